@@ -0,0 +1,340 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// The main() of all the benchmark binaries. On top of google-benchmark's own flags, it takes:
+//
+//   --bionic_cpu=<list>     Run on the given CPUs only, "2" or "0-3,6" say.
+//   --bionic_cluster=<cpu>  Run on the CPUs that share a cluster (a package, in sysfs) with the
+//                           given one: the little or the big cores of a big.LITTLE device.
+//   --bionic_perf           Count cycles, instructions and cache misses with perf_event_open,
+//                           and show them per iteration in each benchmark's label.
+//   --bionic_json=<file>    Also write the results, counters included, to file as JSON, for
+//                           compare_benchmarks.py.
+//
+// The counters are read between benchmarks, so they include the library's calibration runs.
+// The per-iteration numbers scale them by the benchmark's CPU time per iteration, which assumes
+// that every run behaves alike.
+
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/perf_event.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+enum PerfCounter {
+  kCycles,
+  kInstructions,
+  kCacheMisses,
+  // The time the counters were counting for, which the others are divided by.
+  kTaskClock,
+  kPerfCounterCount
+};
+
+class PerfCounters {
+ public:
+  PerfCounters() {
+    for (int& fd : fds_) fd = -1;
+  }
+
+  ~PerfCounters() {
+    for (int fd : fds_) if (fd != -1) close(fd);
+  }
+
+  bool Open() {
+    static const struct { uint32_t type; uint64_t config; } kEvents[kPerfCounterCount] = {
+      { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+      { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+      { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+      { PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK },
+    };
+    for (size_t i = 0; i < kPerfCounterCount; ++i) {
+      perf_event_attr attr;
+      memset(&attr, 0, sizeof(attr));
+      attr.size = sizeof(attr);
+      attr.type = kEvents[i].type;
+      attr.config = kEvents[i].config;
+      attr.exclude_kernel = 1;
+      attr.exclude_hv = 1;
+      // Count the benchmark threads too.
+      attr.inherit = 1;
+      // There may be fewer hardware counters than events, in which case the kernel takes turns.
+      attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+      fds_[i] = syscall(__NR_perf_event_open, &attr, 0, -1, -1, PERF_FLAG_FD_CLOEXEC);
+      if (fds_[i] == -1) {
+        fprintf(stderr, "perf_event_open failed: %s (see /proc/sys/kernel/perf_event_paranoid); "
+                "running without counters\n", strerror(errno));
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Returns the counts since the last call.
+  void ReadDeltas(double deltas[kPerfCounterCount]) {
+    for (size_t i = 0; i < kPerfCounterCount; ++i) {
+      uint64_t values[3];  // The count, the time enabled and the time running.
+      double total = 0;
+      if (read(fds_[i], values, sizeof(values)) == sizeof(values) && values[2] != 0) {
+        total = static_cast<double>(values[0]) * values[1] / values[2];
+      }
+      deltas[i] = total - last_[i];
+      last_[i] = total;
+    }
+  }
+
+ private:
+  int fds_[kPerfCounterCount];
+  double last_[kPerfCounterCount] = {};
+};
+
+// Passes everything on to the reporter that shows the results, adding the counters to the
+// labels, and collects the results for --bionic_json.
+class BionicReporter : public benchmark::BenchmarkReporter {
+ public:
+  BionicReporter(benchmark::BenchmarkReporter* display, PerfCounters* perf,
+                 const std::string& cpus)
+      : display_(display), perf_(perf), cpus_(cpus) {
+  }
+
+  bool ReportContext(const Context& context) override {
+    if (perf_ != nullptr) {
+      double ignored[kPerfCounterCount];
+      perf_->ReadDeltas(ignored);
+    }
+    return display_->ReportContext(context);
+  }
+
+  void ReportRuns(const std::vector<Run>& reports) override {
+    double deltas[kPerfCounterCount] = {};
+    if (perf_ != nullptr) perf_->ReadDeltas(deltas);
+
+    std::vector<Run> labelled(reports);
+    for (Run& run : labelled) {
+      Result result;
+      result.name = run.benchmark_name;
+      result.error = run.error_occurred ? run.error_message : "";
+      result.iterations = run.iterations;
+      if (run.iterations > 0) {
+        result.real_time_ns = run.real_accumulated_time * 1e9 / run.iterations;
+        result.cpu_time_ns = run.cpu_accumulated_time * 1e9 / run.iterations;
+      }
+      result.has_counters = (perf_ != nullptr && deltas[kTaskClock] > 0 && !run.error_occurred);
+      if (result.has_counters) {
+        // The task clock counts in ns.
+        double scale = result.cpu_time_ns / deltas[kTaskClock];
+        for (size_t i = 0; i < kTaskClock; ++i) result.counters[i] = deltas[i] * scale;
+
+        char label[128];
+        snprintf(label, sizeof(label), "%.0f cycles %.0f insns %.2f IPC %.1f misses",
+                 result.counters[kCycles], result.counters[kInstructions],
+                 deltas[kCycles] > 0 ? deltas[kInstructions] / deltas[kCycles] : 0.0,
+                 result.counters[kCacheMisses]);
+        if (!run.report_label.empty()) run.report_label += " ";
+        run.report_label += label;
+      }
+      result.label = run.report_label;
+      results_.push_back(result);
+    }
+    display_->ReportRuns(labelled);
+  }
+
+  void Finalize() override {
+    display_->Finalize();
+  }
+
+  bool WriteJson(const char* path) {
+    FILE* fp = fopen(path, "we");
+    if (fp == nullptr) {
+      fprintf(stderr, "couldn't open %s: %s\n", path, strerror(errno));
+      return false;
+    }
+    fprintf(fp, "{\n  \"context\": {\n");
+    fprintf(fp, "    \"date\": %lld,\n", static_cast<long long>(time(nullptr)));
+    fprintf(fp, "    \"cpus\": \"%s\",\n", cpus_.c_str());
+    fprintf(fp, "    \"perf_counters\": %s\n", perf_ != nullptr ? "true" : "false");
+    fprintf(fp, "  },\n  \"benchmarks\": [");
+    for (size_t i = 0; i < results_.size(); ++i) {
+      const Result& r = results_[i];
+      fprintf(fp, "%s\n    {\n", i == 0 ? "" : ",");
+      fprintf(fp, "      \"name\": \"%s\",\n", Escape(r.name).c_str());
+      if (!r.error.empty()) fprintf(fp, "      \"error\": \"%s\",\n", Escape(r.error).c_str());
+      if (!r.label.empty()) fprintf(fp, "      \"label\": \"%s\",\n", Escape(r.label).c_str());
+      if (r.has_counters) {
+        fprintf(fp, "      \"cycles\": %.1f,\n", r.counters[kCycles]);
+        fprintf(fp, "      \"instructions\": %.1f,\n", r.counters[kInstructions]);
+        fprintf(fp, "      \"cache_misses\": %.2f,\n", r.counters[kCacheMisses]);
+      }
+      fprintf(fp, "      \"iterations\": %lld,\n", static_cast<long long>(r.iterations));
+      fprintf(fp, "      \"real_time_ns\": %.2f,\n", r.real_time_ns);
+      fprintf(fp, "      \"cpu_time_ns\": %.2f\n    }", r.cpu_time_ns);
+    }
+    fprintf(fp, "\n  ]\n}\n");
+    if (fclose(fp) != 0) {
+      fprintf(stderr, "couldn't write %s: %s\n", path, strerror(errno));
+      return false;
+    }
+    return true;
+  }
+
+ private:
+  struct Result {
+    std::string name;
+    std::string error;
+    std::string label;
+    int64_t iterations = 0;
+    double real_time_ns = 0;
+    double cpu_time_ns = 0;
+    bool has_counters = false;
+    double counters[kTaskClock] = {};
+  };
+
+  static std::string Escape(const std::string& s) {
+    std::string result;
+    for (char ch : s) {
+      if (ch == '"' || ch == '\\') {
+        result += '\\';
+        result += ch;
+      } else if (static_cast<unsigned char>(ch) < 0x20) {
+        result += ' ';
+      } else {
+        result += ch;
+      }
+    }
+    return result;
+  }
+
+  benchmark::BenchmarkReporter* display_;
+  PerfCounters* perf_;
+  std::string cpus_;
+  std::vector<Result> results_;
+};
+
+// Parses a list like "0-3,6" into set. Returns false if it's malformed.
+static bool ParseCpuList(const char* list, cpu_set_t* set) {
+  CPU_ZERO(set);
+  const char* p = list;
+  while (*p != '\0' && *p != '\n') {
+    char* end;
+    long first = strtol(p, &end, 10);
+    if (end == p || first < 0) return false;
+    long last = first;
+    if (*end == '-') {
+      p = end + 1;
+      last = strtol(p, &end, 10);
+      if (end == p || last < first) return false;
+    }
+    if (last >= CPU_SETSIZE) return false;
+    for (long cpu = first; cpu <= last; ++cpu) CPU_SET(cpu, set);
+    p = end;
+    if (*p == ',') ++p;
+    else if (*p != '\0' && *p != '\n') return false;
+  }
+  return CPU_COUNT(set) > 0;
+}
+
+// Returns the CPUs in the same cluster as cpu, as a list like "4-7", or "" if sysfs doesn't say.
+static std::string ClusterOf(const char* cpu) {
+  std::string path = std::string("/sys/devices/system/cpu/cpu") + cpu +
+      "/topology/core_siblings_list";
+  std::string result;
+  FILE* fp = fopen(path.c_str(), "re");
+  if (fp != nullptr) {
+    char buf[256];
+    if (fgets(buf, sizeof(buf), fp) != nullptr) {
+      buf[strcspn(buf, "\n")] = '\0';
+      result = buf;
+    }
+    fclose(fp);
+  }
+  return result;
+}
+
+static const char* FlagValue(const char* arg, const char* flag) {
+  size_t length = strlen(flag);
+  if (strncmp(arg, flag, length) == 0 && arg[length] == '=') return arg + length + 1;
+  return nullptr;
+}
+
+int main(int argc, char** argv) {
+  std::string cpus;
+  bool perf = false;
+  const char* json_path = nullptr;
+  const char* format = "console";
+
+  // Take our flags out before google-benchmark sees them.
+  int new_argc = 1;
+  for (int i = 1; i < argc; ++i) {
+    const char* value;
+    if ((value = FlagValue(argv[i], "--bionic_cpu")) != nullptr) {
+      cpus = value;
+    } else if ((value = FlagValue(argv[i], "--bionic_cluster")) != nullptr) {
+      cpus = ClusterOf(value);
+      if (cpus.empty()) {
+        fprintf(stderr, "couldn't find the cluster of CPU %s\n", value);
+        return 1;
+      }
+    } else if (strcmp(argv[i], "--bionic_perf") == 0) {
+      perf = true;
+    } else if ((value = FlagValue(argv[i], "--bionic_json")) != nullptr) {
+      json_path = value;
+    } else {
+      if ((value = FlagValue(argv[i], "--benchmark_format")) != nullptr) format = value;
+      argv[new_argc++] = argv[i];
+    }
+  }
+  argv[new_argc] = nullptr;
+  argc = new_argc;
+
+  if (!cpus.empty()) {
+    cpu_set_t set;
+    if (!ParseCpuList(cpus.c_str(), &set)) {
+      fprintf(stderr, "bad CPU list \"%s\"\n", cpus.c_str());
+      return 1;
+    }
+    // Threads the benchmarks start inherit this.
+    if (sched_setaffinity(0, sizeof(set), &set) == -1) {
+      fprintf(stderr, "couldn't run on CPUs %s: %s\n", cpus.c_str(), strerror(errno));
+      return 1;
+    }
+  }
+
+  PerfCounters counters;
+  if (perf && !counters.Open()) perf = false;
+
+  benchmark::Initialize(&argc, argv);
+
+  benchmark::ConsoleReporter console;
+  benchmark::JSONReporter json;
+  benchmark::CSVReporter csv;
+  benchmark::BenchmarkReporter* display = &console;
+  if (strcmp(format, "json") == 0) display = &json;
+  else if (strcmp(format, "csv") == 0) display = &csv;
+
+  BionicReporter reporter(display, perf ? &counters : nullptr, cpus);
+  benchmark::RunSpecifiedBenchmarks(&reporter);
+  if (json_path != nullptr && !reporter.WriteJson(json_path)) return 1;
+  return 0;
+}
@@ -0,0 +1,96 @@
+#!/usr/bin/env python
+#
+# Copyright (C) 2017 The Android Open Source Project
+#
+# Licensed under the Apache License, Version 2.0 (the 'License');
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an 'AS IS' BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+# pylint: disable=bad-indentation,bad-continuation
+"""Compares two runs of the bionic benchmarks, and fails if any got slower.
+
+Write the baseline and the new results with --bionic_json, pinned to the same
+CPUs, then:
+
+  compare_benchmarks.py baseline.json current.json
+
+Output from --benchmark_out_format=json works too, but has no counters. The
+exit status is 1 if any benchmark regressed by more than --threshold percent.
+"""
+from __future__ import print_function
+
+import argparse
+import json
+import sys
+
+# Multipliers to convert google-benchmark's time units to ns.
+time_units = {"ns": 1.0, "us": 1e3, "ms": 1e6, "s": 1e9}
+
+
+def load(path):
+  """Returns a dict of benchmark name to its results, from either format."""
+  with open(path) as f:
+    data = json.load(f)
+  results = {}
+  for benchmark in data["benchmarks"]:
+    if "error" in benchmark or benchmark.get("error_occurred"):
+      continue
+    if "cpu_time_ns" not in benchmark:
+      scale = time_units[benchmark.get("time_unit", "ns")]
+      benchmark["cpu_time_ns"] = benchmark["cpu_time"] * scale
+      benchmark["real_time_ns"] = benchmark["real_time"] * scale
+    results[benchmark["name"]] = benchmark
+  return results
+
+
+def main():
+  parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+  parser.add_argument("baseline")
+  parser.add_argument("current")
+  parser.add_argument("--threshold", type=float, default=5.0,
+                      help="the percentage increase that counts as a regression")
+  parser.add_argument("--metric", default="cpu_time_ns",
+                      choices=["cpu_time_ns", "real_time_ns", "cycles",
+                               "instructions", "cache_misses"],
+                      help="what to compare; the counters need --bionic_perf")
+  args = parser.parse_args()
+
+  baseline = load(args.baseline)
+  current = load(args.current)
+
+  regressions = []
+  print("%-50s %14s %14s %8s" % ("benchmark", "baseline", "current", "change"))
+  for name in sorted(set(baseline) & set(current)):
+    old = baseline[name].get(args.metric)
+    new = current[name].get(args.metric)
+    if old is None or new is None or old <= 0:
+      continue
+    change = (new - old) * 100.0 / old
+    flag = ""
+    if change > args.threshold:
+      flag = " REGRESSED"
+      regressions.append(name)
+    print("%-50s %14.1f %14.1f %+7.1f%%%s" % (name, old, new, change, flag))
+
+  for name in sorted(set(baseline) - set(current)):
+    print("%s: only in %s" % (name, args.baseline))
+  for name in sorted(set(current) - set(baseline)):
+    print("%s: only in %s" % (name, args.current))
+
+  if regressions:
+    print("\n%d of the benchmarks regressed by more than %g%% in %s." %
+          (len(regressions), args.threshold, args.metric))
+    return 1
+  return 0
+
+
+if __name__ == "__main__":
+  sys.exit(main())
@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <ctype.h>
+#include <locale.h>
+#include <wctype.h>
+
+#include <string>
+
+#include <benchmark/benchmark.h>
+
+// Classifying every character of some text, the way a tokenizer does.
+
+static const char kText[] =
+    "The quick brown fox jumps over the lazy dog; 0123456789 times!\n"
+    "\tPack my box with five dozen liquor jugs (ASCII only, mostly).\n";
+
+static const wchar_t kWideText[] =
+    L"The quick brown fox jumps over the lazy dog; 0123456789 times!\n"
+    L"Voix ambiguë d'un cœur qui au zéphyr préfère les jattes de kiwis.\n"
+    L"Съешь же ещё этих мягких французских булок, いろはにほへと.\n";
+
+template <int (*fn)(int)>
+static void BM_ctype(benchmark::State& state) {
+  while (state.KeepRunning()) {
+    int count = 0;
+    for (const char* p = kText; *p != '\0'; ++p) {
+      count += (fn(static_cast<unsigned char>(*p)) != 0);
+    }
+    benchmark::DoNotOptimize(count);
+  }
+  state.SetItemsProcessed(state.iterations() * (sizeof(kText) - 1));
+}
+
+template <int (*fn)(wint_t)>
+static void BM_wctype(benchmark::State& state) {
+  setlocale(LC_CTYPE, "C.UTF-8");
+  while (state.KeepRunning()) {
+    int count = 0;
+    for (const wchar_t* p = kWideText; *p != L'\0'; ++p) {
+      count += (fn(*p) != 0);
+    }
+    benchmark::DoNotOptimize(count);
+  }
+  state.SetItemsProcessed(state.iterations() * (sizeof(kWideText) / sizeof(wchar_t) - 1));
+}
+
+static int isalpha_fn(int c) { return isalpha(c); }
+static int isspace_fn(int c) { return isspace(c); }
+static int isalnum_fn(int c) { return isalnum(c); }
+static int iswalpha_fn(wint_t c) { return iswalpha(c); }
+static int iswspace_fn(wint_t c) { return iswspace(c); }
+static int iswpunct_fn(wint_t c) { return iswpunct(c); }
+
+BENCHMARK_TEMPLATE(BM_ctype, isalpha_fn);
+BENCHMARK_TEMPLATE(BM_ctype, isspace_fn);
+BENCHMARK_TEMPLATE(BM_ctype, isalnum_fn);
+BENCHMARK_TEMPLATE(BM_wctype, iswalpha_fn);
+BENCHMARK_TEMPLATE(BM_wctype, iswspace_fn);
+BENCHMARK_TEMPLATE(BM_wctype, iswpunct_fn);
+
+void BM_ctype_towlower(benchmark::State& state) {
+  setlocale(LC_CTYPE, "C.UTF-8");
+  while (state.KeepRunning()) {
+    wint_t sum = 0;
+    for (const wchar_t* p = kWideText; *p != L'\0'; ++p) {
+      sum += towlower(*p);
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * (sizeof(kWideText) / sizeof(wchar_t) - 1));
+}
+BENCHMARK(BM_ctype_towlower);
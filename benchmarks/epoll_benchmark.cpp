@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+// An epoll instance with some EPOLLONESHOT eventfds in it, for re-arming with EPOLL_CTL_MOD.
+class OneShotFds {
+ public:
+  explicit OneShotFds(size_t count) : epoll_fd_(epoll_create1(EPOLL_CLOEXEC)), fds_(count) {
+    for (size_t i = 0; i < count; ++i) {
+      fds_[i] = eventfd(0, EFD_CLOEXEC);
+      epoll_event event = event_for(i);
+      epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fds_[i], &event);
+    }
+  }
+
+  ~OneShotFds() {
+    for (int fd : fds_) close(fd);
+    close(epoll_fd_);
+  }
+
+  int epoll_fd() const { return epoll_fd_; }
+  const std::vector<int>& fds() const { return fds_; }
+
+  static epoll_event event_for(size_t i) {
+    epoll_event event;
+    event.events = EPOLLIN | EPOLLONESHOT;
+    event.data.u64 = i;
+    return event;
+  }
+
+ private:
+  int epoll_fd_;
+  std::vector<int> fds_;
+};
+
+static void BM_epoll_ctl_mod(benchmark::State& state) {
+  OneShotFds fds(state.range(0));
+  while (state.KeepRunning()) {
+    for (size_t i = 0; i < fds.fds().size(); ++i) {
+      epoll_event event = OneShotFds::event_for(i);
+      epoll_ctl(fds.epoll_fd(), EPOLL_CTL_MOD, fds.fds()[i], &event);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_epoll_ctl_mod)->Arg(1)->Arg(8)->Arg(64)->Arg(512);
+
+#if defined(__BIONIC__)
+static void BM_epoll_ctl_batch_mod(benchmark::State& state) {
+  OneShotFds fds(state.range(0));
+  std::vector<android_epoll_ctl> ops(state.range(0));
+  for (size_t i = 0; i < ops.size(); ++i) {
+    ops[i].op = EPOLL_CTL_MOD;
+    ops[i].fd = fds.fds()[i];
+    ops[i].event = OneShotFds::event_for(i);
+  }
+  while (state.KeepRunning()) {
+    android_epoll_ctl_batch(fds.epoll_fd(), ops.data(), ops.size());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_epoll_ctl_batch_mod)->Arg(1)->Arg(8)->Arg(64)->Arg(512);
+#endif
+
+static void BM_epoll_pwait_zero_timeout(benchmark::State& state) {
+  OneShotFds fds(1);
+  epoll_event events[1];
+  while (state.KeepRunning()) {
+    epoll_pwait(fds.epoll_fd(), events, 1, 0, nullptr);
+  }
+}
+BENCHMARK(BM_epoll_pwait_zero_timeout);
+
+#if defined(__BIONIC__)
+static void BM_epoll_pwait2_zero_timeout(benchmark::State& state) {
+  OneShotFds fds(1);
+  epoll_event events[1];
+  timespec timeout = { 0, 0 };
+  while (state.KeepRunning()) {
+    epoll_pwait2(fds.epoll_fd(), events, 1, &timeout, nullptr);
+  }
+}
+BENCHMARK(BM_epoll_pwait2_zero_timeout);
+
+// How late a 100us wait comes back: epoll_pwait can only ask for a whole millisecond.
+static void BM_epoll_pwait2_100us(benchmark::State& state) {
+  OneShotFds fds(1);
+  epoll_event events[1];
+  timespec timeout = { 0, 100000 };
+  while (state.KeepRunning()) {
+    epoll_pwait2(fds.epoll_fd(), events, 1, &timeout, nullptr);
+  }
+}
+BENCHMARK(BM_epoll_pwait2_100us);
+#endif
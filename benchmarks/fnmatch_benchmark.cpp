@@ -0,0 +1,68 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <fnmatch.h>
+
+#include <benchmark/benchmark.h>
+
+static const char kPath[] =
+    "/data/user/0/com.example.app/cache/image_manager_disk_cache/journal.tmp";
+
+static const char* kPatterns[] = {
+  "*.log", "*.bak", "*~", "*.swp", "*/.git/*", "*cache*", "/data/local/*", "*.[ch]",
+};
+static constexpr size_t kPatternCount = sizeof(kPatterns) / sizeof(kPatterns[0]);
+
+static void RunFnmatch(benchmark::State& state, const char* pattern) {
+  while (state.KeepRunning()) {
+    fnmatch(pattern, kPath, 0);
+  }
+}
+
+#define FNMATCH_BENCHMARK(name, pattern) \
+  static void BM_fnmatch_##name(benchmark::State& state) { \
+    RunFnmatch(state, pattern); \
+  } \
+  BENCHMARK(BM_fnmatch_##name)
+
+FNMATCH_BENCHMARK(literal, "/data/user/0/com.example.app/cache/journal.tmp");
+FNMATCH_BENCHMARK(prefix, "/data/user/*");
+FNMATCH_BENCHMARK(suffix, "*.tmp");
+FNMATCH_BENCHMARK(infix, "*cache*");
+FNMATCH_BENCHMARK(bracket, "*.[ch]");
+
+static void BM_fnmatch_each_pattern(benchmark::State& state) {
+  while (state.KeepRunning()) {
+    for (size_t i = 0; i < kPatternCount; ++i) {
+      fnmatch(kPatterns[i], kPath, 0);
+    }
+  }
+}
+BENCHMARK(BM_fnmatch_each_pattern);
+
+#if defined(__BIONIC__)
+static void BM_fnmatch_set(benchmark::State& state) {
+  android_fnmatch_set* set = android_fnmatch_set_create(kPatterns, kPatternCount, 0);
+  while (state.KeepRunning()) {
+    size_t index;
+    for (size_t start = 0; android_fnmatch_set_match(set, kPath, start, &index) == 0;) {
+      start = index + 1;
+    }
+  }
+  android_fnmatch_set_destroy(set);
+}
+BENCHMARK(BM_fnmatch_set);
+#endif
@@ -0,0 +1,58 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <ifaddrs.h>
+#include <net/if.h>
+#include <sys/socket.h>
+
+#include <benchmark/benchmark.h>
+
+static void BM_getifaddrs(benchmark::State& state) {
+  while (state.KeepRunning()) {
+    ifaddrs* addrs = nullptr;
+    getifaddrs(&addrs);
+    freeifaddrs(addrs);
+  }
+}
+BENCHMARK(BM_getifaddrs);
+
+#if defined(__BIONIC__)
+static void BM_getifaddrs_filtered_inet(benchmark::State& state) {
+  while (state.KeepRunning()) {
+    ifaddrs* addrs = nullptr;
+    android_getifaddrs_filtered(&addrs, AF_INET, 0);
+    freeifaddrs(addrs);
+  }
+}
+BENCHMARK(BM_getifaddrs_filtered_inet);
+
+static void BM_getifaddrs_filtered_lo(benchmark::State& state) {
+  unsigned int lo_index = if_nametoindex("lo");
+  while (state.KeepRunning()) {
+    ifaddrs* addrs = nullptr;
+    android_getifaddrs_filtered(&addrs, AF_UNSPEC, lo_index);
+    freeifaddrs(addrs);
+  }
+}
+BENCHMARK(BM_getifaddrs_filtered_lo);
+#endif
+
+static void BM_if_nameindex(benchmark::State& state) {
+  while (state.KeepRunning()) {
+    if_freenameindex(if_nameindex());
+  }
+}
+BENCHMARK(BM_if_nameindex);
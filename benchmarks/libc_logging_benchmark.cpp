@@ -0,0 +1,52 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <benchmark/benchmark.h>
+
+// The async-signal-safe formatting crash dumps and malloc debug's leak reports use isn't
+// exported, so there's nothing to compare it with on glibc.
+#if defined(__BIONIC__)
+#include "../libc/bionic/libc_logging.cpp"
+
+static void BM_libc_logging_format_buffer(benchmark::State& state) {
+  char buf[BUFSIZ];
+  uint64_t i = 0;
+  while (state.KeepRunning()) {
+    __libc_format_buffer(buf, sizeof(buf), "%zu %d %x %p", static_cast<size_t>(i), -1234567,
+                         0xdeadbeef, &buf);
+    ++i;
+  }
+}
+BENCHMARK(BM_libc_logging_format_buffer);
+
+// Like a line of a leak report.
+static void BM_libc_logging_format_fd(benchmark::State& state) {
+  int fd = open("/dev/null", O_WRONLY | O_CLOEXEC);
+  uint64_t i = 0;
+  while (state.KeepRunning()) {
+    __libc_format_fd(fd, "leak %zu: addr %p size %zu backtrace %x %x %x %x %x %x %s\n",
+                     static_cast<size_t>(i), reinterpret_cast<void*>(0x7f0000000000 + i * 64),
+                     static_cast<size_t>(i * 13), 0x1234, 0x5678, 0x9abc, 0xdef0, 0x1111, 0x2222,
+                     "libfoo.so");
+    ++i;
+  }
+  close(fd);
+}
+BENCHMARK(BM_libc_logging_format_fd);
+#endif
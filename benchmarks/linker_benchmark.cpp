@@ -0,0 +1,265 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <dlfcn.h>
+#include <link.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <string>
+
+#include <benchmark/benchmark.h>
+
+#if defined(__BIONIC__)
+#include <android/dlext.h>
+#endif
+
+// The libraries come from tests/libs, and are installed with the bionic unit tests.
+#if defined(__LP64__)
+#define NATIVE_TESTS_PATH "/nativetest64/bionic-loader-test-libs"
+#else
+#define NATIVE_TESTS_PATH "/nativetest/bionic-loader-test-libs"
+#endif
+
+static std::string TestLibPath(const char* name) {
+  const char* data = getenv("ANDROID_DATA");
+  return std::string(data != nullptr ? data : "/data") + NATIVE_TESTS_PATH "/" + name;
+}
+
+// Opens a test library for the whole of a benchmark.
+class TestLib {
+ public:
+  TestLib(benchmark::State& state, const char* name)
+      : handle_(dlopen(TestLibPath(name).c_str(), RTLD_NOW)) {
+    if (handle_ == nullptr) state.SkipWithError(dlerror());
+  }
+
+  ~TestLib() {
+    if (handle_ != nullptr) dlclose(handle_);
+  }
+
+  void* handle() const { return handle_; }
+
+ private:
+  void* handle_;
+};
+
+static void DlopenDlclose(benchmark::State& state, const char* name) {
+  std::string path = TestLibPath(name);
+  while (state.KeepRunning()) {
+    void* handle = dlopen(path.c_str(), RTLD_NOW);
+    if (handle == nullptr) {
+      state.SkipWithError(dlerror());
+      break;
+    }
+    dlclose(handle);
+  }
+}
+
+// A chain of 8 libraries, each depending on the next.
+static void BM_linker_dlopen_dlclose_deep(benchmark::State& state) {
+  DlopenDlclose(state, "libtest_deep_tree_root.so");
+}
+BENCHMARK(BM_linker_dlopen_dlclose_deep);
+
+// A library with 8 direct dependencies.
+static void BM_linker_dlopen_dlclose_wide(benchmark::State& state) {
+  DlopenDlclose(state, "libtest_wide_tree_root.so");
+}
+BENCHMARK(BM_linker_dlopen_dlclose_wide);
+
+// 2048 relative and 2048 symbolic relocations, unpacked and in each packed format.
+static void BM_linker_dlopen_dlclose_packed_relocs_plain(benchmark::State& state) {
+  DlopenDlclose(state, "libtest_packed_relocs.so");
+}
+BENCHMARK(BM_linker_dlopen_dlclose_packed_relocs_plain);
+
+static void BM_linker_dlopen_dlclose_packed_relocs_aps2(benchmark::State& state) {
+  DlopenDlclose(state, "libtest_packed_relocs_aps2.so");
+}
+BENCHMARK(BM_linker_dlopen_dlclose_packed_relocs_aps2);
+
+static void BM_linker_dlopen_dlclose_packed_relocs_aps3(benchmark::State& state) {
+  DlopenDlclose(state, "libtest_packed_relocs_aps3.so");
+}
+BENCHMARK(BM_linker_dlopen_dlclose_packed_relocs_aps3);
+
+// Opening a library that's already loaded only takes a reference.
+static void BM_linker_dlopen_loaded(benchmark::State& state) {
+  TestLib lib(state, "libtest_deep_tree_root.so");
+  std::string path = TestLibPath("libtest_deep_tree_root.so");
+  while (state.KeepRunning()) {
+    dlclose(dlopen(path.c_str(), RTLD_NOW));
+  }
+}
+BENCHMARK(BM_linker_dlopen_loaded);
+
+// Searches the executable and all of its dependencies, libc included.
+static void BM_linker_dlsym_RTLD_DEFAULT(benchmark::State& state) {
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(dlsym(RTLD_DEFAULT, "fopen"));
+  }
+}
+BENCHMARK(BM_linker_dlsym_RTLD_DEFAULT);
+
+static void BM_linker_dlsym_RTLD_DEFAULT_missing(benchmark::State& state) {
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(dlsym(RTLD_DEFAULT, "linker_benchmark_no_such_symbol"));
+  }
+}
+BENCHMARK(BM_linker_dlsym_RTLD_DEFAULT_missing);
+
+static void DlsymHandle(benchmark::State& state, const char* name, const char* symbol) {
+  TestLib lib(state, name);
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(dlsym(lib.handle(), symbol));
+  }
+}
+
+static void BM_linker_dlsym_handle_gnu_hash(benchmark::State& state) {
+  DlsymHandle(state, "libgnu-hash-table-library.so", "getRandomNumber");
+}
+BENCHMARK(BM_linker_dlsym_handle_gnu_hash);
+
+static void BM_linker_dlsym_handle_gnu_hash_missing(benchmark::State& state) {
+  // The GNU hash bloom filter should reject most missing symbols.
+  DlsymHandle(state, "libgnu-hash-table-library.so", "linker_benchmark_no_such_symbol");
+}
+BENCHMARK(BM_linker_dlsym_handle_gnu_hash_missing);
+
+static void BM_linker_dlsym_handle_sysv_hash(benchmark::State& state) {
+  DlsymHandle(state, "libsysv-hash-table-library.so", "getRandomNumber");
+}
+BENCHMARK(BM_linker_dlsym_handle_sysv_hash);
+
+static void BM_linker_dlsym_handle_sysv_hash_missing(benchmark::State& state) {
+  DlsymHandle(state, "libsysv-hash-table-library.so", "linker_benchmark_no_such_symbol");
+}
+BENCHMARK(BM_linker_dlsym_handle_sysv_hash_missing);
+
+// A lookup through a handle searches the library's dependencies too, so a
+// missing symbol costs a lookup in each of the 8 libraries of the chain.
+static void BM_linker_dlsym_handle_deep_missing(benchmark::State& state) {
+  DlsymHandle(state, "libtest_deep_tree_root.so", "linker_benchmark_no_such_symbol");
+}
+BENCHMARK(BM_linker_dlsym_handle_deep_missing);
+
+static void BM_linker_dladdr_libc(benchmark::State& state) {
+  Dl_info info;
+  void* addr = reinterpret_cast<void*>(fopen);
+  while (state.KeepRunning()) {
+    dladdr(addr, &info);
+  }
+}
+BENCHMARK(BM_linker_dladdr_libc);
+
+static void BM_linker_dladdr_executable(benchmark::State& state) {
+  Dl_info info;
+  void* addr = reinterpret_cast<void*>(BM_linker_dladdr_executable);
+  while (state.KeepRunning()) {
+    dladdr(addr, &info);
+  }
+}
+BENCHMARK(BM_linker_dladdr_executable);
+
+static int CountPhdrs(dl_phdr_info* info, size_t, void* data) {
+  *reinterpret_cast<size_t*>(data) += info->dlpi_phnum;
+  return 0;
+}
+
+static void BM_linker_dl_iterate_phdr(benchmark::State& state) {
+  size_t count = 0;
+  while (state.KeepRunning()) {
+    dl_iterate_phdr(CountPhdrs, &count);
+  }
+  benchmark::DoNotOptimize(count);
+}
+BENCHMARK(BM_linker_dl_iterate_phdr);
+
+#if defined(__BIONIC__)
+// How much address space to reserve for libdlext_test.so.
+static constexpr size_t kRelroLibSize = 1024 * 1024;
+
+// Loads libdlext_test.so, which has a lot of RELRO, into reserved address
+// space, optionally replacing its RELRO with a file written by another
+// process as the zygote does.
+static void DlopenExtRelro(benchmark::State& state, bool use_relro) {
+  std::string path = TestLibPath("libdlext_test.so");
+  void* start = mmap(nullptr, kRelroLibSize, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (start == MAP_FAILED) {
+    state.SkipWithError("mmap failed");
+    return;
+  }
+
+  android_dlextinfo extinfo = {};
+  extinfo.flags = ANDROID_DLEXT_RESERVED_ADDRESS;
+  extinfo.reserved_addr = start;
+  extinfo.reserved_size = kRelroLibSize;
+
+  FILE* relro_file = nullptr;
+  if (use_relro) {
+    relro_file = tmpfile();
+    if (relro_file == nullptr) {
+      state.SkipWithError("tmpfile failed");
+      munmap(start, kRelroLibSize);
+      return;
+    }
+    pid_t pid = fork();
+    if (pid == 0) {
+      extinfo.flags |= ANDROID_DLEXT_WRITE_RELRO;
+      extinfo.relro_fd = fileno(relro_file);
+      _exit(android_dlopen_ext(path.c_str(), RTLD_NOW, &extinfo) != nullptr ? 0 : 1);
+    }
+    int status;
+    if (pid == -1 || waitpid(pid, &status, 0) != pid || !WIFEXITED(status) ||
+        WEXITSTATUS(status) != 0) {
+      state.SkipWithError("couldn't write the RELRO file");
+      fclose(relro_file);
+      munmap(start, kRelroLibSize);
+      return;
+    }
+    extinfo.flags |= ANDROID_DLEXT_USE_RELRO;
+    extinfo.relro_fd = fileno(relro_file);
+  }
+
+  while (state.KeepRunning()) {
+    void* handle = android_dlopen_ext(path.c_str(), RTLD_NOW, &extinfo);
+    if (handle == nullptr) {
+      state.SkipWithError(dlerror());
+      break;
+    }
+    dlclose(handle);
+    // dlclose unmaps the library, so take its part of the reservation back.
+    mmap(start, kRelroLibSize, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1, 0);
+  }
+
+  if (relro_file != nullptr) fclose(relro_file);
+  munmap(start, kRelroLibSize);
+}
+
+static void BM_linker_android_dlopen_ext(benchmark::State& state) {
+  DlopenExtRelro(state, false);
+}
+BENCHMARK(BM_linker_android_dlopen_ext);
+
+static void BM_linker_android_dlopen_ext_use_relro(benchmark::State& state) {
+  DlopenExtRelro(state, true);
+}
+BENCHMARK(BM_linker_android_dlopen_ext_use_relro);
+#endif
@@ -0,0 +1,353 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <fcntl.h>
+#include <malloc.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "RecordFormat.h"
+
+constexpr auto KB = 1024;
+
+#define AT_SIZE_CLASSES \
+    Arg(8)->Arg(16)->Arg(32)->Arg(48)->Arg(64)->Arg(96)->Arg(128)->Arg(256)->Arg(512)-> \
+    Arg(1*KB)->Arg(2*KB)->Arg(4*KB)->Arg(8*KB)->Arg(16*KB)->Arg(64*KB)->Arg(256*KB)-> \
+    Arg(1024*KB)
+
+// Returns the value of a "Name:   1234 kB" line of /proc/self/status.
+static size_t ReadStatusKb(const char* name) {
+  FILE* fp = fopen("/proc/self/status", "re");
+  if (fp == nullptr) {
+    return 0;
+  }
+  size_t name_len = strlen(name);
+  size_t value = 0;
+  char line[256];
+  while (fgets(line, sizeof(line), fp) != nullptr) {
+    if (strncmp(line, name, name_len) == 0 && line[name_len] == ':') {
+      value = strtoul(line + name_len + 1, nullptr, 10);
+      break;
+    }
+  }
+  fclose(fp);
+  return value;
+}
+
+// Measures how much resident memory the allocator needs for a workload:
+// the RSS high-water mark above the starting point, and how much of that
+// the workload's own peak live data does not account for.
+class MemoryUsage {
+ public:
+  MemoryUsage() {
+    // Writing 5 resets VmHWM to the current RSS (Linux 4.0 and later).
+    int fd = open("/proc/self/clear_refs", O_WRONLY | O_CLOEXEC);
+    if (fd != -1) {
+      if (write(fd, "5", 1) != 1) {
+        // Older kernels can't reset it, so this reports the process' peak.
+      }
+      close(fd);
+    }
+    start_kb_ = ReadStatusKb("VmRSS");
+  }
+
+  void SetLabel(benchmark::State& state, size_t peak_live_bytes) {
+    size_t peak_kb = ReadStatusKb("VmHWM");
+    size_t used_kb = peak_kb > start_kb_ ? peak_kb - start_kb_ : 0;
+    double overhead = 0;
+    if (used_kb * KB > peak_live_bytes) {
+      overhead = 100.0 * (used_kb * KB - peak_live_bytes) / (used_kb * KB);
+    }
+    char label[128];
+    snprintf(label, sizeof(label), "rss_hwm=%zukB live=%zukB overhead=%.1f%%", used_kb,
+             peak_live_bytes / KB, overhead);
+    state.SetLabel(label);
+  }
+
+ private:
+  size_t start_kb_;
+};
+
+static void BM_malloc_free(benchmark::State& state) {
+  const size_t nbytes = state.range_x();
+
+  while (state.KeepRunning()) {
+    void* ptr = malloc(nbytes);
+    benchmark::DoNotOptimize(ptr);
+    free(ptr);
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_malloc_free)->AT_SIZE_CLASSES;
+
+// Allocates a batch of objects of one size and frees them in a different
+// order, so the allocator cannot just hand back the last freed pointer.
+static void BM_malloc_batch(benchmark::State& state) {
+  const size_t nbytes = state.range_x();
+  const size_t count = nbytes >= 64*KB ? 64 : 1024;
+  std::vector<void*> ptrs(count);
+
+  MemoryUsage usage;
+  while (state.KeepRunning()) {
+    for (size_t i = 0; i < count; i++) {
+      ptrs[i] = malloc(nbytes);
+      // Touch the memory so that it counts towards the RSS.
+      memset(ptrs[i], 0, 1);
+    }
+    for (size_t i = 0; i < count; i += 2) {
+      free(ptrs[i]);
+    }
+    for (size_t i = 1; i < count; i += 2) {
+      free(ptrs[i]);
+    }
+  }
+
+  state.SetItemsProcessed(state.iterations() * count);
+  usage.SetLabel(state, count * nbytes);
+}
+BENCHMARK(BM_malloc_batch)->AT_SIZE_CLASSES;
+
+// One thread allocates and another one frees, which is the worst case for
+// allocators that cache memory per thread.
+static void BM_malloc_cross_thread_free(benchmark::State& state) {
+  const size_t nbytes = state.range_x();
+  constexpr size_t kBatch = 256;
+
+  std::mutex lock;
+  std::condition_variable cond;
+  std::vector<void*> pending;
+  bool done = false;
+
+  std::thread consumer([&]() {
+    std::vector<void*> batch;
+    while (true) {
+      {
+        std::unique_lock<std::mutex> guard(lock);
+        cond.wait(guard, [&]() { return done || !pending.empty(); });
+        if (pending.empty()) {
+          return;
+        }
+        batch.swap(pending);
+      }
+      cond.notify_all();
+      for (void* ptr : batch) {
+        free(ptr);
+      }
+      batch.clear();
+    }
+  });
+
+  std::vector<void*> batch;
+  batch.reserve(kBatch);
+  while (state.KeepRunning()) {
+    for (size_t i = 0; i < kBatch; i++) {
+      batch.push_back(malloc(nbytes));
+    }
+    std::unique_lock<std::mutex> guard(lock);
+    // Don't let the producer run arbitrarily far ahead.
+    cond.wait(guard, [&]() { return pending.size() < 4 * kBatch; });
+    pending.insert(pending.end(), batch.begin(), batch.end());
+    batch.clear();
+    cond.notify_all();
+  }
+
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    done = true;
+  }
+  cond.notify_all();
+  consumer.join();
+
+  state.SetItemsProcessed(state.iterations() * kBatch);
+}
+BENCHMARK(BM_malloc_cross_thread_free)->Arg(16)->Arg(64)->Arg(512)->Arg(4*KB);
+
+// Grows a buffer the way a string or vector that is appended to would.
+static void BM_malloc_realloc_grow(benchmark::State& state) {
+  const size_t max_bytes = state.range_x();
+
+  size_t reallocs = 0;
+  while (state.KeepRunning()) {
+    void* ptr = nullptr;
+    for (size_t nbytes = 16; nbytes <= max_bytes; nbytes += nbytes / 2) {
+      ptr = realloc(ptr, nbytes);
+      benchmark::DoNotOptimize(ptr);
+      reallocs++;
+    }
+    free(ptr);
+  }
+
+  state.SetItemsProcessed(reallocs);
+}
+BENCHMARK(BM_malloc_realloc_grow)->Arg(1*KB)->Arg(64*KB)->Arg(1024*KB)->Arg(16*1024*KB);
+
+static void BM_malloc_memalign(benchmark::State& state) {
+  const size_t alignment = state.range_x();
+
+  while (state.KeepRunning()) {
+    void* ptr = memalign(alignment, 64);
+    benchmark::DoNotOptimize(ptr);
+    free(ptr);
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_malloc_memalign)->Arg(16)->Arg(64)->Arg(256)->Arg(4*KB)->Arg(64*KB);
+
+// Replays the allocations of a trace written by malloc debug's
+// record_allocs_binary option. Set MALLOC_REPLAY_TRACE to its path.
+static bool LoadTrace(std::vector<Record>* records) {
+  const char* path = getenv("MALLOC_REPLAY_TRACE");
+  if (path == nullptr) {
+    return false;
+  }
+  FILE* fp = fopen(path, "re");
+  if (fp == nullptr) {
+    return false;
+  }
+  std::string data;
+  char buf[64 * KB];
+  size_t bytes;
+  while ((bytes = fread(buf, 1, sizeof(buf), fp)) > 0) {
+    data.append(buf, bytes);
+  }
+  fclose(fp);
+
+  if (data.size() < sizeof(RecordFileHeader) ||
+      memcmp(data.data(), RECORD_FILE_MAGIC, sizeof(RECORD_FILE_MAGIC)) != 0) {
+    return false;
+  }
+  size_t offset = sizeof(RecordFileHeader);
+  while (offset + sizeof(RecordChunkHeader) <= data.size()) {
+    RecordChunkHeader header;
+    memcpy(&header, &data[offset], sizeof(header));
+    offset += sizeof(header);
+    if (offset + header.num_bytes > data.size()) {
+      return false;
+    }
+    const uint8_t* in = reinterpret_cast<const uint8_t*>(&data[offset]);
+    const uint8_t* end = in + header.num_bytes;
+    uint64_t time_ns = header.start_ns;
+    uint64_t last_pointer = 0;
+    while (in < end) {
+      Record record;
+      in = RecordDecode(in, end, &time_ns, &last_pointer, &record);
+      if (in == nullptr) {
+        return false;
+      }
+      records->push_back(record);
+    }
+    offset += header.num_bytes;
+  }
+
+  // Merge the threads so that a pointer freed by a different thread than
+  // the one that allocated it is still matched up.
+  std::stable_sort(records->begin(), records->end(),
+                   [](const Record& a, const Record& b) { return a.time_ns < b.time_ns; });
+  return true;
+}
+
+static void BM_malloc_replay(benchmark::State& state) {
+  std::vector<Record> records;
+  if (!LoadTrace(&records)) {
+    while (state.KeepRunning()) {
+    }
+    state.SetLabel("set MALLOC_REPLAY_TRACE to a record_allocs_binary file");
+    return;
+  }
+
+  // Recorded pointer -> replayed pointer and its size.
+  std::unordered_map<uint64_t, std::pair<void*, size_t>> live;
+  live.reserve(records.size() / 2);
+  size_t peak_live_bytes = 0;
+
+  MemoryUsage usage;
+  while (state.KeepRunning()) {
+    size_t live_bytes = 0;
+    for (const Record& record : records) {
+      void* old_pointer = nullptr;
+      uint64_t old_key = record.op == RECORD_REALLOC ? record.arg : record.pointer;
+      if (record.op == RECORD_FREE || record.op == RECORD_REALLOC) {
+        auto entry = live.find(old_key);
+        if (entry != live.end()) {
+          old_pointer = entry->second.first;
+          live_bytes -= entry->second.second;
+          live.erase(entry);
+        }
+      }
+
+      void* result = nullptr;
+      size_t size = record.size;
+      switch (record.op) {
+        case RECORD_MALLOC:
+          result = malloc(size);
+          break;
+        case RECORD_FREE:
+          free(old_pointer);
+          break;
+        case RECORD_CALLOC:
+          result = calloc(record.arg, size);
+          size *= record.arg;
+          break;
+        case RECORD_REALLOC:
+          result = realloc(old_pointer, size);
+          break;
+        case RECORD_MEMALIGN:
+          result = memalign(record.arg, size);
+          break;
+        case RECORD_THREAD_DONE:
+          break;
+      }
+      if (result != nullptr && record.pointer != 0) {
+        auto inserted = live.emplace(record.pointer, std::make_pair(result, size));
+        if (inserted.second) {
+          live_bytes += size;
+          if (live_bytes > peak_live_bytes) {
+            peak_live_bytes = live_bytes;
+          }
+        } else {
+          // The trace is missing the free of the previous allocation here.
+          free(result);
+        }
+      }
+    }
+
+    // Free whatever the trace leaked so that iterations are independent.
+    for (const auto& entry : live) {
+      free(entry.second.first);
+    }
+    live.clear();
+  }
+
+  state.SetItemsProcessed(state.iterations() * records.size());
+  usage.SetLabel(state, peak_live_bytes);
+}
+BENCHMARK(BM_malloc_replay);
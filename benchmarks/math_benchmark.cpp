@@ -178,6 +178,202 @@ static void BM_math_sin_fesetenv(benchmark::State& state) {
 }
 BENCHMARK(BM_math_sin_fesetenv);
 
+static void BM_math_fesetround(benchmark::State& state) {
+  while (state.KeepRunning()) {
+    fesetround(FE_UPWARD);
+    fesetround(FE_TONEAREST);
+  }
+}
+BENCHMARK(BM_math_fesetround);
+
+#if defined(__BIONIC__)
+static void BM_math_sin_feswapround(benchmark::State& state) {
+  d = 1.0;
+  while (state.KeepRunning()) {
+    int old_round = feswapround(FE_UPWARD);
+    d += sin(d);
+    feswapround(old_round);
+  }
+}
+BENCHMARK(BM_math_sin_feswapround);
+#endif
+
+static void BM_math_exp(benchmark::State& state) {
+  d = 0.0;
+  v = 1.234;
+  while (state.KeepRunning()) {
+    d += exp(v);
+  }
+}
+BENCHMARK(BM_math_exp);
+
+static void BM_math_exp2(benchmark::State& state) {
+  d = 0.0;
+  v = 1.234;
+  while (state.KeepRunning()) {
+    d += exp2(v);
+  }
+}
+BENCHMARK(BM_math_exp2);
+
+static void BM_math_log(benchmark::State& state) {
+  d = 0.0;
+  v = 1234.0;
+  while (state.KeepRunning()) {
+    d += log(v);
+  }
+}
+BENCHMARK(BM_math_log);
+
+static void BM_math_log2(benchmark::State& state) {
+  d = 0.0;
+  v = 1234.0;
+  while (state.KeepRunning()) {
+    d += log2(v);
+  }
+}
+BENCHMARK(BM_math_log2);
+
+static void BM_math_pow(benchmark::State& state) {
+  d = 0.0;
+  v = 1234.0;
+  while (state.KeepRunning()) {
+    d += pow(v, 1.234);
+  }
+}
+BENCHMARK(BM_math_pow);
+
+static void BM_math_hypot(benchmark::State& state) {
+  d = 0.0;
+  v = 1234.0;
+  while (state.KeepRunning()) {
+    d += hypot(v, 567.8);
+  }
+}
+BENCHMARK(BM_math_hypot);
+
+static void BM_math_cbrt(benchmark::State& state) {
+  d = 0.0;
+  v = 1234.0;
+  while (state.KeepRunning()) {
+    d += cbrt(v);
+  }
+}
+BENCHMARK(BM_math_cbrt);
+
+static void BM_math_fmod(benchmark::State& state) {
+  d = 0.0;
+  v = 1234.0;
+  while (state.KeepRunning()) {
+    d += fmod(v, 5.678);
+  }
+}
+BENCHMARK(BM_math_fmod);
+
+static void BM_math_fmod_huge(benchmark::State& state) {
+  d = 0.0;
+  v = 1e300;
+  while (state.KeepRunning()) {
+    d += fmod(v, 5.678);
+  }
+}
+BENCHMARK(BM_math_fmod_huge);
+
+static void BM_math_expf(benchmark::State& state) {
+  d = 0.0;
+  v = 1.234;
+  while (state.KeepRunning()) {
+    d += expf(v);
+  }
+}
+BENCHMARK(BM_math_expf);
+
+static void BM_math_exp2f(benchmark::State& state) {
+  d = 0.0;
+  v = 1.234;
+  while (state.KeepRunning()) {
+    d += exp2f(v);
+  }
+}
+BENCHMARK(BM_math_exp2f);
+
+static void BM_math_logf(benchmark::State& state) {
+  d = 0.0;
+  v = 1234.0;
+  while (state.KeepRunning()) {
+    d += logf(v);
+  }
+}
+BENCHMARK(BM_math_logf);
+
+static void BM_math_log2f(benchmark::State& state) {
+  d = 0.0;
+  v = 1234.0;
+  while (state.KeepRunning()) {
+    d += log2f(v);
+  }
+}
+BENCHMARK(BM_math_log2f);
+
+static void BM_math_powf(benchmark::State& state) {
+  d = 0.0;
+  v = 1234.0;
+  while (state.KeepRunning()) {
+    d += powf(v, 1.234f);
+  }
+}
+BENCHMARK(BM_math_powf);
+
+static void BM_math_sinf(benchmark::State& state) {
+  d = 0.0;
+  v = 1234.0;
+  while (state.KeepRunning()) {
+    d += sinf(v);
+  }
+}
+BENCHMARK(BM_math_sinf);
+
+static void BM_math_cosf(benchmark::State& state) {
+  d = 0.0;
+  v = 1234.0;
+  while (state.KeepRunning()) {
+    d += cosf(v);
+  }
+}
+BENCHMARK(BM_math_cosf);
+
+// Reading v separately for each call stops the compiler turning sin and cos into sincos.
+static void BM_math_sin_cos(benchmark::State& state) {
+  d = 0.0;
+  v = 1234.0;
+  while (state.KeepRunning()) {
+    d += sin(v) + cos(v);
+  }
+}
+BENCHMARK(BM_math_sin_cos);
+
+static void BM_math_sincos(benchmark::State& state) {
+  d = 0.0;
+  v = 1234.0;
+  while (state.KeepRunning()) {
+    double s, c;
+    sincos(v, &s, &c);
+    d += s + c;
+  }
+}
+BENCHMARK(BM_math_sincos);
+
+static void BM_math_sincosf(benchmark::State& state) {
+  d = 0.0;
+  v = 1234.0;
+  while (state.KeepRunning()) {
+    float s, c;
+    sincosf(v, &s, &c);
+    d += s + c;
+  }
+}
+BENCHMARK(BM_math_sincosf);
+
 static void BM_math_fpclassify(benchmark::State& state) {
   d = 0.0;
   v = values[state.range_x()];
@@ -227,3 +423,153 @@ static void BM_math_fabs(benchmark::State& state) {
   SetLabel(state);
 }
 BENCHMARK_COMMON_VALS(BM_math_fabs);
+
+// long double is IEEE quad precision on arm64, where all of this is done in software: the
+// arithmetic here by the compiler runtime linked into the benchmark, and the arithmetic inside
+// the libm functions by libm's own routines. On x86 and x86-64 it's the x87 80-bit format.
+volatile long double ld;
+volatile long double ldv;
+
+static void BM_math_long_double_add(benchmark::State& state) {
+  ld = 0.0L;
+  ldv = 1.1L;
+  while (state.KeepRunning()) {
+    ld += ldv;
+  }
+}
+BENCHMARK(BM_math_long_double_add);
+
+static void BM_math_long_double_mul(benchmark::State& state) {
+  ld = 1.0L;
+  ldv = 1.0000001L;
+  while (state.KeepRunning()) {
+    ld *= ldv;
+  }
+}
+BENCHMARK(BM_math_long_double_mul);
+
+static void BM_math_long_double_div(benchmark::State& state) {
+  ld = 1.0L;
+  ldv = 1.0000001L;
+  while (state.KeepRunning()) {
+    ld /= ldv;
+  }
+}
+BENCHMARK(BM_math_long_double_div);
+
+#define BENCHMARK_LONG_DOUBLE(f, x) \
+  static void BM_math_##f(benchmark::State& state) { \
+    ld = 0.0L; \
+    ldv = x; \
+    while (state.KeepRunning()) { \
+      ld += f(ldv); \
+    } \
+  } \
+  BENCHMARK(BM_math_##f)
+
+BENCHMARK_LONG_DOUBLE(sqrtl, 2.0L);
+BENCHMARK_LONG_DOUBLE(expl, 1.5L);
+BENCHMARK_LONG_DOUBLE(logl, 1234.0L);
+BENCHMARK_LONG_DOUBLE(sinl, 1.0L);
+BENCHMARK_LONG_DOUBLE(cbrtl, 1234.0L);
+
+// The vector versions, called directly, against a loop of scalar calls over the same inputs.
+#if defined(__BIONIC__) && (defined(__aarch64__) || defined(__x86_64__))
+typedef double vector_double __attribute__((vector_size(16)));
+typedef float vector_float __attribute__((vector_size(16)));
+
+#if defined(__aarch64__)
+#define VECTOR_ABI __attribute__((aarch64_vector_pcs))
+#define VECTOR_NAME(lanes, f) _ZGVnN##lanes##_##f
+#else
+#define VECTOR_ABI
+#define VECTOR_NAME(lanes, f) _ZGVbN##lanes##_##f
+#endif
+
+extern "C" VECTOR_ABI vector_double VECTOR_NAME(2v, exp)(vector_double);
+extern "C" VECTOR_ABI vector_double VECTOR_NAME(2v, sin)(vector_double);
+extern "C" VECTOR_ABI vector_float VECTOR_NAME(4v, expf)(vector_float);
+extern "C" VECTOR_ABI vector_float VECTOR_NAME(4v, sinf)(vector_float);
+
+static constexpr size_t kVectorInputs = 1024;
+
+template <typename T>
+static T* VectorInputs() {
+  static T inputs[kVectorInputs] __attribute__((aligned(16)));
+  for (size_t i = 0; i < kVectorInputs; ++i) {
+    inputs[i] = -10 + 20 * static_cast<T>(i) / kVectorInputs;
+  }
+  return inputs;
+}
+
+#define BENCHMARK_VECTOR(V, T, lanes, f) \
+  static void BM_math_##f##_loop(benchmark::State& state) { \
+    T* in = VectorInputs<T>(); \
+    T sum = 0; \
+    while (state.KeepRunning()) { \
+      for (size_t i = 0; i < kVectorInputs; ++i) sum += f(in[i]); \
+    } \
+    d = sum; \
+    state.SetItemsProcessed(state.iterations() * kVectorInputs); \
+  } \
+  BENCHMARK(BM_math_##f##_loop); \
+  static void BM_math_##f##_vector(benchmark::State& state) { \
+    T* in = VectorInputs<T>(); \
+    V sum = {}; \
+    while (state.KeepRunning()) { \
+      for (size_t i = 0; i < kVectorInputs; i += sizeof(V) / sizeof(T)) { \
+        sum += VECTOR_NAME(lanes, f)(*reinterpret_cast<V*>(&in[i])); \
+      } \
+    } \
+    d = sum[0]; \
+    state.SetItemsProcessed(state.iterations() * kVectorInputs); \
+  } \
+  BENCHMARK(BM_math_##f##_vector)
+
+BENCHMARK_VECTOR(vector_double, double, 2v, exp);
+BENCHMARK_VECTOR(vector_double, double, 2v, sin);
+BENCHMARK_VECTOR(vector_float, float, 4v, expf);
+BENCHMARK_VECTOR(vector_float, float, 4v, sinf);
+#endif
+
+// The bulk functions, against a loop of scalar calls writing the same output array.
+#if defined(__BIONIC__)
+static constexpr size_t kArrayInputs = 1024;
+
+template <typename T>
+static T* ArrayInputs() {
+  static T inputs[kArrayInputs];
+  for (size_t i = 0; i < kArrayInputs; ++i) {
+    inputs[i] = static_cast<T>(i + 1) / 100;
+  }
+  return inputs;
+}
+
+#define BENCHMARK_ARRAY(T, f) \
+  static void BM_math_##f##_array_loop(benchmark::State& state) { \
+    T* in = ArrayInputs<T>(); \
+    static T out[kArrayInputs]; \
+    while (state.KeepRunning()) { \
+      for (size_t i = 0; i < kArrayInputs; ++i) out[i] = f(in[i]); \
+      benchmark::DoNotOptimize(out); \
+    } \
+    state.SetItemsProcessed(state.iterations() * kArrayInputs); \
+  } \
+  BENCHMARK(BM_math_##f##_array_loop); \
+  static void BM_math_##f##_array(benchmark::State& state) { \
+    T* in = ArrayInputs<T>(); \
+    static T out[kArrayInputs]; \
+    while (state.KeepRunning()) { \
+      f##_array(in, out, kArrayInputs); \
+    } \
+    state.SetItemsProcessed(state.iterations() * kArrayInputs); \
+  } \
+  BENCHMARK(BM_math_##f##_array)
+
+BENCHMARK_ARRAY(double, exp);
+BENCHMARK_ARRAY(double, log);
+BENCHMARK_ARRAY(double, sin);
+BENCHMARK_ARRAY(float, expf);
+BENCHMARK_ARRAY(float, logf);
+BENCHMARK_ARRAY(float, sinf);
+#endif
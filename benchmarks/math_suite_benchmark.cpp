@@ -0,0 +1,269 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// The libm functions over whole sets of inputs, measured for both throughput and latency.
+// math_benchmark.cpp times single inputs quickly; this is the broader baseline to compare an
+// optimization against, built as its own binary because of the size of the input tables.
+//
+// Each function gets two input sets:
+//   intel   the inputs of its tests/math_data table, which are mostly hard cases: arguments
+//           near overflow, underflow and special values, huge trig arguments, subnormals.
+//   range   1024 values spread evenly over a range typical code passes it.
+// and is measured two ways:
+//   throughput  independent calls, with the results stored, so the CPU can overlap them.
+//   latency     each call's argument made to depend on the previous call's result, so no call
+//               starts until the one before has finished. The dependency costs an integer
+//               and and xor on top of the call, the same for every function.
+// The benchmarks are named BM_math_suite_<function>_<input set>_<throughput or latency>, and
+// items_per_second counts calls.
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+// The shapes of the tests/math_data tables, as in tests/math_data_test.h (which needs gtest).
+template <typename RT, typename T1>
+struct data_1_1_t {
+  RT expected;
+  T1 input;
+};
+
+template <typename RT, typename T1, typename T2>
+struct data_1_2_t {
+  RT expected;
+  T1 input1;
+  T2 input2;
+};
+
+#include "math_data/acos_intel_data.h"
+#include "math_data/acosf_intel_data.h"
+#include "math_data/asin_intel_data.h"
+#include "math_data/asinf_intel_data.h"
+#include "math_data/atan2_intel_data.h"
+#include "math_data/atan2f_intel_data.h"
+#include "math_data/atan_intel_data.h"
+#include "math_data/atanf_intel_data.h"
+#include "math_data/cbrt_intel_data.h"
+#include "math_data/cbrtf_intel_data.h"
+#include "math_data/cos_intel_data.h"
+#include "math_data/cosf_intel_data.h"
+#include "math_data/cosh_intel_data.h"
+#include "math_data/coshf_intel_data.h"
+#include "math_data/exp2_intel_data.h"
+#include "math_data/exp2f_intel_data.h"
+#include "math_data/exp_intel_data.h"
+#include "math_data/expf_intel_data.h"
+#include "math_data/expm1_intel_data.h"
+#include "math_data/expm1f_intel_data.h"
+#include "math_data/fmod_intel_data.h"
+#include "math_data/fmodf_intel_data.h"
+#include "math_data/hypot_intel_data.h"
+#include "math_data/hypotf_intel_data.h"
+#include "math_data/log10_intel_data.h"
+#include "math_data/log10f_intel_data.h"
+#include "math_data/log1p_intel_data.h"
+#include "math_data/log1pf_intel_data.h"
+#include "math_data/log2_intel_data.h"
+#include "math_data/log2f_intel_data.h"
+#include "math_data/log_intel_data.h"
+#include "math_data/logf_intel_data.h"
+#include "math_data/pow_intel_data.h"
+#include "math_data/powf_intel_data.h"
+#include "math_data/sin_intel_data.h"
+#include "math_data/sinf_intel_data.h"
+#include "math_data/sinh_intel_data.h"
+#include "math_data/sinhf_intel_data.h"
+#include "math_data/sqrt_intel_data.h"
+#include "math_data/sqrtf_intel_data.h"
+#include "math_data/tan_intel_data.h"
+#include "math_data/tanf_intel_data.h"
+#include "math_data/tanh_intel_data.h"
+#include "math_data/tanhf_intel_data.h"
+
+static constexpr size_t kRangeInputs = 1024;
+
+// Zero, but not as far as the compiler knows, for making one call depend on the last.
+static volatile uint64_t g_zero = 0;
+
+template <typename T> struct Bits;
+template <> struct Bits<double> { typedef uint64_t type; };
+template <> struct Bits<float> { typedef uint32_t type; };
+
+// Returns x, but only once prev is known. Done on the bits so that an infinite or NaN prev
+// doesn't change x.
+template <typename T>
+static inline T After(T x, T prev, typename Bits<T>::type zero) {
+  typename Bits<T>::type ux, uprev;
+  memcpy(&ux, &x, sizeof(x));
+  memcpy(&uprev, &prev, sizeof(prev));
+  ux ^= uprev & zero;
+  memcpy(&x, &ux, sizeof(x));
+  return x;
+}
+
+template <typename T, size_t N>
+static std::vector<T> IntelInputs(data_1_1_t<T, T> (&data)[N]) {
+  std::vector<T> in(N);
+  for (size_t i = 0; i < N; ++i) in[i] = data[i].input;
+  return in;
+}
+
+template <typename T, size_t N>
+static std::vector<T> IntelInputs1(data_1_2_t<T, T, T> (&data)[N]) {
+  std::vector<T> in(N);
+  for (size_t i = 0; i < N; ++i) in[i] = data[i].input1;
+  return in;
+}
+
+template <typename T, size_t N>
+static std::vector<T> IntelInputs2(data_1_2_t<T, T, T> (&data)[N]) {
+  std::vector<T> in(N);
+  for (size_t i = 0; i < N; ++i) in[i] = data[i].input2;
+  return in;
+}
+
+// kRangeInputs values evenly spread over [lo, hi]. A stride other than 1 through them gives the
+// second argument of a two-argument function an order unrelated to the first's.
+template <typename T>
+static std::vector<T> RangeInputs(double lo, double hi, size_t stride = 1) {
+  std::vector<T> in(kRangeInputs);
+  for (size_t i = 0; i < kRangeInputs; ++i) {
+    in[i] = static_cast<T>(lo + (hi - lo) * ((i * stride) % kRangeInputs) / (kRangeInputs - 1));
+  }
+  return in;
+}
+
+template <typename T, T f(T)>
+static void Throughput(benchmark::State& state, const std::vector<T>& in) {
+  std::vector<T> out(in.size());
+  while (state.KeepRunning()) {
+    for (size_t i = 0; i < in.size(); ++i) out[i] = f(in[i]);
+    benchmark::DoNotOptimize(out.data());
+  }
+  state.SetItemsProcessed(state.iterations() * in.size());
+}
+
+template <typename T, T f(T)>
+static void Latency(benchmark::State& state, const std::vector<T>& in) {
+  typename Bits<T>::type zero = g_zero;
+  T prev = 0;
+  while (state.KeepRunning()) {
+    for (size_t i = 0; i < in.size(); ++i) prev = f(After(in[i], prev, zero));
+  }
+  benchmark::DoNotOptimize(prev);
+  state.SetItemsProcessed(state.iterations() * in.size());
+}
+
+template <typename T, T f(T, T)>
+static void Throughput2(benchmark::State& state, const std::vector<T>& in1,
+                        const std::vector<T>& in2) {
+  std::vector<T> out(in1.size());
+  while (state.KeepRunning()) {
+    for (size_t i = 0; i < in1.size(); ++i) out[i] = f(in1[i], in2[i]);
+    benchmark::DoNotOptimize(out.data());
+  }
+  state.SetItemsProcessed(state.iterations() * in1.size());
+}
+
+// Only the first argument waits for the previous result.
+template <typename T, T f(T, T)>
+static void Latency2(benchmark::State& state, const std::vector<T>& in1,
+                     const std::vector<T>& in2) {
+  typename Bits<T>::type zero = g_zero;
+  T prev = 0;
+  while (state.KeepRunning()) {
+    for (size_t i = 0; i < in1.size(); ++i) prev = f(After(in1[i], prev, zero), in2[i]);
+  }
+  benchmark::DoNotOptimize(prev);
+  state.SetItemsProcessed(state.iterations() * in1.size());
+}
+
+#define MATH_SUITE_BENCHMARK(f, mode, set, ...) \
+  static void BM_math_suite_##f##_##set##_##mode(benchmark::State& state) { __VA_ARGS__; } \
+  BENCHMARK(BM_math_suite_##f##_##set##_##mode)
+
+// A one-argument function f taking and returning T, with typical arguments in [lo, hi].
+#define MATH_SUITE_1(T, f, lo, hi) \
+  MATH_SUITE_BENCHMARK(f, throughput, intel, \
+                       Throughput<T, f>(state, IntelInputs(g_##f##_intel_data))); \
+  MATH_SUITE_BENCHMARK(f, latency, intel, Latency<T, f>(state, IntelInputs(g_##f##_intel_data))); \
+  MATH_SUITE_BENCHMARK(f, throughput, range, Throughput<T, f>(state, RangeInputs<T>(lo, hi))); \
+  MATH_SUITE_BENCHMARK(f, latency, range, Latency<T, f>(state, RangeInputs<T>(lo, hi)))
+
+// A two-argument function, with typical arguments in [lo1, hi1] and [lo2, hi2].
+#define MATH_SUITE_2(T, f, lo1, hi1, lo2, hi2) \
+  MATH_SUITE_BENCHMARK(f, throughput, intel, \
+                       Throughput2<T, f>(state, IntelInputs1(g_##f##_intel_data), \
+                                         IntelInputs2(g_##f##_intel_data))); \
+  MATH_SUITE_BENCHMARK(f, latency, intel, \
+                       Latency2<T, f>(state, IntelInputs1(g_##f##_intel_data), \
+                                      IntelInputs2(g_##f##_intel_data))); \
+  MATH_SUITE_BENCHMARK(f, throughput, range, \
+                       Throughput2<T, f>(state, RangeInputs<T>(lo1, hi1), \
+                                         RangeInputs<T>(lo2, hi2, 389))); \
+  MATH_SUITE_BENCHMARK(f, latency, range, \
+                       Latency2<T, f>(state, RangeInputs<T>(lo1, hi1), \
+                                      RangeInputs<T>(lo2, hi2, 389)))
+
+MATH_SUITE_1(double, acos, -1, 1);
+MATH_SUITE_1(double, asin, -1, 1);
+MATH_SUITE_1(double, atan, -10, 10);
+MATH_SUITE_2(double, atan2, -10, 10, -10, 10);
+MATH_SUITE_1(double, cbrt, -1000, 1000);
+MATH_SUITE_1(double, cos, -10, 10);
+MATH_SUITE_1(double, cosh, -5, 5);
+MATH_SUITE_1(double, exp, -10, 10);
+MATH_SUITE_1(double, exp2, -10, 10);
+MATH_SUITE_1(double, expm1, -2, 2);
+MATH_SUITE_2(double, fmod, -1000, 1000, 1, 10);
+MATH_SUITE_2(double, hypot, -100, 100, -100, 100);
+MATH_SUITE_1(double, log, 0.01, 100);
+MATH_SUITE_1(double, log10, 0.01, 100);
+MATH_SUITE_1(double, log1p, -0.5, 10);
+MATH_SUITE_1(double, log2, 0.01, 100);
+MATH_SUITE_2(double, pow, 0.01, 100, -10, 10);
+MATH_SUITE_1(double, sin, -10, 10);
+MATH_SUITE_1(double, sinh, -5, 5);
+MATH_SUITE_1(double, sqrt, 0, 1000);
+MATH_SUITE_1(double, tan, -10, 10);
+MATH_SUITE_1(double, tanh, -5, 5);
+
+MATH_SUITE_1(float, acosf, -1, 1);
+MATH_SUITE_1(float, asinf, -1, 1);
+MATH_SUITE_1(float, atanf, -10, 10);
+MATH_SUITE_2(float, atan2f, -10, 10, -10, 10);
+MATH_SUITE_1(float, cbrtf, -1000, 1000);
+MATH_SUITE_1(float, cosf, -10, 10);
+MATH_SUITE_1(float, coshf, -5, 5);
+MATH_SUITE_1(float, expf, -10, 10);
+MATH_SUITE_1(float, exp2f, -10, 10);
+MATH_SUITE_1(float, expm1f, -2, 2);
+MATH_SUITE_2(float, fmodf, -1000, 1000, 1, 10);
+MATH_SUITE_2(float, hypotf, -100, 100, -100, 100);
+MATH_SUITE_1(float, logf, 0.01, 100);
+MATH_SUITE_1(float, log10f, 0.01, 100);
+MATH_SUITE_1(float, log1pf, -0.5, 10);
+MATH_SUITE_1(float, log2f, 0.01, 100);
+MATH_SUITE_2(float, powf, 0.01, 100, -10, 10);
+MATH_SUITE_1(float, sinf, -10, 10);
+MATH_SUITE_1(float, sinhf, -5, 5);
+MATH_SUITE_1(float, sqrtf, 0, 1000);
+MATH_SUITE_1(float, tanf, -10, 10);
+MATH_SUITE_1(float, tanhf, -5, 5);
@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2012 The Android Open Source Project
+ * Copyright (C) 2017 The Android Open Source Project
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -14,23 +14,23 @@
  * limitations under the License.
  */
 
-#define _SEARCH_PRIVATE
-#include <search.h>
-#include <stdlib.h>
 
-// Destroy a tree and free all allocated resources.
-// This is a GNU extension, not available from BSD.
-void tdestroy(void* root, void (*destroy_func)(void*)) {
-  node_t* root_node = reinterpret_cast<node_t*>(root);
-  if (root_node == NULL) {
-    return;
-  }
-  if (root_node->llink) {
-    tdestroy(root_node->llink, destroy_func);
-  }
-  if (root_node->rlink) {
-    tdestroy(root_node->rlink, destroy_func);
+#include <mntent.h>
+#include <stdio.h>
+
+#include <benchmark/benchmark.h>
+
+static void BM_getmntent_r_proc_mounts(benchmark::State& state) {
+  mntent entry;
+  char buf[BUFSIZ];
+  size_t count = 0;
+  while (state.KeepRunning()) {
+    FILE* fp = setmntent("/proc/mounts", "re");
+    while (getmntent_r(fp, &entry, buf, sizeof(buf)) != nullptr) {
+      ++count;
+    }
+    endmntent(fp);
   }
-  (*destroy_func)(root_node->key);
-  free(root);
+  state.SetItemsProcessed(count);
 }
+BENCHMARK(BM_getmntent_r_proc_mounts);
@@ -15,11 +15,16 @@
  */
 
 #include <errno.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <time.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <atomic>
 #include <string>
+#include <vector>
 
 #if defined(__BIONIC__)
 
@@ -154,6 +159,26 @@ static void BM_property_get(benchmark::State& state) {
 }
 BENCHMARK(BM_property_get)->TEST_NUM_PROPS;
 
+// Gets every property at once, as a runtime does at startup.
+static void BM_property_get_batch(benchmark::State& state) {
+  const size_t nprops = state.range_x();
+
+  LocalPropertyTestState pa(nprops);
+  if (!pa.valid) return;
+
+  std::vector<std::string> buffers(nprops, std::string(PROP_VALUE_MAX, '\0'));
+  std::vector<char*> values(nprops);
+  for (size_t i = 0; i < nprops; ++i) {
+    values[i] = &buffers[i][0];
+  }
+
+  while (state.KeepRunning()) {
+    __system_property_get_batch(pa.names, values.data(), nprops);
+  }
+  state.SetItemsProcessed(int64_t(state.iterations()) * int64_t(nprops));
+}
+BENCHMARK(BM_property_get_batch)->TEST_NUM_PROPS;
+
 static void BM_property_find(benchmark::State& state) {
   const size_t nprops = state.range_x();
 
@@ -210,4 +235,225 @@ static void BM_property_serial(benchmark::State& state) {
 }
 BENCHMARK(BM_property_serial)->TEST_NUM_PROPS;
 
+// Polling a property that doesn't change, as a feature flag check would.
+static void BM_property_watch_get(benchmark::State& state) {
+  const size_t nprops = state.range_x();
+
+  LocalPropertyTestState pa(nprops);
+  if (!pa.valid) return;
+
+  prop_watch watch;
+  __system_property_watch_init(&watch, pa.names[random() % nprops]);
+
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(__system_property_watch_get(&watch));
+  }
+}
+BENCHMARK(BM_property_watch_get)->TEST_NUM_PROPS;
+
+// Waiters that each care about one property, while properties change at
+// random. With __system_property_wait_any every update wakes every waiter;
+// with __system_property_wait only the one whose property changed wakes.
+// The label gives the average number of wakeups per update.
+struct PropertyWaiters {
+  struct Waiter {
+    PropertyWaiters* waiters;
+    prop_info* pi;
+    pthread_t thread;
+  };
+
+  PropertyWaiters(LocalPropertyTestState& pa, bool wait_any)
+      : wait_any(wait_any), count(pa.nprops), waiter(new Waiter[count]) {
+    for (size_t i = 0; i < count; ++i) {
+      waiter[i].waiters = this;
+      waiter[i].pi = const_cast<prop_info*>(__system_property_find(pa.names[i]));
+    }
+    for (size_t i = 0; i < count; ++i) {
+      pthread_create(&waiter[i].thread, nullptr, WaiterFn, &waiter[i]);
+    }
+  }
+
+  ~PropertyWaiters() {
+    stop = true;
+    // An update is the only way to get the __system_property_wait_any
+    // waiters to look at the stop flag.
+    __system_property_update(waiter[0].pi, "stop", 4);
+    for (size_t i = 0; i < count; ++i) {
+      pthread_join(waiter[i].thread, nullptr);
+    }
+    delete[] waiter;
+  }
+
+  static void* WaiterFn(void* arg) {
+    Waiter* w = static_cast<Waiter*>(arg);
+    PropertyWaiters* self = w->waiters;
+    if (self->wait_any) {
+      unsigned int serial = __system_property_area_serial();
+      while (!self->stop) {
+        serial = __system_property_wait_any(serial);
+        ++self->wakeups;
+        // A real waiter would now check whether its property changed.
+        __system_property_serial(w->pi);
+      }
+    } else {
+      uint32_t serial = __system_property_serial(w->pi);
+      timespec timeout = { 0, 10000000 };
+      while (!self->stop) {
+        if (__system_property_wait(w->pi, serial, &serial, &timeout)) ++self->wakeups;
+      }
+    }
+    return nullptr;
+  }
+
+  const bool wait_any;
+  const size_t count;
+  Waiter* waiter;
+  std::atomic<bool> stop{false};
+  std::atomic<uint64_t> wakeups{0};
+};
+
+static void BM_property_wait_churn(benchmark::State& state, bool wait_any) {
+  const size_t nprops = state.range_x();
+
+  LocalPropertyTestState pa(nprops);
+  if (!pa.valid) return;
+
+  PropertyWaiters waiters(pa, wait_any);
+  // Give the waiters a chance to start waiting.
+  usleep(10000);
+
+  uint64_t updates = 0;
+  size_t i = 0;
+  while (state.KeepRunning()) {
+    __system_property_update(waiters.waiter[i].pi, pa.values[i], pa.value_lens[i]);
+    ++updates;
+    i = (i + 1) % nprops;
+  }
+  char label[32];
+  snprintf(label, sizeof(label), "%.2f wakeups/update",
+           updates ? static_cast<double>(waiters.wakeups) / updates : 0.0);
+  state.SetLabel(label);
+}
+
+static void BM_property_wait_any_churn(benchmark::State& state) {
+  BM_property_wait_churn(state, true);
+}
+BENCHMARK(BM_property_wait_any_churn)->Arg(1)->Arg(4)->Arg(16)->Arg(64);
+
+static void BM_property_wait_one_churn(benchmark::State& state) {
+  BM_property_wait_churn(state, false);
+}
+BENCHMARK(BM_property_wait_one_churn)->Arg(1)->Arg(4)->Arg(16)->Arg(64);
+
+// Readers on several cores reading the same few properties, with or
+// without a writer updating them as fast as it can. A read that overlaps an
+// update has to wait for it or copy the value again. Only the benchmark
+// thread times its reads, one in kSampleInterval of them; the label has
+// their latency percentiles and how many of them overlapped an update.
+// items/s counts every reader's reads.
+struct PropertyReaders {
+  static constexpr size_t kProps = 8;
+
+  PropertyReaders(LocalPropertyTestState& pa, size_t nreaders, bool with_writer)
+      : pa(pa), threads(nreaders - 1 + (with_writer ? 1 : 0)) {
+    for (size_t i = 0; i < kProps; ++i) {
+      pi[i] = const_cast<prop_info*>(__system_property_find(pa.names[i]));
+    }
+    for (size_t i = 0; i < nreaders - 1; ++i) {
+      pthread_create(&threads[i], nullptr, ReaderFn, this);
+    }
+    if (with_writer) {
+      pthread_create(&threads.back(), nullptr, WriterFn, this);
+    }
+  }
+
+  ~PropertyReaders() {
+    stop = true;
+    for (pthread_t& thread : threads) {
+      pthread_join(thread, nullptr);
+    }
+  }
+
+  static void* ReaderFn(void* arg) {
+    PropertyReaders* self = static_cast<PropertyReaders*>(arg);
+    char value[PROP_VALUE_MAX];
+    uint64_t n = 0;
+    for (size_t i = 0; !self->stop; i = (i + 1) % kProps) {
+      __system_property_read(self->pi[i], nullptr, value);
+      // Counting every read in a shared counter would be a benchmark of its own.
+      if (++n % 256 == 0) self->reads += 256;
+    }
+    return nullptr;
+  }
+
+  static void* WriterFn(void* arg) {
+    PropertyReaders* self = static_cast<PropertyReaders*>(arg);
+    for (size_t i = 0; !self->stop; i = (i + 1) % kProps) {
+      __system_property_update(self->pi[i], self->pa.values[i], self->pa.value_lens[i]);
+    }
+    return nullptr;
+  }
+
+  LocalPropertyTestState& pa;
+  prop_info* pi[kProps];
+  std::vector<pthread_t> threads;
+  std::atomic<bool> stop{false};
+  std::atomic<uint64_t> reads{0};
+};
+
+static void BM_property_read_threaded(benchmark::State& state, bool with_writer) {
+  static constexpr uint64_t kSampleInterval = 16;
+  const size_t nreaders = state.range_x();
+
+  LocalPropertyTestState pa(PropertyReaders::kProps);
+  if (!pa.valid) return;
+
+  PropertyReaders readers(pa, nreaders, with_writer);
+
+  std::vector<int64_t> samples;
+  samples.reserve(1 << 16);
+  uint64_t overlapped = 0;
+  uint64_t n = 0;
+  const uint64_t other_reads = readers.reads;
+  char value[PROP_VALUE_MAX];
+  while (state.KeepRunning()) {
+    const prop_info* pi = readers.pi[n % PropertyReaders::kProps];
+    if (n++ % kSampleInterval != 0) {
+      __system_property_read(pi, nullptr, value);
+      continue;
+    }
+
+    const unsigned int serial = __system_property_serial(pi);
+    timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    __system_property_read(pi, nullptr, value);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    samples.push_back((end.tv_sec - start.tv_sec) * INT64_C(1000000000) +
+                      (end.tv_nsec - start.tv_nsec));
+    if (__system_property_serial(pi) != serial) ++overlapped;
+  }
+  state.SetItemsProcessed(int64_t(n + (readers.reads - other_reads)));
+
+  if (samples.empty()) return;
+  std::sort(samples.begin(), samples.end());
+  auto percentile = [&samples](size_t per_mille) {
+    return static_cast<long long>(samples[(samples.size() - 1) * per_mille / 1000]);
+  };
+  char label[128];
+  snprintf(label, sizeof(label), "p50=%lldns p99=%lldns p99.9=%lldns overlapped=%.3f%%",
+           percentile(500), percentile(990), percentile(999),
+           100.0 * overlapped / samples.size());
+  state.SetLabel(label);
+}
+
+static void BM_property_read_readers(benchmark::State& state) {
+  BM_property_read_threaded(state, false);
+}
+BENCHMARK(BM_property_read_readers)->Arg(1)->Arg(2)->Arg(4)->Arg(8);
+
+static void BM_property_read_readers_writer(benchmark::State& state) {
+  BM_property_read_threaded(state, true);
+}
+BENCHMARK(BM_property_read_readers_writer)->Arg(1)->Arg(2)->Arg(4)->Arg(8);
+
 #endif  // __BIONIC__
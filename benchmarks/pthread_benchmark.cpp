@@ -95,6 +95,42 @@ static void BM_pthread_mutex_lock_RECURSIVE(benchmark::State& state) {
 }
 BENCHMARK(BM_pthread_mutex_lock_RECURSIVE);
 
+static void BM_pthread_mutex_lock_ADAPTIVE(benchmark::State& state) {
+  pthread_mutex_t mutex = PTHREAD_ADAPTIVE_MUTEX_INITIALIZER_NP;
+
+  while (state.KeepRunning()) {
+    pthread_mutex_lock(&mutex);
+    pthread_mutex_unlock(&mutex);
+  }
+}
+BENCHMARK(BM_pthread_mutex_lock_ADAPTIVE);
+
+// Every benchmark thread takes the same mutex around a short critical
+// section, which is where spinning should beat sleeping on the futex.
+static pthread_mutex_t g_contended_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t g_contended_adaptive_mutex = PTHREAD_ADAPTIVE_MUTEX_INITIALIZER_NP;
+static volatile int g_contended_counter;
+
+static void ContendedMutexLoop(benchmark::State& state, pthread_mutex_t* mutex) {
+  while (state.KeepRunning()) {
+    pthread_mutex_lock(mutex);
+    for (int i = 0; i < 16; ++i) {
+      g_contended_counter++;
+    }
+    pthread_mutex_unlock(mutex);
+  }
+}
+
+static void BM_pthread_mutex_lock_contended(benchmark::State& state) {
+  ContendedMutexLoop(state, &g_contended_mutex);
+}
+BENCHMARK(BM_pthread_mutex_lock_contended)->Threads(2)->Threads(4)->Threads(8);
+
+static void BM_pthread_mutex_lock_contended_ADAPTIVE(benchmark::State& state) {
+  ContendedMutexLoop(state, &g_contended_adaptive_mutex);
+}
+BENCHMARK(BM_pthread_mutex_lock_contended_ADAPTIVE)->Threads(2)->Threads(4)->Threads(8);
+
 static void BM_pthread_rwlock_read(benchmark::State& state) {
   pthread_rwlock_t lock;
   pthread_rwlock_init(&lock, NULL);
@@ -108,6 +144,42 @@ static void BM_pthread_rwlock_read(benchmark::State& state) {
 }
 BENCHMARK(BM_pthread_rwlock_read);
 
+// Every benchmark thread read-locks the same rwlock. With the default kind
+// all of them write to the rwlock's state word.
+static void ReadScalingLoop(benchmark::State& state, pthread_rwlock_t* lock) {
+  while (state.KeepRunning()) {
+    pthread_rwlock_rdlock(lock);
+    pthread_rwlock_unlock(lock);
+  }
+}
+
+static void BM_pthread_rwlock_read_contended(benchmark::State& state) {
+  static pthread_rwlock_t lock = PTHREAD_RWLOCK_INITIALIZER;
+  ReadScalingLoop(state, &lock);
+}
+BENCHMARK(BM_pthread_rwlock_read_contended)->Threads(1)->Threads(2)->Threads(4)->Threads(8);
+
+#if defined(__BIONIC__)
+static pthread_rwlock_t* ScalableRwlock() {
+  static pthread_rwlock_t* lock = []() {
+    static pthread_rwlock_t l;
+    pthread_rwlockattr_t attr;
+    pthread_rwlockattr_init(&attr);
+    pthread_rwlockattr_setkind_np(&attr, PTHREAD_RWLOCK_SCALABLE_READERS_NP);
+    pthread_rwlock_init(&l, &attr);
+    pthread_rwlockattr_destroy(&attr);
+    return &l;
+  }();
+  return lock;
+}
+
+static void BM_pthread_rwlock_read_contended_SCALABLE_READERS(benchmark::State& state) {
+  ReadScalingLoop(state, ScalableRwlock());
+}
+BENCHMARK(BM_pthread_rwlock_read_contended_SCALABLE_READERS)
+    ->Threads(1)->Threads(2)->Threads(4)->Threads(8);
+#endif
+
 static void BM_pthread_rwlock_write(benchmark::State& state) {
   pthread_rwlock_t lock;
   pthread_rwlock_init(&lock, NULL);
@@ -0,0 +1,314 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+#include <cxxabi.h>
+
+#include <algorithm>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+// These benchmarks run every benchmark thread against the same lock, for each combination of
+// thread count and critical section length (the argument, in units of one increment of a
+// shared counter). The items/s reported is the total across all threads. The label has the
+// latency percentiles of the blocking call (lock, wait...) seen by the first thread.
+#define CONTENTION_ARGS \
+    Arg(0)->Arg(16)->Arg(256)->Threads(1)->Threads(2)->Threads(4)->Threads(8)->Threads(16)
+
+static volatile int g_shared_counter;
+
+static void CriticalSection(int64_t length) {
+  for (int64_t i = 0; i < length; ++i) {
+    g_shared_counter++;
+  }
+}
+
+// Timing every iteration would mostly measure clock_gettime, so only one in kSampleInterval
+// is timed. The latencies still include the cost of one clock_gettime call.
+class LatencySampler {
+ public:
+  static constexpr int kSampleInterval = 16;
+
+  LatencySampler() : count_(0) {
+    samples_.reserve(1 << 16);
+  }
+
+  bool ShouldSample() {
+    return (count_++ % kSampleInterval) == 0;
+  }
+
+  void Start() {
+    clock_gettime(CLOCK_MONOTONIC, &start_);
+  }
+
+  void Stop() {
+    timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    samples_.push_back((end.tv_sec - start_.tv_sec) * INT64_C(1000000000) +
+                       (end.tv_nsec - start_.tv_nsec));
+  }
+
+  void Report(benchmark::State& state) {
+    state.SetItemsProcessed(state.iterations());
+    if (state.thread_index != 0 || samples_.empty()) {
+      return;
+    }
+    std::sort(samples_.begin(), samples_.end());
+    char label[128];
+    snprintf(label, sizeof(label), "p50=%lldns p90=%lldns p99=%lldns p99.9=%lldns",
+             Percentile(500), Percentile(900), Percentile(990), Percentile(999));
+    state.SetLabel(label);
+  }
+
+ private:
+  long long Percentile(size_t per_mille) {
+    return samples_[(samples_.size() - 1) * per_mille / 1000];
+  }
+
+  uint64_t count_;
+  timespec start_;
+  std::vector<int64_t> samples_;
+};
+
+static void MutexLoop(benchmark::State& state, pthread_mutex_t* mutex) {
+  const int64_t length = state.range_x();
+  LatencySampler sampler;
+  while (state.KeepRunning()) {
+    if (sampler.ShouldSample()) {
+      sampler.Start();
+      pthread_mutex_lock(mutex);
+      sampler.Stop();
+    } else {
+      pthread_mutex_lock(mutex);
+    }
+    CriticalSection(length);
+    pthread_mutex_unlock(mutex);
+  }
+  sampler.Report(state);
+}
+
+static void BM_pthread_contention_mutex_NORMAL(benchmark::State& state) {
+  static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+  MutexLoop(state, &mutex);
+}
+BENCHMARK(BM_pthread_contention_mutex_NORMAL)->CONTENTION_ARGS;
+
+static void BM_pthread_contention_mutex_RECURSIVE(benchmark::State& state) {
+  static pthread_mutex_t mutex = PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP;
+  MutexLoop(state, &mutex);
+}
+BENCHMARK(BM_pthread_contention_mutex_RECURSIVE)->CONTENTION_ARGS;
+
+static void BM_pthread_contention_mutex_ERRORCHECK(benchmark::State& state) {
+  static pthread_mutex_t mutex = PTHREAD_ERRORCHECK_MUTEX_INITIALIZER_NP;
+  MutexLoop(state, &mutex);
+}
+BENCHMARK(BM_pthread_contention_mutex_ERRORCHECK)->CONTENTION_ARGS;
+
+static void BM_pthread_contention_mutex_ADAPTIVE(benchmark::State& state) {
+  static pthread_mutex_t mutex = PTHREAD_ADAPTIVE_MUTEX_INITIALIZER_NP;
+  MutexLoop(state, &mutex);
+}
+BENCHMARK(BM_pthread_contention_mutex_ADAPTIVE)->CONTENTION_ARGS;
+
+static void BM_pthread_contention_mutex_PRIO_INHERIT(benchmark::State& state) {
+  static pthread_mutex_t* mutex = []() {
+    static pthread_mutex_t m;
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_setprotocol(&attr, PTHREAD_PRIO_INHERIT);
+    pthread_mutex_init(&m, &attr);
+    pthread_mutexattr_destroy(&attr);
+    return &m;
+  }();
+  MutexLoop(state, mutex);
+}
+BENCHMARK(BM_pthread_contention_mutex_PRIO_INHERIT)->CONTENTION_ARGS;
+
+// Every thread takes the read lock, except that one in write_interval iterations takes the
+// write lock instead (never, if write_interval is 0).
+static void RwlockLoop(benchmark::State& state, int write_interval) {
+  static pthread_rwlock_t lock = PTHREAD_RWLOCK_INITIALIZER;
+  const int64_t length = state.range_x();
+  LatencySampler sampler;
+  int i = 0;
+  while (state.KeepRunning()) {
+    bool write = (write_interval != 0 && ++i % write_interval == 0);
+    bool sample = sampler.ShouldSample();
+    if (sample) {
+      sampler.Start();
+    }
+    if (write) {
+      pthread_rwlock_wrlock(&lock);
+    } else {
+      pthread_rwlock_rdlock(&lock);
+    }
+    if (sample) {
+      sampler.Stop();
+    }
+    CriticalSection(length);
+    pthread_rwlock_unlock(&lock);
+  }
+  sampler.Report(state);
+}
+
+static void BM_pthread_contention_rwlock_read(benchmark::State& state) {
+  RwlockLoop(state, 0);
+}
+BENCHMARK(BM_pthread_contention_rwlock_read)->CONTENTION_ARGS;
+
+static void BM_pthread_contention_rwlock_read_mostly(benchmark::State& state) {
+  RwlockLoop(state, 16);
+}
+BENCHMARK(BM_pthread_contention_rwlock_read_mostly)->CONTENTION_ARGS;
+
+static void BM_pthread_contention_rwlock_write(benchmark::State& state) {
+  RwlockLoop(state, 1);
+}
+BENCHMARK(BM_pthread_contention_rwlock_write)->CONTENTION_ARGS;
+
+// A condition variable guarding a single token: each iteration waits for the token, holds it
+// for the critical section, then gives it back and wakes the waiters. Every thread gives back
+// the token it took, so no thread can be left waiting when the others finish.
+static void CondLoop(benchmark::State& state, bool broadcast) {
+  static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+  static pthread_cond_t cond = PTHREAD_COND_INITIALIZER;
+  static bool token_taken = false;
+  const int64_t length = state.range_x();
+  LatencySampler sampler;
+  while (state.KeepRunning()) {
+    bool sample = sampler.ShouldSample();
+    if (sample) {
+      sampler.Start();
+    }
+    pthread_mutex_lock(&mutex);
+    while (token_taken) {
+      pthread_cond_wait(&cond, &mutex);
+    }
+    token_taken = true;
+    pthread_mutex_unlock(&mutex);
+    if (sample) {
+      sampler.Stop();
+    }
+
+    CriticalSection(length);
+
+    pthread_mutex_lock(&mutex);
+    token_taken = false;
+    if (broadcast) {
+      pthread_cond_broadcast(&cond);
+    } else {
+      pthread_cond_signal(&cond);
+    }
+    pthread_mutex_unlock(&mutex);
+  }
+  sampler.Report(state);
+}
+
+static void BM_pthread_contention_cond_signal(benchmark::State& state) {
+  CondLoop(state, false);
+}
+BENCHMARK(BM_pthread_contention_cond_signal)->CONTENTION_ARGS;
+
+static void BM_pthread_contention_cond_broadcast(benchmark::State& state) {
+  CondLoop(state, true);
+}
+BENCHMARK(BM_pthread_contention_cond_broadcast)->CONTENTION_ARGS;
+
+// A semaphore with a value of one, used as a lock.
+static void BM_pthread_contention_sem_wait_sem_post(benchmark::State& state) {
+  static sem_t* semaphore = []() {
+    static sem_t s;
+    sem_init(&s, 0, 1);
+    return &s;
+  }();
+  const int64_t length = state.range_x();
+  LatencySampler sampler;
+  while (state.KeepRunning()) {
+    if (sampler.ShouldSample()) {
+      sampler.Start();
+      sem_wait(semaphore);
+      sampler.Stop();
+    } else {
+      sem_wait(semaphore);
+    }
+    CriticalSection(length);
+    sem_post(semaphore);
+  }
+  sampler.Report(state);
+}
+BENCHMARK(BM_pthread_contention_sem_wait_sem_post)->CONTENTION_ARGS;
+
+static void DummyPthreadOnceInitFunction() {
+}
+
+// Only the first call runs the init function, so this measures every thread checking an
+// already-run pthread_once_t.
+static void BM_pthread_contention_once(benchmark::State& state) {
+  static pthread_once_t once = PTHREAD_ONCE_INIT;
+  LatencySampler sampler;
+  while (state.KeepRunning()) {
+    if (sampler.ShouldSample()) {
+      sampler.Start();
+      pthread_once(&once, DummyPthreadOnceInitFunction);
+      sampler.Stop();
+    } else {
+      pthread_once(&once, DummyPthreadOnceInitFunction);
+    }
+  }
+  sampler.Report(state);
+}
+BENCHMARK(BM_pthread_contention_once)
+    ->Threads(1)->Threads(2)->Threads(4)->Threads(8)->Threads(16);
+
+// The C++ ABI's guard functions for function-local statics. libc++abi and libstdc++ disagree
+// about the type of a guard, so use whichever this one says.
+template <typename T> static T GuardType(int (*)(T*));
+typedef decltype(GuardType(__cxxabiv1::__cxa_guard_acquire)) cxa_guard_t;
+using __cxxabiv1::__cxa_guard_acquire;
+using __cxxabiv1::__cxa_guard_abort;
+
+// A function-local static that every thread is waiting on while one constructs it. A guard
+// only goes back to unconstructed when a constructor throws, so __cxa_guard_abort stands in
+// for that and the release, and every iteration is a construction that the other threads
+// have to wait for.
+static void BM_pthread_contention_cxa_guard(benchmark::State& state) {
+  static cxa_guard_t guard;
+  const int64_t length = state.range_x();
+  LatencySampler sampler;
+  while (state.KeepRunning()) {
+    bool sample = sampler.ShouldSample();
+    if (sample) {
+      sampler.Start();
+    }
+    while (__cxa_guard_acquire(&guard) == 0) {
+      // Can't happen: the guard is never released.
+    }
+    if (sample) {
+      sampler.Stop();
+    }
+    CriticalSection(length);
+    __cxa_guard_abort(&guard);
+  }
+  sampler.Report(state);
+}
+BENCHMARK(BM_pthread_contention_cxa_guard)->CONTENTION_ARGS;
@@ -0,0 +1,49 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <regex.h>
+
+#include <benchmark/benchmark.h>
+
+static const char kLine[] =
+    "10-15 12:34:56.789  1234  5678 I ActivityManager: Start proc 4321:com.example/u0a42";
+
+static void RunRegexec(benchmark::State& state, const char* pattern, int cflags, size_t nmatch) {
+  regex_t re;
+  if (regcomp(&re, pattern, cflags) != 0) {
+    state.SkipWithError("regcomp failed");
+    return;
+  }
+  regmatch_t matches[4];
+  while (state.KeepRunning()) {
+    regexec(&re, kLine, nmatch, matches, 0);
+  }
+  regfree(&re);
+}
+
+#define REGEX_BENCHMARK(name, pattern, cflags, nmatch) \
+  static void BM_regex_##name(benchmark::State& state) { \
+    RunRegexec(state, pattern, cflags, nmatch); \
+  } \
+  BENCHMARK(BM_regex_##name)
+
+REGEX_BENCHMARK(literal_miss, "BroadcastQueue", REG_EXTENDED, 0);
+REGEX_BENCHMARK(alternation_miss, "Broadcast|Service|Provider", REG_EXTENDED, 0);
+REGEX_BENCHMARK(alternation_match, "(Process|ActivityManager): Start", REG_EXTENDED, 0);
+REGEX_BENCHMARK(submatches, "Start proc ([0-9]+):([a-z.]+)", REG_EXTENDED, 3);
+REGEX_BENCHMARK(anchored, "^[0-9-]+ [0-9:.]+ +[0-9]+ +[0-9]+ [VDIWEF] ", REG_EXTENDED, 1);
+REGEX_BENCHMARK(icase, "activitymanager", REG_EXTENDED | REG_ICASE, 0);
+REGEX_BENCHMARK(back_reference, "\\([0-9]\\)\\1", 0, 0);
@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <search.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+static int intptr_cmp(const void* lhs, const void* rhs) {
+  intptr_t a = reinterpret_cast<intptr_t>(lhs);
+  intptr_t b = reinterpret_cast<intptr_t>(rhs);
+  return (a > b) - (a < b);
+}
+
+static std::vector<intptr_t> MakeKeys(size_t count, bool sorted) {
+  std::vector<intptr_t> keys(count);
+  srandom(1234);
+  for (size_t i = 0; i < count; ++i) {
+    keys[i] = sorted ? i : random();
+  }
+  return keys;
+}
+
+// Builds a tree, looks every key up, and throws the tree away: the lifetime of a typical
+// symbol table.
+static void RunTsearch(benchmark::State& state, bool sorted) {
+  std::vector<intptr_t> keys = MakeKeys(state.range_x(), sorted);
+  while (state.KeepRunning()) {
+    void* root = nullptr;
+    for (intptr_t key : keys) {
+      tsearch(reinterpret_cast<void*>(key), &root, intptr_cmp);
+    }
+    for (intptr_t key : keys) {
+      benchmark::DoNotOptimize(tfind(reinterpret_cast<void*>(key), &root, intptr_cmp));
+    }
+    tdestroy(root, [](void*) {});
+  }
+  state.SetItemsProcessed(state.iterations() * keys.size());
+}
+
+static void BM_search_tsearch_random(benchmark::State& state) {
+  RunTsearch(state, false);
+}
+BENCHMARK(BM_search_tsearch_random)->Arg(64)->Arg(1024)->Arg(64*1024);
+
+static void BM_search_tsearch_sorted(benchmark::State& state) {
+  RunTsearch(state, true);
+}
+BENCHMARK(BM_search_tsearch_sorted)->Arg(64)->Arg(1024)->Arg(64*1024);
+
+static void BM_search_tdelete(benchmark::State& state) {
+  std::vector<intptr_t> keys = MakeKeys(state.range_x(), false);
+  while (state.KeepRunning()) {
+    void* root = nullptr;
+    for (intptr_t key : keys) {
+      tsearch(reinterpret_cast<void*>(key), &root, intptr_cmp);
+    }
+    for (intptr_t key : keys) {
+      tdelete(reinterpret_cast<void*>(key), &root, intptr_cmp);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * keys.size());
+}
+BENCHMARK(BM_search_tdelete)->Arg(1024)->Arg(64*1024);
+
+static void BM_search_hsearch_r(benchmark::State& state) {
+  size_t count = state.range_x();
+  std::vector<std::string> keys;
+  for (size_t i = 0; i < count; ++i) {
+    keys.push_back("symbol_" + std::to_string(i));
+  }
+  while (state.KeepRunning()) {
+    hsearch_data table;
+    memset(&table, 0, sizeof(table));
+    hcreate_r(count, &table);
+    ENTRY* e;
+    for (const std::string& key : keys) {
+      hsearch_r(ENTRY{const_cast<char*>(key.c_str()), nullptr}, ENTER, &e, &table);
+    }
+    for (const std::string& key : keys) {
+      hsearch_r(ENTRY{const_cast<char*>(key.c_str()), nullptr}, FIND, &e, &table);
+      benchmark::DoNotOptimize(e);
+    }
+    hdestroy_r(&table);
+  }
+  state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK(BM_search_hsearch_r)->Arg(64)->Arg(1024)->Arg(64*1024);
@@ -150,3 +150,31 @@ BENCHMARK_F(SemaphoreFixture, semaphore_sem_post)(benchmark::State& state) {
     sched_setscheduler(0, SCHED_IDLE, &param);
   }
 }
+
+// Producers and consumers passing units through a bounded buffer of kMpmcSlots. Even-numbered
+// benchmark threads produce and odd-numbered ones consume; every thread runs the same number of
+// iterations, so the semaphores are back where they started at the end of each run. The items/s
+// reported is the total across all threads.
+static constexpr unsigned int kMpmcSlots = 4;
+
+static sem_t* MpmcSemaphore(bool items) {
+  static sem_t* semaphores = []() {
+    static sem_t s[2];
+    sem_init(&s[0], 0, 0);
+    sem_init(&s[1], 0, kMpmcSlots);
+    return s;
+  }();
+  return &semaphores[items ? 0 : 1];
+}
+
+static void BM_semaphore_mpmc(benchmark::State& state) {
+  bool producer = (state.thread_index % 2) == 0;
+  sem_t* wait_on = MpmcSemaphore(!producer);
+  sem_t* post_to = MpmcSemaphore(producer);
+  while (state.KeepRunning()) {
+    sem_wait(wait_on);
+    sem_post(post_to);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_semaphore_mpmc)->Threads(2)->Threads(4)->Threads(8)->Threads(16);
@@ -0,0 +1,134 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/msg.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <benchmark/benchmark.h>
+
+// A stream of messages of state.range(0) bytes to a child process that reads each of them.
+
+static constexpr size_t kMaxMessageSize = 512;
+
+struct StreamMessage {
+  long type;  // For msgsnd.
+  uint32_t last;
+  char data[kMaxMessageSize];
+};
+
+static void WaitForChild(benchmark::State& state, pid_t pid) {
+  int status;
+  if (waitpid(pid, &status, 0) != pid || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+    state.SkipWithError("child failed");
+  }
+}
+
+static void BM_msg_stream(benchmark::State& state) {
+  int id = msgget(IPC_PRIVATE, IPC_CREAT | 0600);
+  if (id == -1) {
+    state.SkipWithError("msgget failed");
+    return;
+  }
+  size_t size = state.range(0);
+  size_t payload_size = offsetof(StreamMessage, data) - sizeof(long) + size;
+
+  pid_t pid = fork();
+  if (pid == 0) {
+    StreamMessage message;
+    char sink[kMaxMessageSize];
+    do {
+      if (msgrcv(id, &message, sizeof(message) - sizeof(long), 0, 0) == -1) _exit(1);
+      memcpy(sink, message.data, size);
+      benchmark::DoNotOptimize(sink);
+    } while (!message.last);
+    _exit(0);
+  }
+
+  StreamMessage message;
+  message.type = 1;
+  message.last = 0;
+  memset(message.data, 'x', size);
+  while (state.KeepRunning()) {
+    msgsnd(id, &message, payload_size, 0);
+  }
+  message.last = 1;
+  msgsnd(id, &message, payload_size, 0);
+  WaitForChild(state, pid);
+  msgctl(id, IPC_RMID, nullptr);
+  state.SetBytesProcessed(state.iterations() * size);
+}
+BENCHMARK(BM_msg_stream)->Arg(8)->Arg(64)->Arg(512);
+
+#if defined(__BIONIC__)
+#include <android/shm_queue.h>
+
+static void ShmQueueStream(benchmark::State& state, int flags) {
+  android_shm_queue* queue = android_shm_queue_create(sizeof(StreamMessage), 256, flags);
+  if (queue == nullptr) {
+    state.SkipWithError("android_shm_queue_create failed");
+    return;
+  }
+  size_t size = state.range(0);
+
+  pid_t pid = fork();
+  if (pid == 0) {
+    char sink[kMaxMessageSize];
+    uint32_t last;
+    do {
+      size_t message_size;
+      StreamMessage* message = reinterpret_cast<StreamMessage*>(
+          android_shm_queue_receive(queue, &message_size, nullptr));
+      if (message == nullptr) _exit(1);
+      memcpy(sink, message->data, size);
+      benchmark::DoNotOptimize(sink);
+      last = message->last;
+      android_shm_queue_release(queue, message);
+    } while (!last);
+    _exit(0);
+  }
+
+  // The message is built in the queue, where msgsnd would have copied it from.
+  while (state.KeepRunning()) {
+    StreamMessage* message =
+        reinterpret_cast<StreamMessage*>(android_shm_queue_reserve(queue, nullptr));
+    message->last = 0;
+    memset(message->data, 'x', size);
+    android_shm_queue_commit(queue, message, offsetof(StreamMessage, data) + size);
+  }
+  StreamMessage* message =
+      reinterpret_cast<StreamMessage*>(android_shm_queue_reserve(queue, nullptr));
+  message->last = 1;
+  android_shm_queue_commit(queue, message, offsetof(StreamMessage, data));
+  WaitForChild(state, pid);
+  android_shm_queue_close(queue);
+  state.SetBytesProcessed(state.iterations() * size);
+}
+
+static void BM_shm_queue_stream(benchmark::State& state) {
+  ShmQueueStream(state, 0);
+}
+BENCHMARK(BM_shm_queue_stream)->Arg(8)->Arg(64)->Arg(512);
+
+static void BM_shm_queue_stream_spsc(benchmark::State& state) {
+  ShmQueueStream(state, ANDROID_SHM_QUEUE_SPSC);
+}
+BENCHMARK(BM_shm_queue_stream_spsc)->Arg(8)->Arg(64)->Arg(512);
+#endif
@@ -0,0 +1,206 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <netinet/in.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+// UDP over loopback. The first argument is the datagram size, the second how many datagrams are
+// sent and received per iteration, which is also the batch size for sendmmsg and recvmmsg.
+class UdpPair {
+ public:
+  UdpPair(size_t size, size_t count) : buffers_(count, std::vector<char>(size, 'x')) {
+    receiver_ = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    sender_ = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+
+    // Big enough that a whole batch is never dropped, and a time limit so that a benchmark
+    // fails instead of hanging if one is.
+    int rcvbuf = 4 << 20;
+    setsockopt(receiver_, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+    timeval tv = { 1, 0 };
+    setsockopt(receiver_, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t addr_len = sizeof(addr);
+    ok_ = receiver_ != -1 && sender_ != -1 &&
+          bind(receiver_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0 &&
+          getsockname(receiver_, reinterpret_cast<sockaddr*>(&addr), &addr_len) == 0 &&
+          connect(sender_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0;
+
+    iovs_.resize(count);
+    msgs_.resize(count);
+    for (size_t i = 0; i < count; i++) {
+      iovs_[i].iov_base = buffers_[i].data();
+      iovs_[i].iov_len = size;
+      memset(&msgs_[i], 0, sizeof(msgs_[i]));
+      msgs_[i].msg_hdr.msg_iov = &iovs_[i];
+      msgs_[i].msg_hdr.msg_iovlen = 1;
+    }
+  }
+  ~UdpPair() {
+    close(receiver_);
+    close(sender_);
+  }
+
+  bool ok() { return ok_; }
+
+  bool SendBatch() {
+    return sendmmsg(sender_, msgs_.data(), msgs_.size(), 0) == static_cast<int>(msgs_.size());
+  }
+
+  bool SendEach() {
+    for (auto& buffer : buffers_) {
+      if (send(sender_, buffer.data(), buffer.size(), 0) != static_cast<ssize_t>(buffer.size())) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  bool ReceiveBatch() {
+    size_t received = 0;
+    while (received < msgs_.size()) {
+      int n = recvmmsg(receiver_, &msgs_[received], msgs_.size() - received, 0, nullptr);
+      if (n <= 0) return false;
+      received += n;
+    }
+    return true;
+  }
+
+  bool ReceiveEach() {
+    for (auto& buffer : buffers_) {
+      sockaddr_in from;
+      socklen_t from_len = sizeof(from);
+      if (recvfrom(receiver_, buffer.data(), buffer.size(), 0, reinterpret_cast<sockaddr*>(&from),
+                   &from_len) != static_cast<ssize_t>(buffer.size())) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  size_t bytes() { return buffers_.size() * buffers_[0].size(); }
+
+ private:
+  int receiver_;
+  int sender_;
+  bool ok_;
+  std::vector<std::vector<char>> buffers_;
+  std::vector<iovec> iovs_;
+  std::vector<mmsghdr> msgs_;
+};
+
+static void UdpArgs(benchmark::internal::Benchmark* b) {
+  for (int size : { 64, 512, 1400 }) {
+    for (int count : { 1, 8, 32 }) {
+      b->ArgPair(size, count);
+    }
+  }
+}
+
+// The send side is the same batched sendmmsg for both, so the difference is the receive side.
+static void BM_socket_udp_recvfrom(benchmark::State& state) {
+  UdpPair udp(state.range(0), state.range(1));
+  if (!udp.ok()) {
+    state.SkipWithError("couldn't set up the sockets");
+    return;
+  }
+  while (state.KeepRunning()) {
+    if (!udp.SendBatch() || !udp.ReceiveEach()) {
+      state.SkipWithError("datagram lost");
+      break;
+    }
+  }
+  state.SetBytesProcessed(int64_t(state.iterations()) * int64_t(udp.bytes()));
+  state.SetItemsProcessed(int64_t(state.iterations()) * state.range(1));
+}
+BENCHMARK(BM_socket_udp_recvfrom)->Apply(UdpArgs);
+
+static void BM_socket_udp_recvmmsg(benchmark::State& state) {
+  UdpPair udp(state.range(0), state.range(1));
+  if (!udp.ok()) {
+    state.SkipWithError("couldn't set up the sockets");
+    return;
+  }
+  while (state.KeepRunning()) {
+    if (!udp.SendBatch() || !udp.ReceiveBatch()) {
+      state.SkipWithError("datagram lost");
+      break;
+    }
+  }
+  state.SetBytesProcessed(int64_t(state.iterations()) * int64_t(udp.bytes()));
+  state.SetItemsProcessed(int64_t(state.iterations()) * state.range(1));
+}
+BENCHMARK(BM_socket_udp_recvmmsg)->Apply(UdpArgs);
+
+// And the other way round: the receive side is the same batched recvmmsg for both.
+static void BM_socket_udp_send(benchmark::State& state) {
+  UdpPair udp(state.range(0), state.range(1));
+  if (!udp.ok()) {
+    state.SkipWithError("couldn't set up the sockets");
+    return;
+  }
+  while (state.KeepRunning()) {
+    if (!udp.SendEach() || !udp.ReceiveBatch()) {
+      state.SkipWithError("datagram lost");
+      break;
+    }
+  }
+  state.SetBytesProcessed(int64_t(state.iterations()) * int64_t(udp.bytes()));
+  state.SetItemsProcessed(int64_t(state.iterations()) * state.range(1));
+}
+BENCHMARK(BM_socket_udp_send)->Apply(UdpArgs);
+
+static void BM_socket_udp_sendmmsg(benchmark::State& state) {
+  UdpPair udp(state.range(0), state.range(1));
+  if (!udp.ok()) {
+    state.SkipWithError("couldn't set up the sockets");
+    return;
+  }
+  while (state.KeepRunning()) {
+    if (!udp.SendBatch() || !udp.ReceiveBatch()) {
+      state.SkipWithError("datagram lost");
+      break;
+    }
+  }
+  state.SetBytesProcessed(int64_t(state.iterations()) * int64_t(udp.bytes()));
+  state.SetItemsProcessed(int64_t(state.iterations()) * state.range(1));
+}
+BENCHMARK(BM_socket_udp_sendmmsg)->Apply(UdpArgs);
+
+// socket() goes through netd_client, which marks AF_INET and AF_INET6 sockets for the selected
+// network. Compare with AF_UNIX, which is never marked, to see what that costs.
+static void BM_socket_create(benchmark::State& state) {
+  int domain = state.range(0);
+  while (state.KeepRunning()) {
+    int fd = socket(domain, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd == -1) {
+      state.SkipWithError("socket failed");
+      break;
+    }
+    close(fd);
+  }
+}
+BENCHMARK(BM_socket_create)->Arg(AF_UNIX)->Arg(AF_INET)->Arg(AF_INET6);
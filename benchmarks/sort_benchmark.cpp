@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+enum Pattern {
+  kRandom,
+  kSorted,
+  kReversed,
+  kFewUnique,
+};
+
+// Elements are a 32-bit key padded out to Size bytes, so the same inputs exercise each of
+// qsort's swap paths.
+template <size_t Size>
+struct Element {
+  uint32_t key;
+  char padding[Size - sizeof(uint32_t)];
+};
+
+template <>
+struct Element<sizeof(uint32_t)> {
+  uint32_t key;
+};
+
+template <size_t Size>
+static int CompareElements(const void* lhs, const void* rhs) {
+  uint32_t a = reinterpret_cast<const Element<Size>*>(lhs)->key;
+  uint32_t b = reinterpret_cast<const Element<Size>*>(rhs)->key;
+  return (a > b) - (a < b);
+}
+
+template <size_t Size>
+static std::vector<Element<Size>> MakeInput(size_t count, Pattern pattern) {
+  std::vector<Element<Size>> result(count);
+  srandom(1234);
+  for (size_t i = 0; i < count; ++i) {
+    uint32_t key;
+    switch (pattern) {
+      case kRandom: key = random(); break;
+      case kSorted: key = i; break;
+      case kReversed: key = count - i; break;
+      case kFewUnique: key = random() % 16; break;
+    }
+    memset(&result[i], 0, sizeof(result[i]));
+    result[i].key = key;
+  }
+  return result;
+}
+
+// Each iteration sorts a fresh copy of the input; the copy is cheap next to the sort.
+template <size_t Size>
+static void RunQsort(benchmark::State& state, Pattern pattern) {
+  size_t count = state.range_x();
+  std::vector<Element<Size>> input = MakeInput<Size>(count, pattern);
+  std::vector<Element<Size>> work(count);
+  while (state.KeepRunning()) {
+    memcpy(work.data(), input.data(), count * Size);
+    qsort(work.data(), count, Size, CompareElements<Size>);
+  }
+  state.SetItemsProcessed(state.iterations() * count);
+}
+
+#define SORT_BENCHMARK(size, pattern) \
+  static void BM_qsort_##size##_##pattern(benchmark::State& state) { \
+    RunQsort<size>(state, k##pattern); \
+  } \
+  BENCHMARK(BM_qsort_##size##_##pattern)->Arg(16)->Arg(1024)->Arg(64*1024)
+
+SORT_BENCHMARK(4, Random);
+SORT_BENCHMARK(4, Sorted);
+SORT_BENCHMARK(4, Reversed);
+SORT_BENCHMARK(4, FewUnique);
+SORT_BENCHMARK(8, Random);
+SORT_BENCHMARK(16, Random);
+SORT_BENCHMARK(16, FewUnique);
+SORT_BENCHMARK(24, Random);
+SORT_BENCHMARK(64, Random);
@@ -0,0 +1,235 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <pthread.h>
+#include <spawn.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#if defined(__GLIBC__)
+#define BIN_DIR "/bin/"
+#else
+#define BIN_DIR "/system/bin/"
+#endif
+
+static char* const kTrueArgv[] = { const_cast<char*>("true"), nullptr };
+
+// The argument is how many MiB of touched anonymous memory the parent has. fork has to copy the
+// page tables for all of it, which posix_spawn doesn't.
+class ParentMemory {
+ public:
+  explicit ParentMemory(size_t mib) : size_(mib << 20) {
+    if (size_ == 0) return;
+    p_ = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p_ == MAP_FAILED) abort();
+    memset(p_, 1, size_);
+  }
+  ~ParentMemory() {
+    if (size_ != 0) munmap(p_, size_);
+  }
+
+ private:
+  size_t size_;
+  void* p_ = nullptr;
+};
+
+static void BM_spawn_fork_exec(benchmark::State& state) {
+  ParentMemory memory(state.range_x());
+  while (state.KeepRunning()) {
+    pid_t pid = fork();
+    if (pid == 0) {
+      execv(BIN_DIR "true", kTrueArgv);
+      _exit(127);
+    }
+    waitpid(pid, nullptr, 0);
+  }
+}
+BENCHMARK(BM_spawn_fork_exec)->Arg(0)->Arg(64)->Arg(1024);
+
+static void BM_spawn_posix_spawn(benchmark::State& state) {
+  ParentMemory memory(state.range_x());
+  while (state.KeepRunning()) {
+    pid_t pid;
+    if (posix_spawn(&pid, BIN_DIR "true", nullptr, nullptr, kTrueArgv, nullptr) != 0) abort();
+    waitpid(pid, nullptr, 0);
+  }
+}
+BENCHMARK(BM_spawn_posix_spawn)->Arg(0)->Arg(64)->Arg(1024);
+
+// The first argument is how many MiB the parent has malloc()ed in small blocks, the second how
+// many threads did the allocating and are still alive (blocked) while the parent forks. That's
+// the shape of a pre-forking server: the atfork handlers lock every malloc arena and cache that
+// those threads touched, and fork copies the page tables of the whole heap.
+class ParentHeap {
+ public:
+  ParentHeap(size_t mib, size_t thread_count) {
+    size_t blocks_per_thread = (mib << 20) / kBlockSize / thread_count;
+    for (size_t i = 0; i < thread_count; i++) {
+      threads_.emplace_back([this, blocks_per_thread]() {
+        std::vector<void*> blocks;
+        for (size_t j = 0; j < blocks_per_thread; j++) {
+          void* p = malloc(kBlockSize);
+          memset(p, 1, kBlockSize);
+          blocks.push_back(p);
+        }
+        std::unique_lock<std::mutex> lock(mutex_);
+        ++ready_;
+        cv_.notify_all();
+        cv_.wait(lock, [this]() { return done_; });
+        for (void* p : blocks) free(p);
+      });
+    }
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [this, thread_count]() { return ready_ == thread_count; });
+  }
+  ~ParentHeap() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      done_ = true;
+    }
+    cv_.notify_all();
+    for (auto& thread : threads_) thread.join();
+  }
+
+ private:
+  static constexpr size_t kBlockSize = 256;
+
+  std::vector<std::thread> threads_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  size_t ready_ = 0;
+  bool done_ = false;
+};
+
+static void BM_spawn_fork_latency(benchmark::State& state) {
+  ParentHeap heap(state.range_x(), state.range_y());
+  while (state.KeepRunning()) {
+    pid_t pid = fork();
+    if (pid == 0) _exit(0);
+    waitpid(pid, nullptr, 0);
+  }
+}
+BENCHMARK(BM_spawn_fork_latency)
+    ->ArgPair(0, 1)->ArgPair(64, 1)->ArgPair(512, 1)
+    ->ArgPair(64, 16)->ArgPair(512, 16)->ArgPair(512, 128);
+
+// Whether a /proc/self/smaps mapping belongs to libc or the dynamic linker, for either bionic
+// or glibc. The anonymous mapping right after a library's file mappings is its .bss.
+enum MappingOwner { kOwnerNone, kOwnerLibc, kOwnerLinker };
+
+static MappingOwner OwnerOf(const char* path, MappingOwner previous) {
+  if (strstr(path, "/libc.so") != nullptr || strstr(path, "/libc-") != nullptr) return kOwnerLibc;
+  if (strstr(path, "/linker") != nullptr || strstr(path, "/ld-") != nullptr) return kOwnerLinker;
+  if (*path == '\0' || strcmp(path, "[anon:.bss]") == 0) return previous;
+  return kOwnerNone;
+}
+
+// The kB of libc's and the linker's pages this process has its own copies of.
+struct PrivateDirty {
+  size_t libc_kb;
+  size_t linker_kb;
+};
+
+static PrivateDirty ReadPrivateDirty() {
+  PrivateDirty result = { 0, 0 };
+  FILE* fp = fopen("/proc/self/smaps", "re");
+  if (fp == nullptr) return result;
+  MappingOwner owner = kOwnerNone;
+  MappingOwner file_owner = kOwnerNone;
+  char line[512];
+  while (fgets(line, sizeof(line), fp) != nullptr) {
+    line[strcspn(line, "\n")] = '\0';
+    unsigned long start, end;
+    int path_offset = 0;
+    size_t kb;
+    if (sscanf(line, "%lx-%lx %*s %*s %*s %*s %n", &start, &end, &path_offset) == 2 &&
+        path_offset != 0) {
+      owner = OwnerOf(line + path_offset, file_owner);
+      file_owner = (line[path_offset] == '/') ? owner : kOwnerNone;
+    } else if (sscanf(line, "Private_Dirty: %zu kB", &kb) == 1) {
+      if (owner == kOwnerLibc) result.libc_kb += kb;
+      if (owner == kOwnerLinker) result.linker_kb += kb;
+    }
+  }
+  fclose(fp);
+  return result;
+}
+
+static void* DoNothing(void*) {
+  return nullptr;
+}
+
+// How much of libc and the linker a forked child of a warm parent copies: each page with a
+// global the child writes costs a private copy. The child does what short-lived workers tend to:
+// starts a thread, uses stdio, and looks at its environment.
+static void BM_spawn_fork_child_private_dirty(benchmark::State& state) {
+  // Warm the parent up the same way, so the child only copies what it writes, not what its
+  // parent hadn't touched yet.
+  pthread_t thread;
+  pthread_create(&thread, nullptr, DoNothing, nullptr);
+  pthread_join(thread, nullptr);
+
+  PrivateDirty total = { 0, 0 };
+  while (state.KeepRunning()) {
+    int fds[2];
+    if (pipe(fds) == -1) {
+      state.SkipWithError("pipe failed");
+      break;
+    }
+    pid_t pid = fork();
+    if (pid == 0) {
+      close(fds[0]);
+      pthread_t child_thread;
+      pthread_create(&child_thread, nullptr, DoNothing, nullptr);
+      pthread_join(child_thread, nullptr);
+      FILE* fp = fopen("/dev/null", "we");
+      if (fp != nullptr) {
+        fprintf(fp, "%s %d\n", getenv("PATH"), getpid());
+        fclose(fp);
+      }
+      PrivateDirty dirty = ReadPrivateDirty();
+      _exit(write(fds[1], &dirty, sizeof(dirty)) == sizeof(dirty) ? 0 : 1);
+    }
+    close(fds[1]);
+    PrivateDirty dirty;
+    if (read(fds[0], &dirty, sizeof(dirty)) == sizeof(dirty)) {
+      total.libc_kb += dirty.libc_kb;
+      total.linker_kb += dirty.linker_kb;
+    }
+    close(fds[0]);
+    waitpid(pid, nullptr, 0);
+  }
+
+  if (state.iterations() > 0) {
+    char label[64];
+    snprintf(label, sizeof(label), "libc=%zukB linker=%zukB", total.libc_kb / state.iterations(),
+             total.linker_kb / state.iterations());
+    state.SetLabel(label);
+  }
+}
+BENCHMARK(BM_spawn_fork_child_private_dirty);
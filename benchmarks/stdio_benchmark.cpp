@@ -18,6 +18,8 @@
 #include <stdio_ext.h>
 #include <stdlib.h>
 
+#include <string>
+
 #include <benchmark/benchmark.h>
 
 constexpr auto KB = 1024;
@@ -50,7 +52,27 @@ void ReadWriteTest(benchmark::State& state, Fn f, bool buffered) {
 void BM_stdio_fread(benchmark::State& state) {
   ReadWriteTest(state, fread, true);
 }
-BENCHMARK(BM_stdio_fread)->AT_COMMON_SIZES;
+BENCHMARK(BM_stdio_fread)->AT_COMMON_SIZES->Arg(256*KB)->Arg(1024*KB);
+
+// A read larger than the buffer followed by small reads, like reading a record's payload and
+// then the next record's header. The large read should refill the buffer for the small ones.
+void BM_stdio_fread_large_then_small(benchmark::State& state) {
+  size_t chunk_size = state.range_x();
+
+  FILE* fp = fopen("/dev/zero", "re");
+  __fsetlocking(fp, FSETLOCKING_BYCALLER);
+  char* buf = new char[chunk_size];
+
+  while (state.KeepRunning()) {
+    fread(buf, chunk_size, 1, fp);
+    fread(buf, 16, 1, fp);
+  }
+
+  state.SetBytesProcessed(int64_t(state.iterations()) * int64_t(chunk_size + 16));
+  delete[] buf;
+  fclose(fp);
+}
+BENCHMARK(BM_stdio_fread_large_then_small)->Arg(16*KB)->Arg(64*KB)->Arg(256*KB);
 
 void BM_stdio_fwrite(benchmark::State& state) {
   ReadWriteTest(state, fwrite, true);
@@ -86,3 +108,123 @@ void BM_stdio_fopen_fgets_fclose_no_locking(benchmark::State& state) {
   FopenFgetsFclose(state, true);
 }
 BENCHMARK(BM_stdio_fopen_fgets_fclose_no_locking);
+
+// Reads lines of the given length from a few MiB of them, like scanning a log file.
+void BM_stdio_getline(benchmark::State& state) {
+  size_t line_length = state.range_x();
+
+  FILE* fp = tmpfile();
+  __fsetlocking(fp, FSETLOCKING_BYCALLER);
+  std::string line(line_length - 1, 'x');
+  line += '\n';
+  for (size_t n = 0; n < 4 * KB * KB; n += line_length) {
+    fputs(line.c_str(), fp);
+  }
+  rewind(fp);
+
+  char* buf = nullptr;
+  size_t buf_size = 0;
+  while (state.KeepRunning()) {
+    if (getline(&buf, &buf_size, fp) == -1) {
+      rewind(fp);
+    }
+  }
+
+  state.SetBytesProcessed(int64_t(state.iterations()) * int64_t(line_length));
+  free(buf);
+  fclose(fp);
+}
+BENCHMARK(BM_stdio_getline)->Arg(16)->Arg(80)->Arg(1*KB)->Arg(64*KB)->Arg(1024*KB);
+
+void BM_stdio_snprintf_d(benchmark::State& state) {
+  char buf[BUFSIZ];
+  int i = 0;
+  while (state.KeepRunning()) {
+    snprintf(buf, sizeof(buf), "%d", 123456 + (i++ & 0xff));
+  }
+}
+BENCHMARK(BM_stdio_snprintf_d);
+
+void BM_stdio_snprintf_s(benchmark::State& state) {
+  char buf[BUFSIZ];
+  while (state.KeepRunning()) {
+    snprintf(buf, sizeof(buf), "%s", "/system/lib64/libc.so");
+  }
+}
+BENCHMARK(BM_stdio_snprintf_s);
+
+void BM_stdio_snprintf_lu_x(benchmark::State& state) {
+  char buf[BUFSIZ];
+  unsigned long i = 0;
+  while (state.KeepRunning()) {
+    snprintf(buf, sizeof(buf), "%lu %08x", 4000000000UL + i, static_cast<unsigned>(i));
+    ++i;
+  }
+}
+BENCHMARK(BM_stdio_snprintf_lu_x);
+
+// A typical log line: a tag, a pid and tid, and a message with a couple of integers.
+void BM_stdio_snprintf_log_line(benchmark::State& state) {
+  char buf[BUFSIZ];
+  int i = 0;
+  while (state.KeepRunning()) {
+    snprintf(buf, sizeof(buf), "%s(%d:%d): %s: batch %u of %zu, %ld bytes", "bionic", 1234, 5678,
+             "worker", i, static_cast<size_t>(64), 4096L * i);
+    ++i;
+  }
+}
+BENCHMARK(BM_stdio_snprintf_log_line);
+
+void BM_stdio_snprintf_f(benchmark::State& state) {
+  char buf[BUFSIZ];
+  while (state.KeepRunning()) {
+    snprintf(buf, sizeof(buf), "%f", 1234.5678);
+  }
+}
+BENCHMARK(BM_stdio_snprintf_f);
+
+void BM_stdio_snprintf_e(benchmark::State& state) {
+  char buf[BUFSIZ];
+  while (state.KeepRunning()) {
+    snprintf(buf, sizeof(buf), "%e", 1234.5678);
+  }
+}
+BENCHMARK(BM_stdio_snprintf_e);
+
+void BM_stdio_snprintf_g(benchmark::State& state) {
+  char buf[BUFSIZ];
+  while (state.KeepRunning()) {
+    snprintf(buf, sizeof(buf), "%g", 1234.5678);
+  }
+}
+BENCHMARK(BM_stdio_snprintf_g);
+
+// The precision that round-trips any double.
+void BM_stdio_snprintf_17g(benchmark::State& state) {
+  char buf[BUFSIZ];
+  while (state.KeepRunning()) {
+    snprintf(buf, sizeof(buf), "%.17g", 0.1);
+  }
+}
+BENCHMARK(BM_stdio_snprintf_17g);
+
+// Needs more digits than the fast path produces, so it always uses gdtoa.
+void BM_stdio_snprintf_f_huge(benchmark::State& state) {
+  char buf[BUFSIZ];
+  while (state.KeepRunning()) {
+    snprintf(buf, sizeof(buf), "%f", 1e300);
+  }
+}
+BENCHMARK(BM_stdio_snprintf_f_huge);
+
+void BM_stdio_fprintf_log_line(benchmark::State& state) {
+  FILE* fp = fopen("/dev/null", "we");
+  int i = 0;
+  while (state.KeepRunning()) {
+    fprintf(fp, "%s(%d:%d): %s: batch %u of %zu, %ld bytes\n", "bionic", 1234, 5678, "worker", i,
+            static_cast<size_t>(64), 4096L * i);
+    ++i;
+  }
+  fclose(fp);
+}
+BENCHMARK(BM_stdio_fprintf_log_line);
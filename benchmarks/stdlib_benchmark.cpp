@@ -0,0 +1,198 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <limits.h>
+#include <locale.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <wchar.h>
+
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+void BM_stdlib_strtod(benchmark::State& state) {
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(strtod("1234.5678", nullptr));
+  }
+}
+BENCHMARK(BM_stdlib_strtod);
+
+// What %.17g prints, to round-trip a double.
+void BM_stdlib_strtod_17g(benchmark::State& state) {
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(strtod("0.10000000000000001", nullptr));
+  }
+}
+BENCHMARK(BM_stdlib_strtod_17g);
+
+void BM_stdlib_strtod_exponent(benchmark::State& state) {
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(strtod("6.02214076e23", nullptr));
+  }
+}
+BENCHMARK(BM_stdlib_strtod_exponent);
+
+// Too many digits to decide from the first 19, so it always uses gdtoa.
+void BM_stdlib_strtod_long(benchmark::State& state) {
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(strtod("9007199254740993.000000000000000000000000000001", nullptr));
+  }
+}
+BENCHMARK(BM_stdlib_strtod_long);
+
+void BM_stdlib_strtof(benchmark::State& state) {
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(strtof("1234.5678", nullptr));
+  }
+}
+BENCHMARK(BM_stdlib_strtof);
+
+void BM_stdlib_sscanf_f(benchmark::State& state) {
+  while (state.KeepRunning()) {
+    double d;
+    sscanf("1234.5678", "%lf", &d);
+    benchmark::DoNotOptimize(d);
+  }
+}
+BENCHMARK(BM_stdlib_sscanf_f);
+
+// A mix of plain ASCII and multibyte UTF-8, in the proportions of typical
+// text with some accented or CJK words in it.
+static std::string MakeUtf8Text(size_t length) {
+  static const char* words[] = { "hello ", "world ", "caf\xc3\xa9 ", "\xe6\x97\xa5\xe6\x9c\xac ",
+                                 "android ", "bionic " };
+  std::string result;
+  for (size_t i = 0; result.size() < length; ++i) {
+    result += (i % 8 == 3) ? words[2 + (i / 8) % 2] : words[(i % 2) ? 1 : 4 + (i / 2) % 2];
+  }
+  return result;
+}
+
+void BM_stdlib_mbstowcs_ascii(benchmark::State& state) {
+  setlocale(LC_CTYPE, "C.UTF-8");
+  std::string text(state.range(0), 'x');
+  std::vector<wchar_t> out(text.size() + 1);
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(mbstowcs(out.data(), text.c_str(), out.size()));
+  }
+  state.SetBytesProcessed(int64_t(state.iterations()) * int64_t(text.size()));
+}
+BENCHMARK(BM_stdlib_mbstowcs_ascii)->Arg(64)->Arg(4096);
+
+void BM_stdlib_mbstowcs_utf8(benchmark::State& state) {
+  setlocale(LC_CTYPE, "C.UTF-8");
+  std::string text = MakeUtf8Text(state.range(0));
+  std::vector<wchar_t> out(text.size() + 1);
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(mbstowcs(out.data(), text.c_str(), out.size()));
+  }
+  state.SetBytesProcessed(int64_t(state.iterations()) * int64_t(text.size()));
+}
+BENCHMARK(BM_stdlib_mbstowcs_utf8)->Arg(64)->Arg(4096);
+
+// A path of state.range(0) directories below a temporary directory, with a "." and a ".."
+// component along the way, as builds generate.
+void BM_stdlib_realpath(benchmark::State& state) {
+  char base[64];
+  snprintf(base, sizeof(base), "/data/local/tmp/realpath_benchmark.XXXXXX");
+  if (mkdtemp(base) == nullptr) {
+    snprintf(base, sizeof(base), "/tmp/realpath_benchmark.XXXXXX");
+    if (mkdtemp(base) == nullptr) {
+      state.SkipWithError("couldn't create a temporary directory");
+      return;
+    }
+  }
+  std::vector<std::string> dirs;
+  std::string path = base;
+  for (int i = 0; i < state.range(0); ++i) {
+    path += "/dir" + std::to_string(i);
+    mkdir(path.c_str(), 0700);
+    dirs.push_back(path);
+  }
+  path = base + std::string("/dir0/./dir1/..") + path.substr(strlen(base) + strlen("/dir0"));
+
+  char resolved[PATH_MAX];
+  while (state.KeepRunning()) {
+    if (realpath(path.c_str(), resolved) == nullptr) {
+      state.SkipWithError("realpath failed");
+      break;
+    }
+  }
+
+  for (auto it = dirs.rbegin(); it != dirs.rend(); ++it) {
+    rmdir(it->c_str());
+  }
+  rmdir(base);
+}
+BENCHMARK(BM_stdlib_realpath)->Arg(2)->Arg(8)->Arg(32);
+
+void BM_stdlib_wcstombs_utf8(benchmark::State& state) {
+  setlocale(LC_CTYPE, "C.UTF-8");
+  std::string text = MakeUtf8Text(state.range(0));
+  std::vector<wchar_t> wide(text.size() + 1);
+  mbstowcs(wide.data(), text.c_str(), wide.size());
+  std::vector<char> out(text.size() + 1);
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(wcstombs(out.data(), wide.data(), out.size()));
+  }
+  state.SetBytesProcessed(int64_t(state.iterations()) * int64_t(text.size()));
+}
+BENCHMARK(BM_stdlib_wcstombs_utf8)->Arg(64)->Arg(4096);
+
+// MB_CUR_MAX is a function call that depends on the calling thread's locale, and code
+// converting a character at a time often evaluates it for each one.
+void BM_stdlib_mb_cur_max(benchmark::State& state) {
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(MB_CUR_MAX);
+  }
+}
+BENCHMARK(BM_stdlib_mb_cur_max);
+
+void BM_stdlib_mb_cur_max_uselocale(benchmark::State& state) {
+  locale_t c_locale = newlocale(LC_ALL, "C", 0);
+  locale_t old_locale = uselocale(c_locale);
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(MB_CUR_MAX);
+  }
+  uselocale(old_locale);
+  freelocale(c_locale);
+}
+BENCHMARK(BM_stdlib_mb_cur_max_uselocale);
+
+#if defined(__BIONIC__)
+// With more than one thread, these show whether the threads' generators are independent.
+void BM_stdlib_arc4random(benchmark::State& state) {
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(arc4random());
+  }
+}
+BENCHMARK(BM_stdlib_arc4random)->Threads(1)->Threads(4)->Threads(8);
+
+void BM_stdlib_arc4random_buf(benchmark::State& state) {
+  std::vector<char> buf(state.range(0));
+  while (state.KeepRunning()) {
+    arc4random_buf(buf.data(), buf.size());
+  }
+  state.SetBytesProcessed(int64_t(state.iterations()) * int64_t(buf.size()));
+}
+BENCHMARK(BM_stdlib_arc4random_buf)->Arg(16)->Arg(256)->Arg(4096)->Arg(65536)
+    ->Threads(1)->Threads(8);
+#endif
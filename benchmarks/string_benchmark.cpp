@@ -14,8 +14,14 @@
  * limitations under the License.
  */
 
+// Release builds run with FORTIFY everywhere, so measure what they get. The
+// *_unfortified benchmarks call through a pointer to skip the inline checks.
+#undef _FORTIFY_SOURCE
+#define _FORTIFY_SOURCE 2
+
 #include <stdint.h>
 #include <string.h>
+#include <wchar.h>
 
 #include <benchmark/benchmark.h>
 
@@ -24,7 +30,13 @@ constexpr auto KB = 1024;
 #define AT_COMMON_SIZES \
     Arg(8)->Arg(64)->Arg(512)->Arg(1*KB)->Arg(8*KB)->Arg(16*KB)->Arg(32*KB)->Arg(64*KB)
 
-// TODO: test unaligned operation too? (currently everything will be 8-byte aligned by malloc.)
+// memcpy, memmove and memset also switch strategy (rep movsb, non-temporal
+// stores) for sizes well beyond the L1 cache.
+#define AT_COPY_SIZES \
+    AT_COMMON_SIZES->Arg(256*KB)->Arg(1024*KB)->Arg(8*1024*KB)
+
+// Everything here is 8-byte aligned by malloc and hot in the cache. See
+// string_matrix_benchmark.cpp for unaligned, page-crossing and cold runs.
 
 static void BM_string_memcmp(benchmark::State& state) {
   const size_t nbytes = state.range_x();
@@ -56,7 +68,97 @@ static void BM_string_memcpy(benchmark::State& state) {
   delete[] src;
   delete[] dst;
 }
-BENCHMARK(BM_string_memcpy)->AT_COMMON_SIZES;
+BENCHMARK(BM_string_memcpy)->AT_COPY_SIZES;
+
+// A destination whose size the compiler knows, so FORTIFY has something to check.
+static char g_fortify_dst[64*KB];
+static void* (*volatile g_memcpy)(void*, const void*, size_t) = memcpy;
+
+// A runtime size: an inline compare against sizeof(g_fortify_dst), then memcpy.
+static void BM_string_memcpy_fortified(benchmark::State& state) {
+  const size_t nbytes = state.range_x();
+  char* src = new char[nbytes];
+  memset(src, 'x', nbytes);
+
+  while (state.KeepRunning()) {
+    memcpy(g_fortify_dst, src, nbytes);
+  }
+
+  state.SetBytesProcessed(uint64_t(state.iterations()) * uint64_t(nbytes));
+  delete[] src;
+}
+BENCHMARK(BM_string_memcpy_fortified)->AT_COMMON_SIZES;
+
+static void BM_string_memcpy_unfortified(benchmark::State& state) {
+  const size_t nbytes = state.range_x();
+  char* src = new char[nbytes];
+  memset(src, 'x', nbytes);
+
+  while (state.KeepRunning()) {
+    g_memcpy(g_fortify_dst, src, nbytes);
+  }
+
+  state.SetBytesProcessed(uint64_t(state.iterations()) * uint64_t(nbytes));
+  delete[] src;
+}
+BENCHMARK(BM_string_memcpy_unfortified)->AT_COMMON_SIZES;
+
+// A constant size that fits, which should compile to a plain memcpy.
+static void BM_string_memcpy_fortified_constant(benchmark::State& state) {
+  char src[64];
+  memset(src, 'x', sizeof(src));
+
+  while (state.KeepRunning()) {
+    memcpy(g_fortify_dst, src, sizeof(src));
+    benchmark::DoNotOptimize(g_fortify_dst);
+  }
+}
+BENCHMARK(BM_string_memcpy_fortified_constant);
+
+static void BM_string_memcpy_unfortified_constant(benchmark::State& state) {
+  char src[64];
+  memset(src, 'x', sizeof(src));
+
+  while (state.KeepRunning()) {
+    g_memcpy(g_fortify_dst, src, sizeof(src));
+    benchmark::DoNotOptimize(g_fortify_dst);
+  }
+}
+BENCHMARK(BM_string_memcpy_unfortified_constant);
+
+#if defined(__BIONIC__)
+static size_t (*volatile g_strlcpy)(char*, const char*, size_t) = strlcpy;
+
+static void BM_string_strlcpy_fortified(benchmark::State& state) {
+  const size_t nbytes = state.range_x();
+  char* src = new char[nbytes];
+  memset(src, 'x', nbytes);
+  src[nbytes - 1] = '\0';
+
+  while (state.KeepRunning()) {
+    strlcpy(g_fortify_dst, src, nbytes);
+  }
+
+  state.SetBytesProcessed(uint64_t(state.iterations()) * uint64_t(nbytes));
+  delete[] src;
+}
+BENCHMARK(BM_string_strlcpy_fortified)->AT_COMMON_SIZES;
+
+static void BM_string_strlcpy_unfortified(benchmark::State& state) {
+  const size_t nbytes = state.range_x();
+  char* src = new char[nbytes];
+  memset(src, 'x', nbytes);
+  src[nbytes - 1] = '\0';
+
+  while (state.KeepRunning()) {
+    g_strlcpy(g_fortify_dst, src, nbytes);
+  }
+
+  state.SetBytesProcessed(uint64_t(state.iterations()) * uint64_t(nbytes));
+  delete[] src;
+}
+BENCHMARK(BM_string_strlcpy_unfortified)->AT_COMMON_SIZES;
+#endif
 
 static void BM_string_memmove(benchmark::State& state) {
   const size_t nbytes = state.range_x();
@@ -70,7 +172,7 @@ static void BM_string_memmove(benchmark::State& state) {
   state.SetBytesProcessed(uint64_t(state.iterations()) * uint64_t(nbytes));
   delete[] buf;
 }
-BENCHMARK(BM_string_memmove)->AT_COMMON_SIZES;
+BENCHMARK(BM_string_memmove)->AT_COPY_SIZES;
 
 static void BM_string_memset(benchmark::State& state) {
   const size_t nbytes = state.range_x();
@@ -83,7 +185,7 @@ static void BM_string_memset(benchmark::State& state) {
   state.SetBytesProcessed(uint64_t(state.iterations()) * uint64_t(nbytes));
   delete[] dst;
 }
-BENCHMARK(BM_string_memset)->AT_COMMON_SIZES;
+BENCHMARK(BM_string_memset)->AT_COPY_SIZES;
 
 static void BM_string_strlen(benchmark::State& state) {
   const size_t nbytes = state.range_x();
@@ -100,3 +202,289 @@ static void BM_string_strlen(benchmark::State& state) {
   delete[] s;
 }
 BENCHMARK(BM_string_strlen)->AT_COMMON_SIZES;
+
+// The character is only present as the last byte, so these scan everything.
+static void BM_string_memchr(benchmark::State& state) {
+  const size_t nbytes = state.range_x();
+  char* s = new char[nbytes];
+  memset(s, 'x', nbytes);
+  s[nbytes - 1] = 'y';
+
+  volatile uintptr_t c __attribute__((unused)) = 0;
+  while (state.KeepRunning()) {
+    c += reinterpret_cast<uintptr_t>(memchr(s, 'y', nbytes));
+  }
+
+  state.SetBytesProcessed(uint64_t(state.iterations()) * uint64_t(nbytes));
+  delete[] s;
+}
+BENCHMARK(BM_string_memchr)->AT_COMMON_SIZES;
+
+static void BM_string_memrchr(benchmark::State& state) {
+  const size_t nbytes = state.range_x();
+  char* s = new char[nbytes];
+  memset(s, 'x', nbytes);
+  s[0] = 'y';
+
+  volatile uintptr_t c __attribute__((unused)) = 0;
+  while (state.KeepRunning()) {
+    c += reinterpret_cast<uintptr_t>(memrchr(s, 'y', nbytes));
+  }
+
+  state.SetBytesProcessed(uint64_t(state.iterations()) * uint64_t(nbytes));
+  delete[] s;
+}
+BENCHMARK(BM_string_memrchr)->AT_COMMON_SIZES;
+
+static void BM_string_strchr(benchmark::State& state) {
+  const size_t nbytes = state.range_x();
+  char* s = new char[nbytes];
+  memset(s, 'x', nbytes);
+  s[nbytes - 1] = 0;
+
+  volatile uintptr_t c __attribute__((unused)) = 0;
+  while (state.KeepRunning()) {
+    c += reinterpret_cast<uintptr_t>(strchr(s, 'y'));
+  }
+
+  state.SetBytesProcessed(uint64_t(state.iterations()) * uint64_t(nbytes));
+  delete[] s;
+}
+BENCHMARK(BM_string_strchr)->AT_COMMON_SIZES;
+
+static void BM_string_strrchr(benchmark::State& state) {
+  const size_t nbytes = state.range_x();
+  char* s = new char[nbytes];
+  memset(s, 'x', nbytes);
+  s[0] = 'y';
+  s[nbytes - 1] = 0;
+
+  volatile uintptr_t c __attribute__((unused)) = 0;
+  while (state.KeepRunning()) {
+    c += reinterpret_cast<uintptr_t>(strrchr(s, 'y'));
+  }
+
+  state.SetBytesProcessed(uint64_t(state.iterations()) * uint64_t(nbytes));
+  delete[] s;
+}
+BENCHMARK(BM_string_strrchr)->AT_COMMON_SIZES;
+
+static void BM_string_memmem(benchmark::State& state) {
+  const size_t nbytes = state.range_x();
+  char* s = new char[nbytes];
+  for (size_t i = 0; i < nbytes; ++i) s[i] = 'a' + i % 26;
+
+  volatile uintptr_t c __attribute__((unused)) = 0;
+  while (state.KeepRunning()) {
+    c += reinterpret_cast<uintptr_t>(memmem(s, nbytes, "needle", 6));
+  }
+
+  state.SetBytesProcessed(uint64_t(state.iterations()) * uint64_t(nbytes));
+  delete[] s;
+}
+BENCHMARK(BM_string_memmem)->AT_COMMON_SIZES;
+
+static void BM_string_strstr(benchmark::State& state) {
+  const size_t nbytes = state.range_x();
+  char* s = new char[nbytes];
+  for (size_t i = 0; i < nbytes; ++i) s[i] = 'a' + i % 26;
+  s[nbytes - 1] = 0;
+
+  volatile uintptr_t c __attribute__((unused)) = 0;
+  while (state.KeepRunning()) {
+    c += reinterpret_cast<uintptr_t>(strstr(s, "needle"));
+  }
+
+  state.SetBytesProcessed(uint64_t(state.iterations()) * uint64_t(nbytes));
+  delete[] s;
+}
+BENCHMARK(BM_string_strstr)->AT_COMMON_SIZES;
+
+static void BM_string_strcasecmp(benchmark::State& state) {
+  const size_t nbytes = state.range_x();
+  char* s1 = new char[nbytes];
+  char* s2 = new char[nbytes];
+  for (size_t i = 0; i < nbytes; ++i) {
+    s1[i] = 'a' + i % 26;
+    s2[i] = 'A' + i % 26;
+  }
+  s1[nbytes - 1] = s2[nbytes - 1] = 0;
+
+  volatile int c __attribute__((unused)) = 0;
+  while (state.KeepRunning()) {
+    c += strcasecmp(s1, s2);
+  }
+
+  state.SetBytesProcessed(uint64_t(state.iterations()) * uint64_t(nbytes));
+  delete[] s1;
+  delete[] s2;
+}
+BENCHMARK(BM_string_strcasecmp)->AT_COMMON_SIZES;
+
+static void BM_string_strcasestr(benchmark::State& state) {
+  const size_t nbytes = state.range_x();
+  char* s = new char[nbytes];
+  for (size_t i = 0; i < nbytes; ++i) s[i] = 'a' + i % 26;
+  s[nbytes - 1] = 0;
+
+  volatile uintptr_t c __attribute__((unused)) = 0;
+  while (state.KeepRunning()) {
+    c += reinterpret_cast<uintptr_t>(strcasestr(s, "Content-Length"));
+  }
+
+  state.SetBytesProcessed(uint64_t(state.iterations()) * uint64_t(nbytes));
+  delete[] s;
+}
+BENCHMARK(BM_string_strcasestr)->AT_COMMON_SIZES;
+
+static void BM_string_strspn(benchmark::State& state) {
+  const size_t nbytes = state.range_x();
+  char* s = new char[nbytes];
+  memset(s, 'x', nbytes);
+  s[nbytes - 1] = 0;
+
+  volatile size_t c __attribute__((unused)) = 0;
+  while (state.KeepRunning()) {
+    c += strspn(s, "abcxyz");
+  }
+
+  state.SetBytesProcessed(uint64_t(state.iterations()) * uint64_t(nbytes));
+  delete[] s;
+}
+BENCHMARK(BM_string_strspn)->AT_COMMON_SIZES;
+
+static void BM_string_strcspn(benchmark::State& state) {
+  const size_t nbytes = state.range_x();
+  char* s = new char[nbytes];
+  memset(s, 'x', nbytes);
+  s[nbytes - 1] = 0;
+
+  volatile size_t c __attribute__((unused)) = 0;
+  while (state.KeepRunning()) {
+    c += strcspn(s, " \t\r\n");
+  }
+
+  state.SetBytesProcessed(uint64_t(state.iterations()) * uint64_t(nbytes));
+  delete[] s;
+}
+BENCHMARK(BM_string_strcspn)->AT_COMMON_SIZES;
+
+static void BM_string_wcslen(benchmark::State& state) {
+  const size_t nbytes = state.range_x();
+  const size_t nchars = nbytes / sizeof(wchar_t);
+  wchar_t* s = new wchar_t[nchars];
+  wmemset(s, L'x', nchars);
+  s[nchars - 1] = 0;
+
+  volatile size_t c __attribute__((unused)) = 0;
+  while (state.KeepRunning()) {
+    c += wcslen(s);
+  }
+
+  state.SetBytesProcessed(uint64_t(state.iterations()) * uint64_t(nbytes));
+  delete[] s;
+}
+BENCHMARK(BM_string_wcslen)->AT_COMMON_SIZES;
+
+static void BM_string_wmemset(benchmark::State& state) {
+  const size_t nbytes = state.range_x();
+  const size_t nchars = nbytes / sizeof(wchar_t);
+  wchar_t* dst = new wchar_t[nchars];
+
+  while (state.KeepRunning()) {
+    wmemset(dst, L'x', nchars);
+  }
+
+  state.SetBytesProcessed(uint64_t(state.iterations()) * uint64_t(nbytes));
+  delete[] dst;
+}
+BENCHMARK(BM_string_wmemset)->AT_COMMON_SIZES;
+
+static void BM_string_wmemcpy(benchmark::State& state) {
+  const size_t nbytes = state.range_x();
+  const size_t nchars = nbytes / sizeof(wchar_t);
+  wchar_t* src = new wchar_t[nchars];
+  wchar_t* dst = new wchar_t[nchars];
+  wmemset(src, L'x', nchars);
+
+  while (state.KeepRunning()) {
+    wmemcpy(dst, src, nchars);
+  }
+
+  state.SetBytesProcessed(uint64_t(state.iterations()) * uint64_t(nbytes));
+  delete[] src;
+  delete[] dst;
+}
+BENCHMARK(BM_string_wmemcpy)->AT_COMMON_SIZES;
+
+static void BM_string_wmemchr(benchmark::State& state) {
+  const size_t nbytes = state.range_x();
+  const size_t nchars = nbytes / sizeof(wchar_t);
+  wchar_t* s = new wchar_t[nchars];
+  wmemset(s, L'x', nchars);
+
+  volatile uintptr_t c __attribute__((unused)) = 0;
+  while (state.KeepRunning()) {
+    c += reinterpret_cast<uintptr_t>(wmemchr(s, L'y', nchars));
+  }
+
+  state.SetBytesProcessed(uint64_t(state.iterations()) * uint64_t(nbytes));
+  delete[] s;
+}
+BENCHMARK(BM_string_wmemchr)->AT_COMMON_SIZES;
+
+static void BM_string_wcschr(benchmark::State& state) {
+  const size_t nbytes = state.range_x();
+  const size_t nchars = nbytes / sizeof(wchar_t);
+  wchar_t* s = new wchar_t[nchars];
+  wmemset(s, L'x', nchars);
+  s[nchars - 1] = 0;
+
+  volatile uintptr_t c __attribute__((unused)) = 0;
+  while (state.KeepRunning()) {
+    c += reinterpret_cast<uintptr_t>(wcschr(s, L'y'));
+  }
+
+  state.SetBytesProcessed(uint64_t(state.iterations()) * uint64_t(nbytes));
+  delete[] s;
+}
+BENCHMARK(BM_string_wcschr)->AT_COMMON_SIZES;
+
+static void BM_string_wcscmp(benchmark::State& state) {
+  const size_t nbytes = state.range_x();
+  const size_t nchars = nbytes / sizeof(wchar_t);
+  wchar_t* s1 = new wchar_t[nchars];
+  wchar_t* s2 = new wchar_t[nchars];
+  wmemset(s1, L'x', nchars);
+  wmemset(s2, L'x', nchars);
+  s1[nchars - 1] = s2[nchars - 1] = 0;
+
+  volatile int c __attribute__((unused)) = 0;
+  while (state.KeepRunning()) {
+    c += wcscmp(s1, s2);
+  }
+
+  state.SetBytesProcessed(uint64_t(state.iterations()) * uint64_t(nbytes));
+  delete[] s1;
+  delete[] s2;
+}
+BENCHMARK(BM_string_wcscmp)->AT_COMMON_SIZES;
+
+static void BM_string_wcsncpy(benchmark::State& state) {
+  const size_t nbytes = state.range_x();
+  const size_t nchars = nbytes / sizeof(wchar_t);
+  wchar_t* src = new wchar_t[nchars];
+  wchar_t* dst = new wchar_t[nchars];
+  // Half string, half padding.
+  wmemset(src, L'x', nchars);
+  src[nchars / 2] = 0;
+
+  while (state.KeepRunning()) {
+    wcsncpy(dst, src, nchars);
+  }
+
+  state.SetBytesProcessed(uint64_t(state.iterations()) * uint64_t(nbytes));
+  delete[] src;
+  delete[] dst;
+}
+BENCHMARK(BM_string_wcsncpy)->AT_COMMON_SIZES;
@@ -0,0 +1,287 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// The string and memory functions across sizes, buffer offsets and cache
+// state. string_benchmark.cpp covers the common cases quickly; this is the
+// exhaustive version, built as its own binary because a full run takes a
+// long time. Use --benchmark_filter to pick functions.
+//
+// Every benchmark takes two arguments: the size in bytes, and where the
+// source and destination start relative to a page boundary, encoded as
+// src_offset * 10000 + dst_offset: BM_string_matrix_memcpy/64/10007 copies
+// 64 bytes from offset 1 to offset 7, and .../64/40950000 reads from offset
+// 4095, crossing into the next page straight away. Each result's label
+// spells the parameters out again, so --benchmark_format=json or csv gives
+// output that scripts can match up between runs on different CPUs without
+// parsing names.
+//
+// The _cold variants rotate through buffers much bigger than any cache, so
+// every call starts with its data in memory rather than L1.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <wchar.h>
+
+#include <algorithm>
+
+#include <benchmark/benchmark.h>
+
+constexpr auto KB = 1024;
+constexpr auto MB = 1024 * KB;
+
+constexpr size_t kPageSize = 4096;
+constexpr int kOffsetScale = 10000;
+
+// Bigger than the last-level cache of anything we run on.
+constexpr size_t kColdPoolSize = 64 * MB;
+
+// Every size from 0 to 64, where call overhead and the choice of small-size
+// path dominate, then powers of two up to well past the caches.
+static void SizeArgs(benchmark::internal::Benchmark* b, int src_offset, int dst_offset) {
+  for (int size = 0; size <= 64; ++size) {
+    b->ArgPair(size, src_offset * kOffsetScale + dst_offset);
+  }
+  for (int size = 128; size <= 8 * MB; size *= 2) {
+    b->ArgPair(size, src_offset * kOffsetScale + dst_offset);
+  }
+}
+
+// Offsets relative to a page: both aligned, each misaligned by a little
+// or by nearly a vector, mutually misaligned, and starting just before a
+// page boundary so every access near the start crosses it.
+static const int kOffsetPairs[][2] = {
+  { 0, 0 }, { 1, 0 }, { 0, 1 }, { 1, 1 }, { 3, 0 }, { 0, 3 }, { 8, 0 }, { 0, 8 },
+  { 15, 0 }, { 0, 15 }, { 1, 7 }, { 7, 1 }, { 4095, 0 }, { 0, 4095 }, { 4064, 4064 },
+};
+
+static const int kOffsetSweepSizes[] = { 8, 32, 64, 512, 4 * KB, 64 * KB };
+
+static void MatrixArgs(benchmark::internal::Benchmark* b) {
+  SizeArgs(b, 0, 0);
+  for (auto& offsets : kOffsetPairs) {
+    if (offsets[0] == 0 && offsets[1] == 0) continue;
+    for (int size : kOffsetSweepSizes) {
+      b->ArgPair(size, offsets[0] * kOffsetScale + offsets[1]);
+    }
+  }
+}
+
+// wchar_t strings must be aligned, so only offsets that are multiples of
+// sizeof(wchar_t) make sense for them.
+static void WideMatrixArgs(benchmark::internal::Benchmark* b) {
+  SizeArgs(b, 0, 0);
+  for (auto& offsets : kOffsetPairs) {
+    if (offsets[0] == 0 && offsets[1] == 0) continue;
+    if (offsets[0] % sizeof(wchar_t) != 0 || offsets[1] % sizeof(wchar_t) != 0) continue;
+    for (int size : kOffsetSweepSizes) {
+      b->ArgPair(size, offsets[0] * kOffsetScale + offsets[1]);
+    }
+  }
+  b->ArgPair(64, 4092 * kOffsetScale + 0);
+  b->ArgPair(64, 0 * kOffsetScale + 4092);
+}
+
+// Source and destination buffers for one benchmark. A hot run reuses a
+// single pair; a cold run cycles through as many as fit in kColdPoolSize.
+// Each buffer has room for a terminator after the requested size.
+class MatrixBuffers {
+ public:
+  MatrixBuffers(benchmark::State& state, bool cold)
+      : nbytes_(state.range_x()),
+        src_offset_(state.range_y() / kOffsetScale),
+        dst_offset_(state.range_y() % kOffsetScale),
+        index_(0) {
+    // Leave at least a page between buffers so the offsets never overlap.
+    stride_ = (src_offset_ + dst_offset_ + nbytes_ + sizeof(wchar_t) + kPageSize) & ~(kPageSize - 1);
+    count_ = cold ? std::max<size_t>(2, kColdPoolSize / stride_) : 1;
+    src_pool_ = Map(stride_ * count_);
+    dst_pool_ = Map(stride_ * count_);
+    // Fault everything in now rather than on the first timed pass.
+    for (size_t i = 0; i < count_; ++i) {
+      memset(src(i), 0, nbytes_ + sizeof(wchar_t));
+      memset(dst(i), 0, nbytes_ + sizeof(wchar_t));
+    }
+
+    char label[128];
+    snprintf(label, sizeof(label), "size=%zu src_offset=%zu dst_offset=%zu cache=%s",
+             nbytes_, src_offset_, dst_offset_, cold ? "cold" : "hot");
+    state.SetLabel(label);
+  }
+
+  ~MatrixBuffers() {
+    munmap(src_pool_, stride_ * count_);
+    munmap(dst_pool_, stride_ * count_);
+  }
+
+  size_t size() const { return nbytes_; }
+
+  char* src(size_t i) { return src_pool_ + i * stride_ + src_offset_; }
+  char* dst(size_t i) { return dst_pool_ + i * stride_ + dst_offset_; }
+  char* src() { return src(index_); }
+  char* dst() { return dst(index_); }
+
+  // Fills every source (and, if asked, destination) with `ch` and
+  // terminates it, as a byte string or a wchar_t string.
+  void FillStrings(char ch, bool fill_dst) {
+    for (size_t i = 0; i < count_; ++i) {
+      memset(src(i), ch, nbytes_);
+      src(i)[nbytes_] = '\0';
+      if (fill_dst) {
+        memset(dst(i), ch, nbytes_);
+        dst(i)[nbytes_] = '\0';
+      }
+    }
+  }
+
+  void FillWideStrings(wchar_t ch, bool fill_dst) {
+    size_t nchars = nbytes_ / sizeof(wchar_t);
+    for (size_t i = 0; i < count_; ++i) {
+      wchar_t* s = reinterpret_cast<wchar_t*>(src(i));
+      wmemset(s, ch, nchars);
+      s[nchars] = L'\0';
+      if (fill_dst) {
+        wchar_t* d = reinterpret_cast<wchar_t*>(dst(i));
+        wmemset(d, ch, nchars);
+        d[nchars] = L'\0';
+      }
+    }
+  }
+
+  void Next() {
+    if (++index_ == count_) index_ = 0;
+  }
+
+ private:
+  static char* Map(size_t size) {
+    void* p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED) {
+      perror("mmap");
+      abort();
+    }
+    return reinterpret_cast<char*>(p);
+  }
+
+  size_t nbytes_;
+  size_t src_offset_;
+  size_t dst_offset_;
+  size_t stride_;
+  size_t count_;
+  size_t index_;
+  char* src_pool_;
+  char* dst_pool_;
+};
+
+// Defines a hot and a cold benchmark from one body. The body sees
+// `buffers` and `nbytes`, and runs once per iteration.
+#define STRING_MATRIX_BENCHMARK(name, args, setup, body) \
+  static void BM_string_matrix_##name##_impl(benchmark::State& state, bool cold) { \
+    MatrixBuffers buffers(state, cold); \
+    const size_t nbytes __attribute__((unused)) = buffers.size(); \
+    setup; \
+    volatile uintptr_t result __attribute__((unused)) = 0; \
+    while (state.KeepRunning()) { \
+      body; \
+      buffers.Next(); \
+    } \
+    state.SetBytesProcessed(uint64_t(state.iterations()) * uint64_t(nbytes)); \
+  } \
+  static void BM_string_matrix_##name(benchmark::State& state) { \
+    BM_string_matrix_##name##_impl(state, false); \
+  } \
+  static void BM_string_matrix_##name##_cold(benchmark::State& state) { \
+    BM_string_matrix_##name##_impl(state, true); \
+  } \
+  BENCHMARK(BM_string_matrix_##name)->Apply(args); \
+  BENCHMARK(BM_string_matrix_##name##_cold)->Apply(args)
+
+#define SRC buffers.src()
+#define DST buffers.dst()
+#define WSRC reinterpret_cast<wchar_t*>(buffers.src())
+#define WDST reinterpret_cast<wchar_t*>(buffers.dst())
+#define NCHARS (nbytes / sizeof(wchar_t))
+#define RESULT(x) result += (uintptr_t)(x)
+
+// Searches and lengths: the whole string is 'x', so nothing stops early.
+STRING_MATRIX_BENCHMARK(memchr, MatrixArgs, buffers.FillStrings('x', false),
+                        RESULT(memchr(SRC, 'y', nbytes)));
+STRING_MATRIX_BENCHMARK(memrchr, MatrixArgs, buffers.FillStrings('x', false),
+                        RESULT(memrchr(SRC, 'y', nbytes)));
+STRING_MATRIX_BENCHMARK(strlen, MatrixArgs, buffers.FillStrings('x', false),
+                        RESULT(strlen(SRC)));
+STRING_MATRIX_BENCHMARK(strnlen, MatrixArgs, buffers.FillStrings('x', false),
+                        RESULT(strnlen(SRC, nbytes + 1)));
+STRING_MATRIX_BENCHMARK(strchr, MatrixArgs, buffers.FillStrings('x', false),
+                        RESULT(strchr(SRC, 'y')));
+STRING_MATRIX_BENCHMARK(strrchr, MatrixArgs, buffers.FillStrings('x', false),
+                        RESULT(strrchr(SRC, 'y')));
+
+// Comparisons of equal buffers, which have to look at every byte.
+STRING_MATRIX_BENCHMARK(memcmp, MatrixArgs, buffers.FillStrings('x', true),
+                        RESULT(memcmp(DST, SRC, nbytes)));
+STRING_MATRIX_BENCHMARK(strcmp, MatrixArgs, buffers.FillStrings('x', true),
+                        RESULT(strcmp(DST, SRC)));
+STRING_MATRIX_BENCHMARK(strncmp, MatrixArgs, buffers.FillStrings('x', true),
+                        RESULT(strncmp(DST, SRC, nbytes + 1)));
+
+// Copies. The concatenations start from an empty destination each time.
+STRING_MATRIX_BENCHMARK(memcpy, MatrixArgs, buffers.FillStrings('x', false),
+                        RESULT(memcpy(DST, SRC, nbytes)));
+STRING_MATRIX_BENCHMARK(memmove, MatrixArgs, buffers.FillStrings('x', false),
+                        RESULT(memmove(DST, SRC, nbytes)));
+STRING_MATRIX_BENCHMARK(memset, MatrixArgs, ,
+                        RESULT(memset(DST, 0, nbytes)));
+STRING_MATRIX_BENCHMARK(strcpy, MatrixArgs, buffers.FillStrings('x', false),
+                        RESULT(strcpy(DST, SRC)));
+STRING_MATRIX_BENCHMARK(stpcpy, MatrixArgs, buffers.FillStrings('x', false),
+                        RESULT(stpcpy(DST, SRC)));
+STRING_MATRIX_BENCHMARK(strncpy, MatrixArgs, buffers.FillStrings('x', false),
+                        RESULT(strncpy(DST, SRC, nbytes + 1)));
+STRING_MATRIX_BENCHMARK(stpncpy, MatrixArgs, buffers.FillStrings('x', false),
+                        RESULT(stpncpy(DST, SRC, nbytes + 1)));
+STRING_MATRIX_BENCHMARK(strcat, MatrixArgs, buffers.FillStrings('x', false),
+                        DST[0] = '\0'; RESULT(strcat(DST, SRC)));
+STRING_MATRIX_BENCHMARK(strncat, MatrixArgs, buffers.FillStrings('x', false),
+                        DST[0] = '\0'; RESULT(strncat(DST, SRC, nbytes)));
+#if defined(__BIONIC__)
+// glibc doesn't have these.
+STRING_MATRIX_BENCHMARK(strlcpy, MatrixArgs, buffers.FillStrings('x', false),
+                        RESULT(strlcpy(DST, SRC, nbytes + 1)));
+STRING_MATRIX_BENCHMARK(strlcat, MatrixArgs, buffers.FillStrings('x', false),
+                        DST[0] = '\0'; RESULT(strlcat(DST, SRC, nbytes + 1)));
+#endif
+
+// The wchar_t versions. The size is still in bytes.
+STRING_MATRIX_BENCHMARK(wcslen, WideMatrixArgs, buffers.FillWideStrings(L'x', false),
+                        RESULT(wcslen(WSRC)));
+STRING_MATRIX_BENCHMARK(wcschr, WideMatrixArgs, buffers.FillWideStrings(L'x', false),
+                        RESULT(wcschr(WSRC, L'y')));
+STRING_MATRIX_BENCHMARK(wcsrchr, WideMatrixArgs, buffers.FillWideStrings(L'x', false),
+                        RESULT(wcsrchr(WSRC, L'y')));
+STRING_MATRIX_BENCHMARK(wcscmp, WideMatrixArgs, buffers.FillWideStrings(L'x', true),
+                        RESULT(wcscmp(WDST, WSRC)));
+STRING_MATRIX_BENCHMARK(wmemcmp, WideMatrixArgs, buffers.FillWideStrings(L'x', true),
+                        RESULT(wmemcmp(WDST, WSRC, NCHARS)));
+STRING_MATRIX_BENCHMARK(wcscpy, WideMatrixArgs, buffers.FillWideStrings(L'x', false),
+                        RESULT(wcscpy(WDST, WSRC)));
+STRING_MATRIX_BENCHMARK(wcscat, WideMatrixArgs, buffers.FillWideStrings(L'x', false),
+                        WDST[0] = L'\0'; RESULT(wcscat(WDST, WSRC)));
+STRING_MATRIX_BENCHMARK(wmemmove, WideMatrixArgs, buffers.FillWideStrings(L'x', false),
+                        RESULT(wmemmove(WDST, WSRC, NCHARS)));
+STRING_MATRIX_BENCHMARK(wmemset, WideMatrixArgs, ,
+                        RESULT(wmemset(WDST, L'x', NCHARS)));
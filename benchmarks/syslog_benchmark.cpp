@@ -0,0 +1,46 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <syslog.h>
+
+#include <benchmark/benchmark.h>
+
+// Like a daemon logging on a request path.
+static void LogRequests(benchmark::State& state) {
+  int i = 0;
+  while (state.KeepRunning()) {
+    syslog(LOG_DEBUG, "request %d from %s: %s %d bytes", i++, "10.0.0.1", "GET /index.html", 1234);
+  }
+}
+
+static void BM_syslog(benchmark::State& state) {
+  LogRequests(state);
+}
+BENCHMARK(BM_syslog)->Threads(1)->Threads(4);
+
+#if defined(__BIONIC__)
+// This has to come after BM_syslog, because the queue can't be turned off again.
+static void BM_syslog_async(benchmark::State& state) {
+  if (state.thread_index == 0) {
+    android_syslog_set_async(4096, ANDROID_SYSLOG_ASYNC_WRITE_WHEN_FULL);
+  }
+  LogRequests(state);
+  if (state.thread_index == 0) {
+    android_syslog_flush();
+  }
+}
+BENCHMARK(BM_syslog_async)->Threads(1)->Threads(4);
+#endif
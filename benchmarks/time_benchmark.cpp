@@ -14,13 +14,45 @@
  * limitations under the License.
  */
 
+#include <stdlib.h>
+#include <string.h>
 #include <sys/syscall.h>
 #include <sys/time.h>
 #include <time.h>
 #include <unistd.h>
 
+#include <string>
+
 #include <benchmark/benchmark.h>
 
+// Sets TZ for the duration of a benchmark, putting back whatever was there before.
+class ScopedTz {
+ public:
+  explicit ScopedTz(const char* tz) {
+    const char* old = getenv("TZ");
+    had_tz_ = (old != nullptr);
+    if (had_tz_) old_tz_ = old;
+    setenv("TZ", tz, 1);
+    tzset();
+  }
+
+  ~ScopedTz() {
+    if (had_tz_) {
+      setenv("TZ", old_tz_.c_str(), 1);
+    } else {
+      unsetenv("TZ");
+    }
+    tzset();
+  }
+
+ private:
+  bool had_tz_;
+  std::string old_tz_;
+};
+
+// 2017-03-12 10:00:00 UTC, when America/Los_Angeles moved from PST to PDT.
+static const time_t kLosAngelesDstStart = 1489312800;
+
 static void BM_time_clock_gettime(benchmark::State& state) {
   timespec t;
   while (state.KeepRunning()) {
@@ -37,6 +69,44 @@ static void BM_time_clock_gettime_syscall(benchmark::State& state) {
 }
 BENCHMARK(BM_time_clock_gettime_syscall);
 
+static void BM_time_clock_gettime_MONOTONIC_COARSE(benchmark::State& state) {
+  timespec t;
+  while (state.KeepRunning()) {
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &t);
+  }
+}
+BENCHMARK(BM_time_clock_gettime_MONOTONIC_COARSE);
+
+static void BM_time_clock_gettime_REALTIME_COARSE(benchmark::State& state) {
+  timespec t;
+  while (state.KeepRunning()) {
+    clock_gettime(CLOCK_REALTIME_COARSE, &t);
+  }
+}
+BENCHMARK(BM_time_clock_gettime_REALTIME_COARSE);
+
+static void BM_time_clock_gettime_THREAD_CPUTIME_ID(benchmark::State& state) {
+  timespec t;
+  while (state.KeepRunning()) {
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &t);
+  }
+}
+BENCHMARK(BM_time_clock_gettime_THREAD_CPUTIME_ID);
+
+#if defined(__BIONIC__)
+static void BM_time_clock_gettime_THREAD_CPUTIME_ID_fast_path(benchmark::State& state) {
+  if (android_thread_cputime_enable_fast_path() == -1) {
+    state.SkipWithError("no perf event fast path");
+    return;
+  }
+  timespec t;
+  while (state.KeepRunning()) {
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &t);
+  }
+}
+BENCHMARK(BM_time_clock_gettime_THREAD_CPUTIME_ID_fast_path);
+#endif
+
 static void BM_time_gettimeofday(benchmark::State& state) {
   timeval tv;
   while (state.KeepRunning()) {
@@ -53,9 +123,145 @@ void BM_time_gettimeofday_syscall(benchmark::State& state) {
 }
 BENCHMARK(BM_time_gettimeofday_syscall);
 
+static void BM_time_clock_getres(benchmark::State& state) {
+  timespec t;
+  while (state.KeepRunning()) {
+    clock_getres(CLOCK_MONOTONIC, &t);
+  }
+}
+BENCHMARK(BM_time_clock_getres);
+
+static void BM_time_clock_getres_syscall(benchmark::State& state) {
+  timespec t;
+  while (state.KeepRunning()) {
+    syscall(__NR_clock_getres, CLOCK_MONOTONIC, &t);
+  }
+}
+BENCHMARK(BM_time_clock_getres_syscall);
+
 void BM_time_time(benchmark::State& state) {
   while (state.KeepRunning()) {
     time(NULL);
   }
 }
 BENCHMARK(BM_time_time);
+
+static void BM_time_localtime_r(benchmark::State& state) {
+  time_t t = time(nullptr);
+  tm tm;
+  while (state.KeepRunning()) {
+    localtime_r(&t, &tm);
+  }
+}
+BENCHMARK(BM_time_localtime_r)->Threads(1)->Threads(2)->Threads(4)->Threads(8);
+
+static void BM_time_strftime(benchmark::State& state) {
+  time_t t = time(nullptr);
+  tm tm;
+  localtime_r(&t, &tm);
+  char buf[64];
+  while (state.KeepRunning()) {
+    strftime(buf, sizeof(buf), "%a %b %e %H:%M:%S %Y", &tm);
+  }
+}
+BENCHMARK(BM_time_strftime);
+
+static void BM_time_strftime_iso8601(benchmark::State& state) {
+  time_t t = time(nullptr);
+  tm tm;
+  localtime_r(&t, &tm);
+  char buf[64];
+  while (state.KeepRunning()) {
+    strftime(buf, sizeof(buf), "%Y-%m-%dT%H:%M:%S%z", &tm);
+  }
+}
+BENCHMARK(BM_time_strftime_iso8601);
+
+static void BM_time_localtime_r_dst_boundary(benchmark::State& state) {
+  ScopedTz tz("America/Los_Angeles");
+  // Alternate between either side of the transition, so that no cached interval covers both.
+  time_t times[] = { kLosAngelesDstStart - 1, kLosAngelesDstStart };
+  tm tm;
+  size_t i = 0;
+  while (state.KeepRunning()) {
+    localtime_r(&times[i++ & 1], &tm);
+  }
+}
+BENCHMARK(BM_time_localtime_r_dst_boundary);
+
+static void BM_time_localtime_r_tz_switch(benchmark::State& state) {
+  ScopedTz tz("UTC");
+  const char* zones[] = { "America/Los_Angeles", "Europe/London" };
+  time_t t = kLosAngelesDstStart;
+  tm tm;
+  size_t i = 0;
+  while (state.KeepRunning()) {
+    setenv("TZ", zones[i++ & 1], 1);
+    localtime_r(&t, &tm);
+  }
+}
+BENCHMARK(BM_time_localtime_r_tz_switch);
+
+static void BM_time_gmtime_r(benchmark::State& state) {
+  time_t t = time(nullptr);
+  tm tm;
+  while (state.KeepRunning()) {
+    gmtime_r(&t, &tm);
+  }
+}
+BENCHMARK(BM_time_gmtime_r)->Threads(1)->Threads(2)->Threads(4)->Threads(8);
+
+static void BM_time_mktime(benchmark::State& state) {
+  time_t t = time(nullptr);
+  tm tm;
+  localtime_r(&t, &tm);
+  while (state.KeepRunning()) {
+    tm.tm_isdst = -1;
+    mktime(&tm);
+  }
+}
+BENCHMARK(BM_time_mktime)->Threads(1)->Threads(2)->Threads(4)->Threads(8);
+
+static void BM_time_mktime_dst_boundary(benchmark::State& state) {
+  ScopedTz tz("America/Los_Angeles");
+  // 02:30 on the day of the transition doesn't exist, so mktime has to search around it.
+  tm tm;
+  memset(&tm, 0, sizeof(tm));
+  while (state.KeepRunning()) {
+    tm.tm_year = 117;
+    tm.tm_mon = 2;
+    tm.tm_mday = 12;
+    tm.tm_hour = 2;
+    tm.tm_min = 30;
+    tm.tm_sec = 0;
+    tm.tm_isdst = -1;
+    mktime(&tm);
+  }
+}
+BENCHMARK(BM_time_mktime_dst_boundary);
+
+static void BM_time_timegm(benchmark::State& state) {
+  time_t t = time(nullptr);
+  tm tm;
+  gmtime_r(&t, &tm);
+  while (state.KeepRunning()) {
+    timegm(&tm);
+  }
+}
+BENCHMARK(BM_time_timegm);
+
+static void BM_time_tzset(benchmark::State& state) {
+  while (state.KeepRunning()) {
+    tzset();
+  }
+}
+BENCHMARK(BM_time_tzset)->Threads(1)->Threads(2)->Threads(4)->Threads(8);
+
+static void BM_time_strptime(benchmark::State& state) {
+  tm tm;
+  while (state.KeepRunning()) {
+    memset(&tm, 0, sizeof(tm));
+    strptime("2017-03-12 10:00:00", "%Y-%m-%d %H:%M:%S", &tm);
+  }
+}
+BENCHMARK(BM_time_strptime);
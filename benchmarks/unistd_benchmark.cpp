@@ -14,9 +14,18 @@
  * limitations under the License.
  */
 
+#include <fcntl.h>
+#include <limits.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/sendfile.h>
 #include <sys/syscall.h>
+#include <sys/wait.h>
 #include <unistd.h>
 
+#include <vector>
+
 #include <benchmark/benchmark.h>
 
 static void BM_unistd_getpid(benchmark::State& state) {
@@ -54,4 +63,191 @@ void BM_unistd_gettid_syscall(benchmark::State& state) {
 }
 BENCHMARK(BM_unistd_gettid_syscall);
 
-BENCHMARK_MAIN()
+static void VforkAndWait() {
+  pid_t pid = vfork();
+  if (pid == 0) _exit(0);
+  if (pid != -1) waitpid(pid, nullptr, 0);
+}
+
+// After a vfork, getpid and gettid should still be as cheap as they were before.
+static void BM_unistd_getpid_after_vfork(benchmark::State& state) {
+  VforkAndWait();
+  while (state.KeepRunning()) {
+    getpid();
+  }
+}
+BENCHMARK(BM_unistd_getpid_after_vfork);
+
+#if defined(__BIONIC__)
+static void BM_unistd_gettid_after_vfork(benchmark::State& state) {
+  VforkAndWait();
+  while (state.KeepRunning()) {
+    gettid_fp();
+  }
+}
+BENCHMARK(BM_unistd_gettid_after_vfork);
+#endif
+
+static void BM_unistd_getcwd(benchmark::State& state) {
+  char buf[PATH_MAX];
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(getcwd(buf, sizeof(buf)));
+  }
+}
+BENCHMARK(BM_unistd_getcwd);
+
+// Where getcwd allocates exactly as much as it needs.
+static void BM_unistd_getcwd_malloc(benchmark::State& state) {
+  while (state.KeepRunning()) {
+    free(getcwd(nullptr, 0));
+  }
+}
+BENCHMARK(BM_unistd_getcwd_malloc);
+
+static void BM_unistd_sched_getcpu(benchmark::State& state) {
+  while (state.KeepRunning()) {
+    sched_getcpu();
+  }
+}
+BENCHMARK(BM_unistd_sched_getcpu);
+
+static void BM_unistd_getcpu_syscall(benchmark::State& state) {
+  unsigned cpu;
+  while (state.KeepRunning()) {
+    syscall(__NR_getcpu, &cpu, NULL, NULL);
+  }
+}
+BENCHMARK(BM_unistd_getcpu_syscall);
+
+static void BM_unistd_sysconf_nprocessors_onln(benchmark::State& state) {
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(sysconf(_SC_NPROCESSORS_ONLN));
+  }
+}
+BENCHMARK(BM_unistd_sysconf_nprocessors_onln);
+
+static void BM_unistd_sysconf_nprocessors_conf(benchmark::State& state) {
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(sysconf(_SC_NPROCESSORS_CONF));
+  }
+}
+BENCHMARK(BM_unistd_sysconf_nprocessors_conf);
+
+static int OpenTemporaryFile() {
+  char path[64];
+  snprintf(path, sizeof(path), "/data/local/tmp/copy_benchmark.XXXXXX");
+  int fd = mkstemp(path);
+  if (fd == -1) {
+    snprintf(path, sizeof(path), "/tmp/copy_benchmark.XXXXXX");
+    fd = mkstemp(path);
+  }
+  if (fd != -1) unlink(path);
+  return fd;
+}
+
+// Copies a file of state.range_x() bytes to another file with copy(in, out, size) each
+// iteration, starting from the beginning of both each time.
+template <typename CopyFn>
+static void CopyFileBenchmark(benchmark::State& state, CopyFn copy) {
+  size_t size = state.range_x();
+  int in = OpenTemporaryFile();
+  int out = OpenTemporaryFile();
+  if (in == -1 || out == -1) {
+    state.SkipWithError("couldn't create temporary files");
+    return;
+  }
+  std::vector<char> data(size, 'x');
+  if (write(in, data.data(), size) != static_cast<ssize_t>(size)) {
+    state.SkipWithError("couldn't write the input file");
+    return;
+  }
+
+  while (state.KeepRunning()) {
+    lseek(in, 0, SEEK_SET);
+    lseek(out, 0, SEEK_SET);
+    if (!copy(in, out, size)) {
+      state.SkipWithError("copy failed");
+      break;
+    }
+  }
+  state.SetBytesProcessed(int64_t(state.iterations()) * int64_t(size));
+
+  close(in);
+  close(out);
+}
+
+#define COPY_SIZES Arg(64 * 1024)->Arg(1024 * 1024)->Arg(16 * 1024 * 1024)
+
+static void BM_unistd_copy_read_write(benchmark::State& state) {
+  std::vector<char> buf(128 * 1024);
+  CopyFileBenchmark(state, [&buf](int in, int out, size_t size) {
+    while (size > 0) {
+      ssize_t n = read(in, buf.data(), buf.size());
+      if (n <= 0 || write(out, buf.data(), n) != n) return false;
+      size -= n;
+    }
+    return true;
+  });
+}
+BENCHMARK(BM_unistd_copy_read_write)->COPY_SIZES;
+
+static void BM_unistd_copy_sendfile(benchmark::State& state) {
+  CopyFileBenchmark(state, [](int in, int out, size_t size) {
+    while (size > 0) {
+      ssize_t n = sendfile(out, in, nullptr, size);
+      if (n <= 0) return false;
+      size -= n;
+    }
+    return true;
+  });
+}
+BENCHMARK(BM_unistd_copy_sendfile)->COPY_SIZES;
+
+static void BM_unistd_copy_splice(benchmark::State& state) {
+  int fds[2];
+  if (pipe(fds) == -1) {
+    state.SkipWithError("pipe failed");
+    return;
+  }
+  fcntl(fds[1], F_SETPIPE_SZ, 1024 * 1024);
+  int pipe_size = fcntl(fds[1], F_GETPIPE_SZ);
+  CopyFileBenchmark(state, [&fds, pipe_size](int in, int out, size_t size) {
+    while (size > 0) {
+      ssize_t n = splice(in, nullptr, fds[1], nullptr, pipe_size, SPLICE_F_MOVE | SPLICE_F_MORE);
+      if (n <= 0) return false;
+      size -= n;
+      while (n > 0) {
+        ssize_t m = splice(fds[0], nullptr, out, nullptr, n, SPLICE_F_MOVE | SPLICE_F_MORE);
+        if (m <= 0) return false;
+        n -= m;
+      }
+    }
+    return true;
+  });
+  close(fds[0]);
+  close(fds[1]);
+}
+BENCHMARK(BM_unistd_copy_splice)->COPY_SIZES;
+
+#if defined(__NR_copy_file_range)
+static void BM_unistd_copy_copy_file_range(benchmark::State& state) {
+  CopyFileBenchmark(state, [](int in, int out, size_t size) {
+    while (size > 0) {
+      ssize_t n = syscall(__NR_copy_file_range, in, nullptr, out, nullptr, size, 0);
+      if (n <= 0) return false;
+      size -= n;
+    }
+    return true;
+  });
+}
+BENCHMARK(BM_unistd_copy_copy_file_range)->COPY_SIZES;
+#endif
+
+#if defined(__BIONIC__)
+static void BM_unistd_android_copy_fd(benchmark::State& state) {
+  CopyFileBenchmark(state, [](int in, int out, size_t size) {
+    return android_copy_fd(in, out, size) == static_cast<ssize_t>(size);
+  });
+}
+BENCHMARK(BM_unistd_android_copy_fd)->COPY_SIZES;
+#endif
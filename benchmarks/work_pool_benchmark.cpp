@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdint.h>
+
+#if defined(__BIONIC__)
+
+#include <android/work_pool.h>
+
+#include <benchmark/benchmark.h>
+
+static void Nop(void*) {
+}
+
+// The cost of spawning tasks from a thread that isn't a worker, which go through the shared
+// queue, and of waiting for them.
+static void BM_work_pool_spawn_wait(benchmark::State& state) {
+  const int64_t task_count = state.range_x();
+  while (state.KeepRunning()) {
+    android_work_group_t group = ANDROID_WORK_GROUP_INITIALIZER;
+    for (int64_t i = 0; i < task_count; ++i) {
+      android_work_pool_spawn(&group, Nop, nullptr);
+    }
+    android_work_pool_wait(&group);
+  }
+  state.SetItemsProcessed(state.iterations() * task_count);
+}
+BENCHMARK(BM_work_pool_spawn_wait)->Arg(1)->Arg(16)->Arg(256);
+
+struct SplitTask {
+  int64_t depth;
+};
+
+// Each task spawns two more onto its worker's own queue, so that all but the first few tasks
+// are only reached by stealing.
+static void Split(void* arg) {
+  SplitTask* task = reinterpret_cast<SplitTask*>(arg);
+  if (task->depth == 0) {
+    return;
+  }
+  SplitTask children[2] = { { task->depth - 1 }, { task->depth - 1 } };
+  android_work_group_t group = ANDROID_WORK_GROUP_INITIALIZER;
+  android_work_pool_spawn(&group, Split, &children[0]);
+  android_work_pool_spawn(&group, Split, &children[1]);
+  android_work_pool_wait(&group);
+}
+
+static void BM_work_pool_steal(benchmark::State& state) {
+  const int64_t depth = state.range_x();
+  while (state.KeepRunning()) {
+    SplitTask root = { depth };
+    android_work_group_t group = ANDROID_WORK_GROUP_INITIALIZER;
+    android_work_pool_spawn(&group, Split, &root);
+    android_work_pool_wait(&group);
+  }
+  state.SetItemsProcessed(state.iterations() * ((INT64_C(2) << depth) - 1));
+}
+BENCHMARK(BM_work_pool_steal)->Arg(8)->Arg(12)->Arg(16);
+
+#endif  // __BIONIC__
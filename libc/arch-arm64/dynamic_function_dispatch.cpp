@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <stddef.h>
+#include <sys/auxv.h>
+
+#include <private/bionic_ifunc.h>
+
+#if !defined(HWCAP_CPUID)
+#define HWCAP_CPUID (1 << 11)
+#endif
+
+// Denver is the only arm64 core with its own memcpy and memset. The kernel
+// only lets us read MIDR_EL1 (by trapping and emulating the access) if it
+// advertises HWCAP_CPUID; without it we assume a generic core.
+static bool is_denver(unsigned long hwcap) {
+  if ((hwcap & HWCAP_CPUID) == 0) return false;
+  unsigned long midr;
+  __asm__ __volatile__("mrs %0, midr_el1" : "=r"(midr));
+  return ((midr >> 24) & 0xff) == 'N';
+}
+
+extern "C" {
+
+typedef void* memcpy_func(void*, const void*, size_t);
+__LIBC_HIDDEN__ memcpy_func __memcpy_generic, __memcpy_denver64;
+DEFINE_IFUNC_RESOLVER(memcpy) {
+  return is_denver(hwcap) ? __memcpy_denver64 : __memcpy_generic;
+}
+
+typedef void* __memcpy_chk_func(void*, const void*, size_t, size_t);
+__LIBC_HIDDEN__ __memcpy_chk_func __memcpy_chk_generic, __memcpy_chk_denver64;
+DEFINE_IFUNC_RESOLVER(__memcpy_chk) {
+  return is_denver(hwcap) ? __memcpy_chk_denver64 : __memcpy_chk_generic;
+}
+
+typedef void* memset_func(void*, int, size_t);
+__LIBC_HIDDEN__ memset_func __memset_generic, __memset_denver64;
+DEFINE_IFUNC_RESOLVER(memset) {
+  return is_denver(hwcap) ? __memset_denver64 : __memset_generic;
+}
+
+typedef void* __memset_chk_func(void*, int, size_t, size_t);
+__LIBC_HIDDEN__ __memset_chk_func __memset_chk_generic, __memset_chk_denver64;
+DEFINE_IFUNC_RESOLVER(__memset_chk) {
+  return is_denver(hwcap) ? __memset_chk_denver64 : __memset_chk_generic;
+}
+
+}  // extern "C"
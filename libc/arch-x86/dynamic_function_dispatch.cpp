@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <cpuid.h>
+#include <stddef.h>
+
+#include <private/bionic_ifunc.h>
+
+// The Atom (Bonnell/Saltwell) cores have their own SSSE3 copies; everything
+// else gets the Silvermont SSE2 code that was already the default.
+static bool is_atom() {
+  unsigned int eax, ebx, ecx, edx;
+  if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) return false;
+  unsigned int family = (eax >> 8) & 0xf;
+  unsigned int model = ((eax >> 4) & 0xf) | ((eax >> 12) & 0xf0);
+  if (family != 6) return false;
+  switch (model) {
+    case 0x1c:  // Diamondville, Pineview.
+    case 0x26:  // Lincroft.
+    case 0x27:  // Penwell.
+    case 0x35:  // Cloverview.
+    case 0x36:  // Cedarview.
+      return true;
+    default:
+      return false;
+  }
+}
+
+extern "C" {
+
+typedef void* memcpy_func(void*, const void*, size_t);
+__LIBC_HIDDEN__ memcpy_func __memcpy_atom, __memcpy_slm;
+DEFINE_IFUNC_RESOLVER(memcpy) {
+  return is_atom() ? __memcpy_atom : __memcpy_slm;
+}
+
+typedef void* memmove_func(void*, const void*, size_t);
+__LIBC_HIDDEN__ memmove_func __memmove_atom, __memmove_slm;
+DEFINE_IFUNC_RESOLVER(memmove) {
+  return is_atom() ? __memmove_atom : __memmove_slm;
+}
+
+typedef void* memset_func(void*, int, size_t);
+__LIBC_HIDDEN__ memset_func __memset_atom, __memset_slm;
+DEFINE_IFUNC_RESOLVER(memset) {
+  return is_atom() ? __memset_atom : __memset_slm;
+}
+
+typedef void* __memset_chk_func(void*, int, size_t, size_t);
+__LIBC_HIDDEN__ __memset_chk_func __memset_chk_atom, __memset_chk_slm;
+DEFINE_IFUNC_RESOLVER(__memset_chk) {
+  return is_atom() ? __memset_chk_atom : __memset_chk_slm;
+}
+
+typedef char* strcpy_func(char*, const char*);
+__LIBC_HIDDEN__ strcpy_func __strcpy_atom, __strcpy_slm;
+DEFINE_IFUNC_RESOLVER(strcpy) {
+  return is_atom() ? __strcpy_atom : __strcpy_slm;
+}
+
+typedef char* strncpy_func(char*, const char*, size_t);
+__LIBC_HIDDEN__ strncpy_func __strncpy_atom, __strncpy_slm;
+DEFINE_IFUNC_RESOLVER(strncpy) {
+  return is_atom() ? __strncpy_atom : __strncpy_slm;
+}
+
+typedef size_t strlen_func(const char*);
+__LIBC_HIDDEN__ strlen_func __strlen_atom, __strlen_slm;
+DEFINE_IFUNC_RESOLVER(strlen) {
+  return is_atom() ? __strlen_atom : __strlen_slm;
+}
+
+}  // extern "C"
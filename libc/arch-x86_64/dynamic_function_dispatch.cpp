@@ -0,0 +1,153 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <cpuid.h>
+#include <stddef.h>
+
+#include <private/bionic_ifunc.h>
+
+// CPUID.(EAX=7,ECX=0) bits.
+#define EBX_AVX2 (1 << 5)
+#define EBX_ERMS (1 << 9)
+#define EBX_AVX512F (1 << 16)
+#define EBX_AVX512BW (1 << 30)
+#define EDX_FSRM (1 << 4)
+
+// XCR0 bits for the register state the OS saves and restores.
+#define XCR0_YMM 0x06
+#define XCR0_ZMM 0xe6
+
+enum copy_impl { SLM, AVX2, AVX512 };
+
+struct cpu_features {
+  bool avx2;
+  bool erms;
+  bool fast_avx512;
+};
+
+static cpu_features get_cpu_features() {
+  cpu_features result = {};
+  unsigned int eax, ebx, ecx, edx;
+  if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) return result;
+  if ((ecx & bit_OSXSAVE) == 0 || (ecx & bit_AVX) == 0) return result;
+  if (__get_cpuid_max(0, nullptr) < 7) return result;
+  __cpuid_count(7, 0, eax, ebx, ecx, edx);
+
+  unsigned int xcr0_lo, xcr0_hi;
+  __asm__("xgetbv" : "=a"(xcr0_lo), "=d"(xcr0_hi) : "c"(0));
+  if ((xcr0_lo & XCR0_YMM) != XCR0_YMM) return result;
+
+  result.avx2 = (ebx & EBX_AVX2) != 0;
+  result.erms = (ebx & EBX_ERMS) != 0;
+  // Skylake-SP runs 512-bit stores at a reduced frequency that costs more
+  // than it gains for the rest of the program. Only use them on cores that
+  // also have FSRM (Ice Lake and later), where that penalty is gone.
+  result.fast_avx512 = (ebx & EBX_AVX512F) != 0 && (ebx & EBX_AVX512BW) != 0 &&
+      (edx & EDX_FSRM) != 0 && (xcr0_lo & XCR0_ZMM) == XCR0_ZMM;
+  return result;
+}
+
+static copy_impl best_impl() {
+  cpu_features features = get_cpu_features();
+  // The AVX2 and AVX-512 code uses rep movsb/rep stosb for large sizes, so
+  // it's only a win with ERMS.
+  if (!features.avx2 || !features.erms) return SLM;
+  return features.fast_avx512 ? AVX512 : AVX2;
+}
+
+static bool has_avx2() {
+  return get_cpu_features().avx2;
+}
+
+extern "C" {
+
+typedef void* memcpy_func(void*, const void*, size_t);
+__LIBC_HIDDEN__ memcpy_func __memcpy_slm, __memcpy_avx2, __memcpy_avx512;
+DEFINE_IFUNC_RESOLVER(memcpy) {
+  switch (best_impl()) {
+    case AVX512: return __memcpy_avx512;
+    case AVX2: return __memcpy_avx2;
+    default: return __memcpy_slm;
+  }
+}
+
+typedef void* memmove_func(void*, const void*, size_t);
+__LIBC_HIDDEN__ memmove_func __memmove_slm, __memmove_avx2, __memmove_avx512;
+DEFINE_IFUNC_RESOLVER(memmove) {
+  switch (best_impl()) {
+    case AVX512: return __memmove_avx512;
+    case AVX2: return __memmove_avx2;
+    default: return __memmove_slm;
+  }
+}
+
+typedef void* memset_func(void*, int, size_t);
+__LIBC_HIDDEN__ memset_func __memset_slm, __memset_avx2, __memset_avx512;
+DEFINE_IFUNC_RESOLVER(memset) {
+  switch (best_impl()) {
+    case AVX512: return __memset_avx512;
+    case AVX2: return __memset_avx2;
+    default: return __memset_slm;
+  }
+}
+
+typedef void* __memset_chk_func(void*, int, size_t, size_t);
+__LIBC_HIDDEN__ __memset_chk_func __memset_chk_slm, __memset_chk_avx2, __memset_chk_avx512;
+DEFINE_IFUNC_RESOLVER(__memset_chk) {
+  switch (best_impl()) {
+    case AVX512: return __memset_chk_avx512;
+    case AVX2: return __memset_chk_avx2;
+    default: return __memset_chk_slm;
+  }
+}
+
+typedef void* memchr_func(const void*, int, size_t);
+__LIBC_HIDDEN__ memchr_func __memchr_slm, __memchr_avx2;
+DEFINE_IFUNC_RESOLVER(memchr) {
+  return has_avx2() ? __memchr_avx2 : __memchr_slm;
+}
+
+typedef void* memrchr_func(const void*, int, size_t);
+__LIBC_HIDDEN__ memrchr_func __memrchr_slm, __memrchr_avx2;
+DEFINE_IFUNC_RESOLVER(memrchr) {
+  return has_avx2() ? __memrchr_avx2 : __memrchr_slm;
+}
+
+typedef char* strchr_func(const char*, int);
+__LIBC_HIDDEN__ strchr_func __strchr_slm, __strchr_avx2;
+DEFINE_IFUNC_RESOLVER(strchr) {
+  return has_avx2() ? __strchr_avx2 : __strchr_slm;
+}
+
+typedef char* strrchr_func(const char*, int);
+__LIBC_HIDDEN__ strrchr_func __strrchr_slm, __strrchr_avx2;
+DEFINE_IFUNC_RESOLVER(strrchr) {
+  return has_avx2() ? __strrchr_avx2 : __strrchr_slm;
+}
+
+}  // extern "C"
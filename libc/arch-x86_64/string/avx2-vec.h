@@ -0,0 +1,47 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+// Vector macros for the AVX2 instantiations of the *-vec.S templates. See
+// sse2-vec.h.
+
+#define VEC_SIZE	32
+#define VEC(i)		%ymm##i
+
+#define VMOVA(src, dst)		vmovdqa src, dst
+#define PCMPEQB(src, dst)	vpcmpeqb src, dst, dst
+#define PMINUB(src, dst)	vpminub src, dst, dst
+#define POR(src, dst)		vpor src, dst, dst
+#define PXOR(src, dst)		vpxor src, dst, dst
+#define PMOVMSKB(src, dst)	vpmovmskb src, dst
+
+/* Fill vector i with the low byte of the 32-bit register src.  */
+#define BROADCAST_BYTE(src, i) \
+	vmovd src, %xmm##i; \
+	vpbroadcastb %xmm##i, %ymm##i
+
+#define VZEROUPPER	vzeroupper
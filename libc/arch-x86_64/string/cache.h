@@ -34,3 +34,10 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #define SHARED_CACHE_SIZE_HALF	(SHARED_CACHE_SIZE / 2)
 #define DATA_CACHE_SIZE_HALF	(DATA_CACHE_SIZE / 2)
+
+/* Used by the AVX2 and AVX-512 memmove/memcpy/memset */
+/* Larger copies bypass the cache with non-temporal stores */
+#define NON_TEMPORAL_THRESHOLD	(SHARED_CACHE_SIZE * 3 / 4)
+/* Larger copies and sets use rep movsb/rep stosb */
+#define REP_MOVSB_THRESHOLD	(2048)
+#define REP_STOSB_THRESHOLD	(2048)
@@ -0,0 +1,50 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+// Vector macros for the SSE2 instantiations of the *-vec.S templates. The
+// templates only use two-operand forms, so the same source also assembles
+// with avx2-vec.h. Memory operands are always aligned.
+
+#define VEC_SIZE	16
+#define VEC(i)		%xmm##i
+
+#define VMOVA(src, dst)		movdqa src, dst
+#define PCMPEQB(src, dst)	pcmpeqb src, dst
+#define PMINUB(src, dst)	pminub src, dst
+#define POR(src, dst)		por src, dst
+#define PXOR(src, dst)		pxor src, dst
+#define PMOVMSKB(src, dst)	pmovmskb src, dst
+
+/* Fill vector i with the low byte of the 32-bit register src.  */
+#define BROADCAST_BYTE(src, i) \
+	movd src, %xmm##i; \
+	punpcklbw %xmm##i, %xmm##i; \
+	punpcklwd %xmm##i, %xmm##i; \
+	pshufd $0, %xmm##i, %xmm##i
+
+#define VZEROUPPER
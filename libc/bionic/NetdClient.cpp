@@ -46,7 +46,11 @@ static void netdClientInitImpl() {
                            &__netdClientDispatch.connect);
     netdClientInitFunction(netdClientHandle, "netdClientInitNetIdForResolv",
                            &__netdClientDispatch.netIdForResolv);
+    netdClientInitFunction(netdClientHandle, "netdClientInitNetworkGeneration",
+                           &__netdClientDispatch.networkGeneration);
     netdClientInitFunction(netdClientHandle, "netdClientInitSocket", &__netdClientDispatch.socket);
+    netdClientInitFunction(netdClientHandle, "netdClientInitSocketBatch",
+                           &__netdClientDispatch.socketBatch);
 }
 
 static pthread_once_t netdClientInitOnce = PTHREAD_ONCE_INIT;
@@ -16,6 +16,9 @@
 
 #include "private/NetdClientDispatch.h"
 
+#include <errno.h>
+#include <unistd.h>
+
 #ifdef __i386__
 #define __socketcall __attribute__((__cdecl__))
 #else
@@ -30,11 +33,30 @@ static unsigned fallBackNetIdForResolv(unsigned netId) {
     return netId;
 }
 
+// Goes through the socket hook, so that each socket is still marked if netd_client only
+// overrides that.
+static int fallBackSocketBatch(int domain, int type, int protocol, int* fds, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        fds[i] = __netdClientDispatch.socket(domain, type, protocol);
+        if (fds[i] == -1) {
+            int saved_errno = errno;
+            while (i > 0) {
+                close(fds[--i]);
+            }
+            errno = saved_errno;
+            return -1;
+        }
+    }
+    return 0;
+}
+
 // This structure is modified only at startup (when libc.so is loaded) and never
 // afterwards, so it's okay that it's read later at runtime without a lock.
 __LIBC_HIDDEN__ NetdClientDispatch __netdClientDispatch __attribute__((aligned(32))) = {
     __accept4,
     __connect,
     __socket,
+    fallBackSocketBatch,
     fallBackNetIdForResolv,
+    nullptr,
 };
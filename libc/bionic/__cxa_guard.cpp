@@ -21,6 +21,7 @@
 
 #include <stddef.h>
 
+#include "private/bionic_cpu_relax.h"
 #include "private/bionic_futex.h"
 
 // This file contains C++ ABI support functions for one time
@@ -78,8 +79,28 @@ union _guard_t {
 #define CONSTRUCTION_UNDERWAY_WITHOUT_WAITER    0x100
 #define CONSTRUCTION_UNDERWAY_WITH_WAITER       0x200
 
+// Most constructions are short, so before sleeping a thread that finds one underway watches the
+// guard for up to GUARD_SPIN_COUNT reads, with cpu_relax calls between them. That's a few
+// microseconds at most, less than a futex wait and the wake it forces on the constructing thread.
+#define GUARD_SPIN_COUNT 100
+
+static int __cxa_guard_spin(_guard_t* gv) {
+  int old_value = CONSTRUCTION_UNDERWAY_WITHOUT_WAITER;
+  for (int i = 0; i < GUARD_SPIN_COUNT; ++i) {
+    __cpu_relax();
+    old_value = atomic_load_explicit(&gv->state, memory_order_relaxed);
+    if (old_value != CONSTRUCTION_UNDERWAY_WITHOUT_WAITER) {
+      break;
+    }
+  }
+  return old_value;
+}
+
 extern "C" int __cxa_guard_acquire(_guard_t* gv) {
   int old_value = atomic_load_explicit(&gv->state, memory_order_relaxed);
+  if (old_value == CONSTRUCTION_UNDERWAY_WITHOUT_WAITER) {
+    old_value = __cxa_guard_spin(gv);
+  }
 
   while (true) {
     if (old_value == CONSTRUCTION_COMPLETE) {
@@ -96,6 +96,7 @@ void __libc_init_main_thread(KernelArgumentBlock& args) {
   __init_thread_stack_guard(&main_thread);
 
   __init_thread(&main_thread);
+  __init_rseq(&main_thread);
 
   // Store a pointer to the kernel argument block in a TLS slot to be
   // picked up by the libc constructor.
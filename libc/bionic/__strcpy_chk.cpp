@@ -34,8 +34,9 @@
 
 // Runtime implementation of __builtin____strcpy_chk (used directly by compiler, not in headers).
 extern "C" char* __strcpy_chk(char* dst, const char* src, size_t dst_len) {
-  // TODO: optimize so we don't scan src twice.
+  // Now that we know the length, a memcpy is cheaper than strcpy looking
+  // for the NUL all over again.
   size_t src_len = strlen(src) + 1;
   __check_buffer_access("strcpy", "write into", src_len, dst_len);
-  return strcpy(dst, src);
+  return reinterpret_cast<char*>(memcpy(dst, src, src_len));
 }
@@ -16,8 +16,45 @@
 
 #include "private/NetdClientDispatch.h"
 
+#include <fcntl.h>
+#include <poll.h>
 #include <sys/socket.h>
 
 int accept4(int sockfd, sockaddr* addr, socklen_t* addrlen, int flags) {
     return __netdClientDispatch.accept4(sockfd, addr, addrlen, flags);
 }
+
+int android_accept4_batch(int fd, int* fds, sockaddr_storage* addrs, size_t count, int flags) {
+    // Whether fd is in non-blocking mode, checked once there's a second connection to accept.
+    int nonblocking = -1;
+    size_t accepted = 0;
+    while (accepted < count) {
+        if (accepted > 0) {
+            if (nonblocking == -1) {
+                int fd_flags = fcntl(fd, F_GETFL);
+                if (fd_flags == -1) break;
+                nonblocking = (fd_flags & O_NONBLOCK) != 0;
+            }
+            // Don't wait for more connections than were already pending.
+            if (!nonblocking) {
+                pollfd pfd = { fd, POLLIN, 0 };
+                if (poll(&pfd, 1, 0) != 1) break;
+            }
+        }
+
+        sockaddr* addr = nullptr;
+        socklen_t addr_len = sizeof(sockaddr_storage);
+        if (addrs != nullptr) {
+            addr = reinterpret_cast<sockaddr*>(&addrs[accepted]);
+        }
+        int new_fd = __netdClientDispatch.accept4(fd, addr, addr != nullptr ? &addr_len : nullptr,
+                                                  flags);
+        if (new_fd == -1) {
+            // Report the error now if nothing was accepted, and otherwise on the next call.
+            if (accepted == 0) return -1;
+            break;
+        }
+        fds[accepted++] = new_fd;
+    }
+    return accepted;
+}
@@ -0,0 +1,308 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+// The ChaCha20 based generator from OpenBSD's arc4random.c, with a state per thread instead of
+// one global state behind a lock.
+
+#include <signal.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "private/bionic_prctl.h"
+#include "private/thread_private.h"
+#include "pthread_internal.h"
+
+// From getentropy_linux.c, which isn't mentioned in any header.
+extern "C" __LIBC_HIDDEN__ int getentropy(void*, size_t);
+
+#define KEYSZ 32
+#define IVSZ 8
+#define BLOCKSZ 64
+#define RSBUFSZ (16 * BLOCKSZ)
+
+// How many bytes a state hands out before it's reseeded.
+#define RESEED_BYTES 1600000
+
+// arc4random_buf requests at least this big get keystream written straight into them.
+#define BULK_BYTES (4 * BLOCKSZ)
+
+struct arc4random_state {
+  uint32_t input[16];       // ChaCha20 constants, key, block counter and iv.
+  size_t have;              // Valid bytes at the end of buf.
+  size_t count;             // Bytes until the next reseed.
+  pid_t pid;                // The process this state was last seeded in...
+  uint32_t fork_generation; // ...and how many forks deep that was.
+  uint8_t buf[RSBUFSZ];     // Keystream.
+};
+
+// Incremented in every fork child, so that each state it inherited gets reseeded before use. The
+// pid check alone would miss a grandchild that happens to reuse its grandparent's pid.
+static volatile uint32_t g_fork_generation = 1;
+
+// Used under the arc4random lock before this thread's pthread_internal_t is set up, after it has
+// gone away at thread exit, or if its own state can't be mapped.
+static arc4random_state g_shared_state;
+
+#define ARC4RANDOM_STATE_CLOSED reinterpret_cast<arc4random_state*>(MAP_FAILED)
+
+typedef uint32_t u32x4 __attribute__((__vector_size__(16)));
+
+static inline u32x4 rotl(u32x4 v, int c) {
+  return (v << c) | (v >> (32 - c));
+}
+
+#define QUARTERROUND(a, b, c, d) \
+  a += b; d = rotl(d ^ a, 16); \
+  c += d; b = rotl(b ^ c, 12); \
+  a += b; d = rotl(d ^ a, 8); \
+  c += d; b = rotl(b ^ c, 7)
+
+// Writes the next four blocks of keystream to out, and moves the block counter past them. Each
+// vector holds the same word of all four blocks, so the rounds are plain lane-wise arithmetic
+// that compiles to NEON or SSE2, and the blocks are transposed back just before they're stored.
+// (Android is little-endian only, so the words can be stored as they are.)
+static void chacha_blocks4(uint32_t* input, uint8_t* out) {
+  uint64_t counter = input[12] | (static_cast<uint64_t>(input[13]) << 32);
+
+  u32x4 start[16];
+  for (size_t i = 0; i < 16; i++) {
+    start[i] = u32x4{input[i], input[i], input[i], input[i]};
+  }
+  for (uint32_t j = 0; j < 4; j++) {
+    start[12][j] = static_cast<uint32_t>(counter + j);
+    start[13][j] = static_cast<uint32_t>((counter + j) >> 32);
+  }
+
+  u32x4 x[16];
+  memcpy(x, start, sizeof(x));
+  for (size_t i = 0; i < 10; i++) {
+    QUARTERROUND(x[0], x[4], x[8], x[12]);
+    QUARTERROUND(x[1], x[5], x[9], x[13]);
+    QUARTERROUND(x[2], x[6], x[10], x[14]);
+    QUARTERROUND(x[3], x[7], x[11], x[15]);
+    QUARTERROUND(x[0], x[5], x[10], x[15]);
+    QUARTERROUND(x[1], x[6], x[11], x[12]);
+    QUARTERROUND(x[2], x[7], x[8], x[13]);
+    QUARTERROUND(x[3], x[4], x[9], x[14]);
+  }
+  for (size_t i = 0; i < 16; i++) {
+    x[i] += start[i];
+  }
+
+  for (size_t i = 0; i < 16; i += 4) {
+    u32x4 t0 = __builtin_shufflevector(x[i], x[i + 1], 0, 4, 1, 5);
+    u32x4 t1 = __builtin_shufflevector(x[i], x[i + 1], 2, 6, 3, 7);
+    u32x4 t2 = __builtin_shufflevector(x[i + 2], x[i + 3], 0, 4, 1, 5);
+    u32x4 t3 = __builtin_shufflevector(x[i + 2], x[i + 3], 2, 6, 3, 7);
+    u32x4 b0 = __builtin_shufflevector(t0, t2, 0, 1, 4, 5);
+    u32x4 b1 = __builtin_shufflevector(t0, t2, 2, 3, 6, 7);
+    u32x4 b2 = __builtin_shufflevector(t1, t3, 0, 1, 4, 5);
+    u32x4 b3 = __builtin_shufflevector(t1, t3, 2, 3, 6, 7);
+    memcpy(out + 0 * BLOCKSZ + i * 4, &b0, sizeof(b0));
+    memcpy(out + 1 * BLOCKSZ + i * 4, &b1, sizeof(b1));
+    memcpy(out + 2 * BLOCKSZ + i * 4, &b2, sizeof(b2));
+    memcpy(out + 3 * BLOCKSZ + i * 4, &b3, sizeof(b3));
+  }
+
+  counter += 4;
+  input[12] = static_cast<uint32_t>(counter);
+  input[13] = static_cast<uint32_t>(counter >> 32);
+}
+
+static void chacha_keysetup(arc4random_state* st, const uint8_t* key_and_iv) {
+  // "expand 32-byte k".
+  st->input[0] = 0x61707865;
+  st->input[1] = 0x3320646e;
+  st->input[2] = 0x79622d32;
+  st->input[3] = 0x6b206574;
+  memcpy(&st->input[4], key_and_iv, KEYSZ);
+  st->input[12] = 0;
+  st->input[13] = 0;
+  memcpy(&st->input[14], key_and_iv + KEYSZ, IVSZ);
+}
+
+static void rs_fill(arc4random_state* st) {
+  for (size_t i = 0; i < sizeof(st->buf); i += 4 * BLOCKSZ) {
+    chacha_blocks4(st->input, st->buf + i);
+  }
+}
+
+static void rs_rekey(arc4random_state* st) {
+  rs_fill(st);
+  // Immediately reinit for backtracking resistance.
+  chacha_keysetup(st, st->buf);
+  memset(st->buf, 0, KEYSZ + IVSZ);
+  st->have = sizeof(st->buf) - KEYSZ - IVSZ;
+}
+
+static void rs_stir(arc4random_state* st) {
+  uint8_t rnd[KEYSZ + IVSZ];
+  if (getentropy(rnd, sizeof(rnd)) == -1) {
+    raise(SIGKILL);
+  }
+
+  // The seed is mixed into keystream from the old key rather than replacing it. A state that has
+  // never been seeded is all zeroes, which is just as good a starting point.
+  rs_fill(st);
+  for (size_t i = 0; i < sizeof(rnd); i++) {
+    st->buf[i] ^= rnd[i];
+  }
+  chacha_keysetup(st, st->buf);
+  memset(rnd, 0, sizeof(rnd));
+
+  // Invalidate buf.
+  memset(st->buf, 0, sizeof(st->buf));
+  st->have = 0;
+  st->count = RESEED_BYTES;
+}
+
+static void rs_stir_if_needed(arc4random_state* st, size_t len) {
+  pid_t pid = getpid();
+  if (__predict_false(st->pid != pid || st->fork_generation != g_fork_generation)) {
+    st->pid = pid;
+    st->fork_generation = g_fork_generation;
+    st->count = 0;
+  }
+  if (st->count <= len) {
+    rs_stir(st);
+  }
+  if (st->count <= len) {
+    st->count = 0;
+  } else {
+    st->count -= len;
+  }
+}
+
+static void rs_random_buf(arc4random_state* st, void* buf_, size_t n) {
+  uint8_t* buf = static_cast<uint8_t*>(buf_);
+
+  rs_stir_if_needed(st, n);
+
+  // Bulk requests skip the copy through buf. The key is replaced afterwards, so the output still
+  // can't be recovered from the state.
+  if (n >= BULK_BYTES) {
+    do {
+      chacha_blocks4(st->input, buf);
+      buf += BULK_BYTES;
+      n -= BULK_BYTES;
+    } while (n >= BULK_BYTES);
+    rs_rekey(st);
+  }
+
+  while (n > 0) {
+    if (st->have > 0) {
+      size_t m = (n < st->have) ? n : st->have;
+      uint8_t* keystream = st->buf + sizeof(st->buf) - st->have;
+      memcpy(buf, keystream, m);
+      memset(keystream, 0, m);
+      buf += m;
+      n -= m;
+      st->have -= m;
+    }
+    if (st->have == 0) {
+      rs_rekey(st);
+    }
+  }
+}
+
+static void rs_random_u32(arc4random_state* st, uint32_t* val) {
+  rs_stir_if_needed(st, sizeof(*val));
+  if (st->have < sizeof(*val)) {
+    rs_rekey(st);
+  }
+  uint8_t* keystream = st->buf + sizeof(st->buf) - st->have;
+  memcpy(val, keystream, sizeof(*val));
+  memset(keystream, 0, sizeof(*val));
+  st->have -= sizeof(*val);
+}
+
+// Returns this thread's state, mapping it the first time, or null if g_shared_state has to be
+// used instead.
+static arc4random_state* get_thread_state() {
+  pthread_internal_t* thread = __get_thread();
+  if (__predict_false(thread == nullptr)) {
+    return nullptr;
+  }
+  arc4random_state* st = thread->arc4random;
+  if (__predict_true(st != nullptr && st != ARC4RANDOM_STATE_CLOSED)) {
+    return st;
+  }
+  if (st == ARC4RANDOM_STATE_CLOSED) {
+    return nullptr;
+  }
+
+  void* p = mmap(nullptr, sizeof(arc4random_state), PROT_READ | PROT_WRITE,
+                 MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (p == MAP_FAILED) {
+    return nullptr;
+  }
+  prctl(PR_SET_VMA, PR_SET_VMA_ANON_NAME, p, sizeof(arc4random_state), "arc4random state");
+  st = thread->arc4random = reinterpret_cast<arc4random_state*>(p);
+  return st;
+}
+
+uint32_t arc4random() {
+  uint32_t val;
+  arc4random_state* st = get_thread_state();
+  if (__predict_true(st != nullptr)) {
+    rs_random_u32(st, &val);
+  } else {
+    _ARC4_LOCK();
+    rs_random_u32(&g_shared_state, &val);
+    _ARC4_UNLOCK();
+  }
+  return val;
+}
+
+void arc4random_buf(void* buf, size_t n) {
+  arc4random_state* st = get_thread_state();
+  if (__predict_true(st != nullptr)) {
+    rs_random_buf(st, buf, n);
+  } else {
+    _ARC4_LOCK();
+    rs_random_buf(&g_shared_state, buf, n);
+    _ARC4_UNLOCK();
+  }
+}
+
+void __arc4random_fork_child() {
+  g_fork_generation = g_fork_generation + 1;
+  _thread_arc4_unlock();
+}
+
+void __arc4random_thread_exit(pthread_internal_t* thread) {
+  arc4random_state* st = thread->arc4random;
+  thread->arc4random = ARC4RANDOM_STATE_CLOSED;
+  if (st != nullptr && st != ARC4RANDOM_STATE_CLOSED) {
+    memset(st, 0, sizeof(*st));
+    munmap(st, sizeof(*st));
+  }
+}
@@ -0,0 +1,317 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include "private/bionic_decimal.h"
+
+// Multiplication by powers of ten in 128-bit fixed point, shared by the fast paths for
+// converting doubles to decimal (printf) and decimal to doubles (strtod).
+
+namespace {
+
+struct CachedPower {
+  uint64_t hi;
+  uint64_t lo;
+  int16_t e2;
+};
+
+// 10^m for every eighth m from -328 to 344: the 128-bit mantissa, rounded to nearest, with
+// its top bit set, and the power of two it's scaled by.
+#define CACHED_POWER_MIN (-328)
+#define CACHED_POWER_STEP 8
+
+static const CachedPower kCachedPowers[] = {
+  { 0xa9c98d8ccb009506ULL, 0x680efdaf511f18c2ULL, -1217 },  // 1e-328
+  { 0xfd00b897478238d0ULL, 0x8920b098955522b5ULL, -1191 },  // 1e-320
+  { 0xbc807527ed3e12bcULL, 0xc605083704f5ecf2ULL, -1164 },  // 1e-312
+  { 0x8c71dcd9ba0b4925ULL, 0x9ff0c08b7f1d0b15ULL, -1137 },  // 1e-304
+  { 0xd1476e2c07286faaULL, 0x1af5af660db4aee2ULL, -1111 },  // 1e-296
+  { 0x9becce62836ac577ULL, 0x4ee367f9430aec33ULL, -1084 },  // 1e-288
+  { 0xe858ad248f5c22c9ULL, 0xd1b3400f8f9cff69ULL, -1058 },  // 1e-280
+  { 0xad1c8eab5ee43b66ULL, 0xda3243650005eecfULL, -1031 },  // 1e-272
+  { 0x80fa687f881c7f8eULL, 0x7ce66634bc9d0b9aULL, -1004 },  // 1e-264
+  { 0xc0314325637a1939ULL, 0xfa911155fefb5309ULL, -978 },  // 1e-256
+  { 0x8f31cc0937ae58d2ULL, 0xd1b2ecb8b0908811ULL, -951 },  // 1e-248
+  { 0xd5605fcdcf32e1d6ULL, 0xfb1e4a9a90880a65ULL, -925 },  // 1e-240
+  { 0x9efa548d26e5a6e1ULL, 0xc47bc5014a1a6db0ULL, -898 },  // 1e-232
+  { 0xece53cec4a314ebdULL, 0xa4f8bf5635246428ULL, -872 },  // 1e-224
+  { 0xb080392cc4349decULL, 0xbd8d794d96aacfb4ULL, -845 },  // 1e-216
+  { 0x8380dea93da4bc60ULL, 0x4247cb9e59f71e6dULL, -818 },  // 1e-208
+  { 0xc3f490aa77bd60fcULL, 0xbedbfc4411068a9dULL, -792 },  // 1e-200
+  { 0x91ff83775423cc06ULL, 0x7b6306a34627ddcfULL, -765 },  // 1e-192
+  { 0xd98ddaee19068c76ULL, 0x3badd624dd9b0957ULL, -739 },  // 1e-184
+  { 0xa21727db38cb002fULL, 0xb8ada00e5a506a7dULL, -712 },  // 1e-176
+  { 0xf18899b1bc3f8ca1ULL, 0xdc44e6c3cb279ac2ULL, -686 },  // 1e-168
+  { 0xb3f4e093db73a093ULL, 0x59ed216765690f57ULL, -659 },  // 1e-160
+  { 0x8613fd0145877585ULL, 0xbd06742ce95f5f37ULL, -632 },  // 1e-152
+  { 0xc7caba6e7c5382c8ULL, 0xfe64a52ee96b8fc1ULL, -606 },  // 1e-144
+  { 0x94db483840b717efULL, 0xa8c2a44eb4571cdcULL, -579 },  // 1e-136
+  { 0xddd0467c64bce4a0ULL, 0xac7cb3f6d05ddbdfULL, -553 },  // 1e-128
+  { 0xa54394fe1eedb8feULL, 0xc2974eb4ee658829ULL, -526 },  // 1e-120
+  { 0xf64335bcf065d37dULL, 0x4d4617b5ff4a16d6ULL, -500 },  // 1e-112
+  { 0xb77ada0617e3bbcbULL, 0x09ce6ebb40173745ULL, -473 },  // 1e-104
+  { 0x88b402f7fd75539bULL, 0x11dbcb0218ebb414ULL, -446 },  // 1e-96
+  { 0xcbb41ef979346bcaULL, 0x4f2b40a03ad2ffbaULL, -420 },  // 1e-88
+  { 0x97c560ba6b0919a5ULL, 0xdccd879fc967d41aULL, -393 },  // 1e-80
+  { 0xe2280b6c20dd5232ULL, 0x25c6da63c38de1b0ULL, -367 },  // 1e-72
+  { 0xa87fea27a539e9a5ULL, 0x3f2398d747b36224ULL, -340 },  // 1e-64
+  { 0xfb158592be068d2eULL, 0xeed6e2f0f0d56713ULL, -314 },  // 1e-56
+  { 0xbb127c53b17ec159ULL, 0x5560c018580d5d52ULL, -287 },  // 1e-48
+  { 0x8b61313bbabce2c6ULL, 0x2323ac4b3b3da015ULL, -260 },  // 1e-40
+  { 0xcfb11ead453994baULL, 0x67de18eda5814af2ULL, -234 },  // 1e-32
+  { 0x9abe14cd44753b52ULL, 0xc4926a9672793543ULL, -207 },  // 1e-24
+  { 0xe69594bec44de15bULL, 0x4c2ebe687989a9b4ULL, -181 },  // 1e-16
+  { 0xabcc77118461cefcULL, 0xfdc20d2b36ba7c3dULL, -154 },  // 1e-8
+  { 0x8000000000000000ULL, 0x0000000000000000ULL, -127 },  // 1e0
+  { 0xbebc200000000000ULL, 0x0000000000000000ULL, -101 },  // 1e8
+  { 0x8e1bc9bf04000000ULL, 0x0000000000000000ULL, -74 },  // 1e16
+  { 0xd3c21bcecceda100ULL, 0x0000000000000000ULL, -48 },  // 1e24
+  { 0x9dc5ada82b70b59dULL, 0xf020000000000000ULL, -21 },  // 1e32
+  { 0xeb194f8e1ae525fdULL, 0x5dcfab0800000000ULL, 5 },  // 1e40
+  { 0xaf298d050e4395d6ULL, 0x9670b12b7f410000ULL, 32 },  // 1e48
+  { 0x82818f1281ed449fULL, 0xbff8f10e7a8921a4ULL, 59 },  // 1e56
+  { 0xc2781f49ffcfa6d5ULL, 0x3cbf6b71c76b25fbULL, 85 },  // 1e64
+  { 0x90e40fbeea1d3a4aULL, 0xbc8955e946fe31ceULL, 112 },  // 1e72
+  { 0xd7e77a8f87daf7fbULL, 0xdc33745ec97be906ULL, 138 },  // 1e80
+  { 0xa0dc75f1778e39d6ULL, 0x696361ae3db1c721ULL, 165 },  // 1e88
+  { 0xefb3ab16c59b14a2ULL, 0xc5cfe94ef3ea101eULL, 191 },  // 1e96
+  { 0xb2977ee300c50fe7ULL, 0x58edec91ec2cb658ULL, 218 },  // 1e104
+  { 0x850fadc09923329eULL, 0x03e2cf6bc604ddb0ULL, 245 },  // 1e112
+  { 0xc646d63501a1511dULL, 0xb281e1fd541501b9ULL, 271 },  // 1e120
+  { 0x93ba47c980e98cdfULL, 0xc66f336c36b10137ULL, 298 },  // 1e128
+  { 0xdc21a1171d42645dULL, 0x76707543f4fa1f74ULL, 324 },  // 1e136
+  { 0xa402b9c5a8d3a6e7ULL, 0x5f16206c9c6209a6ULL, 351 },  // 1e144
+  { 0xf46518c2ef5b8cd1ULL, 0x7eb258665fc25d69ULL, 377 },  // 1e152
+  { 0xb616a12b7fe617aaULL, 0x577b986b314d6009ULL, 404 },  // 1e160
+  { 0x87aa9aff79042286ULL, 0x90fb44d2f05d0843ULL, 431 },  // 1e168
+  { 0xca28a291859bbf93ULL, 0x7d7b8f7503cfdcffULL, 457 },  // 1e176
+  { 0x969eb7c47859e743ULL, 0x9f644ae5a4b1b325ULL, 484 },  // 1e184
+  { 0xe070f78d3927556aULL, 0x85bbe253f47b1417ULL, 510 },  // 1e192
+  { 0xa738c6bebb12d16cULL, 0xb428f8ac016561dbULL, 537 },  // 1e200
+  { 0xf92e0c3537826145ULL, 0xa7709a56ccdf8a83ULL, 563 },  // 1e208
+  { 0xb9a74a0637ce2ee1ULL, 0x6d953e2bd7173693ULL, 590 },  // 1e216
+  { 0x8a5296ffe33cc92fULL, 0x82bd6b70d99aaa70ULL, 617 },  // 1e224
+  { 0xce1de40642e3f4b9ULL, 0x36251260ab9d668fULL, 643 },  // 1e232
+  { 0x9991a6f3d6bf1765ULL, 0xacca6da1e0a8ef29ULL, 670 },  // 1e240
+  { 0xe4d5e82392a40515ULL, 0x0fabaf3feaa5334aULL, 696 },  // 1e248
+  { 0xaa7eebfb9df9de8dULL, 0xddbb901b98feeab8ULL, 723 },  // 1e256
+  { 0xfe0efb53d30dd4d7ULL, 0xed238cd383aa0111ULL, 749 },  // 1e264
+  { 0xbd49d14aa79dbc82ULL, 0x4b2d8644d8a74e19ULL, 776 },  // 1e272
+  { 0x8d07e33455637eb2ULL, 0xdb0b487b6423e1e8ULL, 803 },  // 1e280
+  { 0xd226fc195c6a2f8cULL, 0x73832eec6fff3112ULL, 829 },  // 1e288
+  { 0x9c935e00d4b9d8d2ULL, 0x6ed1bf9a569f33d3ULL, 856 },  // 1e296
+  { 0xe950df20247c83fdULL, 0x47c6b82ef32a2069ULL, 882 },  // 1e304
+  { 0xadd57a27d29339f6ULL, 0x79c5db9af1f9b563ULL, 909 },  // 1e312
+  { 0x81842f29f2cce375ULL, 0xe6a1158300d46640ULL, 936 },  // 1e320
+  { 0xc0fe908895cf3b44ULL, 0x505f522e53053ff2ULL, 962 },  // 1e328
+  { 0x8fcac257558ee4e6ULL, 0x213a4f0aa5e8a7b2ULL, 989 },  // 1e336
+  { 0xd6444e39c3db9b09ULL, 0x848ce34679abb01cULL, 1015 },  // 1e344
+};
+
+#define CACHED_POWER_COUNT static_cast<int>(sizeof(kCachedPowers) / sizeof(kCachedPowers[0]))
+#define CACHED_POWER_MAX (CACHED_POWER_MIN + CACHED_POWER_STEP * (CACHED_POWER_COUNT - 1))
+
+static const uint64_t kPowersOfFive[] = {
+  1ULL,
+  5ULL,
+  25ULL,
+  125ULL,
+  625ULL,
+  3125ULL,
+  15625ULL,
+  78125ULL,
+  390625ULL,
+  1953125ULL,
+  9765625ULL,
+  48828125ULL,
+  244140625ULL,
+  1220703125ULL,
+  6103515625ULL,
+  30517578125ULL,
+  152587890625ULL,
+  762939453125ULL,
+  3814697265625ULL,
+  19073486328125ULL,
+  95367431640625ULL,
+  476837158203125ULL,
+  2384185791015625ULL,
+  11920928955078125ULL,
+  59604644775390625ULL,
+  298023223876953125ULL,
+  1490116119384765625ULL,
+  7450580596923828125ULL,
+};
+
+// The largest power of ten we can represent exactly, as 5^m * 2^m with 5^m in 128 bits.
+#define EXACT_POWER_MAX 54
+
+static inline uint64_t Mul64(uint64_t a, uint64_t b, uint64_t* hi) {
+#if defined(__SIZEOF_INT128__)
+  unsigned __int128 p = static_cast<unsigned __int128>(a) * b;
+  *hi = static_cast<uint64_t>(p >> 64);
+  return static_cast<uint64_t>(p);
+#else
+  uint64_t a_lo = static_cast<uint32_t>(a), a_hi = a >> 32;
+  uint64_t b_lo = static_cast<uint32_t>(b), b_hi = b >> 32;
+  uint64_t p0 = a_lo * b_lo, p1 = a_lo * b_hi, p2 = a_hi * b_lo, p3 = a_hi * b_hi;
+  uint64_t mid = (p0 >> 32) + static_cast<uint32_t>(p1) + static_cast<uint32_t>(p2);
+  *hi = p3 + (p1 >> 32) + (p2 >> 32) + (mid >> 32);
+  return (mid << 32) | static_cast<uint32_t>(p0);
+#endif
+}
+
+// Bits [b, b + 64) of the 192-bit little-endian number q, where b may be negative.
+static uint64_t BitsAt(const uint64_t* q, int b) {
+  if (b <= -64 || b >= 192) return 0;
+  if (b < 0) return q[0] << -b;
+  int word = b / 64, shift = b % 64;
+  uint64_t result = q[word] >> shift;
+  if (shift != 0 && word < 2) result |= q[word + 1] << (64 - shift);
+  return result;
+}
+
+// Whether q has any bits set below bit b.
+static bool AnyBitsBelow(const uint64_t* q, int b) {
+  if (b <= 0) return false;
+  if (b >= 192) return (q[0] | q[1] | q[2]) != 0;
+  int word = b / 64, shift = b % 64;
+  for (int i = 0; i < word; ++i) {
+    if (q[i] != 0) return true;
+  }
+  return shift != 0 && (q[word] & ((UINT64_C(1) << shift) - 1)) != 0;
+}
+
+}  // namespace
+
+const uint64_t powers_of_ten[20] = {
+  1ULL,
+  10ULL,
+  100ULL,
+  1000ULL,
+  10000ULL,
+  100000ULL,
+  1000000ULL,
+  10000000ULL,
+  100000000ULL,
+  1000000000ULL,
+  10000000000ULL,
+  100000000000ULL,
+  1000000000000ULL,
+  10000000000000ULL,
+  100000000000000ULL,
+  1000000000000000ULL,
+  10000000000000000ULL,
+  100000000000000000ULL,
+  1000000000000000000ULL,
+  10000000000000000000ULL,
+};
+
+bool scale_by_power_of_ten(uint64_t f, int e, int m, ScaledValue* result) {
+  if (m < 0 && m >= -18 && e <= 0 && e > -64 && (f & ((UINT64_C(1) << -e) - 1)) == 0) {
+    // An integer divided by a power of ten that fits in 64 bits. Dividing is exact, and
+    // we only need to know how the remainder compares to a half.
+    uint64_t value = f >> -e;
+    uint64_t divisor = powers_of_ten[-m];
+    uint64_t remainder = value % divisor;
+    result->integer = value / divisor;
+    result->fraction = (remainder * 2 >= divisor) ? UINT64_C(1) << 63 : 0;
+    result->sticky = (remainder * 2 != divisor && remainder != 0);
+    result->exact = true;
+    return true;
+  }
+
+  uint64_t p_hi, p_lo;
+  int e2;
+  if (m >= 0 && m <= EXACT_POWER_MAX) {
+    if (m <= 27) {
+      p_hi = 0;
+      p_lo = kPowersOfFive[m];
+    } else {
+      p_lo = Mul64(kPowersOfFive[27], kPowersOfFive[m - 27], &p_hi);
+    }
+    e2 = m;
+    result->exact = true;
+  } else {
+    if (m < CACHED_POWER_MIN || m >= CACHED_POWER_MAX + CACHED_POWER_STEP) return false;
+    const CachedPower& c = kCachedPowers[(m - CACHED_POWER_MIN) / CACHED_POWER_STEP];
+    int r = (m - CACHED_POWER_MIN) % CACHED_POWER_STEP;
+
+    // Multiply by 10^r = 5^r * 2^r, then drop the low bits to get back to 128.
+    uint64_t lo_carry, hi_carry;
+    uint64_t w0 = Mul64(c.lo, kPowersOfFive[r], &lo_carry);
+    uint64_t w1 = Mul64(c.hi, kPowersOfFive[r], &hi_carry);
+    w1 += lo_carry;
+    hi_carry += (w1 < lo_carry);
+    int shift = (hi_carry == 0) ? 0 : 64 - __builtin_clzll(hi_carry);
+    if (shift == 0) {
+      p_hi = w1;
+      p_lo = w0;
+    } else {
+      p_hi = (hi_carry << (64 - shift)) | (w1 >> shift);
+      p_lo = (w1 << (64 - shift)) | (w0 >> shift);
+    }
+    e2 = c.e2 + r + shift;
+    result->exact = false;
+  }
+
+  // q = f * p, exactly.
+  uint64_t q[3];
+  uint64_t lo_hi, hi_hi;
+  q[0] = Mul64(f, p_lo, &lo_hi);
+  uint64_t mid = Mul64(f, p_hi, &hi_hi);
+  q[1] = lo_hi + mid;
+  q[2] = hi_hi + (q[1] < mid);
+
+  // The value is q * 2^(e + e2), so its integer part starts at bit b of q.
+  int b = -(e + e2);
+  if ((BitsAt(q, b + 64) | BitsAt(q, b + 128) | BitsAt(q, b + 192)) != 0) return false;
+  result->integer = BitsAt(q, b);
+  result->fraction = BitsAt(q, b - 64);
+  result->sticky = AnyBitsBelow(q, b - 64);
+  return true;
+}
+
+bool round_scaled_value(const ScaledValue& s, uint64_t* result) {
+  const uint64_t half = UINT64_C(1) << 63;
+  bool up;
+  if (s.exact) {
+    // Like gdtoa, break exact ties to even.
+    if (s.fraction == half && !s.sticky) {
+      up = (s.integer & 1);
+    } else {
+      up = (s.fraction >= half);
+    }
+  } else {
+    // The error in scale_by_power_of_ten is well under 8 units.
+    const uint64_t slop = 8;
+    if (s.fraction > half - slop && s.fraction < half + slop) return false;
+    up = (s.fraction > half);
+  }
+  if (up && s.integer == UINT64_MAX) return false;
+  *result = s.integer + up;
+  return true;
+}
@@ -0,0 +1,162 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include "private/bionic_elf_tls.h"
+
+#include <link.h>
+#include <malloc.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/param.h>
+
+#include "private/libc_logging.h"
+
+#if defined(__aarch64__)
+static_assert(BIONIC_TLS_SLOT_DTV_OFFSET == TLS_SLOT_DTV * sizeof(void*), "TLS_SLOT_DTV moved");
+static_assert(BIONIC_TLS_DTV_COUNT_OFFSET == offsetof(TlsDtv, count), "TlsDtv changed");
+static_assert(BIONIC_TLS_DTV_MODULES_OFFSET == offsetof(TlsDtv, modules), "TlsDtv changed");
+#endif
+
+struct TlsSegmentSearch {
+  size_t module_id;
+  unsigned long long subs;
+  const ElfW(Phdr)* segment;
+  ElfW(Addr) load_bias;
+};
+
+static int find_tls_segment(dl_phdr_info* info, size_t size, void* arg) {
+  TlsSegmentSearch* search = reinterpret_cast<TlsSegmentSearch*>(arg);
+  search->subs = info->dlpi_subs;
+  if (size < sizeof(dl_phdr_info) || info->dlpi_tls_modid != search->module_id) return 0;
+  for (size_t i = 0; i < info->dlpi_phnum; ++i) {
+    if (info->dlpi_phdr[i].p_type == PT_TLS) {
+      search->segment = &info->dlpi_phdr[i];
+      search->load_bias = info->dlpi_addr;
+      return 1;
+    }
+  }
+  return 0;
+}
+
+struct TlsLiveModules {
+  size_t count;
+  bool* live;
+};
+
+static int mark_live_module(dl_phdr_info* info, size_t size, void* arg) {
+  TlsLiveModules* modules = reinterpret_cast<TlsLiveModules*>(arg);
+  if (size >= sizeof(dl_phdr_info) && info->dlpi_tls_modid != 0 &&
+      info->dlpi_tls_modid <= modules->count) {
+    modules->live[info->dlpi_tls_modid - 1] = true;
+  }
+  return 0;
+}
+
+// Module ids aren't reused, so the blocks of unloaded libraries would otherwise only be freed
+// when the thread exits.
+static void free_unloaded_blocks(TlsDtv* dtv) {
+  TlsLiveModules modules = { dtv->count, static_cast<bool*>(calloc(dtv->count, sizeof(bool))) };
+  if (modules.live == nullptr) return;
+  dl_iterate_phdr(mark_live_module, &modules);
+  for (size_t i = 0; i < dtv->count; ++i) {
+    if (!modules.live[i] && dtv->modules[i] != nullptr) {
+      free(dtv->modules[i]);
+      dtv->modules[i] = nullptr;
+    }
+  }
+  free(modules.live);
+}
+
+static void* tls_get_addr_slow_path(const TlsIndex* ti) {
+  TlsSegmentSearch search = { ti->module_id, 0, nullptr, 0 };
+  dl_iterate_phdr(find_tls_segment, &search);
+  const ElfW(Phdr)* segment = search.segment;
+  if (segment == nullptr) {
+    __libc_fatal("__tls_get_addr: no TLS segment with module id %zu", ti->module_id);
+  }
+
+  void** tls = __get_tls();
+  TlsDtv* dtv = reinterpret_cast<TlsDtv*>(tls[TLS_SLOT_DTV]);
+  if (dtv != nullptr && dtv->subs != search.subs) {
+    free_unloaded_blocks(dtv);
+    dtv->subs = search.subs;
+  }
+
+  if (dtv == nullptr || ti->module_id > dtv->count) {
+    size_t old_count = (dtv != nullptr) ? dtv->count : 0;
+    size_t count = MAX(ti->module_id, MAX(old_count * 2, 8));
+    dtv = reinterpret_cast<TlsDtv*>(realloc(dtv, sizeof(TlsDtv) + count * sizeof(void*)));
+    if (dtv == nullptr) {
+      __libc_fatal("__tls_get_addr: couldn't allocate a DTV for %zu modules", count);
+    }
+    if (old_count == 0) dtv->subs = search.subs;
+    memset(&dtv->modules[old_count], 0, (count - old_count) * sizeof(void*));
+    dtv->count = count;
+    tls[TLS_SLOT_DTV] = dtv;
+  }
+
+  void*& block = dtv->modules[ti->module_id - 1];
+  if (block == nullptr) {
+    block = memalign(MAX(segment->p_align, sizeof(void*)), MAX(segment->p_memsz, 1));
+    if (block == nullptr) {
+      __libc_fatal("__tls_get_addr: couldn't allocate %zu bytes of TLS for module id %zu",
+                   static_cast<size_t>(segment->p_memsz), ti->module_id);
+    }
+    const void* image = reinterpret_cast<void*>(search.load_bias + segment->p_vaddr);
+    memcpy(block, image, segment->p_filesz);
+    memset(static_cast<char*>(block) + segment->p_filesz, 0,
+           segment->p_memsz - segment->p_filesz);
+  }
+  return static_cast<char*>(block) + ti->offset;
+}
+
+extern "C" void* __tls_get_addr(const TlsIndex* ti) {
+  void* block = __get_dynamic_tls_block(ti->module_id);
+  if (__predict_true(block != nullptr)) {
+    return static_cast<char*>(block) + ti->offset;
+  }
+  return tls_get_addr_slow_path(ti);
+}
+
+#if defined(__i386__)
+// The x86 compilers call this variant instead, with the argument in %eax.
+extern "C" __attribute__((__regparm__(1))) void* ___tls_get_addr(const TlsIndex* ti) {
+  return __tls_get_addr(ti);
+}
+#endif
+
+void __free_dynamic_tls() {
+  void** tls = __get_tls();
+  TlsDtv* dtv = reinterpret_cast<TlsDtv*>(tls[TLS_SLOT_DTV]);
+  if (dtv == nullptr) return;
+  tls[TLS_SLOT_DTV] = nullptr;
+  for (size_t i = 0; i < dtv->count; ++i) {
+    free(dtv->modules[i]);
+  }
+  free(dtv);
+}
@@ -41,21 +41,22 @@
 NetlinkConnection::NetlinkConnection() {
   fd_ = -1;
 
-  // The kernel keeps packets under 8KiB (NLMSG_GOODSIZE),
-  // but that's a bit too large to go on the stack.
-  size_ = 8192;
-  data_ = new char[size_];
+  // The kernel sizes each dump packet to fit the largest read we've done, up to 32KiB,
+  // so reading that much at a time means a quarter of the packets at 8KiB (NLMSG_GOODSIZE).
+  // Some links need even more, which we find out from MSG_TRUNC.
+  size_ = 32768;
+  data_ = reinterpret_cast<char*>(malloc(size_));
 }
 
 NetlinkConnection::~NetlinkConnection() {
   ErrnoRestorer errno_restorer;
   if (fd_ != -1) close(fd_);
-  delete[] data_;
+  free(data_);
 }
 
-bool NetlinkConnection::SendRequest(int type) {
+bool NetlinkConnection::Send(void* request, size_t size) {
   // Rather than force all callers to check for the unlikely event of being
-  // unable to allocate 8KiB, check here.
+  // unable to allocate the buffer, check here.
   if (data_ == nullptr) return false;
 
   // Did we open a netlink socket yet?
@@ -63,6 +64,10 @@ bool NetlinkConnection::SendRequest(int type) {
     fd_ = socket(PF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_ROUTE);
   }
 
+  return (TEMP_FAILURE_RETRY(send(fd_, request, size, 0)) == static_cast<ssize_t>(size));
+}
+
+bool NetlinkConnection::SendRequest(int type, int family) {
   // Construct and send the message.
   struct NetlinkMessage {
     nlmsghdr hdr;
@@ -72,18 +77,51 @@ bool NetlinkConnection::SendRequest(int type) {
   request.hdr.nlmsg_flags = NLM_F_DUMP | NLM_F_REQUEST;
   request.hdr.nlmsg_type = type;
   request.hdr.nlmsg_len = sizeof(request);
-  request.msg.rtgen_family = AF_UNSPEC; // All families.
-  return (TEMP_FAILURE_RETRY(send(fd_, &request, sizeof(request), 0)) == sizeof(request));
+  request.msg.rtgen_family = family;
+  return Send(&request, sizeof(request));
+}
+
+bool NetlinkConnection::SendLinkRequest(unsigned int if_index) {
+  // Without NLM_F_DUMP there's no NLMSG_DONE, so ask for an ack to end the response instead.
+  struct NetlinkMessage {
+    nlmsghdr hdr;
+    ifinfomsg msg;
+  } request;
+  memset(&request, 0, sizeof(request));
+  request.hdr.nlmsg_flags = NLM_F_REQUEST | NLM_F_ACK;
+  request.hdr.nlmsg_type = RTM_GETLINK;
+  request.hdr.nlmsg_len = sizeof(request);
+  request.msg.ifi_family = AF_UNSPEC;
+  request.msg.ifi_index = if_index;
+  return Send(&request, sizeof(request));
 }
 
 bool NetlinkConnection::ReadResponses(void callback(void*, nlmsghdr*), void* context) {
   // Read through all the responses, handing interesting ones to the callback.
-  ssize_t bytes_read;
-  while ((bytes_read = TEMP_FAILURE_RETRY(recv(fd_, data_, size_, 0))) > 0) {
+  while (true) {
+    // Make sure the next packet fits before reading it.
+    ssize_t bytes_read = TEMP_FAILURE_RETRY(recv(fd_, nullptr, 0, MSG_PEEK | MSG_TRUNC));
+    if (bytes_read <= 0) break;
+    if (static_cast<size_t>(bytes_read) > size_) {
+      char* new_data = reinterpret_cast<char*>(realloc(data_, bytes_read));
+      if (new_data == nullptr) return false;
+      data_ = new_data;
+      size_ = bytes_read;
+    }
+
+    bytes_read = TEMP_FAILURE_RETRY(recv(fd_, data_, size_, 0));
+    if (bytes_read <= 0) break;
+
     nlmsghdr* hdr = reinterpret_cast<nlmsghdr*>(data_);
     for (; NLMSG_OK(hdr, static_cast<size_t>(bytes_read)); hdr = NLMSG_NEXT(hdr, bytes_read)) {
       if (hdr->nlmsg_type == NLMSG_DONE) return true;
-      if (hdr->nlmsg_type == NLMSG_ERROR) return false;
+      if (hdr->nlmsg_type == NLMSG_ERROR) {
+        // An error code of 0 is the ack for a request without NLM_F_DUMP.
+        nlmsgerr* err = reinterpret_cast<nlmsgerr*>(NLMSG_DATA(hdr));
+        if (err->error == 0) return true;
+        errno = -err->error;
+        return false;
+      }
       callback(context, hdr);
     }
   }
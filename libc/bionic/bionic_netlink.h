@@ -29,6 +29,7 @@
 #ifndef BIONIC_NETLINK_H
 #define BIONIC_NETLINK_H
 
+#include <sys/socket.h>
 #include <sys/types.h>
 
 #include <linux/netlink.h>
@@ -41,10 +42,15 @@ class NetlinkConnection {
   NetlinkConnection();
   ~NetlinkConnection();
 
-  bool SendRequest(int type);
+  // Asks for a dump of everything of the given type, optionally of just one address family.
+  bool SendRequest(int type, int family = AF_UNSPEC);
+  // Asks for a single link rather than a dump of them all.
+  bool SendLinkRequest(unsigned int if_index);
   bool ReadResponses(void callback(void*, nlmsghdr*), void* context);
 
  private:
+  bool Send(void* request, size_t size);
+
   int fd_;
   char* data_;
   size_t size_;
@@ -0,0 +1,144 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+
+#include "private/bionic_macros.h"
+#include "private/bionic_prctl.h"
+#include "private/bionic_scratch.h"
+#include "pthread_internal.h"
+
+// Big enough for the largest user, getaddrinfo's pair of 64KiB DNS answer buffers. The mapping
+// is MAP_NORESERVE, so a thread only pays for the pages it has actually used.
+static constexpr size_t kScratchMapSize = 256 * 1024;
+static constexpr size_t kScratchAlignment = 16;
+
+struct bionic_scratch {
+  size_t offset;
+  alignas(kScratchAlignment) char data[];
+};
+
+static constexpr size_t kScratchDataSize = kScratchMapSize - sizeof(bionic_scratch);
+
+#define SCRATCH_CLOSED reinterpret_cast<bionic_scratch*>(MAP_FAILED)
+
+struct bionic_scratch_overflow {
+  bionic_scratch_overflow* next;
+  alignas(kScratchAlignment) char data[];
+};
+
+// Returns the calling thread's arena if it has one.
+static bionic_scratch* get_scratch() {
+  pthread_internal_t* thread = __get_thread();
+  if (__predict_false(thread == nullptr)) {
+    return nullptr;
+  }
+  bionic_scratch* scratch = thread->scratch;
+  return (scratch == SCRATCH_CLOSED) ? nullptr : scratch;
+}
+
+// Returns the calling thread's arena, mapping it if this is the first time it's been needed.
+static bionic_scratch* get_or_map_scratch() {
+  pthread_internal_t* thread = __get_thread();
+  if (__predict_false(thread == nullptr)) {
+    return nullptr;
+  }
+  bionic_scratch* scratch = thread->scratch;
+  if (__predict_true(scratch != nullptr)) {
+    return (scratch == SCRATCH_CLOSED) ? nullptr : scratch;
+  }
+
+  void* p = mmap(nullptr, kScratchMapSize, PROT_READ | PROT_WRITE,
+                 MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (p == MAP_FAILED) {
+    return nullptr;
+  }
+  prctl(PR_SET_VMA, PR_SET_VMA_ANON_NAME, p, kScratchMapSize, "bionic scratch");
+  scratch = thread->scratch = reinterpret_cast<bionic_scratch*>(p);
+  return scratch;
+}
+
+void __bionic_scratch_begin(bionic_scratch_scope* scope) {
+  // An arena mapped later in this scope starts out empty, so 0 is the right offset to go back to.
+  bionic_scratch* scratch = get_scratch();
+  scope->offset = (scratch != nullptr) ? scratch->offset : 0;
+  scope->overflow = nullptr;
+}
+
+void* __bionic_scratch_alloc(bionic_scratch_scope* scope, size_t size) {
+  size_t aligned_size = BIONIC_ALIGN(size, kScratchAlignment);
+  if (__predict_false(aligned_size < size)) {
+    return nullptr;
+  }
+
+  // A signal handler that runs between reading and writing the offset ends its own scope by
+  // putting back the same offset we read, so this doesn't need to be atomic.
+  bionic_scratch* scratch = get_or_map_scratch();
+  if (__predict_true(scratch != nullptr) && aligned_size <= kScratchDataSize - scratch->offset) {
+    void* result = scratch->data + scratch->offset;
+    scratch->offset += aligned_size;
+    return result;
+  }
+
+  if (size > SIZE_MAX - sizeof(bionic_scratch_overflow)) {
+    return nullptr;
+  }
+  bionic_scratch_overflow* overflow =
+      reinterpret_cast<bionic_scratch_overflow*>(malloc(sizeof(bionic_scratch_overflow) + size));
+  if (overflow == nullptr) {
+    return nullptr;
+  }
+  overflow->next = scope->overflow;
+  scope->overflow = overflow;
+  return overflow->data;
+}
+
+void __bionic_scratch_end(bionic_scratch_scope* scope) {
+  bionic_scratch* scratch = get_scratch();
+  if (scratch != nullptr) {
+    scratch->offset = scope->offset;
+  }
+
+  bionic_scratch_overflow* overflow = scope->overflow;
+  while (overflow != nullptr) {
+    bionic_scratch_overflow* next = overflow->next;
+    free(overflow);
+    overflow = next;
+  }
+  scope->overflow = nullptr;
+}
+
+void __bionic_scratch_thread_exit(pthread_internal_t* thread) {
+  bionic_scratch* scratch = thread->scratch;
+  thread->scratch = SCRATCH_CLOSED;
+  if (scratch != nullptr && scratch != SCRATCH_CLOSED) {
+    munmap(scratch, kScratchMapSize);
+  }
+}
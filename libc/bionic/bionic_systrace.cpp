@@ -17,100 +17,250 @@
 #include <cutils/trace.h>
 #include <errno.h>
 #include <fcntl.h>
+#include <stdatomic.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <sys/user.h>
+#include <time.h>
 
 #include "private/bionic_lock.h"
 #include "private/bionic_systrace.h"
 #include "private/libc_logging.h"
 
+#include "pthread_internal.h"
+
 #define _REALLY_INCLUDE_SYS__SYSTEM_PROPERTIES_H_
 #include <sys/_system_properties.h>
 
 #define WRITE_OFFSET   32
 
 constexpr char SYSTRACE_PROPERTY_NAME[] = "debug.atrace.tags.enableflags";
+constexpr char SYSTRACE_BUFFERED_PROPERTY_NAME[] = "libc.debug.systrace.buffered";
+
+// What should_trace says to do with a marker.
+enum TraceMode {
+  TRACE_OFF,
+  TRACE_DIRECT,
+  TRACE_BUFFERED,
+};
 
+// g_trace_state caches should_trace's answer for one serial of the tags property: the serial
+// is in the top 32 bits, and the TraceMode in the bottom bits along with TRACE_STATE_VALID.
+#define TRACE_STATE_VALID 4
+#define TRACE_STATE_MODE_MASK 3
+
+// Only taken to refresh the cached state when the properties have changed.
 static Lock g_lock;
-static const prop_info* g_pinfo;
-static uint32_t g_property_serial = -1;
-static uint32_t g_property_area_serial = -1;
-static uint64_t g_tags;
-static int g_trace_marker_fd = -1;
-
-static bool should_trace() {
-  bool result = false;
-  g_lock.lock();
+static _Atomic(const prop_info*) g_pinfo;
+static _Atomic(uint32_t) g_property_area_serial = ATOMIC_VAR_INIT(UINT32_MAX);
+static _Atomic(uint64_t) g_trace_state;
+static _Atomic(int) g_trace_marker_fd = ATOMIC_VAR_INIT(-1);
+
+static TraceMode should_trace_locked() {
   // debug.atrace.tags.enableflags is set to a safe non-tracing value during property
   // space initialization, so it should only be null in two cases, if there are
   // insufficient permissions for this process to access the property, in which
   // case an audit will be logged, and during boot before the property server has
   // been started, in which case we store the global property_area serial to prevent
   // the costly find operation until we see a changed property_area.
-  if (!g_pinfo && g_property_area_serial != __system_property_area_serial()) {
-    g_property_area_serial = __system_property_area_serial();
-    g_pinfo = __system_property_find(SYSTRACE_PROPERTY_NAME);
-  }
-  if (g_pinfo) {
-    // Find out which tags have been enabled on the command line and set
-    // the value of tags accordingly.  If the value of the property changes,
-    // the serial will also change, so the costly system_property_read function
-    // can be avoided by calling the much cheaper system_property_serial
-    // first.  The values within pinfo may change, but its location is guaranteed
-    // not to move.
-    uint32_t cur_serial = __system_property_serial(g_pinfo);
-    if (cur_serial != g_property_serial) {
-      g_property_serial = cur_serial;
-      char value[PROP_VALUE_MAX];
-      __system_property_read(g_pinfo, 0, value);
-      g_tags = strtoull(value, nullptr, 0);
+  const prop_info* pinfo = atomic_load_explicit(&g_pinfo, memory_order_relaxed);
+  uint32_t area_serial = __system_property_area_serial();
+  if (!pinfo && atomic_load_explicit(&g_property_area_serial, memory_order_relaxed) != area_serial) {
+    pinfo = __system_property_find(SYSTRACE_PROPERTY_NAME);
+    atomic_store_explicit(&g_pinfo, pinfo, memory_order_release);
+    atomic_store_explicit(&g_property_area_serial, area_serial, memory_order_release);
+  }
+  if (!pinfo) {
+    return TRACE_OFF;
+  }
+
+  // Find out which tags have been enabled on the command line and set
+  // the value of tags accordingly.  If the value of the property changes,
+  // the serial will also change, so the costly system_property_read function
+  // can be avoided by calling the much cheaper system_property_serial
+  // first.  The values within pinfo may change, but its location is guaranteed
+  // not to move.
+  uint32_t serial = __system_property_serial(pinfo);
+  uint64_t state = atomic_load_explicit(&g_trace_state, memory_order_relaxed);
+  if ((state & TRACE_STATE_VALID) && (state >> 32) == serial) {
+    return static_cast<TraceMode>(state & TRACE_STATE_MODE_MASK);
+  }
+
+  char value[PROP_VALUE_MAX];
+  __system_property_read(pinfo, 0, value);
+  TraceMode mode = TRACE_OFF;
+  if ((strtoull(value, nullptr, 0) & ATRACE_TAG_BIONIC) != 0) {
+    // Whether to buffer is only looked at when the tags change, which they do whenever
+    // tracing starts.
+    mode = TRACE_DIRECT;
+    if (__system_property_get(SYSTRACE_BUFFERED_PROPERTY_NAME, value) > 0 &&
+        strcmp(value, "1") == 0) {
+      mode = TRACE_BUFFERED;
     }
-    result = ((g_tags & ATRACE_TAG_BIONIC) != 0);
   }
+  state = (static_cast<uint64_t>(serial) << 32) | TRACE_STATE_VALID | mode;
+  atomic_store_explicit(&g_trace_state, state, memory_order_release);
+  return mode;
+}
+
+static TraceMode should_trace() {
+  // The common case takes no lock: the property is where it was, and its serial hasn't
+  // changed since we last read it.
+  const prop_info* pinfo = atomic_load_explicit(&g_pinfo, memory_order_acquire);
+  if (pinfo) {
+    uint32_t serial = __system_property_serial(pinfo);
+    uint64_t state = atomic_load_explicit(&g_trace_state, memory_order_acquire);
+    if ((state & TRACE_STATE_VALID) && (state >> 32) == serial) {
+      return static_cast<TraceMode>(state & TRACE_STATE_MODE_MASK);
+    }
+  } else if (atomic_load_explicit(&g_property_area_serial, memory_order_acquire) ==
+             __system_property_area_serial()) {
+    return TRACE_OFF;
+  }
+
+  g_lock.lock();
+  TraceMode result = should_trace_locked();
   g_lock.unlock();
   return result;
 }
 
 static int get_trace_marker_fd() {
+  int fd = atomic_load_explicit(&g_trace_marker_fd, memory_order_acquire);
+  if (fd != -1) {
+    return fd;
+  }
   g_lock.lock();
-  if (g_trace_marker_fd == -1) {
-    g_trace_marker_fd = open("/sys/kernel/debug/tracing/trace_marker", O_CLOEXEC | O_WRONLY);
+  fd = atomic_load_explicit(&g_trace_marker_fd, memory_order_relaxed);
+  if (fd == -1) {
+    fd = open("/sys/kernel/debug/tracing/trace_marker", O_CLOEXEC | O_WRONLY);
+    atomic_store_explicit(&g_trace_marker_fd, fd, memory_order_release);
   }
   g_lock.unlock();
-  return g_trace_marker_fd;
+  return fd;
 }
 
-ScopedTrace::ScopedTrace(const char* message) {
-  if (!should_trace()) {
+// In buffered mode, each thread collects its markers in a page of its own and writes them
+// to trace_marker in one go: when the page fills up, when the thread exits, or at the
+// thread's first marker after buffering stops. Each write is then a single trace event
+// holding a batch of lines, one per marker, each prefixed with the CLOCK_MONOTONIC time in
+// nanoseconds at which the marker was made:
+//   @<ns> B|<pid>|<message>
+//   @<ns> E
+// Anything that reads traces has to know to split these up. Markers still buffered when
+// tracing stops may miss the trace, and those of the main thread are lost when the process
+// exits.
+struct bionic_trace_buffer {
+  size_t used;
+  char data[PAGE_SIZE - sizeof(size_t)];
+};
+
+// Set at thread exit, after the last flush: markers made after that are written directly.
+#define TRACE_BUFFER_CLOSED reinterpret_cast<bionic_trace_buffer*>(MAP_FAILED)
+
+static void flush_trace_buffer(bionic_trace_buffer* buffer) {
+  if (buffer->used != 0) {
+    int trace_marker_fd = get_trace_marker_fd();
+    if (trace_marker_fd != -1) {
+      TEMP_FAILURE_RETRY(write(trace_marker_fd, buffer->data, buffer->used));
+    }
+    buffer->used = 0;
+  }
+}
+
+// Adds a marker to this thread's buffer, returning false if it should be written directly.
+static bool buffer_trace(const char* marker, size_t marker_length) {
+  pthread_internal_t* thread = __get_thread();
+  bionic_trace_buffer* buffer = thread->trace_buffer;
+  if (buffer == TRACE_BUFFER_CLOSED) {
+    return false;
+  }
+  if (buffer == nullptr) {
+    void* page = mmap(nullptr, sizeof(bionic_trace_buffer), PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (page == MAP_FAILED) {
+      return false;
+    }
+    buffer = thread->trace_buffer = reinterpret_cast<bionic_trace_buffer*>(page);
+  }
+
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  char prefix[WRITE_OFFSET];
+  size_t prefix_length = snprintf(prefix, sizeof(prefix), "@%lld ",
+                                  ts.tv_sec * 1000000000LL + ts.tv_nsec);
+  size_t length = prefix_length + marker_length + 1;
+  if (length > sizeof(buffer->data)) {
+    flush_trace_buffer(buffer);
+    return false;
+  }
+  if (length > sizeof(buffer->data) - buffer->used) {
+    flush_trace_buffer(buffer);
+  }
+  char* p = buffer->data + buffer->used;
+  memcpy(p, prefix, prefix_length);
+  memcpy(p + prefix_length, marker, marker_length);
+  p[prefix_length + marker_length] = '\n';
+  buffer->used += length;
+  return true;
+}
+
+static void write_trace(TraceMode mode, const char* marker, size_t marker_length) {
+  if (mode == TRACE_BUFFERED && buffer_trace(marker, marker_length)) {
     return;
   }
+  // Don't let buffered markers come out after this one.
+  __bionic_systrace_flush();
 
   int trace_marker_fd = get_trace_marker_fd();
   if (trace_marker_fd == -1) {
     return;
   }
 
+  // Tracing may stop just after checking property and before writing the message.
+  // So the write is acceptable to fail. See b/20666100.
+  TEMP_FAILURE_RETRY(write(trace_marker_fd, marker, marker_length));
+}
+
+ScopedTrace::ScopedTrace(const char* message) {
+  TraceMode mode = should_trace();
+  if (mode == TRACE_OFF) {
+    __bionic_systrace_flush();
+    return;
+  }
+
   // If bionic tracing has been enabled, then write the message to the
   // kernel trace_marker.
   int length = strlen(message);
   char buf[length + WRITE_OFFSET];
   size_t len = snprintf(buf, length + WRITE_OFFSET, "B|%d|%s", getpid(), message);
-
-  // Tracing may stop just after checking property and before writing the message.
-  // So the write is acceptable to fail. See b/20666100.
-  TEMP_FAILURE_RETRY(write(trace_marker_fd, buf, len));
+  write_trace(mode, buf, len);
 }
 
 ScopedTrace::~ScopedTrace() {
-  if (!should_trace()) {
+  TraceMode mode = should_trace();
+  if (mode == TRACE_OFF) {
+    __bionic_systrace_flush();
     return;
   }
 
-  int trace_marker_fd = get_trace_marker_fd();
-  if (trace_marker_fd == -1) {
-    return;
+  write_trace(mode, "E", 1);
+}
+
+void __bionic_systrace_flush() {
+  bionic_trace_buffer* buffer = __get_thread()->trace_buffer;
+  if (buffer != nullptr && buffer != TRACE_BUFFER_CLOSED) {
+    flush_trace_buffer(buffer);
   }
+}
 
-  TEMP_FAILURE_RETRY(write(trace_marker_fd, "E", 1));
+void __bionic_systrace_thread_exit() {
+  pthread_internal_t* thread = __get_thread();
+  bionic_trace_buffer* buffer = thread->trace_buffer;
+  thread->trace_buffer = TRACE_BUFFER_CLOSED;
+  if (buffer != nullptr && buffer != TRACE_BUFFER_CLOSED) {
+    flush_trace_buffer(buffer);
+    munmap(buffer, sizeof(bionic_trace_buffer));
+  }
 }
@@ -35,6 +35,7 @@
 
 extern "C" pid_t __bionic_clone(uint32_t flags, void* child_stack, int* parent_tid, void* tls, int* child_tid, int (*fn)(void*), void* arg);
 extern "C" __noreturn void __exit(int status);
+extern "C" pid_t __getpid();
 
 // Called from the __bionic_clone assembler to call the thread function then exit.
 extern "C" __LIBC_HIDDEN__ void __start_thread(int (*fn)(void*), void* arg) {
@@ -42,6 +43,26 @@ extern "C" __LIBC_HIDDEN__ void __start_thread(int (*fn)(void*), void* arg) {
   __exit(status);
 }
 
+// A child without CLONE_VM is a new process with its own copy of our pthread_internal_t, so, as
+// fork's child does, it can cache its own pid and tid there.
+static void __set_new_process_ids(pthread_internal_t* self) {
+  pid_t pid = __getpid();
+  self->tid = pid;
+  self->set_cached_pid(pid);
+}
+
+struct CloneStart {
+  int (*fn)(void*);
+  void* arg;
+};
+
+static int __clone_new_process_start(void* arg) {
+  // This is in the child's copy of the parent's stack.
+  CloneStart* start = reinterpret_cast<CloneStart*>(arg);
+  __set_new_process_ids(__get_thread());
+  return start->fn(start->arg);
+}
+
 int clone(int (*fn)(void*), void* child_stack, int flags, void* arg, ...) {
   int* parent_tid = NULL;
   void* new_tls = NULL;
@@ -76,8 +97,14 @@ int clone(int (*fn)(void*), void* child_stack, int flags, void* arg, ...) {
   pid_t parent_pid = self->invalidate_cached_pid();
 
   // Actually do the clone.
+  bool new_process = (flags & CLONE_VM) == 0;
   int clone_result;
   if (fn != nullptr) {
+    CloneStart start = { fn, arg };
+    if (new_process) {
+      fn = __clone_new_process_start;
+      arg = &start;
+    }
     clone_result = __bionic_clone(flags, child_stack, parent_tid, new_tls, child_tid, fn, arg);
   } else {
 #if defined(__x86_64__) // sys_clone's last two arguments are flipped on x86-64.
@@ -85,13 +112,22 @@ int clone(int (*fn)(void*), void* child_stack, int flags, void* arg, ...) {
 #else
     clone_result = syscall(__NR_clone, flags, child_stack, parent_tid, new_tls, child_tid);
 #endif
+    if (clone_result == 0) {
+      // We're the child. Sharing our parent's memory, we leave the cache to it.
+      if (new_process) {
+        __set_new_process_ids(self);
+      }
+      return 0;
+    }
   }
 
-  // We're the parent, so put our known pid back in place.
-  // We leave the child without a cached pid, but:
-  // 1. pthread_create gives its children their own pthread_internal_t with the correct pid.
-  // 2. fork makes a clone system call directly.
-  // If any other cases become important, we could use a double trampoline like __pthread_start.
-  self->set_cached_pid(parent_pid);
+  // We're the parent, so put our known pid back in place, unless the clone succeeded and the
+  // child is another process that shares our memory and so our pthread_internal_t (rather
+  // than a thread, a child with its own TLS, or a CLONE_VFORK child that has already exec'ed or
+  // exited). Then neither can use the cache, and getpid and gettid go to the kernel.
+  int sharing_flags = flags & (CLONE_VM | CLONE_THREAD | CLONE_SETTLS | CLONE_VFORK);
+  if (clone_result == -1 || sharing_flags != CLONE_VM) {
+    self->set_cached_pid(parent_pid);
+  }
   return clone_result;
 }
@@ -0,0 +1,229 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#define _GNU_SOURCE 1
+#include <unistd.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/sendfile.h>
+#include <sys/stat.h>
+
+// The most any one system call is asked to copy, so that the count always fits in a ssize_t.
+static constexpr size_t kMaxChunk = 1 << 30;
+
+// The read/write fallback's buffer. Copying is dominated by system calls, so go big.
+static constexpr size_t kBufferSize = 128 * 1024;
+
+// Each of the strategies below copies until it has copied count bytes in all, reaches the end
+// of the input, or fails. They return false only if they failed for some other reason than
+// not being supported for this pair of file descriptors, in which case there's no point in
+// trying the next.
+
+static bool IsUnsupported(int error) {
+  // EXDEV: copy_file_range between file systems on kernels before 5.3.
+  // EBADF: copy_file_range to an O_APPEND file.
+  return error == ENOSYS || error == EINVAL || error == EXDEV || error == EOPNOTSUPP ||
+         error == EBADF;
+}
+
+static size_t Chunk(size_t count, size_t copied) {
+  size_t remaining = count - copied;
+  return (remaining < kMaxChunk) ? remaining : kMaxChunk;
+}
+
+// Returns true and sets *at_eof if it got to the end of the input.
+static bool CopyWithCopyFileRange(int fd_in, int fd_out, size_t count, size_t* copied,
+                                  bool* at_eof) {
+  while (*copied < count) {
+    ssize_t n = TEMP_FAILURE_RETRY(copy_file_range(fd_in, nullptr, fd_out, nullptr,
+                                                   Chunk(count, *copied), 0));
+    if (n == -1) return IsUnsupported(errno);
+    if (n == 0) {
+      // Some file systems (procfs and sysfs, for example) claim to be empty here, so only
+      // believe it if something has already been copied.
+      *at_eof = (*copied != 0);
+      return true;
+    }
+    *copied += n;
+  }
+  return true;
+}
+
+static bool CopyWithSendfile(int fd_in, int fd_out, size_t count, size_t* copied,
+                             bool* at_eof) {
+  while (*copied < count) {
+    ssize_t n = TEMP_FAILURE_RETRY(sendfile(fd_out, fd_in, nullptr, Chunk(count, *copied)));
+    if (n == -1) return IsUnsupported(errno);
+    if (n == 0) {
+      *at_eof = true;
+      return true;
+    }
+    *copied += n;
+  }
+  return true;
+}
+
+// Writes everything in the pipe to fd_out with read and write, for when fd_out can't be
+// spliced to.
+static bool DrainPipe(int pipe_fd, int fd_out, size_t size) {
+  char buf[BUFSIZ];
+  while (size > 0) {
+    ssize_t n = TEMP_FAILURE_RETRY(read(pipe_fd, buf, (size < sizeof(buf)) ? size : sizeof(buf)));
+    if (n <= 0) return false;
+    size -= n;
+    for (ssize_t written = 0; written < n;) {
+      ssize_t w = TEMP_FAILURE_RETRY(write(fd_out, buf + written, n - written));
+      if (w == -1) return false;
+      written += w;
+    }
+  }
+  return true;
+}
+
+static bool CopyThroughPipe(int fd_in, int fd_out, int read_end, int write_end, size_t count,
+                            size_t* copied, bool* at_eof) {
+  // The bigger the pipe, the fewer the splices. It's fine if we're not allowed.
+  int pipe_size = fcntl(write_end, F_SETPIPE_SZ, 1024 * 1024);
+  if (pipe_size == -1) pipe_size = fcntl(write_end, F_GETPIPE_SZ);
+  if (pipe_size <= 0) pipe_size = PIPE_BUF;
+
+  while (*copied < count) {
+    size_t chunk = Chunk(count, *copied);
+    if (chunk > static_cast<size_t>(pipe_size)) chunk = pipe_size;
+    ssize_t in = TEMP_FAILURE_RETRY(splice(fd_in, nullptr, write_end, nullptr, chunk,
+                                           SPLICE_F_MOVE | SPLICE_F_MORE));
+    if (in == -1) return IsUnsupported(errno);
+    if (in == 0) {
+      *at_eof = true;
+      return true;
+    }
+    for (ssize_t out = 0; out < in;) {
+      ssize_t n = TEMP_FAILURE_RETRY(splice(read_end, nullptr, fd_out, nullptr, in - out,
+                                            SPLICE_F_MOVE | SPLICE_F_MORE));
+      if (n == -1) {
+        // The data's already out of fd_in, so it has to get to fd_out some other way.
+        if (!IsUnsupported(errno) || !DrainPipe(read_end, fd_out, in - out)) return false;
+        *copied += in;
+        return true;
+      }
+      out += n;
+    }
+    *copied += in;
+  }
+  return true;
+}
+
+static bool CopyWithSplice(int fd_in, int fd_out, size_t count, size_t* copied, bool* at_eof) {
+  // splice needs a pipe at one end or the other. If neither end is one, go through our own.
+  struct stat in_st, out_st;
+  if (fstat(fd_in, &in_st) == -1 || fstat(fd_out, &out_st) == -1) return false;
+  if (S_ISFIFO(in_st.st_mode) || S_ISFIFO(out_st.st_mode)) {
+    while (*copied < count) {
+      ssize_t n = TEMP_FAILURE_RETRY(splice(fd_in, nullptr, fd_out, nullptr,
+                                            Chunk(count, *copied), SPLICE_F_MOVE));
+      if (n == -1) return IsUnsupported(errno);
+      if (n == 0) {
+        *at_eof = true;
+        return true;
+      }
+      *copied += n;
+    }
+    return true;
+  }
+
+  int pipe_fds[2];
+  if (pipe2(pipe_fds, O_CLOEXEC) == -1) return errno == EMFILE || errno == ENFILE;
+  bool result = CopyThroughPipe(fd_in, fd_out, pipe_fds[0], pipe_fds[1], count, copied, at_eof);
+  int saved_errno = errno;
+  close(pipe_fds[0]);
+  close(pipe_fds[1]);
+  errno = saved_errno;
+  return result;
+}
+
+static bool CopyWithReadWrite(int fd_in, int fd_out, size_t count, size_t* copied,
+                              bool* at_eof) {
+  char small_buf[BUFSIZ];
+  char* buf = reinterpret_cast<char*>(malloc(kBufferSize));
+  size_t buf_size = kBufferSize;
+  if (buf == nullptr) {
+    buf = small_buf;
+    buf_size = sizeof(small_buf);
+  }
+
+  bool result = true;
+  while (*copied < count) {
+    size_t chunk = Chunk(count, *copied);
+    ssize_t n = TEMP_FAILURE_RETRY(read(fd_in, buf, (chunk < buf_size) ? chunk : buf_size));
+    if (n == -1) {
+      result = false;
+      break;
+    }
+    if (n == 0) {
+      *at_eof = true;
+      break;
+    }
+    for (ssize_t written = 0; written < n;) {
+      ssize_t w = TEMP_FAILURE_RETRY(write(fd_out, buf + written, n - written));
+      if (w == -1) {
+        result = false;
+        break;
+      }
+      written += w;
+      *copied += w;
+    }
+    if (!result) break;
+  }
+
+  if (buf != small_buf) {
+    int saved_errno = errno;
+    free(buf);
+    errno = saved_errno;
+  }
+  return result;
+}
+
+ssize_t android_copy_fd(int fd_in, int fd_out, size_t count) {
+  if (count > SSIZE_MAX) count = SSIZE_MAX;
+
+  bool (*const strategies[])(int, int, size_t, size_t*, bool*) = {
+    CopyWithCopyFileRange, CopyWithSendfile, CopyWithSplice, CopyWithReadWrite,
+  };
+  size_t copied = 0;
+  bool at_eof = false;
+  for (auto strategy : strategies) {
+    if (!strategy(fd_in, fd_out, count, &copied, &at_eof)) return -1;
+    if (at_eof || copied == count) return copied;
+  }
+  // CopyWithReadWrite only stops early at the end of the input or on error.
+  return copied;
+}
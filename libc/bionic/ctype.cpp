@@ -26,8 +26,25 @@
  * SUCH DAMAGE.
  */
 
+#define __BIONIC_CTYPE_INLINE /* Out of line. */
 #include <ctype.h>
 
+int isascii(int c) {
+  return static_cast<unsigned>(c) < 0x80;
+}
+
+int toascii(int c) {
+  return c & 0x7f;
+}
+
+int _tolower(int c) {
+  return c - 'A' + 'a';
+}
+
+int _toupper(int c) {
+  return c - 'a' + 'A';
+}
+
 int isalnum_l(int c, locale_t) {
   return isalnum(c);
 }
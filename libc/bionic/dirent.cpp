@@ -54,8 +54,17 @@ struct DIR {
   pthread_mutex_t mutex_;
   dirent buff_[15];
   long current_pos_;
+
+  // The buffer __getdents64 fills: buff_ to begin with, then, once a fill has come back full
+  // (so the directory is too big for buff_), a heap buffer of 32 KiB and then 64 KiB, so big
+  // directories take fewer system calls.
+  char* buffer_;
+  size_t buffer_size_;
+  bool grow_buffer_;
 };
 
+static constexpr size_t kMaxBufferSize = 64 * 1024;
+
 static DIR* __allocate_DIR(int fd) {
   DIR* d = reinterpret_cast<DIR*>(malloc(sizeof(DIR)));
   if (d == NULL) {
@@ -66,6 +75,9 @@ static DIR* __allocate_DIR(int fd) {
   d->next_ = NULL;
   d->current_pos_ = 0L;
   pthread_mutex_init(&d->mutex_, NULL);
+  d->buffer_ = reinterpret_cast<char*>(d->buff_);
+  d->buffer_size_ = sizeof(d->buff_);
+  d->grow_buffer_ = false;
   return d;
 }
 
@@ -92,21 +104,38 @@ DIR* opendir(const char* path) {
   return (fd != -1) ? __allocate_DIR(fd) : NULL;
 }
 
+static void __grow_DIR_buffer(DIR* d) {
+  d->grow_buffer_ = false;
+  size_t new_size = (d->buffer_size_ < kMaxBufferSize / 2) ? kMaxBufferSize / 2 : kMaxBufferSize;
+  char* new_buffer = reinterpret_cast<char*>(malloc(new_size));
+  // If we can't have a bigger buffer, carry on with the one we've got.
+  if (new_buffer == NULL) {
+    return;
+  }
+  if (d->buffer_ != reinterpret_cast<char*>(d->buff_)) {
+    free(d->buffer_);
+  }
+  d->buffer_ = new_buffer;
+  d->buffer_size_ = new_size;
+}
+
 static bool __fill_DIR(DIR* d) {
-  int rc = TEMP_FAILURE_RETRY(__getdents64(d->fd_, d->buff_, sizeof(d->buff_)));
+  if (d->grow_buffer_) {
+    __grow_DIR_buffer(d);
+  }
+  int rc = TEMP_FAILURE_RETRY(__getdents64(d->fd_, reinterpret_cast<dirent*>(d->buffer_),
+                                           d->buffer_size_));
   if (rc <= 0) {
     return false;
   }
   d->available_bytes_ = rc;
-  d->next_ = d->buff_;
+  d->next_ = reinterpret_cast<dirent*>(d->buffer_);
+  // If there might not have been room for another entry, there are probably more to come.
+  d->grow_buffer_ = d->buffer_size_ < kMaxBufferSize && rc + sizeof(dirent) > d->buffer_size_;
   return true;
 }
 
-static dirent* __readdir_locked(DIR* d) {
-  if (d->available_bytes_ == 0 && !__fill_DIR(d)) {
-    return NULL;
-  }
-
+static dirent* __next_entry_locked(DIR* d) {
   dirent* entry = d->next_;
   d->next_ = reinterpret_cast<dirent*>(reinterpret_cast<char*>(entry) + entry->d_reclen);
   d->available_bytes_ -= entry->d_reclen;
@@ -116,6 +145,13 @@ static dirent* __readdir_locked(DIR* d) {
   return entry;
 }
 
+static dirent* __readdir_locked(DIR* d) {
+  if (d->available_bytes_ == 0 && !__fill_DIR(d)) {
+    return NULL;
+  }
+  return __next_entry_locked(d);
+}
+
 dirent* readdir(DIR* d) {
   ScopedPthreadMutexLocker locker(&d->mutex_);
   return __readdir_locked(d);
@@ -143,6 +179,28 @@ int readdir_r(DIR* d, dirent* entry, dirent** result) {
 }
 __strong_alias(readdir64_r, readdir_r);
 
+int android_readdir_batch(DIR* d, dirent** entries, int count) {
+  ScopedPthreadMutexLocker locker(&d->mutex_);
+
+  if (d->available_bytes_ == 0) {
+    int saved_errno = errno;
+    errno = 0;
+    if (!__fill_DIR(d)) {
+      if (errno != 0) return -1;
+      errno = saved_errno;
+      return 0;
+    }
+    errno = saved_errno;
+  }
+
+  // Hand back as many as we were asked for, or as many as the buffer still holds.
+  int n = 0;
+  while (n < count && d->available_bytes_ != 0) {
+    entries[n++] = __next_entry_locked(d);
+  }
+  return n;
+}
+
 int closedir(DIR* d) {
   if (d == NULL) {
     errno = EINVAL;
@@ -151,6 +209,9 @@ int closedir(DIR* d) {
 
   int fd = d->fd_;
   pthread_mutex_destroy(&d->mutex_);
+  if (d->buffer_ != reinterpret_cast<char*>(d->buff_)) {
+    free(d->buffer_);
+  }
   free(d);
   return close(fd);
 }
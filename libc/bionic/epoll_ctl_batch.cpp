@@ -0,0 +1,167 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <sys/epoll.h>
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/io_uring.h>
+#include <unistd.h>
+
+#include "private/ErrnoRestorer.h"
+#include "private/libc_logging.h"
+
+// Our <linux/io_uring.h> is from Linux 5.1, and the epoll_ctl opcode came in 5.6.
+#define IORING_OP_EPOLL_CTL 29
+
+// Smaller batches aren't worth an io_uring_enter, which costs more than an epoll_ctl.
+static constexpr size_t kMinRingBatch = 4;
+// The most operations we submit in one io_uring_enter.
+static constexpr unsigned int kRingEntries = 64;
+
+// One ring is shared by the whole process. A thread that finds another using it falls back
+// to epoll_ctl rather than waiting.
+static pthread_mutex_t g_ring_lock = PTHREAD_MUTEX_INITIALIZER;
+static android_io_uring* g_ring;
+// The process that set up g_ring: a forked child mustn't submit to its parent's ring.
+static pid_t g_ring_pid;
+// Whether we've found that io_uring or its epoll_ctl opcode is unavailable.
+static bool g_ring_unsupported;
+
+static void PrepareEpollCtl(io_uring_sqe* sqe, int epoll_fd, int op, int fd, epoll_event* event,
+                            uint64_t user_data) {
+  sqe->opcode = IORING_OP_EPOLL_CTL;
+  sqe->fd = epoll_fd;
+  sqe->len = op;
+  sqe->off = fd;
+  sqe->addr = reinterpret_cast<uintptr_t>(event);
+  sqe->user_data = user_data;
+}
+
+static void DestroyRing() {
+  android_io_uring_destroy(g_ring);
+  g_ring = nullptr;
+}
+
+static bool GetRing() {
+  if (g_ring != nullptr && g_ring_pid != getpid()) DestroyRing();
+  if (g_ring != nullptr) return true;
+  if (g_ring_unsupported) return false;
+
+  ErrnoRestorer errno_restorer;
+  g_ring = android_io_uring_create(kRingEntries, 0);
+  if (g_ring == nullptr) {
+    g_ring_unsupported = true;
+    return false;
+  }
+  g_ring_pid = getpid();
+
+  // Kernels that don't know the opcode fail it with EINVAL; those that do fail a bad epoll fd
+  // with EBADF.
+  PrepareEpollCtl(android_io_uring_get_sqe(g_ring), -1, EPOLL_CTL_DEL, -1, nullptr, 0);
+  io_uring_cqe* cqe = nullptr;
+  if (android_io_uring_submit(g_ring, 1) == 1) cqe = android_io_uring_wait_cqe(g_ring);
+  if (cqe == nullptr || cqe->res != -EBADF) {
+    DestroyRing();
+    g_ring_unsupported = true;
+    return false;
+  }
+  android_io_uring_cqe_seen(g_ring, cqe);
+  return true;
+}
+
+static int EpollCtlLoop(int epoll_fd, android_epoll_ctl* ops, size_t count) {
+  ErrnoRestorer errno_restorer;
+  int failures = 0;
+  for (size_t i = 0; i < count; ++i) {
+    android_epoll_ctl& op = ops[i];
+    op.result = (epoll_ctl(epoll_fd, op.op, op.fd, &op.event) == 0) ? 0 : errno;
+    if (op.result != 0) ++failures;
+  }
+  return failures;
+}
+
+// Submits ops through g_ring, in chunks of at most kRingEntries. Returns the number of
+// operations that failed, or -1 if g_ring did none of them.
+static int EpollCtlRing(int epoll_fd, android_epoll_ctl* ops, size_t count) {
+  ErrnoRestorer errno_restorer;
+  int failures = 0;
+  size_t done = 0;
+  while (done < count) {
+    unsigned int queued = 0;
+    io_uring_sqe* sqe;
+    while (done + queued < count && (sqe = android_io_uring_get_sqe(g_ring)) != nullptr) {
+      android_epoll_ctl& op = ops[done + queued];
+      PrepareEpollCtl(sqe, epoll_fd, op.op, op.fd, &op.event, done + queued);
+      ++queued;
+    }
+
+    // The kernel takes entries from the ring in order, so if it stops early, it's the ones
+    // at the end of the chunk that are left.
+    unsigned int submitted = 0;
+    while (submitted < queued) {
+      int result = android_io_uring_submit(g_ring, queued - submitted);
+      if (result == -1 && errno != EINTR) break;
+      if (result > 0) submitted += result;
+    }
+
+    for (unsigned int i = 0; i < submitted; ++i) {
+      io_uring_cqe* cqe = android_io_uring_wait_cqe(g_ring);
+      if (cqe == nullptr) {
+        // We can't tell which operations the lost completions were for.
+        __libc_fatal("android_epoll_ctl_batch: io_uring wait failed: %s", strerror(errno));
+      }
+      android_epoll_ctl& op = ops[cqe->user_data];
+      op.result = -cqe->res;
+      if (op.result != 0) ++failures;
+      android_io_uring_cqe_seen(g_ring, cqe);
+    }
+    done += submitted;
+
+    if (submitted < queued) {
+      // Leave the rest of this batch, and any later ones, to epoll_ctl. The unsubmitted
+      // entries are still in the ring, so it can't be used again.
+      DestroyRing();
+      g_ring_unsupported = true;
+      if (done == 0) return -1;
+      return failures + EpollCtlLoop(epoll_fd, ops + done, count - done);
+    }
+  }
+  return failures;
+}
+
+int android_epoll_ctl_batch(int epoll_fd, android_epoll_ctl* ops, size_t count) {
+  if (count >= kMinRingBatch && pthread_mutex_trylock(&g_ring_lock) == 0) {
+    int failures = GetRing() ? EpollCtlRing(epoll_fd, ops, count) : -1;
+    pthread_mutex_unlock(&g_ring_lock);
+    if (failures != -1) return failures;
+  }
+  return EpollCtlLoop(epoll_fd, ops, count);
+}
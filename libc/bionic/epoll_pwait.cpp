@@ -28,9 +28,26 @@
 
 #include <sys/epoll.h>
 
+#include <errno.h>
+#include <limits.h>
+#include <stdatomic.h>
+#include <stdint.h>
+
+#include "private/bionic_constants.h"
 #include "private/kernel_sigset_t.h"
 
+// The kernel's timespec, which has a 64-bit tv_sec even on LP32.
+struct kernel_timespec64 {
+  int64_t tv_sec;
+  int64_t tv_nsec;
+};
+
 extern "C" int __epoll_pwait(int, epoll_event*, int, int, const kernel_sigset_t*, size_t);
+extern "C" int __epoll_pwait2(int, epoll_event*, int, const kernel_timespec64*,
+                              const kernel_sigset_t*, size_t);
+
+// Set once we've seen ENOSYS, so older kernels don't cost an extra system call every wait.
+static atomic_bool g_epoll_pwait2_missing = ATOMIC_VAR_INIT(false);
 
 int epoll_pwait(int fd, epoll_event* events, int max_events, int timeout, const sigset_t* ss) {
   kernel_sigset_t kernel_ss;
@@ -41,3 +58,42 @@ int epoll_pwait(int fd, epoll_event* events, int max_events, int timeout, const
   }
   return __epoll_pwait(fd, events, max_events, timeout, kernel_ss_ptr, sizeof(kernel_ss));
 }
+
+int epoll_pwait2(int fd, epoll_event* events, int max_events, const timespec* timeout,
+                 const sigset_t* ss) {
+  kernel_timespec64 kernel_ts;
+  kernel_timespec64* kernel_ts_ptr = NULL;
+  if (timeout != NULL) {
+    if (timeout->tv_sec < 0 || timeout->tv_nsec < 0 || timeout->tv_nsec >= NS_PER_S) {
+      errno = EINVAL;
+      return -1;
+    }
+    kernel_ts.tv_sec = timeout->tv_sec;
+    kernel_ts.tv_nsec = timeout->tv_nsec;
+    kernel_ts_ptr = &kernel_ts;
+  }
+  kernel_sigset_t kernel_ss;
+  kernel_sigset_t* kernel_ss_ptr = NULL;
+  if (ss != NULL) {
+    kernel_ss.set(ss);
+    kernel_ss_ptr = &kernel_ss;
+  }
+
+  if (!atomic_load_explicit(&g_epoll_pwait2_missing, memory_order_relaxed)) {
+    int result = __epoll_pwait2(fd, events, max_events, kernel_ts_ptr, kernel_ss_ptr,
+                                sizeof(kernel_ss));
+    if (result != -1 || errno != ENOSYS) return result;
+    atomic_store_explicit(&g_epoll_pwait2_missing, true, memory_order_relaxed);
+  }
+
+  // Round up, so we never time out before the caller's deadline.
+  int timeout_ms = -1;
+  if (timeout != NULL) {
+    if (timeout->tv_sec >= INT_MAX / 1000) {
+      timeout_ms = INT_MAX;
+    } else {
+      timeout_ms = timeout->tv_sec * 1000 + (timeout->tv_nsec + 999999) / 1000000;
+    }
+  }
+  return __epoll_pwait(fd, events, max_events, timeout_ms, kernel_ss_ptr, sizeof(kernel_ss));
+}
@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <errno.h>
+#include <fnmatch.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "private/bionic_fnmatch.h"
+
+struct fnmatch_set_entry {
+  const char* pattern;
+  bool is_simple;
+  fnmatch_simple simple;
+};
+
+// The entries are followed by copies of the patterns, all in one allocation.
+struct android_fnmatch_set {
+  int flags;
+  bool any_simple;
+  size_t count;
+  fnmatch_set_entry entries[];
+};
+
+android_fnmatch_set* android_fnmatch_set_create(const char* const* patterns, size_t count,
+                                                int flags) {
+  size_t size = sizeof(android_fnmatch_set);
+  for (size_t i = 0; i < count; ++i) {
+    size_t needed = sizeof(fnmatch_set_entry) + strlen(patterns[i]) + 1;
+    if (size > SIZE_MAX - needed) {
+      errno = ENOMEM;
+      return nullptr;
+    }
+    size += needed;
+  }
+
+  android_fnmatch_set* set = reinterpret_cast<android_fnmatch_set*>(malloc(size));
+  if (set == nullptr) {
+    return nullptr;
+  }
+  set->flags = flags;
+  set->any_simple = false;
+  set->count = count;
+  char* storage = reinterpret_cast<char*>(&set->entries[count]);
+  for (size_t i = 0; i < count; ++i) {
+    fnmatch_set_entry& entry = set->entries[i];
+    size_t length = strlen(patterns[i]);
+    entry.pattern = static_cast<const char*>(memcpy(storage, patterns[i], length + 1));
+    storage += length + 1;
+    entry.is_simple = __fnmatch_classify(entry.pattern, flags, &entry.simple);
+    set->any_simple |= entry.is_simple;
+  }
+  return set;
+}
+
+void android_fnmatch_set_destroy(android_fnmatch_set* set) {
+  free(set);
+}
+
+int android_fnmatch_set_match(const android_fnmatch_set* set, const char* string, size_t start,
+                              size_t* index) {
+  // Finding the string's length and slashes is the only pass over it the simple patterns need.
+  fnmatch_subject subject;
+  if (set->any_simple) {
+    __fnmatch_subject(string, set->flags, &subject);
+  }
+
+  for (size_t i = start; i < set->count; ++i) {
+    const fnmatch_set_entry& entry = set->entries[i];
+    int result = entry.is_simple ? __fnmatch_simple(&entry.simple, &subject, set->flags)
+                                 : fnmatch(entry.pattern, string, set->flags);
+    if (result == 0) {
+      *index = i;
+      return 0;
+    }
+  }
+  return FNM_NOMATCH;
+}
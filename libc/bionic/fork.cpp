@@ -48,6 +48,9 @@ int fork() {
                      &(self->tid));
   if (result == 0) {
     self->set_cached_pid(gettid());
+    // The parent's perf event goes on measuring the parent.
+    __exit_thread_cputime(self);
+    __syscall_stats_fork_child(self);
     __bionic_atfork_run_child();
   } else {
     self->set_cached_pid(parent_pid);
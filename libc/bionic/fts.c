@@ -50,6 +50,7 @@ static void	 fts_padjust(FTS *, FTSENT *);
 static int	 fts_palloc(FTS *, size_t);
 static FTSENT	*fts_sort(FTS *, FTSENT *, int);
 static u_short	 fts_stat(FTS *, FTSENT *, int, int);
+static u_short	 fts_dtype(FTS *, unsigned char);
 static int	 fts_safe_changedir(FTS *, FTSENT *, int, char *);
 
 #define ALIGNBYTES (sizeof(uintptr_t) - 1)
@@ -91,6 +92,10 @@ fts_open(char * const *argv, int options,
 	sp->fts_compar = compar;
 	sp->fts_options = options;
 
+	/* FTS_NOSTAT_TYPE is FTS_NOSTAT with types from the directory entries. */
+	if (ISSET(FTS_NOSTAT_TYPE))
+		SET(FTS_NOSTAT);
+
 	/* Logical walks turn on NOCHDIR; symbolic links are too hard. */
 	if (ISSET(FTS_LOGICAL))
 		SET(FTS_NOCHDIR);
@@ -541,6 +546,11 @@ fts_children(FTS *sp, int instr)
  * The former skips all stat calls.  The latter skips stat calls in any leaf
  * directories and for any files after the subdirectories in the directory have
  * been found, cutting the stat calls by about 2/3.
+ *
+ * FTS_NOSTAT_TYPE goes further: entries whose type is in the directory entry
+ * get their fts_info from it without a stat call, even on a logical walk (where
+ * only symbolic links have to be followed), and only directories and entries
+ * of unknown type are stat'ed.
  */
 static FTSENT *
 fts_build(FTS *sp, int type)
@@ -710,11 +720,15 @@ mem1:				saved_errno = errno;
 #ifdef DT_DIR
 		    || (nostat &&
 		    dp->d_type != DT_DIR && dp->d_type != DT_UNKNOWN)
+		    || (ISSET(FTS_NOSTAT_TYPE) &&
+		    dp->d_type != DT_DIR && dp->d_type != DT_UNKNOWN &&
+		    (dp->d_type != DT_LNK || !ISSET(FTS_LOGICAL)))
 #endif
 		    ) {
 			p->fts_accpath =
 			    ISSET(FTS_NOCHDIR) ? p->fts_path : p->fts_name;
-			p->fts_info = FTS_NSOK;
+			p->fts_info = (type == BNAMES) ? FTS_NSOK :
+			    fts_dtype(sp, dp->d_type);
 		} else {
 			/* Build a file name for fts_stat to stat. */
 			if (ISSET(FTS_NOCHDIR)) {
@@ -866,6 +880,29 @@ err:		memset(sbp, 0, sizeof(struct stat));
 	return (FTS_DEFAULT);
 }
 
+/*
+ * The fts_info for a directory entry of type dtype that isn't being stat'ed:
+ * FTS_NSOK unless FTS_NOSTAT_TYPE asked for the type.
+ */
+static u_short
+fts_dtype(FTS *sp, unsigned char dtype)
+{
+	if (!ISSET(FTS_NOSTAT_TYPE))
+		return (FTS_NSOK);
+	switch (dtype) {
+	case DT_REG:
+		return (FTS_F);
+	case DT_LNK:
+		return (FTS_SL);
+	case DT_DIR:
+	case DT_UNKNOWN:
+		/* Only reached when cheating on link counts; we can't say. */
+		return (FTS_NSOK);
+	default:
+		return (FTS_DEFAULT);
+	}
+}
+
 static FTSENT *
 fts_sort(FTS *sp, FTSENT *head, int nitems)
 {
@@ -18,9 +18,16 @@
  * Materiel Command, USAF, under agreement number F39502-99-1-0512.
  */
 
+#include <android/work_pool.h>
+#include <dirent.h>
 #include <errno.h>
+#include <fcntl.h>
 #include <fts.h>
 #include <ftw.h>
+#include <limits.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
@@ -122,3 +129,212 @@ int nftw(const char* path, int (*nftw_fn)(const char*, const struct stat*, int,
          int nfds, int nftw_flags) {
   return do_nftw(path, nullptr, nftw_fn, nfds, nftw_flags);
 }
+
+// android_nftw_parallel walks each directory in a task of its own on the work pool. A directory
+// is stat'ed by the task reading its parent, and then read by its own task, which stats and
+// reports everything else in it relative to the directory's fd.
+
+struct ParallelWalk {
+  int (*fn)(const char*, const struct stat*, int, FTW*);
+  int flags;
+  dev_t root_dev;
+  android_work_group_t group;
+  // The first non-zero callback result, or -1 for an error. Anything non-zero stops the walk.
+  atomic_int result;
+  // errno to go with result, written by the thread that set it.
+  int error;
+};
+
+struct WalkDir {
+  ParallelWalk* walk;
+  WalkDir* parent;
+  struct stat st;
+  int base;
+  int level;
+  bool visit_postorder;
+  // This directory's own task plus those of its subdirectories, which need it for cycle
+  // detection and, with FTW_DEPTH, have to finish before it's reported.
+  atomic_int pending;
+  size_t path_len;
+  char* path;
+};
+
+static bool WalkStopped(ParallelWalk* walk) {
+  return atomic_load_explicit(&walk->result, memory_order_relaxed) != 0;
+}
+
+static void StopWalk(ParallelWalk* walk, int result, int error) {
+  int expected = 0;
+  if (atomic_compare_exchange_strong(&walk->result, &expected, result)) {
+    walk->error = error;
+  }
+}
+
+static void Visit(ParallelWalk* walk, const char* path, const struct stat* st, int flag,
+                  int base, int level) {
+  if (WalkStopped(walk)) return;
+  FTW ftw;
+  ftw.base = base;
+  ftw.level = level;
+  int result = walk->fn(path, st, flag, &ftw);
+  if (result != 0) StopWalk(walk, result, errno);
+}
+
+// Stats name relative to dir_fd, following symbolic links unless FTW_PHYS is set, and
+// returns the flag to report it with.
+static int StatEntry(int dir_fd, const char* name, int nftw_flags, struct stat* st) {
+  if (!(nftw_flags & FTW_PHYS)) {
+    if (fstatat(dir_fd, name, st, 0) == 0) return S_ISDIR(st->st_mode) ? FTW_D : FTW_F;
+    if (fstatat(dir_fd, name, st, AT_SYMLINK_NOFOLLOW) == 0) return FTW_SLN;
+  } else if (fstatat(dir_fd, name, st, AT_SYMLINK_NOFOLLOW) == 0) {
+    if (S_ISDIR(st->st_mode)) return FTW_D;
+    return S_ISLNK(st->st_mode) ? FTW_SL : FTW_F;
+  }
+  memset(st, 0, sizeof(*st));
+  return FTW_NS;
+}
+
+static void WalkDirTask(void* arg);
+
+static void SpawnDir(ParallelWalk* walk, WalkDir* parent, const char* path, size_t path_len,
+                     const struct stat* st, int base, int level) {
+  WalkDir* dir = reinterpret_cast<WalkDir*>(malloc(sizeof(WalkDir) + path_len + 1));
+  if (dir == nullptr) {
+    StopWalk(walk, -1, ENOMEM);
+    return;
+  }
+  dir->walk = walk;
+  dir->parent = parent;
+  dir->st = *st;
+  dir->base = base;
+  dir->level = level;
+  dir->visit_postorder = false;
+  atomic_init(&dir->pending, 1);
+  dir->path_len = path_len;
+  dir->path = reinterpret_cast<char*>(dir + 1);
+  memcpy(dir->path, path, path_len + 1);
+
+  if (parent != nullptr) atomic_fetch_add(&parent->pending, 1);
+  android_work_pool_spawn(&walk->group, WalkDirTask, dir);
+}
+
+// Drops a reference to dir, and once nothing is left in it, reports it if it's owed an
+// FTW_DP and moves on to its parent.
+static void ReleaseDir(WalkDir* dir) {
+  while (dir != nullptr && atomic_fetch_sub(&dir->pending, 1) == 1) {
+    if (dir->visit_postorder) {
+      Visit(dir->walk, dir->path, &dir->st, FTW_DP, dir->base, dir->level);
+    }
+    WalkDir* parent = dir->parent;
+    free(dir);
+    dir = parent;
+  }
+}
+
+static bool IsCycle(WalkDir* dir, const struct stat* st) {
+  for (; dir != nullptr; dir = dir->parent) {
+    if (dir->st.st_dev == st->st_dev && dir->st.st_ino == st->st_ino) return true;
+  }
+  return false;
+}
+
+static void ReadDir(WalkDir* dir) {
+  ParallelWalk* walk = dir->walk;
+
+  DIR* d = nullptr;
+  int fd = open(dir->path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (fd != -1 && (d = fdopendir(fd)) == nullptr) close(fd);
+  if (d == nullptr) {
+    Visit(walk, dir->path, &dir->st, FTW_DNR, dir->base, dir->level);
+    return;
+  }
+  if (walk->flags & FTW_DEPTH) {
+    dir->visit_postorder = true;
+  } else {
+    Visit(walk, dir->path, &dir->st, FTW_D, dir->base, dir->level);
+  }
+  if ((walk->flags & FTW_MOUNT) && dir->st.st_dev != walk->root_dev) {
+    closedir(d);
+    return;
+  }
+
+  // Entries' paths are this directory's path, a '/' and their name.
+  size_t prefix_len = dir->path_len;
+  if (prefix_len > 0 && dir->path[prefix_len - 1] == '/') --prefix_len;
+  char* path = reinterpret_cast<char*>(malloc(prefix_len + 1 + NAME_MAX + 1));
+  if (path == nullptr) {
+    StopWalk(walk, -1, ENOMEM);
+    closedir(d);
+    return;
+  }
+  memcpy(path, dir->path, prefix_len);
+  path[prefix_len] = '/';
+  int base = prefix_len + 1;
+
+  dirent* entries[64];
+  int count;
+  while (!WalkStopped(walk) && (count = android_readdir_batch(d, entries, 64)) > 0) {
+    for (int i = 0; i < count; ++i) {
+      const char* name = entries[i]->d_name;
+      if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))) continue;
+
+      size_t name_len = strlen(name);
+      memcpy(path + base, name, name_len + 1);
+      struct stat st;
+      int flag = StatEntry(dirfd(d), name, walk->flags, &st);
+      if (flag != FTW_D) {
+        Visit(walk, path, &st, flag, base, dir->level + 1);
+      } else if (!(walk->flags & FTW_PHYS) && IsCycle(dir, &st)) {
+        StopWalk(walk, -1, ELOOP);
+        break;
+      } else {
+        SpawnDir(walk, dir, path, base + name_len, &st, base, dir->level + 1);
+      }
+    }
+  }
+
+  free(path);
+  closedir(d);
+}
+
+static void WalkDirTask(void* arg) {
+  WalkDir* dir = reinterpret_cast<WalkDir*>(arg);
+  if (!WalkStopped(dir->walk)) ReadDir(dir);
+  ReleaseDir(dir);
+}
+
+int android_nftw_parallel(const char* path,
+                          int (*nftw_fn)(const char*, const struct stat*, int, FTW*),
+                          int nfds, int nftw_flags) {
+  // As with nftw, nfds is unused: each worker has at most one directory open at a time.
+  if (nfds < 1 || nftw_fn == nullptr || (nftw_flags & FTW_CHDIR)) {
+    errno = EINVAL;
+    return -1;
+  }
+  if (*path == '\0') {
+    errno = ENOENT;
+    return -1;
+  }
+
+  ParallelWalk walk;
+  walk.fn = nftw_fn;
+  walk.flags = nftw_flags;
+  walk.group = ANDROID_WORK_GROUP_INITIALIZER;
+  atomic_init(&walk.result, 0);
+  walk.error = 0;
+
+  // As with nftw, the root is followed even for a physical walk.
+  struct stat st;
+  int flag = StatEntry(AT_FDCWD, path, nftw_flags & ~FTW_PHYS, &st);
+  if (flag == FTW_D) {
+    walk.root_dev = st.st_dev;
+    SpawnDir(&walk, nullptr, path, strlen(path), &st, 0, 0);
+    android_work_pool_wait(&walk.group);
+  } else {
+    Visit(&walk, path, &st, flag, 0, 0);
+  }
+
+  int result = atomic_load(&walk.result);
+  if (result != 0) errno = walk.error;
+  return result;
+}
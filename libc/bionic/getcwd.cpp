@@ -28,6 +28,7 @@
 
 #undef _FORTIFY_SOURCE
 #include <errno.h>
+#include <limits.h>
 #include <malloc.h>
 #include <string.h>
 #include <unistd.h>
@@ -41,16 +42,27 @@ char* getcwd(char* buf, size_t size) {
     return NULL;
   }
 
+  // If you're asking us to allocate exactly as much as necessary, we only need to allocate the
+  // copy. The Linux kernel won't return more than PATH_MAX bytes.
+  // TODO: if we need to support paths longer than that, we'll have to walk the tree ourselves.
+  if (buf == NULL && size == 0) {
+    char path[PATH_MAX];
+    if (__getcwd(path, sizeof(path)) == -1) {
+      // __getcwd set errno.
+      return NULL;
+    }
+    buf = strdup(path);
+    if (buf == NULL) {
+      // malloc should set errno, but valgrind's malloc wrapper doesn't.
+      errno = ENOMEM;
+    }
+    return buf;
+  }
+
   // Allocate a buffer if necessary.
   char* allocated_buf = NULL;
-  size_t allocated_size = size;
   if (buf == NULL) {
-    if (size == 0) {
-      // The Linux kernel won't return more than a page, so translate size 0 to 4KiB.
-      // TODO: if we need to support paths longer than that, we'll have to walk the tree ourselves.
-      allocated_size = getpagesize();
-    }
-    buf = allocated_buf = static_cast<char*>(malloc(allocated_size));
+    buf = allocated_buf = static_cast<char*>(malloc(size));
     if (buf == NULL) {
       // malloc should set errno, but valgrind's malloc wrapper doesn't.
       errno = ENOMEM;
@@ -59,22 +71,12 @@ char* getcwd(char* buf, size_t size) {
   }
 
   // Ask the kernel to fill our buffer.
-  int rc = __getcwd(buf, allocated_size);
+  int rc = __getcwd(buf, size);
   if (rc == -1) {
     free(allocated_buf);
     // __getcwd set errno.
     return NULL;
   }
 
-  // If we allocated a whole page, only return as large an allocation as necessary.
-  if (allocated_buf != NULL) {
-    if (size == 0) {
-      buf = strdup(allocated_buf);
-      free(allocated_buf);
-    } else {
-      buf = allocated_buf;
-    }
-  }
-
   return buf;
 }
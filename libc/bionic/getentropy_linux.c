@@ -76,7 +76,7 @@
 int	getentropy(void *buf, size_t len);
 
 static int gotdata(char *buf, size_t len);
-#ifdef SYS__getrandom
+#ifdef SYS_getrandom
 static int getentropy_getrandom(void *buf, size_t len);
 #endif
 static int getentropy_urandom(void *buf, size_t len);
@@ -98,7 +98,7 @@ getentropy(void *buf, size_t len)
 		return -1;
 	}
 
-#ifdef SYS__getrandom
+#ifdef SYS_getrandom
 	/*
 	 * Try descriptor-less getrandom()
 	 */
@@ -194,33 +194,26 @@ gotdata(char *buf, size_t len)
 	return 0;
 }
 
-#ifdef SYS__getrandom
+#ifdef SYS_getrandom
 static int
 getentropy_getrandom(void *buf, size_t len)
 {
-#if 0
-
-/* Hand-definitions until the API becomes commonplace */
-#ifndef SYS__getrandom
-#ifdef __LP64__
-#define SYS__getrandom 317
-#else
-#define SYS__getrandom 354
-#endif
-#endif
-	struct __getrandom_args args = {
-		.buf = buf;
-		.len = len;
-		.flags = 0;
-	};
-
+	int pre_errno = errno;
+	int ret;
 	if (len > 256)
 		return (-1);
-	ret = syscall(SYS__getrandom, &args);
-	if (ret == len)
-		return (0);
-#endif
-	return -1;
+	/*
+	 * Don't block waiting for the pool to be initialized early in boot;
+	 * the /dev/urandom fallback below doesn't either.
+	 */
+	do {
+		ret = syscall(SYS_getrandom, buf, len, GRND_NONBLOCK);
+	} while (ret == -1 && errno == EINTR);
+
+	if (ret != (int)len)
+		return (-1);
+	errno = pre_errno;
+	return (0);
 }
 #endif
 
@@ -43,7 +43,8 @@ pid_t getpid() {
     }
   }
 
-  // We're still in the dynamic linker or we're in the middle of forking, so ask the kernel.
+  // We're still in the dynamic linker, in the middle of forking, or a vfork or clone child
+  // sharing our parent's pthread_internal_t, so ask the kernel.
   // We don't know whether it's safe to update the cached value, so don't try.
   return __getpid();
 }
@@ -26,10 +26,19 @@
  * SUCH DAMAGE.
  */
 
+#include <sys/syscall.h>
 #include <unistd.h>
 
 #include "pthread_internal.h"
 
 pid_t gettid() {
-  return __get_thread()->tid;
+  pthread_internal_t* self = __get_thread();
+
+  // The tid is good whenever the pid is. When the pid isn't cached, we may be a vfork or clone
+  // child that shares its parent's pthread_internal_t, so ask the kernel.
+  pid_t cached_pid;
+  if (__predict_true(self->get_cached_pid(&cached_pid))) {
+    return self->tid;
+  }
+  return syscall(__NR_gettid);
 }
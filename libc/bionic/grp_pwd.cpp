@@ -32,6 +32,7 @@
 #include <mntent.h>
 #include <pthread.h>
 #include <pwd.h>
+#include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -50,12 +51,25 @@
 // functions to share state, but <grp.h> functions can't clobber <passwd.h>
 // functions' state and vice versa.
 
+// The names of the last few app ids looked up, in either direction. Formatting and parsing
+// these names is most of the cost of getpwuid(3) and friends for app ids, and callers that
+// render file ownership tend to ask about the same few ids over and over.
+struct app_name_cache_t {
+  static constexpr size_t kSize = 4;
+  struct entry {
+    id_t id;
+    char name[32];
+  } entries[kSize];
+  size_t next;
+};
+
 struct group_state_t {
   group group_;
   char* group_members_[2];
   char group_name_buffer_[32];
-  // Must be last so init_group_state can run a simple memset for the above
+  // Everything from here on survives init_group_state's memset.
   ssize_t getgrent_idx;
+  app_name_cache_t app_names_;
 };
 
 struct passwd_state_t {
@@ -64,13 +78,14 @@ struct passwd_state_t {
   char dir_buffer_[32];
   char sh_buffer_[32];
   ssize_t getpwent_idx;
+  app_name_cache_t app_names_;
 };
 
 static ThreadLocalBuffer<group_state_t> g_group_tls_buffer;
 static ThreadLocalBuffer<passwd_state_t> g_passwd_tls_buffer;
 
 static void init_group_state(group_state_t* state) {
-  memset(state, 0, sizeof(group_state_t) - sizeof(state->getgrent_idx));
+  memset(state, 0, offsetof(group_state_t, getgrent_idx));
   state->group_.gr_mem = state->group_members_;
 }
 
@@ -168,42 +183,125 @@ static group* android_iinfo_to_group(group_state_t* state,
   return gr;
 }
 
-static passwd* android_id_to_passwd(passwd_state_t* state, unsigned id) {
+// android_ids comes from a header we don't own and isn't constexpr, so rather than generate a
+// perfect hash at build time we build open-addressed indexes by id and by name the first time
+// they're needed. With the tables at most half full, a lookup is a probe or two.
+static constexpr size_t android_id_index_size() {
+  size_t size = 1;
+  while (size < 2 * android_id_count) size *= 2;
+  return size;
+}
+static constexpr size_t kAndroidIdIndexSize = android_id_index_size();
+
+// Each slot holds an index into android_ids plus one, or zero if it's empty.
+static uint16_t g_android_id_by_aid[kAndroidIdIndexSize];
+static uint16_t g_android_id_by_name[kAndroidIdIndexSize];
+static pthread_once_t g_android_id_index_once = PTHREAD_ONCE_INIT;
+
+static size_t hash_aid(unsigned id) {
+  return (id * 0x9e3779b1u) & (kAndroidIdIndexSize - 1);
+}
+
+static size_t hash_name(const char* name) {
+  uint32_t h = 2166136261u;
+  for (const char* p = name; *p != 0; ++p) {
+    h = (h ^ static_cast<uint8_t>(*p)) * 16777619u;
+  }
+  return h & (kAndroidIdIndexSize - 1);
+}
+
+static void init_android_id_index() {
   for (size_t n = 0; n < android_id_count; ++n) {
-    if (android_ids[n].aid == id) {
-      return android_iinfo_to_passwd(state, android_ids + n);
+    // If there are duplicates, the first entry wins, as it did for a linear search.
+    size_t i = hash_aid(android_ids[n].aid);
+    while (g_android_id_by_aid[i] != 0 &&
+           android_ids[g_android_id_by_aid[i] - 1].aid != android_ids[n].aid) {
+      i = (i + 1) & (kAndroidIdIndexSize - 1);
     }
+    if (g_android_id_by_aid[i] == 0) g_android_id_by_aid[i] = n + 1;
+
+    i = hash_name(android_ids[n].name);
+    while (g_android_id_by_name[i] != 0 &&
+           strcmp(android_ids[g_android_id_by_name[i] - 1].name, android_ids[n].name) != 0) {
+      i = (i + 1) & (kAndroidIdIndexSize - 1);
+    }
+    if (g_android_id_by_name[i] == 0) g_android_id_by_name[i] = n + 1;
   }
-  return NULL;
 }
 
-static passwd* android_name_to_passwd(passwd_state_t* state, const char* name) {
-  for (size_t n = 0; n < android_id_count; ++n) {
-    if (!strcmp(android_ids[n].name, name)) {
-      return android_iinfo_to_passwd(state, android_ids + n);
+static const android_id_info* find_android_id_info(unsigned id) {
+  pthread_once(&g_android_id_index_once, init_android_id_index);
+  for (size_t i = hash_aid(id); g_android_id_by_aid[i] != 0;
+       i = (i + 1) & (kAndroidIdIndexSize - 1)) {
+    const android_id_info* iinfo = &android_ids[g_android_id_by_aid[i] - 1];
+    if (iinfo->aid == id) {
+      return iinfo;
     }
   }
   return NULL;
 }
 
-static group* android_id_to_group(group_state_t* state, unsigned id) {
-  for (size_t n = 0; n < android_id_count; ++n) {
-    if (android_ids[n].aid == id) {
-      return android_iinfo_to_group(state, android_ids + n);
+static const android_id_info* find_android_id_info(const char* name) {
+  pthread_once(&g_android_id_index_once, init_android_id_index);
+  for (size_t i = hash_name(name); g_android_id_by_name[i] != 0;
+       i = (i + 1) & (kAndroidIdIndexSize - 1)) {
+    const android_id_info* iinfo = &android_ids[g_android_id_by_name[i] - 1];
+    if (!strcmp(iinfo->name, name)) {
+      return iinfo;
     }
   }
   return NULL;
 }
 
+static passwd* android_id_to_passwd(passwd_state_t* state, unsigned id) {
+  const android_id_info* iinfo = find_android_id_info(id);
+  return (iinfo != NULL) ? android_iinfo_to_passwd(state, iinfo) : NULL;
+}
+
+static passwd* android_name_to_passwd(passwd_state_t* state, const char* name) {
+  const android_id_info* iinfo = find_android_id_info(name);
+  return (iinfo != NULL) ? android_iinfo_to_passwd(state, iinfo) : NULL;
+}
+
+static group* android_id_to_group(group_state_t* state, unsigned id) {
+  const android_id_info* iinfo = find_android_id_info(id);
+  return (iinfo != NULL) ? android_iinfo_to_group(state, iinfo) : NULL;
+}
+
 static group* android_name_to_group(group_state_t* state, const char* name) {
-  for (size_t n = 0; n < android_id_count; ++n) {
-    if (!strcmp(android_ids[n].name, name)) {
-      return android_iinfo_to_group(state, android_ids + n);
+  const android_id_info* iinfo = find_android_id_info(name);
+  return (iinfo != NULL) ? android_iinfo_to_group(state, iinfo) : NULL;
+}
+
+static const char* app_name_cache_find(const app_name_cache_t* cache, id_t id) {
+  for (const auto& entry : cache->entries) {
+    if (entry.name[0] != 0 && entry.id == id) {
+      return entry.name;
     }
   }
   return NULL;
 }
 
+static bool app_name_cache_find(const app_name_cache_t* cache, const char* name, id_t* id) {
+  for (const auto& entry : cache->entries) {
+    if (entry.name[0] != 0 && !strcmp(entry.name, name)) {
+      *id = entry.id;
+      return true;
+    }
+  }
+  return false;
+}
+
+static void app_name_cache_add(app_name_cache_t* cache, id_t id, const char* name) {
+  size_t length = strlen(name);
+  if (length == 0 || length >= sizeof(cache->entries[0].name)) {
+    return;
+  }
+  app_name_cache_t::entry* entry = &cache->entries[cache->next++ % app_name_cache_t::kSize];
+  entry->id = id;
+  memcpy(entry->name, name, length + 1);
+}
+
 // Translate a user/group name to the corresponding user/group id.
 // all_a1234 -> 0 * AID_USER + AID_SHARED_GID_START + 1234 (group name only)
 // u0_a1234 -> 0 * AID_USER + AID_APP + 1234
@@ -248,13 +346,11 @@ static id_t app_id_from_name(const char* name, bool is_group) {
     // end will point to \0 if the strtoul below succeeds.
     appid = strtoul(end+2, &end, 10) + AID_ISOLATED_START;
   } else {
-    for (size_t n = 0; n < android_id_count; n++) {
-      if (!strcmp(android_ids[n].name, end + 1)) {
-        appid = android_ids[n].aid;
-        // Move the end pointer to the null terminator.
-        end += strlen(android_ids[n].name) + 1;
-        break;
-      }
+    const android_id_info* iinfo = find_android_id_info(end + 1);
+    if (iinfo != NULL) {
+      appid = iinfo->aid;
+      // Move the end pointer to the null terminator.
+      end += strlen(iinfo->name) + 1;
     }
   }
 
@@ -279,24 +375,26 @@ static id_t app_id_from_name(const char* name, bool is_group) {
   return (appid + userid*AID_USER);
 }
 
-static void print_app_name_from_uid(const uid_t uid, char* buffer, const int bufferlen) {
+// Returns false if there's no name for uid.
+static bool print_app_name_from_uid(const uid_t uid, char* buffer, const int bufferlen) {
   const uid_t appid = uid % AID_USER;
   const uid_t userid = uid / AID_USER;
   if (appid >= AID_ISOLATED_START) {
     snprintf(buffer, bufferlen, "u%u_i%u", userid, appid - AID_ISOLATED_START);
   } else if (appid < AID_APP) {
-    for (size_t n = 0; n < android_id_count; n++) {
-      if (android_ids[n].aid == appid) {
-        snprintf(buffer, bufferlen, "u%u_%s", userid, android_ids[n].name);
-        return;
-      }
+    const android_id_info* iinfo = find_android_id_info(appid);
+    if (iinfo == NULL) {
+      return false;
     }
+    snprintf(buffer, bufferlen, "u%u_%s", userid, iinfo->name);
   } else {
     snprintf(buffer, bufferlen, "u%u_a%u", userid, appid - AID_APP);
   }
+  return true;
 }
 
-static void print_app_name_from_gid(const gid_t gid, char* buffer, const int bufferlen) {
+// Returns false if there's no name for gid.
+static bool print_app_name_from_gid(const gid_t gid, char* buffer, const int bufferlen) {
   const uid_t appid = gid % AID_USER;
   const uid_t userid = gid / AID_USER;
   if (appid >= AID_ISOLATED_START) {
@@ -304,15 +402,15 @@ static void print_app_name_from_gid(const gid_t gid, char* buffer, const int buf
   } else if (userid == 0 && appid >= AID_SHARED_GID_START && appid <= AID_SHARED_GID_END) {
     snprintf(buffer, bufferlen, "all_a%u", appid - AID_SHARED_GID_START);
   } else if (appid < AID_APP) {
-    for (size_t n = 0; n < android_id_count; n++) {
-      if (android_ids[n].aid == appid) {
-        snprintf(buffer, bufferlen, "u%u_%s", userid, android_ids[n].name);
-        return;
-      }
+    const android_id_info* iinfo = find_android_id_info(appid);
+    if (iinfo == NULL) {
+      return false;
     }
+    snprintf(buffer, bufferlen, "u%u_%s", userid, iinfo->name);
   } else {
     snprintf(buffer, bufferlen, "u%u_a%u", userid, appid - AID_APP);
   }
+  return true;
 }
 
 // oem_XXXX -> uid
@@ -382,7 +480,12 @@ static passwd* app_id_to_passwd(uid_t uid, passwd_state_t* state) {
     return NULL;
   }
 
-  print_app_name_from_uid(uid, state->name_buffer_, sizeof(state->name_buffer_));
+  const char* name = app_name_cache_find(&state->app_names_, uid);
+  if (name != NULL) {
+    strcpy(state->name_buffer_, name);
+  } else if (print_app_name_from_uid(uid, state->name_buffer_, sizeof(state->name_buffer_))) {
+    app_name_cache_add(&state->app_names_, uid, state->name_buffer_);
+  }
 
   const uid_t appid = uid % AID_USER;
   if (appid < AID_APP) {
@@ -410,7 +513,13 @@ static group* app_id_to_group(gid_t gid, group_state_t* state) {
     return NULL;
   }
 
-  print_app_name_from_gid(gid, state->group_name_buffer_, sizeof(state->group_name_buffer_));
+  const char* name = app_name_cache_find(&state->app_names_, gid);
+  if (name != NULL) {
+    strcpy(state->group_name_buffer_, name);
+  } else if (print_app_name_from_gid(gid, state->group_name_buffer_,
+                                     sizeof(state->group_name_buffer_))) {
+    app_name_cache_add(&state->app_names_, gid, state->group_name_buffer_);
+  }
 
   group* gr = &state->group_;
   gr->gr_name   = state->group_name_buffer_;
@@ -452,7 +561,12 @@ passwd* getpwnam(const char* login) { // NOLINT: implementing bad function.
   if (pw != NULL) {
     return pw;
   }
-  return app_id_to_passwd(app_id_from_name(login, false), state);
+  // Only the names we've printed are cached, so a hit means login is the canonical name.
+  id_t uid;
+  if (!app_name_cache_find(&state->app_names_, login, &uid)) {
+    uid = app_id_from_name(login, false);
+  }
+  return app_id_to_passwd(uid, state);
 }
 
 // All users are in just one group, the one passed in.
@@ -555,7 +669,11 @@ static group* getgrnam_internal(const char* name, group_state_t* state) {
   if (grp != NULL) {
     return grp;
   }
-  return app_id_to_group(app_id_from_name(name, true), state);
+  id_t gid;
+  if (!app_name_cache_find(&state->app_names_, name, &gid)) {
+    gid = app_id_from_name(name, true);
+  }
+  return app_id_to_group(gid, state);
 }
 
 group* getgrnam(const char* name) { // NOLINT: implementing bad function.
@@ -576,6 +694,8 @@ static int getgroup_r(bool by_name, const char* name, gid_t gid, struct group* g
     return ERANGE;
   }
   group_state_t* state = reinterpret_cast<group_state_t*>(p);
+  // There's no cache worth keeping in the caller's buffer.
+  memset(&state->app_names_, 0, sizeof(state->app_names_));
   init_group_state(state);
   group* retval = (by_name ? getgrnam_internal(name, state) : getgrgid_internal(gid, state));
   if (retval != NULL) {
@@ -0,0 +1,171 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <errno.h>
+#include <search.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// An open-addressed table probed with triangular numbers, which visit every slot of a
+// power-of-two table. Each slot keeps its key's hash, so most mismatches cost no strcmp.
+// There's no way to remove an entry, so no tombstones either.
+
+struct hsearch_slot {
+  ENTRY entry;  // An empty slot has a null key.
+  size_t hash;
+};
+
+struct __hsearch_table {
+  size_t mask;
+  size_t used;
+  hsearch_slot slots[];
+};
+
+static constexpr size_t kMinSlots = 8;
+
+// Grow before the table is more than 3/4 full.
+static bool too_full(size_t used, size_t mask) {
+  return used > (mask + 1) / 4 * 3;
+}
+
+// FNV-1a.
+static size_t hash_key(const char* key) {
+  uint32_t h = 2166136261u;
+  for (const unsigned char* p = reinterpret_cast<const unsigned char*>(key); *p != '\0'; ++p) {
+    h = (h ^ *p) * 16777619u;
+  }
+  return h;
+}
+
+static __hsearch_table* alloc_table(size_t min_entries) {
+  size_t slots = kMinSlots;
+  while (too_full(min_entries, slots - 1)) {
+    if (slots > (SIZE_MAX - sizeof(__hsearch_table)) / sizeof(hsearch_slot) / 2) {
+      errno = ENOMEM;
+      return nullptr;
+    }
+    slots *= 2;
+  }
+  __hsearch_table* table = reinterpret_cast<__hsearch_table*>(
+      calloc(1, sizeof(__hsearch_table) + slots * sizeof(hsearch_slot)));
+  if (table == nullptr) {
+    errno = ENOMEM;
+    return nullptr;
+  }
+  table->mask = slots - 1;
+  return table;
+}
+
+// Returns the slot holding key, or the empty slot where it belongs.
+static hsearch_slot* find_slot(__hsearch_table* table, const char* key, size_t hash) {
+  for (size_t i = hash, step = 1; ; i += step++) {
+    hsearch_slot* slot = &table->slots[i & table->mask];
+    if (slot->entry.key == nullptr ||
+        (slot->hash == hash && strcmp(slot->entry.key, key) == 0)) {
+      return slot;
+    }
+  }
+}
+
+static bool grow_table(hsearch_data* htab) {
+  __hsearch_table* old_table = htab->__table;
+  __hsearch_table* new_table = alloc_table(old_table->used + 1);
+  if (new_table == nullptr) {
+    return false;
+  }
+  for (size_t i = 0; i <= old_table->mask; ++i) {
+    const hsearch_slot& old_slot = old_table->slots[i];
+    if (old_slot.entry.key != nullptr) {
+      *find_slot(new_table, old_slot.entry.key, old_slot.hash) = old_slot;
+    }
+  }
+  new_table->used = old_table->used;
+  free(old_table);
+  htab->__table = new_table;
+  return true;
+}
+
+int hcreate_r(size_t n, hsearch_data* htab) {
+  if (htab == nullptr) {
+    errno = EINVAL;
+    return 0;
+  }
+  htab->__table = alloc_table(n);
+  return (htab->__table != nullptr);
+}
+
+void hdestroy_r(hsearch_data* htab) {
+  if (htab == nullptr) {
+    errno = EINVAL;
+    return;
+  }
+  free(htab->__table);
+  htab->__table = nullptr;
+}
+
+int hsearch_r(ENTRY item, ACTION action, ENTRY** result, hsearch_data* htab) {
+  if (htab == nullptr || htab->__table == nullptr) {
+    errno = EINVAL;
+    *result = nullptr;
+    return 0;
+  }
+
+  size_t hash = hash_key(item.key);
+  hsearch_slot* slot = find_slot(htab->__table, item.key, hash);
+  if (slot->entry.key != nullptr) {
+    *result = &slot->entry;
+    return 1;
+  }
+  if (action == FIND) {
+    errno = ESRCH;
+    *result = nullptr;
+    return 0;
+  }
+
+  if (too_full(htab->__table->used + 1, htab->__table->mask)) {
+    if (!grow_table(htab)) {
+      *result = nullptr;
+      return 0;
+    }
+    slot = find_slot(htab->__table, item.key, hash);
+  }
+  slot->entry = item;
+  slot->hash = hash;
+  ++htab->__table->used;
+  *result = &slot->entry;
+  return 1;
+}
+
+static hsearch_data g_hsearch_data;
+
+int hcreate(size_t n) {
+  // POSIX doesn't say what happens if there's already a table; we just keep it.
+  if (g_hsearch_data.__table != nullptr) {
+    return 1;
+  }
+  return hcreate_r(n, &g_hsearch_data);
+}
+
+void hdestroy() {
+  hdestroy_r(&g_hsearch_data);
+}
+
+ENTRY* hsearch(ENTRY item, ACTION action) {
+  ENTRY* result;
+  hsearch_r(item, action, &result, &g_hsearch_data);
+  return result;
+}
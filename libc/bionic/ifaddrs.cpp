@@ -59,12 +59,13 @@ struct ifaddrs_storage {
   sockaddr_storage ifa_ifu;
   char name[IFNAMSIZ + 1];
 
-  explicit ifaddrs_storage(ifaddrs** list) {
-    memset(this, 0, sizeof(*this));
-
-    // push_front onto `list`.
-    ifa.ifa_next = *list;
-    *list = reinterpret_cast<ifaddrs*>(this);
+  // The pointers in `ifa` point into this entry, so when it's moved from `old_this`
+  // they need moving too.
+  void Rebase(uintptr_t old_this) {
+    RebasePointer(old_this, &ifa.ifa_name);
+    RebasePointer(old_this, &ifa.ifa_addr);
+    RebasePointer(old_this, &ifa.ifa_netmask);
+    RebasePointer(old_this, &ifa.ifa_ifu.ifu_broadaddr);
   }
 
   void SetAddress(int family, const void* data, size_t byteCount) {
@@ -124,6 +125,14 @@ struct ifaddrs_storage {
   }
 
  private:
+  template <typename T>
+  void RebasePointer(uintptr_t old_this, T** p) {
+    if (*p != nullptr) {
+      uintptr_t offset = reinterpret_cast<uintptr_t>(*p) - old_this;
+      *p = reinterpret_cast<T*>(reinterpret_cast<uintptr_t>(this) + offset);
+    }
+  }
+
   sockaddr* CopyAddress(int family, const void* data, size_t byteCount, sockaddr_storage* ss) {
     // Netlink gives us the address family in the header, and the
     // sockaddr_in or sockaddr_in6 bytes as the payload. We need to
@@ -157,14 +166,81 @@ struct ifaddrs_storage {
   }
 };
 
+// The whole result is built in one array, so there's a single allocation for freeifaddrs to
+// free, with the list threaded through it once it's complete. Links come first, followed by
+// addresses.
+struct ifaddrs_builder {
+  ifaddrs_storage* entries;
+  size_t count;
+  size_t capacity;
+  bool failed;
+
+  // The links' entries by interface index, so each RTM_NEWADDR message finds its link without
+  // searching the whole list. Built once all the links are in; slots hold an entry index + 1.
+  size_t link_count;
+  size_t* link_table;
+  size_t link_table_mask;
+
+  ifaddrs_storage* Add() {
+    if (count == capacity) {
+      size_t new_capacity = (capacity == 0) ? 16 : capacity * 2;
+      ifaddrs_storage* new_entries = reinterpret_cast<ifaddrs_storage*>(
+          realloc(entries, new_capacity * sizeof(ifaddrs_storage)));
+      if (new_entries == nullptr) {
+        failed = true;
+        return nullptr;
+      }
+      Moved(reinterpret_cast<uintptr_t>(entries), new_entries);
+      entries = new_entries;
+      capacity = new_capacity;
+    }
+    ifaddrs_storage* result = &entries[count++];
+    memset(result, 0, sizeof(*result));
+    return result;
+  }
+
+  // Fixes up the first `count` entries after they've been moved from `old_entries`.
+  void Moved(uintptr_t old_entries, ifaddrs_storage* new_entries) {
+    if (old_entries == reinterpret_cast<uintptr_t>(new_entries)) return;
+    for (size_t i = 0; i < count; ++i) {
+      new_entries[i].Rebase(old_entries + i * sizeof(ifaddrs_storage));
+    }
+  }
+
+  bool IndexLinks() {
+    link_count = count;
+    size_t slots = 16;
+    while (slots < 2 * link_count) slots *= 2;
+    link_table = reinterpret_cast<size_t*>(calloc(slots, sizeof(size_t)));
+    if (link_table == nullptr) return false;
+    link_table_mask = slots - 1;
+    for (size_t i = 0; i < link_count; ++i) {
+      size_t slot = entries[i].interface_index & link_table_mask;
+      while (link_table[slot] != 0) slot = (slot + 1) & link_table_mask;
+      link_table[slot] = i + 1;
+    }
+    return true;
+  }
+
+  const ifaddrs_storage* FindLink(int interface_index) {
+    size_t slot = interface_index & link_table_mask;
+    for (; link_table[slot] != 0; slot = (slot + 1) & link_table_mask) {
+      const ifaddrs_storage* link = &entries[link_table[slot] - 1];
+      if (link->interface_index == interface_index) return link;
+    }
+    return nullptr;
+  }
+};
+
 static void __getifaddrs_callback(void* context, nlmsghdr* hdr) {
-  ifaddrs** out = reinterpret_cast<ifaddrs**>(context);
+  ifaddrs_builder* builder = reinterpret_cast<ifaddrs_builder*>(context);
 
   if (hdr->nlmsg_type == RTM_NEWLINK) {
     ifinfomsg* ifi = reinterpret_cast<ifinfomsg*>(NLMSG_DATA(hdr));
 
     // Create a new ifaddr entry, and set the interface index and flags.
-    ifaddrs_storage* new_addr = new ifaddrs_storage(out);
+    ifaddrs_storage* new_addr = builder->Add();
+    if (new_addr == nullptr) return;
     new_addr->interface_index = ifi->ifi_index;
     new_addr->ifa.ifa_flags = ifi->ifi_flags;
 
@@ -194,15 +270,14 @@ static void __getifaddrs_callback(void* context, nlmsghdr* hdr) {
     ifaddrmsg* msg = reinterpret_cast<ifaddrmsg*>(NLMSG_DATA(hdr));
 
     // We should already know about this from an RTM_NEWLINK message.
-    const ifaddrs_storage* addr = reinterpret_cast<const ifaddrs_storage*>(*out);
-    while (addr != nullptr && addr->interface_index != static_cast<int>(msg->ifa_index)) {
-      addr = reinterpret_cast<const ifaddrs_storage*>(addr->ifa.ifa_next);
-    }
     // If this is an unknown interface, ignore whatever we're being told about it.
-    if (addr == nullptr) return;
+    if (builder->FindLink(msg->ifa_index) == nullptr) return;
 
     // Create a new ifaddr entry and copy what we already know.
-    ifaddrs_storage* new_addr = new ifaddrs_storage(out);
+    ifaddrs_storage* new_addr = builder->Add();
+    if (new_addr == nullptr) return;
+    // Look the link up again, in case adding an entry moved it.
+    const ifaddrs_storage* addr = builder->FindLink(msg->ifa_index);
     // We can just copy the name rather than look for IFA_LABEL.
     strcpy(new_addr->name, addr->name);
     new_addr->ifa.ifa_name = new_addr->name;
@@ -233,28 +308,62 @@ static void __getifaddrs_callback(void* context, nlmsghdr* hdr) {
   }
 }
 
-int getifaddrs(ifaddrs** out) {
-  // We construct the result directly into `out`, so terminate the list.
+int android_getifaddrs_filtered(ifaddrs** out, int family, unsigned int if_index) {
+  // Ensure that callers crash if they forget to check for success.
   *out = nullptr;
 
-  // Open the netlink socket and ask for all the links and addresses.
+  if (family != AF_UNSPEC && family != AF_PACKET && family != AF_INET && family != AF_INET6) {
+    errno = EAFNOSUPPORT;
+    return -1;
+  }
+
+  ifaddrs_builder builder;
+  memset(&builder, 0, sizeof(builder));
+
+  // Open the netlink socket and ask for the links. We need them even if the caller only wants
+  // addresses, for their names and flags.
   NetlinkConnection nc;
-  bool okay = nc.SendRequest(RTM_GETLINK) && nc.ReadResponses(__getifaddrs_callback, out) &&
-              nc.SendRequest(RTM_GETADDR) && nc.ReadResponses(__getifaddrs_callback, out);
-  if (!okay) {
-    freeifaddrs(*out);
-    // Ensure that callers crash if they forget to check for success.
-    *out = nullptr;
+  bool okay = (if_index == 0) ? nc.SendRequest(RTM_GETLINK) : nc.SendLinkRequest(if_index);
+  okay = okay && nc.ReadResponses(__getifaddrs_callback, &builder) && builder.IndexLinks();
+
+  // Then the addresses, leaving the kernel to filter them by family. Any for other interfaces
+  // are dropped by the callback, since it doesn't know their links.
+  if (okay && family != AF_PACKET) {
+    okay = nc.SendRequest(RTM_GETADDR, family) &&
+           nc.ReadResponses(__getifaddrs_callback, &builder);
+  }
+  free(builder.link_table);
+  if (!okay || builder.failed) {
+    if (builder.failed) errno = ENOMEM;
+    free(builder.entries);
     return -1;
   }
 
+  // Drop the links if the caller only wants addresses.
+  if (family == AF_INET || family == AF_INET6) {
+    uintptr_t old_addresses = reinterpret_cast<uintptr_t>(&builder.entries[builder.link_count]);
+    builder.count -= builder.link_count;
+    memmove(builder.entries, &builder.entries[builder.link_count],
+            builder.count * sizeof(ifaddrs_storage));
+    builder.Moved(old_addresses, builder.entries);
+  }
+
+  if (builder.count == 0) {
+    free(builder.entries);
+    return 0;
+  }
+  for (size_t i = 0; i + 1 < builder.count; ++i) {
+    builder.entries[i].ifa.ifa_next = &builder.entries[i + 1].ifa;
+  }
+  *out = &builder.entries[0].ifa;
   return 0;
 }
 
+int getifaddrs(ifaddrs** out) {
+  return android_getifaddrs_filtered(out, AF_UNSPEC, 0);
+}
+
 void freeifaddrs(ifaddrs* list) {
-  while (list != nullptr) {
-    ifaddrs* current = list;
-    list = list->ifa_next;
-    free(current);
-  }
+  // The whole list is one allocation, starting with its first entry.
+  free(list);
 }
@@ -0,0 +1,202 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <sys/io_uring.h>
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "private/ErrnoRestorer.h"
+#include "private/kernel_sigset_t.h"
+
+extern "C" int __io_uring_enter(unsigned int, unsigned int, unsigned int, unsigned int,
+                                const kernel_sigset_t*, size_t);
+
+int io_uring_enter(int fd, unsigned int to_submit, unsigned int min_complete, unsigned int flags,
+                   const sigset_t* ss) {
+  kernel_sigset_t kernel_ss;
+  kernel_sigset_t* kernel_ss_ptr = NULL;
+  if (ss != NULL) {
+    kernel_ss.set(ss);
+    kernel_ss_ptr = &kernel_ss;
+  }
+  return __io_uring_enter(fd, to_submit, min_complete, flags, kernel_ss_ptr, sizeof(kernel_ss));
+}
+
+struct android_io_uring {
+  int fd;
+  unsigned int flags;
+
+  // The submission queue ring, and the array of entries it indexes into. We hand out entries
+  // [sqe_head, sqe_tail) with android_io_uring_get_sqe, and add them to the ring on submission.
+  void* sq_ring;
+  size_t sq_ring_size;
+  unsigned int* sq_head;
+  unsigned int* sq_tail;
+  unsigned int* sq_flags;
+  unsigned int* sq_array;
+  unsigned int sq_mask;
+  unsigned int sq_entries;
+  io_uring_sqe* sqes;
+  size_t sqes_size;
+  unsigned int sqe_head;
+  unsigned int sqe_tail;
+
+  // The completion queue ring, which holds the completions themselves.
+  void* cq_ring;
+  size_t cq_ring_size;
+  unsigned int* cq_head;
+  unsigned int* cq_tail;
+  unsigned int cq_mask;
+  io_uring_cqe* cqes;
+};
+
+template <typename T>
+static T* RingField(void* ring, unsigned int offset) {
+  return reinterpret_cast<T*>(reinterpret_cast<char*>(ring) + offset);
+}
+
+void android_io_uring_destroy(android_io_uring* ring) {
+  ErrnoRestorer errno_restorer;
+  if (ring->cq_ring != MAP_FAILED) munmap(ring->cq_ring, ring->cq_ring_size);
+  if (ring->sqes != MAP_FAILED) munmap(ring->sqes, ring->sqes_size);
+  if (ring->sq_ring != MAP_FAILED) munmap(ring->sq_ring, ring->sq_ring_size);
+  close(ring->fd);
+  free(ring);
+}
+
+android_io_uring* android_io_uring_create(unsigned int entries, unsigned int flags) {
+  io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  params.flags = flags;
+  int fd = io_uring_setup(entries, &params);
+  if (fd == -1) return nullptr;
+
+  android_io_uring* ring = reinterpret_cast<android_io_uring*>(calloc(1, sizeof(*ring)));
+  if (ring == nullptr) {
+    ErrnoRestorer errno_restorer;
+    close(fd);
+    return nullptr;
+  }
+  ring->fd = fd;
+  ring->flags = flags;
+
+  ring->sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned int);
+  ring->sq_ring = mmap(nullptr, ring->sq_ring_size, PROT_READ | PROT_WRITE,
+                       MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+  ring->sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+  ring->sqes = reinterpret_cast<io_uring_sqe*>(
+      mmap(nullptr, ring->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd,
+           IORING_OFF_SQES));
+  ring->cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+  ring->cq_ring = mmap(nullptr, ring->cq_ring_size, PROT_READ | PROT_WRITE,
+                       MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+  if (ring->sq_ring == MAP_FAILED || ring->sqes == MAP_FAILED || ring->cq_ring == MAP_FAILED) {
+    android_io_uring_destroy(ring);
+    return nullptr;
+  }
+
+  ring->sq_head = RingField<unsigned int>(ring->sq_ring, params.sq_off.head);
+  ring->sq_tail = RingField<unsigned int>(ring->sq_ring, params.sq_off.tail);
+  ring->sq_flags = RingField<unsigned int>(ring->sq_ring, params.sq_off.flags);
+  ring->sq_array = RingField<unsigned int>(ring->sq_ring, params.sq_off.array);
+  ring->sq_mask = *RingField<unsigned int>(ring->sq_ring, params.sq_off.ring_mask);
+  ring->sq_entries = params.sq_entries;
+
+  ring->cq_head = RingField<unsigned int>(ring->cq_ring, params.cq_off.head);
+  ring->cq_tail = RingField<unsigned int>(ring->cq_ring, params.cq_off.tail);
+  ring->cq_mask = *RingField<unsigned int>(ring->cq_ring, params.cq_off.ring_mask);
+  ring->cqes = RingField<io_uring_cqe>(ring->cq_ring, params.cq_off.cqes);
+  return ring;
+}
+
+int android_io_uring_fd(android_io_uring* ring) {
+  return ring->fd;
+}
+
+io_uring_sqe* android_io_uring_get_sqe(android_io_uring* ring) {
+  // Entries are free once the kernel has consumed them from the ring.
+  unsigned int head = __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE);
+  if (ring->sqe_tail - head >= ring->sq_entries) return nullptr;
+  io_uring_sqe* sqe = &ring->sqes[ring->sqe_tail++ & ring->sq_mask];
+  memset(sqe, 0, sizeof(*sqe));
+  return sqe;
+}
+
+int android_io_uring_submit(android_io_uring* ring, unsigned int wait_nr) {
+  // Only we write the tail, so it needn't be an atomic load.
+  unsigned int tail = *ring->sq_tail;
+  while (ring->sqe_head != ring->sqe_tail) {
+    ring->sq_array[tail++ & ring->sq_mask] = ring->sqe_head++ & ring->sq_mask;
+  }
+  __atomic_store_n(ring->sq_tail, tail, __ATOMIC_RELEASE);
+
+  // Count anything an earlier failed submission left in the ring, too.
+  unsigned int to_submit = tail - __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE);
+  unsigned int flags = (wait_nr > 0) ? IORING_ENTER_GETEVENTS : 0;
+  if (ring->flags & IORING_SETUP_SQPOLL) {
+    // The kernel's polling thread picks up new entries by itself, unless it's gone to sleep.
+    // The fence orders our tail store before our check of whether it needs waking.
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(ring->sq_flags, __ATOMIC_RELAXED) & IORING_SQ_NEED_WAKEUP) {
+      flags |= IORING_ENTER_SQ_WAKEUP;
+    } else if (wait_nr == 0) {
+      return to_submit;
+    }
+  } else if (to_submit == 0 && wait_nr == 0) {
+    return 0;
+  }
+
+  int result = io_uring_enter(ring->fd, to_submit, wait_nr, flags, nullptr);
+  if (result == -1) return -1;
+  return (ring->flags & IORING_SETUP_SQPOLL) ? to_submit : result;
+}
+
+io_uring_cqe* android_io_uring_peek_cqe(android_io_uring* ring) {
+  // Only we write the head, so it needn't be an atomic load.
+  unsigned int head = *ring->cq_head;
+  if (head == __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE)) return nullptr;
+  return &ring->cqes[head & ring->cq_mask];
+}
+
+io_uring_cqe* android_io_uring_wait_cqe(android_io_uring* ring) {
+  io_uring_cqe* cqe;
+  while ((cqe = android_io_uring_peek_cqe(ring)) == nullptr) {
+    if (io_uring_enter(ring->fd, 0, 1, IORING_ENTER_GETEVENTS, nullptr) == -1 && errno != EINTR) {
+      return nullptr;
+    }
+  }
+  return cqe;
+}
+
+void android_io_uring_cqe_seen(android_io_uring* ring, io_uring_cqe*) {
+  __atomic_store_n(ring->cq_head, *ring->cq_head + 1, __ATOMIC_RELEASE);
+}
@@ -32,6 +32,13 @@ void je_malloc_enable();
 int je_mallctl(const char *name, void *oldp, size_t *oldlenp, void *newp, size_t newlen);
 void* je_memalign_round_up_boundary(size_t, size_t);
 void* je_pvalloc(size_t);
+int je_heap_create();
+void* je_heap_malloc(int, size_t);
+void je_heap_free(int, void*);
+int je_heap_destroy(int);
+void je_free_sized(void*, size_t);
+int je_mallopt(int, int);
+int je_malloc_trim(size_t);
 
 __END_DECLS
 
@@ -14,11 +14,16 @@
  * limitations under the License.
  */
 
+#include <errno.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
 #include <sys/param.h>
 #include <unistd.h>
 
 #include "jemalloc.h"
 #include "private/bionic_macros.h"
+#include "private/ScopedPthreadMutexLocker.h"
 
 void* je_pvalloc(size_t bytes) {
   size_t pagesize = getpagesize();
@@ -46,3 +51,157 @@ void* je_memalign_round_up_boundary(size_t boundary, size_t size) {
   }
   return je_memalign(boundary, size);
 }
+
+// Passing the size lets jemalloc compute the size class instead of looking
+// the pointer up in its chunk radix tree. malloc(0) gives out a one byte
+// allocation, so a size of 0 has to be freed as 1.
+void je_free_sized(void* ptr, size_t size) {
+  if (ptr != nullptr) {
+    je_sdallocx(ptr, size == 0 ? 1 : size, 0);
+  }
+}
+
+// Heaps are jemalloc arenas created with arenas.extend. jemalloc can't
+// delete an arena, so destroying a heap resets its arena, discarding all of
+// its allocations, and keeps it for the next heap_create.
+static constexpr size_t kMaxHeapArena = 1024;
+
+static pthread_mutex_t g_heap_lock = PTHREAD_MUTEX_INITIALIZER;
+static uint32_t g_heap_live[kMaxHeapArena / 32];
+static unsigned g_heap_unused[kMaxHeapArena];
+static size_t g_heap_unused_count;
+
+static bool heap_is_live(int heap) {
+  return heap >= 0 && static_cast<size_t>(heap) < kMaxHeapArena &&
+      (g_heap_live[heap / 32] & (1U << (heap % 32))) != 0;
+}
+
+int je_heap_create() {
+  ScopedPthreadMutexLocker locker(&g_heap_lock);
+
+  unsigned arena;
+  if (g_heap_unused_count > 0) {
+    arena = g_heap_unused[--g_heap_unused_count];
+  } else {
+    size_t arena_size = sizeof(arena);
+    if (je_mallctl("arenas.extend", &arena, &arena_size, nullptr, 0) != 0) {
+      errno = ENOMEM;
+      return -1;
+    }
+    if (arena >= kMaxHeapArena) {
+      // This arena is lost, but so would every further one be.
+      errno = ENOMEM;
+      return -1;
+    }
+  }
+  g_heap_live[arena / 32] |= 1U << (arena % 32);
+  return arena;
+}
+
+// Heap allocations bypass the thread caches: a cached object can't be
+// discarded by arena.<i>.reset, and it would keep the memory of a heap
+// alive on every thread that ever used it.
+void* je_heap_malloc(int heap, size_t size) {
+  // Racing with heap_destroy is a caller bug, so there is no lock here.
+  if (!heap_is_live(heap)) {
+    errno = EINVAL;
+    return nullptr;
+  }
+  void* result = je_mallocx(size == 0 ? 1 : size, MALLOCX_ARENA(heap) | MALLOCX_TCACHE_NONE);
+  if (result == nullptr) {
+    errno = ENOMEM;
+  }
+  return result;
+}
+
+void je_heap_free(int, void* ptr) {
+  if (ptr != nullptr) {
+    je_dallocx(ptr, MALLOCX_TCACHE_NONE);
+  }
+}
+
+int je_heap_destroy(int heap) {
+  ScopedPthreadMutexLocker locker(&g_heap_lock);
+
+  if (!heap_is_live(heap)) {
+    errno = EINVAL;
+    return -1;
+  }
+  char name[32];
+  snprintf(name, sizeof(name), "arena.%d.reset", heap);
+  if (je_mallctl(name, nullptr, nullptr, nullptr, 0) != 0) {
+    errno = EINVAL;
+    return -1;
+  }
+  g_heap_live[heap / 32] &= ~(1U << (heap % 32));
+  g_heap_unused[g_heap_unused_count++] = heap;
+  return 0;
+}
+
+// arena.<i> and stats.arenas.<i> with i == arenas.narenas stand for all of
+// the arenas at once.
+static unsigned all_arenas() {
+  unsigned narenas = 0;
+  size_t size = sizeof(narenas);
+  je_mallctl("arenas.narenas", &narenas, &size, nullptr, 0);
+  return narenas;
+}
+
+// Returns the number of unused dirty pages, or SIZE_MAX if jemalloc wasn't
+// built with statistics.
+static size_t dirty_pages() {
+  uint64_t epoch = 1;
+  je_mallctl("epoch", nullptr, nullptr, &epoch, sizeof(epoch));
+  char name[64];
+  snprintf(name, sizeof(name), "stats.arenas.%u.pdirty", all_arenas());
+  size_t pdirty;
+  size_t size = sizeof(pdirty);
+  if (je_mallctl(name, &pdirty, &size, nullptr, 0) != 0) {
+    return SIZE_MAX;
+  }
+  return pdirty;
+}
+
+static bool purge_all_arenas() {
+  char name[32];
+  snprintf(name, sizeof(name), "arena.%u.purge", all_arenas());
+  return je_mallctl(name, nullptr, nullptr, nullptr, 0) == 0;
+}
+
+static bool set_decay_time(ssize_t decay_time) {
+  // arenas.decay_time only applies to the arenas created from now on.
+  if (je_mallctl("arenas.decay_time", nullptr, nullptr, &decay_time, sizeof(decay_time)) != 0) {
+    return false;
+  }
+  unsigned narenas = all_arenas();
+  for (unsigned i = 0; i < narenas; ++i) {
+    char name[32];
+    snprintf(name, sizeof(name), "arena.%u.decay_time", i);
+    // This fails for the arenas that haven't been initialized yet, which
+    // will start with the new default.
+    je_mallctl(name, nullptr, nullptr, &decay_time, sizeof(decay_time));
+  }
+  return true;
+}
+
+int je_mallopt(int option, int value) {
+  switch (option) {
+    case M_DECAY_TIME:
+      return set_decay_time(value);
+    case M_PURGE:
+      return purge_all_arenas();
+    case M_FLUSH_THREAD_CACHE:
+      return je_mallctl("thread.tcache.flush", nullptr, nullptr, nullptr, 0) == 0;
+  }
+  return 0;
+}
+
+int je_malloc_trim(size_t) {
+  // This fails if thread caches are disabled, which leaves nothing to flush.
+  je_mallctl("thread.tcache.flush", nullptr, nullptr, nullptr, 0);
+  size_t pdirty = dirty_pages();
+  if (!purge_all_arenas()) {
+    return 0;
+  }
+  return pdirty != 0;
+}
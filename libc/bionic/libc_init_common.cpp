@@ -45,6 +45,8 @@
 #include "private/WriteProtected.h"
 #include "private/bionic_auxv.h"
 #include "private/bionic_globals.h"
+#include "private/bionic_sections.h"
+#include "private/bionic_startup_trace.h"
 #include "private/bionic_tls.h"
 #include "private/libc_logging.h"
 #include "private/thread_private.h"
@@ -52,17 +54,18 @@
 
 extern "C" abort_msg_t** __abort_message_ptr;
 extern "C" int __system_properties_init(void);
+extern "C" void __libc_init_stdio_bufsize();
 
 __LIBC_HIDDEN__ WriteProtected<libc_globals> __libc_globals;
 
 // Not public, but well-known in the BSDs.
-const char* __progname;
+const char* __progname __BIONIC_READ_MOSTLY;
 
 // Declared in <unistd.h>.
-char** environ;
+char** environ __BIONIC_READ_MOSTLY;
 
 #if defined(__i386__)
-__LIBC_HIDDEN__ void* __libc_sysinfo = nullptr;
+__LIBC_HIDDEN__ void* __libc_sysinfo __BIONIC_READ_MOSTLY = nullptr;
 
 __LIBC_HIDDEN__ void __libc_init_sysinfo(KernelArgumentBlock& args) {
   __libc_sysinfo = reinterpret_cast<void*>(args.getauxval(AT_SYSINFO));
@@ -98,12 +101,9 @@ static void __check_max_thread_id() {
 }
 #endif
 
-static void arc4random_fork_handler() {
-  _rs_forked = 1;
-  _thread_arc4_lock();
-}
-
 void __libc_init_common(KernelArgumentBlock& args) {
+  __libc_startup_trace_begin(kStartupPhaseCommon);
+
   // Initialize various globals.
   environ = args.envp;
   errno = 0;
@@ -118,10 +118,20 @@ void __libc_init_common(KernelArgumentBlock& args) {
   pthread_internal_t* main_thread = __get_thread();
   __pthread_internal_add(main_thread);
 
-  // Register atfork handlers to take and release the arc4random lock.
-  pthread_atfork(arc4random_fork_handler, _thread_arc4_unlock, _thread_arc4_unlock);
+  // Register atfork handlers to take and release the arc4random lock, and to have the child
+  // reseed every arc4random state it inherited.
+  pthread_atfork(_thread_arc4_lock, _thread_arc4_unlock, __arc4random_fork_child);
+
+  __pthread_mutex_init_adaptive_default(); // Requires 'environ'.
+  __pthread_mutex_init_numa_wake(); // Requires 'environ'.
+  __pthread_internal_init_stack_cache(); // Requires 'environ'.
+  __pthread_internal_init_stack_profile(); // Requires 'environ'.
+  __libc_init_stdio_bufsize(); // Requires 'environ'.
+  __libc_startup_trace_end(kStartupPhaseCommon);
 
+  __libc_startup_trace_begin(kStartupPhaseProperties);
   __system_properties_init(); // Requires 'environ'.
+  __libc_startup_trace_end(kStartupPhaseProperties);
 }
 
 __noreturn static void __early_abort(int line) {
@@ -247,15 +257,21 @@ static bool __is_unsafe_environment_variable(const char* name) {
     "LD_AOUT_LIBRARY_PATH",
     "LD_AOUT_PRELOAD",
     "LD_AUDIT",
+    "LD_BOOT_IMAGE",
     "LD_DEBUG",
     "LD_DEBUG_OUTPUT",
     "LD_DYNAMIC_WEAK",
     "LD_LIBRARY_PATH",
     "LD_ORIGIN_PATH",
+    "LD_PARALLEL_LOAD",
     "LD_PRELOAD",
     "LD_PROFILE",
+    "LD_READAHEAD",
+    "LD_RELRO_STORE",
     "LD_SHOW_AUXV",
+    "LD_SYMBOL_CACHE",
     "LD_USE_LOAD_BIAS",
+    "LIBC_STARTUP_TRACE",
     "LOCALDOMAIN",
     "LOCPATH",
     "MALLOC_CHECK_",
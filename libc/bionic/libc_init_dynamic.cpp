@@ -53,6 +53,7 @@
 
 #include "private/bionic_globals.h"
 #include "private/bionic_ssp.h"
+#include "private/bionic_startup_trace.h"
 #include "private/bionic_tls.h"
 #include "private/KernelArgumentBlock.h"
 
@@ -79,12 +80,23 @@ __attribute__((constructor)) static void __libc_preinit() {
   // thread's TLS slot with that value. Initialize the local global stack guard with its value.
   __stack_chk_guard = reinterpret_cast<uintptr_t>(tls[TLS_SLOT_STACK_GUARD]);
 
+  __libc_startup_trace_init(args->envp);
+
+  __libc_startup_trace_begin(kStartupPhaseGlobals);
   __libc_init_globals(*args);
+  __libc_startup_trace_end(kStartupPhaseGlobals);
   __libc_init_common(*args);
 
   // Hooks for various libraries to let them know that we're starting up.
+  __libc_startup_trace_begin(kStartupPhaseMalloc);
   __libc_globals.mutate(__libc_init_malloc);
+  __libc_startup_trace_end(kStartupPhaseMalloc);
+  __libc_startup_trace_begin(kStartupPhaseNetd);
   netdClientInit();
+  __libc_startup_trace_end(kStartupPhaseNetd);
+
+  // Until __libc_init(), which is called once every constructor has run.
+  __libc_startup_trace_begin(kStartupPhaseConstructors);
 }
 
 // This function is called from the executable's _start entry point
@@ -99,6 +111,8 @@ __noreturn void __libc_init(void* raw_args,
                             int (*slingshot)(int, char**, char**),
                             structors_array_t const * const structors) {
 
+  __libc_startup_trace_end(kStartupPhaseConstructors);
+
   KernelArgumentBlock args(raw_args);
 
   // Several Linux ABIs don't pass the onexit pointer, and the ones that
@@ -111,6 +125,7 @@ __noreturn void __libc_init(void* raw_args,
     __cxa_atexit(__libc_fini,structors->fini_array,NULL);
   }
 
+  __libc_startup_trace_report();
   exit(slingshot(args.argc, args.argv, args.envp));
 }
 
@@ -29,6 +29,9 @@
 #include <android/api-level.h>
 #include <elf.h>
 #include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
@@ -41,6 +44,7 @@
 
 #include "private/bionic_globals.h"
 #include "private/bionic_page.h"
+#include "private/bionic_startup_trace.h"
 #include "private/bionic_tls.h"
 #include "private/KernelArgumentBlock.h"
 
@@ -70,6 +74,98 @@ static void apply_gnu_relro() {
   }
 }
 
+#if defined(__LP64__)
+#define IRELATIVE_RELOC_TYPE ElfW(Rela)
+extern "C" IRELATIVE_RELOC_TYPE __rela_iplt_start[] __attribute__((weak, visibility("hidden")));
+extern "C" IRELATIVE_RELOC_TYPE __rela_iplt_end[] __attribute__((weak, visibility("hidden")));
+#define IRELATIVE_START __rela_iplt_start
+#define IRELATIVE_END __rela_iplt_end
+#else
+#define IRELATIVE_RELOC_TYPE ElfW(Rel)
+extern "C" IRELATIVE_RELOC_TYPE __rel_iplt_start[] __attribute__((weak, visibility("hidden")));
+extern "C" IRELATIVE_RELOC_TYPE __rel_iplt_end[] __attribute__((weak, visibility("hidden")));
+#define IRELATIVE_START __rel_iplt_start
+#define IRELATIVE_END __rel_iplt_end
+#endif
+
+// There's no dynamic linker to apply the R_*_IRELATIVE relocations of a
+// static executable, so the static linker collects them between these
+// symbols for us to apply before anything can call through them.
+static void call_ifunc_resolvers() {
+#if !defined(__mips__)
+  for (IRELATIVE_RELOC_TYPE* r = IRELATIVE_START; r != IRELATIVE_END; ++r) {
+    ElfW(Addr)* offset = reinterpret_cast<ElfW(Addr)*>(r->r_offset);
+#if defined(__LP64__)
+    ElfW(Addr) resolver = r->r_addend;
+#else
+    ElfW(Addr) resolver = *offset;
+#endif
+#if defined(__arm__) || defined(__aarch64__)
+    typedef ElfW(Addr) (*ifunc_resolver_t)(unsigned long);
+    *offset = reinterpret_cast<ifunc_resolver_t>(resolver)(getauxval(AT_HWCAP));
+#else
+    typedef ElfW(Addr) (*ifunc_resolver_t)(void);
+    *offset = reinterpret_cast<ifunc_resolver_t>(resolver)();
+#endif
+  }
+#endif
+}
+
+// The functions declared with ANDROID_PARALLEL_CONSTRUCTOR. If the executable has none, the
+// section doesn't exist, the static linker doesn't define these, and both are null.
+extern "C" void (* const __start_android_parallel_init[])() __attribute__((weak, visibility("hidden")));
+extern "C" void (* const __stop_android_parallel_init[])() __attribute__((weak, visibility("hidden")));
+
+// More threads than this just fight over the same few cache lines while each constructor touches
+// its own data.
+static constexpr size_t kMaxParallelConstructorThreads = 8;
+
+struct parallel_constructors {
+  void (* const* list)();
+  size_t count;
+  atomic_size_t next;
+};
+
+static void* parallel_constructor_thread(void* arg) {
+  parallel_constructors* ctors = reinterpret_cast<parallel_constructors*>(arg);
+  size_t i;
+  while ((i = atomic_fetch_add_explicit(&ctors->next, 1, memory_order_relaxed)) < ctors->count) {
+    ctors->list[i]();
+  }
+  return nullptr;
+}
+
+// Threads of our own rather than the work pool's, so that a program that starts out
+// single-threaded (one that calls unshare(CLONE_NEWUSER), say) still is by the time main() runs.
+static void call_parallel_constructors() {
+  parallel_constructors ctors;
+  ctors.list = __start_android_parallel_init;
+  ctors.count = __stop_android_parallel_init - __start_android_parallel_init;
+  atomic_init(&ctors.next, 0);
+  if (ctors.count == 0) return;
+
+  size_t cpu_count = 1;
+  cpu_set_t allowed;
+  if (sched_getaffinity(0, sizeof(allowed), &allowed) == 0) {
+    cpu_count = CPU_COUNT(&allowed);
+  }
+  size_t thread_count = ctors.count;
+  if (thread_count > cpu_count) thread_count = cpu_count;
+  if (thread_count > kMaxParallelConstructorThreads) thread_count = kMaxParallelConstructorThreads;
+
+  // This thread is one of them. If we can't start the others, it runs everything itself.
+  pthread_t threads[kMaxParallelConstructorThreads - 1];
+  size_t started = 0;
+  while (started < thread_count - 1 &&
+         pthread_create(&threads[started], nullptr, parallel_constructor_thread, &ctors) == 0) {
+    ++started;
+  }
+  parallel_constructor_thread(&ctors);
+  for (size_t i = 0; i < started; ++i) {
+    pthread_join(threads[i], nullptr);
+  }
+}
+
 // The program startup function __libc_init() defined here is
 // used for static executables only (i.e. those that don't depend
 // on shared libraries). It is called from arch-$ARCH/bionic/crtbegin_static.S
@@ -90,15 +186,26 @@ __noreturn void __libc_init(void* raw_args,
   __libc_init_globals(args);
 
   __libc_init_AT_SECURE(args);
+  // Only now is the environment safe to read.
+  __libc_startup_trace_init(args.envp);
   __libc_init_common(args);
 
+  __libc_startup_trace_begin(kStartupPhaseRelocation);
+  call_ifunc_resolvers();
   apply_gnu_relro();
+  __libc_startup_trace_end(kStartupPhaseRelocation);
 
   // Several Linux ABIs don't pass the onexit pointer, and the ones that
   // do never use it.  Therefore, we ignore it.
 
+  __libc_startup_trace_begin(kStartupPhaseConstructors);
   call_array(structors->preinit_array);
   call_array(structors->init_array);
+  __libc_startup_trace_end(kStartupPhaseConstructors);
+
+  __libc_startup_trace_begin(kStartupPhaseParallelConstructors);
+  call_parallel_constructors();
+  __libc_startup_trace_end(kStartupPhaseParallelConstructors);
 
   // The executable may have its own destructors listed in its .fini_array
   // so we need to ensure that these are called when the program exits
@@ -107,6 +214,7 @@ __noreturn void __libc_init(void* raw_args,
     __cxa_atexit(__libc_fini,structors->fini_array,NULL);
   }
 
+  __libc_startup_trace_report();
   exit(slingshot(args.argc, args.argv, args.envp));
 }
 
@@ -36,6 +36,7 @@
 #include <fcntl.h>
 #include <pthread.h>
 #include <stdarg.h>
+#include <stdatomic.h>
 #include <stddef.h>
 #include <stdlib.h>
 #include <string.h>
@@ -105,9 +106,15 @@ struct BufferOutputStream {
   char* end_;
 };
 
+// Collects output in a buffer on the stack, so that formatting a line takes one write rather
+// than one for every piece of it.
 struct FdOutputStream {
  public:
-  explicit FdOutputStream(int fd) : total(0), fd_(fd) {
+  explicit FdOutputStream(int fd) : total(0), fd_(fd), used_(0) {
+  }
+
+  ~FdOutputStream() {
+    Flush();
   }
 
   void Send(const char* data, int len) {
@@ -117,8 +124,28 @@ struct FdOutputStream {
 
     total += len;
 
+    if (static_cast<size_t>(len) > sizeof(buffer_) - used_) {
+      Flush();
+      if (static_cast<size_t>(len) > sizeof(buffer_)) {
+        Write(data, len);
+        return;
+      }
+    }
+    memcpy(buffer_ + used_, data, len);
+    used_ += len;
+  }
+
+  void Flush() {
+    Write(buffer_, used_);
+    used_ = 0;
+  }
+
+  size_t total;
+
+ private:
+  void Write(const char* data, size_t len) {
     while (len > 0) {
-      int rc = TEMP_FAILURE_RETRY(write(fd_, data, len));
+      ssize_t rc = TEMP_FAILURE_RETRY(write(fd_, data, len));
       if (rc == -1) {
         return;
       }
@@ -127,10 +154,9 @@ struct FdOutputStream {
     }
   }
 
-  size_t total;
-
- private:
   int fd_;
+  size_t used_;
+  char buffer_[512];
 };
 
 /*** formatted output implementation
@@ -161,42 +187,53 @@ static unsigned parse_decimal(const char *format, int *ppos) {
     return result;
 }
 
-// Writes number 'value' in base 'base' into buffer 'buf' of size 'buf_size' bytes.
-// Assumes that buf_size > 0.
+static const char kDigitPairs[] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+// Writes number 'value' in base 'base' (8, 10 or 16) into buffer 'buf' of size 'buf_size' bytes.
+// Assumes that buf_size > 0. If there isn't room for all the digits, the lowest ones are kept.
 static void format_unsigned(char* buf, size_t buf_size, uint64_t value, int base, bool caps) {
-  char* p = buf;
-  char* end = buf + buf_size - 1;
-
-  // Generate digit string in reverse order.
-  while (value) {
-    unsigned d = value % base;
-    value /= base;
-    if (p != end) {
-      char ch;
-      if (d < 10) {
-        ch = '0' + d;
-      } else {
-        ch = (caps ? 'A' : 'a') + (d - 10);
-      }
-      *p++ = ch;
+  // Generate the digits backwards, two at a time for decimal, and with shifts otherwise.
+  char digits[24];
+  char* p = digits + sizeof(digits);
+  if (base == 10) {
+    while (value >= 100) {
+      unsigned d = value % 100;
+      value /= 100;
+      p -= 2;
+      memcpy(p, &kDigitPairs[2 * d], 2);
     }
-  }
-
-  // Special case for 0.
-  if (p == buf) {
-    if (p != end) {
-      *p++ = '0';
+    if (value >= 10) {
+      p -= 2;
+      memcpy(p, &kDigitPairs[2 * value], 2);
+    } else {
+      *--p = '0' + value;
     }
+  } else {
+    const char* hex_digits = caps ? "0123456789ABCDEF" : "0123456789abcdef";
+    int shift = (base == 16) ? 4 : 3;
+    do {
+      *--p = hex_digits[value & (base - 1)];
+      value >>= shift;
+    } while (value);
   }
-  *p = '\0';
-
-  // Reverse digit string in-place.
-  size_t length = p - buf;
-  for (size_t i = 0, j = length - 1; i < j; ++i, --j) {
-    char ch = buf[i];
-    buf[i] = buf[j];
-    buf[j] = ch;
+
+  size_t length = digits + sizeof(digits) - p;
+  if (length > buf_size - 1) {
+    p += length - (buf_size - 1);
+    length = buf_size - 1;
   }
+  memcpy(buf, p, length);
+  buf[length] = '\0';
 }
 
 static void format_integer(char* buf, size_t buf_size, uint64_t value, char conversion) {
@@ -480,6 +517,45 @@ static int __libc_open_log_socket() {
   return log_fd;
 }
 
+// The socket to logd is opened the first time it's needed and then kept, rather than opened
+// for every message. Being non-blocking, a message that logd has no room for is dropped.
+static _Atomic(int) g_log_fd = ATOMIC_VAR_INIT(-1);
+
+static int __libc_get_log_socket() {
+  int log_fd = atomic_load_explicit(&g_log_fd, memory_order_acquire);
+  if (log_fd != -1) {
+    return log_fd;
+  }
+  log_fd = __libc_open_log_socket();
+  if (log_fd == -1) {
+    return -1;
+  }
+  int expected = -1;
+  if (!atomic_compare_exchange_strong(&g_log_fd, &expected, log_fd)) {
+    // Another thread got there first.
+    close(log_fd);
+    return expected;
+  }
+  return log_fd;
+}
+
+// Swaps a fresh connection in for a socket that's stopped working (because logd restarted, say),
+// returning false if there isn't one. dup3 swaps it in under the same fd, so that other threads
+// writing to it at the same time never see the fd closed, let alone reused for something else.
+static bool __libc_reconnect_log_socket(int log_fd) {
+  int new_fd = __libc_open_log_socket();
+  if (new_fd == -1) {
+    return false;
+  }
+  if (new_fd == log_fd) {
+    // Someone had closed our socket, and the new one has taken its place.
+    return true;
+  }
+  bool result = (dup3(new_fd, log_fd, O_CLOEXEC) != -1);
+  close(new_fd);
+  return result;
+}
+
 struct cache {
   const prop_info* pinfo;
   uint32_t serial;
@@ -509,33 +585,36 @@ static void refresh_cache(struct cache *cache, const char *key)
 // rare, we can accept a trylock failure gracefully.
 static pthread_mutex_t lock_clockid = PTHREAD_MUTEX_INITIALIZER;
 
+// The property area serial the clock was last worked out for in the top 32 bits, and whether it
+// was CLOCK_MONOTONIC in bit 0, so that the usual case where no property has changed since is
+// a single load and compare without the lock.
+#define CLOCKID_STATE_MONOTONIC 1
+static _Atomic(uint64_t) g_clockid_state = ATOMIC_VAR_INIT(0);
+
 static clockid_t __android_log_clockid()
 {
   static struct cache r_time_cache = { NULL, static_cast<uint32_t>(-1), 0 };
   static struct cache p_time_cache = { NULL, static_cast<uint32_t>(-1), 0 };
-  char c;
 
-  if (pthread_mutex_trylock(&lock_clockid)) {
-    // We are willing to accept some race in this context
-    if (!(c = p_time_cache.c)) {
-      c = r_time_cache.c;
-    }
-  } else {
-    static uint32_t serial;
-    uint32_t current_serial = __system_property_area_serial();
-    if (current_serial != serial) {
-      refresh_cache(&r_time_cache, "ro.logd.timestamp");
-      refresh_cache(&p_time_cache, "persist.logd.timestamp");
-      serial = current_serial;
-    }
-    if (!(c = p_time_cache.c)) {
+  uint32_t current_serial = __system_property_area_serial();
+  uint64_t state = atomic_load_explicit(&g_clockid_state, memory_order_acquire);
+  // We are willing to accept some race in this context, and use what we last worked out
+  // if another thread is already updating it.
+  if ((state >> 32) != current_serial && pthread_mutex_trylock(&lock_clockid) == 0) {
+    refresh_cache(&r_time_cache, "ro.logd.timestamp");
+    refresh_cache(&p_time_cache, "persist.logd.timestamp");
+    char c = p_time_cache.c;
+    if (!c) {
       c = r_time_cache.c;
     }
+    state = (static_cast<uint64_t>(current_serial) << 32) |
+        ((tolower(c) == 'm') ? CLOCKID_STATE_MONOTONIC : 0);
+    atomic_store_explicit(&g_clockid_state, state, memory_order_release);
 
     pthread_mutex_unlock(&lock_clockid);
   }
 
-  return (tolower(c) == 'm') ? CLOCK_MONOTONIC : CLOCK_REALTIME;
+  return (state & CLOCKID_STATE_MONOTONIC) ? CLOCK_MONOTONIC : CLOCK_REALTIME;
 }
 
 struct log_time { // Wire format
@@ -543,8 +622,19 @@ struct log_time { // Wire format
   uint32_t tv_nsec;
 };
 
+void __libc_log_timestamp(timespec* ts) {
+  clock_gettime(__android_log_clockid(), ts);
+}
+
 int __libc_write_log(int priority, const char* tag, const char* msg) {
-  int main_log_fd = __libc_open_log_socket();
+  timespec ts;
+  __libc_log_timestamp(&ts);
+  return __libc_write_log_stamped(priority, tag, msg, gettid(), &ts);
+}
+
+int __libc_write_log_stamped(int priority, const char* tag, const char* msg, pid_t tid,
+                             const timespec* ts) {
+  int main_log_fd = __libc_get_log_socket();
   if (main_log_fd == -1) {
     // Try stderr instead.
     return __libc_write_stderr(tag, msg);
@@ -554,14 +644,12 @@ int __libc_write_log(int priority, const char* tag, const char* msg) {
   char log_id = (priority == ANDROID_LOG_FATAL) ? LOG_ID_CRASH : LOG_ID_MAIN;
   vec[0].iov_base = &log_id;
   vec[0].iov_len = sizeof(log_id);
-  uint16_t tid = gettid();
-  vec[1].iov_base = &tid;
-  vec[1].iov_len = sizeof(tid);
-  timespec ts;
-  clock_gettime(__android_log_clockid(), &ts);
+  uint16_t log_tid = tid;
+  vec[1].iov_base = &log_tid;
+  vec[1].iov_len = sizeof(log_tid);
   log_time realtime_ts;
-  realtime_ts.tv_sec = ts.tv_sec;
-  realtime_ts.tv_nsec = ts.tv_nsec;
+  realtime_ts.tv_sec = ts->tv_sec;
+  realtime_ts.tv_nsec = ts->tv_nsec;
   vec[2].iov_base = &realtime_ts;
   vec[2].iov_len = sizeof(realtime_ts);
 
@@ -573,7 +661,13 @@ int __libc_write_log(int priority, const char* tag, const char* msg) {
   vec[5].iov_len = strlen(msg) + 1;
 
   int result = TEMP_FAILURE_RETRY(writev(main_log_fd, vec, sizeof(vec) / sizeof(vec[0])));
-  close(main_log_fd);
+  if (result == -1 && errno != EAGAIN) {
+    // logd may have restarted, or gone away altogether.
+    if (!__libc_reconnect_log_socket(main_log_fd)) {
+      return __libc_write_stderr(tag, msg);
+    }
+    result = TEMP_FAILURE_RETRY(writev(main_log_fd, vec, sizeof(vec) / sizeof(vec[0])));
+  }
   return result;
 }
 
@@ -0,0 +1,122 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include "private/bionic_startup_trace.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "private/ErrnoRestorer.h"
+#include "private/libc_logging.h"
+
+static struct {
+  // Where to write the summary, or null if tracing is off.
+  const char* output;
+  long long start_ns;
+  // The CPU time the process had used when libc started initializing: exec(), and for dynamic
+  // executables the dynamic linker.
+  long long start_cpu_ns;
+  long long phase_start_ns[kStartupPhaseCount];
+  long long phase_ns[kStartupPhaseCount];
+} g_startup_trace;
+
+static long long now_ns(clockid_t clock) {
+  timespec ts;
+  clock_gettime(clock, &ts);
+  return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+void __libc_startup_trace_init(char** envp) {
+  static const char kName[] = "LIBC_STARTUP_TRACE=";
+  for (char** env = envp; *env != nullptr; ++env) {
+    if (strncmp(*env, kName, sizeof(kName) - 1) == 0) {
+      const char* value = *env + sizeof(kName) - 1;
+      if (*value != '\0' && strcmp(value, "0") != 0) {
+        g_startup_trace.output = value;
+        g_startup_trace.start_ns = now_ns(CLOCK_MONOTONIC);
+        g_startup_trace.start_cpu_ns = now_ns(CLOCK_PROCESS_CPUTIME_ID);
+      }
+      return;
+    }
+  }
+}
+
+void __libc_startup_trace_begin(StartupPhase phase) {
+  if (__predict_true(g_startup_trace.output == nullptr)) return;
+  g_startup_trace.phase_start_ns[phase] = now_ns(CLOCK_MONOTONIC);
+}
+
+void __libc_startup_trace_end(StartupPhase phase) {
+  if (__predict_true(g_startup_trace.output == nullptr)) return;
+  long long elapsed_ns = now_ns(CLOCK_MONOTONIC) - g_startup_trace.phase_start_ns[phase];
+  g_startup_trace.phase_ns[phase] += elapsed_ns;
+}
+
+void __libc_startup_trace_report() {
+  const char* output = g_startup_trace.output;
+  if (__predict_true(output == nullptr)) return;
+  g_startup_trace.output = nullptr;
+  ErrnoRestorer errno_restorer;
+
+  // One line of key=value pairs, written with a single write() so that lines from concurrently
+  // starting processes sharing a file don't interleave.
+  static_assert(kStartupPhaseCount == 8, "update the format below");
+  const long long* phase_ns = g_startup_trace.phase_ns;
+  char line[512];
+  size_t used = __libc_format_buffer(
+      line, sizeof(line),
+      "libc_startup pid=%d prog=%s pre_libc_cpu_us=%lld globals_us=%lld common_us=%lld "
+      "properties_us=%lld malloc_us=%lld netd_us=%lld relocation_us=%lld constructors_us=%lld "
+      "parallel_constructors_us=%lld total_us=%lld\n",
+      getpid(), getprogname(), g_startup_trace.start_cpu_ns / 1000,
+      phase_ns[kStartupPhaseGlobals] / 1000, phase_ns[kStartupPhaseCommon] / 1000,
+      phase_ns[kStartupPhaseProperties] / 1000, phase_ns[kStartupPhaseMalloc] / 1000,
+      phase_ns[kStartupPhaseNetd] / 1000, phase_ns[kStartupPhaseRelocation] / 1000,
+      phase_ns[kStartupPhaseConstructors] / 1000,
+      phase_ns[kStartupPhaseParallelConstructors] / 1000,
+      (now_ns(CLOCK_MONOTONIC) - g_startup_trace.start_ns) / 1000);
+  if (used >= sizeof(line)) {
+    // A very long argv[0].
+    used = sizeof(line) - 1;
+    line[used - 1] = '\n';
+  }
+
+  if (strcmp(output, "1") == 0) {
+    TEMP_FAILURE_RETRY(write(STDERR_FILENO, line, used));
+  } else {
+    int fd = TEMP_FAILURE_RETRY(open(output, O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0666));
+    if (fd != -1) {
+      TEMP_FAILURE_RETRY(write(fd, line, used));
+      close(fd);
+    }
+  }
+}
@@ -0,0 +1,206 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+
+#include <android/libc_stats.h>
+
+#include <errno.h>
+#include <malloc.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "private/bionic_stats.h"
+#include "pthread_internal.h"
+
+#define _REALLY_INCLUDE_SYS__SYSTEM_PROPERTIES_H_
+#include <sys/_system_properties.h>
+
+// The dynamic linker's statistics, through libdl. It's weak because static executables don't
+// have a dynamic linker, or necessarily libdl.
+extern "C" void android_linker_stats_iterate(void (*callback)(const android_libc_stat*, void*),
+                                             void* arg) __attribute__((weak));
+
+static const char* const kCounterNames[] = {
+  "properties.finds",
+  "pthread.stack_cache.hits",
+  "pthread.stack_cache.misses",
+};
+static_assert(sizeof(kCounterNames) / sizeof(kCounterNames[0]) == LIBC_STAT_COUNTER_COUNT,
+              "a libc_stat_counter has no name");
+
+static const char* const kHistogramNames[] = {
+  "stdio.read_bytes",
+  "stdio.write_bytes",
+};
+static_assert(sizeof(kHistogramNames) / sizeof(kHistogramNames[0]) == LIBC_STAT_HISTOGRAM_COUNT,
+              "a libc_stat_histogram has no name");
+
+typedef void (*Callback)(const android_libc_stat*, void*);
+
+static void Report(Callback callback, void* arg, const char* name, int type, uint64_t value) {
+  android_libc_stat stat = { name, type, value, 0, nullptr, nullptr };
+  callback(&stat, arg);
+}
+
+static void ReportHistogram(Callback callback, void* arg, const char* name, size_t bucket_count,
+                            const uint64_t* bucket_limits, const uint64_t* buckets) {
+  android_libc_stat stat = { name, ANDROID_LIBC_STAT_HISTOGRAM, 0, bucket_count, bucket_limits,
+                             buckets };
+  for (size_t i = 0; i < bucket_count; ++i) stat.value += buckets[i];
+  callback(&stat, arg);
+}
+
+// The linker calls back with its lock held, so its statistics are copied out and reported
+// after it's returned.
+struct LinkerStats {
+  static constexpr size_t kMax = 16;
+  android_libc_stat stats[kMax];
+  size_t count;
+};
+
+static void CollectLinkerStat(const android_libc_stat* stat, void* arg) {
+  LinkerStats* linker_stats = reinterpret_cast<LinkerStats*>(arg);
+  if (linker_stats->count < LinkerStats::kMax) {
+    linker_stats->stats[linker_stats->count++] = *stat;
+  }
+}
+
+static void SumMallocStats(const malloc_thread_stats* stats, void* arg) {
+  malloc_thread_stats* total = reinterpret_cast<malloc_thread_stats*>(arg);
+  total->allocated_bytes += stats->allocated_bytes;
+  total->freed_bytes += stats->freed_bytes;
+  total->allocation_calls += stats->allocation_calls;
+  total->free_calls += stats->free_calls;
+  for (size_t i = 0; i < MALLOC_THREAD_STATS_SIZE_CLASSES; ++i) {
+    total->size_class_calls[i] += stats->size_class_calls[i];
+  }
+}
+
+int android_libc_stats_iterate(Callback callback, void* arg) {
+  if (callback == nullptr) {
+    errno = EINVAL;
+    return -1;
+  }
+
+  _resolv_cache_libc_stats(callback, arg);
+
+  if (android_linker_stats_iterate != nullptr) {
+    LinkerStats linker_stats;
+    linker_stats.count = 0;
+    android_linker_stats_iterate(CollectLinkerStat, &linker_stats);
+    for (size_t i = 0; i < linker_stats.count; ++i) callback(&linker_stats.stats[i], arg);
+  }
+
+  malloc_thread_stats malloc_total;
+  memset(&malloc_total, 0, sizeof(malloc_total));
+  malloc_iterate_thread_stats(SumMallocStats, &malloc_total);
+  Report(callback, arg, "malloc.allocation_calls", ANDROID_LIBC_STAT_COUNTER,
+         malloc_total.allocation_calls);
+  Report(callback, arg, "malloc.free_calls", ANDROID_LIBC_STAT_COUNTER, malloc_total.free_calls);
+  Report(callback, arg, "malloc.allocated_bytes", ANDROID_LIBC_STAT_COUNTER,
+         malloc_total.allocated_bytes);
+  Report(callback, arg, "malloc.freed_bytes", ANDROID_LIBC_STAT_COUNTER, malloc_total.freed_bytes);
+  // Size class i counts the requests of up to 16 << (2 * i) bytes.
+  uint64_t size_class_limits[MALLOC_THREAD_STATS_SIZE_CLASSES];
+  for (size_t i = 0; i < MALLOC_THREAD_STATS_SIZE_CLASSES; ++i) {
+    size_class_limits[i] = (i == MALLOC_THREAD_STATS_SIZE_CLASSES - 1) ? UINT64_MAX
+                                                                       : UINT64_C(16) << (2 * i);
+  }
+  ReportHistogram(callback, arg, "malloc.request_bytes", MALLOC_THREAD_STATS_SIZE_CLASSES,
+                  size_class_limits, malloc_total.size_class_calls);
+  struct mallinfo mi = mallinfo();
+  Report(callback, arg, "malloc.in_use_bytes", ANDROID_LIBC_STAT_GAUGE, mi.uordblks);
+  Report(callback, arg, "malloc.mapped_bytes", ANDROID_LIBC_STAT_GAUGE, mi.hblkhd);
+
+  libc_thread_stats total;
+  size_t threads = __pthread_internal_libc_stats(&total);
+
+  // The global serial goes up by one for each property that's set.
+  unsigned int serial = __system_property_area_serial();
+  if (serial != static_cast<unsigned int>(-1)) {
+    Report(callback, arg, "properties.changes", ANDROID_LIBC_STAT_COUNTER, serial);
+  }
+  Report(callback, arg, kCounterNames[LIBC_STAT_PROPERTY_FINDS], ANDROID_LIBC_STAT_COUNTER,
+         total.counters[LIBC_STAT_PROPERTY_FINDS]);
+
+  Report(callback, arg, "pthread.threads", ANDROID_LIBC_STAT_GAUGE, threads);
+  Report(callback, arg, kCounterNames[LIBC_STAT_THREAD_STACK_CACHE_HITS],
+         ANDROID_LIBC_STAT_COUNTER, total.counters[LIBC_STAT_THREAD_STACK_CACHE_HITS]);
+  Report(callback, arg, kCounterNames[LIBC_STAT_THREAD_STACK_CACHE_MISSES],
+         ANDROID_LIBC_STAT_COUNTER, total.counters[LIBC_STAT_THREAD_STACK_CACHE_MISSES]);
+
+  // See __libc_stats_sample: bucket i holds the samples below 4^i.
+  uint64_t limits[LIBC_STAT_HISTOGRAM_BUCKETS];
+  for (size_t i = 0; i < LIBC_STAT_HISTOGRAM_BUCKETS; ++i) {
+    limits[i] = (i == LIBC_STAT_HISTOGRAM_BUCKETS - 1) ? UINT64_MAX : (UINT64_C(1) << (2 * i)) - 1;
+  }
+  for (size_t i = 0; i < LIBC_STAT_HISTOGRAM_COUNT; ++i) {
+    ReportHistogram(callback, arg, kHistogramNames[i], LIBC_STAT_HISTOGRAM_BUCKETS, limits,
+                    total.histograms[i]);
+  }
+  return 0;
+}
+
+struct DumpState {
+  int fd;
+  int error;
+};
+
+static void DumpOne(const android_libc_stat* stat, void* arg) {
+  DumpState* state = reinterpret_cast<DumpState*>(arg);
+  if (state->error != 0) return;
+
+  static const char* const kTypes[] = { "counter", "gauge", "histogram" };
+  char line[1024];
+  size_t length = snprintf(line, sizeof(line), "%s %s %llu", kTypes[stat->type], stat->name,
+                           static_cast<unsigned long long>(stat->value));
+  for (size_t i = 0; i < stat->bucket_count && length < sizeof(line); ++i) {
+    if (stat->buckets[i] == 0) continue;
+    if (stat->bucket_limits[i] == UINT64_MAX) {
+      length += snprintf(line + length, sizeof(line) - length, " max:%llu",
+                         static_cast<unsigned long long>(stat->buckets[i]));
+    } else {
+      length += snprintf(line + length, sizeof(line) - length, " %llu:%llu",
+                         static_cast<unsigned long long>(stat->bucket_limits[i]),
+                         static_cast<unsigned long long>(stat->buckets[i]));
+    }
+  }
+  if (dprintf(state->fd, "%s\n", line) < 0) {
+    state->error = errno;
+  }
+}
+
+int android_libc_stats_dump(int fd) {
+  DumpState state = { fd, 0 };
+  if (android_libc_stats_iterate(DumpOne, &state) == -1) return -1;
+  if (state.error != 0) {
+    errno = state.error;
+    return -1;
+  }
+  return 0;
+}
@@ -36,10 +36,12 @@
 #include <wchar.h>
 
 #include "private/bionic_macros.h"
+#include "pthread_internal.h"
 
 // We currently support a single locale, the "C" locale (also known as "POSIX").
 
-static bool __bionic_current_locale_is_utf8 = true;
+// MB_CUR_MAX for LC_GLOBAL_LOCALE: 4 for UTF-8, 1 otherwise.
+static size_t g_global_mb_cur_max = 4;
 
 struct __locale_t {
   size_t mb_cur_max;
@@ -49,7 +51,7 @@ struct __locale_t {
 
   explicit __locale_t(const __locale_t* other) {
     if (other == LC_GLOBAL_LOCALE) {
-      mb_cur_max = __bionic_current_locale_is_utf8 ? 4 : 1;
+      mb_cur_max = g_global_mb_cur_max;
     } else {
       mb_cur_max = other->mb_cur_max;
     }
@@ -59,12 +61,8 @@ struct __locale_t {
 };
 
 size_t __ctype_get_mb_cur_max() {
-  locale_t l = uselocale(NULL);
-  if (l == LC_GLOBAL_LOCALE) {
-    return __bionic_current_locale_is_utf8 ? 4 : 1;
-  } else {
-    return l->mb_cur_max;
-  }
+  locale_t l = __get_thread()->locale;
+  return (l == nullptr) ? g_global_mb_cur_max : l->mb_cur_max;
 }
 
 static pthread_once_t g_locale_once = PTHREAD_ONCE_INIT;
@@ -150,23 +148,15 @@ char* setlocale(int category, const char* locale_name) {
       errno = ENOENT;
       return NULL;
     }
-    __bionic_current_locale_is_utf8 = (strstr(locale_name, "UTF-8") != NULL);
+    g_global_mb_cur_max = (strstr(locale_name, "UTF-8") != NULL) ? 4 : 1;
   }
 
-  return const_cast<char*>(__bionic_current_locale_is_utf8 ? "C.UTF-8" : "C");
-}
-
-// We can't use a constructor to create g_uselocal_key, because it may be used in constructors.
-static pthread_once_t g_uselocale_once = PTHREAD_ONCE_INIT;
-static pthread_key_t g_uselocale_key;
-
-static void g_uselocale_key_init() {
-  pthread_key_create(&g_uselocale_key, NULL);
+  return const_cast<char*>((g_global_mb_cur_max == 4) ? "C.UTF-8" : "C");
 }
 
 locale_t uselocale(locale_t new_locale) {
-  pthread_once(&g_uselocale_once, g_uselocale_key_init);
-  locale_t old_locale = static_cast<locale_t>(pthread_getspecific(g_uselocale_key));
+  pthread_internal_t* thread = __get_thread();
+  locale_t old_locale = thread->locale;
 
   // If this is the first call to uselocale(3) on this thread, we return LC_GLOBAL_LOCALE.
   if (old_locale == NULL) {
@@ -174,7 +164,7 @@ locale_t uselocale(locale_t new_locale) {
   }
 
   if (new_locale != NULL) {
-    pthread_setspecific(g_uselocale_key, new_locale);
+    thread->locale = (new_locale == LC_GLOBAL_LOCALE) ? NULL : new_locale;
   }
 
   return old_locale;
@@ -40,13 +40,18 @@
 //   free_malloc_leak_info: Frees the data allocated by the call to
 //                          get_malloc_leak_info.
 
+#include <malloc.h>
 #include <pthread.h>
+#include <string.h>
+#include <sys/mman.h>
 
 #include <private/bionic_config.h>
 #include <private/bionic_globals.h>
 #include <private/bionic_malloc_dispatch.h>
 
 #include "jemalloc.h"
+#include "malloc_sampler.h"
+#include "pthread_internal.h"
 #define Malloc(function)  je_ ## function
 
 static constexpr MallocDispatch __libc_malloc_default_dispatch
@@ -68,28 +73,158 @@ static constexpr MallocDispatch __libc_malloc_default_dispatch
     Malloc(iterate),
     Malloc(malloc_disable),
     Malloc(malloc_enable),
+    Malloc(heap_create),
+    Malloc(heap_malloc),
+    Malloc(heap_free),
+    Malloc(heap_destroy),
+    Malloc(free_sized),
+    Malloc(mallopt),
+    Malloc(malloc_trim),
   };
 
 // In a VM process, this is set to 1 after fork()ing out of zygote.
 int gMallocLeakZygoteChild = 0;
 
+// =============================================================================
+// Per-thread statistics
+// =============================================================================
+// The counters live in pthread_internal_t and are only written by their
+// own thread, so updating them needs neither a lock nor an atomic.
+static inline size_t __malloc_usable_size(const void* mem) {
+  if (__predict_false(__malloc_sampler_owns(mem))) {
+    return __malloc_sampler_usable_size(mem);
+  }
+  auto _malloc_usable_size = __libc_globals->malloc_dispatch.malloc_usable_size;
+  if (__predict_false(_malloc_usable_size != nullptr)) {
+    return _malloc_usable_size(mem);
+  }
+  return Malloc(malloc_usable_size)(mem);
+}
+
+// Size class i covers requests up to 16 << (2 * i) bytes, the last one
+// everything bigger.
+static inline size_t __malloc_size_class(size_t bytes) {
+  if (bytes <= 16) {
+    return 0;
+  }
+  size_t log2 = (sizeof(size_t) * 8 - 1) - __builtin_clzl(bytes - 1);
+  size_t size_class = 1 + (log2 - 4) / 2;
+  return size_class < MALLOC_THREAD_STATS_SIZE_CLASSES ?
+      size_class : MALLOC_THREAD_STATS_SIZE_CLASSES - 1;
+}
+
+static inline void __malloc_stats_count_alloc(size_t usable_size, size_t bytes) {
+  pthread_internal_t* thread = __get_thread();
+  if (__predict_false(thread == nullptr)) {
+    return;
+  }
+  malloc_thread_stats& stats = thread->malloc_stats;
+  stats.allocated_bytes += usable_size;
+  stats.allocation_calls++;
+  stats.size_class_calls[__malloc_size_class(bytes)]++;
+}
+
+static inline void __malloc_stats_alloc(void* mem, size_t bytes) {
+  if (mem != nullptr) {
+    __malloc_stats_count_alloc(__malloc_usable_size(mem), bytes);
+  }
+}
+
+// The usable size of a jemalloc allocation of the given size, computed from
+// its size class rather than looked up. malloc(0) gives out a one byte
+// allocation.
+static inline size_t __malloc_default_usable_size(size_t bytes) {
+  return Malloc(nallocx)(bytes == 0 ? 1 : bytes, 0);
+}
+
+static inline void __malloc_stats_free(size_t usable_size) {
+  pthread_internal_t* thread = __get_thread();
+  if (__predict_false(thread == nullptr)) {
+    return;
+  }
+  thread->malloc_stats.freed_bytes += usable_size;
+  thread->malloc_stats.free_calls++;
+}
+
+// Returns a sampled allocation when the thread's countdown runs out, and
+// nullptr the rest of the time. Only the default allocator is sampled.
+static inline void* __malloc_sampled(size_t bytes) {
+  pthread_internal_t* thread = __get_thread();
+  if (__predict_true(thread == nullptr || thread->malloc_sample_countdown-- != 0)) {
+    return nullptr;
+  }
+  return __malloc_sampler_malloc(thread, bytes);
+}
+
 // =============================================================================
 // Allocation functions
 // =============================================================================
+// malloc, calloc, realloc and free are the hot ones. They look at the
+// dispatch table once, and without malloc debug call straight into jemalloc,
+// including for the sizes the statistics need.
 extern "C" void* calloc(size_t n_elements, size_t elem_size) {
   auto _calloc = __libc_globals->malloc_dispatch.calloc;
   if (__predict_false(_calloc != nullptr)) {
-    return _calloc(n_elements, elem_size);
+    void* result = _calloc(n_elements, elem_size);
+    __malloc_stats_alloc(result, n_elements * elem_size);
+    return result;
+  }
+  size_t bytes;
+  if (__builtin_mul_overflow(n_elements, elem_size, &bytes)) {
+    return Malloc(calloc)(n_elements, elem_size);
+  }
+  // Sampled allocations are always zero filled.
+  void* result = __malloc_sampled(bytes);
+  if (__predict_false(result != nullptr)) {
+    __malloc_stats_count_alloc(__malloc_sampler_usable_size(result), bytes);
+    return result;
+  }
+  result = Malloc(calloc)(n_elements, elem_size);
+  if (__predict_true(result != nullptr)) {
+    __malloc_stats_count_alloc(__malloc_default_usable_size(bytes), bytes);
   }
-  return Malloc(calloc)(n_elements, elem_size);
+  return result;
 }
 
 extern "C" void free(void* mem) {
+  if (__predict_false(__malloc_sampler_owns(mem))) {
+    __malloc_stats_free(__malloc_sampler_usable_size(mem));
+    __malloc_sampler_free(mem);
+    return;
+  }
   auto _free = __libc_globals->malloc_dispatch.free;
   if (__predict_false(_free != nullptr)) {
+    if (mem != nullptr) {
+      __malloc_stats_free(__libc_globals->malloc_dispatch.malloc_usable_size(mem));
+    }
     _free(mem);
+    return;
+  }
+  if (mem != nullptr) {
+    __malloc_stats_free(Malloc(malloc_usable_size)(mem));
+  }
+  Malloc(free)(mem);
+}
+
+// The size must be the one the allocation was requested with. The size
+// class it maps to is what malloc_usable_size would have returned, which
+// keeps the statistics exact without looking the pointer up.
+extern "C" void free_sized(void* mem, size_t bytes) {
+  if (__predict_false(__malloc_sampler_owns(mem))) {
+    free(mem);
+    return;
+  }
+  auto _free_sized = __libc_globals->malloc_dispatch.free_sized;
+  if (__predict_false(_free_sized != nullptr)) {
+    if (mem != nullptr) {
+      __malloc_stats_free(__malloc_usable_size(mem));
+    }
+    _free_sized(mem, bytes);
   } else {
-    Malloc(free)(mem);
+    if (mem != nullptr) {
+      __malloc_stats_free(Malloc(nallocx)(bytes == 0 ? 1 : bytes, 0));
+    }
+    Malloc(free_sized)(mem, bytes);
   }
 }
 
@@ -101,64 +236,182 @@ extern "C" struct mallinfo mallinfo() {
   return Malloc(mallinfo)();
 }
 
+extern "C" int mallopt(int option, int value) {
+  auto _mallopt = __libc_globals->malloc_dispatch.mallopt;
+  if (__predict_false(_mallopt != nullptr)) {
+    return _mallopt(option, value);
+  }
+  return Malloc(mallopt)(option, value);
+}
+
+extern "C" int malloc_trim(size_t pad) {
+  auto _malloc_trim = __libc_globals->malloc_dispatch.malloc_trim;
+  if (__predict_false(_malloc_trim != nullptr)) {
+    return _malloc_trim(pad);
+  }
+  return Malloc(malloc_trim)(pad);
+}
+
 extern "C" void* malloc(size_t bytes) {
   auto _malloc = __libc_globals->malloc_dispatch.malloc;
   if (__predict_false(_malloc != nullptr)) {
-    return _malloc(bytes);
+    void* result = _malloc(bytes);
+    __malloc_stats_alloc(result, bytes);
+    return result;
+  }
+  void* result = __malloc_sampled(bytes);
+  if (__predict_false(result != nullptr)) {
+    __malloc_stats_count_alloc(__malloc_sampler_usable_size(result), bytes);
+    return result;
   }
-  return Malloc(malloc)(bytes);
+  result = Malloc(malloc)(bytes);
+  if (__predict_true(result != nullptr)) {
+    __malloc_stats_count_alloc(__malloc_default_usable_size(bytes), bytes);
+  }
+  return result;
 }
 
 extern "C" size_t malloc_usable_size(const void* mem) {
-  auto _malloc_usable_size = __libc_globals->malloc_dispatch.malloc_usable_size;
-  if (__predict_false(_malloc_usable_size != nullptr)) {
-    return _malloc_usable_size(mem);
-  }
-  return Malloc(malloc_usable_size)(mem);
+  return __malloc_usable_size(mem);
 }
 
 extern "C" void* memalign(size_t alignment, size_t bytes) {
   auto _memalign = __libc_globals->malloc_dispatch.memalign;
+  void* result;
   if (__predict_false(_memalign != nullptr)) {
-    return _memalign(alignment, bytes);
+    result = _memalign(alignment, bytes);
+  } else {
+    result = Malloc(memalign)(alignment, bytes);
   }
-  return Malloc(memalign)(alignment, bytes);
+  __malloc_stats_alloc(result, bytes);
+  return result;
 }
 
 extern "C" int posix_memalign(void** memptr, size_t alignment, size_t size) {
   auto _posix_memalign = __libc_globals->malloc_dispatch.posix_memalign;
+  int result;
   if (__predict_false(_posix_memalign != nullptr)) {
-    return _posix_memalign(memptr, alignment, size);
+    result = _posix_memalign(memptr, alignment, size);
+  } else {
+    result = Malloc(posix_memalign)(memptr, alignment, size);
+  }
+  if (result == 0) {
+    __malloc_stats_alloc(*memptr, size);
   }
-  return Malloc(posix_memalign)(memptr, alignment, size);
+  return result;
 }
 
 extern "C" void* realloc(void* old_mem, size_t bytes) {
+  if (__predict_false(__malloc_sampler_owns(old_mem))) {
+    // Move the allocation out of the sampler's pool.
+    size_t old_usable_size = __malloc_sampler_usable_size(old_mem);
+    if (bytes == 0) {
+      free(old_mem);
+      return nullptr;
+    }
+    void* result = malloc(bytes);
+    if (result != nullptr) {
+      memcpy(result, old_mem, old_usable_size < bytes ? old_usable_size : bytes);
+      free(old_mem);
+    }
+    return result;
+  }
   auto _realloc = __libc_globals->malloc_dispatch.realloc;
+  size_t old_usable_size = 0;
+  void* result;
   if (__predict_false(_realloc != nullptr)) {
-    return _realloc(old_mem, bytes);
+    if (old_mem != nullptr) {
+      old_usable_size = __libc_globals->malloc_dispatch.malloc_usable_size(old_mem);
+    }
+    result = _realloc(old_mem, bytes);
+  } else {
+    if (old_mem != nullptr) {
+      old_usable_size = Malloc(malloc_usable_size)(old_mem);
+    }
+    result = Malloc(realloc)(old_mem, bytes);
+  }
+  // A failed realloc leaves the old allocation alone, except that a zero
+  // size frees it.
+  if (old_mem != nullptr && (result != nullptr || bytes == 0)) {
+    __malloc_stats_free(old_usable_size);
+  }
+  if (__predict_false(_realloc != nullptr)) {
+    __malloc_stats_alloc(result, bytes);
+  } else if (result != nullptr) {
+    __malloc_stats_count_alloc(__malloc_default_usable_size(bytes), bytes);
   }
-  return Malloc(realloc)(old_mem, bytes);
+  return result;
 }
 
 #if defined(HAVE_DEPRECATED_MALLOC_FUNCS)
 extern "C" void* pvalloc(size_t bytes) {
   auto _pvalloc = __libc_globals->malloc_dispatch.pvalloc;
+  void* result;
   if (__predict_false(_pvalloc != nullptr)) {
-    return _pvalloc(bytes);
+    result = _pvalloc(bytes);
+  } else {
+    result = Malloc(pvalloc)(bytes);
   }
-  return Malloc(pvalloc)(bytes);
+  __malloc_stats_alloc(result, bytes);
+  return result;
 }
 
 extern "C" void* valloc(size_t bytes) {
   auto _valloc = __libc_globals->malloc_dispatch.valloc;
+  void* result;
   if (__predict_false(_valloc != nullptr)) {
-    return _valloc(bytes);
+    result = _valloc(bytes);
+  } else {
+    result = Malloc(valloc)(bytes);
   }
-  return Malloc(valloc)(bytes);
+  __malloc_stats_alloc(result, bytes);
+  return result;
 }
 #endif
 
+// =============================================================================
+// Heaps
+// =============================================================================
+extern "C" int android_heap_create() {
+  auto _heap_create = __libc_globals->malloc_dispatch.heap_create;
+  if (__predict_false(_heap_create != nullptr)) {
+    return _heap_create();
+  }
+  return Malloc(heap_create)();
+}
+
+extern "C" void* android_heap_malloc(int heap, size_t bytes) {
+  auto _heap_malloc = __libc_globals->malloc_dispatch.heap_malloc;
+  void* result;
+  if (__predict_false(_heap_malloc != nullptr)) {
+    result = _heap_malloc(heap, bytes);
+  } else {
+    result = Malloc(heap_malloc)(heap, bytes);
+  }
+  __malloc_stats_alloc(result, bytes);
+  return result;
+}
+
+extern "C" void android_heap_free(int heap, void* mem) {
+  if (mem != nullptr) {
+    __malloc_stats_free(__malloc_usable_size(mem));
+  }
+  auto _heap_free = __libc_globals->malloc_dispatch.heap_free;
+  if (__predict_false(_heap_free != nullptr)) {
+    _heap_free(heap, mem);
+  } else {
+    Malloc(heap_free)(heap, mem);
+  }
+}
+
+extern "C" int android_heap_destroy(int heap) {
+  auto _heap_destroy = __libc_globals->malloc_dispatch.heap_destroy;
+  if (__predict_false(_heap_destroy != nullptr)) {
+    return _heap_destroy(heap);
+  }
+  return Malloc(heap_destroy)(heap);
+}
+
 // We implement malloc debugging only in libc.so, so the code below
 // must be excluded if we compile this file for static libc.a
 #if !defined(LIBC_STATIC)
@@ -280,6 +533,34 @@ static bool InitMalloc(void* malloc_impl_handler, MallocDispatch* table, const c
                                          prefix, "malloc_enable")) {
     return false;
   }
+  if (!InitMallocFunction<MallocHeapCreate>(malloc_impl_handler, &table->heap_create,
+                                            prefix, "heap_create")) {
+    return false;
+  }
+  if (!InitMallocFunction<MallocHeapMalloc>(malloc_impl_handler, &table->heap_malloc,
+                                            prefix, "heap_malloc")) {
+    return false;
+  }
+  if (!InitMallocFunction<MallocHeapFree>(malloc_impl_handler, &table->heap_free,
+                                          prefix, "heap_free")) {
+    return false;
+  }
+  if (!InitMallocFunction<MallocHeapDestroy>(malloc_impl_handler, &table->heap_destroy,
+                                             prefix, "heap_destroy")) {
+    return false;
+  }
+  if (!InitMallocFunction<MallocFreeSized>(malloc_impl_handler, &table->free_sized,
+                                           prefix, "free_sized")) {
+    return false;
+  }
+  if (!InitMallocFunction<MallocMallopt>(malloc_impl_handler, &table->mallopt,
+                                         prefix, "mallopt")) {
+    return false;
+  }
+  if (!InitMallocFunction<MallocMallocTrim>(malloc_impl_handler, &table->malloc_trim,
+                                            prefix, "malloc_trim")) {
+    return false;
+  }
 #if defined(HAVE_DEPRECATED_MALLOC_FUNCS)
   if (!InitMallocFunction<MallocPvalloc>(malloc_impl_handler, &table->pvalloc,
                                          prefix, "pvalloc")) {
@@ -412,7 +693,15 @@ static void malloc_init_impl(libc_globals* globals) {
 // Initializes memory allocation framework.
 // This routine is called from __libc_init routines in libc_init_dynamic.cpp.
 __LIBC_HIDDEN__ void __libc_init_malloc(libc_globals* globals) {
+  // Almost no process has either configured, so don't pay for the property
+  // lookups unless the property service says one has been set.
+  if (!__system_property_malloc_debug_possible()) {
+    return;
+  }
   malloc_init_impl(globals);
+  if (globals->malloc_dispatch.malloc == nullptr) {
+    __libc_init_malloc_sampler(globals);
+  }
 }
 #endif  // !LIBC_STATIC
 
@@ -450,6 +739,83 @@ extern "C" void malloc_enable() {
   return Malloc(malloc_enable)();
 }
 
+// Allocations found while the allocator is disabled. They are kept in an
+// mmap of their own, holding capacity bases followed by capacity sizes,
+// since malloc can't be used.
+struct BulkIterateBuffer {
+  void* mem;
+  size_t capacity;
+  size_t count;
+  bool failed;
+
+  uintptr_t* bases() { return reinterpret_cast<uintptr_t*>(mem); }
+  size_t* sizes() { return reinterpret_cast<size_t*>(bases() + capacity); }
+  size_t mem_size() { return capacity * (sizeof(uintptr_t) + sizeof(size_t)); }
+};
+
+static constexpr size_t BULK_ITERATE_WINDOW_SIZE = 1024 * 1024;
+static constexpr size_t BULK_ITERATE_INITIAL_CAPACITY = 1024;
+
+static void __bulk_iterate_add(uintptr_t base, size_t size, void* arg) {
+  BulkIterateBuffer* buffer = reinterpret_cast<BulkIterateBuffer*>(arg);
+  if (buffer->failed) {
+    return;
+  }
+  if (buffer->count == buffer->capacity) {
+    void* mem = mremap(buffer->mem, buffer->mem_size(), 2 * buffer->mem_size(), MREMAP_MAYMOVE);
+    if (mem == MAP_FAILED) {
+      buffer->failed = true;
+      return;
+    }
+    buffer->mem = mem;
+    size_t* old_sizes = buffer->sizes();
+    buffer->capacity *= 2;
+    memmove(buffer->sizes(), old_sizes, buffer->count * sizeof(size_t));
+  }
+  buffer->bases()[buffer->count] = base;
+  buffer->sizes()[buffer->count] = size;
+  buffer->count++;
+}
+
+// Like malloc_iterate, but must not be called with the allocator disabled.
+// [base, base+size) is walked a window at a time, and the allocator is only
+// disabled while one window is walked rather than for the whole heap. The
+// allocations found in a window are handed to callback as arrays, with the
+// allocator enabled again, so the callback may allocate. Allocations made
+// or freed between two windows may or may not be reported.
+extern "C" int malloc_iterate_bulk(uintptr_t base, size_t size,
+    void (*callback)(const uintptr_t* bases, const size_t* sizes, size_t count, void* arg),
+    void* arg) {
+  BulkIterateBuffer buffer = {};
+  buffer.capacity = BULK_ITERATE_INITIAL_CAPACITY;
+  buffer.mem = mmap(nullptr, buffer.mem_size(), PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (buffer.mem == MAP_FAILED) {
+    return -1;
+  }
+
+  int result = 0;
+  uintptr_t end = base + size;
+  while (base < end) {
+    size_t window = (end - base < BULK_ITERATE_WINDOW_SIZE) ? end - base : BULK_ITERATE_WINDOW_SIZE;
+    buffer.count = 0;
+    malloc_disable();
+    result = malloc_iterate(base, window, __bulk_iterate_add, &buffer);
+    malloc_enable();
+    if (result != 0 || buffer.failed) {
+      result = -1;
+      break;
+    }
+    if (buffer.count > 0) {
+      callback(buffer.bases(), buffer.sizes(), buffer.count, arg);
+    }
+    base += window;
+  }
+
+  munmap(buffer.mem, buffer.mem_size());
+  return result;
+}
+
 #ifndef LIBC_STATIC
 extern "C" ssize_t malloc_backtrace(void* pointer, uintptr_t* frames, size_t frame_count) {
   if (g_debug_malloc_backtrace_func == nullptr) {
@@ -17,6 +17,7 @@
 #include "malloc_info.h"
 
 #include <errno.h>
+#include <inttypes.h>
 #include "private/bionic_macros.h"
 
 class __LIBC_HIDDEN__ Elem {
@@ -56,6 +57,15 @@ private:
   DISALLOW_COPY_AND_ASSIGN(Elem);
 };
 
+static void ThreadStatsElem(const malloc_thread_stats* stats, void* arg) {
+  FILE* fp = reinterpret_cast<FILE*>(arg);
+  Elem thread_elem(fp, "thread", "tid=\"%d\"", stats->tid);
+  Elem(fp, "allocated-bytes").contents("%" PRIu64, stats->allocated_bytes);
+  Elem(fp, "freed-bytes").contents("%" PRIu64, stats->freed_bytes);
+  Elem(fp, "nmalloc").contents("%" PRIu64, stats->allocation_calls);
+  Elem(fp, "nfree").contents("%" PRIu64, stats->free_calls);
+}
+
 int malloc_info(int options, FILE* fp) {
   if (options != 0) {
     errno = EINVAL;
@@ -90,5 +100,7 @@ int malloc_info(int options, FILE* fp) {
     }
   }
 
+  malloc_iterate_thread_stats(ThreadStatsElem, fp);
+
   return 0;
 }
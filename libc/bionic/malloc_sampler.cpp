@@ -0,0 +1,334 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include "malloc_sampler.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/system_properties.h>
+#include <unistd.h>
+#include <unwind.h>
+
+#include "pthread_internal.h"
+#include "private/bionic_macros.h"
+#include "private/bionic_prctl.h"
+#include "private/libc_logging.h"
+#include "private/ScopedPthreadMutexLocker.h"
+
+static const char* SAMPLE_RATE_PROPERTY = "libc.malloc.sample_rate";
+
+// The pool is kSlotCount pages of allocations, with a guard page before,
+// between and after them. Allocations bigger than a page aren't sampled.
+static constexpr size_t kSlotCount = 32;
+static constexpr size_t kPoolSize = (2 * kSlotCount + 1) * PAGE_SIZE;
+static constexpr size_t kFrameCount = 16;
+static constexpr size_t kAlignment = 16;
+
+struct SamplerTrace {
+  pid_t tid;
+  size_t frame_count;
+  uintptr_t frames[kFrameCount];
+};
+
+enum SlotState : uint8_t {
+  SLOT_UNUSED,
+  SLOT_ALLOCATED,
+  SLOT_FREED,
+};
+
+struct SamplerSlot {
+  SlotState state;
+  uintptr_t pointer;
+  size_t size;
+  SamplerTrace alloc_trace;
+  SamplerTrace free_trace;
+};
+
+static pthread_mutex_t g_sampler_lock = PTHREAD_MUTEX_INITIALIZER;
+static SamplerSlot* g_slots;
+static size_t g_next_slot;
+static bool g_align_left;
+static size_t g_sample_rate;
+static _Atomic(uint64_t) g_sample_seed;
+static struct sigaction g_previous_sigsegv;
+
+#define sampler_log(format, ...)  \
+    __libc_format_log(ANDROID_LOG_ERROR, "libc", (format), ##__VA_ARGS__ )
+
+static uintptr_t slot_start(size_t slot) {
+  return __libc_globals->malloc_sampler_base + (2 * slot + 1) * PAGE_SIZE;
+}
+
+// Returns the slot whose page holds addr, or nullptr for a guard page.
+static SamplerSlot* find_slot(uintptr_t addr) {
+  size_t page = (addr - __libc_globals->malloc_sampler_base) / PAGE_SIZE;
+  return (page % 2 == 1) ? &g_slots[page / 2] : nullptr;
+}
+
+static _Unwind_Reason_Code sampler_trace_function(_Unwind_Context* context, void* arg) {
+  SamplerTrace* trace = reinterpret_cast<SamplerTrace*>(arg);
+  trace->frames[trace->frame_count++] = _Unwind_GetIP(context);
+  return (trace->frame_count >= kFrameCount) ? _URC_END_OF_STACK : _URC_NO_REASON;
+}
+
+// Unwinding is done before taking the lock, since it can be slow.
+static void collect_trace(SamplerTrace* trace) {
+  trace->tid = gettid();
+  trace->frame_count = 0;
+  _Unwind_Backtrace(sampler_trace_function, trace);
+}
+
+static void log_trace(const char* what, const SamplerTrace& trace) {
+  if (trace.frame_count == 0) {
+    return;
+  }
+  sampler_log("%s by thread %d:", what, trace.tid);
+  for (size_t i = 0; i < trace.frame_count; i++) {
+    sampler_log("  #%02zu pc %p", i, reinterpret_cast<void*>(trace.frames[i]));
+  }
+}
+
+static void log_report(const char* error, uintptr_t addr, const SamplerSlot& slot) {
+  sampler_log("malloc sampler: %s at %p, allocation %p of size %zu", error,
+              reinterpret_cast<void*>(addr), reinterpret_cast<void*>(slot.pointer), slot.size);
+  log_trace("Allocated", slot.alloc_trace);
+  log_trace("Freed", slot.free_trace);
+}
+
+// The lock isn't taken here, since the faulting thread or another one may
+// hold it. The process is about to crash anyway.
+static void report_fault(uintptr_t addr) {
+  SamplerSlot* slot = find_slot(addr);
+  if (slot != nullptr) {
+    if (slot->state == SLOT_FREED) {
+      log_report("use after free", addr, *slot);
+    }
+    return;
+  }
+
+  // A guard page; blame whichever neighbouring allocation is closer.
+  size_t page = (addr - __libc_globals->malloc_sampler_base) / PAGE_SIZE;
+  SamplerSlot* left = (page > 0) ? &g_slots[page / 2 - 1] : nullptr;
+  SamplerSlot* right = (page / 2 < kSlotCount) ? &g_slots[page / 2] : nullptr;
+  if (left != nullptr && left->state != SLOT_ALLOCATED) {
+    left = nullptr;
+  }
+  if (right != nullptr && right->state != SLOT_ALLOCATED) {
+    right = nullptr;
+  }
+  if (left != nullptr && right != nullptr) {
+    if (addr - (left->pointer + left->size) < right->pointer - addr) {
+      right = nullptr;
+    } else {
+      left = nullptr;
+    }
+  }
+  if (left != nullptr) {
+    log_report("buffer overflow", addr, *left);
+  } else if (right != nullptr) {
+    log_report("buffer underflow", addr, *right);
+  }
+}
+
+static void sampler_fault_handler(int signal, siginfo_t* info, void* context) {
+  if (__malloc_sampler_owns(info->si_addr)) {
+    report_fault(reinterpret_cast<uintptr_t>(info->si_addr));
+  }
+
+  // Let the previous handler, usually debuggerd's, deal with the fault.
+  if ((g_previous_sigsegv.sa_flags & SA_SIGINFO) != 0) {
+    g_previous_sigsegv.sa_sigaction(signal, info, context);
+  } else if (g_previous_sigsegv.sa_handler != SIG_DFL &&
+             g_previous_sigsegv.sa_handler != SIG_IGN) {
+    g_previous_sigsegv.sa_handler(signal);
+  } else {
+    // Returning faults again, with the default action.
+    sigaction(SIGSEGV, &g_previous_sigsegv, nullptr);
+  }
+}
+
+// Uniform in [1, 2 * rate - 1], so the mean distance is the sample rate.
+static size_t next_sample_distance() {
+  uint64_t z = atomic_fetch_add_explicit(&g_sample_seed, 0x9e3779b97f4a7c15ULL,
+                                         memory_order_relaxed);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  z ^= z >> 31;
+  return 1 + z % (2 * g_sample_rate - 1);
+}
+
+void* __malloc_sampler_malloc(pthread_internal_t* thread, size_t bytes) {
+  if (g_sample_rate == 0) {
+    thread->malloc_sample_countdown = SIZE_MAX;
+    return nullptr;
+  }
+  thread->malloc_sample_countdown = next_sample_distance() - 1;
+
+  if (bytes > PAGE_SIZE) {
+    return nullptr;
+  }
+  if (bytes == 0) {
+    bytes = 1;
+  }
+
+  SamplerTrace trace;
+  collect_trace(&trace);
+
+  ScopedPthreadMutexLocker locker(&g_sampler_lock);
+
+  // Reuse the slot that was freed longest ago, to catch as many uses after
+  // free as possible.
+  size_t slot_index = kSlotCount;
+  for (size_t i = 0; i < kSlotCount; i++) {
+    size_t index = (g_next_slot + i) % kSlotCount;
+    if (g_slots[index].state != SLOT_ALLOCATED) {
+      slot_index = index;
+      break;
+    }
+  }
+  if (slot_index == kSlotCount) {
+    return nullptr;
+  }
+
+  uintptr_t start = slot_start(slot_index);
+  if (mprotect(reinterpret_cast<void*>(start), PAGE_SIZE, PROT_READ | PROT_WRITE) != 0) {
+    return nullptr;
+  }
+  g_next_slot = slot_index + 1;
+
+  // Alternate between the two ends of the page, so that overflows and
+  // underflows both get caught some of the time.
+  SamplerSlot& slot = g_slots[slot_index];
+  slot.state = SLOT_ALLOCATED;
+  slot.pointer = g_align_left ? start : start + PAGE_SIZE - BIONIC_ALIGN(bytes, kAlignment);
+  slot.size = bytes;
+  slot.alloc_trace = trace;
+  slot.free_trace.frame_count = 0;
+  g_align_left = !g_align_left;
+
+  // The page was either never touched or dropped by MADV_DONTNEED when it
+  // was last freed, so it is always zero filled.
+  return reinterpret_cast<void*>(slot.pointer);
+}
+
+void __malloc_sampler_free(void* mem) {
+  uintptr_t addr = reinterpret_cast<uintptr_t>(mem);
+  SamplerTrace trace;
+  collect_trace(&trace);
+
+  ScopedPthreadMutexLocker locker(&g_sampler_lock);
+
+  SamplerSlot* slot = find_slot(addr);
+  if (slot == nullptr || slot->state == SLOT_UNUSED) {
+    __libc_fatal("malloc sampler: invalid free of %p", mem);
+  }
+  if (slot->state == SLOT_FREED) {
+    log_report("double free", addr, *slot);
+    log_trace("Freed again", trace);
+    __libc_fatal("malloc sampler: double free of %p", mem);
+  }
+  if (slot->pointer != addr) {
+    log_report("invalid free", addr, *slot);
+    __libc_fatal("malloc sampler: invalid free of %p", mem);
+  }
+
+  slot->state = SLOT_FREED;
+  slot->free_trace = trace;
+  void* page = reinterpret_cast<void*>(addr & ~(PAGE_SIZE - 1));
+  mprotect(page, PAGE_SIZE, PROT_NONE);
+  madvise(page, PAGE_SIZE, MADV_DONTNEED);
+}
+
+size_t __malloc_sampler_usable_size(const void* mem) {
+  uintptr_t addr = reinterpret_cast<uintptr_t>(mem);
+
+  ScopedPthreadMutexLocker locker(&g_sampler_lock);
+
+  SamplerSlot* slot = find_slot(addr);
+  if (slot == nullptr || slot->state != SLOT_ALLOCATED || slot->pointer != addr) {
+    return 0;
+  }
+  return slot->size;
+}
+
+void __libc_init_malloc_sampler(libc_globals* globals) {
+  char value[PROP_VALUE_MAX];
+  if (__system_property_get(SAMPLE_RATE_PROPERTY, value) == 0) {
+    return;
+  }
+  char* end;
+  unsigned long rate = strtoul(value, &end, 10);
+  if (*end != '\0' || rate == 0) {
+    return;
+  }
+
+  void* pool = mmap(nullptr, kPoolSize, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE,
+                    -1, 0);
+  if (pool == MAP_FAILED) {
+    sampler_log("%s: malloc sampler: unable to map the pool: %s", getprogname(), strerror(errno));
+    return;
+  }
+  prctl(PR_SET_VMA, PR_SET_VMA_ANON_NAME, pool, kPoolSize, "libc_malloc_sampler");
+
+  size_t slots_size = BIONIC_ALIGN(kSlotCount * sizeof(SamplerSlot), PAGE_SIZE);
+  void* slots = mmap(nullptr, slots_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS,
+                     -1, 0);
+  if (slots == MAP_FAILED) {
+    sampler_log("%s: malloc sampler: unable to map the slots: %s", getprogname(), strerror(errno));
+    munmap(pool, kPoolSize);
+    return;
+  }
+  prctl(PR_SET_VMA, PR_SET_VMA_ANON_NAME, slots, slots_size, "libc_malloc_sampler slots");
+
+  struct sigaction action;
+  memset(&action, 0, sizeof(action));
+  sigemptyset(&action.sa_mask);
+  action.sa_flags = SA_SIGINFO | SA_ONSTACK;
+  action.sa_sigaction = sampler_fault_handler;
+  sigaction(SIGSEGV, &action, &g_previous_sigsegv);
+
+  pthread_atfork([]() { pthread_mutex_lock(&g_sampler_lock); },
+                 []() { pthread_mutex_unlock(&g_sampler_lock); },
+                 []() { pthread_mutex_unlock(&g_sampler_lock); });
+
+  uint64_t seed;
+  arc4random_buf(&seed, sizeof(seed));
+  atomic_init(&g_sample_seed, seed);
+  g_slots = reinterpret_cast<SamplerSlot*>(slots);
+  g_sample_rate = rate;
+  globals->malloc_sampler_base = reinterpret_cast<uintptr_t>(pool);
+  globals->malloc_sampler_size = kPoolSize;
+
+  __libc_format_log(ANDROID_LOG_INFO, "libc", "%s: malloc sampler enabled, 1 in %lu allocations",
+                    getprogname(), rate);
+}
@@ -0,0 +1,62 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef LIBC_BIONIC_MALLOC_SAMPLER_H_
+#define LIBC_BIONIC_MALLOC_SAMPLER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "private/bionic_globals.h"
+
+class pthread_internal_t;
+
+// The malloc sampler sends about one in every libc.malloc.sample_rate
+// malloc and calloc calls to a small pool of pages, each between two guard
+// pages, and records a backtrace when the allocation is made and freed.
+// Running off either end of a sampled allocation, or touching it after it
+// is freed, faults. The fault handler logs both backtraces and passes the
+// signal on. A double or invalid free of a sampled allocation aborts.
+//
+// The sampler only sits in front of the default allocator. It is off when
+// malloc debug is enabled, or when the property is unset or 0.
+
+static inline bool __malloc_sampler_owns(const void* mem) {
+  return reinterpret_cast<uintptr_t>(mem) - __libc_globals->malloc_sampler_base <
+      __libc_globals->malloc_sampler_size;
+}
+
+__LIBC_HIDDEN__ void __libc_init_malloc_sampler(libc_globals* globals);
+
+// Called when the thread's countdown runs out. Restarts the countdown and
+// returns a sampled allocation, or nullptr if this one can't be sampled.
+__LIBC_HIDDEN__ void* __malloc_sampler_malloc(pthread_internal_t* thread, size_t bytes);
+__LIBC_HIDDEN__ void __malloc_sampler_free(void* mem);
+__LIBC_HIDDEN__ size_t __malloc_sampler_usable_size(const void* mem);
+
+#endif // LIBC_BIONIC_MALLOC_SAMPLER_H_
@@ -26,34 +26,174 @@
  * SUCH DAMAGE.
  */
 
+#include <stdint.h>
 #include <string.h>
+#include <sys/param.h>
+
+// Needles longer than this go straight to two-way.
+static constexpr size_t kMaxFilteredNeedle = 256;
+
+// Two-way (Crochemore and Perrin, "Two-way string-matching", 1991). Linear
+// in the haystack with constant space, but it does a fair amount of work
+// per position, so it's only used for long needles and as the fallback
+// when the filter below is doing badly.
+
+// Returns the start of the right half of the critical factorization of the
+// needle, and its period in *period.
+static size_t critical_factorization(const unsigned char* x, size_t m, size_t* period) {
+  // The maximal suffix for the ordinary ordering...
+  size_t max_suffix = SIZE_MAX;
+  size_t j = 0, k = 1, p = 1;
+  while (j + k < m) {
+    unsigned char a = x[j + k];
+    unsigned char b = x[max_suffix + k];
+    if (a < b) {
+      j += k;
+      k = 1;
+      p = j - max_suffix;
+    } else if (a == b) {
+      if (k != p) {
+        ++k;
+      } else {
+        j += p;
+        k = 1;
+      }
+    } else {
+      max_suffix = j++;
+      k = p = 1;
+    }
+  }
+  *period = p;
+
+  // ...and for the reversed ordering.
+  size_t max_suffix_rev = SIZE_MAX;
+  j = 0, k = 1, p = 1;
+  while (j + k < m) {
+    unsigned char a = x[j + k];
+    unsigned char b = x[max_suffix_rev + k];
+    if (b < a) {
+      j += k;
+      k = 1;
+      p = j - max_suffix_rev;
+    } else if (a == b) {
+      if (k != p) {
+        ++k;
+      } else {
+        j += p;
+        k = 1;
+      }
+    } else {
+      max_suffix_rev = j++;
+      k = p = 1;
+    }
+  }
+
+  // The longer of the two suffixes gives the critical factorization.
+  if (max_suffix_rev + 1 < max_suffix + 1) return max_suffix + 1;
+  *period = p;
+  return max_suffix_rev + 1;
+}
+
+static void* two_way(const unsigned char* y, size_t n, const unsigned char* x, size_t m) {
+  size_t period;
+  size_t suffix = critical_factorization(x, m, &period);
+
+  if (memcmp(x, x + period, suffix) == 0) {
+    // The needle is periodic: remember how much of the left half is known
+    // to match after a shift by the period.
+    size_t memory = 0;
+    size_t j = 0;
+    while (j <= n - m) {
+      size_t i = MAX(suffix, memory);
+      while (i < m && x[i] == y[i + j]) ++i;
+      if (i >= m) {
+        i = suffix - 1;
+        while (memory < i + 1 && x[i] == y[i + j]) --i;
+        if (i + 1 < memory + 1) return const_cast<unsigned char*>(y + j);
+        j += period;
+        memory = m - period;
+      } else {
+        j += i - suffix + 1;
+        memory = 0;
+      }
+    }
+  } else {
+    // The halves don't overlap in any match, so shift by more than either.
+    period = MAX(suffix, m - suffix) + 1;
+    size_t j = 0;
+    while (j <= n - m) {
+      size_t i = suffix;
+      while (i < m && x[i] == y[i + j]) ++i;
+      if (i >= m) {
+        i = suffix - 1;
+        while (i != SIZE_MAX && x[i] == y[i + j]) --i;
+        if (i == SIZE_MAX) return const_cast<unsigned char*>(y + j);
+        j += period;
+      } else {
+        j += i - suffix + 1;
+      }
+    }
+  }
+  return nullptr;
+}
+
+// The fast path compares 16 haystack positions at a time against the
+// needle's first and last bytes and only checks the rest of the needle at
+// positions where both match. These are plain vector extensions so the
+// compiler emits NEON or SSE2 as appropriate.
+typedef unsigned char byte16 __attribute__((vector_size(16)));
+
+static inline byte16 load16(const unsigned char* p) {
+  byte16 v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
 
 void* memmem(const void* void_haystack, size_t n, const void* void_needle, size_t m) {
-  const unsigned char* haystack = reinterpret_cast<const unsigned char*>(void_haystack);
-  const unsigned char* needle = reinterpret_cast<const unsigned char*>(void_needle);
+  const unsigned char* y = reinterpret_cast<const unsigned char*>(void_haystack);
+  const unsigned char* x = reinterpret_cast<const unsigned char*>(void_needle);
 
   if (n < m) return nullptr;
 
   if (m == 0) return const_cast<void*>(void_haystack);
-  if (m == 1) return memchr(haystack, needle[0], n);
+  if (m == 1) return const_cast<void*>(memchr(y, x[0], n));
+  if (m > kMaxFilteredNeedle) return two_way(y, n, x, m);
+
+  // Candidates that fail verification cost up to m each. If that adds up
+  // to much more than the distance scanned (something like "aaaa...b" in
+  // a haystack of 'a's), give up on the filter and let two-way finish from
+  // the first position not yet ruled out, keeping the worst case linear.
+  size_t verify_budget = 4 * kMaxFilteredNeedle;
+  const unsigned char first = x[0];
+  const unsigned char last = x[m - 1];
+  const size_t last_position = n - m;
 
-  // This uses the "Not So Naive" algorithm, a very simple but usually effective algorithm.
-  // http://www-igm.univ-mlv.fr/~lecroq/string/
-  const unsigned char* y = haystack;
-  const unsigned char* x = needle;
   size_t j = 0;
-  size_t k = 1, l = 2;
+  if (last_position >= sizeof(byte16)) {
+    const byte16 first16 = first - byte16{};
+    const byte16 last16 = last - byte16{};
+    for (; j <= last_position - sizeof(byte16); j += sizeof(byte16)) {
+      byte16 hits = (load16(y + j) == first16) & (load16(y + j + m - 1) == last16);
+      uint64_t halves[2];
+      memcpy(halves, &hits, sizeof(halves));
+      if ((halves[0] | halves[1]) == 0) continue;
 
-  if (x[0] == x[1]) {
-    k = 2;
-    l = 1;
+      for (size_t k = 0; k < sizeof(byte16); ++k) {
+        if (hits[k] == 0) continue;
+        if (memcmp(y + j + k + 1, x + 1, m - 2) == 0) {
+          return const_cast<unsigned char*>(y + j + k);
+        }
+        if (verify_budget < m) return two_way(y + j + k + 1, n - (j + k + 1), x, m);
+        verify_budget -= m;
+      }
+      verify_budget += 4 * sizeof(byte16);
+    }
   }
-  while (j <= n-m) {
-    if (x[1] != y[j+1]) {
-      j += k;
-    } else {
-      if (!memcmp(x+2, y+j+2, m-2) && x[0] == y[j]) return const_cast<unsigned char*>(&y[j]);
-      j += l;
+
+  // Fewer than 16 positions left.
+  for (; j <= last_position; ++j) {
+    if (y[j] == first && y[j + m - 1] == last && memcmp(y + j + 1, x + 1, m - 2) == 0) {
+      return const_cast<unsigned char*>(y + j);
     }
   }
   return nullptr;
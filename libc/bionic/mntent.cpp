@@ -29,6 +29,7 @@
 #include <mntent.h>
 #include <string.h>
 
+#include "private/LineReader.h"
 #include "private/ThreadLocalBuffer.h"
 
 static ThreadLocalBuffer<mntent> g_getmntent_mntent_tls_buffer;
@@ -45,22 +46,20 @@ mntent* getmntent_r(FILE* fp, struct mntent* e, char* buf, int buf_len) {
   while (fgets(buf, buf_len, fp) != NULL) {
     // Entries look like "proc /proc proc rw,nosuid,nodev,noexec,relatime 0 0".
     // That is: mnt_fsname mnt_dir mnt_type mnt_opts 0 0.
-    int fsname0, fsname1, dir0, dir1, type0, type1, opts0, opts1;
-    if (sscanf(buf, " %n%*s%n %n%*s%n %n%*s%n %n%*s%n %d %d",
-               &fsname0, &fsname1, &dir0, &dir1, &type0, &type1, &opts0, &opts1,
-               &e->mnt_freq, &e->mnt_passno) == 2) {
-      e->mnt_fsname = &buf[fsname0];
-      buf[fsname1] = '\0';
-
-      e->mnt_dir = &buf[dir0];
-      buf[dir1] = '\0';
-
-      e->mnt_type = &buf[type0];
-      buf[type1] = '\0';
-
-      e->mnt_opts = &buf[opts0];
-      buf[opts1] = '\0';
-
+    buf[strcspn(buf, "\n")] = '\0';
+    FieldTokenizer fields(buf);
+    char* fsname = fields.Next();
+    char* dir = fields.Next();
+    char* type = fields.Next();
+    char* opts = fields.Next();
+    unsigned freq, passno;
+    if (opts != NULL && fields.NextNumber(10, &freq) && fields.NextNumber(10, &passno)) {
+      e->mnt_fsname = fsname;
+      e->mnt_dir = dir;
+      e->mnt_type = type;
+      e->mnt_opts = opts;
+      e->mnt_freq = freq;
+      e->mnt_passno = passno;
       return e;
     }
   }
@@ -73,91 +73,97 @@ unsigned if_nametoindex(const char* ifname) {
   return (rc == -1) ? 0 : ifr.ifr_ifindex;
 }
 
+// The links as they come in, before we know how many there are.
 struct if_list {
-  if_list* next;
-  struct if_nameindex data;
-
-  explicit if_list(if_list** list) {
-    // push_front onto `list`.
-    next = *list;
-    *list = this;
-  }
-
-  static void Free(if_list* list, bool names_too) {
-    while (list) {
-      if_list* it = list;
-      list = it->next;
-      if (names_too) free(it->data.if_name);
-      free(it);
-    }
-  }
+  struct entry {
+    unsigned index;
+    char name[IFNAMSIZ];
+  };
+
+  entry* entries;
+  size_t count;
+  size_t capacity;
+  size_t names_size;
+  bool failed;
 };
 
 static void __if_nameindex_callback(void* context, nlmsghdr* hdr) {
-  if_list** list = reinterpret_cast<if_list**>(context);
-  if (hdr->nlmsg_type == RTM_NEWLINK) {
+  if_list* list = reinterpret_cast<if_list*>(context);
+  if (hdr->nlmsg_type == RTM_NEWLINK && !list->failed) {
     ifinfomsg* ifi = reinterpret_cast<ifinfomsg*>(NLMSG_DATA(hdr));
 
     // Create a new entry and set the interface index.
-    if_list* new_link = new if_list(list);
-    new_link->data.if_index = ifi->ifi_index;
+    if (list->count == list->capacity) {
+      size_t new_capacity = (list->capacity == 0) ? 16 : list->capacity * 2;
+      if_list::entry* new_entries = reinterpret_cast<if_list::entry*>(
+          realloc(list->entries, new_capacity * sizeof(if_list::entry)));
+      if (new_entries == nullptr) {
+        list->failed = true;
+        return;
+      }
+      list->entries = new_entries;
+      list->capacity = new_capacity;
+    }
+    if_list::entry* new_link = &list->entries[list->count++];
+    new_link->index = ifi->ifi_index;
+    new_link->name[0] = '\0';
 
     // Go through the various bits of information and find the name.
     rtattr* rta = IFLA_RTA(ifi);
     size_t rta_len = IFLA_PAYLOAD(hdr);
     while (RTA_OK(rta, rta_len)) {
       if (rta->rta_type == IFLA_IFNAME) {
-        new_link->data.if_name = strndup(reinterpret_cast<char*>(RTA_DATA(rta)), RTA_PAYLOAD(rta));
+        size_t length = strnlen(reinterpret_cast<char*>(RTA_DATA(rta)), RTA_PAYLOAD(rta));
+        if (length >= sizeof(new_link->name)) length = sizeof(new_link->name) - 1;
+        memcpy(new_link->name, RTA_DATA(rta), length);
+        new_link->name[length] = '\0';
       }
       rta = RTA_NEXT(rta, rta_len);
     }
+    list->names_size += strlen(new_link->name) + 1;
   }
 }
 
 struct if_nameindex* if_nameindex() {
-  if_list* list = nullptr;
+  if_list list;
+  memset(&list, 0, sizeof(list));
 
   // Open the netlink socket and ask for all the links;
   NetlinkConnection nc;
   bool okay = nc.SendRequest(RTM_GETLINK) && nc.ReadResponses(__if_nameindex_callback, &list);
-  if (!okay) {
-    if_list::Free(list, true);
+  if (!okay || list.failed) {
+    if (list.failed) errno = ENOBUFS;
+    free(list.entries);
     return nullptr;
   }
 
-  // Count the interfaces.
-  size_t interface_count = 0;
-  for (if_list* it = list; it != nullptr; it = it->next) {
-    ++interface_count;
-  }
-
-  // Build the array POSIX requires us to return.
-  struct if_nameindex* result = new struct if_nameindex[interface_count + 1];
+  // Build the array POSIX requires us to return, with the names after it in the same
+  // allocation.
+  size_t array_size = (list.count + 1) * sizeof(struct if_nameindex);
+  struct if_nameindex* result =
+      reinterpret_cast<struct if_nameindex*>(malloc(array_size + list.names_size));
   if (result) {
     struct if_nameindex* out = result;
-    for (if_list* it = list; it != nullptr; it = it->next) {
-      out->if_index = it->data.if_index;
-      out->if_name = it->data.if_name;
+    char* names = reinterpret_cast<char*>(result) + array_size;
+    for (size_t i = 0; i < list.count; ++i) {
+      out->if_index = list.entries[i].index;
+      out->if_name = strcpy(names, list.entries[i].name);
+      names += strlen(names) + 1;
       ++out;
     }
     out->if_index = 0;
     out->if_name = nullptr;
+  } else {
+    errno = ENOBUFS;
   }
 
   // Free temporary storage.
-  if_list::Free(list, false);
+  free(list.entries);
 
   return result;
 }
 
 void if_freenameindex(struct if_nameindex* array) {
-  if (array == nullptr) return;
-
-  struct if_nameindex* ptr = array;
-  while (ptr->if_index != 0 || ptr->if_name != nullptr) {
-    free(ptr->if_name);
-    ++ptr;
-  }
-
-  delete[] array;
+  // The names are in the same allocation as the array.
+  free(array);
 }
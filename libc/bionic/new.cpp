@@ -17,6 +17,7 @@
 #include <new>
 
 #include <errno.h>
+#include <malloc.h>
 #include <stdlib.h>
 
 #include "private/libc_logging.h"
@@ -47,6 +48,14 @@ void  operator delete[](void* ptr) throw() {
     free(ptr);
 }
 
+void  operator delete(void* ptr, std::size_t size) throw() {
+    free_sized(ptr, size);
+}
+
+void  operator delete[](void* ptr, std::size_t size) throw() {
+    free_sized(ptr, size);
+}
+
 void* operator new(std::size_t size, const std::nothrow_t&) {
     return malloc(size);
 }
@@ -26,15 +26,19 @@
  * SUCH DAMAGE.
  */
 
+#include "private/bionic_lock.h"
 #include "private/kernel_sigset_t.h"
 
+#include <android/work_pool.h>
 #include <errno.h>
+#include <limits.h>
 #include <malloc.h>
 #include <pthread.h>
 #include <stdatomic.h>
 #include <stdio.h>
 #include <string.h>
 #include <time.h>
+#include <unistd.h>
 
 // System calls.
 extern "C" int __rt_sigtimedwait(const sigset_t*, siginfo_t*, const timespec*, size_t);
@@ -65,6 +69,18 @@ struct PosixTimer {
   void (*callback)(sigval_t);
   sigval_t callback_argument;
   atomic_bool deleted;  // Set when the timer is deleted, to prevent further calling of callback.
+
+  // The fields below are only needed for a shared SIGEV_THREAD timer (see
+  // android_timer_create_shared), and are protected by g_shared_timers_lock.
+  bool shared;
+  PosixTimer* hash_next;
+  // A callback is waiting to be run by the work pool, or will be once the running one returns.
+  bool queued;
+  bool running;
+  // Expirations folded into the queued callback, and what timer_getoverrun reports to the
+  // running one.
+  int pending_overrun;
+  int overrun;
 };
 
 static __kernel_timer_t to_kernel_timer_id(timer_t timer) {
@@ -107,6 +123,145 @@ static void __timer_thread_stop(PosixTimer* timer) {
   pthread_kill(timer->callback_thread, TIMER_SIGNAL);
 }
 
+// Shared SIGEV_THREAD timers all signal a single dispatcher thread, which hands their callbacks
+// to the work pool, so a process with thousands of timers doesn't need thousands of threads.
+// Callbacks for the same timer never run concurrently: expirations that happen while one is
+// waiting or running are folded into the next one, and reported by timer_getoverrun.
+
+static constexpr size_t kSharedTimerBuckets = 256;
+
+struct SharedTimerDispatcher {
+  // The dispatcher thread doesn't survive fork, so a child process starts a new one.
+  pid_t pid;
+  pid_t tid;
+  // Shared timers by kernel timer id, so the dispatcher can find the timer a signal is for.
+  PosixTimer* buckets[kSharedTimerBuckets];
+};
+
+static Lock g_shared_timers_lock;
+static SharedTimerDispatcher g_shared_timers;
+static android_work_group_t g_shared_timer_group = ANDROID_WORK_GROUP_INITIALIZER;
+
+static PosixTimer** __shared_timer_bucket(__kernel_timer_t kernel_timer_id) {
+  return &g_shared_timers.buckets[static_cast<unsigned>(kernel_timer_id) % kSharedTimerBuckets];
+}
+
+static int __add_overrun(int overrun, int n) {
+  return (overrun > INT_MAX - n) ? INT_MAX : overrun + n;
+}
+
+static void __shared_timer_run(void* arg) {
+  PosixTimer* timer = reinterpret_cast<PosixTimer*>(arg);
+
+  g_shared_timers_lock.lock();
+  bool deleted = atomic_load(&timer->deleted);
+  if (!deleted) {
+    timer->queued = false;
+    timer->running = true;
+    timer->overrun = timer->pending_overrun;
+  }
+  g_shared_timers_lock.unlock();
+
+  if (!deleted) {
+    timer->callback(timer->callback_argument);
+
+    g_shared_timers_lock.lock();
+    timer->running = false;
+    deleted = atomic_load(&timer->deleted);
+    bool again = timer->queued && !deleted;
+    g_shared_timers_lock.unlock();
+
+    if (again) {
+      // Go to the back of the queue rather than hogging a worker with a timer that fires faster
+      // than its callback runs.
+      android_work_pool_spawn(&g_shared_timer_group, __shared_timer_run, timer);
+      return;
+    }
+  }
+
+  // timer_delete leaves freeing the timer to us if it had a callback waiting or running.
+  if (deleted) {
+    free(timer);
+  }
+}
+
+static void* __shared_timer_dispatcher_start(void*) {
+  kernel_sigset_t sigset;
+  sigaddset(sigset.get(), TIMER_SIGNAL);
+
+  while (true) {
+    siginfo_t si;
+    memset(&si, 0, sizeof(si));
+    int rc = __rt_sigtimedwait(sigset.get(), &si, NULL, sizeof(sigset));
+    if (rc == -1 || si.si_code != SI_TIMER) {
+      continue;
+    }
+
+    g_shared_timers_lock.lock();
+    // The timer may have been deleted since the kernel queued the signal, and its id (but not
+    // also its address) reused.
+    PosixTimer* timer = *__shared_timer_bucket(si.si_tid);
+    while (timer != NULL && (timer->kernel_timer_id != si.si_tid || timer != si.si_ptr)) {
+      timer = timer->hash_next;
+    }
+    bool spawn = false;
+    if (timer != NULL) {
+      if (timer->queued) {
+        timer->pending_overrun = __add_overrun(timer->pending_overrun, 1 + si.si_overrun);
+      } else {
+        timer->queued = true;
+        timer->pending_overrun = si.si_overrun;
+        // If a callback is running, the worker running it queues the next one.
+        spawn = !timer->running;
+      }
+    }
+    g_shared_timers_lock.unlock();
+
+    if (spawn) {
+      android_work_pool_spawn(&g_shared_timer_group, __shared_timer_run, timer);
+    }
+  }
+  return NULL;
+}
+
+// Returns the dispatcher thread's tid, starting it if necessary, or -1 and sets errno.
+// Called with g_shared_timers_lock held.
+static pid_t __shared_timer_dispatcher_tid() {
+  if (g_shared_timers.pid == getpid()) {
+    return g_shared_timers.tid;
+  }
+
+  // The parent's shared timers weren't inherited, and nothing can refer to them any more
+  // without the kernel rejecting it first.
+  memset(&g_shared_timers, 0, sizeof(g_shared_timers));
+
+  pthread_attr_t thread_attributes;
+  pthread_attr_init(&thread_attributes);
+  pthread_attr_setdetachstate(&thread_attributes, PTHREAD_CREATE_DETACHED);
+
+  // As in timer_create, the thread inherits TIMER_SIGNAL blocked to avoid a race.
+  kernel_sigset_t sigset;
+  sigaddset(sigset.get(), TIMER_SIGNAL);
+  kernel_sigset_t old_sigset;
+  pthread_sigmask(SIG_BLOCK, sigset.get(), old_sigset.get());
+
+  pthread_t thread;
+  int rc = pthread_create(&thread, &thread_attributes, __shared_timer_dispatcher_start, NULL);
+
+  pthread_sigmask(SIG_SETMASK, old_sigset.get(), NULL);
+  pthread_attr_destroy(&thread_attributes);
+
+  if (rc != 0) {
+    errno = rc;
+    return -1;
+  }
+  pthread_setname_np(thread, "POSIX timers");
+
+  g_shared_timers.pid = getpid();
+  g_shared_timers.tid = pthread_gettid_np(thread);
+  return g_shared_timers.tid;
+}
+
 // http://pubs.opengroup.org/onlinepubs/9699919799/functions/timer_create.html
 int timer_create(clockid_t clock_id, sigevent* evp, timer_t* timer_id) {
   PosixTimer* timer = reinterpret_cast<PosixTimer*>(malloc(sizeof(PosixTimer)));
@@ -115,6 +270,7 @@ int timer_create(clockid_t clock_id, sigevent* evp, timer_t* timer_id) {
   }
 
   timer->sigev_notify = (evp == NULL) ? SIGEV_SIGNAL : evp->sigev_notify;
+  timer->shared = false;
 
   // If not a SIGEV_THREAD timer, the kernel can handle it without our help.
   if (timer->sigev_notify != SIGEV_THREAD) {
@@ -184,14 +340,91 @@ int timer_create(clockid_t clock_id, sigevent* evp, timer_t* timer_id) {
   return 0;
 }
 
+int android_timer_create_shared(clockid_t clock_id, sigevent* evp, timer_t* timer_id) {
+  if (evp == NULL || evp->sigev_notify != SIGEV_THREAD) {
+    return timer_create(clock_id, evp, timer_id);
+  }
+
+  // The work pool's threads can't be given the attributes a callback asks for.
+  if (evp->sigev_notify_function == NULL || evp->sigev_notify_attributes != NULL) {
+    errno = EINVAL;
+    return -1;
+  }
+
+  PosixTimer* timer = reinterpret_cast<PosixTimer*>(calloc(1, sizeof(PosixTimer)));
+  if (timer == NULL) {
+    return -1;
+  }
+  timer->sigev_notify = SIGEV_THREAD;
+  timer->callback = evp->sigev_notify_function;
+  timer->callback_argument = evp->sigev_value;
+  atomic_init(&timer->deleted, false);
+  timer->shared = true;
+
+  g_shared_timers_lock.lock();
+  pid_t tid = __shared_timer_dispatcher_tid();
+  if (tid == -1) {
+    g_shared_timers_lock.unlock();
+    free(timer);
+    return -1;
+  }
+
+  sigevent se = *evp;
+  se.sigev_signo = TIMER_SIGNAL;
+  se.sigev_notify = SIGEV_THREAD_ID;
+  se.sigev_notify_thread_id = tid;
+  se.sigev_value.sival_ptr = timer;
+  if (__timer_create(clock_id, &se, &timer->kernel_timer_id) == -1) {
+    g_shared_timers_lock.unlock();
+    free(timer);
+    return -1;
+  }
+
+  PosixTimer** bucket = __shared_timer_bucket(timer->kernel_timer_id);
+  timer->hash_next = *bucket;
+  *bucket = timer;
+  g_shared_timers_lock.unlock();
+
+  *timer_id = timer;
+  return 0;
+}
+
+static int __shared_timer_delete(PosixTimer* timer) {
+  g_shared_timers_lock.lock();
+  // Deleting the kernel timer takes any signal it still has queued back out of the queue, so
+  // once it's gone from the table too, the dispatcher won't queue another callback.
+  if (__timer_delete(timer->kernel_timer_id) == -1) {
+    g_shared_timers_lock.unlock();
+    return -1;
+  }
+  PosixTimer** p = __shared_timer_bucket(timer->kernel_timer_id);
+  while (*p != timer) {
+    p = &(*p)->hash_next;
+  }
+  *p = timer->hash_next;
+  atomic_store(&timer->deleted, true);
+  // If a callback is waiting or running, the worker that has it frees the timer.
+  bool busy = timer->queued || timer->running;
+  g_shared_timers_lock.unlock();
+
+  if (!busy) {
+    free(timer);
+  }
+  return 0;
+}
+
 // http://pubs.opengroup.org/onlinepubs/9699919799/functions/timer_delete.html
 int timer_delete(timer_t id) {
+  PosixTimer* timer = reinterpret_cast<PosixTimer*>(id);
+  if (timer->shared) {
+    return __shared_timer_delete(timer);
+  }
+
   int rc = __timer_delete(to_kernel_timer_id(id));
   if (rc == -1) {
     return -1;
   }
 
-  PosixTimer* timer = reinterpret_cast<PosixTimer*>(id);
   if (timer->sigev_notify == SIGEV_THREAD) {
     // Stopping the timer's thread frees the timer data when it's safe.
     __timer_thread_stop(timer);
@@ -220,5 +453,16 @@ int timer_settime(timer_t id, int flags, const itimerspec* ts, itimerspec* ots)
 
 // http://pubs.opengroup.org/onlinepubs/9699919799/functions/timer_getoverrun.html
 int timer_getoverrun(timer_t id) {
-  return __timer_getoverrun(to_kernel_timer_id(id));
+  int overrun = __timer_getoverrun(to_kernel_timer_id(id));
+  PosixTimer* timer = reinterpret_cast<PosixTimer*>(id);
+  if (overrun == -1 || !timer->shared) {
+    return overrun;
+  }
+
+  // The kernel's count is for the last signal the dispatcher took, which may not be the one
+  // that led to the running callback.
+  g_shared_timers_lock.lock();
+  overrun = timer->overrun;
+  g_shared_timers_lock.unlock();
+  return overrun;
 }
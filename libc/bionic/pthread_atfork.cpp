@@ -31,6 +31,7 @@
 #include <stdlib.h>
 
 #include "private/bionic_macros.h"
+#include "private/bionic_sections.h"
 
 struct atfork_t {
   atfork_t* next;
@@ -110,8 +111,10 @@ class atfork_list_t {
   DISALLOW_COPY_AND_ASSIGN(atfork_list_t);
 };
 
-static pthread_mutex_t g_atfork_list_mutex = PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP;
-static atfork_list_t g_atfork_list;
+// Every fork locks this, and the child resets it.
+static pthread_mutex_t g_atfork_list_mutex __BIONIC_FORK_WRITTEN =
+    PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP;
+static atfork_list_t g_atfork_list __BIONIC_READ_MOSTLY;
 
 void __bionic_atfork_run_prepare() {
   // We lock the atfork list here, unlock it in the parent, and reset it in the child.
@@ -26,12 +26,21 @@
  * SUCH DAMAGE.
  */
 
+#include <limits.h>
+#include <malloc.h>
 #include <pthread.h>
 #include <stdatomic.h>
 #include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include "private/bionic_futex.h"
 
+// A barrierattr has the process-shared flag in bit 0, and the kind in bit 1.
+#define BARRIERATTR_PSHARED_MASK 1
+#define BARRIERATTR_KIND_SHIFT   1
+#define BARRIERATTR_KIND_MASK    2
+
 int pthread_barrierattr_init(pthread_barrierattr_t* attr) {
   *attr = 0;
   return 0;
@@ -43,24 +52,68 @@ int pthread_barrierattr_destroy(pthread_barrierattr_t* attr) {
 }
 
 int pthread_barrierattr_getpshared(const pthread_barrierattr_t* attr, int* pshared) {
-  *pshared = (*attr & 1) ? PTHREAD_PROCESS_SHARED : PTHREAD_PROCESS_PRIVATE;
+  *pshared = (*attr & BARRIERATTR_PSHARED_MASK) ? PTHREAD_PROCESS_SHARED : PTHREAD_PROCESS_PRIVATE;
   return 0;
 }
 
 int pthread_barrierattr_setpshared(pthread_barrierattr_t* attr, int pshared) {
   if (pshared == PTHREAD_PROCESS_SHARED) {
-    *attr |= 1;
+    *attr |= BARRIERATTR_PSHARED_MASK;
   } else {
-    *attr &= ~1;
+    *attr &= ~BARRIERATTR_PSHARED_MASK;
   }
   return 0;
 }
 
+int pthread_barrierattr_getkind_np(const pthread_barrierattr_t* attr, int* kind) {
+  *kind = (*attr & BARRIERATTR_KIND_MASK) >> BARRIERATTR_KIND_SHIFT;
+  return 0;
+}
+
+int pthread_barrierattr_setkind_np(pthread_barrierattr_t* attr, int kind) {
+  switch (kind) {
+    case PTHREAD_BARRIER_DEFAULT_NP:  // Fall through.
+    case PTHREAD_BARRIER_TREE_NP:
+      *attr = (*attr & ~BARRIERATTR_KIND_MASK) | (kind << BARRIERATTR_KIND_SHIFT);
+      return 0;
+    default:
+      return EINVAL;
+  }
+}
+
 enum BarrierState {
   WAIT,
   RELEASE,
 };
 
+// A PTHREAD_BARRIER_TREE_NP barrier gives each of its [init_count] participants a slot on its
+// own cache line. Participants take a position in the cycle as they arrive, and all but the last
+// sleep on their own slot. The last one releases the first TREE_BARRIER_FAN_OUT slots, and each
+// released participant releases TREE_BARRIER_FAN_OUT more, so no single futex word or cache line
+// has to be touched by every participant.
+#define TREE_BARRIER_FAN_OUT 4
+#define TREE_BARRIER_MAX_COUNT 0xffff
+
+// A tree barrier's arrival word holds the cycle in its top 16 bits and the number of threads that
+// have arrived in the cycle in its low 16 bits.
+#define TREE_BARRIER_CYCLE_SHIFT  16
+#define TREE_BARRIER_COUNT_MASK   0xffff
+
+// Set in a slot's release word while its participant is waiting on the futex.
+#define TREE_BARRIER_WAITER_FLAG  0x10000
+
+struct tree_barrier_slot_t {
+  // Low 16 bits: the last cycle this slot was released for, plus one.
+  atomic_uint release;
+  // The last cycle this slot's participant finished, plus one. pthread_barrier_destroy waits
+  // for it, as a participant still releases other slots after its own release.
+  atomic_uint left;
+  char __pad[56];
+} __attribute__((aligned(64)));
+
+// pthread_barrier_t is only 4-byte aligned on 32-bit, so the pointer has to be too.
+typedef tree_barrier_slot_t* tree_barrier_slots_t __attribute__((aligned(4)));
+
 struct pthread_barrier_internal_t {
   // One barrier can be used for unlimited number of cycles. In each cycle, [init_count]
   // threads must call pthread_barrier_wait() before any of them successfully return from
@@ -74,7 +127,16 @@ struct pthread_barrier_internal_t {
   atomic_uint wait_count;
   // Whether the barrier is shared across processes.
   bool pshared;
-  uint32_t __reserved[4];
+  // For a tree barrier, wait_count is the arrival word, and a non-zero state means
+  // pthread_barrier_destroy is waiting for participants to leave.
+  bool tree;
+  // The participants' slots for a tree barrier.
+  tree_barrier_slots_t slots;
+#if defined(__LP64__)
+  uint32_t __reserved[2];
+#else
+  uint32_t __reserved[3];
+#endif
 };
 
 static_assert(sizeof(pthread_barrier_t) == sizeof(pthread_barrier_internal_t),
@@ -98,9 +160,117 @@ int pthread_barrier_init(pthread_barrier_t* barrier_interface, const pthread_bar
   atomic_init(&barrier->state, WAIT);
   atomic_init(&barrier->wait_count, 0);
   barrier->pshared = false;
-  if (attr != nullptr && (*attr & 1)) {
+  barrier->tree = false;
+  barrier->slots = nullptr;
+  if (attr != nullptr && (*attr & BARRIERATTR_PSHARED_MASK)) {
     barrier->pshared = true;
   }
+  if (attr != nullptr &&
+      ((*attr & BARRIERATTR_KIND_MASK) >> BARRIERATTR_KIND_SHIFT) == PTHREAD_BARRIER_TREE_NP) {
+    // The slots live in this process' heap.
+    if (barrier->pshared) {
+      return ENOTSUP;
+    }
+    if (count > TREE_BARRIER_MAX_COUNT) {
+      return EINVAL;
+    }
+    size_t size = sizeof(tree_barrier_slot_t) * count;
+    barrier->slots = static_cast<tree_barrier_slot_t*>(memalign(alignof(tree_barrier_slot_t),
+                                                                size));
+    if (barrier->slots == nullptr) {
+      return ENOMEM;
+    }
+    memset(barrier->slots, 0, size);
+    barrier->tree = true;
+  }
+  return 0;
+}
+
+static inline bool __tree_barrier_released(uint32_t release, uint32_t expected) {
+  // Cycles are compared modulo 2^16.
+  return static_cast<int16_t>(static_cast<uint16_t>(release - expected)) >= 0;
+}
+
+static void __tree_barrier_release(pthread_barrier_internal_t* barrier, uint32_t first,
+                                   uint32_t release) {
+  // The last participant to arrive doesn't need a slot released, it takes position count - 1.
+  uint32_t end = barrier->init_count - 1;
+  for (uint32_t i = first; i < first + TREE_BARRIER_FAN_OUT && i < end; ++i) {
+    // Use release operation here to pass on what the last thread entering the barrier saw.
+    uint32_t old = atomic_exchange_explicit(&barrier->slots[i].release, release,
+                                            memory_order_release);
+    if (old & TREE_BARRIER_WAITER_FLAG) {
+      __futex_wake_ex(&barrier->slots[i].release, false, INT_MAX);
+    }
+  }
+}
+
+static int __tree_barrier_wait(pthread_barrier_internal_t* barrier) {
+  // Use memory_order_acq_rel operation here to synchronize between all threads entering
+  // the barrier with the last thread entering the barrier.
+  uint32_t old_arrival = atomic_load_explicit(&barrier->wait_count, memory_order_relaxed);
+  uint32_t new_arrival;
+  do {
+    if ((old_arrival & TREE_BARRIER_COUNT_MASK) + 1 == barrier->init_count) {
+      new_arrival = ((old_arrival >> TREE_BARRIER_CYCLE_SHIFT) + 1) << TREE_BARRIER_CYCLE_SHIFT;
+    } else {
+      new_arrival = old_arrival + 1;
+    }
+  } while (!atomic_compare_exchange_weak_explicit(&barrier->wait_count, &old_arrival, new_arrival,
+                                                  memory_order_acq_rel, memory_order_relaxed));
+  uint32_t position = old_arrival & TREE_BARRIER_COUNT_MASK;
+  uint32_t release = ((old_arrival >> TREE_BARRIER_CYCLE_SHIFT) + 1) & TREE_BARRIER_COUNT_MASK;
+
+  int result = 0;
+  if (position + 1 == barrier->init_count) {
+    result = PTHREAD_BARRIER_SERIAL_THREAD;
+    __tree_barrier_release(barrier, 0, release);
+  } else {
+    atomic_uint* slot_release = &barrier->slots[position].release;
+    uint32_t value = atomic_load_explicit(slot_release, memory_order_acquire);
+    while (!__tree_barrier_released(value, release)) {
+      if (!(value & TREE_BARRIER_WAITER_FLAG)) {
+        if (!atomic_compare_exchange_weak_explicit(slot_release, &value,
+                                                   value | TREE_BARRIER_WAITER_FLAG,
+                                                   memory_order_relaxed, memory_order_relaxed)) {
+          continue;
+        }
+        value |= TREE_BARRIER_WAITER_FLAG;
+      }
+      __futex_wait_ex(slot_release, false, value, false, nullptr);
+      value = atomic_load_explicit(slot_release, memory_order_acquire);
+    }
+    __tree_barrier_release(barrier, (position + 1) * TREE_BARRIER_FAN_OUT, release);
+  }
+
+  // Let pthread_barrier_destroy know this thread is done with the slots.
+  atomic_uint* slot_left = &barrier->slots[position].left;
+  atomic_store_explicit(slot_left, release, memory_order_release);
+  atomic_thread_fence(memory_order_seq_cst);
+  if (atomic_load_explicit(&barrier->state, memory_order_relaxed) != WAIT) {
+    __futex_wake_ex(slot_left, false, INT_MAX);
+  }
+  return result;
+}
+
+static int __tree_barrier_destroy(pthread_barrier_internal_t* barrier) {
+  uint32_t arrival = atomic_load_explicit(&barrier->wait_count, memory_order_relaxed);
+  if ((arrival & TREE_BARRIER_COUNT_MASK) != 0) {
+    return EBUSY;
+  }
+  // Wait until every participant of the last cycle has left.
+  uint32_t last = (arrival >> TREE_BARRIER_CYCLE_SHIFT) & TREE_BARRIER_COUNT_MASK;
+  atomic_store_explicit(&barrier->state, RELEASE, memory_order_relaxed);
+  atomic_thread_fence(memory_order_seq_cst);
+  for (uint32_t i = 0; i < barrier->init_count; ++i) {
+    uint32_t left;
+    while ((left = atomic_load_explicit(&barrier->slots[i].left, memory_order_acquire)) != last) {
+      __futex_wait_ex(&barrier->slots[i].left, false, left, false, nullptr);
+    }
+  }
+  free(barrier->slots);
+  barrier->slots = nullptr;
+  barrier->init_count = 0;
   return 0;
 }
 
@@ -112,6 +282,9 @@ int pthread_barrier_init(pthread_barrier_t* barrier_interface, const pthread_bar
 // thread entering the barrier with all threads leaving the barrier.
 int pthread_barrier_wait(pthread_barrier_t* barrier_interface) {
   pthread_barrier_internal_t* barrier = __get_internal_barrier(barrier_interface);
+  if (barrier->tree) {
+    return __tree_barrier_wait(barrier);
+  }
 
   // Wait until all threads for the previous cycle have left the barrier. This is needed
   // as a participating thread can call pthread_barrier_wait() again before other
@@ -170,6 +343,9 @@ int pthread_barrier_destroy(pthread_barrier_t* barrier_interface) {
   if (barrier->init_count == 0) {
     return EINVAL;
   }
+  if (barrier->tree) {
+    return __tree_barrier_destroy(barrier);
+  }
   // Use acquire operation here to synchronize with the last thread leaving the barrier.
   // So we can read correct wait_count below.
   while (atomic_load_explicit(&barrier->state, memory_order_acquire) == RELEASE) {
@@ -104,6 +104,11 @@ int pthread_condattr_destroy(pthread_condattr_t* attr) {
   return 0;
 }
 
+#if defined(__LP64__)
+// pthread_cond_t is only guaranteed 4-byte alignment, see below.
+typedef _Atomic(volatile void*) atomic_futex_ptr_t __attribute__((aligned(4)));
+#endif
+
 struct pthread_cond_internal_t {
   atomic_uint state;
 
@@ -116,7 +121,19 @@ struct pthread_cond_internal_t {
   }
 
 #if defined(__LP64__)
-  char __reserved[44];
+  uint32_t __pad;
+  // The futex word of the mutex the waiters are using, if pthread_cond_broadcast can requeue
+  // them onto it. See __pthread_cond_requeue_all.
+  atomic_futex_ptr_t requeue_futex;
+
+  bool can_requeue() {
+    // A pointer can't be accessed atomically unless it's naturally aligned, and there's no
+    // room to move it in a condition variable that isn't.
+    return !process_shared() &&
+        (reinterpret_cast<uintptr_t>(&requeue_futex) % sizeof(void*)) == 0;
+  }
+
+  char __reserved[32];
 #endif
 };
 
@@ -140,6 +157,9 @@ int pthread_cond_init(pthread_cond_t* cond_interface, const pthread_condattr_t*
     init_state = (*attr & COND_FLAGS_MASK);
   }
   atomic_init(&cond->state, init_state);
+#if defined(__LP64__)
+  atomic_init(&cond->requeue_futex, nullptr);
+#endif
 
   return 0;
 }
@@ -170,6 +190,28 @@ static int __pthread_cond_pulse(pthread_cond_internal_t* cond, int thread_count)
   return 0;
 }
 
+#if defined(__LP64__)
+// Waking every waiter on a broadcast only for all but one of them to go straight back to
+// sleep on the mutex is a thundering herd. Instead, when the waiters registered a mutex
+// futex, wake one of them and move the rest onto that futex, so that each mutex unlock
+// wakes the next. The waiters relock the mutex with __pthread_mutex_lock_requeued
+// to keep it contended until the last of them has it.
+static int __pthread_cond_requeue_all(pthread_cond_internal_t* cond) {
+  // The seq_cst ordering pairs with the one in __pthread_cond_timedwait: either the waiter
+  // reads our new state and doesn't sleep, or we read the futex it registered.
+  unsigned int new_state = atomic_fetch_add_explicit(&cond->state, COND_COUNTER_STEP,
+                                                     memory_order_seq_cst) + COND_COUNTER_STEP;
+  volatile void* mutex_futex = atomic_load_explicit(&cond->requeue_futex, memory_order_seq_cst);
+  // If the state has already changed again, FUTEX_CMP_REQUEUE fails with EAGAIN, and we
+  // just wake everyone.
+  if (mutex_futex == nullptr ||
+      __futex_cmp_requeue_ex(&cond->state, false, 1, INT_MAX, mutex_futex, new_state) < 0) {
+    __futex_wake_ex(&cond->state, false, INT_MAX);
+  }
+  return 0;
+}
+#endif
+
 static int __pthread_cond_timedwait(pthread_cond_internal_t* cond, pthread_mutex_t* mutex,
                                     bool use_realtime_clock, const timespec* abs_timeout_or_null) {
   int result = check_timespec(abs_timeout_or_null, true);
@@ -177,11 +219,26 @@ static int __pthread_cond_timedwait(pthread_cond_internal_t* cond, pthread_mutex
     return result;
   }
 
-  unsigned int old_state = atomic_load_explicit(&cond->state, memory_order_relaxed);
+  bool requeue = false;
+#if defined(__LP64__)
+  if (cond->can_requeue()) {
+    volatile void* mutex_futex = __pthread_mutex_requeue_futex(mutex);
+    atomic_store_explicit(&cond->requeue_futex, mutex_futex, memory_order_seq_cst);
+    requeue = (mutex_futex != nullptr);
+  }
+#endif
+
+  unsigned int old_state = atomic_load_explicit(&cond->state,
+                                                requeue ? memory_order_seq_cst
+                                                        : memory_order_relaxed);
   pthread_mutex_unlock(mutex);
   int status = __futex_wait_ex(&cond->state, cond->process_shared(), old_state,
                                use_realtime_clock, abs_timeout_or_null);
-  pthread_mutex_lock(mutex);
+  if (requeue) {
+    __pthread_mutex_lock_requeued(mutex);
+  } else {
+    pthread_mutex_lock(mutex);
+  }
 
   if (status == -ETIMEDOUT) {
     return ETIMEDOUT;
@@ -190,7 +247,13 @@ static int __pthread_cond_timedwait(pthread_cond_internal_t* cond, pthread_mutex
 }
 
 int pthread_cond_broadcast(pthread_cond_t* cond_interface) {
-  return __pthread_cond_pulse(__get_internal_cond(cond_interface), INT_MAX);
+  pthread_cond_internal_t* cond = __get_internal_cond(cond_interface);
+#if defined(__LP64__)
+  if (cond->can_requeue()) {
+    return __pthread_cond_requeue_all(cond);
+  }
+#endif
+  return __pthread_cond_pulse(cond, INT_MAX);
 }
 
 int pthread_cond_signal(pthread_cond_t* cond_interface) {
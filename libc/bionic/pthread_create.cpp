@@ -29,8 +29,10 @@
 #include <pthread.h>
 
 #include <errno.h>
+#include <signal.h>
 #include <string.h>
 #include <sys/mman.h>
+#include <sys/syscall.h>
 #include <unistd.h>
 
 #include "pthread_internal.h"
@@ -63,6 +65,32 @@ void __init_thread_stack_guard(pthread_internal_t* thread) {
   thread->tls[TLS_SLOT_STACK_GUARD] = reinterpret_cast<void*>(__stack_chk_guard);
 }
 
+void __init_rseq(pthread_internal_t* thread) {
+#if defined(BIONIC_RSEQ_SIG)
+  // Older kernels don't have rseq, and we leave the TLS slot null.
+  ErrnoRestorer errno_restorer;
+  if (syscall(__NR_rseq, &thread->rseq, sizeof(thread->rseq), 0, BIONIC_RSEQ_SIG) == 0) {
+    thread->tls[TLS_SLOT_RSEQ] = &thread->rseq;
+  }
+#else
+  (void) thread;
+#endif
+}
+
+void __exit_rseq(pthread_internal_t* thread) {
+#if defined(BIONIC_RSEQ_SIG)
+  // The kernel writes to the area whenever the thread is rescheduled, so it has to be
+  // unregistered before the memory it's in is freed.
+  if (thread->tls[TLS_SLOT_RSEQ] != nullptr) {
+    thread->tls[TLS_SLOT_RSEQ] = nullptr;
+    syscall(__NR_rseq, &thread->rseq, sizeof(thread->rseq), BIONIC_RSEQ_FLAG_UNREGISTER,
+            BIONIC_RSEQ_SIG);
+  }
+#else
+  (void) thread;
+#endif
+}
+
 void __init_alternate_signal_stack(pthread_internal_t* thread) {
   // Create and set an alternate signal stack.
   void* stack_base = mmap(NULL, SIGNAL_STACK_SIZE, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
@@ -145,13 +173,22 @@ static void* __create_thread_mapped_space(size_t mmap_size, size_t stack_guard_s
 static int __allocate_thread(pthread_attr_t* attr, pthread_internal_t** threadp, void** child_stack) {
   size_t mmap_size;
   uint8_t* stack_top;
+  bool needs_clear = false;
 
   if (attr->stack_base == NULL) {
     // The caller didn't provide a stack, so allocate one.
     // Make sure the stack size and guard size are multiples of PAGE_SIZE.
     mmap_size = BIONIC_ALIGN(attr->stack_size + sizeof(pthread_internal_t), PAGE_SIZE);
     attr->guard_size = BIONIC_ALIGN(attr->guard_size, PAGE_SIZE);
-    attr->stack_base = __create_thread_mapped_space(mmap_size, attr->guard_size);
+    attr->stack_base = __thread_stack_cache_get(mmap_size, attr->guard_size);
+    if (attr->stack_base != NULL) {
+      // A cached stack's pages may have kept their old contents.
+      needs_clear = true;
+      __libc_stats_count(LIBC_STAT_THREAD_STACK_CACHE_HITS);
+    } else {
+      attr->stack_base = __create_thread_mapped_space(mmap_size, attr->guard_size);
+      __libc_stats_count(LIBC_STAT_THREAD_STACK_CACHE_MISSES);
+    }
     if (attr->stack_base == NULL) {
       return EAGAIN;
     }
@@ -159,6 +196,8 @@ static int __allocate_thread(pthread_attr_t* attr, pthread_internal_t** threadp,
   } else {
     // Remember the mmap size is zero and we don't need to free it.
     mmap_size = 0;
+    // If thread was not allocated by mmap(), it may not have been cleared to zero.
+    needs_clear = true;
     stack_top = reinterpret_cast<uint8_t*>(attr->stack_base) + attr->stack_size;
   }
 
@@ -166,20 +205,22 @@ static int __allocate_thread(pthread_attr_t* attr, pthread_internal_t** threadp,
   //   pthread_internal_t
   //   thread stack (including guard page)
 
-  // To safely access the pthread_internal_t and thread stack, we need to find a 16-byte aligned boundary.
+  // To safely access the pthread_internal_t and thread stack, we need to find a boundary that's
+  // at least 16-byte aligned; the rseq area inside pthread_internal_t needs more.
   stack_top = reinterpret_cast<uint8_t*>(
-                (reinterpret_cast<uintptr_t>(stack_top) - sizeof(pthread_internal_t)) & ~0xf);
+                (reinterpret_cast<uintptr_t>(stack_top) - sizeof(pthread_internal_t)) &
+                ~(alignof(pthread_internal_t) - 1));
 
   pthread_internal_t* thread = reinterpret_cast<pthread_internal_t*>(stack_top);
-  if (mmap_size == 0) {
-    // If thread was not allocated by mmap(), it may not have been cleared to zero.
-    // So assume the worst and zero it.
+  if (needs_clear) {
+    // Assume the worst and zero it.
     memset(thread, 0, sizeof(pthread_internal_t));
   }
   attr->stack_size = stack_top - reinterpret_cast<uint8_t*>(attr->stack_base);
 
   thread->mmap_size = mmap_size;
   thread->attr = *attr;
+  __thread_stack_profile_paint(thread);
   __init_tls(thread);
   __init_thread_stack_guard(thread);
 
@@ -197,8 +238,14 @@ static int __pthread_start(void* arg) {
   // accesses previously made by the creating thread are visible to us.
   thread->startup_handshake_lock.lock();
 
+  __init_rseq(thread);
   __init_alternate_signal_stack(thread);
 
+  // Created in an android_defer_signals region, we start with the mask it's deferring for.
+  if (thread->signal_defer_depth != 0) {
+    android_defer_signals_end();
+  }
+
   void* result = thread->start_routine(thread->start_routine_arg);
   pthread_exit(result);
 
@@ -216,8 +263,10 @@ int pthread_create(pthread_t* thread_out, pthread_attr_t const* attr,
                    void* (*start_routine)(void*), void* arg) {
   ErrnoRestorer errno_restorer;
 
-  // Inform the rest of the C library that at least one thread was created.
-  __isthreaded = 1;
+  // Inform the rest of the C library that at least one thread was created. This must happen
+  // before the new thread exists: stdio stops skipping its FILE locks when it sees this. Only
+  // the first call writes, so later calls don't race with other threads' reads.
+  if (!__isthreaded) __isthreaded = 1;
 
   pthread_attr_t thread_attr;
   if (attr == NULL) {
@@ -246,6 +295,12 @@ int pthread_create(pthread_t* thread_out, pthread_attr_t const* attr,
   thread->start_routine = start_routine;
   thread->start_routine_arg = arg;
 
+  pthread_internal_t* self = __get_thread();
+  if (self->signal_defer_depth != 0) {
+    thread->signal_defer_depth = 1;
+    thread->signal_defer_mask = self->signal_defer_mask;
+  }
+
   thread->set_cached_pid(getpid());
 
   int flags = CLONE_VM | CLONE_FS | CLONE_FILES | CLONE_SIGHAND | CLONE_THREAD | CLONE_SYSVSEM |
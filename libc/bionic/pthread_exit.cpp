@@ -33,6 +33,8 @@
 #include <string.h>
 #include <sys/mman.h>
 
+#include "private/bionic_elf_tls.h"
+#include "private/bionic_systrace.h"
 #include "pthread_internal.h"
 
 extern "C" __noreturn void _exit_with_stack_teardown(void*, size_t);
@@ -80,6 +82,25 @@ void pthread_exit(void* return_value) {
   // space (see pthread_key_delete).
   pthread_key_clean_all();
 
+  // The destructors above were the last code that could use this thread's ELF TLS blocks.
+  __free_dynamic_tls();
+
+  // Nothing this thread traces from here on is buffered.
+  __bionic_systrace_thread_exit();
+
+  // Anything after this that wants random numbers uses the shared arc4random state.
+  __arc4random_thread_exit(thread);
+
+  // And anything that wants scratch memory gets it from malloc.
+  __bionic_scratch_thread_exit(thread);
+
+  // The stack is about to be unmapped or cached.
+  __thread_stack_profile_report(thread);
+
+  // Our pthread_internal_t may be unmapped or reused below.
+  __exit_rseq(thread);
+  __exit_thread_cputime(thread);
+
   if (thread->alternate_signal_stack != NULL) {
     // Tell the kernel to stop using the alternate signal stack.
     stack_t ss;
@@ -92,6 +113,10 @@ void pthread_exit(void* return_value) {
     thread->alternate_signal_stack = NULL;
   }
 
+  // The system calls from here on aren't counted, and once we've said we've exited, our
+  // pthread_internal_t may be freed by pthread_join.
+  __syscall_stats_thread_exit(thread);
+
   ThreadJoinState old_state = THREAD_NOT_JOINED;
   while (old_state == THREAD_NOT_JOINED &&
          !atomic_compare_exchange_weak(&thread->join_state, &old_state, THREAD_EXITED_NOT_JOINED)) {
@@ -117,6 +142,13 @@ void pthread_exit(void* return_value) {
       sigfillset(&mask);
       sigprocmask(SIG_SETMASK, &mask, NULL);
 
+      // If the stack can be cached instead, the kernel tells the cache when we're off it.
+      volatile int* tid_address = __thread_stack_cache_put_exiting(thread);
+      if (tid_address != NULL) {
+        __set_tid_address(const_cast<int*>(tid_address));
+        __exit(0);
+      }
+
       _exit_with_stack_teardown(thread->attr.stack_base, thread->mmap_size);
     }
   }
@@ -32,14 +32,56 @@
 #include <stdlib.h>
 #include <string.h>
 #include <sys/mman.h>
+#include <sys/prctl.h>
+#include <sys/resource.h>
 
 #include "private/bionic_futex.h"
+#include "private/bionic_lock.h"
+#include "private/bionic_macros.h"
+#include "private/bionic_sections.h"
 #include "private/bionic_tls.h"
 #include "private/libc_logging.h"
 #include "private/ScopedPthreadMutexLocker.h"
 
-static pthread_internal_t* g_thread_list = NULL;
-static pthread_mutex_t g_thread_list_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_internal_t* g_thread_list __BIONIC_FORK_WRITTEN = NULL;
+static pthread_mutex_t g_thread_list_lock __BIONIC_FORK_WRITTEN = PTHREAD_MUTEX_INITIALIZER;
+
+// Checking a pthread_t with g_thread_list would take the global lock and walk every thread, so
+// __pthread_internal_find uses this hash table of live threads instead. Each bucket has its
+// own lock, so lookups of different threads rarely contend, and chains stay short.
+#define THREAD_FIND_BUCKET_COUNT 1024
+
+struct thread_find_bucket_t {
+  Lock lock;
+  pthread_internal_t* head;
+};
+
+// Left in .bss: it's 16KiB, which would all go in the file, and only pages with a bucket in use
+// are ever written.
+static thread_find_bucket_t g_thread_find_buckets[THREAD_FIND_BUCKET_COUNT];
+
+static thread_find_bucket_t& __thread_find_bucket(pthread_internal_t* thread) {
+  // pthread_internal_t sits at the same offset below the top of every default-sized stack,
+  // so the low bits of its address are all alike. Shift those out and mix the rest.
+  uintptr_t hash = (reinterpret_cast<uintptr_t>(thread) >> 4) * 2654435761u;
+  return g_thread_find_buckets[(hash >> 12) % THREAD_FIND_BUCKET_COUNT];
+}
+
+// The combined malloc_stats and libc_stats of the threads removed from g_thread_list.
+static malloc_thread_stats g_exited_thread_malloc_stats __BIONIC_FORK_WRITTEN;
+static libc_thread_stats g_exited_thread_libc_stats __BIONIC_FORK_WRITTEN;
+
+// Adds src to dst, reading src with relaxed loads, since its thread may still be writing it.
+static void __add_libc_stats(libc_thread_stats& dst, const libc_thread_stats& src) {
+  for (size_t i = 0; i < LIBC_STAT_COUNTER_COUNT; i++) {
+    dst.counters[i] += __atomic_load_n(&src.counters[i], __ATOMIC_RELAXED);
+  }
+  for (size_t i = 0; i < LIBC_STAT_HISTOGRAM_COUNT; i++) {
+    for (size_t j = 0; j < LIBC_STAT_HISTOGRAM_BUCKETS; j++) {
+      dst.histograms[i][j] += __atomic_load_n(&src.histograms[i][j], __ATOMIC_RELAXED);
+    }
+  }
+}
 
 pthread_t __pthread_internal_add(pthread_internal_t* thread) {
   ScopedPthreadMutexLocker locker(&g_thread_list_lock);
@@ -51,12 +93,28 @@ pthread_t __pthread_internal_add(pthread_internal_t* thread) {
     thread->next->prev = thread;
   }
   g_thread_list = thread;
+
+  thread_find_bucket_t& bucket = __thread_find_bucket(thread);
+  bucket.lock.lock();
+  thread->find_next = bucket.head;
+  bucket.head = thread;
+  bucket.lock.unlock();
   return reinterpret_cast<pthread_t>(thread);
 }
 
 void __pthread_internal_remove(pthread_internal_t* thread) {
   ScopedPthreadMutexLocker locker(&g_thread_list_lock);
 
+  malloc_thread_stats& exited = g_exited_thread_malloc_stats;
+  exited.allocated_bytes += thread->malloc_stats.allocated_bytes;
+  exited.freed_bytes += thread->malloc_stats.freed_bytes;
+  exited.allocation_calls += thread->malloc_stats.allocation_calls;
+  exited.free_calls += thread->malloc_stats.free_calls;
+  for (size_t i = 0; i < MALLOC_THREAD_STATS_SIZE_CLASSES; i++) {
+    exited.size_class_calls[i] += thread->malloc_stats.size_class_calls[i];
+  }
+  __add_libc_stats(g_exited_thread_libc_stats, thread->libc_stats);
+
   if (thread->next != NULL) {
     thread->next->prev = thread->prev;
   }
@@ -65,10 +123,229 @@ void __pthread_internal_remove(pthread_internal_t* thread) {
   } else {
     g_thread_list = thread->next;
   }
+
+  thread_find_bucket_t& bucket = __thread_find_bucket(thread);
+  bucket.lock.lock();
+  for (pthread_internal_t** p = &bucket.head; *p != NULL; p = &(*p)->find_next) {
+    if (*p == thread) {
+      *p = thread->find_next;
+      break;
+    }
+  }
+  bucket.lock.unlock();
+}
+
+// Exited threads leave their default-sized stacks here for pthread_create to reuse, which saves
+// the mmap, mprotect and munmap (with its TLB shootdown) of a new stack for every thread.
+#define THREAD_STACK_CACHE_MAX_SIZE 64
+#define THREAD_STACK_CACHE_DEFAULT_SIZE 8
+
+struct thread_stack_cache_entry_t {
+  void* stack_base;  // NULL if the entry is empty.
+  // Non-zero while the stack can't be reused yet. A detached thread that is still exiting on
+  // the stack stores its tid here, and the kernel clears it when the thread is gone.
+  volatile int busy_tid;
+};
+
+// Entries never move, as the kernel may be about to clear their busy_tid.
+static thread_stack_cache_entry_t g_thread_stack_cache[THREAD_STACK_CACHE_MAX_SIZE]
+    __BIONIC_FORK_WRITTEN;
+static size_t g_thread_stack_cache_size __BIONIC_READ_MOSTLY = THREAD_STACK_CACHE_DEFAULT_SIZE;
+static Lock g_thread_stack_cache_lock __BIONIC_FORK_WRITTEN;
+
+void __pthread_internal_init_stack_cache() {
+  // LIBC_THREAD_STACK_CACHE_SIZE sets how many stacks are kept, 0 disables the cache.
+  const char* value = getenv("LIBC_THREAD_STACK_CACHE_SIZE");
+  if (value != nullptr && *value != '\0') {
+    char* end;
+    unsigned long size = strtoul(value, &end, 10);
+    if (*end == '\0') {
+      g_thread_stack_cache_size = (size < THREAD_STACK_CACHE_MAX_SIZE) ? size
+                                                                       : THREAD_STACK_CACHE_MAX_SIZE;
+    }
+  }
+}
+
+// LIBC_THREAD_STACK_PROFILE=mincore or LIBC_THREAD_STACK_PROFILE=paint has every thread whose
+// stack we allocated log how deep its stack got when it exits, to help choose stack sizes.
+// mincore finds the lowest page of the stack that's resident, which costs nothing until exit
+// but only has page granularity, and can't see pages that have been swapped out. paint fills
+// the stack with a pattern when the thread is created and looks for the lowest word that was
+// overwritten, which is exact but makes the whole stack resident.
+enum thread_stack_profile_t {
+  THREAD_STACK_PROFILE_NONE,
+  THREAD_STACK_PROFILE_MINCORE,
+  THREAD_STACK_PROFILE_PAINT,
+};
+
+static thread_stack_profile_t g_thread_stack_profile __BIONIC_READ_MOSTLY =
+    THREAD_STACK_PROFILE_NONE;
+
+void __pthread_internal_init_stack_profile() {
+  const char* value = getenv("LIBC_THREAD_STACK_PROFILE");
+  if (value == nullptr) {
+    return;
+  }
+  if (strcmp(value, "mincore") == 0) {
+    g_thread_stack_profile = THREAD_STACK_PROFILE_MINCORE;
+  } else if (strcmp(value, "paint") == 0) {
+    g_thread_stack_profile = THREAD_STACK_PROFILE_PAINT;
+  }
+}
+
+static bool __is_cacheable_stack(size_t mmap_size, size_t guard_size) {
+  return mmap_size == BIONIC_ALIGN(PTHREAD_STACK_SIZE_DEFAULT + sizeof(pthread_internal_t),
+                                   PAGE_SIZE) &&
+         guard_size == PAGE_SIZE;
+}
+
+// Returns an empty entry holding stack_base, which stays busy until the caller clears busy_tid.
+static thread_stack_cache_entry_t* __thread_stack_cache_reserve(void* stack_base, int busy_tid) {
+  thread_stack_cache_entry_t* result = nullptr;
+  g_thread_stack_cache_lock.lock();
+  for (size_t i = 0; i < g_thread_stack_cache_size; ++i) {
+    if (g_thread_stack_cache[i].stack_base == nullptr) {
+      result = &g_thread_stack_cache[i];
+      result->stack_base = stack_base;
+      result->busy_tid = busy_tid;
+      break;
+    }
+  }
+  g_thread_stack_cache_lock.unlock();
+  return result;
+}
+
+static void __release_stack_pages(uintptr_t start, uintptr_t end) {
+  if (start >= end) {
+    return;
+  }
+  // mincore still counts MADV_FREE pages until they're reclaimed, which would make the next
+  // thread on the stack look as deep as this one.
+  if (g_thread_stack_profile == THREAD_STACK_PROFILE_MINCORE) {
+    madvise(reinterpret_cast<void*>(start), end - start, MADV_DONTNEED);
+    return;
+  }
+  // MADV_FREE only takes the pages back under memory pressure, which makes reuse cheaper,
+  // but it needs Linux 4.5.
+  if (madvise(reinterpret_cast<void*>(start), end - start, MADV_FREE) == -1) {
+    madvise(reinterpret_cast<void*>(start), end - start, MADV_DONTNEED);
+  }
+}
+
+void* __thread_stack_cache_get(size_t mmap_size, size_t guard_size) {
+  if (!__is_cacheable_stack(mmap_size, guard_size)) {
+    return nullptr;
+  }
+  void* result = nullptr;
+  g_thread_stack_cache_lock.lock();
+  for (size_t i = 0; i < g_thread_stack_cache_size; ++i) {
+    thread_stack_cache_entry_t& entry = g_thread_stack_cache[i];
+    if (entry.stack_base != nullptr && entry.busy_tid == 0) {
+      result = entry.stack_base;
+      entry.stack_base = nullptr;
+      break;
+    }
+  }
+  g_thread_stack_cache_lock.unlock();
+  return result;
+}
+
+volatile int* __thread_stack_cache_put_exiting(pthread_internal_t* thread) {
+  if (!__is_cacheable_stack(thread->mmap_size, thread->attr.guard_size)) {
+    return nullptr;
+  }
+  thread_stack_cache_entry_t* entry = __thread_stack_cache_reserve(thread->attr.stack_base,
+                                                                   thread->tid);
+  if (entry == nullptr) {
+    return nullptr;
+  }
+  // This thread still runs on the top of the stack, so only release what is well below us.
+  uintptr_t stack_low = reinterpret_cast<uintptr_t>(thread->attr.stack_base) + PAGE_SIZE;
+  uintptr_t frame = reinterpret_cast<uintptr_t>(__builtin_frame_address(0));
+  __release_stack_pages(stack_low, (frame & ~(PAGE_SIZE - 1)) - PAGE_SIZE);
+  return &entry->busy_tid;
+}
+
+// A pattern that's unlikely to be a pointer, a small integer, or zeroed memory.
+static constexpr uintptr_t kStackPaint = static_cast<uintptr_t>(0xa5c3e1f0a5c3e1f0ULL);
+
+// The stack proper runs from above the guard region up to the pthread_internal_t.
+static uintptr_t __thread_stack_low(pthread_internal_t* thread) {
+  return reinterpret_cast<uintptr_t>(thread->attr.stack_base) + thread->attr.guard_size;
+}
+
+void __thread_stack_profile_paint(pthread_internal_t* thread) {
+  if (g_thread_stack_profile != THREAD_STACK_PROFILE_PAINT || thread->mmap_size == 0) {
+    return;
+  }
+  uintptr_t* p = reinterpret_cast<uintptr_t*>(__thread_stack_low(thread));
+  uintptr_t* end = reinterpret_cast<uintptr_t*>(thread);
+  while (p < end) {
+    *p++ = kStackPaint;
+  }
+}
+
+// Returns the lowest address that looks like it's been used, or the top of the stack.
+static uintptr_t __thread_stack_find_low_water(pthread_internal_t* thread) {
+  uintptr_t low = __thread_stack_low(thread);
+  uintptr_t high = reinterpret_cast<uintptr_t>(thread);
+  if (g_thread_stack_profile == THREAD_STACK_PROFILE_PAINT) {
+    const uintptr_t* p = reinterpret_cast<const uintptr_t*>(low);
+    while (reinterpret_cast<uintptr_t>(p) < high && *p == kStackPaint) {
+      ++p;
+    }
+    return reinterpret_cast<uintptr_t>(p);
+  }
+
+  // The stack proper is page-aligned at the bottom, and the page holding the
+  // pthread_internal_t is in use anyway.
+  unsigned char vec[256];
+  for (uintptr_t page = low; page < high; page += sizeof(vec) * PAGE_SIZE) {
+    size_t count = (high - page + PAGE_SIZE - 1) / PAGE_SIZE;
+    if (count > sizeof(vec)) {
+      count = sizeof(vec);
+    }
+    if (mincore(reinterpret_cast<void*>(page), count * PAGE_SIZE, vec) == -1) {
+      return high;
+    }
+    for (size_t i = 0; i < count; ++i) {
+      if (vec[i] & 1) {
+        return page + i * PAGE_SIZE;
+      }
+    }
+  }
+  return high;
+}
+
+void __thread_stack_profile_report(pthread_internal_t* thread) {
+  if (g_thread_stack_profile == THREAD_STACK_PROFILE_NONE || thread->mmap_size == 0) {
+    return;
+  }
+  uintptr_t high = reinterpret_cast<uintptr_t>(thread);
+  size_t used = high - __thread_stack_find_low_water(thread);
+  size_t size = high - __thread_stack_low(thread);
+
+  char name[16] = {};
+  prctl(PR_GET_NAME, name);
+  rusage usage = {};
+  getrusage(RUSAGE_THREAD, &usage);
+  __libc_format_log(ANDROID_LOG_INFO, "libc",
+                    "thread \"%s\" (tid %d) used %zu of its %zu-byte stack, %ld minor page faults",
+                    name, thread->tid, used, size, usage.ru_minflt);
 }
 
 static void __pthread_internal_free(pthread_internal_t* thread) {
   if (thread->mmap_size != 0) {
+    if (__is_cacheable_stack(thread->mmap_size, thread->attr.guard_size)) {
+      thread_stack_cache_entry_t* entry = __thread_stack_cache_reserve(thread->attr.stack_base,
+                                                                       -1);
+      if (entry != nullptr) {
+        uintptr_t stack_base = reinterpret_cast<uintptr_t>(thread->attr.stack_base);
+        __release_stack_pages(stack_base + PAGE_SIZE, stack_base + thread->mmap_size);
+        entry->busy_tid = 0;
+        return;
+      }
+    }
     // Free mapped space, including thread stack and pthread_internal_t.
     munmap(thread->attr.stack_base, thread->mmap_size);
   }
@@ -87,12 +364,66 @@ pthread_internal_t* __pthread_internal_find(pthread_t thread_id) {
     return thread;
   }
 
+  // Only compare the pointers in the bucket: an invalid pthread_t may point to unmapped memory.
+  thread_find_bucket_t& bucket = __thread_find_bucket(thread);
+  pthread_internal_t* result = NULL;
+  bucket.lock.lock();
+  for (pthread_internal_t* t = bucket.head; t != NULL; t = t->find_next) {
+    if (t == thread) {
+      result = thread;
+      break;
+    }
+  }
+  bucket.lock.unlock();
+  return result;
+}
+
+int malloc_iterate_thread_stats(void (*callback)(const malloc_thread_stats*, void*), void* arg) {
   ScopedPthreadMutexLocker locker(&g_thread_list_lock);
 
   for (pthread_internal_t* t = g_thread_list; t != NULL; t = t->next) {
-    if (t == thread) {
-      return thread;
-    }
+    malloc_thread_stats stats = t->malloc_stats;
+    stats.tid = t->tid;
+    callback(&stats, arg);
+  }
+  callback(&g_exited_thread_malloc_stats, arg);
+  return 0;
+}
+
+size_t __pthread_internal_libc_stats(libc_thread_stats* total) {
+  ScopedPthreadMutexLocker locker(&g_thread_list_lock);
+
+  *total = g_exited_thread_libc_stats;
+  size_t threads = 0;
+  for (pthread_internal_t* t = g_thread_list; t != NULL; t = t->next) {
+    __add_libc_stats(*total, t->libc_stats);
+    ++threads;
+  }
+  return threads;
+}
+
+// A plain load and store rather than an atomic add: no other thread writes these.
+static inline void __libc_stats_add(uint64_t* counter) {
+  __atomic_store_n(counter, __atomic_load_n(counter, __ATOMIC_RELAXED) + 1, __ATOMIC_RELAXED);
+}
+
+void __libc_stats_count(libc_stat_counter counter) {
+  pthread_internal_t* thread = __get_thread();
+  if (__predict_false(thread == nullptr)) {
+    return;
+  }
+  __libc_stats_add(&thread->libc_stats.counters[counter]);
+}
+
+void __libc_stats_sample(libc_stat_histogram histogram, uint64_t value) {
+  pthread_internal_t* thread = __get_thread();
+  if (__predict_false(thread == nullptr)) {
+    return;
+  }
+  // Bucket i holds the values below 4^i, which have at most 2 * i significant bits.
+  size_t bucket = (value == 0) ? 0 : (64 - __builtin_clzll(value) + 1) / 2;
+  if (bucket >= LIBC_STAT_HISTOGRAM_BUCKETS) {
+    bucket = LIBC_STAT_HISTOGRAM_BUCKETS - 1;
   }
-  return NULL;
+  __libc_stats_add(&thread->libc_stats.histograms[histogram][bucket]);
 }
@@ -28,11 +28,16 @@
 #ifndef _PTHREAD_INTERNAL_H_
 #define _PTHREAD_INTERNAL_H_
 
+#include <malloc.h>
 #include <pthread.h>
 #include <stdatomic.h>
+#include <xlocale.h>
 
 #include "private/bionic_lock.h"
+#include "private/bionic_rseq.h"
+#include "private/bionic_stats.h"
 #include "private/bionic_tls.h"
+#include "private/kernel_sigset_t.h"
 
 /* Has the thread been detached by a pthread_join or pthread_detach call? */
 #define PTHREAD_ATTR_FLAG_DETACHED 0x00000001
@@ -46,6 +51,14 @@ class pthread_key_data_t {
   void* data;
 };
 
+#define PTHREAD_KEY_IN_USE_WORDS(n) (((n) + 31) / 32)
+
+// A thread's data for one page of the pthread keys past BIONIC_PTHREAD_KEY_COUNT.
+struct pthread_key_data_page_t {
+  uint32_t in_use[PTHREAD_KEY_IN_USE_WORDS(BIONIC_PTHREAD_KEY_PAGE_KEYS)];
+  pthread_key_data_t data[BIONIC_PTHREAD_KEY_PAGE_KEYS];
+};
+
 enum ThreadJoinState {
   THREAD_NOT_JOINED,
   THREAD_EXITED_NOT_JOINED,
@@ -53,7 +66,12 @@ enum ThreadJoinState {
   THREAD_DETACHED
 };
 
+struct arc4random_state;
+struct bionic_scratch;
+struct bionic_trace_buffer;
+struct syscall_stats_table;
 class thread_local_dtor;
+class WorkPoolWorker;
 
 class pthread_internal_t {
  public:
@@ -104,6 +122,67 @@ class pthread_internal_t {
 
   pthread_key_data_t key_data[BIONIC_PTHREAD_KEY_COUNT];
 
+  // Each bit is set while the matching key_data has non-NULL data, so that thread exit only
+  // visits those.
+  uint32_t key_data_in_use[PTHREAD_KEY_IN_USE_WORDS(BIONIC_PTHREAD_KEY_COUNT)];
+
+  // Mapped the first time this thread sets a key in the page, and unmapped at thread exit.
+  pthread_key_data_page_t* key_data_pages[BIONIC_PTHREAD_KEY_PAGE_COUNT];
+
+  // Only written by this thread, from malloc_common.cpp. The tid is unused.
+  malloc_thread_stats malloc_stats;
+
+  // Allocations left before the malloc sampler takes one, see malloc_sampler.h.
+  size_t malloc_sample_countdown;
+
+  // Only written by this thread, through __libc_stats_count and __libc_stats_sample.
+  libc_thread_stats libc_stats;
+
+  // Next thread in the same bucket of the table __pthread_internal_find looks threads up in.
+  class pthread_internal_t* find_next;
+
+  // Set on the worker threads of the process-wide pool in work_pool.cpp.
+  WorkPoolWorker* work_pool_worker;
+
+  // Registered with the kernel by the thread itself, see __init_rseq.
+  bionic_rseq rseq;
+
+  // Systrace markers waiting to be written, when they're being buffered; mapped by
+  // bionic_systrace.cpp the first time it's needed, and unmapped at thread exit.
+  bionic_trace_buffer* trace_buffer;
+
+  // This thread's arc4random generator, mapped by arc4random.cpp the first time it's needed, and
+  // unmapped at thread exit.
+  arc4random_state* arc4random;
+
+  // This thread's scratch arena (see private/bionic_scratch.h), mapped by bionic_scratch.cpp the
+  // first time it's needed, and unmapped at thread exit.
+  bionic_scratch* scratch;
+
+  // This thread's system call counts, in libc_syscall_stats.so; mapped by syscall_stats.cpp the
+  // first time it's needed, and unmapped at thread exit.
+  syscall_stats_table* syscall_stats;
+
+  // The perf event android_thread_cputime_enable_fast_path set up for this thread, if any.
+  struct {
+    void* page;
+    int fd;
+    int64_t base_ns;
+  } cputime;
+
+  // Nesting depth of android_defer_signals_begin calls. While it's non-zero, the kernel blocks
+  // every signal but the synchronous ones for this thread, and signal_defer_mask is the mask
+  // sigprocmask reports and changes instead, which android_defer_signals_end restores.
+  int signal_defer_depth;
+  kernel_sigset_t signal_defer_mask;
+
+  // The locale uselocale(3) set for this thread, or null for LC_GLOBAL_LOCALE. Kept here rather
+  // than in a pthread key because MB_CUR_MAX reads it, once per character in some loops.
+  locale_t locale;
+
+  // Contended mutex unlocks since this thread last woke a waiter regardless of its NUMA node.
+  uint32_t mutex_numa_local_wakes;
+
   /*
    * The dynamic linker implements dlerror(3), which makes it hard for us to implement this
    * per-thread buffer by simply using malloc(3) and free(3).
@@ -116,11 +195,43 @@ __LIBC_HIDDEN__ int __init_thread(pthread_internal_t* thread);
 __LIBC_HIDDEN__ void __init_tls(pthread_internal_t* thread);
 __LIBC_HIDDEN__ void __init_thread_stack_guard(pthread_internal_t* thread);
 __LIBC_HIDDEN__ void __init_alternate_signal_stack(pthread_internal_t*);
+// These must be called on the thread itself.
+__LIBC_HIDDEN__ void __init_rseq(pthread_internal_t* thread);
+__LIBC_HIDDEN__ void __exit_rseq(pthread_internal_t* thread);
+// Reads the thread's CPU time via its perf event, returning false if it can't.
+__LIBC_HIDDEN__ bool __read_thread_cputime(pthread_internal_t* thread, timespec* ts);
+__LIBC_HIDDEN__ void __exit_thread_cputime(pthread_internal_t* thread);
+__LIBC_HIDDEN__ void __arc4random_thread_exit(pthread_internal_t* thread);
+__LIBC_HIDDEN__ void __bionic_scratch_thread_exit(pthread_internal_t* thread);
+__LIBC_HIDDEN__ void __syscall_stats_thread_exit(pthread_internal_t* thread);
+__LIBC_HIDDEN__ void __syscall_stats_fork_child(pthread_internal_t* self);
+__LIBC_HIDDEN__ void __pthread_mutex_init_adaptive_default();
+__LIBC_HIDDEN__ void __pthread_mutex_init_numa_wake();
+// Returns the futex word pthread_cond_broadcast can requeue waiters for this mutex onto, or null
+// if it's not a mutex those waiters can safely sleep on. The caller must hold the mutex.
+__LIBC_HIDDEN__ volatile void* __pthread_mutex_requeue_futex(pthread_mutex_t* mutex);
+// Locks a mutex whose waiters may have been requeued onto it, leaving it contended so that
+// they'll be woken in turn.
+__LIBC_HIDDEN__ void __pthread_mutex_lock_requeued(pthread_mutex_t* mutex);
+__LIBC_HIDDEN__ void __pthread_internal_init_stack_cache();
+__LIBC_HIDDEN__ void __pthread_internal_init_stack_profile();
 
 __LIBC_HIDDEN__ pthread_t           __pthread_internal_add(pthread_internal_t* thread);
 __LIBC_HIDDEN__ pthread_internal_t* __pthread_internal_find(pthread_t pthread_id);
 __LIBC_HIDDEN__ void                __pthread_internal_remove(pthread_internal_t* thread);
 __LIBC_HIDDEN__ void                __pthread_internal_remove_and_free(pthread_internal_t* thread);
+// Adds up the libc_stats of every thread, exited or not, and returns the number of live threads.
+__LIBC_HIDDEN__ size_t              __pthread_internal_libc_stats(libc_thread_stats* total);
+
+// Returns a cached thread stack of the given size, or NULL.
+__LIBC_HIDDEN__ void* __thread_stack_cache_get(size_t mmap_size, size_t guard_size);
+// Caches the stack of the exiting detached thread. If that succeeded, the returned tid address
+// must be passed to set_tid_address before the thread exits.
+__LIBC_HIDDEN__ volatile int* __thread_stack_cache_put_exiting(pthread_internal_t* thread);
+// With LIBC_THREAD_STACK_PROFILE set, prepare a new thread's stack for measurement, and log
+// how much of its stack an exiting thread used.
+__LIBC_HIDDEN__ void __thread_stack_profile_paint(pthread_internal_t* thread);
+__LIBC_HIDDEN__ void __thread_stack_profile_report(pthread_internal_t* thread);
 
 // Make __get_thread() inlined for performance reason. See http://b/19825434.
 static inline __always_inline pthread_internal_t* __get_thread() {
@@ -25,11 +25,12 @@
  * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
  * SUCH DAMAGE.
  */
-
 #include <errno.h>
 #include <pthread.h>
 #include <stdatomic.h>
+#include <sys/mman.h>
 
+#include "private/bionic_lock.h"
 #include "private/bionic_tls.h"
 #include "pthread_internal.h"
 
@@ -53,6 +54,12 @@ struct pthread_key_internal_t {
 
 static pthread_key_internal_t key_map[BIONIC_PTHREAD_KEY_COUNT];
 
+// Keys past BIONIC_PTHREAD_KEY_COUNT are only needed by processes that use a lot of them, so
+// their slots are mapped one page at a time once all the keys before them are used. Pages are
+// never unmapped, and key_map_pages_lock serializes mapping them.
+static _Atomic(pthread_key_internal_t*) key_map_pages[BIONIC_PTHREAD_KEY_PAGE_COUNT];
+static Lock key_map_pages_lock;
+
 static inline bool SeqOfKeyInUse(uintptr_t seq) {
   return seq & (1 << SEQ_KEY_IN_USE_BIT);
 }
@@ -68,43 +75,102 @@ static inline bool KeyInValidRange(pthread_key_t key) {
   return (key < (KEY_VALID_FLAG | BIONIC_PTHREAD_KEY_COUNT));
 }
 
+static inline bool KeyInValidExtraRange(pthread_key_t key) {
+  return (key >= (KEY_VALID_FLAG | BIONIC_PTHREAD_KEY_COUNT) &&
+          key < (KEY_VALID_FLAG | (BIONIC_PTHREAD_KEY_COUNT + BIONIC_PTHREAD_KEY_EXTRA_COUNT)));
+}
+
+static void* MapPage(size_t size) {
+  void* result = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  return (result == MAP_FAILED) ? NULL : result;
+}
+
+// Returns the slot of the key with the given index past BIONIC_PTHREAD_KEY_COUNT, or NULL if
+// no key was ever created in its page.
+static pthread_key_internal_t* ExtraKeyInternal(size_t extra_index) {
+  pthread_key_internal_t* page = atomic_load_explicit(
+      &key_map_pages[extra_index / BIONIC_PTHREAD_KEY_PAGE_KEYS], memory_order_acquire);
+  return (page == NULL) ? NULL : &page[extra_index % BIONIC_PTHREAD_KEY_PAGE_KEYS];
+}
+
+static inline void SetKeyDataInUse(uint32_t* in_use, size_t index, const void* data) {
+  uint32_t bit = 1u << (index % 32);
+  in_use[index / 32] = (in_use[index / 32] & ~bit) | ((data != NULL) ? bit : 0);
+}
+
+// Calls the destructor of the key in key_map_entry for data, if the data is current.
+// Returns true if a destructor was called.
+static bool CallKeyDestructor(pthread_key_internal_t* key_map_entry, pthread_key_data_t* data,
+                              uint32_t* in_use, size_t index) {
+  uintptr_t seq = atomic_load_explicit(&key_map_entry->seq, memory_order_relaxed);
+  if (!SeqOfKeyInUse(seq) || seq != data->seq || data->data == NULL) {
+    return false;
+  }
+  // Other threads may be calling pthread_key_delete/pthread_key_create while current thread
+  // is exiting. So we need to ensure we read the right key_destructor.
+  // We can rely on a user-established happens-before relationship between the creation and
+  // use of pthread key to ensure that we're not getting an earlier key_destructor.
+  // To avoid using the key_destructor of the newly created key in the same slot, we need to
+  // recheck the sequence number after reading key_destructor. As a result, we either see the
+  // right key_destructor, or the sequence number must have changed when we reread it below.
+  key_destructor_t key_destructor = reinterpret_cast<key_destructor_t>(
+    atomic_load_explicit(&key_map_entry->key_destructor, memory_order_relaxed));
+  if (key_destructor == NULL) {
+    return false;
+  }
+  atomic_thread_fence(memory_order_acquire);
+  if (atomic_load_explicit(&key_map_entry->seq, memory_order_relaxed) != seq) {
+    return false;
+  }
+
+  // We need to clear the key data now, this will prevent the destructor (or a later one)
+  // from seeing the old value if it calls pthread_getspecific().
+  // We don't do this if 'key_destructor == NULL' just in case another destructor
+  // function is responsible for manually releasing the corresponding data.
+  void* old_data = data->data;
+  data->data = NULL;
+  SetKeyDataInUse(in_use, index, NULL);
+
+  (*key_destructor)(old_data);
+  return true;
+}
+
+// Calls the destructors for the keys whose bit is set in in_use. Returns how many were called.
+static size_t CallKeyDestructors(pthread_key_internal_t* key_map_entries, pthread_key_data_t* data,
+                                 uint32_t* in_use, size_t count) {
+  size_t called_destructor_count = 0;
+  for (size_t word = 0; word < PTHREAD_KEY_IN_USE_WORDS(count); ++word) {
+    // Destructors may set more keys, but the next round will see those.
+    uint32_t bits = in_use[word];
+    while (bits != 0) {
+      size_t i = word * 32 + __builtin_ctz(bits);
+      bits &= bits - 1;
+      if (CallKeyDestructor(&key_map_entries[i], &data[i], in_use, i)) {
+        ++called_destructor_count;
+      }
+    }
+  }
+  return called_destructor_count;
+}
+
 // Called from pthread_exit() to remove all pthread keys. This must call the destructor of
 // all keys that have a non-NULL data value and a non-NULL destructor.
 __LIBC_HIDDEN__ void pthread_key_clean_all() {
   // Because destructors can do funky things like deleting/creating other keys,
   // we need to implement this in a loop.
-  pthread_key_data_t* key_data = __get_thread()->key_data;
+  pthread_internal_t* thread = __get_thread();
   for (size_t rounds = PTHREAD_DESTRUCTOR_ITERATIONS; rounds > 0; --rounds) {
-    size_t called_destructor_count = 0;
-    for (size_t i = 0; i < BIONIC_PTHREAD_KEY_COUNT; ++i) {
-      uintptr_t seq = atomic_load_explicit(&key_map[i].seq, memory_order_relaxed);
-      if (SeqOfKeyInUse(seq) && seq == key_data[i].seq && key_data[i].data != NULL) {
-        // Other threads may be calling pthread_key_delete/pthread_key_create while current thread
-        // is exiting. So we need to ensure we read the right key_destructor.
-        // We can rely on a user-established happens-before relationship between the creation and
-        // use of pthread key to ensure that we're not getting an earlier key_destructor.
-        // To avoid using the key_destructor of the newly created key in the same slot, we need to
-        // recheck the sequence number after reading key_destructor. As a result, we either see the
-        // right key_destructor, or the sequence number must have changed when we reread it below.
-        key_destructor_t key_destructor = reinterpret_cast<key_destructor_t>(
-          atomic_load_explicit(&key_map[i].key_destructor, memory_order_relaxed));
-        if (key_destructor == NULL) {
-          continue;
-        }
-        atomic_thread_fence(memory_order_acquire);
-        if (atomic_load_explicit(&key_map[i].seq, memory_order_relaxed) != seq) {
-           continue;
-        }
-
-        // We need to clear the key data now, this will prevent the destructor (or a later one)
-        // from seeing the old value if it calls pthread_getspecific().
-        // We don't do this if 'key_destructor == NULL' just in case another destructor
-        // function is responsible for manually releasing the corresponding data.
-        void* data = key_data[i].data;
-        key_data[i].data = NULL;
-
-        (*key_destructor)(data);
-        ++called_destructor_count;
+    size_t called_destructor_count = CallKeyDestructors(key_map, thread->key_data,
+                                                        thread->key_data_in_use,
+                                                        BIONIC_PTHREAD_KEY_COUNT);
+    for (size_t i = 0; i < BIONIC_PTHREAD_KEY_PAGE_COUNT; ++i) {
+      pthread_key_data_page_t* page = thread->key_data_pages[i];
+      if (page != NULL) {
+        // This thread only has data for keys that were created, so the key page exists.
+        pthread_key_internal_t* key_page = atomic_load_explicit(&key_map_pages[i],
+                                                                memory_order_acquire);
+        called_destructor_count += CallKeyDestructors(key_page, page->data, page->in_use,
+                                                      BIONIC_PTHREAD_KEY_PAGE_KEYS);
       }
     }
 
@@ -113,15 +179,55 @@ __LIBC_HIDDEN__ void pthread_key_clean_all() {
       break;
     }
   }
+
+  for (size_t i = 0; i < BIONIC_PTHREAD_KEY_PAGE_COUNT; ++i) {
+    if (thread->key_data_pages[i] != NULL) {
+      munmap(thread->key_data_pages[i], sizeof(pthread_key_data_page_t));
+      thread->key_data_pages[i] = NULL;
+    }
+  }
+}
+
+static bool TryCreateKey(pthread_key_internal_t* key_map_entry,
+                         void (*key_destructor)(void*)) {
+  uintptr_t seq = atomic_load_explicit(&key_map_entry->seq, memory_order_relaxed);
+  while (!SeqOfKeyInUse(seq)) {
+    if (atomic_compare_exchange_weak(&key_map_entry->seq, &seq, seq + SEQ_INCREMENT_STEP)) {
+      atomic_store(&key_map_entry->key_destructor, reinterpret_cast<uintptr_t>(key_destructor));
+      return true;
+    }
+  }
+  return false;
 }
 
 int pthread_key_create(pthread_key_t* key, void (*key_destructor)(void*)) {
   for (size_t i = 0; i < BIONIC_PTHREAD_KEY_COUNT; ++i) {
-    uintptr_t seq = atomic_load_explicit(&key_map[i].seq, memory_order_relaxed);
-    while (!SeqOfKeyInUse(seq)) {
-      if (atomic_compare_exchange_weak(&key_map[i].seq, &seq, seq + SEQ_INCREMENT_STEP)) {
-        atomic_store(&key_map[i].key_destructor, reinterpret_cast<uintptr_t>(key_destructor));
-        *key = i | KEY_VALID_FLAG;
+    if (TryCreateKey(&key_map[i], key_destructor)) {
+      *key = i | KEY_VALID_FLAG;
+      return 0;
+    }
+  }
+
+  for (size_t page_index = 0; page_index < BIONIC_PTHREAD_KEY_PAGE_COUNT; ++page_index) {
+    pthread_key_internal_t* page = atomic_load_explicit(&key_map_pages[page_index],
+                                                        memory_order_acquire);
+    if (page == NULL) {
+      key_map_pages_lock.lock();
+      page = atomic_load_explicit(&key_map_pages[page_index], memory_order_relaxed);
+      if (page == NULL) {
+        page = static_cast<pthread_key_internal_t*>(
+            MapPage(sizeof(pthread_key_internal_t) * BIONIC_PTHREAD_KEY_PAGE_KEYS));
+        atomic_store_explicit(&key_map_pages[page_index], page, memory_order_release);
+      }
+      key_map_pages_lock.unlock();
+      if (page == NULL) {
+        return EAGAIN;
+      }
+    }
+    for (size_t i = 0; i < BIONIC_PTHREAD_KEY_PAGE_KEYS; ++i) {
+      if (TryCreateKey(&page[i], key_destructor)) {
+        *key = (BIONIC_PTHREAD_KEY_COUNT + page_index * BIONIC_PTHREAD_KEY_PAGE_KEYS + i) |
+               KEY_VALID_FLAG;
         return 0;
       }
     }
@@ -134,27 +240,57 @@ int pthread_key_create(pthread_key_t* key, void (*key_destructor)(void*)) {
 // responsibility of the caller to properly dispose of the corresponding data
 // and resources, using any means it finds suitable.
 int pthread_key_delete(pthread_key_t key) {
-  if (__predict_false(!KeyInValidRange(key))) {
+  pthread_key_internal_t* key_map_entry;
+  if (__predict_true(KeyInValidRange(key))) {
+    key_map_entry = &key_map[key & ~KEY_VALID_FLAG];
+  } else if (KeyInValidExtraRange(key)) {
+    key_map_entry = ExtraKeyInternal((key & ~KEY_VALID_FLAG) - BIONIC_PTHREAD_KEY_COUNT);
+    if (key_map_entry == NULL) {
+      return EINVAL;
+    }
+  } else {
     return EINVAL;
   }
-  key &= ~KEY_VALID_FLAG;
   // Increase seq to invalidate values in all threads.
-  uintptr_t seq = atomic_load_explicit(&key_map[key].seq, memory_order_relaxed);
+  uintptr_t seq = atomic_load_explicit(&key_map_entry->seq, memory_order_relaxed);
   if (SeqOfKeyInUse(seq)) {
-    if (atomic_compare_exchange_strong(&key_map[key].seq, &seq, seq + SEQ_INCREMENT_STEP)) {
+    if (atomic_compare_exchange_strong(&key_map_entry->seq, &seq, seq + SEQ_INCREMENT_STEP)) {
       return 0;
     }
   }
   return EINVAL;
 }
 
+static void* GetExtraSpecific(pthread_key_t key) {
+  if (!KeyInValidExtraRange(key)) {
+    return NULL;
+  }
+  size_t extra_index = (key & ~KEY_VALID_FLAG) - BIONIC_PTHREAD_KEY_COUNT;
+  pthread_key_data_page_t* page =
+      __get_thread()->key_data_pages[extra_index / BIONIC_PTHREAD_KEY_PAGE_KEYS];
+  // If this thread never set a key in the page, all of them are NULL.
+  if (page == NULL) {
+    return NULL;
+  }
+  size_t index = extra_index % BIONIC_PTHREAD_KEY_PAGE_KEYS;
+  uintptr_t seq = atomic_load_explicit(&ExtraKeyInternal(extra_index)->seq, memory_order_relaxed);
+  pthread_key_data_t* data = &page->data[index];
+  if (SeqOfKeyInUse(seq) && data->seq == seq) {
+    return data->data;
+  }
+  data->data = NULL;
+  SetKeyDataInUse(page->in_use, index, NULL);
+  return NULL;
+}
+
 void* pthread_getspecific(pthread_key_t key) {
   if (__predict_false(!KeyInValidRange(key))) {
-    return NULL;
+    return GetExtraSpecific(key);
   }
   key &= ~KEY_VALID_FLAG;
   uintptr_t seq = atomic_load_explicit(&key_map[key].seq, memory_order_relaxed);
-  pthread_key_data_t* data = &(__get_thread()->key_data[key]);
+  pthread_internal_t* thread = __get_thread();
+  pthread_key_data_t* data = &(thread->key_data[key]);
   // It is user's responsibility to synchornize between the creation and use of pthread keys,
   // so we use memory_order_relaxed when checking the sequence number.
   if (__predict_true(SeqOfKeyInUse(seq) && data->seq == seq)) {
@@ -163,19 +299,54 @@ void* pthread_getspecific(pthread_key_t key) {
   // We arrive here when current thread holds the seq of an deleted pthread key. So the
   // data is for the deleted pthread key, and should be cleared.
   data->data = NULL;
+  SetKeyDataInUse(thread->key_data_in_use, key, NULL);
   return NULL;
 }
 
+static int SetExtraSpecific(pthread_key_t key, const void* ptr) {
+  if (!KeyInValidExtraRange(key)) {
+    return EINVAL;
+  }
+  size_t extra_index = (key & ~KEY_VALID_FLAG) - BIONIC_PTHREAD_KEY_COUNT;
+  pthread_key_internal_t* key_map_entry = ExtraKeyInternal(extra_index);
+  if (key_map_entry == NULL) {
+    return EINVAL;
+  }
+  uintptr_t seq = atomic_load_explicit(&key_map_entry->seq, memory_order_relaxed);
+  if (!SeqOfKeyInUse(seq)) {
+    return EINVAL;
+  }
+  pthread_internal_t* thread = __get_thread();
+  pthread_key_data_page_t*& page =
+      thread->key_data_pages[extra_index / BIONIC_PTHREAD_KEY_PAGE_KEYS];
+  if (page == NULL) {
+    if (ptr == NULL) {
+      return 0;
+    }
+    page = static_cast<pthread_key_data_page_t*>(MapPage(sizeof(pthread_key_data_page_t)));
+    if (page == NULL) {
+      return ENOMEM;
+    }
+  }
+  size_t index = extra_index % BIONIC_PTHREAD_KEY_PAGE_KEYS;
+  page->data[index].seq = seq;
+  page->data[index].data = const_cast<void*>(ptr);
+  SetKeyDataInUse(page->in_use, index, ptr);
+  return 0;
+}
+
 int pthread_setspecific(pthread_key_t key, const void* ptr) {
   if (__predict_false(!KeyInValidRange(key))) {
-    return EINVAL;
+    return SetExtraSpecific(key, ptr);
   }
   key &= ~KEY_VALID_FLAG;
   uintptr_t seq = atomic_load_explicit(&key_map[key].seq, memory_order_relaxed);
   if (__predict_true(SeqOfKeyInUse(seq))) {
-    pthread_key_data_t* data = &(__get_thread()->key_data[key]);
+    pthread_internal_t* thread = __get_thread();
+    pthread_key_data_t* data = &(thread->key_data[key]);
     data->seq = seq;
     data->data = const_cast<void*>(ptr);
+    SetKeyDataInUse(thread->key_data_in_use, key, ptr);
     return 0;
   }
   return EINVAL;
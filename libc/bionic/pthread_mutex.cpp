@@ -31,6 +31,7 @@
 #include <errno.h>
 #include <limits.h>
 #include <stdatomic.h>
+#include <stdlib.h>
 #include <string.h>
 #include <sys/cdefs.h>
 #include <sys/mman.h>
@@ -39,19 +40,29 @@
 #include "pthread_internal.h"
 
 #include "private/bionic_constants.h"
+#include "private/bionic_cpu_relax.h"
 #include "private/bionic_futex.h"
+#include "private/bionic_globals.h"
+#include "private/bionic_lock.h"
 #include "private/bionic_systrace.h"
 #include "private/bionic_time_conversions.h"
 #include "private/bionic_tls.h"
+#include "private/bionic_vdso.h"
+#include "private/get_cpu_count_from_string.h"
+#include "private/LineReader.h"
 
 /* a mutex attribute holds the following fields
  *
  * bits:     name       description
  * 0-3       type       type of mutex
  * 4         shared     process-shared flag
+ * 5         protocol   whether it is a priority inherit mutex.
  */
 #define  MUTEXATTR_TYPE_MASK   0x000f
 #define  MUTEXATTR_SHARED_MASK 0x0010
+#define  MUTEXATTR_PROTOCOL_MASK 0x0020
+
+#define  MUTEXATTR_PROTOCOL_SHIFT 5
 
 int pthread_mutexattr_init(pthread_mutexattr_t *attr)
 {
@@ -69,7 +80,7 @@ int pthread_mutexattr_gettype(const pthread_mutexattr_t *attr, int *type_p)
 {
     int type = (*attr & MUTEXATTR_TYPE_MASK);
 
-    if (type < PTHREAD_MUTEX_NORMAL || type > PTHREAD_MUTEX_ERRORCHECK) {
+    if (type < PTHREAD_MUTEX_NORMAL || type > PTHREAD_MUTEX_ADAPTIVE_NP) {
         return EINVAL;
     }
 
@@ -79,7 +90,7 @@ int pthread_mutexattr_gettype(const pthread_mutexattr_t *attr, int *type_p)
 
 int pthread_mutexattr_settype(pthread_mutexattr_t *attr, int type)
 {
-    if (type < PTHREAD_MUTEX_NORMAL || type > PTHREAD_MUTEX_ERRORCHECK ) {
+    if (type < PTHREAD_MUTEX_NORMAL || type > PTHREAD_MUTEX_ADAPTIVE_NP) {
         return EINVAL;
     }
 
@@ -113,6 +124,226 @@ int pthread_mutexattr_getpshared(const pthread_mutexattr_t* attr, int* pshared)
     return 0;
 }
 
+int pthread_mutexattr_setprotocol(pthread_mutexattr_t* attr, int protocol) {
+    if (protocol != PTHREAD_PRIO_NONE && protocol != PTHREAD_PRIO_INHERIT) {
+        return EINVAL;
+    }
+    *attr = (*attr & ~MUTEXATTR_PROTOCOL_MASK) | (protocol << MUTEXATTR_PROTOCOL_SHIFT);
+    return 0;
+}
+
+int pthread_mutexattr_getprotocol(const pthread_mutexattr_t* attr, int* protocol) {
+    *protocol = (*attr & MUTEXATTR_PROTOCOL_MASK) >> MUTEXATTR_PROTOCOL_SHIFT;
+    return 0;
+}
+
+// Priority Inheritance mutex implementation
+struct PIMutex {
+  // mutex type, can be 0 (normal), 1 (recursive), 2 (errorcheck), constant during lifetime
+  uint8_t type;
+  // process-shared flag, constant during lifetime
+  bool shared;
+  // <number of times a thread holding a recursive PI mutex> - 1
+  uint16_t counter;
+  // owner_tid is read/written by both userspace code and kernel code. It includes three fields:
+  // FUTEX_WAITERS, FUTEX_OWNER_DIED and FUTEX_TID_MASK.
+  atomic_int owner_tid;
+};
+
+static inline __always_inline int PIMutexTryLock(PIMutex& mutex) {
+    pid_t tid = __get_thread()->tid;
+    // Handle common case first.
+    int old_owner = 0;
+    if (__predict_true(atomic_compare_exchange_strong_explicit(&mutex.owner_tid,
+                                                              &old_owner, tid,
+                                                              memory_order_acquire,
+                                                              memory_order_relaxed))) {
+        return 0;
+    }
+    if (tid == (old_owner & FUTEX_TID_MASK)) {
+        // We already own this mutex.
+        if (mutex.type == PTHREAD_MUTEX_NORMAL) {
+            return EBUSY;
+        }
+        if (mutex.type == PTHREAD_MUTEX_ERRORCHECK) {
+            return EDEADLK;
+        }
+        if (mutex.counter == 0xffff) {
+            return EAGAIN;
+        }
+        mutex.counter++;
+        return 0;
+    }
+    return EBUSY;
+}
+
+static int PIMutexTimedLock(PIMutex& mutex, bool use_realtime_clock,
+                            const timespec* abs_timeout_or_null) {
+    int ret = PIMutexTryLock(mutex);
+    if (__predict_true(ret == 0)) {
+        return 0;
+    }
+    if (ret != EBUSY) {
+        return ret;
+    }
+    ret = check_timespec(abs_timeout_or_null, true);
+    if (ret != 0) {
+        return ret;
+    }
+
+    // FUTEX_LOCK_PI only takes CLOCK_REALTIME timeouts, so move a
+    // CLOCK_MONOTONIC one over to CLOCK_REALTIME.
+    timespec realtime_abs_timeout;
+    if (abs_timeout_or_null != nullptr && !use_realtime_clock) {
+        timespec now_monotonic;
+        clock_gettime(CLOCK_MONOTONIC, &now_monotonic);
+        clock_gettime(CLOCK_REALTIME, &realtime_abs_timeout);
+        realtime_abs_timeout.tv_sec += abs_timeout_or_null->tv_sec - now_monotonic.tv_sec;
+        realtime_abs_timeout.tv_nsec += abs_timeout_or_null->tv_nsec - now_monotonic.tv_nsec;
+        if (realtime_abs_timeout.tv_nsec < 0) {
+            realtime_abs_timeout.tv_nsec += NS_PER_S;
+            realtime_abs_timeout.tv_sec--;
+        } else if (realtime_abs_timeout.tv_nsec >= NS_PER_S) {
+            realtime_abs_timeout.tv_nsec -= NS_PER_S;
+            realtime_abs_timeout.tv_sec++;
+        }
+        abs_timeout_or_null = &realtime_abs_timeout;
+    }
+
+    ScopedTrace trace("Contending for pthread mutex");
+    return -__futex_pi_lock(&mutex.owner_tid, mutex.shared, abs_timeout_or_null);
+}
+
+static int PIMutexUnlock(PIMutex& mutex) {
+    pid_t tid = __get_thread()->tid;
+    int old_owner = tid;
+    // Handle common case first.
+    if (__predict_true(mutex.type == PTHREAD_MUTEX_NORMAL)) {
+        if (__predict_true(atomic_compare_exchange_strong_explicit(&mutex.owner_tid,
+                                                                  &old_owner, 0,
+                                                                  memory_order_release,
+                                                                  memory_order_relaxed))) {
+            return 0;
+        }
+    } else {
+        old_owner = atomic_load_explicit(&mutex.owner_tid, memory_order_relaxed);
+    }
+
+    if (tid != (old_owner & FUTEX_TID_MASK)) {
+        // The mutex can only be unlocked by the thread who owns it.
+        return EPERM;
+    }
+    if (mutex.type == PTHREAD_MUTEX_RECURSIVE) {
+        if (mutex.counter != 0u) {
+            --mutex.counter;
+            return 0;
+        }
+    }
+    if (old_owner == tid) {
+        // No thread is waiting.
+        if (__predict_true(atomic_compare_exchange_strong_explicit(&mutex.owner_tid,
+                                                                  &old_owner, 0,
+                                                                  memory_order_release,
+                                                                  memory_order_relaxed))) {
+            return 0;
+        }
+    }
+    // A waiter set FUTEX_WAITERS, so the kernel has to hand the mutex over.
+    return -__futex_pi_unlock(&mutex.owner_tid, mutex.shared);
+}
+
+static int PIMutexDestroy(PIMutex& mutex) {
+    // The mutex should be in unlocked state (owner_tid == 0) when destroyed.
+    // Store 0xffffffff to make the mutex unusable.
+    int old_owner = 0;
+    if (atomic_compare_exchange_strong_explicit(&mutex.owner_tid, &old_owner, 0xffffffff,
+                                                memory_order_relaxed, memory_order_relaxed)) {
+        return 0;
+    }
+    return EBUSY;
+}
+
+#if !defined(__LP64__)
+
+namespace PIMutexAllocator {
+// pthread_mutex_t has only 4 bytes in 32-bit programs, which are not enough to hold a PIMutex.
+// So PIMutexes are allocated here, and the 16 bits of pthread_mutex_t next to the state hold
+// an id to find them by. This allows at most 65536 PI mutexes at a time.
+// Mapping an id to its PIMutex is done without a lock: once a PIMutex is allocated, the data
+// used to find it doesn't change until it is destroyed. An id is looked up as
+//   (*nodes[id >> 8])[id & 0xff]
+// and freed ids are kept in a free list.
+
+union Node {
+    PIMutex mutex;
+    int next_free_id;  // If not -1, refer to the next node in the free PIMutex list.
+};
+typedef Node NodeArray[256];
+typedef NodeArray* NodeArrayP;
+
+// lock protects the items below.
+static Lock lock;
+static NodeArrayP* nodes;
+static int next_to_alloc_id;
+static int first_free_id = -1;  // If not -1, refer to the first node in the free PIMutex list.
+
+static inline __always_inline Node& IdToNode(int id) {
+    return (*nodes[id >> 8])[id & 0xff];
+}
+
+static inline __always_inline PIMutex& IdToPIMutex(int id) {
+    return IdToNode(id).mutex;
+}
+
+static int AllocIdLocked() {
+    if (first_free_id != -1) {
+        int result = first_free_id;
+        first_free_id = IdToNode(result).next_free_id;
+        return result;
+    }
+    if (next_to_alloc_id >= 0x10000) {
+        return -1;
+    }
+    int array_pos = next_to_alloc_id >> 8;
+    int node_pos = next_to_alloc_id & 0xff;
+    if (node_pos == 0) {
+        if (array_pos == 0) {
+            nodes = static_cast<NodeArray**>(calloc(256, sizeof(NodeArray*)));
+            if (nodes == nullptr) {
+                return -1;
+            }
+        }
+        nodes[array_pos] = static_cast<NodeArray*>(malloc(sizeof(NodeArray)));
+        if (nodes[array_pos] == nullptr) {
+            return -1;
+        }
+    }
+    return next_to_alloc_id++;
+}
+
+// If successful, return an id referring to a PIMutex, otherwise return -1.
+// A valid id is in range [0, 0xffff].
+static int AllocId() {
+    lock.lock();
+    int result = AllocIdLocked();
+    lock.unlock();
+    if (result != -1) {
+        memset(&IdToPIMutex(result), 0, sizeof(PIMutex));
+    }
+    return result;
+}
+
+static void FreeId(int id) {
+    lock.lock();
+    IdToNode(id).next_free_id = first_free_id;
+    first_free_id = id;
+    lock.unlock();
+}
+
+}  // namespace PIMutexAllocator
+
+#endif  // !defined(__LP64__)
+
 /* a mutex contains a state value and a owner_tid.
  * The value is implemented as a 16-bit integer holding the following fields:
  *
@@ -203,7 +434,8 @@ int pthread_mutexattr_getpshared(const pthread_mutexattr_t* attr, int* pshared)
 #define  MUTEX_SHARED_MASK     FIELD_MASK(MUTEX_SHARED_SHIFT,1)
 
 /* Mutex type:
- * We support normal, recursive and errorcheck mutexes.
+ * We support normal, recursive, errorcheck and adaptive mutexes. Adaptive
+ * mutexes are normal mutexes that spin for a while before sleeping.
  */
 #define  MUTEX_TYPE_SHIFT      14
 #define  MUTEX_TYPE_LEN        2
@@ -214,16 +446,42 @@ int pthread_mutexattr_getpshared(const pthread_mutexattr_t* attr, int* pshared)
 #define  MUTEX_TYPE_BITS_NORMAL      MUTEX_TYPE_TO_BITS(PTHREAD_MUTEX_NORMAL)
 #define  MUTEX_TYPE_BITS_RECURSIVE   MUTEX_TYPE_TO_BITS(PTHREAD_MUTEX_RECURSIVE)
 #define  MUTEX_TYPE_BITS_ERRORCHECK  MUTEX_TYPE_TO_BITS(PTHREAD_MUTEX_ERRORCHECK)
+#define  MUTEX_TYPE_BITS_ADAPTIVE    MUTEX_TYPE_TO_BITS(PTHREAD_MUTEX_ADAPTIVE_NP)
+
+// A priority inheritance mutex has this value in its state for its whole
+// life. Its type and lock state live in a PIMutex instead. The value can't
+// be taken by any other mutex: a lock state of 3 is never used otherwise.
+#define PI_MUTEX_STATE  (MUTEX_TYPE_BITS_ADAPTIVE | MUTEX_STATE_TO_BITS(3))
 
 struct pthread_mutex_internal_t {
   _Atomic(uint16_t) state;
 #if defined(__LP64__)
   uint16_t __pad;
-  atomic_int owner_tid;
-  char __reserved[32];
+  union {
+    atomic_int owner_tid;
+    PIMutex pi_mutex;
+  };
+  char __reserved[28];
+#else
+  union {
+    _Atomic(uint16_t) owner_tid;
+    uint16_t pi_mutex_id;
+  };
+#endif
+
+  PIMutex& ToPIMutex() {
+#if defined(__LP64__)
+    return pi_mutex;
 #else
-  _Atomic(uint16_t) owner_tid;
+    return PIMutexAllocator::IdToPIMutex(pi_mutex_id);
 #endif
+  }
+
+  void FreePIMutex() {
+#if !defined(__LP64__)
+    PIMutexAllocator::FreeId(pi_mutex_id);
+#endif
+  }
 } __attribute__((aligned(4)));
 
 static_assert(sizeof(pthread_mutex_t) == sizeof(pthread_mutex_internal_t),
@@ -253,6 +511,32 @@ int pthread_mutex_init(pthread_mutex_t* mutex_interface, const pthread_mutexattr
         state |= MUTEX_SHARED_MASK;
     }
 
+    if (((*attr & MUTEXATTR_PROTOCOL_MASK) >> MUTEXATTR_PROTOCOL_SHIFT) == PTHREAD_PRIO_INHERIT) {
+        int type = *attr & MUTEXATTR_TYPE_MASK;
+        if (type < PTHREAD_MUTEX_NORMAL || type > PTHREAD_MUTEX_ADAPTIVE_NP) {
+            return EINVAL;
+        }
+        bool shared = (*attr & MUTEXATTR_SHARED_MASK) != 0;
+#if !defined(__LP64__)
+        // The PIMutex lives in this process' memory, so the mutex can't be shared.
+        if (shared) {
+            return ENOTSUP;
+        }
+        int id = PIMutexAllocator::AllocId();
+        if (id == -1) {
+            return ENOMEM;
+        }
+        mutex->pi_mutex_id = id;
+#endif
+        PIMutex& pi_mutex = mutex->ToPIMutex();
+        // The kernel already gives waiters the lock in priority order, so an
+        // adaptive PI mutex is just a normal one.
+        pi_mutex.type = (type == PTHREAD_MUTEX_ADAPTIVE_NP) ? PTHREAD_MUTEX_NORMAL : type;
+        pi_mutex.shared = shared;
+        atomic_init(&mutex->state, PI_MUTEX_STATE);
+        return 0;
+    }
+
     switch (*attr & MUTEXATTR_TYPE_MASK) {
     case PTHREAD_MUTEX_NORMAL:
       state |= MUTEX_TYPE_BITS_NORMAL;
@@ -263,6 +547,9 @@ int pthread_mutex_init(pthread_mutex_t* mutex_interface, const pthread_mutexattr
     case PTHREAD_MUTEX_ERRORCHECK:
       state |= MUTEX_TYPE_BITS_ERRORCHECK;
       break;
+    case PTHREAD_MUTEX_ADAPTIVE_NP:
+      state |= MUTEX_TYPE_BITS_ADAPTIVE;
+      break;
     default:
         return EINVAL;
     }
@@ -273,9 +560,10 @@ int pthread_mutex_init(pthread_mutex_t* mutex_interface, const pthread_mutexattr
 }
 
 static inline __always_inline int __pthread_normal_mutex_trylock(pthread_mutex_internal_t* mutex,
+                                                                 uint16_t mtype,
                                                                  uint16_t shared) {
-    const uint16_t unlocked           = shared | MUTEX_STATE_BITS_UNLOCKED;
-    const uint16_t locked_uncontended = shared | MUTEX_STATE_BITS_LOCKED_UNCONTENDED;
+    const uint16_t unlocked           = mtype | shared | MUTEX_STATE_BITS_UNLOCKED;
+    const uint16_t locked_uncontended = mtype | shared | MUTEX_STATE_BITS_LOCKED_UNCONTENDED;
 
     uint16_t old_state = unlocked;
     if (__predict_true(atomic_compare_exchange_strong_explicit(&mutex->state, &old_state,
@@ -285,8 +573,100 @@ static inline __always_inline int __pthread_normal_mutex_trylock(pthread_mutex_i
     return EBUSY;
 }
 
+// Set from LIBC_PTHREAD_MUTEX_ADAPTIVE, to make normal mutexes spin too.
+static bool g_mutex_adaptive_default;
+
+void __pthread_mutex_init_adaptive_default() {
+    const char* value = getenv("LIBC_PTHREAD_MUTEX_ADAPTIVE");
+    g_mutex_adaptive_default = (value != nullptr && strcmp(value, "1") == 0);
+}
+
+// Set from LIBC_PTHREAD_MUTEX_NUMA_WAKE on machines with more than one NUMA node. Waiters for a
+// normal mutex then sleep in the futex class of their node, and unlocking wakes a waiter on the
+// unlocking thread's node if there is one, so the mutex and the data it protects stay in that
+// node's caches. To bound how long waiters on other nodes can be passed over, every
+// MUTEX_NUMA_LOCAL_WAKE_LIMIT-th contended unlock by a thread wakes any waiter.
+#define MUTEX_NUMA_LOCAL_WAKE_LIMIT 8
+
+static bool g_mutex_numa_wake;
+
+void __pthread_mutex_init_numa_wake() {
+    const char* value = getenv("LIBC_PTHREAD_MUTEX_NUMA_WAKE");
+    if (value == nullptr || strcmp(value, "1") != 0) {
+        return;
+    }
+    char nodes[256];
+    g_mutex_numa_wake = ReadSmallFile("/sys/devices/system/node/online", nodes, sizeof(nodes)) &&
+                        GetCpuCountFromString(nodes) > 1;
+}
+
+// Returns the futex class of the NUMA node this thread is running on.
+static uint32_t __numa_node_futex_bitset() {
+    // This is only null on architectures without a vdso.
+    auto vdso_getcpu = reinterpret_cast<decltype(&__getcpu)>(
+        __libc_globals->vdso[VDSO_GETCPU].fn);
+    if (vdso_getcpu == nullptr) {
+        vdso_getcpu = __getcpu;
+    }
+    unsigned cpu;
+    unsigned node;
+    if (vdso_getcpu(&cpu, &node, nullptr) == -1) {
+        return FUTEX_BITSET_MATCH_ANY;
+    }
+    return 1u << (node % 32);
+}
+
+static uint32_t __mutex_wait_bitset() {
+    return g_mutex_numa_wake ? __numa_node_futex_bitset() : FUTEX_BITSET_MATCH_ANY;
+}
+
+static uint32_t __mutex_wake_bitset() {
+    if (!g_mutex_numa_wake) {
+        return FUTEX_BITSET_MATCH_ANY;
+    }
+    pthread_internal_t* thread = __get_thread();
+    if (thread == nullptr || ++thread->mutex_numa_local_wakes >= MUTEX_NUMA_LOCAL_WAKE_LIMIT) {
+        if (thread != nullptr) {
+            thread->mutex_numa_local_wakes = 0;
+        }
+        return FUTEX_BITSET_MATCH_ANY;
+    }
+    return __numa_node_futex_bitset();
+}
+
+// An adaptive mutex spins for up to MUTEX_SPIN_COUNT reads of its state,
+// pausing a little longer after each one up to MUTEX_SPIN_MAX_BACKOFF
+// cpu_relax calls, before sleeping on the futex like a normal mutex. That is
+// a few microseconds at most, below the cost of a futex wait and wake.
+#define MUTEX_SPIN_COUNT        100
+#define MUTEX_SPIN_MAX_BACKOFF  8
+
+static int __pthread_normal_mutex_spin(pthread_mutex_internal_t* mutex, uint16_t mtype,
+                                       uint16_t shared) {
+    int backoff = 1;
+    for (int i = 0; i < MUTEX_SPIN_COUNT; ++i) {
+        uint16_t state = atomic_load_explicit(&mutex->state, memory_order_relaxed);
+        if (MUTEX_STATE_BITS_IS_UNLOCKED(state)) {
+            if (__pthread_normal_mutex_trylock(mutex, mtype, shared) == 0) {
+                return 0;
+            }
+        } else if (MUTEX_STATE_BITS_IS_LOCKED_CONTENDED(state)) {
+            // Other threads already gave up and went to sleep, so the owner
+            // is probably not going to release the mutex soon.
+            break;
+        }
+        for (int j = 0; j < backoff; ++j) {
+            __cpu_relax();
+        }
+        if (backoff < MUTEX_SPIN_MAX_BACKOFF) {
+            backoff *= 2;
+        }
+    }
+    return EBUSY;
+}
+
 /*
- * Lock a mutex of type NORMAL.
+ * Lock a mutex of type NORMAL or ADAPTIVE.
  *
  * As noted above, there are three states:
  *   0 (unlocked, no contention)
@@ -298,10 +678,11 @@ static inline __always_inline int __pthread_normal_mutex_trylock(pthread_mutex_i
  * the lock state field.
  */
 static inline __always_inline int __pthread_normal_mutex_lock(pthread_mutex_internal_t* mutex,
+                                                              uint16_t mtype,
                                                               uint16_t shared,
                                                               bool use_realtime_clock,
                                                               const timespec* abs_timeout_or_null) {
-    if (__predict_true(__pthread_normal_mutex_trylock(mutex, shared) == 0)) {
+    if (__predict_true(__pthread_normal_mutex_trylock(mutex, mtype, shared) == 0)) {
         return 0;
     }
     int result = check_timespec(abs_timeout_or_null, true);
@@ -309,10 +690,15 @@ static inline __always_inline int __pthread_normal_mutex_lock(pthread_mutex_inte
         return result;
     }
 
+    if ((mtype == MUTEX_TYPE_BITS_ADAPTIVE || g_mutex_adaptive_default) &&
+        __pthread_normal_mutex_spin(mutex, mtype, shared) == 0) {
+        return 0;
+    }
+
     ScopedTrace trace("Contending for pthread mutex");
 
-    const uint16_t unlocked           = shared | MUTEX_STATE_BITS_UNLOCKED;
-    const uint16_t locked_contended = shared | MUTEX_STATE_BITS_LOCKED_CONTENDED;
+    const uint16_t unlocked           = mtype | shared | MUTEX_STATE_BITS_UNLOCKED;
+    const uint16_t locked_contended = mtype | shared | MUTEX_STATE_BITS_LOCKED_CONTENDED;
 
     // We want to go to sleep until the mutex is available, which requires
     // promoting it to locked_contended. We need to swap in the new state
@@ -322,10 +708,11 @@ static inline __always_inline int __pthread_normal_mutex_lock(pthread_mutex_inte
     // thread still holds the lock and we should wait again.
     // If lock is acquired, an acquire fence is needed to make all memory accesses
     // made by other threads visible to the current CPU.
+    const uint32_t bitset = __mutex_wait_bitset();
     while (atomic_exchange_explicit(&mutex->state, locked_contended,
                                     memory_order_acquire) != unlocked) {
-        if (__futex_wait_ex(&mutex->state, shared, locked_contended, use_realtime_clock,
-                            abs_timeout_or_null) == -ETIMEDOUT) {
+        if (__futex_wait_bitset_ex(&mutex->state, shared, locked_contended, use_realtime_clock,
+                                   abs_timeout_or_null, bitset) == -ETIMEDOUT) {
             return ETIMEDOUT;
         }
     }
@@ -337,9 +724,10 @@ static inline __always_inline int __pthread_normal_mutex_lock(pthread_mutex_inte
  * that we are in fact the owner of this lock.
  */
 static inline __always_inline void __pthread_normal_mutex_unlock(pthread_mutex_internal_t* mutex,
+                                                                 uint16_t mtype,
                                                                  uint16_t shared) {
-    const uint16_t unlocked         = shared | MUTEX_STATE_BITS_UNLOCKED;
-    const uint16_t locked_contended = shared | MUTEX_STATE_BITS_LOCKED_CONTENDED;
+    const uint16_t unlocked         = mtype | shared | MUTEX_STATE_BITS_UNLOCKED;
+    const uint16_t locked_contended = mtype | shared | MUTEX_STATE_BITS_LOCKED_CONTENDED;
 
     // We use an atomic_exchange to release the lock. If locked_contended state
     // is returned, some threads is waiting for the lock and we need to wake up
@@ -366,7 +754,7 @@ static inline __always_inline void __pthread_normal_mutex_unlock(pthread_mutex_i
         // we call wake, the thread we eventually wake will find an unlocked mutex
         // and will execute. Either way we have correct behavior and nobody is
         // orphaned on the wait queue.
-        __futex_wake_ex(&mutex->state, shared, 1);
+        __futex_wake_one_preferring_ex(&mutex->state, shared, __mutex_wake_bitset());
     }
 }
 
@@ -427,7 +815,15 @@ static int __pthread_mutex_lock_with_timeout(pthread_mutex_internal_t* mutex,
 
     // Handle common case first.
     if ( __predict_true(mtype == MUTEX_TYPE_BITS_NORMAL) ) {
-        return __pthread_normal_mutex_lock(mutex, shared, use_realtime_clock, abs_timeout_or_null);
+        return __pthread_normal_mutex_lock(mutex, mtype, shared, use_realtime_clock,
+                                           abs_timeout_or_null);
+    }
+    if (old_state == PI_MUTEX_STATE) {
+        return PIMutexTimedLock(mutex->ToPIMutex(), use_realtime_clock, abs_timeout_or_null);
+    }
+    if (mtype == MUTEX_TYPE_BITS_ADAPTIVE) {
+        return __pthread_normal_mutex_lock(mutex, mtype, shared, use_realtime_clock,
+                                           abs_timeout_or_null);
     }
 
     // Do we already own this recursive or error-check mutex?
@@ -517,7 +913,8 @@ int pthread_mutex_lock(pthread_mutex_t* mutex_interface) {
     uint16_t shared = (old_state & MUTEX_SHARED_MASK);
     // Avoid slowing down fast path of normal mutex lock operation.
     if (__predict_true(mtype == MUTEX_TYPE_BITS_NORMAL)) {
-      if (__predict_true(__pthread_normal_mutex_trylock(mutex, shared) == 0)) {
+      if (__predict_true(__pthread_normal_mutex_trylock(mutex, MUTEX_TYPE_BITS_NORMAL,
+                                                        shared) == 0)) {
         return 0;
       }
     }
@@ -542,7 +939,14 @@ int pthread_mutex_unlock(pthread_mutex_t* mutex_interface) {
 
     // Handle common case first.
     if (__predict_true(mtype == MUTEX_TYPE_BITS_NORMAL)) {
-        __pthread_normal_mutex_unlock(mutex, shared);
+        __pthread_normal_mutex_unlock(mutex, mtype, shared);
+        return 0;
+    }
+    if (old_state == PI_MUTEX_STATE) {
+        return PIMutexUnlock(mutex->ToPIMutex());
+    }
+    if (mtype == MUTEX_TYPE_BITS_ADAPTIVE) {
+        __pthread_normal_mutex_unlock(mutex, mtype, shared);
         return 0;
     }
 
@@ -589,7 +993,14 @@ int pthread_mutex_trylock(pthread_mutex_t* mutex_interface) {
 
     // Handle common case first.
     if (__predict_true(mtype == MUTEX_TYPE_BITS_NORMAL)) {
-        return __pthread_normal_mutex_trylock(mutex, shared);
+        return __pthread_normal_mutex_trylock(mutex, mtype, shared);
+    }
+    if (old_state == PI_MUTEX_STATE) {
+        int result = PIMutexTryLock(mutex->ToPIMutex());
+        return (result == EDEADLK) ? EBUSY : result;
+    }
+    if (mtype == MUTEX_TYPE_BITS_ADAPTIVE) {
+        return __pthread_normal_mutex_trylock(mutex, mtype, shared);
     }
 
     // Do we already own this recursive or error-check mutex?
@@ -637,9 +1048,50 @@ int pthread_mutex_timedlock(pthread_mutex_t* mutex_interface, const timespec* ab
                                              true, abs_timeout);
 }
 
+// Only normal and adaptive mutexes can have condition variable waiters requeued onto them:
+// their futex word holds nothing but the state, and unlocking wakes a waiter whenever it's
+// locked_contended. Process-shared mutexes are excluded because the condition variable would
+// need to be process-shared too, and then the mutex address means nothing to other processes.
+volatile void* __pthread_mutex_requeue_futex(pthread_mutex_t* mutex_interface) {
+    pthread_mutex_internal_t* mutex = __get_internal_mutex(mutex_interface);
+    uint16_t old_state = atomic_load_explicit(&mutex->state, memory_order_relaxed);
+    uint16_t mtype = (old_state & MUTEX_TYPE_MASK);
+    if ((old_state & MUTEX_SHARED_MASK) != 0 || old_state == PI_MUTEX_STATE ||
+        (mtype != MUTEX_TYPE_BITS_NORMAL && mtype != MUTEX_TYPE_BITS_ADAPTIVE)) {
+        return nullptr;
+    }
+    return &mutex->state;
+}
+
+// Waiters requeued by pthread_cond_broadcast sleep on the mutex futex without having set
+// locked_contended themselves, so a thread leaving pthread_cond_wait can't take the mutex
+// with the uncontended fast path: nothing would wake the others when it unlocked.
+void __pthread_mutex_lock_requeued(pthread_mutex_t* mutex_interface) {
+    pthread_mutex_internal_t* mutex = __get_internal_mutex(mutex_interface);
+    uint16_t old_state = atomic_load_explicit(&mutex->state, memory_order_relaxed);
+    uint16_t mtype = (old_state & MUTEX_TYPE_MASK);
+    uint16_t shared = (old_state & MUTEX_SHARED_MASK);
+
+    const uint16_t unlocked         = mtype | shared | MUTEX_STATE_BITS_UNLOCKED;
+    const uint16_t locked_contended = mtype | shared | MUTEX_STATE_BITS_LOCKED_CONTENDED;
+
+    while (atomic_exchange_explicit(&mutex->state, locked_contended,
+                                    memory_order_acquire) != unlocked) {
+        __futex_wait_ex(&mutex->state, shared, locked_contended, false, nullptr);
+    }
+}
+
 int pthread_mutex_destroy(pthread_mutex_t* mutex_interface) {
     pthread_mutex_internal_t* mutex = __get_internal_mutex(mutex_interface);
     uint16_t old_state = atomic_load_explicit(&mutex->state, memory_order_relaxed);
+    if (old_state == PI_MUTEX_STATE) {
+        int result = PIMutexDestroy(mutex->ToPIMutex());
+        if (result == 0) {
+            mutex->FreePIMutex();
+            atomic_store_explicit(&mutex->state, 0xffff, memory_order_relaxed);
+        }
+        return result;
+    }
     // Store 0xffff to make the mutex unusable. Although POSIX standard says it is undefined
     // behavior to destroy a locked mutex, we prefer not to change mutex->state in that situation.
     if (MUTEX_STATE_BITS_IS_UNLOCKED(old_state) &&
@@ -27,7 +27,9 @@
  */
 
 #include <errno.h>
+#include <malloc.h>
 #include <stdatomic.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "pthread_internal.h"
@@ -55,19 +57,26 @@
  *  - This implementation will return EDEADLK in "write after write" and "read after
  *    write" cases and will deadlock in write after read case.
  *
+ * A PTHREAD_RWLOCK_SCALABLE_READERS_NP rwlock doesn't count readers in its state. Each reader
+ * instead counts itself in one of RWLOCK_READER_SLOTS cache-line-sized slots, picked by its tid,
+ * so readers on different cores don't write to the same cache line. The state then only holds
+ * the writer flag and the pending flags. A writer sets the writer flag first, which stops new
+ * readers, then waits for every slot to drain. As readers can't get in while a writer is
+ * waiting, a writer can't be starved, and recursive read locking can deadlock like it does for
+ * PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP.
  */
 
 // A rwlockattr is implemented as a 32-bit integer which has following fields:
 //  bits    name              description
-//   1     rwlock_kind       have rwlock preference like PTHREAD_RWLOCK_PREFER_READER_NP.
+//  2-1     rwlock_kind       have rwlock preference like PTHREAD_RWLOCK_PREFER_READER_NP.
 //   0      process_shared    set to 1 if the rwlock is shared between processes.
 
 #define RWLOCKATTR_PSHARED_SHIFT 0
 #define RWLOCKATTR_KIND_SHIFT    1
 
 #define RWLOCKATTR_PSHARED_MASK  1
-#define RWLOCKATTR_KIND_MASK     2
-#define RWLOCKATTR_RESERVED_MASK (~3)
+#define RWLOCKATTR_KIND_MASK     6
+#define RWLOCKATTR_RESERVED_MASK (~7)
 
 static inline __always_inline __always_inline bool __rwlockattr_getpshared(const pthread_rwlockattr_t* attr) {
   return (*attr & RWLOCKATTR_PSHARED_MASK) >> RWLOCKATTR_PSHARED_SHIFT;
@@ -126,7 +135,8 @@ int pthread_rwlockattr_getkind_np(const pthread_rwlockattr_t* attr, int* pref) {
 int pthread_rwlockattr_setkind_np(pthread_rwlockattr_t* attr, int pref) {
   switch (pref) {
     case PTHREAD_RWLOCK_PREFER_READER_NP:   // Fall through.
-    case PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP:
+    case PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP:   // Fall through.
+    case PTHREAD_RWLOCK_SCALABLE_READERS_NP:
       __rwlockattr_setkind(attr, pref);
       return 0;
     default:
@@ -154,6 +164,16 @@ int pthread_rwlockattr_setkind_np(pthread_rwlockattr_t* attr, int pref) {
 #define STATE_HAVE_PENDING_READERS_OR_WRITERS_FLAG \
           (STATE_HAVE_PENDING_READERS_FLAG | STATE_HAVE_PENDING_WRITERS_FLAG)
 
+#define RWLOCK_READER_SLOTS 16
+
+struct rwlock_reader_slot_t {
+  atomic_int count;  // Count of readers holding the lock through this slot.
+  char __pad[60];
+} __attribute__((aligned(64)));
+
+// pthread_rwlock_t is only 4-byte aligned, so the pointer has to be too.
+typedef rwlock_reader_slot_t* rwlock_reader_slots_t __attribute__((aligned(4)));
+
 struct pthread_rwlock_internal_t {
   atomic_int state;
   atomic_int writer_tid;
@@ -174,10 +194,11 @@ struct pthread_rwlock_internal_t {
   uint32_t pending_reader_wakeup_serial;  // Pending reader threads wait on this address by futex_wait.
   uint32_t pending_writer_wakeup_serial;  // Pending writer threads wait on this address by futex_wait.
 
+  // Only set for PTHREAD_RWLOCK_SCALABLE_READERS_NP rwlocks, which can't be process-shared.
+  rwlock_reader_slots_t reader_slots;
+
 #if defined(__LP64__)
-  char __reserved[20];
-#else
-  char __reserved[4];
+  char __reserved[12];
 #endif
 };
 
@@ -238,12 +259,29 @@ int pthread_rwlock_init(pthread_rwlock_t* rwlock_interface, const pthread_rwlock
       case PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP:
         rwlock->writer_nonrecursive_preferred = true;
         break;
+      case PTHREAD_RWLOCK_SCALABLE_READERS_NP:
+        // The writer flag already keeps new readers out, so no preference is needed.
+        rwlock->writer_nonrecursive_preferred = false;
+        break;
       default:
         return EINVAL;
     }
     if ((*attr & RWLOCKATTR_RESERVED_MASK) != 0) {
       return EINVAL;
     }
+    if (kind == PTHREAD_RWLOCK_SCALABLE_READERS_NP) {
+      // The reader slots live in this process' heap.
+      if (rwlock->pshared) {
+        return ENOTSUP;
+      }
+      size_t size = sizeof(rwlock_reader_slot_t) * RWLOCK_READER_SLOTS;
+      rwlock->reader_slots = static_cast<rwlock_reader_slot_t*>(
+          memalign(alignof(rwlock_reader_slot_t), size));
+      if (rwlock->reader_slots == nullptr) {
+        return ENOMEM;
+      }
+      memset(rwlock->reader_slots, 0, size);
+    }
   }
 
   atomic_init(&rwlock->state, 0);
@@ -257,9 +295,51 @@ int pthread_rwlock_destroy(pthread_rwlock_t* rwlock_interface) {
   if (atomic_load_explicit(&rwlock->state, memory_order_relaxed) != 0) {
     return EBUSY;
   }
+  if (rwlock->reader_slots != nullptr) {
+    for (size_t i = 0; i < RWLOCK_READER_SLOTS; ++i) {
+      if (atomic_load_explicit(&rwlock->reader_slots[i].count, memory_order_relaxed) != 0) {
+        return EBUSY;
+      }
+    }
+    free(rwlock->reader_slots);
+    rwlock->reader_slots = nullptr;
+  }
   return 0;
 }
 
+static inline __always_inline atomic_int* __rwlock_reader_count(pthread_rwlock_internal_t* rwlock) {
+  return &rwlock->reader_slots[__get_thread()->tid & (RWLOCK_READER_SLOTS - 1)].count;
+}
+
+static inline __always_inline void __rwlock_release_reader_slot(pthread_rwlock_internal_t* rwlock,
+                                                                atomic_int* count) {
+  int old_count = atomic_fetch_sub_explicit(count, 1, memory_order_release);
+  // Pairs with the fence in __rwlock_drain_reader_slots: either the writer sees our decrement,
+  // or we see its writer flag and wake it up.
+  atomic_thread_fence(memory_order_seq_cst);
+  if (old_count == 1 &&
+      __state_owned_by_writer(atomic_load_explicit(&rwlock->state, memory_order_relaxed))) {
+    __futex_wake_ex(count, false, 1);
+  }
+}
+
+static inline __always_inline int __pthread_rwlock_scalable_tryrdlock(
+    pthread_rwlock_internal_t* rwlock) {
+  if (__state_owned_by_writer(atomic_load_explicit(&rwlock->state, memory_order_relaxed))) {
+    return EBUSY;
+  }
+  atomic_int* count = __rwlock_reader_count(rwlock);
+  atomic_fetch_add_explicit(count, 1, memory_order_relaxed);
+  atomic_thread_fence(memory_order_seq_cst);
+  if (__predict_true(!__state_owned_by_writer(atomic_load_explicit(&rwlock->state,
+                                                                   memory_order_acquire)))) {
+    return 0;
+  }
+  // A writer got in first, so back out and let it drain the slots.
+  __rwlock_release_reader_slot(rwlock, count);
+  return EBUSY;
+}
+
 static inline __always_inline bool __can_acquire_read_lock(int old_state,
                                                              bool writer_nonrecursive_preferred) {
   // If writer is preferred with nonrecursive reader, we prevent further readers from acquiring
@@ -270,6 +350,10 @@ static inline __always_inline bool __can_acquire_read_lock(int old_state,
 }
 
 static inline __always_inline int __pthread_rwlock_tryrdlock(pthread_rwlock_internal_t* rwlock) {
+  if (__predict_false(rwlock->reader_slots != nullptr)) {
+    return __pthread_rwlock_scalable_tryrdlock(rwlock);
+  }
+
   int old_state = atomic_load_explicit(&rwlock->state, memory_order_relaxed);
 
   while (__predict_true(__can_acquire_read_lock(old_state, rwlock->writer_nonrecursive_preferred))) {
@@ -345,16 +429,65 @@ static inline __always_inline bool __can_acquire_write_lock(int old_state) {
   return !__state_owned_by_readers_or_writer(old_state);
 }
 
-static inline __always_inline int __pthread_rwlock_trywrlock(pthread_rwlock_internal_t* rwlock) {
+static void __pthread_rwlock_wake_pending(pthread_rwlock_internal_t* rwlock);
+
+// Waits until no reader holds any of the reader slots, after the writer flag is set. If that
+// fails, the writer flag is given up again.
+static int __rwlock_drain_reader_slots(pthread_rwlock_internal_t* rwlock, bool wait,
+                                       const timespec* abs_timeout_or_null) {
+  atomic_thread_fence(memory_order_seq_cst);
+  int result = 0;
+  for (size_t i = 0; i < RWLOCK_READER_SLOTS && result == 0; ++i) {
+    atomic_int* count = &rwlock->reader_slots[i].count;
+    int old_count;
+    while ((old_count = atomic_load_explicit(count, memory_order_acquire)) != 0) {
+      if (!wait) {
+        result = EBUSY;
+        break;
+      }
+      result = check_timespec(abs_timeout_or_null, true);
+      if (result != 0) {
+        break;
+      }
+      if (__futex_wait_ex(count, false, old_count, true, abs_timeout_or_null) == -ETIMEDOUT) {
+        result = ETIMEDOUT;
+        break;
+      }
+    }
+  }
+  if (result != 0) {
+    int old_state = atomic_fetch_and_explicit(&rwlock->state, ~STATE_OWNED_BY_WRITER_FLAG,
+                                              memory_order_release);
+    if (__state_have_pending_readers_or_writers(old_state)) {
+      __pthread_rwlock_wake_pending(rwlock);
+    }
+  }
+  return result;
+}
+
+static inline __always_inline bool __pthread_rwlock_try_set_writer_flag(
+    pthread_rwlock_internal_t* rwlock) {
   int old_state = atomic_load_explicit(&rwlock->state, memory_order_relaxed);
 
   while (__predict_true(__can_acquire_write_lock(old_state))) {
     if (__predict_true(atomic_compare_exchange_weak_explicit(&rwlock->state, &old_state,
           __state_add_writer_flag(old_state), memory_order_acquire, memory_order_relaxed))) {
+      return true;
+    }
+  }
+  return false;
+}
 
-      atomic_store_explicit(&rwlock->writer_tid, __get_thread()->tid, memory_order_relaxed);
-      return 0;
+static inline __always_inline int __pthread_rwlock_trywrlock(pthread_rwlock_internal_t* rwlock) {
+  if (__predict_true(__pthread_rwlock_try_set_writer_flag(rwlock))) {
+    if (__predict_false(rwlock->reader_slots != nullptr)) {
+      int result = __rwlock_drain_reader_slots(rwlock, false, nullptr);
+      if (result != 0) {
+        return result;
+      }
     }
+    atomic_store_explicit(&rwlock->writer_tid, __get_thread()->tid, memory_order_relaxed);
+    return 0;
   }
   return EBUSY;
 }
@@ -366,11 +499,17 @@ static int __pthread_rwlock_timedwrlock(pthread_rwlock_internal_t* rwlock,
     return EDEADLK;
   }
   while (true) {
-    int result = __pthread_rwlock_trywrlock(rwlock);
-    if (result == 0) {
-      return result;
+    if (__pthread_rwlock_try_set_writer_flag(rwlock)) {
+      if (rwlock->reader_slots != nullptr) {
+        int result = __rwlock_drain_reader_slots(rwlock, true, abs_timeout_or_null);
+        if (result != 0) {
+          return result;
+        }
+      }
+      atomic_store_explicit(&rwlock->writer_tid, __get_thread()->tid, memory_order_relaxed);
+      return 0;
     }
-    result = check_timespec(abs_timeout_or_null, true);
+    int result = check_timespec(abs_timeout_or_null, true);
     if (result != 0) {
       return result;
     }
@@ -447,10 +586,26 @@ int pthread_rwlock_trywrlock(pthread_rwlock_t* rwlock_interface) {
   return __pthread_rwlock_trywrlock(__get_internal_rwlock(rwlock_interface));
 }
 
+static int __pthread_rwlock_scalable_rdunlock(pthread_rwlock_internal_t* rwlock) {
+  atomic_int* count = __rwlock_reader_count(rwlock);
+  if (atomic_load_explicit(count, memory_order_relaxed) <= 0) {
+    return EPERM;
+  }
+  __rwlock_release_reader_slot(rwlock, count);
+  return 0;
+}
+
 int pthread_rwlock_unlock(pthread_rwlock_t* rwlock_interface) {
   pthread_rwlock_internal_t* rwlock = __get_internal_rwlock(rwlock_interface);
 
   int old_state = atomic_load_explicit(&rwlock->state, memory_order_relaxed);
+  if (__predict_false(rwlock->reader_slots != nullptr)) {
+    // The writer flag is also set while a writer waits for readers to leave.
+    if (!__state_owned_by_writer(old_state) ||
+        atomic_load_explicit(&rwlock->writer_tid, memory_order_relaxed) != __get_thread()->tid) {
+      return __pthread_rwlock_scalable_rdunlock(rwlock);
+    }
+  }
   if (__state_owned_by_writer(old_state)) {
     if (atomic_load_explicit(&rwlock->writer_tid, memory_order_relaxed) != __get_thread()->tid) {
       return EPERM;
@@ -473,6 +628,11 @@ int pthread_rwlock_unlock(pthread_rwlock_t* rwlock_interface) {
     return EPERM;
   }
 
+  __pthread_rwlock_wake_pending(rwlock);
+  return 0;
+}
+
+static void __pthread_rwlock_wake_pending(pthread_rwlock_internal_t* rwlock) {
   // Wake up pending readers or writers.
   rwlock->pending_lock.lock();
   if (rwlock->pending_writer_count != 0) {
@@ -491,5 +651,4 @@ int pthread_rwlock_unlock(pthread_rwlock_t* rwlock_interface) {
     // It happens when waiters are woken up by timeout.
     rwlock->pending_lock.unlock();
   }
-  return 0;
 }
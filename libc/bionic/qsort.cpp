@@ -0,0 +1,420 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// qsort and qsort_r are Orson Peters' pattern-defeating quicksort
+// (https://github.com/orlp/pdqsort): an introsort that partitions with the branchless block
+// scheme from "BlockQuicksort: How Branch Mispredictions don't affect Quicksort" (Edelkamp and
+// Weiss, 2016), notices runs that are already sorted, groups elements equal to the pivot, and
+// shuffles its way out of patterns that would otherwise make it quadratic, falling back to
+// heapsort if that doesn't work.
+//
+// Unlike the C++ original, elements only ever move by swapping, so nothing has to be copied out
+// of the array and any element size works without a temporary buffer. The pivot stays at the
+// start of the range while it's partitioned. Swaps of 4-, 8- and 16-byte elements are done as
+// single loads and stores.
+
+namespace {
+
+constexpr size_t kInsertionSortThreshold = 24;
+constexpr size_t kNintherThreshold = 128;
+constexpr size_t kPartialInsertionSortLimit = 8;
+constexpr size_t kBlockSize = 64;
+
+struct Chunk16 {
+  uint64_t lo;
+  uint64_t hi;
+};
+
+template <typename T>
+struct FixedSwapper {
+  explicit FixedSwapper(size_t) {}
+  size_t size() const { return sizeof(T); }
+  void Swap(char* a, char* b) const {
+    T ta, tb;
+    memcpy(&ta, a, sizeof(T));
+    memcpy(&tb, b, sizeof(T));
+    memcpy(a, &tb, sizeof(T));
+    memcpy(b, &ta, sizeof(T));
+  }
+};
+
+struct GenericSwapper {
+  explicit GenericSwapper(size_t size) : size_(size) {}
+  size_t size() const { return size_; }
+  void Swap(char* a, char* b) const {
+    size_t n = size_;
+    for (; n >= sizeof(uint64_t); n -= sizeof(uint64_t)) {
+      uint64_t ta, tb;
+      memcpy(&ta, a, sizeof(ta));
+      memcpy(&tb, b, sizeof(tb));
+      memcpy(a, &tb, sizeof(tb));
+      memcpy(b, &ta, sizeof(ta));
+      a += sizeof(uint64_t);
+      b += sizeof(uint64_t);
+    }
+    for (; n > 0; --n) {
+      char t = *a;
+      *a++ = *b;
+      *b++ = t;
+    }
+  }
+
+ private:
+  size_t size_;
+};
+
+typedef int (*Comparator)(const void*, const void*, void*);
+
+template <typename Swapper>
+class Sorter {
+ public:
+  Sorter(size_t size, Comparator cmp, void* arg) : swapper_(size), cmp_(cmp), arg_(arg) {}
+
+  void Sort(char* begin, size_t count) {
+    size_t log2 = 0;
+    for (size_t n = count; n > 1; n >>= 1) {
+      ++log2;
+    }
+    Loop(begin, At(begin, count), log2, true);
+  }
+
+ private:
+  size_t Size() const { return swapper_.size(); }
+  char* At(char* p, size_t i) const { return p + i * Size(); }
+  size_t Distance(const char* first, const char* last) const { return (last - first) / Size(); }
+  void Swap(char* a, char* b) const { swapper_.Swap(a, b); }
+  bool Less(const char* a, const char* b) const { return cmp_(a, b, arg_) < 0; }
+
+  void Sort2(char* a, char* b) const {
+    if (Less(b, a)) Swap(a, b);
+  }
+
+  void Sort3(char* a, char* b, char* c) const {
+    Sort2(a, b);
+    Sort2(b, c);
+    Sort2(a, b);
+  }
+
+  // Sorts [begin, end). If unguarded, *(begin - 1) must be no greater than any element in the
+  // range, which saves checking for the beginning.
+  void InsertionSort(char* begin, char* end, bool unguarded) const {
+    if (begin == end) return;
+    size_t size = Size();
+    for (char* cur = begin + size; cur != end; cur += size) {
+      for (char* p = cur; (unguarded || p != begin) && Less(p, p - size); p -= size) {
+        Swap(p, p - size);
+      }
+    }
+  }
+
+  // Tries insertion sort, but gives up and returns false if it has to move elements more than
+  // kPartialInsertionSortLimit places in total.
+  bool PartialInsertionSort(char* begin, char* end) const {
+    if (begin == end) return true;
+    size_t size = Size();
+    size_t moves = 0;
+    for (char* cur = begin + size; cur != end; cur += size) {
+      for (char* p = cur; p != begin && Less(p, p - size); p -= size) {
+        Swap(p, p - size);
+        ++moves;
+      }
+      if (moves > kPartialInsertionSortLimit) return false;
+    }
+    return true;
+  }
+
+  void SiftDown(char* begin, size_t root, size_t count) const {
+    while (true) {
+      size_t child = 2 * root + 1;
+      if (child >= count) return;
+      if (child + 1 < count && Less(At(begin, child), At(begin, child + 1))) ++child;
+      if (!Less(At(begin, root), At(begin, child))) return;
+      Swap(At(begin, root), At(begin, child));
+      root = child;
+    }
+  }
+
+  void HeapSort(char* begin, char* end) const {
+    size_t count = Distance(begin, end);
+    for (size_t i = count / 2; i > 0; --i) {
+      SiftDown(begin, i - 1, count);
+    }
+    for (size_t i = count - 1; i > 0; --i) {
+      Swap(begin, At(begin, i));
+      SiftDown(begin, 0, i);
+    }
+  }
+
+  // Partitions [begin, end) around the pivot at *begin, putting elements equal to it on the
+  // left. Only used when the pivot is known to be no greater than anything in the range, so the
+  // left side is then all equal to it. Returns the pivot's final position.
+  char* PartitionLeft(char* begin, char* end) const {
+    size_t size = Size();
+    char* pivot = begin;
+    char* first = begin;
+    char* last = end;
+
+    while (Less(pivot, last -= size)) {}
+    if (last + size == end) {
+      while (first < last && !Less(pivot, first += size)) {}
+    } else {
+      while (!Less(pivot, first += size)) {}
+    }
+
+    while (first < last) {
+      Swap(first, last);
+      while (Less(pivot, last -= size)) {}
+      while (!Less(pivot, first += size)) {}
+    }
+
+    Swap(begin, last);
+    return last;
+  }
+
+  // Swaps the elements at the given offsets from left_base (counting up) and right_base
+  // (counting down).
+  void SwapOffsets(char* left_base, char* right_base, const uint8_t* offsets_l,
+                   const uint8_t* offsets_r, size_t count) const {
+    for (size_t i = 0; i < count; ++i) {
+      Swap(At(left_base, offsets_l[i]), right_base - offsets_r[i] * Size());
+    }
+  }
+
+  // Partitions [begin, end) around the pivot at *begin, putting elements equal to it on the
+  // right. The median-of-three pivot selection guarantees an element no less than the pivot
+  // past it. Returns the pivot's final position, and sets *already_partitioned if no elements
+  // had to be swapped.
+  char* PartitionRight(char* begin, char* end, bool* already_partitioned) const {
+    size_t size = Size();
+    char* pivot = begin;
+    char* first = begin;
+    char* last = end;
+
+    // Find the first element that belongs on the right...
+    while (Less(first += size, pivot)) {}
+    // ...and the last that belongs on the left, which needs a guard if there wasn't an element
+    // on the left before first.
+    if (first - size == begin) {
+      while (first < last && !Less(last -= size, pivot)) {}
+    } else {
+      while (!Less(last -= size, pivot)) {}
+    }
+
+    *already_partitioned = first >= last;
+    if (!*already_partitioned) {
+      Swap(first, last);
+      first += size;
+
+      // Look at a block from each end at a time, recording which elements are on the wrong side
+      // without branching on the comparisons, and then swap as many pairs as we found.
+      uint8_t offsets_l[kBlockSize];
+      uint8_t offsets_r[kBlockSize];
+      char* offsets_l_base = first;
+      char* offsets_r_base = last;
+      size_t num_l = 0, num_r = 0, start_l = 0, start_r = 0;
+
+      while (first < last) {
+        size_t num_unknown = Distance(first, last);
+        size_t left_split = (num_l == 0) ? ((num_r == 0) ? num_unknown / 2 : num_unknown) : 0;
+        size_t right_split = (num_r == 0) ? (num_unknown - left_split) : 0;
+
+        if (left_split > kBlockSize) left_split = kBlockSize;
+        for (size_t i = 0; i < left_split; ++i) {
+          offsets_l[num_l] = i;
+          num_l += !Less(first, pivot);
+          first += size;
+        }
+
+        if (right_split > kBlockSize) right_split = kBlockSize;
+        for (size_t i = 0; i < right_split; ++i) {
+          last -= size;
+          offsets_r[num_r] = i + 1;
+          num_r += Less(last, pivot);
+        }
+
+        size_t num = (num_l < num_r) ? num_l : num_r;
+        SwapOffsets(offsets_l_base, offsets_r_base, offsets_l + start_l, offsets_r + start_r, num);
+        num_l -= num;
+        num_r -= num;
+        start_l += num;
+        start_r += num;
+
+        if (num_l == 0) {
+          start_l = 0;
+          offsets_l_base = first;
+        }
+        if (num_r == 0) {
+          start_r = 0;
+          offsets_r_base = last;
+        }
+      }
+
+      // Everything has been looked at, but one side may still have elements to move across the
+      // boundary.
+      if (num_l != 0) {
+        const uint8_t* offsets = offsets_l + start_l;
+        while (num_l-- != 0) {
+          Swap(At(offsets_l_base, offsets[num_l]), last -= size);
+        }
+        first = last;
+      }
+      if (num_r != 0) {
+        const uint8_t* offsets = offsets_r + start_r;
+        while (num_r-- != 0) {
+          Swap(offsets_r_base - offsets[num_r] * size, first);
+          first += size;
+        }
+      }
+    }
+
+    char* pivot_pos = first - size;
+    Swap(begin, pivot_pos);
+    return pivot_pos;
+  }
+
+  void Loop(char* begin, char* end, size_t bad_allowed, bool leftmost) {
+    size_t size = Size();
+    while (true) {
+      size_t count = Distance(begin, end);
+      if (count < kInsertionSortThreshold) {
+        InsertionSort(begin, end, !leftmost);
+        return;
+      }
+
+      // Choose a pivot, the median of three or of three medians of three, and move it to begin.
+      size_t s2 = count / 2;
+      if (count > kNintherThreshold) {
+        Sort3(begin, At(begin, s2), end - size);
+        Sort3(At(begin, 1), At(begin, s2 - 1), end - 2 * size);
+        Sort3(At(begin, 2), At(begin, s2 + 1), end - 3 * size);
+        Sort3(At(begin, s2 - 1), At(begin, s2), At(begin, s2 + 1));
+        Swap(begin, At(begin, s2));
+      } else {
+        Sort3(At(begin, s2), begin, end - size);
+      }
+
+      // If the element before this range (the pivot of an earlier partition, no greater than
+      // anything here) equals our pivot, the range has lots of equal elements. Put them all on
+      // the left, where they're already sorted, and carry on with the rest.
+      if (!leftmost && !Less(begin - size, begin)) {
+        begin = PartitionLeft(begin, end) + size;
+        continue;
+      }
+
+      bool already_partitioned;
+      char* pivot_pos = PartitionRight(begin, end, &already_partitioned);
+
+      size_t l_count = Distance(begin, pivot_pos);
+      size_t r_count = Distance(pivot_pos + size, end);
+      bool highly_unbalanced = l_count < count / 8 || r_count < count / 8;
+
+      if (highly_unbalanced) {
+        // Too many bad pivots means the input is hostile: finish with heapsort.
+        if (--bad_allowed == 0) {
+          HeapSort(begin, end);
+          return;
+        }
+
+        // Otherwise shuffle some elements around to break up whatever pattern caused this.
+        if (l_count >= kInsertionSortThreshold) {
+          Swap(begin, At(begin, l_count / 4));
+          Swap(pivot_pos - size, pivot_pos - (l_count / 4) * size);
+          if (l_count > kNintherThreshold) {
+            Swap(At(begin, 1), At(begin, l_count / 4 + 1));
+            Swap(At(begin, 2), At(begin, l_count / 4 + 2));
+            Swap(pivot_pos - 2 * size, pivot_pos - (l_count / 4 + 1) * size);
+            Swap(pivot_pos - 3 * size, pivot_pos - (l_count / 4 + 2) * size);
+          }
+        }
+        if (r_count >= kInsertionSortThreshold) {
+          Swap(pivot_pos + size, At(pivot_pos, 1 + r_count / 4));
+          Swap(end - size, end - (r_count / 4) * size);
+          if (r_count > kNintherThreshold) {
+            Swap(At(pivot_pos, 2), At(pivot_pos, 2 + r_count / 4));
+            Swap(At(pivot_pos, 3), At(pivot_pos, 3 + r_count / 4));
+            Swap(end - 2 * size, end - (1 + r_count / 4) * size);
+            Swap(end - 3 * size, end - (2 + r_count / 4) * size);
+          }
+        }
+      } else if (already_partitioned && PartialInsertionSort(begin, pivot_pos) &&
+                 PartialInsertionSort(pivot_pos + size, end)) {
+        // A decent pivot that didn't need to move anything suggests the input was already
+        // (nearly) sorted, and insertion sort just confirmed it.
+        return;
+      }
+
+      // Recurse into the left side, and loop on the right.
+      Loop(begin, pivot_pos, bad_allowed, leftmost);
+      begin = pivot_pos + size;
+      leftmost = false;
+    }
+  }
+
+  Swapper swapper_;
+  Comparator cmp_;
+  void* arg_;
+};
+
+template <typename Swapper>
+void SortWith(void* base, size_t count, size_t size, Comparator cmp, void* arg) {
+  Sorter<Swapper>(size, cmp, arg).Sort(reinterpret_cast<char*>(base), count);
+}
+
+int CallQsortComparator(const void* lhs, const void* rhs, void* arg) {
+  return reinterpret_cast<int (*)(const void*, const void*)>(arg)(lhs, rhs);
+}
+
+}  // namespace
+
+void qsort_r(void* base, size_t count, size_t size,
+             int (*cmp)(const void*, const void*, void*), void* arg) {
+  if (count < 2 || size == 0) return;
+
+  switch (size) {
+    case sizeof(uint32_t):
+      SortWith<FixedSwapper<uint32_t>>(base, count, size, cmp, arg);
+      break;
+    case sizeof(uint64_t):
+      SortWith<FixedSwapper<uint64_t>>(base, count, size, cmp, arg);
+      break;
+    case sizeof(Chunk16):
+      SortWith<FixedSwapper<Chunk16>>(base, count, size, cmp, arg);
+      break;
+    default:
+      SortWith<GenericSwapper>(base, count, size, cmp, arg);
+      break;
+  }
+}
+
+void qsort(void* base, size_t count, size_t size, int (*cmp)(const void*, const void*)) {
+  qsort_r(base, count, size, CallQsortComparator, reinterpret_cast<void*>(cmp));
+}
@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#undef _FORTIFY_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "private/ErrnoRestorer.h"
+
+// The upstream implementation, which resolves one component at a time with lstat and readlink.
+extern "C" char* __realpath_walk(const char*, char*);
+
+// Lets the kernel do the whole resolution: opening the path resolves it, and /proc/self/fd has
+// the result. That's three system calls however deep the path is. Returns false, with errno
+// unchanged, if that didn't work; the component walk then has the final word, so errors are
+// reported the same way whatever the fast path did.
+static bool realpath_fd(const char* path, char* dst) {
+  ErrnoRestorer errno_restorer;
+  int fd = open(path, O_PATH | O_CLOEXEC);
+  if (fd == -1) return false;
+
+  char proc_path[32];
+  snprintf(proc_path, sizeof(proc_path), "/proc/self/fd/%d", fd);
+  ssize_t length = readlink(proc_path, dst, PATH_MAX);
+  close(fd);
+
+  // Without /proc, or for a file that has since been unlinked (when the kernel appends
+  // " (deleted)", which a real name could also end with), leave it to the walk.
+  static const char kDeleted[] = " (deleted)";
+  const ssize_t deleted_length = sizeof(kDeleted) - 1;
+  if (length <= 0 || length >= PATH_MAX || dst[0] != '/' ||
+      (length >= deleted_length &&
+       memcmp(dst + length - deleted_length, kDeleted, deleted_length) == 0)) {
+    return false;
+  }
+  dst[length] = '\0';
+  return true;
+}
+
+char* realpath(const char* path, char* resolved) {
+  if (path != nullptr && path[0] != '\0') {
+    char buf[PATH_MAX];
+    if (realpath_fd(path, buf)) {
+      return (resolved != nullptr) ? strcpy(resolved, buf) : strdup(buf);
+    }
+  }
+  return __realpath_walk(path, resolved);
+}
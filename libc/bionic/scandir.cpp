@@ -51,7 +51,7 @@ class ScandirResult {
 
   bool Add(dirent* entry) {
     if (size_ >= capacity_) {
-      size_t new_capacity = capacity_ + 32;
+      size_t new_capacity = (capacity_ == 0) ? 32 : capacity_ * 2;
       dirent** new_names =
           reinterpret_cast<dirent**>(realloc(names_, new_capacity * sizeof(dirent*)));
       if (new_names == nullptr) {
@@ -86,6 +86,9 @@ class ScandirResult {
     // Allocate the minimum number of bytes necessary, rounded up to a 4-byte boundary.
     size_t size = ((original->d_reclen + 3) & ~3);
     dirent* copy = reinterpret_cast<dirent*>(malloc(size));
+    if (copy == nullptr) {
+      return nullptr;
+    }
     memcpy(copy, original, original->d_reclen);
     return copy;
   }
@@ -112,13 +115,22 @@ int scandirat(int parent_fd, const char* dir_name, dirent*** name_list,
   }
 
   ScandirResult names;
-  dirent* entry;
-  while ((entry = reader.ReadEntry()) != nullptr) {
-    // If we have a filter, skip names that don't match.
-    if (filter != nullptr && !(*filter)(entry)) {
-      continue;
+  dirent* entries[64];
+  int count;
+  while ((count = reader.ReadEntries(entries, 64)) > 0) {
+    for (int i = 0; i < count; ++i) {
+      // If we have a filter, skip names that don't match.
+      if (filter != nullptr && !(*filter)(entries[i])) {
+        continue;
+      }
+      if (!names.Add(entries[i])) {
+        errno = ENOMEM;
+        return -1;
+      }
     }
-    names.Add(entry);
+  }
+  if (count == -1) {
+    return -1;
   }
 
   names.Sort(comparator);
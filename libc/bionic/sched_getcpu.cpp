@@ -29,11 +29,19 @@
 #define _GNU_SOURCE 1
 #include <sched.h>
 
-extern "C" int __getcpu(unsigned*, unsigned*, void*);
+#include "private/bionic_globals.h"
+#include "private/bionic_vdso.h"
 
 int sched_getcpu() {
+  // This is only null on architectures without a vdso.
+  auto vdso_getcpu = reinterpret_cast<decltype(&__getcpu)>(
+    __libc_globals->vdso[VDSO_GETCPU].fn);
+  if (vdso_getcpu == nullptr) {
+    vdso_getcpu = __getcpu;
+  }
+
   unsigned cpu;
-  int rc = __getcpu(&cpu, NULL, NULL);
+  int rc = vdso_getcpu(&cpu, NULL, NULL);
   if (rc == -1) {
     return -1; // errno is already set.
   }
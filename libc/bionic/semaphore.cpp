@@ -36,10 +36,12 @@
 #include <errno.h>
 #include <limits.h>
 #include <stdatomic.h>
+#include <sys/sysinfo.h>
 #include <sys/time.h>
 #include <time.h>
 
 #include "private/bionic_constants.h"
+#include "private/bionic_cpu_relax.h"
 #include "private/bionic_futex.h"
 #include "private/bionic_sdk_version.h"
 #include "private/bionic_time_conversions.h"
@@ -62,6 +64,14 @@
 // wait(1)  ==> 0
 // wait(0)  ==> -1 then wait for a wake up + loop
 // wait(-1) ==> -1 then wait for a wake up + loop
+//
+// That is the protocol for 32-bit, where sem_t is a single word. On LP64 sem_t
+// has room for a separate count of the threads asleep, or about to sleep, in
+// sem_wait or sem_timedwait, that haven't been woken yet. There the value never
+// goes negative: waiters sleep while it is 0, and sem_post wakes one of them
+// only if the count is non-zero, rather than waking all of them whenever a
+// waiter has ever set -1. A waiter that times out or is interrupted takes itself
+// out of the count, so a later sem_post doesn't make a futex syscall for it.
 
 // Use the upper 31-bits for the counter, and the lower one
 // for the shared flag.
@@ -95,6 +105,19 @@ static inline atomic_uint* SEM_TO_ATOMIC_POINTER(sem_t* sem) {
   return reinterpret_cast<atomic_uint*>(&sem->count);
 }
 
+#if defined(__LP64__)
+static inline atomic_uint* SEM_TO_WAITERS_POINTER(sem_t* sem) {
+  static_assert(sizeof(atomic_uint) == sizeof(sem->__reserved[0]),
+                "sem->__reserved[0] should hold an atomic_uint.");
+  return reinterpret_cast<atomic_uint*>(&sem->__reserved[0]);
+}
+
+// How many reads beyond the minimum a waiter spins for before sleeping (see __sem_spin).
+static inline atomic_uint* SEM_TO_SPIN_POINTER(sem_t* sem) {
+  return reinterpret_cast<atomic_uint*>(&sem->__reserved[1]);
+}
+#endif
+
 // Return the shared bitflag from a semaphore counter.
 static inline unsigned int SEM_GET_SHARED(atomic_uint* sem_count_ptr) {
   // memory_order_relaxed is used as SHARED flag will not be changed after init.
@@ -115,6 +138,10 @@ int sem_init(sem_t* sem, int pshared, unsigned int value) {
 
   atomic_uint* sem_count_ptr = SEM_TO_ATOMIC_POINTER(sem);
   atomic_init(sem_count_ptr, count);
+#if defined(__LP64__)
+  atomic_init(SEM_TO_WAITERS_POINTER(sem), 0);
+  atomic_init(SEM_TO_SPIN_POINTER(sem), 0);
+#endif
   return 0;
 }
 
@@ -137,6 +164,7 @@ int sem_unlink(const char*) {
   return -1;
 }
 
+#if !defined(__LP64__)
 // Decrement a semaphore's value atomically,
 // and return the old one. As a special case,
 // this returns immediately if the value is
@@ -158,6 +186,7 @@ static int __sem_dec(atomic_uint* sem_count_ptr) {
 
   return SEMCOUNT_TO_VALUE(old_value);
 }
+#endif
 
 // Same as __sem_dec, but will not touch anything if the
 // value is already negative *or* 0. Returns the old value.
@@ -212,23 +241,133 @@ static int __sem_inc(atomic_uint* sem_count_ptr) {
   return SEMCOUNT_TO_VALUE(old_value);
 }
 
-int sem_wait(sem_t* sem) {
+// Whether any thread has given up on getting the semaphore and gone to sleep.
+static inline bool __sem_has_sleepers(sem_t* sem) {
+#if defined(__LP64__)
+  return atomic_load_explicit(SEM_TO_WAITERS_POINTER(sem), memory_order_relaxed) != 0;
+#else
+  return SEMCOUNT_TO_VALUE(atomic_load_explicit(SEM_TO_ATOMIC_POINTER(sem),
+                                                memory_order_relaxed)) < 0;
+#endif
+}
+
+// Before sleeping, a waiter spins for a few reads of the value in case a post
+// is imminent. It doesn't spin if other waiters are already asleep: a post then
+// goes to one of them, and stealing it would only send that waiter back to sleep.
+//
+// Spinning only pays off if the poster is running on another CPU at the time,
+// which depends on the workload and the machine, so on LP64 each semaphore
+// learns how long to spin for: a spin that succeeds after n reads allows up to
+// 2n extra reads next time, and one that fails halves the allowance. 32-bit has
+// no room for that, so it always spins for just SEM_SPIN_MIN reads. Nothing
+// spins with only one CPU online (get_nprocs is cached, so asking is cheap).
+#define SEM_SPIN_MIN          4
+#define SEM_SPIN_MAX          64
+#define SEM_SPIN_MAX_BACKOFF  4
+
+static bool __sem_spin(sem_t* sem) {
+  if (get_nprocs() < 2) {
+    return false;
+  }
+
+  atomic_uint* sem_count_ptr = SEM_TO_ATOMIC_POINTER(sem);
+#if defined(__LP64__)
+  atomic_uint* spin_ptr = SEM_TO_SPIN_POINTER(sem);
+  unsigned int allowance = atomic_load_explicit(spin_ptr, memory_order_relaxed);
+#else
+  unsigned int allowance = 0;
+#endif
+
+  int backoff = 1;
+  for (unsigned int i = 0; i < SEM_SPIN_MIN + allowance && !__sem_has_sleepers(sem); ++i) {
+    if (__sem_trydec(sem_count_ptr) > 0) {
+#if defined(__LP64__)
+      unsigned int wanted = (2 * i < SEM_SPIN_MAX) ? 2 * i : SEM_SPIN_MAX;
+      if (wanted > allowance) {
+        atomic_store_explicit(spin_ptr, wanted, memory_order_relaxed);
+      }
+#endif
+      return true;
+    }
+    for (int j = 0; j < backoff; ++j) {
+      __cpu_relax();
+    }
+    if (backoff < SEM_SPIN_MAX_BACKOFF) {
+      backoff *= 2;
+    }
+  }
+
+#if defined(__LP64__)
+  if (allowance != 0) {
+    atomic_store_explicit(spin_ptr, allowance / 2, memory_order_relaxed);
+  }
+#endif
+  return false;
+}
+
+// Sleeps until the semaphore can be decremented, then decrements it. Returns 0,
+// or ETIMEDOUT if abs_timeout passes first, or EINTR if a signal interrupts the
+// wait and return_eintr is set.
+static int __sem_wait_slow(sem_t* sem, const timespec* abs_timeout, bool return_eintr) {
   atomic_uint* sem_count_ptr = SEM_TO_ATOMIC_POINTER(sem);
   unsigned int shared = SEM_GET_SHARED(sem_count_ptr);
 
+#if defined(__LP64__)
+  atomic_uint* waiters_ptr = SEM_TO_WAITERS_POINTER(sem);
+
   while (true) {
+    // sem_post increments the value and then reads the sleeper count; we
+    // increment the count and then read the value. Both are sequentially
+    // consistent, so either we see the new value or sem_post sees us and wakes us.
+    atomic_fetch_add(waiters_ptr, 1);
+    unsigned int old_value = atomic_load(sem_count_ptr);
+    if (SEMCOUNT_TO_VALUE(old_value) > 0) {
+      atomic_fetch_sub(waiters_ptr, 1);
+      if (atomic_compare_exchange_weak(sem_count_ptr, &old_value,
+                                       SEMCOUNT_DECREMENT(old_value) | shared)) {
+        return 0;
+      }
+      continue;
+    }
+
+    int ret = __futex_wait_ex(sem_count_ptr, shared, old_value, true, abs_timeout);
+    if (ret != 0) {
+      // Nobody woke us, so nobody took us out of the count.
+      atomic_fetch_sub(waiters_ptr, 1);
+    }
+    if (ret == -ETIMEDOUT || (ret == -EINTR && return_eintr)) {
+      return -ret;
+    }
+  }
+#else
+  while (true) {
+    // Try to grab the semaphore. If the value was 0, this will also change it to -1.
     if (__sem_dec(sem_count_ptr) > 0) {
       return 0;
     }
 
-    int result = __futex_wait_ex(sem_count_ptr, shared, shared | SEMCOUNT_MINUS_ONE, false, nullptr);
-    if (bionic_get_application_target_sdk_version() > 23) {
-      if (result ==-EINTR) {
-        errno = EINTR;
-        return -1;
-      }
+    // Contention detected. Wait for a wakeup event.
+    int ret = __futex_wait_ex(sem_count_ptr, shared, shared | SEMCOUNT_MINUS_ONE, true,
+                              abs_timeout);
+    if (ret == -ETIMEDOUT || (ret == -EINTR && return_eintr)) {
+      return -ret;
     }
   }
+#endif
+}
+
+int sem_wait(sem_t* sem) {
+  atomic_uint* sem_count_ptr = SEM_TO_ATOMIC_POINTER(sem);
+  if (__sem_trydec(sem_count_ptr) > 0 || __sem_spin(sem)) {
+    return 0;
+  }
+
+  int result = __sem_wait_slow(sem, nullptr, bionic_get_application_target_sdk_version() > 23);
+  if (result != 0) {
+    errno = result;
+    return -1;
+  }
+  return 0;
 }
 
 int sem_timedwait(sem_t* sem, const timespec* abs_timeout) {
@@ -248,23 +387,17 @@ int sem_timedwait(sem_t* sem, const timespec* abs_timeout) {
     return -1;
   }
 
-  unsigned int shared = SEM_GET_SHARED(sem_count_ptr);
-
-  while (true) {
-    // Try to grab the semaphore. If the value was 0, this will also change it to -1.
-    if (__sem_dec(sem_count_ptr) > 0) {
-      return 0;
-    }
-
-    // Contention detected. Wait for a wakeup event.
-    int result = __futex_wait_ex(sem_count_ptr, shared, shared | SEMCOUNT_MINUS_ONE, true, abs_timeout);
+  if (__sem_spin(sem)) {
+    return 0;
+  }
 
-    // Return in case of timeout or interrupt.
-    if (result == -ETIMEDOUT || result == -EINTR) {
-      errno = -result;
-      return -1;
-    }
+  // Return in case of timeout or interrupt.
+  result = __sem_wait_slow(sem, abs_timeout, true);
+  if (result != 0) {
+    errno = result;
+    return -1;
   }
+  return 0;
 }
 
 int sem_post(sem_t* sem) {
@@ -272,15 +405,30 @@ int sem_post(sem_t* sem) {
   unsigned int shared = SEM_GET_SHARED(sem_count_ptr);
 
   int old_value = __sem_inc(sem_count_ptr);
-  if (old_value < 0) {
-    // Contention on the semaphore. Wake up all waiters.
-    __futex_wake_ex(sem_count_ptr, shared, INT_MAX);
-  } else if (old_value == SEM_VALUE_MAX) {
+  if (old_value == SEM_VALUE_MAX) {
     // Overflow detected.
     errno = EOVERFLOW;
     return -1;
   }
 
+#if defined(__LP64__)
+  // One new unit can only satisfy one sleeper. We take the one we wake out of
+  // the count, so a waiter that has been woken but hasn't run yet doesn't cause
+  // the next post to make a futex syscall that finds nobody to wake.
+  atomic_uint* waiters_ptr = SEM_TO_WAITERS_POINTER(sem);
+  if (atomic_load(waiters_ptr) != 0) {
+    int woken = __futex_wake_ex(sem_count_ptr, shared, 1);
+    if (woken > 0) {
+      atomic_fetch_sub(waiters_ptr, woken);
+    }
+  }
+#else
+  if (old_value < 0) {
+    // Contention on the semaphore. Wake up all waiters.
+    __futex_wake_ex(sem_count_ptr, shared, INT_MAX);
+  }
+#endif
+
   return 0;
 }
 
@@ -0,0 +1,424 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <android/shm_queue.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/ashmem.h>
+#include <linux/memfd.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "private/ErrnoRestorer.h"
+#include "private/bionic_futex.h"
+#include "private/bionic_time_conversions.h"
+#include "private/libc_logging.h"
+
+// The queue is Vyukov's bounded MPMC queue: each slot has a sequence number saying which lap
+// of the ring it's ready for, so producers and consumers only contend on their own position.
+// Everything in shared memory is 32-bit, so that 32-bit and 64-bit processes can share a
+// queue, and positions are compared modulo 2^32.
+
+static constexpr uint32_t kMagic = 0x51534d41;  // "AMSQ".
+static constexpr uint32_t kVersion = 1;
+
+static constexpr size_t kMaxMessageSize = 16 * 1024 * 1024;
+static constexpr size_t kMaxMessageCount = 16 * 1024 * 1024;
+
+// How many times to look for a message, or room for one, before sleeping on the futex.
+static constexpr int kSpinCount = 64;
+
+// Something that can be waited for: a futex word that's bumped when it happens, but only when
+// the waiters count says someone might be asleep on it.
+struct ShmQueueEvent {
+  atomic_uint sequence;
+  atomic_uint waiters;
+};
+
+struct ShmQueueHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t flags;
+  uint32_t message_size;
+  uint32_t slot_size;
+  uint32_t slot_count;
+
+  // Only producers write these two, and only consumers the next two.
+  alignas(64) atomic_uint enqueue_pos;
+  ShmQueueEvent not_full;
+  alignas(64) atomic_uint dequeue_pos;
+  ShmQueueEvent not_empty;
+};
+
+// Slots start on a cache line and are a whole number of cache lines, so neighboring messages
+// don't share one. The header keeps the message 16-byte aligned.
+struct ShmQueueSlot {
+  atomic_uint sequence;
+  uint32_t size;
+  uint32_t __reserved[2];
+};
+
+static constexpr size_t kSlotsOffset = (sizeof(ShmQueueHeader) + 63) & ~63;
+
+struct android_shm_queue {
+  // The geometry is copied out of shared memory when the queue is mapped, so another process
+  // can't change it from under us.
+  ShmQueueHeader* header;
+  char* slots;
+  size_t map_size;
+  uint32_t message_size;
+  uint32_t slot_size;
+  uint32_t mask;
+  bool spsc;
+  int fd;
+};
+
+static uint32_t SlotSizeFor(size_t message_size) {
+  return (sizeof(ShmQueueSlot) + message_size + 63) & ~63;
+}
+
+static ShmQueueSlot* GetSlot(android_shm_queue* queue, uint32_t pos) {
+  return reinterpret_cast<ShmQueueSlot*>(queue->slots + (pos & queue->mask) * queue->slot_size);
+}
+
+static void* GetMessage(ShmQueueSlot* slot) {
+  return slot + 1;
+}
+
+static void* GetReceivedMessage(android_shm_queue* queue, ShmQueueSlot* slot, size_t* size) {
+  // Don't trust the producer to have stayed within the slot.
+  uint32_t message_size = slot->size;
+  *size = (message_size <= queue->message_size) ? message_size : queue->message_size;
+  return GetMessage(slot);
+}
+
+static ShmQueueSlot* SlotForMessage(android_shm_queue* queue, void* message, const char* fn) {
+  uintptr_t offset =
+      reinterpret_cast<uintptr_t>(message) - reinterpret_cast<uintptr_t>(queue->slots);
+  if (offset % queue->slot_size != sizeof(ShmQueueSlot) ||
+      offset / queue->slot_size > queue->mask) {
+    __libc_fatal("%s: %p isn't a message in queue %p", fn, message, queue);
+  }
+  return reinterpret_cast<ShmQueueSlot*>(queue->slots + offset - sizeof(ShmQueueSlot));
+}
+
+static int CreateSharedMemory(size_t size) {
+  int fd = syscall(__NR_memfd_create, "android_shm_queue", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+  if (fd != -1) {
+    // Sealing the size means another process can't truncate the queue and crash us with
+    // SIGBUS.
+    if (ftruncate(fd, size) == -1 ||
+        fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL) == -1) {
+      ErrnoRestorer errno_restorer;
+      close(fd);
+      return -1;
+    }
+    return fd;
+  }
+  if (errno != ENOSYS) return -1;
+
+  // ashmem regions can't be resized once they're mapped.
+  fd = open("/dev/ashmem", O_RDWR | O_CLOEXEC);
+  if (fd == -1) return -1;
+  if (ioctl(fd, ASHMEM_SET_NAME, "android_shm_queue") == -1 ||
+      ioctl(fd, ASHMEM_SET_SIZE, size) == -1) {
+    ErrnoRestorer errno_restorer;
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+static bool GetSharedMemorySize(int fd, size_t* size) {
+  struct stat sb;
+  if (fstat(fd, &sb) == -1) return false;
+  if (sb.st_size != 0) {
+    *size = sb.st_size;
+    return true;
+  }
+  // ashmem regions have no size as far as fstat is concerned.
+  int result = ioctl(fd, ASHMEM_GET_SIZE, nullptr);
+  if (result == -1) {
+    errno = EINVAL;
+    return false;
+  }
+  *size = result;
+  return true;
+}
+
+// Maps the queue in fd, which the returned queue takes ownership of.
+static android_shm_queue* MapQueue(int fd, size_t size) {
+  void* map = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (map == MAP_FAILED) return nullptr;
+
+  android_shm_queue* queue = reinterpret_cast<android_shm_queue*>(calloc(1, sizeof(*queue)));
+  if (queue == nullptr) {
+    munmap(map, size);
+    return nullptr;
+  }
+  queue->header = reinterpret_cast<ShmQueueHeader*>(map);
+  queue->slots = reinterpret_cast<char*>(map) + kSlotsOffset;
+  queue->map_size = size;
+  queue->fd = fd;
+  return queue;
+}
+
+android_shm_queue* android_shm_queue_create(size_t message_size, size_t message_count,
+                                            int flags) {
+  if (message_size == 0 || message_size > kMaxMessageSize ||
+      message_count == 0 || message_count > kMaxMessageCount ||
+      (flags & ~ANDROID_SHM_QUEUE_SPSC) != 0) {
+    errno = EINVAL;
+    return nullptr;
+  }
+  // A single slot doesn't work: a message committed at position n would look like a free slot
+  // for position n + 1.
+  uint32_t slot_count = 2;
+  while (slot_count < message_count) slot_count *= 2;
+  uint32_t slot_size = SlotSizeFor(message_size);
+  size_t size;
+  if (__builtin_mul_overflow(slot_size, slot_count, &size) ||
+      __builtin_add_overflow(size, kSlotsOffset, &size)) {
+    errno = EINVAL;
+    return nullptr;
+  }
+
+  int fd = CreateSharedMemory(size);
+  if (fd == -1) return nullptr;
+  android_shm_queue* queue = MapQueue(fd, size);
+  if (queue == nullptr) {
+    ErrnoRestorer errno_restorer;
+    close(fd);
+    return nullptr;
+  }
+  queue->message_size = message_size;
+  queue->slot_size = slot_size;
+  queue->mask = slot_count - 1;
+  queue->spsc = (flags & ANDROID_SHM_QUEUE_SPSC) != 0;
+
+  // The memory starts out zeroed. Other processes can't see it until we hand out the fd.
+  ShmQueueHeader* header = queue->header;
+  header->magic = kMagic;
+  header->version = kVersion;
+  header->flags = flags;
+  header->message_size = message_size;
+  header->slot_size = slot_size;
+  header->slot_count = slot_count;
+  for (uint32_t i = 0; i < slot_count; ++i) {
+    atomic_init(&GetSlot(queue, i)->sequence, i);
+  }
+  return queue;
+}
+
+android_shm_queue* android_shm_queue_open(int fd) {
+  size_t size;
+  if (!GetSharedMemorySize(fd, &size)) return nullptr;
+  if (size < kSlotsOffset) {
+    errno = EINVAL;
+    return nullptr;
+  }
+  int dup_fd = fcntl(fd, F_DUPFD_CLOEXEC, 0);
+  if (dup_fd == -1) return nullptr;
+  android_shm_queue* queue = MapQueue(dup_fd, size);
+  if (queue == nullptr) {
+    ErrnoRestorer errno_restorer;
+    close(dup_fd);
+    return nullptr;
+  }
+
+  // Check the header against what we've actually mapped, because we'll trust it from now on.
+  const ShmQueueHeader* header = queue->header;
+  uint32_t message_size = header->message_size;
+  uint32_t slot_count = header->slot_count;
+  uint32_t flags = header->flags;
+  if (header->magic != kMagic || header->version != kVersion ||
+      message_size == 0 || message_size > kMaxMessageSize ||
+      slot_count < 2 || slot_count > kMaxMessageCount || (slot_count & (slot_count - 1)) != 0 ||
+      header->slot_size != SlotSizeFor(message_size) ||
+      (size - kSlotsOffset) / SlotSizeFor(message_size) < slot_count ||
+      (flags & ~ANDROID_SHM_QUEUE_SPSC) != 0) {
+    android_shm_queue_close(queue);
+    errno = EINVAL;
+    return nullptr;
+  }
+  queue->message_size = message_size;
+  queue->slot_size = SlotSizeFor(message_size);
+  queue->mask = slot_count - 1;
+  queue->spsc = (flags & ANDROID_SHM_QUEUE_SPSC) != 0;
+  return queue;
+}
+
+void android_shm_queue_close(android_shm_queue* queue) {
+  if (queue == nullptr) return;
+  ErrnoRestorer errno_restorer;
+  munmap(queue->header, queue->map_size);
+  close(queue->fd);
+  free(queue);
+}
+
+int android_shm_queue_get_fd(android_shm_queue* queue) {
+  return queue->fd;
+}
+
+size_t android_shm_queue_get_message_size(android_shm_queue* queue) {
+  return queue->message_size;
+}
+
+// Claims the slot at *pos if its sequence number says it's ready for this side, where
+// ready_offset is how far ahead of the position the sequence number is then. Returns the
+// slot, or nullptr if the queue is full (for producers) or empty (for consumers).
+static ShmQueueSlot* ClaimSlot(android_shm_queue* queue, atomic_uint* pos_ptr,
+                               uint32_t ready_offset) {
+  uint32_t pos = atomic_load_explicit(pos_ptr, memory_order_relaxed);
+  while (true) {
+    ShmQueueSlot* slot = GetSlot(queue, pos);
+    uint32_t sequence = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+    int32_t diff = static_cast<int32_t>(sequence - (pos + ready_offset));
+    if (diff == 0) {
+      if (queue->spsc) {
+        atomic_store_explicit(pos_ptr, pos + 1, memory_order_relaxed);
+        return slot;
+      }
+      if (atomic_compare_exchange_weak_explicit(pos_ptr, &pos, pos + 1,
+                                                memory_order_relaxed, memory_order_relaxed)) {
+        return slot;
+      }
+    } else if (diff < 0) {
+      // The other side hasn't finished with this slot's previous lap.
+      return nullptr;
+    } else {
+      // Another producer or consumer got here first.
+      pos = atomic_load_explicit(pos_ptr, memory_order_relaxed);
+    }
+  }
+}
+
+static ShmQueueSlot* TryReserve(android_shm_queue* queue) {
+  return ClaimSlot(queue, &queue->header->enqueue_pos, 0);
+}
+
+static ShmQueueSlot* TryReceive(android_shm_queue* queue) {
+  return ClaimSlot(queue, &queue->header->dequeue_pos, 1);
+}
+
+static void Notify(ShmQueueEvent* event) {
+  // Pairs with the fence in Wait: either the waiter sees what we just published, or we see
+  // that it's waiting.
+  atomic_thread_fence(memory_order_seq_cst);
+  if (atomic_load_explicit(&event->waiters, memory_order_relaxed) != 0) {
+    atomic_fetch_add_explicit(&event->sequence, 1, memory_order_relaxed);
+    __futex_wake_ex(&event->sequence, true, 1);
+  }
+}
+
+static ShmQueueSlot* Wait(android_shm_queue* queue, ShmQueueEvent* event,
+                          ShmQueueSlot* (*try_claim)(android_shm_queue*),
+                          const timespec* abs_timeout) {
+  for (int i = 0; i < kSpinCount; ++i) {
+    ShmQueueSlot* slot = try_claim(queue);
+    if (slot != nullptr) return slot;
+  }
+  int result = check_timespec(abs_timeout, true);
+  if (result != 0) {
+    errno = result;
+    return nullptr;
+  }
+
+  while (true) {
+    uint32_t sequence = atomic_load_explicit(&event->sequence, memory_order_acquire);
+    atomic_fetch_add_explicit(&event->waiters, 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    ShmQueueSlot* slot = try_claim(queue);
+    if (slot == nullptr) {
+      result = __futex_wait_ex(&event->sequence, true, sequence, false, abs_timeout);
+    }
+    atomic_fetch_sub_explicit(&event->waiters, 1, memory_order_relaxed);
+    if (slot != nullptr) return slot;
+    if (result == -ETIMEDOUT) {
+      errno = ETIMEDOUT;
+      return nullptr;
+    }
+  }
+}
+
+void* android_shm_queue_reserve(android_shm_queue* queue, const timespec* abs_timeout) {
+  ShmQueueSlot* slot = Wait(queue, &queue->header->not_full, TryReserve, abs_timeout);
+  return (slot != nullptr) ? GetMessage(slot) : nullptr;
+}
+
+void* android_shm_queue_try_reserve(android_shm_queue* queue) {
+  ShmQueueSlot* slot = TryReserve(queue);
+  if (slot == nullptr) {
+    errno = EAGAIN;
+    return nullptr;
+  }
+  return GetMessage(slot);
+}
+
+void android_shm_queue_commit(android_shm_queue* queue, void* message, size_t size) {
+  ShmQueueSlot* slot = SlotForMessage(queue, message, "android_shm_queue_commit");
+  if (size > queue->message_size) {
+    __libc_fatal("android_shm_queue_commit: message size %zu > %u", size, queue->message_size);
+  }
+  slot->size = size;
+  // The slot's sequence number is still the position we reserved it at.
+  uint32_t sequence = atomic_load_explicit(&slot->sequence, memory_order_relaxed);
+  atomic_store_explicit(&slot->sequence, sequence + 1, memory_order_release);
+  Notify(&queue->header->not_empty);
+}
+
+void* android_shm_queue_receive(android_shm_queue* queue, size_t* size,
+                                const timespec* abs_timeout) {
+  ShmQueueSlot* slot = Wait(queue, &queue->header->not_empty, TryReceive, abs_timeout);
+  return (slot != nullptr) ? GetReceivedMessage(queue, slot, size) : nullptr;
+}
+
+void* android_shm_queue_try_receive(android_shm_queue* queue, size_t* size) {
+  ShmQueueSlot* slot = TryReceive(queue);
+  if (slot == nullptr) {
+    errno = EAGAIN;
+    return nullptr;
+  }
+  return GetReceivedMessage(queue, slot, size);
+}
+
+void android_shm_queue_release(android_shm_queue* queue, void* message) {
+  ShmQueueSlot* slot = SlotForMessage(queue, message, "android_shm_queue_release");
+  // The slot's sequence number is one past the position we received it at, and becomes the
+  // position a producer can reserve it at on the next lap.
+  uint32_t sequence = atomic_load_explicit(&slot->sequence, memory_order_relaxed);
+  atomic_store_explicit(&slot->sequence, sequence - 1 + queue->mask + 1, memory_order_release);
+  Notify(&queue->header->not_full);
+}
@@ -29,11 +29,71 @@
 #include <errno.h>
 #include <pthread.h>
 #include <signal.h>
+#include <string.h>
 
+#include "pthread_internal.h"
 #include "private/kernel_sigset_t.h"
 
 extern "C" int __rt_sigprocmask(int, const kernel_sigset_t*, kernel_sigset_t*, size_t);
 
+// The signals an android_defer_signals region doesn't block: they're raised by what the thread
+// itself does, and the kernel kills the process rather than leave one of them pending.
+static const int kSynchronousSignals[] = {
+  SIGABRT, SIGBUS, SIGFPE, SIGILL, SIGSEGV, SIGSYS, SIGTRAP,
+};
+
+// The mask the kernel has while a region defers for the given mask.
+static kernel_sigset_t deferring_mask(const kernel_sigset_t& mask) {
+  kernel_sigset_t result;
+  result.fill();
+  for (int signal : kSynchronousSignals) {
+    if (!sigismember(&mask.bionic, signal)) {
+      sigdelset(&result.bionic, signal);
+    }
+  }
+  return result;
+}
+
+// sigprocmask inside a region: the mask it changes is the one the region will restore.
+static int deferred_sigprocmask(pthread_internal_t* self, int how, const kernel_sigset_t* new_set,
+                                sigset_t* bionic_old_set) {
+  kernel_sigset_t old_set = self->signal_defer_mask;
+  if (new_set != NULL) {
+    if (how != SIG_BLOCK && how != SIG_UNBLOCK && how != SIG_SETMASK) {
+      errno = EINVAL;
+      return -1;
+    }
+    kernel_sigset_t mask = old_set;
+    unsigned char* dst = reinterpret_cast<unsigned char*>(&mask);
+    const unsigned char* src = reinterpret_cast<const unsigned char*>(new_set);
+    for (size_t i = 0; i < sizeof(mask); ++i) {
+      if (how == SIG_BLOCK) {
+        dst[i] |= src[i];
+      } else if (how == SIG_UNBLOCK) {
+        dst[i] &= ~src[i];
+      } else {
+        dst[i] = src[i];
+      }
+    }
+    // As the kernel would.
+    sigdelset(&mask.bionic, SIGKILL);
+    sigdelset(&mask.bionic, SIGSTOP);
+
+    kernel_sigset_t kernel_mask = deferring_mask(mask);
+    kernel_sigset_t old_kernel_mask = deferring_mask(old_set);
+    if (memcmp(&kernel_mask, &old_kernel_mask, sizeof(kernel_mask)) != 0 &&
+        __rt_sigprocmask(SIG_SETMASK, &kernel_mask, NULL, sizeof(kernel_mask)) == -1) {
+      return -1;
+    }
+    self->signal_defer_mask = mask;
+  }
+
+  if (bionic_old_set != NULL) {
+    *bionic_old_set = old_set.bionic;
+  }
+  return 0;
+}
+
 int sigprocmask(int how, const sigset_t* bionic_new_set, sigset_t* bionic_old_set) {
   kernel_sigset_t new_set;
   kernel_sigset_t* new_set_ptr = NULL;
@@ -42,6 +102,11 @@ int sigprocmask(int how, const sigset_t* bionic_new_set, sigset_t* bionic_old_se
     new_set_ptr = &new_set;
   }
 
+  pthread_internal_t* self = __get_thread();
+  if (__predict_false(self->signal_defer_depth != 0)) {
+    return deferred_sigprocmask(self, how, new_set_ptr, bionic_old_set);
+  }
+
   kernel_sigset_t old_set;
   if (__rt_sigprocmask(how, new_set_ptr, &old_set, sizeof(old_set)) == -1) {
     return -1;
@@ -53,3 +118,31 @@ int sigprocmask(int how, const sigset_t* bionic_new_set, sigset_t* bionic_old_se
 
   return 0;
 }
+
+int android_defer_signals_begin() {
+  pthread_internal_t* self = __get_thread();
+  if (self->signal_defer_depth == 0) {
+    // Blocking rather than setting keeps any synchronous signals the caller has blocked blocked.
+    kernel_sigset_t none;
+    kernel_sigset_t deferred = deferring_mask(none);
+    if (__rt_sigprocmask(SIG_BLOCK, &deferred, &self->signal_defer_mask,
+                         sizeof(deferred)) == -1) {
+      return -1;
+    }
+  }
+  ++self->signal_defer_depth;
+  return 0;
+}
+
+int android_defer_signals_end() {
+  pthread_internal_t* self = __get_thread();
+  if (self->signal_defer_depth == 0) {
+    errno = EINVAL;
+    return -1;
+  }
+  if (--self->signal_defer_depth == 0) {
+    return __rt_sigprocmask(SIG_SETMASK, &self->signal_defer_mask, NULL,
+                            sizeof(self->signal_defer_mask));
+  }
+  return 0;
+}
@@ -14,10 +14,105 @@
  * limitations under the License.
  */
 
+
 #include "private/NetdClientDispatch.h"
 
+#include <errno.h>
 #include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+
+#ifdef __i386__
+#define __socketcall __attribute__((__cdecl__))
+#else
+#define __socketcall
+#endif
+
+extern "C" __socketcall int __socket(int, int, int);
+
+// netd_client's socket hook asks netd to mark each new AF_INET and AF_INET6 socket (SO_MARK) for
+// the network the process has selected, which costs a round trip to netd per socket. The mark
+// only depends on that selection, so if netd_client tells us when it changes, the mark netd gave
+// the last socket can be set on the next one directly. Setting SO_MARK needs CAP_NET_ADMIN, so
+// the fast path only helps processes that have it; it's turned off the first time it fails.
+
+// The network generation in the top 32 bits and the mark in the bottom, or 0 if nothing is
+// cached. netd_client never uses generation 0, so a cached entry is never 0.
+static std::atomic<uint64_t> g_cached_mark;
+static std::atomic<bool> g_cached_mark_disabled;
+
+// Returns the current network generation if marks for this domain may be cached, 0 otherwise.
+static unsigned cacheable_generation(int domain) {
+    if (domain != AF_INET && domain != AF_INET6) return 0;
+    unsigned (*generation)() = __netdClientDispatch.networkGeneration;
+    if (generation == nullptr || g_cached_mark_disabled.load(std::memory_order_relaxed)) return 0;
+    return generation();
+}
+
+static bool lookup_cached_mark(unsigned generation, uint32_t* mark) {
+    uint64_t cached = g_cached_mark.load(std::memory_order_relaxed);
+    if (generation == 0 || (cached >> 32) != generation) return false;
+    *mark = static_cast<uint32_t>(cached);
+    return true;
+}
+
+// Remembers the mark netd gave fd. The generation is the one read before fd was made: if the
+// selection changed in between, the entry is for a generation no one will ask for again.
+static void remember_mark(int fd, unsigned generation) {
+    uint32_t mark;
+    socklen_t mark_len = sizeof(mark);
+    if (generation != 0 && getsockopt(fd, SOL_SOCKET, SO_MARK, &mark, &mark_len) == 0) {
+        g_cached_mark.store((static_cast<uint64_t>(generation) << 32) | mark,
+                            std::memory_order_relaxed);
+    }
+}
+
+// Returns -1 with errno EPERM (and the fast path disabled) if this process can't set SO_MARK.
+static int socket_with_mark(int domain, int type, int protocol, uint32_t mark) {
+    int fd = __socket(domain, type, protocol);
+    if (fd != -1 && mark != 0 && setsockopt(fd, SOL_SOCKET, SO_MARK, &mark, sizeof(mark)) == -1) {
+        int saved_errno = errno;
+        close(fd);
+        if (saved_errno == EPERM) g_cached_mark_disabled = true;
+        errno = saved_errno;
+        return -1;
+    }
+    return fd;
+}
 
 int socket(int domain, int type, int protocol) {
-    return __netdClientDispatch.socket(domain, type, protocol);
+    unsigned generation = cacheable_generation(domain);
+    uint32_t mark;
+    if (lookup_cached_mark(generation, &mark)) {
+        int fd = socket_with_mark(domain, type, protocol, mark);
+        if (fd != -1 || errno != EPERM) return fd;
+    }
+    int fd = __netdClientDispatch.socket(domain, type, protocol);
+    if (fd != -1) remember_mark(fd, generation);
+    return fd;
+}
+
+int android_socket_batch(int domain, int type, int protocol, int* fds, size_t count) {
+    unsigned generation = cacheable_generation(domain);
+    uint32_t mark;
+    if (lookup_cached_mark(generation, &mark)) {
+        size_t i = 0;
+        for (; i < count; ++i) {
+            fds[i] = socket_with_mark(domain, type, protocol, mark);
+            if (fds[i] == -1) break;
+        }
+        if (i == count) return 0;
+        int saved_errno = errno;
+        while (i > 0) {
+            close(fds[--i]);
+        }
+        if (saved_errno != EPERM) {
+            errno = saved_errno;
+            return -1;
+        }
+    }
+    if (__netdClientDispatch.socketBatch(domain, type, protocol, fds, count) == -1) return -1;
+    if (count > 0) remember_mark(fds[0], generation);
+    return 0;
 }
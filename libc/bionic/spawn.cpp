@@ -0,0 +1,376 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#define _GNU_SOURCE 1
+#include <spawn.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "pthread_internal.h"
+
+#include "private/kernel_sigset_t.h"
+
+extern "C" int __rt_sigprocmask(int, const kernel_sigset_t*, kernel_sigset_t*, size_t);
+
+enum Action {
+  kOpen,
+  kClose,
+  kDup2
+};
+
+struct __posix_spawn_file_action {
+  __posix_spawn_file_action* next;
+
+  Action what;
+  int fd;
+  int new_fd;
+  char* path;
+  int flags;
+  mode_t mode;
+
+  // This runs in the child, which mustn't write to anything of the parent's but the SpawnArgs.
+  bool Do() {
+    if (what == kOpen) {
+      int opened_fd = TEMP_FAILURE_RETRY(open(path, flags, mode));
+      if (opened_fd == -1) return false;
+      // If it didn't land where we wanted it, move it.
+      if (opened_fd != new_fd) {
+        if (dup2(opened_fd, new_fd) == -1) return false;
+        close(opened_fd);
+      }
+    } else if (what == kClose) {
+      // Failure to close is ignored.
+      close(fd);
+    } else if (fd == new_fd) {
+      // POSIX: dup2'ing an fd to itself clears FD_CLOEXEC, so it survives the exec.
+      int fd_flags = fcntl(fd, F_GETFD);
+      if (fd_flags == -1 || fcntl(fd, F_SETFD, fd_flags & ~FD_CLOEXEC) == -1) return false;
+    } else {
+      if (dup2(fd, new_fd) == -1) return false;
+    }
+    return true;
+  }
+};
+
+struct __posix_spawn_file_actions {
+  __posix_spawn_file_action* head;
+  __posix_spawn_file_action* last;
+
+  bool Do() {
+    for (__posix_spawn_file_action* action = head; action != nullptr; action = action->next) {
+      if (!action->Do()) return false;
+    }
+    return true;
+  }
+};
+
+struct __posix_spawnattr {
+  short flags;
+  pid_t pgroup;
+  sched_param schedparam;
+  int schedpolicy;
+  sigset_t sigmask;
+  sigset_t sigdefault;
+};
+
+// Everything the child needs, on the parent's stack. The child shares the parent's memory and the
+// parent is suspended until the child execs or exits, so the child can report a failure by just
+// storing its errno in here before it exits.
+struct SpawnArgs {
+  const char* path;
+  char* const* argv;
+  char* const* envp;
+  const posix_spawn_file_actions_t* actions;
+  const posix_spawnattr_t* attr;
+  int (*exec_fn)(const char*, char* const*, char* const*);
+  const kernel_sigset_t* child_mask;
+  int error;
+};
+
+static bool ApplyAttrs(short flags, const posix_spawnattr_t* attr) {
+  // POSIX: "Signals set to be caught by the calling process shall be set to the default action in
+  // the child process." That also matters before the exec: the handlers live in the parent's
+  // memory, which the child is still sharing.
+  struct sigaction default_sa = {};
+  default_sa.sa_handler = SIG_DFL;
+  bool use_sigdefault = (flags & POSIX_SPAWN_SETSIGDEF) != 0;
+  for (int s = 1; s < _NSIG; ++s) {
+    bool reset = false;
+    if (use_sigdefault && sigismember(&(*attr)->sigdefault, s) == 1) {
+      reset = true;
+    } else {
+      struct sigaction current;
+      if (sigaction(s, nullptr, &current) == -1) continue;
+      reset = (current.sa_handler != SIG_IGN && current.sa_handler != SIG_DFL);
+    }
+    if (reset && sigaction(s, &default_sa, nullptr) == -1) return false;
+  }
+
+  if ((flags & POSIX_SPAWN_SETPGROUP) != 0 && setpgid(0, (*attr)->pgroup) == -1) return false;
+  if ((flags & POSIX_SPAWN_SETSID) != 0 && setsid() == -1) return false;
+
+  // POSIX_SPAWN_SETSCHEDULER overrides POSIX_SPAWN_SETSCHEDPARAM, but it is not an error
+  // to set both.
+  if ((flags & POSIX_SPAWN_SETSCHEDULER) != 0) {
+    if (sched_setscheduler(0, (*attr)->schedpolicy, &(*attr)->schedparam) == -1) return false;
+  } else if ((flags & POSIX_SPAWN_SETSCHEDPARAM) != 0) {
+    if (sched_setparam(0, &(*attr)->schedparam) == -1) return false;
+  }
+
+  if ((flags & POSIX_SPAWN_RESETIDS) != 0) {
+    if (seteuid(getuid()) == -1 || setegid(getgid()) == -1) return false;
+  }
+  return true;
+}
+
+static int SpawnChild(void* arg) {
+  SpawnArgs* args = reinterpret_cast<SpawnArgs*>(arg);
+  short flags = (args->attr != nullptr) ? (*args->attr)->flags : 0;
+
+  if (ApplyAttrs(flags, args->attr) &&
+      (args->actions == nullptr || (*args->actions)->Do())) {
+    // Not sigprocmask: we're still on the parent's thread as far as android_defer_signals is
+    // concerned.
+    if ((flags & POSIX_SPAWN_SETSIGMASK) != 0) {
+      kernel_sigset_t mask(&(*args->attr)->sigmask);
+      __rt_sigprocmask(SIG_SETMASK, &mask, nullptr, sizeof(kernel_sigset_t));
+    } else {
+      __rt_sigprocmask(SIG_SETMASK, args->child_mask, nullptr, sizeof(kernel_sigset_t));
+    }
+    args->exec_fn(args->path, args->argv, args->envp);
+  }
+  args->error = errno;
+  _exit(127);
+}
+
+static int PosixSpawn(pid_t* pid_ptr, const char* path, const posix_spawn_file_actions_t* actions,
+                      const posix_spawnattr_t* attr, char* const argv[], char* const env[],
+                      int (*exec_fn)(const char*, char* const*, char* const*),
+                      size_t extra_stack_size) {
+  // Rather than fork, which has to copy the page tables (so gets slower as the parent gets
+  // bigger) and runs the atfork handlers, share the parent's memory and suspend the parent until
+  // the child execs or exits, as vfork does. Unlike vfork, the child runs on its own small stack
+  // rather than the parent's, so it can call and return from functions without trampling the
+  // parent's frames. All signals stay blocked until the child has reset its handlers, since a
+  // handler running in the child would be running on the parent's memory.
+  kernel_sigset_t all_signals;
+  all_signals.fill();
+  kernel_sigset_t parent_mask;
+  __rt_sigprocmask(SIG_SETMASK, &all_signals, &parent_mask, sizeof(kernel_sigset_t));
+  // In an android_defer_signals region, the child gets the mask the region is deferring for.
+  pthread_internal_t* self = __get_thread();
+  const kernel_sigset_t* child_mask =
+      (self->signal_defer_depth != 0) ? &self->signal_defer_mask : &parent_mask;
+
+  SpawnArgs args = { path, argv, env, actions, attr, exec_fn, child_mask, 0 };
+
+  // The child's stack is in the parent's frame; the parent isn't using it until the child's done.
+  char stack[2 * PAGE_SIZE + extra_stack_size];
+  int saved_errno = errno;
+  pid_t pid = clone(SpawnChild, stack + sizeof(stack), CLONE_VM | CLONE_VFORK | SIGCHLD, &args);
+  int result = 0;
+  if (pid == -1) {
+    result = errno;
+  } else if (args.error != 0) {
+    // The child failed, and has already exited: reap it.
+    result = args.error;
+    TEMP_FAILURE_RETRY(waitpid(pid, nullptr, 0));
+  } else if (pid_ptr != nullptr) {
+    *pid_ptr = pid;
+  }
+  errno = saved_errno;
+
+  __rt_sigprocmask(SIG_SETMASK, &parent_mask, nullptr, sizeof(kernel_sigset_t));
+  return result;
+}
+
+int posix_spawn(pid_t* pid, const char* path, const posix_spawn_file_actions_t* actions,
+                const posix_spawnattr_t* attr, char* const argv[], char* const env[]) {
+  return PosixSpawn(pid, path, actions, attr, argv, env, execve, 0);
+}
+
+int posix_spawnp(pid_t* pid, const char* file, const posix_spawn_file_actions_t* actions,
+                 const posix_spawnattr_t* attr, char* const argv[], char* const env[]) {
+  // execvpe copies $PATH and builds each candidate path on the stack, and might also need to build
+  // an argv for a shell script.
+  const char* path = getenv("PATH");
+  size_t argc = 0;
+  while (argv[argc] != nullptr) ++argc;
+  size_t extra_stack_size = 2 * (strlen(path ? path : "") + strlen(file)) + PATH_MAX +
+                            (argc + 2) * sizeof(char*);
+  return PosixSpawn(pid, file, actions, attr, argv, env, execvpe, extra_stack_size);
+}
+
+int posix_spawnattr_init(posix_spawnattr_t* attr) {
+  *attr = reinterpret_cast<__posix_spawnattr*>(calloc(1, sizeof(__posix_spawnattr)));
+  return (*attr == nullptr) ? errno : 0;
+}
+
+int posix_spawnattr_destroy(posix_spawnattr_t* attr) {
+  free(*attr);
+  *attr = nullptr;
+  return 0;
+}
+
+int posix_spawnattr_setflags(posix_spawnattr_t* attr, short flags) {
+  if ((flags & ~(POSIX_SPAWN_RESETIDS | POSIX_SPAWN_SETPGROUP | POSIX_SPAWN_SETSIGDEF |
+                 POSIX_SPAWN_SETSIGMASK | POSIX_SPAWN_SETSCHEDPARAM | POSIX_SPAWN_SETSCHEDULER |
+                 POSIX_SPAWN_USEVFORK | POSIX_SPAWN_SETSID)) != 0) {
+    return EINVAL;
+  }
+  (*attr)->flags = flags;
+  return 0;
+}
+
+int posix_spawnattr_getflags(const posix_spawnattr_t* attr, short* flags) {
+  *flags = (*attr)->flags;
+  return 0;
+}
+
+int posix_spawnattr_setpgroup(posix_spawnattr_t* attr, pid_t pgroup) {
+  (*attr)->pgroup = pgroup;
+  return 0;
+}
+
+int posix_spawnattr_getpgroup(const posix_spawnattr_t* attr, pid_t* pgroup) {
+  *pgroup = (*attr)->pgroup;
+  return 0;
+}
+
+int posix_spawnattr_setsigmask(posix_spawnattr_t* attr, const sigset_t* mask) {
+  (*attr)->sigmask = *mask;
+  return 0;
+}
+
+int posix_spawnattr_getsigmask(const posix_spawnattr_t* attr, sigset_t* mask) {
+  *mask = (*attr)->sigmask;
+  return 0;
+}
+
+int posix_spawnattr_setsigdefault(posix_spawnattr_t* attr, const sigset_t* mask) {
+  (*attr)->sigdefault = *mask;
+  return 0;
+}
+
+int posix_spawnattr_getsigdefault(const posix_spawnattr_t* attr, sigset_t* mask) {
+  *mask = (*attr)->sigdefault;
+  return 0;
+}
+
+int posix_spawnattr_setschedparam(posix_spawnattr_t* attr, const struct sched_param* param) {
+  (*attr)->schedparam = *param;
+  return 0;
+}
+
+int posix_spawnattr_getschedparam(const posix_spawnattr_t* attr, struct sched_param* param) {
+  *param = (*attr)->schedparam;
+  return 0;
+}
+
+int posix_spawnattr_setschedpolicy(posix_spawnattr_t* attr, int policy) {
+  (*attr)->schedpolicy = policy;
+  return 0;
+}
+
+int posix_spawnattr_getschedpolicy(const posix_spawnattr_t* attr, int* policy) {
+  *policy = (*attr)->schedpolicy;
+  return 0;
+}
+
+int posix_spawn_file_actions_init(posix_spawn_file_actions_t* actions) {
+  *actions = reinterpret_cast<__posix_spawn_file_actions*>(
+      calloc(1, sizeof(__posix_spawn_file_actions)));
+  return (*actions == nullptr) ? errno : 0;
+}
+
+int posix_spawn_file_actions_destroy(posix_spawn_file_actions_t* actions) {
+  __posix_spawn_file_action* a = (*actions)->head;
+  while (a != nullptr) {
+    __posix_spawn_file_action* last = a;
+    a = a->next;
+    free(last->path);
+    free(last);
+  }
+  free(*actions);
+  *actions = nullptr;
+  return 0;
+}
+
+static int posix_spawn_add_file_action(posix_spawn_file_actions_t* actions, Action what, int fd,
+                                       int new_fd, const char* path, int flags, mode_t mode) {
+  __posix_spawn_file_action* action = reinterpret_cast<__posix_spawn_file_action*>(
+      malloc(sizeof(__posix_spawn_file_action)));
+  if (action == nullptr) return errno;
+
+  action->next = nullptr;
+  if (path != nullptr) {
+    action->path = strdup(path);
+    if (action->path == nullptr) {
+      free(action);
+      return errno;
+    }
+  } else {
+    action->path = nullptr;
+  }
+  action->what = what;
+  action->fd = fd;
+  action->new_fd = new_fd;
+  action->flags = flags;
+  action->mode = mode;
+
+  if ((*actions)->head == nullptr) {
+    (*actions)->head = (*actions)->last = action;
+  } else {
+    (*actions)->last->next = action;
+    (*actions)->last = action;
+  }
+  return 0;
+}
+
+int posix_spawn_file_actions_addopen(posix_spawn_file_actions_t* actions, int fd,
+                                     const char* path, int flags, mode_t mode) {
+  if (fd < 0) return EBADF;
+  return posix_spawn_add_file_action(actions, kOpen, -1, fd, path, flags, mode);
+}
+
+int posix_spawn_file_actions_addclose(posix_spawn_file_actions_t* actions, int fd) {
+  if (fd < 0) return EBADF;
+  return posix_spawn_add_file_action(actions, kClose, fd, -1, nullptr, 0, 0);
+}
+
+int posix_spawn_file_actions_adddup2(posix_spawn_file_actions_t* actions, int fd, int new_fd) {
+  if (fd < 0 || new_fd < 0) return EBADF;
+  return posix_spawn_add_file_action(actions, kDup2, fd, new_fd, nullptr, 0, 0);
+}
@@ -0,0 +1,175 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/user.h>
+
+// Case-insensitive comparison and search in the C locale, where only 'A'-'Z'
+// fold. Sixteen bytes are folded and compared at a time using plain vector
+// extensions, so the compiler emits NEON or SSE2 as appropriate. Bytes
+// outside ASCII fold to themselves, so they need no special handling.
+
+typedef unsigned char byte16 __attribute__((vector_size(16)));
+
+static inline unsigned char fold(unsigned char c) {
+  return c + ((static_cast<unsigned>(c - 'A') < 26) << 5);
+}
+
+static inline byte16 fold16(byte16 v) {
+  return v + ((v - 'A' < 26) & 0x20);
+}
+
+static inline byte16 load16(const unsigned char* p) {
+  byte16 v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+// Returns the index of the first non-zero lane, or 16 if they're all zero.
+static inline size_t first_set(byte16 mask) {
+  uint64_t halves[2];
+  memcpy(halves, &mask, sizeof(halves));
+  if (halves[0] != 0) return __builtin_ctzll(halves[0]) / 8;
+  if (halves[1] != 0) return 8 + __builtin_ctzll(halves[1]) / 8;
+  return 16;
+}
+
+// A string may end anywhere, so only read a whole block if it can't fault:
+// that is, if it doesn't cross into the next page.
+static inline bool within_page(const unsigned char* p) {
+  return (reinterpret_cast<uintptr_t>(p) & (PAGE_SIZE - 1)) <= PAGE_SIZE - sizeof(byte16);
+}
+
+int strcasecmp(const char* s1, const char* s2) {
+  const unsigned char* p1 = reinterpret_cast<const unsigned char*>(s1);
+  const unsigned char* p2 = reinterpret_cast<const unsigned char*>(s2);
+  while (true) {
+    if (within_page(p1) && within_page(p2)) {
+      byte16 v1 = load16(p1);
+      byte16 stop = (fold16(v1) != fold16(load16(p2))) | (v1 == 0);
+      size_t i = first_set(stop);
+      if (i < sizeof(byte16)) return fold(p1[i]) - fold(p2[i]);
+      p1 += sizeof(byte16);
+      p2 += sizeof(byte16);
+    } else {
+      // One of the strings is about to cross a page; take it a byte at a time.
+      int c1 = fold(*p1);
+      int c2 = fold(*p2);
+      if (c1 != c2 || c1 == 0) return c1 - c2;
+      ++p1;
+      ++p2;
+    }
+  }
+}
+
+int strncasecmp(const char* s1, const char* s2, size_t n) {
+  const unsigned char* p1 = reinterpret_cast<const unsigned char*>(s1);
+  const unsigned char* p2 = reinterpret_cast<const unsigned char*>(s2);
+  while (n >= sizeof(byte16)) {
+    if (within_page(p1) && within_page(p2)) {
+      byte16 v1 = load16(p1);
+      byte16 stop = (fold16(v1) != fold16(load16(p2))) | (v1 == 0);
+      size_t i = first_set(stop);
+      if (i < sizeof(byte16)) return fold(p1[i]) - fold(p2[i]);
+      p1 += sizeof(byte16);
+      p2 += sizeof(byte16);
+      n -= sizeof(byte16);
+    } else {
+      int c1 = fold(*p1);
+      int c2 = fold(*p2);
+      if (c1 != c2 || c1 == 0) return c1 - c2;
+      ++p1;
+      ++p2;
+      --n;
+    }
+  }
+  for (; n != 0; --n) {
+    int c1 = fold(*p1++);
+    int c2 = fold(*p2++);
+    if (c1 != c2 || c1 == 0) return c1 - c2;
+  }
+  return 0;
+}
+
+// Case-insensitive memmem, with the same first/last byte filter as memmem:
+// only positions where both the first and the last byte of the needle match
+// are compared in full.
+static const unsigned char* memcasemem(const unsigned char* y, size_t n,
+                                       const unsigned char* x, size_t m) {
+  if (n < m) return nullptr;
+
+  const unsigned char first = fold(x[0]);
+  const unsigned char last = fold(x[m - 1]);
+  const size_t last_position = n - m;
+
+  auto matches_at = [&](size_t j) {
+    for (size_t k = 1; k + 1 < m; ++k) {
+      if (fold(y[j + k]) != fold(x[k])) return false;
+    }
+    return true;
+  };
+
+  size_t j = 0;
+  if (last_position >= sizeof(byte16)) {
+    const byte16 first16 = first - byte16{};
+    const byte16 last16 = last - byte16{};
+    for (; j <= last_position - sizeof(byte16); j += sizeof(byte16)) {
+      byte16 hits = (fold16(load16(y + j)) == first16) & (fold16(load16(y + j + m - 1)) == last16);
+      for (size_t k = first_set(hits); k < sizeof(byte16); ++k) {
+        if (hits[k] != 0 && matches_at(j + k)) return y + j + k;
+      }
+    }
+  }
+
+  // Fewer than 16 positions left.
+  for (; j <= last_position; ++j) {
+    if (fold(y[j]) == first && fold(y[j + m - 1]) == last && matches_at(j)) return y + j;
+  }
+  return nullptr;
+}
+
+char* strcasestr(const char* haystack, const char* needle) {
+  if (needle[0] == '\0') return const_cast<char*>(haystack);
+
+  // As in strstr, search a window at a time so an early match doesn't need
+  // the length of the whole haystack. Consecutive windows overlap by m - 1
+  // bytes so no position is missed.
+  const unsigned char* p = reinterpret_cast<const unsigned char*>(haystack);
+  const unsigned char* x = reinterpret_cast<const unsigned char*>(needle);
+  size_t m = strlen(needle);
+  size_t chunk = (m < 4096) ? 4096 : m;
+  while (true) {
+    size_t n = strnlen(reinterpret_cast<const char*>(p), chunk + m - 1);
+    const unsigned char* result = memcasemem(p, n, x, m);
+    if (result != nullptr) return reinterpret_cast<char*>(const_cast<unsigned char*>(result));
+    if (n < chunk + m - 1) return nullptr;
+    p += chunk;
+  }
+}
@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#define _GNU_SOURCE 1
+#include <limits.h>
+#include <stdint.h>
+#include <string.h>
+
+// The upstream versions compare every byte of the string with every byte
+// of the set. Turning the set into a bitmap first makes each byte of the
+// string a single lookup, however big the set is.
+
+namespace {
+
+class ByteSet {
+ public:
+  explicit ByteSet(const char* set) {
+    memset(bits_, 0, sizeof(bits_));
+    for (const unsigned char* p = reinterpret_cast<const unsigned char*>(set); *p; ++p) Add(*p);
+  }
+
+  void Add(unsigned char ch) { bits_[ch / kBitsPerWord] |= uint64_t(1) << (ch % kBitsPerWord); }
+
+  bool Contains(unsigned char ch) const {
+    return (bits_[ch / kBitsPerWord] >> (ch % kBitsPerWord)) & 1;
+  }
+
+ private:
+  static constexpr size_t kBitsPerWord = 64;
+  uint64_t bits_[(UCHAR_MAX + 1) / kBitsPerWord];
+};
+
+}  // namespace
+
+size_t strspn(const char* s, const char* accept) {
+  const unsigned char* p = reinterpret_cast<const unsigned char*>(s);
+  if (accept[0] == '\0') return 0;
+  if (accept[1] == '\0') {
+    while (*p == static_cast<unsigned char>(accept[0])) ++p;
+    return p - reinterpret_cast<const unsigned char*>(s);
+  }
+
+  // NUL isn't in the set, so it stops the scan.
+  ByteSet set(accept);
+  while (set.Contains(*p)) ++p;
+  return p - reinterpret_cast<const unsigned char*>(s);
+}
+
+size_t strcspn(const char* s, const char* reject) {
+  if (reject[0] == '\0') return strlen(s);
+  if (reject[1] == '\0') return strchrnul(s, reject[0]) - s;
+
+  // Adding NUL to the set means one test finds either.
+  const unsigned char* p = reinterpret_cast<const unsigned char*>(s);
+  ByteSet set(reject);
+  set.Add('\0');
+  while (!set.Contains(*p)) ++p;
+  return p - reinterpret_cast<const unsigned char*>(s);
+}
+
+char* strpbrk(const char* s, const char* accept) {
+  s += strcspn(s, accept);
+  return (*s != '\0') ? const_cast<char*>(s) : nullptr;
+}
@@ -0,0 +1,50 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <string.h>
+
+char* strstr(const char* haystack, const char* needle) {
+  if (needle[0] == '\0') return const_cast<char*>(haystack);
+
+  // Skip straight to the first possible match.
+  const char* p = strchr(haystack, needle[0]);
+  if (p == nullptr || needle[1] == '\0') return const_cast<char*>(p);
+
+  // Search the rest with memmem, a window at a time so that an early
+  // match doesn't need the length of the whole haystack. Consecutive
+  // windows overlap by m - 1 bytes so no position is missed.
+  size_t m = strlen(needle);
+  size_t chunk = (m < 4096) ? 4096 : m;
+  while (true) {
+    size_t n = strnlen(p, chunk + m - 1);
+    void* result = memmem(p, n, needle, m);
+    if (result != nullptr) return static_cast<char*>(result);
+    if (n < chunk + m - 1) return nullptr;
+    p += chunk;
+  }
+}
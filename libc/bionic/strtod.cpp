@@ -0,0 +1,263 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/user.h>
+
+#include "private/bionic_decimal.h"
+
+// libc_gdtoa builds gdtoa's strtod and strtof under these names, so that we can try a fast
+// path first.
+extern "C" double __strtod_gdtoa(const char*, char**);
+extern "C" float __strtof_gdtoa(const char*, char**);
+
+// gdtoa's strtod and strtof (behind atof, scanf's %f and friends, and the _l variants too)
+// are correct for every input, but pay for it with bignum arithmetic and a malloc on every
+// call. The common case is a short decimal, and in the style of Eisel and Lemire we can
+// handle that with a single 128-bit multiplication: read up to 19 significant digits into
+// a uint64_t (eight at a time where we can), multiply by the power of ten from the
+// exponent, and round to the destination's precision. Round-half-even ties are only
+// possible when the product is exact, and we know when it is.
+//
+// Anything else is left to gdtoa: hex, infinities and NaNs, products too close to a tie to
+// call, and results that overflow, underflow or are subnormal (where errno is gdtoa's
+// business).
+
+#define MAX_DIGITS 19
+
+// Exponents beyond this are far outside any double, so we stop accumulating.
+#define MAX_EXPONENT 100000
+
+struct Decimal {
+  // The value is w * 10^q.
+  uint64_t w;
+  int q;
+  bool negative;
+  // Whether nonzero digits were dropped after the first MAX_DIGITS.
+  bool truncated;
+  const char* end;
+};
+
+struct FloatFormat {
+  // Including the implicit leading bit.
+  int mantissa_bits;
+  int exponent_bits;
+};
+
+static const FloatFormat kDouble = { 53, 11 };
+static const FloatFormat kFloat = { 24, 8 };
+
+static inline bool IsDigit(char c) {
+  return c >= '0' && c <= '9';
+}
+
+// Reads the eight digits at p, if they are eight digits, all at once. (Android is
+// little-endian, so the first digit ends up in the lowest byte.)
+static inline bool ReadEightDigits(const char* p, uint32_t* result) {
+  // The string may end anywhere, so don't read across a page boundary.
+  if ((reinterpret_cast<uintptr_t>(p) & (PAGE_SIZE - 1)) > PAGE_SIZE - 8) return false;
+
+  uint64_t v;
+  memcpy(&v, p, sizeof(v));
+  // Every byte must be 0x30-0x39: its high nibble 3 both before and after adding 6.
+  uint64_t high = v & 0xf0f0f0f0f0f0f0f0ULL;
+  uint64_t high_plus_6 = (v + 0x0606060606060606ULL) & 0xf0f0f0f0f0f0f0f0ULL;
+  if ((high | (high_plus_6 >> 4)) != 0x3333333333333333ULL) return false;
+  // Combine adjacent digits into pairs, the pairs into fours, and the fours into eight.
+  v -= 0x3030303030303030ULL;
+  v = (v * 10) + (v >> 8);
+  v = (((v & 0x000000ff000000ffULL) * (100 + (1000000ULL << 32))) +
+       (((v >> 16) & 0x000000ff000000ffULL) * (1 + (10000ULL << 32)))) >> 32;
+  *result = static_cast<uint32_t>(v);
+  return true;
+}
+
+// Accumulates the digits at p into d. Digits after a decimal point (is_fraction) scale the
+// value down; dropped digits before one scale it up.
+static const char* ReadDigits(const char* p, bool is_fraction, int* digit_count, Decimal* d) {
+  while (true) {
+    uint32_t eight;
+    if (*digit_count + 8 <= MAX_DIGITS && ReadEightDigits(p, &eight)) {
+      d->w = d->w * 100000000 + eight;
+      *digit_count += 8;
+      if (is_fraction) d->q -= 8;
+      p += 8;
+    } else if (IsDigit(*p)) {
+      if (*digit_count < MAX_DIGITS) {
+        d->w = d->w * 10 + (*p - '0');
+        ++*digit_count;
+        if (is_fraction) --d->q;
+      } else {
+        if (*p != '0') d->truncated = true;
+        if (!is_fraction && d->q < MAX_EXPONENT) ++d->q;
+      }
+      ++p;
+    } else {
+      return p;
+    }
+  }
+}
+
+// Parses the longest prefix of s that strtod would, as long as it's a plain decimal.
+static bool ParseDecimal(const char* s, Decimal* d) {
+  const char* p = s;
+  while (*p == ' ' || (*p >= '\t' && *p <= '\r')) ++p;
+  d->negative = (*p == '-');
+  if (*p == '-' || *p == '+') ++p;
+  if (p[0] == '0' && (p[1] == 'x' || p[1] == 'X')) return false;
+
+  d->w = 0;
+  d->q = 0;
+  d->truncated = false;
+  int digit_count = 0;
+
+  // Leading zeros aren't significant digits.
+  const char* digits = p;
+  while (*p == '0') ++p;
+  p = ReadDigits(p, false, &digit_count, d);
+  bool have_digits = (p != digits);
+
+  if (*p == '.') {
+    digits = ++p;
+    if (digit_count == 0) {
+      while (*p == '0') ++p;
+      if (p - digits > MAX_EXPONENT) return false;
+      d->q -= (p - digits);
+    }
+    p = ReadDigits(p, true, &digit_count, d);
+    have_digits |= (p != digits);
+  }
+  if (!have_digits) return false;
+
+  // An exponent with no digits isn't part of the number.
+  if (*p == 'e' || *p == 'E') {
+    const char* e = p + 1;
+    bool negative_exponent = (*e == '-');
+    if (*e == '-' || *e == '+') ++e;
+    if (IsDigit(*e)) {
+      int exponent = 0;
+      for (; IsDigit(*e); ++e) {
+        if (exponent < MAX_EXPONENT) exponent = exponent * 10 + (*e - '0');
+      }
+      d->q += negative_exponent ? -exponent : exponent;
+      p = e;
+    }
+  }
+  d->end = p;
+  return true;
+}
+
+// Rounds w * 10^q to m * 2^(e - (mantissa_bits - 1)), with m in
+// [2^(mantissa_bits - 1), 2^mantissa_bits).
+static bool ToBinary(uint64_t w, int q, int mantissa_bits, uint64_t* m, int* e) {
+  int shift = __builtin_clzll(w);
+  uint64_t f = w << shift;
+
+  // Our estimate of e, floor(log2(w * 10^q)), using 217706/2^16 ~= log2(10), may be off
+  // by one either way.
+  int estimate = (63 - shift) + ((q * 217706) >> 16);
+  const uint64_t low = UINT64_C(1) << (mantissa_bits - 1);
+  ScaledValue s;
+  for (int attempt = 0; ; ++attempt) {
+    if (attempt == 3 ||
+        !scale_by_power_of_ten(f, mantissa_bits - 1 - estimate - shift, q, &s)) {
+      return false;
+    }
+    if (s.integer >= 2 * low) {
+      ++estimate;
+    } else if (s.integer < low) {
+      --estimate;
+    } else {
+      break;
+    }
+  }
+  if (!round_scaled_value(s, m)) return false;
+  if (*m == 2 * low) {
+    // Rounded up to the next power of two.
+    *m = low;
+    ++estimate;
+  }
+  *e = estimate;
+  return true;
+}
+
+// Returns the bits of the float or double nearest to s, or false to leave s to gdtoa.
+static bool FastStrToF(const char* s, char** end_ptr, const FloatFormat& format,
+                       uint64_t* result) {
+  Decimal d;
+  if (!ParseDecimal(s, &d)) return false;
+
+  int sign_bit = format.mantissa_bits - 1 + format.exponent_bits;
+  uint64_t sign = static_cast<uint64_t>(d.negative) << sign_bit;
+  if (d.w == 0) {
+    *result = sign;
+  } else {
+    uint64_t m;
+    int e;
+    if (!ToBinary(d.w, d.q, format.mantissa_bits, &m, &e)) return false;
+    if (d.truncated) {
+      // The true value is somewhere between w and w + 1, so both must round the same way.
+      uint64_t m1;
+      int e1;
+      if (!ToBinary(d.w + 1, d.q, format.mantissa_bits, &m1, &e1) || m1 != m || e1 != e) {
+        return false;
+      }
+    }
+    int max_biased_exponent = (1 << format.exponent_bits) - 2;
+    int biased_exponent = e + max_biased_exponent / 2;
+    if (biased_exponent < 1 || biased_exponent > max_biased_exponent) return false;
+    uint64_t mantissa_mask = (UINT64_C(1) << (format.mantissa_bits - 1)) - 1;
+    *result = sign | (static_cast<uint64_t>(biased_exponent) << (format.mantissa_bits - 1)) |
+              (m & mantissa_mask);
+  }
+  if (end_ptr != nullptr) *end_ptr = const_cast<char*>(d.end);
+  return true;
+}
+
+double strtod(const char* s, char** end_ptr) {
+  uint64_t bits;
+  if (FastStrToF(s, end_ptr, kDouble, &bits)) {
+    double result;
+    memcpy(&result, &bits, sizeof(result));
+    return result;
+  }
+  return __strtod_gdtoa(s, end_ptr);
+}
+
+float strtof(const char* s, char** end_ptr) {
+  uint64_t bits;
+  if (FastStrToF(s, end_ptr, kFloat, &bits)) {
+    uint32_t float_bits = static_cast<uint32_t>(bits);
+    float result;
+    memcpy(&result, &float_bits, sizeof(result));
+    return result;
+  }
+  return __strtof_gdtoa(s, end_ptr);
+}
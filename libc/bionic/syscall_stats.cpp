@@ -0,0 +1,269 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+
+#include <android/syscall_stats.h>
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/user.h>
+#include <unistd.h>
+
+#include "private/ErrnoRestorer.h"
+#include "private/bionic_lock.h"
+#include "private/bionic_macros.h"
+#include "private/bionic_syscall_stats.h"
+#include "pthread_internal.h"
+
+#if defined(LIBC_SYSCALL_STATS)
+
+// Everything here makes its own system calls with syscall(2), which isn't instrumented, so that
+// it never ends up back in __syscall_stats_end.
+
+struct syscall_stats_table {
+  syscall_stats_table* next;
+  syscall_stats_table* prev;
+  pid_t tid;
+  // The call count and cycle count of each entry in __syscall_stats_names, in turn. Only the
+  // thread the table belongs to writes them.
+  uint64_t counters[];
+};
+
+// What a thread's syscall_stats points to once it has started exiting.
+#define TABLE_CLOSED reinterpret_cast<syscall_stats_table*>(1)
+
+static Lock g_tables_lock;
+// The tables of the running threads.
+static syscall_stats_table* g_tables;
+// The totals of the threads that have exited, mapped when the first one does.
+static syscall_stats_table* g_exited;
+
+static size_t TableSize() {
+  return BIONIC_ALIGN(sizeof(syscall_stats_table) + 2 * __syscall_stats_count * sizeof(uint64_t),
+                      PAGE_SIZE);
+}
+
+static syscall_stats_table* MapTable(pid_t tid) {
+  ErrnoRestorer errno_restorer;
+#if defined(__LP64__)
+  long result = syscall(__NR_mmap, nullptr, TableSize(), PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+#else
+  long result = syscall(__NR_mmap2, nullptr, TableSize(), PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+#endif
+  void* p = reinterpret_cast<void*>(result);
+  if (p == MAP_FAILED) return nullptr;
+  syscall_stats_table* table = reinterpret_cast<syscall_stats_table*>(p);
+  table->tid = tid;
+  return table;
+}
+
+static void UnmapTable(syscall_stats_table* table) {
+  ErrnoRestorer errno_restorer;
+  syscall(__NR_munmap, table, TableSize());
+}
+
+static void Unlink(syscall_stats_table* table) {
+  if (table->prev != nullptr) {
+    table->prev->next = table->next;
+  } else {
+    g_tables = table->next;
+  }
+  if (table->next != nullptr) table->next->prev = table->prev;
+}
+
+// Adds table's counts to g_exited, and unlinks and unmaps it. Called with g_tables_lock held.
+static void Retire(syscall_stats_table* table) {
+  Unlink(table);
+  if (g_exited == nullptr) g_exited = MapTable(0);
+  if (g_exited != nullptr) {
+    for (size_t i = 0; i < 2 * __syscall_stats_count; ++i) {
+      g_exited->counters[i] += table->counters[i];
+    }
+  }
+  UnmapTable(table);
+}
+
+// Returns the calling thread's table, mapping it the first time it's needed.
+static syscall_stats_table* GetTable() {
+  pthread_internal_t* thread = __get_thread();
+  if (__predict_false(thread == nullptr)) return nullptr;
+  syscall_stats_table* table = thread->syscall_stats;
+  if (__predict_true(table != nullptr)) return (table == TABLE_CLOSED) ? nullptr : table;
+
+  table = MapTable(thread->tid);
+  if (table == nullptr) return nullptr;
+  if (thread->syscall_stats != nullptr) {
+    // A signal handler got here first.
+    UnmapTable(table);
+    return GetTable();
+  }
+  // Publish the table before taking the lock, so that a signal handler on this thread doesn't
+  // try to map another, and wait for the lock we hold.
+  thread->syscall_stats = table;
+  g_tables_lock.lock();
+  table->next = g_tables;
+  if (g_tables != nullptr) g_tables->prev = table;
+  g_tables = table;
+  g_tables_lock.unlock();
+  return table;
+}
+
+// The same clocks the kernel's perf tools use, where userspace can read them.
+static inline uint64_t Now() {
+#if defined(__i386__) || defined(__x86_64__)
+  return __builtin_ia32_rdtsc();
+#elif defined(__aarch64__)
+  uint64_t ticks;
+  __asm__ __volatile__("mrs %0, cntvct_el0" : "=r"(ticks));
+  return ticks;
+#else
+  return 0;
+#endif
+}
+
+uint64_t __syscall_stats_begin() {
+  return Now();
+}
+
+void __syscall_stats_end(size_t index, uint64_t start) {
+  uint64_t end = Now();
+  syscall_stats_table* table = GetTable();
+  if (__predict_false(table == nullptr)) return;
+  table->counters[2 * index] += 1;
+  table->counters[2 * index + 1] += end - start;
+}
+
+void __syscall_stats_thread_exit(pthread_internal_t* thread) {
+  syscall_stats_table* table = thread->syscall_stats;
+  thread->syscall_stats = TABLE_CLOSED;
+  if (table != nullptr && table != TABLE_CLOSED) {
+    g_tables_lock.lock();
+    Retire(table);
+    g_tables_lock.unlock();
+  }
+}
+
+void __syscall_stats_fork_child(pthread_internal_t* self) {
+  // The other threads didn't come with us, and may have been holding the lock. A new process
+  // starts counting from zero.
+  g_tables_lock.init(false);
+  syscall_stats_table* table = g_tables;
+  while (table != nullptr) {
+    syscall_stats_table* next = table->next;
+    if (table != self->syscall_stats) {
+      Unlink(table);
+      UnmapTable(table);
+    }
+    table = next;
+  }
+  if (g_exited != nullptr) {
+    UnmapTable(g_exited);
+    g_exited = nullptr;
+  }
+  table = self->syscall_stats;
+  if (table != nullptr && table != TABLE_CLOSED) {
+    table->tid = self->tid;
+    memset(table->counters, 0, 2 * __syscall_stats_count * sizeof(uint64_t));
+  }
+}
+
+static void Report(syscall_stats_table* table, pid_t tid,
+                   void (*callback)(const android_syscall_stats*, void*), void* arg) {
+  for (size_t i = 0; i < __syscall_stats_count; ++i) {
+    android_syscall_stats stats;
+    stats.calls = table->counters[2 * i];
+    if (stats.calls == 0) continue;
+    stats.cycles = table->counters[2 * i + 1];
+    stats.tid = tid;
+    stats.name = __syscall_stats_names[i];
+    callback(&stats, arg);
+  }
+}
+
+int android_syscall_stats_iterate(void (*callback)(const android_syscall_stats*, void*),
+                                  void* arg) {
+  if (callback == nullptr) {
+    errno = EINVAL;
+    return -1;
+  }
+  // Any system calls the callback makes go in our table, which mustn't need mapping while we hold
+  // the lock.
+  GetTable();
+  g_tables_lock.lock();
+  for (syscall_stats_table* table = g_tables; table != nullptr; table = table->next) {
+    Report(table, table->tid, callback, arg);
+  }
+  if (g_exited != nullptr) Report(g_exited, 0, callback, arg);
+  g_tables_lock.unlock();
+  return 0;
+}
+
+#else
+
+void __syscall_stats_thread_exit(pthread_internal_t*) {
+}
+
+void __syscall_stats_fork_child(pthread_internal_t*) {
+}
+
+int android_syscall_stats_iterate(void (*)(const android_syscall_stats*, void*), void*) {
+  errno = ENOSYS;
+  return -1;
+}
+
+#endif
+
+struct DumpState {
+  int fd;
+  int error;
+};
+
+static void DumpOne(const android_syscall_stats* stats, void* arg) {
+  DumpState* state = reinterpret_cast<DumpState*>(arg);
+  if (state->error != 0) return;
+  if (dprintf(state->fd, "%d %s %llu %llu\n", stats->tid, stats->name,
+              static_cast<unsigned long long>(stats->calls),
+              static_cast<unsigned long long>(stats->cycles)) < 0) {
+    state->error = errno;
+  }
+}
+
+int android_syscall_stats_dump(int fd) {
+  DumpState state = { fd, 0 };
+  if (android_syscall_stats_iterate(DumpOne, &state) == -1) return -1;
+  if (state.error != 0) {
+    errno = state.error;
+    return -1;
+  }
+  return 0;
+}
@@ -46,6 +46,43 @@ static long __sysconf_rlimit(int resource) {
   return rl.rlim_cur;
 }
 
+enum CacheAttribute {
+  kCacheSize,
+  kCacheAssoc,
+  kCacheLineSize,
+};
+
+// Reports the first CPU's caches. On big.LITTLE systems the other clusters' may differ; see
+// android_get_cpu_topology().
+static long __sysconf_cache(int level, int type, CacheAttribute attribute) {
+  const android_cpu_topology* topology = android_get_cpu_topology();
+  if (topology == nullptr || topology->cpu_count == 0) {
+    return 0;
+  }
+  const android_cpu_info& cpu = topology->cpus[0];
+  for (int i = 0; i < cpu.cache_count; ++i) {
+    const android_cpu_cache& cache = cpu.caches[i];
+    if (cache.level != level || (cache.type != type && cache.type != ANDROID_CPU_CACHE_UNIFIED)) {
+      continue;
+    }
+    long result = cache.size;
+    if (attribute == kCacheAssoc) result = cache.ways;
+    if (attribute == kCacheLineSize) result = cache.line_size;
+    // 0 means unknown.
+    return MAX(result, 0);
+  }
+  return 0;
+}
+
+static long __sysconf_icache(CacheAttribute attribute) {
+  return __sysconf_cache(1, ANDROID_CPU_CACHE_INSTRUCTION, attribute);
+}
+
+// Level 2 and up are usually unified.
+static long __sysconf_dcache(int level, CacheAttribute attribute) {
+  return __sysconf_cache(level, ANDROID_CPU_CACHE_DATA, attribute);
+}
+
 long sysconf(int name) {
   switch (name) {
     //
@@ -137,7 +174,7 @@ long sysconf(int name) {
     case _SC_GETPW_R_SIZE_MAX:  return 1024;
     case _SC_LOGIN_NAME_MAX:    return 256;   // Seems default on linux.
     case _SC_THREAD_DESTRUCTOR_ITERATIONS: return PTHREAD_DESTRUCTOR_ITERATIONS;
-    case _SC_THREAD_KEYS_MAX:   return PTHREAD_KEYS_MAX;
+    case _SC_THREAD_KEYS_MAX:   return PTHREAD_KEYS_MAX + BIONIC_PTHREAD_KEY_EXTRA_COUNT;
     case _SC_THREAD_STACK_MIN:    return PTHREAD_STACK_MIN;
     case _SC_THREAD_THREADS_MAX:  return -1; // No specific limit.
     case _SC_TTY_NAME_MAX:        return 32; // Seems default on linux.
@@ -195,23 +232,22 @@ long sysconf(int name) {
     case _SC_XOPEN_STREAMS:     return -1;            // Obsolescent in POSIX.1-2008.
     case _SC_XOPEN_UUCP:        return -1;
 
-    // We do not have actual implementations for cache queries.
-    // It's valid to return 0 as the result is unknown.
-    case _SC_LEVEL1_ICACHE_SIZE:      return 0;
-    case _SC_LEVEL1_ICACHE_ASSOC:     return 0;
-    case _SC_LEVEL1_ICACHE_LINESIZE:  return 0;
-    case _SC_LEVEL1_DCACHE_SIZE:      return 0;
-    case _SC_LEVEL1_DCACHE_ASSOC:     return 0;
-    case _SC_LEVEL1_DCACHE_LINESIZE:  return 0;
-    case _SC_LEVEL2_CACHE_SIZE:       return 0;
-    case _SC_LEVEL2_CACHE_ASSOC:      return 0;
-    case _SC_LEVEL2_CACHE_LINESIZE:   return 0;
-    case _SC_LEVEL3_CACHE_SIZE:       return 0;
-    case _SC_LEVEL3_CACHE_ASSOC:      return 0;
-    case _SC_LEVEL3_CACHE_LINESIZE:   return 0;
-    case _SC_LEVEL4_CACHE_SIZE:       return 0;
-    case _SC_LEVEL4_CACHE_ASSOC:      return 0;
-    case _SC_LEVEL4_CACHE_LINESIZE:   return 0;
+    // 0 means unknown, which is what the cache queries return if sysfs doesn't say.
+    case _SC_LEVEL1_ICACHE_SIZE:      return __sysconf_icache(kCacheSize);
+    case _SC_LEVEL1_ICACHE_ASSOC:     return __sysconf_icache(kCacheAssoc);
+    case _SC_LEVEL1_ICACHE_LINESIZE:  return __sysconf_icache(kCacheLineSize);
+    case _SC_LEVEL1_DCACHE_SIZE:      return __sysconf_dcache(1, kCacheSize);
+    case _SC_LEVEL1_DCACHE_ASSOC:     return __sysconf_dcache(1, kCacheAssoc);
+    case _SC_LEVEL1_DCACHE_LINESIZE:  return __sysconf_dcache(1, kCacheLineSize);
+    case _SC_LEVEL2_CACHE_SIZE:       return __sysconf_dcache(2, kCacheSize);
+    case _SC_LEVEL2_CACHE_ASSOC:      return __sysconf_dcache(2, kCacheAssoc);
+    case _SC_LEVEL2_CACHE_LINESIZE:   return __sysconf_dcache(2, kCacheLineSize);
+    case _SC_LEVEL3_CACHE_SIZE:       return __sysconf_dcache(3, kCacheSize);
+    case _SC_LEVEL3_CACHE_ASSOC:      return __sysconf_dcache(3, kCacheAssoc);
+    case _SC_LEVEL3_CACHE_LINESIZE:   return __sysconf_dcache(3, kCacheLineSize);
+    case _SC_LEVEL4_CACHE_SIZE:       return __sysconf_dcache(4, kCacheSize);
+    case _SC_LEVEL4_CACHE_ASSOC:      return __sysconf_dcache(4, kCacheAssoc);
+    case _SC_LEVEL4_CACHE_LINESIZE:   return __sysconf_dcache(4, kCacheLineSize);
 
     default:
       // Posix says EINVAL is the only error that shall be returned,
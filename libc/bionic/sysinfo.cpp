@@ -29,21 +29,37 @@
 #include <sys/sysinfo.h>
 
 #include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <sys/user.h>
+#include <time.h>
 #include <unistd.h>
 
+#include <atomic>
+
+#include "private/LineReader.h"
 #include "private/get_cpu_count_from_string.h"
 #include "private/ScopedReaddir.h"
 
-static bool __matches_cpuN(const char* s) {
-  // The %c trick is to ensure that we have the anchored match "^cpu[0-9]+$".
-  unsigned cpu;
-  char dummy;
-  return (sscanf(s, "cpu%u%c", &cpu, &dummy) == 1);
+static bool __matches_cpuN(const char* s, int* cpu) {
+  // The anchored match "^cpu[0-9]+$".
+  if (strncmp(s, "cpu", 3) != 0) {
+    return false;
+  }
+  unsigned n;
+  const char* end = FieldTokenizer::ParseNumber(s + 3, 10, &n);
+  if (end == nullptr || *end != '\0') {
+    return false;
+  }
+  *cpu = n;
+  return true;
 }
 
-int get_nprocs_conf() {
+static int __read_nprocs_conf() {
   // On x86 kernels you can use /proc/cpuinfo for this, but on ARM kernels offline CPUs disappear
   // from there. This method works on both.
   ScopedReaddir reader("/sys/devices/system/cpu");
@@ -52,28 +68,177 @@ int get_nprocs_conf() {
   }
 
   int result = 0;
+  int cpu;
   dirent* entry;
   while ((entry = reader.ReadEntry()) != NULL) {
-    if (entry->d_type == DT_DIR && __matches_cpuN(entry->d_name)) {
+    if (entry->d_type == DT_DIR && __matches_cpuN(entry->d_name, &cpu)) {
       ++result;
     }
   }
   return result;
 }
 
+static int __read_nprocs() {
+  char line[PAGE_SIZE];
+  if (!ReadSmallFile("/sys/devices/system/cpu/online", line, sizeof(line))) {
+    return 1;
+  }
+  return GetCpuCountFromString(line);
+}
+
+// The CPU counts only change on hotplug, but sysconf(_SC_NPROCESSORS_ONLN) is called often (by
+// every thread pool sizing itself, say), so a count is re-read at most every
+// kCpuCountRefreshMs. Each cache packs the time the count expires, in CLOCK_MONOTONIC_COARSE
+// milliseconds, above the count in its low 16 bits; 0 means the count hasn't been read yet.
+static constexpr uint64_t kCpuCountRefreshMs = 100;
+
+static std::atomic<uint64_t> g_nprocs_conf_cache;
+static std::atomic<uint64_t> g_nprocs_cache;
+
+static int __cached_cpu_count(std::atomic<uint64_t>* cache, int (*read_count)()) {
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+  uint64_t now_ms = static_cast<uint64_t>(ts.tv_sec) * 1000 + ts.tv_nsec / 1000000;
+
+  uint64_t cached = cache->load(std::memory_order_relaxed);
+  if (cached != 0 && now_ms < (cached >> 16)) {
+    return static_cast<int>(cached & 0xffff);
+  }
+
+  int count = read_count();
+  if (count > 0 && count <= 0xffff) {
+    cache->store(((now_ms + kCpuCountRefreshMs) << 16) | count, std::memory_order_relaxed);
+  }
+  return count;
+}
+
+int get_nprocs_conf() {
+  return __cached_cpu_count(&g_nprocs_conf_cache, __read_nprocs_conf);
+}
+
 int get_nprocs() {
-  int cpu_count = 1;
-  FILE* fp = fopen("/sys/devices/system/cpu/online", "re");
-  if (fp != nullptr) {
-    char* line = nullptr;
-    size_t len = 0;
-    if (getline(&line, &len, fp) != -1) {
-      cpu_count = GetCpuCountFromString(line);
-      free(line);
+  return __cached_cpu_count(&g_nprocs_cache, __read_nprocs);
+}
+
+// Returns -1 if the attribute is missing, as the topology attributes of offline CPUs are on
+// some kernels.
+static long __read_cpu_attribute(int cpu, const char* name) {
+  char path[128];
+  char value[64];
+  snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/%s", cpu, name);
+  if (!ReadSmallFile(path, value, sizeof(value))) {
+    return -1;
+  }
+  char* end;
+  long result = strtol(value, &end, 10);
+  if (end == value) {
+    return -1;
+  }
+  // Cache sizes are in the kernel's "32K" format.
+  if (*end == 'K') result *= 1024;
+  if (*end == 'M') result *= 1024 * 1024;
+  return result;
+}
+
+static int __read_cache_type(int cpu, int index) {
+  char path[128];
+  char value[64];
+  snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/cache/index%d/type", cpu, index);
+  if (!ReadSmallFile(path, value, sizeof(value))) {
+    return -1;
+  }
+  if (strncmp(value, "Data", 4) == 0) return ANDROID_CPU_CACHE_DATA;
+  if (strncmp(value, "Instruction", 11) == 0) return ANDROID_CPU_CACHE_INSTRUCTION;
+  if (strncmp(value, "Unified", 7) == 0) return ANDROID_CPU_CACHE_UNIFIED;
+  return -1;
+}
+
+static void __read_cpu_info(android_cpu_info* info) {
+  int cpu = info->cpu;
+  info->core_id = __read_cpu_attribute(cpu, "topology/core_id");
+  // Newer kernels report big.LITTLE clusters separately from the package.
+  info->cluster_id = __read_cpu_attribute(cpu, "topology/cluster_id");
+  if (info->cluster_id == -1) {
+    info->cluster_id = __read_cpu_attribute(cpu, "topology/physical_package_id");
+  }
+  long max_freq = __read_cpu_attribute(cpu, "cpufreq/cpuinfo_max_freq");
+  info->max_freq_khz = (max_freq == -1) ? 0 : max_freq;
+
+  for (int i = 0; i < ANDROID_CPU_MAX_CACHES; ++i) {
+    char name[64];
+    snprintf(name, sizeof(name), "cache/index%d/level", i);
+    long level = __read_cpu_attribute(cpu, name);
+    if (level == -1) {
+      break;
     }
-    fclose(fp);
+    android_cpu_cache* cache = &info->caches[info->cache_count++];
+    cache->level = level;
+    cache->type = __read_cache_type(cpu, i);
+    snprintf(name, sizeof(name), "cache/index%d/size", i);
+    long size = __read_cpu_attribute(cpu, name);
+    cache->size = (size == -1) ? 0 : size;
+    snprintf(name, sizeof(name), "cache/index%d/coherency_line_size", i);
+    cache->line_size = __read_cpu_attribute(cpu, name);
+    snprintf(name, sizeof(name), "cache/index%d/ways_of_associativity", i);
+    cache->ways = __read_cpu_attribute(cpu, name);
   }
-  return cpu_count;
+}
+
+static int __compare_cpu_info(const void* lhs, const void* rhs) {
+  return reinterpret_cast<const android_cpu_info*>(lhs)->cpu -
+         reinterpret_cast<const android_cpu_info*>(rhs)->cpu;
+}
+
+static android_cpu_topology* g_cpu_topology;
+static pthread_once_t g_cpu_topology_once = PTHREAD_ONCE_INIT;
+
+static void __parse_cpu_topology() {
+  ScopedReaddir reader("/sys/devices/system/cpu");
+  if (reader.IsBad()) {
+    return;
+  }
+
+  android_cpu_info* cpus = nullptr;
+  int cpu_count = 0;
+  int cpu;
+  dirent* entry;
+  while ((entry = reader.ReadEntry()) != NULL) {
+    if (entry->d_type == DT_DIR && __matches_cpuN(entry->d_name, &cpu)) {
+      android_cpu_info* grown = reinterpret_cast<android_cpu_info*>(
+          realloc(cpus, (cpu_count + 1) * sizeof(android_cpu_info)));
+      if (grown == nullptr) {
+        free(cpus);
+        return;
+      }
+      cpus = grown;
+      memset(&cpus[cpu_count], 0, sizeof(android_cpu_info));
+      cpus[cpu_count++].cpu = cpu;
+    }
+  }
+  qsort(cpus, cpu_count, sizeof(android_cpu_info), __compare_cpu_info);
+
+  android_cpu_topology* topology =
+      reinterpret_cast<android_cpu_topology*>(calloc(1, sizeof(android_cpu_topology)));
+  if (topology == nullptr) {
+    free(cpus);
+    return;
+  }
+  for (int i = 0; i < cpu_count; ++i) {
+    __read_cpu_info(&cpus[i]);
+    bool new_cluster = (cpus[i].cluster_id != -1);
+    for (int j = 0; j < i && new_cluster; ++j) {
+      new_cluster = (cpus[j].cluster_id != cpus[i].cluster_id);
+    }
+    if (new_cluster) ++topology->cluster_count;
+  }
+  topology->cpu_count = cpu_count;
+  topology->cpus = cpus;
+  g_cpu_topology = topology;
+}
+
+const android_cpu_topology* android_get_cpu_topology() {
+  pthread_once(&g_cpu_topology_once, __parse_cpu_topology);
+  return g_cpu_topology;
 }
 
 long get_phys_pages() {
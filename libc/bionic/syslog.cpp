@@ -15,15 +15,241 @@
  */
 
 #include <errno.h>
+#include <limits.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdatomic.h>
 #include <stdlib.h>
 #include <string.h>
 #include <syslog.h>
+#include <time.h>
+#include <unistd.h>
 
+#include "private/bionic_futex.h"
+#include "private/kernel_sigset_t.h"
 #include "private/libc_logging.h"
 
 static const char* syslog_log_tag = NULL;
 static int syslog_priority_mask = 0xff;
 
+// The most android_syslog_set_async will queue.
+static constexpr size_t kMaxAsyncQueueLength = 64 * 1024;
+
+// A queued message, formatted straight into the slot by the thread that logged it.
+struct SyslogSlot {
+  // The position of the message in the slot, plus one, once it's ready to be written, and the
+  // position of the next message the slot will take once it has been written. This is the
+  // bounded multi-producer queue from
+  // http://www.1024cores.net/home/lock-free-algorithms/queues/bounded-mpmc-queue, with only
+  // the background thread taking messages off.
+  _Atomic(size_t) sequence;
+  int priority;
+  pid_t tid;
+  timespec timestamp;
+  // openlog's tag could be freed after a closelog while a message is still queued.
+  char tag[128];
+  char msg[1024];
+};
+
+struct SyslogQueue {
+  pid_t pid;
+  int flags;
+  size_t mask;
+
+  _Atomic(size_t) enqueue_pos;
+  // How many messages the background thread has written.
+  _Atomic(size_t) dequeue_pos;
+
+  // 1 while the background thread is asleep waiting for a message.
+  _Atomic(int) writer_sleeping;
+  // Bumped by the background thread each time it runs out of messages, while there are threads
+  // in android_syslog_flush waiting for it.
+  _Atomic(int) flush_generation;
+  _Atomic(int) flush_waiters;
+
+  _Atomic(uint64_t) dropped;
+  _Atomic(uint64_t) written_directly;
+
+  SyslogSlot slots[];
+};
+
+// Set once by android_syslog_set_async. A queue is never freed, so a thread that loads this
+// can use it without worrying about a concurrent android_syslog_set_async; a forked child's
+// inherited queue (with no thread to empty it) is just ignored.
+static _Atomic(SyslogQueue*) g_syslog_queue = ATOMIC_VAR_INIT(nullptr);
+static pthread_mutex_t g_syslog_queue_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static SyslogQueue* __syslog_queue() {
+  SyslogQueue* queue = atomic_load_explicit(&g_syslog_queue, memory_order_acquire);
+  return (queue != nullptr && queue->pid == getpid()) ? queue : nullptr;
+}
+
+// Returns a free slot and its position, or null if the queue is full.
+static SyslogSlot* __syslog_claim_slot(SyslogQueue* queue, size_t* pos_ptr) {
+  size_t pos = atomic_load_explicit(&queue->enqueue_pos, memory_order_relaxed);
+  while (true) {
+    SyslogSlot* slot = &queue->slots[pos & queue->mask];
+    size_t sequence = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+    intptr_t difference = static_cast<intptr_t>(sequence - pos);
+    if (difference == 0) {
+      if (atomic_compare_exchange_weak_explicit(&queue->enqueue_pos, &pos, pos + 1,
+                                                memory_order_relaxed, memory_order_relaxed)) {
+        *pos_ptr = pos;
+        return slot;
+      }
+    } else if (difference < 0) {
+      return nullptr;
+    } else {
+      pos = atomic_load_explicit(&queue->enqueue_pos, memory_order_relaxed);
+    }
+  }
+}
+
+static void __syslog_publish_slot(SyslogQueue* queue, SyslogSlot* slot, size_t pos) {
+  atomic_store_explicit(&slot->sequence, pos + 1, memory_order_release);
+  // Pairs with the fence in __syslog_writer_wait: either we see it asleep, or it sees our message.
+  atomic_thread_fence(memory_order_seq_cst);
+  if (atomic_load_explicit(&queue->writer_sleeping, memory_order_relaxed) != 0 &&
+      atomic_exchange_explicit(&queue->writer_sleeping, 0, memory_order_relaxed) != 0) {
+    __futex_wake_ex(&queue->writer_sleeping, false, 1);
+  }
+}
+
+static bool __syslog_slot_ready(SyslogQueue* queue, size_t pos) {
+  SyslogSlot* slot = &queue->slots[pos & queue->mask];
+  return atomic_load_explicit(&slot->sequence, memory_order_acquire) == pos + 1;
+}
+
+static void __syslog_writer_wait(SyslogQueue* queue, size_t pos) {
+  atomic_store_explicit(&queue->writer_sleeping, 1, memory_order_relaxed);
+  atomic_thread_fence(memory_order_seq_cst);
+  if (__syslog_slot_ready(queue, pos)) {
+    atomic_store_explicit(&queue->writer_sleeping, 0, memory_order_relaxed);
+    return;
+  }
+  __futex_wait_ex(&queue->writer_sleeping, false, 1, false, nullptr);
+}
+
+static void* __syslog_writer(void* arg) {
+  SyslogQueue* queue = reinterpret_cast<SyslogQueue*>(arg);
+  size_t pos = 0;
+  uint64_t reported_drops = 0;
+  while (true) {
+    if (__syslog_slot_ready(queue, pos)) {
+      SyslogSlot* slot = &queue->slots[pos & queue->mask];
+      __libc_write_log_stamped(slot->priority, slot->tag, slot->msg, slot->tid, &slot->timestamp);
+      atomic_store_explicit(&slot->sequence, pos + queue->mask + 1, memory_order_release);
+      atomic_store_explicit(&queue->dequeue_pos, ++pos, memory_order_release);
+      continue;
+    }
+
+    // We've caught up (or the thread logging the next message is still formatting it).
+    // The fence pairs with the one in android_syslog_flush: either it sees our last write, or
+    // we see it waiting.
+    atomic_thread_fence(memory_order_seq_cst);
+    if ((queue->flags & ANDROID_SYSLOG_ASYNC_REPORT_DROPS) != 0) {
+      uint64_t dropped = atomic_load_explicit(&queue->dropped, memory_order_relaxed);
+      if (dropped != reported_drops) {
+        __libc_format_log(ANDROID_LOG_WARN, "libc", "syslog dropped %llu messages",
+                          static_cast<unsigned long long>(dropped - reported_drops));
+        reported_drops = dropped;
+      }
+    }
+    if (atomic_load_explicit(&queue->flush_waiters, memory_order_acquire) != 0) {
+      atomic_fetch_add_explicit(&queue->flush_generation, 1, memory_order_release);
+      __futex_wake_ex(&queue->flush_generation, false, INT_MAX);
+    }
+    __syslog_writer_wait(queue, pos);
+  }
+  return nullptr;
+}
+
+int android_syslog_set_async(size_t queue_length, int flags) {
+  if (queue_length == 0 || queue_length > kMaxAsyncQueueLength ||
+      (flags & ~(ANDROID_SYSLOG_ASYNC_WRITE_WHEN_FULL | ANDROID_SYSLOG_ASYNC_REPORT_DROPS)) != 0) {
+    errno = EINVAL;
+    return -1;
+  }
+  size_t length = 1;
+  while (length < queue_length) length <<= 1;
+
+  pthread_mutex_lock(&g_syslog_queue_lock);
+  if (__syslog_queue() != nullptr) {
+    pthread_mutex_unlock(&g_syslog_queue_lock);
+    errno = EBUSY;
+    return -1;
+  }
+
+  SyslogQueue* queue = reinterpret_cast<SyslogQueue*>(
+      calloc(1, sizeof(SyslogQueue) + length * sizeof(SyslogSlot)));
+  if (queue == nullptr) {
+    pthread_mutex_unlock(&g_syslog_queue_lock);
+    return -1;
+  }
+  queue->pid = getpid();
+  queue->flags = flags;
+  queue->mask = length - 1;
+  for (size_t i = 0; i < length; ++i) {
+    atomic_init(&queue->slots[i].sequence, i);
+  }
+
+  pthread_attr_t attr;
+  pthread_attr_init(&attr);
+  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+
+  // Signals are for the application's threads, not ours.
+  kernel_sigset_t sigset;
+  sigset.fill();
+  kernel_sigset_t old_sigset;
+  pthread_sigmask(SIG_SETMASK, sigset.get(), old_sigset.get());
+
+  pthread_t thread;
+  int rc = pthread_create(&thread, &attr, __syslog_writer, queue);
+
+  pthread_sigmask(SIG_SETMASK, old_sigset.get(), NULL);
+  pthread_attr_destroy(&attr);
+
+  if (rc != 0) {
+    free(queue);
+    pthread_mutex_unlock(&g_syslog_queue_lock);
+    errno = rc;
+    return -1;
+  }
+  pthread_setname_np(thread, "syslog");
+
+  atomic_store_explicit(&g_syslog_queue, queue, memory_order_release);
+  pthread_mutex_unlock(&g_syslog_queue_lock);
+  return 0;
+}
+
+void android_syslog_flush() {
+  SyslogQueue* queue = __syslog_queue();
+  if (queue == nullptr) return;
+
+  size_t target = atomic_load_explicit(&queue->enqueue_pos, memory_order_relaxed);
+  atomic_fetch_add_explicit(&queue->flush_waiters, 1, memory_order_relaxed);
+  atomic_thread_fence(memory_order_seq_cst);
+  while (true) {
+    int generation = atomic_load_explicit(&queue->flush_generation, memory_order_acquire);
+    // Compare distances rather than positions, in case they wrap.
+    size_t written = atomic_load_explicit(&queue->dequeue_pos, memory_order_acquire);
+    if (static_cast<intptr_t>(written - target) >= 0) break;
+    __futex_wait_ex(&queue->flush_generation, false, generation, false, nullptr);
+  }
+  atomic_fetch_sub_explicit(&queue->flush_waiters, 1, memory_order_relaxed);
+}
+
+void android_syslog_get_async_stats(android_syslog_async_stats* stats) {
+  SyslogQueue* queue = __syslog_queue();
+  if (queue == nullptr) {
+    memset(stats, 0, sizeof(*stats));
+    return;
+  }
+  stats->written = atomic_load_explicit(&queue->dequeue_pos, memory_order_relaxed);
+  stats->dropped = atomic_load_explicit(&queue->dropped, memory_order_relaxed);
+  stats->written_directly = atomic_load_explicit(&queue->written_directly, memory_order_relaxed);
+}
+
 void closelog() {
   syslog_log_tag = NULL;
 }
@@ -109,14 +335,41 @@ void vsyslog(int priority, const char* fmt, va_list args) {
     *dst = '\0';
   }
 
+  // Format straight into a slot in the queue, if there's one with room.
+  SyslogQueue* queue = __syslog_queue();
+  SyslogSlot* slot = nullptr;
+  size_t pos = 0;
+  if (queue != nullptr) {
+    slot = __syslog_claim_slot(queue, &pos);
+    if (slot == nullptr) {
+      if ((queue->flags & ANDROID_SYSLOG_ASYNC_WRITE_WHEN_FULL) == 0) {
+        atomic_fetch_add_explicit(&queue->dropped, 1, memory_order_relaxed);
+        if (log_fmt != fmt) {
+          free(const_cast<char*>(log_fmt));
+        }
+        return;
+      }
+      atomic_fetch_add_explicit(&queue->written_directly, 1, memory_order_relaxed);
+    }
+  }
+
   // We can't let __libc_format_log do the formatting because it doesn't support
   // all the printf functionality.
-  char log_line[1024];
-  vsnprintf(log_line, sizeof(log_line), log_fmt, args);
+  char log_line[sizeof(SyslogSlot::msg)];
+  char* msg = (slot != nullptr) ? slot->msg : log_line;
+  vsnprintf(msg, sizeof(log_line), log_fmt, args);
 
   if (log_fmt != fmt) {
     free(const_cast<char*>(log_fmt));
   }
 
-  __libc_format_log(android_log_priority, log_tag, "%s", log_line);
+  if (slot != nullptr) {
+    slot->priority = android_log_priority;
+    slot->tid = gettid();
+    strlcpy(slot->tag, log_tag, sizeof(slot->tag));
+    __libc_log_timestamp(&slot->timestamp);
+    __syslog_publish_slot(queue, slot, pos);
+  } else {
+    __libc_write_log(android_log_priority, log_tag, log_line);
+  }
 }
@@ -54,8 +54,12 @@
 #include <sys/system_properties.h>
 
 #include "private/bionic_futex.h"
+#include "private/bionic_globals.h"
 #include "private/bionic_lock.h"
 #include "private/bionic_macros.h"
+#include "private/bionic_property_contexts.h"
+#include "private/bionic_sections.h"
+#include "private/bionic_stats.h"
 #include "private/libc_logging.h"
 
 static const char property_service_socket[] = "/dev/socket/" PROP_SERVICE_NAME;
@@ -76,6 +80,15 @@ static const char property_service_socket[] = "/dev/socket/" PROP_SERVICE_NAME;
  *                  +-----+   +-----+     +-----+            +-----------+
  *                  | net |   | sys |     | com |            |     1     |
  *                  +-----+   +-----+     +-----+            +===========+
+ *
+ * That's the PROP_AREA_VERSION layout, which we can still read. Areas we
+ * create are PROP_AREA_VERSION_HASHED, where following a sibling tree from
+ * node to node costs a cache miss per level of the tree. Instead, a node's
+ * children pointer leads to its first child, and once it has more than one
+ * its left pointer leads to a prop_bt_table: an open-addressed hash table of
+ * all its children, keyed by a hash of their names, so finding a child is
+ * usually one cache line of the table and one for the child itself. The
+ * right pointer is unused.
  */
 
 // Represents a node in the trie.
@@ -116,72 +129,159 @@ private:
     DISALLOW_COPY_AND_ASSIGN(prop_bt);
 };
 
+// A PROP_AREA_VERSION_HASHED node's children. A slot is empty until its node
+// offset is set, which happens after its hash is. Slots are never removed;
+// when the table gets too full, the writer copies it into a bigger one and
+// points the parent at that instead.
+struct prop_bt_table {
+    uint32_t capacity;  // A power of two.
+    uint32_t size;      // Only used by the writer.
+
+    struct slot {
+        atomic_uint_least32_t hash;
+        atomic_uint_least32_t node;
+    } slots[0];
+
+    explicit prop_bt_table(uint32_t capacity) : capacity(capacity), size(0) {
+    }
+
+private:
+    DISALLOW_COPY_AND_ASSIGN(prop_bt_table);
+};
+
+class prop_area;
+
+// Remembers the nodes for the leading components of the last name looked up,
+// so that looking up names in sorted order only walks the components they
+// share once.
+struct prop_trie_cursor {
+    const prop_area* pa = nullptr;
+    const char* name = nullptr;
+    size_t depth = 0;
+    // For each component: the offset of the '.' after it, and its node.
+    size_t ends[PROP_NAME_MAX / 2];
+    prop_bt* nodes[PROP_NAME_MAX / 2];
+};
+
+// Bits in a prop_area's flags word. They're only maintained in the serial
+// area, and only by the property service, which sets PROP_AREA_FLAG_VALID when
+// it creates the area; areas written by an older init have none set.
+static constexpr uint32_t PROP_AREA_FLAG_VALID = 0x80000000;
+// A malloc debug or malloc sampler property has been given a value.
+static constexpr uint32_t PROP_AREA_FLAG_MALLOC_DEBUG = 0x00000001;
+
 class prop_area {
 public:
 
     prop_area(const uint32_t magic, const uint32_t version) :
         magic_(magic), version_(version) {
         atomic_init(&serial_, 0);
+        atomic_init(&flags_, PROP_AREA_FLAG_VALID);
         memset(reserved_, 0, sizeof(reserved_));
         // Allocate enough space for the root node.
         bytes_used_ = sizeof(prop_bt);
     }
 
     const prop_info *find(const char *name);
+    const prop_info *find(const char *name, prop_trie_cursor *cursor);
     bool add(const char *name, unsigned int namelen,
              const char *value, unsigned int valuelen);
 
     bool foreach(void (*propfn)(const prop_info *pi, void *cookie), void *cookie);
 
     atomic_uint_least32_t *serial() { return &serial_; }
+    uint32_t flags() { return atomic_load_explicit(&flags_, memory_order_relaxed); }
+    void set_flags(uint32_t flags) {
+        atomic_store_explicit(&flags_, this->flags() | flags, memory_order_relaxed);
+    }
     uint32_t magic() const { return magic_; }
     uint32_t version() const { return version_; }
 
 private:
     void *allocate_obj(const size_t size, uint_least32_t *const off);
     prop_bt *new_prop_bt(const char *name, uint8_t namelen, uint_least32_t *const off);
+    prop_bt_table *new_prop_bt_table(uint32_t capacity, uint_least32_t *const off);
     prop_info *new_prop_info(const char *name, uint8_t namelen,
-                             const char *value, uint8_t valuelen,
+                             const char *value, uint32_t valuelen,
                              uint_least32_t *const off);
     void *to_prop_obj(uint_least32_t off);
     prop_bt *to_prop_bt(atomic_uint_least32_t *off_p);
     prop_info *to_prop_info(atomic_uint_least32_t *off_p);
+    prop_bt_table *to_prop_bt_table(atomic_uint_least32_t *off_p);
+
+    bool hashed() const { return version_ == PROP_AREA_VERSION_HASHED; }
 
     prop_bt *root_node();
 
+    prop_bt *find_child(prop_bt *const parent, const char *name,
+                        uint8_t namelen, bool alloc_if_needed);
     prop_bt *find_prop_bt(prop_bt *const bt, const char *name,
                           uint8_t namelen, bool alloc_if_needed);
+    prop_bt *find_child_hashed(prop_bt *const parent, const char *name,
+                               uint8_t namelen, bool alloc_if_needed);
+    bool add_child_hashed(prop_bt *const parent, uint32_t hash, uint_least32_t child_off);
 
     const prop_info *find_property(prop_bt *const trie, const char *name,
                                    uint8_t namelen, const char *value,
-                                   uint8_t valuelen, bool alloc_if_needed);
+                                   uint32_t valuelen, bool alloc_if_needed);
 
     bool foreach_property(prop_bt *const trie,
                           void (*propfn)(const prop_info *pi, void *cookie),
                           void *cookie);
+    bool foreach_property_hashed(prop_bt *const trie,
+                                 void (*propfn)(const prop_info *pi, void *cookie),
+                                 void *cookie);
 
     uint32_t bytes_used_;
     atomic_uint_least32_t serial_;
     uint32_t magic_;
     uint32_t version_;
-    uint32_t reserved_[28];
+    atomic_uint_least32_t flags_;
+    uint32_t reserved_[27];
     char data_[0];
 
     DISALLOW_COPY_AND_ASSIGN(prop_area);
 };
 
+/*
+ * A read-only property's value can be PROP_VALUE_MAX or longer. It's then
+ * stored after the name instead of in value, which holds its length, and
+ * the length in the serial is PROP_LONG_VALUE_LEN.
+ */
 struct prop_info {
     atomic_uint_least32_t serial;
     char value[PROP_VALUE_MAX];
     char name[0];
 
     prop_info(const char *name, const uint8_t namelen, const char *value,
-              const uint8_t valuelen) {
+              const uint32_t valuelen) {
         memcpy(this->name, name, namelen);
         this->name[namelen] = '\0';
-        atomic_init(&this->serial, valuelen << 24);
-        memcpy(this->value, value, valuelen);
-        this->value[valuelen] = '\0';
+        if (valuelen < PROP_VALUE_MAX) {
+            atomic_init(&this->serial, valuelen << 24);
+            memcpy(this->value, value, valuelen);
+            this->value[valuelen] = '\0';
+        } else {
+            atomic_init(&this->serial, PROP_LONG_VALUE_LEN << 24);
+            memcpy(this->value, &valuelen, sizeof(valuelen));
+            char* long_value = this->name + namelen + 1;
+            memcpy(long_value, value, valuelen);
+            long_value[valuelen] = '\0';
+        }
+    }
+
+    static bool is_long(uint32_t serial) {
+        return SERIAL_VALUE_LEN(serial) == PROP_LONG_VALUE_LEN;
+    }
+
+    const char* long_value() const {
+        return name + strlen(name) + 1;
+    }
+
+    uint32_t long_value_len() const {
+        uint32_t len;
+        memcpy(&len, value, sizeof(len));
+        return len;
     }
 private:
     DISALLOW_COPY_AND_ASSIGN(prop_info);
@@ -196,15 +296,15 @@ struct find_nth_cookie {
     }
 };
 
-static char property_filename[PROP_FILENAME_MAX] = PROP_FILENAME;
-static bool compat_mode = false;
-static size_t pa_data_size;
-static size_t pa_size;
-static bool initialized = false;
+static char property_filename[PROP_FILENAME_MAX] __BIONIC_READ_MOSTLY = PROP_FILENAME;
+static bool compat_mode __BIONIC_READ_MOSTLY = false;
+static size_t pa_data_size __BIONIC_READ_MOSTLY;
+static size_t pa_size __BIONIC_READ_MOSTLY;
+static bool initialized __BIONIC_READ_MOSTLY = false;
 
 // NOTE: This isn't static because system_properties_compat.c
 // requires it.
-prop_area *__system_property_area__ = NULL;
+prop_area *__system_property_area__ __BIONIC_READ_MOSTLY = NULL;
 
 static int get_fd_from_env(void)
 {
@@ -272,7 +372,7 @@ static prop_area* map_prop_area_rw(const char* filename, const char* context,
         return nullptr;
     }
 
-    prop_area *pa = new(memory_area) prop_area(PROP_AREA_MAGIC, PROP_AREA_VERSION);
+    prop_area *pa = new(memory_area) prop_area(PROP_AREA_MAGIC, PROP_AREA_VERSION_HASHED);
 
     close(fd);
     return pa;
@@ -302,6 +402,7 @@ static prop_area* map_fd_ro(const int fd) {
     prop_area* pa = reinterpret_cast<prop_area*>(map_result);
     if ((pa->magic() != PROP_AREA_MAGIC) ||
         (pa->version() != PROP_AREA_VERSION &&
+         pa->version() != PROP_AREA_VERSION_HASHED &&
          pa->version() != PROP_AREA_VERSION_COMPAT)) {
         munmap(pa, pa_size);
         return nullptr;
@@ -370,11 +471,29 @@ prop_bt *prop_area::new_prop_bt(const char *name, uint8_t namelen, uint_least32_
     return NULL;
 }
 
+prop_bt_table *prop_area::new_prop_bt_table(uint32_t capacity, uint_least32_t *const off)
+{
+    uint_least32_t new_offset;
+    void *const p = allocate_obj(sizeof(prop_bt_table) + capacity * sizeof(prop_bt_table::slot),
+                                 &new_offset);
+    if (p != NULL) {
+        prop_bt_table* table = new(p) prop_bt_table(capacity);
+        *off = new_offset;
+        return table;
+    }
+
+    return NULL;
+}
+
 prop_info *prop_area::new_prop_info(const char *name, uint8_t namelen,
-        const char *value, uint8_t valuelen, uint_least32_t *const off)
+        const char *value, uint32_t valuelen, uint_least32_t *const off)
 {
+    size_t size = sizeof(prop_info) + namelen + 1;
+    if (valuelen >= PROP_VALUE_MAX) {
+        size += valuelen + 1;
+    }
     uint_least32_t new_offset;
-    void* const p = allocate_obj(sizeof(prop_info) + namelen + 1, &new_offset);
+    void* const p = allocate_obj(size, &new_offset);
     if (p != NULL) {
         prop_info* info = new(p) prop_info(name, namelen, value, valuelen);
         *off = new_offset;
@@ -402,6 +521,11 @@ inline prop_info *prop_area::to_prop_info(atomic_uint_least32_t* off_p) {
   return reinterpret_cast<prop_info*>(to_prop_obj(off));
 }
 
+inline prop_bt_table *prop_area::to_prop_bt_table(atomic_uint_least32_t* off_p) {
+  uint_least32_t off = atomic_load_explicit(off_p, memory_order_consume);
+  return reinterpret_cast<prop_bt_table*>(to_prop_obj(off));
+}
+
 inline prop_bt *prop_area::root_node()
 {
     return reinterpret_cast<prop_bt*>(to_prop_obj(0));
@@ -469,8 +593,158 @@ prop_bt *prop_area::find_prop_bt(prop_bt *const bt, const char *name,
     }
 }
 
+// FNV-1a.
+static uint32_t prop_name_hash(const char *name, uint8_t namelen)
+{
+    uint32_t hash = 2166136261u;
+    for (uint8_t i = 0; i < namelen; ++i) {
+        hash = (hash ^ static_cast<uint8_t>(name[i])) * 16777619u;
+    }
+    return hash;
+}
+
+prop_bt *prop_area::find_child_hashed(prop_bt *const parent, const char *name,
+                                      uint8_t namelen, bool alloc_if_needed)
+{
+    const uint32_t hash = prop_name_hash(name, namelen);
+
+    uint_least32_t table_offset = atomic_load_explicit(&parent->left, memory_order_relaxed);
+    if (table_offset != 0) {
+        prop_bt_table* table = to_prop_bt_table(&parent->left);
+        if (!table) {
+            return NULL;
+        }
+        const uint32_t mask = table->capacity - 1;
+        for (uint32_t i = hash & mask, n = 0; n < table->capacity; i = (i + 1) & mask, ++n) {
+            prop_bt_table::slot* slot = &table->slots[i];
+            // Acquire, not consume: we need to see the hash stored before it.
+            uint_least32_t node_offset = atomic_load_explicit(&slot->node, memory_order_acquire);
+            if (node_offset == 0) {
+                break;
+            }
+            if (atomic_load_explicit(&slot->hash, memory_order_relaxed) != hash) {
+                continue;
+            }
+            prop_bt* child = reinterpret_cast<prop_bt*>(to_prop_obj(node_offset));
+            if (child && !cmp_prop_name(name, namelen, child->name, child->namelen)) {
+                return child;
+            }
+        }
+    } else {
+        uint_least32_t child_offset = atomic_load_explicit(&parent->children, memory_order_relaxed);
+        if (child_offset != 0) {
+            prop_bt* child = to_prop_bt(&parent->children);
+            if (child && !cmp_prop_name(name, namelen, child->name, child->namelen)) {
+                return child;
+            }
+        }
+    }
+
+    if (!alloc_if_needed) {
+        return NULL;
+    }
+
+    uint_least32_t new_offset;
+    prop_bt* new_bt = new_prop_bt(name, namelen, &new_offset);
+    if (!new_bt) {
+        return NULL;
+    }
+    if (atomic_load_explicit(&parent->children, memory_order_relaxed) == 0) {
+        atomic_store_explicit(&parent->children, new_offset, memory_order_release);
+        return new_bt;
+    }
+    return add_child_hashed(parent, hash, new_offset) ? new_bt : NULL;
+}
+
+// Only called by the writer, so it doesn't need to worry about anyone else
+// changing the table underneath it.
+bool prop_area::add_child_hashed(prop_bt *const parent, uint32_t hash, uint_least32_t child_off)
+{
+    prop_bt_table* table = NULL;
+    if (atomic_load_explicit(&parent->left, memory_order_relaxed) != 0) {
+        table = to_prop_bt_table(&parent->left);
+    }
+
+    // Keep the table at most three quarters full, so that probes are short.
+    if (!table || (table->size + 1) * 4 > table->capacity * 3) {
+        uint_least32_t new_table_offset;
+        prop_bt_table* new_table = new_prop_bt_table(table ? table->capacity * 2 : 4,
+                                                     &new_table_offset);
+        if (!new_table) {
+            return false;
+        }
+
+        // Copy the existing children across: the old table's, or the only
+        // child there was before there was a table.
+        auto insert = [new_table](uint32_t h, uint_least32_t off) {
+            const uint32_t mask = new_table->capacity - 1;
+            uint32_t i = h & mask;
+            while (atomic_load_explicit(&new_table->slots[i].node, memory_order_relaxed) != 0) {
+                i = (i + 1) & mask;
+            }
+            atomic_store_explicit(&new_table->slots[i].hash, h, memory_order_relaxed);
+            atomic_store_explicit(&new_table->slots[i].node, off, memory_order_relaxed);
+            new_table->size++;
+        };
+        if (table) {
+            for (uint32_t i = 0; i < table->capacity; ++i) {
+                uint_least32_t off = atomic_load_explicit(&table->slots[i].node, memory_order_relaxed);
+                if (off != 0) {
+                    insert(atomic_load_explicit(&table->slots[i].hash, memory_order_relaxed), off);
+                }
+            }
+        } else {
+            prop_bt* only_child = to_prop_bt(&parent->children);
+            insert(prop_name_hash(only_child->name, only_child->namelen),
+                   atomic_load_explicit(&parent->children, memory_order_relaxed));
+        }
+        insert(hash, child_off);
+
+        // The old table stays where it is, complete, for anyone still
+        // reading it.
+        atomic_store_explicit(&parent->left, new_table_offset, memory_order_release);
+        return true;
+    }
+
+    const uint32_t mask = table->capacity - 1;
+    uint32_t i = hash & mask;
+    while (atomic_load_explicit(&table->slots[i].node, memory_order_relaxed) != 0) {
+        i = (i + 1) & mask;
+    }
+    atomic_store_explicit(&table->slots[i].hash, hash, memory_order_relaxed);
+    atomic_store_explicit(&table->slots[i].node, child_off, memory_order_release);
+    table->size++;
+    return true;
+}
+
+prop_bt *prop_area::find_child(prop_bt *const parent, const char *name,
+                               uint8_t namelen, bool alloc_if_needed)
+{
+    if (hashed()) {
+        return find_child_hashed(parent, name, namelen, alloc_if_needed);
+    }
+
+    prop_bt* root = NULL;
+    uint_least32_t children_offset = atomic_load_explicit(&parent->children, memory_order_relaxed);
+    if (children_offset != 0) {
+        root = to_prop_bt(&parent->children);
+    } else if (alloc_if_needed) {
+        uint_least32_t new_offset;
+        root = new_prop_bt(name, namelen, &new_offset);
+        if (root) {
+            atomic_store_explicit(&parent->children, new_offset, memory_order_release);
+        }
+    }
+
+    if (!root) {
+        return NULL;
+    }
+
+    return find_prop_bt(root, name, namelen, alloc_if_needed);
+}
+
 const prop_info *prop_area::find_property(prop_bt *const trie, const char *name,
-        uint8_t namelen, const char *value, uint8_t valuelen,
+        uint8_t namelen, const char *value, uint32_t valuelen,
         bool alloc_if_needed)
 {
     if (!trie) return NULL;
@@ -487,23 +761,7 @@ const prop_info *prop_area::find_property(prop_bt *const trie, const char *name,
             return NULL;
         }
 
-        prop_bt* root = NULL;
-        uint_least32_t children_offset = atomic_load_explicit(&current->children, memory_order_relaxed);
-        if (children_offset != 0) {
-            root = to_prop_bt(&current->children);
-        } else if (alloc_if_needed) {
-            uint_least32_t new_offset;
-            root = new_prop_bt(remaining_name, substr_size, &new_offset);
-            if (root) {
-                atomic_store_explicit(&current->children, new_offset, memory_order_release);
-            }
-        }
-
-        if (!root) {
-            return NULL;
-        }
-
-        current = find_prop_bt(root, remaining_name, substr_size, alloc_if_needed);
+        current = find_child(current, remaining_name, substr_size, alloc_if_needed);
         if (!current) {
             return NULL;
         }
@@ -530,7 +788,7 @@ const prop_info *prop_area::find_property(prop_bt *const trie, const char *name,
     }
 }
 
-static int send_prop_msg(const prop_msg *msg)
+static int connect_prop_service()
 {
     const int fd = socket(AF_LOCAL, SOCK_STREAM | SOCK_CLOEXEC, 0);
     if (fd == -1) {
@@ -548,6 +806,15 @@ static int send_prop_msg(const prop_msg *msg)
         close(fd);
         return -1;
     }
+    return fd;
+}
+
+static int send_prop_msg(const prop_msg *msg)
+{
+    const int fd = connect_prop_service();
+    if (fd == -1) {
+        return -1;
+    }
 
     const int num_bytes = TEMP_FAILURE_RETRY(send(fd, msg, sizeof(prop_msg), 0));
 
@@ -585,6 +852,217 @@ static int send_prop_msg(const prop_msg *msg)
     return result;
 }
 
+/*
+ * The connection to property_service for __system_property_set_batch() and
+ * __system_property_set_async(), which stays open between calls and carries
+ * any number of PROP_MSG_SETPROP_STREAM messages. The service answers each
+ * one in order, so asynchronous sets only need to count how many answers are
+ * still to come.
+ *
+ * Like the context nodes, this uses a bionic Lock rather than a pthread mutex.
+ */
+static Lock prop_stream_lock __BIONIC_FORK_WRITTEN;
+static int prop_stream_fd __BIONIC_FORK_WRITTEN = -1;
+static pid_t prop_stream_pid __BIONIC_FORK_WRITTEN;
+// Has the service answered anything on this connection yet?
+static bool prop_stream_answered;
+// Asynchronous sets sent but not yet answered, and whether any has failed.
+static size_t prop_stream_unanswered;
+static bool prop_stream_async_failed;
+// Set once the service has shown it only understands PROP_MSG_SETPROP.
+static bool prop_stream_unsupported;
+
+// How many messages are sent before waiting for their answers. This keeps
+// the service from blocking on a full socket while we block on another.
+static constexpr size_t kPropStreamWindow = 32;
+
+enum prop_answer {
+    PROP_ANSWER_OK,
+    PROP_ANSWER_REJECTED,
+    PROP_ANSWER_NONE,   // Timed out, or nothing yet if not waiting.
+    PROP_ANSWER_LOST,   // The connection has gone.
+};
+
+static void prop_stream_close()
+{
+    if (prop_stream_fd != -1) {
+        close(prop_stream_fd);
+        prop_stream_fd = -1;
+    }
+}
+
+static bool prop_stream_open()
+{
+    if (prop_stream_fd != -1) {
+        if (prop_stream_pid == getpid()) {
+            return true;
+        }
+        // Inherited across fork: the connection and any answers still due on
+        // it belong to the parent.
+        prop_stream_close();
+        prop_stream_unanswered = 0;
+        prop_stream_async_failed = false;
+    }
+
+    const int fd = connect_prop_service();
+    if (fd == -1) {
+        return false;
+    }
+    // Wait for each answer as long as send_prop_msg() waits for the service
+    // to hang up.
+    timeval timeout = { 0, 250000 };
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    prop_stream_fd = fd;
+    prop_stream_pid = getpid();
+    prop_stream_answered = false;
+    return true;
+}
+
+// Can asynchronous sets be sent without opening or probing a connection?
+static bool prop_stream_established()
+{
+    return prop_stream_fd != -1 && prop_stream_pid == getpid() && prop_stream_answered;
+}
+
+static bool prop_stream_write(const prop_msg* msgs, size_t count)
+{
+    const char* p = reinterpret_cast<const char*>(msgs);
+    size_t remaining = count * sizeof(prop_msg);
+    while (remaining > 0) {
+        const ssize_t num_bytes = TEMP_FAILURE_RETRY(send(prop_stream_fd, p, remaining,
+                                                          MSG_NOSIGNAL));
+        if (num_bytes <= 0) {
+            return false;
+        }
+        p += num_bytes;
+        remaining -= num_bytes;
+    }
+    return true;
+}
+
+static prop_answer prop_stream_read_answer(bool wait)
+{
+    uint32_t result;
+    const ssize_t num_bytes = TEMP_FAILURE_RETRY(recv(prop_stream_fd, &result, sizeof(result),
+                                                      wait ? MSG_WAITALL : MSG_DONTWAIT));
+    if (num_bytes == sizeof(result)) {
+        prop_stream_answered = true;
+        return (result == 0) ? PROP_ANSWER_OK : PROP_ANSWER_REJECTED;
+    }
+    if (num_bytes == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+        return PROP_ANSWER_NONE;
+    }
+    return PROP_ANSWER_LOST;
+}
+
+// Collects the answers to asynchronous sets: those that have arrived, or
+// all of them if wait is true.
+static void prop_stream_drain(bool wait)
+{
+    while (prop_stream_unanswered > 0) {
+        const prop_answer answer = prop_stream_read_answer(wait);
+        if (answer == PROP_ANSWER_OK || answer == PROP_ANSWER_REJECTED) {
+            if (answer == PROP_ANSWER_REJECTED) {
+                prop_stream_async_failed = true;
+            }
+            --prop_stream_unanswered;
+        } else if (answer == PROP_ANSWER_NONE && !wait) {
+            return;
+        } else {
+            // A timeout is taken as success, as in send_prop_msg(), but
+            // later answers couldn't be matched up, so start again.
+            if (answer == PROP_ANSWER_LOST) {
+                prop_stream_async_failed = true;
+            }
+            prop_stream_unanswered = 0;
+            prop_stream_close();
+        }
+    }
+}
+
+// Sends up to kPropStreamWindow messages and waits for their answers.
+// Returns how many were handled by the service, which is fewer than count
+// if the connection was lost. Sets *failed if any was rejected.
+static size_t prop_stream_send(const prop_msg* msgs, size_t count, bool* failed)
+{
+    if (!prop_stream_write(msgs, count)) {
+        return 0;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        switch (prop_stream_read_answer(true)) {
+            case PROP_ANSWER_OK:
+                break;
+            case PROP_ANSWER_REJECTED:
+                *failed = true;
+                break;
+            case PROP_ANSWER_NONE:
+                // The rest were delivered; as in send_prop_msg(), assume the
+                // service is just slow.
+                prop_stream_close();
+                return count;
+            case PROP_ANSWER_LOST:
+                return i;
+        }
+    }
+    return count;
+}
+
+// Sets up to kPropStreamWindow properties and waits until they've been set,
+// over the stream if the service supports it and one connection at a time
+// if not. Returns false if any of them failed. Call with the lock held.
+static bool prop_stream_set(prop_msg* msgs, size_t count)
+{
+    bool failed = false;
+    bool retried = false;
+    size_t done = 0;
+    while (done < count && !prop_stream_unsupported && prop_stream_open()) {
+        prop_stream_drain(true);
+        if (prop_stream_fd == -1) {
+            continue;
+        }
+
+        const bool fresh = !prop_stream_answered;
+        const size_t handled = prop_stream_send(msgs + done, count - done, &failed);
+        done += handled;
+        if (done < count) {
+            prop_stream_close();
+            if (fresh && handled == 0) {
+                // Hung up without answering: an older service that only
+                // takes PROP_MSG_SETPROP.
+                prop_stream_unsupported = true;
+            } else if (retried) {
+                break;
+            } else {
+                // It may just have closed a connection we'd left idle.
+                retried = true;
+            }
+        }
+    }
+
+    for (; done < count; ++done) {
+        msgs[done].cmd = PROP_MSG_SETPROP;
+        if (send_prop_msg(&msgs[done]) < 0) {
+            failed = true;
+        }
+    }
+    return !failed;
+}
+
+static bool make_prop_msg(prop_msg* msg, unsigned cmd, const char* key, const char* value)
+{
+    if (key == 0) return false;
+    if (value == 0) value = "";
+    if (strlen(key) >= PROP_NAME_MAX) return false;
+    if (strlen(value) >= PROP_VALUE_MAX) return false;
+
+    memset(msg, 0, sizeof(*msg));
+    msg->cmd = cmd;
+    strlcpy(msg->name, key, sizeof(msg->name));
+    strlcpy(msg->value, value, sizeof(msg->value));
+    return true;
+}
+
 static void find_nth_fn(const prop_info *pi, void *ptr)
 {
     find_nth_cookie *cookie = reinterpret_cast<find_nth_cookie*>(ptr);
@@ -630,23 +1108,106 @@ bool prop_area::foreach_property(prop_bt *const trie,
     return true;
 }
 
+bool prop_area::foreach_property_hashed(prop_bt *const trie,
+        void (*propfn)(const prop_info *pi, void *cookie), void *cookie)
+{
+    if (!trie)
+        return false;
+
+    uint_least32_t prop_offset = atomic_load_explicit(&trie->prop, memory_order_relaxed);
+    if (prop_offset != 0) {
+        prop_info *info = to_prop_info(&trie->prop);
+        if (!info)
+            return false;
+        propfn(info, cookie);
+    }
+
+    uint_least32_t table_offset = atomic_load_explicit(&trie->left, memory_order_relaxed);
+    if (table_offset != 0) {
+        prop_bt_table *table = to_prop_bt_table(&trie->left);
+        if (!table)
+            return false;
+        for (uint32_t i = 0; i < table->capacity; ++i) {
+            uint_least32_t node_offset =
+                atomic_load_explicit(&table->slots[i].node, memory_order_relaxed);
+            if (node_offset != 0 &&
+                !foreach_property_hashed(to_prop_bt(&table->slots[i].node), propfn, cookie))
+                return false;
+        }
+    } else {
+        uint_least32_t children_offset = atomic_load_explicit(&trie->children, memory_order_relaxed);
+        if (children_offset != 0 &&
+            !foreach_property_hashed(to_prop_bt(&trie->children), propfn, cookie))
+            return false;
+    }
+
+    return true;
+}
+
 const prop_info *prop_area::find(const char *name) {
     return find_property(root_node(), name, strlen(name), nullptr, 0, false);
 }
 
+const prop_info *prop_area::find(const char *name, prop_trie_cursor *cursor) {
+    const size_t max_depth = sizeof(cursor->nodes) / sizeof(cursor->nodes[0]);
+
+    // Start from the last node this name has in common with the previous one.
+    size_t depth = 0;
+    if (cursor->pa == this) {
+        while (depth < cursor->depth && !strncmp(name, cursor->name, cursor->ends[depth] + 1)) {
+            ++depth;
+        }
+    }
+    prop_bt* current = (depth != 0) ? cursor->nodes[depth - 1] : root_node();
+    const char* remaining_name = (depth != 0) ? name + cursor->ends[depth - 1] + 1 : name;
+
+    cursor->pa = this;
+    cursor->name = name;
+    cursor->depth = depth;
+
+    while (current) {
+        const char *sep = strchr(remaining_name, '.');
+        const uint8_t substr_size = (sep != NULL) ? sep - remaining_name : strlen(remaining_name);
+        if (!substr_size) {
+            return NULL;
+        }
+
+        current = find_child(current, remaining_name, substr_size, false);
+        if (!current || sep == NULL) {
+            break;
+        }
+
+        if (cursor->depth < max_depth) {
+            cursor->ends[cursor->depth] = sep - name;
+            cursor->nodes[cursor->depth] = current;
+            ++cursor->depth;
+        }
+        remaining_name = sep + 1;
+    }
+
+    if (!current || atomic_load_explicit(&current->prop, memory_order_relaxed) == 0) {
+        return NULL;
+    }
+    return to_prop_info(&current->prop);
+}
+
 bool prop_area::add(const char *name, unsigned int namelen,
                     const char *value, unsigned int valuelen) {
     return find_property(root_node(), name, namelen, value, valuelen, true);
 }
 
 bool prop_area::foreach(void (*propfn)(const prop_info* pi, void* cookie), void* cookie) {
+    if (hashed()) {
+        return foreach_property_hashed(root_node(), propfn, cookie);
+    }
     return foreach_property(root_node(), propfn, cookie);
 }
 
 class context_node {
 public:
     context_node(context_node* next, const char* context, prop_area* pa)
-        : next(next), context_(strdup(context)), pa_(pa), no_access_(false) {
+        : next(next), context_(strdup(context)), pa_(pa), no_access_(false), used_(false),
+          foreach_holds_(0) {
         lock_.init(false);
     }
     ~context_node() {
@@ -657,6 +1218,11 @@ public:
     bool check_access_and_open();
     void reset_access();
 
+    // For LIBC_PROPERTY_UNMAP_COLD.
+    void mark_used();
+    bool hold_for_foreach();
+    void release_after_foreach(bool unmap_if_unused);
+
     const char* context() const { return context_; }
     prop_area* pa() { return pa_; }
 
@@ -668,13 +1234,18 @@ private:
 
     Lock lock_;
     char* context_;
-    prop_area* pa_;
+    _Atomic(prop_area*) pa_;
     bool no_access_;
+    // Has a lookup used the area? If not, it was only mapped for foreach.
+    atomic_bool used_;
+    // How many foreach calls are looking at the area. Protected by lock_.
+    uint32_t foreach_holds_;
 };
 
 struct prefix_node {
     prefix_node(struct prefix_node* next, const char* prefix, context_node* context)
-        : prefix(strdup(prefix)), prefix_len(strlen(prefix)), context(context), next(next) {
+        : prefix(strdup(prefix)), prefix_len(strlen(prefix)), context(context), next(next),
+          shorter(nullptr) {
     }
     ~prefix_node() {
         free(prefix);
@@ -683,6 +1254,8 @@ struct prefix_node {
     const size_t prefix_len;
     context_node* context;
     struct prefix_node* next;
+    // The longest other prefix that is a prefix of this one, if any.
+    struct prefix_node* shorter;
 };
 
 template <typename List, typename... Args>
@@ -736,6 +1309,259 @@ static void list_free(List** list) {
 static prefix_node* prefixes = nullptr;
 static context_node* contexts = nullptr;
 
+// Set from LIBC_PROPERTY_UNMAP_COLD, for processes that would rather not keep
+// every property area mapped after a __system_property_foreach.
+static bool unmap_cold_contexts = false;
+
+/*
+ * The prefixes list is in the order they should be tried, longest first, which
+ * makes looking up a property's context a scan of every prefix. Once the list
+ * is complete, build_prefix_index() also puts the prefixes in a sorted array,
+ * with the range of entries starting with each byte, so find_prefix() only has
+ * to binary search the entries starting with the same byte as the name.
+ */
+static prefix_node** sorted_prefixes = nullptr;
+static size_t sorted_prefix_start[257];
+static prefix_node* wildcard_prefix = nullptr;
+
+static bool is_wildcard_prefix(const prefix_node* p) {
+    return p->prefix_len == 0 || p->prefix[0] == '*';
+}
+
+static void free_prefix_index() {
+    free(sorted_prefixes);
+    sorted_prefixes = nullptr;
+    memset(sorted_prefix_start, 0, sizeof(sorted_prefix_start));
+    wildcard_prefix = nullptr;
+}
+
+static bool build_prefix_index() {
+    free_prefix_index();
+
+    size_t count = 0;
+    list_foreach(prefixes, [&count](prefix_node*) { ++count; });
+    sorted_prefixes = static_cast<prefix_node**>(malloc(count * sizeof(prefix_node*)));
+    if (count != 0 && !sorted_prefixes) {
+        return false;
+    }
+
+    // Insert in list order, so that when the same prefix appears twice the
+    // one the list scan would have found first is the one kept. Likewise the
+    // catch-all is the first one in the list.
+    size_t n = 0;
+    for (prefix_node* p = prefixes; p; p = p->next) {
+        if (is_wildcard_prefix(p)) {
+            if (!wildcard_prefix) wildcard_prefix = p;
+            continue;
+        }
+        size_t lo = 0, hi = n;
+        int cmp = 1;
+        while (lo < hi) {
+            size_t mid = lo + (hi - lo) / 2;
+            cmp = strcmp(sorted_prefixes[mid]->prefix, p->prefix);
+            if (cmp == 0) break;
+            if (cmp < 0) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        if (cmp == 0) {
+            continue;
+        }
+        memmove(&sorted_prefixes[lo + 1], &sorted_prefixes[lo], (n - lo) * sizeof(prefix_node*));
+        sorted_prefixes[lo] = p;
+        ++n;
+    }
+
+    // Everything between a prefix and a name it matches in sorted order starts
+    // with that prefix, so the prefixes of an entry are all found by following
+    // the previous entry's chain of shorter prefixes.
+    for (size_t i = 0; i < n; ++i) {
+        prefix_node* p = sorted_prefixes[i];
+        prefix_node* shorter = (i > 0) ? sorted_prefixes[i - 1] : nullptr;
+        while (shorter && strncmp(shorter->prefix, p->prefix, shorter->prefix_len)) {
+            shorter = shorter->shorter;
+        }
+        p->shorter = shorter;
+    }
+
+    size_t i = 0;
+    for (size_t c = 0; c < 256; ++c) {
+        sorted_prefix_start[c] = i;
+        while (i < n && static_cast<unsigned char>(sorted_prefixes[i]->prefix[0]) == c) {
+            ++i;
+        }
+    }
+    sorted_prefix_start[256] = n;
+    return true;
+}
+
+static prefix_node* find_prefix(const char* name) {
+    unsigned char c = name[0];
+    size_t start = sorted_prefix_start[c];
+    size_t lo = start, hi = sorted_prefix_start[c + 1];
+
+    // Find the last prefix that sorts no later than the name. The longest
+    // prefix that matches the name is either it or one of its shorter ones.
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (strcmp(sorted_prefixes[mid]->prefix, name) <= 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    if (lo != start) {
+        for (prefix_node* p = sorted_prefixes[lo - 1]; p; p = p->shorter) {
+            if (!strncmp(p->prefix, name, p->prefix_len)) {
+                return p;
+            }
+        }
+    }
+    return wildcard_prefix;
+}
+
+/*
+ * When /property_contexts.bin is there, it's mapped and used in place of the
+ * prefixes list and index above: only the context_nodes are allocated, one per
+ * context rather than one per line. find_compiled_context() is find_prefix()
+ * over the file's table.
+ */
+static const property_contexts_header* compiled_contexts = nullptr;
+static context_node** compiled_context_nodes = nullptr;
+
+static const property_contexts_prefix* compiled_prefix(uint32_t i) {
+    auto base = reinterpret_cast<const char*>(compiled_contexts);
+    return reinterpret_cast<const property_contexts_prefix*>(base + compiled_contexts->prefixes) + i;
+}
+
+static const char* compiled_string(uint32_t offset) {
+    return reinterpret_cast<const char*>(compiled_contexts) + offset;
+}
+
+static context_node* find_compiled_context(const char* name) {
+    const property_contexts_header* h = compiled_contexts;
+    unsigned char c = name[0];
+    uint32_t start = h->prefix_start[c];
+    uint32_t lo = start, hi = h->prefix_start[c + 1];
+
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (strcmp(compiled_string(compiled_prefix(mid)->name), name) <= 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    if (lo != start) {
+        for (uint32_t i = lo - 1; i != PROPERTY_CONTEXTS_NONE; i = compiled_prefix(i)->shorter) {
+            const property_contexts_prefix* p = compiled_prefix(i);
+            if (!strncmp(compiled_string(p->name), name, p->name_len)) {
+                return compiled_context_nodes[p->context];
+            }
+        }
+    }
+    if (h->wildcard_context == PROPERTY_CONTEXTS_NONE) {
+        return nullptr;
+    }
+    return compiled_context_nodes[h->wildcard_context];
+}
+
+static void unmap_compiled_contexts() {
+    if (compiled_contexts) {
+        munmap(const_cast<property_contexts_header*>(compiled_contexts), compiled_contexts->size);
+        compiled_contexts = nullptr;
+    }
+    free(compiled_context_nodes);
+    compiled_context_nodes = nullptr;
+}
+
+static bool compiled_string_ok(const property_contexts_header* h, uint32_t offset) {
+    // The file ends in a NUL, so any string that starts inside it ends inside it.
+    return offset >= sizeof(*h) && offset < h->size;
+}
+
+static bool compiled_table_ok(const property_contexts_header* h, uint32_t offset, uint32_t count,
+                              size_t entry_size) {
+    return offset >= sizeof(*h) && offset % alignof(uint32_t) == 0 && offset <= h->size &&
+           count <= (h->size - offset) / entry_size;
+}
+
+/*
+ * Checks everything find_compiled_context() relies on, so that a truncated or
+ * corrupt file makes us fall back to the text rather than crash.
+ */
+static bool compiled_contexts_ok(const property_contexts_header* h, size_t size) {
+    if (size < sizeof(*h) || h->magic != PROPERTY_CONTEXTS_MAGIC ||
+        h->version != PROPERTY_CONTEXTS_VERSION || h->size != size ||
+        reinterpret_cast<const char*>(h)[size - 1] != '\0' ||
+        !compiled_table_ok(h, h->contexts, h->context_count, sizeof(uint32_t)) ||
+        !compiled_table_ok(h, h->prefixes, h->prefix_count, sizeof(property_contexts_prefix))) {
+        return false;
+    }
+    if (h->wildcard_context != PROPERTY_CONTEXTS_NONE && h->wildcard_context >= h->context_count) {
+        return false;
+    }
+    auto context_offsets = reinterpret_cast<const uint32_t*>(
+        reinterpret_cast<const char*>(h) + h->contexts);
+    for (uint32_t i = 0; i < h->context_count; ++i) {
+        if (!compiled_string_ok(h, context_offsets[i])) return false;
+    }
+    auto prefixes = reinterpret_cast<const property_contexts_prefix*>(
+        reinterpret_cast<const char*>(h) + h->prefixes);
+    for (uint32_t i = 0; i < h->prefix_count; ++i) {
+        const property_contexts_prefix* p = &prefixes[i];
+        if (!compiled_string_ok(h, p->name) || p->name_len > h->size - p->name ||
+            p->context >= h->context_count ||
+            (p->shorter != PROPERTY_CONTEXTS_NONE && p->shorter >= i)) {
+            return false;
+        }
+    }
+    for (size_t c = 0; c < 256; ++c) {
+        if (h->prefix_start[c] > h->prefix_start[c + 1]) return false;
+    }
+    return h->prefix_start[256] == h->prefix_count;
+}
+
+static bool load_compiled_contexts() {
+    int fd = open(PROPERTY_CONTEXTS_BIN_PATH, O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        return false;
+    }
+    struct stat sb;
+    void* map = MAP_FAILED;
+    if (fstat(fd, &sb) == 0 && sb.st_size > 0 &&
+        static_cast<uint64_t>(sb.st_size) < PROPERTY_CONTEXTS_NONE) {
+        map = mmap(nullptr, sb.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (map == MAP_FAILED) {
+        return false;
+    }
+
+    auto h = static_cast<const property_contexts_header*>(map);
+    if (!compiled_contexts_ok(h, sb.st_size)) {
+        munmap(map, sb.st_size);
+        return false;
+    }
+    compiled_contexts = h;
+
+    compiled_context_nodes =
+        static_cast<context_node**>(calloc(h->context_count, sizeof(context_node*)));
+    if (h->context_count != 0 && !compiled_context_nodes) {
+        unmap_compiled_contexts();
+        return false;
+    }
+    // Added in the same order as the text would add them.
+    auto context_offsets = reinterpret_cast<const uint32_t*>(compiled_string(h->contexts));
+    for (uint32_t i = 0; i < h->context_count; ++i) {
+        list_add(&contexts, compiled_string(context_offsets[i]), nullptr);
+        compiled_context_nodes[i] = contexts;
+    }
+    return true;
+}
+
 /*
  * pthread_mutex_lock() calls into system_properties in the case of contention.
  * This creates a risk of dead lock if any system_properties functions
@@ -778,6 +1604,42 @@ bool context_node::check_access_and_open() {
     return pa_;
 }
 
+void context_node::mark_used() {
+    if (!atomic_load_explicit(&used_, memory_order_relaxed)) {
+        atomic_store(&used_, true);
+    }
+}
+
+bool context_node::hold_for_foreach() {
+    while (check_access_and_open()) {
+        lock_.lock();
+        if (pa_) {
+            ++foreach_holds_;
+            lock_.unlock();
+            return true;
+        }
+        // Another foreach unmapped it in between; map it again.
+        lock_.unlock();
+    }
+    return false;
+}
+
+void context_node::release_after_foreach(bool unmap_if_unused) {
+    lock_.lock();
+    if (--foreach_holds_ == 0 && unmap_if_unused && !atomic_load(&used_)) {
+        // A lookup marks the area used before it looks at pa_, so either it
+        // sees nullptr and maps the area again itself, or we see that it's
+        // used and put pa_ back.
+        prop_area* pa = atomic_exchange(&pa_, nullptr);
+        if (atomic_load(&used_) || pa == __system_property_area__) {
+            atomic_store(&pa_, pa);
+        } else {
+            munmap(pa, pa_size);
+        }
+    }
+    lock_.unlock();
+}
+
 void context_node::reset_access() {
     if (!check_access()) {
         unmap();
@@ -829,14 +1691,20 @@ static bool map_system_property_area(bool access_rw, bool* fsetxattr_failed) {
 }
 
 static prop_area* get_prop_area_for_name(const char* name) {
-    auto entry = list_find(prefixes, [name](prefix_node* l) {
-        return l->prefix[0] == '*' || !strncmp(l->prefix, name, l->prefix_len);
-    });
-    if (!entry) {
+    context_node* cnode;
+    if (compiled_contexts) {
+        cnode = find_compiled_context(name);
+    } else {
+        prefix_node* entry = find_prefix(name);
+        cnode = entry ? entry->context : nullptr;
+    }
+    if (!cnode) {
         return nullptr;
     }
 
-    auto cnode = entry->context;
+    if (__predict_false(unmap_cold_contexts)) {
+        cnode->mark_used();
+    }
     if (!cnode->pa()) {
         /*
          * We explicitly do not check no_access_ in this case because unlike the
@@ -942,6 +1810,10 @@ static int read_spec_entries(char *line_buf, int num_args, ...)
 }
 
 static bool initialize_properties() {
+    if (load_compiled_contexts()) {
+        return true;
+    }
+
     FILE* file = fopen("/property_contexts", "re");
 
     if (!file) {
@@ -987,7 +1859,7 @@ static bool initialize_properties() {
 
     free(buffer);
     fclose(file);
-    return true;
+    return build_prefix_index();
 }
 
 static bool is_dir(const char* pathname) {
@@ -998,7 +1870,89 @@ static bool is_dir(const char* pathname) {
     return S_ISDIR(info.st_mode);
 }
 
+/*
+ * A small cache of __system_property_find() results, for callers that look
+ * up the same names over and over. Entries are direct-mapped by name hash.
+ * A prop_info never moves once added, so a hit only has to compare its
+ * name. A miss is cached with the area serial, and goes stale as soon as
+ * any property is added or updated.
+ *
+ * Each entry is a seqlock. A thread that finds an entry being written by
+ * another one just doesn't use the cache this time.
+ *
+ * Reinitializing the property areas (as the tests do) invalidates every
+ * prop_info, so it bumps the generation, which empties the cache.
+ */
+struct find_cache_entry {
+    atomic_uint_least32_t seq;  // Odd while being written.
+    atomic_uint_least32_t generation;
+    atomic_uint_least32_t area_serial;
+    _Atomic(const prop_info*) pi;  // nullptr for a miss.
+    char name[PROP_NAME_MAX];  // Only for a miss: a hit compares pi->name.
+};
+
+static constexpr size_t kFindCacheSize = 64;
+static find_cache_entry find_cache[kFindCacheSize];
+// Starts at 1 so that the zeroed entries don't match.
+static atomic_uint_least32_t find_cache_generation = ATOMIC_VAR_INIT(1);
+
+static bool find_cache_lookup(const char* name, uint32_t hash, const prop_info** pi_ptr)
+{
+    find_cache_entry* e = &find_cache[hash % kFindCacheSize];
+    const uint32_t seq = atomic_load_explicit(&e->seq, memory_order_acquire);
+    if (seq & 1) {
+        return false;
+    }
+    const uint32_t generation = atomic_load_explicit(&e->generation, memory_order_relaxed);
+    const uint32_t area_serial = atomic_load_explicit(&e->area_serial, memory_order_relaxed);
+    const prop_info* pi = atomic_load_explicit(&e->pi, memory_order_relaxed);
+    char cached_name[PROP_NAME_MAX];
+    if (pi == nullptr) {
+        // This races with writers, like the memcpy in __system_property_read.
+        memcpy(cached_name, e->name, sizeof(cached_name));
+    }
+    atomic_thread_fence(memory_order_acquire);
+    if (atomic_load_explicit(&e->seq, memory_order_relaxed) != seq ||
+        generation != atomic_load_explicit(&find_cache_generation, memory_order_relaxed)) {
+        return false;
+    }
+
+    if (pi != nullptr) {
+        if (strcmp(pi->name, name) != 0) {
+            return false;
+        }
+    } else if (area_serial != __system_property_area_serial() ||
+               strncmp(cached_name, name, sizeof(cached_name)) != 0) {
+        return false;
+    }
+    *pi_ptr = pi;
+    return true;
+}
+
+static void find_cache_insert(const char* name, uint32_t hash, uint32_t generation,
+                              uint32_t area_serial, const prop_info* pi)
+{
+    find_cache_entry* e = &find_cache[hash % kFindCacheSize];
+    uint32_t seq = atomic_load_explicit(&e->seq, memory_order_relaxed);
+    if ((seq & 1) || !atomic_compare_exchange_strong_explicit(&e->seq, &seq, seq + 1,
+                                                              memory_order_relaxed,
+                                                              memory_order_relaxed)) {
+        return;
+    }
+    atomic_thread_fence(memory_order_release);
+    atomic_store_explicit(&e->generation, generation, memory_order_relaxed);
+    atomic_store_explicit(&e->area_serial, area_serial, memory_order_relaxed);
+    atomic_store_explicit(&e->pi, pi, memory_order_relaxed);
+    if (pi == nullptr) {
+        strlcpy(e->name, name, sizeof(e->name));
+    }
+    atomic_store_explicit(&e->seq, seq + 2, memory_order_release);
+}
+
 static void free_and_unmap_contexts() {
+    atomic_fetch_add_explicit(&find_cache_generation, 1, memory_order_relaxed);
+    free_prefix_index();
+    unmap_compiled_contexts();
     list_free(&prefixes);
     list_free(&contexts);
     if (__system_property_area__) {
@@ -1009,6 +1963,9 @@ static void free_and_unmap_contexts() {
 
 int __system_properties_init()
 {
+    const char* unmap_cold = getenv("LIBC_PROPERTY_UNMAP_COLD");
+    unmap_cold_contexts = (unmap_cold != nullptr && strcmp(unmap_cold, "1") == 0);
+
     if (initialized) {
         list_foreach(contexts, [](context_node* l) { l->reset_access(); });
         return 0;
@@ -1028,6 +1985,10 @@ int __system_properties_init()
         }
         list_add(&contexts, "legacy_system_prop_area", __system_property_area__);
         list_add_after_len(&prefixes, "*", contexts);
+        if (!build_prefix_index()) {
+            free_and_unmap_contexts();
+            return -1;
+        }
     }
     initialized = true;
     return 0;
@@ -1077,6 +2038,7 @@ unsigned int __system_property_area_serial()
 
 const prop_info *__system_property_find(const char *name)
 {
+    __libc_stats_count(LIBC_STAT_PROPERTY_FINDS);
     if (!__system_property_area__) {
         return nullptr;
     }
@@ -1085,13 +2047,34 @@ const prop_info *__system_property_find(const char *name)
         return __system_property_find_compat(name);
     }
 
+    const size_t namelen = strlen(name);
+    const bool cacheable = (namelen < PROP_NAME_MAX);
+    uint32_t hash = 0;
+    uint32_t generation = 0;
+    uint32_t area_serial = 0;
+    if (cacheable) {
+        hash = prop_name_hash(name, namelen);
+        const prop_info* pi;
+        if (find_cache_lookup(name, hash, &pi)) {
+            return pi;
+        }
+        // Read these before looking, so that anything that changes while
+        // we look makes the entry stale rather than wrong.
+        generation = atomic_load_explicit(&find_cache_generation, memory_order_relaxed);
+        area_serial = __system_property_area_serial();
+    }
+
     prop_area* pa = get_prop_area_for_name(name);
     if (!pa) {
         __libc_format_log(ANDROID_LOG_ERROR, "libc", "Access denied finding property \"%s\"", name);
         return nullptr;
     }
 
-    return pa->find(name);
+    const prop_info* pi = pa->find(name);
+    if (cacheable) {
+        find_cache_insert(name, hash, generation, area_serial, pi);
+    }
+    return pi;
 }
 
 // The C11 standard doesn't allow atomic loads from const fields,
@@ -1110,6 +2093,16 @@ int __system_property_read(const prop_info *pi, char *name, char *value)
 
     while (true) {
         uint32_t serial = __system_property_serial(pi); // acquire semantics
+        if (__predict_false(prop_info::is_long(serial))) {
+            // Long values never change, but only the start of one fits.
+            const size_t len = PROP_VALUE_MAX - 1;
+            memcpy(value, pi->long_value(), len);
+            value[len] = '\0';
+            if (name != 0) {
+                strcpy(name, pi->name);
+            }
+            return len;
+        }
         size_t len = SERIAL_VALUE_LEN(serial);
         memcpy(value, pi->value, len + 1);
         // TODO: Fix the synchronization scheme here.
@@ -1131,6 +2124,25 @@ int __system_property_read(const prop_info *pi, char *name, char *value)
     }
 }
 
+const char* __system_property_value_ptr(const prop_info* pi, size_t* len)
+{
+    if (__predict_false(compat_mode)) {
+        return nullptr;
+    }
+    // Only read-only properties are never updated under the caller.
+    if (strncmp(pi->name, "ro.", 3) != 0) {
+        return nullptr;
+    }
+
+    const uint32_t serial = __system_property_serial(pi);
+    if (prop_info::is_long(serial)) {
+        *len = pi->long_value_len();
+        return pi->long_value();
+    }
+    *len = SERIAL_VALUE_LEN(serial);
+    return pi->value;
+}
+
 int __system_property_get(const char *name, char *value)
 {
     const prop_info *pi = __system_property_find(name);
@@ -1143,18 +2155,111 @@ int __system_property_get(const char *name, char *value)
     }
 }
 
-int __system_property_set(const char *key, const char *value)
+int __system_property_get_batch(const char* const* names, char* const* values, size_t count)
 {
-    if (key == 0) return -1;
-    if (value == 0) value = "";
-    if (strlen(key) >= PROP_NAME_MAX) return -1;
-    if (strlen(value) >= PROP_VALUE_MAX) return -1;
+    if (__predict_false(compat_mode) || !__system_property_area__) {
+        int found = 0;
+        for (size_t i = 0; i < count; ++i) {
+            const prop_info* pi = __system_property_find(names[i]);
+            if (pi) {
+                __system_property_read(pi, nullptr, values[i]);
+                ++found;
+            } else {
+                values[i][0] = '\0';
+            }
+        }
+        return found;
+    }
+
+    // Sort the names a chunk at a time so we don't need to allocate. Sorted
+    // names tend to share their property area and their leading components.
+    size_t order[64];
+    prop_trie_cursor cursor;
+    int found = 0;
+    for (size_t start = 0; start < count; start += sizeof(order) / sizeof(order[0])) {
+        size_t n = count - start;
+        if (n > sizeof(order) / sizeof(order[0])) n = sizeof(order) / sizeof(order[0]);
+        for (size_t i = 0; i < n; ++i) {
+            size_t j = i;
+            for (; j > 0 && strcmp(names[order[j - 1]], names[start + i]) > 0; --j) {
+                order[j] = order[j - 1];
+            }
+            order[j] = start + i;
+        }
 
+        for (size_t i = 0; i < n; ++i) {
+            const char* name = names[order[i]];
+            char* value = values[order[i]];
+            const prop_info* pi = nullptr;
+            prop_area* pa = get_prop_area_for_name(name);
+            if (pa) {
+                pi = pa->find(name, &cursor);
+            } else {
+                __libc_format_log(ANDROID_LOG_ERROR, "libc",
+                                  "Access denied finding property \"%s\"", name);
+            }
+            if (pi) {
+                __system_property_read(pi, nullptr, value);
+                ++found;
+            } else {
+                value[0] = '\0';
+            }
+        }
+    }
+    return found;
+}
+
+void __system_property_watch_init(prop_watch* watch, const char* name)
+{
+    watch->name = name;
+    watch->pi = nullptr;
+    watch->serial_ptr = nullptr;
+    watch->serial = 0;
+    watch->value[0] = '\0';
+    __system_property_watch_update(watch);
+}
+
+bool __system_property_watch_update(prop_watch* watch)
+{
+    prop_area* pa = __system_property_area__;
+    if (!pa) {
+        // Nothing will ever change.
+        static const uint32_t no_serial = 0;
+        watch->serial_ptr = &no_serial;
+        watch->serial = 0;
+        return false;
+    }
+
+    // Until the property exists, or if the area's too old for us to know
+    // where its serial is, follow the global serial instead. Read it before
+    // looking, so that anything added after we look counts as a change.
+    if (watch->pi == nullptr || __predict_false(compat_mode)) {
+        uint32_t area_serial = atomic_load_explicit(pa->serial(), memory_order_acquire);
+        watch->pi = __system_property_find(watch->name);
+        if (watch->pi == nullptr || __predict_false(compat_mode)) {
+            watch->serial_ptr = reinterpret_cast<const uint32_t*>(pa->serial());
+            watch->serial = area_serial;
+            if (watch->pi == nullptr) {
+                watch->value[0] = '\0';
+            } else {
+                __system_property_read(watch->pi, nullptr, watch->value);
+            }
+            return true;
+        }
+        watch->serial_ptr = reinterpret_cast<const uint32_t*>(&watch->pi->serial);
+    }
+
+    // If the value changes again while we copy it, the serial we keep is
+    // already out of date, so we'll just copy it again next time.
+    watch->serial = __system_property_serial(watch->pi);
+    __system_property_read(watch->pi, nullptr, watch->value);
+    return true;
+}
+
+int __system_property_set(const char *key, const char *value)
+{
     prop_msg msg;
-    memset(&msg, 0, sizeof msg);
-    msg.cmd = PROP_MSG_SETPROP;
-    strlcpy(msg.name, key, sizeof msg.name);
-    strlcpy(msg.value, value, sizeof msg.value);
+    if (!make_prop_msg(&msg, PROP_MSG_SETPROP, key, value)) return -1;
 
     const int err = send_prop_msg(&msg);
     if (err < 0) {
@@ -1164,6 +2269,88 @@ int __system_property_set(const char *key, const char *value)
     return 0;
 }
 
+int __system_property_set_batch(const char* const* keys, const char* const* values, size_t count)
+{
+    // Check them all first, so that a bad one doesn't leave the rest half set.
+    prop_msg msg;
+    for (size_t i = 0; i < count; ++i) {
+        if (!make_prop_msg(&msg, PROP_MSG_SETPROP_STREAM, keys[i], values[i])) return -1;
+    }
+
+    bool ok = true;
+    prop_stream_lock.lock();
+    for (size_t i = 0; i < count; i += kPropStreamWindow) {
+        prop_msg msgs[kPropStreamWindow];
+        const size_t n = (count - i < kPropStreamWindow) ? count - i : kPropStreamWindow;
+        for (size_t j = 0; j < n; ++j) {
+            make_prop_msg(&msgs[j], PROP_MSG_SETPROP_STREAM, keys[i + j], values[i + j]);
+        }
+        if (!prop_stream_set(msgs, n)) {
+            ok = false;
+        }
+    }
+    prop_stream_lock.unlock();
+    return ok ? 0 : -1;
+}
+
+int __system_property_set_async(const char* key, const char* value)
+{
+    prop_msg msg;
+    if (!make_prop_msg(&msg, PROP_MSG_SETPROP_STREAM, key, value)) return -1;
+
+    bool ok;
+    prop_stream_lock.lock();
+    if (prop_stream_established()) {
+        // Pick up any answers that have already arrived, so they don't pile up.
+        prop_stream_drain(false);
+    }
+    if (prop_stream_established() && prop_stream_unanswered < kPropStreamWindow &&
+        prop_stream_write(&msg, 1)) {
+        ++prop_stream_unanswered;
+        ok = true;
+    } else {
+        // Until the service has answered on this connection we don't know
+        // that it understands the stream, so wait this once. Likewise when
+        // it's falling behind.
+        ok = prop_stream_set(&msg, 1);
+    }
+    prop_stream_lock.unlock();
+    return ok ? 0 : -1;
+}
+
+int __system_property_set_flush()
+{
+    prop_stream_lock.lock();
+    if (prop_stream_fd != -1 && prop_stream_pid == getpid()) {
+        prop_stream_drain(true);
+    }
+    const bool failed = prop_stream_async_failed;
+    prop_stream_async_failed = false;
+    prop_stream_lock.unlock();
+    return failed ? -1 : 0;
+}
+
+// Records in the serial area that a property every process would otherwise
+// have to look up at startup has been set, so that they can skip the lookups
+// until it is. The bit is never cleared.
+static void note_property_set(const char* name, unsigned int valuelen) {
+    if (valuelen != 0 &&
+        (strncmp(name, "libc.debug.malloc.", 18) == 0 || strncmp(name, "libc.malloc.", 12) == 0)) {
+        __system_property_area__->set_flags(PROP_AREA_FLAG_MALLOC_DEBUG);
+    }
+}
+
+bool __system_property_malloc_debug_possible() {
+    prop_area* pa = __system_property_area__;
+    if (pa == nullptr) {
+        return false;
+    }
+    if (__predict_false(compat_mode) || !(pa->flags() & PROP_AREA_FLAG_VALID)) {
+        return true;
+    }
+    return (pa->flags() & PROP_AREA_FLAG_MALLOC_DEBUG) != 0;
+}
+
 int __system_property_update(prop_info *pi, const char *value, unsigned int len)
 {
     if (len >= PROP_VALUE_MAX)
@@ -1176,6 +2363,10 @@ int __system_property_update(prop_info *pi, const char *value, unsigned int len)
     }
 
     uint32_t serial = atomic_load_explicit(&pi->serial, memory_order_relaxed);
+    if (prop_info::is_long(serial)) {
+        // Callers of __system_property_value_ptr() may still be using it.
+        return -1;
+    }
     serial |= 1;
     atomic_store_explicit(&pi->serial, serial, memory_order_relaxed);
     // The memcpy call here also races.  Again pretend it
@@ -1188,6 +2379,7 @@ int __system_property_update(prop_info *pi, const char *value, unsigned int len)
         (len << 24) | ((serial + 1) & 0xffffff),
         memory_order_release);
     __futex_wake(&pi->serial, INT32_MAX);
+    note_property_set(pi->name, len);
 
     atomic_store_explicit(
         pa->serial(),
@@ -1203,7 +2395,8 @@ int __system_property_add(const char *name, unsigned int namelen,
 {
     if (namelen >= PROP_NAME_MAX)
         return -1;
-    if (valuelen >= PROP_VALUE_MAX)
+    if (valuelen >= PROP_VALUE_MAX &&
+        (strncmp(name, "ro.", 3) != 0 || valuelen > PROP_LONG_VALUE_MAX))
         return -1;
     if (namelen < 1)
         return -1;
@@ -1222,6 +2415,7 @@ int __system_property_add(const char *name, unsigned int namelen,
     bool ret = pa->add(name, namelen, value, valuelen);
     if (!ret)
         return -1;
+    note_property_set(name, valuelen);
 
     // There is only a single mutator, but we want to make sure that
     // updates are visible to a reader waiting for the update.
@@ -1263,20 +2457,41 @@ unsigned int __system_property_wait_any(unsigned int serial)
     return my_serial;
 }
 
-const prop_info *__system_property_find_nth(unsigned n)
+bool __system_property_wait(const prop_info* pi, uint32_t old_serial, uint32_t* new_serial_ptr,
+                            const timespec* relative_timeout)
 {
-    find_nth_cookie cookie(n);
-
-    const int err = __system_property_foreach(find_nth_fn, &cookie);
-    if (err < 0) {
-        return NULL;
+    // Without a prop_info, this is __system_property_wait_any with a timeout.
+    const atomic_uint_least32_t* serial_ptr;
+    if (pi == nullptr) {
+        prop_area* pa = __system_property_area__;
+        if (!pa) {
+            return false;
+        }
+        serial_ptr = pa->serial();
+    } else {
+        serial_ptr = &pi->serial;
     }
 
-    return cookie.pi;
+    uint32_t new_serial;
+    do {
+        int rc = __futex_wait(const_cast<atomic_uint_least32_t*>(serial_ptr), old_serial,
+                              relative_timeout);
+        if (rc == -ETIMEDOUT) {
+            return false;
+        }
+        new_serial = load_const_atomic(serial_ptr, memory_order_acquire);
+    } while (new_serial == old_serial);
+
+    // If we caught the property mid-update, wait for the writer to finish.
+    if (pi != nullptr && SERIAL_DIRTY(new_serial)) {
+        new_serial = __system_property_serial(pi);
+    }
+    *new_serial_ptr = new_serial;
+    return true;
 }
 
-int __system_property_foreach(void (*propfn)(const prop_info *pi, void *cookie),
-        void *cookie)
+static int system_property_foreach(void (*propfn)(const prop_info *pi, void *cookie),
+        void *cookie, bool unmap_cold)
 {
     if (!__system_property_area__) {
         return -1;
@@ -1286,10 +2501,41 @@ int __system_property_foreach(void (*propfn)(const prop_info *pi, void *cookie),
         return __system_property_foreach_compat(propfn, cookie);
     }
 
+    if (!unmap_cold) {
+        list_foreach(contexts, [propfn, cookie](context_node* l) {
+            if (l->check_access_and_open()) {
+                l->pa()->foreach(propfn, cookie);
+            }
+        });
+        return 0;
+    }
+
+    // Areas no lookup has used are unmapped again afterwards, so the
+    // prop_info pointers are only good for the duration of the callback.
     list_foreach(contexts, [propfn, cookie](context_node* l) {
-        if (l->check_access_and_open()) {
+        if (l->hold_for_foreach()) {
             l->pa()->foreach(propfn, cookie);
+            l->release_after_foreach(true);
         }
     });
     return 0;
 }
+
+const prop_info *__system_property_find_nth(unsigned n)
+{
+    find_nth_cookie cookie(n);
+
+    // The caller keeps the prop_info, so its area must stay mapped.
+    const int err = system_property_foreach(find_nth_fn, &cookie, false);
+    if (err < 0) {
+        return NULL;
+    }
+
+    return cookie.pi;
+}
+
+int __system_property_foreach(void (*propfn)(const prop_info *pi, void *cookie),
+        void *cookie)
+{
+    return system_property_foreach(propfn, cookie, unmap_cold_contexts);
+}
@@ -0,0 +1,159 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <errno.h>
+#include <linux/perf_event.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/user.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "pthread_internal.h"
+
+// A per-thread perf event is enabled exactly while its thread is running, and the kernel
+// publishes how long that's been, as of when the thread was last scheduled in, in a page that
+// can be mapped. With the conversion from the CPU's cycle counter to nanoseconds that the
+// kernel also publishes there, a thread can work out its own CPU time without a system call.
+// It's a hardware event, because the kernel only refreshes the page as the thread is scheduled
+// in for those; its count is never read.
+
+#if defined(__aarch64__) || defined(__i386__) || defined(__x86_64__)
+
+static inline uint64_t read_cycle_counter() {
+#if defined(__aarch64__)
+  uint64_t result;
+  __asm__ __volatile__("isb; mrs %0, cntvct_el0" : "=r"(result) : : "memory");
+  return result;
+#else
+  uint32_t lo, hi;
+  __asm__ __volatile__("rdtsc" : "=a"(lo), "=d"(hi));
+  return (static_cast<uint64_t>(hi) << 32) | lo;
+#endif
+}
+
+// Returns how long the event has been enabled in nanoseconds, or -1 if the kernel isn't
+// publishing what we need to work that out.
+static int64_t perf_event_enabled_time(const perf_event_mmap_page* page) {
+  const volatile perf_event_mmap_page* p = page;
+  uint32_t seq;
+  uint64_t enabled;
+  uint64_t cycles;
+  uint64_t offset;
+  uint32_t mult;
+  uint16_t shift;
+  do {
+    seq = p->lock;
+    __asm__ __volatile__("" : : : "memory");
+    if (!p->cap_user_time) {
+      return -1;
+    }
+    enabled = p->time_enabled;
+    offset = p->time_offset;
+    mult = p->time_mult;
+    shift = p->time_shift;
+    cycles = read_cycle_counter();
+    __asm__ __volatile__("" : : : "memory");
+  } while (p->lock != seq);
+
+  uint64_t quot = cycles >> shift;
+  uint64_t rem = cycles & ((static_cast<uint64_t>(1) << shift) - 1);
+  return enabled + offset + quot * mult + ((rem * mult) >> shift);
+}
+
+static int64_t syscall_thread_cputime() {
+  timespec ts;
+  if (syscall(__NR_clock_gettime, CLOCK_THREAD_CPUTIME_ID, &ts) == -1) {
+    return -1;
+  }
+  return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+int android_thread_cputime_enable_fast_path() {
+  pthread_internal_t* thread = __get_thread();
+  if (thread->cputime.page != nullptr) {
+    return 0;
+  }
+
+  perf_event_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = PERF_TYPE_HARDWARE;
+  attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  int fd = syscall(__NR_perf_event_open, &attr, 0, -1, -1, PERF_FLAG_FD_CLOEXEC);
+  if (fd == -1) {
+    return -1;
+  }
+  void* page = mmap(nullptr, PAGE_SIZE, PROT_READ, MAP_SHARED, fd, 0);
+  if (page == MAP_FAILED) {
+    close(fd);
+    return -1;
+  }
+
+  // The event only counts from now, so remember what the thread had used before it.
+  perf_event_mmap_page* event_page = reinterpret_cast<perf_event_mmap_page*>(page);
+  int64_t enabled = perf_event_enabled_time(event_page);
+  int64_t cputime = syscall_thread_cputime();
+  if (enabled == -1 || cputime == -1) {
+    munmap(page, PAGE_SIZE);
+    close(fd);
+    errno = ENOTSUP;
+    return -1;
+  }
+  thread->cputime.base_ns = cputime - enabled;
+  thread->cputime.fd = fd;
+  thread->cputime.page = page;
+  return 0;
+}
+
+bool __read_thread_cputime(pthread_internal_t* thread, timespec* ts) {
+  int64_t enabled =
+      perf_event_enabled_time(reinterpret_cast<perf_event_mmap_page*>(thread->cputime.page));
+  if (enabled == -1) {
+    return false;
+  }
+  int64_t ns = thread->cputime.base_ns + enabled;
+  ts->tv_sec = ns / 1000000000;
+  ts->tv_nsec = ns % 1000000000;
+  return true;
+}
+
+void __exit_thread_cputime(pthread_internal_t* thread) {
+  if (thread->cputime.page != nullptr) {
+    munmap(thread->cputime.page, PAGE_SIZE);
+    close(thread->cputime.fd);
+    thread->cputime.page = nullptr;
+  }
+}
+
+#else
+
+int android_thread_cputime_enable_fast_path() {
+  errno = ENOTSUP;
+  return -1;
+}
+
+bool __read_thread_cputime(pthread_internal_t*, timespec*) {
+  return false;
+}
+
+void __exit_thread_cputime(pthread_internal_t*) {
+}
+
+#endif
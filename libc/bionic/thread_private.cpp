@@ -27,11 +27,12 @@
  */
 
 #include <pthread.h>
+#include "private/bionic_sections.h"
 #include "private/thread_private.h"
 
 // Some simple glue used to make BSD code thread-safe.
 
-static pthread_mutex_t g_atexit_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t g_atexit_lock __BIONIC_FORK_WRITTEN = PTHREAD_MUTEX_INITIALIZER;
 
 void _thread_atexit_lock() {
   pthread_mutex_lock(&g_atexit_lock);
@@ -41,7 +42,7 @@ void _thread_atexit_unlock() {
   pthread_mutex_unlock(&g_atexit_lock);
 }
 
-static pthread_mutex_t g_arc4_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t g_arc4_lock __BIONIC_FORK_WRITTEN = PTHREAD_MUTEX_INITIALIZER;
 
 void _thread_arc4_lock() {
   pthread_mutex_lock(&g_arc4_lock);
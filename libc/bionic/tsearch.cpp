@@ -0,0 +1,254 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <search.h>
+#include <stdint.h>
+#include <sys/mman.h>
+#include <sys/prctl.h>
+
+#include "private/bionic_lock.h"
+#include "private/bionic_prctl.h"
+
+// The tsearch family keeps an AVL tree, so lookups stay logarithmic whatever order the keys
+// arrive in (the classic unbalanced tree degenerates into a list for sorted input).
+
+struct node_t {
+  // Must be first: callers read the key through the node pointers we hand out.
+  const void* key;
+  node_t* link[2];
+  int height;
+};
+
+// An AVL tree of n nodes is less than 1.45 * log2(n + 2) high.
+static constexpr size_t kMaxHeight = sizeof(void*) * 8 * 3 / 2;
+
+// Nodes are small and allocated one at a time, so rather than paying for a malloc each, they
+// come from slabs shared by every tree in the process. Nodes allocated together end up next to
+// each other, which helps lookups in trees built in one go. Freed nodes are kept for reuse;
+// slabs are never unmapped.
+static constexpr size_t kNodeSlabSize = 64 * 1024;
+
+static Lock g_node_lock;
+static node_t* g_free_nodes;
+static char* g_slab_next;
+static char* g_slab_end;
+
+static node_t* alloc_node() {
+  g_node_lock.lock();
+  node_t* n = g_free_nodes;
+  if (n != nullptr) {
+    g_free_nodes = n->link[0];
+  } else {
+    if (g_slab_next == g_slab_end) {
+      void* slab = mmap(nullptr, kNodeSlabSize, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+      if (slab == MAP_FAILED) {
+        g_node_lock.unlock();
+        return nullptr;
+      }
+      prctl(PR_SET_VMA, PR_SET_VMA_ANON_NAME, slab, kNodeSlabSize, "tsearch nodes");
+      g_slab_next = reinterpret_cast<char*>(slab);
+      g_slab_end = g_slab_next + (kNodeSlabSize / sizeof(node_t)) * sizeof(node_t);
+    }
+    n = reinterpret_cast<node_t*>(g_slab_next);
+    g_slab_next += sizeof(node_t);
+  }
+  g_node_lock.unlock();
+  return n;
+}
+
+static void free_node(node_t* n) {
+  g_node_lock.lock();
+  n->link[0] = g_free_nodes;
+  g_free_nodes = n;
+  g_node_lock.unlock();
+}
+
+static int height(const node_t* n) {
+  return (n != nullptr) ? n->height : 0;
+}
+
+// Restores the balance of the subtree at *p, whose children are balanced but may differ in
+// height by two. Returns how much the subtree's height changed, so callers walking back up
+// the tree know when they can stop.
+static int rebalance(node_t** p) {
+  node_t* x = *p;
+  int old_height = x->height;
+  int h0 = height(x->link[0]);
+  int h1 = height(x->link[1]);
+  if (h0 - h1 <= 1 && h1 - h0 <= 1) {
+    x->height = ((h0 > h1) ? h0 : h1) + 1;
+    return x->height - old_height;
+  }
+
+  int dir = (h1 > h0);  // The deeper side.
+  node_t* y = x->link[dir];
+  node_t* z = y->link[!dir];
+  int hz = height(z);
+  if (hz > height(y->link[dir])) {
+    // Double rotation: z comes up to take x's place, with x and y as its children.
+    x->link[dir] = z->link[!dir];
+    y->link[!dir] = z->link[dir];
+    z->link[!dir] = x;
+    z->link[dir] = y;
+    x->height = hz;
+    y->height = hz;
+    z->height = hz + 1;
+    *p = z;
+  } else {
+    // Single rotation: y comes up, and x takes z as its child.
+    x->link[dir] = z;
+    y->link[!dir] = x;
+    x->height = hz + 1;
+    y->height = hz + 2;
+    *p = y;
+  }
+  return (*p)->height - old_height;
+}
+
+void* tfind(const void* key, void* const* rootp, int (*compar)(const void*, const void*)) {
+  if (rootp == nullptr) {
+    return nullptr;
+  }
+  node_t* n = *reinterpret_cast<node_t* const*>(rootp);
+  while (n != nullptr) {
+    int r = compar(key, n->key);
+    if (r == 0) {
+      return n;
+    }
+    n = n->link[r > 0];
+  }
+  return nullptr;
+}
+
+void* tsearch(const void* key, void** rootp, int (*compar)(const void*, const void*)) {
+  if (rootp == nullptr) {
+    return nullptr;
+  }
+
+  // Remember the links we followed, to rebalance on the way back up.
+  node_t** path[kMaxHeight + 1];
+  size_t depth = 0;
+  node_t** link = reinterpret_cast<node_t**>(rootp);
+  path[depth++] = link;
+  while (*link != nullptr) {
+    int r = compar(key, (*link)->key);
+    if (r == 0) {
+      return *link;
+    }
+    link = &(*link)->link[r > 0];
+    path[depth++] = link;
+  }
+
+  node_t* n = alloc_node();
+  if (n == nullptr) {
+    return nullptr;
+  }
+  n->key = key;
+  n->link[0] = n->link[1] = nullptr;
+  n->height = 1;
+  *link = n;
+
+  for (size_t i = depth - 1; i-- > 0 && rebalance(path[i]) != 0;) {
+  }
+  return n;
+}
+
+void* tdelete(const void* key, void** rootp, int (*compar)(const void*, const void*)) {
+  if (rootp == nullptr) {
+    return nullptr;
+  }
+
+  node_t** path[kMaxHeight + 1];
+  size_t depth = 0;
+  node_t** link = reinterpret_cast<node_t**>(rootp);
+  path[depth++] = link;
+  while (true) {
+    if (*link == nullptr) {
+      return nullptr;
+    }
+    int r = compar(key, (*link)->key);
+    if (r == 0) {
+      break;
+    }
+    link = &(*link)->link[r > 0];
+    path[depth++] = link;
+  }
+
+  // We return the deleted node's parent. POSIX leaves what to return for the root unspecified,
+  // other than that it isn't null.
+  void* parent = (depth > 1) ? static_cast<void*>(*path[depth - 2]) : static_cast<void*>(rootp);
+
+  // A node with a left subtree takes its predecessor's key, and the predecessor's node is the
+  // one that actually leaves the tree.
+  node_t* n = *link;
+  node_t* child;
+  if (n->link[0] != nullptr) {
+    node_t* deleted = n;
+    link = &n->link[0];
+    path[depth++] = link;
+    while ((*link)->link[1] != nullptr) {
+      link = &(*link)->link[1];
+      path[depth++] = link;
+    }
+    n = *link;
+    deleted->key = n->key;
+    child = n->link[0];
+  } else {
+    child = n->link[1];
+  }
+  *link = child;
+  free_node(n);
+
+  for (size_t i = depth - 1; i-- > 0 && rebalance(path[i]) != 0;) {
+  }
+  return parent;
+}
+
+static void trecurse(const node_t* n, void (*action)(const void*, VISIT, int), int level) {
+  if (n->link[0] == nullptr && n->link[1] == nullptr) {
+    action(n, leaf, level);
+    return;
+  }
+  action(n, preorder, level);
+  if (n->link[0] != nullptr) {
+    trecurse(n->link[0], action, level + 1);
+  }
+  action(n, postorder, level);
+  if (n->link[1] != nullptr) {
+    trecurse(n->link[1], action, level + 1);
+  }
+  action(n, endorder, level);
+}
+
+void twalk(const void* root, void (*action)(const void*, VISIT, int)) {
+  if (root != nullptr && action != nullptr) {
+    trecurse(reinterpret_cast<const node_t*>(root), action, 0);
+  }
+}
+
+// Destroy a tree and free all allocated resources.
+// This is a GNU extension, not available from BSD.
+void tdestroy(void* root, void (*destroy_func)(void*)) {
+  node_t* n = reinterpret_cast<node_t*>(root);
+  if (n == nullptr) {
+    return;
+  }
+  tdestroy(n->link[0], destroy_func);
+  tdestroy(n->link[1], destroy_func);
+  destroy_func(const_cast<void*>(n->key));
+  free_node(n);
+}
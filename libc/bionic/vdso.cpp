@@ -17,6 +17,8 @@
 #include "private/bionic_globals.h"
 #include "private/bionic_vdso.h"
 
+#include "pthread_internal.h"
+
 #if defined(__aarch64__) || defined(__arm__) || defined(__i386__) || defined(__x86_64__)
 
 #include <limits.h>
@@ -31,6 +33,12 @@
 #define AT_SYSINFO_EHDR 33 /* until we have new enough uapi headers... */
 
 int clock_gettime(int clock_id, timespec* tp) {
+  if (__predict_false(clock_id == CLOCK_THREAD_CPUTIME_ID)) {
+    pthread_internal_t* thread = __get_thread();
+    if (thread->cputime.page != nullptr && __read_thread_cputime(thread, tp)) {
+      return 0;
+    }
+  }
   auto vdso_clock_gettime = reinterpret_cast<decltype(&clock_gettime)>(
     __libc_globals->vdso[VDSO_CLOCK_GETTIME].fn);
   if (__predict_true(vdso_clock_gettime)) {
@@ -48,12 +56,43 @@ int gettimeofday(timeval* tv, struct timezone* tz) {
   return __gettimeofday(tv, tz);
 }
 
+int clock_getres(int clock_id, timespec* tp) {
+  auto vdso_clock_getres = reinterpret_cast<decltype(&clock_getres)>(
+    __libc_globals->vdso[VDSO_CLOCK_GETRES].fn);
+  if (__predict_true(vdso_clock_getres)) {
+    return vdso_clock_getres(clock_id, tp);
+  }
+  return __clock_getres(clock_id, tp);
+}
+
+time_t time(time_t* t) {
+  auto vdso_time = reinterpret_cast<decltype(&time)>(__libc_globals->vdso[VDSO_TIME].fn);
+  if (__predict_true(vdso_time)) {
+    return vdso_time(t);
+  }
+
+  // There's no time(2) on most architectures, so go via gettimeofday (which is
+  // itself usually in the vdso).
+  timeval tv;
+  if (gettimeofday(&tv, nullptr) == -1) {
+    return -1;
+  }
+  if (t != nullptr) {
+    *t = tv.tv_sec;
+  }
+  return tv.tv_sec;
+}
+
 void __libc_init_vdso(libc_globals* globals, KernelArgumentBlock& args) {
   auto&& vdso = globals->vdso;
   vdso[VDSO_CLOCK_GETTIME] = { VDSO_CLOCK_GETTIME_SYMBOL,
                                reinterpret_cast<void*>(__clock_gettime) };
   vdso[VDSO_GETTIMEOFDAY] = { VDSO_GETTIMEOFDAY_SYMBOL,
                               reinterpret_cast<void*>(__gettimeofday) };
+  vdso[VDSO_CLOCK_GETRES] = { VDSO_CLOCK_GETRES_SYMBOL,
+                              reinterpret_cast<void*>(__clock_getres) };
+  vdso[VDSO_TIME] = { VDSO_TIME_SYMBOL, nullptr };
+  vdso[VDSO_GETCPU] = { VDSO_GETCPU_SYMBOL, reinterpret_cast<void*>(__getcpu) };
 
   // Do we have a vdso?
   uintptr_t vdso_ehdr_addr = args.getauxval(AT_SYSINFO_EHDR);
@@ -106,7 +145,7 @@ void __libc_init_vdso(libc_globals* globals, KernelArgumentBlock& args) {
   // Are there any symbols we want?
   for (size_t i = 0; i < symbol_count; ++i) {
     for (size_t j = 0; j < VDSO_END; ++j) {
-      if (strcmp(vdso[j].name, strtab + symtab[i].st_name) == 0) {
+      if (vdso[j].name != nullptr && strcmp(vdso[j].name, strtab + symtab[i].st_name) == 0) {
         vdso[j].fn = reinterpret_cast<void*>(vdso_addr + symtab[i].st_value);
       }
     }
@@ -115,6 +154,21 @@ void __libc_init_vdso(libc_globals* globals, KernelArgumentBlock& args) {
 
 #else
 
+#include <sys/time.h>
+#include <time.h>
+
+// There's no time(2) on mips64, so go via gettimeofday.
+time_t time(time_t* t) {
+  timeval tv;
+  if (gettimeofday(&tv, nullptr) == -1) {
+    return -1;
+  }
+  if (t != nullptr) {
+    *t = tv.tv_sec;
+  }
+  return tv.tv_sec;
+}
+
 void __libc_init_vdso(libc_globals*, KernelArgumentBlock&) {
 }
 
@@ -28,6 +28,7 @@
 
 #include <errno.h>
 #include <sys/param.h>
+#include <sys/user.h>
 #include <string.h>
 #include <wchar.h>
 #include <uchar.h>
@@ -65,31 +66,134 @@ size_t mbrtowc(wchar_t* pwc, const char* s, size_t n, mbstate_t* ps) {
   return mbrtoc32(reinterpret_cast<char32_t*>(pwc), s, n, state);
 }
 
+// Bulk conversion helpers. mbsnrtowcs and wcsnrtombs handle runs of ASCII
+// sixteen characters at a time and decode or encode complete, well-formed
+// sequences inline. Anything else (errors, truncated sequences, a partial
+// sequence left in the mbstate_t) still goes through mbrtowc or wcrtomb,
+// so the results and error behavior are exactly as before.
+
+typedef uint8_t byte16 __attribute__((vector_size(16)));
+typedef uint32_t wide4 __attribute__((vector_size(16)));
+
+// Can we look at the next n bytes? They have to be within the limit the
+// caller gave us, and since the string may end sooner, they mustn't cross
+// a page boundary either.
+static inline bool can_read(const void* p, size_t available, size_t n) {
+  return available >= n && (reinterpret_cast<uintptr_t>(p) & (PAGE_SIZE - 1)) <= PAGE_SIZE - n;
+}
+
+// Are the 16 bytes at s all ASCII, and none of them NUL? Subtracting one
+// takes NUL to 0xff and 0x80-0xff to 0x7f-0xfe, so one compare finds both.
+static inline bool is_ascii16(const char* s, size_t available) {
+  if (!can_read(s, available, 16)) return false;
+  byte16 v;
+  memcpy(&v, s, sizeof(v));
+  auto bad = (v - 1) >= 0x7f;
+  uint64_t halves[2];
+  memcpy(halves, &bad, sizeof(halves));
+  return (halves[0] | halves[1]) == 0;
+}
+
+// The same for 16 wchar_ts.
+static inline bool is_ascii16(const wchar_t* s, size_t available) {
+  if (!can_read(s, available * sizeof(wchar_t), 16 * sizeof(wchar_t))) return false;
+  wide4 v[4];
+  memcpy(v, s, sizeof(v));
+  auto bad = ((v[0] - 1) >= 0x7f) | ((v[1] - 1) >= 0x7f) | ((v[2] - 1) >= 0x7f) |
+      ((v[3] - 1) >= 0x7f);
+  uint64_t halves[2];
+  memcpy(halves, &bad, sizeof(halves));
+  return (halves[0] | halves[1]) == 0;
+}
+
+// Decodes one complete, well-formed sequence of two to four bytes, returning
+// its length, or returns 0 for anything mbrtoc32 should look at instead. The
+// checks are in order, so nothing is read past a NUL.
+static inline size_t decode_utf8(const char* s, size_t n, char32_t* out) {
+  const uint8_t* p = reinterpret_cast<const uint8_t*>(s);
+  char32_t c32;
+  if ((p[0] & 0xe0) == 0xc0) {
+    if (n < 2 || (p[1] & 0xc0) != 0x80) return 0;
+    c32 = ((p[0] & 0x1f) << 6) | (p[1] & 0x3f);
+    if (c32 < 0x80) return 0;
+    *out = c32;
+    return 2;
+  } else if ((p[0] & 0xf0) == 0xe0) {
+    if (n < 3 || (p[1] & 0xc0) != 0x80 || (p[2] & 0xc0) != 0x80) return 0;
+    c32 = ((p[0] & 0x0f) << 12) | ((p[1] & 0x3f) << 6) | (p[2] & 0x3f);
+    if (c32 < 0x800 || (c32 >= 0xd800 && c32 <= 0xdfff) || c32 == 0xfffe || c32 == 0xffff) {
+      return 0;
+    }
+    *out = c32;
+    return 3;
+  } else if ((p[0] & 0xf8) == 0xf0) {
+    if (n < 4 || (p[1] & 0xc0) != 0x80 || (p[2] & 0xc0) != 0x80 || (p[3] & 0xc0) != 0x80) {
+      return 0;
+    }
+    c32 = ((p[0] & 0x07) << 18) | ((p[1] & 0x3f) << 12) | ((p[2] & 0x3f) << 6) | (p[3] & 0x3f);
+    if (c32 < 0x10000) return 0;
+    *out = c32;
+    return 4;
+  }
+  return 0;
+}
+
+// Encodes a non-ASCII character as c32rtomb would, returning 0 for the
+// ones it rejects.
+static inline size_t encode_utf8(char32_t c32, char* s) {
+  if (c32 < 0x800) {
+    s[0] = 0xc0 | (c32 >> 6);
+    s[1] = 0x80 | (c32 & 0x3f);
+    return 2;
+  } else if (c32 < 0x10000) {
+    s[0] = 0xe0 | (c32 >> 12);
+    s[1] = 0x80 | ((c32 >> 6) & 0x3f);
+    s[2] = 0x80 | (c32 & 0x3f);
+    return 3;
+  } else if (c32 < 0x200000) {
+    s[0] = 0xf0 | (c32 >> 18);
+    s[1] = 0x80 | ((c32 >> 12) & 0x3f);
+    s[2] = 0x80 | ((c32 >> 6) & 0x3f);
+    s[3] = 0x80 | (c32 & 0x3f);
+    return 4;
+  }
+  return 0;
+}
+
 size_t mbsnrtowcs(wchar_t* dst, const char** src, size_t nmc, size_t len, mbstate_t* ps) {
   static mbstate_t __private_state;
   mbstate_t* state = (ps == NULL) ? &__private_state : ps;
   size_t i, o, r;
+  char32_t c32;
+
+  /*
+   * The fast paths in the loops below are not safe if an ASCII
+   * character appears as anything but the first byte of a
+   * multibyte sequence. Check now to avoid doing it in the loop.
+   */
+  if ((nmc > 0) && (mbstate_bytes_so_far(state) > 0)
+      && (static_cast<uint8_t>((*src)[0]) < 0x80)) {
+    return reset_and_return_illegal(EILSEQ, state);
+  }
 
   if (dst == NULL) {
-    /*
-     * The fast path in the loop below is not safe if an ASCII
-     * character appears as anything but the first byte of a
-     * multibyte sequence. Check now to avoid doing it in the loop.
-     */
-    if ((nmc > 0) && (mbstate_bytes_so_far(state) > 0)
-        && (static_cast<uint8_t>((*src)[0]) < 0x80)) {
-      return reset_and_return_illegal(EILSEQ, state);
-    }
-    for (i = o = 0; i < nmc; i += r, o++) {
-      if (static_cast<uint8_t>((*src)[i]) < 0x80) {
+    i = o = 0;
+    while (i < nmc) {
+      const char* s = *src + i;
+      if (static_cast<uint8_t>(*s) < 0x80) {
         // Fast path for plain ASCII characters.
-        if ((*src)[i] == '\0') {
+        if (is_ascii16(s, nmc - i)) {
+          i += 16;
+          o += 16;
+          continue;
+        }
+        if (*s == '\0') {
           *src = nullptr;
           return reset_and_return(o, state);
         }
         r = 1;
-      } else {
-        r = mbrtowc(NULL, *src + i, nmc - i, state);
+      } else if (!mbsinit(state) || (r = decode_utf8(s, nmc - i, &c32)) == 0) {
+        r = mbrtowc(NULL, s, nmc - i, state);
         if (r == __MB_ERR_ILLEGAL_SEQUENCE) {
           return reset_and_return_illegal(EILSEQ, state);
         }
@@ -101,30 +205,35 @@ size_t mbsnrtowcs(wchar_t* dst, const char** src, size_t nmc, size_t len, mbstat
           return reset_and_return(o, state);
         }
       }
+      i += r;
+      o++;
     }
     return reset_and_return(o, state);
   }
 
-  /*
-   * The fast path in the loop below is not safe if an ASCII
-   * character appears as anything but the first byte of a
-   * multibyte sequence. Check now to avoid doing it in the loop.
-   */
-  if ((nmc > 0) && (mbstate_bytes_so_far(state) > 0)
-      && (static_cast<uint8_t>((*src)[0]) < 0x80)) {
-    return reset_and_return_illegal(EILSEQ, state);
-  }
-  for (i = o = 0; i < nmc && o < len; i += r, o++) {
-    if (static_cast<uint8_t>((*src)[i]) < 0x80) {
+  i = o = 0;
+  while (i < nmc && o < len) {
+    const char* s = *src + i;
+    if (static_cast<uint8_t>(*s) < 0x80) {
       // Fast path for plain ASCII characters.
-      dst[o] = (*src)[i];
+      if (len - o >= 16 && is_ascii16(s, nmc - i)) {
+        for (size_t j = 0; j < 16; j++) {
+          dst[o + j] = static_cast<uint8_t>(s[j]);
+        }
+        i += 16;
+        o += 16;
+        continue;
+      }
+      dst[o] = *s;
       r = 1;
-      if ((*src)[i] == '\0') {
+      if (*s == '\0') {
         *src = nullptr;
         return reset_and_return(o, state);
       }
+    } else if (mbsinit(state) && (r = decode_utf8(s, nmc - i, &c32)) != 0) {
+      dst[o] = c32;
     } else {
-      r = mbrtowc(dst + o, *src + i, nmc - i, state);
+      r = mbrtowc(dst + o, s, nmc - i, state);
       if (r == __MB_ERR_ILLEGAL_SEQUENCE) {
         *src += i;
         return reset_and_return_illegal(EILSEQ, state);
@@ -138,6 +247,8 @@ size_t mbsnrtowcs(wchar_t* dst, const char** src, size_t nmc, size_t len, mbstat
         return reset_and_return(o, state);
       }
     }
+    i += r;
+    o++;
   }
   *src += i;
   return reset_and_return(o, state);
@@ -166,28 +277,46 @@ size_t wcsnrtombs(char* dst, const wchar_t** src, size_t nwc, size_t len, mbstat
   char buf[MB_LEN_MAX];
   size_t i, o, r;
   if (dst == NULL) {
-    for (i = o = 0; i < nwc; i++, o += r) {
-      wchar_t wc = (*src)[i];
-      if (static_cast<uint32_t>(wc) < 0x80) {
+    i = o = 0;
+    while (i < nwc) {
+      const wchar_t* s = *src + i;
+      if (static_cast<uint32_t>(*s) < 0x80) {
         // Fast path for plain ASCII characters.
-        if (wc == 0) {
+        if (is_ascii16(s, nwc - i)) {
+          i += 16;
+          o += 16;
+          continue;
+        }
+        if (*s == 0) {
           return o;
         }
         r = 1;
-      } else {
-        r = wcrtomb(buf, wc, state);
+      } else if ((r = encode_utf8(*s, buf)) == 0) {
+        r = wcrtomb(buf, *s, state);
         if (r == __MB_ERR_ILLEGAL_SEQUENCE) {
           return r;
         }
       }
+      i++;
+      o += r;
     }
     return o;
   }
 
-  for (i = o = 0; i < nwc && o < len; i++, o += r) {
-    wchar_t wc = (*src)[i];
+  i = o = 0;
+  while (i < nwc && o < len) {
+    const wchar_t* s = *src + i;
+    wchar_t wc = *s;
     if (static_cast<uint32_t>(wc) < 0x80) {
       // Fast path for plain ASCII characters.
+      if (len - o >= 16 && is_ascii16(s, nwc - i)) {
+        for (size_t j = 0; j < 16; j++) {
+          dst[o + j] = s[j];
+        }
+        i += 16;
+        o += 16;
+        continue;
+      }
       dst[o] = wc;
       if (wc == 0) {
         *src = NULL;
@@ -196,23 +325,29 @@ size_t wcsnrtombs(char* dst, const wchar_t** src, size_t nwc, size_t len, mbstat
       r = 1;
     } else if (len - o >= sizeof(buf)) {
       // Enough space to translate in-place.
-      r = wcrtomb(dst + o, wc, state);
-      if (r == __MB_ERR_ILLEGAL_SEQUENCE) {
-        *src += i;
-        return r;
+      if ((r = encode_utf8(wc, dst + o)) == 0) {
+        r = wcrtomb(dst + o, wc, state);
+        if (r == __MB_ERR_ILLEGAL_SEQUENCE) {
+          *src += i;
+          return r;
+        }
       }
     } else {
       // May not be enough space; use temp buffer.
-      r = wcrtomb(buf, wc, state);
-      if (r == __MB_ERR_ILLEGAL_SEQUENCE) {
-        *src += i;
-        return r;
+      if ((r = encode_utf8(wc, buf)) == 0) {
+        r = wcrtomb(buf, wc, state);
+        if (r == __MB_ERR_ILLEGAL_SEQUENCE) {
+          *src += i;
+          return r;
+        }
       }
       if (r > len - o) {
         break;
       }
       memcpy(dst + o, buf, r);
     }
+    i++;
+    o += r;
   }
   *src += i;
   return o;
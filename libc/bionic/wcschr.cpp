@@ -0,0 +1,61 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <wchar.h>
+
+#include "private/bionic_wide_vector.h"
+
+wchar_t* wcschr(const wchar_t* s, wchar_t c) {
+  if (!wchar_aligned(s)) {
+    while (*s != c && *s != L'\0') ++s;
+    return (*s == c) ? const_cast<wchar_t*>(s) : nullptr;
+  }
+
+  const wide4 c4 = wide4_splat(c);
+  const wchar_t* p = wide4_align(s);
+  wide4 v = wide4_load(p);
+  wide4 hits = wide4_from((v == c4) | (v == 0), s);
+  while (!wide4_any(hits)) {
+    p += kWide4Lanes;
+    if (wide4_unroll_aligned(p)) {
+      // Four blocks at a time, as in wcslen.
+      while (true) {
+        wide4 v0 = wide4_load(p), v1 = wide4_load(p + 4);
+        wide4 v2 = wide4_load(p + 8), v3 = wide4_load(p + 12);
+        wide4 m = (v0 == c4) | (v0 == 0) | (v1 == c4) | (v1 == 0) |
+                  (v2 == c4) | (v2 == 0) | (v3 == c4) | (v3 == 0);
+        if (wide4_any(m)) break;
+        p += kWide4Unroll * kWide4Lanes;
+      }
+    }
+    v = wide4_load(p);
+    hits = (v == c4) | (v == 0);
+  }
+  size_t i = wide4_first(hits);
+  return (p[i] == c) ? const_cast<wchar_t*>(p + i) : nullptr;
+}
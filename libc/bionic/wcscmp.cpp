@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <wchar.h>
+
+#include "private/bionic_wide_vector.h"
+
+// Like the BSD implementation, this returns the difference between the
+// first characters that differ, compared as unsigned.
+static inline int wcscmp_result(wchar_t c1, wchar_t c2) {
+  return static_cast<unsigned>(c1) - static_cast<unsigned>(c2);
+}
+
+int wcscmp(const wchar_t* s1, const wchar_t* s2) {
+  const size_t kUnrollBytes = kWide4Unroll * sizeof(wide4);
+  while (true) {
+    if (wide4_within_page(s1, kUnrollBytes) && wide4_within_page(s2, kUnrollBytes)) {
+      // Skip four equal blocks at a time. When there's a difference or a
+      // terminator in them, the single-block case below finds it.
+      wide4 a0 = wide4_load(s1), a1 = wide4_load(s1 + 4);
+      wide4 a2 = wide4_load(s1 + 8), a3 = wide4_load(s1 + 12);
+      wide4 m = (a0 != wide4_load(s2)) | (a1 != wide4_load(s2 + 4)) |
+                (a2 != wide4_load(s2 + 8)) | (a3 != wide4_load(s2 + 12)) |
+                (a0 == 0) | (a1 == 0) | (a2 == 0) | (a3 == 0);
+      if (!wide4_any(m)) {
+        s1 += kWide4Unroll * kWide4Lanes;
+        s2 += kWide4Unroll * kWide4Lanes;
+        continue;
+      }
+    }
+    if (wide4_within_page(s1) && wide4_within_page(s2)) {
+      wide4 v1 = wide4_load(s1);
+      size_t i = wide4_first((v1 != wide4_load(s2)) | (v1 == 0));
+      if (i < kWide4Lanes) return wcscmp_result(s1[i], s2[i]);
+      s1 += kWide4Lanes;
+      s2 += kWide4Lanes;
+    } else {
+      // One of the strings is about to cross a page; take it a character
+      // at a time.
+      if (*s1 != *s2 || *s1 == L'\0') return wcscmp_result(*s1, *s2);
+      ++s1;
+      ++s2;
+    }
+  }
+}
@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <wchar.h>
+
+#include "private/bionic_wide_vector.h"
+
+size_t wcslen(const wchar_t* s) {
+  if (!wchar_aligned(s)) {
+    const wchar_t* p = s;
+    while (*p != L'\0') ++p;
+    return p - s;
+  }
+
+  // A block at a time up to a four-block boundary, then four at a time
+  // until one of them has the terminator in it, then back to single blocks
+  // to find which.
+  const wchar_t* p = wide4_align(s);
+  wide4 hits = wide4_from(wide4_load(p) == 0, s);
+  while (!wide4_any(hits)) {
+    p += kWide4Lanes;
+    if (wide4_unroll_aligned(p)) {
+      while (!wide4_any((wide4_load(p) == 0) | (wide4_load(p + 4) == 0) |
+                        (wide4_load(p + 8) == 0) | (wide4_load(p + 12) == 0))) {
+        p += kWide4Unroll * kWide4Lanes;
+      }
+    }
+    hits = wide4_load(p) == 0;
+  }
+  return p + wide4_first(hits) - s;
+}
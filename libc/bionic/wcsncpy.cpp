@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <wchar.h>
+
+#include "private/bionic_wide_vector.h"
+
+wchar_t* wcsncpy(wchar_t* __restrict dst, const wchar_t* __restrict src, size_t n) {
+  wchar_t* d = dst;
+  const wchar_t* s = src;
+  while (n != 0) {
+    // Copy whole blocks until the one with the terminator in it, four at a
+    // time where there's room...
+    if (n >= kWide4Unroll * kWide4Lanes && wide4_within_page(s, kWide4Unroll * sizeof(wide4))) {
+      wide4 v0 = wide4_load(s), v1 = wide4_load(s + 4);
+      wide4 v2 = wide4_load(s + 8), v3 = wide4_load(s + 12);
+      if (!wide4_any((v0 == 0) | (v1 == 0) | (v2 == 0) | (v3 == 0))) {
+        wide4_store(d, v0);
+        wide4_store(d + 4, v1);
+        wide4_store(d + 8, v2);
+        wide4_store(d + 12, v3);
+        d += kWide4Unroll * kWide4Lanes;
+        s += kWide4Unroll * kWide4Lanes;
+        n -= kWide4Unroll * kWide4Lanes;
+        continue;
+      }
+    }
+    if (n >= kWide4Lanes && wide4_within_page(s)) {
+      wide4 v = wide4_load(s);
+      if (!wide4_any(v == 0)) {
+        wide4_store(d, v);
+        d += kWide4Lanes;
+        s += kWide4Lanes;
+        n -= kWide4Lanes;
+        continue;
+      }
+    }
+    // ...and then a character at a time up to and including it.
+    --n;
+    if ((*d++ = *s++) == L'\0') break;
+  }
+  // Pad whatever's left with NULs.
+  wmemset(d, L'\0', n);
+  return dst;
+}
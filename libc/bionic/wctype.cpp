@@ -30,24 +30,76 @@
 
 #include <ctype.h>
 #include <errno.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 #include <wchar.h>
 
-// TODO: these only work for the ASCII range; rewrite to dlsym icu4c? http://b/14499654
-
-int iswalnum(wint_t wc) { return isalnum(wc); }
-int iswalpha(wint_t wc) { return isalpha(wc); }
-int iswblank(wint_t wc) { return isblank(wc); }
-int iswcntrl(wint_t wc) { return iscntrl(wc); }
-int iswdigit(wint_t wc) { return isdigit(wc); }
-int iswgraph(wint_t wc) { return isgraph(wc); }
-int iswlower(wint_t wc) { return islower(wc); }
-int iswprint(wint_t wc) { return isprint(wc); }
-int iswpunct(wint_t wc) { return ispunct(wc); }
-int iswspace(wint_t wc) { return isspace(wc); }
-int iswupper(wint_t wc) { return isupper(wc); }
-int iswxdigit(wint_t wc) { return isxdigit(wc); }
+// Classification and case mapping use tables generated from the Unicode
+// database by libc/tools/genwctype.py. The class bits below must match the
+// ones in that script.
+#define WC_BIT_UPPER  0x001
+#define WC_BIT_LOWER  0x002
+#define WC_BIT_ALPHA  0x004
+#define WC_BIT_DIGIT  0x008
+#define WC_BIT_XDIGIT 0x010
+#define WC_BIT_SPACE  0x020
+#define WC_BIT_BLANK  0x040
+#define WC_BIT_CNTRL  0x080
+#define WC_BIT_PUNCT  0x100
+#define WC_BIT_GRAPH  0x200
+#define WC_BIT_PRINT  0x400
+
+struct wc_record {
+  uint16_t classes;
+  int32_t upper_delta;
+  int32_t lower_delta;
+};
+
+#include "wctype_tables.h"
+
+static const wc_record kWcInvalid = { 0, 0, 0 };
+
+static inline const wc_record& wc_lookup(wint_t wc) {
+  if (wc < 0x10000) {
+    // Two loads: which 64-character block, then the character's record.
+    size_t block = kWcBmpIndex[wc >> WC_BLOCK_SHIFT];
+    size_t offset = wc & ((1 << WC_BLOCK_SHIFT) - 1);
+    return kWcRecords[kWcBmpBlocks[(block << WC_BLOCK_SHIFT) | offset]];
+  }
+  if (wc > 0x10ffff) return kWcInvalid;
+
+  // Find the last run starting at or before wc. The first run starts at
+  // U+10000, so there always is one.
+  uint32_t key = (wc << 8) | 0xff;
+  size_t lo = 0, hi = sizeof(kWcSupplementaryRuns) / sizeof(kWcSupplementaryRuns[0]);
+  while (lo < hi) {
+    size_t mid = (lo + hi) / 2;
+    if (kWcSupplementaryRuns[mid] <= key) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return kWcRecords[kWcSupplementaryRuns[lo - 1] & 0xff];
+}
+
+static inline int wc_is(wint_t wc, uint16_t bits) {
+  return (wc_lookup(wc).classes & bits) != 0;
+}
+
+int iswalnum(wint_t wc) { return wc_is(wc, WC_BIT_ALPHA | WC_BIT_DIGIT); }
+int iswalpha(wint_t wc) { return wc_is(wc, WC_BIT_ALPHA); }
+int iswblank(wint_t wc) { return wc_is(wc, WC_BIT_BLANK); }
+int iswcntrl(wint_t wc) { return wc_is(wc, WC_BIT_CNTRL); }
+int iswdigit(wint_t wc) { return wc_is(wc, WC_BIT_DIGIT); }
+int iswgraph(wint_t wc) { return wc_is(wc, WC_BIT_GRAPH); }
+int iswlower(wint_t wc) { return wc_is(wc, WC_BIT_LOWER); }
+int iswprint(wint_t wc) { return wc_is(wc, WC_BIT_PRINT); }
+int iswpunct(wint_t wc) { return wc_is(wc, WC_BIT_PUNCT); }
+int iswspace(wint_t wc) { return wc_is(wc, WC_BIT_SPACE); }
+int iswupper(wint_t wc) { return wc_is(wc, WC_BIT_UPPER); }
+int iswxdigit(wint_t wc) { return wc_is(wc, WC_BIT_XDIGIT); }
 
 int iswalnum_l(wint_t c, locale_t) { return iswalnum(c); }
 int iswalpha_l(wint_t c, locale_t) { return iswalpha(c); }
@@ -84,8 +136,8 @@ int iswctype_l(wint_t wc, wctype_t char_class, locale_t) {
   return iswctype(wc, char_class);
 }
 
-wint_t towlower(wint_t wc) { return tolower(wc); }
-wint_t towupper(wint_t wc) { return toupper(wc); }
+wint_t towlower(wint_t wc) { return wc + wc_lookup(wc).lower_delta; }
+wint_t towupper(wint_t wc) { return wc + wc_lookup(wc).upper_delta; }
 
 wint_t towupper_l(int c, locale_t) { return towupper(c); }
 wint_t towlower_l(int c, locale_t) { return towlower(c); }
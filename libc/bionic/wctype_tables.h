@@ -0,0 +1,1186 @@
+/* generated by genwctype.py from Unicode 14.0.0 - do not edit */
+
+#define WC_BLOCK_SHIFT 6
+
+static const wc_record kWcRecords[] = {
+  { 0x080, 0, 0 },
+  { 0x0e0, 0, 0 },
+  { 0x0a0, 0, 0 },
+  { 0x460, 0, 0 },
+  { 0x700, 0, 0 },
+  { 0x618, 0, 0 },
+  { 0x615, 0, 32 },
+  { 0x605, 0, 32 },
+  { 0x616, -32, 0 },
+  { 0x606, -32, 0 },
+  { 0x400, 0, 0 },
+  { 0x604, 0, 0 },
+  { 0x606, 743, 0 },
+  { 0x606, 0, 0 },
+  { 0x606, 121, 0 },
+  { 0x605, 0, 1 },
+  { 0x606, -1, 0 },
+  { 0x605, 0, 0 },
+  { 0x606, -232, 0 },
+  { 0x605, 0, -121 },
+  { 0x606, -300, 0 },
+  { 0x606, 195, 0 },
+  { 0x605, 0, 210 },
+  { 0x605, 0, 206 },
+  { 0x605, 0, 205 },
+  { 0x605, 0, 79 },
+  { 0x605, 0, 202 },
+  { 0x605, 0, 203 },
+  { 0x605, 0, 207 },
+  { 0x606, 97, 0 },
+  { 0x605, 0, 211 },
+  { 0x605, 0, 209 },
+  { 0x606, 163, 0 },
+  { 0x605, 0, 213 },
+  { 0x606, 130, 0 },
+  { 0x605, 0, 214 },
+  { 0x605, 0, 218 },
+  { 0x605, 0, 217 },
+  { 0x605, 0, 219 },
+  { 0x606, 56, 0 },
+  { 0x605, 0, 2 },
+  { 0x607, -1, 1 },
+  { 0x606, -2, 0 },
+  { 0x606, -79, 0 },
+  { 0x605, 0, -97 },
+  { 0x605, 0, -56 },
+  { 0x605, 0, -130 },
+  { 0x605, 0, 10795 },
+  { 0x605, 0, -163 },
+  { 0x605, 0, 10792 },
+  { 0x606, 10815, 0 },
+  { 0x605, 0, -195 },
+  { 0x605, 0, 69 },
+  { 0x605, 0, 71 },
+  { 0x606, 10783, 0 },
+  { 0x606, 10780, 0 },
+  { 0x606, 10782, 0 },
+  { 0x606, -210, 0 },
+  { 0x606, -206, 0 },
+  { 0x606, -205, 0 },
+  { 0x606, -202, 0 },
+  { 0x606, -203, 0 },
+  { 0x606, 42319, 0 },
+  { 0x606, 42315, 0 },
+  { 0x606, -207, 0 },
+  { 0x606, 42280, 0 },
+  { 0x606, 42308, 0 },
+  { 0x606, -209, 0 },
+  { 0x606, -211, 0 },
+  { 0x606, 10743, 0 },
+  { 0x606, 42305, 0 },
+  { 0x606, 10749, 0 },
+  { 0x606, -213, 0 },
+  { 0x606, -214, 0 },
+  { 0x606, 10727, 0 },
+  { 0x606, -218, 0 },
+  { 0x606, 42307, 0 },
+  { 0x606, 42282, 0 },
+  { 0x606, -69, 0 },
+  { 0x606, -217, 0 },
+  { 0x606, -71, 0 },
+  { 0x606, -219, 0 },
+  { 0x606, 42261, 0 },
+  { 0x606, 42258, 0 },
+  { 0x702, 84, 0 },
+  { 0x000, 0, 0 },
+  { 0x605, 0, 116 },
+  { 0x605, 0, 38 },
+  { 0x605, 0, 37 },
+  { 0x605, 0, 64 },
+  { 0x605, 0, 63 },
+  { 0x606, -38, 0 },
+  { 0x606, -37, 0 },
+  { 0x606, -31, 0 },
+  { 0x606, -64, 0 },
+  { 0x606, -63, 0 },
+  { 0x605, 0, 8 },
+  { 0x606, -62, 0 },
+  { 0x606, -57, 0 },
+  { 0x606, -47, 0 },
+  { 0x606, -54, 0 },
+  { 0x606, -8, 0 },
+  { 0x606, -86, 0 },
+  { 0x606, -80, 0 },
+  { 0x606, 7, 0 },
+  { 0x606, -116, 0 },
+  { 0x605, 0, -60 },
+  { 0x606, -96, 0 },
+  { 0x605, 0, -7 },
+  { 0x605, 0, 80 },
+  { 0x605, 0, 15 },
+  { 0x606, -15, 0 },
+  { 0x605, 0, 48 },
+  { 0x606, -48, 0 },
+  { 0x605, 0, 7264 },
+  { 0x606, 3008, 0 },
+  { 0x605, 0, 38864 },
+  { 0x606, -6254, 0 },
+  { 0x606, -6253, 0 },
+  { 0x606, -6244, 0 },
+  { 0x606, -6242, 0 },
+  { 0x606, -6243, 0 },
+  { 0x606, -6236, 0 },
+  { 0x606, -6181, 0 },
+  { 0x606, 35266, 0 },
+  { 0x605, 0, -3008 },
+  { 0x606, 35332, 0 },
+  { 0x606, 3814, 0 },
+  { 0x606, 35384, 0 },
+  { 0x606, -59, 0 },
+  { 0x605, 0, -7615 },
+  { 0x606, 8, 0 },
+  { 0x605, 0, -8 },
+  { 0x606, 74, 0 },
+  { 0x606, 86, 0 },
+  { 0x606, 100, 0 },
+  { 0x606, 128, 0 },
+  { 0x606, 112, 0 },
+  { 0x606, 126, 0 },
+  { 0x605, 0, -74 },
+  { 0x605, 0, -9 },
+  { 0x606, -7205, 0 },
+  { 0x605, 0, -86 },
+  { 0x605, 0, -100 },
+  { 0x605, 0, -112 },
+  { 0x605, 0, -128 },
+  { 0x605, 0, -126 },
+  { 0x605, 0, -7517 },
+  { 0x605, 0, -8383 },
+  { 0x605, 0, -8262 },
+  { 0x605, 0, 28 },
+  { 0x606, -28, 0 },
+  { 0x605, 0, 16 },
+  { 0x606, -16, 0 },
+  { 0x701, 0, 26 },
+  { 0x702, -26, 0 },
+  { 0x605, 0, -10743 },
+  { 0x605, 0, -3814 },
+  { 0x605, 0, -10727 },
+  { 0x606, -10795, 0 },
+  { 0x606, -10792, 0 },
+  { 0x605, 0, -10780 },
+  { 0x605, 0, -10749 },
+  { 0x605, 0, -10783 },
+  { 0x605, 0, -10782 },
+  { 0x605, 0, -10815 },
+  { 0x606, -7264, 0 },
+  { 0x605, 0, -35332 },
+  { 0x605, 0, -42280 },
+  { 0x606, 48, 0 },
+  { 0x605, 0, -42308 },
+  { 0x605, 0, -42319 },
+  { 0x605, 0, -42315 },
+  { 0x605, 0, -42305 },
+  { 0x605, 0, -42258 },
+  { 0x605, 0, -42282 },
+  { 0x605, 0, -42261 },
+  { 0x605, 0, 928 },
+  { 0x605, 0, -48 },
+  { 0x605, 0, -42307 },
+  { 0x605, 0, -35384 },
+  { 0x606, -928, 0 },
+  { 0x606, -38864, 0 },
+  { 0x605, 0, 40 },
+  { 0x606, -40, 0 },
+  { 0x605, 0, 39 },
+  { 0x606, -39, 0 },
+  { 0x605, 0, 34 },
+  { 0x606, -34, 0 },
+};
+
+static const uint8_t kWcBmpIndex[1024] = {
+    0,   1,   2,   3,   4,   5,   6,   7,   8,   9,  10,  11,  12,  13,  14,  15,
+   16,  17,  18,  19,  20,  21,  22,  23,  24,  25,  26,  27,  28,  29,  30,  31,
+   32,  33,  34,  35,  36,  37,  38,  39,  40,  41,  42,  43,  44,  45,  46,  47,
+   48,  49,  50,  51,  52,  53,  54,  55,  56,  57,  58,  59,  60,  61,  62,  63,
+   64,  65,  66,  67,  26,  26,  26,  26,  26,  68,  69,  70,  71,  72,  73,  74,
+   75,  26,  26,  26,  26,  26,  26,  26,  26,  76,  77,  78,  79,  80,  81,  82,
+   83,  84,  85,  86,  87,  88,  89,  90,  91,  92,  93,  94,  95,  96,  97,  98,
+   99, 100, 101, 102, 103, 104, 105,  12, 106, 106, 107, 106, 108, 109, 110, 111,
+  112, 113, 114, 115, 116, 117, 118,  12,  12,  12,  12,  12,  12,  12,  12,  12,
+  119, 120, 121, 122,  12,  12,  12,  12,  12,  12,  12,  12,  12,  12,  12,  12,
+   12,  12,  12,  12,  12,  12,  12,  12,  12,  12,  12,  12,  12, 123, 124,  12,
+  125, 126, 106, 127, 128, 129, 130, 131, 132, 133, 134, 135,  12,  12,  12, 136,
+  137, 138, 139, 140, 141,  26, 142, 143, 144,  12,  12,  12,  12,  12,  12,  12,
+   26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,
+   26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,
+   26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,
+   26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,
+   26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,
+   26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,
+   26,  26,  26,  26,  26,  26,  26,  12,  26,  26,  26,  26,  26,  26,  26,  26,
+   26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,
+   26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,
+   26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,
+   26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,
+   26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,
+   26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,
+   26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,
+   26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,
+   26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,
+   26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,
+   26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,
+   26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,
+   26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,
+   26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,
+   26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,
+   26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,
+   26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,
+   26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,
+   26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,
+   26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,
+   26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,
+   26,  26, 145, 146,  26,  26,  26,  26, 147, 148, 149, 150, 151, 152, 153, 154,
+  155, 156, 157, 158, 159, 160, 161, 162, 163, 164, 165, 166, 167, 168, 169, 170,
+   26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,
+   26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,
+   26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,
+   26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,
+   26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,
+   26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,
+   26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,
+   26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,
+   26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,
+   26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,
+   26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26,  26, 171, 172,
+  173, 173, 173, 173, 173, 173, 173, 173, 173, 173, 173, 173, 173, 173, 173, 173,
+  173, 173, 173, 173, 173, 173, 173, 173, 173, 173, 173, 173, 173, 173, 173, 173,
+   12,  12,  12,  12,  12,  12,  12,  12,  12,  12,  12,  12,  12,  12,  12,  12,
+   12,  12,  12,  12,  12,  12,  12,  12,  12,  12,  12,  12,  12,  12,  12,  12,
+   12,  12,  12,  12,  12,  12,  12,  12,  12,  12,  12,  12,  12,  12,  12,  12,
+   12,  12,  12,  12,  12,  12,  12,  12,  12,  12,  12,  12,  12,  12,  12,  12,
+   12,  12,  12,  12,  12,  12,  12,  12,  12,  12,  12,  12,  12,  12,  12,  12,
+   12,  12,  12,  12,  12,  12,  12,  12,  12,  12,  12,  12,  12,  12,  12,  12,
+   12,  12,  12,  12,  26,  26,  26,  26,  26, 174,  26, 175, 176, 177, 178, 179,
+   26,  26,  26,  26, 180, 181, 182, 183, 184, 185,  26, 186, 187, 188, 189, 190,
+};
+
+static const uint8_t kWcBmpBlocks[12224] = {
+    0,   0,   0,   0,   0,   0,   0,   0,   0,   1,   2,   2,   2,   2,   0,   0,
+    0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+    3,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+    5,   5,   5,   5,   5,   5,   5,   5,   5,   5,   4,   4,   4,   4,   4,   4,
+    4,   6,   6,   6,   6,   6,   6,   7,   7,   7,   7,   7,   7,   7,   7,   7,
+    7,   7,   7,   7,   7,   7,   7,   7,   7,   7,   7,   4,   4,   4,   4,   4,
+    4,   8,   8,   8,   8,   8,   8,   9,   9,   9,   9,   9,   9,   9,   9,   9,
+    9,   9,   9,   9,   9,   9,   9,   9,   9,   9,   9,   4,   4,   4,   4,   0,
+    0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+    0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+   10,   4,   4,   4,   4,   4,   4,   4,   4,   4,  11,   4,   4,   4,   4,   4,
+    4,   4,   4,   4,   4,  12,   4,   4,   4,   4,  11,   4,   4,   4,   4,   4,
+    7,   7,   7,   7,   7,   7,   7,   7,   7,   7,   7,   7,   7,   7,   7,   7,
+    7,   7,   7,   7,   7,   7,   7,   4,   7,   7,   7,   7,   7,   7,   7,  13,
+    9,   9,   9,   9,   9,   9,   9,   9,   9,   9,   9,   9,   9,   9,   9,   9,
+    9,   9,   9,   9,   9,   9,   9,   4,   9,   9,   9,   9,   9,   9,   9,  14,
+   15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,
+   15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,
+   15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,
+   17,  18,  15,  16,  15,  16,  15,  16,  13,  15,  16,  15,  16,  15,  16,  15,
+   16,  15,  16,  15,  16,  15,  16,  15,  16,  13,  15,  16,  15,  16,  15,  16,
+   15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,
+   15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,
+   15,  16,  15,  16,  15,  16,  15,  16,  19,  15,  16,  15,  16,  15,  16,  20,
+   21,  22,  15,  16,  15,  16,  23,  15,  16,  24,  24,  15,  16,  13,  25,  26,
+   27,  15,  16,  24,  28,  29,  30,  31,  15,  16,  32,  13,  30,  33,  34,  35,
+   15,  16,  15,  16,  15,  16,  36,  15,  16,  36,  13,  13,  15,  16,  36,  15,
+   16,  37,  37,  15,  16,  15,  16,  38,  15,  16,  13,  11,  15,  16,  13,  39,
+   11,  11,  11,  11,  40,  41,  42,  40,  41,  42,  40,  41,  42,  15,  16,  15,
+   16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  43,  15,  16,
+   15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,
+   13,  40,  41,  42,  15,  16,  44,  45,  15,  16,  15,  16,  15,  16,  15,  16,
+   15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,
+   15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,
+   46,  13,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,
+   15,  16,  15,  16,  13,  13,  13,  13,  13,  13,  47,  15,  16,  48,  49,  50,
+   50,  15,  16,  51,  52,  53,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,
+   54,  55,  56,  57,  58,  13,  59,  59,  13,  60,  13,  61,  62,  13,  13,  13,
+   59,  63,  13,  64,  13,  65,  66,  13,  67,  68,  66,  69,  70,  13,  13,  68,
+   13,  71,  72,  13,  13,  73,  13,  13,  13,  13,  13,  13,  13,  74,  13,  13,
+   75,  13,  76,  75,  13,  13,  13,  77,  75,  78,  79,  79,  80,  13,  13,  13,
+   13,  13,  81,  13,  11,  13,  13,  13,  13,  13,  13,  13,  13,  82,  83,  13,
+   13,  13,  13,  13,  13,  13,  13,  13,  13,  13,  13,  13,  13,  13,  13,  13,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,   4,   4,   4,   4,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+   11,  11,  11,  11,  11,   4,   4,   4,   4,   4,   4,   4,  11,   4,  11,   4,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+    4,   4,   4,   4,   4,  84,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+   15,  16,  15,  16,  11,   4,  15,  16,  85,  85,  11,  34,  34,  34,   4,  86,
+   85,  85,  85,  85,   4,   4,  87,   4,  88,  88,  88,  85,  89,  85,  90,  90,
+   13,   7,   7,   7,   7,   7,   7,   7,   7,   7,   7,   7,   7,   7,   7,   7,
+    7,   7,  85,   7,   7,   7,   7,   7,   7,   7,   7,   7,  91,  92,  92,  92,
+   13,   9,   9,   9,   9,   9,   9,   9,   9,   9,   9,   9,   9,   9,   9,   9,
+    9,   9,  93,   9,   9,   9,   9,   9,   9,   9,   9,   9,  94,  95,  95,  96,
+   97,  98,  17,  17,  17,  99, 100, 101,  15,  16,  15,  16,  15,  16,  15,  16,
+   15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,
+  102, 103, 104, 105, 106, 107,   4,  15,  16, 108,  15,  16,  13,  46,  46,  46,
+  109, 109, 109, 109, 109, 109, 109, 109, 109, 109, 109, 109, 109, 109, 109, 109,
+    7,   7,   7,   7,   7,   7,   7,   7,   7,   7,   7,   7,   7,   7,   7,   7,
+    7,   7,   7,   7,   7,   7,   7,   7,   7,   7,   7,   7,   7,   7,   7,   7,
+    9,   9,   9,   9,   9,   9,   9,   9,   9,   9,   9,   9,   9,   9,   9,   9,
+    9,   9,   9,   9,   9,   9,   9,   9,   9,   9,   9,   9,   9,   9,   9,   9,
+  103, 103, 103, 103, 103, 103, 103, 103, 103, 103, 103, 103, 103, 103, 103, 103,
+   15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,
+   15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,
+   15,  16,   4,   4,   4,   4,   4,   4,   4,   4,  15,  16,  15,  16,  15,  16,
+   15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,
+   15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,
+   15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,
+  110,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16, 111,
+   15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,
+   15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,
+   15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,
+   15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,
+   15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,
+   15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,
+   85, 112, 112, 112, 112, 112, 112, 112, 112, 112, 112, 112, 112, 112, 112, 112,
+  112, 112, 112, 112, 112, 112, 112, 112, 112, 112, 112, 112, 112, 112, 112, 112,
+  112, 112, 112, 112, 112, 112, 112,  85,  85,  11,   4,   4,   4,   4,   4,   4,
+   13, 113, 113, 113, 113, 113, 113, 113, 113, 113, 113, 113, 113, 113, 113, 113,
+  113, 113, 113, 113, 113, 113, 113, 113, 113, 113, 113, 113, 113, 113, 113, 113,
+  113, 113, 113, 113, 113, 113, 113,  13,  13,   4,   4,  85,  85,   4,   4,   4,
+   85,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+    4,   4,   4,   4,   4,   4,   4,   4,  85,  85,  85,  85,  85,  85,  85,  85,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  85,  85,  85,  85,  11,
+   11,  11,  11,   4,   4,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,   4,   4,   4,   4,   4,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,   4,   4,   4,   4,  11,  11,
+    4,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,   4,  11,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+    4,   4,   4,   4,   4,  11,  11,   4,   4,   4,   4,   4,   4,   4,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,   4,   4,  11,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,  85,   4,
+   11,   4,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,  85,  85,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+    4,  11,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,   4,   4,   4,   4,   4,
+    4,   4,   4,   4,  11,  11,   4,   4,   4,   4,  11,  85,  85,   4,   4,   4,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,   4,   4,   4,   4,  11,   4,   4,   4,   4,   4,
+    4,   4,   4,   4,  11,   4,   4,   4,  11,   4,   4,   4,   4,   4,  85,  85,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,  85,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,   4,   4,   4,  85,  85,   4,  85,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  85,  85,  85,  85,  85,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,   4,  11,  11,  11,  11,  11,  11,  85,
+    4,   4,  85,  85,  85,  85,  85,  85,   4,   4,   4,   4,   4,   4,   4,   4,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,   4,   4,   4,   4,   4,   4,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+    4,   4,   4,   4,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,   4,   4,   4,  11,   4,   4,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+   11,   4,   4,   4,   4,   4,   4,   4,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,   4,   4,   4,   4,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+    4,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,   4,   4,   4,  85,  11,  11,  11,  11,  11,  11,  11,  11,  85,  85,  11,
+   11,  85,  85,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  85,  11,  11,  11,  11,  11,  11,
+   11,  85,  11,  85,  85,  85,  11,  11,  11,  11,  85,  85,   4,  11,   4,   4,
+    4,   4,   4,   4,   4,  85,  85,   4,   4,  85,  85,   4,   4,   4,  11,  85,
+   85,  85,  85,  85,  85,  85,  85,   4,  85,  85,  85,  85,  11,  11,  85,  11,
+   11,  11,   4,   4,  85,  85,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,  11,   4,   4,  85,
+   85,   4,   4,   4,  85,  11,  11,  11,  11,  11,  11,  85,  85,  85,  85,  11,
+   11,  85,  85,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  85,  11,  11,  11,  11,  11,  11,
+   11,  85,  11,  11,  85,  11,  11,  85,  11,  11,  85,  85,   4,  85,   4,   4,
+    4,   4,   4,  85,  85,  85,  85,   4,   4,  85,  85,   4,   4,   4,  85,  85,
+   85,   4,  85,  85,  85,  85,  85,  85,  85,  11,  11,  11,  11,  85,  11,  85,
+   85,  85,  85,  85,  85,  85,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+    4,   4,  11,  11,  11,   4,   4,  85,  85,  85,  85,  85,  85,  85,  85,  85,
+   85,   4,   4,   4,  85,  11,  11,  11,  11,  11,  11,  11,  11,  11,  85,  11,
+   11,  11,  85,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  85,  11,  11,  11,  11,  11,  11,
+   11,  85,  11,  11,  85,  11,  11,  11,  11,  11,  85,  85,   4,  11,   4,   4,
+    4,   4,   4,   4,   4,   4,  85,   4,   4,   4,  85,   4,   4,   4,  85,  85,
+   11,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,
+   11,  11,   4,   4,  85,  85,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+    4,   4,  85,  85,  85,  85,  85,  85,  85,  11,   4,   4,   4,   4,   4,   4,
+   85,   4,   4,   4,  85,  11,  11,  11,  11,  11,  11,  11,  11,  85,  85,  11,
+   11,  85,  85,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  85,  11,  11,  11,  11,  11,  11,
+   11,  85,  11,  11,  85,  11,  11,  11,  11,  11,  85,  85,   4,  11,   4,   4,
+    4,   4,   4,   4,   4,  85,  85,   4,   4,  85,  85,   4,   4,   4,  85,  85,
+   85,  85,  85,  85,  85,   4,   4,   4,  85,  85,  85,  85,  11,  11,  85,  11,
+   11,  11,   4,   4,  85,  85,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+    4,  11,   4,   4,   4,   4,   4,   4,  85,  85,  85,  85,  85,  85,  85,  85,
+   85,  85,   4,  11,  85,  11,  11,  11,  11,  11,  11,  85,  85,  85,  11,  11,
+   11,  85,  11,  11,  11,  11,  85,  85,  85,  11,  11,  85,  11,  85,  11,  11,
+   85,  85,  85,  11,  11,  85,  85,  85,  11,  11,  11,  85,  85,  85,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  85,  85,  85,  85,   4,   4,
+    4,   4,   4,  85,  85,  85,   4,   4,   4,  85,   4,   4,   4,   4,  85,  85,
+   11,  85,  85,  85,  85,  85,  85,   4,  85,  85,  85,  85,  85,  85,  85,  85,
+   85,  85,  85,  85,  85,  85,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,  85,  85,  85,  85,  85,
+    4,   4,   4,   4,   4,  11,  11,  11,  11,  11,  11,  11,  11,  85,  11,  11,
+   11,  85,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  85,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  85,  85,   4,  11,   4,   4,
+    4,   4,   4,   4,   4,  85,   4,   4,   4,  85,   4,   4,   4,   4,  85,  85,
+   85,  85,  85,  85,  85,   4,   4,  85,  11,  11,  11,  85,  85,  11,  85,  85,
+   11,  11,   4,   4,  85,  85,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   85,  85,  85,  85,  85,  85,  85,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+   11,   4,   4,   4,   4,  11,  11,  11,  11,  11,  11,  11,  11,  85,  11,  11,
+   11,  85,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  85,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  85,  11,  11,  11,  11,  11,  85,  85,   4,  11,   4,   4,
+    4,   4,   4,   4,   4,  85,   4,   4,   4,  85,   4,   4,   4,   4,  85,  85,
+   85,  85,  85,  85,  85,   4,   4,  85,  85,  85,  85,  85,  85,  11,  11,  85,
+   11,  11,   4,   4,  85,  85,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   85,  11,  11,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,
+    4,   4,   4,   4,  11,  11,  11,  11,  11,  11,  11,  11,  11,  85,  11,  11,
+   11,  85,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,   4,   4,  11,   4,   4,
+    4,   4,   4,   4,   4,  85,   4,   4,   4,  85,   4,   4,   4,   4,  11,   4,
+   85,  85,  85,  85,  11,  11,  11,   4,   4,   4,   4,   4,   4,   4,   4,  11,
+   11,  11,   4,   4,  85,  85,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,  11,  11,  11,  11,  11,  11,
+   85,   4,   4,   4,  85,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  85,  85,  85,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  85,  11,  11,  11,  11,  11,  11,  11,  11,  11,  85,  11,  85,  85,
+   11,  11,  11,  11,  11,  11,  11,  85,  85,  85,   4,  85,  85,  85,  85,   4,
+    4,   4,   4,   4,   4,  85,   4,  85,   4,   4,   4,   4,   4,   4,   4,   4,
+   85,  85,  85,  85,  85,  85,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   85,  85,   4,   4,   4,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,
+   85,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,   4,  11,  11,   4,   4,   4,   4,   4,   4,   4,  85,  85,  85,  85,   4,
+   11,  11,  11,  11,  11,  11,  11,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,   4,   4,  85,  85,  85,  85,
+   85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,
+   85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,
+   85,  11,  11,  85,  11,  85,  11,  11,  11,  11,  11,  85,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  85,  11,  85,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,   4,  11,  11,   4,   4,   4,   4,   4,   4,   4,   4,   4,  11,  85,  85,
+   11,  11,  11,  11,  11,  85,  11,  85,   4,   4,   4,   4,   4,   4,  85,  85,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  85,  85,  11,  11,  11,  11,
+   85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,
+   85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,
+   11,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,   4,   4,   4,   4,   4,   4,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+   11,  11,  11,  11,  11,  11,  11,  11,  85,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  85,  85,  85,
+   85,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+    4,   4,   4,   4,   4,   4,   4,   4,  11,  11,  11,  11,  11,   4,   4,   4,
+    4,   4,   4,   4,   4,   4,   4,   4,  85,   4,   4,   4,   4,   4,   4,   4,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,  85,   4,   4,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,  85,   4,   4,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,  85,  85,  85,  85,  85,
+   85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,
+   85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,   4,   4,   4,   4,   4,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,   4,   4,   4,   4,   4,   4,
+   11,  11,  11,  11,  11,  11,   4,   4,   4,   4,  11,  11,  11,  11,   4,   4,
+    4,  11,   4,   4,   4,  11,  11,   4,   4,   4,   4,   4,   4,   4,  11,  11,
+   11,   4,   4,   4,   4,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,  11,   4,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,   4,   4,   4,   4,   4,   4,
+  114, 114, 114, 114, 114, 114, 114, 114, 114, 114, 114, 114, 114, 114, 114, 114,
+  114, 114, 114, 114, 114, 114, 114, 114, 114, 114, 114, 114, 114, 114, 114, 114,
+  114, 114, 114, 114, 114, 114,  85, 114,  85,  85,  85,  85,  85, 114,  85,  85,
+  115, 115, 115, 115, 115, 115, 115, 115, 115, 115, 115, 115, 115, 115, 115, 115,
+  115, 115, 115, 115, 115, 115, 115, 115, 115, 115, 115, 115, 115, 115, 115, 115,
+  115, 115, 115, 115, 115, 115, 115, 115, 115, 115, 115,   4,  11, 115, 115, 115,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  85,  11,  11,  11,  11,  85,  85,
+   11,  11,  11,  11,  11,  11,  11,  85,  11,  85,  11,  11,  11,  11,  85,  85,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  85,  11,  11,  11,  11,  85,  85,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  85,  11,  11,  11,  11,  85,  85,  11,  11,  11,  11,  11,  11,  11,  85,
+   11,  85,  11,  11,  11,  11,  85,  85,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  85,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  85,  11,  11,  11,  11,  85,  85,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  85,  85,   4,   4,   4,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,  85,  85,  85,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,  85,  85,  85,  85,  85,  85,
+  116, 116, 116, 116, 116, 116, 116, 116, 116, 116, 116, 116, 116, 116, 116, 116,
+  116, 116, 116, 116, 116, 116, 116, 116, 116, 116, 116, 116, 116, 116, 116, 116,
+  116, 116, 116, 116, 116, 116, 116, 116, 116, 116, 116, 116, 116, 116, 116, 116,
+  116, 116, 116, 116, 116, 116, 116, 116, 116, 116, 116, 116, 116, 116, 116, 116,
+  116, 116, 116, 116, 116, 116, 116, 116, 116, 116, 116, 116, 116, 116, 116, 116,
+   96,  96,  96,  96,  96,  96,  85,  85, 101, 101, 101, 101, 101, 101,  85,  85,
+    4,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,   4,   4,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+    3,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,   4,   4,  85,  85,  85,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,   4,   4,   4,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  85,  85,  85,  85,  85,  85,  85,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,   4,   4,   4,   4,  85,  85,  85,  85,  85,  85,  85,  85,  85,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,   4,   4,   4,   4,   4,  85,  85,  85,  85,  85,  85,  85,  85,  85,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,   4,   4,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  85,  11,  11,
+   11,  85,   4,   4,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+    4,   4,   4,   4,   4,   4,   4,  11,   4,   4,   4,   4,  11,   4,  85,  85,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  85,  85,  85,  85,  85,  85,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,  85,  85,  85,  85,  85,  85,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  85,  85,  85,  85,  85,  85,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  85,  85,  85,  85,  85,  85,  85,
+   11,  11,  11,  11,  11,   4,   4,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,   4,  11,  85,  85,  85,  85,  85,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  85,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,  85,  85,  85,  85,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,  85,  85,  85,  85,
+    4,  85,  85,  85,   4,   4,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  85,  85,
+   11,  11,  11,  11,  11,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  85,  85,  85,  85,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  85,  85,  85,  85,  85,  85,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,   4,  85,  85,  85,   4,   4,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,   4,   4,   4,   4,   4,  85,  85,   4,   4,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,  85,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,  85,  85,   4,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  85,  85,  85,  85,  85,  85,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  85,  85,  85,  85,  85,  85,
+    4,   4,   4,   4,   4,   4,   4,  11,   4,   4,   4,   4,   4,   4,  85,  85,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,  85,
+   85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,
+   85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,
+   85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,
+    4,   4,   4,   4,   4,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+    4,   4,   4,   4,   4,  11,  11,  11,  11,  11,  11,  11,  11,  85,  85,  85,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,   4,   4,   4,   4,   4,   4,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,  85,
+    4,   4,   4,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+    4,   4,   4,   4,  85,  85,  85,  85,  85,  85,  85,  85,   4,   4,   4,   4,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+    4,   4,   4,   4,   4,   4,   4,   4,  85,  85,  85,   4,   4,   4,   4,   4,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  85,  85,  85,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,   4,   4,
+  117, 118, 119, 120, 120, 121, 122, 123, 124,  85,  85,  85,  85,  85,  85,  85,
+  125, 125, 125, 125, 125, 125, 125, 125, 125, 125, 125, 125, 125, 125, 125, 125,
+  125, 125, 125, 125, 125, 125, 125, 125, 125, 125, 125, 125, 125, 125, 125, 125,
+  125, 125, 125, 125, 125, 125, 125, 125, 125, 125, 125,  85,  85, 125, 125, 125,
+    4,   4,   4,   4,   4,   4,   4,   4,  85,  85,  85,  85,  85,  85,  85,  85,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,  11,  11,  11,  11,   4,  11,  11,
+   11,  11,  11,  11,   4,  11,  11,   4,   4,   4,  11,  85,  85,  85,  85,  85,
+   13,  13,  13,  13,  13,  13,  13,  13,  13,  13,  13,  13,  13,  13,  13,  13,
+   13,  13,  13,  13,  13,  13,  13,  13,  13,  13,  13,  13,  13,  13,  13,  13,
+   13,  13,  13,  13,  13,  13,  13,  13,  13,  13,  13,  13,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  13,  13,  13,  13,  13,
+   13,  13,  13,  13,  13,  13,  13,  13,  11, 126,  13,  13,  13, 127,  13,  13,
+   13,  13,  13,  13,  13,  13,  13,  13,  13,  13,  13,  13,  13,  13, 128,  13,
+   13,  13,  13,  13,  13,  13,  13,  13,  13,  13,  13,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,
+   15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,
+   15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,
+   15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,
+   15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,
+   15,  16,  15,  16,  15,  16,  13,  13,  13,  13,  13, 129,  13,  13, 130,  13,
+   15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,
+   15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,
+  131, 131, 131, 131, 131, 131, 131, 131, 132, 132, 132, 132, 132, 132, 132, 132,
+  131, 131, 131, 131, 131, 131,  85,  85, 132, 132, 132, 132, 132, 132,  85,  85,
+  131, 131, 131, 131, 131, 131, 131, 131, 132, 132, 132, 132, 132, 132, 132, 132,
+  131, 131, 131, 131, 131, 131, 131, 131, 132, 132, 132, 132, 132, 132, 132, 132,
+  131, 131, 131, 131, 131, 131,  85,  85, 132, 132, 132, 132, 132, 132,  85,  85,
+   13, 131,  13, 131,  13, 131,  13, 131,  85, 132,  85, 132,  85, 132,  85, 132,
+  131, 131, 131, 131, 131, 131, 131, 131, 132, 132, 132, 132, 132, 132, 132, 132,
+  133, 133, 134, 134, 134, 134, 135, 135, 136, 136, 137, 137, 138, 138,  85,  85,
+   13,  13,  13,  13,  13,  13,  13,  13, 132, 132, 132, 132, 132, 132, 132, 132,
+   13,  13,  13,  13,  13,  13,  13,  13, 132, 132, 132, 132, 132, 132, 132, 132,
+   13,  13,  13,  13,  13,  13,  13,  13, 132, 132, 132, 132, 132, 132, 132, 132,
+  131, 131,  13,  13,  13,  85,  13,  13, 132, 132, 139, 139, 140,   4, 141,   4,
+    4,   4,  13,  13,  13,  85,  13,  13, 142, 142, 142, 142, 140,   4,   4,   4,
+  131, 131,  13,  13,  85,  85,  13,  13, 132, 132, 143, 143,  85,   4,   4,   4,
+  131, 131,  13,  13,  13, 104,  13,  13, 132, 132, 144, 144, 108,   4,   4,   4,
+   85,  85,  13,  13,  13,  85,  13,  13, 145, 145, 146, 146, 140,   4,   4,  85,
+    3,   3,   3,   3,   3,   3,   3,  10,   3,   3,   3,   4,   4,   4,   4,   4,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+    4,   4,   4,   4,   4,   4,   4,   4,   2,   2,   4,   4,   4,   4,   4,  10,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   3,
+    4,   4,   4,   4,   4,  85,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+    4,  11,  85,  85,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,  11,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,  85,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  85,  85,  85,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+    4,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+    4,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,
+    4,   4,  17,   4,   4,   4,   4,  17,   4,   4,  13,  17,  17,  17,  13,  13,
+   17,  17,  17,  13,   4,  17,   4,   4,   4,  17,  17,  17,  17,  17,   4,   4,
+    4,   4,   4,   4,  17,   4, 147,   4,  17,   4, 148, 149,  17,  17,   4,  13,
+   17,  17, 150,  17,  13,  11,  11,  11,  11,  13,   4,   4,  13,  13,  17,  17,
+    4,   4,   4,   4,   4,  17,  13,  13,  13,  13,   4,   4,   4,   4, 151,   4,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+  152, 152, 152, 152, 152, 152, 152, 152, 152, 152, 152, 152, 152, 152, 152, 152,
+  153, 153, 153, 153, 153, 153, 153, 153, 153, 153, 153, 153, 153, 153, 153, 153,
+   11,  11,  11,  15,  16,  11,  11,  11,  11,   4,   4,   4,  85,  85,  85,  85,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+    4,   4,   4,   4,   4,   4,   4,  85,  85,  85,  85,  85,  85,  85,  85,  85,
+   85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,  85,  85,  85,  85,  85,
+   85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+    4,   4,   4,   4,   4,   4, 154, 154, 154, 154, 154, 154, 154, 154, 154, 154,
+  154, 154, 154, 154, 154, 154, 154, 154, 154, 154, 154, 154, 154, 154, 154, 154,
+  155, 155, 155, 155, 155, 155, 155, 155, 155, 155, 155, 155, 155, 155, 155, 155,
+  155, 155, 155, 155, 155, 155, 155, 155, 155, 155,   4,   4,   4,   4,   4,   4,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+    4,   4,   4,   4,  85,  85,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+    4,   4,   4,   4,   4,   4,  85,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+  112, 112, 112, 112, 112, 112, 112, 112, 112, 112, 112, 112, 112, 112, 112, 112,
+  112, 112, 112, 112, 112, 112, 112, 112, 112, 112, 112, 112, 112, 112, 112, 112,
+  112, 112, 112, 112, 112, 112, 112, 112, 112, 112, 112, 112, 112, 112, 112, 112,
+  113, 113, 113, 113, 113, 113, 113, 113, 113, 113, 113, 113, 113, 113, 113, 113,
+  113, 113, 113, 113, 113, 113, 113, 113, 113, 113, 113, 113, 113, 113, 113, 113,
+  113, 113, 113, 113, 113, 113, 113, 113, 113, 113, 113, 113, 113, 113, 113, 113,
+   15,  16, 156, 157, 158, 159, 160,  15,  16,  15,  16,  15,  16, 161, 162, 163,
+  164,  13,  15,  16,  13,  15,  16,  13,  13,  13,  13,  13,  11,  11, 165, 165,
+   15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,
+   15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,
+   15,  16,  15,  16,  13,   4,   4,   4,   4,   4,   4,  15,  16,  15,  16,   4,
+    4,   4,  15,  16,  85,  85,  85,  85,  85,   4,   4,   4,   4,   4,   4,   4,
+  166, 166, 166, 166, 166, 166, 166, 166, 166, 166, 166, 166, 166, 166, 166, 166,
+  166, 166, 166, 166, 166, 166, 166, 166, 166, 166, 166, 166, 166, 166, 166, 166,
+  166, 166, 166, 166, 166, 166,  85, 166,  85,  85,  85,  85,  85, 166,  85,  85,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  85,  85,  85,  85,  85,  85,  85,  11,
+    4,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,   4,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  85,  85,  85,  85,  85,  85,  85,  85,  85,
+   11,  11,  11,  11,  11,  11,  11,  85,  11,  11,  11,  11,  11,  11,  11,  85,
+   11,  11,  11,  11,  11,  11,  11,  85,  11,  11,  11,  11,  11,  11,  11,  85,
+   11,  11,  11,  11,  11,  11,  11,  85,  11,  11,  11,  11,  11,  11,  11,  85,
+   11,  11,  11,  11,  11,  11,  11,  85,  11,  11,  11,  11,  11,  11,  11,  85,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,  11,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,  85,  85,
+   85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,
+   85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,  85,   4,   4,   4,   4,   4,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+    4,   4,   4,   4,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+    4,   4,   4,   4,   4,   4,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,
+   85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,  85,  85,  85,  85,
+    3,   4,   4,   4,   4,  11,  11,  11,   4,   4,   4,   4,   4,   4,   4,   4,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+    4,  11,  11,  11,  11,  11,  11,  11,  11,  11,   4,   4,   4,   4,   4,   4,
+    4,  11,  11,  11,  11,  11,   4,   4,  11,  11,  11,  11,  11,   4,   4,   4,
+   85,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  85,  85,   4,   4,   4,   4,  11,  11,  11,
+    4,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,   4,  11,  11,  11,  11,
+   85,  85,  85,  85,  85,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   85,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  85,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+    4,   4,   4,   4,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,  85,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  85,  85,  85,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+    4,   4,   4,   4,   4,   4,   4,  85,  85,  85,  85,  85,  85,  85,  85,  85,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,   4,   4,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,   4,   4,   4,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  85,  85,  85,  85,
+   85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,
+   15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,
+   15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,
+   15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  11,   4,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,  11,
+   15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,
+   15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  11,  11,   4,   4,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+    4,   4,   4,   4,   4,   4,   4,   4,  85,  85,  85,  85,  85,  85,  85,  85,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+    4,   4,   4,   4,   4,   4,   4,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+    4,   4,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,
+   13,  13,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,
+   15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,
+   15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,
+   15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,
+   11,  13,  13,  13,  13,  13,  13,  13,  13,  15,  16,  15,  16, 167,  15,  16,
+   15,  16,  15,  16,  15,  16,  15,  16,  11,   4,   4,  15,  16, 168,  13,  11,
+   15,  16,  15,  16, 169,  13,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,
+   15,  16,  15,  16,  15,  16,  15,  16,  15,  16, 170, 171, 172, 173, 170,  13,
+  174, 175, 176, 177,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,  15,  16,
+   15,  16,  15,  16, 178, 179, 180,  15,  16,  15,  16,  85,  85,  85,  85,  85,
+   15,  16,  85,  13,  85,  13,  15,  16,  15,  16,  85,  85,  85,  85,  85,  85,
+   85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,
+   85,  85,  11,  11,  11,  15,  16,  11,  11,  11,  13,  11,  11,  11,  11,  11,
+   11,  11,   4,  11,  11,  11,   4,  11,  11,  11,  11,   4,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,  85,  85,  85,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,  85,  85,  85,  85,  85,  85,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,   4,   4,   4,   4,  85,  85,  85,  85,  85,  85,  85,  85,
+    4,   4,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+    4,   4,   4,   4,   4,   4,  85,  85,  85,  85,  85,  85,  85,  85,   4,   4,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  85,  85,  85,  85,  85,  85,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+    4,   4,  11,  11,  11,  11,  11,  11,   4,   4,   4,  11,   4,  11,  11,   4,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+    4,   4,   4,   4,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,   4,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  85,  85,  85,
+    4,   4,   4,   4,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,  85,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  85,  85,  85,  85,   4,   4,
+   11,  11,  11,  11,  11,   4,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  85,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,   4,   4,   4,   4,   4,   4,   4,
+    4,   4,   4,   4,   4,   4,   4,  85,  85,  85,  85,  85,  85,  85,  85,  85,
+   11,  11,  11,   4,  11,  11,  11,  11,  11,  11,  11,  11,   4,   4,  85,  85,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  85,  85,   4,   4,   4,   4,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,   4,   4,   4,  11,   4,   4,   4,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+    4,  11,   4,   4,   4,  11,  11,   4,   4,  11,  11,  11,  11,  11,   4,   4,
+   11,   4,  11,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,
+   85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  11,  11,  11,   4,   4,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,   4,   4,   4,   4,   4,
+    4,   4,  11,  11,  11,   4,   4,  85,  85,  85,  85,  85,  85,  85,  85,  85,
+   85,  11,  11,  11,  11,  11,  11,  85,  85,  11,  11,  11,  11,  11,  11,  85,
+   85,  11,  11,  11,  11,  11,  11,  85,  85,  85,  85,  85,  85,  85,  85,  85,
+   11,  11,  11,  11,  11,  11,  11,  85,  11,  11,  11,  11,  11,  11,  11,  85,
+   13,  13,  13,  13,  13,  13,  13,  13,  13,  13,  13,  13,  13,  13,  13,  13,
+   13,  13,  13,  13,  13,  13,  13,  13,  13,  13,  13,  13,  13,  13,  13,  13,
+   13,  13,  13, 181,  13,  13,  13,  13,  13,  13,  13,   4,  11,  11,  11,  11,
+   13,  13,  13,  13,  13,  13,  13,  13,  13,  11,   4,   4,  85,  85,  85,  85,
+  182, 182, 182, 182, 182, 182, 182, 182, 182, 182, 182, 182, 182, 182, 182, 182,
+  182, 182, 182, 182, 182, 182, 182, 182, 182, 182, 182, 182, 182, 182, 182, 182,
+  182, 182, 182, 182, 182, 182, 182, 182, 182, 182, 182, 182, 182, 182, 182, 182,
+  182, 182, 182, 182, 182, 182, 182, 182, 182, 182, 182, 182, 182, 182, 182, 182,
+  182, 182, 182, 182, 182, 182, 182, 182, 182, 182, 182, 182, 182, 182, 182, 182,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,  85,  85,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  85,  85,  85,  85,  85,  85,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  85,  85,  85,  85,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  85,  85,  85,  85,
+   85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,
+   85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,
+   85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,
+   85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  85,  85,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  85,  85,  85,  85,  85,  85,
+   85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,
+   85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,
+   13,  13,  13,  13,  13,  13,  13,  85,  85,  85,  85,  85,  85,  85,  85,  85,
+   85,  85,  85,  13,  13,  13,  13,  13,  85,  85,  85,  85,  85,  11,   4,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,   4,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  85,  11,  11,  11,  11,  11,  85,  11,  85,
+   11,  11,  85,  11,  11,  85,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+    4,   4,   4,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,
+   85,  85,  85,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,   4,   4,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   85,  85,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  85,  85,  85,  85,  85,  85,  85,   4,
+   85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,
+   85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,  85,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,   4,   4,   4,   4,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,  85,  85,  85,  85,  85,  85,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+    4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+    4,   4,   4,  85,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+    4,   4,   4,   4,   4,   4,   4,  85,   4,   4,   4,   4,  85,  85,  85,  85,
+   11,  11,  11,  11,  11,  85,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  85,  85,   4,
+   85,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,   4,   4,   4,   4,   4,   4,
+    4,   7,   7,   7,   7,   7,   7,   7,   7,   7,   7,   7,   7,   7,   7,   7,
+    7,   7,   7,   7,   7,   7,   7,   7,   7,   7,   7,   4,   4,   4,   4,   4,
+    4,   9,   9,   9,   9,   9,   9,   9,   9,   9,   9,   9,   9,   9,   9,   9,
+    9,   9,   9,   9,   9,   9,   9,   9,   9,   9,   9,   4,   4,   4,   4,   4,
+    4,   4,   4,   4,   4,   4,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,
+   11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  11,  85,
+   85,  85,  11,  11,  11,  11,  11,  11,  85,  85,  11,  11,  11,  11,  11,  11,
+   85,  85,  11,  11,  11,  11,  11,  11,  85,  85,  11,  11,  11,  85,  85,  85,
+    4,   4,   4,   4,   4,   4,   4,  85,   4,   4,   4,   4,   4,   4,   4,  85,
+   85,  85,  85,  85,  85,  85,  85,  85,  85,   4,   4,   4,   4,   4,  85,  85,
+};
+
+static const uint32_t kWcSupplementaryRuns[915] = {
+  0x0100000b, 0x01000c55, 0x01000d0b, 0x01002755, 0x0100280b, 0x01003b55,
+  0x01003c0b, 0x01003e55, 0x01003f0b, 0x01004e55, 0x0100500b, 0x01005e55,
+  0x0100800b, 0x0100fb55, 0x01010004, 0x01010355, 0x01010704, 0x01013455,
+  0x01013704, 0x0101400b, 0x01017504, 0x01018f55, 0x01019004, 0x01019d55,
+  0x0101a004, 0x0101a155, 0x0101d004, 0x0101fe55, 0x0102800b, 0x01029d55,
+  0x0102a00b, 0x0102d155, 0x0102e004, 0x0102fc55, 0x0103000b, 0x01032004,
+  0x01032455, 0x01032d0b, 0x01034b55, 0x0103500b, 0x01037604, 0x01037b55,
+  0x0103800b, 0x01039e55, 0x01039f04, 0x0103a00b, 0x0103c455, 0x0103c80b,
+  0x0103d004, 0x0103d10b, 0x0103d655, 0x010400b7, 0x010428b8, 0x0104500b,
+  0x01049e55, 0x0104a00b, 0x0104aa55, 0x0104b0b7, 0x0104d455, 0x0104d8b8,
+  0x0104fc55, 0x0105000b, 0x01052855, 0x0105300b, 0x01056455, 0x01056f04,
+  0x010570b9, 0x01057b55, 0x01057cb9, 0x01058b55, 0x01058cb9, 0x01059355,
+  0x010594b9, 0x01059655, 0x010597ba, 0x0105a255, 0x0105a3ba, 0x0105b255,
+  0x0105b3ba, 0x0105ba55, 0x0105bbba, 0x0105bd55, 0x0106000b, 0x01073755,
+  0x0107400b, 0x01075655, 0x0107600b, 0x01076855, 0x0107800b, 0x01078655,
+  0x0107870b, 0x0107b155, 0x0107b20b, 0x0107bb55, 0x0108000b, 0x01080655,
+  0x0108080b, 0x01080955, 0x01080a0b, 0x01083655, 0x0108370b, 0x01083955,
+  0x01083c0b, 0x01083d55, 0x01083f0b, 0x01085655, 0x01085704, 0x0108600b,
+  0x01087704, 0x0108800b, 0x01089f55, 0x0108a704, 0x0108b055, 0x0108e00b,
+  0x0108f355, 0x0108f40b, 0x0108f655, 0x0108fb04, 0x0109000b, 0x01091604,
+  0x01091c55, 0x01091f04, 0x0109200b, 0x01093a55, 0x01093f04, 0x01094055,
+  0x0109800b, 0x0109b855, 0x0109bc04, 0x0109be0b, 0x0109c004, 0x0109d055,
+  0x0109d204, 0x010a000b, 0x010a0104, 0x010a0455, 0x010a0504, 0x010a0755,
+  0x010a0c04, 0x010a100b, 0x010a1455, 0x010a150b, 0x010a1855, 0x010a190b,
+  0x010a3655, 0x010a3804, 0x010a3b55, 0x010a3f04, 0x010a4955, 0x010a5004,
+  0x010a5955, 0x010a600b, 0x010a7d04, 0x010a800b, 0x010a9d04, 0x010aa055,
+  0x010ac00b, 0x010ac804, 0x010ac90b, 0x010ae504, 0x010ae755, 0x010aeb04,
+  0x010af755, 0x010b000b, 0x010b3655, 0x010b3904, 0x010b400b, 0x010b5655,
+  0x010b5804, 0x010b600b, 0x010b7355, 0x010b7804, 0x010b800b, 0x010b9255,
+  0x010b9904, 0x010b9d55, 0x010ba904, 0x010bb055, 0x010c000b, 0x010c4955,
+  0x010c8059, 0x010cb355, 0x010cc05e, 0x010cf355, 0x010cfa04, 0x010d000b,
+  0x010d2404, 0x010d2855, 0x010d300b, 0x010d3a55, 0x010e6004, 0x010e7f55,
+  0x010e800b, 0x010eaa55, 0x010eab04, 0x010eae55, 0x010eb00b, 0x010eb255,
+  0x010f000b, 0x010f1d04, 0x010f270b, 0x010f2855, 0x010f300b, 0x010f4604,
+  0x010f5a55, 0x010f700b, 0x010f8204, 0x010f8a55, 0x010fb00b, 0x010fc504,
+  0x010fcc55, 0x010fe00b, 0x010ff755, 0x01100004, 0x0110030b, 0x01103804,
+  0x01104e55, 0x01105204, 0x0110660b, 0x01107004, 0x0110710b, 0x01107304,
+  0x0110750b, 0x01107655, 0x01107f04, 0x0110830b, 0x0110b004, 0x0110c355,
+  0x0110cd04, 0x0110ce55, 0x0110d00b, 0x0110e955, 0x0110f00b, 0x0110fa55,
+  0x01110004, 0x0111030b, 0x01112704, 0x01113555, 0x0111360b, 0x01114004,
+  0x0111440b, 0x01114504, 0x0111470b, 0x01114855, 0x0111500b, 0x01117304,
+  0x0111760b, 0x01117755, 0x01118004, 0x0111830b, 0x0111b304, 0x0111c10b,
+  0x0111c504, 0x0111d00b, 0x0111db04, 0x0111dc0b, 0x0111dd04, 0x0111e055,
+  0x0111e104, 0x0111f555, 0x0112000b, 0x01121255, 0x0112130b, 0x01122c04,
+  0x01123f55, 0x0112800b, 0x01128755, 0x0112880b, 0x01128955, 0x01128a0b,
+  0x01128e55, 0x01128f0b, 0x01129e55, 0x01129f0b, 0x0112a904, 0x0112aa55,
+  0x0112b00b, 0x0112df04, 0x0112eb55, 0x0112f00b, 0x0112fa55, 0x01130004,
+  0x01130455, 0x0113050b, 0x01130d55, 0x01130f0b, 0x01131155, 0x0113130b,
+  0x01132955, 0x01132a0b, 0x01133155, 0x0113320b, 0x01133455, 0x0113350b,
+  0x01133a55, 0x01133b04, 0x01133d0b, 0x01133e04, 0x01134555, 0x01134704,
+  0x01134955, 0x01134b04, 0x01134e55, 0x0113500b, 0x01135155, 0x01135704,
+  0x01135855, 0x01135d0b, 0x01136204, 0x01136455, 0x01136604, 0x01136d55,
+  0x01137004, 0x01137555, 0x0114000b, 0x01143504, 0x0114470b, 0x01144b04,
+  0x0114500b, 0x01145a04, 0x01145c55, 0x01145d04, 0x01145f0b, 0x01146255,
+  0x0114800b, 0x0114b004, 0x0114c40b, 0x0114c604, 0x0114c70b, 0x0114c855,
+  0x0114d00b, 0x0114da55, 0x0115800b, 0x0115af04, 0x0115b655, 0x0115b804,
+  0x0115d80b, 0x0115dc04, 0x0115de55, 0x0116000b, 0x01163004, 0x0116440b,
+  0x01164555, 0x0116500b, 0x01165a55, 0x01166004, 0x01166d55, 0x0116800b,
+  0x0116ab04, 0x0116b80b, 0x0116b904, 0x0116ba55, 0x0116c00b, 0x0116ca55,
+  0x0117000b, 0x01171b55, 0x01171d04, 0x01172c55, 0x0117300b, 0x01173a04,
+  0x0117400b, 0x01174755, 0x0118000b, 0x01182c04, 0x01183c55, 0x0118a007,
+  0x0118c009, 0x0118e00b, 0x0118ea04, 0x0118f355, 0x0118ff0b, 0x01190755,
+  0x0119090b, 0x01190a55, 0x01190c0b, 0x01191455, 0x0119150b, 0x01191755,
+  0x0119180b, 0x01193004, 0x01193655, 0x01193704, 0x01193955, 0x01193b04,
+  0x01193f0b, 0x01194004, 0x0119410b, 0x01194204, 0x01194755, 0x0119500b,
+  0x01195a55, 0x0119a00b, 0x0119a855, 0x0119aa0b, 0x0119d104, 0x0119d855,
+  0x0119da04, 0x0119e10b, 0x0119e204, 0x0119e30b, 0x0119e404, 0x0119e555,
+  0x011a000b, 0x011a0104, 0x011a0b0b, 0x011a3304, 0x011a3a0b, 0x011a3b04,
+  0x011a4855, 0x011a500b, 0x011a5104, 0x011a5c0b, 0x011a8a04, 0x011a9d0b,
+  0x011a9e04, 0x011aa355, 0x011ab00b, 0x011af955, 0x011c000b, 0x011c0955,
+  0x011c0a0b, 0x011c2f04, 0x011c3755, 0x011c3804, 0x011c400b, 0x011c4104,
+  0x011c4655, 0x011c500b, 0x011c5a04, 0x011c6d55, 0x011c7004, 0x011c720b,
+  0x011c9055, 0x011c9204, 0x011ca855, 0x011ca904, 0x011cb755, 0x011d000b,
+  0x011d0755, 0x011d080b, 0x011d0a55, 0x011d0b0b, 0x011d3104, 0x011d3755,
+  0x011d3a04, 0x011d3b55, 0x011d3c04, 0x011d3e55, 0x011d3f04, 0x011d460b,
+  0x011d4704, 0x011d4855, 0x011d500b, 0x011d5a55, 0x011d600b, 0x011d6655,
+  0x011d670b, 0x011d6955, 0x011d6a0b, 0x011d8a04, 0x011d8f55, 0x011d9004,
+  0x011d9255, 0x011d9304, 0x011d980b, 0x011d9955, 0x011da00b, 0x011daa55,
+  0x011ee00b, 0x011ef304, 0x011ef955, 0x011fb00b, 0x011fb155, 0x011fc004,
+  0x011ff255, 0x011fff04, 0x0120000b, 0x01239a55, 0x0124000b, 0x01246f55,
+  0x01247004, 0x01247555, 0x0124800b, 0x01254455, 0x012f900b, 0x012ff104,
+  0x012ff355, 0x0130000b, 0x01342f55, 0x01343004, 0x01343955, 0x0144000b,
+  0x01464755, 0x0168000b, 0x016a3955, 0x016a400b, 0x016a5f55, 0x016a600b,
+  0x016a6a55, 0x016a6e04, 0x016a700b, 0x016abf55, 0x016ac00b, 0x016aca55,
+  0x016ad00b, 0x016aee55, 0x016af004, 0x016af655, 0x016b000b, 0x016b3004,
+  0x016b400b, 0x016b4404, 0x016b4655, 0x016b500b, 0x016b5a55, 0x016b5b04,
+  0x016b6255, 0x016b630b, 0x016b7855, 0x016b7d0b, 0x016b9055, 0x016e4007,
+  0x016e6009, 0x016e8004, 0x016e9b55, 0x016f000b, 0x016f4b55, 0x016f4f04,
+  0x016f500b, 0x016f5104, 0x016f8855, 0x016f8f04, 0x016f930b, 0x016fa055,
+  0x016fe00b, 0x016fe204, 0x016fe30b, 0x016fe404, 0x016fe555, 0x016ff004,
+  0x016ff255, 0x0170000b, 0x0187f855, 0x0188000b, 0x018cd655, 0x018d000b,
+  0x018d0955, 0x01aff00b, 0x01aff455, 0x01aff50b, 0x01affc55, 0x01affd0b,
+  0x01afff55, 0x01b0000b, 0x01b12355, 0x01b1500b, 0x01b15355, 0x01b1640b,
+  0x01b16855, 0x01b1700b, 0x01b2fc55, 0x01bc000b, 0x01bc6b55, 0x01bc700b,
+  0x01bc7d55, 0x01bc800b, 0x01bc8955, 0x01bc900b, 0x01bc9a55, 0x01bc9c04,
+  0x01bca455, 0x01cf0004, 0x01cf2e55, 0x01cf3004, 0x01cf4755, 0x01cf5004,
+  0x01cfc455, 0x01d00004, 0x01d0f655, 0x01d10004, 0x01d12755, 0x01d12904,
+  0x01d1eb55, 0x01d20004, 0x01d24655, 0x01d2e004, 0x01d2f455, 0x01d30004,
+  0x01d35755, 0x01d36004, 0x01d37955, 0x01d40011, 0x01d41a0d, 0x01d43411,
+  0x01d44e0d, 0x01d45555, 0x01d4560d, 0x01d46811, 0x01d4820d, 0x01d49c11,
+  0x01d49d55, 0x01d49e11, 0x01d4a055, 0x01d4a211, 0x01d4a355, 0x01d4a511,
+  0x01d4a755, 0x01d4a911, 0x01d4ad55, 0x01d4ae11, 0x01d4b60d, 0x01d4ba55,
+  0x01d4bb0d, 0x01d4bc55, 0x01d4bd0d, 0x01d4c455, 0x01d4c50d, 0x01d4d011,
+  0x01d4ea0d, 0x01d50411, 0x01d50655, 0x01d50711, 0x01d50b55, 0x01d50d11,
+  0x01d51555, 0x01d51611, 0x01d51d55, 0x01d51e0d, 0x01d53811, 0x01d53a55,
+  0x01d53b11, 0x01d53f55, 0x01d54011, 0x01d54555, 0x01d54611, 0x01d54755,
+  0x01d54a11, 0x01d55155, 0x01d5520d, 0x01d56c11, 0x01d5860d, 0x01d5a011,
+  0x01d5ba0d, 0x01d5d411, 0x01d5ee0d, 0x01d60811, 0x01d6220d, 0x01d63c11,
+  0x01d6560d, 0x01d67011, 0x01d68a0d, 0x01d6a655, 0x01d6a811, 0x01d6c104,
+  0x01d6c20d, 0x01d6db04, 0x01d6dc0d, 0x01d6e211, 0x01d6fb04, 0x01d6fc0d,
+  0x01d71504, 0x01d7160d, 0x01d71c11, 0x01d73504, 0x01d7360d, 0x01d74f04,
+  0x01d7500d, 0x01d75611, 0x01d76f04, 0x01d7700d, 0x01d78904, 0x01d78a0d,
+  0x01d79011, 0x01d7a904, 0x01d7aa0d, 0x01d7c304, 0x01d7c40d, 0x01d7ca11,
+  0x01d7cb0d, 0x01d7cc55, 0x01d7ce0b, 0x01d80004, 0x01da8c55, 0x01da9b04,
+  0x01daa055, 0x01daa104, 0x01dab055, 0x01df000d, 0x01df0a0b, 0x01df0b0d,
+  0x01df1f55, 0x01e00004, 0x01e00755, 0x01e00804, 0x01e01955, 0x01e01b04,
+  0x01e02255, 0x01e02304, 0x01e02555, 0x01e02604, 0x01e02b55, 0x01e1000b,
+  0x01e12d55, 0x01e13004, 0x01e1370b, 0x01e13e55, 0x01e1400b, 0x01e14a55,
+  0x01e14e0b, 0x01e14f04, 0x01e15055, 0x01e2900b, 0x01e2ae04, 0x01e2af55,
+  0x01e2c00b, 0x01e2ec04, 0x01e2f00b, 0x01e2fa55, 0x01e2ff04, 0x01e30055,
+  0x01e7e00b, 0x01e7e755, 0x01e7e80b, 0x01e7ec55, 0x01e7ed0b, 0x01e7ef55,
+  0x01e7f00b, 0x01e7ff55, 0x01e8000b, 0x01e8c555, 0x01e8c704, 0x01e8d755,
+  0x01e900bb, 0x01e922bc, 0x01e94404, 0x01e94b0b, 0x01e94c55, 0x01e9500b,
+  0x01e95a55, 0x01e95e04, 0x01e96055, 0x01ec7104, 0x01ecb555, 0x01ed0104,
+  0x01ed3e55, 0x01ee000b, 0x01ee0455, 0x01ee050b, 0x01ee2055, 0x01ee210b,
+  0x01ee2355, 0x01ee240b, 0x01ee2555, 0x01ee270b, 0x01ee2855, 0x01ee290b,
+  0x01ee3355, 0x01ee340b, 0x01ee3855, 0x01ee390b, 0x01ee3a55, 0x01ee3b0b,
+  0x01ee3c55, 0x01ee420b, 0x01ee4355, 0x01ee470b, 0x01ee4855, 0x01ee490b,
+  0x01ee4a55, 0x01ee4b0b, 0x01ee4c55, 0x01ee4d0b, 0x01ee5055, 0x01ee510b,
+  0x01ee5355, 0x01ee540b, 0x01ee5555, 0x01ee570b, 0x01ee5855, 0x01ee590b,
+  0x01ee5a55, 0x01ee5b0b, 0x01ee5c55, 0x01ee5d0b, 0x01ee5e55, 0x01ee5f0b,
+  0x01ee6055, 0x01ee610b, 0x01ee6355, 0x01ee640b, 0x01ee6555, 0x01ee670b,
+  0x01ee6b55, 0x01ee6c0b, 0x01ee7355, 0x01ee740b, 0x01ee7855, 0x01ee790b,
+  0x01ee7d55, 0x01ee7e0b, 0x01ee7f55, 0x01ee800b, 0x01ee8a55, 0x01ee8b0b,
+  0x01ee9c55, 0x01eea10b, 0x01eea455, 0x01eea50b, 0x01eeaa55, 0x01eeab0b,
+  0x01eebc55, 0x01eef004, 0x01eef255, 0x01f00004, 0x01f02c55, 0x01f03004,
+  0x01f09455, 0x01f0a004, 0x01f0af55, 0x01f0b104, 0x01f0c055, 0x01f0c104,
+  0x01f0d055, 0x01f0d104, 0x01f0f655, 0x01f10004, 0x01f1ae55, 0x01f1e604,
+  0x01f20355, 0x01f21004, 0x01f23c55, 0x01f24004, 0x01f24955, 0x01f25004,
+  0x01f25255, 0x01f26004, 0x01f26655, 0x01f30004, 0x01f6d855, 0x01f6dd04,
+  0x01f6ed55, 0x01f6f004, 0x01f6fd55, 0x01f70004, 0x01f77455, 0x01f78004,
+  0x01f7d955, 0x01f7e004, 0x01f7ec55, 0x01f7f004, 0x01f7f155, 0x01f80004,
+  0x01f80c55, 0x01f81004, 0x01f84855, 0x01f85004, 0x01f85a55, 0x01f86004,
+  0x01f88855, 0x01f89004, 0x01f8ae55, 0x01f8b004, 0x01f8b255, 0x01f90004,
+  0x01fa5455, 0x01fa6004, 0x01fa6e55, 0x01fa7004, 0x01fa7555, 0x01fa7804,
+  0x01fa7d55, 0x01fa8004, 0x01fa8755, 0x01fa9004, 0x01faad55, 0x01fab004,
+  0x01fabb55, 0x01fac004, 0x01fac655, 0x01fad004, 0x01fada55, 0x01fae004,
+  0x01fae855, 0x01faf004, 0x01faf755, 0x01fb0004, 0x01fb9355, 0x01fb9404,
+  0x01fbcb55, 0x01fbf00b, 0x01fbfa55, 0x0200000b, 0x02a6e055, 0x02a7000b,
+  0x02b73955, 0x02b7400b, 0x02b81e55, 0x02b8200b, 0x02cea255, 0x02ceb00b,
+  0x02ebe155, 0x02f8000b, 0x02fa1e55, 0x0300000b, 0x03134b55, 0x0e000104,
+  0x0e000255, 0x0e002004, 0x0e008055, 0x0e010004, 0x0e01f055, 0x0f000004,
+  0x0ffffe55, 0x10000004, 0x10fffe55,
+};
+
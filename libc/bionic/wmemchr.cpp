@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <stdint.h>
+#include <wchar.h>
+
+#include "private/bionic_wide_vector.h"
+
+wchar_t* wmemchr(const wchar_t* s, wchar_t c, size_t n) {
+  if (n == 0) return nullptr;
+  if (!wchar_aligned(s)) {
+    for (; n != 0; --n, ++s) {
+      if (*s == c) return const_cast<wchar_t*>(s);
+    }
+    return nullptr;
+  }
+
+  // Count what's left from the aligned start. Callers sometimes pass a huge
+  // n when they know there's a match, so don't let that overflow.
+  const wide4 c4 = wide4_splat(c);
+  const wchar_t* p = wide4_align(s);
+  size_t skipped = s - p;
+  size_t remaining = (n > SIZE_MAX - skipped) ? SIZE_MAX : n + skipped;
+  wide4 hits = wide4_from(wide4_load(p) == c4, s);
+  while (!wide4_any(hits)) {
+    if (remaining <= kWide4Lanes) return nullptr;
+    remaining -= kWide4Lanes;
+    p += kWide4Lanes;
+    if (wide4_unroll_aligned(p)) {
+      // Four blocks at a time, as in wcslen, while there's more to come after them.
+      while (remaining > kWide4Unroll * kWide4Lanes &&
+             !wide4_any((wide4_load(p) == c4) | (wide4_load(p + 4) == c4) |
+                        (wide4_load(p + 8) == c4) | (wide4_load(p + 12) == c4))) {
+        remaining -= kWide4Unroll * kWide4Lanes;
+        p += kWide4Unroll * kWide4Lanes;
+      }
+    }
+    hits = wide4_load(p) == c4;
+  }
+  size_t i = wide4_first(hits);
+  return (i < remaining) ? const_cast<wchar_t*>(p + i) : nullptr;
+}
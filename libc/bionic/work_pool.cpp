@@ -0,0 +1,468 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <android/work_pool.h>
+
+#include <errno.h>
+#include <limits.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "pthread_internal.h"
+
+#include "private/bionic_futex.h"
+#include "private/bionic_lock.h"
+#include "private/bionic_macros.h"
+
+// The pool has a worker for each CPU in the affinity mask of the thread that starts it, up to
+// this many. Each worker is pinned to its CPU.
+static constexpr size_t kMaxWorkers = 64;
+
+// Tasks a worker's own queue can hold. Tasks that don't fit go onto the shared queue.
+static constexpr uint32_t kWorkerQueueSize = 256;
+
+// How many times an idle worker looks for a task before it sleeps.
+static constexpr int kIdleSpinCount = 64;
+
+// The android_work_group_t pending word counts unfinished tasks in the low bits, and the
+// threads in android_work_pool_wait in the high bits. Keeping both in one word means that the
+// thread finishing the last task knows whether to wake anyone without touching the group
+// afterwards, when a waiter may already have returned and freed it.
+#define WORK_GROUP_TASKS_MASK    0x00ffffffu
+#define WORK_GROUP_WAITER_STEP   0x01000000u
+
+struct work_group_internal_t {
+  atomic_uint pending;
+  uint32_t __reserved;
+};
+
+static_assert(sizeof(android_work_group_t) == sizeof(work_group_internal_t),
+              "android_work_group_t should actually be work_group_internal_t in implementation.");
+
+static work_group_internal_t* __get_internal_work_group(android_work_group_t* group_interface) {
+  return reinterpret_cast<work_group_internal_t*>(group_interface);
+}
+
+typedef void (*WorkPoolFn)(void*);
+
+struct WorkPoolTask {
+  WorkPoolFn fn;
+  void* arg;
+  work_group_internal_t* group;
+  WorkPoolTask* next;
+};
+
+// Thieves may read a slot while its owner overwrites it. They throw away what they read in
+// that case, but the fields still have to be atomic.
+struct WorkPoolSlot {
+  _Atomic(WorkPoolFn) fn;
+  _Atomic(void*) arg;
+  _Atomic(work_group_internal_t*) group;
+};
+
+struct WorkPool;
+
+// A worker's queue is a Chase-Lev deque: its owner pushes and takes tasks at the bottom, other
+// threads steal them from the top. Only taking the last task needs a compare_exchange against
+// thieves. See "Correct and Efficient Work-Stealing for Weak Memory Models", Lê et al., 2013.
+class WorkPoolWorker {
+ public:
+  WorkPool* pool;
+  size_t index;
+  int cpu;
+  uint32_t steal_seed;
+
+  bool Push(const WorkPoolTask& task) {
+    uint32_t b = atomic_load_explicit(&bottom_, memory_order_relaxed);
+    uint32_t t = atomic_load_explicit(&top_, memory_order_acquire);
+    if (b - t >= kWorkerQueueSize) {
+      return false;
+    }
+    WorkPoolSlot& slot = slots_[b % kWorkerQueueSize];
+    atomic_store_explicit(&slot.fn, task.fn, memory_order_relaxed);
+    atomic_store_explicit(&slot.arg, task.arg, memory_order_relaxed);
+    atomic_store_explicit(&slot.group, task.group, memory_order_relaxed);
+    atomic_store_explicit(&bottom_, b + 1, memory_order_release);
+    return true;
+  }
+
+  bool Take(WorkPoolTask* task) {
+    uint32_t b = atomic_load_explicit(&bottom_, memory_order_relaxed) - 1;
+    atomic_store_explicit(&bottom_, b, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    uint32_t t = atomic_load_explicit(&top_, memory_order_relaxed);
+    if (static_cast<int32_t>(b - t) < 0) {
+      atomic_store_explicit(&bottom_, b + 1, memory_order_relaxed);
+      return false;
+    }
+    Read(b, task);
+    if (b != t) {
+      return true;
+    }
+    bool won = atomic_compare_exchange_strong_explicit(&top_, &t, t + 1, memory_order_seq_cst,
+                                                       memory_order_relaxed);
+    atomic_store_explicit(&bottom_, b + 1, memory_order_relaxed);
+    return won;
+  }
+
+  bool Steal(WorkPoolTask* task) {
+    while (true) {
+      uint32_t t = atomic_load_explicit(&top_, memory_order_acquire);
+      atomic_thread_fence(memory_order_seq_cst);
+      uint32_t b = atomic_load_explicit(&bottom_, memory_order_acquire);
+      if (static_cast<int32_t>(b - t) <= 0) {
+        return false;
+      }
+      Read(t, task);
+      if (atomic_compare_exchange_strong_explicit(&top_, &t, t + 1, memory_order_seq_cst,
+                                                  memory_order_relaxed)) {
+        return true;
+      }
+    }
+  }
+
+  size_t NextVictim() {
+    // xorshift32, so that idle workers don't all go after the same victim.
+    steal_seed ^= steal_seed << 13;
+    steal_seed ^= steal_seed >> 17;
+    steal_seed ^= steal_seed << 5;
+    return steal_seed;
+  }
+
+ private:
+  void Read(uint32_t i, WorkPoolTask* task) {
+    WorkPoolSlot& slot = slots_[i % kWorkerQueueSize];
+    task->fn = atomic_load_explicit(&slot.fn, memory_order_relaxed);
+    task->arg = atomic_load_explicit(&slot.arg, memory_order_relaxed);
+    task->group = atomic_load_explicit(&slot.group, memory_order_relaxed);
+  }
+
+  // top_ is written by thieves and bottom_ by the owner, so keep them on separate cache lines.
+  alignas(64) atomic_uint top_;
+  alignas(64) atomic_uint bottom_;
+  WorkPoolSlot slots_[kWorkerQueueSize];
+};
+
+struct WorkPool {
+  // The pool's threads don't survive fork, so a child process starts a new pool.
+  pid_t pid;
+  size_t worker_count;
+  size_t started_count;
+  WorkPoolWorker* workers;
+
+  // Tasks spawned by threads that aren't workers, or that didn't fit in a worker's queue.
+  Lock shared_lock;
+  WorkPoolTask* shared_head;
+  WorkPoolTask* shared_tail;
+  atomic_uint shared_count;
+
+  // Idle workers, and threads in android_work_pool_wait with nothing left to run, sleep on
+  // idle_epoch. It's incremented before each wake so that a thread about to go to sleep
+  // notices it missed one.
+  atomic_int idle_epoch;
+  atomic_uint idle_count;
+};
+
+static Lock g_work_pool_lock;
+static _Atomic(WorkPool*) g_work_pool;
+
+static bool PushSharedTask(WorkPool* pool, const WorkPoolTask& task) {
+  WorkPoolTask* node = reinterpret_cast<WorkPoolTask*>(malloc(sizeof(WorkPoolTask)));
+  if (node == nullptr) {
+    return false;
+  }
+  *node = task;
+  node->next = nullptr;
+  pool->shared_lock.lock();
+  if (pool->shared_tail == nullptr) {
+    pool->shared_head = node;
+  } else {
+    pool->shared_tail->next = node;
+  }
+  pool->shared_tail = node;
+  atomic_fetch_add_explicit(&pool->shared_count, 1, memory_order_relaxed);
+  pool->shared_lock.unlock();
+  return true;
+}
+
+static bool PopSharedTask(WorkPool* pool, WorkPoolTask* task) {
+  if (atomic_load_explicit(&pool->shared_count, memory_order_relaxed) == 0) {
+    return false;
+  }
+  pool->shared_lock.lock();
+  WorkPoolTask* node = pool->shared_head;
+  if (node != nullptr) {
+    pool->shared_head = node->next;
+    if (pool->shared_head == nullptr) {
+      pool->shared_tail = nullptr;
+    }
+    atomic_fetch_sub_explicit(&pool->shared_count, 1, memory_order_relaxed);
+  }
+  pool->shared_lock.unlock();
+  if (node == nullptr) {
+    return false;
+  }
+  *task = *node;
+  free(node);
+  return true;
+}
+
+static WorkPoolWorker* CurrentWorker(WorkPool* pool) {
+  WorkPoolWorker* worker = __get_thread()->work_pool_worker;
+  return (worker != nullptr && worker->pool == pool) ? worker : nullptr;
+}
+
+// Looks for a task in the current worker's own queue first, then in the shared queue, then
+// in the other workers' queues. self is null if the current thread isn't a worker.
+static bool FindTask(WorkPool* pool, WorkPoolWorker* self, WorkPoolTask* task) {
+  if (self != nullptr && self->Take(task)) {
+    return true;
+  }
+  if (PopSharedTask(pool, task)) {
+    return true;
+  }
+  size_t start = (self != nullptr) ? self->NextVictim() : __get_thread()->tid;
+  for (size_t i = 0; i < pool->worker_count; ++i) {
+    WorkPoolWorker* victim = &pool->workers[(start + i) % pool->worker_count];
+    if (victim != self && victim->Steal(task)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static void WakeIdleThread(WorkPool* pool) {
+  // Pairs with the fence in ParkOrFindTask: either the sleeper sees the new task, or we see it
+  // counted in idle_count.
+  atomic_thread_fence(memory_order_seq_cst);
+  if (atomic_load_explicit(&pool->idle_count, memory_order_relaxed) != 0) {
+    atomic_fetch_add_explicit(&pool->idle_epoch, 1, memory_order_relaxed);
+    __futex_wake_ex(&pool->idle_epoch, false, 1);
+  }
+}
+
+static void RunTask(WorkPool* pool, const WorkPoolTask& task) {
+  task.fn(task.arg);
+  unsigned int old_pending = atomic_fetch_sub_explicit(&task.group->pending, 1,
+                                                       memory_order_seq_cst);
+  if ((old_pending & WORK_GROUP_TASKS_MASK) == 1 && old_pending >= WORK_GROUP_WAITER_STEP) {
+    // The waiters sleep with the idle workers, and we don't know which ones they are.
+    atomic_fetch_add_explicit(&pool->idle_epoch, 1, memory_order_seq_cst);
+    __futex_wake_ex(&pool->idle_epoch, false, INT_MAX);
+  }
+}
+
+// Sleeps until there may be a task to run, or until group (if not null) has finished.
+// Returns true if it found a task while getting ready to sleep instead.
+static bool ParkOrFindTask(WorkPool* pool, WorkPoolWorker* self, work_group_internal_t* group,
+                           WorkPoolTask* task) {
+  atomic_fetch_add_explicit(&pool->idle_count, 1, memory_order_relaxed);
+  atomic_thread_fence(memory_order_seq_cst);
+  int epoch = atomic_load_explicit(&pool->idle_epoch, memory_order_relaxed);
+  bool found = FindTask(pool, self, task);
+  if (!found && (group == nullptr ||
+      (atomic_load_explicit(&group->pending, memory_order_acquire) & WORK_GROUP_TASKS_MASK) != 0)) {
+    __futex_wait_ex(&pool->idle_epoch, false, epoch, false, nullptr);
+  }
+  atomic_fetch_sub_explicit(&pool->idle_count, 1, memory_order_relaxed);
+  return found;
+}
+
+static void* WorkPoolWorkerMain(void* arg) {
+  WorkPoolWorker* self = reinterpret_cast<WorkPoolWorker*>(arg);
+  WorkPool* pool = self->pool;
+  __get_thread()->work_pool_worker = self;
+
+  if (self->cpu != -1) {
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    CPU_SET(self->cpu, &cpu_set);
+    sched_setaffinity(0, sizeof(cpu_set), &cpu_set);
+  }
+  char name[16];
+  snprintf(name, sizeof(name), "work_pool:%zu", self->index);
+  pthread_setname_np(pthread_self(), name);
+
+  while (true) {
+    WorkPoolTask task;
+    bool found = false;
+    for (int i = 0; !found && i < kIdleSpinCount; ++i) {
+      found = FindTask(pool, self, &task);
+    }
+    if (found || ParkOrFindTask(pool, self, nullptr, &task)) {
+      RunTask(pool, task);
+    }
+  }
+  return nullptr;
+}
+
+static WorkPool* StartWorkPool() {
+  cpu_set_t allowed;
+  long cpu_count;
+  bool pin = (sched_getaffinity(0, sizeof(allowed), &allowed) == 0);
+  if (pin) {
+    cpu_count = CPU_COUNT(&allowed);
+  } else {
+    cpu_count = sysconf(_SC_NPROCESSORS_ONLN);
+  }
+  size_t worker_count = 1;
+  if (cpu_count > static_cast<long>(kMaxWorkers)) {
+    worker_count = kMaxWorkers;
+  } else if (cpu_count > 1) {
+    worker_count = cpu_count;
+  }
+
+  size_t workers_offset = BIONIC_ALIGN(sizeof(WorkPool), alignof(WorkPoolWorker));
+  size_t mmap_size = BIONIC_ALIGN(workers_offset + worker_count * sizeof(WorkPoolWorker),
+                                  PAGE_SIZE);
+  void* mem = mmap(nullptr, mmap_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS,
+                   -1, 0);
+  if (mem == MAP_FAILED) {
+    return nullptr;
+  }
+
+  // The mapping is zero-filled, which is how everything in the pool starts out.
+  WorkPool* pool = reinterpret_cast<WorkPool*>(mem);
+  pool->pid = getpid();
+  pool->worker_count = worker_count;
+  pool->workers = reinterpret_cast<WorkPoolWorker*>(reinterpret_cast<char*>(mem) + workers_offset);
+  pool->shared_lock.init(false);
+
+  int cpu = -1;
+  for (size_t i = 0; i < worker_count; ++i) {
+    WorkPoolWorker* worker = &pool->workers[i];
+    worker->pool = pool;
+    worker->index = i;
+    worker->steal_seed = i + 1;
+    if (pin) {
+      do {
+        ++cpu;
+      } while (!CPU_ISSET(cpu, &allowed));
+    }
+    worker->cpu = cpu;
+  }
+
+  pthread_attr_t attr;
+  pthread_attr_init(&attr);
+  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+  for (size_t i = 0; i < worker_count; ++i) {
+    pthread_t thread;
+    if (pthread_create(&thread, &attr, WorkPoolWorkerMain, &pool->workers[i]) != 0) {
+      break;
+    }
+    ++pool->started_count;
+  }
+  pthread_attr_destroy(&attr);
+
+  // Workers that didn't start just have queues that stay empty. If none started, there's no
+  // pool, and tasks are run by the threads spawning them.
+  if (pool->started_count == 0) {
+    munmap(mem, mmap_size);
+    return nullptr;
+  }
+  return pool;
+}
+
+static WorkPool* GetWorkPool() {
+  WorkPool* pool = atomic_load_explicit(&g_work_pool, memory_order_acquire);
+  if (__predict_true(pool != nullptr && pool->pid == getpid())) {
+    return pool;
+  }
+
+  g_work_pool_lock.lock();
+  pool = atomic_load_explicit(&g_work_pool, memory_order_relaxed);
+  if (pool == nullptr || pool->pid != getpid()) {
+    // In a child process, the parent's pool is leaked along with any tasks still queued in it.
+    pool = StartWorkPool();
+    if (pool != nullptr) {
+      atomic_store_explicit(&g_work_pool, pool, memory_order_release);
+    }
+  }
+  g_work_pool_lock.unlock();
+  return pool;
+}
+
+int android_work_pool_spawn(android_work_group_t* group_interface, void (*fn)(void*), void* arg) {
+  if (group_interface == nullptr || fn == nullptr) {
+    return EINVAL;
+  }
+  work_group_internal_t* group = __get_internal_work_group(group_interface);
+
+  WorkPool* pool = GetWorkPool();
+  if (pool == nullptr) {
+    fn(arg);
+    return 0;
+  }
+
+  atomic_fetch_add_explicit(&group->pending, 1, memory_order_relaxed);
+  WorkPoolTask task = { fn, arg, group, nullptr };
+  WorkPoolWorker* self = CurrentWorker(pool);
+  if ((self != nullptr && self->Push(task)) || PushSharedTask(pool, task)) {
+    WakeIdleThread(pool);
+  } else {
+    RunTask(pool, task);
+  }
+  return 0;
+}
+
+int android_work_pool_wait(android_work_group_t* group_interface) {
+  if (group_interface == nullptr) {
+    return EINVAL;
+  }
+  work_group_internal_t* group = __get_internal_work_group(group_interface);
+  if ((atomic_load_explicit(&group->pending, memory_order_acquire) & WORK_GROUP_TASKS_MASK) == 0) {
+    return 0;
+  }
+
+  // Tasks are only ever pending in a pool that exists.
+  WorkPool* pool = GetWorkPool();
+  if (pool == nullptr) {
+    return 0;
+  }
+  WorkPoolWorker* self = CurrentWorker(pool);
+  atomic_fetch_add_explicit(&group->pending, WORK_GROUP_WAITER_STEP, memory_order_seq_cst);
+  while ((atomic_load_explicit(&group->pending, memory_order_acquire) &
+          WORK_GROUP_TASKS_MASK) != 0) {
+    WorkPoolTask task;
+    if (FindTask(pool, self, &task) || ParkOrFindTask(pool, self, group, &task)) {
+      RunTask(pool, task);
+    }
+  }
+  atomic_fetch_sub_explicit(&group->pending, WORK_GROUP_WAITER_STEP, memory_order_relaxed);
+  return 0;
+}
+
+size_t android_work_pool_get_worker_count() {
+  WorkPool* pool = GetWorkPool();
+  return (pool != nullptr) ? pool->started_count : 0;
+}
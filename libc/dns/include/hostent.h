@@ -44,6 +44,12 @@ void sethostent_r(FILE **);
 struct hostent	*netbsd_gethostent_r(FILE *, struct hostent *, char *, size_t, int *);
 void endhostent_r(FILE **);
 
+/*
+ * Returns a stream of just the hosts file lines that have the given name,
+ * or NULL if the hosts file itself should be read instead.
+ */
+__LIBC_HIDDEN__ FILE *_hosts_index_open(const char *);
+
 /*
  * The following are internal API's and are used only for testing.
  */
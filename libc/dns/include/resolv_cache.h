@@ -43,7 +43,9 @@ typedef enum {
     RESOLV_CACHE_UNSUPPORTED,  /* the cache can't handle that kind of queries */
                                /* or the answer buffer is too small */
     RESOLV_CACHE_NOTFOUND,     /* the cache doesn't know about this query */
-    RESOLV_CACHE_FOUND         /* the cache found the answer */
+    RESOLV_CACHE_FOUND,        /* the cache found the answer */
+    RESOLV_CACHE_FOUND_REFRESH /* the cache found the answer, but it has expired */
+                               /* or is about to: the caller should refresh it */
 } ResolvCacheStatus;
 
 __LIBC_HIDDEN__
@@ -55,6 +57,19 @@ _resolv_cache_lookup( unsigned              netid,
                       int                   answersize,
                       int                  *answerlen );
 
+/* like _resolv_cache_lookup, but if another thread is already sending the
+ * same query, return RESOLV_CACHE_NOTFOUND rather than wait for its answer.
+ * for callers that can't block, such as android_res_async_query().
+ */
+__LIBC_HIDDEN__
+extern ResolvCacheStatus
+_resolv_cache_lookup_nowait( unsigned              netid,
+                             const void*           query,
+                             int                   querylen,
+                             void*                 answer,
+                             int                   answersize,
+                             int                  *answerlen );
+
 /* add a (query,answer) to the cache, only call if _resolv_cache_lookup
  * did return RESOLV_CACHE_NOTFOUND
  */
@@ -96,6 +96,45 @@ extern void _resolv_flush_cache_for_net(unsigned netid) __used_in_netd;
 /* delete the cache associated with a certain network */
 extern void _resolv_delete_cache_for_net(unsigned netid) __used_in_netd;
 
+/* limit the memory used by a network's cache to max_bytes, or the default if 0. The network's
+ * name servers must have been set. Returns 0 or an errno value. */
+extern int _resolv_set_cache_size_for_net(unsigned netid, size_t max_bytes) __used_in_netd;
+
+/* let a network's cache answer with an entry for up to grace_seconds after it expires while the
+ * entry is refreshed in the background, and refresh popular entries shortly before they expire.
+ * 0, the default, turns this off. Returns 0 or an errno value. */
+extern int _resolv_set_cache_stale_for_net(unsigned netid, unsigned grace_seconds) __used_in_netd;
+
+/*
+ * A non-blocking resolver, for event loops that can't spare a thread per lookup. Any number of
+ * queries can be in flight on one android_res_async, which sends them all on the same sockets and
+ * uses the same cache as res_nsend(). An android_res_async isn't thread-safe.
+ *
+ * The callback gets error 0 and the answer, which is only valid until the callback returns, or
+ * an errno value: ETIMEDOUT if no server answered, ECONNREFUSED if they all answered SERVFAIL,
+ * NOTIMP or REFUSED. A truncated answer is passed on as it is, with TC set.
+ */
+struct android_res_async;
+typedef void (*android_res_async_callback)(void *cookie, int error, const u_char *answer,
+    int anslen);
+
+/* Returns a resolver for the given network, or NULL with errno set. */
+struct android_res_async *android_res_async_create(unsigned netid, unsigned mark) __used_in_netd;
+/* Returns the fd to poll for input. Call android_res_async_process() when it's readable. */
+int android_res_async_fd(const struct android_res_async *) __used_in_netd;
+/* Starts a query, like res_nquery(). Returns a handle for android_res_async_cancel(), or 0 if
+ * the callback has already been called with an answer from the cache, or -1 with errno set. */
+int android_res_async_query(struct android_res_async *, const char *dname, int ns_class,
+    int ns_type, android_res_async_callback callback, void *cookie) __used_in_netd;
+/* Reads answers, resends queries that have timed out, and calls the callbacks of those that
+ * are done. */
+void android_res_async_process(struct android_res_async *) __used_in_netd;
+/* Forgets a query without calling its callback. Returns 0, or -1 with errno set to ENOENT if the
+ * callback has already been called or is about to be. */
+int android_res_async_cancel(struct android_res_async *, int handle) __used_in_netd;
+/* Forgets all queries in flight, without calling their callbacks, and frees the resolver. */
+void android_res_async_destroy(struct android_res_async *) __used_in_netd;
+
 /* Internal use only. */
 struct hostent *android_gethostbyaddrfornet_proxy(const void *, socklen_t, int , unsigned, unsigned) __LIBC_HIDDEN__;
 int android_getnameinfofornet(const struct sockaddr *, socklen_t, char *, size_t, char *, size_t, int, unsigned, unsigned) __LIBC_HIDDEN__;
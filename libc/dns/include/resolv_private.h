@@ -211,14 +211,22 @@ extern int
 _resolv_cache_get_resolver_stats( unsigned netid, struct __res_params* params,
         struct __res_stats stats[MAXNS]);
 
-/* Add a sample to the shared struct for the given netid and server, provided that the
- * revision_id of the stored servers has not changed.
+/* Count an attempt to send a query to the given server, and add its sample to the shared struct
+ * for the given netid if max_samples is positive, provided that the revision_id of the stored
+ * servers has not changed.
  */
 __LIBC_HIDDEN__
 extern void
 _resolv_cache_add_resolver_stats_sample( unsigned netid, int revision_id, int ns,
         const struct __res_sample* sample, int max_samples);
 
+/* Count a query sent to the given netid's servers, which took latency ms to be answered or to
+ * fail.
+ */
+__LIBC_HIDDEN__
+extern void
+_resolv_cache_add_query_stats( unsigned netid, int latency, int answered);
+
 /* End of stats related definitions */
 
 union res_sockaddr_union {
@@ -271,6 +279,7 @@ union res_sockaddr_union {
 #define	RES_NOCHECKNAME	0x00008000	/* do not check names for sanity. */
 #define	RES_KEEPTSIG	0x00010000	/* do not strip TSIG records */
 #define	RES_BLAST	0x00020000	/* blast all recursive servers */
+#define	RES_PARALLEL	0x00040000	/* also ask the next server if one is slow */
 #define RES_NOTLDQUERY	0x00100000	/* don't unqualified name as a tld */
 #define RES_USE_DNSSEC	0x00200000	/* use DNSSEC using OK bit in OPT */
 /* #define RES_DEBUG2	0x00400000 */	/* nslookup internal */
@@ -488,6 +497,8 @@ int		res_nmkquery(res_state, int, const char *, int, int,
 				  const u_char *, int, const u_char *,
 				  u_char *, int);
 int		res_nsend(res_state, const u_char *, int, u_char *, int);
+__LIBC_HIDDEN__ int		res_nsend_pair(res_state, const u_char *, int, u_char *, int,
+				    int *, const u_char *, int, u_char *, int, int *);
 int		res_nsendsigned(res_state, const u_char *, int,
 				     ns_tsig_key *, u_char *, int);
 int		res_findzonecut(res_state, const char *, ns_class, int,
@@ -61,6 +61,50 @@ _res_stats_set_sample(struct __res_sample* sample, time_t now, int rcode, int rt
 extern bool
 _res_stats_usable_server(const struct __res_params* params, struct __res_stats* stats);
 
+/* Counters for a network's DNS cache. */
+struct __res_cache_counters {
+    uint64_t			hits;       // lookups answered from the cache
+    uint64_t			misses;     // lookups that weren't
+    uint64_t			evictions;  // entries removed to make room, rather than expired
+    uint64_t			stale_hits; // hits answered with an expired entry
+    uint64_t			refreshes;  // hits that started a refresh of their entry
+    uint32_t			entries;    // entries in the cache now
+    uint32_t			bytes;      // memory used by them
+    uint32_t			max_bytes;  // see _resolv_set_cache_size_for_net()
+};
+
+/* Round-trip times and query latencies are counted in buckets by powers of two: bucket 0 has
+ * those under 1ms, bucket i those from 2^(i-1) up to 2^i ms, and the last bucket all the rest.
+ */
+#define RES_RTT_BUCKETS 14
+
+/* Counters for one of a network's servers, since the network's servers were last set. */
+struct __res_server_counters {
+    uint64_t			attempts;        // queries sent to it, including retries
+    // The outcomes of the attempts, told apart as android_net_res_stats_aggregate() does.
+    uint64_t			successes;
+    uint64_t			errors;
+    uint64_t			timeouts;
+    uint64_t			internal_errors;
+    uint32_t			rtt[RES_RTT_BUCKETS]; // round-trip times of the successes and errors
+};
+
+/* Counters for a network's queries. */
+struct __res_net_counters {
+    struct __res_cache_counters	cache;
+    uint64_t			queries;   // queries sent to the servers: cache misses and refreshes
+    uint64_t			failures;  // queries that got no answer
+    uint64_t			retries;   // attempts beyond the first for each query
+    uint32_t			latency[RES_RTT_BUCKETS]; // time to each query's answer or failure
+    int				nscount;
+    struct sockaddr_storage	servers[MAXNS];
+    struct __res_server_counters server_counters[MAXNS];
+};
+
+/* Returns the bucket that counts a round-trip time or latency of rtt ms. */
+extern int
+_res_stats_rtt_bucket(int rtt);
+
 __BEGIN_DECLS
 /* Aggregates the reachability statistics for the given server based on on the stored samples. */
 extern void
@@ -74,6 +118,25 @@ android_net_res_stats_get_info_for_net(unsigned netid, int* nscount,
         struct __res_params* params, struct __res_stats stats[MAXNS])
     __attribute__((visibility ("default")));
 
+/* Reads the counters of the given network's cache. Returns 0, or -1 with errno set to ENOENT if
+ * there is no such network.
+ */
+extern int
+android_net_res_cache_get_counters_for_net(unsigned netid, struct __res_cache_counters* counters)
+    __attribute__((visibility ("default")));
+
+/* Reads the counters of the given network's cache, queries and servers. Returns 0, or -1 with
+ * errno set to ENOENT if there is no such network.
+ */
+extern int
+android_net_res_stats_get_counters_for_net(unsigned netid, struct __res_net_counters* counters)
+    __attribute__((visibility ("default")));
+
+/* Writes the counters of every network to fd as text, for dumpsys. */
+extern void
+android_net_res_stats_dump(int fd)
+    __attribute__((visibility ("default")));
+
 /* Returns an array of bools indicating which servers are considered good */
 extern void
 android_net_res_stats_get_usable_servers(const struct __res_params* params,
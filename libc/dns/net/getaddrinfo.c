@@ -93,6 +93,7 @@
 #include <errno.h>
 #include <netdb.h>
 #include "NetdClientDispatch.h"
+#include "hostent.h"
 #include "resolv_cache.h"
 #include "resolv_netid.h"
 #include "resolv_private.h"
@@ -106,8 +107,11 @@
 
 #include <syslog.h>
 #include <stdarg.h>
+#include <stdatomic.h>
 #include "nsswitch.h"
 
+#include "private/bionic_scratch.h"
+
 #if defined(__BIONIC__)
 #include <sys/system_properties.h>
 #endif
@@ -216,6 +220,45 @@ struct res_target {
 	int n;			/* result length */
 };
 
+/*
+ * Result lists are allocated in one block, so that a lookup returning many
+ * addresses costs one malloc and freeaddrinfo() one free.  Each entry is a
+ * struct ai_packed followed by its address and, if it has one, its
+ * canonical name.  The block goes when the last of its entries is freed,
+ * so freeing sublists (which POSIX allows) still works.
+ */
+struct ai_block {
+	atomic_int live;	/* entries not yet freed */
+};
+
+struct ai_packed {
+	struct addrinfo ai;
+	struct ai_block *block;
+	/* While the block is being built, its pointers are offsets. */
+	size_t next_off;
+	size_t name_off;
+};
+
+#define AI_BLOCK_HDRLEN	ALIGN(sizeof(struct ai_block))
+
+/* Entries allocated one at a time have their address right after them. */
+#define _ai_is_packed(ai) \
+	((ai)->ai_addr == (struct sockaddr *)(void *)((struct ai_packed *)(void *)(ai) + 1))
+
+struct ai_builder {
+	char *buf;
+	size_t len, cap;
+	size_t first, last;	/* offsets of the first and last entries */
+	int count;
+};
+
+static void _ai_init(struct ai_builder *, size_t);
+static struct addrinfo *_ai_add(struct ai_builder *,
+	const struct addrinfo *, socklen_t);
+static char *_ai_add_name(struct ai_builder *, size_t, size_t);
+static struct addrinfo *_ai_finish(struct ai_builder *);
+static struct addrinfo *_ai_pack(struct addrinfo *);
+
 static int str2number(const char *);
 static int explore_fqdn(const struct addrinfo *, const char *,
 	const char *, struct addrinfo **, const struct android_net_context *);
@@ -236,8 +279,8 @@ static const struct afd *find_afd(int);
 static int ip6_str2scopeid(char *, struct sockaddr_in6 *, u_int32_t *);
 #endif
 
-static struct addrinfo *getanswer(const querybuf *, int, const char *, int,
-	const struct addrinfo *);
+static int getanswer(const querybuf *, int, const char *, int,
+	const struct addrinfo *, struct ai_builder *);
 static int _dns_getaddrinfo(void *, void *, va_list);
 static void _sethtent(FILE **);
 static void _endhtent(FILE **);
@@ -324,6 +367,7 @@ void
 freeaddrinfo(struct addrinfo *ai)
 {
 	struct addrinfo *next;
+	struct ai_block *block;
 
 #if defined(__BIONIC__)
 	if (ai == NULL) return;
@@ -333,14 +377,182 @@ freeaddrinfo(struct addrinfo *ai)
 
 	do {
 		next = ai->ai_next;
-		if (ai->ai_canonname)
-			free(ai->ai_canonname);
-		/* no need to free(ai->ai_addr) */
-		free(ai);
+		if (_ai_is_packed(ai)) {
+			block = ((struct ai_packed *)(void *)ai)->block;
+			if (atomic_fetch_sub(&block->live, 1) == 1)
+				free(block);
+		} else {
+			if (ai->ai_canonname)
+				free(ai->ai_canonname);
+			/* no need to free(ai->ai_addr) */
+			free(ai);
+		}
 		ai = next;
 	} while (ai);
 }
 
+static void
+_ai_init(struct ai_builder *b, size_t cap)
+{
+
+	memset(b, 0, sizeof(*b));
+	b->len = AI_BLOCK_HDRLEN;
+	if (cap != 0) {
+		b->buf = malloc(cap);
+		if (b->buf != NULL)
+			b->cap = cap;
+	}
+}
+
+/* Returns the offset of len bytes of new space, or 0 if out of memory. */
+static size_t
+_ai_alloc(struct ai_builder *b, size_t len)
+{
+	size_t off, cap;
+	char *buf;
+
+	len = ALIGN(len);
+	if (b->len + len > b->cap) {
+		cap = b->cap ? b->cap * 2 : 512;
+		while (b->len + len > cap)
+			cap *= 2;
+		buf = realloc(b->buf, cap);
+		if (buf == NULL)
+			return 0;
+		b->buf = buf;
+		b->cap = cap;
+	}
+	off = b->len;
+	b->len += len;
+	return off;
+}
+
+/*
+ * Appends an entry for an address of addrlen bytes, which is zeroed.  The
+ * returned entry (and its ai_addr) is only good until the next call.
+ */
+static struct addrinfo *
+_ai_add(struct ai_builder *b, const struct addrinfo *pai, socklen_t addrlen)
+{
+	struct ai_packed *ap;
+	size_t off;
+
+	off = _ai_alloc(b, sizeof(*ap) + addrlen);
+	if (off == 0)
+		return NULL;
+	ap = (struct ai_packed *)(void *)(b->buf + off);
+	memset(ap, 0, sizeof(*ap) + addrlen);
+	ap->ai.ai_flags = pai->ai_flags;
+	ap->ai.ai_family = pai->ai_family;
+	ap->ai.ai_socktype = pai->ai_socktype;
+	ap->ai.ai_protocol = pai->ai_protocol;
+	ap->ai.ai_addrlen = addrlen;
+	ap->ai.ai_addr = (struct sockaddr *)(void *)(ap + 1);
+	if (b->last != 0)
+		((struct ai_packed *)(void *)(b->buf + b->last))->next_off = off;
+	else
+		b->first = off;
+	b->last = off;
+	b->count++;
+	return &ap->ai;
+}
+
+/* Makes room for the canonical name of the entry at offset entry. */
+static char *
+_ai_add_name(struct ai_builder *b, size_t entry, size_t len)
+{
+	size_t off;
+
+	off = _ai_alloc(b, len);
+	if (off == 0)
+		return NULL;
+	((struct ai_packed *)(void *)(b->buf + entry))->name_off = off;
+	return b->buf + off;
+}
+
+/* Returns the finished list, or NULL if it's empty. */
+static struct addrinfo *
+_ai_finish(struct ai_builder *b)
+{
+	struct ai_block *block;
+	struct ai_packed *ap;
+	size_t off;
+	char *buf;
+
+	if (b->count == 0) {
+		free(b->buf);
+		return NULL;
+	}
+	buf = realloc(b->buf, b->len);
+	if (buf != NULL)
+		b->buf = buf;
+	block = (struct ai_block *)(void *)b->buf;
+	atomic_init(&block->live, b->count);
+	for (off = b->first; off != 0; off = ap->next_off) {
+		ap = (struct ai_packed *)(void *)(b->buf + off);
+		ap->block = block;
+		ap->ai.ai_addr = (struct sockaddr *)(void *)(ap + 1);
+		ap->ai.ai_canonname = ap->name_off ? b->buf + ap->name_off : NULL;
+		ap->ai.ai_next = ap->next_off ?
+		    (struct addrinfo *)(void *)(b->buf + ap->next_off) : NULL;
+	}
+	return (struct addrinfo *)(void *)(b->buf + b->first);
+}
+
+/*
+ * Copies a list built from separately allocated entries, or from more
+ * than one block, into a single block.  If that fails the list is
+ * returned as it was.
+ */
+static struct addrinfo *
+_ai_pack(struct addrinfo *list)
+{
+	struct ai_builder b;
+	struct ai_block *block;
+	struct addrinfo *ai, *copy;
+	size_t len, n;
+	char *name;
+
+	block = NULL;
+	for (ai = list; ai; ai = ai->ai_next) {
+		if (!_ai_is_packed(ai))
+			break;
+		if (block != NULL &&
+		    ((struct ai_packed *)(void *)ai)->block != block)
+			break;
+		block = ((struct ai_packed *)(void *)ai)->block;
+	}
+	if (ai == NULL)
+		return list;
+
+	len = AI_BLOCK_HDRLEN;
+	for (ai = list; ai; ai = ai->ai_next) {
+		len += ALIGN(sizeof(struct ai_packed) + ai->ai_addrlen);
+		if (ai->ai_canonname)
+			len += ALIGN(strlen(ai->ai_canonname) + 1);
+	}
+	_ai_init(&b, len);
+	for (ai = list; ai; ai = ai->ai_next) {
+		copy = _ai_add(&b, ai, ai->ai_addrlen);
+		if (copy == NULL)
+			goto nomem;
+		memcpy(copy->ai_addr, ai->ai_addr, (size_t)ai->ai_addrlen);
+		if (ai->ai_canonname) {
+			n = strlen(ai->ai_canonname) + 1;
+			name = _ai_add_name(&b, b.last, n);
+			if (name == NULL)
+				goto nomem;
+			memcpy(name, ai->ai_canonname, n);
+		}
+	}
+	freeaddrinfo(list);
+	return _ai_finish(&b);
+
+ nomem:
+	free(b.buf);
+	return list;
+}
+
 static int
 str2number(const char *p)
 {
@@ -407,10 +619,10 @@ android_getaddrinfo_proxy(
 {
 	int success = 0;
 
-	// Clear this at start, as we use its non-NULLness later (in the
-	// error path) to decide if we have to free up any memory we
-	// allocated in the process (before failing).
+	struct ai_builder builder;
+
 	*res = NULL;
+	_ai_init(&builder, 0);
 
 	// Bogus things we can't serialize.  Don't use the proxy.  These will fail - let them.
 	if ((hostname != NULL &&
@@ -457,8 +669,7 @@ android_getaddrinfo_proxy(
 		goto exit;
 	}
 
-	struct addrinfo* ai = NULL;
-	struct addrinfo** nextres = res;
+	// Entries are read straight into the block that becomes the result.
 	while (1) {
 		int32_t have_more;
 		if (!readBE32(proxy, &have_more)) {
@@ -469,12 +680,6 @@ android_getaddrinfo_proxy(
 			break;
 		}
 
-		struct addrinfo* ai = calloc(1, sizeof(struct addrinfo) + sizeof(struct sockaddr_storage));
-		if (ai == NULL) {
-			break;
-		}
-		ai->ai_addr = (struct sockaddr*)(ai + 1);
-
 		// struct addrinfo {
 		//	int	ai_flags;	/* AI_PASSIVE, AI_CANONNAME, AI_NUMERICHOST */
 		//	int	ai_family;	/* PF_xxx */
@@ -488,71 +693,68 @@ android_getaddrinfo_proxy(
 
 		// Read the struct piece by piece because we might be a 32-bit process
 		// talking to a 64-bit netd.
+		struct addrinfo hdr;
 		int32_t addr_len;
 		bool success =
-				readBE32(proxy, &ai->ai_flags) &&
-				readBE32(proxy, &ai->ai_family) &&
-				readBE32(proxy, &ai->ai_socktype) &&
-				readBE32(proxy, &ai->ai_protocol) &&
+				readBE32(proxy, &hdr.ai_flags) &&
+				readBE32(proxy, &hdr.ai_family) &&
+				readBE32(proxy, &hdr.ai_socktype) &&
+				readBE32(proxy, &hdr.ai_protocol) &&
 				readBE32(proxy, &addr_len);
 		if (!success) {
 			break;
 		}
+		if ((size_t) addr_len > sizeof(struct sockaddr_storage)) {
+			// Bogus; too big.
+			break;
+		}
 
 		// Set ai_addrlen and read the ai_addr data.
-		ai->ai_addrlen = addr_len;
+		struct addrinfo* ai = _ai_add(&builder, &hdr, addr_len);
+		if (ai == NULL) {
+			break;
+		}
 		if (addr_len != 0) {
-			if ((size_t) addr_len > sizeof(struct sockaddr_storage)) {
-				// Bogus; too big.
-				break;
-			}
 			if (fread(ai->ai_addr, addr_len, 1, proxy) != 1) {
 				break;
 			}
 		}
 
 		// The string for ai_cannonname.
+		size_t entry = builder.last;
 		int32_t name_len;
-		if (!readBE32(proxy, &name_len)) {
+		if (!readBE32(proxy, &name_len) || name_len < 0) {
 			break;
 		}
 		if (name_len != 0) {
-			ai->ai_canonname = (char*) malloc(name_len);
-			if (fread(ai->ai_canonname, name_len, 1, proxy) != 1) {
+			char* name = _ai_add_name(&builder, entry, name_len);
+			if (name == NULL) {
+				break;
+			}
+			if (fread(name, name_len, 1, proxy) != 1) {
 				break;
 			}
-			if (ai->ai_canonname[name_len - 1] != '\0') {
+			if (name[name_len - 1] != '\0') {
 				// The proxy should be returning this
 				// NULL-terminated.
 				break;
 			}
 		}
-
-		*nextres = ai;
-		nextres = &ai->ai_next;
-		ai = NULL;
 	}
 
-	if (ai != NULL) {
-		// Clean up partially-built addrinfo that we never ended up
-		// attaching to the response.
-		freeaddrinfo(ai);
-	}
 exit:
 	if (proxy != NULL) {
 		fclose(proxy);
 	}
 
 	if (success) {
+		*res = _ai_finish(&builder);
 		return 0;
 	}
 
 	// Proxy failed;
 	// clean up memory we might've allocated.
-	if (*res) {
-		freeaddrinfo(*res);
-		*res = NULL;
-	}
+	free(builder.buf);
 	return EAI_NODATA;
 }
 
@@ -774,7 +976,7 @@ android_getaddrinfofornetcontext(const char *hostname, const char *servname,
 	if (error == 0) {
 		if (sentinel.ai_next) {
  good:
-			*res = sentinel.ai_next;
+			*res = _ai_pack(sentinel.ai_next);
 			return SUCCESS;
 		} else
 			error = EAI_FAIL;
@@ -1290,12 +1492,16 @@ ip6_str2scopeid(char *scope, struct sockaddr_in6 *sin6, u_int32_t *scopeid)
 static const char AskedForGot[] =
 	"gethostby*.getanswer: asked for \"%s\", got \"%s\"";
 
-static struct addrinfo *
+/*
+ * Adds the addresses in the answer to b, and returns how many there were.
+ */
+static int
 getanswer(const querybuf *answer, int anslen, const char *qname, int qtype,
-    const struct addrinfo *pai)
+    const struct addrinfo *pai, struct ai_builder *b)
 {
-	struct addrinfo sentinel, *cur;
+	struct addrinfo *cur;
 	struct addrinfo ai;
+	size_t first;
 	const struct afd *afd;
 	char *canonname;
 	const HEADER *hp;
@@ -1313,9 +1519,7 @@ getanswer(const querybuf *answer, int anslen, const char *qname, int qtype,
 	assert(qname != NULL);
 	assert(pai != NULL);
 
-	memset(&sentinel, 0, sizeof(sentinel));
-	cur = &sentinel;
-
+	first = 0;
 	canonname = NULL;
 	eom = answer->buf + anslen;
 	switch (qtype) {
@@ -1325,7 +1529,7 @@ getanswer(const querybuf *answer, int anslen, const char *qname, int qtype,
 		name_ok = res_hnok;
 		break;
 	default:
-		return NULL;	/* XXX should be abort(); */
+		return 0;	/* XXX should be abort(); */
 	}
 	/*
 	 * find first satisfactory answer
@@ -1338,12 +1542,12 @@ getanswer(const querybuf *answer, int anslen, const char *qname, int qtype,
 	cp = answer->buf + HFIXEDSZ;
 	if (qdcount != 1) {
 		h_errno = NO_RECOVERY;
-		return (NULL);
+		return 0;
 	}
 	n = dn_expand(answer->buf, eom, cp, bp, ep - bp);
 	if ((n < 0) || !(*name_ok)(bp)) {
 		h_errno = NO_RECOVERY;
-		return (NULL);
+		return 0;
 	}
 	cp += n + QFIXEDSZ;
 	if (qtype == T_A || qtype == T_AAAA || qtype == T_ANY) {
@@ -1354,7 +1558,7 @@ getanswer(const querybuf *answer, int anslen, const char *qname, int qtype,
 		n = strlen(bp) + 1;		/* for the \0 */
 		if (n >= MAXHOSTNAMELEN) {
 			h_errno = NO_RECOVERY;
-			return (NULL);
+			return 0;
 		}
 		canonname = bp;
 		bp += n;
@@ -1455,11 +1659,19 @@ getanswer(const querybuf *answer, int anslen, const char *qname, int qtype,
 				cp += n;
 				continue;
 			}
-			cur->ai_next = get_ai(&ai, afd, (const char *)cp);
-			if (cur->ai_next == NULL)
+			cur = _ai_add(b, &ai, afd->a_socklen);
+			if (cur == NULL) {
 				had_error++;
-			while (cur && cur->ai_next)
-				cur = cur->ai_next;
+				continue;
+			}
+			if (first == 0)
+				first = b->last;
+#ifdef HAVE_SA_LEN
+			cur->ai_addr->sa_len = afd->a_socklen;
+#endif
+			cur->ai_addr->sa_family = afd->a_af;
+			memcpy((char *)(void *)cur->ai_addr + afd->a_off, cp,
+			    (size_t)afd->a_addrlen);
 			cp += n;
 			break;
 		default:
@@ -1469,16 +1681,20 @@ getanswer(const querybuf *answer, int anslen, const char *qname, int qtype,
 			haveanswer++;
 	}
 	if (haveanswer) {
-		if (!canonname)
-			(void)get_canonname(pai, sentinel.ai_next, qname);
-		else
-			(void)get_canonname(pai, sentinel.ai_next, canonname);
+		if ((pai->ai_flags & AI_CANONNAME) != 0) {
+			if (!canonname)
+				canonname = (char *)qname;
+			n = strlen(canonname) + 1;
+			bp = _ai_add_name(b, first, (size_t)n);
+			if (bp != NULL)
+				memcpy(bp, canonname, (size_t)n);
+		}
 		h_errno = NETDB_SUCCESS;
-		return sentinel.ai_next;
+		return haveanswer;
 	}
 
 	h_errno = NO_RECOVERY;
-	return NULL;
+	return 0;
 }
 
 struct addrinfo_sort_elem {
@@ -1874,13 +2090,14 @@ error:
 static int
 _dns_getaddrinfo(void *rv, void	*cb_data, va_list ap)
 {
-	struct addrinfo *ai;
 	querybuf *buf, *buf2;
 	const char *name;
 	const struct addrinfo *pai;
-	struct addrinfo sentinel, *cur;
+	struct addrinfo sentinel;
+	struct ai_builder builder;
 	struct res_target q, q2;
 	res_state res;
+	struct bionic_scratch_scope scratch;
 	const struct android_net_context *netcontext;
 
 	name = va_arg(ap, char *);
@@ -1891,16 +2108,13 @@ _dns_getaddrinfo(void *rv, void	*cb_data, va_list ap)
 	memset(&q, 0, sizeof(q));
 	memset(&q2, 0, sizeof(q2));
 	memset(&sentinel, 0, sizeof(sentinel));
-	cur = &sentinel;
 
-	buf = malloc(sizeof(*buf));
-	if (buf == NULL) {
-		h_errno = NETDB_INTERNAL;
-		return NS_NOTFOUND;
-	}
-	buf2 = malloc(sizeof(*buf2));
-	if (buf2 == NULL) {
-		free(buf);
+	/* The answer buffers are only needed until getanswer has copied what it wants out. */
+	__bionic_scratch_begin(&scratch);
+	buf = __bionic_scratch_alloc(&scratch, sizeof(*buf));
+	buf2 = __bionic_scratch_alloc(&scratch, sizeof(*buf2));
+	if (buf == NULL || buf2 == NULL) {
+		__bionic_scratch_end(&scratch);
 		h_errno = NETDB_INTERNAL;
 		return NS_NOTFOUND;
 	}
@@ -1930,8 +2144,7 @@ _dns_getaddrinfo(void *rv, void	*cb_data, va_list ap)
 		} else if (query_ipv4) {
 			q.qtype = T_A;
 		} else {
-			free(buf);
-			free(buf2);
+			__bionic_scratch_end(&scratch);
 			return NS_NOTFOUND;
 		}
 		break;
@@ -1950,15 +2163,13 @@ _dns_getaddrinfo(void *rv, void	*cb_data, va_list ap)
 		q.anslen = sizeof(buf->buf);
 		break;
 	default:
-		free(buf);
-		free(buf2);
+		__bionic_scratch_end(&scratch);
 		return NS_UNAVAIL;
 	}
 
 	res = __res_get_state();
 	if (res == NULL) {
-		free(buf);
-		free(buf2);
+		__bionic_scratch_end(&scratch);
 		return NS_NOTFOUND;
 	}
 
@@ -1971,23 +2182,15 @@ _dns_getaddrinfo(void *rv, void	*cb_data, va_list ap)
 	res_setmark(res, netcontext->dns_mark);
 	if (res_searchN(name, &q, res) < 0) {
 		__res_put_state(res);
-		free(buf);
-		free(buf2);
+		__bionic_scratch_end(&scratch);
 		return NS_NOTFOUND;
 	}
-	ai = getanswer(buf, q.n, q.name, q.qtype, pai);
-	if (ai) {
-		cur->ai_next = ai;
-		while (cur && cur->ai_next)
-			cur = cur->ai_next;
-	}
-	if (q.next) {
-		ai = getanswer(buf2, q2.n, q2.name, q2.qtype, pai);
-		if (ai)
-			cur->ai_next = ai;
-	}
-	free(buf);
-	free(buf2);
+	_ai_init(&builder, 0);
+	getanswer(buf, q.n, q.name, q.qtype, pai, &builder);
+	if (q.next)
+		getanswer(buf2, q2.n, q2.name, q2.qtype, pai, &builder);
+	sentinel.ai_next = _ai_finish(&builder);
+	__bionic_scratch_end(&scratch);
 	if (sentinel.ai_next == NULL) {
 		__res_put_state(res);
 		switch (h_errno) {
@@ -2111,7 +2314,9 @@ _files_getaddrinfo(void *rv, void *cb_data, va_list ap)
 	memset(&sentinel, 0, sizeof(sentinel));
 	cur = &sentinel;
 
-	_sethtent(&hostf);
+	hostf = _hosts_index_open(name);
+	if (hostf == NULL)
+		_sethtent(&hostf);
 	while ((p = _gethtent(&hostf, name, pai)) != NULL) {
 		cur->ai_next = p;
 		while (cur && cur->ai_next)
@@ -2137,16 +2342,42 @@ _files_getaddrinfo(void *rv, void *cb_data, va_list ap)
  *
  * Caller must parse answer and determine whether it answers the question.
  */
+/*
+ * Builds the query for one target of res_queryN() in buf.
+ */
+static int
+res_mkqueryN(const char *name, const struct res_target *t, res_state res,
+    u_char *buf, int buflen)
+{
+	int n;
+
+#ifdef DEBUG
+	if (res->options & RES_DEBUG)
+		printf(";; res_nquery(%s, %d, %d)\n", name, t->qclass, t->qtype);
+#endif
+
+	n = res_nmkquery(res, QUERY, name, t->qclass, t->qtype, NULL, 0, NULL,
+	    buf, buflen);
+#ifdef RES_USE_EDNS0
+	if (n > 0 && (res->options & RES_USE_EDNS0) != 0)
+		n = res_nopt(res, n, buf, buflen, t->anslen);
+#endif
+	return n;
+}
+
 static int
 res_queryN(const char *name, /* domain name */ struct res_target *target,
     res_state res)
 {
 	u_char buf[MAXPACKET];
+	u_char buf2[PACKETSZ];
 	HEADER *hp;
-	int n;
+	int n, n2;
 	struct res_target *t;
 	int rcode;
 	int ancount;
+	int paired;
+	int sent[2];
 
 	assert(name != NULL);
 	/* XXX: target may be NULL??? */
@@ -2154,39 +2385,41 @@ res_queryN(const char *name, /* domain name */ struct res_target *target,
 	rcode = NOERROR;
 	ancount = 0;
 
-	for (t = target; t; t = t->next) {
-		int class, type;
-		u_char *answer;
-		int anslen;
+	/*
+	 * An AF_UNSPEC lookup asks for AAAA and A.  Send both queries at
+	 * once, so that a cache miss costs one round trip rather than two.
+	 */
+	paired = 0;
+	if (target != NULL && target->next != NULL && target->next->next == NULL) {
+		n = res_mkqueryN(name, target, res, buf, sizeof(buf));
+		n2 = res_mkqueryN(name, target->next, res, buf2, sizeof(buf2));
+		if (n > 0 && n2 > 0) {
+			((HEADER *)(void *)target->answer)->rcode = NOERROR;
+			((HEADER *)(void *)target->next->answer)->rcode = NOERROR;
+			paired = res_nsend_pair(res, buf, n, target->answer,
+			    target->anslen, &sent[0], buf2, n2, target->next->answer,
+			    target->next->anslen, &sent[1]) == 0;
+		}
+	}
 
+	for (t = target; t; t = t->next) {
 		hp = (HEADER *)(void *)t->answer;
-		hp->rcode = NOERROR;	/* default */
-
-		/* make it easier... */
-		class = t->qclass;
-		type = t->qtype;
-		answer = t->answer;
-		anslen = t->anslen;
-#ifdef DEBUG
-		if (res->options & RES_DEBUG)
-			printf(";; res_nquery(%s, %d, %d)\n", name, class, type);
-#endif
+		if (paired) {
+			n = sent[t == target ? 0 : 1];
+		} else {
+			hp->rcode = NOERROR;	/* default */
 
-		n = res_nmkquery(res, QUERY, name, class, type, NULL, 0, NULL,
-		    buf, sizeof(buf));
-#ifdef RES_USE_EDNS0
-		if (n > 0 && (res->options & RES_USE_EDNS0) != 0)
-			n = res_nopt(res, n, buf, sizeof(buf), anslen);
-#endif
-		if (n <= 0) {
+			n = res_mkqueryN(name, t, res, buf, sizeof(buf));
+			if (n <= 0) {
 #ifdef DEBUG
-			if (res->options & RES_DEBUG)
-				printf(";; res_nquery: mkquery failed\n");
+				if (res->options & RES_DEBUG)
+					printf(";; res_nquery: mkquery failed\n");
 #endif
-			h_errno = NO_RECOVERY;
-			return n;
+				h_errno = NO_RECOVERY;
+				return n;
+			}
+			n = res_nsend(res, buf, n, t->answer, t->anslen);
 		}
-		n = res_nsend(res, buf, n, answer, anslen);
 #if 0
 		if (n < 0) {
 #ifdef DEBUG
@@ -0,0 +1,365 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * An index of the hosts file by name, so that looking a name up reads only
+ * the lines that mention it rather than parsing the whole file every time.
+ * It's built the first time it's needed and again whenever the file's
+ * inode, size or modification time changes.  The index keeps its own copy
+ * of the file rather than a mapping of it: a hosts file truncated in place
+ * would otherwise make a lookup in another thread fault.
+ */
+
+#include <sys/stat.h>
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+
+#include "hostent.h"
+
+/* Bigger files are read line by line, as they were before. */
+#define HOSTS_INDEX_MAX_SIZE	(64 * 1024 * 1024)
+
+struct hosts_name {
+	uint32_t hash;
+	uint32_t line;		/* offset of the line it's on */
+	uint32_t name;		/* offset of the name itself */
+	uint32_t next;		/* 1 + index of the next name in its bucket */
+};
+
+struct hosts_index {
+	dev_t dev;
+	ino_t ino;
+	off_t size;
+	struct timespec mtime;
+	char *text;		/* the file, NUL-terminated */
+	struct hosts_name *names;
+	uint32_t *buckets;	/* 1 + index of the first name in each */
+	uint32_t mask;		/* number of buckets - 1 */
+};
+
+static pthread_rwlock_t hosts_index_lock = PTHREAD_RWLOCK_INITIALIZER;
+static struct hosts_index *hosts_index;
+
+static int
+hosts_delim(int c)
+{
+	return c == ' ' || c == '\t' || c == '#' || c == '\n' || c == '\0';
+}
+
+/* FNV-1a of the name, ignoring case as the lookups do. */
+static uint32_t
+hosts_hash(const char *name, size_t len)
+{
+	uint32_t hash = 2166136261u;
+	size_t i;
+
+	for (i = 0; i < len; i++) {
+		hash ^= (uint32_t)tolower((unsigned char)name[i]);
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+static int
+hosts_index_current(const struct hosts_index *hi, const struct stat *st)
+{
+	return hi != NULL && hi->dev == st->st_dev && hi->ino == st->st_ino &&
+	    hi->size == st->st_size &&
+	    hi->mtime.tv_sec == st->st_mtim.tv_sec &&
+	    hi->mtime.tv_nsec == st->st_mtim.tv_nsec;
+}
+
+static void
+hosts_index_free(struct hosts_index *hi)
+{
+	if (hi != NULL) {
+		free(hi->text);
+		free(hi->names);
+		free(hi->buckets);
+		free(hi);
+	}
+}
+
+static char *
+hosts_read(const struct stat *st)
+{
+	char *text;
+	size_t got;
+	ssize_t n;
+	int fd;
+
+	fd = open(_PATH_HOSTS, O_RDONLY | O_CLOEXEC);
+	if (fd == -1)
+		return NULL;
+	text = malloc((size_t)st->st_size + 1);
+	if (text == NULL) {
+		close(fd);
+		return NULL;
+	}
+	for (got = 0; got < (size_t)st->st_size; got += n) {
+		n = TEMP_FAILURE_RETRY(read(fd, text + got, (size_t)st->st_size - got));
+		if (n <= 0)
+			break;
+	}
+	close(fd);
+	if (got != (size_t)st->st_size) {
+		/* changed while we were reading it; try again next time */
+		free(text);
+		return NULL;
+	}
+	if (memchr(text, '\0', got) != NULL) {
+		/* not something the parsers' fgets() loops read sensibly */
+		free(text);
+		return NULL;
+	}
+	text[got] = '\0';
+	return text;
+}
+
+/*
+ * Indexes every name in the file, skipping the lines that
+ * netbsd_gethostent_r() and getaddrinfo()'s _gethtent() would.  A file
+ * that can't be indexed still gets an (empty) index, so that we don't
+ * try again until it changes.
+ */
+static struct hosts_index *
+hosts_index_build(const struct stat *st)
+{
+	struct hosts_index *hi;
+	struct hosts_name *names, *grown;
+	uint32_t *tails;
+	size_t count, cap, nbuckets, i;
+	char *line, *end, *cp;
+
+	hi = calloc(1, sizeof(*hi));
+	if (hi == NULL)
+		return NULL;
+	hi->dev = st->st_dev;
+	hi->ino = st->st_ino;
+	hi->size = st->st_size;
+	hi->mtime = st->st_mtim;
+	if (st->st_size > HOSTS_INDEX_MAX_SIZE)
+		return hi;
+	hi->text = hosts_read(st);
+	if (hi->text == NULL)
+		return hi;
+
+	names = NULL;
+	count = cap = 0;
+	for (line = hi->text; *line != '\0'; line = end + 1) {
+		end = strchr(line, '\n');
+		if (end == NULL)
+			break;	/* the parsers skip an unterminated last line */
+		if (*line == '#')
+			continue;
+		/* skip the address */
+		for (cp = line; !hosts_delim(*cp); cp++)
+			continue;
+		if (*cp != ' ' && *cp != '\t')
+			continue;
+		while (*cp != '#' && *cp != '\n') {
+			char *name;
+
+			if (*cp == ' ' || *cp == '\t') {
+				cp++;
+				continue;
+			}
+			for (name = cp; !hosts_delim(*cp); cp++)
+				continue;
+			if (count == cap) {
+				cap = cap ? cap * 2 : 256;
+				grown = realloc(names, cap * sizeof(*names));
+				if (grown == NULL) {
+					free(names);
+					goto fail;
+				}
+				names = grown;
+			}
+			names[count].hash = hosts_hash(name, (size_t)(cp - name));
+			names[count].line = (uint32_t)(line - hi->text);
+			names[count].name = (uint32_t)(name - hi->text);
+			names[count].next = 0;
+			count++;
+		}
+	}
+	hi->names = names;
+
+	/* chain the names in each bucket in file order */
+	for (nbuckets = 16; nbuckets < count; nbuckets *= 2)
+		continue;
+	hi->mask = (uint32_t)(nbuckets - 1);
+	hi->buckets = calloc(nbuckets, sizeof(*hi->buckets));
+	tails = calloc(nbuckets, sizeof(*tails));
+	if (hi->buckets == NULL || tails == NULL) {
+		free(tails);
+		goto fail;
+	}
+	for (i = 0; i < count; i++) {
+		uint32_t b = names[i].hash & hi->mask;
+
+		if (tails[b] == 0)
+			hi->buckets[b] = (uint32_t)(i + 1);
+		else
+			names[tails[b] - 1].next = (uint32_t)(i + 1);
+		tails[b] = (uint32_t)(i + 1);
+	}
+	free(tails);
+	return hi;
+
+ fail:
+	free(hi->text);
+	free(hi->names);
+	free(hi->buckets);
+	hi->text = NULL;
+	hi->names = NULL;
+	hi->buckets = NULL;
+	return hi;
+}
+
+static size_t
+hosts_line_len(const char *line)
+{
+	return (size_t)(strchr(line, '\n') - line) + 1;
+}
+
+/*
+ * Calls fn for each line of the file that has the name, in file order.
+ * The index must be read-locked.
+ */
+static void
+hosts_index_each(const struct hosts_index *hi, const char *name,
+    void (*fn)(const char *, size_t, void *), void *arg)
+{
+	const struct hosts_name *hn;
+	uint32_t hash, last, i;
+	size_t len;
+
+	len = strlen(name);
+	hash = hosts_hash(name, len);
+	last = UINT32_MAX;
+	for (i = hi->buckets[hash & hi->mask]; i != 0; i = hn->next) {
+		const char *text;
+
+		hn = &hi->names[i - 1];
+		text = hi->text + hn->name;
+		if (hn->hash != hash || hn->line == last ||
+		    strncasecmp(text, name, len) != 0 || !hosts_delim(text[len]))
+			continue;
+		last = hn->line;
+		fn(hi->text + hn->line, hosts_line_len(hi->text + hn->line), arg);
+	}
+}
+
+struct hosts_lines {
+	size_t len;
+	size_t pos;
+	char text[];
+};
+
+static void
+hosts_count_line(const char *line, size_t len, void *arg)
+{
+	*(size_t *)arg += len;
+}
+
+static void
+hosts_copy_line(const char *line, size_t len, void *arg)
+{
+	struct hosts_lines *hl = arg;
+
+	memcpy(hl->text + hl->len, line, len);
+	hl->len += len;
+}
+
+static int
+hosts_lines_read(void *cookie, char *buf, int size)
+{
+	struct hosts_lines *hl = cookie;
+	size_t n;
+
+	n = hl->len - hl->pos;
+	if (n > (size_t)size)
+		n = (size_t)size;
+	memcpy(buf, hl->text + hl->pos, n);
+	hl->pos += n;
+	return (int)n;
+}
+
+static int
+hosts_lines_close(void *cookie)
+{
+	free(cookie);
+	return 0;
+}
+
+/*
+ * Returns a stream of just the lines of the hosts file that have the given
+ * name, for reading in place of the file itself, or NULL if the caller
+ * should read the file.
+ */
+FILE *
+_hosts_index_open(const char *name)
+{
+	struct hosts_lines *hl;
+	struct stat st;
+	size_t size;
+	FILE *fp;
+
+	if (stat(_PATH_HOSTS, &st) == -1)
+		return NULL;
+
+	pthread_rwlock_rdlock(&hosts_index_lock);
+	if (!hosts_index_current(hosts_index, &st)) {
+		pthread_rwlock_unlock(&hosts_index_lock);
+		pthread_rwlock_wrlock(&hosts_index_lock);
+		if (!hosts_index_current(hosts_index, &st)) {
+			hosts_index_free(hosts_index);
+			hosts_index = hosts_index_build(&st);
+		}
+		pthread_rwlock_unlock(&hosts_index_lock);
+		pthread_rwlock_rdlock(&hosts_index_lock);
+	}
+	if (!hosts_index_current(hosts_index, &st) || hosts_index->text == NULL) {
+		pthread_rwlock_unlock(&hosts_index_lock);
+		return NULL;
+	}
+
+	/* an empty stream is still a valid answer: there are no such lines */
+	size = 0;
+	hosts_index_each(hosts_index, name, hosts_count_line, &size);
+	hl = malloc(sizeof(*hl) + size);
+	if (hl != NULL) {
+		hl->len = hl->pos = 0;
+		hosts_index_each(hosts_index, name, hosts_copy_line, hl);
+	}
+	pthread_rwlock_unlock(&hosts_index_lock);
+	if (hl == NULL)
+		return NULL;
+
+	fp = funopen(hl, hosts_lines_read, NULL, NULL, hosts_lines_close);
+	if (fp == NULL)
+		free(hl);
+	return fp;
+}
@@ -136,8 +136,9 @@ _hf_gethtbyname2(const char *name, int af, struct getnamaddr *info)
 
 	_DIAGASSERT(name != NULL);
 
-	hf = NULL;
-	sethostent_r(&hf);
+	hf = _hosts_index_open(name);
+	if (hf == NULL)
+		sethostent_r(&hf);
 	if (hf == NULL) {
 		errno = EINVAL;
 		*info->he = NETDB_INTERNAL;
@@ -0,0 +1,588 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * A non-blocking resolver for event loops. Any number of queries share one
+ * UDP socket per address family, and a single epoll fd reports both answers
+ * and retransmission timeouts. Queries are built by res_nmkquery() and go to
+ * the network's name servers as they would from res_nsend(), and answers go
+ * through the same cache and server statistics.
+ */
+
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+#include <arpa/nameser.h>
+#include <netinet/in.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "resolv_cache.h"
+#include "resolv_netid.h"
+#include "resolv_private.h"
+#include "resolv_stats.h"
+#include "res_private.h"
+
+#define EXT(res) ((res)->_u._ext)
+
+/* in-flight queries are found by their DNS id */
+#define ASYNC_ID_BUCKETS 256
+
+/* enough for the answers to a burst of a few thousand queries to wait until
+ * the event loop gets around to them, if the kernel allows */
+#define ASYNC_RCVBUF (1024 * 1024)
+
+struct async_query {
+    struct async_query*         next;       /* in the list of queries in flight */
+    struct async_query*         prev;
+    struct async_query*         id_next;    /* in its id bucket */
+    int                         handle;
+    android_res_async_callback  callback;   /* NULL when refreshing a cache entry */
+    void*                       cookie;
+    int                         attempt;    /* sends so far, over all servers */
+    int                         ns;         /* the server it was last sent to */
+    ResolvCacheStatus           cache_status;
+    int                         revision_id;
+    int                         max_samples;
+    struct timespec             started;
+    struct timespec             sent_at;
+    struct timespec             deadline;
+    union res_sockaddr_union    to;
+    int                         error;      /* for when no server answers */
+    int                         anslen;     /* once it has been answered */
+    u_char*                     answer;
+    int                         querylen;
+    u_char                      query[];
+};
+
+struct android_res_async {
+    struct __res_state      res;
+    int                     epfd;
+    int                     timerfd;
+    int                     socks[2];       /* IPv4 and IPv6, once needed */
+    unsigned                generation;
+    struct async_query      inflight;
+    struct async_query*     ids[ASYNC_ID_BUCKETS];
+    struct timespec         armed;          /* when timerfd fires, or 0 */
+    u_char                  buf[NS_MAXMSG];
+};
+
+static int
+ts_before(const struct timespec* a, const struct timespec* b)
+{
+    return a->tv_sec < b->tv_sec || (a->tv_sec == b->tv_sec && a->tv_nsec < b->tv_nsec);
+}
+
+static struct async_query**
+async_bucket(struct android_res_async* ctx, unsigned id)
+{
+    return &ctx->ids[id % ASYNC_ID_BUCKETS];
+}
+
+static struct async_query*
+async_find_id(struct android_res_async* ctx, unsigned id)
+{
+    struct async_query* q;
+
+    for (q = *async_bucket(ctx, id); q != NULL; q = q->id_next) {
+        if ((q->handle & 0xffff) == (int) id)
+            return q;
+    }
+    return NULL;
+}
+
+/* take a query out of the in-flight list and its id bucket */
+static void
+async_unlink(struct android_res_async* ctx, struct async_query* q)
+{
+    struct async_query** pq = async_bucket(ctx, q->handle & 0xffff);
+
+    while (*pq != q)
+        pq = &(*pq)->id_next;
+    *pq = q->id_next;
+    q->prev->next = q->next;
+    q->next->prev = q->prev;
+}
+
+static void
+async_arm(struct android_res_async* ctx, const struct timespec* when)
+{
+    struct itimerspec its;
+
+    memset(&its, 0, sizeof(its));
+    if (when != NULL)
+        its.it_value = *when;
+    if (timerfd_settime(ctx->timerfd, TFD_TIMER_ABSTIME, &its, NULL) == 0) {
+        if (when != NULL)
+            ctx->armed = *when;
+        else
+            memset(&ctx->armed, 0, sizeof(ctx->armed));
+    }
+}
+
+static int
+async_socket(struct android_res_async* ctx, int family)
+{
+    int* s = &ctx->socks[family == AF_INET6];
+    struct epoll_event ev;
+    int rcvbuf = ASYNC_RCVBUF;
+
+    if (*s != -1)
+        return *s;
+    *s = socket(family, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (*s == -1)
+        return -1;
+    setsockopt(*s, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+    if (ctx->res._mark != MARK_UNSET &&
+        setsockopt(*s, SOL_SOCKET, SO_MARK, &ctx->res._mark, sizeof(ctx->res._mark)) == -1) {
+        goto fail;
+    }
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.fd = *s;
+    if (epoll_ctl(ctx->epfd, EPOLL_CTL_ADD, *s, &ev) == -1)
+        goto fail;
+    return *s;
+
+fail:
+    close(*s);
+    *s = -1;
+    return -1;
+}
+
+static struct sockaddr*
+async_nsaddr(res_state statp, int ns)
+{
+    if (!statp->nsaddr_list[ns].sin_family && EXT(statp).ext)
+        return (struct sockaddr*) (void*) &EXT(statp).ext->nsaddrs[ns];
+    return (struct sockaddr*) (void*) &statp->nsaddr_list[ns];
+}
+
+static socklen_t
+async_salen(const struct sockaddr* sa)
+{
+    if (sa->sa_family == AF_INET)
+        return sizeof(struct sockaddr_in);
+    if (sa->sa_family == AF_INET6)
+        return sizeof(struct sockaddr_in6);
+    return 0;
+}
+
+static int
+async_from_server(const union res_sockaddr_union* to, const struct sockaddr* from)
+{
+    if (to->sin.sin_family != from->sa_family)
+        return 0;
+    if (from->sa_family == AF_INET) {
+        const struct sockaddr_in* sin = (const struct sockaddr_in*) (const void*) from;
+        return sin->sin_port == to->sin.sin_port &&
+            sin->sin_addr.s_addr == to->sin.sin_addr.s_addr;
+    }
+    if (from->sa_family == AF_INET6) {
+        const struct sockaddr_in6* sin6 = (const struct sockaddr_in6*) (const void*) from;
+        return sin6->sin6_port == to->sin6.sin6_port &&
+            IN6_ARE_ADDR_EQUAL(&sin6->sin6_addr, &to->sin6.sin6_addr);
+    }
+    return 0;
+}
+
+static void
+async_add_sample(struct android_res_async* ctx, struct async_query* q, int rcode)
+{
+    struct __res_sample sample;
+    struct timespec now;
+    int rtt = 0;
+
+    if (rcode != RCODE_TIMEOUT && rcode != RCODE_INTERNAL_ERROR) {
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        rtt = _res_stats_calculate_rtt(&now, &q->sent_at);
+    }
+    _res_stats_set_sample(&sample, time(NULL), rcode, rtt);
+    _resolv_cache_add_resolver_stats_sample(ctx->res.netid, q->revision_id, q->ns, &sample,
+            q->max_samples);
+}
+
+/* Send the query to the next server, in the order res_nsend() would try
+ * them: each server in turn, with a longer timeout on every round. Returns
+ * 0, or -1 once there are no more to try.
+ */
+static int
+async_send(struct android_res_async* ctx, struct async_query* q, const struct timespec* now)
+{
+    res_state statp = &ctx->res;
+
+    while (statp->nscount > 0 && q->attempt < statp->retry * statp->nscount) {
+        int round = q->attempt / statp->nscount;
+        int timeout = statp->retrans << round;
+        struct sockaddr* nsap;
+        socklen_t nsaplen;
+        int s;
+
+        q->ns = q->attempt % statp->nscount;
+        q->attempt++;
+        if (round > 0)
+            timeout /= statp->nscount;
+        if (timeout <= 0)
+            timeout = 1;
+
+        nsap = async_nsaddr(statp, q->ns);
+        nsaplen = async_salen(nsap);
+        if (nsaplen == 0)
+            continue;
+        s = async_socket(ctx, nsap->sa_family);
+        if (s == -1 || sendto(s, q->query, q->querylen, 0, nsap, nsaplen) != q->querylen) {
+            q->error = errno;
+            async_add_sample(ctx, q, RCODE_INTERNAL_ERROR);
+            continue;
+        }
+        memcpy(&q->to, nsap, nsaplen);
+        q->sent_at = *now;
+        q->deadline = *now;
+        q->deadline.tv_sec += timeout;
+        return 0;
+    }
+    return -1;
+}
+
+/* Queries that have been answered or have failed are moved to a list of
+ * their own, and their callbacks are called once the in-flight list is
+ * consistent again, since a callback may start or cancel other queries.
+ */
+static void
+async_done(struct android_res_async* ctx, struct async_query* q, struct async_query** done)
+{
+    struct timespec now;
+
+    async_unlink(ctx, q);
+    if (q->answer == NULL)
+        _resolv_cache_query_failed(ctx->res.netid, q->query, q->querylen);
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    _resolv_cache_add_query_stats(ctx->res.netid, _res_stats_calculate_rtt(&now, &q->started),
+            q->answer != NULL);
+    q->next = *done;
+    *done = q;
+}
+
+static void
+async_call_done(struct async_query* done)
+{
+    while (done != NULL) {
+        struct async_query* q = done;
+
+        done = q->next;
+        if (q->callback != NULL) {
+            if (q->answer != NULL)
+                q->callback(q->cookie, 0, q->answer, q->anslen);
+            else
+                q->callback(q->cookie, q->error, NULL, 0);
+        }
+        free(q->answer);
+        free(q);
+    }
+}
+
+static void
+async_receive(struct android_res_async* ctx, int s, struct async_query** done)
+{
+    union res_sockaddr_union from;
+    socklen_t fromlen;
+    struct timespec now;
+    struct async_query* q;
+    const HEADER* hp;
+    int n;
+
+    for (;;) {
+        fromlen = sizeof(from);
+        n = recvfrom(s, ctx->buf, sizeof(ctx->buf), MSG_DONTWAIT,
+                (struct sockaddr*) (void*) &from, &fromlen);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            return;
+        }
+        if (n < HFIXEDSZ)
+            continue;
+        hp = (const HEADER*) (const void*) ctx->buf;
+        q = async_find_id(ctx, ntohs(hp->id));
+        if (q == NULL || !async_from_server(&q->to, (struct sockaddr*) (void*) &from) ||
+            res_queriesmatch(q->query, q->query + q->querylen, ctx->buf, ctx->buf + n) != 1) {
+            /* late or forged */
+            continue;
+        }
+        async_add_sample(ctx, q, hp->rcode);
+        if (hp->rcode == SERVFAIL || hp->rcode == NOTIMP || hp->rcode == REFUSED) {
+            /* as in send_dg(): ask the next server at once */
+            q->error = ECONNREFUSED;
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            if (async_send(ctx, q, &now) == -1)
+                async_done(ctx, q, done);
+            continue;
+        }
+        q->answer = malloc(n);
+        if (q->answer == NULL) {
+            q->error = ENOMEM;
+        } else {
+            memcpy(q->answer, ctx->buf, n);
+            q->anslen = n;
+            if (q->cache_status != RESOLV_CACHE_UNSUPPORTED)
+                _resolv_cache_add(ctx->res.netid, q->query, q->querylen, q->answer, n);
+        }
+        async_done(ctx, q, done);
+    }
+}
+
+/* resend the queries whose servers haven't answered in time, and set the
+ * timer for the next such deadline */
+static void
+async_expire(struct android_res_async* ctx, struct async_query** done)
+{
+    struct async_query* q;
+    struct async_query* next;
+    struct timespec now;
+    struct timespec* first = NULL;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    for (q = ctx->inflight.next; q != &ctx->inflight; q = next) {
+        next = q->next;
+        if (!ts_before(&now, &q->deadline)) {
+            async_add_sample(ctx, q, RCODE_TIMEOUT);
+            if (q->error == 0)
+                q->error = ETIMEDOUT;
+            if (async_send(ctx, q, &now) == -1) {
+                async_done(ctx, q, done);
+                continue;
+            }
+        }
+        if (first == NULL || ts_before(&q->deadline, first))
+            first = &q->deadline;
+    }
+    async_arm(ctx, first);
+}
+
+struct android_res_async*
+android_res_async_create(unsigned netid, unsigned mark)
+{
+    struct android_res_async* ctx;
+    struct epoll_event ev;
+    int saved_errno;
+
+    ctx = calloc(1, sizeof(*ctx));
+    if (ctx == NULL)
+        return NULL;
+    ctx->epfd = ctx->timerfd = ctx->socks[0] = ctx->socks[1] = -1;
+    ctx->inflight.next = ctx->inflight.prev = &ctx->inflight;
+    if (res_ninit(&ctx->res) == -1) {
+        free(ctx);
+        errno = ENOMEM;
+        return NULL;
+    }
+    res_setnetid(&ctx->res, netid);
+    res_setmark(&ctx->res, mark);
+
+    ctx->epfd = epoll_create1(EPOLL_CLOEXEC);
+    ctx->timerfd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (ctx->epfd == -1 || ctx->timerfd == -1)
+        goto fail;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.fd = ctx->timerfd;
+    if (epoll_ctl(ctx->epfd, EPOLL_CTL_ADD, ctx->timerfd, &ev) == -1)
+        goto fail;
+    return ctx;
+
+fail:
+    saved_errno = errno;
+    android_res_async_destroy(ctx);
+    errno = saved_errno;
+    return NULL;
+}
+
+int
+android_res_async_fd(const struct android_res_async* ctx)
+{
+    return ctx->epfd;
+}
+
+int
+android_res_async_query(struct android_res_async* ctx, const char* dname, int ns_class,
+        int ns_type, android_res_async_callback callback, void* cookie)
+{
+    struct __res_params params;
+    struct __res_stats stats[MAXNS];
+    struct async_query* q;
+    struct async_query* refresh = NULL;
+    struct timespec now;
+    u_char* answer;
+    ResolvCacheStatus cache_status;
+    unsigned id;
+    int n, anslen = 0;
+
+    n = res_nmkquery(&ctx->res, QUERY, dname, ns_class, ns_type, NULL, 0, NULL,
+            ctx->buf, sizeof(ctx->buf));
+    if (n <= 0) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    cache_status = _resolv_cache_lookup_nowait(ctx->res.netid, ctx->buf, n,
+            ctx->buf + n, sizeof(ctx->buf) - n, &anslen);
+    if (cache_status == RESOLV_CACHE_FOUND || cache_status == RESOLV_CACHE_FOUND_REFRESH) {
+        if (cache_status == RESOLV_CACHE_FOUND_REFRESH) {
+            /* the cached answer will do, but fetch a new one for next time */
+            refresh = calloc(1, sizeof(*refresh) + n);
+            if (refresh == NULL) {
+                _resolv_cache_query_failed(ctx->res.netid, ctx->buf, n);
+            } else {
+                memcpy(refresh->query, ctx->buf, n);
+            }
+        }
+        /* the callback may send another query, reusing ctx->buf */
+        answer = malloc(anslen);
+        if (answer == NULL) {
+            if (cache_status == RESOLV_CACHE_FOUND_REFRESH)
+                _resolv_cache_query_failed(ctx->res.netid, ctx->buf, n);
+            free(refresh);
+            errno = ENOMEM;
+            return -1;
+        }
+        memcpy(answer, ctx->buf + n, anslen);
+        callback(cookie, 0, answer, anslen);
+        free(answer);
+        if (refresh == NULL)
+            return 0;
+        q = refresh;
+    } else {
+        q = calloc(1, sizeof(*q) + n);
+        if (q == NULL) {
+            if (cache_status == RESOLV_CACHE_NOTFOUND)
+                _resolv_cache_query_failed(ctx->res.netid, ctx->buf, n);
+            errno = ENOMEM;
+            return -1;
+        }
+        memcpy(q->query, ctx->buf, n);
+    }
+    q->querylen = n;
+    q->cache_status = cache_status;
+    if (refresh == NULL) {
+        q->callback = callback;
+        q->cookie = cookie;
+    }
+
+    /* the name servers may have changed since the last query */
+    if (cache_status != RESOLV_CACHE_UNSUPPORTED)
+        _resolv_populate_res_for_net(&ctx->res);
+    q->revision_id = _resolv_cache_get_resolver_stats(ctx->res.netid, &params, stats);
+    q->max_samples = q->revision_id >= 0 ? params.max_samples : 0;
+    if (ctx->res.nscount == 0) {
+        _resolv_cache_query_failed(ctx->res.netid, q->query, n);
+        free(q);
+        if (refresh != NULL)
+            return 0;
+        errno = ESRCH;
+        return -1;
+    }
+
+    /* the id must tell the answers to queries in flight apart */
+    id = ntohs(((HEADER*) (void*) q->query)->id);
+    while (async_find_id(ctx, id) != NULL) {
+        id = res_randomid() & 0xffff;
+        ((HEADER*) (void*) q->query)->id = htons(id);
+    }
+    if (++ctx->generation > 0x7fff)
+        ctx->generation = 1;
+    q->handle = (int) (ctx->generation << 16 | id);
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    q->started = now;
+    if (async_send(ctx, q, &now) == -1) {
+        int error = q->error;
+
+        _resolv_cache_query_failed(ctx->res.netid, q->query, n);
+        free(q);
+        if (refresh != NULL)
+            return 0;
+        errno = error;
+        return -1;
+    }
+    q->id_next = *async_bucket(ctx, id);
+    *async_bucket(ctx, id) = q;
+    q->prev = ctx->inflight.prev;
+    q->next = &ctx->inflight;
+    q->prev->next = q;
+    ctx->inflight.prev = q;
+    if ((ctx->armed.tv_sec == 0 && ctx->armed.tv_nsec == 0) || ts_before(&q->deadline, &ctx->armed))
+        async_arm(ctx, &q->deadline);
+    return refresh != NULL ? 0 : q->handle;
+}
+
+int
+android_res_async_cancel(struct android_res_async* ctx, int handle)
+{
+    struct async_query* q = async_find_id(ctx, handle & 0xffff);
+
+    if (q == NULL || q->handle != handle || q->callback == NULL) {
+        errno = ENOENT;
+        return -1;
+    }
+    async_unlink(ctx, q);
+    _resolv_cache_query_failed(ctx->res.netid, q->query, q->querylen);
+    free(q);
+    return 0;
+}
+
+void
+android_res_async_process(struct android_res_async* ctx)
+{
+    struct async_query* done = NULL;
+    uint64_t expirations;
+    int i;
+
+    while (read(ctx->timerfd, &expirations, sizeof(expirations)) > 0) {
+    }
+    for (i = 0; i < 2; i++) {
+        if (ctx->socks[i] != -1)
+            async_receive(ctx, ctx->socks[i], &done);
+    }
+    async_expire(ctx, &done);
+    async_call_done(done);
+}
+
+void
+android_res_async_destroy(struct android_res_async* ctx)
+{
+    struct async_query* q;
+
+    if (ctx == NULL)
+        return;
+    while ((q = ctx->inflight.next) != &ctx->inflight) {
+        async_unlink(ctx, q);
+        _resolv_cache_query_failed(ctx->res.netid, q->query, q->querylen);
+        free(q);
+    }
+    if (ctx->socks[0] != -1)
+        close(ctx->socks[0]);
+    if (ctx->socks[1] != -1)
+        close(ctx->socks[1]);
+    if (ctx->timerfd != -1)
+        close(ctx->timerfd);
+    if (ctx->epfd != -1)
+        close(ctx->epfd);
+    res_ndestroy(&ctx->res);
+    free(ctx);
+}
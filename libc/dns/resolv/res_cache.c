@@ -30,6 +30,7 @@
 
 #include <resolv.h>
 #include <stdarg.h>
+#include <stdatomic.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -48,6 +49,10 @@
 #include "resolv_netid.h"
 #include "res_private.h"
 
+#include <android/libc_stats.h>
+
+#include "private/bionic_sections.h"
+#include "private/bionic_stats.h"
 #include "private/libc_logging.h"
 
 /* This code implements a small and *simple* DNS resolver cache.
@@ -137,7 +142,29 @@
  * *****************************************
  */
 #define  CONFIG_MAX_ENTRIES    64 * 2 * 5
-/* name of the system property that can be used to set the cache size */
+
+/* Each network's cache is limited in bytes rather than entries, since
+ * answers vary a lot in size; _resolv_set_cache_size_for_net() changes the
+ * limit. The default allows about 256 bytes for each of CONFIG_MAX_ENTRIES
+ * entries. The hash table has a bucket for every CONFIG_ENTRY_SIZE bytes,
+ * the size of a small entry, which also caps the number of entries.
+ */
+#define  CONFIG_ENTRY_SIZE     128
+#define  CONFIG_MAX_BYTES      (CONFIG_MAX_ENTRIES * 256)
+#define  CONFIG_MAX_BYTES_LIMIT  (64 * 1024 * 1024)
+
+/* the share of a cache's bytes that can be used by entries that have been
+ * hit since they were added (see _cache_remove_oldest) */
+#define  CONFIG_PROTECTED_PERCENT  80
+
+/* With _resolv_set_cache_stale_for_net(), an expired entry can still be
+ * served for a grace period while one caller refreshes it, and an entry
+ * that has been hit CONFIG_PREFETCH_HITS times in the last
+ * CONFIG_PREFETCH_PERCENT of its TTL is refreshed before it expires.
+ */
+#define  CONFIG_STALE_LIMIT        3600
+#define  CONFIG_PREFETCH_PERCENT   10
+#define  CONFIG_PREFETCH_HITS      3
 
 /****************************************************************************/
 /****************************************************************************/
@@ -988,19 +1015,31 @@ _dnsPacket_isEqualQuery( DnsPacket*  pack1, DnsPacket*  pack2 )
 /* cache entry. for simplicity, 'hash' and 'hlink' are inlined in this
  * structure though they are conceptually part of the hash table.
  *
- * similarly, mru_next and mru_prev are part of the global MRU list
+ * similarly, mru_next and mru_prev link the entry into one of the cache's
+ * two replacement lists, 'protected' says which, and 'referenced' is set
+ * by a cache hit: hits don't write to the lists, so they only need the
+ * cache's read lock.
+ *
+ * 'late_hits' counts the hits after 'prefetch_at', and 'refreshing' is set
+ * when a caller has been asked to refresh the entry (see
+ * _resolv_cache_lookup). both are also written under the read lock.
  */
 typedef struct Entry {
     unsigned int     hash;   /* hash value */
     struct Entry*    hlink;  /* next in collision chain */
     struct Entry*    mru_prev;
     struct Entry*    mru_next;
+    atomic_int       referenced;
+    int              protected;
 
     const uint8_t*   query;
     int              querylen;
     const uint8_t*   answer;
     int              answerlen;
     time_t           expires;   /* time_t when the entry isn't valid any more */
+    time_t           prefetch_at;
+    atomic_int       late_hits;
+    atomic_int       refreshing;
     int              id;        /* for debugging purpose */
 } Entry;
 
@@ -1158,15 +1197,20 @@ entry_init_key( Entry*  e, const void*  query, int  querylen )
     return _dnsPacket_checkQuery(pack);
 }
 
+/* the memory used by a cache node, which is a single block */
+static size_t
+entry_size( int  querylen, int  answerlen )
+{
+    return sizeof(Entry) + querylen + answerlen;
+}
+
 /* allocate a new entry as a cache node */
 static Entry*
 entry_alloc( const Entry*  init, const void*  answer, int  answerlen )
 {
     Entry*  e;
-    int     size;
 
-    size = sizeof(*e) + init->querylen + answerlen;
-    e    = calloc(size, 1);
+    e = calloc(entry_size(init->querylen, answerlen), 1);
     if (e == NULL)
         return e;
 
@@ -1217,16 +1261,41 @@ entry_equals( const Entry*  e1, const Entry*  e2 )
 typedef struct pending_req_info {
     unsigned int                hash;
     pthread_cond_t              cond;
+    int                         waiters;  /* threads waiting on cond */
+    int                         done;     /* the request has completed */
     struct pending_req_info*    next;
 } PendingReqInfo;
 
+/* Each cache has its own locks, so that lookups on one network don't wait
+ * for another. 'lock' protects the hash table and the replacement list:
+ * lookups take it for reading, and only adding or removing entries takes it
+ * for writing. 'pending_lock' protects the pending requests, and is never
+ * held while taking 'lock'.
+ *
+ * The list of caches holds a reference to each, and a thread waiting for
+ * a pending request holds another, since it doesn't hold
+ * _res_cache_list_lock while it waits.
+ */
 typedef struct resolv_cache {
-    int              max_entries;
+    int              max_entries;    /* also the number of hash buckets */
     int              num_entries;
-    Entry            mru_list;
+    size_t           max_bytes;
+    size_t           num_bytes;
+    size_t           protected_bytes;
+    time_t           stale_grace;    /* seconds an expired entry may still be used */
+    Entry            probation;      /* entries not hit since being added */
+    Entry            protected;      /* entries that have been */
     int              last_id;
-    Entry*           entries;
+    Entry**          entries;
     PendingReqInfo   pending_requests;
+    pthread_rwlock_t lock;
+    pthread_mutex_t  pending_lock;
+    atomic_int       refs;
+    atomic_uint_least64_t hits;
+    atomic_uint_least64_t misses;
+    atomic_uint_least64_t evictions;
+    atomic_uint_least64_t stale_hits;
+    atomic_uint_least64_t refreshes;
 } Cache;
 
 struct resolv_cache_info {
@@ -1239,6 +1308,11 @@ struct resolv_cache_info {
     int                         revision_id; // # times the nameservers have been replaced
     struct __res_params         params;
     struct __res_stats          nsstats[MAXNS];
+    struct __res_server_counters nscounters[MAXNS];
+    uint64_t                    queries;    // see struct __res_net_counters
+    uint64_t                    failures;
+    uint64_t                    attempts;
+    uint32_t                    latency[RES_RTT_BUCKETS];
     char                        defdname[MAXDNSRCHPATH];
     int                         dnsrch_offset[MAXDNSRCH+1];  // offsets into defdname
 };
@@ -1248,35 +1322,53 @@ struct resolv_cache_info {
 static pthread_once_t        _res_cache_once = PTHREAD_ONCE_INIT;
 static void _res_cache_init(void);
 
-// lock protecting everything in the _resolve_cache_info structs (next ptr, etc)
-static pthread_mutex_t _res_cache_list_lock;
+// lock protecting everything in the _resolve_cache_info structs (next ptr, etc).
+// Cache lookups and adds only need it for reading; see struct resolv_cache.
+static pthread_rwlock_t _res_cache_list_lock __BIONIC_FORK_WRITTEN;
 
 /* gets cache associated with a network, or NULL if none exists */
 static struct resolv_cache* _find_named_cache_locked(unsigned netid);
 
+static void _cache_unref( struct resolv_cache* cache );
+
+/* wake the threads waiting for a pending request, which has already been
+ * removed from the list. the last one out frees it. */
+static void
+_cache_complete_pending_request_locked( struct pending_req_info* ri )
+{
+    ri->done = 1;
+    pthread_cond_broadcast(&ri->cond);
+    if (ri->waiters == 0) {
+        pthread_cond_destroy(&ri->cond);
+        free(ri);
+    }
+}
+
 static void
-_cache_flush_pending_requests_locked( struct resolv_cache* cache )
+_cache_flush_pending_requests( struct resolv_cache* cache )
 {
     struct pending_req_info *ri, *tmp;
     if (cache) {
+        pthread_mutex_lock(&cache->pending_lock);
         ri = cache->pending_requests.next;
 
         while (ri) {
             tmp = ri;
             ri = ri->next;
-            pthread_cond_broadcast(&tmp->cond);
-
-            pthread_cond_destroy(&tmp->cond);
-            free(tmp);
+            _cache_complete_pending_request_locked(tmp);
         }
 
         cache->pending_requests.next = NULL;
+        pthread_mutex_unlock(&cache->pending_lock);
     }
 }
 
 /* Return 0 if no pending request is found matching the key.
  * If a matching request is found the calling thread will wait until
- * the matching request completes, then update *cache and return 1. */
+ * the matching request completes, then update *cache and return 1.
+ *
+ * Called with _res_cache_list_lock held for reading, which is dropped
+ * while waiting. */
 static int
 _cache_check_pending_request_locked( struct resolv_cache** cache, Entry* key, unsigned netid )
 {
@@ -1284,6 +1376,7 @@ _cache_check_pending_request_locked( struct resolv_cache** cache, Entry* key, un
     int exist = 0;
 
     if (*cache && key) {
+        pthread_mutex_lock(&(*cache)->pending_lock);
         ri = (*cache)->pending_requests.next;
         prev = &(*cache)->pending_requests;
         while (ri) {
@@ -1302,11 +1395,31 @@ _cache_check_pending_request_locked( struct resolv_cache** cache, Entry* key, un
                 pthread_cond_init(&ri->cond, NULL);
                 prev->next = ri;
             }
+            pthread_mutex_unlock(&(*cache)->pending_lock);
         } else {
+            struct resolv_cache* waiting_cache = *cache;
             struct timespec ts = {0,0};
             XLOG("Waiting for previous request");
             ts.tv_sec = _time_now() + PENDING_REQUEST_TIMEOUT;
-            pthread_cond_timedwait(&ri->cond, &_res_cache_list_lock, &ts);
+
+            /* Don't hold up changes to the cache list while waiting. */
+            atomic_fetch_add_explicit(&waiting_cache->refs, 1, memory_order_relaxed);
+            pthread_rwlock_unlock(&_res_cache_list_lock);
+
+            ++ri->waiters;
+            while (!ri->done) {
+                if (pthread_cond_timedwait(&ri->cond, &waiting_cache->pending_lock, &ts) != 0) {
+                    break;
+                }
+            }
+            if (--ri->waiters == 0 && ri->done) {
+                pthread_cond_destroy(&ri->cond);
+                free(ri);
+            }
+            pthread_mutex_unlock(&waiting_cache->pending_lock);
+
+            pthread_rwlock_rdlock(&_res_cache_list_lock);
+            _cache_unref(waiting_cache);
             /* Must update *cache as it could have been deleted. */
             *cache = _find_named_cache_locked(netid);
         }
@@ -1318,64 +1431,77 @@ _cache_check_pending_request_locked( struct resolv_cache** cache, Entry* key, un
 /* notify any waiting thread that waiting on a request
  * matching the key has been added to the cache */
 static void
-_cache_notify_waiting_tid_locked( struct resolv_cache* cache, Entry* key )
+_cache_notify_waiting_tid( struct resolv_cache* cache, Entry* key )
 {
     struct pending_req_info *ri, *prev;
 
     if (cache && key) {
+        pthread_mutex_lock(&cache->pending_lock);
         ri = cache->pending_requests.next;
         prev = &cache->pending_requests;
         while (ri) {
             if (ri->hash == key->hash) {
-                pthread_cond_broadcast(&ri->cond);
                 break;
             }
             prev = ri;
             ri = ri->next;
         }
 
-        // remove item from list and destroy
+        // remove item from list and wake its waiters
         if (ri) {
             prev->next = ri->next;
-            pthread_cond_destroy(&ri->cond);
-            free(ri);
+            _cache_complete_pending_request_locked(ri);
         }
+        pthread_mutex_unlock(&cache->pending_lock);
     }
 }
 
-/* notify the cache that the query failed */
+static Entry** _cache_lookup_p( Cache*  cache, Entry*  key );
+
+/* notify the cache that the query failed. if it was refreshing an entry,
+ * the next caller to use the entry is asked to try again. */
 void
 _resolv_cache_query_failed( unsigned    netid,
                    const void* query,
                    int         querylen)
 {
     Entry    key[1];
+    Entry*   e;
     Cache*   cache;
 
     if (!entry_init_key(key, query, querylen))
         return;
 
-    pthread_mutex_lock(&_res_cache_list_lock);
+    pthread_rwlock_rdlock(&_res_cache_list_lock);
 
     cache = _find_named_cache_locked(netid);
 
     if (cache) {
-        _cache_notify_waiting_tid_locked(cache, key);
+        if (cache->max_entries > 0) {
+            pthread_rwlock_rdlock(&cache->lock);
+            e = *_cache_lookup_p(cache, key);
+            if (e != NULL) {
+                atomic_store_explicit(&e->refreshing, 0, memory_order_relaxed);
+            }
+            pthread_rwlock_unlock(&cache->lock);
+        }
+        _cache_notify_waiting_tid(cache, key);
     }
 
-    pthread_mutex_unlock(&_res_cache_list_lock);
+    pthread_rwlock_unlock(&_res_cache_list_lock);
 }
 
 static struct resolv_cache_info* _find_cache_info_locked(unsigned netid);
 
 static void
-_cache_flush_locked( Cache*  cache )
+_cache_flush( Cache*  cache )
 {
     int     nn;
 
+    pthread_rwlock_wrlock(&cache->lock);
     for (nn = 0; nn < cache->max_entries; nn++)
     {
-        Entry**  pnode = (Entry**) &cache->entries[nn];
+        Entry**  pnode = &cache->entries[nn];
 
         while (*pnode != NULL) {
             Entry*  node = *pnode;
@@ -1384,22 +1510,26 @@ _cache_flush_locked( Cache*  cache )
         }
     }
 
-    // flush pending request
-    _cache_flush_pending_requests_locked(cache);
-
-    cache->mru_list.mru_next = cache->mru_list.mru_prev = &cache->mru_list;
+    cache->probation.mru_next = cache->probation.mru_prev = &cache->probation;
+    cache->protected.mru_next = cache->protected.mru_prev = &cache->protected;
     cache->num_entries       = 0;
+    cache->num_bytes         = 0;
+    cache->protected_bytes   = 0;
     cache->last_id           = 0;
+    pthread_rwlock_unlock(&cache->lock);
+
+    // flush pending request
+    _cache_flush_pending_requests(cache);
 
     XLOG("*************************\n"
          "*** DNS CACHE FLUSHED ***\n"
          "*************************");
 }
 
-static int
-_res_cache_get_max_entries( void )
+static size_t
+_res_cache_get_max_bytes( void )
 {
-    int cache_size = CONFIG_MAX_ENTRIES;
+    size_t cache_size = CONFIG_MAX_BYTES;
 
     const char* cache_mode = getenv("ANDROID_DNS_MODE");
     if (cache_mode == NULL || strcmp(cache_mode, "local") != 0) {
@@ -1407,10 +1537,21 @@ _res_cache_get_max_entries( void )
         cache_size = 0;
     }
 
-    XLOG("cache size: %d", cache_size);
+    XLOG("cache size: %zu", cache_size);
     return cache_size;
 }
 
+/* the number of entries (and hash buckets) for a cache of max_bytes */
+static int
+_res_cache_entries_for_bytes( size_t  max_bytes )
+{
+    if (max_bytes == 0)
+        return 0;
+    if (max_bytes < CONFIG_ENTRY_SIZE)
+        return 1;
+    return max_bytes / CONFIG_ENTRY_SIZE;
+}
+
 static struct resolv_cache*
 _resolv_cache_create( void )
 {
@@ -1418,10 +1559,15 @@ _resolv_cache_create( void )
 
     cache = calloc(sizeof(*cache), 1);
     if (cache) {
-        cache->max_entries = _res_cache_get_max_entries();
+        cache->max_bytes = _res_cache_get_max_bytes();
+        cache->max_entries = _res_cache_entries_for_bytes(cache->max_bytes);
         cache->entries = calloc(sizeof(*cache->entries), cache->max_entries);
         if (cache->entries) {
-            cache->mru_list.mru_prev = cache->mru_list.mru_next = &cache->mru_list;
+            cache->probation.mru_prev = cache->probation.mru_next = &cache->probation;
+            cache->protected.mru_prev = cache->protected.mru_next = &cache->protected;
+            pthread_rwlock_init(&cache->lock, NULL);
+            pthread_mutex_init(&cache->pending_lock, NULL);
+            atomic_init(&cache->refs, 1);
             XLOG("%s: cache created\n", __FUNCTION__);
         } else {
             free(cache);
@@ -1431,6 +1577,19 @@ _resolv_cache_create( void )
     return cache;
 }
 
+/* drop a reference to a cache, freeing it if that was the last */
+static void
+_cache_unref( Cache*  cache )
+{
+    if (atomic_fetch_sub_explicit(&cache->refs, 1, memory_order_acq_rel) == 1) {
+        _cache_flush(cache);
+        pthread_rwlock_destroy(&cache->lock);
+        pthread_mutex_destroy(&cache->pending_lock);
+        free(cache->entries);
+        free(cache);
+    }
+}
+
 
 #if DEBUG
 static void
@@ -1451,7 +1610,10 @@ _cache_dump_mru( Cache*  cache )
     Entry*  e;
 
     p = _bprint(temp, end, "MRU LIST (%2d): ", cache->num_entries);
-    for (e = cache->mru_list.mru_next; e != &cache->mru_list; e = e->mru_next)
+    for (e = cache->protected.mru_next; e != &cache->protected; e = e->mru_next)
+        p = _bprint(p, end, " %d", e->id);
+    p = _bprint(p, end, " |");
+    for (e = cache->probation.mru_next; e != &cache->probation; e = e->mru_next)
         p = _bprint(p, end, " %d", e->id);
 
     XLOG("%s", temp);
@@ -1519,7 +1681,7 @@ _cache_lookup_p( Cache*   cache,
                  Entry*   key )
 {
     int      index = key->hash % cache->max_entries;
-    Entry**  pnode = (Entry**) &cache->entries[ index ];
+    Entry**  pnode = &cache->entries[ index ];
 
     while (*pnode != NULL) {
         Entry*  node = *pnode;
@@ -1547,8 +1709,9 @@ _cache_add_p( Cache*   cache,
 {
     *lookup = e;
     e->id = ++cache->last_id;
-    entry_mru_add(e, &cache->mru_list);
+    entry_mru_add(e, &cache->probation);
     cache->num_entries += 1;
+    cache->num_bytes += entry_size(e->querylen, e->answerlen);
 
     XLOG("%s: entry %d added (count=%d)", __FUNCTION__,
          e->id, cache->num_entries);
@@ -1569,17 +1732,101 @@ _cache_remove_p( Cache*   cache,
 
     entry_mru_remove(e);
     *lookup = e->hlink;
-    entry_free(e);
     cache->num_entries -= 1;
+    cache->num_bytes -= entry_size(e->querylen, e->answerlen);
+    if (e->protected)
+        cache->protected_bytes -= entry_size(e->querylen, e->answerlen);
+    entry_free(e);
+}
+
+/* Remove the expired entries on one of the replacement lists.
+ */
+static void _cache_remove_expired_from(Cache* cache, Entry* list, time_t now) {
+    Entry* e;
+
+    for (e = list->mru_next; e != list;) {
+        // Entry is old, remove
+        if (now >= e->expires + cache->stale_grace) {
+            Entry** lookup = _cache_lookup_p(cache, e);
+            if (*lookup == NULL) { /* should not happen */
+                XLOG("%s: ENTRY NOT IN HTABLE ?", __FUNCTION__);
+                return;
+            }
+            e = e->mru_next;
+            _cache_remove_p(cache, lookup);
+        } else {
+            e = e->mru_next;
+        }
+    }
+}
+
+/* Remove all expired entries from the hash table.
+ */
+static void _cache_remove_expired(Cache* cache) {
+    time_t now = _time_now();
+
+    _cache_remove_expired_from(cache, &cache->probation, now);
+    _cache_remove_expired_from(cache, &cache->protected, now);
 }
 
-/* Remove the oldest entry from the hash table.
+/* Move entries from the end of the protected list back to probation until
+ * the protected entries fit in their share of the cache. Those that have
+ * been hit again since they were protected stay protected, and go back to
+ * the head of the list instead.
+ */
+static void
+_cache_balance_protected( Cache*  cache )
+{
+    size_t  limit = cache->max_bytes / 100 * CONFIG_PROTECTED_PERCENT;
+
+    while (cache->protected_bytes > limit) {
+        Entry*  e = cache->protected.mru_prev;
+
+        entry_mru_remove(e);
+        if (atomic_exchange_explicit(&e->referenced, 0, memory_order_relaxed)) {
+            entry_mru_add(e, &cache->protected);
+            continue;
+        }
+        e->protected = 0;
+        cache->protected_bytes -= entry_size(e->querylen, e->answerlen);
+        entry_mru_add(e, &cache->probation);
+    }
+}
+
+/* Remove an entry to make room for another (segmented LRU).
+ *
+ * New entries go on the probation list. One that has been hit by the time
+ * it reaches the end of that list moves to the protected list rather than
+ * being removed, so names that are looked up again and again survive a
+ * stream of names that are only looked up once. Cache hits only set the
+ * entry's 'referenced' bit, which is acted on here.
  */
 static void
 _cache_remove_oldest( Cache*  cache )
 {
-    Entry*   oldest = cache->mru_list.mru_prev;
-    Entry**  lookup = _cache_lookup_p(cache, oldest);
+    Entry*   oldest;
+    Entry**  lookup;
+
+    /* this ends, since each entry's bit is cleared as it's passed over */
+    for (;;) {
+        oldest = cache->probation.mru_prev;
+        if (oldest == &cache->probation)
+            break;
+        if (!atomic_exchange_explicit(&oldest->referenced, 0, memory_order_relaxed))
+            break;
+        entry_mru_remove(oldest);
+        entry_mru_add(oldest, &cache->protected);
+        oldest->protected = 1;
+        cache->protected_bytes += entry_size(oldest->querylen, oldest->answerlen);
+        _cache_balance_protected(cache);
+    }
+    if (oldest == &cache->probation) {
+        /* everything left has been hit: give up the oldest of those */
+        oldest = cache->protected.mru_prev;
+        if (oldest == &cache->protected)
+            return;
+    }
+    lookup = _cache_lookup_p(cache, oldest);
 
     if (*lookup == NULL) { /* should not happen */
         XLOG("%s: OLDEST NOT IN HTABLE ?", __FUNCTION__);
@@ -1590,37 +1837,78 @@ _cache_remove_oldest( Cache*  cache )
         XLOG_QUERY(oldest->query, oldest->querylen);
     }
     _cache_remove_p(cache, lookup);
+    atomic_fetch_add_explicit(&cache->evictions, 1, memory_order_relaxed);
 }
 
-/* Remove all expired entries from the hash table.
+/* Remove the oldest entries until there's room for one more of the given
+ * size. Returns 0 if it can't fit at all.
  */
-static void _cache_remove_expired(Cache* cache) {
-    Entry* e;
-    time_t now = _time_now();
+static int
+_cache_make_room( Cache*  cache, size_t  size )
+{
+    if (size > cache->max_bytes)
+        return 0;
+    if (cache->num_entries < cache->max_entries &&
+        cache->num_bytes + size <= cache->max_bytes)
+        return 1;
 
-    for (e = cache->mru_list.mru_next; e != &cache->mru_list;) {
-        // Entry is old, remove
-        if (now >= e->expires) {
-            Entry** lookup = _cache_lookup_p(cache, e);
-            if (*lookup == NULL) { /* should not happen */
-                XLOG("%s: ENTRY NOT IN HTABLE ?", __FUNCTION__);
-                return;
-            }
-            e = e->mru_next;
-            _cache_remove_p(cache, lookup);
-        } else {
-            e = e->mru_next;
+    _cache_remove_expired(cache);
+    while (cache->num_entries > 0 &&
+           (cache->num_entries >= cache->max_entries ||
+            cache->num_bytes + size > cache->max_bytes)) {
+        _cache_remove_oldest(cache);
+    }
+    return 1;
+}
+
+/* Change the cache's size limit, rebuilding its hash table to suit and
+ * removing entries if they no longer fit. Returns 0 or an errno value.
+ */
+static int
+_cache_resize( Cache*  cache, size_t  max_bytes )
+{
+    int      max_entries = _res_cache_entries_for_bytes(max_bytes);
+    Entry**  entries;
+    int      nn;
+
+    entries = calloc(sizeof(*entries), max_entries);
+    if (entries == NULL)
+        return ENOMEM;
+
+    pthread_rwlock_wrlock(&cache->lock);
+    for (nn = 0; nn < cache->max_entries; nn++) {
+        Entry*  node = cache->entries[nn];
+
+        while (node != NULL) {
+            Entry*  next = node->hlink;
+            int     index = node->hash % max_entries;
+
+            node->hlink = entries[index];
+            entries[index] = node;
+            node = next;
         }
     }
+    free(cache->entries);
+    cache->entries = entries;
+    cache->max_entries = max_entries;
+    cache->max_bytes = max_bytes;
+
+    _cache_balance_protected(cache);
+    while (cache->num_entries > cache->max_entries || cache->num_bytes > cache->max_bytes) {
+        _cache_remove_oldest(cache);
+    }
+    pthread_rwlock_unlock(&cache->lock);
+    return 0;
 }
 
-ResolvCacheStatus
-_resolv_cache_lookup( unsigned              netid,
-                      const void*           query,
-                      int                   querylen,
-                      void*                 answer,
-                      int                   answersize,
-                      int                  *answerlen )
+static ResolvCacheStatus
+_resolv_cache_lookup_internal( unsigned              netid,
+                               const void*           query,
+                               int                   querylen,
+                               void*                 answer,
+                               int                   answersize,
+                               int                  *answerlen,
+                               int                   wait )
 {
     Entry      key[1];
     Entry**    lookup;
@@ -1628,6 +1916,8 @@ _resolv_cache_lookup( unsigned              netid,
     time_t     now;
     Cache*     cache;
 
+    int        stale, refresh;
+
     ResolvCacheStatus  result = RESOLV_CACHE_NOTFOUND;
 
     XLOG("%s: lookup", __FUNCTION__);
@@ -1640,7 +1930,7 @@ _resolv_cache_lookup( unsigned              netid,
     }
     /* lookup cache */
     pthread_once(&_res_cache_once, _res_cache_init);
-    pthread_mutex_lock(&_res_cache_list_lock);
+    pthread_rwlock_rdlock(&_res_cache_list_lock);
 
     cache = _find_named_cache_locked(netid);
     if (cache == NULL) {
@@ -1651,19 +1941,23 @@ _resolv_cache_lookup( unsigned              netid,
     /* see the description of _lookup_p to understand this.
      * the function always return a non-NULL pointer.
      */
+    pthread_rwlock_rdlock(&cache->lock);
     lookup = _cache_lookup_p(cache, key);
     e      = *lookup;
 
     if (e == NULL) {
         XLOG( "NOT IN CACHE");
+        pthread_rwlock_unlock(&cache->lock);
         // calling thread will wait if an outstanding request is found
         // that matching this query
-        if (!_cache_check_pending_request_locked(&cache, key, netid) || cache == NULL) {
+        if (!wait || !_cache_check_pending_request_locked(&cache, key, netid) || cache == NULL) {
             goto Exit;
         } else {
+            pthread_rwlock_rdlock(&cache->lock);
             lookup = _cache_lookup_p(cache, key);
             e = *lookup;
             if (e == NULL) {
+                pthread_rwlock_unlock(&cache->lock);
                 goto Exit;
             }
         }
@@ -1671,11 +1965,20 @@ _resolv_cache_lookup( unsigned              netid,
 
     now = _time_now();
 
-    /* remove stale entries here */
-    if (now >= e->expires) {
+    /* remove stale entries here, unless they can still be served while
+     * they're refreshed */
+    if (now >= e->expires + cache->stale_grace) {
         XLOG( " NOT IN CACHE (STALE ENTRY %p DISCARDED)", *lookup );
         XLOG_QUERY(e->query, e->querylen);
-        _cache_remove_p(cache, lookup);
+        /* removing it needs the write lock, and someone may beat us to it */
+        pthread_rwlock_unlock(&cache->lock);
+        pthread_rwlock_wrlock(&cache->lock);
+        lookup = _cache_lookup_p(cache, key);
+        e = *lookup;
+        if (e != NULL && now >= e->expires + cache->stale_grace) {
+            _cache_remove_p(cache, lookup);
+        }
+        pthread_rwlock_unlock(&cache->lock);
         goto Exit;
     }
 
@@ -1684,25 +1987,74 @@ _resolv_cache_lookup( unsigned              netid,
         /* NOTE: we return UNSUPPORTED if the answer buffer is too short */
         result = RESOLV_CACHE_UNSUPPORTED;
         XLOG(" ANSWER TOO LONG");
+        pthread_rwlock_unlock(&cache->lock);
         goto Exit;
     }
 
     memcpy( answer, e->answer, e->answerlen );
 
-    /* bump up this entry to the top of the MRU list */
-    if (e != cache->mru_list.mru_next) {
-        entry_mru_remove( e );
-        entry_mru_add( e, &cache->mru_list );
+    /* give this entry a second chance when the cache is full. only
+     * writing when the bit changes keeps the cache line shared. */
+    if (!atomic_load_explicit(&e->referenced, memory_order_relaxed)) {
+        atomic_store_explicit(&e->referenced, 1, memory_order_relaxed);
+    }
+
+    /* an expired entry within its grace period, or a popular one that is
+     * about to expire, is refreshed by the one caller that gets here first.
+     * everyone else keeps using the cached answer meanwhile. */
+    stale = now >= e->expires;
+    refresh = 0;
+    if (now >= e->prefetch_at && cache->stale_grace > 0) {
+        if (stale || atomic_fetch_add_explicit(&e->late_hits, 1, memory_order_relaxed) + 1 >=
+                     CONFIG_PREFETCH_HITS) {
+            refresh = !atomic_exchange_explicit(&e->refreshing, 1, memory_order_relaxed);
+        }
     }
+    pthread_rwlock_unlock(&cache->lock);
 
-    XLOG( "FOUND IN CACHE entry=%p", e );
-    result = RESOLV_CACHE_FOUND;
+    XLOG( "FOUND IN CACHE entry=%p%s", e, stale ? " (STALE)" : "" );
+    result = refresh ? RESOLV_CACHE_FOUND_REFRESH : RESOLV_CACHE_FOUND;
+    if (stale) {
+        atomic_fetch_add_explicit(&cache->stale_hits, 1, memory_order_relaxed);
+    }
+    if (refresh) {
+        atomic_fetch_add_explicit(&cache->refreshes, 1, memory_order_relaxed);
+    }
 
 Exit:
-    pthread_mutex_unlock(&_res_cache_list_lock);
+    if (cache != NULL) {
+        atomic_fetch_add_explicit(result == RESOLV_CACHE_FOUND ||
+                                  result == RESOLV_CACHE_FOUND_REFRESH ? &cache->hits : &cache->misses,
+                                  1, memory_order_relaxed);
+    }
+    pthread_rwlock_unlock(&_res_cache_list_lock);
     return result;
 }
 
+ResolvCacheStatus
+_resolv_cache_lookup( unsigned              netid,
+                      const void*           query,
+                      int                   querylen,
+                      void*                 answer,
+                      int                   answersize,
+                      int                  *answerlen )
+{
+    return _resolv_cache_lookup_internal(netid, query, querylen, answer, answersize,
+                                         answerlen, 1);
+}
+
+ResolvCacheStatus
+_resolv_cache_lookup_nowait( unsigned              netid,
+                             const void*           query,
+                             int                   querylen,
+                             void*                 answer,
+                             int                   answersize,
+                             int                  *answerlen )
+{
+    return _resolv_cache_lookup_internal(netid, query, querylen, answer, answersize,
+                                         answerlen, 0);
+}
+
 
 void
 _resolv_cache_add( unsigned              netid,
@@ -1724,13 +2076,14 @@ _resolv_cache_add( unsigned              netid,
         return;
     }
 
-    pthread_mutex_lock(&_res_cache_list_lock);
+    pthread_rwlock_rdlock(&_res_cache_list_lock);
 
     cache = _find_named_cache_locked(netid);
     if (cache == NULL) {
         goto Exit;
     }
 
+    pthread_rwlock_wrlock(&cache->lock);
     XLOG( "%s: query:", __FUNCTION__ );
     XLOG_QUERY(query,querylen);
     XLOG_ANSWER(answer, answerlen);
@@ -1742,43 +2095,40 @@ _resolv_cache_add( unsigned              netid,
     lookup = _cache_lookup_p(cache, key);
     e      = *lookup;
 
-    if (e != NULL) { /* should not happen */
-        XLOG("%s: ALREADY IN CACHE (%p) ? IGNORING ADD",
-             __FUNCTION__, e);
-        goto Exit;
+    if (e != NULL) {
+        /* this is the answer to a refresh (see _resolv_cache_lookup) */
+        XLOG("%s: ALREADY IN CACHE (%p), REPLACING", __FUNCTION__, e);
+        _cache_remove_p(cache, lookup);
     }
 
-    if (cache->num_entries >= cache->max_entries) {
-        _cache_remove_expired(cache);
-        if (cache->num_entries >= cache->max_entries) {
-            _cache_remove_oldest(cache);
-        }
-        /* need to lookup again */
-        lookup = _cache_lookup_p(cache, key);
-        e      = *lookup;
-        if (e != NULL) {
-            XLOG("%s: ALREADY IN CACHE (%p) ? IGNORING ADD",
-                __FUNCTION__, e);
-            goto Exit;
-        }
+    ttl = answer_getTTL(answer, answerlen);
+    if (ttl == 0) {
+        goto Unlock;
     }
 
-    ttl = answer_getTTL(answer, answerlen);
-    if (ttl > 0) {
-        e = entry_alloc(key, answer, answerlen);
-        if (e != NULL) {
-            e->expires = ttl + _time_now();
-            _cache_add_p(cache, lookup, e);
-        }
+    if (!_cache_make_room(cache, entry_size(key->querylen, answerlen))) {
+        XLOG("%s: ANSWER TOO LONG FOR CACHE", __FUNCTION__);
+        goto Unlock;
+    }
+    /* need to lookup again */
+    lookup = _cache_lookup_p(cache, key);
+
+    e = entry_alloc(key, answer, answerlen);
+    if (e != NULL) {
+        e->expires = ttl + _time_now();
+        e->prefetch_at = e->expires - ttl * CONFIG_PREFETCH_PERCENT / 100;
+        _cache_add_p(cache, lookup, e);
     }
 #if DEBUG
     _cache_dump_mru(cache);
 #endif
+Unlock:
+    pthread_rwlock_unlock(&cache->lock);
 Exit:
     if (cache != NULL) {
-      _cache_notify_waiting_tid_locked(cache, key);
+      _cache_notify_waiting_tid(cache, key);
     }
-    pthread_mutex_unlock(&_res_cache_list_lock);
+    pthread_rwlock_unlock(&_res_cache_list_lock);
 }
 
 /****************************************************************************/
@@ -1822,7 +2172,7 @@ _res_cache_init(void)
     }
 
     memset(&_res_cache_list, 0, sizeof(_res_cache_list));
-    pthread_mutex_init(&_res_cache_list_lock, NULL);
+    pthread_rwlock_init(&_res_cache_list_lock, NULL);
 }
 
 static struct resolv_cache*
@@ -1849,11 +2199,11 @@ void
 _resolv_flush_cache_for_net(unsigned netid)
 {
     pthread_once(&_res_cache_once, _res_cache_init);
-    pthread_mutex_lock(&_res_cache_list_lock);
+    pthread_rwlock_wrlock(&_res_cache_list_lock);
 
     _flush_cache_for_net_locked(netid);
 
-    pthread_mutex_unlock(&_res_cache_list_lock);
+    pthread_rwlock_unlock(&_res_cache_list_lock);
 }
 
 static void
@@ -1861,7 +2211,7 @@ _flush_cache_for_net_locked(unsigned netid)
 {
     struct resolv_cache* cache = _find_named_cache_locked(netid);
     if (cache) {
-        _cache_flush_locked(cache);
+        _cache_flush(cache);
     }
 
     // Also clear the NS statistics.
@@ -1872,7 +2222,7 @@ _flush_cache_for_net_locked(unsigned netid)
 void _resolv_delete_cache_for_net(unsigned netid)
 {
     pthread_once(&_res_cache_once, _res_cache_init);
-    pthread_mutex_lock(&_res_cache_list_lock);
+    pthread_rwlock_wrlock(&_res_cache_list_lock);
 
     struct resolv_cache_info* prev_cache_info = &_res_cache_list;
 
@@ -1881,9 +2231,7 @@ void _resolv_delete_cache_for_net(unsigned netid)
 
         if (cache_info->netid == netid) {
             prev_cache_info->next = cache_info->next;
-            _cache_flush_locked(cache_info->cache);
-            free(cache_info->cache->entries);
-            free(cache_info->cache);
+            _cache_unref(cache_info->cache);
             _free_nameservers_locked(cache_info);
             free(cache_info);
             break;
@@ -1892,7 +2240,94 @@ void _resolv_delete_cache_for_net(unsigned netid)
         prev_cache_info = prev_cache_info->next;
     }
 
-    pthread_mutex_unlock(&_res_cache_list_lock);
+    pthread_rwlock_unlock(&_res_cache_list_lock);
+}
+
+int
+_resolv_set_cache_size_for_net(unsigned netid, size_t max_bytes)
+{
+    int rc = 0;
+
+    if (max_bytes == 0) {
+        max_bytes = CONFIG_MAX_BYTES;
+    }
+    if (max_bytes > CONFIG_MAX_BYTES_LIMIT) {
+        XLOG("%s: max_bytes=%zu, limit=%d", __FUNCTION__, max_bytes, CONFIG_MAX_BYTES_LIMIT);
+        return EINVAL;
+    }
+
+    pthread_once(&_res_cache_once, _res_cache_init);
+    pthread_rwlock_rdlock(&_res_cache_list_lock);
+
+    struct resolv_cache* cache = _find_named_cache_locked(netid);
+    if (cache == NULL) {
+        rc = ENOENT;
+    } else if (cache->max_bytes != 0) {
+        // A cache of size 0 is one this process doesn't use; leave it alone.
+        rc = _cache_resize(cache, max_bytes);
+    }
+
+    pthread_rwlock_unlock(&_res_cache_list_lock);
+    return rc;
+}
+
+int
+_resolv_set_cache_stale_for_net(unsigned netid, unsigned grace_seconds)
+{
+    int rc = 0;
+
+    if (grace_seconds > CONFIG_STALE_LIMIT) {
+        XLOG("%s: grace_seconds=%u, limit=%d", __FUNCTION__, grace_seconds, CONFIG_STALE_LIMIT);
+        return EINVAL;
+    }
+
+    pthread_once(&_res_cache_once, _res_cache_init);
+    pthread_rwlock_rdlock(&_res_cache_list_lock);
+
+    struct resolv_cache* cache = _find_named_cache_locked(netid);
+    if (cache == NULL) {
+        rc = ENOENT;
+    } else {
+        pthread_rwlock_wrlock(&cache->lock);
+        cache->stale_grace = grace_seconds;
+        pthread_rwlock_unlock(&cache->lock);
+    }
+
+    pthread_rwlock_unlock(&_res_cache_list_lock);
+    return rc;
+}
+
+static void
+_get_cache_counters_locked(struct resolv_cache* cache, struct __res_cache_counters* counters)
+{
+    counters->hits = atomic_load_explicit(&cache->hits, memory_order_relaxed);
+    counters->misses = atomic_load_explicit(&cache->misses, memory_order_relaxed);
+    counters->evictions = atomic_load_explicit(&cache->evictions, memory_order_relaxed);
+    counters->stale_hits = atomic_load_explicit(&cache->stale_hits, memory_order_relaxed);
+    counters->refreshes = atomic_load_explicit(&cache->refreshes, memory_order_relaxed);
+    pthread_rwlock_rdlock(&cache->lock);
+    counters->entries = cache->num_entries;
+    counters->bytes = cache->num_bytes;
+    counters->max_bytes = cache->max_bytes;
+    pthread_rwlock_unlock(&cache->lock);
+}
+
+int
+android_net_res_cache_get_counters_for_net(unsigned netid, struct __res_cache_counters* counters)
+{
+    pthread_once(&_res_cache_once, _res_cache_init);
+    pthread_rwlock_rdlock(&_res_cache_list_lock);
+
+    struct resolv_cache* cache = _find_named_cache_locked(netid);
+    if (cache == NULL) {
+        pthread_rwlock_unlock(&_res_cache_list_lock);
+        errno = ENOENT;
+        return -1;
+    }
+    _get_cache_counters_locked(cache, counters);
+
+    pthread_rwlock_unlock(&_res_cache_list_lock);
+    return 0;
 }
 
 static struct resolv_cache_info*
@@ -1984,7 +2419,7 @@ _resolv_set_nameservers_for_net(unsigned netid, const char** servers, unsigned n
     }
 
     pthread_once(&_res_cache_once, _res_cache_init);
-    pthread_mutex_lock(&_res_cache_list_lock);
+    pthread_rwlock_wrlock(&_res_cache_list_lock);
 
     // creates the cache if not created
     _get_res_cache_for_net_locked(netid);
@@ -2056,7 +2491,7 @@ _resolv_set_nameservers_for_net(unsigned netid, const char** servers, unsigned n
         *offset = -1; /* cache_info->dnsrch_offset has MAXDNSRCH+1 items */
     }
 
-    pthread_mutex_unlock(&_res_cache_list_lock);
+    pthread_rwlock_unlock(&_res_cache_list_lock);
     return 0;
 }
 
@@ -2102,6 +2537,7 @@ _free_nameservers_locked(struct resolv_cache_info* cache_info)
         cache_info->nsstats[i].sample_count =
             cache_info->nsstats[i].sample_next = 0;
     }
+    memset(cache_info->nscounters, 0, sizeof(cache_info->nscounters));
     cache_info->nscount = 0;
     _res_cache_clear_stats_locked(cache_info);
     ++cache_info->revision_id;
@@ -2115,7 +2551,7 @@ _resolv_populate_res_for_net(res_state statp)
     }
 
     pthread_once(&_res_cache_once, _res_cache_init);
-    pthread_mutex_lock(&_res_cache_list_lock);
+    pthread_rwlock_rdlock(&_res_cache_list_lock);
 
     struct resolv_cache_info* info = _find_cache_info_locked(statp->netid);
     if (info != NULL) {
@@ -2156,7 +2592,7 @@ _resolv_populate_res_for_net(res_state statp)
             *pp++ = &statp->defdname[0] + *p++;
         }
     }
-    pthread_mutex_unlock(&_res_cache_list_lock);
+    pthread_rwlock_unlock(&_res_cache_list_lock);
 }
 
 /* Resolver reachability statistics. */
@@ -2191,12 +2627,12 @@ android_net_res_stats_get_info_for_net(unsigned netid, int* nscount,
         struct sockaddr_storage servers[MAXNS], int* dcount, char domains[MAXDNSRCH][MAXDNSRCHPATH],
         struct __res_params* params, struct __res_stats stats[MAXNS]) {
     int revision_id = -1;
-    pthread_mutex_lock(&_res_cache_list_lock);
+    pthread_rwlock_rdlock(&_res_cache_list_lock);
 
     struct resolv_cache_info* info = _find_cache_info_locked(netid);
     if (info) {
         if (info->nscount > MAXNS) {
-            pthread_mutex_unlock(&_res_cache_list_lock);
+            pthread_rwlock_unlock(&_res_cache_list_lock);
             XLOG("%s: nscount %d > MAXNS %d", __FUNCTION__, info->nscount, MAXNS);
             errno = EFAULT;
             return -1;
@@ -2210,19 +2646,19 @@ android_net_res_stats_get_info_for_net(unsigned netid, int* nscount,
             int addrlen = info->nsaddrinfo[i]->ai_addrlen;
             if (addrlen < (int) sizeof(struct sockaddr) ||
                     addrlen > (int) sizeof(servers[0])) {
-                pthread_mutex_unlock(&_res_cache_list_lock);
+                pthread_rwlock_unlock(&_res_cache_list_lock);
                 XLOG("%s: nsaddrinfo[%d].ai_addrlen == %d", __FUNCTION__, i, addrlen);
                 errno = EMSGSIZE;
                 return -1;
             }
             if (info->nsaddrinfo[i]->ai_addr == NULL) {
-                pthread_mutex_unlock(&_res_cache_list_lock);
+                pthread_rwlock_unlock(&_res_cache_list_lock);
                 XLOG("%s: nsaddrinfo[%d].ai_addr == NULL", __FUNCTION__, i);
                 errno = ENOENT;
                 return -1;
             }
             if (info->nsaddrinfo[i]->ai_next != NULL) {
-                pthread_mutex_unlock(&_res_cache_list_lock);
+                pthread_rwlock_unlock(&_res_cache_list_lock);
                 XLOG("%s: nsaddrinfo[%d].ai_next != NULL", __FUNCTION__, i);
                 errno = ENOTUNIQ;
                 return -1;
@@ -2250,7 +2686,7 @@ android_net_res_stats_get_info_for_net(unsigned netid, int* nscount,
         revision_id = info->revision_id;
     }
 
-    pthread_mutex_unlock(&_res_cache_list_lock);
+    pthread_rwlock_unlock(&_res_cache_list_lock);
     return revision_id;
 }
 
@@ -2258,7 +2694,7 @@ int
 _resolv_cache_get_resolver_stats( unsigned netid, struct __res_params* params,
         struct __res_stats stats[MAXNS]) {
     int revision_id = -1;
-    pthread_mutex_lock(&_res_cache_list_lock);
+    pthread_rwlock_rdlock(&_res_cache_list_lock);
 
     struct resolv_cache_info* info = _find_cache_info_locked(netid);
     if (info) {
@@ -2267,23 +2703,233 @@ _resolv_cache_get_resolver_stats( unsigned netid, struct __res_params* params,
         revision_id = info->revision_id;
     }
 
-    pthread_mutex_unlock(&_res_cache_list_lock);
+    pthread_rwlock_unlock(&_res_cache_list_lock);
     return revision_id;
 }
 
+static void
+_res_cache_count_attempt_locked(struct resolv_cache_info* info, int ns,
+        const struct __res_sample* sample) {
+    struct __res_server_counters* counters = &info->nscounters[ns];
+
+    ++info->attempts;
+    ++counters->attempts;
+    // Classified as in android_net_res_stats_aggregate().
+    switch (sample->rcode) {
+    case NOERROR:
+    case NOTAUTH:
+    case NXDOMAIN:
+        ++counters->successes;
+        ++counters->rtt[_res_stats_rtt_bucket(sample->rtt)];
+        break;
+    case RCODE_TIMEOUT:
+        ++counters->timeouts;
+        break;
+    case RCODE_INTERNAL_ERROR:
+        ++counters->internal_errors;
+        break;
+    default:
+        ++counters->errors;
+        ++counters->rtt[_res_stats_rtt_bucket(sample->rtt)];
+        break;
+    }
+}
+
 void
 _resolv_cache_add_resolver_stats_sample( unsigned netid, int revision_id, int ns,
        const struct __res_sample* sample, int max_samples) {
-    if (max_samples <= 0) return;
-
-    pthread_mutex_lock(&_res_cache_list_lock);
+    pthread_rwlock_wrlock(&_res_cache_list_lock);
 
     struct resolv_cache_info* info = _find_cache_info_locked(netid);
 
     if (info && info->revision_id == revision_id) {
-        _res_cache_add_stats_sample_locked(&info->nsstats[ns], sample, max_samples);
+        _res_cache_count_attempt_locked(info, ns, sample);
+        if (max_samples > 0) {
+            _res_cache_add_stats_sample_locked(&info->nsstats[ns], sample, max_samples);
+        }
+    }
+
+    pthread_rwlock_unlock(&_res_cache_list_lock);
+}
+
+void
+_resolv_cache_add_query_stats( unsigned netid, int latency, int answered) {
+    pthread_rwlock_wrlock(&_res_cache_list_lock);
+
+    struct resolv_cache_info* info = _find_cache_info_locked(netid);
+
+    if (info) {
+        ++info->queries;
+        if (!answered) {
+            ++info->failures;
+        }
+        ++info->latency[_res_stats_rtt_bucket(latency)];
     }
 
-    pthread_mutex_unlock(&_res_cache_list_lock);
+    pthread_rwlock_unlock(&_res_cache_list_lock);
+}
+
+static void
+_get_net_counters_locked(struct resolv_cache_info* info, struct __res_net_counters* counters) {
+    memset(counters, 0, sizeof(*counters));
+    if (info->cache) {
+        _get_cache_counters_locked(info->cache, &counters->cache);
+    }
+    counters->queries = info->queries;
+    counters->failures = info->failures;
+    // Every attempt after a query's first, whether to the same server or another.
+    counters->retries = info->attempts > info->queries ? info->attempts - info->queries : 0;
+    memcpy(counters->latency, info->latency, sizeof(counters->latency));
+    counters->nscount = info->nscount;
+    for (int i = 0; i < info->nscount && i < MAXNS; i++) {
+        const struct addrinfo* ai = info->nsaddrinfo[i];
+        if (ai != NULL && ai->ai_addr != NULL &&
+                ai->ai_addrlen <= sizeof(counters->servers[i])) {
+            memcpy(&counters->servers[i], ai->ai_addr, ai->ai_addrlen);
+        }
+        counters->server_counters[i] = info->nscounters[i];
+    }
+}
+
+int
+android_net_res_stats_get_counters_for_net(unsigned netid, struct __res_net_counters* counters) {
+    pthread_once(&_res_cache_once, _res_cache_init);
+    pthread_rwlock_rdlock(&_res_cache_list_lock);
+
+    struct resolv_cache_info* info = _find_cache_info_locked(netid);
+    if (info == NULL) {
+        pthread_rwlock_unlock(&_res_cache_list_lock);
+        errno = ENOENT;
+        return -1;
+    }
+    _get_net_counters_locked(info, counters);
+
+    pthread_rwlock_unlock(&_res_cache_list_lock);
+    return 0;
+}
+
+static void
+_dump_rtt_histogram(int fd, const char* label, const uint32_t histogram[RES_RTT_BUCKETS]) {
+    int i;
+    for (i = 0; i < RES_RTT_BUCKETS && histogram[i] == 0; i++) {
+    }
+    if (i == RES_RTT_BUCKETS) {
+        return;
+    }
+    dprintf(fd, "    %s:", label);
+    for (; i < RES_RTT_BUCKETS; i++) {
+        if (histogram[i] == 0) {
+            continue;
+        }
+        if (i == 0) {
+            dprintf(fd, " <1ms %u", histogram[i]);
+        } else if (i == RES_RTT_BUCKETS - 1) {
+            dprintf(fd, " >=%dms %u", 1 << (i - 1), histogram[i]);
+        } else {
+            dprintf(fd, " %d-%dms %u", 1 << (i - 1), 1 << i, histogram[i]);
+        }
+    }
+    dprintf(fd, "\n");
+}
+
+void
+android_net_res_stats_dump(int fd) {
+    pthread_once(&_res_cache_once, _res_cache_init);
+    pthread_rwlock_rdlock(&_res_cache_list_lock);
+
+    for (struct resolv_cache_info* info = _res_cache_list.next; info; info = info->next) {
+        struct __res_net_counters c;
+        _get_net_counters_locked(info, &c);
+
+        dprintf(fd, "netid %u:\n", info->netid);
+        dprintf(fd, "  cache: %llu hits (%llu stale, %llu refreshed), %llu misses, "
+                "%llu evictions, %u entries, %u/%u bytes\n",
+                (unsigned long long) c.cache.hits, (unsigned long long) c.cache.stale_hits,
+                (unsigned long long) c.cache.refreshes, (unsigned long long) c.cache.misses,
+                (unsigned long long) c.cache.evictions, c.cache.entries, c.cache.bytes,
+                c.cache.max_bytes);
+        dprintf(fd, "  queries: %llu sent, %llu failed, %llu retries\n",
+                (unsigned long long) c.queries, (unsigned long long) c.failures,
+                (unsigned long long) c.retries);
+        _dump_rtt_histogram(fd, "latency", c.latency);
+        for (int i = 0; i < c.nscount && i < MAXNS; i++) {
+            const struct __res_server_counters* s = &c.server_counters[i];
+            char host[NI_MAXHOST];
+            if (getnameinfo((const struct sockaddr*) &c.servers[i], sizeof(c.servers[i]),
+                    host, sizeof(host), NULL, 0, NI_NUMERICHOST) != 0) {
+                strlcpy(host, "?", sizeof(host));
+            }
+            dprintf(fd, "  server %s: %llu attempts, %llu successes, %llu errors, "
+                    "%llu timeouts, %llu internal errors\n", host,
+                    (unsigned long long) s->attempts, (unsigned long long) s->successes,
+                    (unsigned long long) s->errors, (unsigned long long) s->timeouts,
+                    (unsigned long long) s->internal_errors);
+            _dump_rtt_histogram(fd, "rtt", s->rtt);
+        }
+    }
+
+    pthread_rwlock_unlock(&_res_cache_list_lock);
+}
+
+static void
+_report_stat(void (*callback)(const struct android_libc_stat*, void*), void* arg,
+             const char* name, int type, uint64_t value) {
+    struct android_libc_stat stat = { name, type, value, 0, NULL, NULL };
+    callback(&stat, arg);
+}
+
+void
+_resolv_cache_libc_stats(void (*callback)(const struct android_libc_stat*, void*), void* arg) {
+    pthread_once(&_res_cache_once, _res_cache_init);
+    pthread_rwlock_rdlock(&_res_cache_list_lock);
+
+    struct __res_net_counters total;
+    memset(&total, 0, sizeof(total));
+    for (struct resolv_cache_info* info = _res_cache_list.next; info; info = info->next) {
+        struct __res_net_counters c;
+        _get_net_counters_locked(info, &c);
+        total.cache.hits += c.cache.hits;
+        total.cache.misses += c.cache.misses;
+        total.cache.evictions += c.cache.evictions;
+        total.cache.stale_hits += c.cache.stale_hits;
+        total.cache.refreshes += c.cache.refreshes;
+        total.cache.entries += c.cache.entries;
+        total.cache.bytes += c.cache.bytes;
+        total.queries += c.queries;
+        total.failures += c.failures;
+        total.retries += c.retries;
+        for (int i = 0; i < RES_RTT_BUCKETS; i++) {
+            total.latency[i] += c.latency[i];
+        }
+    }
+
+    pthread_rwlock_unlock(&_res_cache_list_lock);
+
+    _report_stat(callback, arg, "dns.cache.hits", ANDROID_LIBC_STAT_COUNTER, total.cache.hits);
+    _report_stat(callback, arg, "dns.cache.misses", ANDROID_LIBC_STAT_COUNTER, total.cache.misses);
+    _report_stat(callback, arg, "dns.cache.evictions", ANDROID_LIBC_STAT_COUNTER,
+                 total.cache.evictions);
+    _report_stat(callback, arg, "dns.cache.stale_hits", ANDROID_LIBC_STAT_COUNTER,
+                 total.cache.stale_hits);
+    _report_stat(callback, arg, "dns.cache.refreshes", ANDROID_LIBC_STAT_COUNTER,
+                 total.cache.refreshes);
+    _report_stat(callback, arg, "dns.cache.entries", ANDROID_LIBC_STAT_GAUGE, total.cache.entries);
+    _report_stat(callback, arg, "dns.cache.bytes", ANDROID_LIBC_STAT_GAUGE, total.cache.bytes);
+    _report_stat(callback, arg, "dns.queries", ANDROID_LIBC_STAT_COUNTER, total.queries);
+    _report_stat(callback, arg, "dns.failures", ANDROID_LIBC_STAT_COUNTER, total.failures);
+    _report_stat(callback, arg, "dns.retries", ANDROID_LIBC_STAT_COUNTER, total.retries);
+
+    // See _res_stats_rtt_bucket(): bucket 0 is under 1ms, and bucket i up to 2^i ms.
+    uint64_t limits[RES_RTT_BUCKETS];
+    uint64_t buckets[RES_RTT_BUCKETS];
+    struct android_libc_stat latency = {
+        "dns.latency_ms", ANDROID_LIBC_STAT_HISTOGRAM, 0, RES_RTT_BUCKETS, limits, buckets
+    };
+    for (int i = 0; i < RES_RTT_BUCKETS; i++) {
+        limits[i] = (i == RES_RTT_BUCKETS - 1) ? UINT64_MAX : (UINT64_C(1) << i) - 1;
+        buckets[i] = total.latency[i];
+        latency.value += buckets[i];
+    }
+    callback(&latency, arg);
 }
 
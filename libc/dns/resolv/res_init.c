@@ -555,6 +555,8 @@ res_setoptions(res_state statp, const char *options, const char *source)
 			statp->options |= RES_USE_INET6;
 		} else if (!strncmp(cp, "rotate", sizeof("rotate") - 1)) {
 			statp->options |= RES_ROTATE;
+		} else if (!strncmp(cp, "parallel", sizeof("parallel") - 1)) {
+			statp->options |= RES_PARALLEL;
 		} else if (!strncmp(cp, "no-check-names",
 				    sizeof("no-check-names") - 1)) {
 			statp->options |= RES_NOCHECKNAME;
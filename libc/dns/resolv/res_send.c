@@ -98,6 +98,8 @@ __RCSID("$NetBSD: res_send.c,v 1.9 2006/01/24 17:41:25 christos Exp $");
 #include <errno.h>
 #include <fcntl.h>
 #include <netdb.h>
+#include <poll.h>
+#include <pthread.h>
 #ifdef ANDROID_CHANGES
 #include "resolv_netid.h"
 #include "resolv_private.h"
@@ -133,32 +135,63 @@ __RCSID("$NetBSD: res_send.c,v 1.9 2006/01/24 17:41:25 christos Exp $");
 #define EXT(res) ((res)->_u._ext)
 #define DBG 0
 
-static const int highestFD = FD_SETSIZE - 1;
+/* One of the queries sent together by res_nsend_pair(). */
+struct dg_query {
+	const u_char *buf;
+	int buflen;
+	u_char *ans;
+	int anssiz;
+	ResolvCacheStatus cache_status;
+	int resplen;		/* > 0 once answered */
+	int truncated;		/* needs TCP */
+	int sent;		/* sent to the current nameserver */
+	int waiting;		/* sent, but no answer yet */
+	int rcode;
+	int delay;
+};
 
 /* Forward. */
 
 static int		get_salen __P((const struct sockaddr *));
 static struct sockaddr * get_nsaddr __P((res_state, size_t));
 static int		send_vc(res_state, const u_char *, int,
-				u_char *, int, int *, int,
+				u_char *, int, int *, int, int,
 				time_t *, int *, int *);
+static int		vc_idle_timeout(const struct __res_params *,
+				struct __res_stats *);
+static int		vc_pool_get(struct sockaddr *, unsigned);
+static void		vc_pool_put(int, struct sockaddr *, unsigned, int);
 static int		send_dg(res_state, const u_char *, int,
 				u_char *, int, int *, int,
 				int *, int *,
 				time_t *, int *, int *);
+static int		open_dg(res_state, int, int *);
+static int		send_dg_pair(res_state, struct dg_query *, int, int,
+				int *, int *, time_t *);
+static int		send_dg_staggered(res_state, struct dg_query *, int,
+				const bool *, struct __res_stats *,
+				const struct __res_params *, int, int,
+				int *, int *);
+static void		send_dg_queries(res_state, struct dg_query *, int);
+static void		add_stats_sample(res_state, int,
+				const struct __res_params *, int, time_t,
+				int, int, int);
+static void		res_nsend_prepare(res_state);
+static int		res_nsend_uncached(res_state, const u_char *, int,
+				u_char *, int, ResolvCacheStatus);
+static void		res_nsend_refresh(res_state, const u_char *, int);
+static int		res_nsend_servers(res_state, const u_char *, int,
+				u_char *, int, int, ResolvCacheStatus);
 static void		Aerror(const res_state, FILE *, const char *, int,
 			       const struct sockaddr *, int);
 static void		Perror(const res_state, FILE *, const char *, int);
 static int		sock_eq(struct sockaddr *, struct sockaddr *);
-#ifdef NEED_PSELECT
-static int		pselect(int, void *, void *, void *,
-				struct timespec *,
-				const sigset_t *);
-#endif
 void res_pquery(const res_state, const u_char *, int, FILE *);
 static int connect_with_timeout(int sock, const struct sockaddr *nsap,
 			socklen_t salen, int sec);
-static int retrying_select(const int sock, fd_set *readset, fd_set *writeset,
+static int poll_until(struct pollfd *fds, nfds_t nfds,
+			const struct timespec *finish);
+static int retrying_poll(const int sock, const short events,
 			const struct timespec *finish);
 
 /* BIONIC-BEGIN: implement source port randomization */
@@ -218,6 +251,35 @@ random_bind( int  s, int  family )
 
 static const int niflags = NI_NUMERICHOST | NI_NUMERICSERV;
 
+/* In RES_PARALLEL mode, how long to wait for a nameserver to answer
+ * before asking the next one as well; see get_parallel_delay(). */
+#define RES_PARALLEL_DELAY_MS		250
+#define RES_PARALLEL_MIN_DELAY_MS	50
+#define RES_PARALLEL_MAX_DELAY_MS	1000
+
+/*
+ * TCP connections to nameservers that send_vc() has finished with are kept
+ * for a while, shared by all threads, so that a run of answers too large
+ * for UDP doesn't pay for a handshake each.  Each connection is used by one
+ * query at a time.  How long one is kept depends on how the server has
+ * been doing; see vc_idle_timeout().
+ */
+#define VC_POOL_SIZE		8
+#define VC_IDLE_TIMEOUT		30	/* seconds, for a server that always answers */
+#define VC_IDLE_MIN_TIMEOUT	5	/* seconds, for one with too few samples to tell */
+
+struct vc_conn {
+	int fd;
+	unsigned mark;
+	union res_sockaddr_union addr;
+	time_t expires;
+};
+
+static struct vc_conn vc_pool[VC_POOL_SIZE];
+static int vc_pool_count;
+static pid_t vc_pool_pid;
+static pthread_mutex_t vc_pool_lock = PTHREAD_MUTEX_INITIALIZER;
+
 /* Public. */
 
 /* int
@@ -361,8 +423,6 @@ int
 res_nsend(res_state statp,
 	  const u_char *buf, int buflen, u_char *ans, int anssiz)
 {
-	int gotsomewhere, terrno, try, v_circuit, resplen, ns, n;
-	char abuf[NI_MAXHOST];
 	ResolvCacheStatus     cache_status = RESOLV_CACHE_UNSUPPORTED;
 
 	if (anssiz < HFIXEDSZ) {
@@ -371,9 +431,6 @@ res_nsend(res_state statp,
 	}
 	DprintQ((statp->options & RES_DEBUG) || (statp->pfcode & RES_PRF_QUERY),
 		(stdout, ";; res_send()\n"), buf, buflen);
-	v_circuit = (statp->options & RES_USEVC) || buflen > PACKETSZ;
-	gotsomewhere = 0;
-	terrno = ETIMEDOUT;
 
 	int  anslen = 0;
 	cache_status = _resolv_cache_lookup(
@@ -382,11 +439,25 @@ res_nsend(res_state statp,
 
 	if (cache_status == RESOLV_CACHE_FOUND) {
 		return anslen;
+	} else if (cache_status == RESOLV_CACHE_FOUND_REFRESH) {
+		res_nsend_refresh(statp, buf, buflen);
+		return anslen;
 	} else if (cache_status != RESOLV_CACHE_UNSUPPORTED) {
 		// had a cache miss for a known network, so populate the thread private
 		// data so the normal resolve path can do its thing
 		_resolv_populate_res_for_net(statp);
 	}
+	return res_nsend_uncached(statp, buf, buflen, ans, anssiz, cache_status);
+}
+
+/* The part of res_nsend() after the cache lookup. */
+static int
+res_nsend_uncached(res_state statp, const u_char *buf, int buflen,
+	u_char *ans, int anssiz, ResolvCacheStatus cache_status)
+{
+	struct timespec start, done;
+	int resplen;
+
 	if (statp->nscount == 0) {
 		// We have no nameservers configured, so there's no point trying.
 		// Tell the cache the query failed, or any retries and anyone else asking the same
@@ -396,6 +467,106 @@ res_nsend(res_state statp,
 		return (-1);
 	}
 
+	res_nsend_prepare(statp);
+	start = evNowTime();
+	if ((statp->options & RES_PARALLEL) != 0U &&
+	    (statp->options & RES_USEVC) == 0U && buflen <= PACKETSZ &&
+	    buflen >= HFIXEDSZ && statp->qhook == NULL && statp->rhook == NULL) {
+		struct dg_query q;
+
+		memset(&q, 0, sizeof(q));
+		q.buf = buf;
+		q.buflen = buflen;
+		q.ans = ans;
+		q.anssiz = anssiz;
+		q.cache_status = cache_status;
+		send_dg_queries(statp, &q, 1);
+		resplen = q.resplen;
+	} else {
+		resplen = res_nsend_servers(statp, buf, buflen, ans, anssiz,
+		    (statp->options & RES_USEVC) || buflen > PACKETSZ,
+		    cache_status);
+	}
+	done = evNowTime();
+	_resolv_cache_add_query_stats(statp->netid,
+	    _res_stats_calculate_rtt(&done, &start), resplen > 0);
+	return (resplen);
+}
+
+/* A query that res_nsend() answered from a cache entry that needs to be
+ * refreshed; see _resolv_set_cache_stale_for_net(). */
+struct res_refresh {
+	unsigned netid;
+	unsigned mark;
+	int buflen;
+	u_char buf[];
+};
+
+static void *
+res_refresh_thread(void *arg)
+{
+	struct res_refresh *r = arg;
+	res_state res;
+	u_char *ans;
+
+	res = __res_get_state();
+	ans = malloc(NS_MAXMSG);
+	if (res == NULL || ans == NULL) {
+		_resolv_cache_query_failed(r->netid, r->buf, r->buflen);
+	} else {
+		res_setnetid(res, r->netid);
+		res_setmark(res, r->mark);
+		_resolv_populate_res_for_net(res);
+		/* the answer goes into the cache, in place of the old one */
+		res_nsend_uncached(res, r->buf, r->buflen, ans, NS_MAXMSG,
+		    RESOLV_CACHE_NOTFOUND);
+	}
+	if (res != NULL)
+		__res_put_state(res);
+	free(ans);
+	free(r);
+	return (NULL);
+}
+
+/* Sends the query again from a thread of its own, so that the caller can
+ * carry on with the cached answer. */
+static void
+res_nsend_refresh(res_state statp, const u_char *buf, int buflen)
+{
+	struct res_refresh *r;
+	pthread_attr_t attr;
+	pthread_t thread;
+	int rc;
+
+	r = malloc(sizeof(*r) + buflen);
+	if (r == NULL) {
+		_resolv_cache_query_failed(statp->netid, buf, buflen);
+		return;
+	}
+	r->netid = statp->netid;
+	r->mark = statp->_mark;
+	r->buflen = buflen;
+	memcpy(r->buf, buf, buflen);
+
+	pthread_attr_init(&attr);
+	pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+	rc = pthread_create(&thread, &attr, res_refresh_thread, r);
+	pthread_attr_destroy(&attr);
+	if (rc != 0) {
+		free(r);
+		_resolv_cache_query_failed(statp->netid, buf, buflen);
+	}
+}
+
+/*
+ * Brings our private copy of the nameserver list up to date before
+ * sending, and rotates it if asked to.
+ */
+static void
+res_nsend_prepare(res_state statp)
+{
+	int ns;
+
 	/*
 	 * If the ns_addr_list in the resolver context has changed, then
 	 * invalidate our cached copy and the associated timing data.
@@ -483,6 +654,22 @@ res_nsend(res_state statp,
 		EXT(statp).nssocks[lastns] = fd;
 		EXT(statp).nstimes[lastns] = nstime;
 	}
+}
+
+/*
+ * The part of res_nsend() after the cache lookup: tries each nameserver
+ * in turn until one answers, and adds the answer to the cache.
+ */
+static int
+res_nsend_servers(res_state statp,
+	  const u_char *buf, int buflen, u_char *ans, int anssiz,
+	  int v_circuit, ResolvCacheStatus cache_status)
+{
+	int gotsomewhere, terrno, try, resplen, ns, n;
+	char abuf[NI_MAXHOST];
+
+	gotsomewhere = 0;
+	terrno = ETIMEDOUT;
 
 	/*
 	 * Send request, RETRY times, or until successful.
@@ -550,19 +737,17 @@ res_nsend(res_state statp,
 			try = statp->retry;
 
 			n = send_vc(statp, buf, buflen, ans, anssiz, &terrno,
-				    ns, &now, &rcode, &delay);
+				    ns, vc_idle_timeout(&params, &stats[ns]),
+				    &now, &rcode, &delay);
 
 			/*
-			 * Only record stats the first time we try a query. This ensures that
-			 * queries that deterministically fail (e.g., a name that always returns
-			 * SERVFAIL or times out) do not unduly affect the stats.
+			 * Every attempt is counted, but only the first time we try a query
+			 * is sampled for server selection. This ensures that queries that
+			 * deterministically fail (e.g., a name that always returns SERVFAIL
+			 * or times out) do not unduly affect the stats.
 			 */
-			if (try == 0) {
-				struct __res_sample sample;
-				_res_stats_set_sample(&sample, now, rcode, delay);
-				_resolv_cache_add_resolver_stats_sample(statp->netid, revision_id,
-					ns, &sample, params.max_samples);
-			}
+			add_stats_sample(statp, revision_id, &params, ns, now, rcode, delay,
+			    try == 0);
 
 			if (DBG) {
 				__libc_format_log(ANDROID_LOG_DEBUG, "libc",
@@ -583,13 +768,9 @@ res_nsend(res_state statp,
 			n = send_dg(statp, buf, buflen, ans, anssiz, &terrno,
 				    ns, &v_circuit, &gotsomewhere, &now, &rcode, &delay);
 
-			/* Only record stats the first time we try a query. See above. */
-			if (try == 0) {
-				struct __res_sample sample;
-				_res_stats_set_sample(&sample, now, rcode, delay);
-				_resolv_cache_add_resolver_stats_sample(statp->netid, revision_id,
-					ns, &sample, params.max_samples);
-			}
+			/* Only sample the first time we try a query. See above. */
+			add_stats_sample(statp, revision_id, &params, ns, now, rcode, delay,
+			    try == 0);
 
 			if (DBG) {
 				__libc_format_log(ANDROID_LOG_DEBUG, "libc", "used send_dg %d\n",n);
@@ -683,6 +864,254 @@ res_nsend(res_state statp,
 	return (-1);
 }
 
+static int
+dg_query_pending(const struct dg_query *q)
+{
+	return q->resplen <= 0 && !q->truncated;
+}
+
+static int
+dg_queries_pending(const struct dg_query *q, int nq)
+{
+	int i;
+
+	for (i = 0; i < nq; i++) {
+		if (dg_query_pending(&q[i]))
+			return 1;
+	}
+	return 0;
+}
+
+/*
+ * Counts an attempt to send a query to nameserver ns, and if record is
+ * set also keeps it as a sample for server selection.
+ */
+static void
+add_stats_sample(res_state statp, int revision_id, const struct __res_params *params,
+	int ns, time_t at, int rcode, int delay, int record)
+{
+	struct __res_sample sample;
+
+	_res_stats_set_sample(&sample, at, rcode, delay);
+	_resolv_cache_add_resolver_stats_sample(statp->netid, revision_id,
+		ns, &sample, record ? params->max_samples : 0);
+}
+
+/* Caches the answers to the queries just sent. */
+static void
+cache_dg_answers(res_state statp, struct dg_query *q, int nq)
+{
+	int i;
+
+	for (i = 0; i < nq; i++) {
+		if (!q[i].sent || q[i].resplen <= 0)
+			continue;
+		DprintQ((statp->options & RES_DEBUG) ||
+			(statp->pfcode & RES_PRF_REPLY),
+			(stdout, "%s", ""),
+			q[i].ans, (q[i].resplen > q[i].anssiz) ?
+			q[i].anssiz : q[i].resplen);
+		if (q[i].cache_status == RESOLV_CACHE_NOTFOUND)
+			_resolv_cache_add(statp->netid, q[i].buf, q[i].buflen,
+			    q[i].ans, q[i].resplen);
+	}
+}
+
+/*
+ * The part of res_nsend() after the cache lookup for datagram queries that
+ * are sent together (see res_nsend_pair()) or in RES_PARALLEL mode.  Each
+ * query ends up with its answer's length, or -1, in its resplen, just as
+ * if it had come from res_nsend().
+ */
+static void
+send_dg_queries(res_state statp, struct dg_query *q, int nq)
+{
+	int gotsomewhere, terrno, try, ns, n, i;
+
+	gotsomewhere = 0;
+	terrno = ETIMEDOUT;
+
+	/*
+	 * Send the unanswered queries, RETRY times, or until all are
+	 * answered.  A query the nameserver rejects is sent again to the
+	 * next one, as res_nsend() would.
+	 */
+	for (try = 0; try < statp->retry; try++) {
+	    struct __res_stats stats[MAXNS];
+	    struct __res_params params;
+	    int revision_id = _resolv_cache_get_resolver_stats(statp->netid, &params, stats);
+	    bool usable_servers[MAXNS];
+	    android_net_res_stats_get_usable_servers(&params, stats, statp->nscount,
+		    usable_servers);
+
+	    if ((statp->options & RES_PARALLEL) != 0U) {
+		n = send_dg_staggered(statp, q, nq, usable_servers, stats, &params,
+		    revision_id, try == 0, &terrno, &gotsomewhere);
+		cache_dg_answers(statp, q, nq);
+		if (DBG) {
+			__libc_format_log(ANDROID_LOG_DEBUG, "libc",
+				"used send_dg_staggered %d\n", n);
+		}
+		if (n < 0) {
+			res_nclose(statp);
+			errno = terrno;
+			goto failed;
+		}
+		if (!dg_queries_pending(q, nq))
+			goto answered;
+		continue;
+	    }
+
+	    for (ns = 0; ns < statp->nscount; ns++) {
+		time_t now = 0;
+
+		if (!usable_servers[ns]) continue;
+		statp->_flags &= ~RES_F_LASTMASK;
+		statp->_flags |= (ns << RES_F_LASTSHIFT);
+
+		n = send_dg_pair(statp, q, nq, ns, &terrno, &gotsomewhere, &now);
+
+		/* Only sample the first time we try a query. */
+		for (i = 0; i < nq; i++) {
+			if (q[i].sent)
+				add_stats_sample(statp, revision_id, &params, ns, now,
+				    q[i].rcode, q[i].delay, try == 0);
+		}
+		cache_dg_answers(statp, q, nq);
+		if (DBG) {
+			__libc_format_log(ANDROID_LOG_DEBUG, "libc",
+				"used send_dg_pair %d\n", n);
+		}
+		if (n < 0) {
+			res_nclose(statp);
+			errno = terrno;
+			goto failed;
+		}
+		if (!dg_queries_pending(q, nq))
+			goto answered;
+	    }
+	}
+	res_nclose(statp);
+	errno = gotsomewhere ? ETIMEDOUT : ECONNREFUSED;
+
+ failed:
+	for (i = 0; i < nq; i++) {
+		if (!dg_query_pending(&q[i]))
+			continue;
+		_resolv_cache_query_failed(statp->netid, q[i].buf, q[i].buflen);
+		q[i].resplen = -1;
+	}
+	goto truncated;
+
+ answered:
+	if ((statp->options & RES_STAYOPEN) == 0U)
+		res_nclose(statp);
+
+ truncated:
+	/* Truncated answers are asked for again, on their own, over TCP. */
+	for (i = 0; i < nq; i++) {
+		if (q[i].truncated)
+			q[i].resplen = res_nsend_servers(statp, q[i].buf, q[i].buflen,
+			    q[i].ans, q[i].anssiz, 1, q[i].cache_status);
+	}
+}
+
+/*
+ * Sends two queries for the same name (the A and AAAA queries of an
+ * AF_UNSPEC getaddrinfo(), say) together over one UDP socket and waits
+ * for both answers, so that the lookup takes one round trip rather than
+ * two.  Each answer is cached, and has its length or -1 stored in
+ * *resplen1 or *resplen2, just as if it had come from res_nsend().
+ *
+ * Returns -1 without doing anything if the queries can't be sent this
+ * way (TCP, hooks, or clashing ids), and the caller should use
+ * res_nsend() for each instead; 0 otherwise.
+ */
+int
+res_nsend_pair(res_state statp,
+	  const u_char *buf1, int buflen1, u_char *ans1, int anssiz1, int *resplen1,
+	  const u_char *buf2, int buflen2, u_char *ans2, int anssiz2, int *resplen2)
+{
+	struct dg_query q[2];
+	struct timespec start, finish;
+	int i, pending, populated;
+
+	if (anssiz1 < HFIXEDSZ || anssiz2 < HFIXEDSZ ||
+	    buflen1 < HFIXEDSZ || buflen2 < HFIXEDSZ ||
+	    buflen1 > PACKETSZ || buflen2 > PACKETSZ ||
+	    (statp->options & RES_USEVC) != 0U ||
+	    statp->qhook != NULL || statp->rhook != NULL)
+		return (-1);
+	/* Answers are told apart by their ids. */
+	if (((const HEADER *)(const void *)buf1)->id ==
+	    ((const HEADER *)(const void *)buf2)->id)
+		return (-1);
+
+	memset(q, 0, sizeof(q));
+	q[0].buf = buf1;
+	q[0].buflen = buflen1;
+	q[0].ans = ans1;
+	q[0].anssiz = anssiz1;
+	q[1].buf = buf2;
+	q[1].buflen = buflen2;
+	q[1].ans = ans2;
+	q[1].anssiz = anssiz2;
+
+	pending = 0;
+	populated = 0;
+	for (i = 0; i < 2; i++) {
+		int anslen = 0;
+
+		DprintQ((statp->options & RES_DEBUG) || (statp->pfcode & RES_PRF_QUERY),
+			(stdout, ";; res_send()\n"), q[i].buf, q[i].buflen);
+		q[i].cache_status = _resolv_cache_lookup(statp->netid,
+		    q[i].buf, q[i].buflen, q[i].ans, q[i].anssiz, &anslen);
+		if (q[i].cache_status == RESOLV_CACHE_FOUND) {
+			q[i].resplen = anslen;
+			continue;
+		}
+		if (q[i].cache_status == RESOLV_CACHE_FOUND_REFRESH) {
+			res_nsend_refresh(statp, q[i].buf, q[i].buflen);
+			q[i].resplen = anslen;
+			continue;
+		}
+		if (q[i].cache_status != RESOLV_CACHE_UNSUPPORTED && !populated) {
+			_resolv_populate_res_for_net(statp);
+			populated = 1;
+		}
+		pending++;
+	}
+	if (pending == 0)
+		goto done;
+	if (statp->nscount == 0) {
+		for (i = 0; i < 2; i++) {
+			if (q[i].resplen > 0)
+				continue;
+			_resolv_cache_query_failed(statp->netid, q[i].buf, q[i].buflen);
+			q[i].resplen = -1;
+		}
+		errno = ESRCH;
+		goto done;
+	}
+
+	res_nsend_prepare(statp);
+	start = evNowTime();
+	send_dg_queries(statp, q, 2);
+	finish = evNowTime();
+	for (i = 0; i < 2; i++) {
+		if (q[i].cache_status == RESOLV_CACHE_FOUND ||
+		    q[i].cache_status == RESOLV_CACHE_FOUND_REFRESH)
+			continue;
+		_resolv_cache_add_query_stats(statp->netid,
+		    _res_stats_calculate_rtt(&finish, &start), q[i].resplen > 0);
+	}
+
+ done:
+	*resplen1 = q[0].resplen;
+	*resplen2 = q[1].resplen;
+	return (0);
+}
+
 /* Private */
 
 static int
@@ -746,10 +1175,119 @@ static int get_timeout(const res_state statp, const int ns)
 	return timeout;
 }
 
+/*
+ * How long to keep an idle TCP connection to a server: VC_IDLE_TIMEOUT
+ * scaled by the share of its recent queries that it answered, or not at
+ * all if the server is considered broken.
+ */
+static int
+vc_idle_timeout(const struct __res_params *params, struct __res_stats *stats)
+{
+	int successes, errors, timeouts, internal_errors, rtt_avg, total;
+	time_t last_sample_time;
+
+	if (!_res_stats_usable_server(params, stats))
+		return (0);
+	android_net_res_stats_aggregate(stats, &successes, &errors, &timeouts,
+	    &internal_errors, &rtt_avg, &last_sample_time);
+	total = successes + errors + timeouts;
+	if (total == 0 || total < params->min_samples)
+		return (VC_IDLE_MIN_TIMEOUT);
+	return (VC_IDLE_TIMEOUT * successes / total);
+}
+
+/* Closes the connections in the pool that have expired, or all of them if
+ * this is a child process that inherited the parent's. */
+static void
+vc_pool_expire_locked(time_t now)
+{
+	int i;
+
+	if (vc_pool_pid != getpid()) {
+		for (i = 0; i < vc_pool_count; i++)
+			close(vc_pool[i].fd);
+		vc_pool_count = 0;
+		vc_pool_pid = getpid();
+	}
+	for (i = 0; i < vc_pool_count; ) {
+		if (now >= vc_pool[i].expires) {
+			close(vc_pool[i].fd);
+			vc_pool[i] = vc_pool[--vc_pool_count];
+		} else
+			i++;
+	}
+}
+
+/*
+ * Takes an idle connection to the server from the pool.  Returns its
+ * descriptor, or -1 if there isn't one.
+ */
+static int
+vc_pool_get(struct sockaddr *nsap, unsigned mark)
+{
+	struct pollfd pfd;
+	int i, fd = -1;
+
+	pthread_mutex_lock(&vc_pool_lock);
+	vc_pool_expire_locked(time(NULL));
+	for (i = vc_pool_count - 1; i >= 0; i--) {
+		if (vc_pool[i].mark != mark ||
+		    !sock_eq((struct sockaddr *)(void *)&vc_pool[i].addr, nsap))
+			continue;
+		fd = vc_pool[i].fd;
+		vc_pool[i] = vc_pool[--vc_pool_count];
+		/* nothing should be waiting to be read, unless the server
+		 * has closed the connection */
+		pfd.fd = fd;
+		pfd.events = POLLIN;
+		pfd.revents = 0;
+		if (poll(&pfd, 1, 0) == 0)
+			break;
+		close(fd);
+		fd = -1;
+	}
+	pthread_mutex_unlock(&vc_pool_lock);
+	return (fd);
+}
+
+/*
+ * Gives a connection whose last answer has been read in full back to the
+ * pool, for idle seconds, or closes it.  If the pool is full, the
+ * connection that would expire first makes way.
+ */
+static void
+vc_pool_put(int fd, struct sockaddr *nsap, unsigned mark, int idle)
+{
+	time_t now = time(NULL);
+	int i, victim;
+
+	if (idle <= 0) {
+		close(fd);
+		return;
+	}
+	pthread_mutex_lock(&vc_pool_lock);
+	vc_pool_expire_locked(now);
+	if (vc_pool_count == VC_POOL_SIZE) {
+		victim = 0;
+		for (i = 1; i < vc_pool_count; i++) {
+			if (vc_pool[i].expires < vc_pool[victim].expires)
+				victim = i;
+		}
+		close(vc_pool[victim].fd);
+		vc_pool[victim] = vc_pool[--vc_pool_count];
+	}
+	vc_pool[vc_pool_count].fd = fd;
+	vc_pool[vc_pool_count].mark = mark;
+	memcpy(&vc_pool[vc_pool_count].addr, nsap, get_salen(nsap));
+	vc_pool[vc_pool_count].expires = now + idle;
+	vc_pool_count++;
+	pthread_mutex_unlock(&vc_pool_lock);
+}
+
 static int
 send_vc(res_state statp,
 	const u_char *buf, int buflen, u_char *ans, int anssiz,
-	int *terrno, int ns, time_t* at, int* rcode, int* delay)
+	int *terrno, int ns, int idle, time_t* at, int* rcode, int* delay)
 {
 	*at = time(NULL);
 	*rcode = RCODE_INTERNAL_ERROR;
@@ -758,8 +1296,9 @@ send_vc(res_state statp,
 	HEADER *anhp = (HEADER *)(void *)ans;
 	struct sockaddr *nsap;
 	int nsaplen;
-	int truncating, connreset, resplen, n;
+	int truncating, connreset, reused, resplen, n;
 	struct iovec iov[2];
+	struct msghdr msg;
 	u_short len;
 	u_char *cp;
 	void *tmp;
@@ -774,6 +1313,7 @@ send_vc(res_state statp,
 	connreset = 0;
  same_ns:
 	truncating = 0;
+	reused = 0;
 
 	struct timespec now = evNowTime();
 
@@ -797,11 +1337,18 @@ send_vc(res_state statp,
 		if (statp->_vcsock >= 0)
 			res_nclose(statp);
 
-		statp->_vcsock = socket(nsap->sa_family, SOCK_STREAM | SOCK_CLOEXEC, 0);
-		if (statp->_vcsock > highestFD) {
-			res_nclose(statp);
-			errno = ENOTSOCK;
+		/* a fresh connection if a pooled one has already let us down */
+		if (!connreset) {
+			statp->_vcsock = vc_pool_get(nsap, statp->_mark);
+			if (statp->_vcsock >= 0) {
+				statp->_flags |= RES_F_VC;
+				reused = 1;
+			}
 		}
+	}
+
+	if (statp->_vcsock < 0) {
+		statp->_vcsock = socket(nsap->sa_family, SOCK_STREAM | SOCK_CLOEXEC, 0);
 		if (statp->_vcsock < 0) {
 			switch (errno) {
 			case EPROTONOSUPPORT:
@@ -844,7 +1391,7 @@ send_vc(res_state statp,
 			 * determining whether this was really a timeout or e.g. ECONNREFUSED. Since
 			 * currently both cases are handled in the same way, there is no need to
 			 * change this (yet). If we ever need to reliably distinguish between these
-			 * cases, both connect_with_timeout() and retrying_select() need to be
+			 * cases, both connect_with_timeout() and retrying_poll() need to be
 			 * modified, though.
 			 */
 			*rcode = RCODE_TIMEOUT;
@@ -860,10 +1407,18 @@ send_vc(res_state statp,
 	iov[0] = evConsIovec(&len, INT16SZ);
 	DE_CONST(buf, tmp);
 	iov[1] = evConsIovec(tmp, (size_t)buflen);
-	if (writev(statp->_vcsock, iov, 2) != (INT16SZ + buflen)) {
+	memset(&msg, 0, sizeof(msg));
+	msg.msg_iov = iov;
+	msg.msg_iovlen = 2;
+	/* the server may have closed a pooled connection: no SIGPIPE */
+	if (sendmsg(statp->_vcsock, &msg, MSG_NOSIGNAL) != (INT16SZ + buflen)) {
 		*terrno = errno;
 		Perror(statp, stderr, "write failed", errno);
 		res_nclose(statp);
+		if (reused && !connreset) {
+			connreset = 1;
+			goto same_ns;
+		}
 		return (0);
 	}
 	/*
@@ -888,9 +1443,11 @@ send_vc(res_state statp,
 		 * trying a new one.  When there is only one
 		 * server, this means that a query might work
 		 * instead of failing.  We only allow one reset
-		 * per query to prevent looping.
+		 * per query to prevent looping.  The same goes
+		 * for a pooled connection that the server has
+		 * since closed.
 		 */
-		if (*terrno == ECONNRESET && !connreset) {
+		if ((*terrno == ECONNRESET || reused) && !connreset) {
 			connreset = 1;
 			res_nclose(statp);
 			goto same_ns;
@@ -970,6 +1527,12 @@ send_vc(res_state statp,
 	    *delay = _res_stats_calculate_rtt(&done, &now);
 	    *rcode = anhp->rcode;
 	}
+	/* unless the caller keeps its own connection open, share it */
+	if ((statp->options & RES_STAYOPEN) == 0U) {
+		vc_pool_put(statp->_vcsock, nsap, statp->_mark, idle);
+		statp->_vcsock = -1;
+		statp->_flags &= ~RES_F_VC;
+	}
 	return (resplen);
 }
 
@@ -978,7 +1541,6 @@ static int
 connect_with_timeout(int sock, const struct sockaddr *nsap, socklen_t salen, int sec)
 {
 	int res, origflags;
-	fd_set rset, wset;
 	struct timespec now, timeout, finish;
 
 	origflags = fcntl(sock, F_GETFL, 0);
@@ -997,7 +1559,7 @@ connect_with_timeout(int sock, const struct sockaddr *nsap, socklen_t salen, int
 			__libc_format_log(ANDROID_LOG_DEBUG, "libc", "  %d send_vc\n", sock);
 		}
 
-		res = retrying_select(sock, &rset, &wset, &finish);
+		res = retrying_poll(sock, POLLIN | POLLOUT, &finish);
 		if (res <= 0) {
 			res = -1;
 		}
@@ -1011,58 +1573,63 @@ done:
 	return res;
 }
 
+/*
+ * ppoll() until finish, starting again if interrupted.  Returns the number
+ * of ready descriptors, 0 (with errno set to ETIMEDOUT) if none became
+ * ready in time, or -1 on error.
+ */
 static int
-retrying_select(const int sock, fd_set *readset, fd_set *writeset, const struct timespec *finish)
+poll_until(struct pollfd *fds, nfds_t nfds, const struct timespec *finish)
 {
 	struct timespec now, timeout;
+	int n;
+
+	do {
+		now = evNowTime();
+		if (evCmpTime(*finish, now) > 0)
+			timeout = evSubTime(*finish, now);
+		else
+			timeout = evConsTime(0L, 0L);
+		n = ppoll(fds, nfds, &timeout, NULL);
+	} while (n < 0 && errno == EINTR);
+	if (n == 0)
+		errno = ETIMEDOUT;
+	return n;
+}
+
+static int
+retrying_poll(const int sock, const short events, const struct timespec *finish)
+{
+	struct pollfd fds = { .fd = sock, .events = events };
 	int n, error;
 	socklen_t len;
 
-
-retry:
 	if (DBG) {
-		__libc_format_log(ANDROID_LOG_DEBUG, "libc", "  %d retrying_select\n", sock);
-	}
-
-	now = evNowTime();
-	if (readset) {
-		FD_ZERO(readset);
-		FD_SET(sock, readset);
-	}
-	if (writeset) {
-		FD_ZERO(writeset);
-		FD_SET(sock, writeset);
+		__libc_format_log(ANDROID_LOG_DEBUG, "libc", "  %d retrying_poll\n", sock);
 	}
-	if (evCmpTime(*finish, now) > 0)
-		timeout = evSubTime(*finish, now);
-	else
-		timeout = evConsTime(0L, 0L);
 
-	n = pselect(sock + 1, readset, writeset, NULL, &timeout, NULL);
+	n = poll_until(&fds, 1, finish);
 	if (n == 0) {
 		if (DBG) {
 			__libc_format_log(ANDROID_LOG_DEBUG, " libc",
-				"  %d retrying_select timeout\n", sock);
+				"  %d retrying_poll timeout\n", sock);
 		}
-		errno = ETIMEDOUT;
 		return 0;
 	}
 	if (n < 0) {
-		if (errno == EINTR)
-			goto retry;
 		if (DBG) {
 			__libc_format_log(ANDROID_LOG_DEBUG, "libc",
-				"  %d retrying_select got error %d\n",sock, n);
+				"  %d retrying_poll got error %d\n",sock, n);
 		}
 		return n;
 	}
-	if ((readset && FD_ISSET(sock, readset)) || (writeset && FD_ISSET(sock, writeset))) {
+	if (fds.revents != 0) {
 		len = sizeof(error);
 		if (getsockopt(sock, SOL_SOCKET, SO_ERROR, &error, &len) < 0 || error) {
 			errno = error;
 			if (DBG) {
 				__libc_format_log(ANDROID_LOG_DEBUG, "libc",
-					"  %d retrying_select dot error2 %d\n", sock, errno);
+					"  %d retrying_poll dot error2 %d\n", sock, errno);
 			}
 
 			return -1;
@@ -1070,39 +1637,27 @@ retry:
 	}
 	if (DBG) {
 		__libc_format_log(ANDROID_LOG_DEBUG, "libc",
-			"  %d retrying_select returning %d\n",sock, n);
+			"  %d retrying_poll returning %d\n",sock, n);
 	}
 
 	return n;
 }
 
+/*
+ * Opens the datagram socket for nameserver ns if it isn't already open.
+ * Returns 1 on success, and otherwise what send_dg() should: 0 to try
+ * the next nameserver, or -1 to give up.
+ */
 static int
-send_dg(res_state statp,
-	const u_char *buf, int buflen, u_char *ans, int anssiz,
-	int *terrno, int ns, int *v_circuit, int *gotsomewhere,
-	time_t *at, int *rcode, int* delay)
+open_dg(res_state statp, int ns, int *terrno)
 {
-	*at = time(NULL);
-	*rcode = RCODE_INTERNAL_ERROR;
-	*delay = 0;
-	const HEADER *hp = (const HEADER *)(const void *)buf;
-	HEADER *anhp = (HEADER *)(void *)ans;
 	const struct sockaddr *nsap;
 	int nsaplen;
-	struct timespec now, timeout, finish, done;
-	fd_set dsmask;
-	struct sockaddr_storage from;
-	socklen_t fromlen;
-	int resplen, seconds, n, s;
 
 	nsap = get_nsaddr(statp, (size_t)ns);
 	nsaplen = get_salen(nsap);
 	if (EXT(statp).nssocks[ns] == -1) {
 		EXT(statp).nssocks[ns] = socket(nsap->sa_family, SOCK_DGRAM | SOCK_CLOEXEC, 0);
-		if (EXT(statp).nssocks[ns] > highestFD) {
-			res_nclose(statp);
-			errno = ENOTSOCK;
-		}
 		if (EXT(statp).nssocks[ns] < 0) {
 			switch (errno) {
 			case EPROTONOSUPPORT:
@@ -1134,7 +1689,7 @@ send_dg(res_state statp,
 		 * ICMP port unreachable message to be returned.
 		 * If our datagram socket is "connected" to the
 		 * server, we get an ECONNREFUSED error on the next
-		 * socket operation, and select returns if the
+		 * socket operation, and poll returns if the
 		 * error message is received.  We can thus detect
 		 * the absence of a nameserver without timing out.
 		 */
@@ -1155,6 +1710,36 @@ send_dg(res_state statp,
 		       (stdout, ";; new DG socket\n"))
 
 	}
+	return (1);
+}
+
+static int
+send_dg(res_state statp,
+	const u_char *buf, int buflen, u_char *ans, int anssiz,
+	int *terrno, int ns, int *v_circuit, int *gotsomewhere,
+	time_t *at, int *rcode, int* delay)
+{
+	*at = time(NULL);
+	*rcode = RCODE_INTERNAL_ERROR;
+	*delay = 0;
+	const HEADER *hp = (const HEADER *)(const void *)buf;
+	HEADER *anhp = (HEADER *)(void *)ans;
+#ifdef CANNOT_CONNECT_DGRAM
+	const struct sockaddr *nsap;
+	int nsaplen;
+#endif
+	struct timespec now, timeout, finish, done;
+	struct sockaddr_storage from;
+	socklen_t fromlen;
+	int resplen, seconds, n, s;
+
+	n = open_dg(statp, ns, terrno);
+	if (n <= 0)
+		return (n);
+#ifdef CANNOT_CONNECT_DGRAM
+	nsap = get_nsaddr(statp, (size_t)ns);
+	nsaplen = get_salen(nsap);
+#endif
 	s = EXT(statp).nssocks[ns];
 #ifndef CANNOT_CONNECT_DGRAM
 	if (send(s, (const char*)buf, (size_t)buflen, 0) != buflen) {
@@ -1179,7 +1764,7 @@ send_dg(res_state statp,
 	timeout = evConsTime((long)seconds, 0L);
 	finish = evAddTime(now, timeout);
 retry:
-	n = retrying_select(s, &dsmask, NULL, &finish);
+	n = retrying_poll(s, POLLIN, &finish);
 
 	if (n == 0) {
 		*rcode = RCODE_TIMEOUT;
@@ -1188,7 +1773,7 @@ retry:
 		return (0);
 	}
 	if (n < 0) {
-		Perror(statp, stderr, "select", errno);
+		Perror(statp, stderr, "poll", errno);
 		res_nclose(statp);
 		return (0);
 	}
@@ -1304,6 +1889,496 @@ retry:
 	return (resplen);
 }
 
+/*
+ * send_dg() for res_nsend_pair(): sends each of its pending queries to
+ * nameserver ns over the same socket, and then waits for all of their
+ * answers, which may arrive in any order.  Returns -1 to give up, 0 if
+ * the nameserver couldn't be reached or didn't answer in time, and 1
+ * otherwise; the fate of each query is left in its dg_query.
+ */
+static int
+send_dg_pair(res_state statp, struct dg_query *q, int nq, int ns,
+	int *terrno, int *gotsomewhere, time_t *at)
+{
+#ifdef CANNOT_CONNECT_DGRAM
+	const struct sockaddr *nsap;
+	int nsaplen;
+#endif
+	struct timespec now, timeout, finish, done;
+	struct sockaddr_storage from;
+	socklen_t fromlen;
+	HEADER hdr;
+	int resplen, seconds, n, s, i, waiting;
+
+	*at = time(NULL);
+	for (i = 0; i < nq; i++) {
+		q[i].sent = dg_query_pending(&q[i]);
+		q[i].waiting = 0;
+		q[i].rcode = RCODE_INTERNAL_ERROR;
+		q[i].delay = 0;
+	}
+	n = open_dg(statp, ns, terrno);
+	if (n <= 0)
+		return (n);
+#ifdef CANNOT_CONNECT_DGRAM
+	nsap = get_nsaddr(statp, (size_t)ns);
+	nsaplen = get_salen(nsap);
+#endif
+	s = EXT(statp).nssocks[ns];
+
+	waiting = 0;
+	for (i = 0; i < nq; i++) {
+		if (!q[i].sent)
+			continue;
+#ifndef CANNOT_CONNECT_DGRAM
+		if (send(s, (const char*)q[i].buf, (size_t)q[i].buflen, 0) != q[i].buflen) {
+			Perror(statp, stderr, "send", errno);
+			res_nclose(statp);
+			return (0);
+		}
+#else /* !CANNOT_CONNECT_DGRAM */
+		if (sendto(s, (const char*)q[i].buf, q[i].buflen, 0, nsap, nsaplen) != q[i].buflen)
+		{
+			Aerror(statp, stderr, "sendto", errno, nsap, nsaplen);
+			res_nclose(statp);
+			return (0);
+		}
+#endif /* !CANNOT_CONNECT_DGRAM */
+		q[i].waiting = 1;
+		waiting++;
+	}
+
+	/*
+	 * Wait for replies.
+	 */
+	seconds = get_timeout(statp, ns);
+	now = evNowTime();
+	timeout = evConsTime((long)seconds, 0L);
+	finish = evAddTime(now, timeout);
+	while (waiting > 0) {
+		struct dg_query *qp;
+		HEADER *anhp;
+
+		n = retrying_poll(s, POLLIN, &finish);
+		if (n == 0) {
+			for (i = 0; i < nq; i++) {
+				if (q[i].waiting)
+					q[i].rcode = RCODE_TIMEOUT;
+			}
+			Dprint(statp->options & RES_DEBUG, (stdout, ";; timeout\n"));
+			*gotsomewhere = 1;
+			return (0);
+		}
+		if (n < 0) {
+			Perror(statp, stderr, "poll", errno);
+			res_nclose(statp);
+			return (0);
+		}
+
+		/*
+		 * Peek at the id to see which query this answers, so that
+		 * the answer can be read straight into its buffer.
+		 */
+		errno = 0;
+		memset(&hdr, 0, sizeof(hdr));
+		resplen = recv(s, (char*)&hdr, sizeof(hdr), MSG_PEEK);
+		if (resplen <= 0) {
+			Perror(statp, stderr, "recvfrom", errno);
+			res_nclose(statp);
+			return (0);
+		}
+		*gotsomewhere = 1;
+		qp = NULL;
+		for (i = 0; i < nq; i++) {
+			if (q[i].waiting &&
+			    ((const HEADER *)(const void *)q[i].buf)->id == hdr.id)
+				qp = &q[i];
+		}
+		if (qp == NULL) {
+			/*
+			 * response from old query, ignore it.
+			 * XXX - potential security hazard could
+			 *	 be detected here.
+			 */
+			Dprint(statp->options & RES_DEBUG,
+			       (stdout, ";; old answer\n"));
+			recv(s, (char*)&hdr, sizeof(hdr), 0);
+			continue;
+		}
+
+		anhp = (HEADER *)(void *)qp->ans;
+		fromlen = sizeof(from);
+		resplen = recvfrom(s, (char*)qp->ans, (size_t)qp->anssiz, 0,
+				   (struct sockaddr *)(void *)&from, &fromlen);
+		if (resplen <= 0) {
+			Perror(statp, stderr, "recvfrom", errno);
+			res_nclose(statp);
+			return (0);
+		}
+		if (resplen < HFIXEDSZ) {
+			/*
+			 * Undersized message.
+			 */
+			Dprint(statp->options & RES_DEBUG,
+			       (stdout, ";; undersized: %d\n",
+				resplen));
+			*terrno = EMSGSIZE;
+			res_nclose(statp);
+			return (0);
+		}
+		if (!(statp->options & RES_INSECURE1) &&
+		    !res_ourserver_p(statp, (struct sockaddr *)(void *)&from)) {
+			/*
+			 * response from wrong server? ignore it.
+			 * XXX - potential security hazard could
+			 *	 be detected here.
+			 */
+			DprintQ((statp->options & RES_DEBUG) ||
+				(statp->pfcode & RES_PRF_REPLY),
+				(stdout, ";; not our server:\n"),
+				qp->ans, (resplen > qp->anssiz) ? qp->anssiz : resplen);
+			continue;
+		}
+#ifdef RES_USE_EDNS0
+		if (anhp->rcode == FORMERR && (statp->options & RES_USE_EDNS0) != 0U) {
+			/*
+			 * Do not retry if the server do not understand EDNS0.
+			 * The case has to be captured here, as FORMERR packet do not
+			 * carry query section, hence res_queriesmatch() returns 0.
+			 */
+			DprintQ(statp->options & RES_DEBUG,
+				(stdout, "server rejected query with EDNS0:\n"),
+				qp->ans, (resplen > qp->anssiz) ? qp->anssiz : resplen);
+			/* record the error */
+			statp->_flags |= RES_F_EDNS0ERR;
+			res_nclose(statp);
+			return (0);
+		}
+#endif
+		if (!(statp->options & RES_INSECURE2) &&
+		    !res_queriesmatch(qp->buf, qp->buf + qp->buflen,
+				      qp->ans, qp->ans + qp->anssiz)) {
+			/*
+			 * response contains wrong query? ignore it.
+			 * XXX - potential security hazard could
+			 *	 be detected here.
+			 */
+			DprintQ((statp->options & RES_DEBUG) ||
+				(statp->pfcode & RES_PRF_REPLY),
+				(stdout, ";; wrong query name:\n"),
+				qp->ans, (resplen > qp->anssiz) ? qp->anssiz : resplen);
+			continue;
+		}
+		qp->waiting = 0;
+		waiting--;
+		done = evNowTime();
+		qp->delay = _res_stats_calculate_rtt(&done, &now);
+		if (anhp->rcode == SERVFAIL ||
+		    anhp->rcode == NOTIMP ||
+		    anhp->rcode == REFUSED) {
+			DprintQ(statp->options & RES_DEBUG,
+				(stdout, "server rejected query:\n"),
+				qp->ans, (resplen > qp->anssiz) ? qp->anssiz : resplen);
+			/* don't retry if called from dig */
+			if (!statp->pfcode) {
+				/* Still waiting for the other answer, so keep the socket. */
+				qp->rcode = anhp->rcode;
+				continue;
+			}
+		}
+		if (!(statp->options & RES_IGNTC) && anhp->tc) {
+			/*
+			 * To get the rest of answer,
+			 * use TCP with same server.
+			 */
+			Dprint(statp->options & RES_DEBUG,
+			       (stdout, ";; truncated answer\n"));
+			qp->truncated = 1;
+			continue;
+		}
+		qp->rcode = anhp->rcode;
+		qp->resplen = resplen;
+	}
+	return (1);
+}
+
+/*
+ * In RES_PARALLEL mode, how long to wait for nameserver ns to answer before
+ * asking the next one as well: twice its average round trip time, or
+ * RES_PARALLEL_DELAY_MS if there's nothing to go on.
+ */
+static struct timespec
+get_parallel_delay(struct __res_stats *stats)
+{
+	int successes, errors, timeouts, internal_errors, rtt_avg;
+	time_t last_sample_time;
+	int delay = RES_PARALLEL_DELAY_MS;
+
+	android_net_res_stats_aggregate(stats, &successes, &errors, &timeouts,
+	    &internal_errors, &rtt_avg, &last_sample_time);
+	if (successes > 0 && rtt_avg >= 0) {
+		delay = 2 * rtt_avg;
+		if (delay < RES_PARALLEL_MIN_DELAY_MS)
+			delay = RES_PARALLEL_MIN_DELAY_MS;
+		if (delay > RES_PARALLEL_MAX_DELAY_MS)
+			delay = RES_PARALLEL_MAX_DELAY_MS;
+	}
+	return evConsTime((long)(delay / 1000), (long)(delay % 1000) * 1000000L);
+}
+
+/* Stops waiting for nameserver ns, whose socket has failed. */
+static void
+drop_dg_staggered(res_state statp, int ns, struct pollfd *pfd)
+{
+	if (EXT(statp).nssocks[ns] == pfd->fd) {
+		(void) close(EXT(statp).nssocks[ns]);
+		EXT(statp).nssocks[ns] = -1;
+	}
+	pfd->fd = -1;
+}
+
+/*
+ * send_dg() for RES_PARALLEL mode: sends the pending queries to the first
+ * usable nameserver, and if they haven't all been answered after a short
+ * delay (see get_parallel_delay()), to the next one as well, and so on,
+ * without giving up on the earlier ones.  The first good answer to each
+ * query is used, whichever nameserver it comes from, and a nameserver that
+ * rejects a query has the next one asked straight away.
+ *
+ * Counts its attempts itself, keeping them as reachability samples if
+ * record is set.  Returns -1 to give up, 0 if some queries weren't
+ * answered by any nameserver, and 1 otherwise; the fate of each query is
+ * left in its dg_query.
+ */
+static int
+send_dg_staggered(res_state statp, struct dg_query *q, int nq,
+	const bool *usable_servers, struct __res_stats *stats,
+	const struct __res_params *params, int revision_id, int record,
+	int *terrno, int *gotsomewhere)
+{
+	struct pollfd fds[MAXNS];
+	int fd_ns[MAXNS];
+	unsigned outstanding[MAXNS];	/* queries sent there and not answered */
+	struct timespec sent_at[MAXNS], fd_finish[MAXNS];
+	time_t sent_time[MAXNS];
+	struct timespec now, next_at, deadline, done;
+	int nfds, next, ns, n, i, j;
+
+	for (i = 0; i < nq; i++) {
+		q[i].sent = dg_query_pending(&q[i]);
+		q[i].rcode = RCODE_INTERNAL_ERROR;
+		q[i].delay = 0;
+	}
+	nfds = 0;
+	next = 0;
+	next_at = evNowTime();
+
+	for (;;) {
+		unsigned pending = 0, waiting = 0;
+
+		for (i = 0; i < nq; i++) {
+			if (dg_query_pending(&q[i]))
+				pending |= 1U << i;
+		}
+		if (pending == 0)
+			break;
+		now = evNowTime();
+
+		/* Stop waiting for nameservers that have had their chance. */
+		for (j = 0; j < nfds; j++) {
+			if (fds[j].fd < 0)
+				continue;
+			if (evCmpTime(now, fd_finish[j]) >= 0) {
+				Dprint(statp->options & RES_DEBUG, (stdout, ";; timeout\n"));
+				for (i = 0; i < nq; i++) {
+					if (outstanding[j] & pending & (1U << i))
+						add_stats_sample(statp, revision_id, params,
+						    fd_ns[j], sent_time[j], RCODE_TIMEOUT, 0,
+						    record);
+				}
+				*gotsomewhere = 1;
+				fds[j].fd = -1;
+				continue;
+			}
+			waiting |= outstanding[j] & pending;
+		}
+
+		/*
+		 * Ask the next nameserver if it's time, or if nobody is
+		 * working on some of the queries any more.
+		 */
+		if (next < statp->nscount &&
+		    (waiting != pending || evCmpTime(now, next_at) >= 0)) {
+			int s;
+
+			ns = next++;
+			if (!usable_servers[ns])
+				continue;
+			n = open_dg(statp, ns, terrno);
+			if (n < 0)
+				return (-1);
+			/* open_dg() closes every socket when it fails */
+			for (j = 0; j < nfds; j++) {
+				if (fds[j].fd >= 0 && EXT(statp).nssocks[fd_ns[j]] != fds[j].fd)
+					fds[j].fd = -1;
+			}
+			if (n == 0)
+				continue;
+			s = EXT(statp).nssocks[ns];
+			statp->_flags &= ~RES_F_LASTMASK;
+			statp->_flags |= (ns << RES_F_LASTSHIFT);
+
+			fds[nfds].fd = s;
+			fds[nfds].events = POLLIN;
+			fds[nfds].revents = 0;
+			fd_ns[nfds] = ns;
+			outstanding[nfds] = 0;
+			sent_at[nfds] = now;
+			sent_time[nfds] = time(NULL);
+			fd_finish[nfds] = evAddTime(now, evConsTime((long)get_timeout(statp, ns), 0L));
+			for (i = 0; i < nq; i++) {
+				if (!(pending & (1U << i)))
+					continue;
+				if (send(s, (const char*)q[i].buf, (size_t)q[i].buflen, 0) != q[i].buflen) {
+					Perror(statp, stderr, "send", errno);
+					drop_dg_staggered(statp, ns, &fds[nfds]);
+					break;
+				}
+				outstanding[nfds] |= 1U << i;
+			}
+			nfds++;
+			next_at = evAddTime(now, get_parallel_delay(&stats[ns]));
+			continue;
+		}
+		if (waiting != pending)
+			break;	/* nobody left to ask */
+
+		/* Wait for an answer, or until there's something else to do. */
+		deadline = next_at;
+		n = next < statp->nscount;
+		for (j = 0; j < nfds; j++) {
+			if (fds[j].fd >= 0 && (!n || evCmpTime(fd_finish[j], deadline) < 0)) {
+				deadline = fd_finish[j];
+				n = 1;
+			}
+		}
+		n = poll_until(fds, (nfds_t)nfds, &deadline);
+		if (n == 0)
+			continue;
+		if (n < 0) {
+			Perror(statp, stderr, "poll", errno);
+			res_nclose(statp);
+			return (0);
+		}
+
+		for (j = 0; j < nfds; j++) {
+			struct sockaddr_storage from;
+			socklen_t fromlen;
+			struct dg_query *qp;
+			HEADER hdr, *anhp;
+			int resplen, rcode, bit;
+
+			if (fds[j].fd < 0 || fds[j].revents == 0)
+				continue;
+			ns = fd_ns[j];
+
+			/* Peek at the id to see which query this answers. */
+			errno = 0;
+			memset(&hdr, 0, sizeof(hdr));
+			resplen = recv(fds[j].fd, (char*)&hdr, sizeof(hdr), MSG_PEEK);
+			if (resplen <= 0) {
+				/* ICMP port unreachable, say: give up on this nameserver */
+				Perror(statp, stderr, "recvfrom", errno);
+				for (i = 0; i < nq; i++) {
+					if (outstanding[j] & pending & (1U << i))
+						add_stats_sample(statp, revision_id, params,
+						    ns, sent_time[j], RCODE_INTERNAL_ERROR, 0,
+						    record);
+				}
+				drop_dg_staggered(statp, ns, &fds[j]);
+				continue;
+			}
+			*gotsomewhere = 1;
+			qp = NULL;
+			bit = 0;
+			for (i = 0; i < nq; i++) {
+				if ((outstanding[j] & pending & (1U << i)) &&
+				    ((const HEADER *)(const void *)q[i].buf)->id == hdr.id) {
+					qp = &q[i];
+					bit = 1 << i;
+				}
+			}
+			if (qp == NULL) {
+				/* an old answer, or one we no longer need */
+				recv(fds[j].fd, (char*)&hdr, sizeof(hdr), 0);
+				continue;
+			}
+
+			anhp = (HEADER *)(void *)qp->ans;
+			fromlen = sizeof(from);
+			resplen = recvfrom(fds[j].fd, (char*)qp->ans, (size_t)qp->anssiz, 0,
+					   (struct sockaddr *)(void *)&from, &fromlen);
+			if (resplen < HFIXEDSZ) {
+				Dprint(statp->options & RES_DEBUG,
+				       (stdout, ";; undersized: %d\n", resplen));
+				*terrno = EMSGSIZE;
+				drop_dg_staggered(statp, ns, &fds[j]);
+				continue;
+			}
+			if (!(statp->options & RES_INSECURE1) &&
+			    !res_ourserver_p(statp, (struct sockaddr *)(void *)&from)) {
+				DprintQ((statp->options & RES_DEBUG) ||
+					(statp->pfcode & RES_PRF_REPLY),
+					(stdout, ";; not our server:\n"),
+					qp->ans, (resplen > qp->anssiz) ? qp->anssiz : resplen);
+				continue;
+			}
+#ifdef RES_USE_EDNS0
+			if (anhp->rcode == FORMERR && (statp->options & RES_USE_EDNS0) != 0U) {
+				DprintQ(statp->options & RES_DEBUG,
+					(stdout, "server rejected query with EDNS0:\n"),
+					qp->ans, (resplen > qp->anssiz) ? qp->anssiz : resplen);
+				statp->_flags |= RES_F_EDNS0ERR;
+				outstanding[j] &= ~bit;
+				continue;
+			}
+#endif
+			if (!(statp->options & RES_INSECURE2) &&
+			    !res_queriesmatch(qp->buf, qp->buf + qp->buflen,
+					      qp->ans, qp->ans + qp->anssiz)) {
+				DprintQ((statp->options & RES_DEBUG) ||
+					(statp->pfcode & RES_PRF_REPLY),
+					(stdout, ";; wrong query name:\n"),
+					qp->ans, (resplen > qp->anssiz) ? qp->anssiz : resplen);
+				continue;
+			}
+			outstanding[j] &= ~bit;
+			done = evNowTime();
+			rcode = anhp->rcode;
+			add_stats_sample(statp, revision_id, params, ns, sent_time[j],
+			    rcode, _res_stats_calculate_rtt(&done, &sent_at[j]), record);
+			if ((rcode == SERVFAIL || rcode == NOTIMP || rcode == REFUSED) &&
+			    !statp->pfcode) {
+				DprintQ(statp->options & RES_DEBUG,
+					(stdout, "server rejected query:\n"),
+					qp->ans, (resplen > qp->anssiz) ? qp->anssiz : resplen);
+				qp->rcode = rcode;
+				continue;
+			}
+			if (!(statp->options & RES_IGNTC) && anhp->tc) {
+				Dprint(statp->options & RES_DEBUG,
+				       (stdout, ";; truncated answer\n"));
+				qp->truncated = 1;
+				continue;
+			}
+			qp->rcode = rcode;
+			qp->delay = _res_stats_calculate_rtt(&done, &sent_at[j]);
+			qp->resplen = resplen;
+		}
+	}
+	return dg_queries_pending(q, nq) ? 0 : 1;
+}
+
 static void
 Aerror(const res_state statp, FILE *file, const char *string, int error,
        const struct sockaddr *address, int alen)
@@ -1362,28 +2437,3 @@ sock_eq(struct sockaddr *a, struct sockaddr *b) {
 	}
 }
 
-#ifdef NEED_PSELECT
-/* XXX needs to move to the porting library. */
-static int
-pselect(int nfds, void *rfds, void *wfds, void *efds,
-	struct timespec *tsp, const sigset_t *sigmask)
-{
-	struct timeval tv, *tvp;
-	sigset_t sigs;
-	int n;
-
-	if (tsp) {
-		tvp = &tv;
-		tv = evTimeVal(*tsp);
-	} else
-		tvp = NULL;
-	if (sigmask)
-		sigprocmask(SIG_SETMASK, sigmask, &sigs);
-	n = select(nfds, rfds, wfds, efds, tvp);
-	if (sigmask)
-		sigprocmask(SIG_SETMASK, &sigs, NULL);
-	if (tsp)
-		*tsp = evTimeSpec(tv);
-	return (n);
-}
-#endif
@@ -45,6 +45,17 @@ _res_stats_set_sample(struct __res_sample* sample, time_t now, int rcode, int rt
     sample->rtt = rtt;
 }
 
+/* Returns the bucket that counts a round-trip time or latency of rtt ms. */
+int
+_res_stats_rtt_bucket(int rtt) {
+    int bucket = 0;
+    while (rtt > 0 && bucket < RES_RTT_BUCKETS - 1) {
+        rtt >>= 1;
+        ++bucket;
+    }
+    return bucket;
+}
+
 /* Clears all stored samples for the given server. */
 void
 _res_stats_clear_samples(struct __res_stats* stats)
@@ -104,6 +104,43 @@ enum {
    */
   ANDROID_DLEXT_USE_NAMESPACE = 0x200,
 
+  /* When set, the libraries that have to be loaded for this dlopen (the
+   * library itself and its not yet loaded DT_NEEDED dependencies) are mapped
+   * into memory by a small pool of helper threads. Linking and constructors
+   * still run on the calling thread in the usual order.
+   */
+  ANDROID_DLEXT_PARALLEL_LOAD = 0x400,
+
+  /* When set, R_*_JUMP_SLOT relocations of the libraries loaded by this dlopen
+   * are resolved on the first call through the PLT instead of at load time.
+   * Libraries linked with -z now, or whose PLT GOT is covered by PT_GNU_RELRO,
+   * are still bound eagerly. This is currently supported on arm64 and x86_64
+   * and ignored elsewhere. An unresolvable symbol aborts the process at the
+   * time of the first call.
+   */
+  ANDROID_DLEXT_LAZY_BIND = 0x800,
+
+  /* When set, a library whose executable segment is 2 MB aligned in the file
+   * is mapped at a 2 MB aligned address and advised with MADV_HUGEPAGE so that
+   * the kernel can back its text with huge pages. Libraries that do not meet
+   * the alignment requirement are loaded as usual. Ignored together with
+   * ANDROID_DLEXT_RESERVED_ADDRESS* and the fixed address flags.
+   */
+  ANDROID_DLEXT_HUGE_PAGE_ALIGN = 0x1000,
+
+  /* When set, the constructors of the library and its not yet initialized
+   * dependencies run on a small pool of helper threads: a library's
+   * constructors still only start once those of all its dependencies have
+   * returned, but libraries that do not depend on each other are initialized
+   * concurrently. Calls into the dynamic linker from these constructors are
+   * serialized among the pool but do not wait for other threads. All
+   * constructors are considered started when the first one runs, so a
+   * dlopen() from one of them does not wait for the constructors of
+   * unrelated libraries of this dlopen(). dlopen() returns once all
+   * constructors have returned.
+   */
+  ANDROID_DLEXT_PARALLEL_CONSTRUCTORS = 0x2000,
+
   /* Mask of valid bits */
   ANDROID_DLEXT_VALID_FLAG_BITS       = ANDROID_DLEXT_RESERVED_ADDRESS |
                                         ANDROID_DLEXT_RESERVED_ADDRESS_HINT |
@@ -114,7 +151,11 @@ enum {
                                         ANDROID_DLEXT_FORCE_LOAD |
                                         ANDROID_DLEXT_FORCE_FIXED_VADDR |
                                         ANDROID_DLEXT_LOAD_AT_FIXED_ADDRESS |
-                                        ANDROID_DLEXT_USE_NAMESPACE,
+                                        ANDROID_DLEXT_USE_NAMESPACE |
+                                        ANDROID_DLEXT_PARALLEL_LOAD |
+                                        ANDROID_DLEXT_LAZY_BIND |
+                                        ANDROID_DLEXT_HUGE_PAGE_ALIGN |
+                                        ANDROID_DLEXT_PARALLEL_CONSTRUCTORS,
 };
 
 struct android_namespace_t;
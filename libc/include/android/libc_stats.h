@@ -0,0 +1,94 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef _ANDROID_LIBC_STATS_H
+#define _ANDROID_LIBC_STATS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/cdefs.h>
+
+__BEGIN_DECLS
+
+/*
+ * Statistics from inside libc and the dynamic linker, for monitoring. Keeping them costs next to
+ * nothing: the hot paths only add to counters that belong to the calling thread, and all the
+ * summing up happens when they're read. The names are of the form "subsystem.what", and they
+ * include:
+ *
+ *   dns.*          the DNS cache and queries, summed over every network
+ *   linker.*       relocations the dynamic linker has done
+ *   malloc.*       allocations and frees, as from malloc_iterate_thread_stats, and mallinfo
+ *   properties.*   system property lookups
+ *   pthread.*      live threads and thread stack reuse
+ *   stdio.*        buffer refills and flushes
+ *
+ * Which statistics there are may change from release to release, so look them up by name.
+ */
+
+enum {
+  /* Only ever goes up. */
+  ANDROID_LIBC_STAT_COUNTER = 0,
+  /* A value now, which may go up or down. */
+  ANDROID_LIBC_STAT_GAUGE = 1,
+  /* A count of samples, by size. */
+  ANDROID_LIBC_STAT_HISTOGRAM = 2,
+};
+
+struct android_libc_stat {
+  const char* name;
+  int type;
+  /* The counter or gauge, or the number of samples in a histogram. */
+  uint64_t value;
+  /*
+   * Histograms only (bucket_count is 0 otherwise). buckets[i] counts the samples no bigger than
+   * bucket_limits[i] and bigger than bucket_limits[i - 1]. The last limit is UINT64_MAX.
+   */
+  size_t bucket_count;
+  const uint64_t* bucket_limits;
+  const uint64_t* buckets;
+};
+
+/*
+ * Calls callback once for each statistic. Counters that other threads are still adding to are
+ * only a snapshot. No libc locks are held while the callback runs. Returns 0, or -1 and sets
+ * errno.
+ */
+int android_libc_stats_iterate(void (*callback)(const struct android_libc_stat* stat, void* arg),
+                               void* arg) __INTRODUCED_IN_FUTURE;
+
+/*
+ * Writes the statistics to fd, one line each: "counter <name> <value>", "gauge <name> <value>",
+ * or "histogram <name> <samples>" followed by " <limit>:<count>" for each non-empty bucket, with
+ * "max" as the last bucket's limit. Returns 0, or -1 and sets errno.
+ */
+int android_libc_stats_dump(int fd) __INTRODUCED_IN_FUTURE;
+
+__END_DECLS
+
+#endif
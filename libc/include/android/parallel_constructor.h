@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef _ANDROID_PARALLEL_CONSTRUCTOR_H
+#define _ANDROID_PARALLEL_CONSTRUCTOR_H
+
+#include <sys/cdefs.h>
+
+/*
+ * Android extension: constructors that don't depend on each other, run on several threads at
+ * once before main(). Declare one with
+ *
+ *   ANDROID_PARALLEL_CONSTRUCTOR(init_tables) {
+ *     ...
+ *   }
+ *
+ * They run after every ordinary constructor (so they can rely on those, but ordinary
+ * constructors can't rely on them), in no particular order, and all of them have finished by
+ * the time main() is called. The threads that run them have exited by then too.
+ *
+ * Only static executables run them: libc finds them through the section the static linker
+ * collects them in. Don't use this in code that might be linked into a dynamic executable or a
+ * shared library.
+ */
+#define ANDROID_PARALLEL_CONSTRUCTOR(fn) \
+  static void fn(void); \
+  __attribute__((__section__("android_parallel_init"), __used__)) \
+  static void (* const __android_parallel_init_ ## fn)(void) = fn; \
+  static void fn(void)
+
+#endif
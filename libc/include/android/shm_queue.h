@@ -0,0 +1,127 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef _ANDROID_SHM_QUEUE_H
+#define _ANDROID_SHM_QUEUE_H
+
+#include <stddef.h>
+#include <sys/cdefs.h>
+#include <time.h>
+
+__BEGIN_DECLS
+
+/*
+ * A bounded queue of messages in shared memory, for passing messages between processes
+ * without copying them through the kernel. Producers build each message in place in the
+ * queue's memory and then commit it; consumers read it in place and then release it. Waiting
+ * for a message, or for room for one, uses futexes shared between the processes.
+ *
+ * One process creates the queue and passes its file descriptor to the others (over a unix
+ * domain socket or binder, say), which open it. A forked child can just keep using the
+ * parent's queue. A process that dies between reserving and committing a message, or between
+ * receiving and releasing one, leaves that slot, and so the queue, stuck.
+ */
+
+typedef struct android_shm_queue android_shm_queue;
+
+/*
+ * The queue will only ever have one producer and one consumer at a time, so they can
+ * advance their positions without atomic read-modify-write instructions.
+ */
+#define ANDROID_SHM_QUEUE_SPSC 0x1
+
+/*
+ * Creates a queue of message_count messages of up to message_size bytes each, in a new memfd
+ * (or ashmem region, on kernels without memfd_create). message_count is rounded up to a power
+ * of two, and to at least two. Returns the queue, or NULL and sets errno: EINVAL for a zero or too large
+ * message_size or message_count or unknown flags, or the error from creating the memory.
+ */
+android_shm_queue* android_shm_queue_create(size_t __message_size, size_t __message_count,
+                                            int __flags) __INTRODUCED_IN_FUTURE;
+
+/*
+ * Opens the queue in fd, which came from android_shm_queue_get_fd in another process. The
+ * queue has its own duplicate of fd. Returns the queue, or NULL and sets errno: EINVAL if fd
+ * doesn't hold a queue, or the error from mapping it.
+ */
+android_shm_queue* android_shm_queue_open(int __fd) __INTRODUCED_IN_FUTURE;
+
+/*
+ * Unmaps the queue and closes its file descriptor. The queue itself lasts until every
+ * process has closed it.
+ */
+void android_shm_queue_close(android_shm_queue* __queue) __INTRODUCED_IN_FUTURE;
+
+/* Returns the file descriptor to pass to other processes to open the queue. */
+int android_shm_queue_get_fd(android_shm_queue* __queue) __INTRODUCED_IN_FUTURE;
+
+/* Returns the most bytes a message can hold. */
+size_t android_shm_queue_get_message_size(android_shm_queue* __queue) __INTRODUCED_IN_FUTURE;
+
+/*
+ * Reserves the next free message in the queue, waiting until abs_timeout (against
+ * CLOCK_MONOTONIC), or forever if it's NULL, for one. Returns a pointer to
+ * android_shm_queue_get_message_size bytes, suitably aligned for any type, to build the
+ * message in and then pass to android_shm_queue_commit. Returns NULL and sets errno to
+ * ETIMEDOUT if the queue stayed full, or EINVAL for an invalid abs_timeout.
+ */
+void* android_shm_queue_reserve(android_shm_queue* __queue, const struct timespec* __abs_timeout)
+  __INTRODUCED_IN_FUTURE;
+
+/* Like android_shm_queue_reserve, but returns NULL with errno EAGAIN rather than waiting. */
+void* android_shm_queue_try_reserve(android_shm_queue* __queue) __INTRODUCED_IN_FUTURE;
+
+/*
+ * Makes the first size bytes of a message from android_shm_queue_reserve available to
+ * consumers. Messages are received in the order they were reserved, so a reserved message
+ * holds up any reserved after it until it's committed.
+ */
+void android_shm_queue_commit(android_shm_queue* __queue, void* __message, size_t __size)
+  __INTRODUCED_IN_FUTURE;
+
+/*
+ * Receives the next message in the queue, waiting until abs_timeout (against
+ * CLOCK_MONOTONIC), or forever if it's NULL, for one. Returns a pointer to the message, which
+ * stays valid until it's passed to android_shm_queue_release, and sets *size to its size.
+ * Returns NULL and sets errno to ETIMEDOUT if the queue stayed empty, or EINVAL for an
+ * invalid abs_timeout.
+ */
+void* android_shm_queue_receive(android_shm_queue* __queue, size_t* __size,
+                                const struct timespec* __abs_timeout) __INTRODUCED_IN_FUTURE;
+
+/* Like android_shm_queue_receive, but returns NULL with errno EAGAIN rather than waiting. */
+void* android_shm_queue_try_receive(android_shm_queue* __queue, size_t* __size)
+  __INTRODUCED_IN_FUTURE;
+
+/* Returns a message from android_shm_queue_receive to the queue, for reuse by producers. */
+void android_shm_queue_release(android_shm_queue* __queue, void* __message)
+  __INTRODUCED_IN_FUTURE;
+
+__END_DECLS
+
+#endif
@@ -0,0 +1,76 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+
+#ifndef _ANDROID_SYSCALL_STATS_H
+#define _ANDROID_SYSCALL_STATS_H
+
+#include <stdint.h>
+#include <sys/cdefs.h>
+#include <sys/types.h>
+
+__BEGIN_DECLS
+
+/*
+ * Per-thread system call statistics, from the instrumented build of libc.so that's installed
+ * in the "syscall_stats" subdirectory of the library directory (/system/lib64/syscall_stats,
+ * say). Run a process with that directory on LD_LIBRARY_PATH, and every system call libc makes
+ * through one of its generated stubs is counted and timed. With the ordinary libc.so, these
+ * functions fail with ENOSYS.
+ *
+ * Cycles are timestamp counter ticks on x86 and x86_64, and virtual counter ticks on arm64.
+ * Other architectures only count calls, and report 0 cycles.
+ */
+
+struct android_syscall_stats {
+  /* The thread, or 0 for the total of all the threads that have exited. */
+  pid_t tid;
+  /* The libc function, which isn't always named after the system call it makes. */
+  const char* name;
+  uint64_t calls;
+  uint64_t cycles;
+};
+
+/*
+ * Calls callback once for each system call that each thread has made at least once. Threads
+ * still running may go on making calls, so their counts are only a snapshot. The callback must
+ * not start or exit threads. Returns 0, or -1 and sets errno.
+ */
+int android_syscall_stats_iterate(void (*callback)(const struct android_syscall_stats* stats,
+                                                   void* arg),
+                                  void* arg) __INTRODUCED_IN_FUTURE;
+
+/*
+ * Writes the statistics to fd, one "tid name calls cycles" line each. Returns 0, or -1 and sets
+ * errno.
+ */
+int android_syscall_stats_dump(int fd) __INTRODUCED_IN_FUTURE;
+
+__END_DECLS
+
+#endif
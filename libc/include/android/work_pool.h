@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef _ANDROID_WORK_POOL_H
+#define _ANDROID_WORK_POOL_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/cdefs.h>
+
+__BEGIN_DECLS
+
+/*
+ * A process-wide pool of worker threads, one for each CPU the process may run on, that
+ * libraries can share instead of each starting their own threads. Every worker has its own
+ * queue of tasks, and workers with nothing to do steal tasks from the others' queues.
+ */
+
+/*
+ * Tracks a set of tasks so that they can be waited for.
+ * Initialize it with ANDROID_WORK_GROUP_INITIALIZER.
+ */
+typedef struct {
+  int32_t __private[2];
+} android_work_group_t;
+
+#define ANDROID_WORK_GROUP_INITIALIZER { { 0, 0 } }
+
+/*
+ * Queues fn(arg) to be run by the pool as part of group. A task spawned from a task goes onto
+ * the queue of the worker running it. If the task can't be queued, it's run before returning.
+ * Returns 0, or EINVAL if group or fn is null.
+ */
+int android_work_pool_spawn(android_work_group_t* group, void (*fn)(void*), void* arg)
+  __INTRODUCED_IN_FUTURE;
+
+/*
+ * Waits until all the tasks spawned as part of group have finished, running queued tasks
+ * meanwhile. The group can be reused once this returns. Returns 0, or EINVAL if group is null.
+ */
+int android_work_pool_wait(android_work_group_t* group) __INTRODUCED_IN_FUTURE;
+
+/* Returns the number of worker threads in the pool, starting it if necessary. */
+size_t android_work_pool_get_worker_count(void) __INTRODUCED_IN_FUTURE;
+
+__END_DECLS
+
+#endif
@@ -61,18 +61,64 @@ __BEGIN_DECLS
 
 extern const char* _ctype_;
 
-int isalnum(int);
-int isalpha(int);
-int isblank(int);
-int iscntrl(int);
-int isdigit(int);
-int isgraph(int);
-int islower(int);
-int isprint(int);
-int ispunct(int);
-int isspace(int);
-int isupper(int);
-int isxdigit(int);
+/*
+ * The classification functions are simple enough for the C locale (the only
+ * one for the single-byte functions) that they're defined inline here, as a
+ * range check or two with no table lookup. bionic/ctype.cpp defines
+ * __BIONIC_CTYPE_INLINE to get out-of-line copies for the ABI.
+ */
+#if !defined(__BIONIC_CTYPE_INLINE)
+#define __BIONIC_CTYPE_INLINE static __inline
+#endif
+
+__BIONIC_CTYPE_INLINE int isalpha(int __ch) {
+  return (__BIONIC_CAST(static_cast, unsigned, __ch) | 0x20) - 'a' < 26;
+}
+
+__BIONIC_CTYPE_INLINE int isblank(int __ch) {
+  return __ch == ' ' || __ch == '\t';
+}
+
+__BIONIC_CTYPE_INLINE int iscntrl(int __ch) {
+  return __BIONIC_CAST(static_cast, unsigned, __ch) < ' ' || __ch == 0x7f;
+}
+
+__BIONIC_CTYPE_INLINE int isdigit(int __ch) {
+  return __BIONIC_CAST(static_cast, unsigned, __ch) - '0' < 10;
+}
+
+__BIONIC_CTYPE_INLINE int isgraph(int __ch) {
+  return __BIONIC_CAST(static_cast, unsigned, __ch) - '!' < 94;
+}
+
+__BIONIC_CTYPE_INLINE int islower(int __ch) {
+  return __BIONIC_CAST(static_cast, unsigned, __ch) - 'a' < 26;
+}
+
+__BIONIC_CTYPE_INLINE int isprint(int __ch) {
+  return __BIONIC_CAST(static_cast, unsigned, __ch) - ' ' < 95;
+}
+
+__BIONIC_CTYPE_INLINE int isspace(int __ch) {
+  return __ch == ' ' || __BIONIC_CAST(static_cast, unsigned, __ch) - '\t' < 5;
+}
+
+__BIONIC_CTYPE_INLINE int isupper(int __ch) {
+  return __BIONIC_CAST(static_cast, unsigned, __ch) - 'A' < 26;
+}
+
+__BIONIC_CTYPE_INLINE int isxdigit(int __ch) {
+  return isdigit(__ch) || (__BIONIC_CAST(static_cast, unsigned, __ch) | 0x20) - 'a' < 6;
+}
+
+__BIONIC_CTYPE_INLINE int isalnum(int __ch) {
+  return isalpha(__ch) || isdigit(__ch);
+}
+
+__BIONIC_CTYPE_INLINE int ispunct(int __ch) {
+  return isgraph(__ch) && !isalnum(__ch);
+}
+
 int tolower(int);
 int toupper(int);
 
@@ -92,6 +92,16 @@ int scandirat(int, const char*, struct dirent***, int (*)(const struct dirent*),
               int (*)(const struct dirent**, const struct dirent**)) __INTRODUCED_IN(24);
 #endif
 
+/*
+ * Android extension: stores pointers to up to count of the next entries in the
+ * directory in entries, taking the DIR's lock once rather than once per entry
+ * as readdir does. Returns the number of entries stored, which is fewer than
+ * count if that's all that the last getdents system call returned, 0 at the end
+ * of the directory, or -1 and sets errno on error. As with readdir, the entries
+ * are only valid until the next read from the same DIR.
+ */
+int android_readdir_batch(DIR*, struct dirent**, int) __INTRODUCED_IN_FUTURE;
+
 __END_DECLS
 
 #endif /* _DIRENT_H_ */
@@ -57,6 +57,12 @@ int feenableexcept(int) __INTRODUCED_IN_ARM(21) __INTRODUCED_IN_MIPS(21) __INTRO
 int fedisableexcept(int) __INTRODUCED_IN_ARM(21) __INTRODUCED_IN_MIPS(21) __INTRODUCED_IN_X86(9);
 int fegetexcept(void) __INTRODUCED_IN_ARM(21) __INTRODUCED_IN_MIPS(21) __INTRODUCED_IN_X86(9);
 
+// Sets the rounding mode like fesetround, but returns the previous mode (or -1
+// for an invalid mode), so a caller can switch and restore with one call each.
+// On x86-64 only the SSE rounding mode, used by float and double, is changed;
+// long double arithmetic on the x87 keeps its mode.
+int feswapround(int) __INTRODUCED_IN_FUTURE;
+
 /*
  * The following constant represents the default floating-point environment
  * (that is, the one installed at program startup) and has type pointer to
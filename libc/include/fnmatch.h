@@ -28,6 +28,7 @@
 #ifndef _FNMATCH_H
 #define _FNMATCH_H
 
+#include <stddef.h>
 #include <sys/cdefs.h>
 
 __BEGIN_DECLS
@@ -46,6 +47,24 @@ __BEGIN_DECLS
 
 int fnmatch(const char* pattern, const char* string, int flags);
 
+/*
+ * A set of patterns compiled for matching many strings against, with the same flags for each.
+ * Patterns of the common forms "literal", "prefix*", "*suffix" and "*infix*" are matched with
+ * simple comparisons, and the string is only scanned once for all of them. The set keeps its
+ * own copy of the patterns. Returns NULL with errno set on failure.
+ */
+typedef struct android_fnmatch_set android_fnmatch_set;
+android_fnmatch_set* android_fnmatch_set_create(const char* const* patterns, size_t count,
+                                                int flags) __INTRODUCED_IN_FUTURE;
+void android_fnmatch_set_destroy(android_fnmatch_set* set) __INTRODUCED_IN_FUTURE;
+/*
+ * Finds the first pattern at or after index start that matches string, as fnmatch would.
+ * Returns 0 and sets *index if there is one, and FNM_NOMATCH otherwise. Call again with
+ * start = *index + 1 to find the rest.
+ */
+int android_fnmatch_set_match(const android_fnmatch_set* set, const char* string, size_t start,
+                              size_t* index) __INTRODUCED_IN_FUTURE;
+
 __END_DECLS
 
 #endif /* _FNMATCH_H */
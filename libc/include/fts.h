@@ -56,6 +56,7 @@ typedef struct {
 #define	FTS_PHYSICAL	0x0010		/* physical walk */
 #define	FTS_SEEDOT	0x0020		/* return dot and dot-dot */
 #define	FTS_XDEV	0x0040		/* don't cross devices */
+#define	FTS_NOSTAT_TYPE	0x0080		/* FTS_NOSTAT, but fts_info from d_type */
 #define	FTS_OPTIONMASK	0x00ff		/* valid user option mask */
 
 #define	FTS_NAMEONLY	0x1000		/* (private) child names only */
@@ -61,6 +61,18 @@ int nftw(const char*, int (*)(const char*, const struct stat*, int, struct FTW*)
 int ftw64(const char*, int (*)(const char*, const struct stat64*, int), int) __INTRODUCED_IN(21);
 int nftw64(const char*, int (*)(const char*, const struct stat64*, int, struct FTW*), int, int)
   __INTRODUCED_IN(21);
+
+/*
+ * Android extension: nftw, but with the directories read in parallel by the process-wide work
+ * pool (see <android/work_pool.h>). The callback may be called from several threads at once,
+ * and the only ordering is that a directory's FTW_D comes before, or with FTW_DEPTH its FTW_DP
+ * comes after, the calls for what's in it. FTW_CHDIR isn't supported (EINVAL), since all the
+ * threads share a working directory. A non-zero return from the callback stops the walk once
+ * the calls already under way have returned, and is returned (one of them, if there are
+ * several).
+ */
+int android_nftw_parallel(const char*, int (*)(const char*, const struct stat*, int, struct FTW*),
+                          int, int) __INTRODUCED_IN_FUTURE;
 __END_DECLS
 
 #endif	/* !_FTW_H */
@@ -54,6 +54,16 @@ struct ifaddrs {
 void freeifaddrs(struct ifaddrs*) __INTRODUCED_IN(24);
 int getifaddrs(struct ifaddrs**) __INTRODUCED_IN(24);
 
+/*
+ * Like getifaddrs, but only returns entries of the given family, and only for the interface with
+ * the given index. The family can be AF_INET or AF_INET6 for addresses, AF_PACKET for the
+ * interfaces themselves, or AF_UNSPEC for everything; an index of 0 means all interfaces. Only
+ * what's asked for is requested from the kernel, which is much cheaper than a full dump on
+ * systems with many interfaces. The result is freed with freeifaddrs.
+ */
+int android_getifaddrs_filtered(struct ifaddrs** __list_ptr, int __family,
+                                unsigned int __if_index) __INTRODUCED_IN_FUTURE;
+
 __END_DECLS
 
 #endif
@@ -45,6 +45,18 @@ struct dl_phdr_info {
   const char* dlpi_name;
   const ElfW(Phdr)* dlpi_phdr;
   ElfW(Half) dlpi_phnum;
+
+  /* The number of objects loaded into and unloaded from the process so far.
+   * Only present if the size argument of the callback covers them. */
+  unsigned long long dlpi_adds;
+  unsigned long long dlpi_subs;
+
+  /* The module id of the object's PT_TLS segment, or 0 if it has none, and the
+   * calling thread's block for it, or NULL if the thread hasn't allocated one
+   * (always NULL in android_get_dl_phdr_snapshot()). Only present if the size
+   * argument of the callback covers them. */
+  size_t dlpi_tls_modid;
+  void* dlpi_tls_data;
 };
 
 #if defined(__arm__)
@@ -53,6 +65,22 @@ int dl_iterate_phdr(int (*)(struct dl_phdr_info*, size_t, void*), void*) __INTRO
 int dl_iterate_phdr(int (*)(struct dl_phdr_info*, size_t, void*), void*);
 #endif
 
+/* An immutable snapshot of what dl_iterate_phdr() would report. */
+struct android_dl_phdr_snapshot {
+  unsigned long long dlpi_adds;
+  unsigned long long dlpi_subs;
+  size_t count;
+  const struct dl_phdr_info* infos;
+};
+
+/* Returns a snapshot of the loaded objects without taking the linker lock
+ * unless something was loaded or unloaded since the last call; the same
+ * pointer is returned until then, so callers can cache derived data keyed by
+ * it. Snapshots stay readable for the lifetime of the process, but the
+ * segments of objects unloaded since may no longer be mapped. Returns NULL
+ * on failure. */
+const struct android_dl_phdr_snapshot* android_get_dl_phdr_snapshot(void) __INTRODUCED_IN_FUTURE;
+
 #ifdef __arm__
 typedef long unsigned int* _Unwind_Ptr;
 _Unwind_Ptr dl_unwind_find_exidx(_Unwind_Ptr, int*);
@@ -19,7 +19,9 @@
 
 #include <sys/cdefs.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
+#include <sys/types.h>
 
 __BEGIN_DECLS
 
@@ -37,6 +39,13 @@ void free(void* p);
 void* memalign(size_t alignment, size_t byte_count) __mallocfunc __BIONIC_ALLOC_SIZE(2) __wur;
 size_t malloc_usable_size(const void* p) __INTRODUCED_IN(17);
 
+/*
+ * free_sized is free for callers that know the size the allocation was
+ * requested with, which lets the allocator skip looking it up. With malloc
+ * debug enabled, a size that doesn't match the allocation is reported.
+ */
+void free_sized(void* p, size_t byte_count) __INTRODUCED_IN_FUTURE;
+
 #ifndef STRUCT_MALLINFO_DECLARED
 #define STRUCT_MALLINFO_DECLARED 1
 struct mallinfo {
@@ -55,6 +64,31 @@ struct mallinfo {
 
 struct mallinfo mallinfo(void);
 
+/*
+ * mallopt options for returning memory to the kernel. They return 1 on
+ * success and 0 if the option isn't supported.
+ *
+ * M_DECAY_TIME: unused dirty pages are returned over the next value seconds,
+ * in every existing and future arena. 0 returns them as soon as they are
+ * unused, and -1 keeps them until M_PURGE.
+ * M_PURGE: returns all unused dirty pages now. The value is ignored.
+ * M_FLUSH_THREAD_CACHE: returns the objects cached by the calling thread to
+ * their arenas, so that M_PURGE can release them. The value is ignored.
+ */
+#define M_DECAY_TIME (-100)
+#define M_PURGE (-101)
+#define M_FLUSH_THREAD_CACHE (-102)
+
+int mallopt(int option, int value) __INTRODUCED_IN_FUTURE;
+
+/*
+ * malloc_trim returns the calling thread's cached objects and all unused
+ * dirty pages to the kernel, like mallopt(M_FLUSH_THREAD_CACHE) followed by
+ * mallopt(M_PURGE). Returns 1 if any memory was released, and 0 otherwise.
+ * pad is ignored: there is no single top of the heap to keep free.
+ */
+int malloc_trim(size_t pad) __INTRODUCED_IN_FUTURE;
+
 /*
  * XML structure for malloc_info(3) is in the following format:
  *
@@ -72,10 +106,63 @@ struct mallinfo mallinfo(void);
  *     <!-- more bins -->
  *   </heap>
  *   <!-- more heaps -->
+ *   <thread tid="INT">
+ *     <allocated-bytes>INT</allocated-bytes>
+ *     <freed-bytes>INT</freed-bytes>
+ *     <nmalloc>INT</nmalloc>
+ *     <nfree>INT</nfree>
+ *   </thread>
+ *   <!-- more threads -->
  * </malloc>
+ *
+ * The thread elements come from malloc_iterate_thread_stats.
  */
 int malloc_info(int, FILE*) __INTRODUCED_IN(23);
 
+#define MALLOC_THREAD_STATS_SIZE_CLASSES 8
+
+/*
+ * Allocation counters that every thread keeps. Byte counts are usable sizes,
+ * so allocated_bytes - freed_bytes is what the thread's allocations still hold
+ * unless other threads freed them. Size class i counts the requests of up to
+ * 16 << (2 * i) bytes; the last one counts all the bigger ones.
+ */
+struct malloc_thread_stats {
+  pid_t tid;  /* 0 for the combined counters of all threads that have exited. */
+  uint64_t allocated_bytes;
+  uint64_t freed_bytes;
+  /* malloc, calloc, realloc, memalign, posix_memalign, pvalloc and valloc calls. */
+  uint64_t allocation_calls;
+  uint64_t free_calls;
+  uint64_t size_class_calls[MALLOC_THREAD_STATS_SIZE_CLASSES];
+};
+
+/*
+ * Calls callback with the counters of every live thread, then with those of
+ * the exited threads. The counters of other threads are read while they
+ * change, so they are only approximate. The callback must not create or join
+ * threads. Returns 0.
+ */
+int malloc_iterate_thread_stats(void (*callback)(const struct malloc_thread_stats*, void*),
+                                void* arg) __INTRODUCED_IN_FUTURE;
+
+/*
+ * Heaps keep a group of allocations apart from the rest of the process, and
+ * let it be released all at once. android_heap_create returns a heap id, or
+ * -1 and sets errno. Memory from android_heap_malloc must be freed with
+ * android_heap_free on the same heap, or by destroying it.
+ * android_heap_destroy releases every allocation still in the heap and
+ * returns 0, or -1 and sets errno to EINVAL if heap is not a live heap.
+ *
+ * When malloc debug is enabled, heap allocations come from the regular heap
+ * so that all debug checks apply, and destroying a heap does not release them.
+ */
+int android_heap_create(void) __INTRODUCED_IN_FUTURE;
+void* android_heap_malloc(int heap, size_t byte_count) __mallocfunc __BIONIC_ALLOC_SIZE(2) __wur
+    __INTRODUCED_IN_FUTURE;
+void android_heap_free(int heap, void* p) __INTRODUCED_IN_FUTURE;
+int android_heap_destroy(int heap) __INTRODUCED_IN_FUTURE;
+
 __END_DECLS
 
 #endif  /* LIBC_INCLUDE_MALLOC_H_ */
@@ -368,6 +368,114 @@ void sincosf(float, float*, float*);
 void sincosl(long double, long double*, long double*);
 #endif
 
+/*
+ * Bulk versions of some functions, which set out[i] to f(in[i]) (or to
+ * pow(in1[i], in2[i])) for each i < n.  Where there are vector versions of f
+ * (see below) they're built on those, so the results are as accurate as f's but
+ * not always identical to them.  out may be the same array as the input, but
+ * mustn't otherwise overlap it.  (size_t is spelled __SIZE_TYPE__ so that
+ * <math.h> doesn't have to define it.)
+ */
+void cos_array(const double*, double*, __SIZE_TYPE__) __INTRODUCED_IN_FUTURE;
+void exp_array(const double*, double*, __SIZE_TYPE__) __INTRODUCED_IN_FUTURE;
+void log_array(const double*, double*, __SIZE_TYPE__) __INTRODUCED_IN_FUTURE;
+void pow_array(const double*, const double*, double*, __SIZE_TYPE__) __INTRODUCED_IN_FUTURE;
+void sin_array(const double*, double*, __SIZE_TYPE__) __INTRODUCED_IN_FUTURE;
+void cosf_array(const float*, float*, __SIZE_TYPE__) __INTRODUCED_IN_FUTURE;
+void expf_array(const float*, float*, __SIZE_TYPE__) __INTRODUCED_IN_FUTURE;
+void logf_array(const float*, float*, __SIZE_TYPE__) __INTRODUCED_IN_FUTURE;
+void powf_array(const float*, const float*, float*, __SIZE_TYPE__) __INTRODUCED_IN_FUTURE;
+void sinf_array(const float*, float*, __SIZE_TYPE__) __INTRODUCED_IN_FUTURE;
+
+/*
+ * libm also has vector versions of some functions, named and called as the
+ * vector function ABI for the architecture describes (_ZGVbN2v_exp and so
+ * on), which let a loop that calls them be vectorized.  GCC learns about them
+ * from the simd attribute, and clang from "omp declare simd" when building
+ * with -fopenmp.  There are no SVE versions, so an SVE build mustn't be told
+ * about them.
+ */
+#if (defined(__aarch64__) && !defined(__ARM_FEATURE_SVE)) || defined(__x86_64__)
+#if __ANDROID_API__ >= __ANDROID_API_FUTURE__
+#if __has_attribute(__simd__)
+#define __BIONIC_VECTOR_VARIANTS __attribute__((__simd__("notinbranch")))
+#elif defined(_OPENMP) && _OPENMP >= 201307
+#define __BIONIC_VECTOR_VARIANTS _Pragma("omp declare simd notinbranch")
+#endif
+#if defined(__BIONIC_VECTOR_VARIANTS)
+__BIONIC_VECTOR_VARIANTS double cos(double);
+__BIONIC_VECTOR_VARIANTS double exp(double);
+__BIONIC_VECTOR_VARIANTS double log(double);
+__BIONIC_VECTOR_VARIANTS double pow(double, double);
+__BIONIC_VECTOR_VARIANTS double sin(double);
+__BIONIC_VECTOR_VARIANTS float cosf(float);
+__BIONIC_VECTOR_VARIANTS float expf(float);
+__BIONIC_VECTOR_VARIANTS float logf(float);
+__BIONIC_VECTOR_VARIANTS float powf(float, float);
+__BIONIC_VECTOR_VARIANTS float sinf(float);
+#undef __BIONIC_VECTOR_VARIANTS
+#endif
+#endif /* __ANDROID_API__ >= __ANDROID_API_FUTURE__ */
+#endif
+
+/*
+ * On arm64 and x86-64 these are an instruction or two each, so they're defined
+ * inline here, where the compiler can fold and vectorize them even with
+ * -fno-builtin, instead of leaving a call in a hot loop. (The rounding
+ * functions need SSE4.1 on x86-64, and round has no x86 instruction at all.
+ * x86's min and max don't order -0 before +0 as fmin and fmax do, so those are
+ * arm64-only too.)
+ *
+ * They're extern gnu_inline: taking the address of one, or anything else that
+ * needs a real function, gets libm's out-of-line copy. libm itself builds with
+ * __BIONIC_NO_MATH_INLINES so that it can define those copies.
+ */
+#if !defined(__BIONIC_NO_MATH_INLINES) && (defined(__aarch64__) || defined(__x86_64__))
+#define __BIONIC_MATH_INLINE extern __inline__ __always_inline __attribute__((gnu_inline))
+
+__BIONIC_MATH_INLINE double fabs(double __x) { return __builtin_fabs(__x); }
+__BIONIC_MATH_INLINE float fabsf(float __x) { return __builtin_fabsf(__x); }
+__BIONIC_MATH_INLINE long double fabsl(long double __x) { return __builtin_fabsl(__x); }
+
+__BIONIC_MATH_INLINE double copysign(double __x, double __y) {
+  return __builtin_copysign(__x, __y);
+}
+__BIONIC_MATH_INLINE float copysignf(float __x, float __y) {
+  return __builtin_copysignf(__x, __y);
+}
+__BIONIC_MATH_INLINE long double copysignl(long double __x, long double __y) {
+  return __builtin_copysignl(__x, __y);
+}
+
+#if !defined(__cplusplus)
+/* In C++, <cmath>'s std::isinf and std::isnan overloads already use the builtins. */
+__BIONIC_MATH_INLINE int (isinf)(double __x) { return __builtin_isinf(__x); }
+__BIONIC_MATH_INLINE int (isnan)(double __x) { return __builtin_isnan(__x); }
+#endif
+
+#if defined(__aarch64__) || defined(__SSE4_1__)
+__BIONIC_MATH_INLINE double ceil(double __x) { return __builtin_ceil(__x); }
+__BIONIC_MATH_INLINE float ceilf(float __x) { return __builtin_ceilf(__x); }
+__BIONIC_MATH_INLINE double floor(double __x) { return __builtin_floor(__x); }
+__BIONIC_MATH_INLINE float floorf(float __x) { return __builtin_floorf(__x); }
+__BIONIC_MATH_INLINE double rint(double __x) { return __builtin_rint(__x); }
+__BIONIC_MATH_INLINE float rintf(float __x) { return __builtin_rintf(__x); }
+__BIONIC_MATH_INLINE double trunc(double __x) { return __builtin_trunc(__x); }
+__BIONIC_MATH_INLINE float truncf(float __x) { return __builtin_truncf(__x); }
+#endif
+
+#if defined(__aarch64__)
+__BIONIC_MATH_INLINE double fmax(double __x, double __y) { return __builtin_fmax(__x, __y); }
+__BIONIC_MATH_INLINE float fmaxf(float __x, float __y) { return __builtin_fmaxf(__x, __y); }
+__BIONIC_MATH_INLINE double fmin(double __x, double __y) { return __builtin_fmin(__x, __y); }
+__BIONIC_MATH_INLINE float fminf(float __x, float __y) { return __builtin_fminf(__x, __y); }
+__BIONIC_MATH_INLINE double round(double __x) { return __builtin_round(__x); }
+__BIONIC_MATH_INLINE float roundf(float __x) { return __builtin_roundf(__x); }
+#endif
+
+#undef __BIONIC_MATH_INLINE
+#endif
+
 __END_DECLS
 
 #endif /* !_MATH_H_ */
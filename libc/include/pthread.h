@@ -47,6 +47,7 @@ enum {
     PTHREAD_MUTEX_NORMAL = 0,
     PTHREAD_MUTEX_RECURSIVE = 1,
     PTHREAD_MUTEX_ERRORCHECK = 2,
+    PTHREAD_MUTEX_ADAPTIVE_NP = 3,
 
     PTHREAD_MUTEX_ERRORCHECK_NP = PTHREAD_MUTEX_ERRORCHECK,
     PTHREAD_MUTEX_RECURSIVE_NP  = PTHREAD_MUTEX_RECURSIVE,
@@ -54,9 +55,15 @@ enum {
     PTHREAD_MUTEX_DEFAULT = PTHREAD_MUTEX_NORMAL
 };
 
+enum {
+    PTHREAD_PRIO_NONE = 0,
+    PTHREAD_PRIO_INHERIT = 1,
+};
+
 #define PTHREAD_MUTEX_INITIALIZER { { ((PTHREAD_MUTEX_NORMAL & 3) << 14) } }
 #define PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP { { ((PTHREAD_MUTEX_RECURSIVE & 3) << 14) } }
 #define PTHREAD_ERRORCHECK_MUTEX_INITIALIZER_NP { { ((PTHREAD_MUTEX_ERRORCHECK & 3) << 14) } }
+#define PTHREAD_ADAPTIVE_MUTEX_INITIALIZER_NP { { ((PTHREAD_MUTEX_ADAPTIVE_NP & 3) << 14) } }
 
 #define PTHREAD_COND_INITIALIZER  { { 0 } }
 
@@ -65,12 +72,18 @@ enum {
 enum {
   PTHREAD_RWLOCK_PREFER_READER_NP = 0,
   PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP = 1,
+  PTHREAD_RWLOCK_SCALABLE_READERS_NP = 2,
 };
 
 #define PTHREAD_ONCE_INIT 0
 
 #define PTHREAD_BARRIER_SERIAL_THREAD -1
 
+enum {
+  PTHREAD_BARRIER_DEFAULT_NP = 0,
+  PTHREAD_BARRIER_TREE_NP = 1,
+};
+
 #if defined(__LP64__)
 #define PTHREAD_STACK_MIN (4 * PAGE_SIZE)
 #else
@@ -144,9 +157,12 @@ int pthread_key_create(pthread_key_t* _Nonnull, void (*)(void*));
 int pthread_key_delete(pthread_key_t);
 
 int pthread_mutexattr_destroy(pthread_mutexattr_t* _Nonnull);
+int pthread_mutexattr_getprotocol(const pthread_mutexattr_t* _Nonnull, int* _Nonnull)
+  __INTRODUCED_IN_FUTURE;
 int pthread_mutexattr_getpshared(const pthread_mutexattr_t* _Nonnull, int* _Nonnull);
 int pthread_mutexattr_gettype(const pthread_mutexattr_t* _Nonnull, int* _Nonnull);
 int pthread_mutexattr_init(pthread_mutexattr_t* _Nonnull);
+int pthread_mutexattr_setprotocol(pthread_mutexattr_t* _Nonnull, int) __INTRODUCED_IN_FUTURE;
 int pthread_mutexattr_setpshared(pthread_mutexattr_t* _Nonnull, int);
 int pthread_mutexattr_settype(pthread_mutexattr_t* _Nonnull, int);
 
@@ -184,6 +200,10 @@ int pthread_barrierattr_getpshared(const pthread_barrierattr_t* _Nonnull attr,
                                    int* _Nonnull pshared) __INTRODUCED_IN(24);
 int pthread_barrierattr_setpshared(pthread_barrierattr_t* _Nonnull attr, int pshared)
   __INTRODUCED_IN(24);
+int pthread_barrierattr_getkind_np(const pthread_barrierattr_t* _Nonnull attr,
+                                   int* _Nonnull kind) __INTRODUCED_IN_FUTURE;
+int pthread_barrierattr_setkind_np(pthread_barrierattr_t* _Nonnull attr, int kind)
+  __INTRODUCED_IN_FUTURE;
 
 int pthread_barrier_init(pthread_barrier_t* _Nonnull, const pthread_barrierattr_t*, unsigned)
   __INTRODUCED_IN(24);
@@ -19,16 +19,37 @@ typedef enum {
   leaf
 } VISIT;
 
-#ifdef _SEARCH_PRIVATE
-typedef struct node {
+typedef struct entry {
   char* key;
-  struct node* llink;
-  struct node* rlink;
-} node_t;
-#endif
+  void* data;
+} ENTRY;
+
+typedef enum {
+  FIND,
+  ENTER
+} ACTION;
+
+/* The table used by hcreate_r/hsearch_r/hdestroy_r. Zero it before calling hcreate_r. */
+struct hsearch_data {
+  struct __hsearch_table* __table;
+  unsigned int __unused1;
+  unsigned int __unused2;
+};
 
 __BEGIN_DECLS
 
+/*
+ * hsearch keeps an open-addressed table that grows as needed, so the size passed to hcreate is
+ * only a hint. ENTRY pointers returned by hsearch are invalidated by the next ENTER of a new key.
+ */
+int hcreate(size_t) __INTRODUCED_IN_FUTURE;
+void hdestroy(void) __INTRODUCED_IN_FUTURE;
+ENTRY* hsearch(ENTRY, ACTION) __INTRODUCED_IN_FUTURE;
+
+int hcreate_r(size_t, struct hsearch_data*) __INTRODUCED_IN_FUTURE;
+void hdestroy_r(struct hsearch_data*) __INTRODUCED_IN_FUTURE;
+int hsearch_r(ENTRY, ACTION, ENTRY**, struct hsearch_data*) __INTRODUCED_IN_FUTURE;
+
 void insque(void*, void*) __INTRODUCED_IN(21);
 void remque(void*) __INTRODUCED_IN(21);
 
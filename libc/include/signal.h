@@ -158,6 +158,18 @@ void psignal(int, const char*) __INTRODUCED_IN(17);
 int pthread_kill(pthread_t, int);
 int pthread_sigmask(int, const sigset_t*, sigset_t*);
 
+/*
+ * Android extension: blocks every signal except SIGABRT, SIGBUS, SIGFPE, SIGILL, SIGSEGV, SIGSYS
+ * and SIGTRAP for the calling thread until the matching android_defer_signals_end, which lets
+ * any that arrived in between be delivered. Regions nest, and only the outermost begin and end
+ * make system calls. Inside a region, sigprocmask and pthread_sigmask report and change the mask
+ * the region will restore, without a system call unless a synchronous signal's bit changes.
+ * Threads created in a region start with that mask. Returns 0 on success, and -1 and sets errno
+ * on failure; android_defer_signals_end fails with EINVAL outside a region.
+ */
+int android_defer_signals_begin(void) __INTRODUCED_IN_FUTURE;
+int android_defer_signals_end(void) __INTRODUCED_IN_FUTURE;
+
 int sigqueue(pid_t, int, const union sigval) __INTRODUCED_IN(23);
 int sigtimedwait(const sigset_t* _Nonnull, siginfo_t*, const struct timespec*) __INTRODUCED_IN(23);
 int sigwaitinfo(const sigset_t* _Nonnull, siginfo_t*) __INTRODUCED_IN(23);
@@ -47,6 +47,15 @@ size_t __fpending(FILE*) __INTRODUCED_IN(23);
 void _flushlbf(void) __INTRODUCED_IN(23);
 int __fsetlocking(FILE*, int) __INTRODUCED_IN(23);
 
+/*
+ * Declares how `fp` will be accessed: POSIX_FADV_NORMAL, POSIX_FADV_SEQUENTIAL or
+ * POSIX_FADV_RANDOM. Like setvbuf(3), call it before the first I/O on the stream: a
+ * sequential stream then gets a larger buffer, a random one keeps the file's block size.
+ * The hint is also passed to posix_fadvise(2) for the underlying file descriptor.
+ * Returns 0 on success, or -1 and sets errno to EINVAL for an unknown pattern.
+ */
+int __fsetaccesspattern(FILE* fp, int pattern) __INTRODUCED_IN_FUTURE;
+
 __END_DECLS
 
 #endif /* _STDIO_EXT_H */
@@ -49,6 +49,14 @@ int atexit(void (*)(void));
 int at_quick_exit(void (*)(void)) __INTRODUCED_IN(21);
 void quick_exit(int) __noreturn __INTRODUCED_IN(21);
 
+/*
+ * Android extension: when __enabled is non-zero, exit() skips atexit handlers, C++ static and
+ * thread_local destructors. It runs only the at_quick_exit handlers, flushes stdio streams
+ * with unwritten output, and calls _exit. For processes whose destructors do nothing the
+ * kernel won't do anyway, this makes teardown take no longer than its stdio output.
+ */
+void android_set_fast_exit(int __enabled) __INTRODUCED_IN_FUTURE;
+
 char* getenv(const char*);
 int putenv(char*);
 int setenv(const char*, const char*, int);
@@ -96,6 +104,13 @@ void* bsearch(const void* key, const void* base0, size_t nmemb, size_t size,
               int (*compar)(const void*, const void*));
 
 void qsort(void*, size_t, size_t, int (*)(const void*, const void*));
+/*
+ * Like qsort, but passes __arg to each call of the comparator, as in glibc and POSIX.1-2024 (not
+ * the BSDs, where the context argument comes first).
+ */
+void qsort_r(void* __base, size_t __count, size_t __size,
+             int (*__comparator)(const void*, const void*, void*), void* __arg)
+    __INTRODUCED_IN_FUTURE;
 
 uint32_t arc4random(void);
 uint32_t arc4random_uniform(uint32_t);
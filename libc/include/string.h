@@ -167,7 +167,12 @@ void* memchr(const void* s, int c, size_t n) {
     }
 #endif
 
+#if defined(__BIONIC_FORTIFY_INLINE_CHECKS)
+    __bionic_fortify_check_access("memchr", "read from", n, bos);
+    return __builtin_memchr(s, c, n);
+#else
     return __memchr_chk(s, c, n, bos);
+#endif
 }
 
 __BIONIC_FORTIFY_INLINE
@@ -188,19 +193,47 @@ void* memrchr(const void* s, int c, size_t n) {
     }
 #endif
 
+#if defined(__BIONIC_FORTIFY_INLINE_CHECKS)
+    __bionic_fortify_check_access("memrchr", "read from", n, bos);
+    return __memrchr_real(s, c, n);
+#else
     return __memrchr_chk(s, c, n, bos);
+#endif
 }
 #endif /* __ANDROID_API__ >= 23 */
 
 #if __ANDROID_API__ >= 17
 __BIONIC_FORTIFY_INLINE
 void* memcpy(void* _Nonnull __restrict dst, const void* _Nonnull __restrict src, size_t copy_amount) {
+#if defined(__BIONIC_FORTIFY_INLINE_CHECKS)
+    size_t bos = __bos0(dst);
+
+    /* The compiler can diagnose, or do without, the check of a constant size. */
+    if (__builtin_constant_p(copy_amount)) {
+        return __builtin___memcpy_chk(dst, src, copy_amount, bos);
+    }
+
+    __bionic_fortify_check_access("memcpy", "write into", copy_amount, bos);
+    return __builtin_memcpy(dst, src, copy_amount);
+#else
     return __builtin___memcpy_chk(dst, src, copy_amount, __bos0(dst));
+#endif
 }
 
 __BIONIC_FORTIFY_INLINE
 void* memmove(void* _Nonnull dst, const void* _Nonnull src, size_t len) {
+#if defined(__BIONIC_FORTIFY_INLINE_CHECKS)
+    size_t bos = __bos0(dst);
+
+    if (__builtin_constant_p(len)) {
+        return __builtin___memmove_chk(dst, src, len, bos);
+    }
+
+    __bionic_fortify_check_access("memmove", "write into", len, bos);
+    return __builtin_memmove(dst, src, len);
+#else
     return __builtin___memmove_chk(dst, src, len, __bos0(dst));
+#endif
 }
 #endif /* __ANDROID_API__ >= 17 */
 
@@ -275,7 +308,18 @@ char *strncat(char* _Nonnull __restrict dst, const char* _Nonnull __restrict src
 
 __BIONIC_FORTIFY_INLINE
 void* memset(void* _Nonnull s, int c, size_t n) {
+#if defined(__BIONIC_FORTIFY_INLINE_CHECKS)
+    size_t bos = __bos0(s);
+
+    if (__builtin_constant_p(n)) {
+        return __builtin___memset_chk(s, c, n, bos);
+    }
+
+    __bionic_fortify_check_access("memset", "write into", n, bos);
+    return __builtin_memset(s, c, n);
+#else
     return __builtin___memset_chk(s, c, n, __bos0(s));
+#endif
 }
 
 __BIONIC_FORTIFY_INLINE
@@ -295,7 +339,12 @@ size_t strlcpy(char* _Nonnull __restrict dst, const char* _Nonnull __restrict sr
     }
 #endif /* !defined(__clang__) */
 
+#if defined(__BIONIC_FORTIFY_INLINE_CHECKS)
+    __bionic_fortify_check_access("strlcpy", "write into", size, bos);
+    return __strlcpy_real(dst, src, size);
+#else
     return __strlcpy_chk(dst, src, size, bos);
+#endif
 }
 
 
@@ -316,19 +365,24 @@ size_t strlcat(char* _Nonnull __restrict dst, const char* _Nonnull __restrict sr
     }
 #endif /* !defined(__clang__) */
 
+#if defined(__BIONIC_FORTIFY_INLINE_CHECKS)
+    __bionic_fortify_check_access("strlcat", "write into", size, bos);
+    return __strlcat_real(dst, src, size);
+#else
     return __strlcat_chk(dst, src, size, bos);
+#endif
 }
 
 __BIONIC_FORTIFY_INLINE
 size_t strlen(const char* _Nonnull s) {
     size_t bos = __bos(s);
 
-#if !defined(__clang__)
     // Compiler doesn't know destination size. Don't call __strlen_chk
     if (bos == __BIONIC_FORTIFY_UNKNOWN_SIZE) {
         return __builtin_strlen(s);
     }
 
+#if !defined(__clang__)
     size_t slen = __builtin_strlen(s);
     if (__builtin_constant_p(slen)) {
         return slen;
@@ -344,12 +398,12 @@ __BIONIC_FORTIFY_INLINE
 char* strchr(const char* _Nonnull s, int c) {
     size_t bos = __bos(s);
 
-#if !defined(__clang__)
     // Compiler doesn't know destination size. Don't call __strchr_chk
     if (bos == __BIONIC_FORTIFY_UNKNOWN_SIZE) {
         return __builtin_strchr(s, c);
     }
 
+#if !defined(__clang__)
     size_t slen = __builtin_strlen(s);
     if (__builtin_constant_p(slen) && (slen < bos)) {
         return __builtin_strchr(s, c);
@@ -363,12 +417,12 @@ __BIONIC_FORTIFY_INLINE
 char* strrchr(const char* _Nonnull s, int c) {
     size_t bos = __bos(s);
 
-#if !defined(__clang__)
     // Compiler doesn't know destination size. Don't call __strrchr_chk
     if (bos == __BIONIC_FORTIFY_UNKNOWN_SIZE) {
         return __builtin_strrchr(s, c);
     }
 
+#if !defined(__clang__)
     size_t slen = __builtin_strlen(s);
     if (__builtin_constant_p(slen) && (slen < bos)) {
         return __builtin_strrchr(s, c);
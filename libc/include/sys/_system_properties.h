@@ -41,6 +41,7 @@ typedef struct prop_msg prop_msg;
 #define PROP_AREA_MAGIC   0x504f5250
 #define PROP_AREA_VERSION 0xfc6ed0ab
 #define PROP_AREA_VERSION_COMPAT 0x45434f76
+#define PROP_AREA_VERSION_HASHED 0xfc6ed0ac
 
 #define PROP_SERVICE_NAME "property_service"
 #define PROP_FILENAME_MAX 1024
@@ -51,6 +52,12 @@ typedef struct prop_msg prop_msg;
 #define SERIAL_VALUE_LEN(serial) ((serial) >> 24)
 #define SERIAL_DIRTY(serial) ((serial) & 1)
 
+/* The value length in the serial of a read-only property whose value is
+** too long to store inline (see __system_property_value_ptr).
+*/
+#define PROP_LONG_VALUE_LEN 0xff
+#define PROP_LONG_VALUE_MAX (16 * 1024)
+
 __BEGIN_DECLS
 
 struct prop_msg
@@ -62,6 +69,15 @@ struct prop_msg
 
 #define PROP_MSG_SETPROP 1
 
+/* Any number of PROP_MSG_SETPROP_STREAM messages can be sent one after
+** another on a connection.  The property service answers each, in order,
+** with a uint32_t that is 0 if the property was set, and keeps the
+** connection open until the client closes it.  A property service that
+** doesn't know this command hangs up without answering, and clients then
+** send one PROP_MSG_SETPROP per connection instead.
+*/
+#define PROP_MSG_SETPROP_STREAM 2
+
 /*
 ** Rules:
 **
@@ -130,6 +146,10 @@ unsigned int __system_property_area_serial();
 ** does not already exist and that only one property is added
 ** or updated at a time.
 **
+** The values of read-only ("ro.") properties can be up to
+** PROP_LONG_VALUE_MAX bytes long; others must be shorter than
+** PROP_VALUE_MAX.
+**
 ** Returns 0 on success, -1 if the property area is full.
 */
 int __system_property_add(const char *name, unsigned int namelen,
@@ -139,7 +159,8 @@ int __system_property_add(const char *name, unsigned int namelen,
 ** __system_property_find.  Can only be done by a single process
 ** that has write access to the property area, and that process
 ** must handle sequencing to ensure that only one property is
-** updated at a time.
+** updated at a time.  Properties with long values can't be
+** updated.
 **
 ** Returns 0 on success, -1 if the parameters are incorrect.
 */
@@ -157,6 +178,49 @@ unsigned int __system_property_serial(const prop_info *pi);
 ** successive call. */
 unsigned int __system_property_wait_any(unsigned int serial);
 
+/* A cached copy of one system property's value, for code that checks a
+** property often but expects it to change rarely.  Checking whether the
+** property has changed is a single load of its serial number; the value
+** is only copied again when it has.  If the property doesn't exist yet,
+** the watch follows the global serial number instead and looks for the
+** property again whenever that changes.
+**
+** A prop_watch isn't thread-safe: use one per thread, or lock around it.
+**
+**     static prop_watch watch;
+**     if (!watch.serial_ptr) __system_property_watch_init(&watch, "debug.foo");
+**     if (strcmp(__system_property_watch_get(&watch), "1") == 0) ...
+*/
+typedef struct prop_watch {
+    const char* name;
+    const prop_info* pi;
+    const uint32_t* serial_ptr;
+    uint32_t serial;
+    char value[PROP_VALUE_MAX];
+} prop_watch;
+
+/* Look up the property and take a copy of its value ("" if it doesn't
+** exist).  The name must outlive the watch. */
+void __system_property_watch_init(prop_watch* watch, const char* name) __INTRODUCED_IN_FUTURE;
+
+/* Copy the property's value again if it has changed.  Returns true if
+** the value was copied. */
+bool __system_property_watch_update(prop_watch* watch) __INTRODUCED_IN_FUTURE;
+
+/* Has the property changed since the value was last copied? */
+static __inline bool __system_property_watch_changed(const prop_watch* watch) {
+    return __atomic_load_n(watch->serial_ptr, __ATOMIC_ACQUIRE) != watch->serial;
+}
+
+/* Returns the property's current value, copying it first if it has
+** changed. */
+static __inline const char* __system_property_watch_get(prop_watch* watch) {
+    if (__predict_false(__system_property_watch_changed(watch))) {
+        __system_property_watch_update(watch);
+    }
+    return watch->value;
+}
+
 /*  Compatibility functions to support using an old init with a new libc,
  ** mostly for the OTA updater binary.  These can be deleted once OTAs from
  ** a pre-K release no longer needed to be supported. */
@@ -277,6 +277,40 @@
 
 #include <android/versioning.h>
 
+#if defined(__BIONIC_FORTIFY) && __ANDROID_API__ >= __ANDROID_API_FUTURE__
+/*
+ * The fortified functions whose checks are cheap do them inline, and only call into libc to
+ * report a failure. When the compiler knows the call is safe, which includes when it doesn't know
+ * the buffer's size at all (__bos is then SIZE_MAX), the checks fold away, leaving a plain call.
+ */
+#define __BIONIC_FORTIFY_INLINE_CHECKS 1
+
+__BEGIN_DECLS
+
+/* Formats a message to the log prefixed by "FORTIFY: ", and aborts. */
+void __fortify_fatal(const char* _Nonnull __fmt, ...) __noreturn __printflike(1, 2)
+  __INTRODUCED_IN_FUTURE;
+
+__BIONIC_FORTIFY_INLINE
+void __bionic_fortify_check_count(const char* _Nonnull __fn, const char* _Nonnull __what,
+                                  __SIZE_TYPE__ __value) {
+  if (__builtin_expect(__value > __BIONIC_CAST(static_cast, __SIZE_TYPE__, __PTRDIFF_MAX__), 0)) {
+    __fortify_fatal("%s: %s %zu > SSIZE_MAX", __fn, __what, __value);
+  }
+}
+
+__BIONIC_FORTIFY_INLINE
+void __bionic_fortify_check_access(const char* _Nonnull __fn, const char* _Nonnull __action,
+                                   __SIZE_TYPE__ __claim, __SIZE_TYPE__ __actual) {
+  if (__builtin_expect(__claim > __actual, 0)) {
+    __fortify_fatal("%s: prevented %zu-byte %s %zu-byte buffer", __fn, __claim, __action,
+                    __actual);
+  }
+}
+
+__END_DECLS
+#endif
+
 #if __has_builtin(__builtin_umul_overflow) || __GNUC__ >= 5
 #if defined(__LP64__)
 #define __size_mul_overflow(a, b, result) __builtin_umull_overflow(a, b, result)
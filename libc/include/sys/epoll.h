@@ -79,6 +79,38 @@ int epoll_ctl(int, int, int, struct epoll_event*);
 int epoll_wait(int, struct epoll_event*, int, int);
 int epoll_pwait(int, struct epoll_event*, int, int, const sigset_t*) __INTRODUCED_IN(21);
 
+/*
+ * Like epoll_pwait, but with a timespec timeout, so an event loop's timers aren't rounded to
+ * milliseconds. A null __timeout waits indefinitely. On kernels without the epoll_pwait2
+ * system call (before Linux 5.11) this falls back to epoll_pwait, rounding the timeout up to
+ * the next millisecond so it never returns early.
+ */
+int epoll_pwait2(int __epoll_fd, struct epoll_event* __events, int __event_count,
+                 const struct timespec* __timeout, const sigset_t* __mask) __INTRODUCED_IN_FUTURE;
+
+/*
+ * Android extension: one operation for android_epoll_ctl_batch, with the arguments epoll_ctl
+ * would take. On return, result is 0 if the operation succeeded, or the errno value epoll_ctl
+ * would have set.
+ */
+struct android_epoll_ctl {
+  int op;
+  int fd;
+  struct epoll_event event;
+  int result;
+};
+
+/*
+ * Android extension: performs __count epoll_ctl operations on __epoll_fd, for event loops
+ * that re-arm many EPOLLONESHOT file descriptors at a time. Where the kernel supports it
+ * (Linux 5.6 and later), large batches are submitted through io_uring with one system call;
+ * otherwise this loops over epoll_ctl. Operations can be applied in any order, so a batch
+ * shouldn't have more than one operation on the same file descriptor. Returns the number of
+ * operations that failed.
+ */
+int android_epoll_ctl_batch(int __epoll_fd, struct android_epoll_ctl* __ops, size_t __count)
+  __INTRODUCED_IN_FUTURE;
+
 __END_DECLS
 
 #endif  /* _SYS_EPOLL_H_ */
@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef _SYS_IO_URING_H_
+#define _SYS_IO_URING_H_
+
+#include <sys/cdefs.h>
+#include <sys/types.h>
+#include <signal.h> /* For sigset_t. */
+
+#include <linux/io_uring.h>
+
+__BEGIN_DECLS
+
+int io_uring_setup(unsigned int, struct io_uring_params*) __INTRODUCED_IN_FUTURE;
+int io_uring_enter(int, unsigned int, unsigned int, unsigned int, const sigset_t*)
+  __INTRODUCED_IN_FUTURE;
+int io_uring_register(int, unsigned int, void*, unsigned int) __INTRODUCED_IN_FUTURE;
+
+/*
+ * Android extension: a minimal io_uring helper, for callers that want batched asynchronous
+ * I/O without managing the mmap'ed rings themselves. An android_io_uring isn't thread-safe.
+ *
+ * Get a zeroed submission queue entry with android_io_uring_get_sqe (NULL if the queue is
+ * full), fill it in, and submit everything queued so far with android_io_uring_submit,
+ * optionally waiting for some number of completions. Completions are looked at with
+ * android_io_uring_peek_cqe (NULL if there are none) or android_io_uring_wait_cqe (which
+ * blocks), and handed back with android_io_uring_cqe_seen.
+ */
+typedef struct android_io_uring android_io_uring;
+
+/*
+ * Returns a new ring with room for at least entries submissions, set up with the given
+ * IORING_SETUP_ flags, or NULL and sets errno.
+ */
+android_io_uring* android_io_uring_create(unsigned int entries, unsigned int flags)
+  __INTRODUCED_IN_FUTURE;
+void android_io_uring_destroy(android_io_uring*) __INTRODUCED_IN_FUTURE;
+/* Returns the ring's file descriptor, for io_uring_register. */
+int android_io_uring_fd(android_io_uring*) __INTRODUCED_IN_FUTURE;
+
+struct io_uring_sqe* android_io_uring_get_sqe(android_io_uring*) __INTRODUCED_IN_FUTURE;
+/*
+ * Submits the queued entries, then waits for at least wait_nr completions. Returns the number
+ * of entries submitted, or -1 and sets errno.
+ */
+int android_io_uring_submit(android_io_uring*, unsigned int wait_nr) __INTRODUCED_IN_FUTURE;
+
+struct io_uring_cqe* android_io_uring_peek_cqe(android_io_uring*) __INTRODUCED_IN_FUTURE;
+/* Returns the next completion, waiting for it if necessary, or NULL and sets errno. */
+struct io_uring_cqe* android_io_uring_wait_cqe(android_io_uring*) __INTRODUCED_IN_FUTURE;
+void android_io_uring_cqe_seen(android_io_uring*, struct io_uring_cqe*) __INTRODUCED_IN_FUTURE;
+
+__END_DECLS
+
+#endif
@@ -305,6 +305,26 @@ __socketcall int socketpair(int, int, int, int*);
 ssize_t recv(int, void*, size_t, int);
 ssize_t send(int, const void*, size_t, int);
 
+/*
+ * Android extension: accepts up to __count pending connections on the listening socket
+ * __fd, as accept4 with __flags would, for draining the accept queue in one call when
+ * epoll reports __fd readable. Only the first accept blocks, and only if __fd is in
+ * blocking mode. The new file descriptors are stored in __fds and, if __addrs isn't
+ * null, the peer addresses in __addrs. Returns the number of connections accepted, or
+ * -1 and sets errno if there were none (to EAGAIN if none were pending).
+ */
+int android_accept4_batch(int __fd, int* __fds, struct sockaddr_storage* __addrs, size_t __count,
+                          int __flags) __INTRODUCED_IN_FUTURE;
+
+/*
+ * Android extension: creates __count sockets as socket would, storing them in __fds. When
+ * the process has selected a network, libnetd_client can mark all of them for it in one
+ * round trip to netd instead of one per socket. Returns 0, or -1 and sets errno, in which
+ * case no sockets were created.
+ */
+int android_socket_batch(int __domain, int __type, int __protocol, int* __fds, size_t __count)
+  __INTRODUCED_IN_FUTURE;
+
 __socketcall ssize_t sendto(int, const void*, size_t, int, const struct sockaddr*, socklen_t);
 __socketcall ssize_t recvfrom(int, void*, size_t, int, struct sockaddr*, socklen_t*);
 
@@ -29,6 +29,7 @@
 #define _SYS_SYSINFO_H_
 
 #include <sys/cdefs.h>
+#include <stddef.h>
 #include <linux/kernel.h>
 
 __BEGIN_DECLS
@@ -43,6 +44,49 @@ long get_phys_pages(void) __INTRODUCED_IN(23);
 
 long get_avphys_pages(void) __INTRODUCED_IN(23);
 
+/*
+ * Android extension: the CPU topology, parsed from /sys/devices/system/cpu the first time
+ * android_get_cpu_topology() is called. It describes the configured CPUs, online or not, and
+ * is never updated; use get_nprocs() for the number currently online. Fields the kernel
+ * doesn't report are -1 (or 0 for the sizes and frequency).
+ */
+#define ANDROID_CPU_CACHE_DATA 1
+#define ANDROID_CPU_CACHE_INSTRUCTION 2
+#define ANDROID_CPU_CACHE_UNIFIED 3
+
+#define ANDROID_CPU_MAX_CACHES 8
+
+struct android_cpu_cache {
+  int level;
+  /* One of the ANDROID_CPU_CACHE_ constants. */
+  int type;
+  size_t size;
+  int line_size;
+  int ways;
+};
+
+struct android_cpu_info {
+  /* The N in /sys/devices/system/cpu/cpuN. */
+  int cpu;
+  int core_id;
+  /* CPUs in the same cluster (the big or the LITTLE cores, say) have the same cluster_id. */
+  int cluster_id;
+  unsigned long max_freq_khz;
+  int cache_count;
+  struct android_cpu_cache caches[ANDROID_CPU_MAX_CACHES];
+};
+
+struct android_cpu_topology {
+  /* The number of entries in cpus, which are sorted by cpu. */
+  int cpu_count;
+  /* The number of distinct cluster_ids. */
+  int cluster_count;
+  const struct android_cpu_info* cpus;
+};
+
+/* Returns NULL if /sys/devices/system/cpu can't be read. */
+const struct android_cpu_topology* android_get_cpu_topology(void) __INTRODUCED_IN_FUTURE;
+
 __END_DECLS
 
 #endif /* _SYS_SYSINFO_H_ */
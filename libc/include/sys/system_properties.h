@@ -30,6 +30,9 @@
 #define _INCLUDE_SYS_SYSTEM_PROPERTIES_H
 
 #include <sys/cdefs.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 
 __BEGIN_DECLS
 
@@ -46,10 +49,48 @@ typedef struct prop_info prop_info;
 */
 int __system_property_get(const char *name, char *value);
 
+/* Look up count system properties at once, as if by calling
+** __system_property_get(names[i], values[i]) for each, where each
+** values[i] has room for PROP_VALUE_MAX bytes.  This is cheaper than
+** separate calls when there are many names: they are looked up in sorted
+** order, so the leading components they share are only looked up once.
+**
+** Returns the number of the properties that exist.
+*/
+int __system_property_get_batch(const char* const* names, char* const* values, size_t count)
+  __INTRODUCED_IN_FUTURE;
+
 /* Set a system property by name.
 **/
 int __system_property_set(const char* key, const char* value) __INTRODUCED_IN(12);
 
+/* Set count system properties, as if by calling
+** __system_property_set(keys[i], values[i]) for each in turn, but over one
+** connection to the property service that is kept open for later calls.
+** Nothing is set if any key or value is too long.
+**
+** Returns 0 if all were set, -1 otherwise.
+*/
+int __system_property_set_batch(const char* const* keys, const char* const* values, size_t count)
+  __INTRODUCED_IN_FUTURE;
+
+/* Like __system_property_set(), but over the same connection as
+** __system_property_set_batch(), and without waiting for the property
+** service to finish.  Asynchronous sets are applied in order, but a later
+** __system_property_set() may overtake them: call
+** __system_property_set_flush() first if that matters.
+**
+** Returns 0 if the set was sent, -1 if the key or value is too long or
+** the set failed.
+*/
+int __system_property_set_async(const char* key, const char* value) __INTRODUCED_IN_FUTURE;
+
+/* Wait for the property service to finish the asynchronous sets made so
+** far.  Returns 0 if they all succeeded, -1 if any failed since the last
+** call.
+*/
+int __system_property_set_flush(void) __INTRODUCED_IN_FUTURE;
+
 /* Return a pointer to the system property named name, if it
 ** exists, or NULL if there is no such property.  Use 
 ** __system_property_read() to obtain the string value from
@@ -72,6 +113,17 @@ const prop_info *__system_property_find(const char *name);
 */
 int __system_property_read(const prop_info *pi, char *name, char *value);
 
+/* Return a pointer to the value of a read-only ("ro.") system property,
+** without copying it, and store its length in *len.  Read-only values
+** can be longer than PROP_VALUE_MAX; __system_property_read() and
+** __system_property_get() only copy the first PROP_VALUE_MAX - 1 bytes
+** of those.  The value is \0 terminated and stays valid for the
+** lifetime of the process.
+**
+** Returns NULL if pi isn't a read-only property.
+*/
+const char* __system_property_value_ptr(const prop_info* pi, size_t* len) __INTRODUCED_IN_FUTURE;
+
 /* Return a prop_info for the nth system property, or NULL if 
 ** there is no nth property.  Use __system_property_read() to
 ** read the value of this property.
@@ -92,10 +144,29 @@ const prop_info *__system_property_find_nth(unsigned n);
 **
 ** Order of results may change from call to call.  This is
 ** not a bug.
+**
+** In a process started with LIBC_PROPERTY_UNMAP_COLD=1 in its
+** environment, property areas that no lookup has used are unmapped
+** again afterwards, so the prop_info pointers are only valid during the
+** callback.
 */
 int __system_property_foreach(void (*propfn)(const prop_info* pi, void* cookie), void* cookie)
   __INTRODUCED_IN(19);
 
+/* Wait for the system property pi to be updated past old_serial, which
+** should come from __system_property_serial().  Unlike
+** __system_property_wait_any(), updates to other properties do not wake
+** the caller.  If pi is NULL, waits for the global serial number
+** instead, as __system_property_wait_any() does.
+**
+** Waits no longer than relative_timeout, or forever if it is NULL.
+** Returns true and stores the new serial number in *new_serial_ptr, or
+** returns false if the wait timed out.
+*/
+struct timespec;
+bool __system_property_wait(const prop_info* pi, uint32_t old_serial, uint32_t* new_serial_ptr,
+                            const struct timespec* relative_timeout) __INTRODUCED_IN_FUTURE;
+
 __END_DECLS
 
 #endif
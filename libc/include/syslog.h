@@ -30,6 +30,7 @@
 #define _SYSLOG_H
 
 #include <stdio.h>
+#include <stdint.h>
 #include <sys/cdefs.h>
 #include <stdarg.h>
 
@@ -91,6 +92,43 @@ int setlogmask(int);
 void syslog(int, const char* _Nonnull, ...) __printflike(2, 3);
 void vsyslog(int, const char* _Nonnull, va_list) __printflike(2, 0);
 
+/*
+ * Android extension: flags for android_syslog_set_async. By default a message that finds the
+ * queue full is dropped, so that syslog never waits. ANDROID_SYSLOG_ASYNC_WRITE_WHEN_FULL
+ * writes it directly instead, as syslog does without a queue. ANDROID_SYSLOG_ASYNC_REPORT_DROPS
+ * has the background thread log how many messages were dropped once it catches up.
+ */
+#define ANDROID_SYSLOG_ASYNC_WRITE_WHEN_FULL 0x1
+#define ANDROID_SYSLOG_ASYNC_REPORT_DROPS 0x2
+
+/*
+ * Android extension: makes syslog and vsyslog format each message into a queue of at least
+ * __queue_length entries, which a background thread writes to the log, so that the caller
+ * doesn't wait for the write. This can be done once per process; a forked child goes back to
+ * writing messages directly until it calls this itself. Returns 0, or -1 and sets errno
+ * (EBUSY if the queue is already running).
+ *
+ * Messages still queued when the process exits are lost, unless android_syslog_flush is called
+ * first.
+ */
+int android_syslog_set_async(size_t __queue_length, int __flags) __INTRODUCED_IN_FUTURE;
+
+/* Android extension: waits until every message queued before the call has been written. */
+void android_syslog_flush(void) __INTRODUCED_IN_FUTURE;
+
+struct android_syslog_async_stats {
+  /* Messages the background thread has written. */
+  uint64_t written;
+  /* Messages dropped because the queue was full. */
+  uint64_t dropped;
+  /* Messages written directly because the queue was full. */
+  uint64_t written_directly;
+};
+
+/* Android extension: gets the queue's counts, which are all zero if there is no queue. */
+void android_syslog_get_async_stats(struct android_syslog_async_stats* _Nonnull __stats)
+  __INTRODUCED_IN_FUTURE;
+
 __END_DECLS
 
 #endif /* _SYSLOG_H */
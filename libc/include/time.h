@@ -92,12 +92,30 @@ int clock_gettime(clockid_t, struct timespec*);
 int clock_nanosleep(clockid_t, int, const struct timespec*, struct timespec*);
 int clock_settime(clockid_t, const struct timespec*);
 
+/*
+ * Opts the calling thread in to a clock_gettime(CLOCK_THREAD_CPUTIME_ID) that works out the
+ * thread's CPU time from a perf event rather than making a system call. It uses one of the CPU's
+ * performance counters for as long as the thread lives. Returns 0, or -1 and sets errno if the
+ * kernel or CPU doesn't allow it, in which case clock_gettime carries on as before.
+ */
+int android_thread_cputime_enable_fast_path(void) __INTRODUCED_IN_FUTURE;
+
 int timer_create(int, struct sigevent*, timer_t*);
 int timer_delete(timer_t);
 int timer_settime(timer_t, int, const struct itimerspec*, struct itimerspec*);
 int timer_gettime(timer_t, struct itimerspec*);
 int timer_getoverrun(timer_t);
 
+/*
+ * Like timer_create, except that a SIGEV_THREAD timer's callbacks are run by the process-wide
+ * work pool (see <android/work_pool.h>), after a single thread shared by all such timers
+ * receives their signals. Use this for large numbers of timers whose callbacks are short and
+ * don't block. A timer's callbacks never overlap: expirations while one is pending or running
+ * are folded into the next, and timer_getoverrun reports how many were. Fails with EINVAL if
+ * sigev_notify_attributes is set. Other kinds of timer are passed on to timer_create.
+ */
+int android_timer_create_shared(clockid_t, struct sigevent*, timer_t*) __INTRODUCED_IN_FUTURE;
+
 /* Non-standard extensions that are in the BSDs and glibc. */
 time_t timelocal(struct tm*) __INTRODUCED_IN(12);
 time_t timegm(struct tm*) __INTRODUCED_IN(12);
@@ -282,6 +282,21 @@ ssize_t __readlinkat_real(int dirfd, const char*, char*, size_t) __RENAME(readli
 int getdomainname(char*, size_t) __INTRODUCED_IN_FUTURE;
 int setdomainname(const char*, size_t) __INTRODUCED_IN_FUTURE;
 
+#if defined(__USE_GNU)
+ssize_t copy_file_range(int __fd_in, off64_t* __off_in, int __fd_out, off64_t* __off_out,
+                        size_t __length, unsigned int __flags) __INTRODUCED_IN_FUTURE;
+#endif
+
+/*
+ * Android extension: copies up to count bytes from __fd_in's file offset to __fd_out's,
+ * advancing both, with the cheapest mechanism the pair of file descriptors supports:
+ * copy_file_range, then sendfile, then splice (directly if either is a pipe, or through
+ * one), and finally read and write. Returns the number of bytes copied, which is less
+ * than count only at the end of the input, or -1 and sets errno, in which case some of
+ * the data may already have been copied.
+ */
+ssize_t android_copy_fd(int __fd_in, int __fd_out, size_t __count) __INTRODUCED_IN_FUTURE;
+
 #if defined(__BIONIC_FORTIFY)
 
 #if __ANDROID_API__ >= 24
@@ -346,7 +361,13 @@ ssize_t pread(int fd, void* buf, size_t count, off_t offset) {
     }
 #endif
 
+#if defined(__BIONIC_FORTIFY_INLINE_CHECKS)
+    __bionic_fortify_check_count("pread", "count", count);
+    __bionic_fortify_check_access("pread", "write into", count, bos);
+    return __PREAD_PREFIX(real)(fd, buf, count, offset);
+#else
     return __PREAD_PREFIX(chk)(fd, buf, count, offset, bos);
+#endif
 }
 
 __BIONIC_FORTIFY_INLINE
@@ -371,7 +392,13 @@ ssize_t pread64(int fd, void* buf, size_t count, off64_t offset) {
     }
 #endif
 
+#if defined(__BIONIC_FORTIFY_INLINE_CHECKS)
+    __bionic_fortify_check_count("pread64", "count", count);
+    __bionic_fortify_check_access("pread64", "write into", count, bos);
+    return __pread64_real(fd, buf, count, offset);
+#else
     return __pread64_chk(fd, buf, count, offset, bos);
+#endif
 }
 #endif /* __ANDROID_API__ >= 23 */
 
@@ -404,7 +431,13 @@ ssize_t pwrite(int fd, const void* buf, size_t count, off_t offset) {
     }
 #endif
 
+#if defined(__BIONIC_FORTIFY_INLINE_CHECKS)
+    __bionic_fortify_check_count("pwrite", "count", count);
+    __bionic_fortify_check_access("pwrite", "read from", count, bos);
+    return __PWRITE_PREFIX(real)(fd, buf, count, offset);
+#else
     return __PWRITE_PREFIX(chk)(fd, buf, count, offset, bos);
+#endif
 }
 
 __BIONIC_FORTIFY_INLINE
@@ -429,7 +462,13 @@ ssize_t pwrite64(int fd, const void* buf, size_t count, off64_t offset) {
     }
 #endif
 
+#if defined(__BIONIC_FORTIFY_INLINE_CHECKS)
+    __bionic_fortify_check_count("pwrite64", "count", count);
+    __bionic_fortify_check_access("pwrite64", "read from", count, bos);
+    return __pwrite64_real(fd, buf, count, offset);
+#else
     return __pwrite64_chk(fd, buf, count, offset, bos);
+#endif
 }
 #endif /* __ANDROID_API__ >= 24 */
 
@@ -456,7 +495,13 @@ ssize_t read(int fd, void* buf, size_t count) {
     }
 #endif
 
+#if defined(__BIONIC_FORTIFY_INLINE_CHECKS)
+    __bionic_fortify_check_count("read", "count", count);
+    __bionic_fortify_check_access("read", "write into", count, bos);
+    return __read_real(fd, buf, count);
+#else
     return __read_chk(fd, buf, count, bos);
+#endif
 }
 #endif /* __ANDROID_API__ >= 21 */
 
@@ -485,7 +530,13 @@ ssize_t write(int fd, const void* buf, size_t count) {
     }
 #endif
 
+#if defined(__BIONIC_FORTIFY_INLINE_CHECKS)
+    __bionic_fortify_check_count("write", "count", count);
+    __bionic_fortify_check_access("write", "read from", count, bos);
+    return __write_real(fd, buf, count);
+#else
     return __write_chk(fd, buf, count, bos);
+#endif
 }
 #endif /* __ANDROID_API__ >= 24 */
 
@@ -512,7 +563,13 @@ ssize_t readlink(const char* path, char* buf, size_t size) {
     }
 #endif
 
+#if defined(__BIONIC_FORTIFY_INLINE_CHECKS)
+    __bionic_fortify_check_count("readlink", "size", size);
+    __bionic_fortify_check_access("readlink", "write into", size, bos);
+    return __readlink_real(path, buf, size);
+#else
     return __readlink_chk(path, buf, size, bos);
+#endif
 }
 
 __BIONIC_FORTIFY_INLINE
@@ -537,7 +594,13 @@ ssize_t readlinkat(int dirfd, const char* path, char* buf, size_t size) {
     }
 #endif
 
+#if defined(__BIONIC_FORTIFY_INLINE_CHECKS)
+    __bionic_fortify_check_count("readlinkat", "size", size);
+    __bionic_fortify_check_access("readlinkat", "write into", size, bos);
+    return __readlinkat_real(dirfd, path, buf, size);
+#else
     return __readlinkat_chk(dirfd, path, buf, size, bos);
+#endif
 }
 #endif /* __ANDROID_API__ >= 23 */
 
@@ -271,6 +271,7 @@ struct fscrypt_policy {
 #define SYNC_FILE_RANGE_WRITE 2
 #define SYNC_FILE_RANGE_WAIT_AFTER 4
 /* WARNING: DO NOT EDIT, AUTO-GENERATED CODE - SEE TOP FOR INSTRUCTIONS */
+typedef int __kernel_rwf_t;
 #define RWF_HIPRI 0x00000001
 #define RWF_DSYNC 0x00000002
 #define RWF_SYNC 0x00000004
@@ -27,9 +27,11 @@
  */
 
 #include <errno.h>
+#include <math.h>
 #include <signal.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 #include <sys/types.h>
 #include <unistd.h>
 
@@ -49,15 +51,26 @@ static void EnableToggle(int, siginfo_t*, void*) {
   }
 }
 
-BacktraceData::BacktraceData(DebugData* debug_data, const Config& config, size_t* offset)
+BacktraceData::BacktraceData(DebugData* debug_data, const Config&)
     : OptionData(debug_data) {
-  size_t hdr_len = sizeof(BacktraceHeader) + sizeof(uintptr_t) * config.backtrace_frames;
-  alloc_offset_ = *offset;
-  *offset += BIONIC_ALIGN(hdr_len, MINIMUM_ALIGNMENT_BYTES);
+}
+
+BacktraceData::~BacktraceData() {
+  if (sample_bytes_ != 0) {
+    pthread_key_delete(sample_key_);
+  }
 }
 
 bool BacktraceData::Initialize(const Config& config) {
   enabled_ = config.backtrace_enabled;
+  if (config.backtrace_sampling) {
+    int ret = pthread_key_create(&sample_key_, nullptr);
+    if (ret != 0) {
+      error_log("Unable to create backtrace sample key: %s", strerror(ret));
+      return false;
+    }
+    sample_bytes_ = config.backtrace_sample_bytes;
+  }
   if (config.backtrace_enable_on_signal) {
     struct sigaction enable_act;
     memset(&enable_act, 0, sizeof(enable_act));
@@ -74,3 +87,208 @@ bool BacktraceData::Initialize(const Config& config) {
   }
   return true;
 }
+
+// Draws the distance to the next sample from an exponential distribution
+// with a mean of sample_bytes_, so that every allocated byte has the same
+// chance of triggering a sample no matter how the allocations are sized.
+size_t BacktraceData::NextSampleDistance() {
+  // A uniform value in (0, 1].
+  double u = (static_cast<double>(arc4random()) + 1.0) / 4294967296.0;
+  double distance = -log(u) * sample_bytes_;
+  if (distance < 1.0) {
+    return 1;
+  }
+  if (distance > static_cast<double>(SIZE_MAX / 2)) {
+    return SIZE_MAX / 2;
+  }
+  return static_cast<size_t>(distance);
+}
+
+bool BacktraceData::ShouldSample(size_t size) {
+  if (sample_bytes_ == 0) {
+    return true;
+  }
+
+  size_t remaining = reinterpret_cast<uintptr_t>(pthread_getspecific(sample_key_));
+  if (remaining == 0) {
+    remaining = NextSampleDistance();
+  }
+  bool sample = size >= remaining;
+  if (sample) {
+    remaining = NextSampleDistance();
+  } else {
+    remaining -= size;
+  }
+  pthread_setspecific(sample_key_, reinterpret_cast<void*>(remaining));
+  return sample;
+}
+
+size_t BacktraceData::ScaledSize(size_t size) {
+  if (sample_bytes_ == 0 || size == 0) {
+    return size;
+  }
+
+  // An allocation of size bytes is sampled with probability
+  // 1 - exp(-size / sample_bytes_), so weigh it by the inverse.
+  double probability = -expm1(-static_cast<double>(size) / sample_bytes_);
+  double scaled = size / probability;
+  if (scaled > static_cast<double>(SIZE_MAX)) {
+    return SIZE_MAX;
+  }
+  return static_cast<size_t>(scaled);
+}
+
+static size_t HashFrames(const uintptr_t* frames, size_t num_frames) {
+  size_t hash = num_frames;
+  for (size_t i = 0; i < num_frames; i++) {
+    hash = hash * 31 + frames[i];
+  }
+  // Mix the bits so that the low ones, which select the shard, depend on
+  // every frame.
+  return static_cast<size_t>((static_cast<uint64_t>(hash) * 0x9e3779b97f4a7c15ULL) >> 32);
+}
+
+uint32_t BacktraceData::Add(const uintptr_t* frames, size_t num_frames) {
+  if (num_frames == 0) {
+    return 0;
+  }
+
+  size_t hash = HashFrames(frames, num_frames);
+  size_t shard_index = hash & (kShards - 1);
+  Shard& shard = shards_[shard_index];
+
+  Activate(shard);
+  pthread_mutex_lock(&shard.mutex);
+  uint32_t index;
+  auto range = shard.index.equal_range(hash);
+  auto it = range.first;
+  for (; it != range.second; ++it) {
+    Entry& entry = shard.entries[it->second];
+    if (entry.frames.size() == num_frames &&
+        memcmp(entry.frames.data(), frames, num_frames * sizeof(uintptr_t)) == 0) {
+      break;
+    }
+  }
+
+  if (it != range.second) {
+    index = it->second;
+    shard.entries[index].ref_count++;
+  } else {
+    if (!shard.free_entries.empty()) {
+      index = shard.free_entries.back();
+      shard.free_entries.pop_back();
+    } else {
+      index = shard.entries.size();
+      shard.entries.emplace_back();
+    }
+    Entry& entry = shard.entries[index];
+    entry.hash = hash;
+    entry.ref_count = 1;
+    entry.frames.assign(frames, frames + num_frames);
+    shard.index.emplace(hash, index);
+  }
+  pthread_mutex_unlock(&shard.mutex);
+
+  return static_cast<uint32_t>(((index + 1) << kShardBits) | shard_index);
+}
+
+BacktraceData::Entry* BacktraceData::GetEntry(uint32_t id) {
+  return &shards_[id & (kShards - 1)].entries[(id >> kShardBits) - 1];
+}
+
+void BacktraceData::Remove(uint32_t id) {
+  if (id == 0) {
+    return;
+  }
+
+  Shard& shard = shards_[id & (kShards - 1)];
+  uint32_t index = (id >> kShardBits) - 1;
+
+  pthread_mutex_lock(&shard.mutex);
+  Entry& entry = shard.entries[index];
+  if (--entry.ref_count == 0) {
+    auto range = shard.index.equal_range(entry.hash);
+    for (auto it = range.first; it != range.second; ++it) {
+      if (it->second == index) {
+        shard.index.erase(it);
+        break;
+      }
+    }
+    std::vector<uintptr_t>().swap(entry.frames);
+    shard.free_entries.push_back(index);
+  }
+  pthread_mutex_unlock(&shard.mutex);
+}
+
+size_t BacktraceData::GetFrames(uint32_t id, uintptr_t* frames, size_t max_frames) {
+  if (id == 0) {
+    return 0;
+  }
+
+  Shard& shard = shards_[id & (kShards - 1)];
+  pthread_mutex_lock(&shard.mutex);
+  const Entry* entry = GetEntry(id);
+  size_t num_frames = entry->frames.size();
+  if (num_frames > max_frames) {
+    num_frames = max_frames;
+  }
+  memcpy(frames, entry->frames.data(), num_frames * sizeof(uintptr_t));
+  pthread_mutex_unlock(&shard.mutex);
+  return num_frames;
+}
+
+size_t BacktraceData::GetFramesLocked(uint32_t id, const uintptr_t** frames) {
+  if (id == 0) {
+    *frames = nullptr;
+    return 0;
+  }
+
+  const Entry* entry = GetEntry(id);
+  *frames = entry->frames.data();
+  return entry->frames.size();
+}
+
+void BacktraceData::LockAll() {
+  for (size_t i = 0; i < kShards; i++) {
+    pthread_mutex_lock(&shards_[i].mutex);
+  }
+}
+
+void BacktraceData::UnlockAll() {
+  for (size_t i = kShards; i > 0; i--) {
+    pthread_mutex_unlock(&shards_[i - 1].mutex);
+  }
+}
+
+void BacktraceData::Activate(Shard& shard) {
+  if (!shard.active.load(std::memory_order_acquire)) {
+    pthread_mutex_lock(&activate_mutex_);
+    shard.active.store(true, std::memory_order_release);
+    pthread_mutex_unlock(&activate_mutex_);
+  }
+}
+
+void BacktraceData::PrepareFork() {
+  pthread_mutex_lock(&activate_mutex_);
+  for (size_t i = 0; i < kShards; i++) {
+    if (shards_[i].active.load(std::memory_order_acquire)) {
+      pthread_mutex_lock(&shards_[i].mutex);
+    }
+  }
+}
+
+void BacktraceData::PostForkParent() {
+  for (size_t i = kShards; i > 0; i--) {
+    if (shards_[i - 1].active.load(std::memory_order_relaxed)) {
+      pthread_mutex_unlock(&shards_[i - 1].mutex);
+    }
+  }
+  pthread_mutex_unlock(&activate_mutex_);
+}
+
+void BacktraceData::PostForkChild() {
+  for (size_t i = 0; i < kShards; i++) {
+    pthread_mutex_init(&shards_[i].mutex, NULL);
+  }
+  pthread_mutex_init(&activate_mutex_, NULL);
+}
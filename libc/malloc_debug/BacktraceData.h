@@ -29,8 +29,13 @@
 #ifndef DEBUG_MALLOC_BACKTRACEDATA_H
 #define DEBUG_MALLOC_BACKTRACEDATA_H
 
+#include <pthread.h>
 #include <stdint.h>
 
+#include <atomic>
+#include <unordered_map>
+#include <vector>
+
 #include <private/bionic_macros.h>
 
 #include "OptionData.h"
@@ -40,21 +45,86 @@ struct Config;
 
 class BacktraceData : public OptionData {
  public:
-  BacktraceData(DebugData* debug_data, const Config& config, size_t* offset);
-  virtual ~BacktraceData() = default;
+  BacktraceData(DebugData* debug_data, const Config& config);
+  virtual ~BacktraceData();
 
   bool Initialize(const Config& config);
 
-  inline size_t alloc_offset() { return alloc_offset_; }
-
   bool enabled() { return enabled_; }
   void set_enabled(bool enabled) { enabled_ = enabled; }
 
+  // When backtrace_sample_bytes is set, returns true for roughly one
+  // allocation every that many bytes, counted per thread. Otherwise
+  // always returns true.
+  bool ShouldSample(size_t size);
+
+  // Returns the number of bytes that a sampled allocation of size bytes
+  // stands for.
+  size_t ScaledSize(size_t size);
+
+  bool sampling() { return sample_bytes_ != 0; }
+
+  // Allocation backtraces are interned: allocations with identical
+  // backtraces share one reference counted copy, identified by a
+  // non-zero 32 bit id. Returns 0 if num_frames is 0.
+  uint32_t Add(const uintptr_t* frames, size_t num_frames);
+
+  // Drops the reference taken by Add().
+  void Remove(uint32_t id);
+
+  // Copies up to max_frames frames of the backtrace and returns how
+  // many were copied.
+  size_t GetFrames(uint32_t id, uintptr_t* frames, size_t max_frames);
+
+  // Like GetFrames(), but points *frames at the interned copy. The
+  // caller must hold LockAll() for as long as it uses it.
+  size_t GetFramesLocked(uint32_t id, const uintptr_t** frames);
+
+  void LockAll();
+  void UnlockAll();
+
+  void PrepareFork();
+  void PostForkParent();
+  void PostForkChild();
+
  private:
-  size_t alloc_offset_ = 0;
+  // The table is sharded like TrackData; the low bits of an id select
+  // the shard and the rest is the index of the entry in it plus one.
+  static constexpr size_t kShardBits = 6;
+  static constexpr size_t kShards = 1 << kShardBits;
+
+  struct Entry {
+    size_t hash;
+    size_t ref_count;
+    std::vector<uintptr_t> frames;
+  };
+
+  struct Shard {
+    pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+    // As in TrackData, only shards that have been added to are locked
+    // across fork.
+    std::atomic<bool> active{false};
+    // Backtrace hash -> index in entries.
+    std::unordered_multimap<size_t, uint32_t> index;
+    std::vector<Entry> entries;
+    std::vector<uint32_t> free_entries;
+  };
+
+  Entry* GetEntry(uint32_t id);
+  void Activate(Shard& shard);
+
+  size_t NextSampleDistance();
+
+  Shard shards_[kShards];
+  pthread_mutex_t activate_mutex_ = PTHREAD_MUTEX_INITIALIZER;
 
   volatile bool enabled_ = false;
 
+  size_t sample_bytes_ = 0;
+  // Per thread number of bytes left before the next sample. A value of
+  // zero means the thread has not drawn a distance yet.
+  pthread_key_t sample_key_;
+
   DISALLOW_COPY_AND_ASSIGN(BacktraceData);
 };
 
@@ -58,11 +58,18 @@ static constexpr size_t MAX_GUARD_BYTES = 16384;
 static constexpr size_t DEFAULT_BACKTRACE_FRAMES = 16;
 static constexpr size_t MAX_BACKTRACE_FRAMES = 256;
 
+static constexpr size_t DEFAULT_BACKTRACE_SAMPLE_BYTES = 512 * 1024;
+static constexpr size_t MAX_BACKTRACE_SAMPLE_BYTES = 1024 * 1024 * 1024;
+
 static constexpr size_t DEFAULT_EXPAND_BYTES = 16;
 static constexpr size_t MAX_EXPAND_BYTES = 16384;
 
 static constexpr size_t DEFAULT_FREE_TRACK_ALLOCATIONS = 100;
 static constexpr size_t MAX_FREE_TRACK_ALLOCATIONS = 16384;
+static constexpr size_t DEFAULT_FREE_TRACK_VERIFY_SAMPLE = 16;
+static constexpr size_t MAX_FREE_TRACK_VERIFY_SAMPLE = 65536;
+static constexpr size_t DEFAULT_FREE_TRACK_BYTES = 64 * 1024 * 1024;
+static constexpr size_t MAX_FREE_TRACK_BYTES = 1024 * 1024 * 1024;
 
 static constexpr size_t DEFAULT_RECORD_ALLOCS = 8000000;
 static constexpr size_t MAX_RECORD_ALLOCS = 50000000;
@@ -267,6 +274,19 @@ void PropertyParser::LogUsage() {
   error_log("    frames. The default is %zu frames, the max number of frames is %zu.",
             DEFAULT_BACKTRACE_FRAMES, MAX_BACKTRACE_FRAMES);
   error_log("");
+  error_log("  backtrace_sample_bytes[=XX]");
+  error_log("    This option only has meaning if backtrace or backtrace_enable_on_signal");
+  error_log("    is set. Instead of capturing a backtrace for every allocation, capture");
+  error_log("    one on average every XX allocated bytes. Leak reports scale the sampled");
+  error_log("    allocations to estimate the total. The default is %zu bytes, the max",
+            DEFAULT_BACKTRACE_SAMPLE_BYTES);
+  error_log("    bytes is %zu.", MAX_BACKTRACE_SAMPLE_BYTES);
+  error_log("");
+  error_log("  backtrace_frame_pointers");
+  error_log("    Walk the chain of frame pointers to capture backtraces instead of");
+  error_log("    unwinding. Much faster, but only complete if the code on the stack");
+  error_log("    was built with frame pointers. Only supported on arm64, x86 and x86_64.");
+  error_log("");
   error_log("  fill_on_alloc[=XX]");
   error_log("    On first allocation, fill with the value 0x%02x.", DEFAULT_FILL_ALLOC_VALUE);
   error_log("    If XX is set it will only fill up to XX bytes of the");
@@ -310,6 +330,27 @@ void PropertyParser::LogUsage() {
   error_log("    The default is to record %zu frames, the max number of frames is %zu.",
             DEFAULT_BACKTRACE_FRAMES, MAX_BACKTRACE_FRAMES);
   error_log("");
+  error_log("  free_track_verify_sample[=XX]");
+  error_log("    This option only has meaning if free_track is set. Only one in XX");
+  error_log("    of the allocations leaving the list is verified, so that free");
+  error_log("    stays cheap with a large list. Everything left on the list is");
+  error_log("    still verified when the program terminates. The default is %zu,",
+            DEFAULT_FREE_TRACK_VERIFY_SAMPLE);
+  error_log("    the max is %zu.", MAX_FREE_TRACK_VERIFY_SAMPLE);
+  error_log("");
+  error_log("  free_track_bytes[=XX]");
+  error_log("    This option only has meaning if free_track is set. Keep freed");
+  error_log("    allocations on one of four lists by size, and limit the memory");
+  error_log("    held by all of the lists to XX bytes. Each list still keeps at");
+  error_log("    most the number of allocations set by free_track. The default");
+  error_log("    is %zu bytes, the max bytes is %zu.", DEFAULT_FREE_TRACK_BYTES,
+            MAX_FREE_TRACK_BYTES);
+  error_log("");
+  error_log("  free_track_async");
+  error_log("    This option only has meaning if free_track is set. Allocations");
+  error_log("    that leave the list are verified and freed in batches by a low");
+  error_log("    priority thread, instead of by the thread calling free.");
+  error_log("");
   error_log("  leak_track");
   error_log("    Enable the leak tracking of memory allocations.");
   error_log("");
@@ -325,6 +366,10 @@ void PropertyParser::LogUsage() {
   error_log("    This option only has meaning if the record_allocs options has been specified.");
   error_log("    This is the name of the file to which recording information will be dumped.");
   error_log("    The default is %s.", DEFAULT_RECORD_ALLOCS_FILE);
+  error_log("");
+  error_log("  record_allocs_binary");
+  error_log("    This option only has meaning if the record_allocs options has been specified.");
+  error_log("    The records are written in a compact binary format instead of as text.");
 }
 
 // This function is designed to be called once. A second call will not
@@ -344,7 +389,13 @@ bool Config::SetFromProperties() {
   backtrace_signal = SIGRTMAX - 19;
   record_allocs_signal = SIGRTMAX - 18;
   free_track_backtrace_num_frames = 0;
+  free_track_verify_sampling = false;
+  free_track_byte_limit = false;
+  free_track_async = false;
+  backtrace_sampling = false;
+  backtrace_frame_pointers = false;
   record_allocs_file.clear();
+  record_allocs_binary = false;
 
   // Parse the options are of the format:
   //   option_name or option_name=XX
@@ -370,6 +421,14 @@ bool Config::SetFromProperties() {
   const OptionSizeT option_backtrace_enable_on_signal(
       "backtrace_enable_on_signal", DEFAULT_BACKTRACE_FRAMES, 1, MAX_BACKTRACE_FRAMES,
       BACKTRACE | TRACK_ALLOCS, &this->backtrace_frames, false, &this->backtrace_enable_on_signal);
+  // Only capture a backtrace for a sample of the allocations. Value is the
+  // average number of bytes allocated between two samples.
+  const OptionSizeT option_backtrace_sample_bytes(
+      "backtrace_sample_bytes", DEFAULT_BACKTRACE_SAMPLE_BYTES, 1, MAX_BACKTRACE_SAMPLE_BYTES, 0,
+      &this->backtrace_sample_bytes, false, &this->backtrace_sampling);
+  // Capture backtraces by following frame pointers rather than unwinding.
+  const Option option_backtrace_frame_pointers(
+      "backtrace_frame_pointers", 0, false, &this->backtrace_frame_pointers);
 
   const OptionSizeT option_fill("fill", SIZE_MAX, 1, SIZE_MAX, 0, nullptr, true);
   // Fill the allocation with an arbitrary pattern on allocation.
@@ -400,6 +459,18 @@ bool Config::SetFromProperties() {
   const OptionSizeT option_free_track_backtrace_num_frames(
       "free_track_backtrace_num_frames", DEFAULT_BACKTRACE_FRAMES, 0, MAX_BACKTRACE_FRAMES, 0,
       &this->free_track_backtrace_num_frames);
+  // Only verify a sample of the allocations that leave the free track list. Value is how many
+  // allocations leave the list for each one that's verified.
+  const OptionSizeT option_free_track_verify_sample(
+      "free_track_verify_sample", DEFAULT_FREE_TRACK_VERIFY_SAMPLE, 1,
+      MAX_FREE_TRACK_VERIFY_SAMPLE, 0, &this->free_track_verify_sample, false,
+      &this->free_track_verify_sampling);
+  // Split the free track list by allocation size and limit the total number of bytes it holds.
+  const OptionSizeT option_free_track_bytes(
+      "free_track_bytes", DEFAULT_FREE_TRACK_BYTES, 1, MAX_FREE_TRACK_BYTES, 0,
+      &this->free_track_bytes, false, &this->free_track_byte_limit);
+  // Verify and free allocations leaving the free track list on a background thread.
+  const Option option_free_track_async("free_track_async", 0, false, &this->free_track_async);
 
   // Enable printing leaked allocations.
   const Option option_leak_track("leak_track", LEAK_TRACK | TRACK_ALLOCS);
@@ -409,15 +480,20 @@ bool Config::SetFromProperties() {
       &this->record_allocs_num_entries);
   const OptionString option_record_allocs_file(
       "record_allocs_file", 0, DEFAULT_RECORD_ALLOCS_FILE, &this->record_allocs_file);
+  // Write the records in the format described in RecordFormat.h.
+  const Option option_record_allocs_binary(
+      "record_allocs_binary", 0, false, &this->record_allocs_binary);
 
   const Option* option_list[] = {
     &option_guard, &option_front_guard, &option_rear_guard,
-    &option_backtrace, &option_backtrace_enable_on_signal,
+    &option_backtrace, &option_backtrace_enable_on_signal, &option_backtrace_sample_bytes,
+    &option_backtrace_frame_pointers,
     &option_fill, &option_fill_on_alloc, &option_fill_on_free,
     &option_expand_alloc,
     &option_free_track, &option_free_track_backtrace_num_frames,
+    &option_free_track_verify_sample, &option_free_track_bytes, &option_free_track_async,
     &option_leak_track,
-    &option_record_allocs, &option_record_allocs_file,
+    &option_record_allocs, &option_record_allocs_file, &option_record_allocs_binary,
   };
 
   // Set defaults for all of the options.
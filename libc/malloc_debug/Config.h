@@ -65,6 +65,9 @@ struct Config {
   int backtrace_signal = 0;
   bool backtrace_enabled = false;
   size_t backtrace_frames = 0;
+  bool backtrace_sampling = false;
+  size_t backtrace_sample_bytes = 0;
+  bool backtrace_frame_pointers = false;
 
   size_t fill_on_alloc_bytes = 0;
   size_t fill_on_free_bytes = 0;
@@ -73,10 +76,16 @@ struct Config {
 
   size_t free_track_allocations = 0;
   size_t free_track_backtrace_num_frames = 0;
+  bool free_track_verify_sampling = false;
+  size_t free_track_verify_sample = 0;
+  bool free_track_byte_limit = false;
+  size_t free_track_bytes = 0;
+  bool free_track_async = false;
 
   int record_allocs_signal = 0;
   size_t record_allocs_num_entries = 0;
   std::string record_allocs_file;
+  bool record_allocs_binary = false;
 
   uint64_t options = 0;
   uint8_t fill_alloc_value;
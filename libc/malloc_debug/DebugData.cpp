@@ -50,7 +50,7 @@ bool DebugData::Initialize() {
     pointer_offset_ = BIONIC_ALIGN(sizeof(Header), MINIMUM_ALIGNMENT_BYTES);
 
     if (config_.options & BACKTRACE) {
-      backtrace.reset(new BacktraceData(this, config_, &pointer_offset_));
+      backtrace.reset(new BacktraceData(this, config_));
       if (!backtrace->Initialize(config_)) {
         return false;
       }
@@ -94,15 +94,33 @@ void DebugData::PrepareFork() {
   if (track != nullptr) {
     track->PrepareFork();
   }
+  if (backtrace != nullptr) {
+    backtrace->PrepareFork();
+  }
+  if (free_track != nullptr) {
+    free_track->PrepareFork();
+  }
 }
 
 void DebugData::PostForkParent() {
+  if (free_track != nullptr) {
+    free_track->PostForkParent();
+  }
+  if (backtrace != nullptr) {
+    backtrace->PostForkParent();
+  }
   if (track != nullptr) {
     track->PostForkParent();
   }
 }
 
 void DebugData::PostForkChild() {
+  if (free_track != nullptr) {
+    free_track->PostForkChild();
+  }
+  if (backtrace != nullptr) {
+    backtrace->PostForkChild();
+  }
   if (track != nullptr) {
     track->PostForkChild();
   }
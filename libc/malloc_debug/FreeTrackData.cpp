@@ -26,23 +26,50 @@
  * SUCH DAMAGE.
  */
 
+#include <pthread.h>
 #include <stdint.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <utility>
 
 #include "backtrace.h"
 #include "Config.h"
 #include "DebugData.h"
 #include "debug_disable.h"
 #include "debug_log.h"
+#include "fill_check.h"
 #include "FreeTrackData.h"
 #include "malloc_debug.h"
 
 FreeTrackData::FreeTrackData(DebugData* debug, const Config& config)
-    : OptionData(debug), backtrace_num_frames_(config.free_track_backtrace_num_frames) {
-  cmp_mem_.resize(4096);
-  memset(cmp_mem_.data(), config.fill_free_value, cmp_mem_.size());
+    : OptionData(debug),
+      size_classes_(config.free_track_byte_limit ? kSizeClasses : 1),
+      max_allocations_(config.free_track_allocations),
+      max_bytes_(config.free_track_byte_limit ? config.free_track_bytes / kSizeClasses : 0),
+      backtrace_num_frames_(config.free_track_backtrace_num_frames),
+      verify_sample_(config.free_track_verify_sampling ? config.free_track_verify_sample : 1),
+      verify_countdown_(verify_sample_),
+      async_(config.free_track_async) {
+}
+
+FreeTrackData::~FreeTrackData() {
+  StopVerifyThread();
+}
+
+size_t FreeTrackData::SizeClass(const Header* header) {
+  if (size_classes_ == 1 || header->usable_size <= 256) {
+    return 0;
+  } else if (header->usable_size <= 4096) {
+    return 1;
+  } else if (header->usable_size <= 65536) {
+    return 2;
+  }
+  return 3;
 }
 
-void FreeTrackData::LogFreeError(const Header* header, const uint8_t* pointer) {
+void FreeTrackData::LogFreeError(const Header* header, const uint8_t* pointer,
+                                 const BacktraceHeader* back_header) {
   error_log(LOG_DIVIDER);
   error_log("+++ ALLOCATION %p USED AFTER FREE", pointer);
   uint8_t fill_free_value = debug_->config().fill_free_value;
@@ -51,71 +78,181 @@ void FreeTrackData::LogFreeError(const Header* header, const uint8_t* pointer) {
       error_log("  allocation[%zu] = 0x%02x (expected 0x%02x)", i, pointer[i], fill_free_value);
     }
   }
-  auto back_iter = backtraces_.find(header);
-  if (back_iter != backtraces_.end()) {
-    const BacktraceHeader* back_header = back_iter->second;
+  if (back_header != nullptr) {
     error_log("Backtrace at time of free:");
     backtrace_log(&back_header->frames[0], back_header->num_frames);
   }
   error_log(LOG_DIVIDER);
 }
 
-void FreeTrackData::VerifyAndFree(const Header* header) {
+void FreeTrackData::VerifyAndFree(const Entry& entry) {
+  const Header* header = entry.header;
   const void* pointer = debug_->GetPointer(header);
   if (header->tag != DEBUG_FREE_TAG) {
     error_log(LOG_DIVIDER);
     error_log("+++ ALLOCATION %p HAS CORRUPTED HEADER TAG 0x%x AFTER FREE", pointer, header->tag);
     error_log(LOG_DIVIDER);
-  } else {
-    const uint8_t* memory = reinterpret_cast<const uint8_t*>(pointer);
+  } else if (entry.verify) {
     size_t bytes = header->usable_size;
     bytes = (bytes < debug_->config().fill_on_free_bytes) ? bytes
         : debug_->config().fill_on_free_bytes;
-    while (bytes > 0) {
-      size_t bytes_to_cmp = (bytes < cmp_mem_.size()) ? bytes : cmp_mem_.size();
-      if (memcmp(memory, cmp_mem_.data(), bytes_to_cmp) != 0) {
-        LogFreeError(header, reinterpret_cast<const uint8_t*>(pointer));
-        break;
-      }
-      bytes -= bytes_to_cmp;
-      memory = &memory[bytes_to_cmp];
+    if (!all_bytes_equal(pointer, bytes, debug_->config().fill_free_value)) {
+      LogFreeError(header, reinterpret_cast<const uint8_t*>(pointer), entry.backtrace);
     }
   }
 
-  auto back_iter = backtraces_.find(header);
-  if (back_iter != backtraces_.end()) {
-    g_dispatch->free(reinterpret_cast<void*>(back_iter->second));
-    backtraces_.erase(header);
+  if (entry.backtrace != nullptr) {
+    g_dispatch->free(entry.backtrace);
   }
   g_dispatch->free(header->orig_pointer);
 }
 
-void FreeTrackData::Add(const Header* header) {
-  pthread_mutex_lock(&mutex_);
-  if (list_.size() == debug_->config().free_track_allocations) {
-    const Header* old_header = list_.back();
-    VerifyAndFree(old_header);
-    list_.pop_back();
+// Called with mutex_ held, once entry has been taken off its list.
+void FreeTrackData::Evict(Entry& entry) {
+  entry.verify = (--verify_countdown_ == 0);
+  if (entry.verify) {
+    verify_countdown_ = verify_sample_;
+  }
+
+  size_t bytes = entry.header->usable_size;
+  bool backlogged = pending_.size() >= kMaxPending ||
+      (max_bytes_ != 0 && pending_bytes_ + bytes > max_bytes_);
+  if (async_ && !backlogged && (verify_thread_started_ || StartVerifyThread())) {
+    pending_.push_back(entry);
+    pending_bytes_ += bytes;
+    if (pending_.size() == kVerifyBatch) {
+      pthread_cond_signal(&pending_cond_);
+    }
+  } else {
+    VerifyAndFree(entry);
   }
+}
 
+void FreeTrackData::Add(const Header* header) {
+  Entry entry = {header, nullptr, false};
   if (backtrace_num_frames_ > 0) {
     BacktraceHeader* back_header = reinterpret_cast<BacktraceHeader*>(
       g_dispatch->malloc(sizeof(BacktraceHeader) + backtrace_num_frames_ * sizeof(uintptr_t)));
     if (back_header) {
       back_header->num_frames = backtrace_get(&back_header->frames[0], backtrace_num_frames_);
-      backtraces_[header] = back_header;
+      entry.backtrace = back_header;
+    }
+  }
+
+  pthread_mutex_lock(&mutex_);
+  Quarantine& quarantine = quarantines_[SizeClass(header)];
+  while (!quarantine.list.empty() &&
+         (quarantine.list.size() == max_allocations_ ||
+          (max_bytes_ != 0 && quarantine.bytes + header->usable_size > max_bytes_))) {
+    Entry old_entry = quarantine.list.back();
+    quarantine.list.pop_back();
+    quarantine.bytes -= old_entry.header->usable_size;
+    if (old_entry.backtrace != nullptr) {
+      backtraces_.erase(old_entry.header);
+    }
+    Evict(old_entry);
+  }
+
+  if (entry.backtrace != nullptr) {
+    backtraces_[header] = entry.backtrace;
+  }
+  quarantine.list.push_front(entry);
+  quarantine.bytes += header->usable_size;
+
+  pthread_mutex_unlock(&mutex_);
+}
+
+// Called with mutex_ held.
+bool FreeTrackData::StartVerifyThread() {
+  pthread_attr_t attr;
+  pthread_attr_init(&attr);
+  pthread_attr_setstacksize(&attr, 64 * 1024);
+  int result = pthread_create(&verify_thread_, &attr, VerifyThreadMain, this);
+  pthread_attr_destroy(&attr);
+  if (result != 0) {
+    // Don't keep trying on every free.
+    async_ = false;
+    return false;
+  }
+  verify_thread_started_ = true;
+  return true;
+}
+
+void* FreeTrackData::VerifyThreadMain(void* arg) {
+  // Nothing this thread allocates or frees should go through the debug code.
+  DebugDisableSet(true);
+  setpriority(PRIO_PROCESS, gettid(), 19);
+  reinterpret_cast<FreeTrackData*>(arg)->VerifyLoop();
+  return nullptr;
+}
+
+void FreeTrackData::VerifyLoop() {
+  std::vector<Entry> batch;
+  pthread_mutex_lock(&mutex_);
+  while (true) {
+    while (pending_.size() < kVerifyBatch && !verify_thread_stopping_) {
+      pthread_cond_wait(&pending_cond_, &mutex_);
+    }
+    if (verify_thread_stopping_) {
+      break;
+    }
+
+    batch.swap(pending_);
+    pending_bytes_ = 0;
+    verifying_ = true;
+    pthread_mutex_unlock(&mutex_);
+
+    for (const auto& entry : batch) {
+      VerifyAndFree(entry);
     }
+    batch.clear();
+
+    pthread_mutex_lock(&mutex_);
+    verifying_ = false;
+    pthread_cond_broadcast(&idle_cond_);
   }
-  list_.push_front(header);
+  pthread_mutex_unlock(&mutex_);
+}
 
+void FreeTrackData::StopVerifyThread() {
+  pthread_mutex_lock(&mutex_);
+  if (!verify_thread_started_) {
+    pthread_mutex_unlock(&mutex_);
+    return;
+  }
+  verify_thread_stopping_ = true;
+  pthread_cond_signal(&pending_cond_);
+  pthread_mutex_unlock(&mutex_);
+
+  pthread_join(verify_thread_, nullptr);
+
+  pthread_mutex_lock(&mutex_);
+  verify_thread_started_ = false;
+  verify_thread_stopping_ = false;
   pthread_mutex_unlock(&mutex_);
 }
 
 void FreeTrackData::VerifyAll() {
-  for (const auto& header : list_) {
-    VerifyAndFree(header);
+  // Whatever the verifier thread hadn't got to yet is verified here instead.
+  StopVerifyThread();
+  async_ = false;
+
+  for (const auto& entry : pending_) {
+    VerifyAndFree(entry);
+  }
+  pending_.clear();
+  pending_bytes_ = 0;
+
+  for (size_t i = 0; i < size_classes_; i++) {
+    Quarantine& quarantine = quarantines_[i];
+    for (auto& entry : quarantine.list) {
+      entry.verify = true;
+      VerifyAndFree(entry);
+    }
+    quarantine.list.clear();
+    quarantine.bytes = 0;
   }
-  list_.clear();
+  backtraces_.clear();
 }
 
 void FreeTrackData::LogBacktrace(const Header* header) {
@@ -127,3 +264,25 @@ void FreeTrackData::LogBacktrace(const Header* header) {
   error_log("Backtrace of original free:");
   backtrace_log(&back_iter->second->frames[0], back_iter->second->num_frames);
 }
+
+void FreeTrackData::PrepareFork() {
+  pthread_mutex_lock(&mutex_);
+  // Don't let the child inherit a batch that's half freed.
+  while (verifying_) {
+    pthread_cond_wait(&idle_cond_, &mutex_);
+  }
+}
+
+void FreeTrackData::PostForkParent() {
+  pthread_mutex_unlock(&mutex_);
+}
+
+void FreeTrackData::PostForkChild() {
+  mutex_ = PTHREAD_MUTEX_INITIALIZER;
+  pending_cond_ = PTHREAD_COND_INITIALIZER;
+  idle_cond_ = PTHREAD_COND_INITIALIZER;
+  // The verifier thread doesn't exist in the child. One is started again if needed, and anything
+  // already pending is verified by that one, or at exit.
+  verify_thread_started_ = false;
+  verify_thread_stopping_ = false;
+}
@@ -49,7 +49,7 @@ struct Header;
 class FreeTrackData : public OptionData {
  public:
   FreeTrackData(DebugData* debug_data, const Config& config);
-  virtual ~FreeTrackData() = default;
+  virtual ~FreeTrackData();
 
   void Add(const Header* header);
 
@@ -57,15 +57,67 @@ class FreeTrackData : public OptionData {
 
   void LogBacktrace(const Header* header);
 
+  void PrepareFork();
+  void PostForkParent();
+  void PostForkChild();
+
  private:
-  void LogFreeError(const Header* header, const uint8_t* pointer);
-  void VerifyAndFree(const Header* header);
+  struct Entry {
+    const Header* header;
+    // The backtrace at the time of the free, if one was recorded.
+    BacktraceHeader* backtrace;
+    // Whether the fill is checked before the allocation is really freed.
+    bool verify;
+  };
+
+  // Without free_track_bytes there's a single list. With it, allocations are kept on the list for
+  // their size, so that a stream of large frees can't push out every small one.
+  static constexpr size_t kSizeClasses = 4;
+  struct Quarantine {
+    std::deque<Entry> list;
+    size_t bytes = 0;
+  };
+
+  // The verifier thread wakes up once this many allocations are waiting for it.
+  static constexpr size_t kVerifyBatch = 64;
+  // If the verifier falls this far behind (or behind by more than max_bytes_), frees verify their
+  // own evictions again.
+  static constexpr size_t kMaxPending = 16 * kVerifyBatch;
+
+  size_t SizeClass(const Header* header);
+  void Evict(Entry& entry);
+  bool StartVerifyThread();
+  void StopVerifyThread();
+  static void* VerifyThreadMain(void* arg);
+  void VerifyLoop();
+
+  void LogFreeError(const Header* header, const uint8_t* pointer, const BacktraceHeader* backtrace);
+  void VerifyAndFree(const Entry& entry);
 
   pthread_mutex_t mutex_ = PTHREAD_MUTEX_INITIALIZER;
-  std::deque<const Header*> list_;
-  std::vector<uint8_t> cmp_mem_;
+  Quarantine quarantines_[kSizeClasses];
+  size_t size_classes_;
+  size_t max_allocations_;
+  // Per size class; zero for no limit.
+  size_t max_bytes_;
   std::unordered_map<const Header*, BacktraceHeader*> backtraces_;
   size_t backtrace_num_frames_;
+  // Only one in verify_sample_ of the allocations that leave the list is verified.
+  size_t verify_sample_;
+  size_t verify_countdown_;
+
+  // With free_track_async, evicted allocations are queued here for the verifier thread, which is
+  // started the first time one is.
+  bool async_;
+  bool verify_thread_started_ = false;
+  bool verify_thread_stopping_ = false;
+  // Set while the verifier thread is working through a batch without holding mutex_.
+  bool verifying_ = false;
+  pthread_t verify_thread_;
+  pthread_cond_t pending_cond_ = PTHREAD_COND_INITIALIZER;
+  pthread_cond_t idle_cond_ = PTHREAD_COND_INITIALIZER;
+  std::vector<Entry> pending_;
+  size_t pending_bytes_ = 0;
 
   DISALLOW_COPY_AND_ASSIGN(FreeTrackData);
 };
@@ -30,12 +30,10 @@
 #define DEBUG_MALLOC_GUARDDATA_H
 
 #include <stdint.h>
-#include <string.h>
-
-#include <vector>
 
 #include <private/bionic_macros.h>
 
+#include "fill_check.h"
 #include "OptionData.h"
 
 // Forward declarations.
@@ -48,12 +46,13 @@ class GuardData : public OptionData {
   GuardData(DebugData* debug_data, int init_value, size_t num_bytes);
   virtual ~GuardData() = default;
 
-  bool Valid(void* data) { return memcmp(data, cmp_mem_.data(), cmp_mem_.size()) == 0; }
+  bool Valid(void* data) { return all_bytes_equal(data, num_bytes_, value_); }
 
   void LogFailure(const Header* header, const void* pointer, const void* data);
 
  protected:
-  std::vector<uint8_t> cmp_mem_;
+  uint8_t value_;
+  size_t num_bytes_;
 
   virtual const char* GetTypeName() = 0;
 
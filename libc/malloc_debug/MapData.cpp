@@ -29,35 +29,39 @@
 #include <ctype.h>
 #include <elf.h>
 #include <inttypes.h>
+#include <limits.h>
 #include <link.h>
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
 
+#include <algorithm>
 #include <vector>
 
 #include "MapData.h"
 
+#include "private/LineReader.h"
+
 // Format of /proc/<PID>/maps:
 //   6f000000-6f01e000 rwxp 00000000 00:0c 16389419   /system/lib/libcomposer.so
 static MapEntry* parse_line(char* line) {
+  FieldTokenizer fields(line);
+  const char* range = fields.Next();
   uintptr_t start;
   uintptr_t end;
-  uintptr_t offset;
-  char permissions[5];
-  int name_pos;
-  if (sscanf(line, "%" PRIxPTR "-%" PRIxPTR " %4s %" PRIxPTR " %*x:%*x %*d %n", &start,
-             &end, permissions, &offset, &name_pos) < 2) {
+  if (range == nullptr || (range = FieldTokenizer::ParseNumber(range, 16, &start)) == nullptr ||
+      *range != '-' || FieldTokenizer::ParseNumber(range + 1, 16, &end) == nullptr) {
     return nullptr;
   }
-
-  const char* name = line + name_pos;
-  size_t name_len = strlen(name);
-  if (name_len && name[name_len - 1] == '\n') {
-    name_len -= 1;
+  const char* permissions = fields.Next();
+  uintptr_t offset;
+  if (permissions == nullptr || !fields.NextNumber(16, &offset) ||
+      fields.Next() == nullptr || fields.Next() == nullptr) {
+    return nullptr;
   }
+  const char* name = fields.Rest();
 
-  MapEntry* entry = new MapEntry(start, end, offset, name, name_len);
+  MapEntry* entry = new MapEntry(start, end, offset, name, strlen(name));
   if (permissions[0] != 'r') {
     // Any unreadable map will just get a zero load base.
     entry->load_base = 0;
@@ -111,28 +115,54 @@ static void read_loadbase(MapEntry* entry) {
 }
 
 bool MapData::ReadMaps() {
-  FILE* fp = fopen("/proc/self/maps", "re");
-  if (fp == nullptr) {
+  // Room for a line with the longest path.
+  char buffer[PATH_MAX + 256];
+  LineReader reader("/proc/self/maps", buffer, sizeof(buffer));
+  if (reader.IsBad()) {
     return false;
   }
-
-  std::vector<char> buffer(1024);
-  while (fgets(buffer.data(), buffer.size(), fp) != nullptr) {
-    MapEntry* entry = parse_line(buffer.data());
+  maps_read_ = true;
+  maps_snapshot_ = android_get_dl_phdr_snapshot();
+
+  // Anything that overlaps a map we already know about is left as it was, so that the
+  // pointers we've handed out stay valid.
+  std::vector<MapEntry*> added;
+  bool result = true;
+  char* line;
+  while ((line = reader.ReadLine()) != nullptr) {
+    MapEntry* entry = parse_line(line);
     if (entry == nullptr) {
-      fclose(fp);
-      return false;
+      result = false;
+      break;
     }
 
-    auto it = entries_.find(entry);
-    if (it == entries_.end()) {
-      entries_.insert(entry);
+    if (!OverlapsLocked(entry)) {
+      added.push_back(entry);
     } else {
       delete entry;
     }
   }
-  fclose(fp);
-  return true;
+  if (reader.HadError()) {
+    result = false;
+  }
+
+  if (!added.empty()) {
+    entries_.insert(entries_.end(), added.begin(), added.end());
+    std::sort(entries_.begin(), entries_.end(),
+              [](const MapEntry* a, const MapEntry* b) { return a->start < b->start; });
+  }
+  return result;
+}
+
+// A pc that wasn't in any map last time can only be in one now if something has been mapped
+// since. That's almost always a library being loaded, which the linker's snapshot tells us about
+// without reading /proc/self/maps again. If there's no snapshot, assume anything may have changed.
+bool MapData::MapsMayHaveChanged() {
+  if (!maps_read_) {
+    return true;
+  }
+  const android_dl_phdr_snapshot* snapshot = android_get_dl_phdr_snapshot();
+  return snapshot == nullptr || snapshot != maps_snapshot_;
 }
 
 MapData::~MapData() {
@@ -142,22 +172,31 @@ MapData::~MapData() {
   entries_.clear();
 }
 
-// Find the containing map info for the PC.
-const MapEntry* MapData::find(uintptr_t pc, uintptr_t* rel_pc) {
-  MapEntry pc_entry(pc);
-
-  std::lock_guard<std::mutex> lock(m_);
+// Binary search for the entry containing pc.
+MapEntry* MapData::FindLocked(uintptr_t pc) {
+  auto it = std::upper_bound(entries_.begin(), entries_.end(), pc,
+                             [](uintptr_t pc, const MapEntry* entry) { return pc < entry->start; });
+  if (it == entries_.begin()) {
+    return nullptr;
+  }
+  MapEntry* entry = *--it;
+  return (pc < entry->end) ? entry : nullptr;
+}
 
-  auto it = entries_.find(&pc_entry);
-  if (it == entries_.end()) {
-    ReadMaps();
+bool MapData::OverlapsLocked(const MapEntry* entry) {
+  auto it = std::upper_bound(
+      entries_.begin(), entries_.end(), entry->start,
+      [](uintptr_t start, const MapEntry* other) { return start < other->start; });
+  if (it != entries_.end() && (*it)->start < entry->end) {
+    return true;
   }
-  it = entries_.find(&pc_entry);
-  if (it == entries_.end()) {
+  return it != entries_.begin() && (*--it)->end > entry->start;
+}
+
+const MapEntry* MapData::ResolveLocked(MapEntry* entry, uintptr_t pc, uintptr_t* rel_pc) {
+  if (entry == nullptr) {
     return nullptr;
   }
-
-  MapEntry *entry = *it;
   if (!entry->load_base_read) {
     read_loadbase(entry);
   }
@@ -166,3 +205,31 @@ const MapEntry* MapData::find(uintptr_t pc, uintptr_t* rel_pc) {
   }
   return entry;
 }
+
+// Find the containing map info for the PC.
+const MapEntry* MapData::find(uintptr_t pc, uintptr_t* rel_pc) {
+  std::lock_guard<std::mutex> lock(m_);
+
+  MapEntry* entry = FindLocked(pc);
+  if (entry == nullptr && MapsMayHaveChanged()) {
+    ReadMaps();
+    entry = FindLocked(pc);
+  }
+  return ResolveLocked(entry, pc, rel_pc);
+}
+
+void MapData::find(const uintptr_t* pcs, size_t pc_count, const MapEntry** entries,
+                   uintptr_t* rel_pcs) {
+  std::lock_guard<std::mutex> lock(m_);
+
+  bool reread = false;
+  for (size_t i = 0; i < pc_count; i++) {
+    MapEntry* entry = FindLocked(pcs[i]);
+    if (entry == nullptr && !reread && MapsMayHaveChanged()) {
+      ReadMaps();
+      reread = true;
+      entry = FindLocked(pcs[i]);
+    }
+    entries[i] = ResolveLocked(entry, pcs[i], rel_pcs ? &rel_pcs[i] : nullptr);
+  }
+}
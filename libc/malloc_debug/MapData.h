@@ -29,11 +29,12 @@
 #ifndef DEBUG_MALLOC_MAPDATA_H
 #define DEBUG_MALLOC_MAPDATA_H
 
+#include <link.h>
 #include <sys/cdefs.h>
 
 #include <mutex>
 #include <string>
-#include <set>
+#include <vector>
 
 #include <private/bionic_macros.h>
 
@@ -52,13 +53,6 @@ struct MapEntry {
 };
 
 
-// Ordering comparator that returns equivalence for overlapping entries
-struct compare_entries {
-  bool operator()(const MapEntry* a, const MapEntry* b) const {
-    return a->end <= b->start;
-  }
-};
-
 class MapData {
  public:
   MapData() = default;
@@ -66,11 +60,25 @@ class MapData {
 
   const MapEntry* find(uintptr_t pc, uintptr_t* rel_pc = nullptr);
 
+  // Looks up pc_count pcs at once, storing each one's entry (or null) in entries and, if
+  // rel_pcs isn't null, its relative pc in rel_pcs. The maps are read at most once.
+  void find(const uintptr_t* pcs, size_t pc_count, const MapEntry** entries, uintptr_t* rel_pcs);
+
  private:
   bool ReadMaps();
+  bool MapsMayHaveChanged();
+  MapEntry* FindLocked(uintptr_t pc);
+  bool OverlapsLocked(const MapEntry* entry);
+  const MapEntry* ResolveLocked(MapEntry* entry, uintptr_t pc, uintptr_t* rel_pc);
 
   std::mutex m_;
-  std::set<MapEntry*, compare_entries> entries_;
+  // Sorted by start address, and never overlapping. The entries themselves are never freed or
+  // changed (until the MapData is destroyed), so callers can keep the pointers they are given.
+  std::vector<MapEntry*> entries_;
+  // The linker's snapshot when the maps were last read, to tell whether a miss could be for a
+  // library loaded since.
+  bool maps_read_ = false;
+  const android_dl_phdr_snapshot* maps_snapshot_ = nullptr;
 
   DISALLOW_COPY_AND_ASSIGN(MapData);
 };
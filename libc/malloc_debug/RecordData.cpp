@@ -33,9 +33,12 @@
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <sys/mman.h>
 #include <sys/types.h>
+#include <time.h>
 
 #include <mutex>
+#include <new>
 
 #include <android-base/stringprintf.h>
 
@@ -96,10 +99,33 @@ std::string MemalignEntry::GetString() const {
                                      alignment_, size_);
 }
 
+// A buffer of binary records made by a single thread. Chunks are mapped
+// directly so that recording does not disturb the heap being traced.
+struct RecordChunk {
+  RecordChunk* next = nullptr;
+  RecordChunkHeader header;
+  uint64_t last_ns;
+  uintptr_t last_pointer = 0;
+
+  uint8_t* data() { return reinterpret_cast<uint8_t*>(this + 1); }
+};
+
+static constexpr size_t RECORD_CHUNK_SIZE = 64 * 1024;
+static constexpr size_t RECORD_CHUNK_DATA_SIZE = RECORD_CHUNK_SIZE - sizeof(RecordChunk);
+
+static uint64_t Nanotime() {
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return static_cast<uint64_t>(t.tv_sec) * 1000000000 + t.tv_nsec;
+}
+
 struct ThreadData {
   ThreadData(RecordData* record_data, ThreadCompleteEntry* entry) : record_data(record_data), entry(entry) {}
   RecordData* record_data;
+  // Only used in the text format.
   ThreadCompleteEntry* entry;
+  // Only used in the binary format.
+  RecordChunk* chunk = nullptr;
   size_t count = 0;
 };
 
@@ -112,7 +138,11 @@ static void ThreadKeyDelete(void* data) {
   if (thread_data->count == 4) {
     ScopedDisableDebugCalls disable;
 
-    thread_data->record_data->AddEntryOnly(thread_data->entry);
+    if (thread_data->entry != nullptr) {
+      thread_data->record_data->AddEntryOnly(thread_data->entry);
+    } else {
+      thread_data->record_data->AddThreadDone(thread_data);
+    }
     delete thread_data;
   } else {
     pthread_setspecific(thread_data->record_data->key(), data);
@@ -141,9 +171,24 @@ void RecordData::Dump() {
     last_entry_index = num_entries_;
   }
 
+  if (binary_) {
+    // Include the records of this thread up to the one that triggered the
+    // dump. Other threads keep filling their current chunk, which will be
+    // part of a later dump.
+    ThreadData* thread_data = reinterpret_cast<ThreadData*>(pthread_getspecific(key_));
+    if (thread_data != nullptr && thread_data->chunk != nullptr) {
+      FinishChunk(thread_data);
+    }
+  }
+
   int dump_fd = open(dump_file_.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC | O_NOFOLLOW,
                      0755);
-  if (dump_fd != -1) {
+  if (dump_fd != -1 && binary_) {
+    DumpChunks(dump_fd);
+    close(dump_fd);
+
+    cur_index_ = 0U;
+  } else if (dump_fd != -1) {
     for (size_t i = 0; i < last_entry_index; i++) {
       std::string line = entries_[i]->GetString();
       ssize_t bytes = write(dump_fd, line.c_str(), line.length());
@@ -174,6 +219,50 @@ void RecordData::Dump() {
   dump_ = false;
 }
 
+bool RecordData::DumpChunks(int dump_fd) {
+  RecordChunk* chunks;
+  {
+    std::lock_guard<std::mutex> lock(chunk_lock_);
+    chunks = chunks_;
+    chunks_ = nullptr;
+  }
+
+  // Write the chunks in the order they were filled.
+  RecordChunk* oldest = nullptr;
+  while (chunks != nullptr) {
+    RecordChunk* next = chunks->next;
+    chunks->next = oldest;
+    oldest = chunks;
+    chunks = next;
+  }
+
+  RecordFileHeader file_header;
+  memcpy(file_header.magic, RECORD_FILE_MAGIC, sizeof(file_header.magic));
+  file_header.version = RECORD_FILE_VERSION;
+  bool written = write(dump_fd, &file_header, sizeof(file_header)) ==
+      static_cast<ssize_t>(sizeof(file_header));
+
+  while (oldest != nullptr) {
+    RecordChunk* chunk = oldest;
+    oldest = chunk->next;
+
+    if (written) {
+      ssize_t header_bytes = write(dump_fd, &chunk->header, sizeof(chunk->header));
+      ssize_t data_bytes = write(dump_fd, chunk->data(), chunk->header.num_bytes);
+      written = header_bytes == static_cast<ssize_t>(sizeof(chunk->header)) &&
+          data_bytes == static_cast<ssize_t>(chunk->header.num_bytes);
+    }
+    // We don't have any way to dump a partial list of the records, so drop
+    // the rest of them after a failure.
+    munmap(chunk, RECORD_CHUNK_SIZE);
+  }
+
+  if (!written) {
+    error_log("Failed to write record alloc information: %s", strerror(errno));
+  }
+  return written;
+}
+
 RecordData::RecordData() {
   pthread_key_create(&key_, ThreadKeyDelete);
 }
@@ -195,7 +284,10 @@ bool RecordData::Initialize(const Config& config) {
            config.record_allocs_signal, getpid());
 
   num_entries_ = config.record_allocs_num_entries;
-  entries_ = new const RecordEntry*[num_entries_];
+  binary_ = config.record_allocs_binary;
+  if (!binary_) {
+    entries_ = new const RecordEntry*[num_entries_];
+  }
   cur_index_ = 0;
   dump_ = false;
   dump_file_ = config.record_allocs_file;
@@ -205,6 +297,11 @@ bool RecordData::Initialize(const Config& config) {
 
 RecordData::~RecordData() {
   delete [] entries_;
+  while (chunks_ != nullptr) {
+    RecordChunk* chunk = chunks_;
+    chunks_ = chunk->next;
+    munmap(chunk, RECORD_CHUNK_SIZE);
+  }
   pthread_key_delete(key_);
 }
 
@@ -215,12 +312,17 @@ void RecordData::AddEntryOnly(const RecordEntry* entry) {
   }
 }
 
-void RecordData::AddEntry(const RecordEntry* entry) {
-  void* data = pthread_getspecific(key_);
-  if (data == nullptr) {
-    ThreadData* thread_data = new ThreadData(this, new ThreadCompleteEntry());
+ThreadData* RecordData::GetThreadData() {
+  ThreadData* thread_data = reinterpret_cast<ThreadData*>(pthread_getspecific(key_));
+  if (thread_data == nullptr) {
+    thread_data = new ThreadData(this, binary_ ? nullptr : new ThreadCompleteEntry());
     pthread_setspecific(key_, thread_data);
   }
+  return thread_data;
+}
+
+void RecordData::AddEntry(const RecordEntry* entry) {
+  GetThreadData();
 
   AddEntryOnly(entry);
 
@@ -229,3 +331,116 @@ void RecordData::AddEntry(const RecordEntry* entry) {
     Dump();
   }
 }
+
+void RecordData::FinishChunk(ThreadData* thread_data) {
+  std::lock_guard<std::mutex> lock(chunk_lock_);
+  thread_data->chunk->next = chunks_;
+  chunks_ = thread_data->chunk;
+  thread_data->chunk = nullptr;
+}
+
+bool RecordData::WriteRecord(ThreadData* thread_data, RecordOp op, uintptr_t pointer,
+                             uint64_t arg0, uint64_t arg1) {
+  RecordChunk* chunk = thread_data->chunk;
+  if (chunk != nullptr && chunk->header.num_bytes + RECORD_MAX_BYTES > RECORD_CHUNK_DATA_SIZE) {
+    FinishChunk(thread_data);
+    chunk = nullptr;
+  }
+
+  uint64_t now = Nanotime();
+  if (chunk == nullptr) {
+    void* map = mmap(nullptr, RECORD_CHUNK_SIZE, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (map == MAP_FAILED) {
+      return false;
+    }
+    chunk = new (map) RecordChunk;
+    chunk->header.tid = gettid();
+    chunk->header.num_bytes = 0;
+    chunk->header.start_ns = now;
+    chunk->last_ns = now;
+    thread_data->chunk = chunk;
+  }
+
+  uint8_t* start = chunk->data() + chunk->header.num_bytes;
+  uint8_t* out = start;
+  *out++ = op;
+  out = RecordPutVarint(out, now - chunk->last_ns);
+  chunk->last_ns = now;
+  if (op != RECORD_THREAD_DONE) {
+    out = RecordPutPointer(out, &chunk->last_pointer, pointer);
+  }
+  if (op == RECORD_CALLOC || op == RECORD_MEMALIGN) {
+    out = RecordPutVarint(out, arg0);
+  } else if (op == RECORD_REALLOC) {
+    out = RecordPutPointer(out, &chunk->last_pointer, arg0);
+  }
+  if (op != RECORD_FREE && op != RECORD_THREAD_DONE) {
+    out = RecordPutVarint(out, arg1);
+  }
+  chunk->header.num_bytes += out - start;
+  return true;
+}
+
+void RecordData::AddRecord(RecordOp op, uintptr_t pointer, uint64_t arg0, uint64_t arg1) {
+  ThreadData* thread_data = GetThreadData();
+
+  if (cur_index_.fetch_add(1) < num_entries_) {
+    WriteRecord(thread_data, op, pointer, arg0, arg1);
+  }
+
+  // Check to see if it's time to dump the entries.
+  if (dump_) {
+    Dump();
+  }
+}
+
+void RecordData::AddThreadDone(ThreadData* thread_data) {
+  if (cur_index_.fetch_add(1) < num_entries_) {
+    WriteRecord(thread_data, RECORD_THREAD_DONE, 0, 0, 0);
+  }
+  if (thread_data->chunk != nullptr) {
+    FinishChunk(thread_data);
+  }
+}
+
+void RecordData::AddMalloc(void* pointer, size_t size) {
+  if (binary_) {
+    AddRecord(RECORD_MALLOC, reinterpret_cast<uintptr_t>(pointer), 0, size);
+  } else {
+    AddEntry(new MallocEntry(pointer, size));
+  }
+}
+
+void RecordData::AddFree(void* pointer) {
+  if (binary_) {
+    AddRecord(RECORD_FREE, reinterpret_cast<uintptr_t>(pointer), 0, 0);
+  } else {
+    AddEntry(new FreeEntry(pointer));
+  }
+}
+
+void RecordData::AddCalloc(void* pointer, size_t nmemb, size_t size) {
+  if (binary_) {
+    AddRecord(RECORD_CALLOC, reinterpret_cast<uintptr_t>(pointer), nmemb, size);
+  } else {
+    AddEntry(new CallocEntry(pointer, size, nmemb));
+  }
+}
+
+void RecordData::AddRealloc(void* pointer, void* old_pointer, size_t size) {
+  if (binary_) {
+    AddRecord(RECORD_REALLOC, reinterpret_cast<uintptr_t>(pointer),
+              reinterpret_cast<uintptr_t>(old_pointer), size);
+  } else {
+    AddEntry(new ReallocEntry(pointer, size, old_pointer));
+  }
+}
+
+void RecordData::AddMemalign(void* pointer, size_t alignment, size_t size) {
+  if (binary_) {
+    AddRecord(RECORD_MEMALIGN, reinterpret_cast<uintptr_t>(pointer), alignment, size);
+  } else {
+    AddEntry(new MemalignEntry(pointer, size, alignment));
+  }
+}
@@ -39,6 +39,8 @@
 
 #include <private/bionic_macros.h>
 
+#include "RecordFormat.h"
+
 class RecordEntry {
  public:
   RecordEntry();
@@ -145,6 +147,8 @@ class MemalignEntry : public MallocEntry {
 };
 
 struct Config;
+struct RecordChunk;
+struct ThreadData;
 
 class RecordData {
  public:
@@ -156,12 +160,29 @@ class RecordData {
   void AddEntry(const RecordEntry* entry);
   void AddEntryOnly(const RecordEntry* entry);
 
+  void AddMalloc(void* pointer, size_t size);
+  void AddFree(void* pointer);
+  void AddCalloc(void* pointer, size_t nmemb, size_t size);
+  void AddRealloc(void* pointer, void* old_pointer, size_t size);
+  void AddMemalign(void* pointer, size_t alignment, size_t size);
+
+  // Appends the final record of a thread in the binary format.
+  void AddThreadDone(ThreadData* thread_data);
+
   void SetToDump() { dump_ = true; }
 
   pthread_key_t key() { return key_; }
 
  private:
+  ThreadData* GetThreadData();
+
+  void AddRecord(RecordOp op, uintptr_t pointer, uint64_t arg0, uint64_t arg1);
+  bool WriteRecord(ThreadData* thread_data, RecordOp op, uintptr_t pointer, uint64_t arg0,
+                   uint64_t arg1);
+  void FinishChunk(ThreadData* thread_data);
+
   void Dump();
+  bool DumpChunks(int dump_fd);
 
   std::mutex dump_lock_;
   pthread_key_t key_;
@@ -171,6 +192,13 @@ class RecordData {
   std::atomic_bool dump_;
   std::string dump_file_;
 
+  // Records are encoded per thread into RecordChunks instead of being
+  // kept as RecordEntry objects.
+  bool binary_ = false;
+  std::mutex chunk_lock_;
+  // Filled chunks waiting for the next dump, the newest first.
+  RecordChunk* chunks_ = nullptr;
+
   DISALLOW_COPY_AND_ASSIGN(RecordData);
 };
 
@@ -0,0 +1,167 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef DEBUG_MALLOC_RECORDFORMAT_H
+#define DEBUG_MALLOC_RECORDFORMAT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Binary format written by record_allocs_binary.
+//
+// The file starts with a RecordFileHeader, followed by any number of
+// chunks. Every chunk holds the records of a single thread, in the order
+// they were made, and starts with a RecordChunkHeader. Chunks from
+// different threads can be interleaved in any order; merge them by
+// timestamp to get a global order.
+//
+// A record is an op byte followed by the number of nanoseconds since the
+// previous record of the chunk (or since the start of the chunk) and the
+// op's arguments, all encoded as LEB128 varints:
+//
+//   RECORD_MALLOC:      pointer size
+//   RECORD_FREE:        pointer
+//   RECORD_CALLOC:      pointer nmemb size
+//   RECORD_REALLOC:     pointer old_pointer size
+//   RECORD_MEMALIGN:    pointer alignment size
+//   RECORD_THREAD_DONE:
+//
+// Pointers are stored as the zigzag encoded difference from the previous
+// pointer value in the chunk, which starts out as zero.
+
+static constexpr char RECORD_FILE_MAGIC[4] = { 'M', 'D', 'R', 'A' };
+static constexpr uint32_t RECORD_FILE_VERSION = 1;
+
+struct RecordFileHeader {
+  char magic[4];
+  uint32_t version;
+};
+
+struct RecordChunkHeader {
+  uint32_t tid;
+  uint32_t num_bytes;
+  // CLOCK_MONOTONIC time in nanoseconds.
+  uint64_t start_ns;
+};
+
+enum RecordOp : uint8_t {
+  RECORD_MALLOC = 0,
+  RECORD_FREE,
+  RECORD_CALLOC,
+  RECORD_REALLOC,
+  RECORD_MEMALIGN,
+  RECORD_THREAD_DONE,
+};
+
+// Op byte, time delta and three 64 bit varints.
+static constexpr size_t RECORD_MAX_BYTES = 1 + 4 * 10;
+
+static inline uint8_t* RecordPutVarint(uint8_t* out, uint64_t value) {
+  while (value >= 0x80) {
+    *out++ = static_cast<uint8_t>(value) | 0x80;
+    value >>= 7;
+  }
+  *out++ = static_cast<uint8_t>(value);
+  return out;
+}
+
+static inline uint8_t* RecordPutPointer(uint8_t* out, uintptr_t* last, uintptr_t pointer) {
+  int64_t delta = static_cast<int64_t>(static_cast<uint64_t>(pointer) - *last);
+  *last = pointer;
+  return RecordPutVarint(out, (static_cast<uint64_t>(delta) << 1) ^ (delta >> 63));
+}
+
+// Returns nullptr if the varint runs past end.
+static inline const uint8_t* RecordGetVarint(const uint8_t* in, const uint8_t* end,
+                                             uint64_t* value) {
+  *value = 0;
+  for (size_t shift = 0; in < end && shift < 64; shift += 7) {
+    uint8_t byte = *in++;
+    *value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0) {
+      return in;
+    }
+  }
+  return nullptr;
+}
+
+static inline const uint8_t* RecordGetPointer(const uint8_t* in, const uint8_t* end,
+                                              uint64_t* last, uint64_t* pointer) {
+  uint64_t zigzag;
+  in = RecordGetVarint(in, end, &zigzag);
+  if (in != nullptr) {
+    *last += (zigzag >> 1) ^ -(zigzag & 1);
+    *pointer = *last;
+  }
+  return in;
+}
+
+struct Record {
+  RecordOp op;
+  uint64_t time_ns;
+  uint64_t pointer;
+  // The nmemb of calloc, old_pointer of realloc or alignment of memalign.
+  uint64_t arg;
+  uint64_t size;
+};
+
+// Decodes the record at in. The caller initializes *time_ns to the chunk's
+// start_ns and *last_pointer to zero before the first record of a chunk.
+// Returns nullptr if the record is malformed.
+static inline const uint8_t* RecordDecode(const uint8_t* in, const uint8_t* end,
+                                          uint64_t* time_ns, uint64_t* last_pointer,
+                                          Record* record) {
+  if (in >= end || *in > RECORD_THREAD_DONE) {
+    return nullptr;
+  }
+  *record = Record();
+  record->op = static_cast<RecordOp>(*in++);
+
+  uint64_t delta;
+  in = RecordGetVarint(in, end, &delta);
+  if (in == nullptr) {
+    return nullptr;
+  }
+  *time_ns += delta;
+  record->time_ns = *time_ns;
+
+  if (record->op != RECORD_THREAD_DONE) {
+    in = RecordGetPointer(in, end, last_pointer, &record->pointer);
+  }
+  if (in != nullptr && (record->op == RECORD_CALLOC || record->op == RECORD_MEMALIGN)) {
+    in = RecordGetVarint(in, end, &record->arg);
+  } else if (in != nullptr && record->op == RECORD_REALLOC) {
+    in = RecordGetPointer(in, end, last_pointer, &record->arg);
+  }
+  if (in != nullptr && record->op != RECORD_FREE && record->op != RECORD_THREAD_DONE) {
+    in = RecordGetVarint(in, end, &record->size);
+  }
+  return in;
+}
+
+#endif // DEBUG_MALLOC_RECORDFORMAT_H
@@ -33,8 +33,6 @@
 #include <algorithm>
 #include <vector>
 
-#include <private/ScopedPthreadMutexLocker.h>
-
 #include "backtrace.h"
 #include "BacktraceData.h"
 #include "Config.h"
@@ -47,9 +45,68 @@
 TrackData::TrackData(DebugData* debug_data) : OptionData(debug_data) {
 }
 
+TrackData::Shard& TrackData::GetShard(const Header* header) {
+  // Allocations are at least 8 byte aligned and large ones are page
+  // aligned, so mix all of the address bits into the shard index.
+  uint64_t hash = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(header)) *
+                  0x9e3779b97f4a7c15ULL;
+  return shards_[hash >> (64 - kShardBits)];
+}
+
+void TrackData::LockAll() {
+  for (size_t i = 0; i < kShards; i++) {
+    pthread_mutex_lock(&shards_[i].mutex);
+  }
+}
+
+void TrackData::UnlockAll() {
+  for (size_t i = kShards; i > 0; i--) {
+    pthread_mutex_unlock(&shards_[i - 1].mutex);
+  }
+}
+
+void TrackData::Activate(Shard& shard) {
+  if (!shard.active.load(std::memory_order_acquire)) {
+    pthread_mutex_lock(&activate_mutex_);
+    shard.active.store(true, std::memory_order_release);
+    pthread_mutex_unlock(&activate_mutex_);
+  }
+}
+
+// Holding activate_mutex_ keeps the set of active shards fixed until the
+// fork is over, so an empty shard can't be written to behind our back
+// and there's no need to lock it.
+void TrackData::PrepareFork() {
+  pthread_mutex_lock(&activate_mutex_);
+  for (size_t i = 0; i < kShards; i++) {
+    if (shards_[i].active.load(std::memory_order_acquire)) {
+      pthread_mutex_lock(&shards_[i].mutex);
+    }
+  }
+}
+
+void TrackData::PostForkParent() {
+  for (size_t i = kShards; i > 0; i--) {
+    if (shards_[i - 1].active.load(std::memory_order_relaxed)) {
+      pthread_mutex_unlock(&shards_[i - 1].mutex);
+    }
+  }
+  pthread_mutex_unlock(&activate_mutex_);
+}
+
+void TrackData::PostForkChild() {
+  for (size_t i = 0; i < kShards; i++) {
+    pthread_mutex_init(&shards_[i].mutex, NULL);
+  }
+  pthread_mutex_init(&activate_mutex_, NULL);
+}
+
+// The caller must hold every shard lock or be the only thread left.
 void TrackData::GetList(std::vector<const Header*>* list) {
-  for (const auto& header : headers_) {
-    list->push_back(header);
+  for (size_t i = 0; i < kShards; i++) {
+    for (const auto& header : shards_[i].headers) {
+      list->push_back(header);
+    }
   }
 
   // Sort by the size of the allocation.
@@ -60,27 +117,33 @@ void TrackData::GetList(std::vector<const Header*>* list) {
 }
 
 void TrackData::Add(const Header* header, bool backtrace_found) {
-  pthread_mutex_lock(&mutex_);
+  Shard& shard = GetShard(header);
+  Activate(shard);
+  pthread_mutex_lock(&shard.mutex);
+  // Updated under the shard lock so that LockAll() sees a count that
+  // matches the sets.
   if (backtrace_found) {
-    total_backtrace_allocs_++;
+    total_backtrace_allocs_.fetch_add(1, std::memory_order_relaxed);
   }
-  headers_.insert(header);
-  pthread_mutex_unlock(&mutex_);
+  shard.headers.insert(header);
+  pthread_mutex_unlock(&shard.mutex);
 }
 
 void TrackData::Remove(const Header* header, bool backtrace_found) {
-  pthread_mutex_lock(&mutex_);
-  headers_.erase(header);
+  Shard& shard = GetShard(header);
+  pthread_mutex_lock(&shard.mutex);
+  shard.headers.erase(header);
   if (backtrace_found) {
-    total_backtrace_allocs_--;
+    total_backtrace_allocs_.fetch_sub(1, std::memory_order_relaxed);
   }
-  pthread_mutex_unlock(&mutex_);
+  pthread_mutex_unlock(&shard.mutex);
 }
 
 bool TrackData::Contains(const Header* header) {
-  pthread_mutex_lock(&mutex_);
-  bool found = headers_.count(header);
-  pthread_mutex_unlock(&mutex_);
+  Shard& shard = GetShard(header);
+  pthread_mutex_lock(&shard.mutex);
+  bool found = shard.headers.count(header);
+  pthread_mutex_unlock(&shard.mutex);
   return found;
 }
 
@@ -93,10 +156,12 @@ void TrackData::DisplayLeaks() {
     error_log("+++ %s leaked block of size %zu at %p (leak %zu of %zu)", getprogname(),
               header->real_size(), debug_->GetPointer(header), ++track_count, list.size());
     if (debug_->config().options & BACKTRACE) {
-      BacktraceHeader* back_header = debug_->GetAllocBacktrace(header);
-      if (back_header->num_frames > 0) {
+      std::vector<uintptr_t> frames(debug_->config().backtrace_frames);
+      size_t num_frames = debug_->backtrace->GetFrames(header->backtrace_id, frames.data(),
+                                                       frames.size());
+      if (num_frames > 0) {
         error_log("Backtrace at time of allocation:");
-        backtrace_log(&back_header->frames[0], back_header->num_frames);
+        backtrace_log(frames.data(), num_frames);
       }
     }
     g_dispatch->free(header->orig_pointer);
@@ -105,33 +170,50 @@ void TrackData::DisplayLeaks() {
 
 void TrackData::GetInfo(uint8_t** info, size_t* overall_size, size_t* info_size,
                         size_t* total_memory, size_t* backtrace_size) {
-  ScopedPthreadMutexLocker scoped(&mutex_);
+  // Lock order: the TrackData shards, then the backtrace table.
+  LockAll();
+  debug_->backtrace->LockAll();
+  GetInfoLocked(info, overall_size, info_size, total_memory, backtrace_size);
+  debug_->backtrace->UnlockAll();
+  UnlockAll();
+}
 
-  if (headers_.size() == 0 || total_backtrace_allocs_ == 0) {
+void TrackData::GetInfoLocked(uint8_t** info, size_t* overall_size, size_t* info_size,
+                              size_t* total_memory, size_t* backtrace_size) {
+  size_t total_backtrace_allocs = total_backtrace_allocs_.load(std::memory_order_relaxed);
+  if (total_backtrace_allocs == 0) {
     return;
   }
 
   *backtrace_size = debug_->config().backtrace_frames;
   *info_size = sizeof(size_t) * 2 + sizeof(uintptr_t) * *backtrace_size;
-  *info = reinterpret_cast<uint8_t*>(g_dispatch->calloc(*info_size, total_backtrace_allocs_));
+  *info = reinterpret_cast<uint8_t*>(g_dispatch->calloc(*info_size, total_backtrace_allocs));
   if (*info == nullptr) {
     return;
   }
-  *overall_size = *info_size * total_backtrace_allocs_;
+  *overall_size = *info_size * total_backtrace_allocs;
 
   std::vector<const Header*> list;
   GetList(&list);
 
   uint8_t* data = *info;
   for (const auto& header : list) {
-    BacktraceHeader* back_header = debug_->GetAllocBacktrace(header);
-    if (back_header->num_frames > 0) {
-      memcpy(data, &header->size, sizeof(size_t));
-      memcpy(&data[sizeof(size_t)], &back_header->num_frames, sizeof(size_t));
-      memcpy(&data[2 * sizeof(size_t)], &back_header->frames[0],
-            back_header->num_frames * sizeof(uintptr_t));
-
-      *total_memory += header->real_size();
+    const uintptr_t* frames;
+    size_t num_frames = debug_->backtrace->GetFramesLocked(header->backtrace_id, &frames);
+    if (num_frames > 0) {
+      // When only a sample of the allocations has a backtrace, report
+      // each of them as the estimated amount of memory it represents.
+      size_t real_size = debug_->backtrace->ScaledSize(header->real_size());
+      size_t size = header->size;
+      if (debug_->backtrace->sampling()) {
+        size = (header->size & ~Header::max_size()) |
+            (real_size > Header::max_size() ? Header::max_size() : real_size);
+      }
+      memcpy(data, &size, sizeof(size_t));
+      memcpy(&data[sizeof(size_t)], &num_frames, sizeof(size_t));
+      memcpy(&data[2 * sizeof(size_t)], frames, num_frames * sizeof(uintptr_t));
+
+      *total_memory += real_size;
 
       data += *info_size;
     }
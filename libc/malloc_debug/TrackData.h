@@ -32,6 +32,7 @@
 #include <stdint.h>
 #include <pthread.h>
 
+#include <atomic>
 #include <vector>
 #include <unordered_set>
 
@@ -62,14 +63,36 @@ class TrackData : public OptionData {
 
   void DisplayLeaks();
 
-  void PrepareFork() { pthread_mutex_lock(&mutex_); }
-  void PostForkParent() { pthread_mutex_unlock(&mutex_); }
-  void PostForkChild() { pthread_mutex_init(&mutex_, NULL); }
+  void PrepareFork();
+  void PostForkParent();
+  void PostForkChild();
 
  private:
-  pthread_mutex_t mutex_ = PTHREAD_MUTEX_INITIALIZER;
-  std::unordered_set<const Header*> headers_;
-  size_t total_backtrace_allocs_ = 0;
+  // Live allocations are spread over independently locked shards by
+  // header address so that threads allocating at the same time rarely
+  // contend. Anything that needs all of them takes every shard lock,
+  // always in the same order.
+  static constexpr size_t kShardBits = 6;
+  static constexpr size_t kShards = 1 << kShardBits;
+
+  struct Shard {
+    pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+    // Set, under activate_mutex_, before the first header is added. fork
+    // only has to lock the shards that have ever held anything.
+    std::atomic<bool> active{false};
+    std::unordered_set<const Header*> headers;
+  };
+
+  Shard& GetShard(const Header* header);
+  void Activate(Shard& shard);
+  void GetInfoLocked(uint8_t** info, size_t* overall_size, size_t* info_size,
+                     size_t* total_memory, size_t* backtrace_size);
+  void LockAll();
+  void UnlockAll();
+
+  Shard shards_[kShards];
+  pthread_mutex_t activate_mutex_ = PTHREAD_MUTEX_INITIALIZER;
+  std::atomic<size_t> total_backtrace_allocs_{0};
 
   DISALLOW_COPY_AND_ASSIGN(TrackData);
 };
@@ -36,10 +36,14 @@
 #include <unistd.h>
 #include <unwind.h>
 
+#include <vector>
+
 #include "backtrace.h"
 #include "debug_log.h"
 #include "MapData.h"
 
+#include "bionic/pthread_internal.h"
+
 #if defined(__LP64__)
 #define PAD_PTR "016" PRIxPTR
 #else
@@ -63,8 +67,36 @@ static _Unwind_Reason_Code find_current_map(__unwind_context* context, void*) {
   return _URC_END_OF_STACK;
 }
 
-void backtrace_startup() {
+// Set by backtrace_startup for the main thread, whose pthread_internal_t doesn't record its stack.
+static pthread_internal_t* g_main_thread = nullptr;
+static uintptr_t g_main_stack_base = 0;
+static uintptr_t g_main_stack_top = 0;
+
+static bool g_frame_pointers = false;
+
+void backtrace_startup(bool frame_pointers) {
   _Unwind_Backtrace(find_current_map, nullptr);
+
+#if defined(__aarch64__) || defined(__i386__) || defined(__x86_64__)
+  g_frame_pointers = frame_pointers;
+  if (g_frame_pointers && gettid() == getpid()) {
+    // pthread_getattr_np reads /proc/self/maps for the main thread, so only do it once.
+    pthread_attr_t attr;
+    void* stack_base;
+    size_t stack_size;
+    if (pthread_getattr_np(pthread_self(), &attr) == 0) {
+      if (pthread_attr_getstack(&attr, &stack_base, &stack_size) == 0) {
+        g_main_thread = __get_thread();
+        g_main_stack_base = reinterpret_cast<uintptr_t>(stack_base);
+        g_main_stack_top = g_main_stack_base + stack_size;
+      }
+      pthread_attr_destroy(&attr);
+    }
+  }
+#else
+  // There's no frame record layout the compilers agree on for arm and mips.
+  (void) frame_pointers;
+#endif
 }
 
 void backtrace_shutdown() {
@@ -79,44 +111,50 @@ struct stack_crawl_state_t {
       : frames(frames), frame_count(frame_count) {}
 };
 
-static _Unwind_Reason_Code trace_function(__unwind_context* context, void* arg) {
-  stack_crawl_state_t* state = static_cast<stack_crawl_state_t*>(arg);
-
-  uintptr_t ip = _Unwind_GetIP(context);
-
-  // The instruction pointer is pointing at the instruction after the return
-  // call on all architectures.
-  // Modify the pc to point at the real function.
-  if (ip != 0) {
+// The return address is the instruction after the call on all architectures.
+// Returns an address inside the call instruction itself.
+static uintptr_t adjust_pc(uintptr_t ip) {
 #if defined(__arm__)
-    // If the ip is suspiciously low, do nothing to avoid a segfault trying
-    // to access this memory.
-    if (ip >= 4096) {
-      // Check bits [15:11] of the first halfword assuming the instruction
-      // is 32 bits long. If the bits are any of these values, then our
-      // assumption was correct:
-      //  b11101
-      //  b11110
-      //  b11111
-      // Otherwise, this is a 16 bit instruction.
-      uint16_t value = (*reinterpret_cast<uint16_t*>(ip - 2)) >> 11;
-      if (value == 0x1f || value == 0x1e || value == 0x1d) {
-        ip -= 4;
-      } else {
-        ip -= 2;
-      }
+  // If the ip is suspiciously low, do nothing to avoid a segfault trying
+  // to access this memory.
+  if (ip >= 4096) {
+    // Check bits [15:11] of the first halfword assuming the instruction
+    // is 32 bits long. If the bits are any of these values, then our
+    // assumption was correct:
+    //  b11101
+    //  b11110
+    //  b11111
+    // Otherwise, this is a 16 bit instruction.
+    uint16_t value = (*reinterpret_cast<uint16_t*>(ip - 2)) >> 11;
+    if (value == 0x1f || value == 0x1e || value == 0x1d) {
+      ip -= 4;
+    } else {
+      ip -= 2;
     }
+  }
 #elif defined(__aarch64__)
-    // All instructions are 4 bytes long, skip back one instruction.
-    ip -= 4;
+  // All instructions are 4 bytes long, skip back one instruction.
+  ip -= 4;
 #elif defined(__i386__) || defined(__x86_64__)
-    // It's difficult to decode exactly where the previous instruction is,
-    // so subtract 1 to estimate where the instruction lives.
-    ip--;
+  // It's difficult to decode exactly where the previous instruction is,
+  // so subtract 1 to estimate where the instruction lives.
+  ip--;
 #endif
+  return ip;
+}
 
-    // Do not record the frames that fall in our own shared library.
-    if (g_current_code_map && (ip >= g_current_code_map->start) && ip < g_current_code_map->end) {
+// Do not record the frames that fall in our own shared library.
+static bool in_current_code_map(uintptr_t ip) {
+  return g_current_code_map && (ip >= g_current_code_map->start) && ip < g_current_code_map->end;
+}
+
+static _Unwind_Reason_Code trace_function(__unwind_context* context, void* arg) {
+  stack_crawl_state_t* state = static_cast<stack_crawl_state_t*>(arg);
+
+  uintptr_t ip = _Unwind_GetIP(context);
+  if (ip != 0) {
+    ip = adjust_pc(ip);
+    if (in_current_code_map(ip)) {
       return _URC_NO_REASON;
     }
   }
@@ -125,7 +163,63 @@ static _Unwind_Reason_Code trace_function(__unwind_context* context, void* arg)
   return (state->cur_frame >= state->frame_count) ? _URC_END_OF_STACK : _URC_NO_REASON;
 }
 
+// Each frame record is the caller's frame pointer followed by the return address, and the
+// caller's record is always higher up the stack. Every record read has to lie between our own
+// frame and the top of this thread's stack, so garbage left in the frame pointer register by code
+// built without frame pointers ends the walk rather than faulting. Returns -1 if our own frame
+// isn't on this thread's stack (we're on an alternate signal stack, say).
+static ssize_t frame_pointer_backtrace(uintptr_t* frames, size_t frame_count) {
+  pthread_internal_t* thread = __get_thread();
+  if (thread == nullptr) {
+    return -1;
+  }
+  uintptr_t stack_base;
+  uintptr_t stack_top;
+  if (thread == g_main_thread) {
+    stack_base = g_main_stack_base;
+    stack_top = g_main_stack_top;
+  } else {
+    stack_base = reinterpret_cast<uintptr_t>(thread->attr.stack_base);
+    stack_top = stack_base + thread->attr.stack_size;
+  }
+
+  uintptr_t fp = reinterpret_cast<uintptr_t>(__builtin_frame_address(0));
+  if (fp < stack_base || fp >= stack_top) {
+    return -1;
+  }
+
+  size_t cur_frame = 0;
+  while (cur_frame < frame_count) {
+    if ((fp & (sizeof(uintptr_t) - 1)) != 0 || stack_top - fp < 2 * sizeof(uintptr_t)) {
+      break;
+    }
+    const uintptr_t* record = reinterpret_cast<const uintptr_t*>(fp);
+    uintptr_t ip = record[1];
+    if (ip == 0) {
+      break;
+    }
+    ip = adjust_pc(ip);
+    if (!in_current_code_map(ip)) {
+      frames[cur_frame++] = ip;
+    }
+
+    uintptr_t next_fp = record[0];
+    if (next_fp <= fp) {
+      break;
+    }
+    fp = next_fp;
+  }
+  return cur_frame;
+}
+
 size_t backtrace_get(uintptr_t* frames, size_t frame_count) {
+  if (g_frame_pointers) {
+    ssize_t frame_num = frame_pointer_backtrace(frames, frame_count);
+    if (frame_num >= 0) {
+      return frame_num;
+    }
+  }
+
   stack_crawl_state_t state(frames, frame_count);
   _Unwind_Backtrace(trace_function, &state);
   return state.cur_frame;
@@ -134,6 +228,11 @@ size_t backtrace_get(uintptr_t* frames, size_t frame_count) {
 std::string backtrace_string(const uintptr_t* frames, size_t frame_count) {
   std::string str;
 
+  // Look up all the frames' maps at once, so that the maps are read at most once per backtrace.
+  std::vector<const MapEntry*> entries(frame_count);
+  std::vector<uintptr_t> rel_pcs(frame_count);
+  g_map_data.find(frames, frame_count, entries.data(), rel_pcs.data());
+
   for (size_t frame_num = 0; frame_num < frame_count; frame_num++) {
     uintptr_t offset = 0;
     const char* symbol = nullptr;
@@ -144,8 +243,8 @@ std::string backtrace_string(const uintptr_t* frames, size_t frame_count) {
       symbol = info.dli_sname;
     }
 
-    uintptr_t rel_pc = offset;
-    const MapEntry* entry = g_map_data.find(frames[frame_num], &rel_pc);
+    const MapEntry* entry = entries[frame_num];
+    uintptr_t rel_pc = (entry != nullptr) ? rel_pcs[frame_num] : offset;
 
     const char* soname = (entry != nullptr) ? entry->name.c_str() : info.dli_fname;
     if (soname == nullptr) {
@@ -34,7 +34,7 @@
 
 #include <string>
 
-void backtrace_startup();
+void backtrace_startup(bool frame_pointers);
 void backtrace_shutdown();
 size_t backtrace_get(uintptr_t* frames, size_t frame_count);
 void backtrace_log(const uintptr_t* frames, size_t frame_count);
@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef DEBUG_MALLOC_FILL_CHECK_H
+#define DEBUG_MALLOC_FILL_CHECK_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Returns true if all size bytes starting at data equal value. This is what checking a guard or
+// a freed allocation's fill comes down to, so rather than memcmp against a buffer of the expected
+// bytes (which reads twice as much memory), it compares 128 bytes at a time against the value
+// using 16-byte vectors (NEON or SSE2), and only branches once per 128 bytes.
+static inline bool all_bytes_equal(const void* data, size_t size, uint8_t value) {
+  typedef uint64_t vec_t __attribute__((__vector_size__(16), __may_alias__));
+
+  const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data);
+  while (size > 0 && (reinterpret_cast<uintptr_t>(bytes) & (sizeof(vec_t) - 1)) != 0) {
+    if (*bytes++ != value) {
+      return false;
+    }
+    size--;
+  }
+
+  const uint64_t word = value * 0x0101010101010101ULL;
+  const vec_t pattern = { word, word };
+  const vec_t* vecs = reinterpret_cast<const vec_t*>(bytes);
+  while (size >= 8 * sizeof(vec_t)) {
+    vec_t diff = (vecs[0] ^ pattern) | (vecs[1] ^ pattern) | (vecs[2] ^ pattern) |
+                 (vecs[3] ^ pattern) | (vecs[4] ^ pattern) | (vecs[5] ^ pattern) |
+                 (vecs[6] ^ pattern) | (vecs[7] ^ pattern);
+    if ((diff[0] | diff[1]) != 0) {
+      return false;
+    }
+    vecs += 8;
+    size -= 8 * sizeof(vec_t);
+  }
+
+  bytes = reinterpret_cast<const uint8_t*>(vecs);
+  while (size > 0) {
+    if (*bytes++ != value) {
+      return false;
+    }
+    size--;
+  }
+  return true;
+}
+
+#endif // DEBUG_MALLOC_FILL_CHECK_H
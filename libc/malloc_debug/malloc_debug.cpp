@@ -72,6 +72,7 @@ void debug_free_malloc_leak_info(uint8_t* info);
 size_t debug_malloc_usable_size(void* pointer);
 void* debug_malloc(size_t size);
 void debug_free(void* pointer);
+void debug_free_sized(void* pointer, size_t bytes);
 void* debug_memalign(size_t alignment, size_t bytes);
 void* debug_realloc(void* pointer, size_t bytes);
 void* debug_calloc(size_t nmemb, size_t bytes);
@@ -81,6 +82,12 @@ int debug_iterate(uintptr_t base, size_t size,
     void (*callback)(uintptr_t base, size_t size, void* arg), void* arg);
 void debug_malloc_disable();
 void debug_malloc_enable();
+int debug_heap_create();
+void* debug_heap_malloc(int heap, size_t size);
+void debug_heap_free(int heap, void* pointer);
+int debug_heap_destroy(int heap);
+int debug_mallopt(int option, int value);
+int debug_malloc_trim(size_t pad);
 
 #if defined(HAVE_DEPRECATED_MALLOC_FUNCS)
 void* debug_pvalloc(size_t bytes);
@@ -159,17 +166,14 @@ static void* InitHeader(Header* header, void* orig_pointer, size_t size) {
     header->usable_size = header->real_size();
   }
 
-  bool backtrace_found = false;
-  if (g_debug->config().options & BACKTRACE) {
-    BacktraceHeader* back_header = g_debug->GetAllocBacktrace(header);
-    if (g_debug->backtrace->enabled()) {
-      back_header->num_frames = backtrace_get(
-          &back_header->frames[0], g_debug->config().backtrace_frames);
-      backtrace_found = back_header->num_frames > 0;
-    } else {
-      back_header->num_frames = 0;
-    }
+  header->backtrace_id = 0;
+  if ((g_debug->config().options & BACKTRACE) && g_debug->backtrace->enabled() &&
+      g_debug->backtrace->ShouldSample(size)) {
+    std::vector<uintptr_t> frames(g_debug->config().backtrace_frames);
+    size_t num_frames = backtrace_get(frames.data(), frames.size());
+    header->backtrace_id = g_debug->backtrace->Add(frames.data(), num_frames);
   }
+  bool backtrace_found = header->backtrace_id != 0;
 
   if (g_debug->config().options & TRACK_ALLOCS) {
     g_debug->track->Add(header, backtrace_found);
@@ -203,7 +207,7 @@ bool debug_initialize(const MallocDispatch* malloc_dispatch, int* malloc_zygote_
 
   // Always enable the backtrace code since we will use it in a number
   // of different error cases.
-  backtrace_startup();
+  backtrace_startup(g_debug->config().backtrace_frame_pointers);
 
   return true;
 }
@@ -331,7 +335,7 @@ void* debug_malloc(size_t size) {
   void* pointer = internal_malloc(size);
 
   if (g_debug->config().options & RECORD_ALLOCS) {
-    g_debug->record->AddEntry(new MallocEntry(pointer, size));
+    g_debug->record->AddMalloc(pointer, size);
   }
 
   return pointer;
@@ -361,12 +365,11 @@ static void internal_free(void* pointer) {
     }
 
     if (g_debug->config().options & TRACK_ALLOCS) {
-      bool backtrace_found = false;
-      if (g_debug->config().options & BACKTRACE) {
-        BacktraceHeader* back_header = g_debug->GetAllocBacktrace(header);
-        backtrace_found = back_header->num_frames > 0;
-      }
-      g_debug->track->Remove(header, backtrace_found);
+      g_debug->track->Remove(header, header->backtrace_id != 0);
+    }
+    if (g_debug->config().options & BACKTRACE) {
+      g_debug->backtrace->Remove(header->backtrace_id);
+      header->backtrace_id = 0;
     }
     header->tag = DEBUG_FREE_TAG;
 
@@ -400,9 +403,58 @@ void debug_free(void* pointer) {
   ScopedDisableDebugCalls disable;
 
   if (g_debug->config().options & RECORD_ALLOCS) {
-    g_debug->record->AddEntry(new FreeEntry(pointer));
+    g_debug->record->AddFree(pointer);
+  }
+
+  internal_free(pointer);
+}
+
+static void VerifyFreeSize(void* pointer, size_t bytes) {
+  size_t size;
+  size_t slack = 0;
+  if (g_debug->need_header()) {
+    Header* header = g_debug->GetHeader(pointer);
+    if (header->tag != DEBUG_TAG) {
+      // internal_free reports this.
+      return;
+    }
+    size = header->real_size();
+    if (g_debug->config().options & EXPAND_ALLOC) {
+      // A realloc adds the expand bytes to the recorded size.
+      slack = g_debug->config().expand_alloc_bytes;
+    }
+  } else {
+    // Without a header, all that is known is that the size fit.
+    size = g_dispatch->malloc_usable_size(pointer);
+    slack = size;
+  }
+  // A zero size allocation is recorded as one byte.
+  size_t freed_size = (bytes == 0) ? 1 : bytes;
+  if (freed_size <= size && size - freed_size <= slack) {
+    return;
+  }
+
+  error_log(LOG_DIVIDER);
+  error_log("+++ ALLOCATION %p SIZE %zu FREED WITH SIZE %zu (free_sized)", pointer, size, bytes);
+  error_log("Backtrace at time of failure:");
+  std::vector<uintptr_t> frames(64);
+  size_t frame_num = backtrace_get(frames.data(), frames.size());
+  frames.resize(frame_num);
+  backtrace_log(frames.data(), frames.size());
+  error_log(LOG_DIVIDER);
+}
+
+void debug_free_sized(void* pointer, size_t bytes) {
+  if (DebugCallsDisabled() || pointer == nullptr) {
+    return g_dispatch->free_sized(pointer, bytes);
+  }
+  ScopedDisableDebugCalls disable;
+
+  if (g_debug->config().options & RECORD_ALLOCS) {
+    g_debug->record->AddFree(pointer);
   }
 
+  VerifyFreeSize(pointer, bytes);
   internal_free(pointer);
 }
 
@@ -472,7 +524,7 @@ void* debug_memalign(size_t alignment, size_t bytes) {
   }
 
   if (g_debug->config().options & RECORD_ALLOCS) {
-    g_debug->record->AddEntry(new MemalignEntry(pointer, bytes, alignment));
+    g_debug->record->AddMemalign(pointer, alignment, bytes);
   }
 
   return pointer;
@@ -487,14 +539,14 @@ void* debug_realloc(void* pointer, size_t bytes) {
   if (pointer == nullptr) {
     pointer = internal_malloc(bytes);
     if (g_debug->config().options & RECORD_ALLOCS) {
-      g_debug->record->AddEntry(new ReallocEntry(pointer, bytes, nullptr));
+      g_debug->record->AddRealloc(pointer, nullptr, bytes);
     }
     return pointer;
   }
 
   if (bytes == 0) {
     if (g_debug->config().options & RECORD_ALLOCS) {
-      g_debug->record->AddEntry(new ReallocEntry(nullptr, bytes, pointer));
+      g_debug->record->AddRealloc(nullptr, pointer, bytes);
     }
 
     internal_free(pointer);
@@ -578,7 +630,7 @@ void* debug_realloc(void* pointer, size_t bytes) {
   }
 
   if (g_debug->config().options & RECORD_ALLOCS) {
-    g_debug->record->AddEntry(new ReallocEntry(new_pointer, bytes, pointer));
+    g_debug->record->AddRealloc(new_pointer, pointer, bytes);
   }
 
   return new_pointer;
@@ -628,7 +680,7 @@ void* debug_calloc(size_t nmemb, size_t bytes) {
     pointer = g_dispatch->calloc(1, real_size);
   }
   if (g_debug->config().options & RECORD_ALLOCS) {
-    g_debug->record->AddEntry(new CallocEntry(pointer, bytes, nmemb));
+    g_debug->record->AddCalloc(pointer, nmemb, bytes);
   }
   return pointer;
 }
@@ -694,6 +746,39 @@ void debug_malloc_enable() {
   g_dispatch->malloc_enable();
 }
 
+// Heap allocations are made like any other so that every option applies
+// to them. The heap itself is still created, so that its id is checked by
+// heap_destroy, but nothing is allocated from it.
+int debug_heap_create() {
+  return g_dispatch->heap_create();
+}
+
+void* debug_heap_malloc(int heap, size_t size) {
+  if (heap < 0) {
+    errno = EINVAL;
+    return nullptr;
+  }
+  return debug_malloc(size);
+}
+
+void debug_heap_free(int, void* pointer) {
+  debug_free(pointer);
+}
+
+int debug_heap_destroy(int heap) {
+  return g_dispatch->heap_destroy(heap);
+}
+
+// Allocations held in the free_track queue stay allocated, so they are not
+// released by either of these.
+int debug_mallopt(int option, int value) {
+  return g_dispatch->mallopt(option, value);
+}
+
+int debug_malloc_trim(size_t pad) {
+  return g_dispatch->malloc_trim(pad);
+}
+
 ssize_t debug_malloc_backtrace(void* pointer, uintptr_t* frames, size_t frame_count) {
   if (DebugCallsDisabled() || pointer == nullptr) {
     return 0;
@@ -714,14 +799,7 @@ ssize_t debug_malloc_backtrace(void* pointer, uintptr_t* frames, size_t frame_co
       return 0;
     }
     if (g_debug->config().options & BACKTRACE) {
-      BacktraceHeader* back_header = g_debug->GetAllocBacktrace(header);
-      if (back_header->num_frames > 0) {
-        if (frame_count > back_header->num_frames) {
-          frame_count = back_header->num_frames;
-        }
-        memcpy(frames, &back_header->frames[0], frame_count * sizeof(uintptr_t));
-        return frame_count;
-      }
+      return g_debug->backtrace->GetFrames(header->backtrace_id, frames, frame_count);
     }
   }
 
@@ -38,12 +38,13 @@
 // part of the header does not exist, the other parts of the header
 // will still be in this order.
 //   Header          (Required)
-//   BacktraceHeader (Optional: For the allocation backtrace)
 //   uint8_t data    (Optional: Front guard, will be a multiple of MINIMUM_ALIGNMENT_BYTES)
 //   allocation data
 //   uint8_t data    (Optional: End guard)
 //
-// If backtracing is enabled, then both BacktraceHeaders will be present.
+// If backtracing is enabled, the allocation backtrace is kept in a table
+// shared by all allocations with the same backtrace and the header only
+// holds its id (see BacktraceData).
 //
 // In the initialization function, offsets into the header will be set
 // for each different header location. The offsets are always from the
@@ -53,6 +54,7 @@ struct Header {
   void* orig_pointer;
   size_t size;
   size_t usable_size;
+  uint32_t backtrace_id;
   size_t real_size() const { return size & ~(1U << 31); }
   void set_zygote() { size |= 1U << 31; }
   static size_t max_size() { return (1U << 31) - 1; }
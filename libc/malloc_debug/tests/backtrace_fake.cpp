@@ -34,7 +34,7 @@ void backtrace_fake_add(const std::vector<uintptr_t>& ips) {
   g_fake_backtrace.push_back(ips);
 }
 
-void backtrace_startup() {
+void backtrace_startup(bool) {
 }
 
 void backtrace_shutdown() {
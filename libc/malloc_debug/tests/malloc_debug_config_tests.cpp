@@ -74,6 +74,18 @@ std::string usage_string(
   "6 malloc_debug     receives a signal. If XX is set it sets the number of backtrace\n"
   "6 malloc_debug     frames. The default is 16 frames, the max number of frames is 256.\n"
   "6 malloc_debug \n"
+  "6 malloc_debug   backtrace_sample_bytes[=XX]\n"
+  "6 malloc_debug     This option only has meaning if backtrace or backtrace_enable_on_signal\n"
+  "6 malloc_debug     is set. Instead of capturing a backtrace for every allocation, capture\n"
+  "6 malloc_debug     one on average every XX allocated bytes. Leak reports scale the sampled\n"
+  "6 malloc_debug     allocations to estimate the total. The default is 524288 bytes, the max\n"
+  "6 malloc_debug     bytes is 1073741824.\n"
+  "6 malloc_debug \n"
+  "6 malloc_debug   backtrace_frame_pointers\n"
+  "6 malloc_debug     Walk the chain of frame pointers to capture backtraces instead of\n"
+  "6 malloc_debug     unwinding. Much faster, but only complete if the code on the stack\n"
+  "6 malloc_debug     was built with frame pointers. Only supported on arm64, x86 and x86_64.\n"
+  "6 malloc_debug \n"
   "6 malloc_debug   fill_on_alloc[=XX]\n"
   "6 malloc_debug     On first allocation, fill with the value 0xeb.\n"
   "6 malloc_debug     If XX is set it will only fill up to XX bytes of the\n"
@@ -111,6 +123,25 @@ std::string usage_string(
   "6 malloc_debug     is set to zero, then no backtrace will be captured.\n"
   "6 malloc_debug     The default is to record 16 frames, the max number of frames is 256.\n"
   "6 malloc_debug \n"
+  "6 malloc_debug   free_track_verify_sample[=XX]\n"
+  "6 malloc_debug     This option only has meaning if free_track is set. Only one in XX\n"
+  "6 malloc_debug     of the allocations leaving the list is verified, so that free\n"
+  "6 malloc_debug     stays cheap with a large list. Everything left on the list is\n"
+  "6 malloc_debug     still verified when the program terminates. The default is 16,\n"
+  "6 malloc_debug     the max is 65536.\n"
+  "6 malloc_debug \n"
+  "6 malloc_debug   free_track_bytes[=XX]\n"
+  "6 malloc_debug     This option only has meaning if free_track is set. Keep freed\n"
+  "6 malloc_debug     allocations on one of four lists by size, and limit the memory\n"
+  "6 malloc_debug     held by all of the lists to XX bytes. Each list still keeps at\n"
+  "6 malloc_debug     most the number of allocations set by free_track. The default\n"
+  "6 malloc_debug     is 67108864 bytes, the max bytes is 1073741824.\n"
+  "6 malloc_debug \n"
+  "6 malloc_debug   free_track_async\n"
+  "6 malloc_debug     This option only has meaning if free_track is set. Allocations\n"
+  "6 malloc_debug     that leave the list are verified and freed in batches by a low\n"
+  "6 malloc_debug     priority thread, instead of by the thread calling free.\n"
+  "6 malloc_debug \n"
   "6 malloc_debug   leak_track\n"
   "6 malloc_debug     Enable the leak tracking of memory allocations.\n"
   "6 malloc_debug \n"
@@ -126,6 +157,10 @@ std::string usage_string(
   "6 malloc_debug     This option only has meaning if the record_allocs options has been specified.\n"
   "6 malloc_debug     This is the name of the file to which recording information will be dumped.\n"
   "6 malloc_debug     The default is /data/local/tmp/record_allocs.txt.\n"
+  "6 malloc_debug \n"
+  "6 malloc_debug   record_allocs_binary\n"
+  "6 malloc_debug     This option only has meaning if the record_allocs options has been specified.\n"
+  "6 malloc_debug     The records are written in a compact binary format instead of as text.\n"
 );
 
 TEST_F(MallocDebugConfigTest, unknown_option) {
@@ -318,6 +353,36 @@ TEST_F(MallocDebugConfigTest, backtrace_enable_on_signal) {
   ASSERT_STREQ("", getFakeLogPrint().c_str());
 }
 
+TEST_F(MallocDebugConfigTest, backtrace_sample_bytes) {
+  ASSERT_TRUE(InitConfig("backtrace backtrace_sample_bytes=4096")) << getFakeLogPrint();
+  ASSERT_EQ(BACKTRACE | TRACK_ALLOCS, config->options);
+  ASSERT_TRUE(config->backtrace_sampling);
+  ASSERT_EQ(4096U, config->backtrace_sample_bytes);
+
+  ASSERT_TRUE(InitConfig("backtrace backtrace_sample_bytes")) << getFakeLogPrint();
+  ASSERT_EQ(BACKTRACE | TRACK_ALLOCS, config->options);
+  ASSERT_TRUE(config->backtrace_sampling);
+  ASSERT_EQ(524288U, config->backtrace_sample_bytes);
+
+  ASSERT_TRUE(InitConfig("backtrace")) << getFakeLogPrint();
+  ASSERT_FALSE(config->backtrace_sampling);
+
+  ASSERT_STREQ("", getFakeLogBuf().c_str());
+  ASSERT_STREQ("", getFakeLogPrint().c_str());
+}
+
+TEST_F(MallocDebugConfigTest, backtrace_frame_pointers) {
+  ASSERT_TRUE(InitConfig("backtrace backtrace_frame_pointers")) << getFakeLogPrint();
+  ASSERT_EQ(BACKTRACE | TRACK_ALLOCS, config->options);
+  ASSERT_TRUE(config->backtrace_frame_pointers);
+
+  ASSERT_TRUE(InitConfig("backtrace")) << getFakeLogPrint();
+  ASSERT_FALSE(config->backtrace_frame_pointers);
+
+  ASSERT_STREQ("", getFakeLogBuf().c_str());
+  ASSERT_STREQ("", getFakeLogPrint().c_str());
+}
+
 TEST_F(MallocDebugConfigTest, fill_on_alloc) {
   ASSERT_TRUE(InitConfig("fill_on_alloc=64")) << getFakeLogPrint();
   ASSERT_EQ(FILL_ON_ALLOC, config->options);
@@ -430,6 +495,52 @@ TEST_F(MallocDebugConfigTest, free_track_backtrace_num_frames_zero) {
   ASSERT_STREQ("", getFakeLogPrint().c_str());
 }
 
+TEST_F(MallocDebugConfigTest, free_track_verify_sample) {
+  ASSERT_TRUE(InitConfig("free_track free_track_verify_sample=100")) << getFakeLogPrint();
+  ASSERT_EQ(FREE_TRACK | FILL_ON_FREE, config->options);
+  ASSERT_TRUE(config->free_track_verify_sampling);
+  ASSERT_EQ(100U, config->free_track_verify_sample);
+
+  ASSERT_TRUE(InitConfig("free_track free_track_verify_sample")) << getFakeLogPrint();
+  ASSERT_TRUE(config->free_track_verify_sampling);
+  ASSERT_EQ(16U, config->free_track_verify_sample);
+
+  ASSERT_TRUE(InitConfig("free_track")) << getFakeLogPrint();
+  ASSERT_FALSE(config->free_track_verify_sampling);
+
+  ASSERT_STREQ("", getFakeLogBuf().c_str());
+  ASSERT_STREQ("", getFakeLogPrint().c_str());
+}
+
+TEST_F(MallocDebugConfigTest, free_track_bytes) {
+  ASSERT_TRUE(InitConfig("free_track free_track_bytes=1048576")) << getFakeLogPrint();
+  ASSERT_EQ(FREE_TRACK | FILL_ON_FREE, config->options);
+  ASSERT_TRUE(config->free_track_byte_limit);
+  ASSERT_EQ(1048576U, config->free_track_bytes);
+
+  ASSERT_TRUE(InitConfig("free_track free_track_bytes")) << getFakeLogPrint();
+  ASSERT_TRUE(config->free_track_byte_limit);
+  ASSERT_EQ(67108864U, config->free_track_bytes);
+
+  ASSERT_TRUE(InitConfig("free_track")) << getFakeLogPrint();
+  ASSERT_FALSE(config->free_track_byte_limit);
+
+  ASSERT_STREQ("", getFakeLogBuf().c_str());
+  ASSERT_STREQ("", getFakeLogPrint().c_str());
+}
+
+TEST_F(MallocDebugConfigTest, free_track_async) {
+  ASSERT_TRUE(InitConfig("free_track free_track_async")) << getFakeLogPrint();
+  ASSERT_EQ(FREE_TRACK | FILL_ON_FREE, config->options);
+  ASSERT_TRUE(config->free_track_async);
+
+  ASSERT_TRUE(InitConfig("free_track")) << getFakeLogPrint();
+  ASSERT_FALSE(config->free_track_async);
+
+  ASSERT_STREQ("", getFakeLogBuf().c_str());
+  ASSERT_STREQ("", getFakeLogPrint().c_str());
+}
+
 TEST_F(MallocDebugConfigTest, free_track_backtrace_num_frames_and_free_track) {
   ASSERT_TRUE(InitConfig("free_track free_track_backtrace_num_frames=123")) << getFakeLogPrint();
   ASSERT_EQ(FREE_TRACK | FILL_ON_FREE, config->options);
@@ -487,6 +598,18 @@ TEST_F(MallocDebugConfigTest, record_allocs_file) {
   ASSERT_STREQ("", getFakeLogPrint().c_str());
 }
 
+TEST_F(MallocDebugConfigTest, record_allocs_binary) {
+  ASSERT_TRUE(InitConfig("record_allocs record_allocs_binary")) << getFakeLogPrint();
+  ASSERT_EQ(RECORD_ALLOCS, config->options);
+  ASSERT_TRUE(config->record_allocs_binary);
+
+  ASSERT_TRUE(InitConfig("record_allocs")) << getFakeLogPrint();
+  ASSERT_FALSE(config->record_allocs_binary);
+
+  ASSERT_STREQ("", getFakeLogBuf().c_str());
+  ASSERT_STREQ("", getFakeLogPrint().c_str());
+}
+
 TEST_F(MallocDebugConfigTest, guard_min_error) {
   ASSERT_FALSE(InitConfig("guard=0"));
 
@@ -666,6 +789,16 @@ TEST_F(MallocDebugConfigTest, free_track_backtrace_num_frames_max_error) {
   ASSERT_STREQ((log_msg + usage_string).c_str(), getFakeLogPrint().c_str());
 }
 
+TEST_F(MallocDebugConfigTest, backtrace_sample_bytes_min_error) {
+  ASSERT_FALSE(InitConfig("backtrace backtrace_sample_bytes=0"));
+
+  ASSERT_STREQ("", getFakeLogBuf().c_str());
+  std::string log_msg(
+      "6 malloc_debug malloc_testing: bad value for option 'backtrace_sample_bytes', "
+      "value must be >= 1: 0\n");
+  ASSERT_STREQ((log_msg + usage_string).c_str(), getFakeLogPrint().c_str());
+}
+
 TEST_F(MallocDebugConfigTest, record_alloc_min_error) {
   ASSERT_FALSE(InitConfig("record_allocs=0"));
 
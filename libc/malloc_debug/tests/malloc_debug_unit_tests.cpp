@@ -14,6 +14,7 @@
  * limitations under the License.
  */
 
+#include <inttypes.h>
 #include <malloc.h>
 #include <signal.h>
 #include <stdlib.h>
@@ -21,9 +22,11 @@
 #include <sys/cdefs.h>
 #include <sys/param.h>
 #include <sys/types.h>
+#include <sys/wait.h>
 #include <unistd.h>
 
 #include <algorithm>
+#include <atomic>
 #include <thread>
 #include <vector>
 #include <utility>
@@ -38,6 +41,7 @@
 
 #include "Config.h"
 #include "malloc_debug.h"
+#include "RecordFormat.h"
 
 #include "log_fake.h"
 #include "backtrace_fake.h"
@@ -50,6 +54,7 @@ void debug_finalize();
 
 void* debug_malloc(size_t);
 void debug_free(void*);
+void debug_free_sized(void*, size_t);
 void* debug_calloc(size_t, size_t);
 void* debug_realloc(void*, size_t);
 int debug_posix_memalign(void**, size_t, size_t);
@@ -57,9 +62,18 @@ void* debug_memalign(size_t, size_t);
 size_t debug_malloc_usable_size(void*);
 void debug_get_malloc_leak_info(uint8_t**, size_t*, size_t*, size_t*, size_t*);
 void debug_free_malloc_leak_info(uint8_t*);
+ssize_t debug_malloc_backtrace(void*, uintptr_t*, size_t);
 
 struct mallinfo debug_mallinfo();
 
+int debug_heap_create();
+void* debug_heap_malloc(int, size_t);
+void debug_heap_free(int, void*);
+int debug_heap_destroy(int);
+
+int debug_mallopt(int, int);
+int debug_malloc_trim(size_t);
+
 #if defined(HAVE_DEPRECATED_MALLOC_FUNCS)
 void* debug_pvalloc(size_t);
 void* debug_valloc(size_t);
@@ -70,14 +84,8 @@ __END_DECLS
 constexpr char DIVIDER[] =
     "6 malloc_debug *** *** *** *** *** *** *** *** *** *** *** *** *** *** *** ***\n";
 
-constexpr uint32_t BACKTRACE_HEADER = 0x1;
-
-static size_t get_tag_offset(uint32_t flags = 0, size_t backtrace_frames = 0) {
-  size_t offset = BIONIC_ALIGN(sizeof(Header), MINIMUM_ALIGNMENT_BYTES);
-  if (flags & BACKTRACE_HEADER) {
-    offset += BIONIC_ALIGN(sizeof(BacktraceHeader) + sizeof(uintptr_t) * backtrace_frames, MINIMUM_ALIGNMENT_BYTES);
-  }
-  return offset;
+static size_t get_tag_offset() {
+  return BIONIC_ALIGN(sizeof(Header), MINIMUM_ALIGNMENT_BYTES);
 }
 
 static constexpr const char RECORD_ALLOCS_FILE[] = "/data/local/tmp/record_allocs.txt";
@@ -112,6 +120,26 @@ class MallocDebugTest : public ::testing::Test {
   static MallocDispatch dispatch;
 };
 
+static int fake_heap_create() {
+  return 1;
+}
+
+static int fake_heap_destroy(int heap) {
+  return heap == 1 ? 0 : -1;
+}
+
+static void fake_free_sized(void* pointer, size_t) {
+  free(pointer);
+}
+
+static int fake_mallopt(int option, int) {
+  return option == M_PURGE ? 1 : 0;
+}
+
+static int fake_malloc_trim(size_t) {
+  return 1;
+}
+
 MallocDispatch MallocDebugTest::dispatch = {
   calloc,
   free,
@@ -130,6 +158,13 @@ MallocDispatch MallocDebugTest::dispatch = {
   nullptr,
   nullptr,
   nullptr,
+  fake_heap_create,
+  nullptr,
+  nullptr,
+  fake_heap_destroy,
+  fake_free_sized,
+  fake_mallopt,
+  fake_malloc_trim,
 };
 
 void VerifyAllocCalls() {
@@ -480,6 +515,93 @@ TEST_F(MallocDebugTest, rear_guard_corrupted) {
   ASSERT_STREQ(expected_log.c_str(), getFakeLogPrint().c_str());
 }
 
+TEST_F(MallocDebugTest, free_sized) {
+  Init("guard");
+
+  void* pointer = debug_malloc(100);
+  ASSERT_TRUE(pointer != nullptr);
+  debug_free_sized(pointer, 100);
+
+  pointer = debug_malloc(0);
+  ASSERT_TRUE(pointer != nullptr);
+  debug_free_sized(pointer, 0);
+
+  ASSERT_STREQ("", getFakeLogBuf().c_str());
+  ASSERT_STREQ("", getFakeLogPrint().c_str());
+}
+
+TEST_F(MallocDebugTest, free_sized_wrong_size) {
+  Init("guard");
+
+  backtrace_fake_add(std::vector<uintptr_t> {0x100, 0x200});
+
+  void* pointer = debug_malloc(100);
+  ASSERT_TRUE(pointer != nullptr);
+  debug_free_sized(pointer, 64);
+
+  std::string expected_log(DIVIDER);
+  expected_log += android::base::StringPrintf(
+      "6 malloc_debug +++ ALLOCATION %p SIZE 100 FREED WITH SIZE 64 (free_sized)\n", pointer);
+  expected_log += "6 malloc_debug Backtrace at time of failure:\n";
+  expected_log += "6 malloc_debug   #00 pc 0x100\n";
+  expected_log += "6 malloc_debug   #01 pc 0x200\n";
+  expected_log += DIVIDER;
+
+  ASSERT_STREQ("", getFakeLogBuf().c_str());
+  ASSERT_STREQ(expected_log.c_str(), getFakeLogPrint().c_str());
+}
+
+TEST_F(MallocDebugTest, mallopt_malloc_trim) {
+  Init("guard");
+
+  ASSERT_EQ(1, debug_mallopt(M_PURGE, 0));
+  ASSERT_EQ(0, debug_mallopt(M_DECAY_TIME, 1));
+  ASSERT_EQ(1, debug_malloc_trim(0));
+
+  ASSERT_STREQ("", getFakeLogBuf().c_str());
+  ASSERT_STREQ("", getFakeLogPrint().c_str());
+}
+
+TEST_F(MallocDebugTest, free_sized_expand_alloc) {
+  Init("expand_alloc=16");
+
+  void* pointer = debug_malloc(100);
+  ASSERT_TRUE(pointer != nullptr);
+  pointer = debug_realloc(pointer, 200);
+  ASSERT_TRUE(pointer != nullptr);
+  debug_free_sized(pointer, 200);
+
+  ASSERT_STREQ("", getFakeLogBuf().c_str());
+  ASSERT_STREQ("", getFakeLogPrint().c_str());
+}
+
+TEST_F(MallocDebugTest, heap_rear_guard_corrupted) {
+  Init("rear_guard=32");
+
+  backtrace_fake_add(std::vector<uintptr_t> {0x100, 0x200, 0x300});
+
+  int heap = debug_heap_create();
+  ASSERT_EQ(1, heap);
+  uint8_t* pointer = reinterpret_cast<uint8_t*>(debug_heap_malloc(heap, 100));
+  ASSERT_TRUE(pointer != nullptr);
+  pointer[130] = 0xbf;
+  debug_heap_free(heap, pointer);
+  ASSERT_EQ(0, debug_heap_destroy(heap));
+
+  std::string expected_log(DIVIDER);
+  expected_log += android::base::StringPrintf(
+      "6 malloc_debug +++ ALLOCATION %p SIZE 100 HAS A CORRUPTED REAR GUARD\n", pointer);
+  expected_log += "6 malloc_debug   allocation[130] = 0xbf (expected 0xbb)\n";
+  expected_log += "6 malloc_debug Backtrace at time of failure:\n";
+  expected_log += "6 malloc_debug   #00 pc 0x100\n";
+  expected_log += "6 malloc_debug   #01 pc 0x200\n";
+  expected_log += "6 malloc_debug   #02 pc 0x300\n";
+  expected_log += DIVIDER;
+
+  ASSERT_STREQ("", getFakeLogBuf().c_str());
+  ASSERT_STREQ(expected_log.c_str(), getFakeLogPrint().c_str());
+}
+
 TEST_F(MallocDebugTest, rear_guard_corrupted_after_realloc_shrink) {
   Init("rear_guard=32");
 
@@ -692,6 +814,87 @@ TEST_F(MallocDebugTest, leak_track_frees) {
   ASSERT_STREQ(expected_log.c_str(), getFakeLogPrint().c_str());
 }
 
+TEST_F(MallocDebugTest, leak_track_multiple_thread) {
+  Init("leak_track");
+
+  std::vector<std::thread*> threads(100);
+  std::vector<void*> leaked(threads.size());
+  for (size_t i = 0; i < threads.size(); i++) {
+    threads[i] = new std::thread([&leaked, i](){
+      for (size_t j = 0; j < 100; j++) {
+        void* mem = debug_malloc(100);
+        write(0, mem, 0);
+        debug_free(mem);
+      }
+      leaked[i] = debug_malloc(1000 + i);
+    });
+  }
+  for (size_t i = 0; i < threads.size(); i++) {
+    threads[i]->join();
+    delete threads[i];
+  }
+
+  // Free all but the largest allocation, the only one left to report.
+  for (size_t i = 0; i < leaked.size() - 1; i++) {
+    debug_free(leaked[i]);
+  }
+
+  debug_finalize();
+  initialized = false;
+
+  ASSERT_STREQ("", getFakeLogBuf().c_str());
+  std::string expected_log = android::base::StringPrintf(
+      "6 malloc_debug +++ malloc_testing leaked block of size %zu at %p (leak 1 of 1)\n",
+      1000 + leaked.size() - 1, leaked.back());
+  ASSERT_STREQ(expected_log.c_str(), getFakeLogPrint().c_str());
+}
+
+TEST_F(MallocDebugTest, leak_track_fork_while_allocating) {
+  Init("leak_track");
+
+  // Start with a single tracked allocation so that fork only has to lock
+  // one shard, while the other threads start filling the rest.
+  void* pointer = debug_malloc(100);
+  ASSERT_TRUE(pointer != nullptr);
+
+  std::atomic<bool> done(false);
+  std::vector<std::thread*> threads(4);
+  for (size_t i = 0; i < threads.size(); i++) {
+    threads[i] = new std::thread([&done](){
+      while (!done) {
+        void* mem = debug_malloc(100);
+        write(0, mem, 0);
+        debug_free(mem);
+      }
+    });
+  }
+
+  for (size_t i = 0; i < 20; i++) {
+    pid_t pid = fork();
+    ASSERT_NE(-1, pid);
+    if (pid == 0) {
+      for (size_t j = 0; j < 100; j++) {
+        debug_free(debug_malloc(100 + j));
+      }
+      _exit(0);
+    }
+    int status;
+    ASSERT_EQ(pid, TEMP_FAILURE_RETRY(waitpid(pid, &status, 0)));
+    ASSERT_TRUE(WIFEXITED(status));
+    ASSERT_EQ(0, WEXITSTATUS(status));
+  }
+
+  done = true;
+  for (size_t i = 0; i < threads.size(); i++) {
+    threads[i]->join();
+    delete threads[i];
+  }
+  debug_free(pointer);
+
+  ASSERT_STREQ("", getFakeLogBuf().c_str());
+  ASSERT_STREQ("", getFakeLogPrint().c_str());
+}
+
 TEST_F(MallocDebugTest, free_track) {
   Init("free_track=5 free_track_backtrace_num_frames=0");
 
@@ -1068,6 +1271,111 @@ TEST_F(MallocDebugTest, get_malloc_leak_info_single) {
   ASSERT_STREQ("", getFakeLogPrint().c_str());
 }
 
+TEST_F(MallocDebugTest, get_malloc_leak_info_sampled) {
+  // With a mean distance of one byte, every allocation is sampled and
+  // the scaled size is the real size.
+  Init("backtrace backtrace_sample_bytes=1");
+
+  size_t individual_size = 2 * sizeof(size_t) + 16 * sizeof(uintptr_t);
+  std::vector<uint8_t> expected_info(individual_size);
+  memset(expected_info.data(), 0, individual_size);
+
+  InfoEntry* entry = reinterpret_cast<InfoEntry*>(expected_info.data());
+  entry->size = 200;
+  entry->num_frames = 2;
+  entry->frames[0] = 0x1;
+  entry->frames[1] = 0x2;
+
+  backtrace_fake_add(std::vector<uintptr_t> {0x1, 0x2});
+
+  void* pointer = debug_malloc(entry->size);
+  ASSERT_TRUE(pointer != nullptr);
+
+  uint8_t* info;
+  size_t overall_size;
+  size_t info_size;
+  size_t total_memory;
+  size_t backtrace_size;
+
+  debug_get_malloc_leak_info(&info, &overall_size, &info_size, &total_memory, &backtrace_size);
+  ASSERT_TRUE(info != nullptr);
+  ASSERT_EQ(individual_size, overall_size);
+  ASSERT_EQ(individual_size, info_size);
+  ASSERT_EQ(200U, total_memory);
+  ASSERT_EQ(16U, backtrace_size);
+  ASSERT_TRUE(memcmp(expected_info.data(), info, overall_size) == 0);
+
+  debug_free_malloc_leak_info(info);
+
+  debug_free(pointer);
+
+  ASSERT_STREQ("", getFakeLogBuf().c_str());
+  ASSERT_STREQ("", getFakeLogPrint().c_str());
+}
+
+TEST_F(MallocDebugTest, get_malloc_leak_info_shared_backtrace) {
+  Init("backtrace");
+
+  // Create the expected info buffer.
+  size_t individual_size = 2 * sizeof(size_t) + 16 * sizeof(uintptr_t);
+  std::vector<uint8_t> expected_info(individual_size * 2);
+  memset(expected_info.data(), 0, individual_size * 2);
+
+  InfoEntry* entry0 = reinterpret_cast<InfoEntry*>(expected_info.data());
+  InfoEntry* entry1 = reinterpret_cast<InfoEntry*>(
+      reinterpret_cast<uintptr_t>(entry0) + individual_size);
+  entry0->size = 300;
+  entry1->size = 100;
+  for (InfoEntry* entry : {entry0, entry1}) {
+    entry->num_frames = 3;
+    entry->frames[0] = 0xa;
+    entry->frames[1] = 0xb;
+    entry->frames[2] = 0xc;
+  }
+
+  // Both allocations share one copy of the backtrace, which has to stay
+  // valid when the first of them is freed.
+  backtrace_fake_add(std::vector<uintptr_t> {0xa, 0xb, 0xc});
+  backtrace_fake_add(std::vector<uintptr_t> {0xa, 0xb, 0xc});
+  backtrace_fake_add(std::vector<uintptr_t> {0xa, 0xb, 0xc});
+
+  void* pointer0 = debug_malloc(entry1->size);
+  ASSERT_TRUE(pointer0 != nullptr);
+  void* pointer1 = debug_malloc(200);
+  ASSERT_TRUE(pointer1 != nullptr);
+  void* pointer2 = debug_malloc(entry0->size);
+  ASSERT_TRUE(pointer2 != nullptr);
+  debug_free(pointer1);
+
+  uintptr_t frames[4];
+  ASSERT_EQ(3, debug_malloc_backtrace(pointer0, frames, 4));
+  ASSERT_EQ(0xaU, frames[0]);
+  ASSERT_EQ(0xbU, frames[1]);
+  ASSERT_EQ(0xcU, frames[2]);
+
+  uint8_t* info;
+  size_t overall_size;
+  size_t info_size;
+  size_t total_memory;
+  size_t backtrace_size;
+
+  debug_get_malloc_leak_info(&info, &overall_size, &info_size, &total_memory, &backtrace_size);
+  ASSERT_TRUE(info != nullptr);
+  ASSERT_EQ(individual_size * 2, overall_size);
+  ASSERT_EQ(individual_size, info_size);
+  ASSERT_EQ(300U + 100U, total_memory);
+  ASSERT_EQ(16U, backtrace_size);
+  ASSERT_TRUE(memcmp(expected_info.data(), info, overall_size) == 0);
+
+  debug_free_malloc_leak_info(info);
+
+  debug_free(pointer0);
+  debug_free(pointer2);
+
+  ASSERT_STREQ("", getFakeLogBuf().c_str());
+  ASSERT_STREQ("", getFakeLogPrint().c_str());
+}
+
 TEST_F(MallocDebugTest, get_malloc_leak_info_multi) {
   Init("backtrace=16");
 
@@ -1518,7 +1826,66 @@ TEST_F(MallocDebugTest, debug_valloc) {
 }
 #endif
 
-void VerifyRecordAllocs() {
+// Converts a record_allocs_binary dump to the text format.
+static std::string DecodeRecordAllocs(const std::string& data) {
+  if (data.size() < sizeof(RecordFileHeader) ||
+      memcmp(data.data(), RECORD_FILE_MAGIC, sizeof(RECORD_FILE_MAGIC)) != 0) {
+    return "bad file header";
+  }
+
+  std::string text;
+  size_t offset = sizeof(RecordFileHeader);
+  while (offset + sizeof(RecordChunkHeader) <= data.size()) {
+    RecordChunkHeader header;
+    memcpy(&header, &data[offset], sizeof(header));
+    offset += sizeof(header);
+    if (offset + header.num_bytes > data.size()) {
+      return text + "truncated chunk";
+    }
+
+    const uint8_t* in = reinterpret_cast<const uint8_t*>(&data[offset]);
+    const uint8_t* end = in + header.num_bytes;
+    offset += header.num_bytes;
+    uint64_t time_ns = header.start_ns;
+    uint64_t last_pointer = 0;
+    while (in < end) {
+      Record record;
+      in = RecordDecode(in, end, &time_ns, &last_pointer, &record);
+      if (in == nullptr) {
+        return text + "bad record";
+      }
+      void* pointer = reinterpret_cast<void*>(record.pointer);
+      switch (record.op) {
+        case RECORD_MALLOC:
+          text += android::base::StringPrintf("%d: malloc %p %" PRIu64 "\n", header.tid,
+                                              pointer, record.size);
+          break;
+        case RECORD_FREE:
+          text += android::base::StringPrintf("%d: free %p\n", header.tid, pointer);
+          break;
+        case RECORD_CALLOC:
+          text += android::base::StringPrintf("%d: calloc %p %" PRIu64 " %" PRIu64 "\n",
+                                              header.tid, pointer, record.size, record.arg);
+          break;
+        case RECORD_REALLOC:
+          text += android::base::StringPrintf("%d: realloc %p %p %" PRIu64 "\n", header.tid,
+                                              pointer, reinterpret_cast<void*>(record.arg),
+                                              record.size);
+          break;
+        case RECORD_MEMALIGN:
+          text += android::base::StringPrintf("%d: memalign %p %" PRIu64 " %" PRIu64 "\n",
+                                              header.tid, pointer, record.arg, record.size);
+          break;
+        case RECORD_THREAD_DONE:
+          text += android::base::StringPrintf("%d: thread_done 0x0\n", header.tid);
+          break;
+      }
+    }
+  }
+  return text;
+}
+
+void VerifyRecordAllocs(bool binary = false) {
   std::string expected;
 
   void* pointer = debug_malloc(10);
@@ -1582,6 +1949,9 @@ void VerifyRecordAllocs() {
   // Read all of the contents.
   std::string actual;
   ASSERT_TRUE(android::base::ReadFileToString(RECORD_ALLOCS_FILE, &actual));
+  if (binary) {
+    actual = DecodeRecordAllocs(actual);
+  }
 
   ASSERT_STREQ(expected.c_str(), actual.c_str());
 
@@ -1606,6 +1976,45 @@ TEST_F(MallocDebugTest, record_allocs_with_header) {
   VerifyRecordAllocs();
 }
 
+TEST_F(MallocDebugTest, record_allocs_binary) {
+  Init("record_allocs record_allocs_binary");
+
+  VerifyRecordAllocs(true);
+}
+
+TEST_F(MallocDebugTest, record_allocs_binary_thread_done) {
+  Init("record_allocs=5 record_allocs_binary");
+
+  static pid_t tid = 0;
+  static void* pointer = nullptr;
+  std::thread thread([](){
+    tid = gettid();
+    pointer = debug_malloc(100);
+    write(0, pointer, 0);
+    debug_free(pointer);
+  });
+  thread.join();
+
+  std::string expected = android::base::StringPrintf("%d: malloc %p 100\n", tid, pointer);
+  expected += android::base::StringPrintf("%d: free %p\n", tid, pointer);
+  expected += android::base::StringPrintf("%d: thread_done 0x0\n", tid);
+
+  // Dump all of the data accumulated so far.
+  ASSERT_TRUE(kill(getpid(), SIGRTMAX - 18) == 0);
+  sleep(1);
+
+  // This triggers the dumping.
+  pointer = debug_malloc(23);
+  ASSERT_TRUE(pointer != nullptr);
+  expected += android::base::StringPrintf("%d: malloc %p 23\n", getpid(), pointer);
+
+  std::string actual;
+  ASSERT_TRUE(android::base::ReadFileToString(RECORD_ALLOCS_FILE, &actual));
+  ASSERT_STREQ(expected.c_str(), DecodeRecordAllocs(actual).c_str());
+
+  debug_free(pointer);
+}
+
 TEST_F(MallocDebugTest, record_allocs_max) {
   Init("record_allocs=5");
 
@@ -0,0 +1,207 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+// Replays a record_allocs_binary dump against the allocator that this
+// program runs with, and reports how long each kind of call took.
+//
+// The records of all threads are merged by timestamp and replayed on a
+// single thread, so the result measures the cost of the allocation
+// pattern, not of the contention between the original threads.
+
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <malloc.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <android-base/file.h>
+
+#include "RecordFormat.h"
+
+static uint64_t Nanotime() {
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return static_cast<uint64_t>(t.tv_sec) * 1000000000 + t.tv_nsec;
+}
+
+static bool ParseRecords(const std::string& data, std::vector<Record>* records) {
+  if (data.size() < sizeof(RecordFileHeader) ||
+      memcmp(data.data(), RECORD_FILE_MAGIC, sizeof(RECORD_FILE_MAGIC)) != 0) {
+    fprintf(stderr, "not a record_allocs_binary file\n");
+    return false;
+  }
+  RecordFileHeader file_header;
+  memcpy(&file_header, data.data(), sizeof(file_header));
+  if (file_header.version != RECORD_FILE_VERSION) {
+    fprintf(stderr, "unsupported version %u\n", file_header.version);
+    return false;
+  }
+
+  size_t offset = sizeof(RecordFileHeader);
+  while (offset < data.size()) {
+    RecordChunkHeader header;
+    if (offset + sizeof(header) > data.size()) {
+      fprintf(stderr, "truncated chunk header at offset %zu\n", offset);
+      return false;
+    }
+    memcpy(&header, &data[offset], sizeof(header));
+    offset += sizeof(header);
+    if (offset + header.num_bytes > data.size()) {
+      fprintf(stderr, "truncated chunk at offset %zu\n", offset);
+      return false;
+    }
+
+    const uint8_t* in = reinterpret_cast<const uint8_t*>(&data[offset]);
+    const uint8_t* end = in + header.num_bytes;
+    uint64_t time_ns = header.start_ns;
+    uint64_t last_pointer = 0;
+    while (in < end) {
+      Record record;
+      in = RecordDecode(in, end, &time_ns, &last_pointer, &record);
+      if (in == nullptr) {
+        fprintf(stderr, "bad record in chunk at offset %zu\n", offset);
+        return false;
+      }
+      records->push_back(record);
+    }
+    offset += header.num_bytes;
+  }
+
+  // Every chunk is already in order, so a stable sort keeps the order of
+  // the records of a thread that share a timestamp.
+  std::stable_sort(records->begin(), records->end(),
+                   [](const Record& a, const Record& b) { return a.time_ns < b.time_ns; });
+  return true;
+}
+
+struct OpStats {
+  const char* name;
+  uint64_t count = 0;
+  uint64_t total_ns = 0;
+};
+
+int main(int argc, char** argv) {
+  if (argc != 2) {
+    fprintf(stderr, "usage: %s RECORD_FILE\n", argv[0]);
+    return 1;
+  }
+
+  std::string data;
+  if (!android::base::ReadFileToString(argv[1], &data)) {
+    fprintf(stderr, "failed to read %s: %s\n", argv[1], strerror(errno));
+    return 1;
+  }
+  std::vector<Record> records;
+  if (!ParseRecords(data, &records)) {
+    return 1;
+  }
+  std::string().swap(data);
+
+  OpStats stats[RECORD_THREAD_DONE + 1];
+  stats[RECORD_MALLOC].name = "malloc";
+  stats[RECORD_FREE].name = "free";
+  stats[RECORD_CALLOC].name = "calloc";
+  stats[RECORD_REALLOC].name = "realloc";
+  stats[RECORD_MEMALIGN].name = "memalign";
+  stats[RECORD_THREAD_DONE].name = "thread_done";
+
+  // Recorded pointer -> pointer returned by this allocator.
+  std::unordered_map<uint64_t, void*> live;
+  live.reserve(records.size() / 2);
+
+  for (const Record& record : records) {
+    void* result = nullptr;
+    void* old_pointer = nullptr;
+    uint64_t start = Nanotime();
+    switch (record.op) {
+      case RECORD_MALLOC:
+        result = malloc(record.size);
+        break;
+      case RECORD_FREE: {
+        auto entry = live.find(record.pointer);
+        if (entry != live.end()) {
+          old_pointer = entry->second;
+          live.erase(entry);
+        }
+        start = Nanotime();
+        free(old_pointer);
+        break;
+      }
+      case RECORD_CALLOC:
+        result = calloc(record.arg, record.size);
+        break;
+      case RECORD_REALLOC: {
+        auto entry = live.find(record.arg);
+        if (entry != live.end()) {
+          old_pointer = entry->second;
+          live.erase(entry);
+        }
+        start = Nanotime();
+        result = realloc(old_pointer, record.size);
+        break;
+      }
+      case RECORD_MEMALIGN:
+        result = memalign(record.arg, record.size);
+        break;
+      case RECORD_THREAD_DONE:
+        break;
+    }
+    stats[record.op].total_ns += Nanotime() - start;
+    stats[record.op].count++;
+
+    if (result != nullptr && record.pointer != 0) {
+      live[record.pointer] = result;
+    }
+  }
+
+  uint64_t total_ns = 0;
+  for (const OpStats& op : stats) {
+    if (op.count != 0 && &op != &stats[RECORD_THREAD_DONE]) {
+      printf("%-10s %12" PRIu64 " calls %14" PRIu64 " ns %10.1f ns/call\n", op.name, op.count,
+             op.total_ns, static_cast<double>(op.total_ns) / op.count);
+      total_ns += op.total_ns;
+    }
+  }
+  printf("%-10s %12zu records %12" PRIu64 " ns\n", "total", records.size(), total_ns);
+  printf("%zu allocations still live at the end of the trace\n", live.size());
+
+  for (const auto& entry : live) {
+    free(entry.second);
+  }
+  return 0;
+}
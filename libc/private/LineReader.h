@@ -0,0 +1,210 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef LINE_READER_H
+#define LINE_READER_H
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "private/bionic_macros.h"
+
+// Helpers for the line-oriented text files in /proc and /sys. They work in place in a buffer
+// the caller provides, usually on the stack, so they don't allocate or use stdio. procfs
+// files can't be mmapped, so they're read.
+
+// Reads path, which should be smaller than size, into buf, NUL-terminated. Sysfs attributes
+// are at most a page. Returns false if the file couldn't be read or was empty.
+static inline bool ReadSmallFile(const char* path, char* buf, size_t size) {
+  int fd = open(path, O_RDONLY | O_CLOEXEC);
+  if (fd == -1) {
+    return false;
+  }
+  ssize_t n = TEMP_FAILURE_RETRY(read(fd, buf, size - 1));
+  close(fd);
+  if (n <= 0) {
+    return false;
+  }
+  buf[n] = '\0';
+  return true;
+}
+
+// Splits a line into fields separated by spaces and tabs, in place.
+class FieldTokenizer {
+ public:
+  explicit FieldTokenizer(char* line) : p_(line) {
+  }
+
+  // Returns the next field, NUL-terminated, or nullptr if the line has no more.
+  char* Next() {
+    SkipSpaces();
+    if (*p_ == '\0') {
+      return nullptr;
+    }
+    char* field = p_;
+    while (*p_ != '\0' && !IsSpace(*p_)) {
+      ++p_;
+    }
+    if (*p_ != '\0') {
+      *p_++ = '\0';
+    }
+    return field;
+  }
+
+  // Parses the next field, which must be all digits, as a number in base 10 or 16.
+  template <typename T>
+  bool NextNumber(int base, T* value) {
+    const char* field = Next();
+    return field != nullptr && ParseNumber(field, base, value) == field + strlen(field);
+  }
+
+  // Returns the rest of the line after any spaces, which may itself contain spaces: the last
+  // field of a /proc/self/maps line is a path, for example.
+  char* Rest() {
+    SkipSpaces();
+    return p_;
+  }
+
+  // Parses the digits at the start of s as a number in base 10 or 16. Returns a pointer to
+  // the character after them, or nullptr if s doesn't start with a digit. Overflow wraps.
+  template <typename T>
+  static const char* ParseNumber(const char* s, int base, T* value) {
+    T result = 0;
+    const char* p = s;
+    while (true) {
+      int digit;
+      if (*p >= '0' && *p <= '9') {
+        digit = *p - '0';
+      } else if (base == 16 && (*p | 0x20) >= 'a' && (*p | 0x20) <= 'f') {
+        digit = (*p | 0x20) - 'a' + 10;
+      } else {
+        break;
+      }
+      result = result * base + digit;
+      ++p;
+    }
+    if (p == s) {
+      return nullptr;
+    }
+    *value = result;
+    return p;
+  }
+
+ private:
+  static bool IsSpace(char ch) {
+    return ch == ' ' || ch == '\t';
+  }
+
+  void SkipSpaces() {
+    while (IsSpace(*p_)) {
+      ++p_;
+    }
+  }
+
+  char* p_;
+
+  DISALLOW_COPY_AND_ASSIGN(FieldTokenizer);
+};
+
+// Reads a file a line at a time through the caller's buffer.
+class LineReader {
+ public:
+  // Reads the file at path, which is closed when the LineReader is destroyed.
+  LineReader(const char* path, char* buf, size_t size)
+      : fd_(open(path, O_RDONLY | O_CLOEXEC)), buf_(buf), size_(size), start_(0), end_(0),
+        eof_(false), error_(fd_ == -1) {
+  }
+
+  ~LineReader() {
+    if (fd_ != -1) {
+      close(fd_);
+    }
+  }
+
+  bool IsBad() {
+    return fd_ == -1;
+  }
+
+  // Whether a read failed, or the file couldn't be opened.
+  bool HadError() {
+    return error_;
+  }
+
+  // Returns the next line, NUL-terminated and without its newline, or nullptr at the end of
+  // the file. The line stays valid, and can be modified, until the next call. A line that
+  // doesn't fit in the buffer is skipped.
+  char* ReadLine() {
+    if (fd_ == -1) {
+      return nullptr;
+    }
+    bool skipping = false;
+    while (true) {
+      char* line = buf_ + start_;
+      char* newline = static_cast<char*>(memchr(line, '\n', end_ - start_));
+      if (newline != nullptr) {
+        start_ = newline + 1 - buf_;
+        if (skipping) {
+          skipping = false;
+          continue;
+        }
+        *newline = '\0';
+        return line;
+      }
+      if (eof_) {
+        if (start_ == end_ || skipping) {
+          return nullptr;
+        }
+        // The last line didn't end with a newline.
+        buf_[end_] = '\0';
+        start_ = end_;
+        return line;
+      }
+
+      // Move the partial line to the front of the buffer and read the rest of it. One byte is
+      // kept back for the NUL.
+      memmove(buf_, line, end_ - start_);
+      end_ -= start_;
+      start_ = 0;
+      if (end_ == size_ - 1) {
+        skipping = true;
+        end_ = 0;
+      }
+      ssize_t n = TEMP_FAILURE_RETRY(read(fd_, buf_ + end_, size_ - 1 - end_));
+      if (n <= 0) {
+        eof_ = true;
+        error_ = (n == -1);
+      } else {
+        end_ += n;
+      }
+    }
+  }
+
+ private:
+  int fd_;
+  char* buf_;
+  size_t size_;
+  size_t start_;
+  size_t end_;
+  bool eof_;
+  bool error_;
+
+  DISALLOW_COPY_AND_ASSIGN(LineReader);
+};
+
+#endif // LINE_READER_H
@@ -26,7 +26,11 @@ struct NetdClientDispatch {
     int (*accept4)(int, struct sockaddr*, socklen_t*, int);
     int (*connect)(int, const struct sockaddr*, socklen_t);
     int (*socket)(int, int, int);
+    int (*socketBatch)(int, int, int, int*, size_t);
     unsigned (*netIdForResolv)(unsigned);
+    // Null unless netd_client provides it. Returns a number that changes whenever the network
+    // selection (and so the mark netd gives new sockets) changes, or 0 if marks mustn't be cached.
+    unsigned (*networkGeneration)();
 };
 
 extern __LIBC_HIDDEN__ struct NetdClientDispatch __netdClientDispatch;
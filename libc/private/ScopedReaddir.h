@@ -44,6 +44,10 @@ class ScopedReaddir {
     return readdir(dir_);
   }
 
+  int ReadEntries(dirent** entries, int count) {
+    return android_readdir_batch(dir_, entries, count);
+  }
+
  private:
   DIR* dir_;
 
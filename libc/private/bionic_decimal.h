@@ -0,0 +1,58 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef _BIONIC_DECIMAL_H
+#define _BIONIC_DECIMAL_H
+
+#include <stdint.h>
+#include <sys/cdefs.h>
+
+struct ScaledValue {
+  uint64_t integer;
+  // The first 64 bits of the fractional part.
+  uint64_t fraction;
+  // Whether there are more fraction bits set beyond those.
+  bool sticky;
+  // Whether integer.fraction is exact. Otherwise it may be a few units in the last place
+  // of `fraction` either side of the true value.
+  bool exact;
+};
+
+// 10^0 to 10^19.
+__LIBC_HIDDEN__ extern const uint64_t powers_of_ten[20];
+
+// Computes f * 2^e * 10^m, exactly for 10^0 to 10^54 and to within a few units in the
+// last place of the fraction otherwise. Returns false if 10^m is outside our table (which
+// covers every power a finite double needs), or if the integer part doesn't fit in 64 bits.
+__LIBC_HIDDEN__ bool scale_by_power_of_ten(uint64_t f, int e, int m, ScaledValue* result);
+
+// Rounds to the nearest integer, breaking exact ties to even like gdtoa. Returns false if
+// an inexact value is too close to a tie to call.
+__LIBC_HIDDEN__ bool round_scaled_value(const ScaledValue& s, uint64_t* result);
+
+#endif
@@ -0,0 +1,88 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef _PRIVATE_BIONIC_ELF_TLS_H
+#define _PRIVATE_BIONIC_ELF_TLS_H
+
+// ELF TLS for shared libraries built with -fno-emulated-tls.
+//
+// The dynamic linker gives each loaded library with a PT_TLS segment a module id, reported by
+// dl_iterate_phdr() as dlpi_tls_modid; ids are never reused, so a stale block can never be
+// mistaken for a newer library's. Each thread has a dynamic thread vector (DTV) in
+// TLS_SLOT_DTV holding its block for each module id, which libc allocates from the module's
+// template the first time the thread touches one of its variables. Accesses go through
+// __tls_get_addr() (general and local dynamic models) or, on arm64, the TLSDESC resolver; both
+// are a few loads once the block exists.
+//
+// The initial-exec and local-exec models need a static TLS area at a fixed offset from the
+// thread pointer, which bionic's TLS slots occupy, so executables can't have a PT_TLS segment.
+
+// For the arm64 TLSDESC resolver; checked by static_asserts in bionic_elf_tls.cpp.
+#define BIONIC_TLS_SLOT_DTV_OFFSET (10 * 8)
+#define BIONIC_TLS_DTV_COUNT_OFFSET 0
+#define BIONIC_TLS_DTV_MODULES_OFFSET 16
+
+#if !defined(__ASSEMBLER__)
+
+#include <stddef.h>
+#include <sys/cdefs.h>
+
+#include "bionic_tls.h"
+
+__BEGIN_DECLS
+
+// The argument to __tls_get_addr(), and of a resolved TLSDESC descriptor.
+struct TlsIndex {
+  size_t module_id;
+  size_t offset;
+};
+
+struct TlsDtv {
+  // The number of entries in modules.
+  size_t count;
+  // The dlpi_subs value when blocks for unloaded modules were last freed.
+  unsigned long long subs;
+  // The block for module id i + 1, or null if this thread hasn't touched it yet.
+  void* modules[];
+};
+
+// Frees the calling thread's blocks. Called by pthread_exit() after the thread's destructors.
+__LIBC_HIDDEN__ void __free_dynamic_tls(void);
+
+// Returns the calling thread's block for module_id, or null if it hasn't allocated one.
+static inline void* __get_dynamic_tls_block(size_t module_id) {
+  struct TlsDtv* dtv = (struct TlsDtv*) __get_tls()[TLS_SLOT_DTV];
+  if (dtv == NULL || module_id == 0 || module_id > dtv->count) return NULL;
+  return dtv->modules[module_id - 1];
+}
+
+__END_DECLS
+
+#endif // !defined(__ASSEMBLER__)
+
+#endif // _PRIVATE_BIONIC_ELF_TLS_H
@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef _BIONIC_FNMATCH_H
+#define _BIONIC_FNMATCH_H
+
+#include <stddef.h>
+#include <sys/cdefs.h>
+
+__BEGIN_DECLS
+
+// Most patterns in practice are a literal with a '*' at one or both ends ("*.log", "prefix*",
+// "*tmp*"), or no '*' at all. Those can be matched with a memcmp or memmem rather than by
+// fnmatch's general interpreter.
+struct fnmatch_simple {
+  int leading_star;
+  int trailing_star;
+  const char* literal;  // Points into the pattern; not NUL-terminated.
+  size_t length;
+};
+
+// Where the slashes in a string are, so FNM_PATHNAME can check a '*' doesn't match one.
+// Both are the string's length if it has no slashes, or without FNM_PATHNAME.
+struct fnmatch_subject {
+  const char* string;
+  size_t length;
+  size_t first_slash;
+  size_t last_slash;
+};
+
+// Returns 1 and fills in *simple if the pattern has one of the simple forms under the given
+// flags, and 0 if it needs the general matcher.
+__LIBC_HIDDEN__ int __fnmatch_classify(const char* pattern, int flags,
+                                       struct fnmatch_simple* simple);
+
+__LIBC_HIDDEN__ void __fnmatch_subject(const char* string, int flags,
+                                       struct fnmatch_subject* subject);
+
+// Returns 0 or FNM_NOMATCH, exactly as fnmatch would.
+__LIBC_HIDDEN__ int __fnmatch_simple(const struct fnmatch_simple* simple,
+                                     const struct fnmatch_subject* subject, int flags);
+
+__END_DECLS
+
+#endif
@@ -32,6 +32,7 @@
 #include <linux/futex.h>
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <sys/cdefs.h>
 #include <sys/syscall.h>
 #include <unistd.h>
@@ -65,11 +66,64 @@ static inline int __futex_wait(volatile void* ftx, int value, const struct times
   return __futex(ftx, FUTEX_WAIT, value, timeout, 0);
 }
 
+// Waits like __futex_wait_ex, but only a wake whose bitset shares a bit with this one wakes
+// the waiter. Plain wakes use FUTEX_BITSET_MATCH_ANY, so they wake every class of waiter.
+static inline int __futex_wait_bitset_ex(volatile void* ftx, bool shared, int value,
+                                         bool use_realtime_clock,
+                                         const struct timespec* abs_timeout, uint32_t bitset) {
+  return __futex(ftx, (shared ? FUTEX_WAIT_BITSET : FUTEX_WAIT_BITSET_PRIVATE) |
+                 (use_realtime_clock ? FUTEX_CLOCK_REALTIME : 0), value, abs_timeout, bitset);
+}
+
 static inline int __futex_wait_ex(volatile void* ftx, bool shared, int value,
                                   bool use_realtime_clock, const struct timespec* abs_timeout) {
-  return __futex(ftx, (shared ? FUTEX_WAIT_BITSET : FUTEX_WAIT_BITSET_PRIVATE) |
-                 (use_realtime_clock ? FUTEX_CLOCK_REALTIME : 0), value, abs_timeout,
-                 FUTEX_BITSET_MATCH_ANY);
+  return __futex_wait_bitset_ex(ftx, shared, value, use_realtime_clock, abs_timeout,
+                                FUTEX_BITSET_MATCH_ANY);
+}
+
+// Wakes up to count of the waiters whose bitset shares a bit with this one.
+static inline int __futex_wake_bitset_ex(volatile void* ftx, bool shared, int count,
+                                         uint32_t bitset) {
+  return __futex(ftx, shared ? FUTEX_WAKE_BITSET : FUTEX_WAKE_BITSET_PRIVATE, count, NULL,
+                 bitset);
+}
+
+// Wakes one waiter, preferring one in the class of waiters bitset selects. Only if there's none
+// of those is another woken, which costs a second system call.
+static inline int __futex_wake_one_preferring_ex(volatile void* ftx, bool shared,
+                                                 uint32_t bitset) {
+  if (bitset != FUTEX_BITSET_MATCH_ANY) {
+    int woken = __futex_wake_bitset_ex(ftx, shared, 1, bitset);
+    if (woken > 0) {
+      return woken;
+    }
+  }
+  return __futex_wake_ex(ftx, shared, 1);
+}
+
+// Wakes up to wake_count waiters on ftx and moves up to requeue_count of the rest onto ftx2,
+// as long as ftx still contains expected_value. Otherwise returns -EAGAIN.
+static inline int __futex_cmp_requeue_ex(volatile void* ftx, bool shared, int wake_count,
+                                         int requeue_count, volatile void* ftx2,
+                                         int expected_value) {
+  int saved_errno = errno;
+  int result = syscall(__NR_futex, ftx, shared ? FUTEX_CMP_REQUEUE : FUTEX_CMP_REQUEUE_PRIVATE,
+                       wake_count, (long) requeue_count, ftx2, expected_value);
+  if (__predict_false(result == -1)) {
+    result = -errno;
+    errno = saved_errno;
+  }
+  return result;
+}
+
+// FUTEX_LOCK_PI's timeout is always an absolute CLOCK_REALTIME time.
+static inline int __futex_pi_lock(volatile void* ftx, bool shared,
+                                  const struct timespec* abs_timeout) {
+  return __futex(ftx, shared ? FUTEX_LOCK_PI : FUTEX_LOCK_PI_PRIVATE, 0, abs_timeout, 0);
+}
+
+static inline int __futex_pi_unlock(volatile void* ftx, bool shared) {
+  return __futex(ftx, shared ? FUTEX_UNLOCK_PI : FUTEX_UNLOCK_PI_PRIVATE, 0, NULL, 0);
 }
 
 __END_DECLS
@@ -39,12 +39,17 @@ struct libc_globals {
   vdso_entry vdso[VDSO_END];
   long setjmp_cookie;
   MallocDispatch malloc_dispatch;
+  uintptr_t malloc_sampler_base;
+  size_t malloc_sampler_size;
 };
 
 __LIBC_HIDDEN__ extern WriteProtected<libc_globals> __libc_globals;
 
 class KernelArgumentBlock;
 __LIBC_HIDDEN__ void __libc_init_malloc(libc_globals* globals);
+// False if no malloc debug or malloc sampler property can have a value, so
+// __libc_init_malloc needn't look them up. Defined in system_properties.cpp.
+__LIBC_HIDDEN__ bool __system_property_malloc_debug_possible();
 __LIBC_HIDDEN__ void __libc_init_setjmp_cookie(libc_globals* globals, KernelArgumentBlock& args);
 __LIBC_HIDDEN__ void __libc_init_vdso(libc_globals* globals, KernelArgumentBlock& args);
 
@@ -0,0 +1,58 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef _PRIVATE_BIONIC_IFUNC_H_
+#define _PRIVATE_BIONIC_IFUNC_H_
+
+#include <sys/cdefs.h>
+
+// Helpers for choosing between several implementations of a libc function
+// when libc.so is loaded. Each dispatched function needs a typedef named
+// <name>_func for its signature and a resolver defined with
+// DEFINE_IFUNC_RESOLVER(<name>) that returns one of the implementations.
+//
+// Resolvers run while the dynamic linker is relocating libc.so, before any
+// of libc has been initialized: they can't use TLS, errno, the stack
+// protector, or anything else that needs libc to be set up. Declare the
+// implementations __LIBC_HIDDEN__ so that the resolvers can take their
+// addresses without going through relocations that may not have been
+// applied yet.
+
+// On arm and arm64 the linker passes AT_HWCAP to resolvers, as glibc does.
+// Elsewhere resolvers take no arguments and query the CPU directly.
+#if defined(__arm__) || defined(__aarch64__)
+#define IFUNC_ARGS (unsigned long hwcap __attribute__((unused)))
+#else
+#define IFUNC_ARGS ()
+#endif
+
+#define DEFINE_IFUNC_RESOLVER(name) \
+    name##_func name __attribute__((ifunc(#name "_resolver"))); \
+    __LIBC_HIDDEN__ name##_func* name##_resolver IFUNC_ARGS
+
+#endif  // _PRIVATE_BIONIC_IFUNC_H_
@@ -45,6 +45,13 @@ typedef void* (*MallocRealloc)(void*, size_t);
 typedef int (*MallocIterate)(uintptr_t, size_t, void (*)(uintptr_t, size_t, void*), void*);
 typedef void (*MallocMallocDisable)();
 typedef void (*MallocMallocEnable)();
+typedef int (*MallocHeapCreate)();
+typedef void* (*MallocHeapMalloc)(int, size_t);
+typedef void (*MallocHeapFree)(int, void*);
+typedef int (*MallocHeapDestroy)(int);
+typedef void (*MallocFreeSized)(void*, size_t);
+typedef int (*MallocMallopt)(int, int);
+typedef int (*MallocMallocTrim)(size_t);
 
 #if defined(HAVE_DEPRECATED_MALLOC_FUNCS)
 typedef void* (*MallocPvalloc)(size_t);
@@ -69,6 +76,13 @@ struct MallocDispatch {
   MallocIterate iterate;
   MallocMallocDisable malloc_disable;
   MallocMallocEnable malloc_enable;
+  MallocHeapCreate heap_create;
+  MallocHeapMalloc heap_malloc;
+  MallocHeapFree heap_free;
+  MallocHeapDestroy heap_destroy;
+  MallocFreeSized free_sized;
+  MallocMallopt mallopt;
+  MallocMallocTrim malloc_trim;
 } __attribute__((aligned(32)));
 
 #endif
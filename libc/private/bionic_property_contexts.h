@@ -0,0 +1,76 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+
+#ifndef _PRIVATE_BIONIC_PROPERTY_CONTEXTS_H
+#define _PRIVATE_BIONIC_PROPERTY_CONTEXTS_H
+
+#include <stdint.h>
+
+// The format of /property_contexts.bin: /property_contexts compiled at build time by
+// libc/tools/compile_property_contexts.py, so that every process can map it and look names up
+// in place, rather than parse the text and malloc a node per line. If it's missing or doesn't
+// check out, system_properties.cpp falls back to the text.
+//
+// Offsets are from the start of the file, and strings are NUL-terminated. The prefix table is
+// the one build_prefix_index() builds from the text: sorted by strcmp, with ctl.* entries,
+// duplicates and the catch-all left out, and each prefix pointing at the longest other prefix
+// of itself. Keep the two in sync.
+
+#define PROPERTY_CONTEXTS_BIN_PATH "/property_contexts.bin"
+#define PROPERTY_CONTEXTS_MAGIC 0x58544350  // "PCTX".
+#define PROPERTY_CONTEXTS_VERSION 1
+#define PROPERTY_CONTEXTS_NONE UINT32_MAX
+
+struct property_contexts_header {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t size;  // Of the whole file.
+
+  // Offsets of the context names, in the order the text first uses them.
+  uint32_t context_count;
+  uint32_t contexts;
+
+  // An array of property_contexts_prefix, and for each first byte c, the index of the first
+  // prefix that starts with c. prefix_start[256] is prefix_count.
+  uint32_t prefix_count;
+  uint32_t prefixes;
+  uint32_t prefix_start[257];
+
+  // The context of names that no prefix matches, or PROPERTY_CONTEXTS_NONE.
+  uint32_t wildcard_context;
+};
+
+struct property_contexts_prefix {
+  uint32_t name;
+  uint32_t name_len;
+  uint32_t context;
+  uint32_t shorter;  // An index less than this one's, or PROPERTY_CONTEXTS_NONE.
+};
+
+#endif
@@ -0,0 +1,123 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef _PRIVATE_BIONIC_RSEQ_H
+#define _PRIVATE_BIONIC_RSEQ_H
+
+// Restartable sequences (rseq): every thread registers an area the kernel keeps the current CPU
+// number in, and in which it can name a short critical section that the kernel will abort if the
+// thread is preempted, migrated or signaled while in it. This header is shared with the assembler
+// implementations of the critical sections in arch-*/bionic/rseq.S.
+
+// The abort handler of each critical section must be preceded by this value, which doubles as an
+// instruction that traps if it's ever executed. Registration is only done where there are
+// critical sections implemented.
+#if defined(__aarch64__)
+#define BIONIC_RSEQ_SIG 0xd428bc00 // brk #0x45e0
+#elif defined(__x86_64__)
+#define BIONIC_RSEQ_SIG 0x53053053 // The displacement of "ud1 0x53053053(%rip), %edi".
+#endif
+
+#define BIONIC_RSEQ_CPU_ID_OFFSET 4
+#define BIONIC_RSEQ_CS_OFFSET 8
+
+#if !defined(__ASSEMBLER__)
+
+#include <stdint.h>
+#include <sys/cdefs.h>
+
+#include "private/bionic_tls.h"
+
+__BEGIN_DECLS
+
+// Our kernel headers predate rseq.
+#if !defined(__NR_rseq)
+#if defined(__aarch64__)
+#define __NR_rseq 293
+#elif defined(__x86_64__)
+#define __NR_rseq 334
+#endif
+#endif
+
+#define BIONIC_RSEQ_FLAG_UNREGISTER 1
+
+// The kernel's struct rseq.
+struct bionic_rseq {
+  uint32_t cpu_id_start;
+  uint32_t cpu_id;
+  uint64_t rseq_cs;
+  uint32_t flags;
+} __attribute__((aligned(32)));
+
+// Returns the calling thread's registered rseq area, or null if it doesn't have one, in which
+// case callers should fall back to sched_getcpu and atomics.
+static inline __always_inline struct bionic_rseq* __bionic_rseq_area(void) {
+  return (struct bionic_rseq*) __get_tls()[TLS_SLOT_RSEQ];
+}
+
+// Returns the CPU the calling thread is running on, or -1 if it has no rseq area.
+static inline __always_inline int __bionic_rseq_cpu(void) {
+  struct bionic_rseq* rs = __bionic_rseq_area();
+  return rs != NULL ? (int) __atomic_load_n(&rs->cpu_id, __ATOMIC_RELAXED) : -1;
+}
+
+// Per-CPU critical sections. Each one either completes while the calling thread runs on `cpu`
+// without interruption, or does nothing and returns -1, in which case the caller should get the
+// CPU again and retry. `rs` must be the calling thread's __bionic_rseq_area().
+#if defined(BIONIC_RSEQ_SIG)
+// Adds `count` to `*v`.
+__LIBC_HIDDEN__ int __bionic_rseq_addv(struct bionic_rseq* rs, intptr_t* v, intptr_t count,
+                                       int cpu);
+// Stores `newv` in `*v` if `*v` is `expect`, and returns 0. Returns 1 if it wasn't.
+__LIBC_HIDDEN__ int __bionic_rseq_cmpeqv_storev(struct bionic_rseq* rs, intptr_t* v,
+                                                intptr_t expect, intptr_t newv, int cpu);
+#else
+// There are no areas to pass on this architecture, so these are never called.
+static inline int __bionic_rseq_addv(struct bionic_rseq* rs __unused, intptr_t* v __unused,
+                                     intptr_t count __unused, int cpu __unused) {
+  return -1;
+}
+static inline int __bionic_rseq_cmpeqv_storev(struct bionic_rseq* rs __unused,
+                                              intptr_t* v __unused, intptr_t expect __unused,
+                                              intptr_t newv __unused, int cpu __unused) {
+  return -1;
+}
+#endif
+
+__END_DECLS
+
+#if defined(__cplusplus)
+static_assert(__builtin_offsetof(bionic_rseq, cpu_id) == BIONIC_RSEQ_CPU_ID_OFFSET,
+              "rseq.S expects cpu_id at BIONIC_RSEQ_CPU_ID_OFFSET");
+static_assert(__builtin_offsetof(bionic_rseq, rseq_cs) == BIONIC_RSEQ_CS_OFFSET,
+              "rseq.S expects rseq_cs at BIONIC_RSEQ_CS_OFFSET");
+#endif
+
+#endif // !defined(__ASSEMBLER__)
+
+#endif // _PRIVATE_BIONIC_RSEQ_H
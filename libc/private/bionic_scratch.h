@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef BIONIC_SCRATCH_H
+#define BIONIC_SCRATCH_H
+
+#include <stddef.h>
+#include <sys/cdefs.h>
+
+// Per-thread scratch memory for libc internals that need a temporary buffer for the length of a
+// call. Allocation bumps a pointer in an arena the thread maps the first time it's needed, and
+// ending the scope hands everything allocated in it back at once. Anything that doesn't fit (or
+// any allocation on a thread without an arena) comes from malloc and is freed when the scope ends.
+//
+// Scopes nest, but must end in the reverse order they began, and memory from a scope must only
+// be allocated while it's the innermost one. A signal handler that uses its own scope is fine.
+//
+// From C:
+//   struct bionic_scratch_scope scope;
+//   __bionic_scratch_begin(&scope);
+//   char* buf = __bionic_scratch_alloc(&scope, size);
+//   ...
+//   __bionic_scratch_end(&scope);
+
+struct bionic_scratch_overflow;
+
+struct bionic_scratch_scope {
+  size_t offset;
+  struct bionic_scratch_overflow* overflow;
+};
+
+__BEGIN_DECLS
+
+__LIBC_HIDDEN__ void __bionic_scratch_begin(struct bionic_scratch_scope* scope);
+// Returns size bytes aligned for any type, or null if even malloc can't provide them.
+__LIBC_HIDDEN__ void* __bionic_scratch_alloc(struct bionic_scratch_scope* scope, size_t size);
+__LIBC_HIDDEN__ void __bionic_scratch_end(struct bionic_scratch_scope* scope);
+
+__END_DECLS
+
+#if defined(__cplusplus)
+
+#include "bionic_macros.h"
+
+class ScopedScratch {
+ public:
+  ScopedScratch() {
+    __bionic_scratch_begin(&scope_);
+  }
+
+  ~ScopedScratch() {
+    __bionic_scratch_end(&scope_);
+  }
+
+  void* Alloc(size_t size) {
+    return __bionic_scratch_alloc(&scope_, size);
+  }
+
+ private:
+  bionic_scratch_scope scope_;
+
+  DISALLOW_COPY_AND_ASSIGN(ScopedScratch);
+};
+
+#endif
+
+#endif
@@ -0,0 +1,42 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef BIONIC_SECTIONS_H
+#define BIONIC_SECTIONS_H
+
+#include <sys/cdefs.h>
+
+// Sections that keep libc's and the linker's mutable globals apart by how they're used, so that
+// a process forked from a warm parent (the zygote, say) copies as few of their pages as possible.
+// Otherwise the globals children write are spread across .data and .bss, and each write costs a
+// private copy of a page that's mostly globals they never touch.
+//
+// The static linker puts each of these sections, whose names it doesn't know, in an output
+// section of its own next to .data. They aren't page-aligned, because the only way to do that
+// from C is to align some variable, and the compiler may put that after others in the section,
+// padding it with most of a page. So each can share a page at either end with its neighbours.
+//
+// Only use these on variables that aren't const: a section can't hold both.
+
+// Globals that forked children are likely to write on common paths: locks, thread lists, stdio
+// buffers and the like.
+#define __BIONIC_FORK_WRITTEN __attribute__((section("bionic_fork_written")))
+
+// Globals set at startup and only read after that, whose pages children go on sharing with
+// their parent.
+#define __BIONIC_READ_MOSTLY __attribute__((section("bionic_read_mostly")))
+
+#endif
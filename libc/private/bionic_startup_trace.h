@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef _PRIVATE_BIONIC_STARTUP_TRACE_H
+#define _PRIVATE_BIONIC_STARTUP_TRACE_H
+
+#include <sys/cdefs.h>
+
+#include "private/bionic_macros.h"
+
+// Optional timing of libc's initialization, for programs whose runtime is dominated by it
+// (short-lived command-line tools, say). With LIBC_STARTUP_TRACE=1 in the environment, a
+// one-line summary of how long each phase took is written to stderr just before main() is
+// called; with LIBC_STARTUP_TRACE set to a path, the line is appended to that file instead.
+// Each phase costs two clock_gettime() calls when tracing is on, and two calls that return
+// immediately when it's off.
+
+enum StartupPhase {
+  kStartupPhaseGlobals,       // __libc_init_globals(): the vdso and the setjmp cookie.
+  kStartupPhaseCommon,        // The rest of __libc_init_common().
+  kStartupPhaseProperties,    // __system_properties_init().
+  kStartupPhaseMalloc,        // __libc_init_malloc(), including loading libc_malloc_debug.so.
+  kStartupPhaseNetd,          // netdClientInit().
+  kStartupPhaseRelocation,    // Static executables' ifunc resolvers and RELRO.
+  kStartupPhaseConstructors,  // The other libraries' and the executable's constructors.
+  kStartupPhaseParallelConstructors,  // Static executables' ANDROID_PARALLEL_CONSTRUCTORs.
+  kStartupPhaseCount,
+};
+
+// Reads LIBC_STARTUP_TRACE from envp; must be called before any of the others.
+__LIBC_HIDDEN__ void __libc_startup_trace_init(char** envp);
+
+__LIBC_HIDDEN__ void __libc_startup_trace_begin(StartupPhase phase);
+__LIBC_HIDDEN__ void __libc_startup_trace_end(StartupPhase phase);
+
+// Writes the summary; called just before main().
+__LIBC_HIDDEN__ void __libc_startup_trace_report();
+
+class ScopedStartupPhase {
+ public:
+  explicit ScopedStartupPhase(StartupPhase phase) : phase_(phase) {
+    __libc_startup_trace_begin(phase_);
+  }
+  ~ScopedStartupPhase() {
+    __libc_startup_trace_end(phase_);
+  }
+
+ private:
+  StartupPhase phase_;
+
+  DISALLOW_COPY_AND_ASSIGN(ScopedStartupPhase);
+};
+
+#endif  // _PRIVATE_BIONIC_STARTUP_TRACE_H
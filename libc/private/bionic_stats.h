@@ -0,0 +1,62 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef BIONIC_STATS_H
+#define BIONIC_STATS_H
+
+#include <stdint.h>
+#include <sys/cdefs.h>
+
+// The counters and histograms that every thread keeps for android_libc_stats_iterate, in its
+// pthread_internal_t. Only the thread itself writes them, so a relaxed load, add and store is
+// enough, with no locked instruction. Their names are in libc_stats.cpp.
+
+enum libc_stat_counter {
+  LIBC_STAT_PROPERTY_FINDS,
+  LIBC_STAT_THREAD_STACK_CACHE_HITS,
+  LIBC_STAT_THREAD_STACK_CACHE_MISSES,
+  LIBC_STAT_COUNTER_COUNT
+};
+
+enum libc_stat_histogram {
+  LIBC_STAT_STDIO_READ_BYTES,
+  LIBC_STAT_STDIO_WRITE_BYTES,
+  LIBC_STAT_HISTOGRAM_COUNT
+};
+
+// Bucket 0 counts samples of 0, bucket i those below 4^i, and the last bucket all the rest.
+#define LIBC_STAT_HISTOGRAM_BUCKETS 16
+
+struct libc_thread_stats {
+  uint64_t counters[LIBC_STAT_COUNTER_COUNT];
+  uint64_t histograms[LIBC_STAT_HISTOGRAM_COUNT][LIBC_STAT_HISTOGRAM_BUCKETS];
+};
+
+struct android_libc_stat;
+
+__BEGIN_DECLS
+
+// Both do nothing before the calling thread's TLS is set up.
+__LIBC_HIDDEN__ void __libc_stats_count(enum libc_stat_counter counter);
+__LIBC_HIDDEN__ void __libc_stats_sample(enum libc_stat_histogram histogram, uint64_t value);
+
+// Reports the DNS cache and query counters of res_cache.c, summed over every network.
+__LIBC_HIDDEN__ void _resolv_cache_libc_stats(
+    void (*callback)(const struct android_libc_stat* stat, void* arg), void* arg);
+
+__END_DECLS
+
+#endif
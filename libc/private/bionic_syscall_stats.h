@@ -0,0 +1,38 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef BIONIC_SYSCALL_STATS_H
+#define BIONIC_SYSCALL_STATS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/cdefs.h>
+
+// The interface between syscall_stats.cpp and the wrappers gensyscalls.py --syscall-stats
+// generates for libc_syscall_stats.so. Each wrapper calls __syscall_stats_begin, makes the system
+// call, and then calls __syscall_stats_end with the index of its name in __syscall_stats_names.
+
+__BEGIN_DECLS
+
+__LIBC_HIDDEN__ extern const char* const __syscall_stats_names[];
+__LIBC_HIDDEN__ extern const size_t __syscall_stats_count;
+
+__LIBC_HIDDEN__ uint64_t __syscall_stats_begin();
+__LIBC_HIDDEN__ void __syscall_stats_end(size_t index, uint64_t start);
+
+__END_DECLS
+
+#endif
@@ -32,4 +32,9 @@ class __LIBC_HIDDEN__ ScopedTrace {
   DISALLOW_COPY_AND_ASSIGN(ScopedTrace);
 };
 
+// Writes out the calling thread's buffered markers, if any.
+__LIBC_HIDDEN__ void __bionic_systrace_flush();
+// Writes out and frees the calling thread's buffered markers; later ones aren't buffered.
+__LIBC_HIDDEN__ void __bionic_systrace_thread_exit();
+
 #endif
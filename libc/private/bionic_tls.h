@@ -74,6 +74,14 @@ enum {
   // state.
   TLS_SLOT_TSAN,
 
+  // The thread's registered rseq area, if any, for reading the current CPU and running per-CPU
+  // critical sections (see bionic_rseq.h).
+  TLS_SLOT_RSEQ,
+
+  // The thread's dynamic thread vector for ELF TLS, or null until the thread first touches a
+  // TLS variable (see bionic_elf_tls.h).
+  TLS_SLOT_DTV,
+
   BIONIC_TLS_SLOTS // Must come last!
 };
 
@@ -89,7 +97,6 @@ enum {
  *
  *  basename               libc (ThreadLocalBuffer)
  *  dirname                libc (ThreadLocalBuffer)
- *  uselocale              libc (can be used in constructors)
  *  getmntent_mntent       libc (ThreadLocalBuffer)
  *  getmntent_strings      libc (ThreadLocalBuffer)
  *  ptsname                libc (ThreadLocalBuffer)
@@ -99,6 +106,7 @@ enum {
  *  passwd                 libc (ThreadLocalBuffer)
  *  group                  libc (ThreadLocalBuffer)
  *  _res_key               libc (constructor in BSD code)
+ *  lcl_interval_key       libc (constructor in tzcode)
  */
 
 #define LIBC_PTHREAD_KEY_RESERVED_COUNT 12
@@ -113,6 +121,14 @@ enum {
  */
 #define BIONIC_PTHREAD_KEY_COUNT (BIONIC_PTHREAD_KEY_RESERVED_COUNT + PTHREAD_KEYS_MAX)
 
+/*
+ * Once those are used up, more pthread keys are allocated in pages of
+ * BIONIC_PTHREAD_KEY_PAGE_KEYS keys, which are mapped on demand.
+ */
+#define BIONIC_PTHREAD_KEY_PAGE_KEYS 128
+#define BIONIC_PTHREAD_KEY_PAGE_COUNT 31
+#define BIONIC_PTHREAD_KEY_EXTRA_COUNT (BIONIC_PTHREAD_KEY_PAGE_KEYS * BIONIC_PTHREAD_KEY_PAGE_COUNT)
+
 __END_DECLS
 
 #if defined(__cplusplus)
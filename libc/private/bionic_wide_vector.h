@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _BIONIC_WIDE_VECTOR_H_
+#define _BIONIC_WIDE_VECTOR_H_
+
+#include <stdint.h>
+#include <string.h>
+#include <sys/user.h>
+#include <wchar.h>
+
+// Helpers for the wide string functions, which work on four wchar_t at a
+// time using the compiler's generic vector extensions. That's NEON on arm64
+// and SSE2 on x86_64 without any per-architecture code.
+
+typedef int32_t wide4 __attribute__((vector_size(16)));
+
+static constexpr size_t kWide4Lanes = sizeof(wide4) / sizeof(wchar_t);
+
+static inline wide4 wide4_load(const wchar_t* p) {
+  wide4 v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+static inline void wide4_store(wchar_t* p, wide4 v) {
+  memcpy(p, &v, sizeof(v));
+}
+
+static inline wide4 wide4_splat(wchar_t c) {
+  return static_cast<int32_t>(c) - wide4{};
+}
+
+// Returns the index of the first non-zero lane of a comparison result, or
+// kWide4Lanes if there isn't one.
+static inline size_t wide4_first(wide4 mask) {
+  uint64_t halves[2];
+  memcpy(halves, &mask, sizeof(halves));
+  if (halves[0] != 0) return (halves[0] & 0xffffffff) ? 0 : 1;
+  if (halves[1] != 0) return (halves[1] & 0xffffffff) ? 2 : 3;
+  return kWide4Lanes;
+}
+
+// Is any lane of a comparison result set?
+static inline bool wide4_any(wide4 mask) {
+  uint64_t halves[2];
+  memcpy(halves, &mask, sizeof(halves));
+  return (halves[0] | halves[1]) != 0;
+}
+
+// Clears the lanes of a comparison result before the one p points to, for
+// when p has been rounded down to wide4 alignment.
+static inline wide4 wide4_from(wide4 mask, const wchar_t* p) {
+  const wide4 lanes = { 0, 1, 2, 3 };
+  int32_t first = (reinterpret_cast<uintptr_t>(p) % sizeof(wide4)) / sizeof(wchar_t);
+  return mask & (lanes >= first);
+}
+
+// Rounds p down to wide4 alignment. An aligned block never crosses a page,
+// so it can be read even if the string ends part way through it. This only
+// works for properly aligned wchar_t pointers; callers check.
+static inline const wchar_t* wide4_align(const wchar_t* p) {
+  return reinterpret_cast<const wchar_t*>(reinterpret_cast<uintptr_t>(p) & ~(sizeof(wide4) - 1));
+}
+
+// The main loops handle four blocks at a time. Starting from an address
+// aligned to that, they never cross a page either.
+static constexpr size_t kWide4Unroll = 4;
+
+static inline bool wide4_unroll_aligned(const wchar_t* p) {
+  return (reinterpret_cast<uintptr_t>(p) % (kWide4Unroll * sizeof(wide4))) == 0;
+}
+
+static inline bool wchar_aligned(const wchar_t* p) {
+  return (reinterpret_cast<uintptr_t>(p) % sizeof(wchar_t)) == 0;
+}
+
+// Can n bytes be read from p without crossing into the next page? For when
+// two strings are read side by side and can't both be aligned.
+static inline bool wide4_within_page(const wchar_t* p, size_t n = sizeof(wide4)) {
+  return (reinterpret_cast<uintptr_t>(p) & (PAGE_SIZE - 1)) <= PAGE_SIZE - n;
+}
+
+#endif  // _BIONIC_WIDE_VECTOR_H_
@@ -37,6 +37,10 @@ union kernel_sigset_t {
     __builtin_memset(this, 0, sizeof(*this));
   }
 
+  void fill() {
+    __builtin_memset(this, 0xff, sizeof(*this));
+  }
+
   void set(const sigset_t* value) {
     bionic = *value;
   }
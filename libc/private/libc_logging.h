@@ -33,6 +33,7 @@
 #include <stdarg.h>
 #include <stddef.h>
 #include <stdint.h>
+#include <sys/types.h>
 
 __BEGIN_DECLS
 
@@ -88,6 +89,13 @@ int __libc_format_log_va_list(int pri, const char* _Nonnull tag, const char* _No
 #endif
 int __libc_write_log(int pri, const char* _Nonnull tag, const char* _Nonnull msg);
 
+// For logging a message later, from another thread: the timestamp __libc_write_log would give
+// it now, and a __libc_write_log that takes the timestamp and thread id to record.
+struct timespec;
+void __libc_log_timestamp(struct timespec* _Nonnull ts);
+int __libc_write_log_stamped(int pri, const char* _Nonnull tag, const char* _Nonnull msg,
+                             pid_t tid, const struct timespec* _Nonnull ts);
+
 __END_DECLS
 
 #endif
@@ -50,7 +50,8 @@ __LIBC_HIDDEN__ void    _thread_arc4_unlock(void);
 #define _ARC4_UNLOCK() _thread_arc4_unlock()
 #define _ARC4_ATFORK(f) pthread_atfork(NULL, NULL, (f))
 
-extern volatile sig_atomic_t _rs_forked;
+/* Reseeds arc4random in a fork child, and releases the arc4random lock. */
+__LIBC_HIDDEN__ void    __arc4random_fork_child(void);
 
 __END_DECLS
 
@@ -0,0 +1,154 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+#include <stdint.h>
+#include <string.h>
+
+#include "local.h"
+#include "private/bionic_decimal.h"
+
+// A fast path for the double to decimal conversion behind printf's %e, %f and %g, which
+// otherwise means gdtoa's __dtoa: bignum arithmetic and a malloc for every value.
+//
+// Like Ryu's fixed-precision mode, this multiplies the double by a power of ten from a
+// table and reads the digits straight off the integer part of the product. The product
+// is exact for powers 10^0 to 10^54, which covers every ordinary %f and %e of a value
+// between about 1e-37 and 1e18. Outside that it uses a 128-bit approximation with a known
+// error bound. Either way the digits are correctly rounded (with gdtoa's round-half-even),
+// and a product too close to a tie to call is left to __dtoa, as are infinities, NaNs,
+// long doubles and requests for more than 18 significant digits (printf's %.17g round-trip
+// precision is covered).
+//
+// The results follow __dtoa's conventions for modes 2 and 3: a NUL-terminated digit string
+// with trailing zeros removed, the decimal exponent in *decpt, and the sign in *sign.
+
+// The most significant digits we produce: enough that an integer part up to ten times too
+// big while we search for the exponent still fits in 64 bits.
+#define MAX_DIGITS 18
+
+static const char kDigitPairs[] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+char* __dtoa_fast(double d, int mode, int ndigits, int* decpt, int* sign, char** rve, char* buf) {
+  uint64_t bits;
+  memcpy(&bits, &d, sizeof(bits));
+  int biased_exponent = (bits >> 52) & 0x7ff;
+  uint64_t f = bits & ((UINT64_C(1) << 52) - 1);
+  if (biased_exponent == 0x7ff) return nullptr;
+
+  *sign = bits >> 63;
+  if (biased_exponent == 0 && f == 0) {
+    buf[0] = '0';
+    buf[1] = '\0';
+    *decpt = 1;
+    *rve = buf + 1;
+    return buf;
+  }
+
+  // Normalize to d = f * 2^e with the top bit of f set.
+  int e;
+  if (biased_exponent == 0) {
+    e = -1074;
+  } else {
+    f |= UINT64_C(1) << 52;
+    e = biased_exponent - 1075;
+  }
+  int shift = __builtin_clzll(f);
+  f <<= shift;
+  e -= shift;
+
+  ScaledValue s;
+  uint64_t digits;
+  if (mode == 2) {
+    // ndigits significant digits: find k, the decimal exponent of d, so that the integer
+    // part of d * 10^(ndigits - 1 - k) has exactly ndigits digits. Our first guess, from
+    // the binary exponent, is at most one too small.
+    if (ndigits < 1 || ndigits > MAX_DIGITS) return nullptr;
+    int k = ((e + 63) * 78913) >> 18;
+    for (int attempt = 0; ; ++attempt) {
+      if (attempt == 3 || !scale_by_power_of_ten(f, e, ndigits - 1 - k, &s)) return nullptr;
+      if (s.integer >= powers_of_ten[ndigits]) {
+        ++k;
+      } else if (s.integer < powers_of_ten[ndigits - 1]) {
+        --k;
+      } else {
+        break;
+      }
+    }
+    if (!round_scaled_value(s, &digits)) return nullptr;
+    if (digits == powers_of_ten[ndigits]) {
+      // Rounded up to the next power of ten.
+      digits = powers_of_ten[ndigits - 1];
+      ++k;
+    }
+    *decpt = k + 1;
+  } else if (mode == 3) {
+    // ndigits digits after the decimal point: just the integer part of d * 10^ndigits.
+    // gdtoa has its own conventions when that rounds to zero, so leave those to it.
+    if (ndigits < 0 || !scale_by_power_of_ten(f, e, ndigits, &s) || !round_scaled_value(s, &digits) || digits == 0) {
+      return nullptr;
+    }
+    int n = 1;
+    while (n < 20 && digits >= powers_of_ten[n]) ++n;
+    *decpt = n - ndigits;
+  } else {
+    return nullptr;
+  }
+
+  while (digits % 10 == 0) digits /= 10;
+
+  // Write the digits backwards, two at a time, into the end of a 20-byte scratch area
+  // (enough for any uint64_t), then move them to the front of buf.
+  char tmp[20];
+  char* p = tmp + sizeof(tmp);
+  while (digits >= 100) {
+    unsigned pair = static_cast<unsigned>(digits % 100) * 2;
+    digits /= 100;
+    *--p = kDigitPairs[pair + 1];
+    *--p = kDigitPairs[pair];
+  }
+  if (digits >= 10) {
+    *--p = kDigitPairs[digits * 2 + 1];
+    *--p = kDigitPairs[digits * 2];
+  } else {
+    *--p = '0' + digits;
+  }
+  size_t length = tmp + sizeof(tmp) - p;
+  memcpy(buf, p, length);
+  buf[length] = '\0';
+  *rve = buf + length;
+  return buf;
+}
@@ -34,6 +34,20 @@
 #include <errno.h>
 #include <stdio.h>
 #include "local.h"
+#include "private/bionic_stats.h"
+
+/*
+ * Flush a registered write stream if it has anything buffered. The
+ * unlocked peek can only miss output from a write that is racing with
+ * fflush(NULL), which it could have been ordered after anyway.
+ */
+static int
+__sflush_pending(FILE *fp)
+{
+	if (fp->_bf._base == NULL || fp->_p == fp->_bf._base)
+		return (0);
+	return (__sflush_locked(fp));
+}
 
 /* Flush a single file, or (if fp is NULL) all files.  */
 int
@@ -42,7 +56,7 @@ fflush(FILE *fp)
 	int	r;
 
 	if (fp == NULL)
-		return (_fwalk(__sflush_locked));
+		return (__sfwalk_pending(__sflush_pending));
 	FLOCKFILE(fp);
 	if ((fp->_flags & (__SWR | __SRW)) == 0) {
 		errno = EBADF;
@@ -81,6 +95,7 @@ __sflush(FILE *fp)
 			fp->_flags |= __SERR;
 			return (EOF);
 		}
+		__libc_stats_sample(LIBC_STAT_STDIO_WRITE_BYTES, t);
 	}
 	return (0);
 }
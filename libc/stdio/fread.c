@@ -36,6 +36,8 @@
 #include <stdint.h>
 #include <errno.h>
 #include <sys/param.h>
+#include <sys/uio.h>
+#include <unistd.h>
 #include "local.h"
 
 #define MUL_NO_OVERFLOW	(1UL << (sizeof(size_t) * 4))
@@ -99,9 +101,10 @@ fread(void *buf, size_t size, size_t count, FILE *fp)
 
 		/*
 		 * Do we have so much more to read that we should
-		 * avoid copying it through the buffer?
+		 * avoid copying it through the buffer?  (Not if the
+		 * buffer is a mapping of the file.)
 		 */
-		if (total > (size_t) fp->_bf._size) {
+		if (total > (size_t) fp->_bf._size && !_EXT(fp)->_mmap) {
 			/*
 			 * Make sure that fseek doesn't think it can
 			 * reuse the buffer since we are going to read
@@ -121,8 +124,38 @@ fread(void *buf, size_t size, size_t count, FILE *fp)
 	}
 
 	/*
-	 * Read directly into the caller's buffer.
+	 * Read directly into the caller's buffer. If we're reading from
+	 * a file descriptor, the FILE buffer can be refilled by the same
+	 * readv, so that a caller reading a large amount but not exactly
+	 * the size of the file doesn't need another read for the tail.
+	 * That's only safe if the buffer isn't holding anything else:
+	 * pending writes, or the real buffer hidden by an ungetc buffer.
 	 */
+	if (fp->_read == __sread && (fp->_flags & __SRD) != 0 && !HASUB(fp) &&
+	    (fp->_flags & __SNBF) == 0) {
+		while (total > 0) {
+			struct iovec iov[2];
+			iov[0].iov_base = dst;
+			iov[0].iov_len = total;
+			iov[1].iov_base = fp->_bf._base;
+			iov[1].iov_len = fp->_bf._size;
+			ssize_t bytes_read = TEMP_FAILURE_RETRY(readv(fp->_file, iov, 2));
+			if (bytes_read <= 0) {
+				fp->_flags |= (bytes_read == 0) ? __SEOF : __SERR;
+				break;
+			}
+			if ((size_t) bytes_read > total) {
+				fp->_p = fp->_bf._base;
+				fp->_r = bytes_read - total;
+				fp->_flags &= ~__SMOD;
+				total = 0;
+				break;
+			}
+			dst += bytes_read;
+			total -= bytes_read;
+		}
+		goto out;
+	}
 	while (total > 0) {
 		ssize_t bytes_read = (*fp->_read)(fp->_cookie, dst, total);
 		if (bytes_read <= 0) {
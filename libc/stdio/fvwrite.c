@@ -35,9 +35,62 @@
 #include <stdlib.h>
 #include <string.h>
 #include <errno.h>
+#include <sys/uio.h>
+#include <unistd.h>
 #include "local.h"
 #include "fvwrite.h"
 
+/*
+ * Can writev_buffered be used instead of filling and flushing the
+ * buffer, then writing the rest of len bytes directly? Only if the
+ * FILE is backed by a file descriptor, and only if the rest would
+ * have been written directly anyway: otherwise filling and flushing
+ * is one write too, and the rest stays buffered.
+ */
+static int
+can_writev(FILE *fp, size_t len, size_t room)
+{
+	return (fp->_write == __swrite && fp->_p > fp->_bf._base &&
+	    len > room && len - room >= (size_t)fp->_bf._size);
+}
+
+/*
+ * Write the buffered bytes followed by up to len bytes from p with
+ * as few writev calls as possible, and empty the buffer. Returns the
+ * number of bytes of p written, or -1 on error.
+ */
+static int
+writev_buffered(FILE *fp, const char *p, size_t len)
+{
+	struct iovec iov[2];
+	ssize_t n;
+
+	iov[0].iov_base = fp->_bf._base;
+	iov[0].iov_len = fp->_p - fp->_bf._base;
+	iov[1].iov_base = (void *)p;
+	iov[1].iov_len = len;
+
+	/* As in __sflush, leave the FILE consistent even if we fail. */
+	fp->_p = fp->_bf._base;
+	fp->_w = (fp->_flags & (__SLBF|__SNBF)) ? 0 : fp->_bf._size;
+
+	if (fp->_flags & __SAPP)
+		(void)TEMP_FAILURE_RETRY(lseek64(fp->_file, 0, SEEK_END));
+	while (iov[0].iov_len > 0) {
+		n = TEMP_FAILURE_RETRY(writev(fp->_file, iov, 2));
+		if (n <= 0)
+			return (-1);
+		if ((size_t)n < iov[0].iov_len) {
+			iov[0].iov_base = (char *)iov[0].iov_base + n;
+			iov[0].iov_len -= n;
+			continue;
+		}
+		/* The buffer's out; the rest is how much of p got written. */
+		return (n - iov[0].iov_len);
+	}
+	return (0);
+}
+
 /*
  * Write some memory regions.  Return zero on success, EOF on error.
  *
@@ -103,7 +156,7 @@ __sfvwrite(FILE *fp, struct __suio *uio)
 		do {
 			GETIOV(;);
 			if ((fp->_flags & (__SALC | __SSTR)) ==
-			    (__SALC | __SSTR) && fp->_w < len) {
+			    (__SALC | __SSTR) && (size_t)fp->_w < len) {
 				size_t blen = fp->_p - fp->_bf._base;
 				unsigned char *_base;
 				int _size;
@@ -112,7 +165,7 @@ __sfvwrite(FILE *fp, struct __suio *uio)
 				_size = fp->_bf._size;
 				do {
 					_size = (_size << 1) + 1;
-				} while (_size < blen + len);
+				} while ((size_t)_size < blen + len);
 				_base = realloc(fp->_bf._base, _size + 1);
 				if (_base == NULL)
 					goto err;
@@ -123,20 +176,25 @@ __sfvwrite(FILE *fp, struct __suio *uio)
 			}
 			w = fp->_w;
 			if (fp->_flags & __SSTR) {
-				if (len < w)
+				if (len < (size_t)w)
 					w = len;
 				COPY(w);	/* copy MIN(fp->_w,len), */
 				fp->_w -= w;
 				fp->_p += w;
 				w = len;	/* but pretend copied all */
-			} else if (fp->_p > fp->_bf._base && len > w) {
+			} else if (can_writev(fp, len, w)) {
+				/* flush and write directly, in one go */
+				w = writev_buffered(fp, p, len);
+				if (w < 0)
+					goto err;
+			} else if (fp->_p > fp->_bf._base && len > (size_t)w) {
 				/* fill and flush */
 				COPY(w);
 				/* fp->_w -= w; */ /* unneeded */
 				fp->_p += w;
 				if (__sflush(fp))
 					goto err;
-			} else if (len >= (w = fp->_bf._size)) {
+			} else if (len >= (size_t)(w = fp->_bf._size)) {
 				/* write directly */
 				w = (*fp->_write)(fp->_cookie, p, w);
 				if (w <= 0)
@@ -165,12 +223,16 @@ __sfvwrite(FILE *fp, struct __suio *uio)
 			GETIOV(nlknown = 0);
 			if (!nlknown) {
 				nl = memchr((void *)p, '\n', len);
-				nldist = nl ? nl + 1 - p : len + 1;
+				nldist = nl ? nl + 1 - p : (int)len + 1;
 				nlknown = 1;
 			}
-			s = MIN(len, nldist);
+			s = MIN(len, (size_t)nldist);
 			w = fp->_w + fp->_bf._size;
-			if (fp->_p > fp->_bf._base && s > w) {
+			if (can_writev(fp, s, w)) {
+				w = writev_buffered(fp, p, s);
+				if (w < 0)
+					goto err;
+			} else if (fp->_p > fp->_bf._base && s > w) {
 				COPY(w);
 				/* fp->_w -= w; */
 				fp->_p += w;
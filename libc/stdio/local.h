@@ -122,6 +122,26 @@ struct __sfileext {
   // Equivalent to `_seek` but for _FILE_OFFSET_BITS=64.
   // Callers should use this but fall back to `__sFILE::_seek`.
   off64_t (*_seek64)(void*, off64_t, int);
+
+  // __fsetaccesspattern support: one of POSIX_FADV_NORMAL, POSIX_FADV_SEQUENTIAL or
+  // POSIX_FADV_RANDOM, used by __swhatbuf to size the buffer and by __srefill to advise
+  // the kernel about a mapping.
+  int _access_pattern;
+
+  // fopen's "m" mode: reads come from a window of the file mapped at _mmap_offset, which
+  // `_bf` points to instead of a malloc()ed buffer.
+  bool _mmap;
+  off64_t _mmap_offset;
+
+  // __sfp's free list. A closed FILE that's freopen()ed stays on the list until __sfp
+  // next reaches it, so _on_free_list stops fclose from adding it twice.
+  FILE* _next_free;
+  bool _on_free_list;
+
+  // The write stream registry (see __sregister_writer). A FILE stays registered when it's
+  // closed and reused.
+  FILE* _next_writer;
+  bool _writer_registered;
 };
 
 // Values for `__sFILE::_flags`.
@@ -163,6 +183,8 @@ do { \
 	pthread_mutex_init(&_FLOCK(fp), &attr); \
 	pthread_mutexattr_destroy(&attr); \
 	_EXT(fp)->_caller_handles_locking = false; \
+	_EXT(fp)->_access_pattern = 0; /* POSIX_FADV_NORMAL */ \
+	_EXT(fp)->_mmap = false; \
 } while (0)
 
 #define _FILEEXT_SETUP(f, fext) \
@@ -199,9 +221,15 @@ __LIBC32_LEGACY_PUBLIC__ int _fwalk(int (*)(FILE *));
 off64_t __sseek64(void*, off64_t, int);
 int	__sflush_locked(FILE *);
 int	__swhatbuf(FILE *, size_t *, int *);
+__LIBC_HIDDEN__ extern size_t __sdefault_bufsize;
+__LIBC_HIDDEN__ void __sregister_writer(FILE*);
+__LIBC_HIDDEN__ void __sunmap(FILE*);
+__LIBC_HIDDEN__ int __sfwalk_pending(int (*)(FILE*));
 wint_t __fgetwc_unlock(FILE *);
 wint_t	__ungetwc(wint_t, FILE *);
 int	__vfprintf(FILE *, const char *, __va_list);
+__LIBC_HIDDEN__ bool __vfprintf_fast(FILE*, const char*, __va_list, int*);
+__LIBC_HIDDEN__ char* __dtoa_fast(double, int, int, int*, int*, char**, char*);
 int	__svfscanf(FILE * __restrict, const char * __restrict, __va_list);
 int	__vfwprintf(FILE * __restrict, const wchar_t * __restrict, __va_list);
 int	__vfwscanf(FILE * __restrict, const wchar_t * __restrict, __va_list);
@@ -233,8 +261,17 @@ int	__vfwscanf(FILE * __restrict, const wchar_t * __restrict, __va_list);
 	(fp)->_lb._base = NULL; \
 }
 
-#define FLOCKFILE(fp)   if (!_EXT(fp)->_caller_handles_locking) flockfile(fp)
-#define FUNLOCKFILE(fp) if (!_EXT(fp)->_caller_handles_locking) funlockfile(fp)
+// Set by pthread_create before the process's second thread exists, and never cleared.
+// Until then no other thread can be contending for a FILE, so stdio skips its internal
+// locking entirely (like glibc's SINGLE_THREAD_P). If a funopen callback creates the first
+// thread mid-call, the matching FUNLOCKFILE just fails with EPERM on the unowned recursive
+// mutex. Explicit flockfile(3) calls always lock.
+extern int __isthreaded;
+
+#define _FLOCKING_NEEDED(fp) (__isthreaded && !_EXT(fp)->_caller_handles_locking)
+
+#define FLOCKFILE(fp)   if (_FLOCKING_NEEDED(fp)) flockfile(fp)
+#define FUNLOCKFILE(fp) if (_FLOCKING_NEEDED(fp)) funlockfile(fp)
 
 #define FLOATING_POINT
 #define PRINTF_WIDE_CHAR
@@ -33,6 +33,7 @@
 
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <fcntl.h>
 #include <unistd.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -53,6 +54,9 @@ __smakebuf(FILE *fp)
 	size_t size;
 	int couldbetty;
 
+	/* __srefill points the buffer at a mapping of the file instead */
+	if (_EXT(fp)->_mmap)
+		return;
 	if (fp->_flags & __SNBF) {
 		fp->_bf._base = fp->_p = fp->_nbuf;
 		fp->_bf._size = 1;
@@ -73,6 +77,35 @@ __smakebuf(FILE *fp)
 	fp->_flags |= flags;
 }
 
+/*
+ * Buffer size for streams the caller has declared sequential with
+ * __fsetaccesspattern. Large enough that each refill or flush is one
+ * big read(2) or write(2) rather than a trickle of block-sized ones.
+ */
+#define SEQUENTIAL_BUFSIZ (64 * 1024)
+
+/*
+ * Scale the natural buffer size for `fp' (st_blksize, or BUFSIZ) by the
+ * stream's access pattern and the process-wide LIBC_STDIO_BUFSIZ default.
+ * Random access keeps the natural size, since a bigger buffer only means
+ * reading more data that will be discarded by the next fseek.
+ */
+static size_t
+__sbufsize(FILE *fp, size_t size)
+{
+	switch (_EXT(fp)->_access_pattern) {
+	case POSIX_FADV_RANDOM:
+		return (size);
+	case POSIX_FADV_SEQUENTIAL:
+		if (size < SEQUENTIAL_BUFSIZ)
+			size = SEQUENTIAL_BUFSIZ;
+		break;
+	}
+	if (size < __sdefault_bufsize)
+		size = __sdefault_bufsize;
+	return (size);
+}
+
 /*
  * Internal routine to determine `proper' buffering for a file.
  */
@@ -83,14 +116,14 @@ __swhatbuf(FILE *fp, size_t *bufsize, int *couldbetty)
 
 	if (fp->_file < 0 || fstat(fp->_file, &st) < 0) {
 		*couldbetty = 0;
-		*bufsize = BUFSIZ;
+		*bufsize = __sbufsize(fp, BUFSIZ);
 		return (__SNPT);
 	}
 
 	/* could be a tty iff it is a character device */
 	*couldbetty = S_ISCHR(st.st_mode);
 	if (st.st_blksize == 0) {
-		*bufsize = BUFSIZ;
+		*bufsize = *couldbetty ? BUFSIZ : __sbufsize(fp, BUFSIZ);
 		return (__SNPT);
 	}
 
@@ -98,8 +131,11 @@ __swhatbuf(FILE *fp, size_t *bufsize, int *couldbetty)
 	 * Optimise fseek() only if it is a regular file.  (The test for
 	 * __sseek is mainly paranoia.)  It is safe to set _blksize
 	 * unconditionally; it will only be used if __SOPT is also set.
+	 * Character devices keep their natural size: a tty is line
+	 * buffered and gains nothing from a larger buffer.
 	 */
-	*bufsize = st.st_blksize;
+	*bufsize = *couldbetty ? (size_t)st.st_blksize :
+	    __sbufsize(fp, st.st_blksize);
 	fp->_blksize = st.st_blksize;
 	return ((st.st_mode & S_IFMT) == S_IFREG && fp->_seek == __sseek ?
 	    __SOPT : __SNPT);
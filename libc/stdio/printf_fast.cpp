@@ -0,0 +1,496 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+#include <errno.h>
+#include <limits.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/types.h>
+
+#include "local.h"
+#include "fvwrite.h"
+
+// A fast path for the printf family covering what most callers (logging in particular)
+// actually use: %d, %i, %u, %o, %x, %X, %c, %s, %p and %%, with the usual flags, widths,
+// precisions and integer length modifiers. Anything else -- floating point, positional
+// arguments, wide characters, %n, or a format that isn't plain ASCII -- is left to the
+// general OpenBSD __vfprintf, and the output here must be byte-for-byte the same as
+// that would have produced.
+//
+// The format is checked in a first pass that consumes no arguments, so falling back
+// is always possible. The second pass formats each conversion in one step, emitting
+// decimal digits two at a time from a table, and copies straight into the destination
+// for snprintf or into a local buffer handed to __sfvwrite in large chunks otherwise.
+
+namespace {
+
+enum {
+  LADJUST = 0x001,
+  ALT = 0x002,
+  ZEROPAD = 0x004,
+  // Integer sizes, tested in the same order as __vfprintf's SARG and UARG.
+  MAXINT = 0x010,
+  LLONGINT = 0x020,
+  LONGINT = 0x040,
+  PTRINT = 0x080,
+  SIZEINT = 0x100,
+  SHORTINT = 0x200,
+  CHARINT = 0x400,
+};
+
+enum ParseResult {
+  kParsed,
+  kUnsupported,
+  kOverflow,
+};
+
+struct Spec {
+  int flags;
+  int width;
+  int prec;
+  char sign;
+  char conv;
+};
+
+static const char kDigitPairs[] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+static inline bool is_digit(char ch) {
+  return static_cast<unsigned>(ch - '0') <= 9;
+}
+
+// Parses a run of digits the way __vfprintf's APPEND_DIGIT does, failing on int overflow.
+static bool ParseDigits(const char** fmt, int* value) {
+  int n = 0;
+  while (is_digit(**fmt)) {
+    int digit = **fmt - '0';
+    if (n > INT_MAX / 10 || n * 10 > INT_MAX - digit) return false;
+    n = n * 10 + digit;
+    ++*fmt;
+  }
+  *value = n;
+  return true;
+}
+
+// Handles a '*' width or precision. A "*N$" positional argument isn't supported.
+// Without `ap` (the checking pass), no argument is consumed and the value is 0.
+static ParseResult ParseAster(const char* fmt, va_list* ap, int* value) {
+  int n;
+  if (!ParseDigits(&fmt, &n)) return kOverflow;
+  if (*fmt == '$') return kUnsupported;
+  *value = (ap != nullptr) ? va_arg(*ap, int) : 0;
+  return kParsed;
+}
+
+// Parses one conversion specification, starting just after its '%', mirroring the rflag
+// loop in __vfprintf. Any conversion that isn't handled here is kUnsupported.
+static ParseResult ParseSpec(const char** fmt_ptr, va_list* ap, Spec* spec) {
+  const char* fmt = *fmt_ptr;
+  spec->flags = 0;
+  spec->width = 0;
+  spec->prec = -1;
+  spec->sign = '\0';
+
+  for (;;) {
+    char ch = *fmt++;
+    int n;
+    ParseResult result;
+    switch (ch) {
+      case ' ':
+        if (!spec->sign) spec->sign = ' ';
+        continue;
+      case '#':
+        spec->flags |= ALT;
+        continue;
+      case '\'':
+        continue;
+      case '*':
+        if ((result = ParseAster(fmt, ap, &n)) != kParsed) return result;
+        if (n >= 0) {
+          spec->width = n;
+          continue;
+        }
+        if (n == INT_MIN) return kOverflow;
+        spec->width = -n;
+        spec->flags |= LADJUST;
+        continue;
+      case '-':
+        spec->flags |= LADJUST;
+        continue;
+      case '+':
+        spec->sign = '+';
+        continue;
+      case '.':
+        if (*fmt == '*') {
+          if ((result = ParseAster(++fmt, ap, &n)) != kParsed) return result;
+          spec->prec = (n < 0) ? -1 : n;
+          continue;
+        }
+        if (!ParseDigits(&fmt, &n)) return kOverflow;
+        if (*fmt == '$') return kUnsupported;
+        spec->prec = n;
+        continue;
+      case '0':
+        spec->flags |= ZEROPAD;
+        continue;
+      case '1': case '2': case '3': case '4':
+      case '5': case '6': case '7': case '8': case '9':
+        --fmt;
+        if (!ParseDigits(&fmt, &n)) return kOverflow;
+        if (*fmt == '$') return kUnsupported;
+        spec->width = n;
+        continue;
+      case 'h':
+        if (*fmt == 'h') {
+          ++fmt;
+          spec->flags |= CHARINT;
+        } else {
+          spec->flags |= SHORTINT;
+        }
+        continue;
+      case 'j':
+        spec->flags |= MAXINT;
+        continue;
+      case 'l':
+        if (*fmt == 'l') {
+          ++fmt;
+          spec->flags |= LLONGINT;
+        } else {
+          spec->flags |= LONGINT;
+        }
+        continue;
+      case 'q':
+        spec->flags |= LLONGINT;
+        continue;
+      case 't':
+        spec->flags |= PTRINT;
+        continue;
+      case 'z':
+        spec->flags |= SIZEINT;
+        continue;
+      case 'D':
+      case 'O':
+      case 'U':
+        spec->flags |= LONGINT;
+        ch += 'a' - 'A';
+        break;
+      case 'c':
+      case 's':
+        // %lc and %ls take wide characters.
+        if (spec->flags & LONGINT) return kUnsupported;
+        break;
+      case 'd': case 'i': case 'o': case 'u': case 'x': case 'X': case 'p': case '%':
+        break;
+      default:
+        return kUnsupported;
+    }
+    spec->conv = ch;
+    *fmt_ptr = fmt;
+    return kParsed;
+  }
+}
+
+// The checking pass: true if every conversion in `fmt` is one ParseSpec handles.
+static bool IsSupported(const char* fmt) {
+  for (;;) {
+    unsigned char ch = *fmt++;
+    if (ch == '\0') return true;
+    // __vfprintf decodes the literal text with mbrtowc, which can fail.
+    if (ch >= 0x80) return false;
+    if (ch == '%') {
+      Spec spec;
+      if (ParseSpec(&fmt, nullptr, &spec) != kParsed) return false;
+    }
+  }
+}
+
+static intmax_t GetSignedArg(va_list* ap, int flags) {
+  if (flags & MAXINT) return va_arg(*ap, intmax_t);
+  if (flags & LLONGINT) return va_arg(*ap, long long);
+  if (flags & LONGINT) return va_arg(*ap, long);
+  if (flags & PTRINT) return va_arg(*ap, ptrdiff_t);
+  if (flags & SIZEINT) return va_arg(*ap, ssize_t);
+  if (flags & SHORTINT) return static_cast<short>(va_arg(*ap, int));
+  if (flags & CHARINT) return static_cast<signed char>(va_arg(*ap, int));
+  return va_arg(*ap, int);
+}
+
+static uintmax_t GetUnsignedArg(va_list* ap, int flags) {
+  if (flags & MAXINT) return va_arg(*ap, uintmax_t);
+  if (flags & LLONGINT) return va_arg(*ap, unsigned long long);
+  if (flags & LONGINT) return va_arg(*ap, unsigned long);
+  if (flags & PTRINT) return static_cast<uintptr_t>(va_arg(*ap, ptrdiff_t));
+  if (flags & SIZEINT) return va_arg(*ap, size_t);
+  if (flags & SHORTINT) return static_cast<unsigned short>(va_arg(*ap, int));
+  if (flags & CHARINT) return static_cast<unsigned char>(va_arg(*ap, int));
+  return va_arg(*ap, unsigned int);
+}
+
+// Writes the decimal digits of `value` backwards from `end`, two at a time. Values that
+// fit in 32 bits use 32-bit division, which is much cheaper on 32-bit targets.
+static char* FormatDecimal(uintmax_t value, char* end) {
+  while (value > UINT32_MAX) {
+    unsigned pair = static_cast<unsigned>(value % 100) * 2;
+    value /= 100;
+    *--end = kDigitPairs[pair + 1];
+    *--end = kDigitPairs[pair];
+  }
+  uint32_t v = static_cast<uint32_t>(value);
+  while (v >= 100) {
+    unsigned pair = (v % 100) * 2;
+    v /= 100;
+    *--end = kDigitPairs[pair + 1];
+    *--end = kDigitPairs[pair];
+  }
+  if (v >= 10) {
+    *--end = kDigitPairs[v * 2 + 1];
+    *--end = kDigitPairs[v * 2];
+  } else {
+    *--end = '0' + v;
+  }
+  return end;
+}
+
+// Collects output for `fp`. String streams from snprintf are written in place, silently
+// truncating at the end of the buffer just like __sfvwrite does for __SSTR. Everything
+// else (including vasprintf's growable strings) is buffered locally and handed to
+// __sfvwrite a chunk at a time, so a whole line usually costs one call.
+class Sink {
+ public:
+  explicit Sink(FILE* fp)
+      : fp_(fp), direct_((fp->_flags & (__SSTR | __SALC)) == __SSTR), p_(buf_), failed_(false) {
+  }
+
+  void Write(const char* s, size_t n) {
+    if (direct_) {
+      // _w can be negative from vsprintf's SSIZE_MAX size; like __sfvwrite, treat it as huge.
+      size_t room = static_cast<size_t>(fp_->_w);
+      if (n < room) room = n;
+      memcpy(fp_->_p, s, room);
+      fp_->_p += room;
+      fp_->_w -= room;
+      return;
+    }
+    while (n > 0) {
+      size_t room = buf_ + sizeof(buf_) - p_;
+      if (room == 0) {
+        Flush();
+        room = sizeof(buf_);
+      }
+      if (n < room) room = n;
+      memcpy(p_, s, room);
+      p_ += room;
+      s += room;
+      n -= room;
+    }
+  }
+
+  void Pad(char ch, int n) {
+    static const char blanks[16] = {
+      ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ',
+    };
+    static const char zeroes[16] = {
+      '0', '0', '0', '0', '0', '0', '0', '0', '0', '0', '0', '0', '0', '0', '0', '0',
+    };
+    const char* with = (ch == '0') ? zeroes : blanks;
+    for (; n > 0; n -= sizeof(blanks)) {
+      Write(with, (n < static_cast<int>(sizeof(blanks))) ? n : sizeof(blanks));
+    }
+  }
+
+  void Flush() {
+    if (p_ != buf_ && !failed_) {
+      __siov iov = { buf_, static_cast<size_t>(p_ - buf_) };
+      __suio uio = { &iov, 1, static_cast<int>(p_ - buf_) };
+      // On error __sfvwrite sets __SERR, which our caller checks.
+      if (__sfvwrite(fp_, &uio) != 0) failed_ = true;
+    }
+    p_ = buf_;
+  }
+
+ private:
+  FILE* fp_;
+  bool direct_;
+  char* p_;
+  bool failed_;
+  char buf_[BUFSIZ];
+};
+
+// Formats one parsed conversion, following the layout rules at the end of __vfprintf's
+// conversion loop. Returns the number of bytes it produces.
+static int FormatSpec(Sink* sink, Spec* spec, va_list* ap) {
+  // Enough for a 64-bit value in octal plus %#o's leading 0.
+  char buf[24];
+  char* const end = buf + sizeof(buf);
+  const char* cp;
+  int size;
+  int dprec = 0;
+  char ox = '\0';
+  uintmax_t value;
+  const char* xdigs = "0123456789abcdef";
+
+  switch (spec->conv) {
+    case 'c':
+      buf[0] = static_cast<char>(va_arg(*ap, int));
+      cp = buf;
+      size = 1;
+      spec->sign = '\0';
+      break;
+    case '%':
+      buf[0] = '%';
+      cp = buf;
+      size = 1;
+      spec->sign = '\0';
+      break;
+    case 's':
+      cp = va_arg(*ap, const char*);
+      if (cp == nullptr) cp = "(null)";
+      if (spec->prec >= 0) {
+        const char* nul = static_cast<const char*>(memchr(cp, 0, spec->prec));
+        size = nul ? (nul - cp) : spec->prec;
+      } else {
+        size_t len = strlen(cp);
+        if (len > INT_MAX) return -1;
+        size = len;
+      }
+      spec->sign = '\0';
+      break;
+    default:
+      if (spec->conv == 'd' || spec->conv == 'i') {
+        intmax_t svalue = GetSignedArg(ap, spec->flags);
+        value = svalue;
+        if (svalue < 0) {
+          value = -value;
+          spec->sign = '-';
+        }
+      } else {
+        if (spec->conv == 'p') {
+          value = reinterpret_cast<uintptr_t>(va_arg(*ap, void*));
+          ox = 'x';
+        } else {
+          value = GetUnsignedArg(ap, spec->flags);
+          if (spec->conv == 'X') xdigs = "0123456789ABCDEF";
+          if ((spec->conv == 'x' || spec->conv == 'X') && (spec->flags & ALT) && value != 0) {
+            ox = spec->conv;
+          }
+        }
+        spec->sign = '\0';
+      }
+      if ((dprec = spec->prec) >= 0) spec->flags &= ~ZEROPAD;
+
+      char* p = end;
+      if (value != 0 || spec->prec != 0) {
+        if (spec->conv == 'o') {
+          do {
+            *--p = '0' + (value & 7);
+            value >>= 3;
+          } while (value);
+          if ((spec->flags & ALT) && *p != '0') *--p = '0';
+        } else if (spec->conv == 'x' || spec->conv == 'X' || spec->conv == 'p') {
+          do {
+            *--p = xdigs[value & 15];
+            value >>= 4;
+          } while (value);
+        } else {
+          p = FormatDecimal(value, end);
+        }
+      }
+      cp = p;
+      size = end - p;
+      break;
+  }
+
+  int realsz = (dprec > size) ? dprec : size;
+  if (spec->sign) realsz++;
+  if (ox) realsz += 2;
+
+  int width = spec->width;
+  int flags = spec->flags;
+  if ((flags & (LADJUST | ZEROPAD)) == 0) sink->Pad(' ', width - realsz);
+  if (spec->sign) sink->Write(&spec->sign, 1);
+  if (ox) {
+    char prefix[2] = { '0', ox };
+    sink->Write(prefix, 2);
+  }
+  if ((flags & (LADJUST | ZEROPAD)) == ZEROPAD) sink->Pad('0', width - realsz);
+  sink->Pad('0', dprec - size);
+  sink->Write(cp, size);
+  if (flags & LADJUST) sink->Pad(' ', width - realsz);
+
+  return (width < realsz) ? realsz : width;
+}
+
+}  // namespace
+
+bool __vfprintf_fast(FILE* fp, const char* fmt, va_list ap0, int* result) {
+  if (!IsSupported(fmt)) return false;
+
+  Sink sink(fp);
+  va_list ap;
+  va_copy(ap, ap0);
+  int ret = 0;
+  for (;;) {
+    const char* cp = fmt;
+    while (*fmt != '\0' && *fmt != '%') ++fmt;
+    if (fmt != cp) {
+      ptrdiff_t m = fmt - cp;
+      if (m > INT_MAX - ret) goto overflow;
+      sink.Write(cp, m);
+      ret += m;
+    }
+    if (*fmt == '\0') break;
+    ++fmt;
+
+    Spec spec;
+    if (ParseSpec(&fmt, &ap, &spec) != kParsed) goto overflow;
+    int n = FormatSpec(&sink, &spec, &ap);
+    if (n < 0 || n > INT_MAX - ret) goto overflow;
+    ret += n;
+  }
+  sink.Flush();
+  va_end(ap);
+  *result = __sferror(fp) ? -1 : ret;
+  return true;
+
+overflow:
+  sink.Flush();
+  va_end(ap);
+  errno = ENOMEM;
+  *result = -1;
+  return true;
+}
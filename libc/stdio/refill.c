@@ -32,9 +32,19 @@
  */
 
 #include <errno.h>
+#include <fcntl.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/param.h>
+#include <sys/stat.h>
+#include <sys/user.h>
+#include <unistd.h>
 #include "local.h"
+#include "private/bionic_stats.h"
+
+/* How much of a file fopen's "m" mode maps at a time. */
+#define MMAP_WINDOW (2 * 1024 * 1024)
 
 static int
 lflush(FILE *fp)
@@ -44,6 +54,85 @@ lflush(FILE *fp)
 	return (0);
 }
 
+/*
+ * Unmap the window of a FILE opened with fopen's "m" mode, and turn
+ * that mode off.
+ */
+void
+__sunmap(FILE *fp)
+{
+	if (_EXT(fp)->_mmap && fp->_bf._base != NULL) {
+		munmap(fp->_bf._base, fp->_bf._size);
+		fp->_bf._base = fp->_p = NULL;
+		fp->_bf._size = 0;
+		fp->_r = 0;
+	}
+	_EXT(fp)->_mmap = false;
+}
+
+/*
+ * Refill a FILE opened with fopen's "m" mode by moving its window to
+ * the current file offset.  The file offset is then left at the end of
+ * the window, as if the window had been read, so that ftell, fseek and
+ * direct reads see the same file offset as they would with a buffer.
+ */
+static int
+mrefill(FILE *fp)
+{
+	struct __sfileext *ext = _EXT(fp);
+	struct stat64 sb;
+	off64_t pos, start;
+	size_t len;
+	void *p;
+
+	if ((pos = lseek64(fp->_file, 0, SEEK_CUR)) == -1 ||
+	    fstat64(fp->_file, &sb) == -1) {
+		fp->_flags |= __SERR;
+		return (EOF);
+	}
+	fp->_flags &= ~__SMOD;
+
+	/* fseek may have left us inside the current window. */
+	if (fp->_bf._base != NULL && pos >= ext->_mmap_offset &&
+	    pos < ext->_mmap_offset + (off64_t)fp->_bf._size) {
+		start = ext->_mmap_offset;
+		len = fp->_bf._size;
+	} else {
+		if (pos >= sb.st_size) {
+			fp->_flags |= __SEOF;
+			return (EOF);
+		}
+		if (fp->_bf._base != NULL) {
+			munmap(fp->_bf._base, fp->_bf._size);
+			fp->_bf._base = NULL;
+			fp->_bf._size = 0;
+		}
+		start = pos & ~(off64_t)(PAGE_SIZE - 1);
+		len = MIN(MMAP_WINDOW, sb.st_size - start);
+		/* Writable but private, since fgetln's callers may scribble. */
+		p = mmap64(NULL, len, PROT_READ | PROT_WRITE, MAP_PRIVATE,
+		    fp->_file, start);
+		if (p == MAP_FAILED) {
+			/* Carry on with an ordinary buffer instead. */
+			ext->_mmap = false;
+			return (__srefill(fp));
+		}
+		madvise(p, len, ext->_access_pattern == POSIX_FADV_RANDOM ?
+		    MADV_RANDOM : MADV_SEQUENTIAL);
+		fp->_bf._base = p;
+		fp->_bf._size = len;
+		ext->_mmap_offset = start;
+	}
+
+	if (lseek64(fp->_file, start + len, SEEK_SET) == -1) {
+		fp->_flags |= __SERR;
+		return (EOF);
+	}
+	fp->_p = fp->_bf._base + (pos - start);
+	fp->_r = len - (pos - start);
+	return (0);
+}
+
 /*
  * Refill a stdio buffer.
  * Return EOF on eof or error, 0 otherwise.
@@ -91,6 +180,9 @@ __srefill(FILE *fp)
 		}
 	}
 
+	if (_EXT(fp)->_mmap)
+		return (mrefill(fp));
+
 	if (fp->_bf._base == NULL)
 		__smakebuf(fp);
 
@@ -100,9 +192,9 @@ __srefill(FILE *fp)
 	 * standard.
 	 */
 	if (fp->_flags & (__SLBF|__SNBF)) {
-		/* Ignore this file in _fwalk to avoid potential deadlock. */
+		/* Ignore this file in the walk to avoid potential deadlock. */
 		fp->_flags |= __SIGN;
-		(void) _fwalk(lflush);
+		(void) __sfwalk_pending(lflush);
 		fp->_flags &= ~__SIGN;
 
 		/* Now flush this file without locking it. */
@@ -112,6 +204,8 @@ __srefill(FILE *fp)
 	fp->_p = fp->_bf._base;
 	fp->_r = (*fp->_read)(fp->_cookie, (char *)fp->_p, fp->_bf._size);
 	fp->_flags &= ~__SMOD;	/* buffer contents are again pristine */
+	if (fp->_r >= 0)
+		__libc_stats_sample(LIBC_STAT_STDIO_READ_BYTES, fp->_r);
 	if (fp->_r <= 0) {
 		if (fp->_r == 0)
 			fp->_flags |= __SEOF;
@@ -71,6 +71,7 @@ setvbuf(FILE *fp, char *buf, int mode, size_t size)
 	flags = fp->_flags;
 	if (flags & __SMBF)
 		free((void *)fp->_bf._base);
+	__sunmap(fp);
 	flags &= ~(__SLBF | __SNBF | __SMBF | __SOPT | __SNPT | __SEOF);
 
 	/* If setting unbuffered mode, skip all the hard work. */
@@ -144,6 +145,7 @@ nbf:
 		 * Begin or continue writing: see __swsetup().  Note
 		 * that __SNBF is impossible (it was handled earlier).
 		 */
+		__sregister_writer(fp);
 		if (flags & __SLBF) {
 			fp->_w = 0;
 			fp->_lbfsize = -fp->_bf._size;
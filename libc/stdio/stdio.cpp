@@ -48,12 +48,13 @@
 #include "glue.h"
 #include "private/bionic_fortify.h"
 #include "private/ErrnoRestorer.h"
+#include "private/bionic_sections.h"
 #include "private/thread_private.h"
 
 #define ALIGNBYTES (sizeof(uintptr_t) - 1)
 #define ALIGN(p) (((uintptr_t)(p) + ALIGNBYTES) &~ ALIGNBYTES)
 
-#define	NDYNAMIC 10		/* add ten more whenever necessary */
+#define	NDYNAMIC 10		/* add at least ten more whenever necessary */
 
 #define PRINTF_IMPL(expr) \
     va_list ap; \
@@ -77,7 +78,7 @@ _THREAD_PRIVATE_MUTEX(__sfp_mutex);
 #endif
 #define WCHAR_IO_DATA_INIT {MBSTATE_T_INIT,MBSTATE_T_INIT,{0},0,0}
 
-static struct __sfileext __sFext[3] = {
+static struct __sfileext __sFext[3] __BIONIC_FORK_WRITTEN = {
   { SBUF_INIT, WCHAR_IO_DATA_INIT, PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP, false, __sseek64 },
   { SBUF_INIT, WCHAR_IO_DATA_INIT, PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP, false, __sseek64 },
   { SBUF_INIT, WCHAR_IO_DATA_INIT, PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP, false, __sseek64 },
@@ -85,18 +86,26 @@ static struct __sfileext __sFext[3] = {
 
 // __sF is exported for backwards compatibility. Until M, we didn't have symbols
 // for stdin/stdout/stderr; they were macros accessing __sF.
-FILE __sF[3] = {
+FILE __sF[3] __BIONIC_FORK_WRITTEN = {
   std(__SRD, STDIN_FILENO),
   std(__SWR, STDOUT_FILENO),
   std(__SWR|__SNBF, STDERR_FILENO),
 };
 
-FILE* stdin = &__sF[0];
-FILE* stdout = &__sF[1];
-FILE* stderr = &__sF[2];
+FILE* stdin __BIONIC_READ_MOSTLY = &__sF[0];
+FILE* stdout __BIONIC_READ_MOSTLY = &__sF[1];
+FILE* stderr __BIONIC_READ_MOSTLY = &__sF[2];
 
-struct glue __sglue = { NULL, 3, __sF };
-static struct glue* lastglue = &__sglue;
+struct glue __sglue __BIONIC_FORK_WRITTEN = { NULL, 3, __sF };
+static struct glue* lastglue __BIONIC_FORK_WRITTEN = &__sglue;
+
+// Released FILEs, so __sfp doesn't have to search for one. Guarded by __sfp_mutex.
+static FILE* __sfp_free_list;
+
+// Every FILE that's been set up for writing, linked through _next_writer. FILEs are
+// never freed or unregistered, so walkers don't need __sfp_mutex: new entries are
+// pushed under the mutex and published with a release store.
+static FILE* __swriters;
 
 class ScopedFileLock {
  public:
@@ -126,6 +135,10 @@ static glue* moreglue(int n) {
   while (--n >= 0) {
     *p = empty;
     _FILEEXT_SETUP(p, pext);
+    pext->_next_free = nullptr;
+    pext->_on_free_list = false;
+    pext->_next_writer = nullptr;
+    pext->_writer_registered = false;
     p++;
     pext++;
   }
@@ -141,20 +154,41 @@ FILE* __sfp(void) {
 	struct glue *g;
 
 	_THREAD_PRIVATE_MUTEX_LOCK(__sfp_mutex);
+	while ((fp = __sfp_free_list) != NULL) {
+		__sfp_free_list = _EXT(fp)->_next_free;
+		_EXT(fp)->_on_free_list = false;
+		/* skip closed FILEs that were freopen()ed since */
+		if (fp->_flags == 0)
+			goto found;
+	}
+
+	/*
+	 * fmemopen and open_memstream release a FILE on failure by just
+	 * clearing _flags, so look for one of those before growing. Each
+	 * new block is about as big as all the others put together, which
+	 * keeps the cost of this search constant per FILE.
+	 */
 	for (g = &__sglue; g != NULL; g = g->next) {
 		for (fp = g->iobs, n = g->niobs; --n >= 0; fp++)
 			if (fp->_flags == 0)
 				goto found;
 	}
+	n = MAX(NDYNAMIC, 2 * lastglue->niobs);
 
 	/* release lock while mallocing */
 	_THREAD_PRIVATE_MUTEX_UNLOCK(__sfp_mutex);
-	if ((g = moreglue(NDYNAMIC)) == NULL)
+	if ((g = moreglue(n)) == NULL)
 		return (NULL);
 	_THREAD_PRIVATE_MUTEX_LOCK(__sfp_mutex);
 	lastglue->next = g;
 	lastglue = g;
 	fp = g->iobs;
+	/* take the first for ourselves and free the rest */
+	for (n = g->niobs; --n > 0; ) {
+		_EXT(&g->iobs[n])->_next_free = __sfp_free_list;
+		_EXT(&g->iobs[n])->_on_free_list = true;
+		__sfp_free_list = &g->iobs[n];
+	}
 found:
 	fp->_flags = 1;		/* reserve this slot; caller sets real flags */
 	_THREAD_PRIVATE_MUTEX_UNLOCK(__sfp_mutex);
@@ -178,9 +212,66 @@ found:
 	return fp;
 }
 
+// Marks `fp` as free and puts it on __sfp's free list.
+static void __sfp_release(FILE* fp) {
+  _THREAD_PRIVATE_MUTEX_LOCK(__sfp_mutex);
+  fp->_flags = 0;
+  if (!_EXT(fp)->_on_free_list) {
+    _EXT(fp)->_next_free = __sfp_free_list;
+    _EXT(fp)->_on_free_list = true;
+    __sfp_free_list = fp;
+  }
+  _THREAD_PRIVATE_MUTEX_UNLOCK(__sfp_mutex);
+}
+
+// Adds `fp` to the registry walked by fflush(NULL) and exit. Called whenever a stream
+// gets a write buffer. String streams are often on the stack, so they're never added.
+void __sregister_writer(FILE* fp) {
+  if ((fp->_flags & __SSTR) != 0) return;
+  if (__atomic_load_n(&_EXT(fp)->_writer_registered, __ATOMIC_RELAXED)) return;
+
+  _THREAD_PRIVATE_MUTEX_LOCK(__sfp_mutex);
+  if (!_EXT(fp)->_writer_registered) {
+    _EXT(fp)->_next_writer = __swriters;
+    __atomic_store_n(&_EXT(fp)->_writer_registered, true, __ATOMIC_RELAXED);
+    __atomic_store_n(&__swriters, fp, __ATOMIC_RELEASE);
+  }
+  _THREAD_PRIVATE_MUTEX_UNLOCK(__sfp_mutex);
+}
+
+// Like _fwalk, but only visits streams that have been set up for writing.
+int __sfwalk_pending(int (*function)(FILE*)) {
+  int ret = 0;
+  for (FILE* fp = __atomic_load_n(&__swriters, __ATOMIC_ACQUIRE); fp != nullptr;
+       fp = _EXT(fp)->_next_writer) {
+    if (fp->_flags != 0 && (fp->_flags & __SIGN) == 0) ret |= (*function)(fp);
+  }
+  return ret;
+}
+
+// The minimum buffer size for streams opened by this process, from the LIBC_STDIO_BUFSIZ
+// environment variable. Zero (the default) means each stream uses its file's st_blksize.
+size_t __sdefault_bufsize;
+
+// Largest LIBC_STDIO_BUFSIZ we'll honor. Each FILE gets its own buffer, so a typo here
+// shouldn't be able to make every fopen allocate megabytes.
+#define MAX_DEFAULT_BUFSIZ (1024 * 1024)
+
+extern "C" __LIBC_HIDDEN__ void __libc_init_stdio_bufsize() {
+  const char* value = getenv("LIBC_STDIO_BUFSIZ");
+  if (value == nullptr || *value == '\0') return;
+
+  ErrnoRestorer errno_restorer;
+  char* end;
+  errno = 0;
+  unsigned long size = strtoul(value, &end, 10);
+  if (errno != 0 || *end != '\0' || size < BUFSIZ) return;
+  __sdefault_bufsize = MIN(size, MAX_DEFAULT_BUFSIZ);
+}
+
 extern "C" __LIBC_HIDDEN__ void __libc_stdio_cleanup(void) {
   // Equivalent to fflush(nullptr), but without all the locking since we're shutting down anyway.
-  _fwalk(__sflush);
+  __sfwalk_pending(__sflush);
 }
 
 static FILE* __fopen(int fd, int flags) {
@@ -204,6 +295,17 @@ static FILE* __fopen(int fd, int flags) {
   return fp;
 }
 
+// Like glibc, a read-only mode containing 'm' asks for reads to come straight from a
+// mapping of the file rather than being copied into a buffer. Pipes, ttys and the like
+// can't be mapped, and /proc files claim to be empty, so those just get a buffer.
+static void __smmap_setup(FILE* fp, const char* mode) {
+  if (mode[0] != 'r' || strchr(mode, '+') != nullptr || strchr(mode, 'm') == nullptr) return;
+
+  struct stat64 sb;
+  if (fstat64(fp->_file, &sb) == -1 || !S_ISREG(sb.st_mode) || sb.st_size == 0) return;
+  _EXT(fp)->_mmap = true;
+}
+
 FILE* fopen(const char* file, const char* mode) {
   int oflags;
   int flags = __sflags(mode, &oflags);
@@ -230,6 +332,7 @@ FILE* fopen(const char* file, const char* mode) {
   // TODO: check in __sseek instead.
   if (oflags & O_APPEND) __sseek64(fp, 0, SEEK_END);
 
+  __smmap_setup(fp, mode);
   return fp;
 }
 __strong_alias(fopen64, fopen);
@@ -259,7 +362,9 @@ FILE* fdopen(int fd, const char* mode) {
     fcntl(fd, F_SETFD, tmp | FD_CLOEXEC);
   }
 
-  return __fopen(fd, flags);
+  FILE* fp = __fopen(fd, flags);
+  if (fp != nullptr) __smmap_setup(fp, mode);
+  return fp;
 }
 
 // Re-direct an existing, open (probably) file to some other file.
@@ -317,6 +422,7 @@ FILE* freopen(const char* file, const char* mode, FILE* fp) {
   // of any setbuffer calls, but stdio has always done this before.
   if (isopen && fd != wantfd) (*fp->_close)(fp->_cookie);
   if (fp->_flags & __SMBF) free(fp->_bf._base);
+  __sunmap(fp);
   fp->_w = 0;
   fp->_r = 0;
   fp->_p = NULL;
@@ -330,7 +436,7 @@ FILE* freopen(const char* file, const char* mode, FILE* fp) {
   fp->_lb._size = 0;
 
   if (fd < 0) { // Did not get it after all.
-    fp->_flags = 0; // Release.
+    __sfp_release(fp);
     errno = sverrno; // Restore errno in case _close clobbered it.
     return nullptr;
   }
@@ -347,7 +453,7 @@ FILE* freopen(const char* file, const char* mode, FILE* fp) {
 
   // _file is only a short.
   if (fd > SHRT_MAX) {
-      fp->_flags = 0; // Release.
+      __sfp_release(fp);
       errno = EMFILE;
       return nullptr;
   }
@@ -367,6 +473,7 @@ FILE* freopen(const char* file, const char* mode, FILE* fp) {
   // we can do about this.  (We could set __SAPP and check in
   // fseek and ftell.)
   if (oflags & O_APPEND) __sseek64(fp, 0, SEEK_END);
+  __smmap_setup(fp, mode);
   return fp;
 }
 __strong_alias(freopen64, freopen);
@@ -385,6 +492,7 @@ int fclose(FILE* fp) {
     r = EOF;
   }
   if (fp->_flags & __SMBF) free(fp->_bf._base);
+  __sunmap(fp);
   if (HASUB(fp)) FREEUB(fp);
   if (HASLB(fp)) FREELB(fp);
 
@@ -393,7 +501,7 @@ int fclose(FILE* fp) {
   fp->_r = fp->_w = 0;
 
   // Release this FILE for reuse.
-  fp->_flags = 0;
+  __sfp_release(fp);
   return r;
 }
 
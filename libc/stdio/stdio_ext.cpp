@@ -29,6 +29,7 @@
 #include <stdio_ext.h>
 
 #include <errno.h>
+#include <fcntl.h>
 #include <stdlib.h>
 
 #include "local.h"
@@ -89,3 +90,18 @@ int __fsetlocking(FILE* fp, int type) {
   _EXT(fp)->_caller_handles_locking = (type == FSETLOCKING_BYCALLER);
   return old_state;
 }
+
+int __fsetaccesspattern(FILE* fp, int pattern) {
+  if (pattern != POSIX_FADV_NORMAL && pattern != POSIX_FADV_SEQUENTIAL &&
+      pattern != POSIX_FADV_RANDOM) {
+    errno = EINVAL;
+    return -1;
+  }
+
+  FLOCKFILE(fp);
+  _EXT(fp)->_access_pattern = pattern;
+  // The readahead hint is advisory, so a stream on a pipe or socket (ESPIPE) isn't an error.
+  if (fp->_file >= 0) posix_fadvise(fp->_file, 0, 0, pattern);
+  FUNLOCKFILE(fp);
+  return 0;
+}
@@ -265,6 +265,42 @@ vfprintf(FILE *fp, const char *fmt0, __va_list ap)
 }
 DEF_STRONG(vfprintf);
 
+/*
+ * android-added: find the next '%' in the format, as the mbrtowc loops that
+ * used to be in __vfprintf and __find_arguments did. A '%' byte is never part
+ * of a multibyte character, so runs of ASCII are skipped without converting
+ * them. Returns what the last mbrtowc call would have: 0 at the end of the
+ * format, 1 at a '%', or a negative value for an invalid sequence, and leaves
+ * *fmtp pointing at the '%' or the end.
+ */
+static int
+__find_percent(char **fmtp, size_t mb_cur_max, mbstate_t *ps)
+{
+	char *fmt = *fmtp;
+	wchar_t wc;
+	int n;
+
+	for (;;) {
+		if ((unsigned char)*fmt < 0x80) {
+			if (*fmt == '%') {
+				n = 1;
+				break;
+			}
+			if (*fmt == '\0') {
+				n = 0;
+				break;
+			}
+			fmt++;
+			continue;
+		}
+		if ((n = mbrtowc(&wc, fmt, mb_cur_max, ps)) <= 0)
+			break;
+		fmt += n;
+	}
+	*fmtp = fmt;
+	return (n);
+}
+
 int
 __vfprintf(FILE *fp, const char *fmt0, __va_list ap)
 {
@@ -278,7 +314,7 @@ __vfprintf(FILE *fp, const char *fmt0, __va_list ap)
 	int width;		/* width from format (%8d), or 0 */
 	int prec;		/* precision from format; <0 for N/A */
 	char sign;		/* sign prefix (' ', '+', '-', or \0) */
-	wchar_t wc;
+	size_t mb_cur_max;	/* android-added: MB_CUR_MAX, read once */
 	mbstate_t ps;
 #ifdef FLOATING_POINT
 	/*
@@ -309,6 +345,7 @@ __vfprintf(FILE *fp, const char *fmt0, __va_list ap)
 	int ndig;		/* actual number of digits returned by dtoa */
 	char expstr[MAXEXPDIG+2];	/* buffer for exponent string: e+ZZZ */
 	char *dtoaresult = NULL;
+	char dtoabuf[24];	/* android-added: digits from __dtoa_fast */
 #endif
 
 	uintmax_t _umax;	/* integer arguments %[diouxX] */
@@ -463,6 +500,10 @@ __vfprintf(FILE *fp, const char *fmt0, __va_list ap)
 		return (EOF);
 	}
 
+	/* android-added: fast path for the common integer and string conversions */
+	if (__vfprintf_fast(fp, fmt0, ap, &ret))
+		return (ret);
+
 	/* optimise fprintf(stderr) (and other unbuffered Unix files) */
 	if ((fp->_flags & (__SNBF|__SWR|__SRW)) == (__SNBF|__SWR) &&
 	    fp->_file >= 0)
@@ -481,18 +522,13 @@ __vfprintf(FILE *fp, const char *fmt0, __va_list ap)
 #endif
 
 	memset(&ps, 0, sizeof(ps));
+	mb_cur_max = MB_CUR_MAX;
 	/*
 	 * Scan the format for conversions (`%' character).
 	 */
 	for (;;) {
 		cp = fmt;
-		while ((n = mbrtowc(&wc, fmt, MB_CUR_MAX, &ps)) > 0) {
-			fmt += n;
-			if (wc == '%') {
-				fmt--;
-				break;
-			}
-		}
+		n = __find_percent(&fmt, mb_cur_max, &ps);
 		if (n < 0) {
 			ret = -1;
 			goto error;
@@ -737,6 +773,7 @@ fp_begin:
 				prec = DEFPREC;
 			if (dtoaresult)
 				__freedtoa(dtoaresult);
+			dtoaresult = NULL;
 			if (flags & LONGDBL) {
 				fparg.ldbl = GETARG(long double);
 				dtoaresult = cp =
@@ -748,15 +785,20 @@ fp_begin:
 				}
 			} else {
 				fparg.dbl = GETARG(double);
-				dtoaresult = cp =
-				    __dtoa(fparg.dbl, expchar ? 2 : 3, prec,
-				    &expt, &signflag, &dtoaend);
-				if (dtoaresult == NULL) {
-					errno = ENOMEM;
-					goto error;
+				/* android-added: try the allocation-free path first */
+				cp = __dtoa_fast(fparg.dbl, expchar ? 2 : 3, prec,
+				    &expt, &signflag, &dtoaend, dtoabuf);
+				if (cp == NULL) {
+					dtoaresult = cp =
+					    __dtoa(fparg.dbl, expchar ? 2 : 3, prec,
+					    &expt, &signflag, &dtoaend);
+					if (dtoaresult == NULL) {
+						errno = ENOMEM;
+						goto error;
+					}
+					if (expt == 9999)
+						expt = INT_MAX;
 				}
-				if (expt == 9999)
-					expt = INT_MAX;
  			}
 fp_common:
 			if (signflag)
@@ -1150,7 +1192,7 @@ __find_arguments(const char *fmt0, va_list ap, union arg **argtable,
 	int tablemax;		/* largest used index in table */
 	int nextarg;		/* 1-based argument index */
 	int ret = 0;		/* return value */
-	wchar_t wc;
+	size_t mb_cur_max;	/* android-added: MB_CUR_MAX, read once */
 	mbstate_t ps;
 
 	/*
@@ -1206,19 +1248,14 @@ __find_arguments(const char *fmt0, va_list ap, union arg **argtable,
 	nextarg = 1;
 	memset(typetable, T_UNUSED, STATIC_ARG_TBL_SIZE);
 	memset(&ps, 0, sizeof(ps));
+	mb_cur_max = MB_CUR_MAX;
 
 	/*
 	 * Scan the format for conversions (`%' character).
 	 */
 	for (;;) {
 		cp = fmt;
-		while ((n = mbrtowc(&wc, fmt, MB_CUR_MAX, &ps)) > 0) {
-			fmt += n;
-			if (wc == '%') {
-				fmt--;
-				break;
-			}
-		}
+		n = __find_percent(&fmt, mb_cur_max, &ps);
 		if (n < 0)
 			return (-1);
 		if (n == 0)
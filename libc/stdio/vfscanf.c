@@ -114,6 +114,7 @@ __svfscanf(FILE *fp, const char *fmt0, __va_list ap)
 	wchar_t *wcp;		/* handy wide character pointer */
 	size_t nconv;		/* length of multibyte sequence converted */
 	mbstate_t mbs;
+	int mb_cur_max;		/* android-added: MB_CUR_MAX, read once */
 #endif
 
 	/* `basefix' is used to avoid `if' tests in the integer scanner */
@@ -122,6 +123,9 @@ __svfscanf(FILE *fp, const char *fmt0, __va_list ap)
 
 	_SET_ORIENTATION(fp, -1);
 
+#ifdef SCANF_WIDE_CHAR
+	mb_cur_max = MB_CUR_MAX;
+#endif
 	nassigned = 0;
 	nread = 0;
 	base = 0;		/* XXX just to keep gcc happy */
@@ -346,7 +350,7 @@ literal:
 					wcp = NULL;
 				n = 0;
 				while (width != 0) {
-					if (n == (int)MB_CUR_MAX) {
+					if (n == mb_cur_max) {
 						fp->_flags |= __SERR;
 						goto input_failure;
 					}
@@ -428,7 +432,7 @@ literal:
 				n = 0;
 				nchars = 0;
 				while (width != 0) {
-					if (n == (int)MB_CUR_MAX) {
+					if (n == mb_cur_max) {
 						fp->_flags |= __SERR;
 						goto input_failure;
 					}
@@ -532,7 +536,7 @@ literal:
 					wcp = &twc;
 				n = 0;
 				while (!isspace(*fp->_p) && width != 0) {
-					if (n == (int)MB_CUR_MAX) {
+					if (n == mb_cur_max) {
 						fp->_flags |= __SERR;
 						goto input_failure;
 					}
@@ -123,6 +123,7 @@ __vfwscanf(FILE * __restrict fp, const wchar_t * __restrict fmt, __va_list ap)
 	size_t nconv;		/* number of bytes in mb. conversion */
 	char mbbuf[MB_LEN_MAX];	/* temporary mb. character buffer */
  	mbstate_t mbs;
+	size_t mb_cur_max;	/* android-added: MB_CUR_MAX, read once */
 
 	/* `basefix' is used to avoid `if' tests in the integer scanner */
 	static short basefix[17] =
@@ -130,6 +131,7 @@ __vfwscanf(FILE * __restrict fp, const wchar_t * __restrict fmt, __va_list ap)
 
 	_SET_ORIENTATION(fp, 1);
 
+	mb_cur_max = MB_CUR_MAX;
 	nassigned = 0;
 	nconversions = 0;
 	nread = 0;
@@ -374,7 +376,7 @@ literal:
 				memset(&mbs, 0, sizeof(mbs));
 				while (width != 0 &&
 				    (wi = __fgetwc_unlock(fp)) != WEOF) {
-					if (width >= MB_CUR_MAX &&
+					if (width >= mb_cur_max &&
 					    !(flags & SUPPRESS)) {
 						nconv = wcrtomb(mbp, wi, &mbs);
 						if (nconv == (size_t)-1)
@@ -439,7 +441,7 @@ literal:
 				memset(&mbs, 0, sizeof(mbs));
 				while ((wi = __fgetwc_unlock(fp)) != WEOF &&
 				    width != 0 && INCCL(wi)) {
-					if (width >= MB_CUR_MAX &&
+					if (width >= mb_cur_max &&
 					   !(flags & SUPPRESS)) {
 						nconv = wcrtomb(mbp, wi, &mbs);
 						if (nconv == (size_t)-1)
@@ -501,7 +503,7 @@ literal:
 				while ((wi = __fgetwc_unlock(fp)) != WEOF &&
 				    width != 0 &&
 				    !iswspace(wi)) {
-					if (width >= MB_CUR_MAX &&
+					if (width >= mb_cur_max &&
 					    !(flags & SUPPRESS)) {
 						nconv = wcrtomb(mbp, wi, &mbs);
 						if (nconv == (size_t)-1)
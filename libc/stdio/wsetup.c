@@ -72,6 +72,7 @@ __swsetup(FILE *fp)
 			return (EOF);
 		__smakebuf(fp);
 	}
+	__sregister_writer(fp);
 	if (fp->_flags & __SLBF) {
 		/*
 		 * It is line buffered, so make _lbfsize be -_bufsize
@@ -31,6 +31,7 @@
 
 #include <sys/types.h>
 #include <sys/mman.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
@@ -49,12 +50,146 @@ struct atexit {
 		void (*fn_ptr)(void *);
 		void *fn_arg;		/* argument for CXA callback */
 		void *fn_dso;		/* shared module handle */
+		/* BEGIN android-added */
+		struct atexit_fn *fn_dso_next;	/* older handler, same DSO */
+		/* END android-added */
 	} fns[1];			/* the table itself */
 };
 
 static struct atexit *__atexit;
 static int restartloop;
 
+/* BEGIN android-added: per-DSO index */
+/*
+ * __cxa_finalize(dso) runs when a library is dlclose()d, so rather than
+ * scanning every handler in the process for the few that belong to it,
+ * each DSO's handlers are chained newest first through fn_dso_next, with
+ * the chain heads in an open-addressed hash table keyed by DSO handle.
+ * Like the pages themselves, the table is kept read-only except while
+ * it's being changed.
+ */
+struct atexit_dso {
+	void *dso;			/* shared module handle, or NULL */
+	struct atexit_fn *head;		/* newest handler not yet called */
+};
+
+static struct atexit_dso *__atexit_dsos;
+static size_t dsos_max;			/* power of two, or 0 */
+static size_t dsos_used;
+static int dsos_broken;			/* fall back to scanning */
+
+static size_t
+dsos_size(size_t max)
+{
+	size_t pgsize = getpagesize();
+
+	return (max * sizeof(struct atexit_dso) + pgsize - 1) & ~(pgsize - 1);
+}
+
+static struct atexit_dso *
+dsos_slot(struct atexit_dso *table, size_t max, void *dso)
+{
+	size_t i = (((uintptr_t)dso >> 4) * 2654435761u) & (max - 1);
+
+	while (table[i].dso != NULL && table[i].dso != dso)
+		i = (i + 1) & (max - 1);
+	return (&table[i]);
+}
+
+static struct atexit_dso *
+dsos_find(void *dso)
+{
+	struct atexit_dso *d;
+
+	if (__atexit_dsos == NULL)
+		return (NULL);
+	d = dsos_slot(__atexit_dsos, dsos_max, dso);
+	return (d->dso == dso ? d : NULL);
+}
+
+/* Doubles the table, leaving the new one writable. */
+static int
+dsos_grow(void)
+{
+	struct atexit_dso *table, *d;
+	size_t i, max;
+
+	max = dsos_max ? dsos_max * 2 : getpagesize() / sizeof(*table);
+	table = mmap(NULL, dsos_size(max), PROT_READ | PROT_WRITE,
+	    MAP_ANON | MAP_PRIVATE, -1, 0);
+	if (table == MAP_FAILED)
+		return (-1);
+	prctl(PR_SET_VMA, PR_SET_VMA_ANON_NAME, table, dsos_size(max),
+	    "atexit handlers");
+	for (i = 0; i < dsos_max; i++) {
+		if (__atexit_dsos[i].dso != NULL) {
+			d = dsos_slot(table, max, __atexit_dsos[i].dso);
+			*d = __atexit_dsos[i];
+		}
+	}
+	if (__atexit_dsos != NULL)
+		munmap(__atexit_dsos, dsos_size(dsos_max));
+	__atexit_dsos = table;
+	dsos_max = max;
+	return (0);
+}
+
+/*
+ * Adds a new handler to its DSO's chain. fnp's page must be writable. If
+ * the table can't be grown, __cxa_finalize(dso) goes back to scanning.
+ */
+static void
+dsos_add(struct atexit_fn *fnp)
+{
+	struct atexit_dso *d;
+
+	fnp->fn_dso_next = NULL;
+	if (fnp->fn_dso == NULL || dsos_broken)
+		return;
+	d = dsos_find(fnp->fn_dso);
+	if (d == NULL && (dsos_used + 1) * 2 > dsos_max && dsos_grow())
+		goto broken;
+	if (mprotect(__atexit_dsos, dsos_size(dsos_max),
+	    PROT_READ | PROT_WRITE))
+		goto broken;
+	if (d == NULL) {
+		d = dsos_slot(__atexit_dsos, dsos_max, fnp->fn_dso);
+		d->dso = fnp->fn_dso;
+		dsos_used++;
+	}
+	fnp->fn_dso_next = d->head;
+	d->head = fnp;
+	mprotect(__atexit_dsos, dsos_size(dsos_max), PROT_READ);
+	return;
+broken:
+	dsos_broken = 1;
+}
+
+/*
+ * Removes and returns the newest handler for dso, or NULL if none is left
+ * or the table can't be changed (in which case dsos_broken is set).
+ */
+static struct atexit_fn *
+dsos_pop(void *dso)
+{
+	struct atexit_dso *d;
+	struct atexit_fn *fnp;
+
+	d = dsos_find(dso);
+	if (d == NULL || d->head == NULL)
+		return (NULL);
+	if (mprotect(__atexit_dsos, dsos_size(dsos_max),
+	    PROT_READ | PROT_WRITE)) {
+		dsos_broken = 1;
+		return (NULL);
+	}
+	fnp = d->head;
+	d->head = fnp->fn_dso_next;
+	mprotect(__atexit_dsos, dsos_size(dsos_max), PROT_READ);
+	return (fnp);
+}
+/* END android-added */
+
 /* BEGIN android-changed: __unregister_atfork is used by __cxa_finalize */
 extern void __unregister_atfork(void* dso);
 /* END android-changed */
@@ -117,6 +252,9 @@ __cxa_atexit(void (*func)(void *), void *arg, void *dso)
 	fnp->fn_ptr = func;
 	fnp->fn_arg = arg;
 	fnp->fn_dso = dso;
+	/* BEGIN android-added */
+	dsos_add(fnp);
+	/* END android-added */
 	if (mprotect(p, pgsize, PROT_READ))
 		goto unlock;
 	restartloop = 1;
@@ -142,6 +280,29 @@ __cxa_finalize(void *dso)
 	_ATEXIT_LOCK();
 	call_depth++;
 
+	/* BEGIN android-added: only visit dso's own handlers */
+	while (dso != NULL && !dsos_broken) {
+		struct atexit_fn *fnp = dsos_pop(dso);
+
+		if (fnp == NULL) {
+			if (dsos_broken)
+				break;
+			goto done;
+		}
+		if (fnp->fn_ptr == NULL)
+			continue;	/* already called */
+		fn = *fnp;
+		p = (struct atexit *)((uintptr_t)fnp & ~((uintptr_t)pgsize - 1));
+		if (mprotect(p, pgsize, PROT_READ | PROT_WRITE) == 0) {
+			fnp->fn_ptr = NULL;
+			mprotect(p, pgsize, PROT_READ);
+		}
+		_ATEXIT_UNLOCK();
+		(*fn.fn_ptr)(fn.fn_arg);
+		_ATEXIT_LOCK();
+	}
+	/* END android-added */
+
 restart:
 	restartloop = 0;
 	for (p = __atexit; p != NULL; p = p->next) {
@@ -168,6 +329,9 @@ restart:
 		}
 	}
 
+/* BEGIN android-added */
+done:
+/* END android-added */
 	call_depth--;
 
 	/*
@@ -182,6 +346,13 @@ restart:
 			munmap(q, pgsize);
 		}
 		__atexit = NULL;
+		/* BEGIN android-added */
+		if (__atexit_dsos != NULL)
+			munmap(__atexit_dsos, dsos_size(dsos_max));
+		__atexit_dsos = NULL;
+		dsos_max = dsos_used = 0;
+		dsos_broken = 0;
+		/* END android-added */
 	}
 	_ATEXIT_UNLOCK();
 
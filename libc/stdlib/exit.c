@@ -47,12 +47,33 @@ extern void __cxa_finalize(void* dso_handle);
 extern void __cxa_thread_finalize();
 /* END android-added */
 
+/* BEGIN android-added: fast exit */
+extern void __libc_stdio_cleanup(void);
+extern void __run_quick_exit_handlers(void);
+
+static int fast_exit;
+
+void
+android_set_fast_exit(int enabled)
+{
+	__atomic_store_n(&fast_exit, enabled != 0, __ATOMIC_RELAXED);
+}
+/* END android-added */
+
 /*
  * Exit, flushing stdio buffers if necessary.
  */
 void
 exit(int status)
 {
+  /* BEGIN android-added: skip destructors if asked to */
+  if (__atomic_load_n(&fast_exit, __ATOMIC_RELAXED)) {
+    __run_quick_exit_handlers();
+    __libc_stdio_cleanup();
+    _exit(status);
+  }
+  /* END android-added */
+
   /* BEGIN android-added: call thread_local d-tors */
   __cxa_thread_finalize();
   /* END android-added */
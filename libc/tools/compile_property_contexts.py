@@ -0,0 +1,149 @@
+#!/usr/bin/env python
+#
+# Copyright (C) 2017 The Android Open Source Project
+#
+# Licensed under the Apache License, Version 2.0 (the 'License');
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an 'AS IS' BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+# pylint: disable=bad-indentation,bad-continuation
+"""Compiles property_contexts into the property_contexts.bin libc maps.
+
+  compile_property_contexts.py property_contexts property_contexts.bin
+
+The format is in libc/private/bionic_property_contexts.h. The lookups have to
+give the same answers as the text would, so this parses it the way
+initialize_properties() does, and builds the table build_prefix_index() would.
+"""
+from __future__ import print_function
+
+import struct
+import sys
+
+MAGIC = 0x58544350
+VERSION = 1
+NONE = 0xffffffff
+
+# magic, version, size, context_count, contexts, prefix_count, prefixes,
+# prefix_start[257], wildcard_context.
+HEADER = struct.Struct("<7I257II")
+PREFIX = struct.Struct("<4I")
+
+
+def parse(text):
+  """Returns the (prefix, context) pairs in the order libc's list holds them,
+  and the contexts in the order libc creates them."""
+  prefixes = []
+  contexts = []
+  for line in text.split(b"\n"):
+    # getline() stops at the newline, and the C string at a NUL.
+    line = line.split(b"\0")[0]
+    fields = line.split()
+    if not fields or fields[0].startswith(b"#") or len(fields) < 2:
+      continue
+    prefix, context = fields[0], fields[1]
+    # init handles ctl.* itself; they have no property area.
+    if prefix.startswith(b"ctl."):
+      continue
+    if context not in contexts:
+      contexts.append(context)
+    # list_add_after_len().
+    i = 0
+    while i < len(prefixes):
+      other = prefixes[i][0]
+      if len(other) < len(prefix) or other.startswith(b"*"):
+        break
+      i += 1
+    prefixes.insert(i, (prefix, context))
+  return prefixes, contexts
+
+
+def build_index(prefixes, contexts):
+  """Returns the sorted (prefix, context index, shorter index) table and the
+  wildcard's context index, as build_prefix_index() does."""
+  wildcard = NONE
+  best = {}
+  for prefix, context in prefixes:
+    if prefix.startswith(b"*"):
+      if wildcard == NONE:
+        wildcard = contexts.index(context)
+      continue
+    # The first of any duplicates in list order is the one that's kept.
+    best.setdefault(prefix, contexts.index(context))
+
+  # strcmp order is byte order.
+  names = sorted(best)
+  table = []
+  for i, name in enumerate(names):
+    shorter = i - 1 if i > 0 else NONE
+    while shorter != NONE and not name.startswith(names[shorter]):
+      shorter = table[shorter][2]
+    table.append((name, best[name], shorter))
+  return table, wildcard
+
+
+def compile_contexts(text):
+  prefixes, contexts = parse(text)
+  table, wildcard = build_index(prefixes, contexts)
+
+  contexts_offset = HEADER.size
+  prefixes_offset = contexts_offset + 4 * len(contexts)
+  strings_offset = prefixes_offset + PREFIX.size * len(table)
+
+  strings = bytearray()
+  string_offsets = {}
+  def add_string(s):
+    if s not in string_offsets:
+      string_offsets[s] = strings_offset + len(strings)
+      strings.extend(s + b"\0")
+    return string_offsets[s]
+
+  context_offsets = [add_string(c) for c in contexts]
+  prefix_entries = [(add_string(name), len(name), context, shorter)
+                    for name, context, shorter in table]
+  if not strings:
+    strings.extend(b"\0")  # libc checks that the file ends in a NUL.
+
+  prefix_start = []
+  i = 0
+  for c in range(256):
+    prefix_start.append(i)
+    while i < len(table) and bytearray(table[i][0])[0] == c:
+      i += 1
+  prefix_start.append(len(table))
+
+  size = strings_offset + len(strings)
+  out = bytearray(HEADER.pack(MAGIC, VERSION, size, len(contexts),
+                              contexts_offset, len(table), prefixes_offset,
+                              *(prefix_start + [wildcard])))
+  for offset in context_offsets:
+    out.extend(struct.pack("<I", offset))
+  for entry in prefix_entries:
+    out.extend(PREFIX.pack(*entry))
+  out.extend(strings)
+  assert len(out) == size
+  return bytes(out)
+
+
+def main():
+  if len(sys.argv) != 3:
+    print("usage: %s property_contexts property_contexts.bin" % sys.argv[0],
+          file=sys.stderr)
+    return 1
+  with open(sys.argv[1], "rb") as f:
+    text = f.read()
+  with open(sys.argv[2], "wb") as f:
+    f.write(compile_contexts(text))
+  return 0
+
+
+if __name__ == "__main__":
+  sys.exit(main())
@@ -26,7 +26,8 @@ bionic_temp = tempfile.mkdtemp(prefix="bionic_gensyscalls");
 # Make sure the directory is deleted when the script exits.
 atexit.register(shutil.rmtree, bionic_temp)
 
-bionic_libc_root = os.path.join(os.environ["ANDROID_BUILD_TOP"], "bionic/libc")
+# Not needed, and not set, when generating the syscall statistics variant at build time.
+bionic_libc_root = os.path.join(os.environ.get("ANDROID_BUILD_TOP", ""), "bionic/libc")
 
 warning = "Generated by gensyscalls.py. Do not edit."
 
@@ -400,6 +401,116 @@ def x86_64_genstub(syscall):
     return result
 
 
+#
+# Stubs for libc_syscall_stats.so, which counts and times every call.
+#
+# Each stub is generated as usual, but under a hidden name, and called from a
+# C++ wrapper with the public name that records the call. The wrapper passes
+# its arguments on as the same number of machine words, so it needs no types:
+# 64-bit arguments on LP32 are two words, aligned as the stub expects them.
+
+syscall_stats_prefix = "__syscall_stats_real_"
+
+syscall_stats_wrappers_header = "// " + warning + """
+
+#include <stdint.h>
+
+#include "private/bionic_syscall_stats.h"
+
+"""
+
+syscall_stats_wrapper = """\
+extern "C" %(return_type)s %(real_func)s(%(real_params)s);
+extern "C" %(visibility)s%(return_type)s %(func)s(%(params)s) {
+  uint64_t start = __syscall_stats_begin();
+  %(return_type)s result = %(real_func)s(%(args)s);
+  __syscall_stats_end(%(index)d, start);
+  return result;
+}
+"""
+
+
+def syscall_stats_word_count(arch, params):
+    params = [param for param in params if param.strip() != "void"]
+    if arch == "arm" or arch == "mips":
+        return count_arm_param_registers(params)
+    if arch == "x86":
+        return count_generic_param_registers(params)
+    return count_generic_param_registers64(params)
+
+
+def syscall_stats_genstub(arch, syscall):
+    real = dict(syscall)
+    real["func"] = syscall_stats_prefix + syscall["func"]
+    if arch == "arm":
+        # Keep each stub's literal pool within reach of its ldr.
+        stub = arm_eabi_genstub(real) + "    .ltorg\n"
+    elif arch == "arm64":
+        stub = arm64_genstub(real)
+    elif arch == "mips":
+        stub = mips_genstub(real)
+    elif arch == "mips64":
+        stub = mips64_genstub(real)
+    elif arch == "x86" and syscall["socketcall_id"] >= 0:
+        stub = x86_genstub_socketcall(real)
+    elif arch == "x86":
+        stub = x86_genstub(real)
+    else:
+        stub = x86_64_genstub(real)
+    # All the stubs go in one file, which only needs the header once.
+    stub = stub.replace(syscall_stub_header % real, "ENTRY(%s)\n" % real["func"])
+    return stub + ".hidden %s\n\n" % real["func"]
+
+
+def syscall_stats_genwrapper(arch, syscall, index):
+    lp64 = arch in [ "arm64", "mips64", "x86_64" ]
+    words = syscall_stats_word_count(arch, syscall["params"])
+    return_type = "long"
+    if not lp64 and param_uses_64bits(syscall["return_type"]):
+        return_type = "long long"
+    visibility = ""
+    if (lp64 and syscall["func"].startswith("__")) or syscall["func"].startswith("___"):
+        visibility = '__attribute__((visibility("hidden"))) '
+    t = {
+        "func"        : syscall["func"],
+        "real_func"   : syscall_stats_prefix + syscall["func"],
+        "return_type" : return_type,
+        "visibility"  : visibility,
+        "real_params" : ", ".join(["long"] * words),
+        "params"      : ", ".join(["long a%d" % i for i in range(words)]),
+        "args"        : ", ".join(["a%d" % i for i in range(words)]),
+        "index"       : index,
+    }
+    wrapper = syscall_stats_wrapper % t
+    for alias in syscall["aliases"]:
+        wrapper += 'extern "C" %s %s(%s) __attribute__((alias("%s")));\n' % \
+            (return_type, alias, t["real_params"], syscall["func"])
+    return wrapper + "\n"
+
+
+def gen_syscall_stats(arch, syscalls_txt, stubs_path, wrappers_path):
+    parser = SysCallsTxtParser()
+    parser.parse_file(syscalls_txt)
+    syscalls = [syscall for syscall in parser.syscalls if syscall.has_key(arch)]
+
+    stubs = open(stubs_path, "w")
+    wrappers = open(wrappers_path, "w")
+    stubs.write(syscall_stub_header.split("ENTRY")[0])
+    wrappers.write(syscall_stats_wrappers_header)
+    for index, syscall in enumerate(syscalls):
+        syscall["__NR_name"] = make__NR_name(syscall["name"])
+        stubs.write(syscall_stats_genstub(arch, syscall))
+        wrappers.write(syscall_stats_genwrapper(arch, syscall, index))
+
+    wrappers.write("const char* const __syscall_stats_names[] = {\n")
+    for syscall in syscalls:
+        wrappers.write('  "%s",\n' % syscall["func"])
+    wrappers.write("};\n\n")
+    wrappers.write("const size_t __syscall_stats_count = %d;\n" % len(syscalls))
+    stubs.close()
+    wrappers.close()
+
+
 class SysCallsTxtParser:
     def __init__(self):
         self.syscalls = []
@@ -477,6 +588,7 @@ class SysCallsTxtParser:
         t = {
               "name"    : syscall_name,
               "func"    : syscall_func,
+              "return_type" : return_type,
               "aliases" : syscall_aliases,
               "params"  : syscall_params,
               "decl"    : "%-15s  %s (%s);" % (return_type, syscall_func, params),
@@ -672,6 +784,10 @@ class State:
         else:
             logging.info("ready to go!!")
 
+if len(sys.argv) == 6 and sys.argv[1] == "--syscall-stats":
+    gen_syscall_stats(sys.argv[2], sys.argv[3], sys.argv[4], sys.argv[5])
+    sys.exit(0)
+
 logging.basicConfig(level=logging.INFO)
 
 state = State()
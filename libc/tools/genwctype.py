@@ -0,0 +1,119 @@
+#!/usr/bin/env python3
+#
+# usage: genwctype.py > libc/bionic/wctype_tables.h
+#
+# Generates the character classification and case mapping tables used by
+# libc/bionic/wctype.cpp from the Unicode database built into Python.
+#
+# Every code point maps to a "record": its class bits plus the deltas to its
+# upper- and lower-case forms. There are fewer than 256 distinct records, so
+# a code point's record is one byte. The BMP is covered by a two-level table
+# of 64-character blocks, with identical blocks shared. The supplementary
+# planes are sparse enough that a sorted list of runs is smaller.
+
+import sys
+import unicodedata
+
+BLOCK_SIZE = 64
+
+# Must match the WC_BIT_ constants in wctype.cpp.
+UPPER, LOWER, ALPHA, DIGIT, XDIGIT, SPACE, BLANK, CNTRL, PUNCT, GRAPH, PRINT = \
+    [1 << i for i in range(11)]
+
+# Zs characters that aren't word separators, and so aren't spaces.
+NO_BREAK_SPACES = (0x00a0, 0x2007, 0x202f)
+
+
+def ascii_classes(c):
+    ch = chr(c)
+    m = 0
+    if 'A' <= ch <= 'Z': m |= UPPER | ALPHA
+    if 'a' <= ch <= 'z': m |= LOWER | ALPHA
+    if '0' <= ch <= '9': m |= DIGIT
+    if ch in '0123456789abcdefABCDEF': m |= XDIGIT
+    if ch in ' \t\n\v\f\r': m |= SPACE
+    if ch in ' \t': m |= BLANK
+    if c < 0x20 or c == 0x7f: m |= CNTRL
+    if 0x20 <= c < 0x7f: m |= PRINT
+    if 0x20 < c < 0x7f: m |= GRAPH
+    if (m & GRAPH) and not (m & (ALPHA | DIGIT)): m |= PUNCT
+    return m
+
+
+def classes(c):
+    if c < 0x80:
+        return ascii_classes(c)
+    ch = chr(c)
+    cat = unicodedata.category(ch)
+    upper = ch.upper()
+    lower = ch.lower()
+    m = 0
+    if cat in ('Lu', 'Lt') or (len(lower) == 1 and lower != ch): m |= UPPER
+    if cat == 'Ll' or (len(upper) == 1 and upper != ch): m |= LOWER
+    # As in glibc, other scripts' digits count as alphabetic so that iswalnum
+    # covers them; iswdigit is only ever true for '0'-'9'.
+    if cat[0] == 'L' or cat in ('Nd', 'Nl'): m |= ALPHA
+    if cat == 'Zs' and c not in NO_BREAK_SPACES: m |= SPACE | BLANK
+    if cat in ('Zl', 'Zp'): m |= SPACE | CNTRL
+    if cat == 'Cc': m |= CNTRL
+    if cat not in ('Cc', 'Cs', 'Cn', 'Zl', 'Zp'): m |= PRINT
+    if (m & PRINT) and cat != 'Zs': m |= GRAPH
+    if (m & GRAPH) and not (m & ALPHA): m |= PUNCT
+    return m
+
+
+def record(c):
+    ch = chr(c)
+    upper = ch.upper()
+    lower = ch.lower()
+    # Only simple (one-to-one) mappings can be expressed by towupper/towlower.
+    upper_delta = ord(upper) - c if len(upper) == 1 else 0
+    lower_delta = ord(lower) - c if len(lower) == 1 else 0
+    return (classes(c), upper_delta, lower_delta)
+
+
+def print_array(out, decl, values, per_line, fmt):
+    out.write('%s = {\n' % decl)
+    for i in range(0, len(values), per_line):
+        out.write('  ' + ' '.join(fmt % v + ',' for v in values[i:i + per_line]) + '\n')
+    out.write('};\n\n')
+
+
+def main():
+    records = {}
+    def index(c):
+        return records.setdefault(record(c), len(records))
+
+    blocks = {}
+    bmp_index = []
+    for start in range(0, 0x10000, BLOCK_SIZE):
+        block = tuple(index(c) for c in range(start, start + BLOCK_SIZE))
+        bmp_index.append(blocks.setdefault(block, len(blocks)))
+
+    runs = []
+    previous = None
+    for c in range(0x10000, 0x110000):
+        i = index(c)
+        if i != previous:
+            runs.append((c << 8) | i)
+            previous = i
+
+    assert len(records) <= 256 and len(blocks) <= 256
+
+    out = sys.stdout
+    out.write('/* generated by genwctype.py from Unicode %s - do not edit */\n\n' %
+              unicodedata.unidata_version)
+    out.write('#define WC_BLOCK_SHIFT %d\n\n' % (BLOCK_SIZE.bit_length() - 1))
+    out.write('static const wc_record kWcRecords[] = {\n')
+    for (m, upper_delta, lower_delta), i in sorted(records.items(), key=lambda r: r[1]):
+        out.write('  { 0x%03x, %d, %d },\n' % (m, upper_delta, lower_delta))
+    out.write('};\n\n')
+    print_array(out, 'static const uint8_t kWcBmpIndex[%d]' % len(bmp_index), bmp_index, 16, '%3d')
+    flat = [i for block, _ in sorted(blocks.items(), key=lambda b: b[1]) for i in block]
+    print_array(out, 'static const uint8_t kWcBmpBlocks[%d]' % len(flat), flat, 16, '%3d')
+    print_array(out, 'static const uint32_t kWcSupplementaryRuns[%d]' % len(runs), runs, 6,
+                '0x%08x')
+
+
+if __name__ == '__main__':
+    main()
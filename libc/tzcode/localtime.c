@@ -178,6 +178,33 @@ static struct state gmtmem;
 static char lcl_TZname[TZ_STRLEN_MAX + 1];
 static int  lcl_is_set;
 
+#if defined(__BIONIC__)
+// BEGIN android-added: lock-free localtime_r() for times near the last one converted.
+#include <stdatomic.h>
+
+// Bumped under the lock whenever lclptr is (re)loaded, invalidating every thread's
+// lcl_interval at once. Never 0 once a zone has been loaded.
+static atomic_uint lcl_generation;
+
+// The span of times around the last one this thread passed to localtime_r(), all of which
+// share its UTC offset, and what localsub() would say about them.
+struct lcl_interval {
+  unsigned generation;
+  time_t start;  // inclusive
+  time_t end;  // inclusive
+  int_fast32_t gmtoff;
+  int isdst;
+  char *abbr;
+};
+
+static pthread_key_t lcl_interval_key;
+
+__attribute__((constructor)) static void lcl_interval_key_init(void) {
+  pthread_key_create(&lcl_interval_key, free);
+}
+// END android-added
+#endif
+
 /*
 ** Section 4.12.3 of X3.159-1989 requires that
 **  Except for the strftime function, these functions [asctime,
@@ -369,7 +396,7 @@ union local_storage {
   } u;
 };
 
-static int __bionic_open_tzdata(const char*);
+static ssize_t __bionic_read_tzdata(const char*, char*, size_t);
 
 /* Load tz data from the file named NAME into *SP.  Read extended
    format if DOEXTEND.  Use *LSP for temporary storage.  Return 0 on
@@ -398,7 +425,12 @@ tzloadbody(char const *name, struct state *sp, bool doextend,
 	}
 
 #if defined(__BIONIC__)
-	fid = __bionic_open_tzdata(name);
+	(void) fid;
+	nread = __bionic_read_tzdata(name, up->buf, sizeof up->buf);
+	if (nread < 0)
+	  return errno;
+	if (nread < tzheadsize)
+	  return EINVAL;
 #else
 	if (name[0] == ':')
 		++name;
@@ -420,7 +452,6 @@ tzloadbody(char const *name, struct state *sp, bool doextend,
 	if (doaccess && access(name, R_OK) != 0)
 	  return errno;
 	fid = open(name, OPEN_MODE);
-#endif
 	if (fid < 0)
 	  return errno;
 
@@ -432,6 +463,7 @@ tzloadbody(char const *name, struct state *sp, bool doextend,
 	}
 	if (close(fid) < 0)
 	  return errno;
+#endif
 	for (stored = 4; stored <= 8; stored *= 2) {
 		int_fast32_t ttisstdcnt = detzcode(up->tzhead.tzh_ttisstdcnt);
 		int_fast32_t ttisgmtcnt = detzcode(up->tzhead.tzh_ttisgmtcnt);
@@ -1274,6 +1306,64 @@ zoneinit(struct state *sp, char const *name)
   }
 }
 
+#if defined(__BIONIC__) && defined(ALL_STATE)
+// BEGIN android-added
+// The zones we've parsed, so that switching TZ back and forth, or tzalloc'ing a zone that's
+// been used before, doesn't load and parse it again. lclptr points to one of these whenever the
+// name fits in lcl_TZname. Entries are only used or changed with the lock held.
+#define ZONE_CACHE_SIZE 16
+static struct zone_cache_entry {
+  char name[TZ_STRLEN_MAX + 1];
+  struct state *sp;
+  int err; /* What zoneinit returned. */
+  unsigned long last_used;
+} zone_cache[ZONE_CACHE_SIZE];
+static unsigned long zone_cache_clock;
+
+/* Return the entry for NAME, or NULL if it isn't cached.  */
+static struct zone_cache_entry *
+zone_cache_find(char const *name)
+{
+  int i;
+  for (i = 0; i < ZONE_CACHE_SIZE; i++) {
+    struct zone_cache_entry *e = &zone_cache[i];
+    if (e->sp && strcmp(e->name, name) == 0) {
+      e->last_used = ++zone_cache_clock;
+      return e;
+    }
+  }
+  return NULL;
+}
+
+/* Return a new entry for NAME, whose state the caller must fill in,
+   replacing the least recently used entry other than the one for KEEP.
+   Return NULL if out of memory.  */
+static struct zone_cache_entry *
+zone_cache_add(char const *name, struct state const *keep)
+{
+  struct zone_cache_entry *victim = NULL;
+  int i;
+  if (sizeof zone_cache[0].name <= strlen(name))
+    return NULL;
+  for (i = 0; i < ZONE_CACHE_SIZE; i++) {
+    struct zone_cache_entry *e = &zone_cache[i];
+    if (!e->sp) {
+      e->sp = malloc(sizeof *e->sp);
+      if (!e->sp)
+        return NULL;
+      victim = e;
+      break;
+    }
+    if (e->sp != keep && (!victim || e->last_used < victim->last_used))
+      victim = e;
+  }
+  strcpy(victim->name, name);
+  victim->last_used = ++zone_cache_clock;
+  return victim;
+}
+// END android-added
+#endif
+
 static void
 tzsetlcl(char const *name)
 {
@@ -1283,6 +1373,35 @@ tzsetlcl(char const *name)
       ? lcl_is_set < 0
       : 0 < lcl_is_set && strcmp(lcl_TZname, name) == 0)
     return;
+#if defined(__BIONIC__) && defined(ALL_STATE)
+  // BEGIN android-changed: reuse parsed zones.
+  if (0 < lcl) {
+    struct zone_cache_entry *e = zone_cache_find(name);
+    if (!e && (e = zone_cache_add(name, lclptr)) != NULL) {
+      e->err = zoneinit(e->sp, name);
+      if (e->err != 0)
+        zoneinit(e->sp, "");
+    }
+    if (e)
+      lclptr = sp = e->sp;
+    else
+      sp = NULL;
+  } else {
+    // Names too long to remember get a state of their own.
+    static struct state *lcl_uncached;
+    if (!lcl_uncached)
+      lcl_uncached = malloc(sizeof *lcl_uncached);
+    sp = lcl_uncached;
+    if (sp) {
+      lclptr = sp;
+      if (zoneinit(sp, name) != 0)
+        zoneinit(sp, "");
+    }
+  }
+  if (sp && 0 < lcl)
+    strcpy(lcl_TZname, name);
+  // END android-changed
+#else
 #ifdef ALL_STATE
   if (! sp)
     lclptr = sp = malloc(sizeof *lclptr);
@@ -1293,8 +1412,15 @@ tzsetlcl(char const *name)
     if (0 < lcl)
       strcpy(lcl_TZname, name);
   }
+#endif
   settzname();
   lcl_is_set = lcl;
+#if defined(__BIONIC__)
+  // BEGIN android-added
+  unsigned generation = atomic_load_explicit(&lcl_generation, memory_order_relaxed) + 1;
+  atomic_store_explicit(&lcl_generation, generation ? generation : 1, memory_order_release);
+  // END android-added
+#endif
 }
 
 #ifdef STD_INSPIRED
@@ -1394,7 +1520,35 @@ tzalloc(char const *name)
 {
   timezone_t sp = malloc(sizeof *sp);
   if (sp) {
+#if defined(__BIONIC__) && defined(ALL_STATE)
+    // BEGIN android-added: copy zones we've already parsed.
+    int err = -1;
+    if (name && lock() == 0) {
+      struct zone_cache_entry *e = zone_cache_find(name);
+      if (e) {
+        err = e->err;
+        if (err == 0)
+          memcpy(sp, e->sp, sizeof *sp);
+      }
+      unlock();
+    }
+    if (err == -1) {
+      err = zoneinit(sp, name);
+      if (err == 0 && name && lock() == 0) {
+        if (!zone_cache_find(name)) {
+          struct zone_cache_entry *e = zone_cache_add(name, lclptr);
+          if (e) {
+            memcpy(e->sp, sp, sizeof *sp);
+            e->err = 0;
+          }
+        }
+        unlock();
+      }
+    }
+    // END android-added
+#else
     int err = zoneinit(sp, name);
+#endif
     if (err != 0) {
       free(sp);
       errno = err;
@@ -1526,6 +1680,73 @@ localtime_rz(struct state *sp, time_t const *timep, struct tm *tmp)
 
 #endif
 
+#if defined(__BIONIC__)
+// BEGIN android-added
+/*
+** Remember, for this thread, the span of times around *TIMEP that localsub(SP, ...) converts
+** with the same ttinfo, so that localtime_r() can convert them without the lock.  Must be
+** called with the lock held.  Zones with leap seconds, and times beyond the transition table
+** that localsub() maps back into it, aren't remembered.
+*/
+static void
+lcl_interval_update(struct state const *sp, time_t const *timep)
+{
+  struct lcl_interval *li;
+  const struct ttinfo *ttisp;
+  time_t t = *timep;
+  time_t start = time_t_min;
+  time_t end = time_t_max;
+  int i;
+
+  if (sp == NULL || sp->leapcnt != 0)
+    return;
+  if ((sp->goback && t < sp->ats[0]) ||
+      (sp->goahead && t > sp->ats[sp->timecnt - 1]))
+    return;
+  if (sp->timecnt == 0) {
+    i = sp->defaulttype;
+  } else if (t < sp->ats[0]) {
+    i = sp->defaulttype;
+    end = sp->ats[0] - 1;
+  } else {
+    int lo = 1;
+    int hi = sp->timecnt;
+
+    while (lo < hi) {
+      int mid = (lo + hi) >> 1;
+
+      if (t < sp->ats[mid])
+        hi = mid;
+      else
+        lo = mid + 1;
+    }
+    i = sp->types[lo - 1];
+    start = sp->ats[lo - 1];
+    if (lo < sp->timecnt)
+      end = sp->ats[lo] - 1;
+    else if (sp->goahead)
+      end = sp->ats[lo - 1];
+  }
+
+  li = pthread_getspecific(lcl_interval_key);
+  if (li == NULL) {
+    li = malloc(sizeof *li);
+    if (li == NULL || pthread_setspecific(lcl_interval_key, li) != 0) {
+      free(li);
+      return;
+    }
+  }
+  ttisp = &sp->ttis[i];
+  li->generation = atomic_load_explicit(&lcl_generation, memory_order_relaxed);
+  li->start = start;
+  li->end = end;
+  li->gmtoff = ttisp->tt_gmtoff;
+  li->isdst = ttisp->tt_isdst;
+  li->abbr = (char *) &sp->chars[ttisp->tt_abbrind];
+}
+// END android-added
+#endif
+
 static struct tm *
 localtime_tzset(time_t const *timep, struct tm *tmp, bool setname)
 {
@@ -1537,6 +1758,10 @@ localtime_tzset(time_t const *timep, struct tm *tmp, bool setname)
   if (setname || !lcl_is_set)
     tzset_unlocked();
   tmp = localsub(lclptr, timep, setname, tmp);
+#if defined(__BIONIC__)
+  if (tmp && !setname)
+    lcl_interval_update(lclptr, timep); // android-added
+#endif
   unlock();
   return tmp;
 }
@@ -1550,6 +1775,24 @@ localtime(const time_t *timep)
 struct tm *
 localtime_r(const time_t *timep, struct tm *tmp)
 {
+#if defined(__BIONIC__)
+  // BEGIN android-added: if the zone hasn't changed and this time is in the same interval as
+  // the last one this thread converted, all that's left is the calendar arithmetic.
+  struct lcl_interval *li = pthread_getspecific(lcl_interval_key);
+  if (li != NULL &&
+      li->generation == atomic_load_explicit(&lcl_generation, memory_order_acquire) &&
+      li->start <= *timep && *timep <= li->end) {
+    struct tm *result = timesub(timep, li->gmtoff, NULL, tmp);
+    if (result) {
+      result->tm_isdst = li->isdst;
+#ifdef TM_ZONE
+      result->TM_ZONE = li->abbr;
+#endif /* defined TM_ZONE */
+    }
+    return result;
+  }
+  // END android-added
+#endif
   return localtime_tzset(timep, tmp, false);
 }
 
@@ -2340,9 +2583,47 @@ time(time_t *p)
 #include <assert.h>
 #include <stdint.h>
 #include <arpa/inet.h> // For ntohl(3).
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// byte[12] tzdata_version  -- "tzdata2012f\0"
+// int index_offset
+// int data_offset
+// int zonetab_offset
+struct bionic_tzdata_header {
+  char tzdata_version[12];
+  int32_t index_offset;
+  int32_t data_offset;
+  int32_t zonetab_offset;
+};
+
+#define TZDATA_NAME_LENGTH 40
+struct index_entry_t {
+  char buf[TZDATA_NAME_LENGTH];
+  int32_t start;
+  int32_t length;
+  int32_t unused; // Was raw GMT offset; always 0 since tzdata2014f (L).
+};
+
+// A tzdata file, mapped the first time it's needed. The files are only replaced at boot, so
+// the mapping stays valid for the life of the process.
+struct bionic_tzdata {
+  bool mapped;
+  int error; // 0, -1 if the file is bad, or -2 if there isn't one.
+  const char* data;
+  size_t size;
+  const struct index_entry_t* index;
+  size_t id_count;
+  size_t data_offset;
+  bool sorted; // ZoneCompactor sorts the index by id, but we check.
+};
+
+static pthread_mutex_t __bionic_tzdata_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct bionic_tzdata __bionic_tzdata_files[2];
 
-static int __bionic_open_tzdata_path(const char* path_prefix_variable, const char* path_suffix,
-                                     const char* olson_id) {
+static int __bionic_map_tzdata(struct bionic_tzdata* tzdata, const char* path_prefix_variable,
+                               const char* path_suffix) {
   const char* path_prefix = getenv(path_prefix_variable);
   if (path_prefix == NULL) {
     fprintf(stderr, "%s: %s not set!\n", __FUNCTION__, path_prefix_variable);
@@ -2361,123 +2642,141 @@ static int __bionic_open_tzdata_path(const char* path_prefix_variable, const cha
     return -2; // Distinguish failure to find any data from failure to find a specific id.
   }
 
-  // byte[12] tzdata_version  -- "tzdata2012f\0"
-  // int index_offset
-  // int data_offset
-  // int zonetab_offset
-  struct bionic_tzdata_header {
-    char tzdata_version[12];
-    int32_t index_offset;
-    int32_t data_offset;
-    int32_t zonetab_offset;
-  } header;
-  memset(&header, 0, sizeof(header));
-  ssize_t bytes_read = TEMP_FAILURE_RETRY(read(fd, &header, sizeof(header)));
-  if (bytes_read != sizeof(header)) {
+  struct stat sb;
+  if (fstat(fd, &sb) == -1) {
+    sb.st_size = -1;
+  }
+  if (sb.st_size < (off_t) sizeof(struct bionic_tzdata_header)) {
     fprintf(stderr, "%s: could not read header of \"%s\": %s\n",
-            __FUNCTION__, path, (bytes_read == -1) ? strerror(errno) : "short read");
+            __FUNCTION__, path, (sb.st_size == -1) ? strerror(errno) : "short read");
     free(path);
     close(fd);
     return -1;
   }
-
-  if (strncmp(header.tzdata_version, "tzdata", 6) != 0 || header.tzdata_version[11] != 0) {
-    fprintf(stderr, "%s: bad magic in \"%s\": \"%.6s\"\n",
-            __FUNCTION__, path, header.tzdata_version);
+  void* data = mmap(NULL, sb.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED) {
+    fprintf(stderr, "%s: could not map \"%s\": %s\n", __FUNCTION__, path, strerror(errno));
     free(path);
-    close(fd);
     return -1;
   }
 
-#if 0
-  fprintf(stderr, "version: %s\n", header.tzdata_version);
-  fprintf(stderr, "index_offset = %d\n", ntohl(header.index_offset));
-  fprintf(stderr, "data_offset = %d\n", ntohl(header.data_offset));
-  fprintf(stderr, "zonetab_offset = %d\n", ntohl(header.zonetab_offset));
-#endif
-
-  if (TEMP_FAILURE_RETRY(lseek(fd, ntohl(header.index_offset), SEEK_SET)) == -1) {
-    fprintf(stderr, "%s: couldn't seek to index in \"%s\": %s\n",
-            __FUNCTION__, path, strerror(errno));
+  const struct bionic_tzdata_header* header = data;
+  if (strncmp(header->tzdata_version, "tzdata", 6) != 0 || header->tzdata_version[11] != 0) {
+    fprintf(stderr, "%s: bad magic in \"%s\": \"%.6s\"\n",
+            __FUNCTION__, path, header->tzdata_version);
     free(path);
-    close(fd);
+    munmap(data, sb.st_size);
     return -1;
   }
 
-  off_t specific_zone_offset = -1;
-  ssize_t index_size = ntohl(header.data_offset) - ntohl(header.index_offset);
-  char* index = malloc(index_size);
-  if (index == NULL) {
-    fprintf(stderr, "%s: couldn't allocate %zd-byte index for \"%s\"\n",
-            __FUNCTION__, index_size, path);
-    free(path);
-    close(fd);
-    return -1;
-  }
-  if (TEMP_FAILURE_RETRY(read(fd, index, index_size)) != index_size) {
-    fprintf(stderr, "%s: could not read index of \"%s\": %s\n",
-            __FUNCTION__, path, (bytes_read == -1) ? strerror(errno) : "short read");
+  size_t index_offset = ntohl(header->index_offset);
+  size_t data_offset = ntohl(header->data_offset);
+  if (index_offset > data_offset || data_offset > (size_t) sb.st_size) {
+    fprintf(stderr, "%s: bad index in \"%s\"\n", __FUNCTION__, path);
     free(path);
-    free(index);
-    close(fd);
+    munmap(data, sb.st_size);
     return -1;
   }
+  free(path);
 
-  static const size_t NAME_LENGTH = 40;
-  struct index_entry_t {
-    char buf[NAME_LENGTH];
-    int32_t start;
-    int32_t length;
-    int32_t unused; // Was raw GMT offset; always 0 since tzdata2014f (L).
-  };
-
-  size_t id_count = (ntohl(header.data_offset) - ntohl(header.index_offset)) / sizeof(struct index_entry_t);
-  struct index_entry_t* entry = (struct index_entry_t*) index;
-  for (size_t i = 0; i < id_count; ++i) {
-    char this_id[NAME_LENGTH + 1];
-    memcpy(this_id, entry->buf, NAME_LENGTH);
-    this_id[NAME_LENGTH] = '\0';
-
-    if (strcmp(this_id, olson_id) == 0) {
-      specific_zone_offset = ntohl(entry->start) + ntohl(header.data_offset);
+  tzdata->data = data;
+  tzdata->size = sb.st_size;
+  tzdata->index = (const struct index_entry_t*) (tzdata->data + index_offset);
+  tzdata->id_count = (data_offset - index_offset) / sizeof(struct index_entry_t);
+  tzdata->data_offset = data_offset;
+  tzdata->sorted = true;
+  for (size_t i = 1; i < tzdata->id_count; ++i) {
+    if (strncmp(tzdata->index[i - 1].buf, tzdata->index[i].buf, TZDATA_NAME_LENGTH) >= 0) {
+      tzdata->sorted = false;
       break;
     }
+  }
+  return 0;
+}
 
-    ++entry;
+static const struct index_entry_t* __bionic_find_tzdata_id(const struct bionic_tzdata* tzdata,
+                                                           const char* olson_id) {
+  // Ids are NUL-padded, so one that fills the whole field has no terminator.
+  if (strlen(olson_id) > TZDATA_NAME_LENGTH) {
+    return NULL;
   }
-  free(index);
 
-  if (specific_zone_offset == -1) {
-    free(path);
-    close(fd);
-    return -1;
+  if (tzdata->sorted) {
+    size_t lo = 0;
+    size_t hi = tzdata->id_count;
+    while (lo < hi) {
+      size_t mid = lo + (hi - lo) / 2;
+      int cmp = strncmp(tzdata->index[mid].buf, olson_id, TZDATA_NAME_LENGTH);
+      if (cmp == 0) {
+        return &tzdata->index[mid];
+      } else if (cmp < 0) {
+        lo = mid + 1;
+      } else {
+        hi = mid;
+      }
+    }
+    return NULL;
   }
 
-  if (TEMP_FAILURE_RETRY(lseek(fd, specific_zone_offset, SEEK_SET)) == -1) {
-    fprintf(stderr, "%s: could not seek to %ld in \"%s\": %s\n",
-            __FUNCTION__, specific_zone_offset, path, strerror(errno));
-    free(path);
-    close(fd);
+  for (size_t i = 0; i < tzdata->id_count; ++i) {
+    if (strncmp(tzdata->index[i].buf, olson_id, TZDATA_NAME_LENGTH) == 0) {
+      return &tzdata->index[i];
+    }
+  }
+  return NULL;
+}
+
+// Copies the zone olson_id from the given file into buf, truncated to buf_size bytes, and
+// returns its length. Returns -1 if the zone isn't there and -2 if the file isn't.
+static ssize_t __bionic_read_tzdata_path(struct bionic_tzdata* tzdata,
+                                         const char* path_prefix_variable,
+                                         const char* path_suffix, const char* olson_id,
+                                         char* buf, size_t buf_size) {
+  pthread_mutex_lock(&__bionic_tzdata_lock);
+  if (!tzdata->mapped) {
+    tzdata->error = __bionic_map_tzdata(tzdata, path_prefix_variable, path_suffix);
+    tzdata->mapped = true;
+  }
+  pthread_mutex_unlock(&__bionic_tzdata_lock);
+  if (tzdata->error != 0) {
+    return tzdata->error;
+  }
+
+  const struct index_entry_t* entry = __bionic_find_tzdata_id(tzdata, olson_id);
+  if (entry == NULL) {
     return -1;
   }
 
   // TODO: check that there's TZ_MAGIC at this offset, so we can fall back to the other file if not.
-
-  free(path);
-  return fd;
+  size_t specific_zone_offset = ntohl(entry->start) + tzdata->data_offset;
+  size_t n = ntohl(entry->length);
+  if (specific_zone_offset > tzdata->size || n > tzdata->size - specific_zone_offset) {
+    return -1;
+  }
+  if (n > buf_size) {
+    n = buf_size;
+  }
+  memcpy(buf, tzdata->data + specific_zone_offset, n);
+  return n;
 }
 
-static int __bionic_open_tzdata(const char* olson_id) {
-  int fd = __bionic_open_tzdata_path("ANDROID_DATA", "/misc/zoneinfo/current/tzdata", olson_id);
-  if (fd < 0) {
-    fd = __bionic_open_tzdata_path("ANDROID_ROOT", "/usr/share/zoneinfo/tzdata", olson_id);
-    if (fd == -2) {
+static ssize_t __bionic_read_tzdata(const char* olson_id, char* buf, size_t buf_size) {
+  ssize_t n = __bionic_read_tzdata_path(&__bionic_tzdata_files[0], "ANDROID_DATA",
+                                        "/misc/zoneinfo/current/tzdata", olson_id, buf, buf_size);
+  if (n < 0) {
+    n = __bionic_read_tzdata_path(&__bionic_tzdata_files[1], "ANDROID_ROOT",
+                                  "/usr/share/zoneinfo/tzdata", olson_id, buf, buf_size);
+    if (n == -2) {
       // The first thing that 'recovery' does is try to format the current time. It doesn't have
       // any tzdata available, so we must not abort here --- doing so breaks the recovery image!
       fprintf(stderr, "%s: couldn't find any tzdata when looking for %s!\n", __FUNCTION__, olson_id);
     }
   }
-  return fd;
+  if (n < 0) {
+    errno = ENOENT;
+  }
+  return n;
 }
 
 // END android-added
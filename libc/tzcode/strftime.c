@@ -118,6 +118,8 @@ static char *   _add(const char *, char *, const char *, int);
 static char *   _conv(int, const char *, char *, const char *);
 static char *   _fmt(const char *, const struct tm *, char *, const char *,
             int *);
+static char *   _fmt_numeric(const char *, const struct tm *, char *,
+            const char *);
 static char *   _yconv(int, int, bool, bool, char *, const char *, int);
 
 #if !HAVE_POSIX_DECLS
@@ -151,6 +153,17 @@ strftime(char *s, size_t maxsize, const char *format, const struct tm *t)
     char *  p;
     int warn;
 
+    // BEGIN: Android-added.
+    // Timestamps in ISO 8601 and the like need neither tzset nor snprintf.
+    if (format != NULL) {
+        p = _fmt_numeric(format, t, s, s + maxsize);
+        if (p != NULL && p != s + maxsize) {
+            *p = '\0';
+            return p - s;
+        }
+    }
+    // END: Android-added.
+
     tzset();
     warn = IN_NONE;
     p = _fmt(((format == NULL) ? "%c" : format), t, s, s + maxsize, &warn);
@@ -626,6 +639,114 @@ label:
     return pt;
 }
 
+// BEGIN: Android-added.
+static const char digit_pairs[] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+/*
+** Formats like _fmt, but only formats made of plain characters and the
+** conversions with fixed-width numeric output: %Y %m %d %H %M %S %F %T %z and
+** %%, without any modifiers. Returns NULL if the format has anything else, if
+** a field's value wouldn't fit its usual width, or if the output wouldn't fit,
+** all of which are left to _fmt.
+*/
+static char *
+_fmt_numeric(const char *format, const struct tm *t, char *pt,
+        const char *ptlim)
+{
+    int n;
+
+    for ( ; *format; ++format) {
+        if (*format != '%') {
+            if (pt == ptlim)
+                return NULL;
+            *pt++ = *format;
+            continue;
+        }
+        switch (*++format) {
+        case 'Y':
+            if (t->tm_year < -TM_YEAR_BASE || t->tm_year > 9999 - TM_YEAR_BASE ||
+                ptlim - pt < 4)
+                return NULL;
+            n = t->tm_year + TM_YEAR_BASE;
+            memcpy(pt, &digit_pairs[2 * (n / 100)], 2);
+            memcpy(pt + 2, &digit_pairs[2 * (n % 100)], 2);
+            pt += 4;
+            continue;
+        case 'm':
+            if (t->tm_mon < -1 || t->tm_mon > 98)
+                return NULL;
+            n = t->tm_mon + 1;
+            goto two_digits;
+        case 'd':
+            n = t->tm_mday;
+            goto two_digits;
+        case 'H':
+            n = t->tm_hour;
+            goto two_digits;
+        case 'M':
+            n = t->tm_min;
+            goto two_digits;
+        case 'S':
+            n = t->tm_sec;
+two_digits:
+            if (n < 0 || n > 99 || ptlim - pt < 2)
+                return NULL;
+            memcpy(pt, &digit_pairs[2 * n], 2);
+            pt += 2;
+            continue;
+        case 'F':
+            pt = _fmt_numeric("%Y-%m-%d", t, pt, ptlim);
+            break;
+        case 'T':
+            pt = _fmt_numeric("%H:%M:%S", t, pt, ptlim);
+            break;
+        case 'z':
+#ifdef TM_GMTOFF
+            {
+                long diff = t->TM_GMTOFF;
+
+                if (t->tm_isdst < 0)
+                    continue;
+                if (diff <= -100 * SECSPERHOUR || diff >= 100 * SECSPERHOUR ||
+                    ptlim - pt < 5)
+                    return NULL;
+                *pt++ = (diff < 0) ? '-' : '+';
+                if (diff < 0)
+                    diff = -diff;
+                diff /= SECSPERMIN;
+                memcpy(pt, &digit_pairs[2 * (diff / MINSPERHOUR)], 2);
+                memcpy(pt + 2, &digit_pairs[2 * (diff % MINSPERHOUR)], 2);
+                pt += 4;
+            }
+            continue;
+#else /* !defined TM_GMTOFF */
+            return NULL;
+#endif /* !defined TM_GMTOFF */
+        case '%':
+            if (pt == ptlim)
+                return NULL;
+            *pt++ = '%';
+            continue;
+        default:
+            return NULL;
+        }
+        if (pt == NULL)
+            return NULL;
+    }
+    return pt;
+}
+// END: Android-added.
+
 static char *
 _conv(int n, const char *format, char *pt, const char *ptlim)
 {
@@ -65,8 +65,9 @@ at_quick_exit(void (*func)(void))
 	return (0);
 }
 
+/* BEGIN android-changed: also used by exit() in fast exit mode */
 void
-quick_exit(int status)
+__run_quick_exit_handlers(void)
 {
 	struct quick_exit_handler *h;
 
@@ -76,5 +77,12 @@ quick_exit(int status)
 	 */
 	for (h = handlers; NULL != h; h = h->next)
 		h->cleanup();
+}
+
+void
+quick_exit(int status)
+{
+	__run_quick_exit_handlers();
 	_Exit(status);
 }
+/* END android-changed */
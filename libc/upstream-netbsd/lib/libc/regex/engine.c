@@ -81,6 +81,7 @@
 #ifdef SNAMES
 #define	matcher	smatcher
 #define	fast	sfast
+#define	fastdfa	sfastdfa
 #define	slow	sslow
 #define	dissect	sdissect
 #define	backref	sbackref
@@ -93,6 +94,7 @@
 #ifdef LNAMES
 #define	matcher	lmatcher
 #define	fast	lfast
+#define	fastdfa	lfastdfa
 #define	slow	lslow
 #define	dissect	ldissect
 #define	backref	lbackref
@@ -118,6 +120,10 @@ struct match {
 	states fresh;		/* states for a fresh start */
 	states tmp;		/* temporary */
 	states empty;		/* empty set of states */
+	/* BEGIN android-changed */
+	struct re_scratch *scratch;	/* reused between calls */
+	struct re_dfa *dfa;	/* for fast(), or NULL */
+	/* END android-changed */
 };
 
 /* ========= begin header generated by ./mkh ========= */
@@ -130,6 +136,9 @@ static int matcher(struct re_guts *g, const char *string, size_t nmatch, regmatc
 static const char *dissect(struct match *m, const char *start, const char *stop, sopno startst, sopno stopst);
 static const char *backref(struct match *m, const char *start, const char *stop, sopno startst, sopno stopst, sopno lev);
 static const char *fast(struct match *m, const char *start, const char *stop, sopno startst, sopno stopst);
+/* BEGIN android-changed */
+static const char *fastdfa(struct match *m, const char *start, const char *stop, sopno startst, sopno stopst);
+/* END android-changed */
 static const char *slow(struct match *m, const char *start, const char *stop, sopno startst, sopno stopst);
 static states step(struct re_guts *g, sopno start, sopno stop, states bef, int ch, states aft);
 #define	BOL	(OUT+1)
@@ -227,6 +236,15 @@ matcher(
 	m->offp = string;
 	m->beginp = start;
 	m->endp = stop;
+	/* BEGIN android-changed: reuse scratch space, and the DFA if we can */
+	m->scratch = getscratch(g);
+	if (m->scratch == NULL)
+		return(REG_ESPACE);
+	m->dfa = NULL;
+	if (!g->backrefs && !(eflags&REG_BACKR) &&
+	    dfa_prepare(&m->scratch->dfa, g, STATESIZE(g)))
+		m->dfa = &m->scratch->dfa;
+	/* END android-changed */
 	STATESETUP(m, 4);
 	SETUP(m->st);
 	SETUP(m->fresh);
@@ -236,7 +254,12 @@ matcher(
 
 	/* this loop does only one repetition except for backrefs */
 	for (;;) {
-		endp = fast(m, start, stop, gf, gl);
+		/* BEGIN android-changed */
+		if (m->dfa != NULL)
+			endp = fastdfa(m, start, stop, gf, gl);
+		else
+			endp = fast(m, start, stop, gf, gl);
+		/* END android-changed */
 		if (endp == NULL) {		/* a miss */
 			error = REG_NOMATCH;
 			goto done;
@@ -258,26 +281,19 @@ matcher(
 			break;		/* no further info needed */
 
 		/* oh my, he wants the subexpressions... */
-		if (m->pmatch == NULL)
-			m->pmatch = (regmatch_t *)malloc((m->g->nsub + 1) *
-							sizeof(regmatch_t));
-		if (m->pmatch == NULL) {
-			error = REG_ESPACE;
-			goto done;
-		}
+		/* BEGIN android-changed */
+		m->pmatch = m->scratch->pmatch;
+		/* END android-changed */
 		for (i = 1; i <= m->g->nsub; i++)
 			m->pmatch[i].rm_so = m->pmatch[i].rm_eo = (regoff_t)-1;
 		if (!g->backrefs && !(m->eflags&REG_BACKR)) {
 			NOTE("dissecting");
 			dp = dissect(m, m->coldp, endp, gf, gl);
 		} else {
-			if (g->nplus > 0 && m->lastpos == NULL)
-				m->lastpos = malloc((g->nplus+1) *
-							sizeof(const char *));
-			if (g->nplus > 0 && m->lastpos == NULL) {
-				error = REG_ESPACE;
-				goto done;
-			}
+			/* BEGIN android-changed */
+			if (g->nplus > 0)
+				m->lastpos = m->scratch->lastpos;
+			/* END android-changed */
 			NOTE("backref dissect");
 			dp = backref(m, m->coldp, endp, gf, gl, (sopno)0);
 		}
@@ -332,15 +348,12 @@ matcher(
 	}
 
 done:
-	if (m->pmatch != NULL) {
-		free(m->pmatch);
-		m->pmatch = NULL;
-	}
-	if (m->lastpos != NULL) {
-		free(m->lastpos);
-		m->lastpos = NULL;
-	}
+	/* BEGIN android-changed */
+	m->pmatch = NULL;
+	m->lastpos = NULL;
 	STATETEARDOWN(m);
+	putscratch(g, m->scratch);
+	/* END android-changed */
 	return error;
 }
 
@@ -858,6 +871,129 @@ fast(
 		return(NULL);
 }
 
+/* BEGIN android-changed: fast(), stepping through m->dfa */
+/*
+ - fastdfa - fast(), but with transitions cached in a DFA
+ * The DFA caches what step() does for ordinary characters.  The steps
+ * for ^, $ and word boundaries depend on the characters either side, so
+ * they're still taken with step(), and the resulting set looked up.
+ */
+static const char *		/* where tentative match ended, or NULL */
+fastdfa(
+    struct match *m,
+    const char *start,
+    const char *stop,
+    sopno startst,
+    sopno stopst)
+{
+	struct re_dfa *d = m->dfa;
+	const cat_t *cats = m->g->categories;
+	states st = m->st;
+	states fresh = m->fresh;
+	states tmp = m->tmp;
+	const char *p = start;
+	int c = (start == m->beginp) ? OUT : *(start-1);
+	int lastc;	/* previous c */
+	int flagch;
+	int boleol;	/* flagch for ^ and $ */
+	int flushed;
+	size_t i;
+	size_t cur;	/* DFA state for st */
+	size_t next;
+	const char *coldp; /* last p after which no match was underway */
+
+	_DIAGASSERT(m != NULL);
+	_DIAGASSERT(start != NULL);
+	_DIAGASSERT(stop != NULL);
+
+	if (d->nstates == 0) {
+		CLEAR(st);
+		SET1(st, startst);
+		st = step(m->g, startst, stopst, st, NOTHING, st);
+		flushed = 0;
+		(void)dfa_state(d, STATEPTR(st), ISSET(st, stopst), &flushed);
+	}
+	memcpy(STATEPTR(fresh), d->sets, d->setsize);
+	cur = 0;
+	coldp = NULL;
+	for (;;) {
+		/* next character */
+		lastc = c;
+		c = (p == m->endp) ? OUT : *p;
+		if (cur == 0)
+			coldp = p;
+
+		/* is there an EOL and/or BOL between lastc and c? */
+		flagch = '\0';
+		i = 0;
+		if ( (lastc == '\n' && m->g->cflags&REG_NEWLINE) ||
+				(lastc == OUT && !(m->eflags&REG_NOTBOL)) ) {
+			flagch = BOL;
+			i = m->g->nbol;
+		}
+		if ( (c == '\n' && m->g->cflags&REG_NEWLINE) ||
+				(c == OUT && !(m->eflags&REG_NOTEOL)) ) {
+			flagch = (flagch == BOL) ? BOLEOL : EOL;
+			i += m->g->neol;
+		}
+		boleol = flagch;
+
+		/* how about a word boundary? (only matters if we use them) */
+		if (d->words) {
+			if ( (flagch == BOL || (lastc != OUT && !ISWORD(lastc))) &&
+						(c != OUT && ISWORD(c)) ) {
+				flagch = BOW;
+			}
+			if ( (lastc != OUT && ISWORD(lastc)) &&
+					(flagch == EOL || (c != OUT && !ISWORD(c))) ) {
+				flagch = EOW;
+			}
+		}
+
+		if (i != 0 || flagch == BOW || flagch == EOW) {
+			memcpy(STATEPTR(st), d->sets + cur * d->setsize,
+			    d->setsize);
+			for (; i > 0; i--)
+				st = step(m->g, startst, stopst, st, boleol, st);
+			if (flagch == BOW || flagch == EOW)
+				st = step(m->g, startst, stopst, st, flagch, st);
+			flushed = 0;
+			cur = dfa_state(d, STATEPTR(st), ISSET(st, stopst),
+			    &flushed);
+		}
+
+		/* are we done? */
+		if (d->accept[cur] || p == stop)
+			break;		/* NOTE BREAK OUT */
+
+		/* no, take the transition for this character */
+		assert(c != OUT);
+		next = d->trans[cur * d->ncat + cats[c]];
+		if (next == DFA_NONE) {
+			memcpy(STATEPTR(tmp), d->sets + cur * d->setsize,
+			    d->setsize);
+			ASSIGN(st, fresh);
+			st = step(m->g, startst, stopst, tmp, c, st);
+			flushed = 0;
+			next = dfa_state(d, STATEPTR(st), ISSET(st, stopst),
+			    &flushed);
+			if (!flushed)
+				d->trans[cur * d->ncat + cats[c]] =
+				    (uint16_t)next;
+		}
+		cur = next;
+		p++;
+	}
+
+	assert(coldp != NULL);
+	m->coldp = coldp;
+	if (d->accept[cur])
+		return(p+1);
+	else
+		return(NULL);
+}
+/* END android-changed */
+
 /*
  - slow - step through the string more deliberately
  == static const char *slow(struct match *m, const char *start, \
@@ -1178,6 +1314,7 @@ pchar(
 
 #undef	matcher
 #undef	fast
+#undef	fastdfa
 #undef	slow
 #undef	dissect
 #undef	backref
@@ -298,6 +298,9 @@ regcomp(
 	g->categories = &g->catspace[-(CHAR_MIN)];
 	(void) memset((char *)g->catspace, 0, NC*sizeof(cat_t));
 	g->backrefs = 0;
+	/* BEGIN android-changed */
+	g->scratch = NULL;
+	/* END android-changed */
 
 	/* do it */
 	EMIT(OEND, 0);
@@ -200,10 +200,18 @@ struct re_guts {
 	size_t nsub;		/* copy of re_nsub */
 	int backrefs;		/* does it use back references? */
 	sopno nplus;		/* how deep does it nest +s? */
+	/* BEGIN android-changed: kept between regexec calls */
+	struct re_scratch *scratch;	/* idle scratch space, or NULL */
+	/* END android-changed */
 	/* catspace must be last */
 	cat_t catspace[1];	/* actually [NC] */
 };
 
 /* misc utilities */
+/* BEGIN android-changed */
+struct re_scratch;
+__LIBC_HIDDEN__ void __regex_free_scratch(struct re_scratch *);
+/* END android-changed */
+
 #define	OUT	(CHAR_MAX+1)	/* a non-character value */
 #define	ISWORD(c)	(isalnum((unsigned char)c) || (c) == '_')
@@ -105,6 +105,206 @@ __weak_alias(regexec,_regexec)
 #include "utils.h"
 #include "regex2.h"
 
+/* BEGIN android-changed: scratch space and a DFA kept between regexec calls */
+#include <stdint.h>
+
+/*
+ * Everything matcher() would otherwise allocate comes from one block per
+ * regex_t, which is kept for the next regexec rather than freed.  A caller
+ * that finds the block in use by another thread allocates its own, and
+ * frees it afterwards if the first one has been handed back by then.
+ *
+ * The block also holds a DFA built lazily from the state sets fast() goes
+ * through: each distinct set gets a row of transitions indexed by
+ * character category, each filled in by one step() the first time it's
+ * taken.  Once a pattern's common paths have been seen, scanning a string
+ * costs a table lookup per character rather than a step() over the whole
+ * strip, however large the pattern.
+ */
+#define	DFA_INITSTATES	16
+#define	DFA_MAXSTATES	1024	/* past this, flush and start again */
+#define	DFA_NONE	UINT16_MAX	/* transition not known yet */
+
+struct re_dfa {
+	size_t setsize;		/* bytes in a state set */
+	size_t ncat;		/* transitions per state */
+	size_t nstates;		/* states in use; 0 is the fresh start */
+	size_t cap;		/* states allocated */
+	int words;		/* pattern uses word boundaries */
+	uint16_t *trans;	/* [cap][ncat] */
+	unsigned char *accept;	/* [cap]: set includes the stop state */
+	char *sets;		/* [cap][setsize] */
+	uint16_t *hash;		/* [cap*2]: state index + 1, or 0 if empty */
+};
+
+struct re_scratch {
+	struct re_dfa dfa;
+	regmatch_t *pmatch;	/* [nsub+1] */
+	const char **lastpos;	/* [nplus+1] */
+	char *space;		/* 4 state sets for lmatcher */
+};
+
+static struct re_scratch *
+getscratch(struct re_guts *g)
+{
+	struct re_scratch *sc;
+	size_t size;
+
+	sc = __atomic_exchange_n(&g->scratch, NULL, __ATOMIC_ACQUIRE);
+	if (sc != NULL)
+		return sc;
+
+	size = sizeof(*sc) + (g->nsub + 1) * sizeof(regmatch_t) +
+	    (g->nplus + 1) * sizeof(const char *) + 4 * (size_t)g->nstates;
+	sc = calloc(1, size);
+	if (sc == NULL)
+		return NULL;
+	sc->pmatch = (regmatch_t *)(sc + 1);
+	sc->lastpos = (const char **)(sc->pmatch + g->nsub + 1);
+	sc->space = (char *)(sc->lastpos + g->nplus + 1);
+	return sc;
+}
+
+static void
+putscratch(struct re_guts *g, struct re_scratch *sc)
+{
+	struct re_scratch *expected = NULL;
+
+	if (!__atomic_compare_exchange_n(&g->scratch, &expected, sc, 0,
+	    __ATOMIC_RELEASE, __ATOMIC_RELAXED))
+		__regex_free_scratch(sc);
+}
+
+void
+__regex_free_scratch(struct re_scratch *sc)
+{
+	if (sc == NULL)
+		return;
+	free(sc->dfa.trans);
+	free(sc->dfa.accept);
+	free(sc->dfa.sets);
+	free(sc->dfa.hash);
+	free(sc);
+}
+
+static uint32_t
+dfa_hashset(const char *set, size_t n)
+{
+	uint32_t h = 2166136261u;
+
+	while (n-- > 0)
+		h = (h ^ (unsigned char)*set++) * 16777619u;
+	return h;
+}
+
+static void
+dfa_rehash(struct re_dfa *d)
+{
+	size_t i, j, mask = d->cap * 2 - 1;
+
+	memset(d->hash, 0, d->cap * 2 * sizeof(*d->hash));
+	for (i = 0; i < d->nstates; i++) {
+		j = dfa_hashset(d->sets + i * d->setsize, d->setsize) & mask;
+		while (d->hash[j] != 0)
+			j = (j + 1) & mask;
+		d->hash[j] = (uint16_t)(i + 1);
+	}
+}
+
+static int
+dfa_resize(struct re_dfa *d, size_t cap)
+{
+	uint16_t *trans;
+	unsigned char *accept;
+	char *sets;
+	uint16_t *hash;
+
+	trans = realloc(d->trans, cap * d->ncat * sizeof(*trans));
+	if (trans != NULL)
+		d->trans = trans;
+	accept = realloc(d->accept, cap);
+	if (accept != NULL)
+		d->accept = accept;
+	sets = realloc(d->sets, cap * d->setsize);
+	if (sets != NULL)
+		d->sets = sets;
+	hash = realloc(d->hash, cap * 2 * sizeof(*hash));
+	if (hash != NULL)
+		d->hash = hash;
+	if (trans == NULL || accept == NULL || sets == NULL || hash == NULL)
+		return 0;
+	d->cap = cap;
+	dfa_rehash(d);
+	return 1;
+}
+
+/*
+ * Gets the DFA ready for a regex whose state sets are setsize bytes.
+ * Returns 0 if it can't be used.
+ */
+static int
+dfa_prepare(struct re_dfa *d, struct re_guts *g, size_t setsize)
+{
+	sopno pc;
+
+	if (d->cap != 0 && d->setsize == setsize)
+		return 1;
+
+	free(d->trans);
+	free(d->accept);
+	free(d->sets);
+	free(d->hash);
+	memset(d, 0, sizeof(*d));
+	d->setsize = setsize;
+	d->ncat = g->ncategories;
+	for (pc = 0; pc < g->nstates; pc++)
+		if (OP(g->strip[pc]) == OBOW || OP(g->strip[pc]) == OEOW)
+			d->words = 1;
+	if (!dfa_resize(d, DFA_INITSTATES)) {
+		d->cap = 0;
+		return 0;
+	}
+	return 1;
+}
+
+/*
+ * Returns the index of the DFA state for this set of NFA states, adding it
+ * if need be.  If the DFA is full, everything but the fresh start state is
+ * thrown away first, and *flushed is set.
+ */
+static size_t
+dfa_state(struct re_dfa *d, const char *set, int accept, int *flushed)
+{
+	size_t i, j, mask;
+
+	for (;;) {
+		mask = d->cap * 2 - 1;
+		j = dfa_hashset(set, d->setsize) & mask;
+		while ((i = d->hash[j]) != 0) {
+			if (memcmp(d->sets + (i - 1) * d->setsize, set,
+			    d->setsize) == 0)
+				return i - 1;
+			j = (j + 1) & mask;
+		}
+		if (d->nstates < d->cap)
+			break;
+		if (d->cap >= DFA_MAXSTATES || !dfa_resize(d, d->cap * 2)) {
+			d->nstates = 1;
+			memset(d->trans, 0xff, d->ncat * sizeof(*d->trans));
+			dfa_rehash(d);
+			*flushed = 1;
+		}
+	}
+
+	i = d->nstates++;
+	memcpy(d->sets + i * d->setsize, set, d->setsize);
+	d->accept[i] = (unsigned char)accept;
+	memset(d->trans + i * d->ncat, 0xff, d->ncat * sizeof(*d->trans));
+	d->hash[j] = (uint16_t)(i + 1);
+	return i;
+}
+/* END android-changed */
+
 /* macros for manipulating states, small version */
 #define	states	unsigned long
 #define	states1	unsigned long	/* for later use in regexec() decision */
@@ -127,6 +327,10 @@ __weak_alias(regexec,_regexec)
 #define	FWD(dst, src, n)	((dst) |= ((unsigned long)(src)&(here)) << (n))
 #define	BACK(dst, src, n)	((dst) |= ((unsigned long)(src)&(here)) >> (n))
 #define	ISSETBACK(v, n)	(((v) & ((unsigned long)here >> (n))) != 0)
+/* BEGIN android-changed: state sets as bytes, for the DFA */
+#define	STATEPTR(v)	((char *)&(v))
+#define	STATESIZE(g)	sizeof(unsigned long)
+/* END android-changed */
 /* function names */
 #define SNAMES			/* engine.c looks after details */
 
@@ -151,6 +355,8 @@ __weak_alias(regexec,_regexec)
 #undef	FWD
 #undef	BACK
 #undef	ISSETBACK
+#undef	STATEPTR
+#undef	STATESIZE
 #undef	SNAMES
 
 /* macros for manipulating states, large version */
@@ -162,13 +368,11 @@ __weak_alias(regexec,_regexec)
 #define	ASSIGN(d, s)	memcpy(d, s, (size_t)m->g->nstates)
 #define	EQ(a, b)	(memcmp(a, b, (size_t)m->g->nstates) == 0)
 #define	STATEVARS	int vn; char *space
+/* BEGIN android-changed: state sets come from the regex_t's scratch space */
 #define	STATESETUP(m, nv) \
-    if (((m)->space = malloc((size_t)((nv)*(m)->g->nstates))) == NULL) \
-	return(REG_ESPACE); \
-    else \
-	(m)->vn = 0
-
-#define	STATETEARDOWN(m)	{ free((m)->space); m->space = NULL; }
+	((m)->space = (m)->scratch->space, (m)->vn = 0)
+#define	STATETEARDOWN(m)	{ m->space = NULL; }
+/* END android-changed */
 #define	SETUP(v)	((v) = &m->space[(size_t)(m->vn++ * m->g->nstates)])
 #define	onestate	int
 #define	INIT(o, n)	((o) = (int)(n))
@@ -179,6 +383,10 @@ __weak_alias(regexec,_regexec)
 #define	FWD(dst, src, n)	((dst)[here+(n)] |= (src)[here])
 #define	BACK(dst, src, n)	((dst)[here-(n)] |= (src)[here])
 #define	ISSETBACK(v, n)	((v)[here - (n)])
+/* BEGIN android-changed: state sets as bytes, for the DFA */
+#define	STATEPTR(v)	(v)
+#define	STATESIZE(g)	((size_t)(g)->nstates)
+/* END android-changed */
 /* function names */
 #define	LNAMES			/* flag */
 
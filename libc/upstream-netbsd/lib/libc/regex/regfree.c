@@ -125,5 +125,8 @@ regfree(
 		free(g->setbits);
 	if (g->must != NULL)
 		free(g->must);
+	/* BEGIN android-changed */
+	__regex_free_scratch(g->scratch);
+	/* END android-changed */
 	free(g);
 }
@@ -91,6 +91,10 @@
 
 #include "charclass.h"
 
+/* BEGIN android-changed */
+#include "private/bionic_fnmatch.h"
+/* END android-changed */
+
 #define	RANGE_MATCH	1
 #define	RANGE_NOMATCH	0
 #define	RANGE_ERROR	(-1)
@@ -277,6 +281,98 @@ fnmatch_ch_success:
     return result;
 }
 
+/* BEGIN android-changed: fast paths for literal, prefix*, *suffix and *infix* */
+#define	FNM_SIMPLE_FLAGS	(FNM_NOESCAPE | FNM_PATHNAME | FNM_PERIOD)
+
+int __fnmatch_classify(const char *pattern, int flags,
+    struct fnmatch_simple *simple)
+{
+    const char *p;
+
+    if (flags & ~FNM_SIMPLE_FLAGS)
+        return 0;
+
+    simple->leading_star = (*pattern == '*');
+    if (simple->leading_star)
+        ++pattern;
+    for (p = pattern; *p; ++p) {
+        if (*p == '?' || *p == '[' || (*p == '\\' && !(flags & FNM_NOESCAPE)))
+            return 0;
+        if (*p == '*')
+            break;
+    }
+    simple->trailing_star = (*p == '*');
+    if (simple->trailing_star && p[1])
+        return 0;
+    simple->literal = pattern;
+    simple->length = (size_t)(p - pattern);
+
+    /* A '*' can't match a '/', so keep slashes out of the way for simplicity */
+    if ((flags & FNM_PATHNAME) &&
+        (simple->leading_star || simple->trailing_star) &&
+        memchr(simple->literal, '/', simple->length) != NULL)
+        return 0;
+    return 1;
+}
+
+void __fnmatch_subject(const char *string, int flags,
+    struct fnmatch_subject *subject)
+{
+    const char *p;
+
+    subject->string = string;
+    subject->length = strlen(string);
+    subject->first_slash = subject->last_slash = subject->length;
+    if ((flags & FNM_PATHNAME) &&
+        (p = memchr(string, '/', subject->length)) != NULL) {
+        subject->first_slash = (size_t)(p - string);
+        p = memrchr(string, '/', subject->length);
+        subject->last_slash = (size_t)(p - string);
+    }
+}
+
+int __fnmatch_simple(const struct fnmatch_simple *simple,
+    const struct fnmatch_subject *subject, int flags)
+{
+    const char *string = subject->string;
+    const size_t len = subject->length;
+    const size_t n = simple->length;
+    const int slash = !!(flags & FNM_PATHNAME);
+
+    if (len < n)
+        return FNM_NOMATCH;
+
+    if (!simple->leading_star && !simple->trailing_star) {
+        return (len == n && memcmp(string, simple->literal, n) == 0) ?
+            0 : FNM_NOMATCH;
+    }
+
+    /* A leading '*' never matches a leading period */
+    if (simple->leading_star && (flags & FNM_PERIOD) && *string == '.')
+        return FNM_NOMATCH;
+
+    if (!simple->leading_star) {
+        /* prefix*: the '*' matches [n, len) */
+        if (slash && subject->last_slash < len && subject->last_slash >= n)
+            return FNM_NOMATCH;
+        return (memcmp(string, simple->literal, n) == 0) ? 0 : FNM_NOMATCH;
+    }
+
+    if (!simple->trailing_star) {
+        /* *suffix: the '*' matches [0, len - n) */
+        if (slash && subject->first_slash < len - n)
+            return FNM_NOMATCH;
+        return (memcmp(string + len - n, simple->literal, n) == 0) ?
+            0 : FNM_NOMATCH;
+    }
+
+    /* *infix*: the '*'s between them match everything but the infix */
+    if (slash && subject->first_slash < len)
+        return FNM_NOMATCH;
+    return (memmem(string, len, simple->literal, n) != NULL) ? 0 : FNM_NOMATCH;
+}
+/* END android-changed */
+
 
 int fnmatch(const char *pattern, const char *string, int flags)
 {
@@ -294,6 +390,15 @@ int fnmatch(const char *pattern, const char *string, int flags)
     const char *strstartseg = NULL;
     const char *mismatch = NULL;
     int matchlen = 0;
+    /* BEGIN android-changed */
+    struct fnmatch_simple simple;
+    struct fnmatch_subject subject;
+
+    if (__fnmatch_classify(pattern, flags, &simple)) {
+        __fnmatch_subject(string, flags, &subject);
+        return __fnmatch_simple(&simple, &subject, flags);
+    }
+    /* END android-changed */
 
     if (*pattern == '*')
         goto firstsegment;
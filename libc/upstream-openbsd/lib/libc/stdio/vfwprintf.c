@@ -169,6 +169,9 @@ __mbsconv(char *mbsarg, int prec)
 	wchar_t *convbuf, *wcp;
 	const char *p;
 	size_t insize, nchars, nconv;
+	/* BEGIN android-changed: read MB_CUR_MAX once, not per character */
+	size_t mb_cur_max = MB_CUR_MAX;
+	/* END android-changed */
 
 	if (mbsarg == NULL)
 		return (NULL);
@@ -186,7 +189,9 @@ __mbsconv(char *mbsarg, int prec)
 		insize = nchars = nconv = 0;
 		bzero(&mbs, sizeof(mbs));
 		while (nchars != (size_t)prec) {
-			nconv = mbrlen(p, MB_CUR_MAX, &mbs);
+			/* BEGIN android-changed */
+			nconv = mbrlen(p, mb_cur_max, &mbs);
+			/* END android-changed */
 			if (nconv == (size_t)0 || nconv == (size_t)-1 ||
 			    nconv == (size_t)-2)
 				break;
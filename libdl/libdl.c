@@ -19,6 +19,7 @@
 #include <stdlib.h>
 #include <stdbool.h>
 #include <android/dlext.h>
+#include <android/libc_stats.h>
 
 // These are stubs for functions that are actually defined
 // in the dynamic linker and hijacked at runtime.
@@ -46,6 +47,12 @@ int dl_iterate_phdr(int (*cb)(struct dl_phdr_info* info, size_t size, void* data
   return 0;
 }
 
+const struct android_dl_phdr_snapshot* android_get_dl_phdr_snapshot() { return 0; }
+
+void android_linker_stats_iterate(void (*callback)(const struct android_libc_stat*, void*) __unused,
+                                  void* arg __unused) {
+}
+
 void android_get_LD_LIBRARY_PATH(char* buffer __unused, size_t buffer_size __unused) { }
 void android_update_LD_LIBRARY_PATH(const char* ld_library_path __unused) { }
 
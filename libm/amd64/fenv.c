@@ -209,17 +209,16 @@ fetestexcept(int excepts)
 int
 fegetround(void)
 {
-  unsigned short control;
+  unsigned int mxcsr;
 
   /*
-   * We assume that the x87 and the SSE unit agree on the
-   * rounding mode.  Reading the control word on the x87 turns
-   * out to be about 5 times faster than reading it on the SSE
-   * unit on an Opteron 244.
+   * The x87 and the SSE unit agree on the rounding mode unless
+   * feswapround() has changed only the latter. float and double
+   * arithmetic uses SSE, so that's the mode to report.
    */
-  __asm__ __volatile__ ("fnstcw %0" : "=m" (control));
+  __asm__ __volatile__ ("stmxcsr %0" : "=m" (mxcsr));
 
-  return (control & X87_ROUND_MASK);
+  return ((mxcsr >> SSE_ROUND_SHIFT) & X87_ROUND_MASK);
 }
 
 /*
@@ -230,32 +229,54 @@ fegetround(void)
 int
 fesetround(int round)
 {
-  unsigned short control;
-  unsigned int mxcsr;
+  unsigned short control, new_control;
+  unsigned int mxcsr, new_mxcsr;
 
   /* Check whether requested rounding direction is supported */
   if (round & ~X87_ROUND_MASK)
     return (-1);
 
-  /* Store the current x87 control word register */
+  /*
+   * Loading either control register is far slower than storing it, so
+   * only load the ones that need to change.
+   */
   __asm__ __volatile__ ("fnstcw %0" : "=m" (control));
-
-  /* Set the rounding direction */
-  control &= ~X87_ROUND_MASK;
-  control |= round;
-
-  /* Load the x87 control word register */
-  __asm__ __volatile__ ("fldcw %0" : : "m" (control));
+  new_control = (control & ~X87_ROUND_MASK) | round;
+  if (new_control != control)
+    __asm__ __volatile__ ("fldcw %0" : : "m" (new_control));
 
   /* Same for the SSE environment */
   __asm__ __volatile__ ("stmxcsr %0" : "=m" (mxcsr));
-  mxcsr &= ~(X87_ROUND_MASK << SSE_ROUND_SHIFT);
-  mxcsr |= round << SSE_ROUND_SHIFT;
-  __asm__ __volatile__ ("ldmxcsr %0" : : "m" (mxcsr));
+  new_mxcsr = (mxcsr & ~(X87_ROUND_MASK << SSE_ROUND_SHIFT)) |
+      (round << SSE_ROUND_SHIFT);
+  if (new_mxcsr != mxcsr)
+    __asm__ __volatile__ ("ldmxcsr %0" : : "m" (new_mxcsr));
 
   return (0);
 }
 
+/*
+ * The feswapround() function sets the rounding direction of the SSE unit, and
+ * so of float and double arithmetic, and returns the previous one. The x87,
+ * and so long double arithmetic, is left alone; use fesetround() for that.
+ */
+int
+feswapround(int round)
+{
+  unsigned int mxcsr, new_mxcsr;
+
+  if (round & ~X87_ROUND_MASK)
+    return (-1);
+
+  __asm__ __volatile__ ("stmxcsr %0" : "=m" (mxcsr));
+  new_mxcsr = (mxcsr & ~(X87_ROUND_MASK << SSE_ROUND_SHIFT)) |
+      (round << SSE_ROUND_SHIFT);
+  if (new_mxcsr != mxcsr)
+    __asm__ __volatile__ ("ldmxcsr %0" : : "m" (new_mxcsr));
+
+  return ((mxcsr >> SSE_ROUND_SHIFT) & X87_ROUND_MASK);
+}
+
 /*
  * The fegetenv() function attempts to store the current floating-point
  * environment in the object pointed to by envp.
@@ -99,6 +99,19 @@ int fesetround(int __round) {
   return 0;
 }
 
+int feswapround(int __round) {
+  fenv_t _fpscr, _new_fpscr;
+  if (__round & ~0x3) {
+    return -1;
+  }
+  fegetenv(&_fpscr);
+  _new_fpscr = (_fpscr & ~(0x3 << FPSCR_RMODE_SHIFT)) | (__round << FPSCR_RMODE_SHIFT);
+  if (_new_fpscr != _fpscr) {
+    fesetenv(&_new_fpscr);
+  }
+  return ((_fpscr >> FPSCR_RMODE_SHIFT) & 0x3);
+}
+
 int feholdexcept(fenv_t* __envp) {
   fenv_t __env;
   fegetenv(&__env);
@@ -0,0 +1,73 @@
+/*-
+ * Copyright (C) 2017 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+
+#include <math.h>
+
+#include "math_config.h"
+
+// The same 5-bit estimate and 23-bit polynomial as msun's s_cbrt.c, then one Halley step
+//   t' = t - t * (t^3 - x) / (2*t^3 + x)
+// which triples the number of correct bits. With t rounded to 26 bits, t*t is exact and an fma
+// gives t^3 - x with a single rounding, so the step is accurate to about 2^-69 and the result is
+// within 0.501 ULP (msun's is within 0.667 ULP). The denominator is divided by 4 so that it
+// can't overflow, and x below 2^-767 is scaled up so that t^3 - x can't lose bits to underflow.
+
+// (1023 - 1023/3 - 0.03306235651) * 2^20.
+static const uint32_t B1 = 715094163;
+
+// |1/cbrt(x) - p(x)| < 2^-23.5.
+static const double P0 = 1.87595182427177009643;
+static const double P1 = -1.88497979543377169875;
+static const double P2 = 1.621429720105354466140;
+static const double P3 = -0.758397934778766047437;
+static const double P4 = 0.145996192886612446982;
+
+double cbrt(double x) {
+  uint64_t ix = asuint64(x);
+  uint64_t sign = ix & 0x8000000000000000ULL;
+  ix ^= sign;
+  double scale = 1.0;
+
+  if (__predict_false(ix >= 0x7ff0000000000000ULL)) return x + x;
+  if (__predict_false(ix < 0x1000000000000000ULL)) {
+    if (ix == 0) return x;
+    ix = asuint64(asdouble(ix) * 0x1p600);
+    scale = 0x1p-200;
+  }
+  double ax = asdouble(ix);
+  double t = asdouble((uint64_t) ((uint32_t) (ix >> 32) / 3 + B1) << 32);
+
+  double r = (t * t) * (t / ax);
+  t = t * ((P0 + r * (P1 + r * P2)) + ((r * r) * r) * (P3 + r * P4));
+
+  t = asdouble((asuint64(t) + (1ULL << 26)) & ~((1ULL << 27) - 1));
+  double t2 = t * t;
+  double d = __builtin_fma(t2, t, -ax);
+  double den = __builtin_fma(t2, t * 0.5, ax * 0.25);
+  t -= (t * 0.25) * (d / den);
+  return asdouble(asuint64(t * scale) | sign);
+}
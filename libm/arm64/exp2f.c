@@ -0,0 +1,135 @@
+/*-
+ * Copyright (C) 2017 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <math.h>
+
+#include "math_config.h"
+
+// expf and exp2f work in double precision, which leaves plenty of margin: 2^(k/N) comes from
+// the table below and 2^r, for |r| <= 1/(2*N), from a cubic. Both are within 0.51 ULP.
+
+#define N (1 << EXP2F_TABLE_BITS)
+
+// asuint64(2^(i/N)) - (i << 47), so that adding k << 47 gives 2^(k/N) for any k with these
+// low bits.
+const uint64_t __exp2f_data[N] = {
+    0x3ff0000000000000,
+    0x3fefd9b0d3158574,
+    0x3fefb5586cf9890f,
+    0x3fef9301d0125b51,
+    0x3fef72b83c7d517b,
+    0x3fef54873168b9aa,
+    0x3fef387a6e756238,
+    0x3fef1e9df51fdee1,
+    0x3fef06fe0a31b715,
+    0x3feef1a7373aa9cb,
+    0x3feedea64c123422,
+    0x3feece086061892d,
+    0x3feebfdad5362a27,
+    0x3feeb42b569d4f82,
+    0x3feeab07dd485429,
+    0x3feea47eb03a5585,
+    0x3feea09e667f3bcd,
+    0x3fee9f75e8ec5f74,
+    0x3feea11473eb0187,
+    0x3feea589994cce13,
+    0x3feeace5422aa0db,
+    0x3feeb737b0cdc5e5,
+    0x3feec49182a3f090,
+    0x3feed503b23e255d,
+    0x3feee89f995ad3ad,
+    0x3feeff76f2fb5e47,
+    0x3fef199bdd85529c,
+    0x3fef3720dcef9069,
+    0x3fef5818dcfba487,
+    0x3fef7c97337b9b5f,
+    0x3fefa4afa2a490da,
+    0x3fefd0765b6e4540,
+};
+
+static const double kShift = 0x1.8p52;
+static const double kExp2Shift = 0x1.8p52 / N;
+static const double kInvLn2N = 0x1.71547652b82fep+5;
+
+// For 2^r.
+static const double C0 = 0x1.c6b08d704a0c0p-5;
+static const double C1 = 0x1.ebfbdff82c58fp-3;
+static const double C2 = 0x1.62e42fefa39efp-1;
+
+// For 2^(r/N).
+static const double D0 = 0x1.c6b08d704a0c0p-20;
+static const double D1 = 0x1.ebfbdff82c58fp-13;
+static const double D2 = 0x1.62e42fefa39efp-6;
+
+// The top 12 bits of a float's sign and exponent (and the top of its significand).
+static inline uint32_t top12f(float x) {
+  return asuint(x) >> 20;
+}
+
+float exp2f(float x) {
+  uint32_t abstop = top12f(x) & 0x7ff;
+  // 0x430 is top12f(128.0f) and 0x7f8 top12f(INFINITY).
+  if (__predict_false(abstop >= 0x430)) {
+    if (asuint(x) == asuint(-INFINITY)) return 0.0f;
+    if (abstop >= 0x7f8) return x + x;
+    if (x > 0.0f) return __math_oflowf(0);
+    if (x <= -150.0f) return __math_uflowf(0);
+  }
+
+  double xd = x;
+  double kd = xd + kExp2Shift;
+  uint64_t ki = asuint64(kd);
+  kd -= kExp2Shift;
+  double r = xd - kd;
+  double s = asdouble(__exp2f_data[ki % N] + (ki << (52 - EXP2F_TABLE_BITS)));
+  double z = C0 * r + C1;
+  double r2 = r * r;
+  double y = C2 * r + 1;
+  y = z * r2 + y;
+  return y * s;
+}
+
+float expf(float x) {
+  uint32_t abstop = top12f(x) & 0x7ff;
+  if (__predict_false(abstop >= 0x430)) {
+    if (asuint(x) == asuint(-INFINITY)) return 0.0f;
+    if (abstop >= 0x7f8) return x + x;
+    if (x > 0.0f) return __math_oflowf(0);
+    if (x <= -150.0f) return __math_uflowf(0);
+  }
+
+  double z = kInvLn2N * x;
+  double kd = z + kShift;
+  uint64_t ki = asuint64(kd);
+  kd -= kShift;
+  double r = z - kd;
+  double s = asdouble(__exp2f_data[ki % N] + (ki << (52 - EXP2F_TABLE_BITS)));
+  double p = D0 * r + D1;
+  double r2 = r * r;
+  double y = D2 * r + 1;
+  y = p * r2 + y;
+  return y * s;
+}
@@ -136,6 +136,21 @@ int fesetround(int round) {
   return 0;
 }
 
+int feswapround(int round) {
+  fpu_control_t fpcr, new_fpcr;
+
+  if (round & ~FE_TOWARDZERO) {
+    return -1;
+  }
+  __get_fpcr(fpcr);
+  new_fpcr = fpcr & ~(FE_TOWARDZERO << FPCR_RMODE_SHIFT);
+  new_fpcr |= (round << FPCR_RMODE_SHIFT);
+  if (new_fpcr != fpcr) {
+    __set_fpcr(new_fpcr);
+  }
+  return ((fpcr >> FPCR_RMODE_SHIFT) & FE_TOWARDZERO);
+}
+
 int feholdexcept(fenv_t* envp) {
   fenv_t env;
   fpu_status_t fpsr;
@@ -0,0 +1,84 @@
+/*-
+ * Copyright (C) 2017 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+
+#include <math.h>
+
+#include "math_config.h"
+
+// hypot(x, y) = sqrt(x*x + y*y), with x and y first scaled by a power of two if needed to keep
+// the squares from overflowing or losing bits to underflow. The fused multiply-add and the square
+// root alone are within about 0.7 ULP; a further fma-computed correction for the rounding errors of
+// the squares and the square root (Borges, "An Improved Algorithm for hypot(a,b)") takes that to
+// within 0.51 ULP, without any of the case analysis msun's e_hypot.c does to split the squares.
+
+double hypot(double x, double y) {
+  uint64_t ix = asuint64(x) & 0x7fffffffffffffffULL;
+  uint64_t iy = asuint64(y) & 0x7fffffffffffffffULL;
+  if (ix < iy) {
+    uint64_t t = ix;
+    ix = iy;
+    iy = t;
+  }
+  double ax = asdouble(ix);
+  double ay = asdouble(iy);
+  uint32_t ex = ix >> 52;
+  uint32_t ey = iy >> 52;
+
+  if (__predict_false(ex == 0x7ff || ex - ey > 54 || iy == 0)) {
+    // An infinity wins over a NaN. Otherwise a NaN is the bigger "magnitude" after the swap,
+    // and the sum propagates it. If y is zero, or so much smaller than x that it's below half
+    // an ULP of x, the sum gives x rounded the right way for the rounding mode.
+    if (iy == 0x7ff0000000000000ULL) return ay;
+    return ax + ay;
+  }
+
+  // 0x52b is the exponent of 2^300, and 0x2d3 of 2^-300: outside that, x and y are scaled so
+  // that neither their squares nor the reciprocal of the sum below can overflow or underflow.
+  // ex - ey <= 54 means only one of the two can be needed.
+  double scale = 1.0;
+  if (ex > 0x52b) {
+    ax *= 0x1p-600;
+    ay *= 0x1p-600;
+    scale = 0x1p600;
+  } else if (ey < 0x2d3) {
+    ax *= 0x1p600;
+    ay *= 0x1p600;
+    scale = 0x1p-600;
+  }
+
+  // The correction is (h*h - x*x - y*y) / (2*h). Dividing by the sum of squares s instead, and
+  // multiplying by h, lets the division run alongside the square root.
+  double s = __builtin_fma(ax, ax, ay * ay);
+  double h = __builtin_sqrt(s);
+  double half_inv_s = 0.5 / s;
+  double h2 = h * h;
+  double ax2 = ax * ax;
+  double a = __builtin_fma(-ay, ay, h2 - ax2);
+  double b = __builtin_fma(h, h, -h2) - __builtin_fma(ax, ax, -ax2);
+  h = __builtin_fma(-(a + b), h * half_inv_s, h);
+  return h * scale;
+}
@@ -0,0 +1,258 @@
+/*-
+ * Copyright (C) 2017 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <math.h>
+
+#include "math_config.h"
+
+// log(x) = k*ln2 + log(c) + log1p(z/c - 1), where x = 2^k * z and c is near z, so that
+// |r| = |z/c - 1| < 1/256. 1/c, and log(c) to more than double precision, come from the table
+// below, and log1p(r) from a polynomial. Near 1 there's too much cancellation for that, so a
+// longer polynomial in x - 1 is used there instead. Within 0.52 ULP.
+
+#define LOG_TABLE_BITS 7
+#define N (1 << LOG_TABLE_BITS)
+#define OFF 0x3fe6000000000000ull
+
+// ln2, split so that kd * kLn2hi is exact.
+static const double kLn2hi = 0x1.62e42fefa3800p-1;
+static const double kLn2lo = 0x1.ef35793c76730p-45;
+
+// For (log1p(r) - r) / r^2, |r| < 1/256.
+static const double A0 = -0x1.ffffffffffffdp-2;
+static const double A1 = 0x1.5555555528556p-2;
+static const double A2 = -0x1.00000001f4aeep-2;
+static const double A3 = 0x1.999b046f7c69cp-3;
+static const double A4 = -0x1.5550e75f39dccp-3;
+
+// For (log1p(r) - r + r^2/2) / r^3, -0x1p-4 <= r <= 0x1.09p-4.
+static const double B1 = 0x1.5555555555558p-2;
+static const double B2 = -0x1.fffffffffff67p-3;
+static const double B3 = 0x1.9999999988284p-3;
+static const double B4 = -0x1.55555555ddff0p-3;
+static const double B5 = 0x1.249249abce00fp-3;
+static const double B6 = -0x1.fffffc21e07aap-4;
+static const double B7 = 0x1.c719934ef8d0cp-4;
+static const double B8 = -0x1.999e14cd12860p-4;
+static const double B9 = 0x1.778b51edbf95ap-4;
+static const double B10 = -0x1.54d48e9ab8df0p-4;
+
+// The ith entry is for z in [asdouble(OFF + (i << 45)), asdouble(OFF + ((i + 1) << 45))),
+// with c the harmonic mean of the ends of that interval. log(c) is split into two doubles.
+static const struct {
+  double invc;
+  double logc;
+  double logctail;
+} kLogTable[N] = {
+    {0x1.734fcf9d1fb01p+0, -0x1.7cca126a0a64cp-2, -0x1.6cf150514abc8p-58},
+    {0x1.713846da93016p+0, -0x1.7701013af057ap-2, 0x1.2a51b1100471cp-58},
+    {0x1.6f26be3a75c9bp+0, -0x1.71404232ef3a7p-2, 0x1.fc1d5f96ea6e2p-56},
+    {0x1.6d1b1c10251efp+0, -0x1.6b87bd84bdf8ap-2, -0x1.044298bec9e38p-60},
+    {0x1.6b154740a6f54p+0, -0x1.65d75bc8a3654p-2, -0x1.4eb339e89f58cp-58},
+    {0x1.6915273ea6d53p+0, -0x1.602f05fa3798cp-2, 0x1.ea689c90433dcp-58},
+    {0x1.671aa40694588p+0, -0x1.5a8ea5763518ap-2, -0x1.59e9cb285c3b8p-56},
+    {0x1.6525a61ae222fp+0, -0x1.54f623f85942bp-2, -0x1.1336590febce7p-56},
+    {0x1.63361680641d2p+0, -0x1.4f656b9953804p-2, -0x1.4a698dfac6ed0p-56},
+    {0x1.614bdebacbc23p+0, -0x1.49dc66ccc2c39p-2, -0x1.80858675007ffp-56},
+    {0x1.5f66e8c9415f6p+0, -0x1.445b005f40d98p-2, -0x1.84ade2a853df8p-57},
+    {0x1.5d871f231931fp+0, -0x1.3ee123747b20cp-2, 0x1.20a06afc0c9dcp-56},
+    {0x1.5bac6cb4a358cp+0, -0x1.396ebb8558348p-2, 0x1.ff1a9c3a8fa11p-56},
+    {0x1.59d6bcdc159d7p+0, -0x1.3403b45e2a25bp-2, 0x1.fb77f0e5fe319p-56},
+    {0x1.5805fb668e213p+0, -0x1.2e9ffa1cecdb0p-2, -0x1.4761f19fb95bap-57},
+    {0x1.563a148d2e047p+0, -0x1.2943792f90369p-2, 0x1.50c988e6836f0p-57},
+    {0x1.5472f4f24b2a0p+0, -0x1.23ee1e524da1ep-2, 0x1.e929959f81dd6p-56},
+    {0x1.52b0899eb8400p+0, -0x1.1e9fd68e08a75p-2, 0x1.aaa27ef148dafp-59},
+    {0x1.50f2bfff22415p+0, -0x1.19588f36ba40ep-2, 0x1.566781e20bb0ep-56},
+    {0x1.4f3985e182aa7p+0, -0x1.141835e9e686bp-2, -0x1.f22456e6464acp-56},
+    {0x1.4d84c972a5a54p+0, -0x1.0edeb88d1c6dep-2, -0x1.f74d2798a043cp-57},
+    {0x1.4bd4793bc3764p+0, -0x1.09ac054c7f470p-2, 0x1.f9c4336eebbbfp-58},
+    {0x1.4a2884202c7e1p+0, -0x1.04800a9959b3dp-2, 0x1.b43874cb8ef0fp-56},
+    {0x1.4880d95b07271p+0, -0x1.feb56e51738cfp-3, -0x1.39a736ab876eap-60},
+    {0x1.46dd687d1f20ap+0, -0x1.f477f3e42c133p-3, -0x1.9fce27725c386p-57},
+    {0x1.453e216ac54cbp+0, -0x1.ea47845bf6506p-3, -0x1.ae0e097cc1caep-57},
+    {0x1.43a2f459bfcc1p+0, -0x1.e023fea983e9dp-3, -0x1.ce5e417f586e4p-57},
+    {0x1.420bd1cf499cep+0, -0x1.d60d423a9b2aap-3, -0x1.fda74b079bdf5p-59},
+    {0x1.4078aa9e21408p+0, -0x1.cc032ef7a319dp-3, 0x1.ca62aee10af4dp-57},
+    {0x1.3ee96fe4a5e7fp+0, -0x1.c205a5413ee6bp-3, 0x1.6fee0a9bb0379p-58},
+    {0x1.3d5e130b02a75p+0, -0x1.b81485edf8318p-3, -0x1.da71f13379d11p-57},
+    {0x1.3bd685c16737dp+0, -0x1.ae2fb247f7c49p-3, 0x1.be923feeb560bp-57},
+    {0x1.3a52b9fe4dd3bp+0, -0x1.a4570c0acc53fp-3, -0x1.46bb61fc435bfp-57},
+    {0x1.38d2a1fccdbbbp+0, -0x1.9a8a75613eda8p-3, -0x1.7554e0e06591bp-57},
+    {0x1.3756303af9faep+0, -0x1.90c9d0e334335p-3, -0x1.821529f8d8a30p-60},
+    {0x1.35dd57784c004p+0, -0x1.871501939b8b7p-3, 0x1.61c0eae53bbeap-58},
+    {0x1.34680ab419abap+0, -0x1.7d6beade69568p-3, -0x1.d814deba20791p-59},
+    {0x1.32f63d2c166b9p+0, -0x1.73ce70969e5e5p-3, 0x1.a7d6543b630acp-57},
+    {0x1.3187e25adf128p+0, -0x1.6a3c76f45aa74p-3, 0x1.648f21395c595p-59},
+    {0x1.301cedf69007cp+0, -0x1.60b5e292fbc75p-3, 0x1.3a08b3014f887p-58},
+    {0x1.2eb553ef65800p+0, -0x1.573a986f46664p-3, 0x1.5b356f6573a64p-64},
+    {0x1.2d51086e6569bp+0, -0x1.4dca7de59a924p-3, 0x1.6b4f4f9c54f7bp-58},
+    {0x1.2befffd412bf0p+0, -0x1.446578b032a51p-3, 0x1.a92b8aba7ae52p-57},
+    {0x1.2a922eb729eefp+0, -0x1.3b0b6ee56c637p-3, 0x1.9086b66fb1f7dp-58},
+    {0x1.293789e366158p+0, -0x1.31bc46f61c1c9p-3, 0x1.e1b4019c11f6ep-57},
+    {0x1.27e006584eba4p+0, -0x1.2877e7abe9798p-3, -0x1.24a4721089458p-57},
+    {0x1.268b99480dd13p+0, -0x1.1f3e3827b5beap-3, -0x1.79a151830a702p-61},
+    {0x1.253a38164dbc2p+0, -0x1.160f1fe00b3f7p-3, -0x1.1e137d10a7833p-57},
+    {0x1.23ebd8571f0b9p+0, -0x1.0cea869f95bf8p-3, -0x1.f489b9114a8f4p-58},
+    {0x1.22a06fcde5c2cp+0, -0x1.03d05483a38afp-3, -0x1.1ae131f45aa7ap-57},
+    {0x1.2157f46c4de28p+0, -0x1.f580e3f55e0a7p-4, 0x1.e344fdf5e9f25p-58},
+    {0x1.20125c5147024p+0, -0x1.e3758f85e0f41p-4, -0x1.840abac821faep-60},
+    {0x1.1ecf9dc806bf2p+0, -0x1.d17e7dd1efe5ep-4, 0x1.6b73165bcdf66p-58},
+    {0x1.1d8faf4711cc9p+0, -0x1.bf9b818c9dc34p-4, -0x1.ea282c0268213p-59},
+    {0x1.1c52876f4b723p+0, -0x1.adcc6e0042cc8p-4, 0x1.7256fffbf206fp-58},
+    {0x1.1b181d0b0b460p+0, -0x1.9c11170bde07fp-4, 0x1.9ed9179d5cb6bp-59},
+    {0x1.19e0670d38f19p+0, -0x1.8a6951208514fp-4, -0x1.a3605b25faaaep-58},
+    {0x1.18ab5c906dd57p+0, -0x1.78d4f13ee2201p-4, -0x1.185d1b5e35bccp-59},
+    {0x1.1778f4d61c5c5p+0, -0x1.6753ccf4bf830p-4, 0x1.094ef4300c518p-58},
+    {0x1.16492745bcd43p+0, -0x1.55e5ba5aa0cf5p-4, 0x1.6e4f98a408186p-58},
+    {0x1.151beb6bffa24p+0, -0x1.448a901168d60p-4, -0x1.fa4980aba4fdbp-60},
+    {0x1.13f138fa04aa6p+0, -0x1.334225400c6b9p-4, 0x1.206712703040cp-58},
+    {0x1.12c907c497c22p+0, -0x1.220c519151869p-4, -0x1.469fdf0c778a7p-59},
+    {0x1.11a34fc3720a2p+0, -0x1.10e8ed319a739p-4, -0x1.4df30cd7bfa22p-59},
+    {0x1.1080091080091p+0, -0x1.ffafa19979987p-5, -0x1.122c33cab37d9p-59},
+    {0x1.0f5f2be72c650p+0, -0x1.ddb1ab17c7cecp-5, 0x1.2aad575f17b3dp-60},
+    {0x1.0e40b0a3af193p+0, -0x1.bbd7aa26fcfb0p-5, 0x1.f757f1cb19872p-59},
+    {0x1.0d248fc261068p+0, -0x1.9a2153026e5bep-5, -0x1.54b99fda16988p-59},
+    {0x1.0c0ac1df13c01p+0, -0x1.788e5ad3ef6dcp-5, 0x1.996e83b5eb9b6p-62},
+    {0x1.0af33fb46d737p+0, -0x1.571e77afed052p-5, 0x1.3d0ce16f9ed4bp-59},
+    {0x1.09de021b48cfdp+0, -0x1.35d160919cbb6p-5, -0x1.42140c5507fd5p-60},
+    {0x1.08cb020a18cecp+0, -0x1.14a6cd57401f5p-5, 0x1.e6808404a9d37p-61},
+    {0x1.07ba389450425p+0, -0x1.e73ced7cf6518p-6, 0x1.5fdcf88ea3ed5p-61},
+    {0x1.06ab9ee9cd0e1p+0, -0x1.a5702cc17b167p-6, 0x1.3bf5339196758p-60},
+    {0x1.059f2e5646f00p+0, -0x1.63e6cd5f7cbaap-6, 0x1.3a42a2add8723p-60},
+    {0x1.0494e040c1c0ap+0, -0x1.22a045e4136d6p-6, 0x1.7321f522382ecp-60},
+    {0x1.038cae2b03115p+0, -0x1.c3381cfe7f40fp-7, 0x1.4ebd61625be5bp-62},
+    {0x1.028691b10b111p+0, -0x1.41b341fa94e14p-7, -0x1.971e05f09807ep-62},
+    {0x1.0182848890a0cp+0, -0x1.8161e3011dcb4p-8, 0x1.f0ba1bc31d3fep-63},
+    {0x1.0080808080808p+0, -0x1.00c095cdb8dbdp-9, -0x1.b5150ef8a4eebp-66},
+    {0x1.fe03f80fe03f8p-1, 0x1.fd04a336fc362p-9, -0x1.8626a4fe1e142p-63},
+    {0x1.fa13b90bf0008p-1, 0x1.7d47687032d26p-7, -0x1.ee97483dea726p-61},
+    {0x1.f632edee61d48p-1, 0x1.3cacb1d0d0da6p-6, -0x1.eea88a2b41aaap-60},
+    {0x1.f2613c76330bdp-1, 0x1.b9bf5ee9e5274p-6, 0x1.9dd44db409b1fp-61},
+    {0x1.ee9e4d1bf05e4p-1, 0x1.1aefbb816fd62p-5, 0x1.b9f52fbdc56f7p-63},
+    {0x1.eae9caf795214p-1, 0x1.588850068b584p-5, 0x1.b55eea6606878p-59},
+    {0x1.e74363a794e6dp-1, 0x1.95ab358836ad7p-5, -0x1.a30360bb434bfp-59},
+    {0x1.e3aac739001c9p-1, 0x1.d25a2a64fc911p-5, 0x1.3a6cefeaa4668p-59},
+    {0x1.e01fa810b5254p-1, 0x1.074b7191347c5p-4, -0x1.9e7e4f9ca1340p-58},
+    {0x1.dca1bad590433p-1, 0x1.2531855b53897p-4, -0x1.0f11d82862df4p-61},
+    {0x1.d930b65b8d707p-1, 0x1.42e02167ba322p-4, -0x1.d5492e2f49b00p-59},
+    {0x1.d5cc538fd0028p-1, 0x1.6058120b432cbp-4, -0x1.3971d643b5a7bp-60},
+    {0x1.d2744d6584a49p-1, 0x1.7d9a1f39bf39ep-4, -0x1.59d4fe95adee6p-58},
+    {0x1.cf2860c392dc0p-1, 0x1.9aa70ca5c3cd3p-4, 0x1.22b14d66df715p-59},
+    {0x1.cbe84c7313e4ep-1, 0x1.b77f99df5af05p-4, -0x1.588f8706c0bb7p-58},
+    {0x1.c8b3d10e85457p-1, 0x1.d4248271a06c9p-4, 0x1.5df95b1cfc10dp-59},
+    {0x1.c58ab0f1ae006p-1, 0x1.f0967dff57afdp-4, -0x1.303f23771c6b4p-58},
+    {0x1.c26cb02a2dce8p-1, 0x1.066b202f42a4ap-3, -0x1.7898b7ac5428dp-58},
+    {0x1.bf599468ae3ecp-1, 0x1.14723cd98b34dp-3, -0x1.dae5ad0cca53bp-57},
+    {0x1.bc5124f2ae0e3p-1, 0x1.2260eb44501fap-3, -0x1.9a8c0fd8684f9p-60},
+    {0x1.b9532a94df72dp-1, 0x1.30377ff5a04c6p-3, 0x1.f053db93a04dbp-58},
+    {0x1.b65f6f961276dp-1, 0x1.3df64dbfd4668p-3, 0x1.65bcebdc92a4fp-59},
+    {0x1.b375bfaaa4e14p-1, 0x1.4b9da5cd2db70p-3, -0x1.d1b54843bbf58p-57},
+    {0x1.b095e7e871801p-1, 0x1.592dd7ab12784p-3, 0x1.e9f784d4595bfp-58},
+    {0x1.adbfb6bb38fa2p-1, 0x1.66a73154eb89ep-3, -0x1.d725ef86f02e5p-57},
+    {0x1.aaf2fbd97e9ecp-1, 0x1.7409ff3ea7382p-3, -0x1.d7d21cb4e0183p-57},
+    {0x1.a82f8839d3f15p-1, 0x1.81568c5ee4a30p-3, 0x1.27f30262950e1p-59},
+    {0x1.a5752e088df44p-1, 0x1.8e8d2238cb283p-3, -0x1.b9d8a4ae9e1cap-57},
+    {0x1.a2c3c09ddf78ep-1, 0x1.9bae08e591094p-3, -0x1.a3d5a9a9ceedep-60},
+    {0x1.a01b147453f6dp-1, 0x1.a8b9871db463fp-3, 0x1.094c58748ab41p-61},
+    {0x1.9d7aff1fa6a6dp-1, 0x1.b5afe241e9726p-3, 0x1.7cfbf7bb5c81fp-57},
+    {0x1.9ae35743f1d4ep-1, 0x1.c2915e63c0e35p-3, 0x1.d8ee589e5d0acp-58},
+    {0x1.9853f48d32906p-1, 0x1.cf5e3e4e08fd7p-3, -0x1.5e930e73696fap-60},
+    {0x1.95ccafa71d129p-1, 0x1.dc16c38cec1fcp-3, 0x1.cd4e346cd25c4p-59},
+    {0x1.934d62353e605p-1, 0x1.e8bb2e75cf1bap-3, 0x1.780fb0b0b1390p-57},
+    {0x1.90d5e6cb67d91p-1, 0x1.f54bbe2ef1c2bp-3, 0x1.69f5b832e971bp-57},
+    {0x1.8e6618e6618e6p-1, 0x1.00e4585b69f3ap-2, 0x1.56fcdb0343871p-56},
+    {0x1.8bfdd4e4e063ep-1, 0x1.07192175b0818p-2, -0x1.ac5fe87aff8f0p-59},
+    {0x1.899cf800bd1fap-1, 0x1.0d4458487246cp-2, 0x1.4e95a0ae15a3fp-56},
+    {0x1.8743604869b31p-1, 0x1.13661a2c64833p-2, -0x1.3da7babf196fdp-56},
+    {0x1.84f0ec98a227bp-1, 0x1.197e83f411c99p-2, -0x1.597ba78d1dfcdp-61},
+    {0x1.82a57c9656b7bp-1, 0x1.1f8db1ef0706dp-2, 0x1.399f08049d835p-58},
+    {0x1.8060f0a8ccbacp-1, 0x1.2593bfece89d0p-2, -0x1.396635ab5950bp-56},
+    {0x1.7e2329f3f429ap-1, 0x1.2b90c940706b0p-2, -0x1.3e12bd3b16b62p-61},
+    {0x1.7bec0a52ef95cp-1, 0x1.3184e8c255900p-2, -0x1.3e0cdce4530dap-56},
+    {0x1.79bb7452cc8c6p-1, 0x1.377038d41eae3p-2, -0x1.da312348e074cp-58},
+    {0x1.77914b2d6a73dp-1, 0x1.3d52d362df6bdp-2, -0x1.ef231ad1f7c43p-57},
+    {0x1.756d72c48e07bp-1, 0x1.432cd1e9e1e94p-2, -0x1.695110e44b18fp-56},
+};
+
+double log(double x) {
+  uint64_t ix = asuint64(x);
+  uint32_t top = ix >> 48;
+
+  // 1 - 0x1p-4 <= x < 1 + 0x1.09p-4.
+  if (__predict_false(ix - 0x3fee000000000000ull < 0x3ff1090000000000ull - 0x3fee000000000000ull)) {
+    if (__predict_false(ix == asuint64(1.0))) return 0.0;
+    double r = x - 1.0;
+    double r2 = r * r;
+    double r3 = r * r2;
+    double y = r3 * (B1 + r * B2 + r2 * B3 +
+                     r3 * (B4 + r * B5 + r2 * B6 + r3 * (B7 + r * B8 + r2 * B9 + r3 * B10)));
+    // r - r^2/2 needs more than double precision: split r so that rhi^2 is exact.
+    double w = r * 0x1p27;
+    double rhi = r + w - w;
+    double rlo = r - rhi;
+    w = rhi * rhi * -0.5;
+    double hi = r + w;
+    double lo = r - hi + w;
+    lo += -0.5 * rlo * (rhi + r);
+    y += lo;
+    y += hi;
+    return y;
+  }
+
+  if (__predict_false(top - 0x0010 >= 0x7ff0 - 0x0010)) {
+    // x is subnormal, zero, negative, infinite or NaN.
+    if (ix * 2 == 0) return __math_divzero(1);
+    if (ix == asuint64(INFINITY)) return x;
+    if ((top & 0x8000) || (top & 0x7ff0) == 0x7ff0) return (x - x) / (x - x);
+    // Normalize subnormals.
+    ix = asuint64(x * 0x1p52);
+    ix -= 52ull << 52;
+  }
+
+  // x = 2^k * z, with z in [OFF, 2*OFF) and exact.
+  uint64_t tmp = ix - OFF;
+  int i = (tmp >> (52 - LOG_TABLE_BITS)) % N;
+  int k = (int64_t) tmp >> 52;
+  uint64_t iz = ix - (tmp & (0xfffull << 52));
+  double invc = kLogTable[i].invc;
+  double logc = kLogTable[i].logc;
+  double logctail = kLogTable[i].logctail;
+  double z = asdouble(iz);
+
+  // The fused multiply-add makes r = z/c - 1 exact but for one rounding.
+  double r = __builtin_fma(z, invc, -1.0);
+  double kd = k;
+
+  // hi + lo = r + log(c) + k*ln2. Either k is 0 or |k*ln2| > |log(c)|, and either way
+  // |log(c) + k*ln2| > |r|, so each of these sums' rounding errors can be recovered exactly.
+  double w = kd * kLn2hi + logc;
+  double wlo = kd * kLn2hi - w + logc;
+  double hi = w + r;
+  double lo = w - hi + r + (wlo + kd * kLn2lo + logctail);
+
+  double r2 = r * r;
+  return lo + r2 * A0 + r * r2 * (A1 + r * A2 + r2 * (A3 + r * A4)) + hi;
+}
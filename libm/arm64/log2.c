@@ -0,0 +1,191 @@
+/*-
+ * Copyright (C) 2017 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <math.h>
+
+#include "math_config.h"
+
+// log2(x) = k + log2(c) + log2(1 + r), where x = 2^k * z, c is near z and r = z/c - 1, as in
+// log.c. |r| < 1/128 here, and near 1 a longer polynomial in x - 1 is used instead. r/ln2 is
+// worked out to more than double precision. Within 0.55 ULP.
+
+#define LOG2_TABLE_BITS 6
+#define N (1 << LOG2_TABLE_BITS)
+#define OFF 0x3fe6000000000000ull
+
+// 1/ln2, split into two doubles.
+static const double kInvLn2hi = 0x1.71547652b82fep+0;
+static const double kInvLn2lo = 0x1.777d0ffda0d24p-56;
+
+// For (log2(1 + r) - r/ln2) / r^2, |r| < 1/128.
+static const double A0 = -0x1.71547652b8309p-1;
+static const double A1 = 0x1.ec709dc3a00f8p-2;
+static const double A2 = -0x1.7154764c6e88ep-2;
+static const double A3 = 0x1.2776c54c7ed4fp-2;
+static const double A4 = -0x1.ec79225b55f62p-3;
+static const double A5 = 0x1.a5fcdf93994bep-3;
+
+// For (log2(1 + r) - r/ln2) / r^2, -0x1.5b51p-5 <= r <= 0x1.6ab2p-5.
+static const double B0 = -0x1.71547652b82fep-1;
+static const double B1 = 0x1.ec709dc3a03f9p-2;
+static const double B2 = -0x1.71547652b78fap-2;
+static const double B3 = 0x1.2776c50f03547p-2;
+static const double B4 = -0x1.ec709dd88d8aep-3;
+static const double B5 = 0x1.a61762093c3c1p-3;
+static const double B6 = -0x1.7153fbb255a3ep-3;
+static const double B7 = 0x1.484cd74f9a1cap-3;
+static const double B8 = -0x1.289c789770b50p-3;
+static const double B9 = 0x1.0b5cb75c1cf00p-3;
+
+// The ith entry is for z in [asdouble(OFF + (i << 46)), asdouble(OFF + ((i + 1) << 46))),
+// with c the harmonic mean of the ends of that interval. log2(c) is split into two doubles.
+static const struct {
+  double invc;
+  double logc;
+  double logctail;
+} kLog2Table[N] = {
+    {0x1.72458e8344c5bp+0, -0x1.109c0a913fbb6p-1, 0x1.75945987ef6dcp-55},
+    {0x1.6e226396676c3p+0, -0x1.084f3343b433fp-1, 0x1.0179fb62ec14cp-56},
+    {0x1.6a16a16a16a17p+0, -0x1.0019f8d44e2e8p-1, 0x1.f318d1fae19c8p-55},
+    {0x1.6621837c644bdp+0, -0x1.eff7acc23382ep-2, -0x1.2e6af97768da1p-57},
+    {0x1.62424dcb19bb5p+0, -0x1.dfe896bb75202p-2, 0x1.2f1700c78da6fp-56},
+    {0x1.5e784c5f5932ep+0, -0x1.d005b6c75c430p-2, -0x1.c699639f5a517p-57},
+    {0x1.5ac2d2e0a34a2p+0, -0x1.c04e1c0a312a0p-2, -0x1.1238785ecd6a9p-58},
+    {0x1.57213c2eb5721p+0, -0x1.b0c0dd43e52bdp-2, -0x1.f9d28d0e930ddp-59},
+    {0x1.5392ea01c26b5p+0, -0x1.a15d187ee4f5cp-2, 0x1.24d62d35edd84p-56},
+    {0x1.501744908fea7p+0, -0x1.9221f2c31a6a8p-2, -0x1.c78988b5c10bdp-59},
+    {0x1.4cadba3c0e24ap+0, -0x1.830e97ccdc80cp-2, -0x1.f2a2cc10da1cap-56},
+    {0x1.4955bf40069ebp+0, -0x1.742239c79020ap-2, 0x1.fd9ed966bdf18p-58},
+    {0x1.460ecd688773bp+0, -0x1.655c110bc1481p-2, -0x1.29032215394c6p-56},
+    {0x1.42d863cbb7708p+0, -0x1.56bb5be07fac4p-2, -0x1.93504966ce168p-56},
+    {0x1.3fb20687c5e8bp+0, -0x1.483f5e3fcdaa3p-2, -0x1.f3ea27f4279acp-59},
+    {0x1.3c9b3e84af20bp+0, -0x1.39e7619df3b9bp-2, -0x1.56f9de6c8aa38p-59},
+    {0x1.3993993993994p+0, -0x1.2bb2b4b38d9ebp-2, 0x1.6453c07675566p-56},
+    {0x1.369aa8756586ap+0, -0x1.1da0ab4a297bbp-2, 0x1.420ec57efa40fp-57},
+    {0x1.33b0022ab44c0p+0, -0x1.0fb09e0b5383ep-2, 0x1.04bc266bf2c0dp-57},
+    {0x1.30d3403e62014p+0, -0x1.01e1ea51eb77fp-2, 0x1.b7c7f4fbdc46ap-56},
+    {0x1.2e04005912e04p+0, -0x1.e867e3fb46ca0p-3, 0x1.93b091770219ep-58},
+    {0x1.2b41e3bb29f9fp+0, -0x1.cd4c369112596p-3, -0x1.0af5c8d55e7dfp-61},
+    {0x1.288c8f1329ceap+0, -0x1.b26fa13cfc9b2p-3, -0x1.bcf7f4618bfcfp-58},
+    {0x1.25e3aa56525e4p+0, -0x1.97d100ed0669dp-3, -0x1.f91c11bfc75b7p-57},
+    {0x1.2346e09b59005p+0, -0x1.7d6f3a5b7a169p-3, 0x1.19b9b407406d5p-59},
+    {0x1.20b5dff718d74p+0, -0x1.634939c83cf54p-3, 0x1.8f037e4f8a0f7p-60},
+    {0x1.1e30595b1d047p+0, -0x1.495df2b53abd2p-3, 0x1.705220b361e84p-61},
+    {0x1.1bb60075e7e5ap+0, -0x1.2fac5fa5c151cp-3, -0x1.15468e951ff6bp-61},
+    {0x1.19468b94dc9d4p+0, -0x1.163381e0a6072p-3, -0x1.e09f1db9325f0p-57},
+    {0x1.16e1b387b1f8fp+0, -0x1.f9e4c26a1f87ep-4, -0x1.347abb7254bc6p-58},
+    {0x1.148733855778fp+0, -0x1.c7d01783872ddp-4, -0x1.36814e36a75acp-58},
+    {0x1.1236c91236c91p+0, -0x1.96272b7da6acep-4, 0x1.9015d1daa5750p-59},
+    {0x1.0ff033e7bd6d0p+0, -0x1.64e832931f974p-4, 0x1.984c1636d3beap-58},
+    {0x1.0db335dd1bb65p+0, -0x1.34116c65434c4p-4, -0x1.a3865d3381ec8p-58},
+    {0x1.0b7f92d127571p+0, -0x1.03a1239c5c407p-4, 0x1.7fc0ea8684709p-58},
+    {0x1.0955109551095p+0, -0x1.a72b5b17b71abp-5, 0x1.571143ba2bc03p-59},
+    {0x1.073376d99dd40p+0, -0x1.47dad3b47537ep-5, 0x1.886f3bc3046d3p-59},
+    {0x1.051a8f1995706p+0, -0x1.d29b08b18d147p-6, 0x1.cd415141f4485p-61},
+    {0x1.030a248a1840cp+0, -0x1.1700a751ce496p-6, -0x1.88abeab395b71p-60},
+    {0x1.0102040810204p+0, -0x1.7381d83b462e4p-8, -0x1.e644ac6274683p-62},
+    {0x1.fc0fc0fc0fc10p-1, 0x1.6d0dc54969bebp-7, -0x1.48a970bb6deccp-61},
+    {0x1.f44dd07ff0b94p-1, 0x1.111cce35d3280p-5, 0x1.6d364c023dfacp-59},
+    {0x1.ecc79ce366b37p-1, 0x1.c4349fbc99169p-5, -0x1.39d9a8dd4d772p-59},
+    {0x1.e57a7e5076ac3p-1, 0x1.3a4ffbd43c0eap-4, -0x1.95f6d95ac8053p-62},
+    {0x1.de63f4a6bcffdp-1, 0x1.91397cd308b70p-4, 0x1.e8d251eada884p-60},
+    {0x1.d781a49fdaafcp-1, 0x1.e6e0748e2f9d0p-4, 0x1.b41f2076cb06dp-58},
+    {0x1.d0d155322b794p-1, 0x1.1da70d7fdfc83p-3, -0x1.b3af6208899ebp-57},
+    {0x1.ca50ed2bab114p-1, 0x1.4745a22f08d52p-3, 0x1.6198786fb198ep-58},
+    {0x1.c3fe70ff9c3fep-1, 0x1.70503353bd7bep-3, 0x1.596bfd2e292e1p-57},
+    {0x1.bdd800c21bdd8p-1, 0x1.98cacf6657f68p-3, -0x1.0412b8b704c47p-59},
+    {0x1.b7dbd64d4eb0fp-1, 0x1.c0b95ac0df816p-3, -0x1.20e36494930b0p-57},
+    {0x1.b208438c4e53bp-1, 0x1.e81f91de65730p-3, 0x1.34c71485a62c6p-57},
+    {0x1.ac5bb0e860973p-1, 0x1.078085ba40f71p-2, 0x1.377af60bf6202p-56},
+    {0x1.a6d49bd5603ecp-1, 0x1.1ab09d34f223fp-2, -0x1.bd17636b1b879p-56},
+    {0x1.a171957a8ebfap-1, 0x1.2da1b7d653a76p-2, -0x1.83bd578351175p-57},
+    {0x1.9c3141754e6b9p-1, 0x1.40556df56e530p-2, -0x1.594edc193448ep-56},
+    {0x1.971254b3841bdp-1, 0x1.52cd4897c5b5fp-2, 0x1.dce94357aaecdp-58},
+    {0x1.921394639816dp-1, 0x1.650ac233167bfp-2, 0x1.648814adb0b85p-56},
+    {0x1.8d33d4f840652p-1, 0x1.770f476342df6p-2, -0x1.e991616669ce1p-56},
+    {0x1.8871f93e6bce1p-1, 0x1.88dc379548137p-2, 0x1.3044cb446acc2p-56},
+    {0x1.83ccf183ccf18p-1, 0x1.9a72e5a80542bp-2, 0x1.4687b0c0a7800p-60},
+    {0x1.7f43bacca8f06p-1, 0x1.abd498838c3a9p-2, -0x1.0efa93c056436p-56},
+    {0x1.7ad55e17ad55ep-1, 0x1.bd028ba7a4dc7p-2, -0x1.62ddd8542c40ep-57},
+    {0x1.7680efaeade07p-1, 0x1.cdfdefb21ece9p-2, -0x1.e7fd6bfbf8f62p-56},
+};
+
+double log2(double x) {
+  uint64_t ix = asuint64(x);
+  uint32_t top = ix >> 48;
+
+  // 1 - 0x1.5b51p-5 <= x < 1 + 0x1.6ab2p-5.
+  if (__predict_false(ix - 0x3feea4af00000000ull < 0x3ff0b55900000000ull - 0x3feea4af00000000ull)) {
+    if (__predict_false(ix == asuint64(1.0))) return 0.0;
+    double r = x - 1.0;
+    double hi = r * kInvLn2hi;
+    double lo = r * kInvLn2lo + __builtin_fma(r, kInvLn2hi, -hi);
+    double r2 = r * r;
+    double r4 = r2 * r2;
+    double p = r2 * (B0 + r * B1);
+    double y = hi + p;
+    lo += hi - y + p;
+    lo += r4 * (B2 + r * B3 + r2 * (B4 + r * B5) + r4 * (B6 + r * B7 + r2 * (B8 + r * B9)));
+    return y + lo;
+  }
+
+  if (__predict_false(top - 0x0010 >= 0x7ff0 - 0x0010)) {
+    // x is subnormal, zero, negative, infinite or NaN.
+    if (ix * 2 == 0) return __math_divzero(1);
+    if (ix == asuint64(INFINITY)) return x;
+    if ((top & 0x8000) || (top & 0x7ff0) == 0x7ff0) return (x - x) / (x - x);
+    // Normalize subnormals.
+    ix = asuint64(x * 0x1p52);
+    ix -= 52ull << 52;
+  }
+
+  // x = 2^k * z, with z in [OFF, 2*OFF) and exact.
+  uint64_t tmp = ix - OFF;
+  int i = (tmp >> (52 - LOG2_TABLE_BITS)) % N;
+  int k = (int64_t) tmp >> 52;
+  uint64_t iz = ix - (tmp & (0xfffull << 52));
+  double invc = kLog2Table[i].invc;
+  double logc = kLog2Table[i].logc;
+  double logctail = kLog2Table[i].logctail;
+  double z = asdouble(iz);
+  double kd = k;
+
+  // r = z/c - 1 but for one rounding, and t1 + t2 = r/ln2.
+  double r = __builtin_fma(z, invc, -1.0);
+  double t1 = r * kInvLn2hi;
+  double t2 = r * kInvLn2lo + __builtin_fma(r, kInvLn2hi, -t1);
+
+  // hi + lo = r/ln2 + log2(c) + k, recovering each sum's rounding error as log.c does.
+  double t3 = kd + logc;
+  double t3lo = kd - t3 + logc;
+  double hi = t3 + t1;
+  double lo = t3 - hi + t1 + t2 + t3lo + logctail;
+
+  double r2 = r * r;
+  double r4 = r2 * r2;
+  double p = A0 + r * A1 + r2 * (A2 + r * A3) + r4 * (A4 + r * A5);
+  return lo + r2 * p + hi;
+}
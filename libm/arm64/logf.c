@@ -0,0 +1,127 @@
+/*-
+ * Copyright (C) 2017 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <math.h>
+
+#include "math_config.h"
+
+// logf and log2f work in double precision: x = 2^k * z, and log(x) = k*ln2 + log(c) +
+// log1p(z/c - 1) with c near z from the table below, so |r| = |z/c - 1| < 0.031. The interval
+// containing 1 has c = 1, so that log1p(r) needs no correction near 1, and there's no
+// cancellation between log(c) and it. Both are within 0.51 ULP.
+
+#define N (1 << LOGF_TABLE_BITS)
+#define OFF 0x3f330000
+
+// The ith entry is for z in [asfloat(OFF + (i << 19)), asfloat(OFF + ((i + 1) << 19))), with
+// c the harmonic mean of the ends of that interval, except that c = 1 for the one containing 1.
+const struct logf_entry __logf_data[N] = {
+    {0x1.664a99209a6d7p+0, -0x1.583cbb6bc303ep-2, -0x1.f0a11d2f0cf85p-2},
+    {0x1.57455e6e8b2fep+0, -0x1.2c62072a650e6p-2, -0x1.b15c6754b4656p-2},
+    {0x1.4975b1d6b37cep+0, -0x1.0254d4df07983p-2, -0x1.74b18211e6492p-2},
+    {0x1.3cb7a0cd99367p+0, -0x1.b3e1544b1b98ep-3, -0x1.3a6bccf35007cp-2},
+    {0x1.30ec9506f9944p+0, -0x1.662a6d246141ep-3, -0x1.025ca96444db9p-2},
+    {0x1.25fa5dcb4760cp+0, -0x1.1b4b6e8fa3a2fp-3, -0x1.98b5320da0f26p-3},
+    {0x1.1bca6cad51a29p+0, -0x1.a621d8fefe6b8p-4, -0x1.308107ff607c6p-3},
+    {0x1.1249398e8dd07p+0, -0x1.1a997e4cec4dfp-4, -0x1.97b47c08628efp-4},
+    {0x1.0965c50333d4dp+0, -0x1.275543439ff23p-5, -0x1.aa13566f4689dp-5},
+    {0x1.0000000000000p+0, 0x0p+0, 0x0p+0},
+    {0x1.e5e0df9813752p-1, 0x1.acfbe90dd9755p-5, 0x1.357251ee14dfep-4},
+    {0x1.caa70ef261995p-1, 0x1.c2b085a092040p-4, 0x1.451a916ba4c6ep-3},
+    {0x1.b2516983210b2p-1, 0x1.50fe556ae7c7ap-3, 0x1.e62dc8553e774p-3},
+    {0x1.9c6fe78507e4bp-1, 0x1.badc7bccf9570p-3, 0x1.3f74f5bde67cdp-2},
+    {0x1.88a80a36930b5p-1, 0x1.0fc25001e6868p-2, 0x1.8810beb05e8c9p-2},
+    {0x1.76afeb4225b84p-1, 0x1.3fba0a49d392bp-2, 0x1.cd44a5a6da8ebp-2},
+};
+
+static const double kLn2 = 0x1.62e42fefa39efp-1;
+static const double kInvLn2 = 0x1.71547652b82fep+0;
+
+// For (log1p(r) - r) / r^2.
+static const double A0 = -0x1.fffffeedc2cf9p-2;
+static const double A1 = 0x1.555565a17b23cp-2;
+static const double A2 = -0x1.00262fb88d6f3p-2;
+static const double A3 = 0x1.98a8a90c56060p-3;
+
+// For (log2(1 + r) - r/ln2) / r^2.
+static const double B0 = -0x1.7154758ce5d91p-1;
+static const double B1 = 0x1.ec70b546c3432p-2;
+static const double B2 = -0x1.718b8db50af16p-2;
+static const double B3 = 0x1.26c8f7f205013p-2;
+
+float logf(float x) {
+  uint32_t ix = asuint(x);
+  if (__predict_false(ix - 0x00800000 >= 0x7f800000 - 0x00800000)) {
+    // x is subnormal, zero, negative, infinite or NaN.
+    if (ix * 2 == 0) return __math_divzerof(1);
+    if (ix == 0x7f800000) return x;
+    if ((ix & 0x80000000) || ix * 2 >= 0xff000000) return (x - x) / (x - x);
+    // Normalize subnormals.
+    ix = asuint(x * 0x1p23f);
+    ix -= 23 << 23;
+  }
+
+  uint32_t tmp = ix - OFF;
+  int i = (tmp >> (23 - LOGF_TABLE_BITS)) % N;
+  int k = (int32_t) tmp >> 23;
+  uint32_t iz = ix - (tmp & 0xff800000);
+  double invc = __logf_data[i].invc;
+  double logc = __logf_data[i].logc;
+  double z = asfloat(iz);
+
+  double r = z * invc - 1.0;
+  double y0 = logc + k * kLn2;
+  double r2 = r * r;
+  double y = y0 + r + r2 * (A0 + r * A1 + r2 * (A2 + r * A3));
+  return y;
+}
+
+float log2f(float x) {
+  uint32_t ix = asuint(x);
+  if (__predict_false(ix - 0x00800000 >= 0x7f800000 - 0x00800000)) {
+    // x is subnormal, zero, negative, infinite or NaN.
+    if (ix * 2 == 0) return __math_divzerof(1);
+    if (ix == 0x7f800000) return x;
+    if ((ix & 0x80000000) || ix * 2 >= 0xff000000) return (x - x) / (x - x);
+    // Normalize subnormals.
+    ix = asuint(x * 0x1p23f);
+    ix -= 23 << 23;
+  }
+
+  uint32_t tmp = ix - OFF;
+  int i = (tmp >> (23 - LOGF_TABLE_BITS)) % N;
+  int k = (int32_t) tmp >> 23;
+  uint32_t iz = ix - (tmp & 0xff800000);
+  double invc = __logf_data[i].invc;
+  double logc = __logf_data[i].log2c;
+  double z = asfloat(iz);
+
+  double r = z * invc - 1.0;
+  double y0 = logc + k;
+  double r2 = r * r;
+  double y = y0 + r * kInvLn2 + r2 * (B0 + r * B1 + r2 * (B2 + r * B3));
+  return y;
+}
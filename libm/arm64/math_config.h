@@ -0,0 +1,100 @@
+/*-
+ * Copyright (C) 2017 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef _BIONIC_LIBM_ARM64_MATH_CONFIG_H
+#define _BIONIC_LIBM_ARM64_MATH_CONFIG_H
+
+#include <stdint.h>
+#include <sys/cdefs.h>
+
+// Shared by the arm64 exp, exp2, log, log2, expf, exp2f, logf, log2f, powf, sinf, cosf and
+// sincosf. These are table-driven: a small table lookup takes care of most of the range
+// reduction, so only a short polynomial is left to evaluate, and that (with the fused
+// multiply-adds the compiler emits for it) is cheap on arm64. hypot and cbrt use just the bit
+// casts.
+
+static inline uint32_t asuint(float f) {
+  union { float f; uint32_t i; } u = { f };
+  return u.i;
+}
+
+static inline float asfloat(uint32_t i) {
+  union { uint32_t i; float f; } u = { i };
+  return u.f;
+}
+
+static inline uint64_t asuint64(double f) {
+  union { double f; uint64_t i; } u = { f };
+  return u.i;
+}
+
+static inline double asdouble(uint64_t i) {
+  union { uint64_t i; double f; } u = { i };
+  return u.f;
+}
+
+// These return the result of an overflow, underflow or division by zero with the given sign,
+// raising the corresponding exception. The volatile stops the compiler folding the operation.
+static inline double __math_xflow(uint32_t sign, double y) {
+  volatile double v = sign ? -y : y;
+  return v * y;
+}
+
+static inline double __math_oflow(uint32_t sign) { return __math_xflow(sign, 0x1p769); }
+static inline double __math_uflow(uint32_t sign) { return __math_xflow(sign, 0x1p-767); }
+
+static inline double __math_divzero(uint32_t sign) {
+  volatile double zero = 0.0;
+  return (sign ? -1.0 : 1.0) / zero;
+}
+
+static inline float __math_xflowf(uint32_t sign, float y) {
+  volatile float v = sign ? -y : y;
+  return v * y;
+}
+
+static inline float __math_oflowf(uint32_t sign) { return __math_xflowf(sign, 0x1p97f); }
+static inline float __math_uflowf(uint32_t sign) { return __math_xflowf(sign, 0x1p-95f); }
+
+static inline float __math_divzerof(uint32_t sign) {
+  volatile float zero = 0.0f;
+  return (sign ? -1.0f : 1.0f) / zero;
+}
+
+// 2^(i/32) for expf, exp2f and powf, in exp2f.c.
+#define EXP2F_TABLE_BITS 5
+__LIBC_HIDDEN__ extern const uint64_t __exp2f_data[1 << EXP2F_TABLE_BITS];
+
+// 1/c, log(c) and log2(c) for logf, log2f and powf, in logf.c.
+#define LOGF_TABLE_BITS 4
+struct logf_entry {
+  double invc;
+  double logc;
+  double log2c;
+};
+__LIBC_HIDDEN__ extern const struct logf_entry __logf_data[1 << LOGF_TABLE_BITS];
+
+#endif
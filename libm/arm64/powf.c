@@ -0,0 +1,135 @@
+/*-
+ * Copyright (C) 2017 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <math.h>
+
+#include "math_config.h"
+
+// powf(x, y) = 2^(y * log2(x)). log2(x) is worked out in double precision as log2f does, but
+// with a longer polynomial: |y * log2(x)| can be up to 150, and its error mustn't be more
+// than about 2^-30 of that. Then 2^(y*log2(x)) is worked out as exp2f does. Within 0.52 ULP.
+
+#define N (1 << EXP2F_TABLE_BITS)
+#define OFF 0x3f330000
+
+static const double kInvLn2 = 0x1.71547652b82fep+0;
+static const double kExp2Shift = 0x1.8p52 / N;
+
+// For (log2(1 + r) - r/ln2) / r^2.
+static const double A0 = -0x1.71547652588e8p-1;
+static const double A1 = 0x1.ec709a76b2092p-2;
+static const double A2 = -0x1.71549b4d8c67ep-2;
+static const double A3 = 0x1.27b1b25d2907dp-2;
+static const double A4 = -0x1.eafe6bb85207ap-3;
+
+// For 2^r.
+static const double C0 = 0x1.c6b08d704a0c0p-5;
+static const double C1 = 0x1.ebfbdff82c58fp-3;
+static const double C2 = 0x1.62e42fefa39efp-1;
+
+// Returns 0 if iy isn't an integer, 1 if it's odd, and 2 if it's even.
+static inline int checkint(uint32_t iy) {
+  int e = iy >> 23 & 0xff;
+  if (e < 0x7f) return 0;
+  if (e > 0x7f + 23) return 2;
+  if (iy & ((1 << (0x7f + 23 - e)) - 1)) return 0;
+  if (iy & (1 << (0x7f + 23 - e))) return 1;
+  return 2;
+}
+
+// Returns whether ix is zero, infinite or NaN.
+static inline int zeroinfnan(uint32_t ix) {
+  return 2 * ix - 1 >= 2u * 0x7f800000 - 1;
+}
+
+// Returns log2 of the finite, positive, normal float with bits ix.
+static inline double log2_inline(uint32_t ix) {
+  uint32_t tmp = ix - OFF;
+  int i = (tmp >> (23 - LOGF_TABLE_BITS)) % (1 << LOGF_TABLE_BITS);
+  int k = (int32_t) tmp >> 23;
+  uint32_t iz = ix - (tmp & 0xff800000);
+  double invc = __logf_data[i].invc;
+  double logc = __logf_data[i].log2c;
+  double z = asfloat(iz);
+
+  double r = z * invc - 1.0;
+  double y0 = logc + k;
+  double r2 = r * r;
+  return y0 + r * kInvLn2 + r2 * (A0 + r * A1 + r2 * (A2 + r * A3 + r2 * A4));
+}
+
+float powf(float x, float y) {
+  uint32_t sign = 0;
+  uint32_t ix = asuint(x);
+  uint32_t iy = asuint(y);
+  if (__predict_false(ix - 0x00800000 >= 0x7f800000 - 0x00800000 || zeroinfnan(iy))) {
+    // x is subnormal, zero, negative, infinite or NaN, or y is zero, infinite or NaN.
+    if (__predict_false(zeroinfnan(iy))) {
+      if (2 * iy == 0) return 1.0f;
+      if (ix == 0x3f800000) return 1.0f;
+      if (2 * ix > 2u * 0x7f800000 || 2 * iy > 2u * 0x7f800000) return x + y;
+      if (2 * ix == 2 * 0x3f800000) return 1.0f;
+      // |x| < 1 and y is +inf, or |x| > 1 and y is -inf.
+      if ((2 * ix < 2 * 0x3f800000) == !(iy & 0x80000000)) return 0.0f;
+      return y * y;
+    }
+    if (__predict_false(zeroinfnan(ix))) {
+      float x2 = x * x;
+      if ((ix & 0x80000000) && checkint(iy) == 1) x2 = -x2;
+      // Dividing raises the divide-by-zero exception for a zero x.
+      return (iy & 0x80000000) ? 1 / x2 : x2;
+    }
+    // x and y are non-zero and finite.
+    if (ix & 0x80000000) {
+      int yint = checkint(iy);
+      if (yint == 0) return (x - x) / (x - x);
+      if (yint == 1) sign = 1;
+      ix &= 0x7fffffff;
+    }
+    if (ix < 0x00800000) {
+      // Normalize subnormals.
+      ix = asuint(asfloat(ix) * 0x1p23f);
+      ix -= 23 << 23;
+    }
+  }
+
+  double ylogx = y * log2_inline(ix);
+  if (__predict_false(ylogx >= 128.0)) return __math_oflowf(sign);
+  if (__predict_false(ylogx <= -150.0)) return __math_uflowf(sign);
+
+  // 2^ylogx, as in exp2f.
+  double kd = ylogx + kExp2Shift;
+  uint64_t ki = asuint64(kd);
+  kd -= kExp2Shift;
+  double r = ylogx - kd;
+  double s = asdouble(__exp2f_data[ki % N] + (ki << (52 - EXP2F_TABLE_BITS)));
+  double z = C0 * r + C1;
+  double r2 = r * r;
+  double result = C2 * r + 1;
+  result = z * r2 + result;
+  result *= s;
+  return sign ? -result : result;
+}
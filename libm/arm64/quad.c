@@ -0,0 +1,410 @@
+/*-
+ * Copyright (C) 2017 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+
+#include <fenv.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "math_config.h"
+
+// long double is IEEE binary128 on arm64, and the compiler turns long double arithmetic into calls
+// to __addtf3 and friends. These are libm's own copies of the ones the ld128 functions use most,
+// so they no longer go through the generic soft-fp routines in the compiler runtime. They work on
+// the 113-bit significands as unsigned __int128 (division takes 29 quotient bits at a time from an
+// integer reciprocal estimate), and honor the FPCR rounding mode and raise the FPSR exceptions just
+// as the hardware double-precision instructions do (including tininess detected before rounding).
+// They're hidden: everything else still gets the compiler runtime's copies.
+
+typedef unsigned __int128 u128;
+
+#define SIG_BITS 112
+#define BIAS 16383
+#define EXP_MAX 0x7fff
+#define IMPLICIT_BIT ((u128)1 << SIG_BITS)
+#define SIG_MASK (IMPLICIT_BIT - 1)
+#define QUIET_BIT ((u128)1 << (SIG_BITS - 1))
+#define SIGN_BIT ((u128)1 << 127)
+#define INF_BITS ((u128)EXP_MAX << SIG_BITS)
+
+static inline u128 tf_bits(long double x) {
+  union { long double f; u128 i; } u = { x };
+  return u.i;
+}
+
+static inline long double tf_from_bits(u128 i) {
+  union { u128 i; long double f; } u = { i };
+  return u.f;
+}
+
+static inline int clz128(u128 x) {
+  uint64_t hi = x >> 64;
+  return hi ? __builtin_clzll(hi) : 64 + __builtin_clzll((uint64_t) x);
+}
+
+static inline int fpcr_rounding_mode(void) {
+  uint64_t fpcr;
+  __asm__ __volatile__("mrs %0, fpcr" : "=r"(fpcr));
+  return (fpcr >> 22) & 3;
+}
+
+// The FE_ constants are the FPSR bits. Inexact is usually already set, so skip the write then.
+static inline void fpsr_raise(unsigned excepts) {
+  uint64_t fpsr;
+  __asm__ __volatile__("mrs %0, fpsr" : "=r"(fpsr));
+  if ((fpsr & excepts) != excepts) __asm__ __volatile__("msr fpsr, %0" : : "r"(fpsr | excepts));
+}
+
+static long double tf_invalid(void) {
+  fpsr_raise(FE_INVALID);
+  return tf_from_bits(INF_BITS | QUIET_BIT);
+}
+
+// Returns a quiet NaN for an operation with a NaN operand, choosing the operand the way the
+// hardware does: the first signaling NaN, otherwise the first quiet NaN.
+static long double tf_nan(u128 a, u128 b) {
+  bool a_nan = (a & ~SIGN_BIT) > INF_BITS;
+  bool b_nan = (b & ~SIGN_BIT) > INF_BITS;
+  bool a_snan = a_nan && !(a & QUIET_BIT);
+  bool b_snan = b_nan && !(b & QUIET_BIT);
+  if (a_snan || b_snan) fpsr_raise(FE_INVALID);
+  return tf_from_bits(((a_snan || (a_nan && !b_snan)) ? a : b) | QUIET_BIT);
+}
+
+static long double tf_overflow(u128 sign, int mode) {
+  fpsr_raise(FE_OVERFLOW | FE_INEXACT);
+  bool to_inf = mode == FE_TONEAREST || mode == (sign ? FE_DOWNWARD : FE_UPWARD);
+  return tf_from_bits(sign | (to_inf ? INF_BITS : INF_BITS - 1));
+}
+
+// Rounds and packs a finite result. sig has its leading bit at bit 115, followed (below the 113
+// bits that are kept) by a guard, a round and a sticky bit. A smaller sig is subnormal, which is
+// only allowed with e == 1; e < 1 means the result is tiny and still has to be shifted down.
+static long double tf_round_pack(u128 sign, int e, u128 sig) {
+  if (__predict_false(e >= EXP_MAX)) return tf_overflow(sign, fpcr_rounding_mode());
+  bool tiny = e < 1 || sig < ((u128)1 << 115);
+  if (e < 1) {
+    int shift = 1 - e;
+    sig = (shift < 116) ? (sig >> shift) | ((sig << (128 - shift)) != 0) : (sig != 0);
+    e = 1;
+  }
+  unsigned rest = sig & 7;
+  sig >>= 3;
+  if (rest != 0) {
+    int mode = fpcr_rounding_mode();
+    if (mode == FE_TONEAREST) {
+      if (rest > 4 || (rest == 4 && (sig & 1))) sig++;
+    } else if (mode == (sign ? FE_DOWNWARD : FE_UPWARD)) {
+      sig++;
+    }
+  }
+  // Adding sig including its implicit bit to e - 1 gives the right exponent field, and lets a
+  // carry out of the significand (or out of a subnormal) bump it.
+  u128 r = ((u128)(e - 1) << SIG_BITS) + sig;
+  if (rest != 0) {
+    if (__predict_false(r >= INF_BITS)) {
+      fpsr_raise(FE_OVERFLOW | FE_INEXACT);
+    } else {
+      fpsr_raise(tiny ? (FE_UNDERFLOW | FE_INEXACT) : FE_INEXACT);
+    }
+  }
+  return tf_from_bits(sign | r);
+}
+
+// Returns the significand of the finite, nonzero |x| with its leading bit at bit 112, setting *e
+// to its exponent. Subnormals are normalized, and get an exponent below 1.
+static inline u128 tf_normalize(u128 abs, int* e) {
+  int exp = abs >> SIG_BITS;
+  if (__predict_true(exp != 0)) {
+    *e = exp;
+    return (abs & SIG_MASK) | IMPLICIT_BIT;
+  }
+  int shift = clz128(abs) - 15;
+  *e = 1 - shift;
+  return abs << shift;
+}
+
+// Whether |x| is zero, infinite or NaN.
+static inline bool tf_is_special(u128 abs) {
+  return abs - 1 >= INF_BITS - 1;
+}
+
+static long double tf_add(u128 a, u128 b) {
+  u128 abs_a = a & ~SIGN_BIT;
+  u128 abs_b = b & ~SIGN_BIT;
+  if (__predict_false(tf_is_special(abs_a) || tf_is_special(abs_b))) {
+    if (abs_a > INF_BITS || abs_b > INF_BITS) return tf_nan(a, b);
+    if (abs_a == INF_BITS) return (abs_b == INF_BITS && a != b) ? tf_invalid() : tf_from_bits(a);
+    if (abs_b == INF_BITS) return tf_from_bits(b);
+    if (abs_b != 0) return tf_from_bits(b);
+    if (abs_a != 0 || a == b) return tf_from_bits(a);
+    // +0 + -0 is -0 only when rounding down.
+    return tf_from_bits(fpcr_rounding_mode() == FE_DOWNWARD ? SIGN_BIT : 0);
+  }
+
+  if (abs_a < abs_b) {
+    u128 t = a; a = b; b = t;
+    t = abs_a; abs_a = abs_b; abs_b = t;
+  }
+  int ea = abs_a >> SIG_BITS;
+  int eb = abs_b >> SIG_BITS;
+  // Subnormals have no implicit bit and the same scale as exponent 1.
+  u128 ma = ((abs_a & SIG_MASK) | (ea ? IMPLICIT_BIT : 0)) << 3;
+  u128 mb = ((abs_b & SIG_MASK) | (eb ? IMPLICIT_BIT : 0)) << 3;
+  ea += !ea;
+  eb += !eb;
+  int d = ea - eb;
+  if (d != 0) mb = (d < 116) ? (mb >> d) | ((mb << (128 - d)) != 0) : 1;
+
+  if (!((a ^ b) & SIGN_BIT)) {
+    ma += mb;
+    if (ma >> 116) {
+      ma = (ma >> 1) | (ma & 1);
+      ea++;
+    }
+  } else {
+    ma -= mb;
+    if (ma == 0) return tf_from_bits(fpcr_rounding_mode() == FE_DOWNWARD ? SIGN_BIT : 0);
+    // Renormalize, but no further than the subnormal scale. The sticky bit only matters when
+    // d >= 2, and then this shifts by at most one.
+    int shift = clz128(ma) - 12;
+    if (shift > ea - 1) shift = ea - 1;
+    ma <<= shift;
+    ea -= shift;
+  }
+  return tf_round_pack(a & SIGN_BIT, ea, ma);
+}
+
+__LIBC_HIDDEN__ long double __addtf3(long double x, long double y) {
+  return tf_add(tf_bits(x), tf_bits(y));
+}
+
+__LIBC_HIDDEN__ long double __subtf3(long double x, long double y) {
+  u128 b = tf_bits(y);
+  // Like fsub, leave a NaN's sign alone.
+  if ((b & ~SIGN_BIT) <= INF_BITS) b ^= SIGN_BIT;
+  return tf_add(tf_bits(x), b);
+}
+
+__LIBC_HIDDEN__ long double __multf3(long double x, long double y) {
+  u128 a = tf_bits(x);
+  u128 b = tf_bits(y);
+  u128 sign = (a ^ b) & SIGN_BIT;
+  u128 abs_a = a & ~SIGN_BIT;
+  u128 abs_b = b & ~SIGN_BIT;
+  if (__predict_false(tf_is_special(abs_a) || tf_is_special(abs_b))) {
+    if (abs_a > INF_BITS || abs_b > INF_BITS) return tf_nan(a, b);
+    if (abs_a == INF_BITS || abs_b == INF_BITS) {
+      return (abs_a == 0 || abs_b == 0) ? tf_invalid() : tf_from_bits(sign | INF_BITS);
+    }
+    return tf_from_bits(sign);
+  }
+
+  int ea, eb;
+  u128 ma = tf_normalize(abs_a, &ea);
+  u128 mb = tf_normalize(abs_b, &eb);
+  // The full 226-bit product, from four 64x64 multiplies.
+  uint64_t a0 = ma, a1 = ma >> 64;
+  uint64_t b0 = mb, b1 = mb >> 64;
+  u128 lo = (u128)a0 * b0;
+  u128 mid = (u128)a1 * b0 + (u128)a0 * b1;
+  u128 hi = (u128)a1 * b1 + (mid >> 64);
+  u128 mid_lo = mid << 64;
+  lo += mid_lo;
+  hi += lo < mid_lo;
+  // The leading bit is at bit 224 or 225; bring it to 115 or 116, with the rest as sticky.
+  u128 sig = (hi << 19) | (lo >> 109) | ((lo << 19) != 0);
+  int e = ea + eb - BIAS;
+  if (sig >> 116) {
+    sig = (sig >> 1) | (sig & 1);
+    e++;
+  }
+  return tf_round_pack(sign, e, sig);
+}
+
+__LIBC_HIDDEN__ long double __divtf3(long double x, long double y) {
+  u128 a = tf_bits(x);
+  u128 b = tf_bits(y);
+  u128 sign = (a ^ b) & SIGN_BIT;
+  u128 abs_a = a & ~SIGN_BIT;
+  u128 abs_b = b & ~SIGN_BIT;
+  if (__predict_false(tf_is_special(abs_a) || tf_is_special(abs_b))) {
+    if (abs_a > INF_BITS || abs_b > INF_BITS) return tf_nan(a, b);
+    if (abs_a == INF_BITS) return (abs_b == INF_BITS) ? tf_invalid() : tf_from_bits(sign | INF_BITS);
+    if (abs_b == INF_BITS) return tf_from_bits(sign);
+    if (abs_b == 0) {
+      if (abs_a == 0) return tf_invalid();
+      fpsr_raise(FE_DIVBYZERO);
+      return tf_from_bits(sign | INF_BITS);
+    }
+    return tf_from_bits(sign);
+  }
+
+  int ea, eb;
+  u128 ma = tf_normalize(abs_a, &ea);
+  u128 mb = tf_normalize(abs_b, &eb);
+  // Produce 116 quotient bits (the leading one at bit 115), so one more when ma < mb.
+  int e = ea - eb + BIAS;
+  int n = 115;
+  if (ma < mb) {
+    n = 116;
+    e--;
+  }
+  // Long division, 29 quotient bits per step. Each step's quotient digit comes from the top of
+  // the remainder times a 33-bit reciprocal of the top of the divisor. That never overestimates,
+  // and underestimates by at most three, which the exact remainder then corrects. The remainder
+  // is only ever a few times mb, so computing it modulo 2^128 is exact.
+  uint64_t inv_b = UINT64_MAX / ((uint64_t)(mb >> 81) + 1);
+  u128 q = 0;
+  u128 r = ma;
+  while (n > 0) {
+    int c = (n < 29) ? n : 29;
+    uint64_t qd = ((u128)(uint64_t)(r >> 50) * inv_b) >> (95 - c);
+    r = (r << c) - (u128)qd * mb;
+    while (r >= mb) {
+      r -= mb;
+      qd++;
+    }
+    q = (q << c) + qd;
+    n -= c;
+  }
+  return tf_round_pack(sign, e, q | (r != 0));
+}
+
+__LIBC_HIDDEN__ long double __extenddftf2(double x) {
+  uint64_t i = asuint64(x);
+  u128 sign = (u128)(i >> 63) << 127;
+  uint64_t abs = i & 0x7fffffffffffffffULL;
+  uint64_t m = abs & 0x000fffffffffffffULL;
+  int e = abs >> 52;
+  if (__predict_false(e == 0x7ff)) {
+    u128 r = sign | INF_BITS | ((u128)m << 60);
+    if (m != 0) {
+      if (!(m & (1ULL << 51))) fpsr_raise(FE_INVALID);
+      r |= QUIET_BIT;
+    }
+    return tf_from_bits(r);
+  }
+  if (__predict_false(e == 0)) {
+    if (m == 0) return tf_from_bits(sign);
+    int shift = __builtin_clzll(m) - 11;
+    m = (m << shift) & 0x000fffffffffffffULL;
+    e = 1 - shift;
+  }
+  return tf_from_bits(sign | ((u128)(e - 1023 + BIAS) << SIG_BITS) | ((u128)m << 60));
+}
+
+__LIBC_HIDDEN__ double __trunctfdf2(long double x) {
+  u128 a = tf_bits(x);
+  uint64_t sign = (uint64_t)(a >> 64) & 0x8000000000000000ULL;
+  u128 abs = a & ~SIGN_BIT;
+  if (__predict_false(abs >= INF_BITS)) {
+    uint64_t r = sign | 0x7ff0000000000000ULL;
+    if (abs > INF_BITS) {
+      if (!(abs & QUIET_BIT)) fpsr_raise(FE_INVALID);
+      r |= 0x0008000000000000ULL | (uint64_t)((abs & SIG_MASK) >> 60);
+    }
+    return asdouble(r);
+  }
+  if (__predict_false(abs == 0)) return asdouble(sign);
+
+  // As in tf_round_pack: the 53 bits kept (the leading one at bit 55), then guard, round, sticky.
+  int exp = abs >> SIG_BITS;
+  int e = exp - BIAS + 1023;
+  uint64_t sig = (uint64_t)((abs & SIG_MASK) >> 57) | (exp ? (1ULL << 55) : 0) |
+                 ((abs & (((u128)1 << 57) - 1)) != 0);
+  if (__predict_false(e >= 0x7ff)) return __math_oflow(sign != 0);
+  bool tiny = e < 1;
+  if (tiny) {
+    int shift = 1 - e;
+    sig = (shift < 56) ? (sig >> shift) | ((sig << (64 - shift)) != 0) : 1;
+    e = 1;
+  }
+  unsigned rest = sig & 7;
+  sig >>= 3;
+  if (rest != 0) {
+    int mode = fpcr_rounding_mode();
+    if (mode == FE_TONEAREST) {
+      if (rest > 4 || (rest == 4 && (sig & 1))) sig++;
+    } else if (mode == (sign ? FE_DOWNWARD : FE_UPWARD)) {
+      sig++;
+    }
+  }
+  uint64_t r = ((uint64_t)(e - 1) << 52) + sig;
+  if (rest != 0) {
+    if (__predict_false(r >= 0x7ff0000000000000ULL)) {
+      fpsr_raise(FE_OVERFLOW | FE_INEXACT);
+    } else {
+      fpsr_raise(tiny ? (FE_UNDERFLOW | FE_INEXACT) : FE_INEXACT);
+    }
+  }
+  return asdouble(sign | r);
+}
+
+__LIBC_HIDDEN__ long double __floatditf(int64_t i) {
+  if (i == 0) return tf_from_bits(0);
+  u128 sign = (i < 0) ? SIGN_BIT : 0;
+  uint64_t m = (i < 0) ? -(uint64_t)i : (uint64_t)i;
+  int shift = __builtin_clzll(m);
+  return tf_from_bits(sign | (((u128)(BIAS + 63 - shift - 1) << SIG_BITS) +
+                              ((u128)m << (SIG_BITS - 63 + shift))));
+}
+
+__LIBC_HIDDEN__ long double __floatsitf(int i) {
+  return __floatditf(i);
+}
+
+// Converts to a signed integer of the given width, truncating. Like fcvtzs, out of range values
+// (and NaN, as 0) saturate and raise FE_INVALID, and dropping a fraction raises FE_INEXACT.
+static inline int64_t tf_fix(long double x, int width) {
+  u128 a = tf_bits(x);
+  u128 abs = a & ~SIGN_BIT;
+  bool negative = a >> 127;
+  int e = (int)(abs >> SIG_BITS) - BIAS;
+  if (e < 0) {
+    if (abs != 0) fpsr_raise(FE_INEXACT);
+    return 0;
+  }
+  int64_t limit = (int64_t)(((uint64_t)1 << width) - 1);
+  if (__predict_false(e >= width)) {
+    if (negative && abs == ((u128)(BIAS + width) << SIG_BITS)) return -limit - 1;
+    fpsr_raise(FE_INVALID);
+    if (abs > INF_BITS) return 0;
+    return negative ? -limit - 1 : limit;
+  }
+  u128 m = (abs & SIG_MASK) | IMPLICIT_BIT;
+  if (m & ((IMPLICIT_BIT >> e) - 1)) fpsr_raise(FE_INEXACT);
+  int64_t r = m >> (SIG_BITS - e);
+  return negative ? -r : r;
+}
+
+__LIBC_HIDDEN__ int64_t __fixtfdi(long double x) {
+  return tf_fix(x, 63);
+}
+
+__LIBC_HIDDEN__ int __fixtfsi(long double x) {
+  return tf_fix(x, 31);
+}
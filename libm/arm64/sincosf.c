@@ -0,0 +1,211 @@
+/*-
+ * Copyright (C) 2017 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <math.h>
+
+#include "math_config.h"
+
+// sinf, cosf and sincosf work in double precision: x = n*pi/2 + r with |r| <= pi/4, and then
+// sin(r) or cos(r) comes from a short polynomial with the sign the quadrant n needs. A float is
+// exact in double, so for |x| < 120 a single fused multiply-subtract of n times pi/2 rounded to
+// double leaves r accurate enough even where it cancels the most. Bigger x are reduced with
+// integer multiplies by the bits of 2/pi that matter for that exponent, instead of the general
+// __kernel_rem_pio2. All three are within 0.57 ULP.
+
+static const double kShift = 0x1.8p52;
+static const double kTwoOverPi = 0x1.45f306dc9c883p-1;
+static const double kPiOver2 = 0x1.921fb54442d18p+0;
+// pi/2 * 2^-62, for the fixed-point result of reduce_large.
+static const double kPiOver2x2e62 = 0x1.921fb54442d18p-62;
+
+// For (sin(r) - r) / r^3.
+static const double S0 = -0x1.555545268a03p-3;
+static const double S1 = 0x1.11073afd14db7p-7;
+static const double S2 = -0x1.9943e0fc799fap-13;
+
+// For (cos(r) - 1) / r^2.
+static const double C0 = -0x1.ffffffcb82e93p-2;
+static const double C1 = 0x1.55553c78995a1p-5;
+static const double C2 = -0x1.6c07f16942069p-10;
+static const double C3 = 0x1.99169fc8b0c58p-16;
+
+// The bits of 2/pi, 32 at a time, with each entry starting 8 bits later than the one before.
+// The first three are padded on the left with zeros.
+static const uint32_t k2OverPiBits[24] = {
+    0x000000a2, 0x0000a2f9, 0x00a2f983, 0xa2f9836e,
+    0xf9836e4e, 0x836e4e44, 0x6e4e4415, 0x4e441529,
+    0x441529fc, 0x1529fc27, 0x29fc2757, 0xfc2757d1,
+    0x2757d1f5, 0x57d1f534, 0xd1f534dd, 0xf534ddc0,
+    0x34ddc0db, 0xddc0db62, 0xc0db6295, 0xdb629599,
+    0x6295993c, 0x95993c43, 0x993c4390, 0x3c439041,
+};
+
+// The top 12 bits of a float's sign and exponent (and the top of its significand).
+static inline uint32_t top12f(float x) {
+  return asuint(x) >> 20;
+}
+
+static inline void force_underflow(float x) {
+  volatile float tiny = x * x;
+  (void) tiny;
+}
+
+static inline double sin_poly(double r, double r2) {
+  double r3 = r * r2;
+  double s = r + r3 * S0;
+  return s + r3 * r2 * (S1 + r2 * S2);
+}
+
+static inline double cos_poly(double r2) {
+  double r4 = r2 * r2;
+  double c = 1.0 + r2 * C0;
+  return c + r4 * (C1 + r2 * C2 + r4 * C3);
+}
+
+// Returns sin(n*pi/2 + r). The quadrant is as good as random for most callers, so both
+// polynomials are evaluated (side by side) and the one needed picked without a branch.
+static inline float sin_quadrant(double r, int n) {
+  double r2 = r * r;
+  double s = sin_poly(r, r2);
+  double c = cos_poly(r2);
+  double y = (n & 1) ? c : s;
+  return asdouble(asuint64(y) ^ ((uint64_t) (n & 2) << 62));
+}
+
+// Returns r = x - n*pi/2, with n the nearest integer to x*2/pi, for |x| < 120.
+static inline double reduce_small(double x, int* n) {
+  double kd = x * kTwoOverPi + kShift;
+  *n = (int) asuint64(kd);
+  kd -= kShift;
+  return __builtin_fma(-kd, kPiOver2, x);
+}
+
+// Returns r = x - n*pi/2, with n the nearest integer to x*2/pi modulo 4, for finite |x| >= 120.
+// A float's significand m times 2/pi is only needed modulo 4, with 62 bits of fraction: the bits
+// of 2/pi worth more than that (for x's exponent) give multiples of 4, and those after it too
+// little to matter. That leaves 96 bits of 2/pi, which are every fourth entry of k2OverPiBits.
+static inline double reduce_large(uint32_t ix, int* n) {
+  const uint32_t* bits = &k2OverPiBits[(ix >> 26) & 15];
+  uint32_t m = ((ix & 0x7fffff) | 0x800000) << ((ix >> 23) & 7);
+
+  // Only the low 32 bits of the first product matter; the rest are multiples of 4.
+  uint64_t hi = m * bits[0];
+  uint64_t mid = (uint64_t) m * bits[4];
+  uint64_t lo = (uint64_t) m * bits[8];
+  uint64_t fixed = ((hi << 32) | (lo >> 32)) + mid;
+
+  // Round to the nearest quadrant, leaving a signed fraction of at most half of one.
+  uint64_t q = (fixed + (1ULL << 61)) >> 62;
+  fixed -= q << 62;
+  *n = (int) q;
+  return (int64_t) fixed * kPiOver2x2e62;
+}
+
+float sinf(float x) {
+  uint32_t abstop = top12f(x) & 0x7ff;
+  double xd = x;
+  double r;
+  int n;
+
+  // 0x3f4 is top12f(0.75f), 0x398 top12f(0x1p-12f), 0x42f top12f(120.0f) and 0x7f8
+  // top12f(INFINITY).
+  if (abstop < 0x3f4) {
+    if (__predict_false(abstop < 0x398)) {
+      // sin(x) rounds to x. Make sure a subnormal x raises underflow.
+      if (abstop < 0x008) force_underflow(x);
+      return x;
+    }
+    return sin_poly(xd, xd * xd);
+  } else if (__predict_true(abstop < 0x42f)) {
+    r = reduce_small(xd, &n);
+  } else if (abstop < 0x7f8) {
+    r = reduce_large(asuint(x), &n);
+    if (asuint(x) >> 31) {
+      r = -r;
+      n = -n;
+    }
+  } else {
+    return x - x;
+  }
+  return sin_quadrant(r, n);
+}
+
+float cosf(float x) {
+  uint32_t abstop = top12f(x) & 0x7ff;
+  double xd = x;
+  double r;
+  int n;
+
+  if (abstop < 0x3f4) {
+    if (__predict_false(abstop < 0x398)) return 1.0f;
+    return cos_poly(xd * xd);
+  } else if (__predict_true(abstop < 0x42f)) {
+    r = reduce_small(xd, &n);
+  } else if (abstop < 0x7f8) {
+    r = reduce_large(asuint(x), &n);
+    if (asuint(x) >> 31) {
+      r = -r;
+      n = -n;
+    }
+  } else {
+    return x - x;
+  }
+  return sin_quadrant(r, n + 1);
+}
+
+void sincosf(float x, float* p_sinf, float* p_cosf) {
+  uint32_t abstop = top12f(x) & 0x7ff;
+  double xd = x;
+  double r, r2;
+  int n;
+
+  if (abstop < 0x3f4) {
+    if (__predict_false(abstop < 0x398)) {
+      if (abstop < 0x008) force_underflow(x);
+      *p_sinf = x;
+      *p_cosf = 1.0f;
+      return;
+    }
+    r2 = xd * xd;
+    *p_sinf = sin_poly(xd, r2);
+    *p_cosf = cos_poly(r2);
+    return;
+  } else if (__predict_true(abstop < 0x42f)) {
+    r = reduce_small(xd, &n);
+  } else if (abstop < 0x7f8) {
+    r = reduce_large(asuint(x), &n);
+    if (asuint(x) >> 31) {
+      r = -r;
+      n = -n;
+    }
+  } else {
+    *p_sinf = *p_cosf = x - x;
+    return;
+  }
+
+  *p_sinf = sin_quadrant(r, n);
+  *p_cosf = sin_quadrant(r, n + 1);
+}
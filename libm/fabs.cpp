@@ -18,6 +18,8 @@
 
 #include "fpmath.h"
 
+// The out-of-line copies: on arm64 and x86-64, <math.h> also defines these inline.
+
 double fabs(double x) {
 #if __arm__
   // Both Clang and GCC insist on moving r0/r1 into a double register
@@ -0,0 +1,98 @@
+/*-
+ * Copyright (C) 2017 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+
+#include <math.h>
+#include <stdint.h>
+#include <sys/cdefs.h>
+
+// fmod(x, y) for LP64, where a 64-bit integer division is a single instruction. With both
+// significands as integers and x = mx * 2^d in units of y's exponent, x mod y is the remainder of
+// mx * 2^d by my. msun's e_fmod.c works that out one bit of d at a time; here each step shifts in
+// as many bits as fit in 64 (at least 11) and takes the remainder with a division, so even the
+// largest d, about 2100, takes under 200 steps. Trailing zero bits of y's significand are shifted
+// out first, which lets round numbers like 1.0 or 10.0 go 50 or more bits a step. The result is
+// exact, as fmod's always is.
+
+static inline uint64_t asuint64(double f) {
+  union { double f; uint64_t i; } u = { f };
+  return u.i;
+}
+
+static inline double asdouble(uint64_t i) {
+  union { uint64_t i; double f; } u = { i };
+  return u.f;
+}
+
+double fmod(double x, double y) {
+  uint64_t ix = asuint64(x);
+  uint64_t iy = asuint64(y);
+  uint64_t sign = ix & 0x8000000000000000ULL;
+  ix ^= sign;
+  iy &= 0x7fffffffffffffffULL;
+
+  if (__predict_false(iy == 0 || ix >= 0x7ff0000000000000ULL || iy > 0x7ff0000000000000ULL)) {
+    return (x * y) / (x * y);
+  }
+  if (__predict_false(ix <= iy)) {
+    return (ix == iy) ? asdouble(sign) : x;
+  }
+
+  // Significands with the implicit bit, and exponents with subnormals treated as 1 (so that
+  // the significand scales the same way).
+  int ex = ix >> 52;
+  int ey = iy >> 52;
+  uint64_t mx = ix & 0x000fffffffffffffULL;
+  uint64_t my = iy & 0x000fffffffffffffULL;
+  if (ex != 0) mx |= 0x0010000000000000ULL; else ex = 1;
+  if (ey != 0) my |= 0x0010000000000000ULL; else ey = 1;
+
+  // x mod y = 2^k * ((x / 2^k) mod (y / 2^k)), for any k that leaves both integers.
+  int d = ex - ey;
+  int k = __builtin_ctzll(my);
+  if (k > d) k = d;
+  my >>= k;
+  d -= k;
+
+  int step = __builtin_clzll(my);
+  mx %= my;
+  while (d > step) {
+    mx = (mx << step) % my;
+    d -= step;
+  }
+  mx = (mx << d) % my;
+  if (mx == 0) return asdouble(sign);
+  mx <<= k;
+
+  // Back to a double with y's exponent, normalizing (or leaving subnormal) as needed.
+  int shift = __builtin_clzll(mx) - 11;
+  if (ey - shift >= 1) {
+    mx = (mx << shift) - 0x0010000000000000ULL + ((uint64_t) (ey - shift) << 52);
+  } else {
+    mx <<= ey - 1;
+  }
+  return asdouble(mx | sign);
+}
@@ -374,6 +374,33 @@ fesetround(int round)
   }
 }
 
+/*
+ * Unlike on x86-64, double arithmetic may be done on the x87 here, so both
+ * units get the new rounding mode. Only the registers that change are loaded.
+ */
+int
+feswapround(int round)
+{
+  __uint32_t mxcsr, new_mxcsr;
+  __uint16_t control, new_control;
+
+  if (round & ~ROUND_MASK)
+    return (-1);
+
+  __fnstcw(&control);
+  new_control = (control & ~ROUND_MASK) | round;
+  if (new_control != control)
+    __fldcw(new_control);
+  if (__HAS_SSE()) {
+    __stmxcsr(&mxcsr);
+    new_mxcsr = (mxcsr & ~(ROUND_MASK << _SSE_ROUND_SHIFT)) |
+        (round << _SSE_ROUND_SHIFT);
+    if (new_mxcsr != mxcsr)
+      __ldmxcsr(new_mxcsr);
+  }
+  return (control & ROUND_MASK);
+}
+
 int
 fesetenv(const fenv_t *envp)
 {
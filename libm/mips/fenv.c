@@ -116,6 +116,19 @@ int fesetround(int __round) {
   return 0;
 }
 
+int feswapround(int __round) {
+  fenv_t _fcsr, _new_fcsr;
+  if (__round & ~FCSR_RMASK) {
+    return -1;
+  }
+  fegetenv(&_fcsr);
+  _new_fcsr = (_fcsr & ~FCSR_RMASK) | __round;
+  if (_new_fcsr != _fcsr) {
+    fesetenv(&_new_fcsr);
+  }
+  return (_fcsr & FCSR_RMASK);
+}
+
 int feholdexcept(fenv_t* __envp) {
   fenv_t __env;
   fegetenv(&__env);
@@ -24,28 +24,59 @@
  * SUCH DAMAGE.
  */
 
-#define _GNU_SOURCE 1
+#include <float.h>
 #include <math.h>
 
-// Disable sincos optimization for all functions in this file,
-// otherwise gcc would generate infinite calls.
-// Refer to gcc PR46926.
-// -fno-builtin-sin or -fno-builtin-cos can disable sincos optimization,
-// but these two options do not work inside optimize pragma in-file.
-// Thus we just enforce -O0 when compiling this file.
-#pragma GCC optimize ("O0")
+#define INLINE_REM_PIO2
+#include "math_private.h"
+#include "e_rem_pio2.c"
+
+// These make the same kernel calls on the same reduced argument as the FreeBSD sin() and cos(),
+// but the argument reduction, which is most of the cost for all but small arguments, is only
+// done once. (sincosf and the ld128 sincosl are in their own files, because each flavor of
+// __ieee754_rem_pio2 brings its own static constants.)
 
 void sincos(double x, double* p_sin, double* p_cos) {
-  *p_sin = sin(x);
-  *p_cos = cos(x);
-}
+  double y[2];
+  int32_t n, ix;
+
+  GET_HIGH_WORD(ix, x);
+  ix &= 0x7fffffff;
+
+  // |x| ~< pi/4, so no reduction is needed.
+  if (ix <= 0x3fe921fb) {
+    if (ix < 0x3e500000 && (int) x == 0) {  // |x| < 2**-26, generating inexact.
+      *p_sin = x;
+    } else {
+      *p_sin = __kernel_sin(x, 0.0, 0);
+    }
+    if (ix < 0x3e46a09e && (int) x == 0) {  // |x| < 2**-27 * sqrt(2), generating inexact.
+      *p_cos = 1.0;
+    } else {
+      *p_cos = __kernel_cos(x, 0.0);
+    }
+    return;
+  }
+
+  // sin and cos of Inf or NaN are NaN.
+  if (ix >= 0x7ff00000) {
+    *p_sin = *p_cos = x - x;
+    return;
+  }
 
-void sincosf(float x, float* p_sinf, float* p_cosf) {
-  *p_sinf = sinf(x);
-  *p_cosf = cosf(x);
+  n = __ieee754_rem_pio2(x, y);
+  double s = __kernel_sin(y[0], y[1], 1);
+  double c = __kernel_cos(y[0], y[1]);
+  switch (n & 3) {
+    case 0: *p_sin = s; *p_cos = c; break;
+    case 1: *p_sin = c; *p_cos = -s; break;
+    case 2: *p_sin = -s; *p_cos = -c; break;
+    default: *p_sin = -c; *p_cos = s; break;
+  }
 }
 
+#if LDBL_MANT_DIG == 53
 void sincosl(long double x, long double* p_sinl, long double* p_cosl) {
-  *p_sinl = sinl(x);
-  *p_cosl = cosl(x);
+  sincos(x, (double*) p_sinl, (double*) p_cosl);
 }
+#endif
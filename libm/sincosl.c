@@ -0,0 +1,76 @@
+/*-
+ * Copyright (C) 2010 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include <float.h>
+#include <math.h>
+
+#include "math_private.h"
+#include "e_rem_pio2l.h"
+
+// This makes the same kernel calls on the same reduced argument as the FreeBSD sinl() and
+// cosl(), but only reduces the argument once. It's only built where long double is the
+// 128-bit format; elsewhere sincos.c provides sincosl.
+void sincosl(long double x, long double* p_sinl, long double* p_cosl) {
+  union IEEEl2bits z;
+  int e0, s;
+  long double y[2];
+  long double sn, cs;
+
+  z.e = x;
+  s = z.bits.sign;
+  z.bits.sign = 0;
+
+  // If x = +-0 or x is a subnormal number, then sin(x) = x and cos(x) = 1.
+  if (z.bits.exp == 0) {
+    *p_sinl = x;
+    *p_cosl = 1.0;
+    return;
+  }
+
+  // If x = NaN or Inf, then sin(x) and cos(x) are NaN.
+  if (z.bits.exp == 32767) {
+    *p_sinl = *p_cosl = (x - x) / (x - x);
+    return;
+  }
+
+  // Optimize the case where x is already within range.
+  if (z.e < M_PI_4) {
+    sn = __kernel_sinl(z.e, 0, 0);
+    *p_sinl = s ? -sn : sn;
+    *p_cosl = __kernel_cosl(z.e, 0);
+    return;
+  }
+
+  e0 = __ieee754_rem_pio2l(x, y);
+  sn = __kernel_sinl(y[0], y[1], 1);
+  cs = __kernel_cosl(y[0], y[1]);
+  switch (e0 & 3) {
+    case 0: *p_sinl = sn; *p_cosl = cs; break;
+    case 1: *p_sinl = cs; *p_cosl = -sn; break;
+    case 2: *p_sinl = -sn; *p_cosl = -cs; break;
+    default: *p_sinl = -cs; *p_cosl = sn; break;
+  }
+}
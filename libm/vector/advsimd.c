@@ -0,0 +1,45 @@
+/*-
+ * Copyright (C) 2017 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+// The AdvSIMD variants: two doubles or four floats in a Q register. Callers assume the vector
+// procedure call standard, under which more of the SIMD registers survive a call. The bulk
+// functions (exp_array and so on) are built on these.
+
+#include <math.h>
+#include <stdint.h>
+#include <sys/cdefs.h>
+
+#define V_F64_LANES 2
+#define V_F32_LANES 4
+#define V_NAME_F64(f) _ZGVnN2v_##f
+#define V_NAME_F64_F64(f) _ZGVnN2vv_##f
+#define V_NAME_F32(f) _ZGVnN4v_##f
+#define V_NAME_F32_F32(f) _ZGVnN4vv_##f
+#define V_ABI __attribute__((aarch64_vector_pcs))
+#define V_NAME_ARRAY(f) f##_array
+#define V_ARRAY_ABI
+
+#include "vector_math.h"
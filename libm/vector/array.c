@@ -0,0 +1,110 @@
+/*-
+ * Copyright (C) 2017 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+// The bulk functions, exp_array and so on. arm64 builds them straight on its vector variants, in
+// advsimd.c. x86_64 has them for SSE2, AVX2 and AVX-512, and picks the best one the CPU and OS
+// support when libm is loaded. Everywhere else they're plain loops over the scalar functions.
+
+#include <math.h>
+#include <stddef.h>
+
+#if defined(__x86_64__)
+
+#include <cpuid.h>
+
+#include <private/bionic_ifunc.h>
+
+// CPUID.(EAX=7,ECX=0) bits.
+#define EBX_AVX2 (1 << 5)
+#define EBX_AVX512F (1 << 16)
+
+// XCR0 bits for the register state the OS saves and restores.
+#define XCR0_YMM 0x06
+#define XCR0_ZMM 0xe6
+
+enum array_impl { SSE2, AVX2, AVX512 };
+
+static enum array_impl best_impl(void) {
+  unsigned int eax, ebx, ecx, edx;
+  if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) return SSE2;
+  if ((ecx & bit_OSXSAVE) == 0 || (ecx & bit_AVX) == 0 || (ecx & bit_FMA) == 0) return SSE2;
+  if (__get_cpuid_max(0, NULL) < 7) return SSE2;
+  __cpuid_count(7, 0, eax, ebx, ecx, edx);
+
+  unsigned int xcr0_lo, xcr0_hi;
+  __asm__("xgetbv" : "=a"(xcr0_lo), "=d"(xcr0_hi) : "c"(0));
+  if ((xcr0_lo & XCR0_YMM) != XCR0_YMM || (ebx & EBX_AVX2) == 0) return SSE2;
+  if ((xcr0_lo & XCR0_ZMM) == XCR0_ZMM && (ebx & EBX_AVX512F) != 0) return AVX512;
+  return AVX2;
+}
+
+#define ARRAY_IFUNC(f, ...)                                                 \
+  typedef void f##_array_func(__VA_ARGS__);                                 \
+  __LIBC_HIDDEN__ f##_array_func __##f##_array_sse2, __##f##_array_avx2,    \
+      __##f##_array_avx512;                                                 \
+  DEFINE_IFUNC_RESOLVER(f##_array) {                                        \
+    switch (best_impl()) {                                                  \
+      case AVX512: return __##f##_array_avx512;                             \
+      case AVX2: return __##f##_array_avx2;                                 \
+      default: return __##f##_array_sse2;                                   \
+    }                                                                       \
+  }
+
+ARRAY_IFUNC(cos, const double*, double*, size_t)
+ARRAY_IFUNC(exp, const double*, double*, size_t)
+ARRAY_IFUNC(log, const double*, double*, size_t)
+ARRAY_IFUNC(sin, const double*, double*, size_t)
+ARRAY_IFUNC(pow, const double*, const double*, double*, size_t)
+ARRAY_IFUNC(cosf, const float*, float*, size_t)
+ARRAY_IFUNC(expf, const float*, float*, size_t)
+ARRAY_IFUNC(logf, const float*, float*, size_t)
+ARRAY_IFUNC(sinf, const float*, float*, size_t)
+ARRAY_IFUNC(powf, const float*, const float*, float*, size_t)
+
+#else
+
+#define ARRAY(f, T)                                    \
+  void f##_array(const T* in, T* out, size_t n) {      \
+    for (size_t i = 0; i < n; i++) out[i] = f(in[i]);  \
+  }
+
+#define ARRAY2(f, T)                                                  \
+  void f##_array(const T* in1, const T* in2, T* out, size_t n) {      \
+    for (size_t i = 0; i < n; i++) out[i] = f(in1[i], in2[i]);        \
+  }
+
+ARRAY(cos, double)
+ARRAY(exp, double)
+ARRAY(log, double)
+ARRAY(sin, double)
+ARRAY2(pow, double)
+ARRAY(cosf, float)
+ARRAY(expf, float)
+ARRAY(logf, float)
+ARRAY(sinf, float)
+ARRAY2(powf, float)
+
+#endif
@@ -0,0 +1,46 @@
+/*-
+ * Copyright (C) 2017 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+// The AVX-512 variants: eight doubles or sixteen floats in a ZMM register. This also has the
+// AVX-512 versions of the bulk functions, for array.c to choose between.
+
+#include <math.h>
+#include <stdint.h>
+#include <sys/cdefs.h>
+
+#define V_F64_LANES 8
+#define V_F32_LANES 16
+#define V_NAME_F64(f) _ZGVeN8v_##f
+#define V_NAME_F64_F64(f) _ZGVeN8vv_##f
+#define V_NAME_F32(f) _ZGVeN16v_##f
+#define V_NAME_F32_F32(f) _ZGVeN16vv_##f
+#define V_ABI
+#define V_NAME_ARRAY(f) __##f##_array_avx512
+#define V_ARRAY_ABI __LIBC_HIDDEN__
+
+#pragma clang attribute push(__attribute__((target("avx512f"))), apply_to = function)
+#include "vector_math.h"
+#pragma clang attribute pop
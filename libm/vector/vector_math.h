@@ -0,0 +1,554 @@
+/*-
+ * Copyright (C) 2017 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+// The vector function ABI variants of exp, log, pow, sin, cos, expf, logf, powf, sinf and cosf,
+// written once with the compiler's vector extensions. Each instruction set's file says how wide
+// its vectors are and what the functions are called, and then includes this.
+//
+// Every lane goes through the same straight-line code, which is only right for the usual range
+// of arguments. Lanes outside that range (zeros, negative or subnormal arguments to log, Inf and
+// NaN, results that overflow or are subnormal, arguments that need more than the cheap argument
+// reduction) are replaced by a harmless value so that they don't raise spurious exceptions, and
+// are then redone by the scalar function. Those lanes get exactly the scalar result.
+//
+// The including file defines:
+//   V_F64_LANES, V_F32_LANES  the number of lanes in a vector of double and of float.
+//   V_NAME_F64(f), V_NAME_F64_F64(f), V_NAME_F32(f), V_NAME_F32_F32(f)
+//                             the mangled names of the one- and two-argument variants of f. A
+//                             file that only wants the float variants leaves the F64 ones out.
+//   V_ABI                     any attribute the vector function ABI needs on the definitions.
+//   V_NAME_ARRAY(f), V_ARRAY_ABI
+//                             optionally, the name of the bulk version of f built on its vector
+//                             variant, and any attribute that needs.
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/cdefs.h>
+
+typedef double v_f64 __attribute__((__vector_size__(V_F64_LANES * sizeof(double))));
+typedef uint64_t v_u64 __attribute__((__vector_size__(V_F64_LANES * sizeof(double))));
+typedef int64_t v_s64 __attribute__((__vector_size__(V_F64_LANES * sizeof(double))));
+
+typedef float v_f32 __attribute__((__vector_size__(V_F32_LANES * sizeof(float))));
+typedef uint32_t v_u32 __attribute__((__vector_size__(V_F32_LANES * sizeof(float))));
+typedef int32_t v_s32 __attribute__((__vector_size__(V_F32_LANES * sizeof(float))));
+
+// The float functions work in double, one double lane per float lane, which keeps them within
+// about half an ULP without needing tables.
+typedef double v_f64w __attribute__((__vector_size__(V_F32_LANES * sizeof(double))));
+typedef uint64_t v_u64w __attribute__((__vector_size__(V_F32_LANES * sizeof(double))));
+typedef int64_t v_s64w __attribute__((__vector_size__(V_F32_LANES * sizeof(double))));
+
+#define V_ABS_MASK 0x7fffffffffffffffULL
+#define V_ABS_MASK_F 0x7fffffffU
+// Adding this rounds to an integer (assuming round-to-nearest), which ends up in the low bits.
+#define V_SHIFT 0x1.8p52
+
+static inline v_f64 v_sel(v_s64 m, v_f64 a, v_f64 b) {
+  return (v_f64)((m & (v_s64)a) | (~m & (v_s64)b));
+}
+
+static inline v_f64w v_selw(v_s64w m, v_f64w a, v_f64w b) {
+  return (v_f64w)((m & (v_s64w)a) | (~m & (v_s64w)b));
+}
+
+static inline v_f32 v_self(v_s32 m, v_f32 a, v_f32 b) {
+  return (v_f32)((m & (v_s32)a) | (~m & (v_s32)b));
+}
+
+static inline v_f64 v_dup(double d) { return (v_f64){} + d; }
+static inline v_f32 v_dupf(float f) { return (v_f32){} + f; }
+
+static inline int v_any(v_s64 m) {
+  int64_t any = 0;
+  for (int i = 0; i < V_F64_LANES; i++) any |= m[i];
+  return any != 0;
+}
+
+static inline int v_anyf(v_s32 m) {
+  int32_t any = 0;
+  for (int i = 0; i < V_F32_LANES; i++) any |= m[i];
+  return any != 0;
+}
+
+// Turns an integer with |k| < 2^51 into a double without a (slow on most of our targets)
+// 64-bit integer conversion.
+static inline v_f64 v_to_f64(v_s64 k) {
+  return (v_f64)((v_u64)k + 0x4338000000000000ULL) - V_SHIFT;
+}
+
+// The top 12 bits of each lane, taken as a signed integer, as a double. This is the unbiased
+// exponent when the lane holds a double minus a constant, and avoids a 64-bit arithmetic shift,
+// which x86 doesn't have before AVX-512.
+static inline v_f64 v_top12_to_f64(v_u64 u) {
+  return (v_f64)(((u >> 52) ^ 0x800) | 0x4330000000000000ULL) - (0x1p52 + 2048.0);
+}
+
+static inline v_f64w v_top12_to_f64w(v_u64w u) {
+  return (v_f64w)(((u >> 52) ^ 0x800) | 0x4330000000000000ULL) - (0x1p52 + 2048.0);
+}
+
+// Unsigned comparisons of the top 32 bits of each lane with a bound, which is all that the range
+// checks need. SSE2 has no 64-bit comparison at all, and AVX2 only a signed one, so on x86 this
+// copies the top half of each lane into both halves and compares those instead.
+#if defined(__aarch64__)
+static inline v_s64 v_top_lt(v_u64 u, uint32_t bound) {
+  return (v_s64)(u < ((uint64_t)bound << 32));
+}
+#else
+typedef uint32_t v_u64_halves __attribute__((__vector_size__(V_F64_LANES * sizeof(double))));
+
+static inline v_s64 v_top_lt(v_u64 u, uint32_t bound) {
+  v_u64 top = u >> 32;
+  return (v_s64)((v_u64_halves)(top | (top << 32)) < bound);
+}
+#endif
+
+static inline v_s64 v_top_ge(v_u64 u, uint32_t bound) {
+  return ~v_top_lt(u, bound);
+}
+
+static __noinline v_f32 v_call_f32(float (*f)(float), v_f32 x, v_f32 y, v_s32 special) {
+  for (int i = 0; i < V_F32_LANES; i++) {
+    if (special[i]) y[i] = f(x[i]);
+  }
+  return y;
+}
+
+static __noinline v_f32 v_call_f32_f32(float (*f)(float, float), v_f32 x1, v_f32 x2, v_f32 y,
+                                       v_s32 special) {
+  for (int i = 0; i < V_F32_LANES; i++) {
+    if (special[i]) y[i] = f(x1[i], x2[i]);
+  }
+  return y;
+}
+
+static const double kInvLn2 = 0x1.71547652b82fep+0;
+
+#if defined(V_NAME_F64)
+
+static __noinline v_f64 v_call_f64(double (*f)(double), v_f64 x, v_f64 y, v_s64 special) {
+  for (int i = 0; i < V_F64_LANES; i++) {
+    if (special[i]) y[i] = f(x[i]);
+  }
+  return y;
+}
+
+static __noinline v_f64 v_call_f64_f64(double (*f)(double, double), v_f64 x1, v_f64 x2, v_f64 y,
+                                       v_s64 special) {
+  for (int i = 0; i < V_F64_LANES; i++) {
+    if (special[i]) y[i] = f(x1[i], x2[i]);
+  }
+  return y;
+}
+
+// ln2, split so that n * kLn2hi is exact.
+static const double kLn2hi = 0x1.62e42fee00000p-1;
+static const double kLn2lo = 0x1.a39ef35793c76p-33;
+
+// exp(x) = 2^n * exp(r), where n is x/ln2 rounded to an integer and |r| <= ln2/2. With no table
+// to shrink r further, exp(r) takes a degree 12 polynomial, which is within 2^-61 of it.
+V_ABI v_f64 V_NAME_F64(exp)(v_f64 x) {
+  v_u64 ia = (v_u64)x & V_ABS_MASK;
+  // |x| >= 708 (so the result might overflow or be subnormal), or NaN.
+  v_s64 special = v_top_ge(ia, 0x40862000);
+  // |x| < 2^-54, when exp(x) rounds to 1 (and squaring x could underflow).
+  v_s64 tiny = v_top_lt(ia, 0x3c900000);
+  v_f64 xs = v_sel(special | tiny, v_dup(0.0), x);
+
+  v_f64 z = xs * kInvLn2 + V_SHIFT;
+  v_f64 n = z - V_SHIFT;
+  // r = r_hi + r_lo, where r_hi is exact, and r rounds that.
+  v_f64 r_hi = xs - n * kLn2hi;
+  v_f64 r_lo = n * -kLn2lo;
+  v_f64 r = r_hi + r_lo;
+  v_f64 r_err = (r_hi - r) + r_lo;
+
+  // exp(r) - 1 - r = r^2 * p(r).
+  v_f64 r2 = r * r;
+  v_f64 r4 = r2 * r2;
+  v_f64 r8 = r4 * r4;
+  v_f64 p = (0x1.0000000000000p-1 + 0x1.5555555555557p-3 * r) +
+            r2 * (0x1.5555555555556p-5 + 0x1.111111111007ep-7 * r) +
+            r4 * ((0x1.6c16c16c1629fp-10 + 0x1.a01a01ac1adebp-13 * r) +
+                  r2 * (0x1.a01a01a6f59a9p-16 + 0x1.71de0190b33a1p-19 * r)) +
+            r8 * ((0x1.27e4db08819d2p-22 + 0x1.af4f375ba602bp-26 * r) + r2 * 0x1.1f73c205d8d57p-29);
+  // 1 + r_hi is split exactly into hi + lo, so that only the final addition rounds much. The
+  // r * r_err term makes up for r^2 * p(r) having used the rounded r.
+  v_f64 hi = 1.0 + r_hi;
+  v_f64 lo = (1.0 - hi) + r_hi;
+  p = lo + (r_lo + (r2 * p + r * r_err));
+
+  v_f64 scale = (v_f64)(((v_u64)z << 52) + 0x3ff0000000000000ULL);
+  v_f64 y = scale * (hi + p);
+  y = v_sel(tiny, v_dup(1.0), y);
+  if (__predict_false(v_any(special))) return v_call_f64(exp, x, y, special);
+  return y;
+}
+
+// log(x) = k*ln2 + log(m), where x = 2^k * m and sqrt(2)/2 <= m < sqrt(2), with log(m) from
+// e_log.c's polynomial in s = (m - 1)/(m + 1).
+V_ABI v_f64 V_NAME_F64(log)(v_f64 x) {
+  v_u64 ix = (v_u64)x;
+  // Zero, negative, subnormal, Inf or NaN.
+  v_s64 special = v_top_ge(ix - 0x0010000000000000ULL, 0x7fe00000);
+  ix = (v_u64)v_sel(special, v_dup(1.0), x);
+
+  v_u64 tmp = ix - 0x3fe6a09e667f3bcdULL;
+  v_f64 k = v_top12_to_f64(tmp);
+  v_f64 f = (v_f64)(ix - (tmp & 0xfff0000000000000ULL)) - 1.0;
+
+  v_f64 hfsq = 0.5 * f * f;
+  v_f64 s = f / (2.0 + f);
+  v_f64 z = s * s;
+  v_f64 w = z * z;
+  v_f64 t1 = w * (0x1.999999997fa04p-2 + w * (0x1.c71c51d8e78afp-3 + w * 0x1.39a09d078c69fp-3));
+  v_f64 t2 = z * (0x1.5555555555593p-1 +
+                  w * (0x1.2492494229359p-2 +
+                       w * (0x1.7466496cb03dep-3 + w * 0x1.2f112df3e5244p-3)));
+  v_f64 R = t2 + t1;
+  v_f64 y = k * kLn2hi - ((hfsq - (s * (hfsq + R) + k * kLn2lo)) - f);
+  if (__predict_false(v_any(special))) return v_call_f64(log, x, y, special);
+  return y;
+}
+
+// The common case of e_pow.c, a lane at a time: log2(x) worked out in extra precision as t1 + t2,
+// multiplied by y in pieces, and 2 raised to the result.
+V_ABI v_f64 V_NAME_F64_F64(pow)(v_f64 x, v_f64 y) {
+  v_u64 iy = (v_u64)y & V_ABS_MASK;
+  // x zero, negative, subnormal, Inf or NaN, or |y| > 2^31 (including Inf and NaN), or y so
+  // small that y * log2(x) could underflow.
+  v_s64 special = v_top_ge((v_u64)x - 0x0010000000000000ULL, 0x7fe00000) |
+                  v_top_ge(iy, 0x41e00000) | v_top_lt(iy - 1, 0x3c300000);
+  v_f64 xs = v_sel(special, v_dup(1.0), x);
+  v_f64 ys = v_sel(special, v_dup(0.0), y);
+
+  // Work with ax = x / 2^n in [1, 2), picking the interval (k = 0 for [1, sqrt(3/2)], k = 1 for
+  // [sqrt(3/2), sqrt(3)]) and moving [sqrt(3), 2) down to [sqrt(3)/2, 1).
+  v_u64 ix = (v_u64)xs >> 32;
+  v_u64 j = ix & 0x000fffff;
+  v_s64 k1 = v_top_ge(j << 32, 0x3988f) & v_top_lt(j << 32, 0xbb67a);
+  v_s64 down = v_top_ge(j << 32, 0xbb67a);
+  v_f64 n = v_to_f64((v_s64)(ix >> 20) - 0x3ff - down);
+  ix = (j | 0x3ff00000) + (v_u64)(down & -0x00100000);
+  v_f64 ax = (v_f64)(((v_u64)ix << 32) | ((v_u64)xs & 0xffffffffULL));
+  v_f64 bp = v_sel(k1, v_dup(1.5), v_dup(1.0));
+  v_f64 dp_h = (v_f64)(k1 & (v_s64)v_dup(5.84962487220764160156e-01));
+  v_f64 dp_l = (v_f64)(k1 & (v_s64)v_dup(1.35003920212974897128e-08));
+
+  // ss = s_h + s_l = (ax - bp)/(ax + bp).
+  v_f64 u = ax - bp;
+  v_f64 v = 1.0 / (ax + bp);
+  v_f64 ss = u * v;
+  v_f64 s_h = (v_f64)((v_u64)ss & 0xffffffff00000000ULL);
+  v_u64 t_h_top = ((ix >> 1) | 0x20000000) + 0x00080000 + (v_u64)(k1 & (1 << 18));
+  v_f64 t_h = (v_f64)(t_h_top << 32);
+  v_f64 t_l = ax - (t_h - bp);
+  v_f64 s_l = v * ((u - s_h * t_h) - s_h * t_l);
+
+  // log(ax).
+  v_f64 s2 = ss * ss;
+  v_f64 r = s2 * s2 * (5.99999999999994648725e-01 +
+                       s2 * (4.28571428578550184252e-01 +
+                             s2 * (3.33333329818377432918e-01 +
+                                   s2 * (2.72728123808534006489e-01 +
+                                         s2 * (2.30660745775561754067e-01 +
+                                               s2 * 2.06975017800338417784e-01)))));
+  r += s_l * (s_h + ss);
+  s2 = s_h * s_h;
+  t_h = 3.0 + s2 + r;
+  t_h = (v_f64)((v_u64)t_h & 0xffffffff00000000ULL);
+  t_l = r - ((t_h - 3.0) - s2);
+  u = s_h * t_h;
+  v = s_l * t_h + t_l * ss;
+  v_f64 p_h = u + v;
+  p_h = (v_f64)((v_u64)p_h & 0xffffffff00000000ULL);
+  v_f64 p_l = v - (p_h - u);
+
+  // log2(ax) = n + dp_h + z_h + z_l = t1 + t2.
+  v_f64 z_h = 9.61796700954437255859e-01 * p_h;
+  v_f64 z_l = -7.02846165095275826516e-09 * p_h + p_l * 9.61796693925975554329e-01 + dp_l;
+  v_f64 t1 = ((z_h + z_l) + dp_h) + n;
+  t1 = (v_f64)((v_u64)t1 & 0xffffffff00000000ULL);
+  v_f64 t2 = z_l - (((t1 - n) - dp_h) - z_h);
+
+  // y * log2(x) = p_h + p_l.
+  v_f64 y1 = (v_f64)((v_u64)ys & 0xffffffff00000000ULL);
+  p_l = (ys - y1) * t1 + ys * t2;
+  p_h = y1 * t1;
+  v_f64 z = p_l + p_h;
+  // The result might overflow or be subnormal.
+  v_s64 range = v_top_ge((v_u64)z & V_ABS_MASK, 0x408ff000);
+  special |= range;
+  p_h = v_sel(range, v_dup(0.0), p_h);
+  p_l = v_sel(range, v_dup(0.0), p_l);
+  z = v_sel(range, v_dup(0.0), z);
+
+  // 2^(p_h + p_l) = 2^m * 2^(p_h - m + p_l), where m is z rounded to an integer. p_h has few
+  // enough bits that p_h - m is exact.
+  v_f64 m = z + V_SHIFT;
+  v_u64 scale = (v_u64)m << 52;
+  p_h -= m - V_SHIFT;
+  v_f64 t = (v_f64)((v_u64)(p_l + p_h) & 0xffffffff00000000ULL);
+  u = t * 6.93147182464599609375e-01;
+  v = (p_l - (t - p_h)) * 6.93147180559945286227e-01 + t * -1.90465429995776804525e-09;
+  z = u + v;
+  v_f64 w = v - (z - u);
+  t = z * z;
+  t1 = z - t * (1.66666666666666019037e-01 +
+                t * (-2.77777777770155933842e-03 +
+                     t * (6.61375632143793436117e-05 +
+                          t * (-1.65339022054652515390e-06 + t * 4.13813679705723846039e-08))));
+  r = (z * t1) / (t1 - 2.0) - (w + z * w);
+  z = 1.0 - (r - z);
+  v_f64 result = (v_f64)((v_u64)z + scale);
+
+  // Like pow(), get these exactly right. Only the lanes that need it divide by or square x, so
+  // that the others can't raise a spurious overflow or underflow.
+  result = v_sel((v_s64)(ys == 1.0), xs, result);
+  v_s64 recip = (v_s64)(ys == -1.0);
+  result = v_sel(recip, 1.0 / v_sel(recip, xs, v_dup(1.0)), result);
+  v_s64 square = (v_s64)(ys == 2.0);
+  v_f64 xx = v_sel(square, xs, v_dup(1.0));
+  result = v_sel(square, xx * xx, result);
+  if (__predict_false(v_any(special))) return v_call_f64_f64(pow, x, y, result, special);
+  return result;
+}
+
+// sin and cos reduce x to r = x - n*pi/2 with |r| <= pi/4 as the medium-sized case of
+// e_rem_pio2.c does, keeping the tail of r in r_tail, and use the polynomials from k_sin.c and
+// k_cos.c. The quadrant n mod 4 picks the polynomial and the sign. Anything large enough, or
+// close enough to a multiple of pi/2, to need the slower reductions goes to sin() or cos().
+static __always_inline v_f64 v_sin_or_cos(v_f64 x, int is_cos) {
+  v_u64 ia = (v_u64)x & V_ABS_MASK;
+  // |x| >= 2^20*(pi/2), Inf or NaN.
+  v_s64 special = v_top_ge(ia, 0x413921fb);
+  // |x| < 2^-27, when sin(x) is x and cos(x) is 1.
+  v_s64 tiny = v_top_lt(ia, 0x3e400000);
+  v_f64 xs = v_sel(special | tiny, v_dup(0.0), x);
+
+  v_f64 fn = xs * 0x1.45f306dc9c883p-1 + V_SHIFT;
+  v_u64 q = (v_u64)fn + (is_cos ? 1 : 0);
+  fn = fn - V_SHIFT;
+  v_f64 r0 = xs - fn * 0x1.921fb54400000p+0;
+  v_f64 w = fn * 0x1.0b4611a626331p-34;
+  v_f64 r = r0 - w;
+  v_f64 r_tail = (r0 - r) - w;
+  // Too much cancellation for one round of reduction: e_rem_pio2.c does another if r's exponent
+  // is more than 16 below x's, and this catches at least those.
+  special |= (v_s64)((v_f64)((v_u64)r & V_ABS_MASK) * 0x1p16 < (v_f64)((v_u64)xs & V_ABS_MASK));
+
+  v_f64 z = r * r;
+  w = z * z;
+  v_f64 v = z * r;
+  v_f64 rs = 0x1.111111110f8a6p-7 + z * (-0x1.a01a019c161d5p-13 + z * 0x1.71de357b1fe7dp-19) +
+             z * w * (-0x1.ae5e68a2b9cebp-26 + z * 0x1.5d93a5acfd57cp-33);
+  v_f64 s = r - ((z * (0.5 * r_tail - v * rs) - r_tail) - v * -0x1.5555555555549p-3);
+  v_f64 rc = z * (0x1.555555555554cp-5 + z * (-0x1.6c16c16c15177p-10 + z * 0x1.a01a019cb1590p-16)) +
+             w * w * (-0x1.27e4f809c52adp-22 +
+                      z * (0x1.1ee9ebdb4b1c4p-29 + z * -0x1.8fae9be8838d4p-37));
+  v_f64 hz = 0.5 * z;
+  w = 1.0 - hz;
+  v_f64 c = w + (((1.0 - w) - hz) + (z * rc - r * r_tail));
+
+  v_f64 y = v_sel(-(v_s64)(q & 1), c, s);
+  y = (v_f64)((v_u64)y ^ ((q & 2) << 62));
+  y = v_sel(tiny, is_cos ? v_dup(1.0) : x, y);
+  if (__predict_false(v_any(special))) return v_call_f64(is_cos ? cos : sin, x, y, special);
+  return y;
+}
+
+V_ABI v_f64 V_NAME_F64(sin)(v_f64 x) {
+  return v_sin_or_cos(x, 0);
+}
+
+V_ABI v_f64 V_NAME_F64(cos)(v_f64 x) {
+  return v_sin_or_cos(x, 1);
+}
+
+#endif  // V_NAME_F64
+
+// 2^t for |t| < 1022, within 2^-33 of it: 2^n from the exponent bits and 2^r, |r| <= 1/2, from a
+// degree 7 polynomial.
+static inline v_f64w v_exp2w(v_f64w t) {
+  v_f64w z = t + V_SHIFT;
+  v_f64w r = t - (z - V_SHIFT);
+  v_f64w r2 = r * r;
+  v_f64w q = (0x1.62e42fefa39efp-1 + 0x1.ebfbe0466cb1ep-3 * r) +
+             r2 * ((0x1.c6b08d8862b20p-5 + 0x1.3b2a1ad1a32b5p-7 * r) +
+                   r2 * (0x1.5d879e4ab263ep-10 + 0x1.44409f532de58p-13 * r +
+                         r2 * 0x1.00a5e3961a5a2p-16));
+  v_f64w scale = (v_f64w)(((v_u64w)z << 52) + 0x3ff0000000000000ULL);
+  return scale + scale * r * q;
+}
+
+// log(x) for positive normal x, within 2^-50 of it: log(x) = k*ln2 + log(m), where x = 2^k * m
+// and sqrt(2)/2 <= m < sqrt(2), and log(m) = 2s + s^3 * p(s^2), where s = (m - 1)/(m + 1).
+static inline v_f64w v_logw(v_f64w x) {
+  v_u64w tmp = (v_u64w)x - 0x3fe6a09e667f3bcdULL;
+  v_f64w k = v_top12_to_f64w(tmp);
+  v_f64w m = (v_f64w)((v_u64w)x - (tmp & 0xfff0000000000000ULL));
+  v_f64w s = (m - 1.0) / (m + 1.0);
+  v_f64w z = s * s;
+  v_f64w z2 = z * z;
+  v_f64w p = (0x1.55555555553b6p-1 + 0x1.9999999b8964bp-2 * z) +
+             z2 * ((0x1.2492462757ac2p-2 + 0x1.c71fcfee6fd01p-3 * z) +
+                   z2 * (0x1.7382554d1fa9ep-3 + 0x1.547222fa60b57p-3 * z));
+  return k * 0x1.62e42fefa39efp-1 + (2.0 * s + s * z * p);
+}
+
+V_ABI v_f32 V_NAME_F32(expf)(v_f32 x) {
+  // |x| > 87 (so the result might overflow or be subnormal), or NaN.
+  v_s32 special = (v_s32)(((v_u32)x & V_ABS_MASK_F) > 0x42ae0000U);
+  v_f64w xd = __builtin_convertvector(v_self(special, v_dupf(0.0f), x), v_f64w);
+  v_f32 y = __builtin_convertvector(v_exp2w(xd * kInvLn2), v_f32);
+  if (__predict_false(v_anyf(special))) return v_call_f32(expf, x, y, special);
+  return y;
+}
+
+V_ABI v_f32 V_NAME_F32(logf)(v_f32 x) {
+  // Zero, negative, subnormal, Inf or NaN.
+  v_s32 special = (v_s32)((v_u32)x - 0x00800000U >= 0x7f000000U);
+  v_f64w xd = __builtin_convertvector(v_self(special, v_dupf(1.0f), x), v_f64w);
+  v_f32 y = __builtin_convertvector(v_logw(xd), v_f32);
+  if (__predict_false(v_anyf(special))) return v_call_f32(logf, x, y, special);
+  return y;
+}
+
+// 2^(y * log2(x)), all in double.
+V_ABI v_f32 V_NAME_F32_F32(powf)(v_f32 x, v_f32 y) {
+  // x zero, negative, subnormal, Inf or NaN, or y Inf or NaN.
+  v_s32 special = (v_s32)((v_u32)x - 0x00800000U >= 0x7f000000U) |
+                  (v_s32)(((v_u32)y & V_ABS_MASK_F) >= 0x7f800000U);
+  v_f64w xd = __builtin_convertvector(v_self(special, v_dupf(1.0f), x), v_f64w);
+  v_f64w yd = __builtin_convertvector(v_self(special, v_dupf(0.0f), y), v_f64w);
+
+  v_f64w t = yd * v_logw(xd) * kInvLn2;
+  // The result might overflow or be subnormal. This compares the top halves of t's lanes as a
+  // vector of 32-bit integers, because comparing a vector of double wider than the machine's gets
+  // done a lane at a time.
+  v_u32 t_top = __builtin_convertvector(((v_u64w)t & V_ABS_MASK) >> 32, v_u32);
+  v_s32 range = (v_s32)(t_top >= 0x405f8000U);
+  t = v_selw(__builtin_convertvector(range, v_s64w), (v_f64w){}, t);
+  special |= range;
+
+  v_f32 result = __builtin_convertvector(v_exp2w(t), v_f32);
+  if (__predict_false(v_anyf(special))) return v_call_f32_f32(powf, x, y, result, special);
+  return result;
+}
+
+// As for double, but reducing x as e_rem_pio2f.c does and with the polynomials from k_sinf.c
+// and k_cosf.c, evaluated in double.
+static __always_inline v_f32 v_sinf_or_cosf(v_f32 x, int is_cos) {
+  v_u32 ia = (v_u32)x & V_ABS_MASK_F;
+  // |x| >= 2^28*(pi/2), Inf or NaN.
+  v_s32 special = (v_s32)(ia >= 0x4dc90fdbU);
+  // |x| < 2^-12, when sinf(x) is x and cosf(x) is 1.
+  v_s32 tiny = (v_s32)(ia < 0x39800000U);
+  v_f64w xd = __builtin_convertvector(v_self(special | tiny, v_dupf(0.0f), x), v_f64w);
+
+  v_f64w fn = xd * 0x1.45f306dc9c883p-1 + V_SHIFT;
+  v_u64w q = (v_u64w)fn + (is_cos ? 1 : 0);
+  fn = fn - V_SHIFT;
+  v_f64w r = (xd - fn * 0x1.921fb50000000p+0) - fn * 0x1.110b4611a6263p-26;
+
+  v_f64w z = r * r;
+  v_f64w w = z * z;
+  v_f64w s = (r + z * r * (-0x1.5555554cbac77p-3 + z * 0x1.11110896efbb2p-7)) +
+             z * r * w * (-0x1.a00f9e2cae774p-13 + z * 0x1.6cd878c3b46a7p-19);
+  v_f64w c = ((1.0 + z * -0x1.ffffffd0c5e81p-2) + w * 0x1.55553e1053a42p-5) +
+             (w * z) * (-0x1.6c087e80f1e27p-10 + z * 0x1.99342e0ee5069p-16);
+
+  v_f64w yd = v_selw(-(v_s64w)(q & 1), c, s);
+  yd = (v_f64w)((v_u64w)yd ^ ((q & 2) << 62));
+  v_f32 y = __builtin_convertvector(yd, v_f32);
+  y = v_self(tiny, is_cos ? v_dupf(1.0f) : x, y);
+  if (__predict_false(v_anyf(special))) return v_call_f32(is_cos ? cosf : sinf, x, y, special);
+  return y;
+}
+
+V_ABI v_f32 V_NAME_F32(sinf)(v_f32 x) {
+  return v_sinf_or_cosf(x, 0);
+}
+
+V_ABI v_f32 V_NAME_F32(cosf)(v_f32 x) {
+  return v_sinf_or_cosf(x, 1);
+}
+
+#if defined(V_NAME_ARRAY)
+
+// The bulk versions, for files that define V_NAME_ARRAY(f) as the name of f's. Each whole vector
+// of the array goes through the vector variant; what's left at the end is padded out to one with
+// 1, which is in the usual range of every function here, and only its real lanes are stored.
+// Loading each vector before storing its results lets out be the same array as in.
+
+#define V_ARRAY(f, T, VT, V_NAME, LANES)                                             \
+  V_ARRAY_ABI void V_NAME_ARRAY(f)(const T* in, T* out, size_t n) {                  \
+    VT x, y;                                                                         \
+    for (; n >= LANES; n -= LANES, in += LANES, out += LANES) {                      \
+      __builtin_memcpy(&x, in, sizeof(x));                                           \
+      y = V_NAME(f)(x);                                                              \
+      __builtin_memcpy(out, &y, sizeof(y));                                          \
+    }                                                                                \
+    if (n != 0) {                                                                    \
+      x = (VT){} + (T)1;                                                             \
+      __builtin_memcpy(&x, in, n * sizeof(T));                                       \
+      y = V_NAME(f)(x);                                                              \
+      __builtin_memcpy(out, &y, n * sizeof(T));                                      \
+    }                                                                                \
+  }
+
+#define V_ARRAY2(f, T, VT, V_NAME, LANES)                                            \
+  V_ARRAY_ABI void V_NAME_ARRAY(f)(const T* in1, const T* in2, T* out, size_t n) {   \
+    VT x1, x2, y;                                                                    \
+    for (; n >= LANES; n -= LANES, in1 += LANES, in2 += LANES, out += LANES) {       \
+      __builtin_memcpy(&x1, in1, sizeof(x1));                                        \
+      __builtin_memcpy(&x2, in2, sizeof(x2));                                        \
+      y = V_NAME(f)(x1, x2);                                                         \
+      __builtin_memcpy(out, &y, sizeof(y));                                          \
+    }                                                                                \
+    if (n != 0) {                                                                    \
+      x1 = x2 = (VT){} + (T)1;                                                       \
+      __builtin_memcpy(&x1, in1, n * sizeof(T));                                     \
+      __builtin_memcpy(&x2, in2, n * sizeof(T));                                     \
+      y = V_NAME(f)(x1, x2);                                                         \
+      __builtin_memcpy(out, &y, n * sizeof(T));                                      \
+    }                                                                                \
+  }
+
+V_ARRAY(cos, double, v_f64, V_NAME_F64, V_F64_LANES)
+V_ARRAY(exp, double, v_f64, V_NAME_F64, V_F64_LANES)
+V_ARRAY(log, double, v_f64, V_NAME_F64, V_F64_LANES)
+V_ARRAY(sin, double, v_f64, V_NAME_F64, V_F64_LANES)
+V_ARRAY2(pow, double, v_f64, V_NAME_F64_F64, V_F64_LANES)
+V_ARRAY(cosf, float, v_f32, V_NAME_F32, V_F32_LANES)
+V_ARRAY(expf, float, v_f32, V_NAME_F32, V_F32_LANES)
+V_ARRAY(logf, float, v_f32, V_NAME_F32, V_F32_LANES)
+V_ARRAY(sinf, float, v_f32, V_NAME_F32, V_F32_LANES)
+V_ARRAY2(powf, float, v_f32, V_NAME_F32_F32, V_F32_LANES)
+
+#endif  // V_NAME_ARRAY
@@ -22,16 +22,48 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
+
+#include <atomic>
+
 #include <android/api-level.h>
+#include <android/libc_stats.h>
 
 #include <bionic/pthread_internal.h>
+#include "private/bionic_sections.h"
 #include "private/bionic_tls.h"
-#include "private/ScopedPthreadMutexLocker.h"
 #include "private/ThreadLocalBuffer.h"
 
 /* This file hijacks the symbols stubbed out in libdl.so. */
 
-static pthread_mutex_t g_dl_mutex = PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP;
+static pthread_mutex_t g_dl_mutex __BIONIC_FORK_WRITTEN = PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP;
+// The thread holding g_dl_mutex, if any, and how many times it has locked it.
+static std::atomic<pid_t> g_dl_mutex_owner __BIONIC_FORK_WRITTEN;
+static size_t g_dl_mutex_depth __BIONIC_FORK_WRITTEN;
+
+class DlMutexLocker {
+ public:
+  DlMutexLocker() {
+    pthread_mutex_lock(&g_dl_mutex);
+    if (g_dl_mutex_depth++ == 0) {
+      g_dl_mutex_owner.store(gettid(), std::memory_order_relaxed);
+    }
+  }
+
+  ~DlMutexLocker() {
+    if (--g_dl_mutex_depth == 0) {
+      g_dl_mutex_owner.store(0, std::memory_order_relaxed);
+    }
+    pthread_mutex_unlock(&g_dl_mutex);
+  }
+
+  static bool is_held_by_current_thread() {
+    return g_dl_mutex_owner.load(std::memory_order_relaxed) == gettid();
+  }
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(DlMutexLocker);
+};
 
 static char* __bionic_set_dlerror(char* new_value) {
   char** dlerror_slot = &reinterpret_cast<char**>(__get_tls())[TLS_SLOT_DLERROR];
@@ -58,24 +90,35 @@ char* dlerror() {
 }
 
 void android_get_LD_LIBRARY_PATH(char* buffer, size_t buffer_size) {
-  ScopedPthreadMutexLocker locker(&g_dl_mutex);
+  DlMutexLocker locker;
   do_android_get_LD_LIBRARY_PATH(buffer, buffer_size);
 }
 
 void android_update_LD_LIBRARY_PATH(const char* ld_library_path) {
-  ScopedPthreadMutexLocker locker(&g_dl_mutex);
+  DlMutexLocker locker;
   do_android_update_LD_LIBRARY_PATH(ld_library_path);
 }
 
 static void* dlopen_ext(const char* filename, int flags,
                         const android_dlextinfo* extinfo, void* caller_addr) {
-  ScopedPthreadMutexLocker locker(&g_dl_mutex);
-  g_linker_logger.ResetState();
-  void* result = do_dlopen(filename, flags, extinfo, caller_addr);
-  if (result == nullptr) {
-    __bionic_format_dlerror("dlopen failed", linker_get_error_buffer());
-    return nullptr;
+  void* result;
+  PendingConstructors* pending_constructors;
+  {
+    DlMutexLocker locker;
+    g_linker_logger.ResetState();
+    result = do_dlopen(filename, flags, extinfo, caller_addr, &pending_constructors);
+    if (result == nullptr) {
+      __bionic_format_dlerror("dlopen failed", linker_get_error_buffer());
+      return nullptr;
+    }
   }
+
+  // Constructors are called without the lock, which would otherwise hold up
+  // the dlsym() and dladdr() calls of all other threads while they run.
+  call_pending_constructors(pending_constructors, !DlMutexLocker::is_held_by_current_thread());
+
+  DlMutexLocker locker;
+  finish_pending_constructors(pending_constructors);
   return result;
 }
 
@@ -90,7 +133,7 @@ void* dlopen(const char* filename, int flags) {
 }
 
 void* dlsym_impl(void* handle, const char* symbol, const char* version, void* caller_addr) {
-  ScopedPthreadMutexLocker locker(&g_dl_mutex);
+  DlMutexLocker locker;
   g_linker_logger.ResetState();
   void* result;
   if (!do_dlsym(handle, symbol, version, caller_addr, &result)) {
@@ -111,13 +154,24 @@ void* dlvsym(void* handle, const char* symbol, const char* version) {
   return dlsym_impl(handle, symbol, version, caller_addr);
 }
 
+// Called by __linker_lazy_bind_trampoline (see arch/*/lazy_bind.S).
+extern "C" ElfW(Addr) __linker_lazy_bind(soinfo* si, size_t reloc_index) {
+  DlMutexLocker locker;
+  return do_lazy_bind(si, reloc_index);
+}
+
 int dladdr(const void* addr, Dl_info* info) {
-  ScopedPthreadMutexLocker locker(&g_dl_mutex);
+  int result;
+  if (try_dladdr_without_lock(addr, info, &result)) {
+    return result;
+  }
+
+  DlMutexLocker locker;
   return do_dladdr(addr, info);
 }
 
 int dlclose(void* handle) {
-  ScopedPthreadMutexLocker locker(&g_dl_mutex);
+  DlMutexLocker locker;
   int result = do_dlclose(handle);
   if (result != 0) {
     __bionic_format_dlerror("dlclose failed", linker_get_error_buffer());
@@ -126,13 +180,28 @@ int dlclose(void* handle) {
 }
 
 int dl_iterate_phdr(int (*cb)(dl_phdr_info* info, size_t size, void* data), void* data) {
-  ScopedPthreadMutexLocker locker(&g_dl_mutex);
+  DlMutexLocker locker;
   return do_dl_iterate_phdr(cb, data);
 }
 
+const android_dl_phdr_snapshot* android_get_dl_phdr_snapshot() {
+  const android_dl_phdr_snapshot* snapshot = get_published_dl_phdr_snapshot();
+  if (snapshot != nullptr) {
+    return snapshot;
+  }
+
+  DlMutexLocker locker;
+  return do_get_dl_phdr_snapshot();
+}
+
+void android_linker_stats_iterate(void (*callback)(const android_libc_stat*, void*), void* arg) {
+  DlMutexLocker locker;
+  do_android_linker_stats_iterate(callback, arg);
+}
+
 void android_set_application_target_sdk_version(uint32_t target) {
   // lock to avoid modification in the middle of dlopen.
-  ScopedPthreadMutexLocker locker(&g_dl_mutex);
+  DlMutexLocker locker;
   set_application_target_sdk_version(target);
 }
 
@@ -141,13 +210,13 @@ uint32_t android_get_application_target_sdk_version() {
 }
 
 void android_dlwarning(void* obj, void (*f)(void*, const char*)) {
-  ScopedPthreadMutexLocker locker(&g_dl_mutex);
+  DlMutexLocker locker;
   get_dlwarning(obj, f);
 }
 
 bool android_init_namespaces(const char* public_ns_sonames,
                              const char* anon_ns_library_path) {
-  ScopedPthreadMutexLocker locker(&g_dl_mutex);
+  DlMutexLocker locker;
   bool success = init_namespaces(public_ns_sonames, anon_ns_library_path);
   if (!success) {
     __bionic_format_dlerror("android_init_namespaces failed", linker_get_error_buffer());
@@ -163,7 +232,7 @@ android_namespace_t* android_create_namespace(const char* name,
                                               const char* permitted_when_isolated_path,
                                               android_namespace_t* parent_namespace) {
   void* caller_addr = __builtin_return_address(0);
-  ScopedPthreadMutexLocker locker(&g_dl_mutex);
+  DlMutexLocker locker;
 
   android_namespace_t* result = create_namespace(caller_addr,
                                                  name,
@@ -209,8 +278,16 @@ static const char ANDROID_LIBDL_STRTAB[] =
   // 0000000000111111 111122222222223333333333 4444444444555555555566666 6666677 777777778888888888
   // 0123456789012345 678901234567890123456789 0123456789012345678901234 5678901 234567890123456789
     "get_sdk_version\0android_init_namespaces\0android_create_namespace\0dlvsym\0android_dlwarning\0"
+  // 2222222222222222222222222222233333333333
+  // 9999999999111111111122222222220000000000
+  // 0123456789012345678901234567890123456789
+    "android_get_dl_phdr_snapshot\0"
+  // 33333333333333333333333333333
+  // 12222222222333333333344444444
+  // 90123456789012345678901234567
+    "android_linker_stats_iterate\0"
 #if defined(__arm__)
-  // 290
+  // 348
     "dl_unwind_find_exidx\0"
 #endif
     ;
@@ -236,8 +313,10 @@ static ElfW(Sym) g_libdl_symtab[] = {
   ELFW(SYM_INITIALIZER)(240, &android_create_namespace, 1),
   ELFW(SYM_INITIALIZER)(265, &dlvsym, 1),
   ELFW(SYM_INITIALIZER)(272, &android_dlwarning, 1),
+  ELFW(SYM_INITIALIZER)(290, &android_get_dl_phdr_snapshot, 1),
+  ELFW(SYM_INITIALIZER)(319, &android_linker_stats_iterate, 1),
 #if defined(__arm__)
-  ELFW(SYM_INITIALIZER)(290, &dl_unwind_find_exidx, 1),
+  ELFW(SYM_INITIALIZER)(348, &dl_unwind_find_exidx, 1),
 #endif
 };
 
@@ -254,9 +333,9 @@ static ElfW(Sym) g_libdl_symtab[] = {
 // Note that adding any new symbols here requires stubbing them out in libdl.
 static unsigned g_libdl_buckets[1] = { 1 };
 #if defined(__arm__)
-static unsigned g_libdl_chains[] = { 0, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 0 };
+static unsigned g_libdl_chains[] = { 0, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 0 };
 #else
-static unsigned g_libdl_chains[] = { 0, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 0 };
+static unsigned g_libdl_chains[] = { 0, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 0 };
 #endif
 
 static uint8_t __libdl_info_buf[sizeof(soinfo)] __attribute__((aligned(8)));
@@ -27,39 +27,53 @@
  */
 
 #include <android/api-level.h>
+#include <android/libc_stats.h>
 #include <errno.h>
 #include <fcntl.h>
 #include <inttypes.h>
 #include <pthread.h>
+#include <sched.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/auxv.h>
 #include <sys/mman.h>
 #include <sys/param.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <atomic>
 #include <new>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
 // Private C library headers.
+#include "private/ErrnoRestorer.h"
 #include "private/KernelArgumentBlock.h"
+#include "private/bionic_elf_tls.h"
+#include "private/bionic_prctl.h"
 #include "private/ScopedPthreadMutexLocker.h"
 #include "private/ScopeGuard.h"
 
 #include "linker.h"
 #include "linker_block_allocator.h"
+#include "linker_boot_image.h"
 #include "linker_gdb_support.h"
 #include "linker_globals.h"
+#include "linker_group_varint.h"
 #include "linker_debug.h"
 #include "linker_dlwarning.h"
 #include "linker_main.h"
 #include "linker_namespaces.h"
+#include "linker_path_cache.h"
 #include "linker_sleb128.h"
 #include "linker_phdr.h"
+#include "linker_profile.h"
 #include "linker_relocs.h"
 #include "linker_reloc_iterators.h"
+#include "linker_relro_store.h"
+#include "linker_symbol_cache.h"
 #include "linker_utils.h"
 
 #include "android-base/strings.h"
@@ -188,20 +202,31 @@ static std::vector<std::string> g_ld_preload_names;
 static bool g_public_namespace_initialized;
 static soinfo_list_t g_public_namespace;
 
-#if STATS
 struct linker_stats_t {
   int count[kRelocMax];
 };
 
+// Always kept, for android_linker_stats_iterate: it's one add per relocation.
 static linker_stats_t linker_stats;
 
 void count_relocation(RelocationKind kind) {
   ++linker_stats.count[kind];
 }
-#else
-void count_relocation(RelocationKind) {
+
+void do_android_linker_stats_iterate(void (*callback)(const android_libc_stat*, void*),
+                                     void* arg) {
+  static const char* const kRelocationNames[kRelocMax] = {
+    "linker.relocations.absolute",
+    "linker.relocations.relative",
+    "linker.relocations.copy",
+    "linker.relocations.symbol",
+  };
+  for (int i = 0; i < kRelocMax; ++i) {
+    android_libc_stat stat = { kRelocationNames[i], ANDROID_LIBC_STAT_COUNTER,
+                               static_cast<uint64_t>(linker_stats.count[i]), 0, nullptr, nullptr };
+    callback(&stat, arg);
+  }
 }
-#endif
 
 #if COUNT_PAGES
 uint32_t bitmask[4096];
@@ -274,6 +299,9 @@ static void soinfo_free(soinfo* si) {
   }
 
   if (si->base != 0 && si->size != 0) {
+    // Readers of the published address index may be looking at si.
+    retract_address_index();
+
     if (!si->is_mapped_by_caller()) {
       munmap(reinterpret_cast<void*>(si->base), si->size);
     } else {
@@ -323,6 +351,106 @@ static bool realpath_fd(int fd, std::string* realpath) {
   return true;
 }
 
+// The mapped soinfos sorted by base address, for find_containing_library().
+// Rebuilt on the next lookup after a library is added, removed or mapped.
+static std::vector<soinfo*> g_address_index;
+static bool g_address_index_is_valid = false;
+
+// A copy of g_address_index for readers that do not hold the linker lock.
+// A published copy is never modified. Readers announce themselves in
+// g_address_index_readers before loading the pointer, and a copy is only
+// deleted, and a library only unmapped, once there are no readers left.
+// is_current is cleared as soon as the copy may be missing a library.
+static std::atomic<std::vector<soinfo*>*> g_published_address_index;
+static std::atomic<bool> g_published_address_index_is_current;
+static std::atomic<size_t> g_address_index_readers;
+
+class AddressIndexReader {
+ public:
+  AddressIndexReader() {
+    g_address_index_readers.fetch_add(1);
+    index_ = g_published_address_index.load();
+    is_current_ = g_published_address_index_is_current.load();
+  }
+
+  ~AddressIndexReader() {
+    g_address_index_readers.fetch_sub(1);
+  }
+
+  const std::vector<soinfo*>* index() const { return index_; }
+  bool is_current() const { return is_current_; }
+
+ private:
+  const std::vector<soinfo*>* index_;
+  bool is_current_;
+
+  DISALLOW_COPY_AND_ASSIGN(AddressIndexReader);
+};
+
+static void publish_address_index(std::vector<soinfo*>* index) {
+  std::vector<soinfo*>* old_index = g_published_address_index.exchange(index);
+  if (old_index != nullptr) {
+    while (g_address_index_readers.load() != 0) {
+      sched_yield();
+    }
+    delete old_index;
+  }
+}
+
+void invalidate_address_index() {
+  g_address_index_is_valid = false;
+  g_published_address_index_is_current.store(false);
+}
+
+void retract_address_index() {
+  invalidate_address_index();
+  publish_address_index(nullptr);
+}
+
+static void update_address_index() {
+  if (g_address_index_is_valid) {
+    return;
+  }
+
+  g_address_index.clear();
+  for (soinfo* si = solist_get_head(); si != nullptr; si = si->next) {
+    if (si->size != 0) {
+      g_address_index.push_back(si);
+    }
+  }
+  std::sort(g_address_index.begin(), g_address_index.end(), [](soinfo* a, soinfo* b) {
+    return a->base < b->base;
+  });
+  g_address_index_is_valid = true;
+
+  publish_address_index(new std::vector<soinfo*>(g_address_index));
+  g_published_address_index_is_current.store(true);
+}
+
+static soinfo* find_in_address_index(const std::vector<soinfo*>& index, const void* p) {
+  // Libraries do not overlap, so only the last one starting at or below
+  // the address can contain it.
+  ElfW(Addr) address = reinterpret_cast<ElfW(Addr)>(p);
+  auto it = std::upper_bound(index.begin(), index.end(), address,
+                             [](ElfW(Addr) address, soinfo* si) {
+                               return address < si->base;
+                             });
+  if (it == index.begin()) {
+    return nullptr;
+  }
+
+  soinfo* si = *(it - 1);
+  if (address - si->base < si->size) {
+    return si;
+  }
+  return nullptr;
+}
+
+soinfo* find_containing_library(const void* p) {
+  update_address_index();
+  return find_in_address_index(g_address_index, p);
+}
+
 #if defined(__arm__)
 
 // For a given PC, find the .so that it belongs to.
@@ -336,6 +464,15 @@ static bool realpath_fd(int fd, std::string* realpath) {
 _Unwind_Ptr dl_unwind_find_exidx(_Unwind_Ptr pc, int* pcount) {
   uintptr_t addr = reinterpret_cast<uintptr_t>(pc);
 
+  AddressIndexReader reader;
+  if (reader.index() != nullptr) {
+    soinfo* si = find_in_address_index(*reader.index(), pc);
+    if (si != nullptr || reader.is_current()) {
+      *pcount = si != nullptr ? si->ARM_exidx_count : 0;
+      return si != nullptr ? reinterpret_cast<_Unwind_Ptr>(si->ARM_exidx) : nullptr;
+    }
+  }
+
   for (soinfo* si = solist_get_head(); si != 0; si = si->next) {
     if ((addr >= si->base) && (addr < (si->base + si->size))) {
         *pcount = si->ARM_exidx_count;
@@ -350,14 +487,23 @@ _Unwind_Ptr dl_unwind_find_exidx(_Unwind_Ptr pc, int* pcount) {
 
 // Here, we only have to provide a callback to iterate across all the
 // loaded libraries. gcc_eh does the rest.
+static void get_dl_phdr_info(const soinfo* si, dl_phdr_info* dl_info) {
+  dl_info->dlpi_addr = si->link_map_head.l_addr;
+  dl_info->dlpi_name = si->link_map_head.l_name;
+  dl_info->dlpi_phdr = si->phdr;
+  dl_info->dlpi_phnum = si->phnum;
+  dl_info->dlpi_adds = solist_get_adds();
+  dl_info->dlpi_subs = solist_get_subs();
+  dl_info->dlpi_tls_modid = si->get_tls_module_id();
+  dl_info->dlpi_tls_data = (dl_info->dlpi_tls_modid == 0) ? nullptr :
+                           __get_dynamic_tls_block(dl_info->dlpi_tls_modid);
+}
+
 int do_dl_iterate_phdr(int (*cb)(dl_phdr_info* info, size_t size, void* data), void* data) {
   int rv = 0;
   for (soinfo* si = solist_get_head(); si != nullptr; si = si->next) {
     dl_phdr_info dl_info;
-    dl_info.dlpi_addr = si->link_map_head.l_addr;
-    dl_info.dlpi_name = si->link_map_head.l_name;
-    dl_info.dlpi_phdr = si->phdr;
-    dl_info.dlpi_phnum = si->phnum;
+    get_dl_phdr_info(si, &dl_info);
     rv = cb(&dl_info, sizeof(dl_phdr_info), data);
     if (rv != 0) {
       break;
@@ -366,6 +512,72 @@ int do_dl_iterate_phdr(int (*cb)(dl_phdr_info* info, size_t size, void* data), v
   return rv;
 }
 
+// The snapshot returned by android_get_dl_phdr_snapshot(); reset whenever
+// the solist changes. Retired snapshots are never unmapped because readers
+// do not take the linker lock and may still be using them.
+static std::atomic<const android_dl_phdr_snapshot*> g_dl_phdr_snapshot;
+
+void invalidate_dl_phdr_snapshot() {
+  g_dl_phdr_snapshot.store(nullptr, std::memory_order_release);
+}
+
+const android_dl_phdr_snapshot* get_published_dl_phdr_snapshot() {
+  return g_dl_phdr_snapshot.load(std::memory_order_acquire);
+}
+
+const android_dl_phdr_snapshot* do_get_dl_phdr_snapshot() {
+  const android_dl_phdr_snapshot* published = get_published_dl_phdr_snapshot();
+  if (published != nullptr) {
+    return published;
+  }
+
+  // The snapshot, its dl_phdr_info array and a copy of the names are
+  // placed in a single read-only mapping.
+  size_t count = 0;
+  size_t names_size = 0;
+  for (soinfo* si = solist_get_head(); si != nullptr; si = si->next) {
+    ++count;
+    if (si->link_map_head.l_name != nullptr) {
+      names_size += strlen(si->link_map_head.l_name) + 1;
+    }
+  }
+
+  size_t size = PAGE_END(sizeof(android_dl_phdr_snapshot) + count * sizeof(dl_phdr_info) +
+                         names_size);
+  void* map = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (map == MAP_FAILED) {
+    return nullptr;
+  }
+
+  android_dl_phdr_snapshot* snapshot = reinterpret_cast<android_dl_phdr_snapshot*>(map);
+  dl_phdr_info* infos = reinterpret_cast<dl_phdr_info*>(snapshot + 1);
+  char* names = reinterpret_cast<char*>(infos + count);
+
+  size_t i = 0;
+  for (soinfo* si = solist_get_head(); si != nullptr; si = si->next, ++i) {
+    get_dl_phdr_info(si, &infos[i]);
+    // The snapshot is shared by all threads.
+    infos[i].dlpi_tls_data = nullptr;
+    if (infos[i].dlpi_name != nullptr) {
+      size_t name_size = strlen(infos[i].dlpi_name) + 1;
+      memcpy(names, infos[i].dlpi_name, name_size);
+      infos[i].dlpi_name = names;
+      names += name_size;
+    }
+  }
+
+  snapshot->dlpi_adds = solist_get_adds();
+  snapshot->dlpi_subs = solist_get_subs();
+  snapshot->count = count;
+  snapshot->infos = infos;
+
+  mprotect(map, size, PROT_READ);
+  prctl(PR_SET_VMA, PR_SET_VMA_ANON_NAME, map, size, "dl_phdr snapshot");
+
+  g_dl_phdr_snapshot.store(snapshot, std::memory_order_release);
+  return snapshot;
+}
+
 
 bool soinfo_do_lookup(soinfo* si_from, const char* name, const version_info* vi,
                       soinfo** si_found_in, const soinfo_list_t& global_group,
@@ -516,6 +728,22 @@ class TypeBasedAllocator {
   }
 };
 
+// Set by LD_READAHEAD.
+static ReadaheadMode g_readahead_mode = kReadaheadNone;
+
+void set_readahead_mode(ReadaheadMode mode) {
+  g_readahead_mode = mode;
+}
+
+// Starts asynchronous readahead of [offset, offset + length) of a library
+// file so that the I/O overlaps with work on the other libraries.
+static void readahead_library(int fd, off64_t offset, off64_t length, const char* name) {
+  int error = posix_fadvise64(fd, offset, length, POSIX_FADV_WILLNEED);
+  if (error != 0) {
+    DEBUG("readahead of \"%s\" failed: %s", name, strerror(error));
+  }
+}
+
 class LoadTask {
  public:
   struct deleter_t {
@@ -603,12 +831,22 @@ class LoadTask {
 
   bool load() {
     ElfReader& elf_reader = get_elf_reader();
-    if (!elf_reader.Load(extinfo_)) {
+    bool huge_page_align =
+        (extinfo_ != nullptr && (extinfo_->flags & ANDROID_DLEXT_HUGE_PAGE_ALIGN) != 0) ||
+        si_->get_primary_namespace()->is_huge_page_aligned();
+    elf_reader.set_preferred_load_start(boot_image_get_load_start(si_->get_realpath()));
+    if (!elf_reader.Load(extinfo_, huge_page_align)) {
       return false;
     }
 
+    if (g_readahead_mode == kReadaheadText) {
+      phdr_table_advise_text(elf_reader.loaded_phdr(), elf_reader.phdr_count(),
+                             elf_reader.load_bias(), MADV_WILLNEED);
+    }
+
     si_->base = elf_reader.load_start();
     si_->size = elf_reader.load_size();
+    invalidate_address_index();
     si_->set_mapped_by_caller(elf_reader.is_mapped_by_caller());
     si_->load_bias = elf_reader.load_bias();
     si_->phnum = elf_reader.phdr_count();
@@ -746,6 +984,96 @@ static const ElfW(Sym)* dlsym_handle_lookup(soinfo* si, soinfo** found,
   return dlsym_handle_lookup(si, nullptr, found, symbol_name, vi);
 }
 
+// Memoizes the result of the global group scan in dlsym(RTLD_DEFAULT, ...).
+// Namespaces live in write-protected memory, so instead of hanging a cache
+// off each android_namespace_t this is a single direct-mapped table keyed by
+// (namespace, name, version). Entries are valid only for the generation they
+// were added in; do_dlopen() and do_dlclose() bump the generation whenever
+// the set of loaded libraries (or their flags) may change.
+struct DlsymCacheEntry {
+  size_t generation;
+  const android_namespace_t* ns;
+  uint32_t hash;
+  uint32_t version_hash;
+  // "name\0version\0", allocated with malloc.
+  char* key;
+  soinfo* found;
+  const ElfW(Sym)* symbol;
+};
+
+static constexpr size_t kDlsymCacheSize = 256;
+static DlsymCacheEntry g_dlsym_cache[kDlsymCacheSize];
+static size_t g_dlsym_cache_generation = 1;
+
+static void invalidate_dlsym_cache() {
+  ++g_dlsym_cache_generation;
+}
+
+static DlsymCacheEntry* dlsym_cache_slot(const android_namespace_t* ns,
+                                         SymbolName& symbol_name,
+                                         const version_info* vi) {
+  uint32_t hash = symbol_name.gnu_hash();
+  uint32_t version_hash = vi == nullptr ? 0 : vi->elf_hash;
+  size_t index = (hash ^ (version_hash * 31) ^ (reinterpret_cast<uintptr_t>(ns) >> 4)) &
+                 (kDlsymCacheSize - 1);
+  return &g_dlsym_cache[index];
+}
+
+static bool dlsym_cache_lookup(const android_namespace_t* ns,
+                               SymbolName& symbol_name,
+                               const version_info* vi,
+                               soinfo** found,
+                               const ElfW(Sym)** symbol) {
+  DlsymCacheEntry* entry = dlsym_cache_slot(ns, symbol_name, vi);
+  if (entry->generation != g_dlsym_cache_generation ||
+      entry->ns != ns ||
+      entry->hash != symbol_name.gnu_hash() ||
+      entry->version_hash != (vi == nullptr ? 0 : vi->elf_hash) ||
+      strcmp(entry->key, symbol_name.get_name()) != 0) {
+    return false;
+  }
+
+  const char* version = entry->key + strlen(entry->key) + 1;
+  if (vi != nullptr && strcmp(version, vi->name) != 0) {
+    return false;
+  }
+
+  if (entry->symbol != nullptr) {
+    *found = entry->found;
+  }
+  *symbol = entry->symbol;
+  return true;
+}
+
+static void dlsym_cache_insert(const android_namespace_t* ns,
+                               SymbolName& symbol_name,
+                               const version_info* vi,
+                               soinfo* found,
+                               const ElfW(Sym)* symbol) {
+  const char* name = symbol_name.get_name();
+  const char* version = vi == nullptr ? "" : vi->name;
+  size_t name_len = strlen(name);
+  size_t version_len = strlen(version);
+
+  char* key = static_cast<char*>(malloc(name_len + version_len + 2));
+  if (key == nullptr) {
+    return;
+  }
+  memcpy(key, name, name_len + 1);
+  memcpy(key + name_len + 1, version, version_len + 1);
+
+  DlsymCacheEntry* entry = dlsym_cache_slot(ns, symbol_name, vi);
+  free(entry->key);
+
+  entry->generation = g_dlsym_cache_generation;
+  entry->ns = ns;
+  entry->hash = symbol_name.gnu_hash();
+  entry->version_hash = vi == nullptr ? 0 : vi->elf_hash;
+  entry->key = key;
+  entry->found = found;
+  entry->symbol = symbol;
+}
+
 /* This is used by dlsym(3) to performs a global symbol lookup. If the
    start value is null (for RTLD_DEFAULT), the search starts at the
    beginning of the global solist. Otherwise the search starts at the
@@ -773,22 +1101,30 @@ static const ElfW(Sym)* dlsym_linear_lookup(android_namespace_t* ns,
   }
 
   const ElfW(Sym)* s = nullptr;
-  for (auto it = start, end = soinfo_list.end(); it != end; ++it) {
-    soinfo* si = *it;
-    // Do not skip RTLD_LOCAL libraries in dlsym(RTLD_DEFAULT, ...)
-    // if the library is opened by application with target api level <= 22
-    // See http://b/21565766
-    if ((si->get_rtld_flags() & RTLD_GLOBAL) == 0 && si->get_target_sdk_version() > 22) {
-      continue;
-    }
+  // The result of the global scan for RTLD_DEFAULT does not depend on the caller.
+  bool use_cache = handle == RTLD_DEFAULT;
+  if (!use_cache || !dlsym_cache_lookup(ns, symbol_name, vi, found, &s)) {
+    for (auto it = start, end = soinfo_list.end(); it != end; ++it) {
+      soinfo* si = *it;
+      // Do not skip RTLD_LOCAL libraries in dlsym(RTLD_DEFAULT, ...)
+      // if the library is opened by application with target api level <= 22
+      // See http://b/21565766
+      if ((si->get_rtld_flags() & RTLD_GLOBAL) == 0 && si->get_target_sdk_version() > 22) {
+        continue;
+      }
 
-    if (!si->find_symbol_by_name(symbol_name, vi, &s)) {
-      return nullptr;
+      if (!si->find_symbol_by_name(symbol_name, vi, &s)) {
+        return nullptr;
+      }
+
+      if (s != nullptr) {
+        *found = si;
+        break;
+      }
     }
 
-    if (s != nullptr) {
-      *found = si;
-      break;
+    if (use_cache) {
+      dlsym_cache_insert(ns, symbol_name, vi, s != nullptr ? *found : nullptr, s);
     }
   }
 
@@ -809,57 +1145,113 @@ static const ElfW(Sym)* dlsym_linear_lookup(android_namespace_t* ns,
   return s;
 }
 
-soinfo* find_containing_library(const void* p) {
-  ElfW(Addr) address = reinterpret_cast<ElfW(Addr)>(p);
-  for (soinfo* si = solist_get_head(); si != nullptr; si = si->next) {
-    if (address >= si->base && address - si->base < si->size) {
-      return si;
-    }
-  }
-  return nullptr;
-}
-
+// Keeps, for the lifetime of the process, an index of the entries of every
+// zip file a library was looked up in, so that loading another library from
+// the same zip file does not have to map and search its central directory.
+// Only entries that can be loaded (stored and page aligned) are indexed.
+// An index is rebuilt when the zip file on disk changes.
 class ZipArchiveCache {
  public:
   ZipArchiveCache() {}
-  ~ZipArchiveCache();
 
-  bool get_or_open(const char* zip_path, ZipArchiveHandle* handle);
+  // Looks up entry_name in the zip file at zip_path, which the caller has
+  // open as fd; returns false if there is no loadable entry with that name.
+  bool find_entry(const char* zip_path, int fd, const char* entry_name, off64_t* offset);
  private:
   DISALLOW_COPY_AND_ASSIGN(ZipArchiveCache);
 
-  std::unordered_map<std::string, ZipArchiveHandle> cache_;
-};
+  struct ZipIndex {
+    dev_t st_dev;
+    ino_t st_ino;
+    off64_t st_size;
+    timespec st_mtim;
+    std::unordered_map<std::string, off64_t> entries;
+  };
 
-bool ZipArchiveCache::get_or_open(const char* zip_path, ZipArchiveHandle* handle) {
-  std::string key(zip_path);
+  static bool build_index(const char* zip_path, ZipIndex* index);
 
-  auto it = cache_.find(key);
-  if (it != cache_.end()) {
-    *handle = it->second;
-    return true;
-  }
+  std::unordered_map<std::string, ZipIndex> cache_;
+};
 
+static ZipArchiveCache g_zip_archive_cache;
+
+bool ZipArchiveCache::build_index(const char* zip_path, ZipIndex* index) {
   int fd = TEMP_FAILURE_RETRY(open(zip_path, O_RDONLY | O_CLOEXEC));
   if (fd == -1) {
     return false;
   }
 
-  if (OpenArchiveFd(fd, "", handle) != 0) {
+  // OpenArchiveFd() takes ownership of fd.
+  ZipArchiveHandle handle;
+  if (OpenArchiveFd(fd, "", &handle) != 0) {
     // invalid zip-file (?)
     CloseArchive(handle);
-    close(fd);
     return false;
   }
 
-  cache_[key] = *handle;
-  return true;
+  void* cookie;
+  if (StartIteration(handle, &cookie, nullptr, nullptr) != 0) {
+    CloseArchive(handle);
+    return false;
+  }
+
+  ZipEntry entry;
+  ZipString name;
+  int32_t result;
+  while ((result = Next(cookie, &entry, &name)) == 0) {
+    if (entry.method == kCompressStored && (entry.offset % PAGE_SIZE) == 0) {
+      std::string entry_name(reinterpret_cast<const char*>(name.name), name.name_length);
+      index->entries[entry_name] = entry.offset;
+    }
+  }
+
+  EndIteration(cookie);
+  CloseArchive(handle);
+
+  // -1 means the end of the central directory was reached.
+  return result == -1;
 }
 
-ZipArchiveCache::~ZipArchiveCache() {
-  for (const auto& it : cache_) {
-    CloseArchive(it.second);
+bool ZipArchiveCache::find_entry(const char* zip_path, int fd, const char* entry_name,
+                                 off64_t* offset) {
+  struct stat file_stat;
+  if (TEMP_FAILURE_RETRY(fstat(fd, &file_stat)) != 0) {
+    return false;
+  }
+
+  std::string key(zip_path);
+  auto it = cache_.find(key);
+  if (it != cache_.end()) {
+    const ZipIndex& index = it->second;
+    if (index.st_dev != file_stat.st_dev || index.st_ino != file_stat.st_ino ||
+        index.st_size != file_stat.st_size ||
+        index.st_mtim.tv_sec != file_stat.st_mtim.tv_sec ||
+        index.st_mtim.tv_nsec != file_stat.st_mtim.tv_nsec) {
+      TRACE("zip file \"%s\" has changed - rebuilding its index", zip_path);
+      cache_.erase(it);
+      it = cache_.end();
+    }
+  }
+
+  if (it == cache_.end()) {
+    ZipIndex index;
+    index.st_dev = file_stat.st_dev;
+    index.st_ino = file_stat.st_ino;
+    index.st_size = file_stat.st_size;
+    index.st_mtim = file_stat.st_mtim;
+    if (!build_index(zip_path, &index)) {
+      return false;
+    }
+    it = cache_.emplace(key, std::move(index)).first;
+  }
+
+  auto entry = it->second.entries.find(entry_name);
+  if (entry == it->second.entries.end()) {
+    return false;
   }
+
+  *offset = entry->second;
+  return true;
 }
 
 static int open_library_in_zipfile(ZipArchiveCache* zip_archive_cache,
@@ -897,29 +1289,12 @@ static int open_library_in_zipfile(ZipArchiveCache* zip_archive_cache,
     return -1;
   }
 
-  ZipArchiveHandle handle;
-  if (!zip_archive_cache->get_or_open(zip_path, &handle)) {
-    // invalid zip-file (?)
-    close(fd);
-    return -1;
-  }
-
-  ZipEntry entry;
-
-  if (FindEntry(handle, ZipString(file_path), &entry) != 0) {
-    // Entry was not found.
+  // Entry was not found, is not properly stored or the zip file is invalid.
+  if (!zip_archive_cache->find_entry(zip_path, fd, file_path, file_offset)) {
     close(fd);
     return -1;
   }
 
-  // Check if it is properly stored
-  if (entry.method != kCompressStored || (entry.offset % PAGE_SIZE) != 0) {
-    close(fd);
-    return -1;
-  }
-
-  *file_offset = entry.offset;
-
   if (realpath_fd(fd, realpath)) {
     *realpath += separator;
   } else {
@@ -952,8 +1327,11 @@ static int open_library_on_paths(ZipArchiveCache* zip_archive_cache,
     }
 
     int fd = -1;
-    if (strstr(buf, kZipFileSeparator) != nullptr) {
+    bool is_zip_path = strstr(buf, kZipFileSeparator) != nullptr;
+    if (is_zip_path) {
       fd = open_library_in_zipfile(zip_archive_cache, buf, file_offset, realpath);
+    } else if (path_cache_is_missing(path, name)) {
+      continue;
     }
 
     if (fd == -1) {
@@ -964,6 +1342,8 @@ static int open_library_on_paths(ZipArchiveCache* zip_archive_cache,
           PRINT("warning: unable to get realpath for the library \"%s\". Will use given path.", buf);
           *realpath = buf;
         }
+      } else if (errno == ENOENT && !is_zip_path) {
+        path_cache_add_missing(path, name);
       }
     }
 
@@ -1093,7 +1473,14 @@ static bool load_library(android_namespace_t* ns,
              si->get_file_offset() == file_offset;
     };
 
-    soinfo* si = ns->soinfo_list().find_if(predicate);
+    soinfo* si = nullptr;
+    if (file_stat.st_dev != 0 && file_stat.st_ino != 0) {
+      const std::vector<soinfo*>* soinfos =
+          ns->find_soinfos_by_file(file_stat.st_dev, file_stat.st_ino, file_offset);
+      if (soinfos != nullptr) {
+        si = soinfos->front();
+      }
+    }
 
     // check public namespace
     if (si == nullptr) {
@@ -1160,12 +1547,25 @@ static bool load_library(android_namespace_t* ns,
 
   task->set_soinfo(si);
 
+  // The extent of a library inside a zip file is only known once its
+  // program headers have been read.
+  if (g_readahead_mode != kReadaheadNone && file_offset == 0) {
+    readahead_library(task->get_fd(), 0, file_stat.st_size, realpath.c_str());
+  }
+
   // Read the ELF header and some of the segments.
+  uint64_t read_start_ns = profile_now();
   if (!task->read(realpath.c_str(), file_stat.st_size)) {
     soinfo_free(si);
     task->set_soinfo(nullptr);
     return false;
   }
+  profile_add_time(realpath.c_str(), kProfileRead, read_start_ns);
+
+  if (g_readahead_mode != kReadaheadNone && file_offset != 0) {
+    readahead_library(task->get_fd(), file_offset, task->get_elf_reader().file_extent(),
+                      realpath.c_str());
+  }
 
   // find and set DT_RUNPATH and dt_soname
   // Note that these field values are temporary and are
@@ -1217,11 +1617,13 @@ static bool load_library(android_namespace_t* ns,
   }
 
   // Open the file.
+  uint64_t open_start_ns = profile_now();
   int fd = open_library(ns, zip_archive_cache, name, needed_by, &file_offset, &realpath);
   if (fd == -1) {
     DL_ERR("library \"%s\" not found", name);
     return false;
   }
+  profile_add_time(realpath.c_str(), kProfileOpen, open_start_ns);
 
   task->set_fd(fd, true);
   task->set_file_offset(file_offset);
@@ -1242,34 +1644,36 @@ static bool find_loaded_library_by_soname(android_namespace_t* ns,
     return false;
   }
 
+  const std::vector<soinfo*>* soinfos = ns->find_soinfos_by_soname(name);
+  if (soinfos == nullptr) {
+    return false;
+  }
+
   uint32_t target_sdk_version = get_application_target_sdk_version();
 
-  return !ns->soinfo_list().visit([&](soinfo* si) {
-    const char* soname = si->get_soname();
-    if (soname != nullptr && (strcmp(name, soname) == 0)) {
-      // If the library was opened under different target sdk version
-      // skip this step and try to reopen it. The exceptions are
-      // "libdl.so" and global group. There is no point in skipping
-      // them because relocation process is going to use them
-      // in any case.
-
-      // TODO (dimitry): remove this once linker stops imposing as libdl.so
-      bool is_libdl = (si == solist_get_head());
-
-      if (is_libdl || (si->get_dt_flags_1() & DF_1_GLOBAL) != 0 ||
-          !si->is_linked() || si->get_target_sdk_version() == target_sdk_version ||
-          ns != &g_default_namespace) {
-        *candidate = si;
-        return false;
-      } else if (*candidate == nullptr) {
-        // for the different sdk version in the default namespace
-        // remember the first library.
-        *candidate = si;
-      }
+  for (soinfo* si : *soinfos) {
+    // If the library was opened under different target sdk version
+    // skip this step and try to reopen it. The exceptions are
+    // "libdl.so" and global group. There is no point in skipping
+    // them because relocation process is going to use them
+    // in any case.
+
+    // TODO (dimitry): remove this once linker stops imposing as libdl.so
+    bool is_libdl = (si == solist_get_head());
+
+    if (is_libdl || (si->get_dt_flags_1() & DF_1_GLOBAL) != 0 ||
+        !si->is_linked() || si->get_target_sdk_version() == target_sdk_version ||
+        ns != &g_default_namespace) {
+      *candidate = si;
+      return true;
+    } else if (*candidate == nullptr) {
+      // for the different sdk version in the default namespace
+      // remember the first library.
+      *candidate = si;
     }
+  }
 
-    return true;
-  });
+  return false;
 }
 
 static bool find_library_internal(android_namespace_t* ns,
@@ -1366,6 +1770,102 @@ static void shuffle(std::vector<LoadTask*>* v) {
   }
 }
 
+// Number of helper threads used to map the libraries of a single
+// find_libraries() call; 0 means the libraries are mapped serially.
+// Set by LD_PARALLEL_LOAD; ANDROID_DLEXT_PARALLEL_LOAD requests
+// kDefaultParallelLoadThreads when it is not set.
+static size_t g_parallel_load_threads = 0;
+static constexpr size_t kDefaultParallelLoadThreads = 4;
+static constexpr size_t kMaxParallelLoadThreads = 16;
+
+void set_parallel_load_threads(size_t thread_count) {
+  g_parallel_load_threads = std::min(thread_count, kMaxParallelLoadThreads);
+}
+
+struct ParallelLoadState {
+  const LoadTaskList* load_list;
+  std::atomic<size_t> next_task;
+  std::atomic<bool> failed;
+  // Per-task ElfReader::Load() time when profiling, see linker_profile.h.
+  uint64_t* load_ns;
+};
+
+static void* parallel_load_worker(void* arg) {
+  ParallelLoadState* state = reinterpret_cast<ParallelLoadState*>(arg);
+  const LoadTaskList& load_list = *state->load_list;
+
+  while (!state->failed.load(std::memory_order_relaxed)) {
+    size_t i = state->next_task.fetch_add(1, std::memory_order_relaxed);
+    if (i >= load_list.size()) {
+      break;
+    }
+
+    uint64_t start_ns = profile_now();
+    if (!load_list[i]->load()) {
+      state->failed.store(true, std::memory_order_relaxed);
+    }
+    if (start_ns != 0) {
+      state->load_ns[i] = profile_now() - start_ns;
+    }
+  }
+
+  return nullptr;
+}
+
+// Maps the libraries in load_list using up to thread_count helper threads in
+// addition to the calling thread. LoadTask::load() only reserves address space
+// and maps segments: it never touches the (single-threaded) linker allocator,
+// and every task owns a distinct soinfo, so tasks are safe to run concurrently.
+// Header reading, prelinking and linking stay on the calling thread in the
+// usual deterministic order.
+static bool load_tasks_in_parallel(const LoadTaskList& load_list, size_t thread_count) {
+  if (thread_count == 0 || load_list.size() < 2) {
+    for (auto&& task : load_list) {
+      uint64_t start_ns = profile_now();
+      if (!task->load()) {
+        return false;
+      }
+      profile_add_time(task->get_soinfo()->get_realpath(), kProfileLoadSegments, start_ns);
+    }
+    return true;
+  }
+
+  // The profile records are not thread-safe; collect the times here and
+  // add them once all helper threads are done.
+  std::vector<uint64_t> load_ns(profile_is_enabled() ? load_list.size() : 0);
+
+  ParallelLoadState state;
+  state.load_list = &load_list;
+  state.next_task = 0;
+  state.failed = false;
+  state.load_ns = load_ns.data();
+
+  size_t helper_count = std::min(thread_count, load_list.size() - 1);
+  pthread_t threads[kMaxParallelLoadThreads];
+  size_t started = 0;
+  for (; started < helper_count; ++started) {
+    if (pthread_create(&threads[started], nullptr, parallel_load_worker, &state) != 0) {
+      // Not fatal; the remaining tasks are picked up by the threads we have.
+      break;
+    }
+  }
+
+  TRACE("[ Loading %zu libraries using %zu helper threads ]", load_list.size(), started);
+
+  parallel_load_worker(&state);
+
+  for (size_t i = 0; i < started; ++i) {
+    pthread_join(threads[i], nullptr);
+  }
+
+  for (size_t i = 0; i < load_ns.size(); ++i) {
+    profile_add_duration(load_list[i]->get_soinfo()->get_realpath(),
+                         kProfileLoadSegments, load_ns[i]);
+  }
+
+  return !state.failed.load();
+}
+
 // add_as_children - add first-level loaded libraries (i.e. library_names[], but
 // not their transitive dependencies) as children of the start_with library.
 // This is false when find_libraries is called for dlopen(), when newly loaded
@@ -1419,7 +1919,7 @@ bool find_libraries(android_namespace_t* ns,
     soinfo_unload(soinfos, soinfos_count);
   });
 
-  ZipArchiveCache zip_archive_cache;
+  ZipArchiveCache& zip_archive_cache = g_zip_archive_cache;
 
   // Step 1: expand the list of load_tasks to include
   // all DT_NEEDED libraries (do not load them just yet)
@@ -1441,6 +1941,11 @@ bool find_libraries(android_namespace_t* ns,
       needed_by->add_child(si);
     }
 
+    if (!si->is_linked() && extinfo != nullptr &&
+        (extinfo->flags & ANDROID_DLEXT_LAZY_BIND) != 0) {
+      si->set_lazy_bind(true);
+    }
+
     if (si->is_linked()) {
       si->increment_ref_count();
     }
@@ -1471,10 +1976,14 @@ bool find_libraries(android_namespace_t* ns,
   }
   shuffle(&load_list);
 
-  for (auto&& task : load_list) {
-    if (!task->load()) {
-      return false;
-    }
+  size_t load_threads = g_parallel_load_threads;
+  if (extinfo != nullptr && (extinfo->flags & ANDROID_DLEXT_PARALLEL_LOAD) != 0 &&
+      load_threads == 0) {
+    load_threads = kDefaultParallelLoadThreads;
+  }
+
+  if (!load_tasks_in_parallel(load_list, load_threads)) {
+    return false;
   }
 
   // Step 3: pre-link all DT_NEEDED libraries in breadth first order.
@@ -1670,6 +2179,10 @@ static void soinfo_unload(soinfo* soinfos[], size_t count) {
   while ((si = external_unload_list.pop_front()) != nullptr) {
     soinfo_unload(si);
   }
+
+  // Give chunks emptied by this unload back to the system.
+  g_soinfo_allocator.purge();
+  g_soinfo_links_allocator.purge();
 }
 
 static std::string symbol_display_name(const char* sym_name, const char* sym_ver) {
@@ -1709,6 +2222,7 @@ void do_android_get_LD_LIBRARY_PATH(char* buffer, size_t buffer_size) {
 
 void do_android_update_LD_LIBRARY_PATH(const char* ld_library_path) {
   parse_LD_LIBRARY_PATH(ld_library_path);
+  path_cache_flush();
 }
 
 static std::string android_dlextinfo_to_string(const android_dlextinfo* info) {
@@ -1736,22 +2250,318 @@ static std::string android_dlextinfo_to_string(const android_dlextinfo* info) {
                                         info->library_namespace : nullptr);
 }
 
-void* do_dlopen(const char* name, int flags, const android_dlextinfo* extinfo,
-                  void* caller_addr) {
-  soinfo* const caller = find_containing_library(caller_addr);
-  android_namespace_t* ns = get_caller_namespace(caller);
+// The threads taking part in call_constructors_in_parallel(), including the
+// calling thread. Only one dlopen() at a time calls its constructors in
+// parallel; it holds g_parallel_constructors_mutex while it does.
+static std::atomic<pthread_t> g_constructor_threads[kMaxParallelLoadThreads + 1];
+static std::atomic<size_t> g_constructor_thread_count;
+static pthread_mutex_t g_parallel_constructors_mutex = PTHREAD_MUTEX_INITIALIZER;
 
-  LD_LOG(kLogDlopen,
-         "dlopen(name=\"%s\", flags=0x%x, extinfo=%s, caller=\"%s\", caller_ns=%s@%p) ...",
-         name,
-         flags,
-         android_dlextinfo_to_string(extinfo).c_str(),
-         caller == nullptr ? "(null)" : caller->get_realpath(),
-         ns == nullptr ? "(null)" : ns->get_name(),
-         ns);
+bool is_parallel_constructor_thread() {
+  size_t count = g_constructor_thread_count.load(std::memory_order_acquire);
+  pthread_t self = pthread_self();
+  for (size_t i = 0; i < count; ++i) {
+    if (pthread_equal(g_constructor_threads[i].load(std::memory_order_relaxed), self)) {
+      return true;
+    }
+  }
+  return false;
+}
 
-  auto failure_guard = make_scope_guard([&]() {
-    LD_LOG(kLogDlopen, "... dlopen failed: %s", linker_get_error_buffer());
+static void register_constructor_thread() {
+  size_t i = g_constructor_thread_count.fetch_add(1, std::memory_order_relaxed);
+  g_constructor_threads[i].store(pthread_self(), std::memory_order_release);
+}
+
+struct ParallelConstructorState {
+  // The libraries whose constructors have to run, and for each of them the
+  // number of children that have not finished yet and the parents waiting
+  // for it.
+  std::vector<soinfo*> soinfos;
+  std::vector<size_t> pending_children;
+  std::vector<std::vector<size_t>> parents;
+  // Libraries whose children are all done, consumed from ready_head.
+  std::vector<size_t> ready;
+  size_t ready_head;
+  size_t finished;
+  // Per-library constructor time when profiling.
+  std::vector<uint64_t> constructor_ns;
+  pthread_mutex_t mutex;
+  pthread_cond_t cond;
+};
+
+static void* parallel_constructor_worker(void* arg) {
+  ParallelConstructorState* state = reinterpret_cast<ParallelConstructorState*>(arg);
+  register_constructor_thread();
+
+  pthread_mutex_lock(&state->mutex);
+  while (true) {
+    while (state->ready_head == state->ready.size() &&
+           state->finished < state->soinfos.size()) {
+      pthread_cond_wait(&state->cond, &state->mutex);
+    }
+    if (state->finished == state->soinfos.size()) {
+      break;
+    }
+
+    size_t i = state->ready[state->ready_head++];
+    pthread_mutex_unlock(&state->mutex);
+
+    uint64_t start_ns = profile_now();
+    state->soinfos[i]->call_own_constructors();
+    if (start_ns != 0) {
+      state->constructor_ns[i] = profile_now() - start_ns;
+    }
+
+    pthread_mutex_lock(&state->mutex);
+    ++state->finished;
+    for (size_t parent : state->parents[i]) {
+      if (--state->pending_children[parent] == 0) {
+        state->ready.push_back(parent);
+      }
+    }
+    pthread_cond_broadcast(&state->cond);
+  }
+  pthread_mutex_unlock(&state->mutex);
+
+  return nullptr;
+}
+
+// Collects the libraries reachable from si whose constructors have not been
+// called yet in the order call_constructors() would call them, and the
+// dependency edges between them. Like in call_constructors(), an edge back
+// to a library that is still being visited (a dependency cycle) is ignored.
+static void collect_constructors(soinfo* si, ParallelConstructorState* state,
+                                 std::unordered_map<soinfo*, size_t>* indexes) {
+  if (!si->set_constructors_called()) {
+    return;
+  }
+
+  std::vector<size_t> children;
+  (*indexes)[si] = SIZE_MAX;
+  si->get_children().for_each([&](soinfo* child) {
+    collect_constructors(child, state, indexes);
+    auto it = indexes->find(child);
+    if (it != indexes->end() && it->second != SIZE_MAX) {
+      children.push_back(it->second);
+    }
+  });
+
+  size_t index = state->soinfos.size();
+  (*indexes)[si] = index;
+  state->soinfos.push_back(si);
+  state->pending_children.push_back(children.size());
+  state->parents.emplace_back();
+  for (size_t child : children) {
+    state->parents[child].push_back(index);
+  }
+  if (children.empty()) {
+    state->ready.push_back(index);
+  }
+}
+
+// Runs the constructors collected in state using up to thread_count helper
+// threads in addition to the calling thread. A library's constructors still
+// only run once those of all its dependencies have returned, but the
+// constructors of libraries that do not depend on each other may run at the
+// same time.
+static void call_constructors_in_parallel(ParallelConstructorState* state, size_t thread_count) {
+  // Reserve up front: the workers must not allocate.
+  state->ready.reserve(state->soinfos.size());
+  state->ready_head = 0;
+  state->finished = 0;
+  pthread_mutex_init(&state->mutex, nullptr);
+  pthread_cond_init(&state->cond, nullptr);
+
+  size_t helper_count = std::min(thread_count, state->soinfos.size() - 1);
+  pthread_t threads[kMaxParallelLoadThreads];
+  size_t started = 0;
+  for (; started < helper_count; ++started) {
+    if (pthread_create(&threads[started], nullptr, parallel_constructor_worker, state) != 0) {
+      break;
+    }
+  }
+
+  TRACE("[ Calling constructors of %zu libraries using %zu helper threads ]",
+        state->soinfos.size(), started);
+
+  parallel_constructor_worker(state);
+
+  for (size_t i = 0; i < started; ++i) {
+    pthread_join(threads[i], nullptr);
+  }
+
+  size_t count = g_constructor_thread_count.exchange(0, std::memory_order_acq_rel);
+  for (size_t i = 0; i < count; ++i) {
+    g_constructor_threads[i].store(0, std::memory_order_relaxed);
+  }
+
+  pthread_cond_destroy(&state->cond);
+  pthread_mutex_destroy(&state->mutex);
+}
+
+// The constructors a successful do_dlopen() leaves to its caller, which
+// calls them once it has released the linker lock.
+struct PendingConstructors {
+  soinfo* root;
+  ParallelConstructorState state;
+  // Helper threads to call the constructors on; 0 to call them all on the
+  // calling thread.
+  size_t thread_count;
+  // The entries of g_pending_constructors of other threads that have to
+  // finish before these constructors may run.
+  std::vector<uint64_t> wait_for;
+
+  pthread_t owner;
+  uint64_t serial;
+  PendingConstructors* next;
+};
+
+// The PendingConstructors whose constructors are marked as called but have
+// not all returned yet, newest first.
+static PendingConstructors* g_pending_constructors;
+static uint64_t g_pending_constructors_serial;
+static pthread_mutex_t g_pending_constructors_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t g_pending_constructors_cond = PTHREAD_COND_INITIALIZER;
+
+static bool is_pending_constructors_serial_locked(uint64_t serial) {
+  for (PendingConstructors* p = g_pending_constructors; p != nullptr; p = p->next) {
+    if (p->serial == serial) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Constructors that call dlopen() must not wait for other constructors:
+// those could, in turn, be waiting for them.
+static bool is_constructor_thread_locked() {
+  pthread_t self = pthread_self();
+  for (PendingConstructors* p = g_pending_constructors; p != nullptr; p = p->next) {
+    if (pthread_equal(p->owner, self)) {
+      return true;
+    }
+  }
+  return is_parallel_constructor_thread();
+}
+
+static PendingConstructors* prepare_constructors(soinfo* si, const android_dlextinfo* extinfo) {
+  PendingConstructors* pending = new PendingConstructors();
+  pending->root = si;
+
+  std::unordered_map<soinfo*, size_t> indexes;
+  collect_constructors(si, &pending->state, &indexes);
+  pending->state.constructor_ns.resize(profile_is_enabled() ? pending->state.soinfos.size() : 0);
+
+  // Constructors running on the helper threads of an outer dlopen() are
+  // not allowed to start helpers of their own.
+  if (extinfo != nullptr && (extinfo->flags & ANDROID_DLEXT_PARALLEL_CONSTRUCTORS) != 0 &&
+      !is_parallel_constructor_thread()) {
+    pending->thread_count = g_parallel_load_threads != 0 ? g_parallel_load_threads
+                                                         : kDefaultParallelLoadThreads;
+  }
+
+  ScopedPthreadMutexLocker locker(&g_pending_constructors_mutex);
+  if (g_pending_constructors != nullptr && !is_constructor_thread_locked()) {
+    // Some of the libraries si depends on may have been loaded by a dlopen()
+    // on another thread that is still calling their constructors.
+    std::unordered_map<soinfo*, uint64_t> running;
+    for (PendingConstructors* p = g_pending_constructors; p != nullptr; p = p->next) {
+      for (soinfo* pending_si : p->state.soinfos) {
+        running[pending_si] = p->serial;
+      }
+    }
+
+    walk_dependencies_tree(&si, 1, [&](soinfo* child) {
+      auto it = running.find(child);
+      if (it != running.end() &&
+          std::find(pending->wait_for.begin(), pending->wait_for.end(), it->second) ==
+              pending->wait_for.end()) {
+        pending->wait_for.push_back(it->second);
+      }
+      return true;
+    });
+  }
+
+  if (!pending->state.soinfos.empty()) {
+    pending->owner = pthread_self();
+    pending->serial = ++g_pending_constructors_serial;
+    pending->next = g_pending_constructors;
+    g_pending_constructors = pending;
+  }
+
+  return pending;
+}
+
+void call_pending_constructors(PendingConstructors* pending, bool lock_released) {
+  if (lock_released && !pending->wait_for.empty()) {
+    ScopedPthreadMutexLocker locker(&g_pending_constructors_mutex);
+    for (uint64_t serial : pending->wait_for) {
+      while (is_pending_constructors_serial_locked(serial)) {
+        pthread_cond_wait(&g_pending_constructors_cond, &g_pending_constructors_mutex);
+      }
+    }
+  }
+
+  ParallelConstructorState& state = pending->state;
+  if (state.soinfos.empty()) {
+    return;
+  }
+
+  // Helper threads calling into the linker need the lock the caller holds.
+  if (lock_released && pending->thread_count != 0 && state.soinfos.size() > 1 &&
+      pthread_mutex_trylock(&g_parallel_constructors_mutex) == 0) {
+    call_constructors_in_parallel(&state, pending->thread_count);
+    pthread_mutex_unlock(&g_parallel_constructors_mutex);
+  } else {
+    for (size_t i = 0; i < state.soinfos.size(); ++i) {
+      uint64_t start_ns = profile_now();
+      state.soinfos[i]->call_own_constructors();
+      if (start_ns != 0) {
+        state.constructor_ns[i] = profile_now() - start_ns;
+      }
+    }
+  }
+
+  ScopedPthreadMutexLocker locker(&g_pending_constructors_mutex);
+  for (PendingConstructors** p = &g_pending_constructors; *p != nullptr; p = &(*p)->next) {
+    if (*p == pending) {
+      *p = pending->next;
+      break;
+    }
+  }
+  pthread_cond_broadcast(&g_pending_constructors_cond);
+}
+
+void finish_pending_constructors(PendingConstructors* pending) {
+  ParallelConstructorState& state = pending->state;
+  for (size_t i = 0; i < state.constructor_ns.size(); ++i) {
+    profile_add_duration(state.soinfos[i]->get_realpath(), kProfileConstructors,
+                         state.constructor_ns[i]);
+  }
+  profile_report("dlopen", pending->root->get_realpath());
+  delete pending;
+}
+
+void* do_dlopen(const char* name, int flags, const android_dlextinfo* extinfo,
+                void* caller_addr, PendingConstructors** pending_constructors) {
+  soinfo* const caller = find_containing_library(caller_addr);
+  android_namespace_t* ns = get_caller_namespace(caller);
+
+  // Pick up libraries added to the search paths since the last dlopen().
+  path_cache_new_generation();
+
+  LD_LOG(kLogDlopen,
+         "dlopen(name=\"%s\", flags=0x%x, extinfo=%s, caller=\"%s\", caller_ns=%s@%p) ...",
+         name,
+         flags,
+         android_dlextinfo_to_string(extinfo).c_str(),
+         caller == nullptr ? "(null)" : caller->get_realpath(),
+         ns == nullptr ? "(null)" : ns->get_name(),
+         ns);
+
+  auto failure_guard = make_scope_guard([&]() {
+    LD_LOG(kLogDlopen, "... dlopen failed: %s", linker_get_error_buffer());
   });
 
   if ((flags & ~(RTLD_NOW|RTLD_LAZY|RTLD_LOCAL|RTLD_GLOBAL|RTLD_NODELETE|RTLD_NOLOAD)) != 0) {
@@ -1808,10 +2618,14 @@ void* do_dlopen(const char* name, int flags, const android_dlextinfo* extinfo,
   }
 
   ProtectedDataGuard guard;
+  invalidate_dlsym_cache();
   soinfo* si = find_library(ns, translated_name, flags, extinfo, caller);
+  invalidate_dlsym_cache();
   if (si != nullptr) {
     failure_guard.disable();
-    si->call_constructors();
+    symbol_cache_flush();
+    update_address_index();
+    *pending_constructors = prepare_constructors(si, extinfo);
     void* handle = si->to_handle();
     LD_LOG(kLogDlopen,
            "... dlopen successful: realpath=\"%s\", soname=\"%s\", handle=%p",
@@ -1822,13 +2636,7 @@ void* do_dlopen(const char* name, int flags, const android_dlextinfo* extinfo,
   return nullptr;
 }
 
-int do_dladdr(const void* addr, Dl_info* info) {
-  // Determine if this address can be found in any library currently mapped.
-  soinfo* si = find_containing_library(addr);
-  if (si == nullptr) {
-    return 0;
-  }
-
+static void fill_dl_info(soinfo* si, const void* addr, Dl_info* info) {
   memset(info, 0, sizeof(Dl_info));
 
   info->dli_fname = si->get_realpath();
@@ -1841,10 +2649,48 @@ int do_dladdr(const void* addr, Dl_info* info) {
     info->dli_sname = si->get_string(sym->st_name);
     info->dli_saddr = reinterpret_cast<void*>(si->resolve_symbol_address(sym));
   }
+}
 
+int do_dladdr(const void* addr, Dl_info* info) {
+  // Determine if this address can be found in any library currently mapped.
+  soinfo* si = find_containing_library(addr);
+  if (si == nullptr) {
+    return 0;
+  }
+
+  if (!si->has_symbol_address_index()) {
+    ProtectedDataGuard guard;
+    si->build_symbol_address_index();
+  }
+
+  fill_dl_info(si, addr, info);
   return 1;
 }
 
+bool try_dladdr_without_lock(const void* addr, Dl_info* info, int* result) {
+  AddressIndexReader reader;
+  if (reader.index() == nullptr) {
+    return false;
+  }
+
+  soinfo* si = find_in_address_index(*reader.index(), addr);
+  if (si == nullptr) {
+    // The address may belong to a library mapped since the index was
+    // published.
+    if (!reader.is_current()) {
+      return false;
+    }
+    *result = 0;
+    return true;
+  }
+
+  // Building the symbol address index writes to si; leave that to
+  // do_dladdr(). The linear scan only reads.
+  fill_dl_info(si, addr, info);
+  *result = 1;
+  return true;
+}
+
 static soinfo* soinfo_from_handle(void* handle) {
   if ((reinterpret_cast<uintptr_t>(handle) & 1) != 0) {
     auto it = g_soinfo_handles_map.find(reinterpret_cast<uintptr_t>(handle));
@@ -1900,6 +2746,14 @@ bool do_dlsym(void* handle, const char* sym_name, const char* sym_ver,
   if (sym != nullptr) {
     uint32_t bind = ELF_ST_BIND(sym->st_info);
 
+    // The address of a TLS variable depends on the calling thread, and
+    // st_value is only an offset into the module's TLS block.
+    if (ELF_ST_TYPE(sym->st_info) == STT_TLS) {
+      DL_ERR("symbol \"%s\" is a TLS symbol and can't be looked up with dlsym",
+             symbol_display_name(sym_name, sym_ver).c_str());
+      return false;
+    }
+
     if ((bind == STB_GLOBAL || bind == STB_WEAK) && sym->st_shndx != 0) {
       *symbol = reinterpret_cast<void*>(found->resolve_symbol_address(sym));
       return true;
@@ -1921,7 +2775,11 @@ int do_dlclose(void* handle) {
     return -1;
   }
 
+  // Destructors may call dlsym() while the libraries are being unloaded.
+  invalidate_dlsym_cache();
   soinfo_unload(si);
+  invalidate_dlsym_cache();
+  update_address_index();
   return 0;
 }
 
@@ -2018,6 +2876,7 @@ android_namespace_t* create_namespace(const void* caller_addr,
   android_namespace_t* ns = new (g_namespace_allocator.alloc()) android_namespace_t();
   ns->set_name(name);
   ns->set_isolated((type & ANDROID_NAMESPACE_TYPE_ISOLATED) != 0);
+  ns->set_huge_page_aligned((type & ANDROID_NAMESPACE_TYPE_HUGE_PAGE_ALIGN) != 0);
   ns->set_ld_library_paths(std::move(ld_library_paths));
   ns->set_default_library_paths(std::move(default_library_paths));
   ns->set_permitted_paths(std::move(permitted_paths));
@@ -2034,9 +2893,17 @@ android_namespace_t* create_namespace(const void* caller_addr,
 }
 
 ElfW(Addr) call_ifunc_resolver(ElfW(Addr) resolver_addr) {
+#if defined(__arm__) || defined(__aarch64__)
+  // As with glibc, resolvers on arm get AT_HWCAP so they don't need to call
+  // getauxval(3) from a library that may not have been relocated yet.
+  typedef ElfW(Addr) (*ifunc_resolver_t)(unsigned long);
+  ifunc_resolver_t ifunc_resolver = reinterpret_cast<ifunc_resolver_t>(resolver_addr);
+  ElfW(Addr) ifunc_addr = ifunc_resolver(getauxval(AT_HWCAP));
+#else
   typedef ElfW(Addr) (*ifunc_resolver_t)(void);
   ifunc_resolver_t ifunc_resolver = reinterpret_cast<ifunc_resolver_t>(resolver_addr);
   ElfW(Addr) ifunc_addr = ifunc_resolver();
+#endif
   TRACE_TYPE(RELO, "Called ifunc_resolver@%p. The result is %p",
       ifunc_resolver, reinterpret_cast<void*>(ifunc_addr));
 
@@ -2168,6 +3035,11 @@ bool find_verdef_version_index(const soinfo* si, const version_info* vi, ElfW(Ve
 
   *versym = kVersymGlobal;
 
+  if (si->has_verdef_index()) {
+    si->find_verdef(vi, versym);
+    return true;
+  }
+
   return for_each_verdef(si,
     [&](size_t, const ElfW(Verdef)* verdef, const ElfW(Verdaux)* verdaux) {
       if (verdef->vd_hash == vi->elf_hash &&
@@ -2181,7 +3053,40 @@ bool find_verdef_version_index(const soinfo* si, const version_info* vi, ElfW(Ve
   );
 }
 
+bool soinfo::build_verdef_index() {
+  if (!has_min_version(3)) {
+    return true;
+  }
+
+  bool success = for_each_verdef(this,
+    [&](size_t, const ElfW(Verdef)* verdef, const ElfW(Verdaux)* verdaux) {
+      verdefs_.push_back({ verdef->vd_hash, verdef->vd_ndx, get_string(verdaux->vda_name) });
+      return false;
+    }
+  );
+
+  if (!success) {
+    return false;
+  }
+
+  // find_verdef() returns the first of several versions with the same
+  // name, like the for_each_verdef() scan.
+  std::stable_sort(verdefs_.begin(), verdefs_.end(),
+                   [](const verdef_info& a, const verdef_info& b) {
+                     return a.elf_hash < b.elf_hash;
+                   });
+  has_verdef_index_ = true;
+  return true;
+}
+
 bool VersionTracker::init_verdef(const soinfo* si_from) {
+  if (si_from->has_verdef_index()) {
+    for (const verdef_info& verdef : si_from->get_verdefs()) {
+      add_version_info(verdef.index, verdef.elf_hash, verdef.name, si_from);
+    }
+    return true;
+  }
+
   return for_each_verdef(si_from,
     [&](size_t, const ElfW(Verdef)* verdef, const ElfW(Verdaux)* verdaux) {
       add_version_info(verdef->vd_ndx, verdef->vd_hash,
@@ -2239,9 +3144,46 @@ static ElfW(Addr) get_addend(ElfW(Rel)* rel, ElfW(Addr) reloc_addr) {
 }
 #endif
 
+#if defined(USE_RELA)
+typedef ElfW(Rela) rel_t;
+#else
+typedef ElfW(Rel) rel_t;
+#endif
+
+// Applies the leading run of R_GENERIC_RELATIVE relocations of a plain
+// relocation table and returns how many were applied. Static linkers sort
+// relative relocations first (see DT_RELCOUNT), so this usually covers most
+// of the table and does no per-relocation symbol or version work.
+static size_t relocate_relative_run(const rel_t* rels, size_t count, ElfW(Addr) load_bias) {
+  size_t i = 0;
+  for (; i < count && ELFW(R_TYPE)(rels[i].r_info) == R_GENERIC_RELATIVE; ++i) {
+    ElfW(Addr)* reloc = reinterpret_cast<ElfW(Addr)*>(rels[i].r_offset + load_bias);
+#if defined(USE_RELA)
+    *reloc = load_bias + rels[i].r_addend;
+#else
+    *reloc += load_bias;
+#endif
+  }
+
+  for (size_t j = 0; j < i; ++j) {
+    count_relocation(kRelocRelative);
+  }
+
+  return i;
+}
+
 template<typename ElfRelIteratorT>
 bool soinfo::relocate(const VersionTracker& version_tracker, ElfRelIteratorT&& rel_iterator,
-                      const soinfo_list_t& global_group, const soinfo_list_t& local_group) {
+                      SymbolLookupSession& lookup_session) {
+#if defined(__aarch64__)
+  ElfW(Addr) tlsdesc_resolver = 0;
+#endif
+  // Packers sort symbolic relocations by symbol, so the lookup of the
+  // previous one's symbol can usually be reused.
+  ElfW(Word) last_sym = 0;
+  const ElfW(Sym)* last_s = nullptr;
+  soinfo* last_lsi = nullptr;
+
   for (size_t idx = 0; rel_iterator.has_next(); ++idx) {
     const auto rel = rel_iterator.next();
     if (rel == nullptr) {
@@ -2252,9 +3194,23 @@ bool soinfo::relocate(const VersionTracker& version_tracker, ElfRelIteratorT&& r
     ElfW(Word) sym = ELFW(R_SYM)(rel->r_info);
 
     ElfW(Addr) reloc = static_cast<ElfW(Addr)>(rel->r_offset + load_bias);
+    ElfW(Addr) addend = get_addend(rel, reloc);
+
+    // Relative relocations need neither a symbol nor a version; keep them
+    // out of the generic path (this matters for packed relocations, where
+    // they cannot be pre-applied in a separate pass).
+    if (type == R_GENERIC_RELATIVE) {
+      count_relocation(kRelocRelative);
+      MARK(rel->r_offset);
+      TRACE_TYPE(RELO, "RELO RELATIVE %16p <- %16p\n",
+                 reinterpret_cast<void*>(reloc),
+                 reinterpret_cast<void*>(load_bias + addend));
+      *reinterpret_cast<ElfW(Addr)*>(reloc) = (load_bias + addend);
+      continue;
+    }
+
     ElfW(Addr) sym_addr = 0;
     const char* sym_name = nullptr;
-    ElfW(Addr) addend = get_addend(rel, reloc);
 
     DEBUG("Processing \"%s\" relocation at index %zd", get_realpath(), idx);
     if (type == R_GENERIC_NONE) {
@@ -2266,14 +3222,24 @@ bool soinfo::relocate(const VersionTracker& version_tracker, ElfRelIteratorT&& r
 
     if (sym != 0) {
       sym_name = get_string(symtab_[sym].st_name);
-      const version_info* vi = nullptr;
 
-      if (!lookup_version_info(version_tracker, sym, sym_name, &vi)) {
-        return false;
-      }
+      if (sym == last_sym) {
+        s = last_s;
+        lsi = last_lsi;
+      } else {
+        const version_info* vi = nullptr;
 
-      if (!soinfo_do_lookup(this, sym_name, vi, &lsi, global_group, local_group, &s)) {
-        return false;
+        if (!lookup_version_info(version_tracker, sym, sym_name, &vi)) {
+          return false;
+        }
+
+        if (!lookup_session.lookup(sym, sym_name, vi, &lsi, &s)) {
+          return false;
+        }
+        profile_count_lookup(get_realpath(), s != nullptr);
+        last_sym = sym;
+        last_s = s;
+        last_lsi = lsi;
       }
 
       if (s == nullptr) {
@@ -2380,14 +3346,6 @@ bool soinfo::relocate(const VersionTracker& version_tracker, ElfRelIteratorT&& r
                    reinterpret_cast<void*>(sym_addr + addend), sym_name);
         *reinterpret_cast<ElfW(Addr)*>(reloc) = (sym_addr + addend);
         break;
-      case R_GENERIC_RELATIVE:
-        count_relocation(kRelocRelative);
-        MARK(rel->r_offset);
-        TRACE_TYPE(RELO, "RELO RELATIVE %16p <- %16p\n",
-                   reinterpret_cast<void*>(reloc),
-                   reinterpret_cast<void*>(load_bias + addend));
-        *reinterpret_cast<ElfW(Addr)*>(reloc) = (load_bias + addend);
-        break;
       case R_GENERIC_IRELATIVE:
         count_relocation(kRelocRelative);
         MARK(rel->r_offset);
@@ -2422,6 +3380,42 @@ bool soinfo::relocate(const VersionTracker& version_tracker, ElfRelIteratorT&& r
         }
         break;
 
+#if defined(R_GENERIC_TLS_DTPMOD)
+      // ELF TLS: the module id of the library defining the symbol (or of
+      // this library, if there's no symbol), and the symbol's offset in that
+      // library's PT_TLS block. See bionic_elf_tls.h.
+      case R_GENERIC_TLS_DTPMOD:
+        count_relocation(kRelocAbsolute);
+        MARK(rel->r_offset);
+        {
+          size_t module_id = (sym == 0) ? get_tls_module_id() : lsi->get_tls_module_id();
+          if (module_id == 0) {
+            DL_ERR("\"%s\": TLS relocation for \"%s\" in a library without a PT_TLS segment",
+                   get_realpath(), sym_name != nullptr ? sym_name : "(local)");
+            return false;
+          }
+          TRACE_TYPE(RELO, "RELO TLS_DTPMOD %16p <- %zu %s\n",
+                     reinterpret_cast<void*>(reloc), module_id, sym_name);
+          *reinterpret_cast<ElfW(Addr)*>(reloc) = module_id;
+        }
+        break;
+      case R_GENERIC_TLS_DTPREL:
+        count_relocation(kRelocAbsolute);
+        MARK(rel->r_offset);
+        {
+          ElfW(Addr) offset = (sym == 0) ? 0 : s->st_value;
+          TRACE_TYPE(RELO, "RELO TLS_DTPREL %16p <- %16p %s\n",
+                     reinterpret_cast<void*>(reloc),
+                     reinterpret_cast<void*>(offset + addend), sym_name);
+#if defined(USE_RELA)
+          *reinterpret_cast<ElfW(Addr)*>(reloc) = offset + addend;
+#else
+          *reinterpret_cast<ElfW(Addr)*>(reloc) += offset;
+#endif
+        }
+        break;
+#endif
+
 #if defined(__aarch64__)
       case R_AARCH64_ABS64:
         count_relocation(kRelocAbsolute);
@@ -2526,9 +3520,37 @@ bool soinfo::relocate(const VersionTracker& version_tracker, ElfRelIteratorT&& r
         TRACE_TYPE(RELO, "RELO TLS_TPREL64 *** %16llx <- %16llx - %16llx\n",
                    reloc, (sym_addr + addend), rel->r_offset);
         break;
-      case R_AARCH64_TLS_DTPREL32:
-        TRACE_TYPE(RELO, "RELO TLS_DTPREL32 *** %16llx <- %16llx - %16llx\n",
-                   reloc, (sym_addr + addend), rel->r_offset);
+      case R_AARCH64_TLSDESC:
+        // The descriptor is a pair of the resolver, which returns the
+        // variable's offset from the thread pointer, and its argument.
+        count_relocation(kRelocAbsolute);
+        MARK(rel->r_offset);
+        {
+          size_t module_id = (sym == 0) ? get_tls_module_id() : lsi->get_tls_module_id();
+          if (module_id == 0) {
+            DL_ERR("\"%s\": TLS relocation for \"%s\" in a library without a PT_TLS segment",
+                   get_realpath(), sym_name != nullptr ? sym_name : "(local)");
+            return false;
+          }
+          if (tlsdesc_resolver == 0) {
+            // libc's resolver, which allocates the blocks with libc's malloc.
+            soinfo* found = nullptr;
+            const ElfW(Sym)* resolver =
+                dlsym_handle_lookup(this, &found, "__tlsdesc_resolver_dynamic", nullptr);
+            if (resolver == nullptr) {
+              DL_ERR("\"%s\" has TLSDESC relocations but doesn't depend on libc",
+                     get_realpath());
+              return false;
+            }
+            tlsdesc_resolver = found->resolve_symbol_address(resolver);
+          }
+          TlsIndex* arg = new TlsIndex { module_id, ((sym == 0) ? 0 : s->st_value) + addend };
+          tlsdesc_args_.push_back(arg);
+          TRACE_TYPE(RELO, "RELO TLSDESC %16p <- module %zu offset %zu %s\n",
+                     reinterpret_cast<void*>(reloc), arg->module_id, arg->offset, sym_name);
+          reinterpret_cast<ElfW(Addr)*>(reloc)[0] = tlsdesc_resolver;
+          reinterpret_cast<ElfW(Addr)*>(reloc)[1] = reinterpret_cast<ElfW(Addr)>(arg);
+        }
         break;
 #elif defined(__x86_64__)
       case R_X86_64_32:
@@ -2601,12 +3623,21 @@ bool soinfo::relocate(const VersionTracker& version_tracker, ElfRelIteratorT&& r
   }
   return true;
 }
+#else
+// MIPS has no R_GENERIC_RELATIVE; see soinfo::relocate() in linker_mips.cpp.
+static size_t relocate_relative_run(const ElfW(Rel)*, size_t, ElfW(Addr)) {
+  return 0;
+}
 #endif  // !defined(__mips__)
 
 // An empty list of soinfos
 static soinfo_list_t g_empty_list;
 
+// The last ELF TLS module id handed out by prelink_image().
+static size_t g_tls_module_count = 0;
+
 bool soinfo::prelink_image() {
+  ProfileTimer profile_timer(get_realpath(), kProfilePrelink);
   /* Extract dynamic section */
   ElfW(Word) dynamic_flags = 0;
   phdr_table_get_dynamic_section(phdr, phnum, load_bias, &dynamic, &dynamic_flags);
@@ -2634,6 +3665,19 @@ bool soinfo::prelink_image() {
                                   &ARM_exidx, &ARM_exidx_count);
 #endif
 
+  // ELF TLS (see bionic_elf_tls.h). Module ids are never reused.
+  for (size_t i = 0; i < phnum; ++i) {
+    if (phdr[i].p_type == PT_TLS) {
+      if (is_main_executable()) {
+        DL_ERR("\"%s\" has a PT_TLS segment: ELF TLS is only supported in shared libraries",
+               get_realpath());
+        return false;
+      }
+      tls_module_id_ = ++g_tls_module_count;
+      break;
+    }
+  }
+
   // Extract useful information from dynamic section.
   // Note that: "Except for the DT_NULL element at the end of the array,
   // and the relative order of DT_NEEDED elements, entries may appear in any order."
@@ -2732,7 +3776,8 @@ bool soinfo::prelink_image() {
         // Used by mips and mips64.
         plt_got_ = reinterpret_cast<ElfW(Addr)**>(load_bias + d->d_un.d_ptr);
 #endif
-        // Ignore for other platforms... (because RTLD_LAZY is not supported)
+        // Used by other platforms only for lazy binding (see can_bind_plt_lazily()).
+        dt_pltgot_ = reinterpret_cast<ElfW(Addr)*>(load_bias + d->d_un.d_ptr);
         break;
 
       case DT_DEBUG:
@@ -2841,6 +3886,24 @@ bool soinfo::prelink_image() {
         return false;
 
 #endif
+      case DT_RELR:
+      case DT_ANDROID_RELR:
+        relr_ = reinterpret_cast<ElfW(Addr)*>(load_bias + d->d_un.d_ptr);
+        break;
+
+      case DT_RELRSZ:
+      case DT_ANDROID_RELRSZ:
+        relr_count_ = d->d_un.d_val / sizeof(ElfW(Addr));
+        break;
+
+      case DT_RELRENT:
+      case DT_ANDROID_RELRENT:
+        if (d->d_un.d_val != sizeof(ElfW(Addr))) {
+          DL_ERR("invalid DT_RELRENT: %zd", static_cast<size_t>(d->d_un.d_val));
+          return false;
+        }
+        break;
+
       case DT_INIT:
         init_func_ = reinterpret_cast<linker_ctor_function_t>(load_bias + d->d_un.d_ptr);
         DEBUG("%s constructors (DT_INIT) found at %p", get_realpath(), init_func_);
@@ -2907,6 +3970,9 @@ bool soinfo::prelink_image() {
         if (d->d_un.d_val & DF_SYMBOLIC) {
           has_DT_SYMBOLIC = true;
         }
+        if (d->d_un.d_val & DF_BIND_NOW) {
+          has_bind_now_ = true;
+        }
         break;
 
       case DT_FLAGS_1:
@@ -2978,6 +4044,12 @@ bool soinfo::prelink_image() {
         // this is parsed after we have strtab initialized (see below).
         break;
 
+      case DT_TLSDESC_PLT:
+      case DT_TLSDESC_GOT:
+        // Only needed for lazily resolved TLSDESC relocations; ours are
+        // resolved at load time.
+        break;
+
       default:
         if (!relocating_linker) {
           DL_WARN("%s: unused DT entry: type %p arg %p", get_realpath(),
@@ -3037,32 +4109,32 @@ bool soinfo::prelink_image() {
       this != solist_get_somain() &&
       (flags_ & FLAG_LINKER) == 0 &&
       get_application_target_sdk_version() <= 22) {
-    soname_ = basename(realpath_.c_str());
+    set_soname(basename(realpath_.c_str()));
     DL_WARN("%s: is missing DT_SONAME will use basename as a replacement: \"%s\"",
         get_realpath(), soname_);
     // Don't call add_dlwarning because a missing DT_SONAME isn't important enough to show in the UI
   }
-  return true;
-}
 
-bool soinfo::link_image(const soinfo_list_t& global_group, const soinfo_list_t& local_group,
-                        const android_dlextinfo* extinfo) {
-
-  local_group_root_ = local_group.front();
-  if (local_group_root_ == nullptr) {
-    local_group_root_ = this;
-  }
-
-  if ((flags_ & FLAG_LINKER) == 0 && local_group_root_ == this) {
-    target_sdk_version_ = get_application_target_sdk_version();
+  // The linker relocating itself cannot allocate yet.
+  if (!relocating_linker) {
+    build_elf_bloom_filter();
+    if (!build_verdef_index()) {
+      return false;
+    }
   }
+  return true;
+}
 
+bool soinfo::relocate_image(const soinfo_list_t& global_group,
+                            const soinfo_list_t& local_group) {
   VersionTracker version_tracker;
 
   if (!version_tracker.init(this)) {
     return false;
   }
 
+  SymbolLookupSession lookup_session(this, global_group, local_group);
+
 #if !defined(__LP64__)
   if (has_text_relocations) {
     // Fail if app is targeting sdk version > 22
@@ -3084,24 +4156,39 @@ bool soinfo::link_image(const soinfo_list_t& global_group, const soinfo_list_t&
   }
 #endif
 
+  if (relr_ != nullptr) {
+    DEBUG("[ relocating %s relr ]", get_realpath());
+    if (!relocate_relr()) {
+      return false;
+    }
+  }
+
   if (android_relocs_ != nullptr) {
-    // check signature
+    // check signature: "APS2" values are SLEB128, "APS3" ones group varints.
     if (android_relocs_size_ > 3 &&
         android_relocs_[0] == 'A' &&
         android_relocs_[1] == 'P' &&
         android_relocs_[2] == 'S' &&
-        android_relocs_[3] == '2') {
+        (android_relocs_[3] == '2' || android_relocs_[3] == '3')) {
       DEBUG("[ android relocating %s ]", get_realpath());
 
       bool relocated = false;
       const uint8_t* packed_relocs = android_relocs_ + 4;
       const size_t packed_relocs_size = android_relocs_size_ - 4;
 
-      relocated = relocate(
-          version_tracker,
-          packed_reloc_iterator<sleb128_decoder>(
-            sleb128_decoder(packed_relocs, packed_relocs_size)),
-          global_group, local_group);
+      if (android_relocs_[3] == '2') {
+        relocated = relocate(
+            version_tracker,
+            packed_reloc_iterator<sleb128_decoder>(
+              sleb128_decoder(packed_relocs, packed_relocs_size)),
+            lookup_session);
+      } else {
+        relocated = relocate(
+            version_tracker,
+            packed_reloc_iterator<group_varint_decoder>(
+              group_varint_decoder(packed_relocs, packed_relocs_size)),
+            lookup_session);
+      }
 
       if (!relocated) {
         return false;
@@ -3115,42 +4202,51 @@ bool soinfo::link_image(const soinfo_list_t& global_group, const soinfo_list_t&
 #if defined(USE_RELA)
   if (rela_ != nullptr) {
     DEBUG("[ relocating %s ]", get_realpath());
+    size_t relative_count = relocate_relative_run(rela_, rela_count_, load_bias);
     if (!relocate(version_tracker,
-            plain_reloc_iterator(rela_, rela_count_), global_group, local_group)) {
+            plain_reloc_iterator(rela_ + relative_count, rela_count_ - relative_count),
+            lookup_session)) {
       return false;
     }
   }
-  if (plt_rela_ != nullptr) {
+  if (plt_rela_ != nullptr && can_bind_plt_lazily()) {
+    DEBUG("[ setting up lazy binding for %s plt ]", get_realpath());
+    if (!setup_lazy_plt(version_tracker, lookup_session)) {
+      return false;
+    }
+  } else if (plt_rela_ != nullptr) {
     DEBUG("[ relocating %s plt ]", get_realpath());
     if (!relocate(version_tracker,
-            plain_reloc_iterator(plt_rela_, plt_rela_count_), global_group, local_group)) {
+            plain_reloc_iterator(plt_rela_, plt_rela_count_), lookup_session)) {
       return false;
     }
   }
 #else
   if (rel_ != nullptr) {
     DEBUG("[ relocating %s ]", get_realpath());
+    size_t relative_count = relocate_relative_run(rel_, rel_count_, load_bias);
     if (!relocate(version_tracker,
-            plain_reloc_iterator(rel_, rel_count_), global_group, local_group)) {
+            plain_reloc_iterator(rel_ + relative_count, rel_count_ - relative_count),
+            lookup_session)) {
       return false;
     }
   }
   if (plt_rel_ != nullptr) {
     DEBUG("[ relocating %s plt ]", get_realpath());
     if (!relocate(version_tracker,
-            plain_reloc_iterator(plt_rel_, plt_rel_count_), global_group, local_group)) {
+            plain_reloc_iterator(plt_rel_, plt_rel_count_), lookup_session)) {
       return false;
     }
   }
 #endif
 
 #if defined(__mips__)
-  if (!mips_relocate_got(version_tracker, global_group, local_group)) {
+  if (!mips_relocate_got(version_tracker, lookup_session)) {
     return false;
   }
 #endif
 
-  DEBUG("[ finished linking %s ]", get_realpath());
+  lookup_session.commit();
 
 #if !defined(__LP64__)
   if (has_text_relocations) {
@@ -3163,6 +4259,33 @@ bool soinfo::link_image(const soinfo_list_t& global_group, const soinfo_list_t&
   }
 #endif
 
+  return true;
+}
+
+bool soinfo::link_image(const soinfo_list_t& global_group, const soinfo_list_t& local_group,
+                        const android_dlextinfo* extinfo) {
+  ProfileTimer profile_timer(get_realpath(), kProfileRelocate);
+
+  local_group_root_ = local_group.front();
+  if (local_group_root_ == nullptr) {
+    local_group_root_ = this;
+  }
+
+  if ((flags_ & FLAG_LINKER) == 0 && local_group_root_ == this) {
+    target_sdk_version_ = get_application_target_sdk_version();
+  }
+
+  bool restored_from_boot_image = false;
+  if (!boot_image_restore(this, &restored_from_boot_image)) {
+    return false;
+  }
+
+  if (!restored_from_boot_image && !relocate_image(global_group, local_group)) {
+    return false;
+  }
+
+  DEBUG("[ finished linking %s ]", get_realpath());
+
   // We can also turn on GNU RELRO protection if we're not linking the dynamic linker
   // itself --- it can't make system calls yet, and will have to call protect_relro later.
   if (!is_linker() && !protect_relro()) {
@@ -3184,12 +4307,192 @@ bool soinfo::link_image(const soinfo_list_t& global_group, const soinfo_list_t&
              get_realpath(), strerror(errno));
       return false;
     }
+  } else if (relro_store_is_enabled() && !is_linker() && is_system_library(get_realpath())) {
+    relro_store_share(this);
   }
 
   notify_gdb_of_load(this);
   return true;
 }
 
+#if defined(__aarch64__) || defined(__x86_64__)
+// Entered from PLT0 the first time a lazily bound PLT entry is called; see
+// arch/*/lazy_bind.S. It calls __linker_lazy_bind() and then jumps to the
+// resolved function with the original arguments.
+extern "C" void __linker_lazy_bind_trampoline();
+#endif
+
+// Lazy binding is opt-in (ANDROID_DLEXT_LAZY_BIND) and is only possible when
+// there is a trampoline for this architecture and the PLT GOT stays writable.
+// Libraries linked with -z now (DF_BIND_NOW/DF_1_NOW) or with the PLT GOT
+// inside PT_GNU_RELRO are always bound eagerly.
+bool soinfo::can_bind_plt_lazily() const {
+#if defined(__aarch64__) || defined(__x86_64__)
+  if (!is_lazy_bind() || dt_pltgot_ == nullptr || has_bind_now_ ||
+      (get_dt_flags_1() & DF_1_NOW) != 0) {
+    return false;
+  }
+
+  ElfW(Addr) got = reinterpret_cast<ElfW(Addr)>(dt_pltgot_);
+  for (size_t i = 0; i < phnum; ++i) {
+    const ElfW(Phdr)* phdr_entry = &phdr[i];
+    if (phdr_entry->p_type == PT_GNU_RELRO &&
+        got >= load_bias + phdr_entry->p_vaddr &&
+        got < load_bias + phdr_entry->p_vaddr + phdr_entry->p_memsz) {
+      return false;
+    }
+  }
+
+  return true;
+#else
+  return false;
+#endif
+}
+
+#if defined(USE_RELA)
+bool soinfo::setup_lazy_plt(const VersionTracker& version_tracker,
+                            SymbolLookupSession& lookup_session) {
+#if defined(__aarch64__) || defined(__x86_64__)
+  for (size_t i = 0; i < plt_rela_count_; ++i) {
+    ElfW(Rela)* rela = plt_rela_ + i;
+    if (ELFW(R_TYPE)(rela->r_info) == R_GENERIC_JUMP_SLOT) {
+      // Until it is bound the slot points back into the PLT (at its link-time
+      // address), so the first call ends up in PLT0 and the trampoline.
+      *reinterpret_cast<ElfW(Addr)*>(rela->r_offset + load_bias) += load_bias;
+    } else if (!relocate(version_tracker, plain_reloc_iterator(rela, 1), lookup_session)) {
+      // Other relocations in DT_JMPREL (R_X86_64_IRELATIVE, for example) are
+      // applied eagerly.
+      return false;
+    }
+  }
+
+  // GOT[1] and GOT[2] are reserved for the dynamic linker.
+  dt_pltgot_[1] = reinterpret_cast<ElfW(Addr)>(this);
+  dt_pltgot_[2] = reinterpret_cast<ElfW(Addr)>(&__linker_lazy_bind_trampoline);
+  return true;
+#else
+  (void) version_tracker;
+  (void) lookup_session;
+  DL_ERR("\"%s\": lazy binding is not supported on this architecture", get_realpath());
+  return false;
+#endif
+}
+#endif
+
+#if defined(__aarch64__) || defined(__x86_64__)
+bool soinfo::bind_lazy_plt_entry(size_t reloc_index, ElfW(Addr)* target) {
+  if (reloc_index >= plt_rela_count_) {
+    DL_ERR("\"%s\": invalid lazy binding request for PLT relocation %zu",
+           get_realpath(), reloc_index);
+    return false;
+  }
+
+  const ElfW(Rela)* rela = plt_rela_ + reloc_index;
+  if (ELFW(R_TYPE)(rela->r_info) != R_GENERIC_JUMP_SLOT) {
+    DL_ERR("\"%s\": unexpected lazy binding request for relocation type %d",
+           get_realpath(), static_cast<int>(ELFW(R_TYPE)(rela->r_info)));
+    return false;
+  }
+
+  ElfW(Word) sym = ELFW(R_SYM)(rela->r_info);
+  const char* sym_name = get_string(symtab_[sym].st_name);
+
+  // Most symbols are not versioned and do not need the version tables.
+  const version_info* vi = nullptr;
+  VersionTracker version_tracker;
+  const ElfW(Versym)* sym_ver = get_versym(sym);
+  if (sym_ver != nullptr && *sym_ver != VER_NDX_LOCAL && *sym_ver != VER_NDX_GLOBAL) {
+    if (!version_tracker.init(this) ||
+        !lookup_version_info(version_tracker, sym, sym_name, &vi)) {
+      return false;
+    }
+  }
+
+  // Rebuild the groups this library was linked against.
+  soinfo_list_t global_group = make_global_group(get_primary_namespace());
+  soinfo_list_t local_group;
+  soinfo* local_group_root = get_local_group_root();
+  walk_dependencies_tree(&local_group_root, 1, [&](soinfo* si) {
+    local_group.push_back(si);
+    return true;
+  });
+
+  soinfo* lsi = nullptr;
+  const ElfW(Sym)* s = nullptr;
+  if (!soinfo_do_lookup(this, sym_name, vi, &lsi, global_group, local_group, &s)) {
+    return false;
+  }
+
+  ElfW(Addr) sym_addr = 0;
+  if (s != nullptr) {
+    sym_addr = lsi->resolve_symbol_address(s);
+  } else if (ELF_ST_BIND(symtab_[sym].st_info) != STB_WEAK) {
+    DL_ERR("cannot locate symbol \"%s\" referenced by \"%s\"...", sym_name, get_realpath());
+    return false;
+  }
+
+  ElfW(Addr) reloc = static_cast<ElfW(Addr)>(rela->r_offset + load_bias);
+  TRACE_TYPE(RELO, "RELO JMP_SLOT (lazy) %16p <- %16p %s\n",
+             reinterpret_cast<void*>(reloc),
+             reinterpret_cast<void*>(sym_addr + rela->r_addend), sym_name);
+
+  *target = sym_addr + rela->r_addend;
+  *reinterpret_cast<ElfW(Addr)*>(reloc) = *target;
+  return true;
+}
+#else
+bool soinfo::bind_lazy_plt_entry(size_t reloc_index __unused, ElfW(Addr)* target __unused) {
+  DL_ERR("\"%s\": lazy binding is not supported on this architecture", get_realpath());
+  return false;
+}
+#endif
+
+ElfW(Addr) do_lazy_bind(soinfo* si, size_t reloc_index) {
+  // This runs in the middle of an arbitrary call, so it must be transparent
+  // to the caller. make_global_group() allocates from protected memory.
+  ErrnoRestorer errno_restorer;
+  ProtectedDataGuard guard;
+
+  ElfW(Addr) target = 0;
+  if (!si->bind_lazy_plt_entry(reloc_index, &target)) {
+    __libc_fatal("%s", linker_get_error_buffer());
+  }
+
+  return target;
+}
+
+// Applies DT_RELR relocations: an even entry is the address of the next
+// relocated word, an odd entry is a bitmap of which of the following
+// 8*sizeof(ElfW(Addr))-1 words are relocated too.
+bool soinfo::relocate_relr() {
+  ElfW(Addr)* where = nullptr;
+  for (size_t i = 0; i < relr_count_; ++i) {
+    ElfW(Addr) entry = relr_[i];
+    if ((entry & 1) == 0) {
+      where = reinterpret_cast<ElfW(Addr)*>(load_bias + entry);
+      *where++ += load_bias;
+      count_relocation(kRelocRelative);
+      continue;
+    }
+
+    if (where == nullptr) {
+      DL_ERR("invalid DT_RELR in \"%s\": bitmap entry without an address", get_realpath());
+      return false;
+    }
+
+    ElfW(Addr)* bitmap_base = where;
+    for (entry >>= 1; entry != 0; entry >>= 1, ++bitmap_base) {
+      if ((entry & 1) != 0) {
+        *bitmap_base += load_bias;
+        count_relocation(kRelocRelative);
+      }
+    }
+    where += 8 * sizeof(ElfW(Addr)) - 1;
+  }
+
+  return true;
+}
+
 bool soinfo::protect_relro() {
   if (phdr_table_protect_gnu_relro(phdr, phnum, load_bias) < 0) {
     DL_ERR("can't enable GNU RELRO protection for \"%s\": %s",
@@ -101,19 +101,56 @@ enum RelocationKind {
 
 void count_relocation(RelocationKind kind);
 
+struct android_libc_stat;
+void do_android_linker_stats_iterate(void (*callback)(const android_libc_stat*, void*),
+                                     void* arg);
+
 soinfo* get_libdl_info();
 
 void do_android_get_LD_LIBRARY_PATH(char*, size_t);
 void do_android_update_LD_LIBRARY_PATH(const char* ld_library_path);
-void* do_dlopen(const char* name, int flags, const android_dlextinfo* extinfo, void* caller_addr);
+struct PendingConstructors;
+
+// On success *pending_constructors is set to the constructors that still have
+// to be called: the caller passes it to call_pending_constructors() after
+// releasing the linker lock, and then to finish_pending_constructors() with
+// the lock held again.
+void* do_dlopen(const char* name, int flags, const android_dlextinfo* extinfo,
+                void* caller_addr, PendingConstructors** pending_constructors);
+// Waits for constructors of dependencies that other threads are still
+// calling, then calls pending's. lock_released is false if the caller still
+// holds the linker lock (dlopen() from a dl_iterate_phdr() callback), in
+// which case it neither waits nor uses helper threads.
+void call_pending_constructors(PendingConstructors* pending, bool lock_released);
+void finish_pending_constructors(PendingConstructors* pending);
 int do_dlclose(void* handle);
 
 int do_dl_iterate_phdr(int (*cb)(dl_phdr_info* info, size_t size, void* data), void* data);
 
+// Returns the current snapshot, or nullptr if it has to be (re)built by
+// do_get_dl_phdr_snapshot(); does not require the linker lock.
+const android_dl_phdr_snapshot* get_published_dl_phdr_snapshot();
+const android_dl_phdr_snapshot* do_get_dl_phdr_snapshot();
+void invalidate_dl_phdr_snapshot();
+void invalidate_address_index();
+// Like invalidate_address_index(), but also withdraws the index published
+// to lock-free readers and waits for them; call before unmapping a library.
+void retract_address_index();
+
+// True on the threads running the constructors of an
+// ANDROID_DLEXT_PARALLEL_CONSTRUCTORS dlopen() while they do.
+bool is_parallel_constructor_thread();
+
 bool do_dlsym(void* handle, const char* sym_name, const char* sym_ver,
               void* caller_addr, void** symbol);
 
 int do_dladdr(const void* addr, Dl_info* info);
+// dladdr() without the linker lock, using the libraries known at the end of
+// the last dlopen() or dlclose(). Returns false if the answer is not known
+// and do_dladdr() has to be called with the lock held.
+bool try_dladdr_without_lock(const void* addr, Dl_info* info, int* result);
+
+ElfW(Addr) do_lazy_bind(soinfo* si, size_t reloc_index);
 
 void set_application_target_sdk_version(uint32_t target);
 uint32_t get_application_target_sdk_version();
@@ -142,6 +179,11 @@ enum {
   ANDROID_NAMESPACE_TYPE_SHARED = 2,
   ANDROID_NAMESPACE_TYPE_SHARED_ISOLATED = ANDROID_NAMESPACE_TYPE_SHARED |
                                            ANDROID_NAMESPACE_TYPE_ISOLATED,
+
+  /* Libraries loaded into this namespace are mapped as if
+   * ANDROID_DLEXT_HUGE_PAGE_ALIGN was specified.
+   */
+  ANDROID_NAMESPACE_TYPE_HUGE_PAGE_ALIGN = 4,
 };
 
 bool init_namespaces(const char* public_ns_sonames, const char* anon_ns_library_path);
@@ -156,4 +198,7 @@ android_namespace_t* create_namespace(const void* caller_addr,
 constexpr unsigned kLibraryAlignmentBits = 18;
 constexpr size_t kLibraryAlignment = 1UL << kLibraryAlignmentBits;
 
+// Size of a PMD-mapped transparent huge page.
+constexpr size_t kHugePageSize = 2 * 1024 * 1024;
+
 #endif
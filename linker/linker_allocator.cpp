@@ -18,9 +18,6 @@
 #include "linker_debug.h"
 #include "linker.h"
 
-#include <algorithm>
-#include <vector>
-
 #include <stdlib.h>
 #include <sys/mman.h>
 #include <unistd.h>
@@ -35,7 +32,8 @@
 // On alloc:
 // If size is >= 1k allocator proxies malloc call directly to mmap
 // If size < 1k allocator uses SmallObjectAllocator for the size
-// rounded up to the nearest power of two.
+// rounded up to the nearest size class: a multiple of 16 up to 128,
+// and a quarter of a power of two above that.
 //
 // On free:
 //
@@ -43,9 +41,10 @@
 // the memory.
 //
 // For a pointer allocated using SmallObjectAllocator it adds
-// the block to free_blocks_list_. If the number of free pages reaches 2,
-// SmallObjectAllocator munmaps one of the pages keeping the other one
-// in reserve.
+// the block to the free list in its page's header. A page that becomes
+// empty goes back to the LinkerPagePool shared by all the
+// SmallObjectAllocators, which unmaps pages in batches once it holds
+// more than a few.
 
 static const char kSignature[4] = {'L', 'M', 'A', 1};
 
@@ -54,12 +53,13 @@ static const size_t kSmallObjectMaxSize = 1 << kSmallObjectMaxSizeLog2;
 // This type is used for large allocations (with size >1k)
 static const uint32_t kLargeObject = 111;
 
-bool operator<(const small_object_page_record& one, const small_object_page_record& two) {
-  return one.page_addr < two.page_addr;
-}
+// The pool maps this many pages at a time...
+static const size_t kPagesPerMap = 4;
+// ...and unmaps empty pages down to half this many when it has more.
+static const size_t kMaxFreePages = 8;
 
-static inline uint16_t log2(size_t number) {
-  uint16_t result = 0;
+static inline uint32_t log2(size_t number) {
+  uint32_t result = 0;
   number--;
 
   while (number != 0) {
@@ -70,149 +70,168 @@ static inline uint16_t log2(size_t number) {
   return result;
 }
 
-LinkerSmallObjectAllocator::LinkerSmallObjectAllocator(uint32_t type, size_t block_size)
-    : type_(type), block_size_(block_size), free_pages_cnt_(0), free_blocks_list_(nullptr) {}
+static inline uint32_t size_to_type(size_t size) {
+  if (size <= 128) {
+    return (size <= 16) ? 0 : (size - 1) / 16;
+  }
+  // The top three bits of size - 1 pick a quarter of the power of two.
+  uint32_t shift = log2(size) - 3;
+  return 8 + (shift - 5) * 4 + (((size - 1) >> shift) & 3);
+}
+
+static inline size_t type_to_size(uint32_t type) {
+  if (type < 8) {
+    return (type + 1) * 16;
+  }
+  return static_cast<size_t>(5 + (type - 8) % 4) << (5 + (type - 8) / 4);
+}
+
+void* LinkerPagePool::alloc_page() {
+  if (free_pages_ == nullptr) {
+    size_t size = kPagesPerMap * PAGE_SIZE;
+    void* map_ptr = mmap(nullptr, size, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS, 0, 0);
+    if (map_ptr == MAP_FAILED) {
+      __libc_fatal("mmap failed");
+    }
+
+    prctl(PR_SET_VMA, PR_SET_VMA_ANON_NAME, map_ptr, size, "linker_alloc_small_objects");
+
+    for (size_t i = kPagesPerMap; i-- > 0;) {
+      free_page_record* record = reinterpret_cast<free_page_record*>(
+          reinterpret_cast<uint8_t*>(map_ptr) + i * PAGE_SIZE);
+      record->next = free_pages_;
+      free_pages_ = record;
+    }
+    free_pages_cnt_ += kPagesPerMap;
+  }
+
+  free_page_record* record = free_pages_;
+  free_pages_ = record->next;
+  free_pages_cnt_--;
+  return record;
+}
+
+void LinkerPagePool::free_page(void* page) {
+  free_page_record* record = reinterpret_cast<free_page_record*>(page);
+  record->next = free_pages_;
+  free_pages_ = record;
+
+  // Trimming to half rather than to the limit means a workload hovering
+  // around the limit doesn't map and unmap a page every time.
+  if (++free_pages_cnt_ > kMaxFreePages) {
+    while (free_pages_cnt_ > kMaxFreePages / 2) {
+      record = free_pages_;
+      free_pages_ = record->next;
+      free_pages_cnt_--;
+      munmap(record, PAGE_SIZE);
+    }
+  }
+}
+
+LinkerSmallObjectAllocator::LinkerSmallObjectAllocator(uint32_t type, size_t block_size,
+                                                       LinkerPagePool* page_pool)
+    : type_(type), block_size_(block_size), page_pool_(page_pool), page_list_(nullptr) {}
 
 void* LinkerSmallObjectAllocator::alloc() {
   CHECK(block_size_ != 0);
 
-  if (free_blocks_list_ == nullptr) {
+  if (page_list_ == nullptr) {
     alloc_page();
   }
 
-  small_object_block_record* block_record = free_blocks_list_;
+  small_object_page_info* page = page_list_;
+  small_object_block_record* block_record = page->free_blocks_list;
   if (block_record->free_blocks_cnt > 1) {
     small_object_block_record* next_free = reinterpret_cast<small_object_block_record*>(
         reinterpret_cast<uint8_t*>(block_record) + block_size_);
     next_free->next = block_record->next;
     next_free->free_blocks_cnt = block_record->free_blocks_cnt - 1;
-    free_blocks_list_ = next_free;
+    page->free_blocks_list = next_free;
   } else {
-    free_blocks_list_ = block_record->next;
+    page->free_blocks_list = block_record->next;
   }
 
   // bookkeeping...
-  auto page_record = find_page_record(block_record);
-
-  if (page_record->allocated_blocks_cnt == 0) {
-    free_pages_cnt_--;
+  if (page->free_blocks_list == nullptr) {
+    unlink_page(page);
   }
-
-  page_record->free_blocks_cnt--;
-  page_record->allocated_blocks_cnt++;
+  page->allocated_blocks_cnt++;
 
   memset(block_record, 0, block_size_);
 
   return block_record;
 }
 
-void LinkerSmallObjectAllocator::free_page(linker_vector_t::iterator page_record) {
-  void* page_start = reinterpret_cast<void*>(page_record->page_addr);
-  void* page_end = reinterpret_cast<void*>(reinterpret_cast<uintptr_t>(page_start) + PAGE_SIZE);
-
-  while (free_blocks_list_ != nullptr &&
-      free_blocks_list_ > page_start &&
-      free_blocks_list_ < page_end) {
-    free_blocks_list_ = free_blocks_list_->next;
-  }
-
-  small_object_block_record* current = free_blocks_list_;
-
-  while (current != nullptr) {
-    while (current->next > page_start && current->next < page_end) {
-      current->next = current->next->next;
-    }
-
-    current = current->next;
-  }
-
-  munmap(page_start, PAGE_SIZE);
-  page_records_.erase(page_record);
-  free_pages_cnt_--;
+void LinkerSmallObjectAllocator::free_page(small_object_page_info* page) {
+  unlink_page(page);
+  page_pool_->free_page(page);
 }
 
 void LinkerSmallObjectAllocator::free(void* ptr) {
-  auto page_record = find_page_record(ptr);
+  small_object_page_info* page =
+      reinterpret_cast<small_object_page_info*>(PAGE_START(reinterpret_cast<uintptr_t>(ptr)));
 
-  ssize_t offset = reinterpret_cast<uintptr_t>(ptr) - sizeof(page_info);
+  ssize_t offset = reinterpret_cast<uintptr_t>(ptr) - reinterpret_cast<uintptr_t>(page + 1);
 
-  if (offset % block_size_ != 0) {
+  if (offset < 0 || offset % block_size_ != 0) {
     __libc_fatal("invalid pointer: %p (block_size=%zd)", ptr, block_size_);
   }
 
-  memset(ptr, 0, block_size_);
   small_object_block_record* block_record = reinterpret_cast<small_object_block_record*>(ptr);
 
-  block_record->next = free_blocks_list_;
+  block_record->next = page->free_blocks_list;
   block_record->free_blocks_cnt = 1;
 
-  free_blocks_list_ = block_record;
-
-  page_record->free_blocks_cnt++;
-  page_record->allocated_blocks_cnt--;
+  // a full page has free blocks again
+  if (page->free_blocks_list == nullptr) {
+    link_page(page);
+  }
+  page->free_blocks_list = block_record;
 
-  if (page_record->allocated_blocks_cnt == 0) {
-    if (free_pages_cnt_++ > 1) {
-      // if we already have a free page - unmap this one.
-      free_page(page_record);
-    }
+  if (--page->allocated_blocks_cnt == 0) {
+    free_page(page);
   }
 }
 
-linker_vector_t::iterator LinkerSmallObjectAllocator::find_page_record(void* ptr) {
-  void* addr = reinterpret_cast<void*>(PAGE_START(reinterpret_cast<uintptr_t>(ptr)));
-  small_object_page_record boundary;
-  boundary.page_addr = addr;
-  linker_vector_t::iterator it = std::lower_bound(
-      page_records_.begin(), page_records_.end(), boundary);
-
-  if (it == page_records_.end() || it->page_addr != addr) {
-    // not found...
-    __libc_fatal("page record for %p was not found (block_size=%zd)", ptr, block_size_);
+void LinkerSmallObjectAllocator::link_page(small_object_page_info* page) {
+  page->prev_page = nullptr;
+  page->next_page = page_list_;
+  if (page_list_ != nullptr) {
+    page_list_->prev_page = page;
   }
-
-  return it;
+  page_list_ = page;
 }
 
-void LinkerSmallObjectAllocator::create_page_record(void* page_addr, size_t free_blocks_cnt) {
-  small_object_page_record record;
-  record.page_addr = page_addr;
-  record.free_blocks_cnt = free_blocks_cnt;
-  record.allocated_blocks_cnt = 0;
-
-  linker_vector_t::iterator it = std::lower_bound(
-      page_records_.begin(), page_records_.end(), record);
-  page_records_.insert(it, record);
+void LinkerSmallObjectAllocator::unlink_page(small_object_page_info* page) {
+  if (page->prev_page != nullptr) {
+    page->prev_page->next_page = page->next_page;
+  } else {
+    page_list_ = page->next_page;
+  }
+  if (page->next_page != nullptr) {
+    page->next_page->prev_page = page->prev_page;
+  }
 }
 
 void LinkerSmallObjectAllocator::alloc_page() {
   static_assert(sizeof(page_info) % 16 == 0,
                 "sizeof(page_info) is not multiple of 16");
-  void* map_ptr = mmap(nullptr, PAGE_SIZE,
-      PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS, 0, 0);
-  if (map_ptr == MAP_FAILED) {
-    __libc_fatal("mmap failed");
-  }
-
-  prctl(PR_SET_VMA, PR_SET_VMA_ANON_NAME, map_ptr, PAGE_SIZE, "linker_alloc_small_objects");
-
-  memset(map_ptr, 0, PAGE_SIZE);
-
-  page_info* info = reinterpret_cast<page_info*>(map_ptr);
-  memcpy(info->signature, kSignature, sizeof(kSignature));
-  info->type = type_;
-  info->allocator_addr = this;
-
-  size_t free_blocks_cnt = (PAGE_SIZE - sizeof(page_info))/block_size_;
-
-  create_page_record(map_ptr, free_blocks_cnt);
-
-  small_object_block_record* first_block = reinterpret_cast<small_object_block_record*>(info + 1);
-
-  first_block->next = free_blocks_list_;
-  first_block->free_blocks_cnt = free_blocks_cnt;
-
-  free_blocks_list_ = first_block;
+  static_assert(sizeof(small_object_page_info) % 16 == 0,
+                "sizeof(small_object_page_info) is not multiple of 16");
+  small_object_page_info* page =
+      reinterpret_cast<small_object_page_info*>(page_pool_->alloc_page());
+
+  memset(page, 0, sizeof(small_object_page_info));
+  memcpy(page->info.signature, kSignature, sizeof(kSignature));
+  page->info.type = type_;
+  page->info.allocator_addr = this;
+
+  small_object_block_record* first_block = reinterpret_cast<small_object_block_record*>(page + 1);
+  first_block->next = nullptr;
+  first_block->free_blocks_cnt = (PAGE_SIZE - sizeof(small_object_page_info))/block_size_;
+  page->free_blocks_list = first_block;
+
+  link_page(page);
 }
 
 
@@ -224,9 +243,8 @@ void LinkerMemoryAllocator::initialize_allocators() {
   LinkerSmallObjectAllocator* allocators =
       reinterpret_cast<LinkerSmallObjectAllocator*>(allocators_buf_);
 
-  for (size_t i = 0; i < kSmallObjectAllocatorsCount; ++i) {
-    uint32_t type = i + kSmallObjectMinSizeLog2;
-    new (allocators + i) LinkerSmallObjectAllocator(type, 1 << type);
+  for (uint32_t type = 0; type < kSmallObjectAllocatorsCount; ++type) {
+    new (allocators + type) LinkerSmallObjectAllocator(type, type_to_size(type), &page_pool_);
   }
 
   allocators_ = allocators;
@@ -263,13 +281,7 @@ void* LinkerMemoryAllocator::alloc(size_t size) {
     return alloc_mmap(size);
   }
 
-  uint16_t log2_size = log2(size);
-
-  if (log2_size < kSmallObjectMinSizeLog2) {
-    log2_size = kSmallObjectMinSizeLog2;
-  }
-
-  return get_small_object_allocator(log2_size)->alloc();
+  return get_small_object_allocator(size_to_type(size))->alloc();
 }
 
 page_info* LinkerMemoryAllocator::get_page_info(void* ptr) {
@@ -336,10 +348,10 @@ void LinkerMemoryAllocator::free(void* ptr) {
 }
 
 LinkerSmallObjectAllocator* LinkerMemoryAllocator::get_small_object_allocator(uint32_t type) {
-  if (type < kSmallObjectMinSizeLog2 || type > kSmallObjectMaxSizeLog2) {
+  if (type >= kSmallObjectAllocatorsCount) {
     __libc_fatal("invalid type: %u", type);
   }
 
   initialize_allocators();
-  return &allocators_[type - kSmallObjectMinSizeLog2];
+  return &allocators_[type];
 }
@@ -23,14 +23,13 @@
 #include <stddef.h>
 #include <unistd.h>
 
-#include <vector>
-
 #include "private/bionic_prctl.h"
 #include "private/libc_logging.h"
 
 const uint32_t kSmallObjectMaxSizeLog2 = 10;
-const uint32_t kSmallObjectMinSizeLog2 = 4;
-const uint32_t kSmallObjectAllocatorsCount = kSmallObjectMaxSizeLog2 - kSmallObjectMinSizeLog2 + 1;
+// Sizes go up in steps of 16 bytes to 128, then in quarters of a power of two: 160, 192, 224,
+// 256, 320, ..., 1024.
+const uint32_t kSmallObjectAllocatorsCount = 8 + (kSmallObjectMaxSizeLog2 - 7) * 4;
 
 class LinkerSmallObjectAllocator;
 
@@ -47,83 +46,67 @@ struct page_info {
   };
 } __attribute__((aligned(16)));
 
-struct small_object_page_record {
-  void* page_addr;
-  size_t free_blocks_cnt;
-  size_t allocated_blocks_cnt;
-};
-
-// for lower_bound...
-bool operator<(const small_object_page_record& one, const small_object_page_record& two);
-
 struct small_object_block_record {
   small_object_block_record* next;
   size_t free_blocks_cnt;
 };
 
-// This is implementation for std::vector allocator
-template <typename T>
-class linker_vector_allocator {
+// Pages of small objects carry their own bookkeeping after the page_info,
+// so freeing a block finds it from the block's address alone.
+struct small_object_page_info {
+  page_info info;
+
+  // this page's free blocks
+  small_object_block_record* free_blocks_list;
+  size_t allocated_blocks_cnt;
+
+  // the allocator's list of pages with free blocks
+  small_object_page_info* prev_page;
+  small_object_page_info* next_page;
+} __attribute__((aligned(16)));
+
+// Empty pages are shared by all the small object allocators. They're mapped
+// a few at a time, and a few are kept for reuse rather than unmapped
+// as soon as they're empty; beyond that they go back to the kernel in batches.
+class LinkerPagePool {
  public:
-  typedef T value_type;
-  typedef T* pointer;
-  typedef const T* const_pointer;
-  typedef T& reference;
-  typedef const T& const_reference;
-  typedef size_t size_type;
-  typedef ptrdiff_t difference_type;
-
-  T* allocate(size_t n, const T* hint = nullptr) {
-    size_t size = n * sizeof(T);
-    void* ptr = mmap(const_cast<T*>(hint), size,
-        PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS, 0, 0);
-    if (ptr == MAP_FAILED) {
-      // Spec says we need to throw std::bad_alloc here but because our
-      // code does not support exception handling anyways - we are going to abort.
-      __libc_fatal("mmap failed");
-    }
-
-    prctl(PR_SET_VMA, PR_SET_VMA_ANON_NAME, ptr, size, "linker_alloc_vector");
-
-    return reinterpret_cast<T*>(ptr);
-  }
-
-  void deallocate(T* ptr, size_t n) {
-    munmap(ptr, n * sizeof(T));
-  }
-};
+  constexpr LinkerPagePool() : free_pages_(nullptr), free_pages_cnt_(0) {}
+  void* alloc_page();
+  void free_page(void* page);
 
-typedef
-    std::vector<small_object_page_record, linker_vector_allocator<small_object_page_record>>
-    linker_vector_t;
+ private:
+  struct free_page_record {
+    free_page_record* next;
+  };
 
+  free_page_record* free_pages_;
+  size_t free_pages_cnt_;
+};
 
 class LinkerSmallObjectAllocator {
  public:
-  LinkerSmallObjectAllocator(uint32_t type, size_t block_size);
+  LinkerSmallObjectAllocator(uint32_t type, size_t block_size, LinkerPagePool* page_pool);
   void* alloc();
   void free(void* ptr);
 
   size_t get_block_size() const { return block_size_; }
  private:
   void alloc_page();
-  void free_page(linker_vector_t::iterator page_record);
-  linker_vector_t::iterator find_page_record(void* ptr);
-  void create_page_record(void* page_addr, size_t free_blocks_cnt);
+  void free_page(small_object_page_info* page);
+  void link_page(small_object_page_info* page);
+  void unlink_page(small_object_page_info* page);
 
   uint32_t type_;
   size_t block_size_;
+  LinkerPagePool* page_pool_;
 
-  size_t free_pages_cnt_;
-  small_object_block_record* free_blocks_list_;
-
-  // sorted vector of page records
-  linker_vector_t page_records_;
+  // pages with at least one free block
+  small_object_page_info* page_list_;
 };
 
 class LinkerMemoryAllocator {
  public:
-  constexpr LinkerMemoryAllocator() : allocators_(nullptr), allocators_buf_() {}
+  constexpr LinkerMemoryAllocator() : allocators_(nullptr), allocators_buf_(), page_pool_() {}
   void* alloc(size_t size);
 
   // Note that this implementation of realloc never shrinks allocation
@@ -137,6 +120,7 @@ class LinkerMemoryAllocator {
 
   LinkerSmallObjectAllocator* allocators_;
   uint8_t allocators_buf_[sizeof(LinkerSmallObjectAllocator)*kSmallObjectAllocatorsCount];
+  LinkerPagePool page_pool_;
 };
 
 
@@ -27,9 +27,16 @@ static constexpr size_t round_up(size_t size, size_t multiplier) {
   return (size + (multiplier - 1)) & ~(multiplier-1);
 }
 
+// Pages are mapped in chunks of this size. A chunk is only touched as
+// blocks are handed out, so a mostly empty chunk costs address space but
+// not memory, and protect_all() needs one mprotect() per chunk instead of
+// one per page.
+static constexpr size_t kBlockAllocatorChunkSize = 16 * PAGE_SIZE;
+
 struct LinkerBlockAllocatorPage {
   LinkerBlockAllocatorPage* next;
-  uint8_t bytes[PAGE_SIZE - 16] __attribute__((aligned(16)));
+  size_t allocated_count;
+  uint8_t bytes[kBlockAllocatorChunkSize - 16] __attribute__((aligned(16)));
 };
 
 struct FreeBlockInfo {
@@ -62,6 +69,8 @@ void* LinkerBlockAllocator::alloc() {
 
   memset(block_info, 0, block_size_);
 
+  find_page(block_info)->allocated_count++;
+
   return block_info;
 }
 
@@ -90,34 +99,85 @@ void LinkerBlockAllocator::free(void* block) {
   block_info->num_free_blocks = 1;
 
   free_block_list_ = block_info;
+
+  page->allocated_count--;
 }
 
 void LinkerBlockAllocator::protect_all(int prot) {
   for (LinkerBlockAllocatorPage* page = page_list_; page != nullptr; page = page->next) {
-    if (mprotect(page, PAGE_SIZE, prot) == -1) {
+    if (mprotect(page, kBlockAllocatorChunkSize, prot) == -1) {
       abort();
     }
   }
 }
 
+void LinkerBlockAllocator::purge() {
+  // Keep one empty chunk (the most recently mapped one) so that a
+  // dlopen()/dlclose() loop does not mmap and munmap on every iteration.
+  LinkerBlockAllocatorPage* keep = nullptr;
+  size_t empty_count = 0;
+  for (LinkerBlockAllocatorPage* page = page_list_; page != nullptr; page = page->next) {
+    if (page->allocated_count == 0) {
+      if (keep == nullptr) {
+        keep = page;
+      }
+      ++empty_count;
+    }
+  }
+
+  if (empty_count <= 1) {
+    return;
+  }
+
+  auto is_released = [&](LinkerBlockAllocatorPage* page) {
+    return page->allocated_count == 0 && page != keep;
+  };
+
+  // A run of free blocks never crosses a chunk boundary, so dropping the
+  // runs that live in released chunks leaves a valid free list behind.
+  void** link = &free_block_list_;
+  while (*link != nullptr) {
+    FreeBlockInfo* block_info = reinterpret_cast<FreeBlockInfo*>(*link);
+    if (is_released(find_page(block_info))) {
+      *link = block_info->next_block;
+    } else {
+      link = &block_info->next_block;
+    }
+  }
+
+  LinkerBlockAllocatorPage** page_link = &page_list_;
+  while (*page_link != nullptr) {
+    LinkerBlockAllocatorPage* page = *page_link;
+    if (is_released(page)) {
+      *page_link = page->next;
+      munmap(page, kBlockAllocatorChunkSize);
+    } else {
+      page_link = &page->next;
+    }
+  }
+}
+
 void LinkerBlockAllocator::create_new_page() {
-  static_assert(sizeof(LinkerBlockAllocatorPage) == PAGE_SIZE,
+  static_assert(sizeof(LinkerBlockAllocatorPage) == kBlockAllocatorChunkSize,
                 "Invalid sizeof(LinkerBlockAllocatorPage)");
 
   LinkerBlockAllocatorPage* page = reinterpret_cast<LinkerBlockAllocatorPage*>(
-      mmap(nullptr, PAGE_SIZE, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS, 0, 0));
+      mmap(nullptr, kBlockAllocatorChunkSize, PROT_READ|PROT_WRITE,
+           MAP_PRIVATE|MAP_ANONYMOUS, 0, 0));
 
   if (page == MAP_FAILED) {
     abort(); // oom
   }
 
-  prctl(PR_SET_VMA, PR_SET_VMA_ANON_NAME, page, PAGE_SIZE, "linker_alloc");
+  prctl(PR_SET_VMA, PR_SET_VMA_ANON_NAME, page, kBlockAllocatorChunkSize, "linker_alloc");
 
-  memset(page, 0, PAGE_SIZE);
+  // Anonymous mappings are zero-filled; leave the rest of the chunk
+  // untouched so that it is not faulted in before it is used.
+  page->allocated_count = 0;
 
   FreeBlockInfo* first_block = reinterpret_cast<FreeBlockInfo*>(page->bytes);
   first_block->next_block = free_block_list_;
-  first_block->num_free_blocks = (PAGE_SIZE - sizeof(LinkerBlockAllocatorPage*))/block_size_;
+  first_block->num_free_blocks = sizeof(page->bytes)/block_size_;
 
   free_block_list_ = first_block;
 
@@ -132,8 +192,7 @@ LinkerBlockAllocatorPage* LinkerBlockAllocator::find_page(void* block) {
 
   LinkerBlockAllocatorPage* page = page_list_;
   while (page != nullptr) {
-    const uint8_t* page_ptr = reinterpret_cast<const uint8_t*>(page);
-    if (block >= (page_ptr + sizeof(page->next)) && block < (page_ptr + PAGE_SIZE)) {
+    if (block >= page->bytes && block < (page->bytes + sizeof(page->bytes))) {
       return page;
     }
 
@@ -38,6 +38,10 @@ class LinkerBlockAllocator {
   void free(void* block);
   void protect_all(int prot);
 
+  // Releases chunks that no longer hold any allocated blocks. The memory
+  // has to be writable, so this must be called with the data unprotected.
+  void purge();
+
  private:
   void create_new_page();
   LinkerBlockAllocatorPage* find_page(void* block);
@@ -51,17 +55,18 @@ class LinkerBlockAllocator {
 
 /*
  * A simple allocator for the dynamic linker. An allocator allocates instances
- * of a single fixed-size type. Allocations are backed by page-sized private
+ * of a single fixed-size type. Allocations are backed by chunks of private
  * anonymous mmaps.
  *
  * The differences between this allocator and LinkerMemoryAllocator are:
  * 1. This allocator manages space more efficiently. LinkerMemoryAllocator
- *    operates in power-of-two sized blocks up to 1k, when this implementation
+ *    operates in size classes up to 1k, when this implementation
  *    splits the page to aligned size of structure; For example for structures
  *    with size 513 this allocator will use 516 (520 for lp64) bytes of data
- *    where generalized implementation is going to use 1024 sized blocks.
+ *    where generalized implementation is going to use 640 sized blocks.
  *
- * 2. This allocator does not munmap allocated memory, where LinkerMemoryAllocator does.
+ * 2. This allocator only munmaps memory on an explicit purge(), where
+ *    LinkerMemoryAllocator does it once it has more than a few empty pages.
  *
  * 3. This allocator provides mprotect services to the user, where LinkerMemoryAllocator
  *    always treats it's memory as READ|WRITE.
@@ -73,6 +78,7 @@ class LinkerTypeAllocator {
   T* alloc() { return reinterpret_cast<T*>(block_allocator_.alloc()); }
   void free(T* t) { block_allocator_.free(t); }
   void protect_all(int prot) { block_allocator_.protect_all(prot); }
+  void purge() { block_allocator_.purge(); }
  private:
   LinkerBlockAllocator block_allocator_;
   DISALLOW_COPY_AND_ASSIGN(LinkerTypeAllocator);
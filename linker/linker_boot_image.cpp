@@ -0,0 +1,515 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include "linker_boot_image.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "linker.h"
+#include "linker_debug.h"
+#include "linker_globals.h"
+#include "linker_main.h"
+#include "linker_utils.h"
+
+#include "android-base/stringprintf.h"
+
+// File layout (all fields are in host byte order):
+//   boot_image_header_t
+//   boot_image_entry_t[header.entry_count]
+//   boot_image_segment_t[header.segment_count]
+//   string table (header.strtab_size bytes of '\0'-terminated realpaths)
+//   segment contents, each starting on a page boundary
+static const char kBootImageMagic[4] = { 'L', 'D', 'B', 'I' };
+static constexpr uint32_t kBootImageVersion = 1;
+
+struct boot_image_header_t {
+  char magic[4];
+  uint32_t version;
+  uint32_t addr_size;
+  uint32_t entry_count;
+  uint32_t segment_count;
+  uint32_t strtab_size;
+  // The linker binary and its address, LD_LIBRARY_PATH and LD_PRELOAD.
+  uint64_t context_hash;
+};
+
+struct boot_image_entry_t {
+  uint64_t identity_hash;
+  uint64_t base;
+  uint64_t load_bias;
+  uint64_t size;
+  uint32_t realpath_offset;
+  uint32_t first_segment;
+  uint32_t segment_count;
+  uint32_t reserved;
+};
+
+struct boot_image_segment_t {
+  uint64_t start;
+  uint64_t size;
+  uint64_t file_offset;
+  uint32_t prot;
+  uint32_t reserved;
+};
+
+enum BootImageState {
+  kBootImageDisabled,
+  kBootImageRecording,
+  kBootImageRestoring,
+};
+
+static BootImageState g_boot_image_state = kBootImageDisabled;
+static bool g_boot_image_checked = false;
+static std::string g_boot_image_path;
+static uint64_t g_boot_image_context_hash;
+static int g_boot_image_fd = -1;
+static const uint8_t* g_boot_image_map = nullptr;
+static size_t g_boot_image_size = 0;
+static const boot_image_segment_t* g_boot_image_segments = nullptr;
+static uint32_t g_boot_image_entry_count = 0;
+// realpath -> entry in g_boot_image_map.
+static std::unordered_map<std::string, const boot_image_entry_t*> g_boot_image_entries;
+
+static uint64_t identity_hash(const soinfo* si) {
+  uint64_t st_dev = si->get_st_dev();
+  uint64_t st_ino = si->get_st_ino();
+  int64_t mtime_sec = si->get_st_mtim().tv_sec;
+  int64_t mtime_nsec = si->get_st_mtim().tv_nsec;
+  int64_t file_offset = si->get_file_offset();
+  const char* realpath = si->get_realpath();
+
+  uint64_t hash = kFnv1aInitialHash;
+  hash = fnv1a(hash, realpath, strlen(realpath));
+  hash = fnv1a(hash, &st_dev, sizeof(st_dev));
+  hash = fnv1a(hash, &st_ino, sizeof(st_ino));
+  hash = fnv1a(hash, &mtime_sec, sizeof(mtime_sec));
+  hash = fnv1a(hash, &mtime_nsec, sizeof(mtime_nsec));
+  hash = fnv1a(hash, &file_offset, sizeof(file_offset));
+  return hash;
+}
+
+static uint64_t context_hash(const struct stat& linker_stat, ElfW(Addr) linker_base,
+                             const char* ld_library_path, const char* ld_preload) {
+  uint64_t st_dev = linker_stat.st_dev;
+  uint64_t st_ino = linker_stat.st_ino;
+  int64_t mtime_sec = linker_stat.st_mtim.tv_sec;
+  int64_t mtime_nsec = linker_stat.st_mtim.tv_nsec;
+  uint64_t base = linker_base;
+
+  uint64_t hash = kFnv1aInitialHash;
+  hash = fnv1a(hash, &st_dev, sizeof(st_dev));
+  hash = fnv1a(hash, &st_ino, sizeof(st_ino));
+  hash = fnv1a(hash, &mtime_sec, sizeof(mtime_sec));
+  hash = fnv1a(hash, &mtime_nsec, sizeof(mtime_nsec));
+  hash = fnv1a(hash, &base, sizeof(base));
+  // Include the terminators so that the two strings can't run together.
+  if (ld_library_path != nullptr) {
+    hash = fnv1a(hash, ld_library_path, strlen(ld_library_path));
+  }
+  hash = fnv1a(hash, "", 1);
+  if (ld_preload != nullptr) {
+    hash = fnv1a(hash, ld_preload, strlen(ld_preload));
+  }
+  hash = fnv1a(hash, "", 1);
+  return hash;
+}
+
+static bool parse_boot_image(const uint8_t* data, size_t size) {
+  if (size < sizeof(boot_image_header_t)) {
+    return false;
+  }
+
+  const boot_image_header_t* header = reinterpret_cast<const boot_image_header_t*>(data);
+  if (memcmp(header->magic, kBootImageMagic, sizeof(kBootImageMagic)) != 0 ||
+      header->version != kBootImageVersion ||
+      header->addr_size != sizeof(ElfW(Addr)) ||
+      header->context_hash != g_boot_image_context_hash ||
+      header->strtab_size == 0) {
+    return false;
+  }
+
+  uint64_t tables_size = sizeof(boot_image_header_t) +
+                         static_cast<uint64_t>(header->entry_count) * sizeof(boot_image_entry_t) +
+                         static_cast<uint64_t>(header->segment_count) * sizeof(boot_image_segment_t) +
+                         header->strtab_size;
+  if (tables_size > size) {
+    return false;
+  }
+
+  const boot_image_entry_t* entries = reinterpret_cast<const boot_image_entry_t*>(header + 1);
+  const boot_image_segment_t* segments =
+      reinterpret_cast<const boot_image_segment_t*>(entries + header->entry_count);
+  const char* strtab = reinterpret_cast<const char*>(segments + header->segment_count);
+  if (strtab[header->strtab_size - 1] != '\0') {
+    return false;
+  }
+
+  for (uint32_t i = 0; i < header->segment_count; ++i) {
+    const boot_image_segment_t& segment = segments[i];
+    if ((segment.start % PAGE_SIZE) != 0 ||
+        (segment.size % PAGE_SIZE) != 0 ||
+        (segment.file_offset % PAGE_SIZE) != 0 ||
+        segment.file_offset < tables_size ||
+        segment.file_offset > size ||
+        segment.size > size - segment.file_offset) {
+      return false;
+    }
+  }
+
+  for (uint32_t i = 0; i < header->entry_count; ++i) {
+    const boot_image_entry_t* entry = entries + i;
+    if (entry->realpath_offset >= header->strtab_size ||
+        entry->first_segment > header->segment_count ||
+        entry->segment_count > header->segment_count - entry->first_segment) {
+      return false;
+    }
+    for (uint32_t j = 0; j < entry->segment_count; ++j) {
+      const boot_image_segment_t& segment = segments[entry->first_segment + j];
+      if (segment.start < entry->base || segment.start - entry->base > entry->size ||
+          segment.size > entry->size - (segment.start - entry->base)) {
+        return false;
+      }
+    }
+    if (!g_boot_image_entries.emplace(strtab + entry->realpath_offset, entry).second) {
+      return false;
+    }
+  }
+
+  g_boot_image_segments = segments;
+  g_boot_image_entry_count = header->entry_count;
+  return true;
+}
+
+static void close_boot_image() {
+  if (g_boot_image_map != nullptr) {
+    munmap(const_cast<uint8_t*>(g_boot_image_map), g_boot_image_size);
+    g_boot_image_map = nullptr;
+  }
+  if (g_boot_image_fd != -1) {
+    close(g_boot_image_fd);
+    g_boot_image_fd = -1;
+  }
+  g_boot_image_segments = nullptr;
+  g_boot_image_entries.clear();
+}
+
+void boot_image_init(const char* path, const char* linker_path, ElfW(Addr) linker_base,
+                     const char* ld_library_path, const char* ld_preload) {
+  if (path == nullptr || path[0] == '\0') {
+    return;
+  }
+
+  struct stat linker_stat;
+  if (linker_path == nullptr || TEMP_FAILURE_RETRY(stat(linker_path, &linker_stat)) != 0) {
+    PRINT("warning: boot image disabled: unable to stat the linker \"%s\"",
+          linker_path == nullptr ? "(null)" : linker_path);
+    return;
+  }
+
+  g_boot_image_path = path;
+  g_boot_image_context_hash = context_hash(linker_stat, linker_base, ld_library_path, ld_preload);
+
+  int fd = TEMP_FAILURE_RETRY(open(path, O_RDONLY | O_CLOEXEC | O_NOFOLLOW));
+  if (fd == -1) {
+    if (errno == ENOENT) {
+      INFO("[ boot image \"%s\" not found; recording it ]", path);
+      g_boot_image_state = kBootImageRecording;
+    } else {
+      PRINT("warning: unable to open boot image \"%s\": %s", path, strerror(errno));
+    }
+    return;
+  }
+
+  struct stat file_stat;
+  if (TEMP_FAILURE_RETRY(fstat(fd, &file_stat)) != 0 ||
+      !S_ISREG(file_stat.st_mode) || !file_is_trusted(file_stat)) {
+    PRINT("warning: ignoring untrusted boot image \"%s\"", path);
+    close(fd);
+    return;
+  }
+
+  size_t size = static_cast<size_t>(file_stat.st_size);
+  void* map = size == 0 ? MAP_FAILED : mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (map == MAP_FAILED) {
+    PRINT("warning: unable to map boot image \"%s\": %s", path, strerror(errno));
+    close(fd);
+    return;
+  }
+
+  g_boot_image_fd = fd;
+  g_boot_image_map = static_cast<const uint8_t*>(map);
+  g_boot_image_size = size;
+
+  if (!parse_boot_image(g_boot_image_map, g_boot_image_size)) {
+    // Replace it with one that matches this process.
+    INFO("[ boot image \"%s\" is stale or invalid; recording it again ]", path);
+    close_boot_image();
+    g_boot_image_state = kBootImageRecording;
+    return;
+  }
+
+  g_boot_image_state = kBootImageRestoring;
+}
+
+void* boot_image_get_load_start(const char* realpath) {
+  if (g_boot_image_state != kBootImageRestoring || g_boot_image_checked) {
+    return nullptr;
+  }
+
+  auto it = g_boot_image_entries.find(realpath);
+  if (it == g_boot_image_entries.end()) {
+    return nullptr;
+  }
+  return reinterpret_cast<void*>(static_cast<uintptr_t>(it->second->base));
+}
+
+// The libraries' writable segments point into each other, so the image is
+// all or nothing: every library of the closure needs to be the file that
+// was recorded, at the address it was recorded at.
+static bool closure_matches_boot_image() {
+  size_t count = 0;
+  for (soinfo* si = solist_get_head(); si != nullptr; si = si->next) {
+    if (si->size == 0 || si->is_linker()) {
+      continue;
+    }
+
+    auto it = g_boot_image_entries.find(si->get_realpath());
+    if (it == g_boot_image_entries.end()) {
+      INFO("[ boot image: \"%s\" was not recorded ]", si->get_realpath());
+      return false;
+    }
+
+    const boot_image_entry_t* entry = it->second;
+    if (entry->identity_hash != identity_hash(si) ||
+        entry->base != si->base ||
+        entry->load_bias != si->load_bias ||
+        entry->size != si->size) {
+      INFO("[ boot image: \"%s\" has changed or was loaded at a different address ]",
+           si->get_realpath());
+      return false;
+    }
+    ++count;
+  }
+
+  return count == g_boot_image_entry_count;
+}
+
+bool boot_image_restore(soinfo* si, bool* restored) {
+  *restored = false;
+
+  // Note that the linker links itself before its globals are initialized;
+  // g_boot_image_state is zero-initialized and kBootImageDisabled.
+  if (g_boot_image_state != kBootImageRestoring) {
+    return true;
+  }
+
+  if (!g_boot_image_checked) {
+    // All of the closure is loaded before any of it is linked.
+    g_boot_image_checked = true;
+    if (!closure_matches_boot_image()) {
+      INFO("[ not using boot image \"%s\" ]", g_boot_image_path.c_str());
+      close_boot_image();
+      g_boot_image_state = kBootImageDisabled;
+      return true;
+    }
+  }
+
+  auto it = g_boot_image_entries.find(si->get_realpath());
+  if (it == g_boot_image_entries.end() || it->second->base != si->base) {
+    return true;
+  }
+
+  const boot_image_entry_t* entry = it->second;
+  for (uint32_t i = 0; i < entry->segment_count; ++i) {
+    const boot_image_segment_t& segment = g_boot_image_segments[entry->first_segment + i];
+    void* start = reinterpret_cast<void*>(static_cast<uintptr_t>(segment.start));
+    void* map = mmap(start, segment.size, segment.prot, MAP_PRIVATE | MAP_FIXED,
+                     g_boot_image_fd, segment.file_offset);
+    if (map == MAP_FAILED) {
+      DL_ERR("can't map boot image segment for \"%s\": %s", si->get_realpath(), strerror(errno));
+      return false;
+    }
+  }
+
+  TRACE("[ \"%s\" restored from boot image ]", si->get_realpath());
+  *restored = true;
+  return true;
+}
+
+static ElfW(Addr) segment_page_start(const soinfo* si, const ElfW(Phdr)* phdr) {
+  return PAGE_START(phdr->p_vaddr + si->load_bias);
+}
+
+static ElfW(Addr) segment_page_end(const soinfo* si, const ElfW(Phdr)* phdr) {
+  return PAGE_END(phdr->p_vaddr + phdr->p_memsz + si->load_bias);
+}
+
+// Adds the writable segments of si to segments, or returns false if they
+// can't be restored by mapping whole pages.
+static bool add_writable_segments(const soinfo* si, std::vector<boot_image_segment_t>* segments) {
+  for (size_t i = 0; i < si->phnum; ++i) {
+    const ElfW(Phdr)* phdr = &si->phdr[i];
+    if (phdr->p_type != PT_LOAD || (phdr->p_flags & PF_W) == 0) {
+      continue;
+    }
+
+    if ((phdr->p_flags & PF_R) == 0) {
+      return false;
+    }
+
+    ElfW(Addr) start = segment_page_start(si, phdr);
+    ElfW(Addr) end = segment_page_end(si, phdr);
+    for (size_t j = 0; j < si->phnum; ++j) {
+      const ElfW(Phdr)* other = &si->phdr[j];
+      if (j != i && other->p_type == PT_LOAD &&
+          segment_page_start(si, other) < end && start < segment_page_end(si, other)) {
+        return false;
+      }
+    }
+
+    boot_image_segment_t segment;
+    memset(&segment, 0, sizeof(segment));
+    segment.start = start;
+    segment.size = end - start;
+    segment.prot = PROT_READ | PROT_WRITE | ((phdr->p_flags & PF_X) != 0 ? PROT_EXEC : 0);
+    segments->push_back(segment);
+  }
+  return true;
+}
+
+static void write_boot_image() {
+  std::vector<boot_image_entry_t> entries;
+  std::vector<boot_image_segment_t> segments;
+  std::string strtab;
+  std::unordered_set<std::string> realpaths;
+
+  for (soinfo* si = solist_get_head(); si != nullptr; si = si->next) {
+    if (si->size == 0 || si->is_linker()) {
+      continue;
+    }
+
+    const char* realpath = si->get_realpath();
+    bool can_record = realpaths.insert(realpath).second && !si->is_lazy_bind();
+#if !defined(__LP64__)
+    can_record = can_record && !si->has_text_relocations;
+#endif
+
+    boot_image_entry_t entry;
+    memset(&entry, 0, sizeof(entry));
+    entry.first_segment = segments.size();
+    if (!can_record || !add_writable_segments(si, &segments)) {
+      INFO("[ not recording boot image: can't restore \"%s\" ]", realpath);
+      return;
+    }
+
+    entry.identity_hash = identity_hash(si);
+    entry.base = si->base;
+    entry.load_bias = si->load_bias;
+    entry.size = si->size;
+    entry.realpath_offset = strtab.size();
+    entry.segment_count = segments.size() - entry.first_segment;
+    entries.push_back(entry);
+
+    strtab.append(realpath, strlen(realpath) + 1);
+  }
+
+  boot_image_header_t header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, kBootImageMagic, sizeof(kBootImageMagic));
+  header.version = kBootImageVersion;
+  header.addr_size = sizeof(ElfW(Addr));
+  header.entry_count = entries.size();
+  header.segment_count = segments.size();
+  header.strtab_size = strtab.size() + 1;
+  header.context_hash = g_boot_image_context_hash;
+
+  size_t tables_size = sizeof(header) +
+                       entries.size() * sizeof(boot_image_entry_t) +
+                       segments.size() * sizeof(boot_image_segment_t) +
+                       header.strtab_size;
+  size_t file_offset = PAGE_END(tables_size);
+  for (auto& segment : segments) {
+    segment.file_offset = file_offset;
+    file_offset += segment.size;
+  }
+
+  // Other processes may be recording the same image - write to a
+  // temporary file and rename it into place.
+  std::string tmp_path = android::base::StringPrintf("%s.%d.tmp",
+                                                     g_boot_image_path.c_str(), getpid());
+  int fd = TEMP_FAILURE_RETRY(open(tmp_path.c_str(),
+                                   O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC | O_NOFOLLOW, 0644));
+  if (fd == -1) {
+    PRINT("warning: unable to create boot image \"%s\": %s", tmp_path.c_str(), strerror(errno));
+    return;
+  }
+
+  // The string table is followed by '\0' padding up to the first page.
+  std::vector<char> padding(PAGE_END(tables_size) - tables_size + 1, '\0');
+  bool success = write_fully(fd, &header, sizeof(header)) &&
+                 write_fully(fd, entries.data(), entries.size() * sizeof(boot_image_entry_t)) &&
+                 write_fully(fd, segments.data(), segments.size() * sizeof(boot_image_segment_t)) &&
+                 write_fully(fd, strtab.data(), strtab.size()) &&
+                 write_fully(fd, padding.data(), padding.size());
+  for (const auto& segment : segments) {
+    if (!success) {
+      break;
+    }
+    success = write_fully(fd, reinterpret_cast<void*>(static_cast<uintptr_t>(segment.start)),
+                          segment.size);
+  }
+
+  close(fd);
+
+  if (!success || rename(tmp_path.c_str(), g_boot_image_path.c_str()) != 0) {
+    PRINT("warning: unable to write boot image \"%s\": %s",
+          g_boot_image_path.c_str(), strerror(errno));
+    unlink(tmp_path.c_str());
+  } else {
+    INFO("[ recorded boot image \"%s\" ]", g_boot_image_path.c_str());
+  }
+}
+
+void boot_image_finish() {
+  if (g_boot_image_state == kBootImageRecording) {
+    write_boot_image();
+  }
+
+  close_boot_image();
+  g_boot_image_state = kBootImageDisabled;
+}
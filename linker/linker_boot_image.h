@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef __LINKER_BOOT_IMAGE_H
+#define __LINKER_BOOT_IMAGE_H
+
+#include "linker_soinfo.h"
+
+// A boot image holds the relocated writable segments of every library in
+// the initial closure of a process (the executable, LD_PRELOADs and their
+// DT_NEEDED dependencies) and the address each one was loaded at. It is
+// enabled by setting LD_BOOT_IMAGE to the path of the image file. If the
+// file does not exist, the linker records it once the closure is linked,
+// so running the program once at build time produces the image. If it
+// does exist, each library of the closure is loaded at its recorded
+// address and has its writable segments mapped from the image instead of
+// being relocated.
+//
+// The image is only used if the files it was recorded from (path, st_dev,
+// st_ino, st_mtime), the linker binary and its address, LD_LIBRARY_PATH
+// and LD_PRELOAD are unchanged, and every library of the closure could be
+// loaded at its recorded address. Otherwise the closure is relocated as
+// usual. The executable and the linker are placed by the kernel, so this
+// needs address space randomization to be off. Images are only used if
+// they are owned by root or the current user and are not writable by
+// anyone else. IFUNC resolvers are not called again when an image is
+// used, so they must not have side effects outside their library's
+// writable segments.
+void boot_image_init(const char* path, const char* linker_path, ElfW(Addr) linker_base,
+                     const char* ld_library_path, const char* ld_preload);
+
+// Returns the address the library at realpath was loaded at when the image
+// was recorded, or nullptr.
+void* boot_image_get_load_start(const char* realpath);
+
+// Called by link_image() in place of relocation. Sets *restored if the
+// writable segments of si were mapped from the image; returns false if
+// they could not be.
+bool boot_image_restore(soinfo* si, bool* restored);
+
+// Called once the initial closure is linked. Writes the image if it is
+// being recorded; later dlopen()s do not use it.
+void boot_image_finish();
+
+#endif  /* __LINKER_BOOT_IMAGE_H */
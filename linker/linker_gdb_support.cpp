@@ -19,6 +19,7 @@
 #include <pthread.h>
 
 #include "private/ScopedPthreadMutexLocker.h"
+#include "private/bionic_sections.h"
 
 // This function is an empty stub where GDB locates a breakpoint to get notified
 // about linker activity.
@@ -28,8 +29,8 @@ void __attribute__((noinline)) __attribute__((visibility("default"))) rtld_db_dl
 r_debug _r_debug =
     {1, nullptr, reinterpret_cast<uintptr_t>(&rtld_db_dlactivity), r_debug::RT_CONSISTENT, 0};
 
-static pthread_mutex_t g__r_debug_mutex = PTHREAD_MUTEX_INITIALIZER;
-static link_map* r_debug_tail = nullptr;
+static pthread_mutex_t g__r_debug_mutex __BIONIC_FORK_WRITTEN = PTHREAD_MUTEX_INITIALIZER;
+static link_map* r_debug_tail __BIONIC_FORK_WRITTEN = nullptr;
 
 void insert_link_map_into_debug_map(link_map* map) {
   // Stick the new library at the end of the list.
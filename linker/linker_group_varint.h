@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _LINKER_GROUP_VARINT_H
+#define _LINKER_GROUP_VARINT_H
+
+#include <stdint.h>
+#include <string.h>
+
+#include "linker_debug.h"
+
+// Decodes the values of APS3 packed relocations, which are those of APS2 in
+// blocks of four: a tag byte whose bit pairs, lowest first, give each value's
+// length (1, 2, 4 or 8 bytes), then the four values, little-endian and
+// zigzag-encoded so that small negative deltas stay small. A block is decoded
+// in one step, with no per-byte loop or branch; the stream ends with whole
+// blocks, padded with zeros.
+class group_varint_decoder {
+ public:
+  group_varint_decoder(const uint8_t* buffer, size_t count)
+      : current_(buffer), end_(buffer + count), index_(4) { }
+
+  size_t pop_front() {
+    if (index_ == 4) {
+      decode_block();
+    }
+    return values_[index_++];
+  }
+
+ private:
+  void decode_block() {
+    static const uint64_t kMasks[4] = { 0xff, 0xffff, 0xffffffff, UINT64_MAX };
+    static const uint8_t kLengths[4] = { 1, 2, 4, 8 };
+
+    if (current_ >= end_) {
+      __libc_fatal("group_varint_decoder ran out of bounds");
+    }
+    const uint8_t tag = *current_++;
+    if (end_ - current_ >= 32) {
+      // Every value can be read as 8 bytes and masked.
+      for (size_t i = 0; i < 4; ++i) {
+        const size_t code = (tag >> (2 * i)) & 3;
+        uint64_t value;
+        memcpy(&value, current_, sizeof(value));
+        value &= kMasks[code];
+        current_ += kLengths[code];
+        values_[i] = static_cast<size_t>((value >> 1) ^ -(value & 1));
+      }
+    } else {
+      for (size_t i = 0; i < 4; ++i) {
+        const size_t code = (tag >> (2 * i)) & 3;
+        if (static_cast<size_t>(end_ - current_) < kLengths[code]) {
+          __libc_fatal("group_varint_decoder ran out of bounds");
+        }
+        uint64_t value = 0;
+        memcpy(&value, current_, kLengths[code]);
+        current_ += kLengths[code];
+        values_[i] = static_cast<size_t>((value >> 1) ^ -(value & 1));
+      }
+    }
+    index_ = 0;
+  }
+
+  const uint8_t* current_;
+  const uint8_t* const end_;
+  size_t values_[4];
+  size_t index_;
+};
+
+#endif // _LINKER_GROUP_VARINT_H
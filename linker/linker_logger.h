@@ -40,6 +40,7 @@
 
 constexpr const uint32_t kLogErrors = 1 << 0;
 constexpr const uint32_t kLogDlopen = 1 << 1;
+constexpr const uint32_t kLogProfile = 1 << 2;
 
 class LinkerLogger {
  public:
@@ -47,6 +48,7 @@ class LinkerLogger {
 
   void ResetState();
   void Log(uint32_t type, const char* format, ...);
+  bool IsEnabled(uint32_t type) const { return (flags_ & type) != 0; }
  private:
   uint32_t flags_;
 
@@ -28,10 +28,14 @@
 
 #include "linker_main.h"
 
+#include "linker_boot_image.h"
 #include "linker_debug.h"
 #include "linker_gdb_support.h"
 #include "linker_globals.h"
 #include "linker_phdr.h"
+#include "linker_profile.h"
+#include "linker_relro_store.h"
+#include "linker_symbol_cache.h"
 #include "linker_utils.h"
 
 #include "private/bionic_globals.h"
@@ -42,6 +46,8 @@
 #include "android-base/stringprintf.h"
 #include "debuggerd/client.h"
 
+#include <string.h>
+
 #include <vector>
 
 extern void __libc_init_globals(KernelArgumentBlock&);
@@ -60,9 +66,16 @@ static soinfo* solist;
 static soinfo* sonext;
 static soinfo* somain; // main process, always the one after libdl_info
 
+// dlpi_adds/dlpi_subs for dl_iterate_phdr().
+static unsigned long long g_solist_adds;
+static unsigned long long g_solist_subs;
+
 void solist_add_soinfo(soinfo* si) {
   sonext->next = si;
   sonext = si;
+  ++g_solist_adds;
+  invalidate_dl_phdr_snapshot();
+  invalidate_address_index();
 }
 
 bool solist_remove_soinfo(soinfo* si) {
@@ -87,6 +100,9 @@ bool solist_remove_soinfo(soinfo* si) {
     sonext = prev;
   }
 
+  ++g_solist_subs;
+  invalidate_dl_phdr_snapshot();
+  invalidate_address_index();
   return true;
 }
 
@@ -94,6 +110,14 @@ soinfo* solist_get_head() {
   return solist;
 }
 
+unsigned long long solist_get_adds() {
+  return g_solist_adds;
+}
+
+unsigned long long solist_get_subs() {
+  return g_solist_subs;
+}
+
 soinfo* solist_get_somain() {
   return somain;
 }
@@ -243,6 +267,9 @@ static ElfW(Addr) __linker_init_post_relocation(KernelArgumentBlock& args, ElfW(
   // doesn't cost us anything.
   const char* ldpath_env = nullptr;
   const char* ldpreload_env = nullptr;
+  const char* ldsymcache_env = nullptr;
+  const char* ldrelrostore_env = nullptr;
+  const char* ldbootimage_env = nullptr;
   if (!getauxval(AT_SECURE)) {
     ldpath_env = getenv("LD_LIBRARY_PATH");
     if (ldpath_env != nullptr) {
@@ -252,6 +279,33 @@ static ElfW(Addr) __linker_init_post_relocation(KernelArgumentBlock& args, ElfW(
     if (ldpreload_env != nullptr) {
       INFO("[ LD_PRELOAD set to \"%s\" ]", ldpreload_env);
     }
+    ldbootimage_env = getenv("LD_BOOT_IMAGE");
+    if (ldbootimage_env != nullptr) {
+      INFO("[ LD_BOOT_IMAGE set to \"%s\" ]", ldbootimage_env);
+    }
+    ldsymcache_env = getenv("LD_SYMBOL_CACHE");
+    if (ldsymcache_env != nullptr) {
+      INFO("[ LD_SYMBOL_CACHE set to \"%s\" ]", ldsymcache_env);
+    }
+    ldrelrostore_env = getenv("LD_RELRO_STORE");
+    if (ldrelrostore_env != nullptr) {
+      INFO("[ LD_RELRO_STORE set to \"%s\" ]", ldrelrostore_env);
+    }
+    const char* ldparallel_env = getenv("LD_PARALLEL_LOAD");
+    if (ldparallel_env != nullptr) {
+      INFO("[ LD_PARALLEL_LOAD set to \"%s\" ]", ldparallel_env);
+      int thread_count = atoi(ldparallel_env);
+      set_parallel_load_threads(thread_count > 0 ? thread_count : 0);
+    }
+    const char* ldreadahead_env = getenv("LD_READAHEAD");
+    if (ldreadahead_env != nullptr) {
+      INFO("[ LD_READAHEAD set to \"%s\" ]", ldreadahead_env);
+      if (strcmp(ldreadahead_env, "text") == 0) {
+        set_readahead_mode(kReadaheadText);
+      } else if (strcmp(ldreadahead_env, "file") == 0) {
+        set_readahead_mode(kReadaheadFile);
+      }
+    }
   }
 
   struct stat file_stat;
@@ -314,6 +368,13 @@ static ElfW(Addr) __linker_init_post_relocation(KernelArgumentBlock& args, ElfW(
 
   init_default_namespace();
 
+  relro_store_init(ldrelrostore_env);
+
+  const char* interpreter_name =
+      phdr_table_get_interpreter_name(si->phdr, si->phnum, si->load_bias);
+  symbol_cache_init(ldsymcache_env, interpreter_name);
+  boot_image_init(ldbootimage_env, interpreter_name, linker_base, ldpath_env, ldpreload_env);
+
   if (!si->prelink_image()) {
     __libc_fatal("CANNOT LINK EXECUTABLE \"%s\": %s", g_argv[0], linker_get_error_buffer());
   }
@@ -349,6 +410,9 @@ static ElfW(Addr) __linker_init_post_relocation(KernelArgumentBlock& args, ElfW(
     si->increment_ref_count();
   }
 
+  symbol_cache_flush();
+  boot_image_finish();
+
   add_vdso(args);
 
   {
@@ -365,6 +429,8 @@ static ElfW(Addr) __linker_init_post_relocation(KernelArgumentBlock& args, ElfW(
     si->call_constructors();
   }
 
+  profile_report("startup", g_argv[0]);
+
 #if TIMING
   gettimeofday(&t1, nullptr);
   PRINT("LINKER TIME: %s: %d microseconds", g_argv[0], (int) (
@@ -522,6 +588,7 @@ extern "C" ElfW(Addr) __linker_init(void* raw_args) {
   // before get_libdl_info().
   solist = get_libdl_info();
   sonext = get_libdl_info();
+  g_solist_adds = 1;
   g_default_namespace.add_soinfo(get_libdl_info());
 
   // We have successfully fixed our own relocations. It's safe to run
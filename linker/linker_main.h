@@ -60,9 +60,23 @@ bool find_libraries(android_namespace_t* ns,
                     const android_dlextinfo* extinfo,
                     bool add_as_children);
 
+void set_parallel_load_threads(size_t thread_count);
+
+enum ReadaheadMode {
+  kReadaheadNone,
+  // Read every library file ahead as soon as it is opened.
+  kReadaheadFile,
+  // kReadaheadFile, and also fault in the mapped executable segments.
+  kReadaheadText,
+};
+
+void set_readahead_mode(ReadaheadMode mode);
+
 void solist_add_soinfo(soinfo* si);
 bool solist_remove_soinfo(soinfo* si);
 soinfo* solist_get_head();
 soinfo* solist_get_somain();
+unsigned long long solist_get_adds();
+unsigned long long solist_get_subs();
 
 #endif
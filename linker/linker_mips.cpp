@@ -33,28 +33,37 @@
 #include "linker.h"
 #include "linker_debug.h"
 #include "linker_globals.h"
+#include "linker_group_varint.h"
 #include "linker_phdr.h"
 #include "linker_relocs.h"
 #include "linker_reloc_iterators.h"
 #include "linker_sleb128.h"
 #include "linker_soinfo.h"
+#include "linker_symbol_cache.h"
 
 template bool soinfo::relocate<plain_reloc_iterator>(const VersionTracker& version_tracker,
                                                      plain_reloc_iterator&& rel_iterator,
-                                                     const soinfo_list_t& global_group,
-                                                     const soinfo_list_t& local_group);
+                                                     SymbolLookupSession& lookup_session);
 
 template bool soinfo::relocate<packed_reloc_iterator<sleb128_decoder>>(
     const VersionTracker& version_tracker,
     packed_reloc_iterator<sleb128_decoder>&& rel_iterator,
-    const soinfo_list_t& global_group,
-    const soinfo_list_t& local_group);
+    SymbolLookupSession& lookup_session);
+
+template bool soinfo::relocate<packed_reloc_iterator<group_varint_decoder>>(
+    const VersionTracker& version_tracker,
+    packed_reloc_iterator<group_varint_decoder>&& rel_iterator,
+    SymbolLookupSession& lookup_session);
 
 template <typename ElfRelIteratorT>
 bool soinfo::relocate(const VersionTracker& version_tracker,
                       ElfRelIteratorT&& rel_iterator,
-                      const soinfo_list_t& global_group,
-                      const soinfo_list_t& local_group) {
+                      SymbolLookupSession& lookup_session) {
+  // As in linker.cpp, reuse the previous relocation's lookup for the same symbol.
+  ElfW(Word) last_sym = 0;
+  const ElfW(Sym)* last_s = nullptr;
+  soinfo* last_lsi = nullptr;
+
   for (size_t idx = 0; rel_iterator.has_next(); ++idx) {
     const auto rel = rel_iterator.next();
 
@@ -79,14 +88,23 @@ bool soinfo::relocate(const VersionTracker& version_tracker,
 
     if (sym != 0) {
       sym_name = get_string(symtab_[sym].st_name);
-      const version_info* vi = nullptr;
 
-      if (!lookup_version_info(version_tracker, sym, sym_name, &vi)) {
-        return false;
-      }
+      if (sym == last_sym) {
+        s = last_s;
+        lsi = last_lsi;
+      } else {
+        const version_info* vi = nullptr;
 
-      if (!soinfo_do_lookup(this, sym_name, vi, &lsi, global_group, local_group, &s)) {
-        return false;
+        if (!lookup_version_info(version_tracker, sym, sym_name, &vi)) {
+          return false;
+        }
+
+        if (!lookup_session.lookup(sym, sym_name, vi, &lsi, &s)) {
+          return false;
+        }
+        last_sym = sym;
+        last_s = s;
+        last_lsi = lsi;
       }
 
       if (s == nullptr) {
@@ -133,8 +151,7 @@ bool soinfo::relocate(const VersionTracker& version_tracker,
 }
 
 bool soinfo::mips_relocate_got(const VersionTracker& version_tracker,
-                               const soinfo_list_t& global_group,
-                               const soinfo_list_t& local_group) {
+                               SymbolLookupSession& lookup_session) {
   ElfW(Addr)** got = plt_got_;
   if (got == nullptr) {
     return true;
@@ -174,7 +191,7 @@ bool soinfo::mips_relocate_got(const VersionTracker& version_tracker,
         return false;
       }
 
-      if (!soinfo_do_lookup(this, sym_name, vi, &lsi, global_group, local_group, &s)) {
+      if (!lookup_session.lookup(sym, sym_name, vi, &lsi, &s)) {
         return false;
       }
     } else if (st_visibility == STV_PROTECTED) {
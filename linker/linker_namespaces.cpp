@@ -27,10 +27,98 @@
  */
 
 #include "linker_namespaces.h"
+#include "linker_soinfo.h"
 #include "linker_utils.h"
 
+#include <string.h>
+
+#include <algorithm>
 #include <vector>
 
+static void remove_from_bucket(std::vector<soinfo*>* bucket, soinfo* si) {
+  bucket->erase(std::remove(bucket->begin(), bucket->end(), si), bucket->end());
+}
+
+void android_namespace_t::add_to_soname_index(soinfo* si, const char* soname,
+                                              bool is_last) {
+  if (soname == nullptr) {
+    return;
+  }
+
+  std::vector<soinfo*>& bucket = soname_index_[soname];
+  if (!bucket.empty() && !is_last) {
+    // Another library already has this soname and si is not at the end of
+    // soinfo_list_; rebuild the bucket to keep it in list order. This is rare.
+    bucket.clear();
+    soinfo_list_.for_each([&](soinfo* candidate) {
+      const char* candidate_soname = candidate->get_soname();
+      if (candidate == si ||
+          (candidate_soname != nullptr && strcmp(candidate_soname, soname) == 0)) {
+        bucket.push_back(candidate);
+      }
+    });
+  } else {
+    bucket.push_back(si);
+  }
+}
+
+void android_namespace_t::remove_from_soname_index(soinfo* si, const char* soname) {
+  if (soname == nullptr) {
+    return;
+  }
+
+  auto it = soname_index_.find(soname);
+  if (it != soname_index_.end()) {
+    remove_from_bucket(&it->second, si);
+    if (it->second.empty()) {
+      soname_index_.erase(it);
+    }
+  }
+}
+
+void android_namespace_t::index_soinfo(soinfo* si) {
+  add_to_soname_index(si, si->get_soname(), true);
+
+  file_key_t key = { si->get_st_dev(), si->get_st_ino(), si->get_file_offset() };
+  file_index_[key].push_back(si);
+}
+
+void android_namespace_t::unindex_soinfo(soinfo* si) {
+  remove_from_soname_index(si, si->get_soname());
+
+  file_key_t key = { si->get_st_dev(), si->get_st_ino(), si->get_file_offset() };
+  auto it = file_index_.find(key);
+  if (it != file_index_.end()) {
+    remove_from_bucket(&it->second, si);
+    if (it->second.empty()) {
+      file_index_.erase(it);
+    }
+  }
+}
+
+void android_namespace_t::update_soname(soinfo* si, const char* old_soname) {
+  const char* new_soname = si->get_soname();
+  if (old_soname == new_soname ||
+      (old_soname != nullptr && new_soname != nullptr && strcmp(old_soname, new_soname) == 0)) {
+    return;
+  }
+
+  remove_from_soname_index(si, old_soname);
+  add_to_soname_index(si, new_soname, false);
+}
+
+const std::vector<soinfo*>* android_namespace_t::find_soinfos_by_soname(const char* soname) const {
+  auto it = soname_index_.find(soname);
+  return it == soname_index_.end() ? nullptr : &it->second;
+}
+
+const std::vector<soinfo*>* android_namespace_t::find_soinfos_by_file(dev_t st_dev, ino_t st_ino,
+                                                                       off64_t file_offset) const {
+  file_key_t key = { st_dev, st_ino, file_offset };
+  auto it = file_index_.find(key);
+  return it == file_index_.end() ? nullptr : &it->second;
+}
+
 bool android_namespace_t::is_accessible(const std::string& file) {
   if (!is_isolated_) {
     return true;
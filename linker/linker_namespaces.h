@@ -31,12 +31,15 @@
 
 #include "linker_common_types.h"
 
+#include <sys/types.h>
+
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 struct android_namespace_t {
  public:
-  android_namespace_t() : name_(nullptr), is_isolated_(false) {}
+  android_namespace_t() : name_(nullptr), is_isolated_(false), is_huge_page_aligned_(false) {}
 
   const char* get_name() const { return name_; }
   void set_name(const char* name) { name_ = name; }
@@ -44,6 +47,9 @@ struct android_namespace_t {
   bool is_isolated() const { return is_isolated_; }
   void set_isolated(bool isolated) { is_isolated_ = isolated; }
 
+  bool is_huge_page_aligned() const { return is_huge_page_aligned_; }
+  void set_huge_page_aligned(bool huge_page_aligned) { is_huge_page_aligned_ = huge_page_aligned; }
+
   const std::vector<std::string>& get_ld_library_paths() const {
     return ld_library_paths_;
   }
@@ -67,6 +73,7 @@ struct android_namespace_t {
 
   void add_soinfo(soinfo* si) {
     soinfo_list_.push_back(si);
+    index_soinfo(si);
   }
 
   void add_soinfos(const soinfo_list_t& soinfos) {
@@ -79,10 +86,21 @@ struct android_namespace_t {
     soinfo_list_.remove_if([&](soinfo* candidate) {
       return si == candidate;
     });
+    unindex_soinfo(si);
   }
 
   const soinfo_list_t& soinfo_list() const { return soinfo_list_; }
 
+  // The soinfos of this namespace with the given soname or file identity, in
+  // soinfo_list() order; nullptr if there are none.
+  const std::vector<soinfo*>* find_soinfos_by_soname(const char* soname) const;
+  const std::vector<soinfo*>* find_soinfos_by_file(dev_t st_dev, ino_t st_ino,
+                                                   off64_t file_offset) const;
+
+  // Must be called by soinfo::set_soname() for every namespace the soinfo
+  // belongs to, since the soname is only known after the soinfo was added.
+  void update_soname(soinfo* si, const char* old_soname);
+
   // For isolated namespaces - checks if the file is on the search path;
   // always returns true for not isolated namespace.
   bool is_accessible(const std::string& path);
@@ -90,11 +108,39 @@ struct android_namespace_t {
  private:
   const char* name_;
   bool is_isolated_;
+  bool is_huge_page_aligned_;
   std::vector<std::string> ld_library_paths_;
   std::vector<std::string> default_library_paths_;
   std::vector<std::string> permitted_paths_;
   soinfo_list_t soinfo_list_;
 
+  struct file_key_t {
+    dev_t st_dev;
+    ino_t st_ino;
+    off64_t file_offset;
+
+    bool operator==(const file_key_t& that) const {
+      return st_dev == that.st_dev && st_ino == that.st_ino && file_offset == that.file_offset;
+    }
+  };
+
+  struct file_key_hash_t {
+    size_t operator()(const file_key_t& key) const {
+      return std::hash<uint64_t>()(key.st_ino) ^ (std::hash<uint64_t>()(key.st_dev) << 1) ^
+             std::hash<int64_t>()(key.file_offset);
+    }
+  };
+
+  void index_soinfo(soinfo* si);
+  void unindex_soinfo(soinfo* si);
+  void add_to_soname_index(soinfo* si, const char* soname, bool is_last);
+  void remove_from_soname_index(soinfo* si, const char* soname);
+
+  // Indexes over soinfo_list_ so that find_library() does not have
+  // to compare every loaded library against every DT_NEEDED entry.
+  std::unordered_map<std::string, std::vector<soinfo*>> soname_index_;
+  std::unordered_map<file_key_t, std::vector<soinfo*>, file_key_hash_t> file_index_;
+
   DISALLOW_COPY_AND_ASSIGN(android_namespace_t);
 };
 
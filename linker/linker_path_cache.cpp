@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include "linker_path_cache.h"
+
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <unordered_map>
+#include <unordered_set>
+
+struct path_cache_dir_t {
+  uint64_t generation;
+  bool exists;
+  // False while the directory was modified too recently for a later
+  // change to be guaranteed to show up in st_mtime.
+  bool cacheable;
+  dev_t st_dev;
+  ino_t st_ino;
+  timespec st_mtim;
+  std::unordered_set<std::string> missing;
+};
+
+static uint64_t g_path_cache_generation = 1;
+static std::unordered_map<std::string, path_cache_dir_t> g_path_cache_dirs;
+
+static path_cache_dir_t& get_dir(const std::string& dir) {
+  path_cache_dir_t& entry = g_path_cache_dirs[dir];
+  if (entry.generation == g_path_cache_generation) {
+    return entry;
+  }
+
+  struct stat dir_stat;
+  bool exists = TEMP_FAILURE_RETRY(stat(dir.c_str(), &dir_stat)) == 0;
+  if (exists != entry.exists ||
+      (exists && (dir_stat.st_dev != entry.st_dev ||
+                  dir_stat.st_ino != entry.st_ino ||
+                  dir_stat.st_mtim.tv_sec != entry.st_mtim.tv_sec ||
+                  dir_stat.st_mtim.tv_nsec != entry.st_mtim.tv_nsec))) {
+    entry.missing.clear();
+    entry.exists = exists;
+    if (exists) {
+      entry.st_dev = dir_stat.st_dev;
+      entry.st_ino = dir_stat.st_ino;
+      entry.st_mtim = dir_stat.st_mtim;
+    }
+  }
+
+  entry.cacheable = true;
+  if (exists) {
+    timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    entry.cacheable = now.tv_sec - dir_stat.st_mtim.tv_sec > 1;
+  }
+
+  entry.generation = g_path_cache_generation;
+  return entry;
+}
+
+bool path_cache_is_missing(const std::string& dir, const char* name) {
+  const path_cache_dir_t& entry = get_dir(dir);
+  return !entry.exists || entry.missing.find(name) != entry.missing.end();
+}
+
+void path_cache_add_missing(const std::string& dir, const char* name) {
+  path_cache_dir_t& entry = get_dir(dir);
+  if (entry.cacheable) {
+    entry.missing.insert(name);
+  }
+}
+
+void path_cache_new_generation() {
+  ++g_path_cache_generation;
+}
+
+void path_cache_flush() {
+  g_path_cache_dirs.clear();
+}
@@ -35,6 +35,8 @@
 #include <sys/stat.h>
 #include <unistd.h>
 
+#include <algorithm>
+
 #include "linker.h"
 #include "linker_globals.h"
 #include "linker_debug.h"
@@ -141,7 +143,7 @@ ElfReader::ElfReader()
     : did_read_(false), did_load_(false), fd_(-1), file_offset_(0), file_size_(0), phdr_num_(0),
       phdr_table_(nullptr), shdr_table_(nullptr), shdr_num_(0), dynamic_(nullptr), strtab_(nullptr),
       strtab_size_(0), load_start_(nullptr), load_size_(0), load_bias_(0), loaded_phdr_(nullptr),
-      mapped_by_caller_(false) {
+      mapped_by_caller_(false), huge_page_aligned_(false), preferred_load_start_(nullptr) {
 }
 
 bool ElfReader::Read(const char* name, int fd, off64_t file_offset, off64_t file_size) {
@@ -163,10 +165,10 @@ bool ElfReader::Read(const char* name, int fd, off64_t file_offset, off64_t file
   return did_read_;
 }
 
-bool ElfReader::Load(const android_dlextinfo* extinfo) {
+bool ElfReader::Load(const android_dlextinfo* extinfo, bool huge_page_align) {
   CHECK(did_read_);
   CHECK(!did_load_);
-  if (ReserveAddressSpace(extinfo) &&
+  if (ReserveAddressSpace(extinfo, huge_page_align) &&
       LoadSegments() &&
       FindPhdr()) {
     did_load_ = true;
@@ -175,6 +177,20 @@ bool ElfReader::Load(const android_dlextinfo* extinfo) {
   return did_load_;
 }
 
+// Returns the number of bytes from the start of the ELF file that are
+// covered by its loadable segments.
+off64_t ElfReader::file_extent() const {
+  CHECK(did_read_);
+  off64_t extent = 0;
+  for (size_t i = 0; i < phdr_num_; ++i) {
+    const ElfW(Phdr)* phdr = &phdr_table_[i];
+    if (phdr->p_type == PT_LOAD) {
+      extent = std::max(extent, static_cast<off64_t>(phdr->p_offset + phdr->p_filesz));
+    }
+  }
+  return extent;
+}
+
 const char* ElfReader::get_string(ElfW(Word) index) const {
   CHECK(strtab_ != nullptr);
   CHECK(index < strtab_size_);
@@ -471,7 +487,10 @@ size_t phdr_table_get_load_size(const ElfW(Phdr)* phdr_table, size_t phdr_count,
 
 // Reserve a virtual address range such that if it's limits were extended to the next 2**align
 // boundary, it would not overlap with any existing mappings.
-static void* ReserveAligned(void* hint, size_t size, size_t align) {
+// Reserve a region of `size` bytes starting at an `align`-aligned address
+// plus a random multiple of `granularity`.
+static void* ReserveAligned(void* hint, size_t size, size_t align,
+                            size_t granularity = PAGE_SIZE) {
   int mmap_flags = MAP_PRIVATE | MAP_ANONYMOUS;
   // Address hint is only used in Art for the image mapping, and it is pretty important. Don't mess
   // with it.
@@ -496,17 +515,37 @@ static void* ReserveAligned(void* hint, size_t size, size_t align) {
 
   uint8_t* first = align_up(mmap_ptr, align);
   uint8_t* last = align_down(mmap_ptr + mmap_size, align) - size;
-  size_t n = arc4random_uniform((last - first) / PAGE_SIZE + 1);
-  uint8_t* start = first + n * PAGE_SIZE;
+  size_t n = arc4random_uniform((last - first) / granularity + 1);
+  uint8_t* start = first + n * granularity;
   munmap(mmap_ptr, start - mmap_ptr);
   munmap(start + size, mmap_ptr + mmap_size - (start + size));
   return start;
 }
 
+// Returns true if an executable segment is big enough to benefit from huge
+// pages and is laid out so that a huge page aligned load bias also aligns its
+// file offset, which is what file-backed transparent huge pages require.
+bool ElfReader::CanAlignToHugePages(ElfW(Addr) min_vaddr) {
+  if ((min_vaddr % kHugePageSize) != 0) {
+    return false;
+  }
+
+  for (size_t i = 0; i < phdr_num_; ++i) {
+    const ElfW(Phdr)* phdr = &phdr_table_[i];
+    if (phdr->p_type == PT_LOAD && (phdr->p_flags & PF_X) != 0 &&
+        phdr->p_filesz >= kHugePageSize &&
+        (file_offset_ + phdr->p_offset) % kHugePageSize == phdr->p_vaddr % kHugePageSize) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
 // Reserve a virtual address range big enough to hold all loadable
 // segments of a program header table. This is done by creating a
 // private anonymous mmap() with PROT_NONE.
-bool ElfReader::ReserveAddressSpace(const android_dlextinfo* extinfo) {
+bool ElfReader::ReserveAddressSpace(const android_dlextinfo* extinfo, bool huge_page_align) {
   ElfW(Addr) min_vaddr;
   load_size_ = phdr_table_get_load_size(phdr_table_, phdr_num_, &min_vaddr);
   if (load_size_ == 0) {
@@ -538,13 +577,23 @@ bool ElfReader::ReserveAddressSpace(const android_dlextinfo* extinfo) {
     }
   }
 
+  if (mmap_hint == nullptr) {
+    mmap_hint = preferred_load_start_;
+  }
+
   if (load_size_ > reserved_size) {
     if (!reserved_hint) {
       DL_ERR("reserved address space %zd smaller than %zd bytes needed for \"%s\"",
              reserved_size - load_size_, load_size_, name_.c_str());
       return false;
     }
-    start = ReserveAligned(mmap_hint, load_size_, kLibraryAlignment);
+    if (huge_page_align && mmap_hint == nullptr && CanAlignToHugePages(min_vaddr)) {
+      start = ReserveAligned(nullptr, load_size_, kHugePageSize, kHugePageSize);
+      huge_page_aligned_ = (start != nullptr);
+    }
+    if (!huge_page_aligned_) {
+      start = ReserveAligned(mmap_hint, load_size_, kLibraryAlignment);
+    }
     if (start == nullptr) {
       DL_ERR("couldn't reserve %zd bytes of address space for \"%s\"", load_size_, name_.c_str());
       return false;
@@ -621,6 +670,18 @@ bool ElfReader::LoadSegments() {
         DL_ERR("couldn't map \"%s\" segment %zd: %s", name_.c_str(), i, strerror(errno));
         return false;
       }
+
+      if (huge_page_aligned_ && (prot & PROT_EXEC) != 0) {
+        // Only whole huge pages inside the mapping can be collapsed; failure just
+        // means the kernel has no THP support for this mapping.
+        ElfW(Addr) huge_start = align_up(seg_page_start, kHugePageSize);
+        ElfW(Addr) huge_end = align_down(seg_page_start + file_length, kHugePageSize);
+        if (huge_start < huge_end &&
+            madvise(reinterpret_cast<void*>(huge_start), huge_end - huge_start,
+                    MADV_HUGEPAGE) == -1) {
+          DEBUG("\"%s\": MADV_HUGEPAGE failed: %s", name_.c_str(), strerror(errno));
+        }
+      }
     }
 
     // if the segment is writable, and does not end on a page boundary,
@@ -724,6 +785,32 @@ int phdr_table_unprotect_segments(const ElfW(Phdr)* phdr_table,
   return _phdr_table_set_load_prot(phdr_table, phdr_count, load_bias, PROT_WRITE);
 }
 
+/* Apply madvise() advice to all executable loadable segments.
+ *
+ * Input:
+ *   phdr_table  -> program header table
+ *   phdr_count  -> number of entries in tables
+ *   load_bias   -> load bias
+ *   advice      -> madvise() advice, e.g. MADV_WILLNEED
+ */
+void phdr_table_advise_text(const ElfW(Phdr)* phdr_table, size_t phdr_count,
+                            ElfW(Addr) load_bias, int advice) {
+  const ElfW(Phdr)* phdr = phdr_table;
+  const ElfW(Phdr)* phdr_limit = phdr + phdr_count;
+
+  for (; phdr < phdr_limit; phdr++) {
+    if (phdr->p_type != PT_LOAD || (phdr->p_flags & PF_X) == 0) {
+      continue;
+    }
+
+    ElfW(Addr) seg_page_start = PAGE_START(phdr->p_vaddr) + load_bias;
+    ElfW(Addr) seg_page_end   = PAGE_END(phdr->p_vaddr + phdr->p_filesz) + load_bias;
+
+    // This is only a hint; ignore failures.
+    madvise(reinterpret_cast<void*>(seg_page_start), seg_page_end - seg_page_start, advice);
+  }
+}
+
 /* Used internally by phdr_table_protect_gnu_relro and
  * phdr_table_unprotect_gnu_relro.
  */
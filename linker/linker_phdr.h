@@ -43,7 +43,10 @@ class ElfReader {
   ElfReader();
 
   bool Read(const char* name, int fd, off64_t file_offset, off64_t file_size);
-  bool Load(const android_dlextinfo* extinfo);
+  bool Load(const android_dlextinfo* extinfo, bool huge_page_align);
+  // Makes Load() try to reserve the address space at addr when extinfo
+  // does not ask for a particular address.
+  void set_preferred_load_start(void* addr) { preferred_load_start_ = addr; }
 
   const char* name() const { return name_.c_str(); }
   size_t phdr_count() const { return phdr_num_; }
@@ -54,6 +57,7 @@ class ElfReader {
   const ElfW(Dyn)* dynamic() const { return dynamic_; }
   const char* get_string(ElfW(Word) index) const;
   bool is_mapped_by_caller() const { return mapped_by_caller_; }
+  off64_t file_extent() const;
 
  private:
   bool ReadElfHeader();
@@ -61,7 +65,8 @@ class ElfReader {
   bool ReadProgramHeaders();
   bool ReadSectionHeaders();
   bool ReadDynamicSection();
-  bool ReserveAddressSpace(const android_dlextinfo* extinfo);
+  bool ReserveAddressSpace(const android_dlextinfo* extinfo, bool huge_page_align);
+  bool CanAlignToHugePages(ElfW(Addr) min_vaddr);
   bool LoadSegments();
   bool FindPhdr();
   bool CheckPhdr(ElfW(Addr));
@@ -103,6 +108,12 @@ class ElfReader {
 
   // Is map owned by the caller
   bool mapped_by_caller_;
+
+  // Is the executable segment mapped at a huge page aligned address
+  bool huge_page_aligned_;
+
+  // Address hint for the reservation, or nullptr
+  void* preferred_load_start_;
 };
 
 size_t phdr_table_get_load_size(const ElfW(Phdr)* phdr_table, size_t phdr_count,
@@ -114,6 +125,9 @@ int phdr_table_protect_segments(const ElfW(Phdr)* phdr_table,
 int phdr_table_unprotect_segments(const ElfW(Phdr)* phdr_table, size_t phdr_count,
                                   ElfW(Addr) load_bias);
 
+void phdr_table_advise_text(const ElfW(Phdr)* phdr_table, size_t phdr_count,
+                            ElfW(Addr) load_bias, int advice);
+
 int phdr_table_protect_gnu_relro(const ElfW(Phdr)* phdr_table, size_t phdr_count,
                                  ElfW(Addr) load_bias);
 
@@ -0,0 +1,146 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include "linker_profile.h"
+
+#include <inttypes.h>
+#include <time.h>
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct ProfileRecord {
+  std::string realpath;
+  uint64_t phase_ns[kProfilePhaseCount];
+  size_t lookups;
+  size_t lookup_misses;
+};
+
+static const char* const kProfilePhaseNames[kProfilePhaseCount] = {
+  "open_us",
+  "read_us",
+  "load_us",
+  "prelink_us",
+  "relocate_us",
+  "constructors_us",
+};
+
+// Records in the order the libraries were first seen.
+static std::vector<ProfileRecord> g_profile_records;
+static std::unordered_map<std::string, size_t> g_profile_record_indexes;
+
+static ProfileRecord* get_record(const char* realpath) {
+  auto it = g_profile_record_indexes.find(realpath);
+  if (it != g_profile_record_indexes.end()) {
+    return &g_profile_records[it->second];
+  }
+
+  g_profile_record_indexes[realpath] = g_profile_records.size();
+  g_profile_records.emplace_back();
+  ProfileRecord* record = &g_profile_records.back();
+  record->realpath = realpath;
+  for (size_t i = 0; i < kProfilePhaseCount; ++i) {
+    record->phase_ns[i] = 0;
+  }
+  record->lookups = 0;
+  record->lookup_misses = 0;
+  return record;
+}
+
+uint64_t profile_now() {
+  if (!profile_is_enabled()) {
+    return 0;
+  }
+
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+}
+
+void profile_add_time(const char* realpath, ProfilePhase phase, uint64_t start_ns) {
+  if (start_ns == 0) {
+    return;
+  }
+
+  profile_add_duration(realpath, phase, profile_now() - start_ns);
+}
+
+void profile_add_duration(const char* realpath, ProfilePhase phase, uint64_t duration_ns) {
+  if (!profile_is_enabled() || realpath == nullptr) {
+    return;
+  }
+
+  get_record(realpath)->phase_ns[phase] += duration_ns;
+}
+
+void profile_record_lookup(const char* realpath, bool found) {
+  if (realpath == nullptr) {
+    return;
+  }
+
+  ProfileRecord* record = get_record(realpath);
+  ++record->lookups;
+  if (!found) {
+    ++record->lookup_misses;
+  }
+}
+
+void profile_report(const char* event, const char* target) {
+  if (!profile_is_enabled()) {
+    return;
+  }
+
+  uint64_t total_ns = 0;
+  for (const auto& record : g_profile_records) {
+    uint64_t us[kProfilePhaseCount];
+    for (size_t i = 0; i < kProfilePhaseCount; ++i) {
+      us[i] = record.phase_ns[i] / 1000;
+      total_ns += record.phase_ns[i];
+    }
+
+    LD_LOG(kLogProfile,
+           "profile event=%s target=%s lib=%s "
+           "%s=%" PRIu64 " %s=%" PRIu64 " %s=%" PRIu64 " %s=%" PRIu64 " %s=%" PRIu64 " %s=%" PRIu64
+           " lookups=%zu lookup_misses=%zu",
+           event, target, record.realpath.c_str(),
+           kProfilePhaseNames[kProfileOpen], us[kProfileOpen],
+           kProfilePhaseNames[kProfileRead], us[kProfileRead],
+           kProfilePhaseNames[kProfileLoadSegments], us[kProfileLoadSegments],
+           kProfilePhaseNames[kProfilePrelink], us[kProfilePrelink],
+           kProfilePhaseNames[kProfileRelocate], us[kProfileRelocate],
+           kProfilePhaseNames[kProfileConstructors], us[kProfileConstructors],
+           record.lookups, record.lookup_misses);
+  }
+
+  LD_LOG(kLogProfile, "profile event=%s target=%s libs=%zu total_us=%" PRIu64,
+         event, target, g_profile_records.size(), total_ns / 1000);
+
+  g_profile_records.clear();
+  g_profile_record_indexes.clear();
+}
@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef __LINKER_PROFILE_H
+#define __LINKER_PROFILE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "linker_logger.h"
+#include "private/bionic_macros.h"
+
+// Per-library load-time profiling, enabled with the "profile" option
+// of the debug.ld.all and debug.ld.app.<name> properties. The linker
+// accumulates the time spent in each phase below, keyed by realpath,
+// and profile_report() logs one line of key=value pairs per library
+// at the end of startup and of every successful dlopen.
+enum ProfilePhase {
+  kProfileOpen = 0,      // Searching the library paths and opening the file.
+  kProfileRead,          // ElfReader::Read().
+  kProfileLoadSegments,  // ElfReader::Load().
+  kProfilePrelink,       // soinfo::prelink_image().
+  kProfileRelocate,      // soinfo::link_image().
+  kProfileConstructors,  // DT_INIT and DT_INIT_ARRAY, excluding dependencies.
+  kProfilePhaseCount
+};
+
+inline bool profile_is_enabled() {
+  return g_linker_logger.IsEnabled(kLogProfile);
+}
+
+// Returns the current CLOCK_MONOTONIC time in nanoseconds, or 0 when
+// profiling is disabled.
+uint64_t profile_now();
+
+// Adds the time since start_ns (as returned by profile_now()) to the
+// given phase of the library; does nothing if start_ns is 0.
+void profile_add_time(const char* realpath, ProfilePhase phase, uint64_t start_ns);
+void profile_add_duration(const char* realpath, ProfilePhase phase, uint64_t duration_ns);
+
+void profile_record_lookup(const char* realpath, bool found);
+
+inline void profile_count_lookup(const char* realpath, bool found) {
+  if (profile_is_enabled()) {
+    profile_record_lookup(realpath, found);
+  }
+}
+
+// Logs and clears the collected records. event is "startup" or
+// "dlopen"; target is the executable or the dlopened library.
+void profile_report(const char* event, const char* target);
+
+class ProfileTimer {
+ public:
+  ProfileTimer(const char* realpath, ProfilePhase phase)
+      : realpath_(realpath), phase_(phase), start_ns_(profile_now()) {}
+
+  ~ProfileTimer() {
+    profile_add_time(realpath_, phase_, start_ns_);
+  }
+
+ private:
+  const char* realpath_;
+  ProfilePhase phase_;
+  uint64_t start_ns_;
+
+  DISALLOW_IMPLICIT_CONSTRUCTORS(ProfileTimer);
+};
+
+#endif  /* __LINKER_PROFILE_H */
@@ -27,6 +27,8 @@
 #define R_GENERIC_GLOB_DAT  R_AARCH64_GLOB_DAT
 #define R_GENERIC_RELATIVE  R_AARCH64_RELATIVE
 #define R_GENERIC_IRELATIVE R_AARCH64_IRELATIVE
+#define R_GENERIC_TLS_DTPMOD R_AARCH64_TLS_DTPMOD64
+#define R_GENERIC_TLS_DTPREL R_AARCH64_TLS_DTPREL64
 
 #elif defined (__arm__)
 
@@ -34,6 +36,8 @@
 #define R_GENERIC_GLOB_DAT  R_ARM_GLOB_DAT
 #define R_GENERIC_RELATIVE  R_ARM_RELATIVE
 #define R_GENERIC_IRELATIVE R_ARM_IRELATIVE
+#define R_GENERIC_TLS_DTPMOD R_ARM_TLS_DTPMOD32
+#define R_GENERIC_TLS_DTPREL R_ARM_TLS_DTPOFF32
 
 #elif defined (__i386__)
 
@@ -41,6 +45,8 @@
 #define R_GENERIC_GLOB_DAT  R_386_GLOB_DAT
 #define R_GENERIC_RELATIVE  R_386_RELATIVE
 #define R_GENERIC_IRELATIVE R_386_IRELATIVE
+#define R_GENERIC_TLS_DTPMOD R_386_TLS_DTPMOD32
+#define R_GENERIC_TLS_DTPREL R_386_TLS_DTPOFF32
 
 #elif defined (__x86_64__)
 
@@ -48,6 +54,8 @@
 #define R_GENERIC_GLOB_DAT  R_X86_64_GLOB_DAT
 #define R_GENERIC_RELATIVE  R_X86_64_RELATIVE
 #define R_GENERIC_IRELATIVE R_X86_64_IRELATIVE
+#define R_GENERIC_TLS_DTPMOD R_X86_64_DTPMOD64
+#define R_GENERIC_TLS_DTPREL R_X86_64_DTPOFF64
 
 #endif
 
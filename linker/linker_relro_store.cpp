@@ -0,0 +1,144 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include "linker_relro_store.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <string>
+
+#include "linker_debug.h"
+#include "linker_phdr.h"
+#include "linker_utils.h"
+
+#include "android-base/stringprintf.h"
+
+static bool g_relro_store_enabled = false;
+static std::string g_relro_store_path;
+
+static bool has_gnu_relro(const soinfo* si) {
+  for (size_t i = 0; i < si->phnum; ++i) {
+    if (si->phdr[i].p_type == PT_GNU_RELRO) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// <basename>-<identity hash>-<load bias>.relro
+static std::string image_path(const soinfo* si) {
+  uint64_t st_dev = si->get_st_dev();
+  uint64_t st_ino = si->get_st_ino();
+  int64_t mtime_sec = si->get_st_mtim().tv_sec;
+  int64_t mtime_nsec = si->get_st_mtim().tv_nsec;
+  int64_t file_offset = si->get_file_offset();
+  const char* realpath = si->get_realpath();
+
+  uint64_t hash = kFnv1aInitialHash;
+  hash = fnv1a(hash, realpath, strlen(realpath));
+  hash = fnv1a(hash, &st_dev, sizeof(st_dev));
+  hash = fnv1a(hash, &st_ino, sizeof(st_ino));
+  hash = fnv1a(hash, &mtime_sec, sizeof(mtime_sec));
+  hash = fnv1a(hash, &mtime_nsec, sizeof(mtime_nsec));
+  hash = fnv1a(hash, &file_offset, sizeof(file_offset));
+
+  return android::base::StringPrintf("%s/%s-%016" PRIx64 "-%" PRIxPTR ".relro",
+                                     g_relro_store_path.c_str(), basename(realpath), hash,
+                                     static_cast<uintptr_t>(si->load_bias));
+}
+
+void relro_store_init(const char* path) {
+  if (path == nullptr || path[0] == '\0') {
+    return;
+  }
+
+  struct stat dir_stat;
+  if (TEMP_FAILURE_RETRY(stat(path, &dir_stat)) != 0 || !S_ISDIR(dir_stat.st_mode)) {
+    PRINT("warning: RELRO store disabled: \"%s\" is not a directory", path);
+    return;
+  }
+
+  g_relro_store_path = path;
+  g_relro_store_enabled = true;
+}
+
+bool relro_store_is_enabled() {
+  return g_relro_store_enabled;
+}
+
+void relro_store_share(soinfo* si) {
+  if (!g_relro_store_enabled || !has_gnu_relro(si)) {
+    return;
+  }
+
+  std::string path = image_path(si);
+
+  int fd = TEMP_FAILURE_RETRY(open(path.c_str(), O_RDONLY | O_CLOEXEC | O_NOFOLLOW));
+  if (fd != -1) {
+    struct stat file_stat;
+    if (TEMP_FAILURE_RETRY(fstat(fd, &file_stat)) != 0 ||
+        !S_ISREG(file_stat.st_mode) || !file_is_trusted(file_stat)) {
+      PRINT("warning: ignoring untrusted RELRO image \"%s\"", path.c_str());
+    } else if (phdr_table_map_gnu_relro(si->phdr, si->phnum, si->load_bias, fd) != 0) {
+      PRINT("warning: unable to map RELRO image \"%s\": %s", path.c_str(), strerror(errno));
+    } else {
+      TRACE("[ \"%s\" is using RELRO image \"%s\" ]", si->get_realpath(), path.c_str());
+    }
+    close(fd);
+    return;
+  }
+
+  if (errno != ENOENT) {
+    return;
+  }
+
+  // Other processes may be adding the same image - write to a temporary
+  // file and rename it into place. phdr_table_serialize_gnu_relro() maps
+  // the file back over the RELRO segment, so it has to be readable.
+  std::string tmp_path = android::base::StringPrintf("%s.%d.tmp", path.c_str(), getpid());
+  fd = TEMP_FAILURE_RETRY(open(tmp_path.c_str(),
+                               O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC | O_NOFOLLOW, 0644));
+  if (fd == -1) {
+    DEBUG("unable to create RELRO image \"%s\": %s", tmp_path.c_str(), strerror(errno));
+    return;
+  }
+
+  if (phdr_table_serialize_gnu_relro(si->phdr, si->phnum, si->load_bias, fd) != 0 ||
+      rename(tmp_path.c_str(), path.c_str()) != 0) {
+    PRINT("warning: unable to write RELRO image \"%s\": %s", path.c_str(), strerror(errno));
+    unlink(tmp_path.c_str());
+  } else {
+    TRACE("[ \"%s\" added RELRO image \"%s\" ]", si->get_realpath(), path.c_str());
+  }
+  close(fd);
+}
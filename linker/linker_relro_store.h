@@ -0,0 +1,55 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef __LINKER_RELRO_STORE_H
+#define __LINKER_RELRO_STORE_H
+
+#include "linker_soinfo.h"
+
+// The RELRO store is an optional directory of serialized GNU RELRO
+// images (see phdr_table_serialize_gnu_relro()), enabled by setting
+// LD_RELRO_STORE to the path of the directory. It lets unrelated
+// processes share the relocated RELRO pages of system libraries the
+// same way ANDROID_DLEXT_WRITE_RELRO/USE_RELRO do, without the caller
+// managing the file descriptor.
+//
+// Images are keyed by the library's (realpath, st_dev, st_ino,
+// st_mtime, file_offset) and load bias. Since only pages identical to
+// the freshly relocated ones are mapped from an image, a stale or
+// foreign image can only cost memory, never correctness. Images are
+// only used if they are owned by root or the current user and are not
+// writable by anyone else.
+void relro_store_init(const char* path);
+bool relro_store_is_enabled();
+
+// Replaces the GNU RELRO pages of an already relocated and protected
+// library with pages from the store, or adds an image to the store if
+// it has none for this library and address. Failures are not fatal.
+void relro_store_share(soinfo* si);
+
+#endif  /* __LINKER_RELRO_STORE_H */
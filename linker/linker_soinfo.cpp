@@ -34,9 +34,12 @@
 #include <sys/stat.h>
 #include <unistd.h>
 
+#include <algorithm>
+
 #include "linker_debug.h"
 #include "linker_globals.h"
 #include "linker_logger.h"
+#include "linker_profile.h"
 #include "linker_utils.h"
 
 // TODO(dimitry): These functions are currently located in linker.cpp - find a better place for it
@@ -59,6 +62,7 @@ soinfo::soinfo(android_namespace_t* ns, const char* realpath,
   if (file_stat != nullptr) {
     this->st_dev_ = file_stat->st_dev;
     this->st_ino_ = file_stat->st_ino;
+    this->st_mtim_ = file_stat->st_mtim;
     this->file_offset_ = file_offset;
   }
 
@@ -68,6 +72,9 @@ soinfo::soinfo(android_namespace_t* ns, const char* realpath,
 
 soinfo::~soinfo() {
   g_soinfo_handles_map.erase(handle_);
+  for (TlsIndex* arg : tlsdesc_args_) {
+    delete arg;
+  }
 }
 
 void soinfo::set_dt_runpath(const char* path) {
@@ -269,6 +276,24 @@ bool soinfo::elf_lookup(SymbolName& symbol_name,
              symbol_name.get_name(), get_realpath(),
              reinterpret_cast<void*>(base), hash, hash % nbucket_);
 
+  if (!elf_bloom_filter_.empty()) {
+    uint32_t gnu_hash = symbol_name.gnu_hash();
+    uint32_t h2 = gnu_hash >> elf_bloom_shift2_;
+
+    uint32_t bloom_mask_bits = sizeof(ElfW(Addr))*8;
+    uint32_t word_num = (gnu_hash / bloom_mask_bits) & (elf_bloom_filter_.size() - 1);
+    ElfW(Addr) bloom_word = elf_bloom_filter_[word_num];
+
+    if ((1 & (bloom_word >> (gnu_hash % bloom_mask_bits)) &
+        (bloom_word >> (h2 % bloom_mask_bits))) == 0) {
+      TRACE_TYPE(LOOKUP, "NOT FOUND %s in %s@%p (bloom)",
+                 symbol_name.get_name(), get_realpath(), reinterpret_cast<void*>(base));
+
+      *symbol_index = 0;
+      return true;
+    }
+  }
+
   ElfW(Versym) verneed = 0;
   if (!find_verdef_version_index(this, vi, &verneed)) {
     return false;
@@ -303,8 +328,47 @@ bool soinfo::elf_lookup(SymbolName& symbol_name,
   return true;
 }
 
-ElfW(Sym)* soinfo::find_symbol_by_address(const void* addr) {
-  return is_gnu_hash() ? gnu_addr_lookup(addr) : elf_addr_lookup(addr);
+// DT_HASH has no bloom filter, so every lookup in a DT_HASH-only library walks
+// a bucket chain and strcmp()s each candidate. Build a GNU-style filter (keyed
+// by the GNU hash, two bits per symbol) so that most misses are rejected
+// without touching the symbol table.
+void soinfo::build_elf_bloom_filter() {
+  if (!has_min_version(3) || is_gnu_hash() || nchain_ <= 1) {
+    return;
+  }
+
+  // Roughly 8 filter bits per symbol keeps the false positive rate around 5%.
+  const size_t bloom_mask_bits = sizeof(ElfW(Addr))*8;
+  size_t maskwords = 1;
+  while (maskwords * bloom_mask_bits < nchain_ * 8) {
+    maskwords <<= 1;
+  }
+
+  uint32_t shift2 = 0;
+  while ((static_cast<size_t>(1) << shift2) < maskwords * bloom_mask_bits) {
+    ++shift2;
+  }
+
+  elf_bloom_filter_.assign(maskwords, 0);
+  elf_bloom_shift2_ = shift2;
+
+  for (size_t n = 1; n < nchain_; ++n) {
+    const ElfW(Sym)* s = symtab_ + n;
+    if ((ELF_ST_BIND(s->st_info) != STB_GLOBAL && ELF_ST_BIND(s->st_info) != STB_WEAK) ||
+        s->st_shndx == SHN_UNDEF) {
+      continue;
+    }
+
+    SymbolName symbol_name(get_string(s->st_name));
+    uint32_t hash = symbol_name.gnu_hash();
+    uint32_t h2 = hash >> shift2;
+    ElfW(Addr)& bloom_word = elf_bloom_filter_[(hash / bloom_mask_bits) & (maskwords - 1)];
+    bloom_word |= static_cast<ElfW(Addr)>(1) << (hash % bloom_mask_bits);
+    bloom_word |= static_cast<ElfW(Addr)>(1) << (h2 % bloom_mask_bits);
+  }
+
+  DEBUG("%s: built %zu-word bloom filter for %zu DT_HASH symbols",
+        get_realpath(), maskwords, nchain_);
 }
 
 static bool symbol_matches_soaddr(const ElfW(Sym)* sym, ElfW(Addr) soaddr) {
@@ -313,6 +377,112 @@ static bool symbol_matches_soaddr(const ElfW(Sym)* sym, ElfW(Addr) soaddr) {
       soaddr < sym->st_value + sym->st_size;
 }
 
+ElfW(Sym)* soinfo::find_symbol_by_address(const void* addr) {
+  if (!has_symbol_address_index()) {
+    return is_gnu_hash() ? gnu_addr_lookup(addr) : elf_addr_lookup(addr);
+  }
+
+  ElfW(Addr) soaddr = reinterpret_cast<ElfW(Addr)>(addr) - load_bias;
+
+  // Find the last symbol starting at or before soaddr and walk back while
+  // an earlier symbol could still extend past soaddr. Among symbols with
+  // the same st_value the first one in symbol table order wins, which is
+  // what the linear scans return.
+  auto it = std::upper_bound(symbol_address_index_.begin(), symbol_address_index_.end(), soaddr,
+                             [&](ElfW(Addr) value, uint32_t n) {
+                               return value < symtab_[n].st_value;
+                             });
+  ElfW(Sym)* result = nullptr;
+  for (size_t i = it - symbol_address_index_.begin();
+       i > 0 && symbol_address_index_end_[i - 1] > soaddr; --i) {
+    ElfW(Sym)* sym = symtab_ + symbol_address_index_[i - 1];
+    if (result != nullptr && sym->st_value != result->st_value) {
+      break;
+    }
+    if (symbol_matches_soaddr(sym, soaddr)) {
+      result = sym;
+    }
+  }
+
+  return result;
+}
+
+bool soinfo::has_symbol_address_index() const {
+  // Paired with the release store in build_symbol_address_index(), for
+  // try_dladdr_without_lock().
+  return has_min_version(3) && __atomic_load_n(&has_symbol_address_index_, __ATOMIC_ACQUIRE);
+}
+
+bool soinfo::has_verdef_index() const {
+  return has_min_version(3) && has_verdef_index_;
+}
+
+const std::vector<verdef_info>& soinfo::get_verdefs() const {
+  return verdefs_;
+}
+
+void soinfo::find_verdef(const version_info* vi, ElfW(Versym)* versym) const {
+  auto it = std::lower_bound(verdefs_.begin(), verdefs_.end(), vi->elf_hash,
+                             [](const verdef_info& verdef, uint32_t elf_hash) {
+                               return verdef.elf_hash < elf_hash;
+                             });
+  for (; it != verdefs_.end() && it->elf_hash == vi->elf_hash; ++it) {
+    if (strcmp(it->name, vi->name) == 0) {
+      *versym = it->index;
+      return;
+    }
+  }
+}
+
+void soinfo::build_symbol_address_index() {
+  if (!has_min_version(3) || has_symbol_address_index_) {
+    return;
+  }
+
+  std::vector<uint32_t> symbols;
+  auto add_symbol = [&](uint32_t n) {
+    const ElfW(Sym)* sym = symtab_ + n;
+    if (sym->st_shndx != SHN_UNDEF && sym->st_size != 0) {
+      symbols.push_back(n);
+    }
+  };
+
+  // Index the same symbols that gnu_addr_lookup()/elf_addr_lookup() scan.
+  if (is_gnu_hash()) {
+    for (size_t i = 0; i < gnu_nbucket_; ++i) {
+      uint32_t n = gnu_bucket_[i];
+      if (n == 0) {
+        continue;
+      }
+
+      do {
+        add_symbol(n);
+      } while ((gnu_chain_[n++] & 1) == 0);
+    }
+  } else {
+    for (size_t i = 0; i < nchain_; ++i) {
+      add_symbol(i);
+    }
+  }
+
+  std::stable_sort(symbols.begin(), symbols.end(), [&](uint32_t a, uint32_t b) {
+    return symtab_[a].st_value < symtab_[b].st_value;
+  });
+
+  symbol_address_index_end_.resize(symbols.size());
+  ElfW(Addr) max_end = 0;
+  for (size_t i = 0; i < symbols.size(); ++i) {
+    const ElfW(Sym)* sym = symtab_ + symbols[i];
+    max_end = std::max(max_end, sym->st_value + sym->st_size);
+    symbol_address_index_end_[i] = max_end;
+  }
+
+  symbol_address_index_ = std::move(symbols);
+  __atomic_store_n(&has_symbol_address_index_, true, __ATOMIC_RELEASE);
+
+  DEBUG("%s: built address index of %zu symbols", get_realpath(), symbol_address_index_.size());
+}
+
 ElfW(Sym)* soinfo::gnu_addr_lookup(const void* addr) {
   ElfW(Addr) soaddr = reinterpret_cast<ElfW(Addr)>(addr) - load_bias;
 
@@ -404,10 +574,23 @@ void soinfo::call_pre_init_constructors() {
 }
 
 void soinfo::call_constructors() {
-  if (constructors_called) {
+  if (!set_constructors_called()) {
     return;
   }
 
+  get_children().for_each([] (soinfo* si) {
+    si->call_constructors();
+  });
+
+  ProfileTimer profile_timer(get_realpath(), kProfileConstructors);
+  call_own_constructors();
+}
+
+bool soinfo::set_constructors_called() {
+  if (constructors_called) {
+    return false;
+  }
+
   // We set constructors_called before actually calling the constructors, otherwise it doesn't
   // protect against recursive constructor calls. One simple example of constructor recursion
   // is the libc debug malloc, which is implemented in libc_malloc_debug_leak.so:
@@ -425,10 +608,10 @@ void soinfo::call_constructors() {
     PRINT("\"%s\": ignoring DT_PREINIT_ARRAY in shared library!", get_realpath());
   }
 
-  get_children().for_each([] (soinfo* si) {
-    si->call_constructors();
-  });
+  return true;
+}
 
+void soinfo::call_own_constructors() {
   TRACE("\"%s\": calling constructors", get_realpath());
 
   // DT_INIT should be called before DT_INIT_ARRAY if both are present.
@@ -506,6 +689,16 @@ ino_t soinfo::get_st_ino() const {
   return 0;
 }
 
+static const timespec g_empty_mtim = {};
+
+const timespec& soinfo::get_st_mtim() const {
+  if (has_min_version(3)) {
+    return st_mtim_;
+  }
+
+  return g_empty_mtim;
+}
+
 off64_t soinfo::get_file_offset() const {
   if (has_min_version(1)) {
     return file_offset_;
@@ -561,6 +754,7 @@ const char* soinfo::get_realpath() const {
 }
 
 void soinfo::set_soname(const char* soname) {
+  const char* old_soname = get_soname();
 #if defined(__work_around_b_24465209__)
   if (has_min_version(2)) {
     soname_ = soname;
@@ -569,6 +763,16 @@ void soinfo::set_soname(const char* soname) {
 #else
   soname_ = soname;
 #endif
+
+  // Keep the soname indexes of our namespaces up to date.
+  if (has_min_version(3)) {
+    if (primary_namespace_ != nullptr) {
+      primary_namespace_->update_soname(this, old_soname);
+    }
+    secondary_namespaces_.for_each([&](android_namespace_t* ns) {
+      ns->update_soname(this, old_soname);
+    });
+  }
 }
 
 const char* soinfo::get_soname() const {
@@ -642,6 +846,14 @@ ElfW(Addr) soinfo::resolve_symbol_address(const ElfW(Sym)* s) const {
   return static_cast<ElfW(Addr)>(s->st_value + load_bias);
 }
 
+const ElfW(Sym)* soinfo::get_symbol(ElfW(Word) index) const {
+  return symtab_ + index;
+}
+
+ElfW(Word) soinfo::get_symbol_index(const ElfW(Sym)* s) const {
+  return static_cast<ElfW(Word)>(s - symtab_);
+}
+
 const char* soinfo::get_string(ElfW(Word) index) const {
   if (has_min_version(1) && (index >= strtab_size_)) {
     __libc_fatal("%s: strtab out of bounds error; STRSZ=%zd, name=%d",
@@ -708,6 +920,22 @@ bool soinfo::is_mapped_by_caller() const {
   return (flags_ & FLAG_MAPPED_BY_CALLER) != 0;
 }
 
+void soinfo::set_lazy_bind(bool lazy_bind) {
+  if (lazy_bind) {
+    flags_ |= FLAG_LAZY_BIND;
+  } else {
+    flags_ &= ~FLAG_LAZY_BIND;
+  }
+}
+
+bool soinfo::is_lazy_bind() const {
+  return (flags_ & FLAG_LAZY_BIND) != 0;
+}
+
+size_t soinfo::get_tls_module_id() const {
+  return tls_module_id_;
+}
+
 // This function returns api-level at the time of
 // dlopen/load. Note that libraries opened by system
 // will always have 'current' api level.
@@ -30,10 +30,12 @@
 #define __LINKER_SOINFO_H
 
 #include <link.h>
+#include <time.h>
 
 #include <string>
 
 #include "linker_namespaces.h"
+#include "private/bionic_elf_tls.h"
 
 #define FLAG_LINKED           0x00000001
 #define FLAG_EXE              0x00000004 // The main executable
@@ -41,6 +43,7 @@
 #define FLAG_GNU_HASH         0x00000040 // uses gnu hash
 #define FLAG_MAPPED_BY_CALLER 0x00000080 // the map is reserved by the caller
                                          // and should not be unmapped
+#define FLAG_LAZY_BIND        0x00000100 // resolve JUMP_SLOT relocations on first call
 #define FLAG_NEW_SOINFO       0x40000000 // new soinfo format
 
 #define SOINFO_VERSION 3
@@ -79,8 +82,17 @@ struct version_info {
   const soinfo* target_si;
 };
 
+// A version defined by a library: a DT_VERDEF entry other than the
+// VER_FLG_BASE one.
+struct verdef_info {
+  uint32_t elf_hash;
+  ElfW(Versym) index;
+  const char* name;
+};
+
 // TODO(dimitry): remove reference from soinfo member functions to this class.
 class VersionTracker;
+class SymbolLookupSession;
 
 #if defined(__work_around_b_24465209__)
 #define SOINFO_NAME_LEN 128
@@ -165,8 +177,7 @@ struct soinfo {
   uint32_t mips_local_gotno_;
   uint32_t mips_gotsym_;
   bool mips_relocate_got(const VersionTracker& version_tracker,
-                         const soinfo_list_t& global_group,
-                         const soinfo_list_t& local_group);
+                         SymbolLookupSession& lookup_session);
 #if !defined(__LP64__)
   bool mips_check_and_adjust_fp_modes();
 #endif
@@ -192,6 +203,10 @@ struct soinfo {
   ~soinfo();
 
   void call_constructors();
+  // The two halves of call_constructors() without the recursion into the
+  // children, for running the constructors of a dependency graph in parallel.
+  bool set_constructors_called();
+  void call_own_constructors();
   void call_destructors();
   void call_pre_init_constructors();
   bool prelink_image();
@@ -204,6 +219,7 @@ struct soinfo {
 
   ino_t get_st_ino() const;
   dev_t get_st_dev() const;
+  const timespec& get_st_mtim() const;
   off64_t get_file_offset() const;
 
   uint32_t get_rtld_flags() const;
@@ -220,8 +236,22 @@ struct soinfo {
                            const ElfW(Sym)** symbol) const;
 
   ElfW(Sym)* find_symbol_by_address(const void* addr);
+  // Makes find_symbol_by_address() a binary search; must be called with
+  // the soinfo writable.
+  void build_symbol_address_index();
+  bool has_symbol_address_index() const;
   ElfW(Addr) resolve_symbol_address(const ElfW(Sym)* s) const;
 
+  // The versions this library defines, sorted by hash; only valid if
+  // has_verdef_index(). find_verdef() sets *versym to the index of vi, and
+  // leaves it alone if the library does not define vi.
+  bool has_verdef_index() const;
+  const std::vector<verdef_info>& get_verdefs() const;
+  void find_verdef(const version_info* vi, ElfW(Versym)* versym) const;
+
+  const ElfW(Sym)* get_symbol(ElfW(Word) index) const;
+  ElfW(Word) get_symbol_index(const ElfW(Sym)* s) const;
+
   const char* get_string(ElfW(Word) index) const;
   bool can_unload() const;
   bool is_gnu_hash() const;
@@ -267,12 +297,21 @@ struct soinfo {
   void set_mapped_by_caller(bool reserved_map);
   bool is_mapped_by_caller() const;
 
+  void set_lazy_bind(bool lazy_bind);
+  bool is_lazy_bind() const;
+  bool bind_lazy_plt_entry(size_t reloc_index, ElfW(Addr)* target);
+
   uintptr_t get_handle() const;
   void generate_handle();
   void* to_handle();
 
+  // The ELF TLS module id of this library's PT_TLS segment, or 0 if it has none.
+  size_t get_tls_module_id() const;
+
  private:
   bool elf_lookup(SymbolName& symbol_name, const version_info* vi, uint32_t* symbol_index) const;
+  void build_elf_bloom_filter();
+  bool build_verdef_index();
   ElfW(Sym)* elf_addr_lookup(const void* addr);
   bool gnu_lookup(SymbolName& symbol_name, const version_info* vi, uint32_t* symbol_index) const;
   ElfW(Sym)* gnu_addr_lookup(const void* addr);
@@ -282,7 +321,15 @@ struct soinfo {
 
   template<typename ElfRelIteratorT>
   bool relocate(const VersionTracker& version_tracker, ElfRelIteratorT&& rel_iterator,
-                const soinfo_list_t& global_group, const soinfo_list_t& local_group);
+                SymbolLookupSession& lookup_session);
+  bool relocate_relr();
+  bool relocate_image(const soinfo_list_t& global_group, const soinfo_list_t& local_group);
+
+  bool can_bind_plt_lazily() const;
+#if defined(USE_RELA)
+  bool setup_lazy_plt(const VersionTracker& version_tracker,
+                      SymbolLookupSession& lookup_session);
+#endif
 
  private:
   // This part of the structure is only available
@@ -335,6 +382,37 @@ struct soinfo {
   android_namespace_t* primary_namespace_;
   android_namespace_list_t secondary_namespaces_;
   uintptr_t handle_;
+  timespec st_mtim_;
+
+  // GNU-style bloom filter over the defined dynamic symbols of a DT_HASH-only
+  // library, built by prelink_image(); empty for DT_GNU_HASH libraries.
+  std::vector<ElfW(Addr)> elf_bloom_filter_;
+  uint32_t elf_bloom_shift2_;
+
+  // DT_PLTGOT and DF_BIND_NOW, used for lazy binding.
+  ElfW(Addr)* dt_pltgot_;
+  bool has_bind_now_;
+
+  // DT_RELR/DT_ANDROID_RELR compact relative relocations.
+  ElfW(Addr)* relr_;
+  size_t relr_count_;
+
+  // Indexes of the defined, sized symbols sorted by st_value, and the
+  // largest st_value + st_size among each prefix; built on the first
+  // dladdr() into this library.
+  std::vector<uint32_t> symbol_address_index_;
+  std::vector<ElfW(Addr)> symbol_address_index_end_;
+  bool has_symbol_address_index_;
+
+  // See get_verdefs(); built by prelink_image(). Empty for the usual
+  // library that only defines its base version.
+  std::vector<verdef_info> verdefs_;
+  bool has_verdef_index_;
+
+  // See get_tls_module_id(); assigned by prelink_image(). tlsdesc_args_ are
+  // the arguments of this library's resolved TLSDESC descriptors.
+  size_t tls_module_id_;
+  std::vector<TlsIndex*> tlsdesc_args_;
 
   friend soinfo* get_libdl_info();
 };
@@ -0,0 +1,452 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#include "linker_symbol_cache.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <string>
+
+#include "linker.h"
+#include "linker_debug.h"
+#include "linker_globals.h"
+#include "linker_utils.h"
+
+#include "android-base/stringprintf.h"
+
+// File layout (all fields are in host byte order and 8-byte aligned):
+//   symbol_cache_header_t
+//   record[header.record_count]:
+//     symbol_cache_record_header_t
+//     realpath (realpath_size bytes, '\0'-terminated and padded)
+//     symbol_cache_scope_entry_t[scope_count]
+//     symbol_cache_entry_t[entry_count] (sorted by sym_index, padded)
+static const char kSymbolCacheMagic[4] = { 'L', 'D', 'S', 'C' };
+static constexpr uint32_t kSymbolCacheVersion = 1;
+static constexpr uint32_t kSymbolCacheNotFound = UINT32_MAX;
+
+struct symbol_cache_header_t {
+  char magic[4];
+  uint32_t version;
+  uint32_t addr_size;
+  uint32_t record_count;
+  // The identity of the linker binary; libdl.so and [vdso] have no
+  // file of their own and are covered by it.
+  symbol_cache_scope_entry_t linker;
+};
+
+struct symbol_cache_record_header_t {
+  uint32_t size;
+  uint32_t realpath_size;
+  uint32_t scope_count;
+  uint32_t entry_count;
+};
+
+static bool g_symbol_cache_enabled = false;
+static bool g_symbol_cache_dirty = false;
+static std::string g_symbol_cache_path;
+static symbol_cache_scope_entry_t g_symbol_cache_linker;
+
+// realpath -> record; the record points either into the mapped cache
+// file or into one of g_symbol_cache_new_records.
+static std::unordered_map<std::string, const symbol_cache_record_header_t*> g_symbol_cache_records;
+static std::vector<std::vector<uint64_t>> g_symbol_cache_new_records;
+
+static size_t align_up_8(size_t size) {
+  return (size + 7) & ~static_cast<size_t>(7);
+}
+
+static const char* record_realpath(const symbol_cache_record_header_t* record) {
+  return reinterpret_cast<const char*>(record + 1);
+}
+
+static const symbol_cache_scope_entry_t* record_scope(const symbol_cache_record_header_t* record) {
+  return reinterpret_cast<const symbol_cache_scope_entry_t*>(
+      reinterpret_cast<const uint8_t*>(record + 1) + record->realpath_size);
+}
+
+static const symbol_cache_entry_t* record_entries(const symbol_cache_record_header_t* record) {
+  return reinterpret_cast<const symbol_cache_entry_t*>(record_scope(record) + record->scope_count);
+}
+
+static uint64_t record_size(uint64_t realpath_size, uint64_t scope_count, uint64_t entry_count) {
+  uint64_t size = sizeof(symbol_cache_record_header_t) + realpath_size +
+                  scope_count * sizeof(symbol_cache_scope_entry_t) +
+                  entry_count * sizeof(symbol_cache_entry_t);
+  return (size + 7) & ~static_cast<uint64_t>(7);
+}
+
+static void make_scope_entry(const struct stat& file_stat, symbol_cache_scope_entry_t* entry) {
+  entry->st_dev = file_stat.st_dev;
+  entry->st_ino = file_stat.st_ino;
+  entry->st_mtime_sec = file_stat.st_mtim.tv_sec;
+  entry->st_mtime_nsec = file_stat.st_mtim.tv_nsec;
+  entry->file_offset = 0;
+}
+
+static void make_scope_entry(const soinfo* si, symbol_cache_scope_entry_t* entry) {
+  const timespec& mtime = si->get_st_mtim();
+  entry->st_dev = si->get_st_dev();
+  entry->st_ino = si->get_st_ino();
+  entry->st_mtime_sec = mtime.tv_sec;
+  entry->st_mtime_nsec = mtime.tv_nsec;
+  entry->file_offset = si->get_file_offset();
+}
+
+static bool scope_entry_equals(const symbol_cache_scope_entry_t& a,
+                               const symbol_cache_scope_entry_t& b) {
+  return a.st_dev == b.st_dev &&
+         a.st_ino == b.st_ino &&
+         a.st_mtime_sec == b.st_mtime_sec &&
+         a.st_mtime_nsec == b.st_mtime_nsec &&
+         a.file_offset == b.file_offset;
+}
+
+static bool parse_symbol_cache(const uint8_t* data, size_t size) {
+  if (size < sizeof(symbol_cache_header_t)) {
+    return false;
+  }
+
+  const symbol_cache_header_t* header = reinterpret_cast<const symbol_cache_header_t*>(data);
+  if (memcmp(header->magic, kSymbolCacheMagic, sizeof(kSymbolCacheMagic)) != 0 ||
+      header->version != kSymbolCacheVersion ||
+      header->addr_size != sizeof(ElfW(Addr)) ||
+      !scope_entry_equals(header->linker, g_symbol_cache_linker)) {
+    return false;
+  }
+
+  size_t offset = sizeof(symbol_cache_header_t);
+  for (uint32_t i = 0; i < header->record_count; ++i) {
+    if (size - offset < sizeof(symbol_cache_record_header_t)) {
+      return false;
+    }
+
+    const symbol_cache_record_header_t* record =
+        reinterpret_cast<const symbol_cache_record_header_t*>(data + offset);
+
+    if (record->size > size - offset ||
+        (record->realpath_size % 8) != 0 ||
+        record->realpath_size == 0 ||
+        record->realpath_size > record->size ||
+        record->scope_count > record->size / sizeof(symbol_cache_scope_entry_t) ||
+        record->entry_count > record->size / sizeof(symbol_cache_entry_t) ||
+        record->size < record_size(record->realpath_size,
+                                   record->scope_count,
+                                   record->entry_count)) {
+      return false;
+    }
+
+    const char* realpath = record_realpath(record);
+    if (realpath[record->realpath_size - 1] != '\0') {
+      return false;
+    }
+
+    g_symbol_cache_records[realpath] = record;
+    offset += record->size;
+  }
+
+  return true;
+}
+
+void symbol_cache_init(const char* path, const char* linker_path) {
+  if (path == nullptr || path[0] == '\0') {
+    return;
+  }
+
+  struct stat linker_stat;
+  if (linker_path == nullptr || TEMP_FAILURE_RETRY(stat(linker_path, &linker_stat)) != 0) {
+    PRINT("warning: symbol cache disabled: unable to stat the linker \"%s\"",
+          linker_path == nullptr ? "(null)" : linker_path);
+    return;
+  }
+
+  g_symbol_cache_path = path;
+  make_scope_entry(linker_stat, &g_symbol_cache_linker);
+  g_symbol_cache_enabled = true;
+
+  int fd = TEMP_FAILURE_RETRY(open(path, O_RDONLY | O_CLOEXEC));
+  if (fd == -1) {
+    // The cache will be created on the first flush.
+    INFO("[ symbol cache \"%s\" not found ]", path);
+    return;
+  }
+
+  struct stat file_stat;
+  if (TEMP_FAILURE_RETRY(fstat(fd, &file_stat)) != 0 || file_stat.st_size <= 0) {
+    close(fd);
+    return;
+  }
+
+  size_t size = static_cast<size_t>(file_stat.st_size);
+  void* map = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+
+  if (map == MAP_FAILED) {
+    PRINT("warning: unable to map symbol cache \"%s\": %s", path, strerror(errno));
+    return;
+  }
+
+  // The mapping stays for the life of the process since the records
+  // point into it.
+  if (!parse_symbol_cache(static_cast<const uint8_t*>(map), size)) {
+    INFO("[ ignoring stale or invalid symbol cache \"%s\" ]", path);
+    g_symbol_cache_records.clear();
+    munmap(map, size);
+  }
+}
+
+bool symbol_cache_is_enabled() {
+  return g_symbol_cache_enabled;
+}
+
+void symbol_cache_flush() {
+  if (!g_symbol_cache_enabled || !g_symbol_cache_dirty) {
+    return;
+  }
+
+  g_symbol_cache_dirty = false;
+
+  // Other processes may be flushing the same cache - write to
+  // a temporary file and rename it into place.
+  std::string tmp_path = android::base::StringPrintf("%s.%d.tmp",
+                                                     g_symbol_cache_path.c_str(), getpid());
+  int fd = TEMP_FAILURE_RETRY(open(tmp_path.c_str(),
+                                   O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600));
+  if (fd == -1) {
+    PRINT("warning: unable to create symbol cache \"%s\": %s", tmp_path.c_str(), strerror(errno));
+    return;
+  }
+
+  symbol_cache_header_t header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, kSymbolCacheMagic, sizeof(kSymbolCacheMagic));
+  header.version = kSymbolCacheVersion;
+  header.addr_size = sizeof(ElfW(Addr));
+  header.record_count = g_symbol_cache_records.size();
+  header.linker = g_symbol_cache_linker;
+
+  bool success = write_fully(fd, &header, sizeof(header));
+  for (const auto& it : g_symbol_cache_records) {
+    if (!success) {
+      break;
+    }
+    success = write_fully(fd, it.second, it.second->size);
+  }
+
+  close(fd);
+
+  if (!success || rename(tmp_path.c_str(), g_symbol_cache_path.c_str()) != 0) {
+    PRINT("warning: unable to write symbol cache \"%s\": %s",
+          g_symbol_cache_path.c_str(), strerror(errno));
+    unlink(tmp_path.c_str());
+  }
+}
+
+SymbolLookupSession::SymbolLookupSession(soinfo* si_from,
+                                         const soinfo_list_t& global_group,
+                                         const soinfo_list_t& local_group)
+    : si_from_(si_from), global_group_(global_group), local_group_(local_group),
+      enabled_(false), dirty_(false), cached_entries_(nullptr), cached_entries_count_(0) {
+  // Note that the linker relocates itself before its globals are
+  // initialized; g_symbol_cache_enabled is zero-initialized and false.
+  if (!g_symbol_cache_enabled || si_from->is_linker() ||
+      (si_from->get_st_dev() == 0 && si_from->get_st_ino() == 0)) {
+    return;
+  }
+
+  enabled_ = true;
+
+  scope_.push_back(si_from);
+  global_group.for_each([&](soinfo* si) {
+    scope_.push_back(si);
+  });
+  local_group.for_each([&](soinfo* si) {
+    scope_.push_back(si);
+  });
+
+  for (size_t i = scope_.size(); i-- > 0; ) {
+    scope_indexes_[scope_[i]] = i;
+  }
+
+  auto it = g_symbol_cache_records.find(si_from->get_realpath());
+  if (it == g_symbol_cache_records.end()) {
+    dirty_ = true;
+    return;
+  }
+
+  const symbol_cache_record_header_t* record = it->second;
+  if (record->scope_count != scope_.size()) {
+    dirty_ = true;
+    return;
+  }
+
+  const symbol_cache_scope_entry_t* scope = record_scope(record);
+  for (size_t i = 0; i < scope_.size(); ++i) {
+    symbol_cache_scope_entry_t entry;
+    make_scope_entry(scope_[i], &entry);
+    if (!scope_entry_equals(entry, scope[i])) {
+      TRACE("[ symbol cache mismatch for \"%s\": \"%s\" has changed ]",
+            si_from->get_realpath(), scope_[i]->get_realpath());
+      dirty_ = true;
+      return;
+    }
+  }
+
+  cached_entries_ = record_entries(record);
+  cached_entries_count_ = record->entry_count;
+}
+
+bool SymbolLookupSession::lookup_cached(ElfW(Word) sym_index, const char* name,
+                                        soinfo** si_found_in, const ElfW(Sym)** symbol) {
+  const symbol_cache_entry_t* end = cached_entries_ + cached_entries_count_;
+  const symbol_cache_entry_t* entry = std::lower_bound(cached_entries_, end, sym_index,
+      [](const symbol_cache_entry_t& e, ElfW(Word) index) {
+        return e.sym_index < index;
+      });
+
+  if (entry == end || entry->sym_index != sym_index) {
+    return false;
+  }
+
+  if (entry->scope_index == kSymbolCacheNotFound) {
+    *symbol = nullptr;
+    return true;
+  }
+
+  if (entry->scope_index >= scope_.size()) {
+    return false;
+  }
+
+  soinfo* provider = scope_[entry->scope_index];
+  const ElfW(Sym)* s = provider->get_symbol(entry->provider_sym_index);
+
+  // Every library in the scope matched; the name check is a cheap
+  // guard against a corrupted cache file.
+  if (strcmp(provider->get_string(s->st_name), name) != 0) {
+    return false;
+  }
+
+  *si_found_in = provider;
+  *symbol = s;
+  return true;
+}
+
+void SymbolLookupSession::record(ElfW(Word) sym_index,
+                                 soinfo* si_found_in,
+                                 const ElfW(Sym)* symbol) {
+  symbol_cache_entry_t entry;
+  entry.sym_index = sym_index;
+
+  if (symbol == nullptr) {
+    entry.scope_index = kSymbolCacheNotFound;
+    entry.provider_sym_index = 0;
+  } else {
+    auto it = scope_indexes_.find(si_found_in);
+    if (it == scope_indexes_.end()) {
+      // Should not happen: soinfo_do_lookup only searches the scope.
+      enabled_ = false;
+      return;
+    }
+    entry.scope_index = it->second;
+    entry.provider_sym_index = si_found_in->get_symbol_index(symbol);
+  }
+
+  entries_.push_back(entry);
+}
+
+bool SymbolLookupSession::lookup(ElfW(Word) sym_index, const char* name, const version_info* vi,
+                                 soinfo** si_found_in, const ElfW(Sym)** symbol) {
+  if (!enabled_) {
+    return soinfo_do_lookup(si_from_, name, vi, si_found_in, global_group_, local_group_, symbol);
+  }
+
+  if (cached_entries_ != nullptr && lookup_cached(sym_index, name, si_found_in, symbol)) {
+    record(sym_index, *si_found_in, *symbol);
+    return true;
+  }
+
+  dirty_ = true;
+
+  if (!soinfo_do_lookup(si_from_, name, vi, si_found_in, global_group_, local_group_, symbol)) {
+    return false;
+  }
+
+  record(sym_index, *si_found_in, *symbol);
+  return true;
+}
+
+void SymbolLookupSession::commit() {
+  if (!enabled_ || !dirty_) {
+    return;
+  }
+
+  std::sort(entries_.begin(), entries_.end(),
+      [](const symbol_cache_entry_t& a, const symbol_cache_entry_t& b) {
+        return a.sym_index < b.sym_index;
+      });
+  entries_.erase(std::unique(entries_.begin(), entries_.end(),
+      [](const symbol_cache_entry_t& a, const symbol_cache_entry_t& b) {
+        return a.sym_index == b.sym_index;
+      }), entries_.end());
+
+  const char* realpath = si_from_->get_realpath();
+  size_t realpath_size = align_up_8(strlen(realpath) + 1);
+  size_t size = static_cast<size_t>(record_size(realpath_size, scope_.size(), entries_.size()));
+
+  // Use uint64_t storage to keep the record 8-byte aligned.
+  std::vector<uint64_t> buf(size / sizeof(uint64_t), 0);
+  symbol_cache_record_header_t* record = reinterpret_cast<symbol_cache_record_header_t*>(&buf[0]);
+  record->size = size;
+  record->realpath_size = realpath_size;
+  record->scope_count = scope_.size();
+  record->entry_count = entries_.size();
+
+  strcpy(const_cast<char*>(record_realpath(record)), realpath);
+
+  symbol_cache_scope_entry_t* scope = const_cast<symbol_cache_scope_entry_t*>(record_scope(record));
+  for (size_t i = 0; i < scope_.size(); ++i) {
+    make_scope_entry(scope_[i], &scope[i]);
+  }
+
+  if (!entries_.empty()) {
+    memcpy(const_cast<symbol_cache_entry_t*>(record_entries(record)), &entries_[0],
+           entries_.size() * sizeof(symbol_cache_entry_t));
+  }
+
+  g_symbol_cache_new_records.push_back(std::move(buf));
+  g_symbol_cache_records[realpath] = reinterpret_cast<const symbol_cache_record_header_t*>(
+      &g_symbol_cache_new_records.back()[0]);
+  g_symbol_cache_dirty = true;
+}
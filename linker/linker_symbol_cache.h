@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+#ifndef __LINKER_SYMBOL_CACHE_H
+#define __LINKER_SYMBOL_CACHE_H
+
+#include <link.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <unordered_map>
+#include <vector>
+
+#include "linker_common_types.h"
+
+struct version_info;
+
+// The symbol cache is an optional on-disk table of the results of
+// the symbol lookups performed while relocating a library. It is
+// enabled by setting LD_SYMBOL_CACHE to the path of the cache file.
+//
+// A record for a library is only used when the library and every
+// library in its lookup scope (DT_SYMBOLIC self, global group and
+// local group, in this order) match the (st_dev, st_ino, st_mtime,
+// file_offset) stored in the record. On any mismatch the linker
+// falls back to the regular lookup and records a new table. The
+// whole file is ignored if the linker binary itself has changed.
+void symbol_cache_init(const char* path, const char* linker_path);
+bool symbol_cache_is_enabled();
+
+// Writes the cache file if it has new records.
+void symbol_cache_flush();
+
+struct symbol_cache_scope_entry_t {
+  uint64_t st_dev;
+  uint64_t st_ino;
+  int64_t st_mtime_sec;
+  int64_t st_mtime_nsec;
+  int64_t file_offset;
+};
+
+struct symbol_cache_entry_t {
+  uint32_t sym_index;
+  uint32_t scope_index;
+  uint32_t provider_sym_index;
+};
+
+// This class is used by soinfo::relocate() for symbol lookups.
+// Without the cache it calls soinfo_do_lookup() for every lookup.
+class SymbolLookupSession {
+ public:
+  SymbolLookupSession(soinfo* si_from,
+                      const soinfo_list_t& global_group,
+                      const soinfo_list_t& local_group);
+
+  bool lookup(ElfW(Word) sym_index, const char* name, const version_info* vi,
+              soinfo** si_found_in, const ElfW(Sym)** symbol);
+
+  // Saves the lookups performed by this session; must only be
+  // called once the library was relocated successfully.
+  void commit();
+
+ private:
+  bool lookup_cached(ElfW(Word) sym_index, const char* name,
+                     soinfo** si_found_in, const ElfW(Sym)** symbol);
+  void record(ElfW(Word) sym_index, soinfo* si_found_in, const ElfW(Sym)* symbol);
+
+  soinfo* si_from_;
+  const soinfo_list_t& global_group_;
+  const soinfo_list_t& local_group_;
+
+  bool enabled_;
+  bool dirty_;
+
+  std::vector<soinfo*> scope_;
+  std::unordered_map<const soinfo*, uint32_t> scope_indexes_;
+
+  const symbol_cache_entry_t* cached_entries_;
+  size_t cached_entries_count_;
+
+  std::vector<symbol_cache_entry_t> entries_;
+
+  DISALLOW_COPY_AND_ASSIGN(SymbolLookupSession);
+};
+
+#endif  /* __LINKER_SYMBOL_CACHE_H */
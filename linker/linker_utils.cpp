@@ -135,6 +135,33 @@ bool parse_zip_path(const char* input_path, std::string* zip_path, std::string*
 
 constexpr off64_t kPageMask = ~static_cast<off64_t>(PAGE_SIZE-1);
 
+bool file_is_trusted(const struct stat& file_stat) {
+  return (file_stat.st_uid == 0 || file_stat.st_uid == getuid()) &&
+         (file_stat.st_mode & (S_IWGRP | S_IWOTH)) == 0;
+}
+
+uint64_t fnv1a(uint64_t hash, const void* data, size_t size) {
+  const uint8_t* p = static_cast<const uint8_t*>(data);
+  for (size_t i = 0; i < size; ++i) {
+    hash ^= p[i];
+    hash *= 0x100000001b3ULL;
+  }
+  return hash;
+}
+
+bool write_fully(int fd, const void* data, size_t size) {
+  const uint8_t* p = static_cast<const uint8_t*>(data);
+  while (size > 0) {
+    ssize_t n = TEMP_FAILURE_RETRY(write(fd, p, size));
+    if (n <= 0) {
+      return false;
+    }
+    p += n;
+    size -= n;
+  }
+  return true;
+}
+
 off64_t page_start(off64_t offset) {
   return offset & kPageMask;
 }
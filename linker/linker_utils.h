@@ -16,6 +16,9 @@
 #ifndef __LINKER_UTILS_H
 #define __LINKER_UTILS_H
 
+#include <stdint.h>
+#include <sys/stat.h>
+
 #include <string>
 #include <vector>
 
@@ -36,6 +39,18 @@ void split_path(const char* path, const char* delimiters, std::vector<std::strin
 
 std::string dirname(const char* path);
 
+// True if a file the linker reads cached state from is owned by root or
+// the current user and is not writable by anyone else.
+bool file_is_trusted(const struct stat& file_stat);
+
+// 64-bit FNV-1a of size bytes at data, continuing from hash; start with
+// kFnv1aInitialHash.
+constexpr uint64_t kFnv1aInitialHash = 0xcbf29ce484222325ULL;
+uint64_t fnv1a(uint64_t hash, const void* data, size_t size);
+
+// Writes all size bytes at data to fd, retrying short writes.
+bool write_fully(int fd, const void* data, size_t size);
+
 off64_t page_start(off64_t offset);
 size_t page_offset(off64_t offset);
 bool safe_add(off64_t* out, off64_t a, size_t b);
@@ -29,6 +29,7 @@ LOCAL_C_INCLUDES := $(LOCAL_PATH)/../../libc/
 LOCAL_SRC_FILES := \
   linker_block_allocator_test.cpp \
   linker_globals.cpp \
+  linker_group_varint_test.cpp \
   linked_list_test.cpp \
   linker_memory_allocator_test.cpp \
   linker_sleb128_test.cpp \
@@ -17,6 +17,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <sys/mman.h>
+#include <vector>
 
 #include <gtest/gtest.h>
 
@@ -134,3 +135,34 @@ TEST(linker_allocator, test_protect) {
   ASSERT_EXIT(protect_all(), testing::KilledBySignal(SIGSEGV), "trying to access protected page");
 }
 
+
+TEST(linker_allocator, test_purge) {
+  LinkerTypeAllocator<test_struct_larger> allocator;
+
+  // Enough blocks to need several chunks.
+  std::vector<test_struct_larger*> ptrs;
+  for (size_t i = 0; i < 64*kPageSize/sizeof(test_struct_larger); ++i) {
+    ptrs.push_back(allocator.alloc());
+    ASSERT_TRUE(ptrs.back() != nullptr);
+  }
+
+  test_struct_larger* kept = ptrs[0];
+  kept->dummy_str[0] = 42;
+  for (size_t i = 1; i < ptrs.size(); ++i) {
+    allocator.free(ptrs[i]);
+  }
+
+  allocator.purge();
+
+  // The released chunks must not be referenced any more.
+  allocator.protect_all(PROT_READ);
+  allocator.protect_all(PROT_READ | PROT_WRITE);
+  ASSERT_EQ(42, kept->dummy_str[0]);
+
+  for (size_t i = 1; i < ptrs.size(); ++i) {
+    ptrs[i] = allocator.alloc();
+    ASSERT_TRUE(ptrs[i] != nullptr);
+    ptrs[i]->dummy_str[0] = 1;
+  }
+  ASSERT_EQ(42, kept->dummy_str[0]);
+}
@@ -0,0 +1,105 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdint.h>
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "../linker_group_varint.h"
+
+TEST(linker_group_varint, smoke) {
+  std::vector<uint8_t> encoding;
+  // 0, 1, -1, 300: 1, 1, 1 and 2 bytes.
+  encoding.push_back(0x40);
+  encoding.push_back(0x00);
+  encoding.push_back(0x02);
+  encoding.push_back(0x01);
+  encoding.push_back(0x58);
+  encoding.push_back(0x02);
+  // -70000, 2147483647, -2147483648, then padding: 4, 4, 4 and 1 bytes.
+  encoding.push_back(0x2a);
+  encoding.push_back(0xdf);
+  encoding.push_back(0x22);
+  encoding.push_back(0x02);
+  encoding.push_back(0x00);
+  encoding.push_back(0xfe);
+  encoding.push_back(0xff);
+  encoding.push_back(0xff);
+  encoding.push_back(0xff);
+  encoding.push_back(0xff);
+  encoding.push_back(0xff);
+  encoding.push_back(0xff);
+  encoding.push_back(0xff);
+  encoding.push_back(0x00);
+#if defined(__LP64__)
+  // 9223372036854775807, -9223372036854775808, then padding: 8, 8, 1 and 1 bytes.
+  encoding.push_back(0x0f);
+  encoding.push_back(0xfe);
+  for (size_t i = 0; i < 15; ++i) {
+    encoding.push_back(0xff);
+  }
+  encoding.push_back(0x00);
+  encoding.push_back(0x00);
+#endif
+  group_varint_decoder decoder(&encoding[0], encoding.size());
+
+  EXPECT_EQ(0U, decoder.pop_front());
+  EXPECT_EQ(1U, decoder.pop_front());
+  EXPECT_EQ(static_cast<size_t>(-1), decoder.pop_front());
+  EXPECT_EQ(300U, decoder.pop_front());
+  EXPECT_EQ(static_cast<size_t>(-70000), decoder.pop_front());
+  EXPECT_EQ(2147483647U, decoder.pop_front());
+  EXPECT_EQ(static_cast<size_t>(-2147483648), decoder.pop_front());
+  EXPECT_EQ(0U, decoder.pop_front());
+#if defined(__LP64__)
+  EXPECT_EQ(9223372036854775807ULL, decoder.pop_front());
+  EXPECT_EQ(static_cast<uint64_t>(-9223372036854775807LL - 1), decoder.pop_front());
+  EXPECT_EQ(0U, decoder.pop_front());
+  EXPECT_EQ(0U, decoder.pop_front());
+#endif
+}
+
+// Enough blocks that all but the last few take the unchecked path.
+TEST(linker_group_varint, long_stream) {
+  std::vector<size_t> values;
+  for (size_t i = 0; i < 1000; ++i) {
+    size_t value = i * 0x9e3779b9;
+    values.push_back((i & 1) ? value : -value);
+    values.push_back(i);
+  }
+
+  std::vector<uint8_t> encoding;
+  for (size_t i = 0; i < values.size(); i += 4) {
+    size_t tag_index = encoding.size();
+    encoding.push_back(0);
+    for (size_t j = 0; j < 4; ++j) {
+      uint64_t value = static_cast<int64_t>(static_cast<ssize_t>(values[i + j]));
+      value = (value << 1) ^ -(value >> 63);
+      size_t code = value <= 0xff ? 0 : value <= 0xffff ? 1 : value <= 0xffffffff ? 2 : 3;
+      encoding[tag_index] |= code << (2 * j);
+      for (size_t k = 0; k < (1U << code); ++k) {
+        encoding.push_back(static_cast<uint8_t>(value >> (8 * k)));
+      }
+    }
+  }
+
+  group_varint_decoder decoder(&encoding[0], encoding.size());
+  for (size_t i = 0; i < values.size(); ++i) {
+    ASSERT_EQ(values[i], decoder.pop_front()) << i;
+  }
+}
@@ -201,3 +201,42 @@ TEST(linker_memory, test_large) {
 }
 
 
+
+TEST(linker_memory, test_size_classes) {
+  LinkerMemoryAllocator allocator;
+
+  // Sizes above 128 are rounded up to a quarter of a power of two, not to the next power of two.
+  void* ptr1 = allocator.alloc(129);
+  void* ptr2 = allocator.alloc(160);
+  ASSERT_EQ(reinterpret_cast<uintptr_t>(ptr1) + 160, reinterpret_cast<uintptr_t>(ptr2));
+
+  void* ptr3 = allocator.alloc(600);
+  void* ptr4 = allocator.alloc(640);
+  ASSERT_EQ(reinterpret_cast<uintptr_t>(ptr3) + 640, reinterpret_cast<uintptr_t>(ptr4));
+
+  // realloc within the size class doesn't move.
+  ASSERT_EQ(ptr3, allocator.realloc(ptr3, 640));
+
+  allocator.free(ptr1);
+  allocator.free(ptr2);
+  allocator.free(ptr3);
+  allocator.free(ptr4);
+}
+
+TEST(linker_memory, test_many_pages) {
+  LinkerMemoryAllocator allocator;
+
+  // Fill more pages than the allocator keeps in reserve, then free them all, twice over.
+  const size_t n = 64 * kPageSize / 256;
+  void* ptrs[n];
+  for (size_t round = 0; round < 2; ++round) {
+    for (size_t i = 0; i < n; ++i) {
+      ptrs[i] = allocator.alloc(256);
+      ASSERT_TRUE(ptrs[i] != nullptr);
+      memset(ptrs[i], 0xff, 256);
+    }
+    for (size_t i = 0; i < n; ++i) {
+      allocator.free(ptrs[i]);
+    }
+  }
+}
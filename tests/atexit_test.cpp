@@ -31,6 +31,8 @@
 #include <limits.h>
 #include <stdio.h>
 #include <stdint.h>
+#include <stdlib.h>
+#include <unistd.h>
 
 #include <string>
 
@@ -117,3 +119,63 @@ TEST(atexit, exit) {
   ASSERT_EXIT(atexit_main(), testing::ExitedWithCode(0), "123456");
 }
 
+
+extern "C" int __cxa_atexit(void (*)(void*), void*, void*);
+extern "C" void __cxa_finalize(void*);
+
+static std::string cxa_finalize_sequence;
+
+static void cxa_finalize_record(void* arg) {
+  cxa_finalize_sequence += std::to_string(reinterpret_cast<uintptr_t>(arg)) + " ";
+}
+
+static void cxa_finalize_main() {
+  // Enough DSOs that libc's per-DSO index has to grow, with their handlers interleaved.
+  static char dsos[1024];
+  for (uintptr_t i = 0; i < 4096; ++i) {
+    if (__cxa_atexit(cxa_finalize_record, reinterpret_cast<void*>(i), &dsos[i % 1024]) != 0) {
+      _exit(1);
+    }
+  }
+  __cxa_finalize(&dsos[7]);
+  if (cxa_finalize_sequence != "3079 2055 1031 7 ") _exit(2);
+  cxa_finalize_sequence.clear();
+  __cxa_finalize(&dsos[7]);
+  if (!cxa_finalize_sequence.empty()) _exit(3);
+  _exit(0);
+}
+
+TEST(atexit, cxa_finalize_dso) {
+  ASSERT_EXIT(cxa_finalize_main(), testing::ExitedWithCode(0), "");
+}
+
+#if defined(__BIONIC__)
+static void fast_exit_not_run() {
+  _exit(1);
+}
+
+static void fast_exit_quick() {
+  fprintf(stderr, "1");
+}
+
+static void fast_exit_main() {
+  // Neither atexit handlers nor static destructors should run.
+  static TestMainStaticDtorClass static_obj;
+  atexit(fast_exit_not_run);
+  at_quick_exit(fast_exit_quick);
+  // But output still buffered in a stream should be written.
+  FILE* fp = fdopen(dup(STDERR_FILENO), "w");
+  setvbuf(fp, nullptr, _IOFBF, BUFSIZ);
+  fprintf(fp, "2");
+  android_set_fast_exit(1);
+  exit(0);
+}
+#endif
+
+TEST(atexit, fast_exit) {
+#if defined(__BIONIC__)
+  ASSERT_EXIT(fast_exit_main(), testing::ExitedWithCode(0), "^12$");
+#else
+  GTEST_LOG_(INFO) << "This test does nothing.\n";
+#endif
+}
@@ -136,3 +136,23 @@ TEST(ctype, _toupper) {
   // _toupper may mangle characters for which islower is false.
   EXPECT_EQ('A', _toupper('a'));
 }
+
+TEST(ctype, non_ascii) {
+  // Nothing outside ASCII is in any class in the C locale, and that includes
+  // EOF and the negative values you get from a signed char.
+  for (int c = -128; c < 256; ++c) {
+    if (c >= 0 && c < 0x80) continue;
+    EXPECT_FALSE(isalnum(c)) << c;
+    EXPECT_FALSE(isalpha(c)) << c;
+    EXPECT_FALSE(isblank(c)) << c;
+    EXPECT_FALSE(iscntrl(c)) << c;
+    EXPECT_FALSE(isdigit(c)) << c;
+    EXPECT_FALSE(isgraph(c)) << c;
+    EXPECT_FALSE(islower(c)) << c;
+    EXPECT_FALSE(isprint(c)) << c;
+    EXPECT_FALSE(ispunct(c)) << c;
+    EXPECT_FALSE(isspace(c)) << c;
+    EXPECT_FALSE(isupper(c)) << c;
+    EXPECT_FALSE(isxdigit(c)) << c;
+  }
+}
@@ -27,6 +27,9 @@
 #include <algorithm>
 #include <set>
 #include <string>
+#include <vector>
+
+#include "TemporaryFile.h"
 
 static void CheckProcSelf(std::set<std::string>& names) {
   // We have a good idea of what should be in /proc/self.
@@ -344,3 +347,81 @@ TEST(dirent, seekdir_telldir) {
 
   ASSERT_EQ(0, closedir(d));
 }
+
+TEST(dirent, android_readdir_batch) {
+#if defined(__BIONIC__)
+  DIR* d = opendir("/proc/self");
+  ASSERT_TRUE(d != NULL);
+  std::set<std::string> name_set;
+  errno = 0;
+  dirent* entries[8];
+  int count;
+  while ((count = android_readdir_batch(d, entries, 8)) > 0) {
+    ASSERT_LE(count, 8);
+    for (int i = 0; i < count; ++i) {
+      name_set.insert(entries[i]->d_name);
+    }
+  }
+  // Reading to the end of the directory is not an error.
+  ASSERT_EQ(0, count);
+  ASSERT_EQ(0, errno);
+  ASSERT_EQ(closedir(d), 0);
+
+  CheckProcSelf(name_set);
+#else
+  GTEST_LOG_(INFO) << "This test does nothing.\n";
+#endif
+}
+
+TEST(dirent, android_readdir_batch_big_directory) {
+#if defined(__BIONIC__)
+  // Enough entries that readdir has to move on to its bigger buffers.
+  TemporaryDir td;
+  std::set<std::string> expected{".", ".."};
+  for (int i = 0; i < 2000; ++i) {
+    std::string name = "a-reasonably-long-file-name-" + std::to_string(i);
+    int fd = open((std::string(td.dirname) + "/" + name).c_str(), O_CREAT | O_WRONLY, 0600);
+    ASSERT_NE(-1, fd);
+    close(fd);
+    expected.insert(name);
+  }
+
+  DIR* d = opendir(td.dirname);
+  ASSERT_TRUE(d != NULL);
+  std::vector<std::string> batch_names;
+  dirent* entries[64];
+  int count;
+  while ((count = android_readdir_batch(d, entries, 64)) > 0) {
+    for (int i = 0; i < count; ++i) {
+      batch_names.push_back(entries[i]->d_name);
+    }
+  }
+  ASSERT_EQ(0, count);
+
+  // readdir sees the same names in the same order.
+  rewinddir(d);
+  std::vector<std::string> readdir_names;
+  dirent* e;
+  while ((e = readdir(d)) != NULL) {
+    readdir_names.push_back(e->d_name);
+  }
+  ASSERT_EQ(0, closedir(d));
+  ASSERT_EQ(readdir_names, batch_names);
+  ASSERT_EQ(expected, std::set<std::string>(batch_names.begin(), batch_names.end()));
+
+  // And so does scandir.
+  dirent** scandir_entries;
+  int scandir_count = scandir(td.dirname, &scandir_entries, NULL, alphasort);
+  ASSERT_EQ(static_cast<int>(expected.size()), scandir_count);
+  std::set<std::string> scandir_set;
+  std::vector<std::string> scandir_list;
+  ScanEntries(scandir_entries, scandir_count, scandir_set, scandir_list);
+  ASSERT_EQ(expected, scandir_set);
+
+  for (const std::string& name : expected) {
+    if (name != "." && name != "..") unlink((std::string(td.dirname) + "/" + name).c_str());
+  }
+#else
+  GTEST_LOG_(INFO) << "This test does nothing.\n";
+#endif
+}
@@ -58,6 +58,11 @@ enum {
   ANDROID_NAMESPACE_TYPE_SHARED = 2,
   ANDROID_NAMESPACE_TYPE_SHARED_ISOLATED = ANDROID_NAMESPACE_TYPE_SHARED |
                                            ANDROID_NAMESPACE_TYPE_ISOLATED,
+
+  /* Libraries loaded into this namespace are mapped as if
+   * ANDROID_DLEXT_HUGE_PAGE_ALIGN was specified.
+   */
+  ANDROID_NAMESPACE_TYPE_HUGE_PAGE_ALIGN = 4,
 };
 
 /*
@@ -232,6 +232,78 @@ TEST(dlext, android_dlopen_ext_force_load_soname_exception) {
   dlclose(handle);
 }
 
+TEST(dlext, android_dlopen_ext_parallel_load_smoke) {
+  // libtest_check_order_dlsym.so has a tree of DT_NEEDED libraries; mapping
+  // them in parallel must not change the order in which symbols are resolved.
+  android_dlextinfo extinfo;
+  extinfo.flags = ANDROID_DLEXT_PARALLEL_LOAD;
+  void* handle = android_dlopen_ext("libtest_check_order_dlsym.so", RTLD_NOW, &extinfo);
+  ASSERT_DL_NOTNULL(handle);
+
+  typedef int (*fn_t) (void);
+  fn_t fn = reinterpret_cast<fn_t>(dlsym(handle, "check_order_dlsym_get_answer"));
+  ASSERT_DL_NOTNULL(fn);
+  fn_t fn2 = reinterpret_cast<fn_t>(dlsym(handle, "check_order_dlsym_get_answer2"));
+  ASSERT_DL_NOTNULL(fn2);
+
+  ASSERT_EQ(42, fn());
+  ASSERT_EQ(43, fn2());
+  dlclose(handle);
+}
+
+TEST(dlext, android_dlopen_ext_lazy_bind_smoke) {
+  // Libraries built with -z now are bound eagerly even with
+  // ANDROID_DLEXT_LAZY_BIND; either way calls must reach the right targets.
+  android_dlextinfo extinfo;
+  extinfo.flags = ANDROID_DLEXT_LAZY_BIND;
+  void* handle = android_dlopen_ext("libtest_check_order_reloc_siblings.so", RTLD_NOW, &extinfo);
+  ASSERT_DL_NOTNULL(handle);
+
+  // check_order_reloc_get_answer() calls into a sibling library through the PLT.
+  typedef int (*fn_t) (void);
+  fn_t fn = reinterpret_cast<fn_t>(dlsym(handle, "check_order_reloc_get_answer"));
+  ASSERT_DL_NOTNULL(fn);
+  ASSERT_EQ(42, fn());
+  ASSERT_EQ(42, fn());
+
+  dlclose(handle);
+}
+
+TEST(dlext, android_dlopen_ext_huge_page_align_smoke) {
+  // Test libraries are not 2 MB aligned, so this must fall back to the
+  // regular mapping.
+  android_dlextinfo extinfo;
+  extinfo.flags = ANDROID_DLEXT_HUGE_PAGE_ALIGN;
+  void* handle = android_dlopen_ext("libtest_check_order_dlsym.so", RTLD_NOW, &extinfo);
+  ASSERT_DL_NOTNULL(handle);
+
+  typedef int (*fn_t) (void);
+  fn_t fn = reinterpret_cast<fn_t>(dlsym(handle, "check_order_dlsym_get_answer"));
+  ASSERT_DL_NOTNULL(fn);
+  ASSERT_EQ(42, fn());
+
+  dlclose(handle);
+}
+
+TEST(dlext, android_dlopen_ext_parallel_constructors) {
+  android_dlextinfo extinfo;
+  extinfo.flags = ANDROID_DLEXT_PARALLEL_CONSTRUCTORS;
+  void* handle = android_dlopen_ext("libtest_check_order_reloc_siblings.so", RTLD_NOW, &extinfo);
+  ASSERT_DL_NOTNULL(handle);
+
+  typedef int (*fn_t) (void);
+  fn_t fn = reinterpret_cast<fn_t>(dlsym(handle, "check_order_reloc_get_answer"));
+  ASSERT_DL_NOTNULL(fn);
+  ASSERT_EQ(42, fn());
+  dlclose(handle);
+
+  // libtest_dlopen_from_ctor.so calls dlopen() from its constructor, which
+  // must not deadlock on the lock held by this dlopen().
+  handle = android_dlopen_ext("libtest_dlopen_from_ctor_main.so", RTLD_NOW, &extinfo);
+  ASSERT_DL_NOTNULL(handle);
+  dlclose(handle);
+}
+
 TEST(dlfcn, dlopen_from_zip_absolute_path) {
   std::string lib_path;
   ASSERT_TRUE(get_realpath(std::string(getenv("ANDROID_DATA")) + LIBZIPPATH, &lib_path)) << strerror(errno);
@@ -298,6 +370,33 @@ TEST(dlfcn, dlopen_from_zip_ld_library_path) {
   dlclose(handle);
 }
 
+TEST(dlfcn, dlopen_ld_library_path_sees_new_library) {
+  const std::string lib_path = std::string(getenv("ANDROID_DATA")) + LIBPATH;
+  TemporaryDir dir;
+  const std::string link_path = std::string(dir.dirname) + "/libdlext_test_path_cache.so";
+
+  typedef void (*fn_t)(const char*);
+  fn_t android_update_LD_LIBRARY_PATH =
+      reinterpret_cast<fn_t>(dlsym(RTLD_DEFAULT, "android_update_LD_LIBRARY_PATH"));
+
+  ASSERT_TRUE(android_update_LD_LIBRARY_PATH != nullptr) << dlerror();
+
+  android_update_LD_LIBRARY_PATH(dir.dirname);
+
+  // The miss must not hide the library once it shows up.
+  void* handle = dlopen("libdlext_test_path_cache.so", RTLD_NOW);
+  ASSERT_TRUE(handle == nullptr);
+
+  ASSERT_EQ(0, symlink(lib_path.c_str(), link_path.c_str())) << strerror(errno);
+
+  handle = dlopen("libdlext_test_path_cache.so", RTLD_NOW);
+  ASSERT_DL_NOTNULL(handle);
+  dlclose(handle);
+
+  ASSERT_EQ(0, unlink(link_path.c_str()));
+  android_update_LD_LIBRARY_PATH("");
+}
+
 
 TEST_F(DlExtTest, Reserved) {
   void* start = mmap(nullptr, LIBSIZE, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
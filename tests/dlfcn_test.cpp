@@ -19,12 +19,16 @@
 #include <dlfcn.h>
 #include <libgen.h>
 #include <limits.h>
+#include <link.h>
 #include <stdio.h>
 #include <stdint.h>
+#include <string.h>
 
 #include "private/ScopeGuard.h"
 
+#include <atomic>
 #include <string>
+#include <vector>
 
 #include "utils.h"
 
@@ -348,6 +352,194 @@ TEST(dlfcn, dlopen_check_order_dlsym) {
   dlclose(handle);
 }
 
+TEST(dlfcn, dlsym_rtld_default_after_dlopen_dlclose) {
+  // Repeated dlsym(RTLD_DEFAULT, ...) lookups, both misses and hits, must
+  // observe libraries being opened and closed in-between.
+  ASSERT_TRUE(dlsym(RTLD_DEFAULT, "check_order_dlsym_get_answer") == nullptr);
+  ASSERT_TRUE(dlsym(RTLD_DEFAULT, "check_order_dlsym_get_answer") == nullptr);
+
+  void* handle = dlopen("libtest_check_order_dlsym.so", RTLD_NOW | RTLD_GLOBAL);
+  ASSERT_TRUE(handle != nullptr) << dlerror();
+
+  void* sym = dlsym(RTLD_DEFAULT, "check_order_dlsym_get_answer");
+  ASSERT_TRUE(sym != nullptr) << dlerror();
+  ASSERT_EQ(sym, dlsym(RTLD_DEFAULT, "check_order_dlsym_get_answer"));
+  ASSERT_EQ(sym, dlsym(handle, "check_order_dlsym_get_answer"));
+
+  dlclose(handle);
+  ASSERT_TRUE(dlsym(RTLD_DEFAULT, "check_order_dlsym_get_answer") == nullptr);
+}
+
+static int get_last_dl_phdr_info(dl_phdr_info* info, size_t size, void* data) {
+  EXPECT_GE(size, sizeof(dl_phdr_info));
+  *reinterpret_cast<dl_phdr_info*>(data) = *info;
+  return 0;
+}
+
+TEST(dlfcn, dl_iterate_phdr_adds_subs) {
+  dl_phdr_info before = {};
+  dl_iterate_phdr(get_last_dl_phdr_info, &before);
+
+  void* handle = dlopen("libtest_check_order_dlsym.so", RTLD_NOW);
+  ASSERT_TRUE(handle != nullptr) << dlerror();
+  dl_phdr_info loaded = {};
+  dl_iterate_phdr(get_last_dl_phdr_info, &loaded);
+  ASSERT_GT(loaded.dlpi_adds, before.dlpi_adds);
+  ASSERT_EQ(before.dlpi_subs, loaded.dlpi_subs);
+
+  dlclose(handle);
+  dl_phdr_info unloaded = {};
+  dl_iterate_phdr(get_last_dl_phdr_info, &unloaded);
+  ASSERT_EQ(loaded.dlpi_adds, unloaded.dlpi_adds);
+  ASSERT_GT(unloaded.dlpi_subs, loaded.dlpi_subs);
+}
+
+static int collect_dl_phdr_names(dl_phdr_info* info, size_t, void* data) {
+  std::vector<std::string>* names = reinterpret_cast<std::vector<std::string>*>(data);
+  names->push_back(info->dlpi_name == nullptr ? "" : info->dlpi_name);
+  return 0;
+}
+
+TEST(dlfcn, android_get_dl_phdr_snapshot) {
+#if defined(__BIONIC__)
+  const android_dl_phdr_snapshot* snapshot = android_get_dl_phdr_snapshot();
+  ASSERT_TRUE(snapshot != nullptr);
+  ASSERT_EQ(snapshot, android_get_dl_phdr_snapshot());
+
+  std::vector<std::string> names;
+  dl_iterate_phdr(collect_dl_phdr_names, &names);
+  ASSERT_EQ(names.size(), snapshot->count);
+  for (size_t i = 0; i < snapshot->count; ++i) {
+    const char* name = snapshot->infos[i].dlpi_name;
+    ASSERT_EQ(names[i], name == nullptr ? "" : name);
+  }
+
+  void* handle = dlopen("libtest_check_order_dlsym.so", RTLD_NOW);
+  ASSERT_TRUE(handle != nullptr) << dlerror();
+  const android_dl_phdr_snapshot* loaded = android_get_dl_phdr_snapshot();
+  ASSERT_TRUE(loaded != nullptr);
+  ASSERT_NE(snapshot, loaded);
+  ASSERT_GT(loaded->count, snapshot->count);
+  ASSERT_GT(loaded->dlpi_adds, snapshot->dlpi_adds);
+
+  dlclose(handle);
+  const android_dl_phdr_snapshot* unloaded = android_get_dl_phdr_snapshot();
+  ASSERT_TRUE(unloaded != nullptr);
+  ASSERT_EQ(snapshot->count, unloaded->count);
+  ASSERT_GT(unloaded->dlpi_subs, loaded->dlpi_subs);
+#else
+  GTEST_LOG_(INFO) << "This test does nothing.\n";
+#endif
+}
+
+// mips doesn't support ELF TLS
+#if !defined(__mips__)
+typedef int (*elftls_bump_counter_fn)();
+typedef char* (*elftls_get_buffer_fn)();
+
+struct ElfTlsThreadResult {
+  void* handle;
+  int counter;
+  char* buffer;
+  bool buffer_zeroed;
+};
+
+static void* ElfTlsThreadFn(void* arg) {
+  ElfTlsThreadResult* result = reinterpret_cast<ElfTlsThreadResult*>(arg);
+  auto bump = reinterpret_cast<elftls_bump_counter_fn>(dlsym(result->handle,
+                                                             "elftls_bump_counter"));
+  auto get_buffer = reinterpret_cast<elftls_get_buffer_fn>(dlsym(result->handle,
+                                                                 "elftls_get_buffer"));
+  result->counter = bump();
+  result->buffer = get_buffer();
+  result->buffer_zeroed = true;
+  for (size_t i = 0; i < 4096; ++i) {
+    if (result->buffer[i] != 0) result->buffer_zeroed = false;
+  }
+  return nullptr;
+}
+
+TEST(dlfcn, elftls_dynamic) {
+  void* handle = dlopen("libtest_elftls_dynamic.so", RTLD_NOW);
+  ASSERT_TRUE(handle != nullptr) << dlerror();
+  auto bump = reinterpret_cast<elftls_bump_counter_fn>(dlsym(handle, "elftls_bump_counter"));
+  ASSERT_TRUE(bump != nullptr) << dlerror();
+  auto get_buffer = reinterpret_cast<elftls_get_buffer_fn>(dlsym(handle, "elftls_get_buffer"));
+  ASSERT_TRUE(get_buffer != nullptr) << dlerror();
+
+  ASSERT_EQ(43, bump());
+  ASSERT_EQ(44, bump());
+  char* buffer = get_buffer();
+  ASSERT_EQ(buffer, get_buffer());
+  memset(buffer, 'x', 4096);
+
+  // Another thread gets its own copy of each variable, initialized from the
+  // library's template.
+  ElfTlsThreadResult result = { handle, 0, nullptr, false };
+  pthread_t t;
+  ASSERT_EQ(0, pthread_create(&t, nullptr, ElfTlsThreadFn, &result));
+  ASSERT_EQ(0, pthread_join(t, nullptr));
+  ASSERT_EQ(43, result.counter);
+  ASSERT_NE(buffer, result.buffer);
+  ASSERT_TRUE(result.buffer_zeroed);
+  ASSERT_EQ(45, bump());
+
+  // A reloaded library starts over.
+  dlclose(handle);
+  handle = dlopen("libtest_elftls_dynamic.so", RTLD_NOW);
+  ASSERT_TRUE(handle != nullptr) << dlerror();
+  bump = reinterpret_cast<elftls_bump_counter_fn>(dlsym(handle, "elftls_bump_counter"));
+  ASSERT_TRUE(bump != nullptr) << dlerror();
+  ASSERT_EQ(43, bump());
+  dlclose(handle);
+}
+
+static int find_elftls_dynamic(dl_phdr_info* info, size_t, void* data) {
+  if (info->dlpi_name != nullptr && strstr(info->dlpi_name, "libtest_elftls_dynamic.so")) {
+    *reinterpret_cast<dl_phdr_info*>(data) = *info;
+    return 1;
+  }
+  return 0;
+}
+
+TEST(dlfcn, elftls_dl_iterate_phdr) {
+  void* handle = dlopen("libtest_elftls_dynamic.so", RTLD_NOW);
+  ASSERT_TRUE(handle != nullptr) << dlerror();
+  auto get_buffer = reinterpret_cast<elftls_get_buffer_fn>(dlsym(handle, "elftls_get_buffer"));
+  ASSERT_TRUE(get_buffer != nullptr) << dlerror();
+
+  dl_phdr_info info = {};
+  ASSERT_EQ(1, dl_iterate_phdr(find_elftls_dynamic, &info));
+  ASSERT_NE(0U, info.dlpi_tls_modid);
+
+  // Once this thread has touched the library's variables, dlpi_tls_data is
+  // its block.
+  char* buffer = get_buffer();
+  ASSERT_EQ(1, dl_iterate_phdr(find_elftls_dynamic, &info));
+  ASSERT_TRUE(info.dlpi_tls_data != nullptr);
+  ASSERT_GE(buffer, static_cast<char*>(info.dlpi_tls_data));
+
+  // Module ids aren't reused.
+  size_t modid = info.dlpi_tls_modid;
+  dlclose(handle);
+  handle = dlopen("libtest_elftls_dynamic.so", RTLD_NOW);
+  ASSERT_TRUE(handle != nullptr) << dlerror();
+  ASSERT_EQ(1, dl_iterate_phdr(find_elftls_dynamic, &info));
+#if defined(__BIONIC__)
+  ASSERT_NE(modid, info.dlpi_tls_modid);
+#else
+  (void) modid;
+#endif
+
+#if defined(__BIONIC__)
+  // There's no single address to return for a TLS variable.
+  ASSERT_TRUE(dlsym(handle, "tls_buffer") == nullptr);
+  ASSERT_SUBSTR("is a TLS symbol", dlerror());
+#endif
+  dlclose(handle);
+}
+#endif // !defined(__mips__)
+
 TEST(dlfcn, dlopen_check_order_reloc_siblings) {
   // This is how this one works:
   // we lookup and call get_answer which is defined in '_2.so'
@@ -901,6 +1093,49 @@ TEST(dlfcn, dladdr_invalid) {
   ASSERT_TRUE(dlerror() == nullptr); // dladdr(3) doesn't set dlerror(3).
 }
 
+static std::atomic<bool> g_dladdr_thread_stop;
+
+static void* ConcurrentDladdrFn(void*) {
+  void* addr = reinterpret_cast<void*>(puts);
+  while (!g_dladdr_thread_stop) {
+    Dl_info info;
+    if (dladdr(addr, &info) == 0 || info.dli_sname == nullptr ||
+        strcmp("puts", info.dli_sname) != 0) {
+      return addr;
+    }
+  }
+  return nullptr;
+}
+
+TEST(dlfcn, dladdr_concurrent_with_dlopen_dlclose) {
+  g_dladdr_thread_stop = false;
+  pthread_t t;
+  ASSERT_EQ(0, pthread_create(&t, nullptr, ConcurrentDladdrFn, nullptr));
+  auto guard = make_scope_guard([&]() {
+    g_dladdr_thread_stop = true;
+    pthread_join(t, nullptr);
+  });
+
+  for (int i = 0; i < 100; ++i) {
+    void* handle = dlopen("libtest_simple.so", RTLD_NOW);
+    ASSERT_TRUE(handle != nullptr) << dlerror();
+    void* sym = dlsym(handle, "dlopen_testlib_simple_func");
+    ASSERT_TRUE(sym != nullptr) << dlerror();
+
+    Dl_info info;
+    ASSERT_NE(0, dladdr(sym, &info));
+    ASSERT_STREQ("dlopen_testlib_simple_func", info.dli_sname);
+    ASSERT_EQ(sym, info.dli_saddr);
+    ASSERT_EQ(0, dlclose(handle));
+  }
+
+  guard.disable();
+  g_dladdr_thread_stop = true;
+  void* thread_result;
+  ASSERT_EQ(0, pthread_join(t, &thread_result));
+  ASSERT_EQ(nullptr, thread_result);
+}
+
 // GNU-style ELF hash tables are incompatible with the MIPS ABI.
 // MIPS requires .dynsym to be sorted to match the GOT but GNU-style requires sorting by hash code.
 TEST(dlfcn, dlopen_library_with_only_gnu_hash) {
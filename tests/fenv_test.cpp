@@ -83,3 +83,30 @@ TEST(fenv, feclearexcept_fetestexcept) {
 TEST(fenv, FE_DFL_ENV_macro) {
   ASSERT_EQ(0, fesetenv(FE_DFL_ENV));
 }
+
+TEST(fenv, feswapround) {
+#if defined(__BIONIC__)
+  fesetround(FE_TONEAREST);
+  ASSERT_EQ(FE_TONEAREST, feswapround(FE_TOWARDZERO));
+  ASSERT_EQ(FE_TOWARDZERO, fegetround());
+  TestRounding(8388609.0f, 1.0f);
+  ASSERT_EQ(FE_TOWARDZERO, feswapround(FE_UPWARD));
+  TestRounding(8388610.0f, 2.0f);
+  ASSERT_EQ(FE_UPWARD, feswapround(FE_DOWNWARD));
+  TestRounding(8388609.0f, 1.0f);
+
+  // Setting the current mode changes nothing.
+  ASSERT_EQ(FE_DOWNWARD, feswapround(FE_DOWNWARD));
+  ASSERT_EQ(FE_DOWNWARD, fegetround());
+
+  // An invalid mode is rejected, and the mode stays as it was.
+  ASSERT_EQ(-1, feswapround(-1));
+  ASSERT_EQ(FE_DOWNWARD, fegetround());
+
+  ASSERT_EQ(FE_DOWNWARD, feswapround(FE_TONEAREST));
+  ASSERT_EQ(FE_TONEAREST, fegetround());
+  TestRounding(8388610.0f, 2.0f);
+#else // __BIONIC__
+  GTEST_LOG_(INFO) << "This test does nothing.\n";
+#endif // __BIONIC__
+}
@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <fnmatch.h>
+
+TEST(fnmatch, literal) {
+  ASSERT_EQ(0, fnmatch("", "", 0));
+  ASSERT_EQ(0, fnmatch("abc", "abc", 0));
+  ASSERT_EQ(FNM_NOMATCH, fnmatch("abc", "abcd", 0));
+  ASSERT_EQ(FNM_NOMATCH, fnmatch("abc", "ab", 0));
+  ASSERT_EQ(0, fnmatch("a/b", "a/b", FNM_PATHNAME));
+  ASSERT_EQ(FNM_NOMATCH, fnmatch("a/b", "a//b", FNM_PATHNAME));
+}
+
+TEST(fnmatch, prefix) {
+  ASSERT_EQ(0, fnmatch("abc*", "abc", 0));
+  ASSERT_EQ(0, fnmatch("abc*", "abcdef", 0));
+  ASSERT_EQ(FNM_NOMATCH, fnmatch("abc*", "ab", 0));
+  ASSERT_EQ(0, fnmatch("abc*", "abc/def", 0));
+  ASSERT_EQ(FNM_NOMATCH, fnmatch("abc*", "abc/def", FNM_PATHNAME));
+  ASSERT_EQ(0, fnmatch("abc/*", "abc/def", FNM_PATHNAME));
+  ASSERT_EQ(0, fnmatch(".abc*", ".abcd", FNM_PERIOD));
+}
+
+TEST(fnmatch, suffix) {
+  ASSERT_EQ(0, fnmatch("*", "", 0));
+  ASSERT_EQ(0, fnmatch("*.log", "a.log", 0));
+  ASSERT_EQ(0, fnmatch("*.log", ".log", 0));
+  ASSERT_EQ(FNM_NOMATCH, fnmatch("*.log", "a.log.1", 0));
+  ASSERT_EQ(0, fnmatch("*.log", "dir/a.log", 0));
+  ASSERT_EQ(FNM_NOMATCH, fnmatch("*.log", "dir/a.log", FNM_PATHNAME));
+  ASSERT_EQ(FNM_NOMATCH, fnmatch("*.log", ".log", FNM_PERIOD));
+  ASSERT_EQ(FNM_NOMATCH, fnmatch("*", ".hidden", FNM_PERIOD));
+}
+
+TEST(fnmatch, infix) {
+  ASSERT_EQ(0, fnmatch("*cache*", "cache", 0));
+  ASSERT_EQ(0, fnmatch("*cache*", "/data/cache/x", 0));
+  ASSERT_EQ(FNM_NOMATCH, fnmatch("*cache*", "/data/cache/x", FNM_PATHNAME));
+  ASSERT_EQ(FNM_NOMATCH, fnmatch("*cache*", "cach", 0));
+  ASSERT_EQ(FNM_NOMATCH, fnmatch("*cache*", ".cache", FNM_PERIOD));
+}
+
+TEST(fnmatch, general) {
+  ASSERT_EQ(0, fnmatch("*.[ch]", "main.c", 0));
+  ASSERT_EQ(FNM_NOMATCH, fnmatch("*.[ch]", "main.o", 0));
+  ASSERT_EQ(0, fnmatch("a?c", "abc", 0));
+  ASSERT_EQ(0, fnmatch("a*c*e", "abcde", 0));
+  ASSERT_EQ(0, fnmatch("\\*", "*", 0));
+  ASSERT_EQ(FNM_NOMATCH, fnmatch("\\*", "a", 0));
+  ASSERT_EQ(0, fnmatch("\\*", "\\a", FNM_NOESCAPE));
+  ASSERT_EQ(0, fnmatch("*.LOG", "a.log", FNM_CASEFOLD));
+  ASSERT_EQ(0, fnmatch("dir", "dir/file", FNM_LEADING_DIR));
+}
+
+TEST(fnmatch, android_fnmatch_set) {
+#if defined(__BIONIC__)
+  const char* patterns[] = { "*.log", "*.[ch]", "build/*", "*tmp*", "Makefile" };
+  android_fnmatch_set* set = android_fnmatch_set_create(patterns, 5, FNM_PATHNAME);
+  ASSERT_TRUE(set != nullptr);
+
+  size_t index;
+  ASSERT_EQ(0, android_fnmatch_set_match(set, "main.c", 0, &index));
+  ASSERT_EQ(1U, index);
+  ASSERT_EQ(0, android_fnmatch_set_match(set, "Makefile", 0, &index));
+  ASSERT_EQ(4U, index);
+  ASSERT_EQ(FNM_NOMATCH, android_fnmatch_set_match(set, "src/main.c", 0, &index));
+  ASSERT_EQ(FNM_NOMATCH, android_fnmatch_set_match(set, "build/a/b", 0, &index));
+
+  // Iterating finds every matching pattern.
+  ASSERT_EQ(0, android_fnmatch_set_match(set, "tmp.log", 0, &index));
+  ASSERT_EQ(0U, index);
+  ASSERT_EQ(0, android_fnmatch_set_match(set, "tmp.log", index + 1, &index));
+  ASSERT_EQ(3U, index);
+  ASSERT_EQ(FNM_NOMATCH, android_fnmatch_set_match(set, "tmp.log", index + 1, &index));
+
+  android_fnmatch_set_destroy(set);
+#else
+  GTEST_LOG_(INFO) << "This test does nothing.\n";
+#endif
+}
@@ -16,6 +16,8 @@
 
 #include <ftw.h>
 
+#include <fcntl.h>
+#include <fts.h>
 #include <pwd.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -23,6 +25,13 @@
 #include <sys/types.h>
 #include <unistd.h>
 
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
 #include "TemporaryFile.h"
 
 #include <android-base/stringprintf.h>
@@ -153,3 +162,140 @@ TEST(ftw, bug_28197840) {
   ASSERT_EQ(0, nftw(root.dirname, bug_28197840_nftw<struct stat>, 128, FTW_PHYS));
   ASSERT_EQ(0, nftw64(root.dirname, bug_28197840_nftw<struct stat64>, 128, FTW_PHYS));
 }
+
+TEST(ftw, fts_FTS_NOSTAT_TYPE) {
+#if defined(__BIONIC__)
+  TemporaryDir root;
+  MakeTree(root.dirname);
+
+  // A physical walk types everything but directories from the directory entries.
+  char* const paths[] = { root.dirname, nullptr };
+  FTS* fts = fts_open(paths, FTS_PHYSICAL | FTS_NOSTAT_TYPE, nullptr);
+  ASSERT_TRUE(fts != nullptr);
+  std::map<std::string, int> infos;
+  FTSENT* e;
+  while ((e = fts_read(fts)) != nullptr) {
+    if (e->fts_info != FTS_DP) infos[e->fts_name] = e->fts_info;
+  }
+  ASSERT_EQ(0, fts_close(fts));
+  EXPECT_EQ(FTS_D, infos["dir"]);
+  EXPECT_EQ(FTS_D, infos["sub"]);
+  EXPECT_EQ(FTS_SL, infos["dangler"]);
+  EXPECT_EQ(FTS_SL, infos["symlink"]);
+  EXPECT_EQ(FTS_F, infos["regular"]);
+
+  // A logical walk still has to follow the symbolic links.
+  fts = fts_open(paths, FTS_LOGICAL | FTS_NOSTAT_TYPE, nullptr);
+  ASSERT_TRUE(fts != nullptr);
+  infos.clear();
+  while ((e = fts_read(fts)) != nullptr) {
+    if (e->fts_level == 1 && e->fts_info != FTS_DP) infos[e->fts_name] = e->fts_info;
+  }
+  ASSERT_EQ(0, fts_close(fts));
+  EXPECT_EQ(FTS_D, infos["dir"]);
+  EXPECT_EQ(FTS_SLNONE, infos["dangler"]);
+  EXPECT_EQ(FTS_D, infos["symlink"]);
+  EXPECT_EQ(FTS_F, infos["regular"]);
+#else
+  GTEST_LOG_(INFO) << "This test does nothing.\n";
+#endif
+}
+
+#if defined(__BIONIC__)
+static std::mutex g_visits_lock;
+static std::vector<std::pair<std::string, int>> g_visits;
+
+static int record_nftw(const char* fpath, const struct stat* sb, int tflag, FTW* ftwbuf) {
+  if (ftwbuf->level > 0) sanity_check_nftw(fpath, sb, tflag, ftwbuf);
+  std::lock_guard<std::mutex> lock(g_visits_lock);
+  g_visits.emplace_back(fpath, tflag);
+  return 0;
+}
+
+static std::set<std::pair<std::string, int>> Visits(bool parallel, const char* root, int flags) {
+  g_visits.clear();
+  int rc = parallel ? android_nftw_parallel(root, record_nftw, 128, flags)
+                    : nftw(root, record_nftw, 128, flags);
+  EXPECT_EQ(0, rc);
+  return std::set<std::pair<std::string, int>>(g_visits.begin(), g_visits.end());
+}
+#endif
+
+TEST(ftw, android_nftw_parallel) {
+#if defined(__BIONIC__)
+  TemporaryDir root;
+  MakeTree(root.dirname);
+  // Enough directories to keep a few workers busy.
+  for (int i = 0; i < 32; ++i) {
+    std::string dir = android::base::StringPrintf("%s/dir/%d", root.dirname, i);
+    ASSERT_EQ(0, mkdir(dir.c_str(), 0755));
+    for (int j = 0; j < 32; ++j) {
+      std::string file = android::base::StringPrintf("%s/%d", dir.c_str(), j);
+      int fd = open(file.c_str(), O_CREAT | O_TRUNC, 0666);
+      ASSERT_NE(-1, fd);
+      close(fd);
+    }
+  }
+
+  // The same calls as nftw makes, if not in the same order.
+  for (int flags : { 0, FTW_PHYS, FTW_DEPTH, FTW_DEPTH | FTW_PHYS, FTW_MOUNT }) {
+    SCOPED_TRACE(flags);
+    std::set<std::pair<std::string, int>> expected = Visits(false, root.dirname, flags);
+    ASSERT_EQ(expected, Visits(true, root.dirname, flags));
+  }
+
+  // With FTW_DEPTH, a directory comes after everything in it.
+  Visits(true, root.dirname, FTW_DEPTH | FTW_PHYS);
+  std::set<std::string> seen;
+  for (const auto& visit : g_visits) {
+    if (visit.second == FTW_DP) {
+      std::string prefix = visit.first + "/";
+      for (const auto& other : g_visits) {
+        if (other.first.compare(0, prefix.size(), prefix) == 0) {
+          ASSERT_EQ(1U, seen.count(other.first)) << other.first << " after " << visit.first;
+        }
+      }
+    }
+    seen.insert(visit.first);
+  }
+
+  for (int i = 0; i < 32; ++i) {
+    for (int j = 0; j < 32; ++j) {
+      unlink(android::base::StringPrintf("%s/dir/%d/%d", root.dirname, i, j).c_str());
+    }
+    rmdir(android::base::StringPrintf("%s/dir/%d", root.dirname, i).c_str());
+  }
+#else
+  GTEST_LOG_(INFO) << "This test does nothing.\n";
+#endif
+}
+
+#if defined(__BIONIC__)
+static int stop_nftw(const char*, const struct stat*, int tflag, FTW*) {
+  return (tflag == FTW_F) ? 123 : 0;
+}
+#endif
+
+TEST(ftw, android_nftw_parallel_stop) {
+#if defined(__BIONIC__)
+  TemporaryDir root;
+  MakeTree(root.dirname);
+  ASSERT_EQ(123, android_nftw_parallel(root.dirname, stop_nftw, 128, 0));
+#else
+  GTEST_LOG_(INFO) << "This test does nothing.\n";
+#endif
+}
+
+TEST(ftw, android_nftw_parallel_EINVAL) {
+#if defined(__BIONIC__)
+  TemporaryDir root;
+  errno = 0;
+  ASSERT_EQ(-1, android_nftw_parallel(root.dirname, check_nftw, 128, FTW_CHDIR));
+  ASSERT_EQ(EINVAL, errno);
+  errno = 0;
+  ASSERT_EQ(-1, android_nftw_parallel(root.dirname, check_nftw, 0, 0));
+  ASSERT_EQ(EINVAL, errno);
+#else
+  GTEST_LOG_(INFO) << "This test does nothing.\n";
+#endif
+}
@@ -452,3 +452,38 @@ TEST(getgrent, iterate) {
   }
   ASSERT_TRUE(application);
 }
+
+TEST(getpwuid, android_ids_round_trip) {
+#if defined(__BIONIC__)
+  for (size_t n = 0; n < android_id_count; ++n) {
+    SCOPED_TRACE(android_ids[n].name);
+    passwd* pwd = getpwuid(android_ids[n].aid);
+    ASSERT_TRUE(pwd != NULL);
+    ASSERT_STREQ(android_ids[n].name, pwd->pw_name);
+    pwd = getpwnam(android_ids[n].name);
+    ASSERT_TRUE(pwd != NULL);
+    ASSERT_EQ(android_ids[n].aid, pwd->pw_uid);
+
+    group* grp = getgrgid(android_ids[n].aid);
+    ASSERT_TRUE(grp != NULL);
+    ASSERT_STREQ(android_ids[n].name, grp->gr_name);
+    grp = getgrnam(android_ids[n].name);
+    ASSERT_TRUE(grp != NULL);
+    ASSERT_EQ(android_ids[n].aid, grp->gr_gid);
+  }
+#else
+  GTEST_LOG_(INFO) << "This test is about uid/username translation for Android, which does nothing on libc other than bionic.\n";
+#endif
+}
+
+TEST(getpwuid, app_ids_repeated) {
+  // More ids than the per-thread cache holds, asked about over and over in both directions.
+  const char* names[] = { "u0_a0", "u0_a1234", "u1_radio", "u1_a40000", "u1_i0", "u2_system" };
+  const uid_t uids[] = { 10000, 11234, 101001, 140000, 199000, 201000 };
+  for (size_t i = 0; i < 5; ++i) {
+    for (size_t n = 0; n < sizeof(uids) / sizeof(uids[0]); ++n) {
+      check_get_passwd(names[n], uids[n], (uids[n] % 100000 < 10000) ? TYPE_SYSTEM : TYPE_APP);
+      check_get_group(names[n], uids[n]);
+    }
+  }
+}
@@ -19,11 +19,14 @@
 #include <ifaddrs.h>
 
 #include <dirent.h>
+#include <errno.h>
+#include <limits.h>
 #include <linux/if_packet.h>
 #include <net/ethernet.h>
 #include <net/if.h>
 #include <netdb.h>
 #include <netinet/in.h>
+#include <string.h>
 #include <sys/ioctl.h>
 
 #include <algorithm>
@@ -267,3 +270,74 @@ TEST(ifaddrs, inet6_scope_ids) {
 
   freeifaddrs(addrs);
 }
+
+TEST(ifaddrs, android_getifaddrs_filtered_family) {
+#if defined(__BIONIC__)
+  for (int family : { AF_INET, AF_INET6, AF_PACKET }) {
+    ifaddrs* addrs;
+    ASSERT_EQ(0, android_getifaddrs_filtered(&addrs, family, 0));
+
+    bool saw_lo = false;
+    for (ifaddrs* ifa = addrs; ifa != nullptr; ifa = ifa->ifa_next) {
+      ASSERT_TRUE(ifa->ifa_addr != nullptr);
+      ASSERT_EQ(family, ifa->ifa_addr->sa_family);
+      if (strcmp(ifa->ifa_name, "lo") == 0) saw_lo = true;
+    }
+    ASSERT_TRUE(saw_lo) << family;
+
+    freeifaddrs(addrs);
+  }
+#else
+  GTEST_LOG_(INFO) << "This test does nothing.\n";
+#endif
+}
+
+TEST(ifaddrs, android_getifaddrs_filtered_index) {
+#if defined(__BIONIC__)
+  unsigned int lo_index = if_nametoindex("lo");
+  ASSERT_NE(0U, lo_index);
+
+  // The unfiltered list should have exactly the same entries for lo.
+  ifaddrs* all;
+  ASSERT_EQ(0, getifaddrs(&all));
+  size_t expected = 0;
+  for (ifaddrs* ifa = all; ifa != nullptr; ifa = ifa->ifa_next) {
+    if (strcmp(ifa->ifa_name, "lo") == 0) ++expected;
+  }
+  freeifaddrs(all);
+
+  ifaddrs* addrs;
+  ASSERT_EQ(0, android_getifaddrs_filtered(&addrs, AF_UNSPEC, lo_index));
+  size_t count = 0;
+  for (ifaddrs* ifa = addrs; ifa != nullptr; ifa = ifa->ifa_next) {
+    ASSERT_STREQ("lo", ifa->ifa_name);
+    ++count;
+  }
+  ASSERT_EQ(expected, count);
+  freeifaddrs(addrs);
+
+  ASSERT_EQ(0, android_getifaddrs_filtered(&addrs, AF_INET, lo_index));
+  ASSERT_TRUE(addrs != nullptr);
+  ASSERT_STREQ("lo", addrs->ifa_name);
+  ASSERT_EQ(AF_INET, addrs->ifa_addr->sa_family);
+  freeifaddrs(addrs);
+#else
+  GTEST_LOG_(INFO) << "This test does nothing.\n";
+#endif
+}
+
+TEST(ifaddrs, android_getifaddrs_filtered_errors) {
+#if defined(__BIONIC__)
+  ifaddrs* addrs;
+  errno = 0;
+  ASSERT_EQ(-1, android_getifaddrs_filtered(&addrs, AF_UNIX, 0));
+  ASSERT_EQ(EAFNOSUPPORT, errno);
+
+  // There's no interface with this index.
+  errno = 0;
+  ASSERT_EQ(-1, android_getifaddrs_filtered(&addrs, AF_UNSPEC, INT_MAX));
+  ASSERT_EQ(ENODEV, errno);
+#else
+  GTEST_LOG_(INFO) << "This test does nothing.\n";
+#endif
+}
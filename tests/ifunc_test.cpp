@@ -0,0 +1,76 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <string.h>
+#include <sys/auxv.h>
+
+#if !defined(__mips__)
+
+static int ret42() {
+  return 42;
+}
+
+#if defined(__arm__) || defined(__aarch64__)
+static unsigned long g_hwcap;
+
+extern "C" void* resolver(unsigned long hwcap) {
+  g_hwcap = hwcap;
+  return reinterpret_cast<void*>(ret42);
+}
+#else
+extern "C" void* resolver() {
+  return reinterpret_cast<void*>(ret42);
+}
+#endif
+
+int ifunc() __attribute__((ifunc("resolver")));
+
+// This runs in both the dynamic and the static test binaries, so it covers
+// the linker and the static executable startup code.
+TEST(ifunc, function) {
+  ASSERT_EQ(42, ifunc());
+}
+
+#if defined(__arm__) || defined(__aarch64__)
+TEST(ifunc, hwcap) {
+  ASSERT_EQ(getauxval(AT_HWCAP), g_hwcap);
+}
+#endif
+
+#endif
+
+// The string routines that are dispatched at runtime on some architectures
+// must still give the same answers whichever implementation was chosen.
+TEST(ifunc, dispatched_string_functions) {
+  char src[64];
+  char dst[64];
+  for (size_t i = 0; i < sizeof(src); ++i) src[i] = 'a' + (i % 26);
+  src[sizeof(src) - 1] = '\0';
+
+  ASSERT_EQ(sizeof(src) - 1, strlen(src));
+  ASSERT_EQ(dst, strcpy(dst, src));
+  ASSERT_STREQ(src, dst);
+  memset(dst, 0, sizeof(dst));
+  ASSERT_EQ(dst, strncpy(dst, src, 10));
+  ASSERT_EQ(0, memcmp(dst, src, 10));
+  ASSERT_EQ('\0', dst[10]);
+  ASSERT_EQ(dst, memcpy(dst, src, sizeof(src)));
+  ASSERT_EQ(0, memcmp(dst, src, sizeof(src)));
+  ASSERT_EQ(dst + 1, memmove(dst + 1, dst, 32));
+  ASSERT_EQ(0, memcmp(dst + 1, src, 32));
+}
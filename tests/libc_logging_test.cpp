@@ -188,3 +188,24 @@ TEST(libc_logging, buffer_overrun) {
   GTEST_LOG_(INFO) << "This test does nothing.\n";
 #endif // __BIONIC__
 }
+
+TEST(libc_logging, log_socket_reused_and_reconnected) {
+#if defined(__BIONIC__)
+  if (__libc_write_log(ANDROID_LOG_INFO, "libc_logging_test", "first") == -1 ||
+      atomic_load(&g_log_fd) == -1) {
+    GTEST_LOG_(INFO) << "This test requires logd.\n";
+    return;
+  }
+  int log_fd = atomic_load(&g_log_fd);
+  ASSERT_NE(-1, __libc_write_log(ANDROID_LOG_INFO, "libc_logging_test", "second"));
+  ASSERT_EQ(log_fd, atomic_load(&g_log_fd));
+
+  // Even if someone closes it behind our back, we get it back.
+  close(log_fd);
+  ASSERT_NE(-1, __libc_write_log(ANDROID_LOG_INFO, "libc_logging_test", "third"));
+  ASSERT_EQ(log_fd, atomic_load(&g_log_fd));
+  ASSERT_NE(-1, fcntl(log_fd, F_GETFD));
+#else // __BIONIC__
+  GTEST_LOG_(INFO) << "This test does nothing.\n";
+#endif // __BIONIC__
+}
@@ -0,0 +1,132 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <gtest/gtest.h>
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <map>
+#include <string>
+
+#include "TemporaryFile.h"
+
+#if defined(__BIONIC__)
+#include <android/libc_stats.h>
+
+struct Stat {
+  int type;
+  uint64_t value;
+  uint64_t bucket_total;
+};
+
+static void CollectStat(const android_libc_stat* stat, void* arg) {
+  auto stats = reinterpret_cast<std::map<std::string, Stat>*>(arg);
+  Stat s = { stat->type, stat->value, 0 };
+  for (size_t i = 0; i < stat->bucket_count; ++i) {
+    s.bucket_total += stat->buckets[i];
+    if (i > 0) EXPECT_LT(stat->bucket_limits[i - 1], stat->bucket_limits[i]) << stat->name;
+  }
+  if (stat->bucket_count > 0) EXPECT_EQ(UINT64_MAX, stat->bucket_limits[stat->bucket_count - 1]);
+  EXPECT_TRUE(stats->find(stat->name) == stats->end()) << stat->name;
+  (*stats)[stat->name] = s;
+}
+
+static std::map<std::string, Stat> GetStats() {
+  std::map<std::string, Stat> stats;
+  EXPECT_EQ(0, android_libc_stats_iterate(CollectStat, &stats));
+  return stats;
+}
+
+static void* ReadFile(void*) {
+  FILE* fp = fopen("/proc/version", "re");
+  if (fp != nullptr) {
+    char buf[128];
+    while (fread(buf, 1, sizeof(buf), fp) > 0) {
+    }
+    fclose(fp);
+  }
+  return nullptr;
+}
+#endif
+
+TEST(libc_stats, android_libc_stats_iterate) {
+#if defined(__BIONIC__)
+  std::map<std::string, Stat> before = GetStats();
+  ASSERT_EQ(ANDROID_LIBC_STAT_COUNTER, before["malloc.allocation_calls"].type);
+  ASSERT_EQ(ANDROID_LIBC_STAT_GAUGE, before["pthread.threads"].type);
+  ASSERT_EQ(ANDROID_LIBC_STAT_HISTOGRAM, before["stdio.read_bytes"].type);
+  ASSERT_EQ(ANDROID_LIBC_STAT_HISTOGRAM, before["dns.latency_ms"].type);
+  ASSERT_GE(before["pthread.threads"].value, 1U);
+  for (const auto& it : before) {
+    if (it.second.type == ANDROID_LIBC_STAT_HISTOGRAM) {
+      ASSERT_EQ(it.second.value, it.second.bucket_total) << it.first;
+    }
+  }
+
+  // The reads of a thread that has exited still count.
+  pthread_t thread;
+  ASSERT_EQ(0, pthread_create(&thread, nullptr, ReadFile, nullptr));
+  ASSERT_EQ(0, pthread_join(thread, nullptr));
+  ReadFile(nullptr);
+  std::map<std::string, Stat> after = GetStats();
+  ASSERT_GE(after["stdio.read_bytes"].value, before["stdio.read_bytes"].value + 4);
+  ASSERT_GT(after["malloc.allocation_calls"].value, before["malloc.allocation_calls"].value);
+  ASSERT_EQ(before["pthread.stack_cache.hits"].value + before["pthread.stack_cache.misses"].value
+                + 1,
+            after["pthread.stack_cache.hits"].value + after["pthread.stack_cache.misses"].value);
+
+  errno = 0;
+  ASSERT_EQ(-1, android_libc_stats_iterate(nullptr, nullptr));
+  ASSERT_EQ(EINVAL, errno);
+#else
+  GTEST_LOG_(INFO) << "This test does nothing.\n";
+#endif
+}
+
+TEST(libc_stats, android_libc_stats_dump) {
+#if defined(__BIONIC__)
+  TemporaryFile tf;
+  ReadFile(nullptr);
+  ASSERT_EQ(0, android_libc_stats_dump(tf.fd));
+
+  FILE* fp = fopen(tf.filename, "r");
+  ASSERT_TRUE(fp != nullptr);
+  bool found_counter = false;
+  bool found_histogram = false;
+  char line[1024];
+  while (fgets(line, sizeof(line), fp) != nullptr) {
+    if (strncmp(line, "counter malloc.allocation_calls ", 32) == 0) found_counter = true;
+    if (strncmp(line, "histogram stdio.read_bytes ", 27) == 0) {
+      // At least the EOF, which reads 0 bytes.
+      found_histogram = (strstr(line, " 0:") != nullptr);
+    }
+  }
+  fclose(fp);
+  ASSERT_TRUE(found_counter);
+  ASSERT_TRUE(found_histogram);
+
+  errno = 0;
+  ASSERT_EQ(-1, android_libc_stats_dump(-1));
+  ASSERT_EQ(EBADF, errno);
+#else
+  GTEST_LOG_(INFO) << "This test does nothing.\n";
+#endif
+}
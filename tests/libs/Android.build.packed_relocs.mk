@@ -0,0 +1,46 @@
+#
+# Copyright (C) 2017 The Android Open Source Project
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+# -----------------------------------------------------------------------------
+# libtest_packed_relocs.so, packed as APS2 and as APS3 for the linker benchmarks
+# -----------------------------------------------------------------------------
+
+BIONIC_TESTS_RELOCATION_PACKER := $(HOST_OUT_EXECUTABLES)/relocation_packer
+
+# $(1) the packed format, aps2 or aps3
+define bionic-packed-relocs-lib
+include $(CLEAR_VARS)
+
+LOCAL_MODULE_CLASS := SHARED_LIBRARIES
+LOCAL_MODULE := libtest_packed_relocs_$(1)
+LOCAL_MODULE_SUFFIX := .so
+LOCAL_MODULE_TAGS := tests
+LOCAL_MODULE_PATH := $($(bionic_2nd_arch_prefix)TARGET_OUT_DATA_NATIVE_TESTS)/bionic-loader-test-libs
+LOCAL_2ND_ARCH_VAR_PREFIX := $(bionic_2nd_arch_prefix)
+
+include $(BUILD_SYSTEM)/base_rules.mk
+
+$$(LOCAL_BUILT_MODULE) : PRIVATE_FORMAT := $(1)
+$$(LOCAL_BUILT_MODULE) : \
+    $($(bionic_2nd_arch_prefix)TARGET_OUT_INTERMEDIATE_LIBRARIES)/libtest_packed_relocs.so \
+    | $(BIONIC_TESTS_RELOCATION_PACKER)
+	@echo "Packing relocations ($$(PRIVATE_FORMAT)): $$@"
+	$(hide) mkdir -p $$(dir $$@) && cp $$< $$@
+	$(hide) $(BIONIC_TESTS_RELOCATION_PACKER) --format=$$(PRIVATE_FORMAT) $$@
+endef
+
+$(eval $(call bionic-packed-relocs-lib,aps2))
+$(eval $(call bionic-packed-relocs-lib,aps3))
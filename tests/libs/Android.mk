@@ -27,6 +27,7 @@ common_additional_dependencies := \
     $(LOCAL_PATH)/Android.build.dlopen_check_order_reloc_siblings.mk \
     $(LOCAL_PATH)/Android.build.dlopen_check_order_reloc_main_executable.mk \
     $(LOCAL_PATH)/Android.build.linker_namespaces.mk \
+    $(LOCAL_PATH)/Android.build.packed_relocs.mk \
     $(LOCAL_PATH)/Android.build.pthread_atfork.mk \
     $(LOCAL_PATH)/Android.build.testlib.mk \
     $(LOCAL_PATH)/Android.build.testlib.target.mk \
@@ -166,6 +167,16 @@ include $(LOCAL_PATH)/Android.build.dlopen_check_order_reloc_main_executable.mk
 # -----------------------------------------------------------------------------
 include $(LOCAL_PATH)/Android.build.versioned_lib.mk
 
+# -----------------------------------------------------------------------------
+# Build the packed copies of libtest_packed_relocs.so
+# -----------------------------------------------------------------------------
+bionic_2nd_arch_prefix :=
+include $(LOCAL_PATH)/Android.build.packed_relocs.mk
+ifneq ($(TARGET_2ND_ARCH),)
+  bionic_2nd_arch_prefix := $(TARGET_2ND_ARCH_VAR_PREFIX)
+  include $(LOCAL_PATH)/Android.build.packed_relocs.mk
+endif
+
 # -----------------------------------------------------------------------------
 # Build libraries needed by pthread_atfork tests
 # -----------------------------------------------------------------------------
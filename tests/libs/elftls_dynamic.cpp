@@ -0,0 +1,29 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Built with -fno-emulated-tls: one initialized variable (.tdata) and one
+// that isn't (.tbss), accessed through the dynamic TLS models.
+
+static __thread int tls_counter = 42;
+__thread char tls_buffer[4096];
+
+extern "C" int elftls_bump_counter() {
+  return ++tls_counter;
+}
+
+extern "C" char* elftls_get_buffer() {
+  return tls_buffer;
+}
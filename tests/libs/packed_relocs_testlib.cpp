@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// 2048 relative relocations, and 2048 symbolic ones against 64 symbols, for
+// the linker benchmarks to load plain and packed.
+
+#define X4(m, n) m(n##0) m(n##1) m(n##2) m(n##3)
+#define X16(m, n) X4(m, n##0) X4(m, n##1) X4(m, n##2) X4(m, n##3)
+#define X64(m, n) X16(m, n##0) X16(m, n##1) X16(m, n##2) X16(m, n##3)
+
+#define DEFINE_GLOBAL(n) int packed_relocs_global_##n = 0;
+X64(DEFINE_GLOBAL, )
+
+static int local_objects[2048];
+
+#define LOCAL_POINTER(n) &local_objects[__COUNTER__],
+#define LOCAL_POINTERS X64(LOCAL_POINTER, )
+
+int* packed_relocs_local_pointers[] = {
+  LOCAL_POINTERS LOCAL_POINTERS LOCAL_POINTERS LOCAL_POINTERS
+  LOCAL_POINTERS LOCAL_POINTERS LOCAL_POINTERS LOCAL_POINTERS
+  LOCAL_POINTERS LOCAL_POINTERS LOCAL_POINTERS LOCAL_POINTERS
+  LOCAL_POINTERS LOCAL_POINTERS LOCAL_POINTERS LOCAL_POINTERS
+  LOCAL_POINTERS LOCAL_POINTERS LOCAL_POINTERS LOCAL_POINTERS
+  LOCAL_POINTERS LOCAL_POINTERS LOCAL_POINTERS LOCAL_POINTERS
+  LOCAL_POINTERS LOCAL_POINTERS LOCAL_POINTERS LOCAL_POINTERS
+  LOCAL_POINTERS LOCAL_POINTERS LOCAL_POINTERS LOCAL_POINTERS
+};
+
+// The globals are preemptible, so each pointer to one needs a symbol lookup.
+#define GLOBAL_POINTER(n) &packed_relocs_global_##n,
+#define GLOBAL_POINTERS X64(GLOBAL_POINTER, )
+
+int* packed_relocs_global_pointers[] = {
+  GLOBAL_POINTERS GLOBAL_POINTERS GLOBAL_POINTERS GLOBAL_POINTERS
+  GLOBAL_POINTERS GLOBAL_POINTERS GLOBAL_POINTERS GLOBAL_POINTERS
+  GLOBAL_POINTERS GLOBAL_POINTERS GLOBAL_POINTERS GLOBAL_POINTERS
+  GLOBAL_POINTERS GLOBAL_POINTERS GLOBAL_POINTERS GLOBAL_POINTERS
+  GLOBAL_POINTERS GLOBAL_POINTERS GLOBAL_POINTERS GLOBAL_POINTERS
+  GLOBAL_POINTERS GLOBAL_POINTERS GLOBAL_POINTERS GLOBAL_POINTERS
+  GLOBAL_POINTERS GLOBAL_POINTERS GLOBAL_POINTERS GLOBAL_POINTERS
+  GLOBAL_POINTERS GLOBAL_POINTERS GLOBAL_POINTERS GLOBAL_POINTERS
+};
@@ -19,6 +19,7 @@
 #include <errno.h>
 #include <limits.h>
 #include <locale.h>
+#include <pthread.h>
 
 TEST(locale, localeconv) {
   EXPECT_STREQ(".", localeconv()->decimal_point);
@@ -133,3 +134,29 @@ TEST(locale, mb_cur_max) {
   freelocale(cloc);
   freelocale(cloc_utf8);
 }
+
+static void* UseLocaleThreadFn(void*) {
+  // A new thread starts out in the global locale, whatever its parent uses.
+  return uselocale(NULL);
+}
+
+TEST(locale, uselocale_per_thread) {
+  locale_t cloc = newlocale(LC_ALL, "C", 0);
+  locale_t old_locale = uselocale(cloc);
+  ASSERT_EQ(1U, MB_CUR_MAX);
+
+  pthread_t t;
+  ASSERT_EQ(0, pthread_create(&t, NULL, UseLocaleThreadFn, NULL));
+  void* result;
+  ASSERT_EQ(0, pthread_join(t, &result));
+  ASSERT_EQ(LC_GLOBAL_LOCALE, static_cast<locale_t>(result));
+
+  // Switching back to the global locale picks up the global MB_CUR_MAX again.
+  ASSERT_EQ(cloc, uselocale(LC_GLOBAL_LOCALE));
+  ASSERT_EQ(LC_GLOBAL_LOCALE, uselocale(NULL));
+  ASSERT_STREQ("C.UTF-8", setlocale(LC_ALL, "C.UTF-8"));
+  ASSERT_EQ(4U, MB_CUR_MAX);
+
+  uselocale(old_locale);
+  freelocale(cloc);
+}
@@ -22,9 +22,20 @@
 #include <malloc.h>
 #include <unistd.h>
 
+#include <set>
+#include <thread>
+#include <vector>
+
 #include <tinyxml2.h>
 
 #include "private/bionic_config.h"
+#include "utils.h"
+
+#if defined(__BIONIC__)
+extern "C" int malloc_iterate_bulk(uintptr_t base, size_t size,
+    void (*callback)(const uintptr_t* bases, const size_t* sizes, size_t count, void* arg),
+    void* arg);
+#endif
 
 TEST(malloc, malloc_std) {
   // Simple malloc test.
@@ -342,11 +353,10 @@ TEST(malloc, malloc_info) {
   ASSERT_STREQ("malloc", root->Name());
   ASSERT_STREQ("jemalloc-1", root->Attribute("version"));
 
-  auto arena = root->FirstChildElement();
-  for (; arena != nullptr; arena = arena->NextSiblingElement()) {
+  auto arena = root->FirstChildElement("heap");
+  for (; arena != nullptr; arena = arena->NextSiblingElement("heap")) {
     int val;
 
-    ASSERT_STREQ("heap", arena->Name());
     ASSERT_EQ(tinyxml2::XML_SUCCESS, arena->QueryIntAttribute("nr", &val));
     ASSERT_EQ(tinyxml2::XML_SUCCESS,
               arena->FirstChildElement("allocated-large")->QueryIntText(&val));
@@ -370,6 +380,197 @@ TEST(malloc, malloc_info) {
       }
     }
   }
+
+  // The counters of the exited threads are always there, with tid 0.
+  bool found_exited = false;
+  auto thread = root->FirstChildElement("thread");
+  for (; thread != nullptr; thread = thread->NextSiblingElement("thread")) {
+    int tid;
+    ASSERT_EQ(tinyxml2::XML_SUCCESS, thread->QueryIntAttribute("tid", &tid));
+    found_exited |= tid == 0;
+    ASSERT_TRUE(thread->FirstChildElement("allocated-bytes")->GetText() != nullptr);
+    ASSERT_TRUE(thread->FirstChildElement("freed-bytes")->GetText() != nullptr);
+    ASSERT_TRUE(thread->FirstChildElement("nmalloc")->GetText() != nullptr);
+    ASSERT_TRUE(thread->FirstChildElement("nfree")->GetText() != nullptr);
+  }
+  ASSERT_TRUE(found_exited);
+#endif
+}
+
+#if defined(__BIONIC__)
+static malloc_thread_stats FindThreadStats(pid_t tid) {
+  struct Search {
+    pid_t tid;
+    malloc_thread_stats stats;
+  } search = {};
+  search.tid = tid;
+  search.stats.tid = -1;
+  malloc_iterate_thread_stats([](const malloc_thread_stats* stats, void* arg) {
+    Search* search = reinterpret_cast<Search*>(arg);
+    if (stats->tid == search->tid) {
+      search->stats = *stats;
+    }
+  }, &search);
+  return search.stats;
+}
+#endif
+
+TEST(malloc, malloc_iterate_thread_stats) {
+#if defined(__BIONIC__)
+  malloc_thread_stats before = FindThreadStats(gettid());
+  ASSERT_EQ(gettid(), before.tid);
+
+  void* small = malloc(10);
+  ASSERT_TRUE(small != nullptr);
+  void* large = malloc(1024 * 1024);
+  ASSERT_TRUE(large != nullptr);
+  size_t usable_size = malloc_usable_size(small) + malloc_usable_size(large);
+  free(small);
+  free(large);
+
+  malloc_thread_stats after = FindThreadStats(gettid());
+  ASSERT_EQ(before.allocation_calls + 2, after.allocation_calls);
+  ASSERT_EQ(before.free_calls + 2, after.free_calls);
+  ASSERT_EQ(before.allocated_bytes + usable_size, after.allocated_bytes);
+  ASSERT_EQ(before.freed_bytes + usable_size, after.freed_bytes);
+  ASSERT_EQ(before.size_class_calls[0] + 1, after.size_class_calls[0]);
+  ASSERT_EQ(before.size_class_calls[MALLOC_THREAD_STATS_SIZE_CLASSES - 1] + 1,
+            after.size_class_calls[MALLOC_THREAD_STATS_SIZE_CLASSES - 1]);
+
+  // A thread's counters move to the exited total once it is joined.
+  malloc_thread_stats exited_before = FindThreadStats(0);
+  std::thread thread([]() { free(malloc(100)); });
+  thread.join();
+  malloc_thread_stats exited_after = FindThreadStats(0);
+  ASSERT_LT(exited_before.allocation_calls, exited_after.allocation_calls);
+  ASSERT_LT(exited_before.free_calls, exited_after.free_calls);
+#else
+  GTEST_LOG_(INFO) << "This test does nothing.\n";
+#endif
+}
+
+TEST(malloc, android_heap) {
+#if defined(__BIONIC__)
+  int heap = android_heap_create();
+  ASSERT_NE(-1, heap);
+
+  void* small = android_heap_malloc(heap, 16);
+  ASSERT_TRUE(small != nullptr);
+  memset(small, 0xff, 16);
+  android_heap_free(heap, small);
+
+  // Allocations still in the heap are released by destroying it.
+  for (size_t i = 0; i < 1000; i++) {
+    void* ptr = android_heap_malloc(heap, 128);
+    ASSERT_TRUE(ptr != nullptr);
+    memset(ptr, 0xff, 128);
+  }
+  ASSERT_EQ(0, android_heap_destroy(heap));
+
+  errno = 0;
+  ASSERT_EQ(-1, android_heap_destroy(heap));
+  ASSERT_EQ(EINVAL, errno);
+
+  // The heap can't be used after it was destroyed.
+  errno = 0;
+  ASSERT_EQ(nullptr, android_heap_malloc(heap, 16));
+  ASSERT_EQ(EINVAL, errno);
+#else
+  GTEST_LOG_(INFO) << "This test does nothing.\n";
+#endif
+}
+
+TEST(malloc, free_sized) {
+#if defined(__BIONIC__)
+  for (size_t size = 0; size <= 65536; size = size * 2 + 1) {
+    void* ptr = malloc(size);
+    ASSERT_TRUE(ptr != nullptr);
+    memset(ptr, 0x5a, size);
+    free_sized(ptr, size);
+  }
+  free_sized(nullptr, 100);
+#else
+  GTEST_LOG_(INFO) << "This test does nothing.\n";
+#endif
+}
+
+TEST(malloc, mallopt) {
+#if defined(__BIONIC__)
+  ASSERT_EQ(0, mallopt(-1000, 1));
+
+  // Leave some dirty pages behind for M_PURGE.
+  std::vector<void*> pointers;
+  for (size_t i = 0; i < 1000; i++) {
+    void* ptr = malloc(4096);
+    ASSERT_TRUE(ptr != nullptr);
+    memset(ptr, 0x5a, 4096);
+    pointers.push_back(ptr);
+  }
+  for (void* ptr : pointers) {
+    free(ptr);
+  }
+  ASSERT_EQ(1, mallopt(M_FLUSH_THREAD_CACHE, 0));
+  ASSERT_EQ(1, mallopt(M_PURGE, 0));
+
+  // The decay time applies to the arenas of new threads too.
+  ASSERT_EQ(1, mallopt(M_DECAY_TIME, 0));
+  std::thread thread([]() { free(malloc(100)); });
+  thread.join();
+  ASSERT_EQ(1, mallopt(M_DECAY_TIME, 1));
+#else
+  GTEST_LOG_(INFO) << "This test does nothing.\n";
+#endif
+}
+
+TEST(malloc, malloc_trim) {
+  std::vector<void*> pointers;
+  for (size_t i = 0; i < 1000; i++) {
+    void* ptr = malloc(4096);
+    ASSERT_TRUE(ptr != nullptr);
+    memset(ptr, 0x5a, 4096);
+    pointers.push_back(ptr);
+  }
+  for (void* ptr : pointers) {
+    free(ptr);
+  }
+  int result = malloc_trim(0);
+  ASSERT_TRUE(result == 0 || result == 1);
+}
+
+TEST(malloc, malloc_iterate_bulk) {
+#if defined(__BIONIC__)
+  std::vector<void*> pointers;
+  for (size_t i = 0; i < 100; i++) {
+    void* ptr = malloc(i * 17 + 1);
+    ASSERT_TRUE(ptr != nullptr);
+    pointers.push_back(ptr);
+  }
+
+  std::vector<map_record> maps;
+  ASSERT_TRUE(Maps::parse_maps(&maps));
+
+  // The callback is run with the allocator enabled, so it can use a set.
+  std::set<uintptr_t> found;
+  for (const map_record& map : maps) {
+    if (map.pathname != "[anon:libc_malloc]") {
+      continue;
+    }
+    ASSERT_EQ(0, malloc_iterate_bulk(map.addr_start, map.addr_end - map.addr_start,
+        [](const uintptr_t* bases, const size_t* sizes, size_t count, void* arg) {
+          std::set<uintptr_t>* found = reinterpret_cast<std::set<uintptr_t>*>(arg);
+          for (size_t i = 0; i < count; i++) {
+            ASSERT_NE(0U, sizes[i]);
+            found->insert(bases[i]);
+          }
+        }, &found));
+  }
+
+  for (void* ptr : pointers) {
+    ASSERT_EQ(1U, found.count(reinterpret_cast<uintptr_t>(ptr))) << ptr;
+    free(ptr);
+  }
+#else
+  GTEST_LOG_(INFO) << "This test does nothing.\n";
 #endif
 }
 
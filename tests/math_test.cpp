@@ -56,6 +56,9 @@ template<typename T> inline int test_capture_isinf(const T in) {
 #include <float.h>
 #include <limits.h>
 #include <stdint.h>
+#include <string.h>
+
+#include <vector>
 
 #include <private/ScopeGuard.h>
 
@@ -1084,6 +1087,50 @@ TEST(math, copysignl) {
   ASSERT_DOUBLE_EQ(-2.0L, copysignl(2.0L, -1.0L));
 }
 
+template <typename T>
+static bool SameBits(T x, T y) {
+  return (isnan(x) && isnan(y)) || memcmp(&x, &y, sizeof(T)) == 0;
+}
+
+// On arm64 and x86-64 <math.h> defines some functions inline. Calls through a
+// volatile function pointer go to libm's out-of-line copies, which must agree.
+TEST(math, inline_definitions_match_libm) {
+  double (* volatile fabs_p)(double) = fabs;
+  double (* volatile copysign_p)(double, double) = copysign;
+  double (* volatile fmax_p)(double, double) = fmax;
+  double (* volatile fmin_p)(double, double) = fmin;
+  double (* volatile ceil_p)(double) = ceil;
+  double (* volatile floor_p)(double) = floor;
+  double (* volatile rint_p)(double) = rint;
+  double (* volatile round_p)(double) = round;
+  double (* volatile trunc_p)(double) = trunc;
+  float (* volatile fmaxf_p)(float, float) = fmaxf;
+  float (* volatile truncf_p)(float) = truncf;
+
+  const double values[] = {
+    0.0, -0.0, 0.5, -0.5, 1.5, -1.5, 2.5, -2.5, 0x1p52 + 0.5, -0x1.fffffffffffffp51,
+    0x1p-1074, -DBL_MAX, HUGE_VAL, -HUGE_VAL, nan(""),
+  };
+  for (double x : values) {
+    SCOPED_TRACE(x);
+    ASSERT_TRUE(SameBits(fabs_p(x), fabs(x)));
+    ASSERT_TRUE(SameBits(ceil_p(x), ceil(x)));
+    ASSERT_TRUE(SameBits(floor_p(x), floor(x)));
+    ASSERT_TRUE(SameBits(rint_p(x), rint(x)));
+    ASSERT_TRUE(SameBits(round_p(x), round(x)));
+    ASSERT_TRUE(SameBits(trunc_p(x), trunc(x)));
+    ASSERT_TRUE(SameBits(truncf_p(static_cast<float>(x)), truncf(static_cast<float>(x))));
+    for (double y : values) {
+      SCOPED_TRACE(y);
+      ASSERT_TRUE(SameBits(copysign_p(x, y), copysign(x, y)));
+      ASSERT_TRUE(SameBits(fmax_p(x, y), fmax(x, y)));
+      ASSERT_TRUE(SameBits(fmin_p(x, y), fmin(x, y)));
+      ASSERT_TRUE(SameBits(fmaxf_p(static_cast<float>(x), static_cast<float>(y)),
+                           fmaxf(static_cast<float>(x), static_cast<float>(y))));
+    }
+  }
+}
+
 TEST(math, significand) {
   ASSERT_DOUBLE_EQ(0.0, significand(0.0));
   ASSERT_DOUBLE_EQ(1.2, significand(1.2));
@@ -1888,3 +1935,188 @@ TEST(math, trunc_intel) {
 TEST(math, truncf_intel) {
   DoMathDataTest<1>(g_truncf_intel_data, truncf);
 }
+
+// libm's vector versions of some functions, called directly rather than via a
+// vectorized loop. They're checked against the same data as the scalar
+// functions, with each input in each lane in turn to make sure that every
+// lane gets the same answer.
+#if defined(__BIONIC__) && (defined(__aarch64__) || defined(__x86_64__))
+typedef double vector_double __attribute__((vector_size(16)));
+typedef float vector_float __attribute__((vector_size(16)));
+
+#if defined(__aarch64__)
+#define VECTOR_ABI __attribute__((aarch64_vector_pcs))
+#define VECTOR_NAME(lanes, f) _ZGVnN##lanes##_##f
+#else
+#define VECTOR_ABI
+#define VECTOR_NAME(lanes, f) _ZGVbN##lanes##_##f
+#endif
+
+extern "C" {
+VECTOR_ABI vector_double VECTOR_NAME(2v, cos)(vector_double);
+VECTOR_ABI vector_double VECTOR_NAME(2v, exp)(vector_double);
+VECTOR_ABI vector_double VECTOR_NAME(2v, log)(vector_double);
+VECTOR_ABI vector_double VECTOR_NAME(2vv, pow)(vector_double, vector_double);
+VECTOR_ABI vector_double VECTOR_NAME(2v, sin)(vector_double);
+VECTOR_ABI vector_float VECTOR_NAME(4v, cosf)(vector_float);
+VECTOR_ABI vector_float VECTOR_NAME(4v, expf)(vector_float);
+VECTOR_ABI vector_float VECTOR_NAME(4v, logf)(vector_float);
+VECTOR_ABI vector_float VECTOR_NAME(4vv, powf)(vector_float, vector_float);
+VECTOR_ABI vector_float VECTOR_NAME(4v, sinf)(vector_float);
+}
+
+template <typename T>
+static bool SameResult(T a, T b) {
+  return (isnan(a) && isnan(b)) || (a == b && signbit(a) == signbit(b));
+}
+
+// Returns f's answer for x and y, or NaN if it depends on which lane they were in.
+// The other lanes get inputs that every one of the functions is fine with.
+template <typename V, typename T, typename F>
+static T EachLane(T x, T y, F f) {
+  constexpr size_t lanes = sizeof(V) / sizeof(T);
+  T result = 0;
+  for (size_t i = 0; i < lanes; ++i) {
+    V vx, vy;
+    for (size_t j = 0; j < lanes; ++j) {
+      vx[j] = (i == j) ? x : 1.5;
+      vy[j] = (i == j) ? y : 1.5;
+    }
+    V r = f(vx, vy);
+    if (i == 0) {
+      result = r[0];
+    } else if (!SameResult(result, static_cast<T>(r[i]))) {
+      return NAN;
+    }
+  }
+  return result;
+}
+
+#define VECTOR_TEST_1(V, T, lanes, f) \
+  static T vector_##f(T x) { \
+    return EachLane<V>(x, static_cast<T>(0), [](V vx, V) { return VECTOR_NAME(lanes, f)(vx); }); \
+  }
+#define VECTOR_TEST_2(V, T, lanes, f) \
+  static T vector_##f(T x, T y) { \
+    return EachLane<V>(x, y, [](V vx, V vy) { return VECTOR_NAME(lanes, f)(vx, vy); }); \
+  }
+VECTOR_TEST_1(vector_double, double, 2v, cos)
+VECTOR_TEST_1(vector_double, double, 2v, exp)
+VECTOR_TEST_1(vector_double, double, 2v, log)
+VECTOR_TEST_2(vector_double, double, 2vv, pow)
+VECTOR_TEST_1(vector_double, double, 2v, sin)
+VECTOR_TEST_1(vector_float, float, 4v, cosf)
+VECTOR_TEST_1(vector_float, float, 4v, expf)
+VECTOR_TEST_1(vector_float, float, 4v, logf)
+VECTOR_TEST_2(vector_float, float, 4vv, powf)
+VECTOR_TEST_1(vector_float, float, 4v, sinf)
+#undef VECTOR_TEST_1
+#undef VECTOR_TEST_2
+#endif
+
+TEST(math, vector_variants_intel) {
+#if defined(__BIONIC__) && (defined(__aarch64__) || defined(__x86_64__))
+  DoMathDataTest<1>(g_cos_intel_data, vector_cos);
+  DoMathDataTest<1>(g_exp_intel_data, vector_exp);
+  DoMathDataTest<1>(g_log_intel_data, vector_log);
+  DoMathDataTest<1>(g_pow_intel_data, vector_pow);
+  DoMathDataTest<1>(g_sin_intel_data, vector_sin);
+  DoMathDataTest<1>(g_cosf_intel_data, vector_cosf);
+  DoMathDataTest<1>(g_expf_intel_data, vector_expf);
+  DoMathDataTest<1>(g_logf_intel_data, vector_logf);
+  DoMathDataTest<1>(g_powf_intel_data, vector_powf);
+  DoMathDataTest<1>(g_sinf_intel_data, vector_sinf);
+#else
+  GTEST_LOG_(INFO) << "This test does nothing.\n";
+#endif
+}
+
+// The bulk functions, over each whole table at once (so through both whole vectors and a partial
+// one at the end) and then in place.
+#if defined(__BIONIC__)
+template <typename RT, typename T, size_t N>
+static void DoArrayDataTest(data_1_1_t<RT, T> (&data)[N], void f(const T*, T*, size_t)) {
+  fesetenv(FE_DFL_ENV);
+  FpUlpEq<1, RT> predicate;
+  std::vector<T> in(N);
+  std::vector<T> out(N + 1, 1234);
+  for (size_t i = 0; i < N; ++i) in[i] = data[i].input;
+
+  f(in.data(), out.data(), N);
+  for (size_t i = 0; i < N; ++i) {
+    EXPECT_PRED_FORMAT2(predicate, data[i].expected, out[i]) << "Failed on element " << i;
+  }
+  ASSERT_EQ(1234, out[N]);
+
+  f(in.data(), in.data(), N);
+  for (size_t i = 0; i < N; ++i) {
+    EXPECT_PRED_FORMAT2(predicate, data[i].expected, in[i]) << "Failed in place on element " << i;
+  }
+}
+
+template <typename RT, typename T1, typename T2, size_t N>
+static void DoArrayDataTest(data_1_2_t<RT, T1, T2> (&data)[N],
+                            void f(const T1*, const T2*, T1*, size_t)) {
+  fesetenv(FE_DFL_ENV);
+  FpUlpEq<1, RT> predicate;
+  std::vector<T1> in1(N);
+  std::vector<T2> in2(N);
+  std::vector<T1> out(N + 1, 1234);
+  for (size_t i = 0; i < N; ++i) {
+    in1[i] = data[i].input1;
+    in2[i] = data[i].input2;
+  }
+
+  f(in1.data(), in2.data(), out.data(), N);
+  for (size_t i = 0; i < N; ++i) {
+    EXPECT_PRED_FORMAT2(predicate, data[i].expected, out[i]) << "Failed on element " << i;
+  }
+  ASSERT_EQ(1234, out[N]);
+}
+#endif
+
+TEST(math, array_functions_intel) {
+#if defined(__BIONIC__)
+  DoArrayDataTest(g_cos_intel_data, cos_array);
+  DoArrayDataTest(g_exp_intel_data, exp_array);
+  DoArrayDataTest(g_log_intel_data, log_array);
+  DoArrayDataTest(g_pow_intel_data, pow_array);
+  DoArrayDataTest(g_sin_intel_data, sin_array);
+  DoArrayDataTest(g_cosf_intel_data, cosf_array);
+  DoArrayDataTest(g_expf_intel_data, expf_array);
+  DoArrayDataTest(g_logf_intel_data, logf_array);
+  DoArrayDataTest(g_powf_intel_data, powf_array);
+  DoArrayDataTest(g_sinf_intel_data, sinf_array);
+#else
+  GTEST_LOG_(INFO) << "This test does nothing.\n";
+#endif
+}
+
+TEST(math, array_functions_short) {
+#if defined(__BIONIC__)
+  // Every length up to a few vectors of the widest variant, so every size of partial vector.
+  for (size_t n = 0; n <= 40; ++n) {
+    double in[41];
+    double out[41];
+    for (size_t i = 0; i <= n; ++i) {
+      in[i] = 0.25 * i - 3;
+      out[i] = 1234;
+    }
+    exp_array(in, out, n);
+    for (size_t i = 0; i < n; ++i) ASSERT_DOUBLE_EQ(exp(in[i]), out[i]) << n << " " << i;
+    ASSERT_EQ(1234, out[n]) << n;
+
+    float inf[41];
+    float outf[41];
+    for (size_t i = 0; i <= n; ++i) {
+      inf[i] = 0.5f * i + 0.5f;
+      outf[i] = 1234;
+    }
+    logf_array(inf, outf, n);
+    for (size_t i = 0; i < n; ++i) ASSERT_FLOAT_EQ(logf(inf[i]), outf[i]) << n << " " << i;
+    ASSERT_EQ(1234, outf[n]) << n;
+  }
+#else
+  GTEST_LOG_(INFO) << "This test does nothing.\n";
+#endif
+}
@@ -18,6 +18,8 @@
 
 #include <mntent.h>
 
+#include "TemporaryFile.h"
+
 TEST(mntent, mntent_smoke) {
   FILE* fp = setmntent("/proc/mounts", "r");
   ASSERT_TRUE(fp != NULL);
@@ -39,6 +41,49 @@ TEST(mntent, mntent_smoke) {
   ASSERT_EQ(1, endmntent(fp));
 }
 
+TEST(mntent, getmntent_r_parsing) {
+  TemporaryFile tf;
+  const char contents[] =
+      "proc /proc proc rw,nosuid 0 0\n"
+      "too few fields\n"
+      "\ttmpfs\t/dev  tmpfs   rw,mode=755 1\t2 \n"
+      "/dev/block/a /a ext4 ro x 0\n"
+      "/dev/block/b /b ext4 ro 0 0 extra\n"
+      "none /last none defaults 0 3";
+  ASSERT_EQ(static_cast<ssize_t>(strlen(contents)), write(tf.fd, contents, strlen(contents)));
+
+  FILE* fp = setmntent(tf.filename, "r");
+  ASSERT_TRUE(fp != NULL);
+  struct mntent entry;
+  char buf[BUFSIZ];
+
+  ASSERT_TRUE(getmntent_r(fp, &entry, buf, sizeof(buf)) != NULL);
+  ASSERT_STREQ("proc", entry.mnt_fsname);
+  ASSERT_STREQ("/proc", entry.mnt_dir);
+  ASSERT_STREQ("proc", entry.mnt_type);
+  ASSERT_STREQ("rw,nosuid", entry.mnt_opts);
+  ASSERT_EQ(0, entry.mnt_freq);
+  ASSERT_EQ(0, entry.mnt_passno);
+
+  ASSERT_TRUE(getmntent_r(fp, &entry, buf, sizeof(buf)) != NULL);
+  ASSERT_STREQ("tmpfs", entry.mnt_fsname);
+  ASSERT_STREQ("/dev", entry.mnt_dir);
+  ASSERT_STREQ("tmpfs", entry.mnt_type);
+  ASSERT_STREQ("rw,mode=755", entry.mnt_opts);
+  ASSERT_EQ(1, entry.mnt_freq);
+  ASSERT_EQ(2, entry.mnt_passno);
+
+  ASSERT_TRUE(getmntent_r(fp, &entry, buf, sizeof(buf)) != NULL);
+  ASSERT_STREQ("/dev/block/b", entry.mnt_fsname);
+
+  ASSERT_TRUE(getmntent_r(fp, &entry, buf, sizeof(buf)) != NULL);
+  ASSERT_STREQ("/last", entry.mnt_dir);
+  ASSERT_EQ(3, entry.mnt_passno);
+
+  ASSERT_TRUE(getmntent_r(fp, &entry, buf, sizeof(buf)) == NULL);
+  ASSERT_EQ(1, endmntent(fp));
+}
+
 TEST(mntent, hasmntopt) {
   // indices                  1  1
   // of keys:      0    5   9 1  4
@@ -53,9 +53,9 @@ TEST(pthread, pthread_keys_max) {
   ASSERT_GE(PTHREAD_KEYS_MAX, _POSIX_THREAD_KEYS_MAX);
 }
 
-TEST(pthread, sysconf_SC_THREAD_KEYS_MAX_eq_PTHREAD_KEYS_MAX) {
+TEST(pthread, sysconf_SC_THREAD_KEYS_MAX_ge_PTHREAD_KEYS_MAX) {
   int sysconf_max = sysconf(_SC_THREAD_KEYS_MAX);
-  ASSERT_EQ(sysconf_max, PTHREAD_KEYS_MAX);
+  ASSERT_GE(sysconf_max, PTHREAD_KEYS_MAX);
 }
 
 TEST(pthread, pthread_key_many_distinct) {
@@ -86,13 +86,14 @@ TEST(pthread, pthread_key_many_distinct) {
   }
 }
 
-TEST(pthread, pthread_key_not_exceed_PTHREAD_KEYS_MAX) {
+TEST(pthread, pthread_key_not_exceed_SC_THREAD_KEYS_MAX) {
   std::vector<pthread_key_t> keys;
   int rv = 0;
 
-  // Pthread keys are used by gtest, so PTHREAD_KEYS_MAX should
+  // Pthread keys are used by gtest, so sysconf(_SC_THREAD_KEYS_MAX) should
   // be more than we are allowed to allocate now.
-  for (int i = 0; i < PTHREAD_KEYS_MAX; i++) {
+  int keys_max = sysconf(_SC_THREAD_KEYS_MAX);
+  for (int i = 0; i < keys_max; i++) {
     pthread_key_t key;
     rv = pthread_key_create(&key, NULL);
     if (rv == EAGAIN) {
@@ -113,6 +114,67 @@ TEST(pthread, pthread_key_not_exceed_PTHREAD_KEYS_MAX) {
   ASSERT_EQ(EAGAIN, rv);
 }
 
+static std::atomic<int> g_many_keys_destructor_calls;
+
+static void ManyKeysDestructor(void*) {
+  ++g_many_keys_destructor_calls;
+}
+
+static void* SetManyKeysFn(void* arg) {
+  std::vector<pthread_key_t>& keys = *reinterpret_cast<std::vector<pthread_key_t>*>(arg);
+  for (size_t i = 0; i < keys.size(); ++i) {
+    if (pthread_setspecific(keys[i], reinterpret_cast<void*>(i + 1)) != 0) {
+      return reinterpret_cast<void*>(-1);
+    }
+  }
+  for (size_t i = 0; i < keys.size(); ++i) {
+    if (pthread_getspecific(keys[i]) != reinterpret_cast<void*>(i + 1)) {
+      return reinterpret_cast<void*>(-1);
+    }
+  }
+  return NULL;
+}
+
+TEST(pthread, pthread_key_more_than_PTHREAD_KEYS_MAX) {
+  if (sysconf(_SC_THREAD_KEYS_MAX) < PTHREAD_KEYS_MAX * 3) {
+    GTEST_LOG_(INFO) << "This test requires more than PTHREAD_KEYS_MAX keys.\n";
+    return;
+  }
+  std::vector<pthread_key_t> keys;
+  auto scope_guard = make_scope_guard([&keys]{
+    for (const auto& key : keys) {
+      EXPECT_EQ(0, pthread_key_delete(key));
+    }
+  });
+
+  for (int i = 0; i < PTHREAD_KEYS_MAX * 3; ++i) {
+    pthread_key_t key;
+    ASSERT_EQ(0, pthread_key_create(&key, ManyKeysDestructor)) << i;
+    keys.push_back(key);
+  }
+
+  // Every one of them works, and has its destructor called at thread exit.
+  g_many_keys_destructor_calls = 0;
+  pthread_t t;
+  ASSERT_EQ(0, pthread_create(&t, NULL, SetManyKeysFn, &keys));
+  void* result;
+  ASSERT_EQ(0, pthread_join(t, &result));
+  ASSERT_EQ(NULL, result);
+  ASSERT_EQ(static_cast<int>(keys.size()), g_many_keys_destructor_calls);
+
+  // A deleted key's value can't be seen through a new key in the same slot.
+  pthread_key_t last_key = keys.back();
+  ASSERT_EQ(0, pthread_setspecific(last_key, &keys));
+  keys.pop_back();
+  ASSERT_EQ(0, pthread_key_delete(last_key));
+  ASSERT_EQ(NULL, pthread_getspecific(last_key));
+  ASSERT_EQ(EINVAL, pthread_setspecific(last_key, &keys));
+  pthread_key_t new_key;
+  ASSERT_EQ(0, pthread_key_create(&new_key, NULL));
+  keys.push_back(new_key);
+  ASSERT_EQ(NULL, pthread_getspecific(new_key));
+}
+
 TEST(pthread, pthread_key_delete) {
   void* expected = reinterpret_cast<void*>(1234);
   pthread_key_t key;
@@ -251,6 +313,37 @@ TEST(pthread, pthread_create) {
   ASSERT_EQ(expected_result, result);
 }
 
+static void* CheckAndSetSpecificFn(void* arg) {
+  pthread_key_t key = *reinterpret_cast<pthread_key_t*>(arg);
+  // A new thread must start with clean thread state, even on a reused stack.
+  void* old_value = pthread_getspecific(key);
+  pthread_setspecific(key, arg);
+  return old_value;
+}
+
+TEST(pthread, pthread_create_reused_stack_is_clean) {
+  // Static because the detached threads may outlive this test.
+  static pthread_key_t key;
+  ASSERT_EQ(0, pthread_key_create(&key, NULL));
+
+  pthread_attr_t detached_attr;
+  ASSERT_EQ(0, pthread_attr_init(&detached_attr));
+  ASSERT_EQ(0, pthread_attr_setdetachstate(&detached_attr, PTHREAD_CREATE_DETACHED));
+
+  for (size_t i = 0; i < 64; ++i) {
+    // Exercise both ways a stack goes back to the cache: joining and detached exit.
+    pthread_t t;
+    ASSERT_EQ(0, pthread_create(&t, &detached_attr, CheckAndSetSpecificFn, &key));
+    ASSERT_EQ(0, pthread_create(&t, NULL, CheckAndSetSpecificFn, &key));
+    void* result;
+    ASSERT_EQ(0, pthread_join(t, &result));
+    ASSERT_EQ(nullptr, result);
+  }
+
+  ASSERT_EQ(0, pthread_attr_destroy(&detached_attr));
+  ASSERT_EQ(0, pthread_key_delete(key));
+}
+
 TEST(pthread, pthread_create_EAGAIN) {
   pthread_attr_t attributes;
   ASSERT_EQ(0, pthread_attr_init(&attributes));
@@ -1017,6 +1110,55 @@ TEST(pthread, pthread_rwlock_kind_PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP)
   ASSERT_EQ(0, pthread_join(reader_thread, NULL));
 }
 
+TEST(pthread, pthread_rwlock_kind_PTHREAD_RWLOCK_SCALABLE_READERS_NP) {
+#if defined(__BIONIC__)
+  RwlockKindTestHelper helper(PTHREAD_RWLOCK_SCALABLE_READERS_NP);
+  ASSERT_EQ(0, pthread_rwlock_rdlock(&helper.lock));
+  ASSERT_EQ(EBUSY, pthread_rwlock_trywrlock(&helper.lock));
+  ASSERT_EQ(EBUSY, pthread_rwlock_destroy(&helper.lock));
+
+  pthread_t writer_thread;
+  std::atomic<pid_t> writer_tid;
+  helper.CreateWriterThread(writer_thread, writer_tid);
+  WaitUntilThreadSleep(writer_tid);
+
+  // The waiting writer keeps new readers out.
+  pthread_t reader_thread;
+  std::atomic<pid_t> reader_tid;
+  helper.CreateReaderThread(reader_thread, reader_tid);
+  WaitUntilThreadSleep(reader_tid);
+
+  ASSERT_EQ(0, pthread_rwlock_unlock(&helper.lock));
+  ASSERT_EQ(0, pthread_join(writer_thread, NULL));
+  ASSERT_EQ(0, pthread_join(reader_thread, NULL));
+
+  ASSERT_EQ(0, pthread_rwlock_trywrlock(&helper.lock));
+  ASSERT_EQ(EBUSY, pthread_rwlock_tryrdlock(&helper.lock));
+  ASSERT_EQ(EDEADLK, pthread_rwlock_rdlock(&helper.lock));
+  ASSERT_EQ(0, pthread_rwlock_unlock(&helper.lock));
+  ASSERT_EQ(EPERM, pthread_rwlock_unlock(&helper.lock));
+#else
+  GTEST_LOG_(INFO) << "This test tests bionic implementation details.\n";
+#endif
+}
+
+TEST(pthread, pthread_rwlock_SCALABLE_READERS_NP_not_pshared) {
+#if defined(__BIONIC__)
+  pthread_rwlockattr_t attr;
+  ASSERT_EQ(0, pthread_rwlockattr_init(&attr));
+  ASSERT_EQ(0, pthread_rwlockattr_setkind_np(&attr, PTHREAD_RWLOCK_SCALABLE_READERS_NP));
+  int kind;
+  ASSERT_EQ(0, pthread_rwlockattr_getkind_np(&attr, &kind));
+  ASSERT_EQ(PTHREAD_RWLOCK_SCALABLE_READERS_NP, kind);
+  ASSERT_EQ(0, pthread_rwlockattr_setpshared(&attr, PTHREAD_PROCESS_SHARED));
+  pthread_rwlock_t lock;
+  ASSERT_EQ(ENOTSUP, pthread_rwlock_init(&lock, &attr));
+  ASSERT_EQ(0, pthread_rwlockattr_destroy(&attr));
+#else
+  GTEST_LOG_(INFO) << "This test tests bionic implementation details.\n";
+#endif
+}
+
 static int g_once_fn_call_count = 0;
 static void OnceFn() {
   ++g_once_fn_call_count;
@@ -1242,6 +1384,69 @@ TEST_F(pthread_CondWakeupTest, signal_timedwait_CLOCK_MONOTONIC) {
   ASSERT_EQ(0, pthread_cond_signal(&cond));
 }
 
+struct CondBroadcastArg {
+  pthread_mutex_t* mutex;
+  pthread_cond_t* cond;
+  bool signaled;
+  int waiting;
+  int finished;
+};
+
+static void* CondBroadcastWaiterFn(CondBroadcastArg* arg) {
+  pthread_mutex_lock(arg->mutex);
+  ++arg->waiting;
+  while (!arg->signaled) {
+    pthread_cond_wait(arg->cond, arg->mutex);
+  }
+  ++arg->finished;
+  pthread_mutex_unlock(arg->mutex);
+  return nullptr;
+}
+
+static void TestCondBroadcastWakesAll(const pthread_mutexattr_t* mutex_attr) {
+  pthread_mutex_t mutex;
+  ASSERT_EQ(0, pthread_mutex_init(&mutex, mutex_attr));
+  pthread_cond_t cond;
+  ASSERT_EQ(0, pthread_cond_init(&cond, nullptr));
+  CondBroadcastArg arg = { &mutex, &cond, false, 0, 0 };
+
+  // Every waiter but the first one woken is requeued onto the mutex, so this checks that
+  // each of them is still woken in turn.
+  const int kThreadCount = 16;
+  std::vector<pthread_t> threads(kThreadCount);
+  for (auto& thread : threads) {
+    ASSERT_EQ(0, pthread_create(&thread, nullptr,
+                                reinterpret_cast<void* (*)(void*)>(CondBroadcastWaiterFn), &arg));
+  }
+  while (true) {
+    ASSERT_EQ(0, pthread_mutex_lock(&mutex));
+    if (arg.waiting == kThreadCount) break;
+    ASSERT_EQ(0, pthread_mutex_unlock(&mutex));
+    usleep(1000);
+  }
+  arg.signaled = true;
+  ASSERT_EQ(0, pthread_cond_broadcast(&cond));
+  ASSERT_EQ(0, pthread_mutex_unlock(&mutex));
+  for (auto& thread : threads) {
+    ASSERT_EQ(0, pthread_join(thread, nullptr));
+  }
+  ASSERT_EQ(kThreadCount, arg.finished);
+  ASSERT_EQ(0, pthread_cond_destroy(&cond));
+  ASSERT_EQ(0, pthread_mutex_destroy(&mutex));
+}
+
+TEST(pthread, pthread_cond_broadcast_wakes_all) {
+  TestCondBroadcastWakesAll(nullptr);
+}
+
+TEST(pthread, pthread_cond_broadcast_wakes_all_RECURSIVE) {
+  pthread_mutexattr_t attr;
+  ASSERT_EQ(0, pthread_mutexattr_init(&attr));
+  ASSERT_EQ(0, pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE));
+  TestCondBroadcastWakesAll(&attr);
+  ASSERT_EQ(0, pthread_mutexattr_destroy(&attr));
+}
+
 TEST(pthread, pthread_cond_timedwait_timeout) {
   pthread_mutex_t mutex;
   ASSERT_EQ(0, pthread_mutex_init(&mutex, nullptr));
@@ -1537,14 +1742,18 @@ TEST(pthread, pthread_mutexattr_gettype) {
   ASSERT_EQ(0, pthread_mutexattr_gettype(&attr, &attr_type));
   ASSERT_EQ(PTHREAD_MUTEX_RECURSIVE, attr_type);
 
+  ASSERT_EQ(0, pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_ADAPTIVE_NP));
+  ASSERT_EQ(0, pthread_mutexattr_gettype(&attr, &attr_type));
+  ASSERT_EQ(PTHREAD_MUTEX_ADAPTIVE_NP, attr_type);
+
   ASSERT_EQ(0, pthread_mutexattr_destroy(&attr));
 }
 
 struct PthreadMutex {
   pthread_mutex_t lock;
 
-  explicit PthreadMutex(int mutex_type) {
-    init(mutex_type);
+  explicit PthreadMutex(int mutex_type, int protocol = PTHREAD_PRIO_NONE) {
+    init(mutex_type, protocol);
   }
 
   ~PthreadMutex() {
@@ -1552,10 +1761,11 @@ struct PthreadMutex {
   }
 
  private:
-  void init(int mutex_type) {
+  void init(int mutex_type, int protocol) {
     pthread_mutexattr_t attr;
     ASSERT_EQ(0, pthread_mutexattr_init(&attr));
     ASSERT_EQ(0, pthread_mutexattr_settype(&attr, mutex_type));
+    ASSERT_EQ(0, pthread_mutexattr_setprotocol(&attr, protocol));
     ASSERT_EQ(0, pthread_mutex_init(&lock, &attr));
     ASSERT_EQ(0, pthread_mutexattr_destroy(&attr));
   }
@@ -1603,6 +1813,75 @@ TEST(pthread, pthread_mutex_lock_RECURSIVE) {
   ASSERT_EQ(EPERM, pthread_mutex_unlock(&m.lock));
 }
 
+TEST(pthread, pthread_mutex_lock_ADAPTIVE) {
+  PthreadMutex m(PTHREAD_MUTEX_ADAPTIVE_NP);
+
+  ASSERT_EQ(0, pthread_mutex_lock(&m.lock));
+  ASSERT_EQ(0, pthread_mutex_unlock(&m.lock));
+  ASSERT_EQ(0, pthread_mutex_trylock(&m.lock));
+  ASSERT_EQ(EBUSY, pthread_mutex_trylock(&m.lock));
+  ASSERT_EQ(0, pthread_mutex_unlock(&m.lock));
+}
+
+TEST(pthread, pthread_mutexattr_protocol) {
+  pthread_mutexattr_t attr;
+  ASSERT_EQ(0, pthread_mutexattr_init(&attr));
+
+  int protocol;
+  ASSERT_EQ(0, pthread_mutexattr_getprotocol(&attr, &protocol));
+  ASSERT_EQ(PTHREAD_PRIO_NONE, protocol);
+  ASSERT_EQ(0, pthread_mutexattr_setprotocol(&attr, PTHREAD_PRIO_INHERIT));
+  ASSERT_EQ(0, pthread_mutexattr_getprotocol(&attr, &protocol));
+  ASSERT_EQ(PTHREAD_PRIO_INHERIT, protocol);
+  ASSERT_EQ(EINVAL, pthread_mutexattr_setprotocol(&attr, 123));
+  ASSERT_EQ(0, pthread_mutexattr_getprotocol(&attr, &protocol));
+  ASSERT_EQ(PTHREAD_PRIO_INHERIT, protocol);
+
+  ASSERT_EQ(0, pthread_mutexattr_destroy(&attr));
+}
+
+TEST(pthread, pthread_mutex_lock_pi) {
+  PthreadMutex m(PTHREAD_MUTEX_NORMAL, PTHREAD_PRIO_INHERIT);
+  ASSERT_EQ(0, pthread_mutex_lock(&m.lock));
+  ASSERT_EQ(0, pthread_mutex_unlock(&m.lock));
+  ASSERT_EQ(0, pthread_mutex_trylock(&m.lock));
+  ASSERT_EQ(EBUSY, pthread_mutex_trylock(&m.lock));
+  ASSERT_EQ(0, pthread_mutex_unlock(&m.lock));
+
+  PthreadMutex m2(PTHREAD_MUTEX_ERRORCHECK, PTHREAD_PRIO_INHERIT);
+  ASSERT_EQ(0, pthread_mutex_lock(&m2.lock));
+  ASSERT_EQ(EDEADLK, pthread_mutex_lock(&m2.lock));
+  ASSERT_EQ(0, pthread_mutex_unlock(&m2.lock));
+  ASSERT_EQ(0, pthread_mutex_trylock(&m2.lock));
+  ASSERT_EQ(EBUSY, pthread_mutex_trylock(&m2.lock));
+  ASSERT_EQ(0, pthread_mutex_unlock(&m2.lock));
+  ASSERT_EQ(EPERM, pthread_mutex_unlock(&m2.lock));
+
+  PthreadMutex m3(PTHREAD_MUTEX_RECURSIVE, PTHREAD_PRIO_INHERIT);
+  ASSERT_EQ(0, pthread_mutex_lock(&m3.lock));
+  ASSERT_EQ(0, pthread_mutex_lock(&m3.lock));
+  ASSERT_EQ(0, pthread_mutex_unlock(&m3.lock));
+  ASSERT_EQ(0, pthread_mutex_unlock(&m3.lock));
+  ASSERT_EQ(0, pthread_mutex_trylock(&m3.lock));
+  ASSERT_EQ(0, pthread_mutex_trylock(&m3.lock));
+  ASSERT_EQ(0, pthread_mutex_unlock(&m3.lock));
+  ASSERT_EQ(0, pthread_mutex_unlock(&m3.lock));
+  ASSERT_EQ(EPERM, pthread_mutex_unlock(&m3.lock));
+}
+
+TEST(pthread, pthread_mutex_pi_destroy_locked) {
+  pthread_mutexattr_t attr;
+  ASSERT_EQ(0, pthread_mutexattr_init(&attr));
+  ASSERT_EQ(0, pthread_mutexattr_setprotocol(&attr, PTHREAD_PRIO_INHERIT));
+  pthread_mutex_t m;
+  ASSERT_EQ(0, pthread_mutex_init(&m, &attr));
+  ASSERT_EQ(0, pthread_mutexattr_destroy(&attr));
+  ASSERT_EQ(0, pthread_mutex_lock(&m));
+  ASSERT_EQ(EBUSY, pthread_mutex_destroy(&m));
+  ASSERT_EQ(0, pthread_mutex_unlock(&m));
+  ASSERT_EQ(0, pthread_mutex_destroy(&m));
+}
+
 TEST(pthread, pthread_mutex_init_same_as_static_initializers) {
   pthread_mutex_t lock_normal = PTHREAD_MUTEX_INITIALIZER;
   PthreadMutex m1(PTHREAD_MUTEX_NORMAL);
@@ -1618,6 +1897,11 @@ TEST(pthread, pthread_mutex_init_same_as_static_initializers) {
   PthreadMutex m3(PTHREAD_MUTEX_RECURSIVE);
   ASSERT_EQ(0, memcmp(&lock_recursive, &m3.lock, sizeof(pthread_mutex_t)));
   ASSERT_EQ(0, pthread_mutex_destroy(&lock_recursive));
+
+  pthread_mutex_t lock_adaptive = PTHREAD_ADAPTIVE_MUTEX_INITIALIZER_NP;
+  PthreadMutex m4(PTHREAD_MUTEX_ADAPTIVE_NP);
+  ASSERT_EQ(0, memcmp(&lock_adaptive, &m4.lock, sizeof(pthread_mutex_t)));
+  ASSERT_EQ(0, pthread_mutex_destroy(&lock_adaptive));
 }
 class MutexWakeupHelper {
  private:
@@ -1644,7 +1928,8 @@ class MutexWakeupHelper {
   }
 
  public:
-  explicit MutexWakeupHelper(int mutex_type) : m(mutex_type) {
+  explicit MutexWakeupHelper(int mutex_type, int protocol = PTHREAD_PRIO_NONE)
+      : m(mutex_type, protocol) {
   }
 
   void test() {
@@ -1682,6 +1967,21 @@ TEST(pthread, pthread_mutex_RECURSIVE_wakeup) {
   helper.test();
 }
 
+TEST(pthread, pthread_mutex_ADAPTIVE_wakeup) {
+  MutexWakeupHelper helper(PTHREAD_MUTEX_ADAPTIVE_NP);
+  helper.test();
+}
+
+TEST(pthread, pthread_mutex_NORMAL_wakeup_pi) {
+  MutexWakeupHelper helper(PTHREAD_MUTEX_NORMAL, PTHREAD_PRIO_INHERIT);
+  helper.test();
+}
+
+TEST(pthread, pthread_mutex_RECURSIVE_wakeup_pi) {
+  MutexWakeupHelper helper(PTHREAD_MUTEX_RECURSIVE, PTHREAD_PRIO_INHERIT);
+  helper.test();
+}
+
 TEST(pthread, pthread_mutex_owner_tid_limit) {
 #if defined(__BIONIC__) && !defined(__LP64__)
   FILE* fp = fopen("/proc/sys/kernel/pid_max", "r");
@@ -1778,7 +2078,7 @@ TEST(pthread, pthread_types_allow_four_bytes_alignment) {
   ASSERT_EQ(0, pthread_rwlock_destroy(rwlock));
 
 #else
-  GTEST_LOG_(INFO) << "This test tests bionic implementation details.";
+  GTEST_LOG_(INFO) << "This test tests bionic implementation details.\n";
 #endif
 }
 
@@ -1865,6 +2165,28 @@ TEST(pthread, pthread_barrierattr_smoke) {
   ASSERT_EQ(0, pthread_barrierattr_destroy(&attr));
 }
 
+TEST(pthread, pthread_barrierattr_kind) {
+#if defined(__BIONIC__)
+  pthread_barrierattr_t attr;
+  ASSERT_EQ(0, pthread_barrierattr_init(&attr));
+  int kind;
+  ASSERT_EQ(0, pthread_barrierattr_getkind_np(&attr, &kind));
+  ASSERT_EQ(PTHREAD_BARRIER_DEFAULT_NP, kind);
+  ASSERT_EQ(0, pthread_barrierattr_setkind_np(&attr, PTHREAD_BARRIER_TREE_NP));
+  ASSERT_EQ(0, pthread_barrierattr_getkind_np(&attr, &kind));
+  ASSERT_EQ(PTHREAD_BARRIER_TREE_NP, kind);
+  ASSERT_EQ(EINVAL, pthread_barrierattr_setkind_np(&attr, 2));
+
+  // Tree barriers can't be process-shared.
+  ASSERT_EQ(0, pthread_barrierattr_setpshared(&attr, PTHREAD_PROCESS_SHARED));
+  pthread_barrier_t barrier;
+  ASSERT_EQ(ENOTSUP, pthread_barrier_init(&barrier, &attr, 2));
+  ASSERT_EQ(0, pthread_barrierattr_destroy(&attr));
+#else
+  GTEST_LOG_(INFO) << "This test tests bionic implementation details.\n";
+#endif
+}
+
 struct BarrierTestHelperData {
   size_t thread_count;
   pthread_barrier_t barrier;
@@ -1902,11 +2224,11 @@ static void BarrierTestHelper(BarrierTestHelperArg* arg) {
   }
 }
 
-TEST(pthread, pthread_barrier_smoke) {
+static void TestBarrierSmoke(const pthread_barrierattr_t* attr) {
   const size_t BARRIER_ITERATION_COUNT = 10;
   const size_t BARRIER_THREAD_COUNT = 10;
   BarrierTestHelperData data(BARRIER_THREAD_COUNT, BARRIER_ITERATION_COUNT);
-  ASSERT_EQ(0, pthread_barrier_init(&data.barrier, nullptr, data.thread_count));
+  ASSERT_EQ(0, pthread_barrier_init(&data.barrier, attr, data.thread_count));
   std::vector<pthread_t> threads(data.thread_count);
   std::vector<BarrierTestHelperArg> args(threads.size());
   for (size_t i = 0; i < threads.size(); ++i) {
@@ -1922,6 +2244,22 @@ TEST(pthread, pthread_barrier_smoke) {
   ASSERT_EQ(0, pthread_barrier_destroy(&data.barrier));
 }
 
+TEST(pthread, pthread_barrier_smoke) {
+  TestBarrierSmoke(nullptr);
+}
+
+TEST(pthread, pthread_barrier_smoke_TREE) {
+#if defined(__BIONIC__)
+  pthread_barrierattr_t attr;
+  ASSERT_EQ(0, pthread_barrierattr_init(&attr));
+  ASSERT_EQ(0, pthread_barrierattr_setkind_np(&attr, PTHREAD_BARRIER_TREE_NP));
+  TestBarrierSmoke(&attr);
+  ASSERT_EQ(0, pthread_barrierattr_destroy(&attr));
+#else
+  GTEST_LOG_(INFO) << "This test tests bionic implementation details.\n";
+#endif
+}
+
 struct BarrierDestroyTestArg {
   std::atomic<int> tid;
   pthread_barrier_t* barrier;
@@ -1973,25 +2311,42 @@ void BarrierOrderingTestHelper(BarrierOrderingTestHelperArg* arg) {
   }
 }
 
-TEST(pthread, pthread_barrier_check_ordering) {
-  const size_t THREAD_COUNT = 4;
+static void TestBarrierOrdering(const pthread_barrierattr_t* attr, size_t thread_count) {
   pthread_barrier_t barrier;
-  ASSERT_EQ(0, pthread_barrier_init(&barrier, nullptr, THREAD_COUNT));
-  size_t array[THREAD_COUNT];
-  std::vector<pthread_t> threads(THREAD_COUNT);
-  std::vector<BarrierOrderingTestHelperArg> args(THREAD_COUNT);
-  for (size_t i = 0; i < THREAD_COUNT; ++i) {
+  ASSERT_EQ(0, pthread_barrier_init(&barrier, attr, thread_count));
+  std::vector<size_t> array(thread_count);
+  std::vector<pthread_t> threads(thread_count);
+  std::vector<BarrierOrderingTestHelperArg> args(thread_count);
+  for (size_t i = 0; i < thread_count; ++i) {
     args[i].barrier = &barrier;
-    args[i].array = array;
-    args[i].array_length = THREAD_COUNT;
+    args[i].array = array.data();
+    args[i].array_length = thread_count;
     args[i].id = i;
     ASSERT_EQ(0, pthread_create(&threads[i], nullptr,
                                 reinterpret_cast<void* (*)(void*)>(BarrierOrderingTestHelper),
                                 &args[i]));
   }
-  for (size_t i = 0; i < THREAD_COUNT; ++i) {
+  for (size_t i = 0; i < thread_count; ++i) {
     ASSERT_EQ(0, pthread_join(threads[i], nullptr));
   }
+  ASSERT_EQ(0, pthread_barrier_destroy(&barrier));
+}
+
+TEST(pthread, pthread_barrier_check_ordering) {
+  TestBarrierOrdering(nullptr, 4);
+}
+
+TEST(pthread, pthread_barrier_check_ordering_TREE) {
+#if defined(__BIONIC__)
+  pthread_barrierattr_t attr;
+  ASSERT_EQ(0, pthread_barrierattr_init(&attr));
+  ASSERT_EQ(0, pthread_barrierattr_setkind_np(&attr, PTHREAD_BARRIER_TREE_NP));
+  // Enough threads for a few levels of the tree.
+  TestBarrierOrdering(&attr, 16);
+  ASSERT_EQ(0, pthread_barrierattr_destroy(&attr));
+#else
+  GTEST_LOG_(INFO) << "This test tests bionic implementation details.\n";
+#endif
 }
 
 TEST(pthread, pthread_spinlock_smoke) {
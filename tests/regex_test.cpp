@@ -16,9 +16,12 @@
 
 #include <gtest/gtest.h>
 
+#include <stdint.h>
 #include <sys/types.h>
 #include <regex.h>
 
+#include <string>
+
 TEST(regex, smoke) {
   // A quick test of all the regex functions.
   regex_t re;
@@ -57,3 +60,74 @@ TEST(regex, regerror_NULL_0) {
   int error_length = regerror(error, &re, nullptr, 0);
   ASSERT_GT(error_length, 0);
 }
+
+TEST(regex, repeated_regexec) {
+  // regexec keeps state between calls on the same regex_t; make sure none of it leaks
+  // from one subject string into the next.
+  regex_t re;
+  ASSERT_EQ(0, regcomp(&re, "(error|warning): ([0-9]+)", REG_EXTENDED));
+  regmatch_t matches[3];
+  for (size_t i = 0; i < 100; ++i) {
+    ASSERT_EQ(0, regexec(&re, "warning: 7 then error: 42", 3, matches, 0));
+    ASSERT_EQ(0, matches[0].rm_so);
+    ASSERT_EQ(10, matches[0].rm_eo);
+    ASSERT_EQ(9, matches[2].rm_so);
+    ASSERT_EQ(REG_NOMATCH, regexec(&re, "error 42", 3, matches, 0));
+    ASSERT_EQ(0, regexec(&re, "x error: 123", 3, matches, 0));
+    ASSERT_EQ(2, matches[1].rm_so);
+    ASSERT_EQ(7, matches[1].rm_eo);
+    ASSERT_EQ(9, matches[2].rm_so);
+    ASSERT_EQ(12, matches[2].rm_eo);
+  }
+  regfree(&re);
+}
+
+TEST(regex, anchors) {
+  regex_t re;
+  regmatch_t matches[1];
+  ASSERT_EQ(0, regcomp(&re, "^b+$", REG_EXTENDED | REG_NEWLINE));
+  ASSERT_EQ(0, regexec(&re, "a\nbb\nc", 1, matches, 0));
+  ASSERT_EQ(2, matches[0].rm_so);
+  ASSERT_EQ(4, matches[0].rm_eo);
+  ASSERT_EQ(0, regexec(&re, "bbb", 1, matches, 0));
+  ASSERT_EQ(REG_NOMATCH, regexec(&re, "bbb", 1, matches, REG_NOTBOL));
+  ASSERT_EQ(REG_NOMATCH, regexec(&re, "bbb", 1, matches, REG_NOTEOL));
+  ASSERT_EQ(REG_NOMATCH, regexec(&re, "abb", 1, matches, 0));
+  regfree(&re);
+}
+
+TEST(regex, many_states) {
+  // Matching this needs a state for each of the last 12 characters seen, which is more than
+  // regexec will cache at once.
+  std::string pattern("(a|b)*a");
+  for (size_t i = 0; i < 12; ++i) pattern += "(a|b)";
+  pattern += "$";
+  regex_t re;
+  ASSERT_EQ(0, regcomp(&re, pattern.c_str(), REG_EXTENDED));
+  std::string s;
+  uint32_t seed = 1;
+  for (size_t i = 0; i < 4096; ++i) {
+    seed = seed * 1103515245 + 12345;
+    s += "ab"[seed >> 31];
+  }
+  regmatch_t matches[1];
+  for (size_t i = 0; i < 2; ++i) {
+    ASSERT_EQ(REG_NOMATCH, regexec(&re, (s + std::string(13, 'b')).c_str(), 1, matches, 0));
+    ASSERT_EQ(0, regexec(&re, (s + "a" + std::string(12, 'b')).c_str(), 1, matches, 0));
+    ASSERT_EQ(0, matches[0].rm_so);
+    ASSERT_EQ(4109, matches[0].rm_eo);
+  }
+  regfree(&re);
+}
+
+TEST(regex, back_references) {
+  regex_t re;
+  regmatch_t matches[2];
+  ASSERT_EQ(0, regcomp(&re, "\\([a-z]*\\)-\\1", 0));
+  ASSERT_EQ(0, regexec(&re, "xx abc-abc", 2, matches, 0));
+  ASSERT_EQ(3, matches[0].rm_so);
+  ASSERT_EQ(10, matches[0].rm_eo);
+  ASSERT_EQ(3, matches[1].rm_so);
+  ASSERT_EQ(6, matches[1].rm_eo);
+  regfree(&re);
+}
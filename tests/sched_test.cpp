@@ -17,9 +17,13 @@
 #include <gtest/gtest.h>
 
 #include <errno.h>
+#include <pthread.h>
 #include <sched.h>
+#include <stdint.h>
+#include <sys/syscall.h>
 #include <sys/types.h>
 #include <sys/wait.h>
+#include <unistd.h>
 
 static int child_fn(void* i_ptr) {
   *reinterpret_cast<int*>(i_ptr) = 42;
@@ -270,3 +274,48 @@ TEST(sched, cpu_equal_s) {
   CPU_FREE(set1);
   CPU_FREE(set2);
 }
+
+#if defined(__BIONIC__) && (defined(__aarch64__) || defined(__x86_64__))
+#if defined(__aarch64__)
+#define TEST_NR_rseq 293
+#define TEST_RSEQ_SIG 0xd428bc00
+#else
+#define TEST_NR_rseq 334
+#define TEST_RSEQ_SIG 0x53053053
+#endif
+
+// Tries to register another rseq area for the calling thread, which fails if libc already has.
+static void* try_rseq_register(void*) {
+  struct alignas(32) {
+    uint32_t cpu_id_start;
+    uint32_t cpu_id;
+    uint64_t rseq_cs;
+    uint32_t flags;
+  } area = {};
+  long rc = syscall(TEST_NR_rseq, &area, sizeof(area), 0, TEST_RSEQ_SIG);
+  return reinterpret_cast<void*>(rc == -1 ? errno : 0);
+}
+#endif
+
+TEST(sched, rseq_registered_by_libc) {
+#if defined(__BIONIC__) && (defined(__aarch64__) || defined(__x86_64__))
+  intptr_t main_errno = reinterpret_cast<intptr_t>(try_rseq_register(nullptr));
+  if (main_errno == ENOSYS) {
+    GTEST_LOG_(INFO) << "This test does nothing on kernels without rseq.\n";
+    return;
+  }
+  ASSERT_EQ(EBUSY, main_errno);
+
+  // Run a few threads one after another, so later ones reuse cached stacks whose rseq areas
+  // must have been unregistered.
+  for (size_t i = 0; i < 4; ++i) {
+    pthread_t t;
+    ASSERT_EQ(0, pthread_create(&t, nullptr, try_rseq_register, nullptr));
+    void* thread_errno;
+    ASSERT_EQ(0, pthread_join(t, &thread_errno));
+    ASSERT_EQ(EBUSY, reinterpret_cast<intptr_t>(thread_errno));
+  }
+#else
+  GTEST_LOG_(INFO) << "This test does nothing on architectures without rseq support in bionic.\n";
+#endif
+}
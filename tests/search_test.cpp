@@ -16,6 +16,7 @@
 
 #include <gtest/gtest.h>
 
+#include <errno.h>
 #include <search.h>
 
 static int int_cmp(const void* lhs, const void* rhs) {
@@ -135,6 +136,55 @@ TEST(search, tdelete) {
   ASSERT_NE(nullptr, tdelete(&n1, &root, pod_node_cmp));
 }
 
+static int intptr_cmp(const void* lhs, const void* rhs) {
+  intptr_t a = reinterpret_cast<intptr_t>(lhs);
+  intptr_t b = reinterpret_cast<intptr_t>(rhs);
+  return (a > b) - (a < b);
+}
+
+static int g_max_level;
+
+static void max_level_walk(const void*, VISIT, int level) {
+  if (level > g_max_level) g_max_level = level;
+}
+
+TEST(search, tsearch_sorted_keys_stay_balanced) {
+  void* root = nullptr;
+  const intptr_t kCount = 10000;
+  for (intptr_t i = 1; i <= kCount; ++i) {
+    void* n = tsearch(reinterpret_cast<void*>(i), &root, intptr_cmp);
+    ASSERT_NE(nullptr, n);
+    ASSERT_EQ(i, *reinterpret_cast<intptr_t*>(n));
+  }
+
+  // A balanced tree of 10000 nodes is no more than 2 * log2(10000) deep; an unbalanced one
+  // would be a 10000-long list.
+  g_max_level = 0;
+  twalk(root, max_level_walk);
+  ASSERT_LT(g_max_level, 28);
+
+  for (intptr_t i = 2; i <= kCount; i += 2) {
+    ASSERT_NE(nullptr, tdelete(reinterpret_cast<void*>(i), &root, intptr_cmp));
+  }
+  for (intptr_t i = 1; i <= kCount; ++i) {
+    void* n = tfind(reinterpret_cast<void*>(i), &root, intptr_cmp);
+    if (i % 2 == 0) {
+      ASSERT_EQ(nullptr, n) << i;
+    } else {
+      ASSERT_NE(nullptr, n) << i;
+      ASSERT_EQ(i, *reinterpret_cast<intptr_t*>(n));
+    }
+  }
+
+  g_max_level = 0;
+  twalk(root, max_level_walk);
+  ASSERT_LT(g_max_level, 26);
+
+  g_free_calls = 0;
+  tdestroy(root, [](void*) { ++g_free_calls; });
+  ASSERT_EQ(static_cast<size_t>(kCount / 2), g_free_calls);
+}
+
 struct q_node {
   explicit q_node(int i) : i(i) {}
 
@@ -208,3 +258,97 @@ TEST(search, insque_remque) {
 
   remque(&zero);
 }
+
+TEST(search, hcreate_hsearch_hdestroy) {
+  ASSERT_NE(0, hcreate(16));
+
+  char a[] = "a";
+  char b[] = "b";
+  int data_a, data_b;
+
+  errno = 0;
+  ASSERT_EQ(nullptr, hsearch(ENTRY{a, nullptr}, FIND));
+  ASSERT_EQ(ESRCH, errno);
+
+  ENTRY* e = hsearch(ENTRY{a, &data_a}, ENTER);
+  ASSERT_NE(nullptr, e);
+  ASSERT_STREQ("a", e->key);
+  ASSERT_EQ(&data_a, e->data);
+
+  // Entering an existing key returns the existing entry.
+  e = hsearch(ENTRY{a, &data_b}, ENTER);
+  ASSERT_NE(nullptr, e);
+  ASSERT_EQ(&data_a, e->data);
+
+  ASSERT_NE(nullptr, hsearch(ENTRY{b, &data_b}, ENTER));
+
+  // Lookups go by string contents, not by pointer.
+  char other_a[] = "a";
+  e = hsearch(ENTRY{other_a, nullptr}, FIND);
+  ASSERT_NE(nullptr, e);
+  ASSERT_EQ(&data_a, e->data);
+  e = hsearch(ENTRY{b, nullptr}, FIND);
+  ASSERT_NE(nullptr, e);
+  ASSERT_EQ(&data_b, e->data);
+
+  hdestroy();
+}
+
+TEST(search, hsearch_r) {
+  hsearch_data table;
+  memset(&table, 0, sizeof(table));
+  ASSERT_NE(0, hcreate_r(1000, &table));
+
+  std::vector<std::string> keys;
+  for (size_t i = 0; i < 1000; ++i) {
+    keys.push_back("key" + std::to_string(i));
+  }
+
+  ENTRY* e;
+  for (size_t i = 0; i < keys.size(); ++i) {
+    ENTRY item{const_cast<char*>(keys[i].c_str()), reinterpret_cast<void*>(i)};
+    ASSERT_NE(0, hsearch_r(item, ENTER, &e, &table));
+  }
+  for (size_t i = 0; i < keys.size(); ++i) {
+    ENTRY item{const_cast<char*>(keys[i].c_str()), nullptr};
+    ASSERT_NE(0, hsearch_r(item, FIND, &e, &table));
+    ASSERT_EQ(reinterpret_cast<void*>(i), e->data);
+  }
+
+  char missing[] = "missing";
+  errno = 0;
+  ASSERT_EQ(0, hsearch_r(ENTRY{missing, nullptr}, FIND, &e, &table));
+  ASSERT_EQ(nullptr, e);
+  ASSERT_EQ(ESRCH, errno);
+
+  hdestroy_r(&table);
+}
+
+TEST(search, hsearch_r_grows) {
+#if defined(__BIONIC__)
+  // glibc's table is fixed at the size given to hcreate_r, but ours grows.
+  hsearch_data table;
+  memset(&table, 0, sizeof(table));
+  ASSERT_NE(0, hcreate_r(1, &table));
+
+  std::vector<std::string> keys;
+  for (size_t i = 0; i < 10000; ++i) {
+    keys.push_back(std::to_string(i));
+  }
+
+  ENTRY* e;
+  for (size_t i = 0; i < keys.size(); ++i) {
+    ENTRY item{const_cast<char*>(keys[i].c_str()), reinterpret_cast<void*>(i)};
+    ASSERT_NE(0, hsearch_r(item, ENTER, &e, &table));
+  }
+  for (size_t i = 0; i < keys.size(); ++i) {
+    ENTRY item{const_cast<char*>(keys[i].c_str()), nullptr};
+    ASSERT_NE(0, hsearch_r(item, FIND, &e, &table));
+    ASSERT_EQ(reinterpret_cast<void*>(i), e->data);
+  }
+
+  hdestroy_r(&table);
+#else
+  GTEST_LOG_(INFO) << "This test does nothing.\n";
+#endif
+}
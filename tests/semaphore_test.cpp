@@ -132,6 +132,83 @@ TEST(semaphore, sem_timedwait) {
   ASSERT_EQ(0, sem_destroy(&s));
 }
 
+// Waiters that time out mustn't leave the semaphore thinking someone is still asleep, or lose
+// a post that arrives just as they give up.
+TEST(semaphore, sem_timedwait_timeout_then_sem_post) {
+  sem_t s;
+  ASSERT_EQ(0, sem_init(&s, 0, 0));
+
+  for (size_t i = 0; i < 10; ++i) {
+    timespec ts;
+    ASSERT_EQ(0, clock_gettime(CLOCK_REALTIME, &ts));
+    timespec_add_ms(ts, 1);
+    errno = 0;
+    ASSERT_EQ(-1, sem_timedwait(&s, &ts));
+    ASSERT_EQ(ETIMEDOUT, errno);
+  }
+
+  ASSERT_EQ(0, sem_post(&s));
+  int i;
+  ASSERT_EQ(0, sem_getvalue(&s, &i));
+  ASSERT_EQ(1, i);
+  ASSERT_EQ(0, sem_wait(&s));
+  ASSERT_EQ(0, sem_destroy(&s));
+}
+
+struct BoundedBuffer {
+  sem_t items;
+  sem_t slots;
+  size_t count;
+};
+
+static void* ProducerFn(void* arg) {
+  BoundedBuffer* buffer = reinterpret_cast<BoundedBuffer*>(arg);
+  for (size_t i = 0; i < buffer->count; ++i) {
+    if (sem_wait(&buffer->slots) != 0 || sem_post(&buffer->items) != 0) {
+      return arg;
+    }
+  }
+  return nullptr;
+}
+
+static void* ConsumerFn(void* arg) {
+  BoundedBuffer* buffer = reinterpret_cast<BoundedBuffer*>(arg);
+  for (size_t i = 0; i < buffer->count; ++i) {
+    if (sem_wait(&buffer->items) != 0 || sem_post(&buffer->slots) != 0) {
+      return arg;
+    }
+  }
+  return nullptr;
+}
+
+// Several producers and consumers passing units through a small buffer, so that there are
+// usually several sleepers on each semaphore, and posts race with waiters going to sleep.
+TEST(semaphore, multiple_producers_multiple_consumers) {
+  BoundedBuffer buffer;
+  ASSERT_EQ(0, sem_init(&buffer.items, 0, 0));
+  ASSERT_EQ(0, sem_init(&buffer.slots, 0, 2));
+  buffer.count = 10000;
+
+  pthread_t threads[8];
+  for (size_t i = 0; i < 8; ++i) {
+    ASSERT_EQ(0, pthread_create(&threads[i], nullptr, (i % 2) ? ConsumerFn : ProducerFn,
+                                &buffer));
+  }
+  for (size_t i = 0; i < 8; ++i) {
+    void* result;
+    ASSERT_EQ(0, pthread_join(threads[i], &result));
+    ASSERT_EQ(nullptr, result);
+  }
+
+  int i;
+  ASSERT_EQ(0, sem_getvalue(&buffer.items, &i));
+  ASSERT_EQ(0, i);
+  ASSERT_EQ(0, sem_getvalue(&buffer.slots, &i));
+  ASSERT_EQ(2, i);
+  ASSERT_EQ(0, sem_destroy(&buffer.items));
+  ASSERT_EQ(0, sem_destroy(&buffer.slots));
+}
+
 TEST(semaphore_DeathTest, sem_timedwait_null_timeout) {
   sem_t s;
   ASSERT_EQ(0, sem_init(&s, 0, 0));
@@ -0,0 +1,342 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <errno.h>
+#include <signal.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "BionicDeathTest.h"
+
+#if defined(__BIONIC__)
+#include <android/shm_queue.h>
+
+#include "TemporaryFile.h"
+
+struct TestMessage {
+  uint32_t producer;
+  uint32_t sequence;
+};
+
+static timespec MonotonicDeadline(long ms) {
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  ts.tv_sec += ms / 1000;
+  ts.tv_nsec += (ms % 1000) * 1000000;
+  if (ts.tv_nsec >= 1000000000) {
+    ts.tv_sec++;
+    ts.tv_nsec -= 1000000000;
+  }
+  return ts;
+}
+
+static void AssertChildExitedCleanly(pid_t pid) {
+  int status;
+  ASSERT_EQ(pid, waitpid(pid, &status, 0));
+  ASSERT_TRUE(WIFEXITED(status));
+  ASSERT_EQ(0, WEXITSTATUS(status));
+}
+#endif
+
+TEST(shm_queue, android_shm_queue_create_errors) {
+#if defined(__BIONIC__)
+  errno = 0;
+  ASSERT_TRUE(android_shm_queue_create(0, 4, 0) == nullptr);
+  ASSERT_EQ(EINVAL, errno);
+  errno = 0;
+  ASSERT_TRUE(android_shm_queue_create(16, 0, 0) == nullptr);
+  ASSERT_EQ(EINVAL, errno);
+  errno = 0;
+  ASSERT_TRUE(android_shm_queue_create(16, 4, 0x100) == nullptr);
+  ASSERT_EQ(EINVAL, errno);
+  errno = 0;
+  ASSERT_TRUE(android_shm_queue_create(SIZE_MAX, 4, 0) == nullptr);
+  ASSERT_EQ(EINVAL, errno);
+#else
+  GTEST_LOG_(INFO) << "This test does nothing.\n";
+#endif
+}
+
+TEST(shm_queue, android_shm_queue_try) {
+#if defined(__BIONIC__)
+  // Three messages get rounded up to four.
+  android_shm_queue* queue = android_shm_queue_create(100, 3, 0);
+  ASSERT_TRUE(queue != nullptr);
+  ASSERT_EQ(100U, android_shm_queue_get_message_size(queue));
+  ASSERT_NE(-1, android_shm_queue_get_fd(queue));
+
+  size_t size;
+  errno = 0;
+  ASSERT_TRUE(android_shm_queue_try_receive(queue, &size) == nullptr);
+  ASSERT_EQ(EAGAIN, errno);
+
+  void* messages[4];
+  for (size_t i = 0; i < 4; ++i) {
+    messages[i] = android_shm_queue_try_reserve(queue);
+    ASSERT_TRUE(messages[i] != nullptr);
+    ASSERT_EQ(0U, reinterpret_cast<uintptr_t>(messages[i]) % 16);
+    memset(messages[i], 'a' + i, 100);
+  }
+  errno = 0;
+  ASSERT_TRUE(android_shm_queue_try_reserve(queue) == nullptr);
+  ASSERT_EQ(EAGAIN, errno);
+
+  // Nothing can be received until the first message reserved is committed.
+  android_shm_queue_commit(queue, messages[1], 2);
+  ASSERT_TRUE(android_shm_queue_try_receive(queue, &size) == nullptr);
+  android_shm_queue_commit(queue, messages[0], 1);
+  android_shm_queue_commit(queue, messages[3], 100);
+  android_shm_queue_commit(queue, messages[2], 3);
+
+  for (size_t i = 0; i < 4; ++i) {
+    char* message = reinterpret_cast<char*>(android_shm_queue_try_receive(queue, &size));
+    ASSERT_TRUE(message != nullptr);
+    ASSERT_EQ(messages[i], message);
+    ASSERT_EQ(i == 3 ? 100U : i + 1, size);
+    ASSERT_EQ(static_cast<char>('a' + i), message[size - 1]);
+    android_shm_queue_release(queue, message);
+  }
+  ASSERT_TRUE(android_shm_queue_try_receive(queue, &size) == nullptr);
+
+  // The ring goes round again.
+  for (size_t lap = 0; lap < 10; ++lap) {
+    void* message = android_shm_queue_try_reserve(queue);
+    ASSERT_TRUE(message != nullptr);
+    android_shm_queue_commit(queue, message, 0);
+    ASSERT_EQ(message, android_shm_queue_try_receive(queue, &size));
+    ASSERT_EQ(0U, size);
+    android_shm_queue_release(queue, message);
+  }
+  android_shm_queue_close(queue);
+#else
+  GTEST_LOG_(INFO) << "This test does nothing.\n";
+#endif
+}
+
+TEST(shm_queue, android_shm_queue_timeout) {
+#if defined(__BIONIC__)
+  // One message gets rounded up to two.
+  android_shm_queue* queue = android_shm_queue_create(8, 1, ANDROID_SHM_QUEUE_SPSC);
+  ASSERT_TRUE(queue != nullptr);
+
+  size_t size;
+  timespec deadline = MonotonicDeadline(10);
+  errno = 0;
+  ASSERT_TRUE(android_shm_queue_receive(queue, &size, &deadline) == nullptr);
+  ASSERT_EQ(ETIMEDOUT, errno);
+  timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  ASSERT_TRUE(now.tv_sec > deadline.tv_sec ||
+              (now.tv_sec == deadline.tv_sec && now.tv_nsec >= deadline.tv_nsec));
+
+  timespec invalid = { 0, -1 };
+  errno = 0;
+  ASSERT_TRUE(android_shm_queue_receive(queue, &size, &invalid) == nullptr);
+  ASSERT_EQ(EINVAL, errno);
+
+  void* messages[2];
+  for (void*& message : messages) {
+    message = android_shm_queue_reserve(queue, nullptr);
+    ASSERT_TRUE(message != nullptr);
+    android_shm_queue_commit(queue, message, 8);
+  }
+  deadline = MonotonicDeadline(10);
+  errno = 0;
+  ASSERT_TRUE(android_shm_queue_reserve(queue, &deadline) == nullptr);
+  ASSERT_EQ(ETIMEDOUT, errno);
+  ASSERT_EQ(messages[0], android_shm_queue_receive(queue, &size, nullptr));
+  android_shm_queue_close(queue);
+#else
+  GTEST_LOG_(INFO) << "This test does nothing.\n";
+#endif
+}
+
+TEST(shm_queue, android_shm_queue_open) {
+#if defined(__BIONIC__)
+  android_shm_queue* queue = android_shm_queue_create(sizeof(TestMessage), 16, 0);
+  ASSERT_TRUE(queue != nullptr);
+  android_shm_queue* other = android_shm_queue_open(android_shm_queue_get_fd(queue));
+  ASSERT_TRUE(other != nullptr);
+  ASSERT_NE(android_shm_queue_get_fd(queue), android_shm_queue_get_fd(other));
+  ASSERT_EQ(sizeof(TestMessage), android_shm_queue_get_message_size(other));
+
+  // Two mappings of the same queue.
+  TestMessage* sent = reinterpret_cast<TestMessage*>(android_shm_queue_try_reserve(queue));
+  ASSERT_TRUE(sent != nullptr);
+  sent->producer = 1;
+  sent->sequence = 1234;
+  android_shm_queue_commit(queue, sent, sizeof(*sent));
+  size_t size;
+  TestMessage* received =
+      reinterpret_cast<TestMessage*>(android_shm_queue_try_receive(other, &size));
+  ASSERT_TRUE(received != nullptr);
+  ASSERT_NE(sent, received);
+  ASSERT_EQ(sizeof(TestMessage), size);
+  ASSERT_EQ(1234U, received->sequence);
+  android_shm_queue_release(other, received);
+  android_shm_queue_close(other);
+  android_shm_queue_close(queue);
+
+  // Things that aren't queues.
+  TemporaryFile tf;
+  errno = 0;
+  ASSERT_TRUE(android_shm_queue_open(tf.fd) == nullptr);
+  ASSERT_EQ(EINVAL, errno);
+  char garbage[4096];
+  memset(garbage, 0xff, sizeof(garbage));
+  ASSERT_EQ(static_cast<ssize_t>(sizeof(garbage)), write(tf.fd, garbage, sizeof(garbage)));
+  errno = 0;
+  ASSERT_TRUE(android_shm_queue_open(tf.fd) == nullptr);
+  ASSERT_EQ(EINVAL, errno);
+  errno = 0;
+  ASSERT_TRUE(android_shm_queue_open(-1) == nullptr);
+  ASSERT_EQ(EBADF, errno);
+#else
+  GTEST_LOG_(INFO) << "This test does nothing.\n";
+#endif
+}
+
+#if defined(__BIONIC__)
+static constexpr uint32_t kProducers = 3;
+static constexpr uint32_t kMessagesPerProducer = 20000;
+
+static int ProduceMessages(int fd, uint32_t producer) {
+  android_shm_queue* queue = android_shm_queue_open(fd);
+  if (queue == nullptr) return 1;
+  for (uint32_t i = 0; i < kMessagesPerProducer; ++i) {
+    TestMessage* message =
+        reinterpret_cast<TestMessage*>(android_shm_queue_reserve(queue, nullptr));
+    if (message == nullptr) return 2;
+    message->producer = producer;
+    message->sequence = i;
+    android_shm_queue_commit(queue, message, sizeof(*message));
+  }
+  android_shm_queue_close(queue);
+  return 0;
+}
+
+static void ConsumeMessages(android_shm_queue* queue) {
+  uint32_t next[kProducers] = {};
+  for (uint32_t i = 0; i < kProducers * kMessagesPerProducer; ++i) {
+    size_t size;
+    TestMessage* message =
+        reinterpret_cast<TestMessage*>(android_shm_queue_receive(queue, &size, nullptr));
+    ASSERT_TRUE(message != nullptr);
+    ASSERT_EQ(sizeof(TestMessage), size);
+    ASSERT_LT(message->producer, kProducers);
+    // Each producer's messages arrive in order.
+    ASSERT_EQ(next[message->producer]++, message->sequence);
+    android_shm_queue_release(queue, message);
+  }
+  for (uint32_t count : next) ASSERT_EQ(kMessagesPerProducer, count);
+}
+#endif
+
+TEST(shm_queue, android_shm_queue_cross_process) {
+#if defined(__BIONIC__)
+  // A small queue, so that producers have to wait for room.
+  android_shm_queue* queue = android_shm_queue_create(sizeof(TestMessage), 8, 0);
+  ASSERT_TRUE(queue != nullptr);
+  pid_t pids[kProducers];
+  for (uint32_t i = 0; i < kProducers; ++i) {
+    pids[i] = fork();
+    ASSERT_NE(-1, pids[i]);
+    if (pids[i] == 0) _exit(ProduceMessages(android_shm_queue_get_fd(queue), i));
+  }
+  ConsumeMessages(queue);
+  for (pid_t pid : pids) AssertChildExitedCleanly(pid);
+  size_t size;
+  ASSERT_TRUE(android_shm_queue_try_receive(queue, &size) == nullptr);
+  android_shm_queue_close(queue);
+#else
+  GTEST_LOG_(INFO) << "This test does nothing.\n";
+#endif
+}
+
+TEST(shm_queue, android_shm_queue_spsc_cross_process) {
+#if defined(__BIONIC__)
+  android_shm_queue* requests =
+      android_shm_queue_create(sizeof(uint64_t), 4, ANDROID_SHM_QUEUE_SPSC);
+  ASSERT_TRUE(requests != nullptr);
+  android_shm_queue* replies =
+      android_shm_queue_create(sizeof(uint64_t), 4, ANDROID_SHM_QUEUE_SPSC);
+  ASSERT_TRUE(replies != nullptr);
+
+  // The child doubles whatever it's sent, until it's sent zero.
+  pid_t pid = fork();
+  ASSERT_NE(-1, pid);
+  if (pid == 0) {
+    while (true) {
+      size_t size;
+      uint64_t* request =
+          reinterpret_cast<uint64_t*>(android_shm_queue_receive(requests, &size, nullptr));
+      if (request == nullptr || size != sizeof(uint64_t)) _exit(1);
+      uint64_t value = *request;
+      android_shm_queue_release(requests, request);
+      if (value == 0) _exit(0);
+      uint64_t* reply = reinterpret_cast<uint64_t*>(android_shm_queue_reserve(replies, nullptr));
+      if (reply == nullptr) _exit(2);
+      *reply = value * 2;
+      android_shm_queue_commit(replies, reply, sizeof(*reply));
+    }
+  }
+
+  for (uint64_t i = 1; i <= 10000; ++i) {
+    uint64_t* request = reinterpret_cast<uint64_t*>(android_shm_queue_reserve(requests, nullptr));
+    ASSERT_TRUE(request != nullptr);
+    *request = i;
+    android_shm_queue_commit(requests, request, sizeof(*request));
+    size_t size;
+    uint64_t* reply =
+        reinterpret_cast<uint64_t*>(android_shm_queue_receive(replies, &size, nullptr));
+    ASSERT_TRUE(reply != nullptr);
+    ASSERT_EQ(i * 2, *reply);
+    android_shm_queue_release(replies, reply);
+  }
+  uint64_t* request = reinterpret_cast<uint64_t*>(android_shm_queue_reserve(requests, nullptr));
+  ASSERT_TRUE(request != nullptr);
+  *request = 0;
+  android_shm_queue_commit(requests, request, sizeof(*request));
+  AssertChildExitedCleanly(pid);
+  android_shm_queue_close(replies);
+  android_shm_queue_close(requests);
+#else
+  GTEST_LOG_(INFO) << "This test does nothing.\n";
+#endif
+}
+
+class shm_queue_DeathTest : public BionicDeathTest {};
+
+TEST_F(shm_queue_DeathTest, android_shm_queue_commit_bad_message) {
+#if defined(__BIONIC__)
+  android_shm_queue* queue = android_shm_queue_create(16, 4, 0);
+  ASSERT_TRUE(queue != nullptr);
+  char* message = reinterpret_cast<char*>(android_shm_queue_try_reserve(queue));
+  ASSERT_TRUE(message != nullptr);
+  ASSERT_EXIT(android_shm_queue_commit(queue, message + 1, 1), testing::KilledBySignal(SIGABRT),
+              "isn't a message in queue");
+  ASSERT_EXIT(android_shm_queue_commit(queue, message, 17), testing::KilledBySignal(SIGABRT),
+              "message size 17 > 16");
+  android_shm_queue_close(queue);
+#else
+  GTEST_LOG_(INFO) << "This test does nothing.\n";
+#endif
+}
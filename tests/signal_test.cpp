@@ -15,6 +15,7 @@
  */
 
 #include <errno.h>
+#include <pthread.h>
 #include <signal.h>
 #include <sys/syscall.h>
 #include <sys/types.h>
@@ -527,3 +528,91 @@ TEST(signal, sigset) {
   ASSERT_EQ(0, sigprocmask(SIG_BLOCK, nullptr, &set));
   EXPECT_TRUE(sigismember(&set, SIGALRM));
 }
+
+#if defined(__BIONIC__)
+// The mask the kernel really has for this thread, rather than what sigprocmask reports.
+static bool KernelBlocks(int signal_number) {
+  // The kernel's sigset_t is 128 bits on mips, 64 bits everywhere else.
+  uint64_t mask[2];
+#if defined(__mips__)
+  syscall(SYS_rt_sigprocmask, SIG_BLOCK, nullptr, mask, sizeof(mask));
+#else
+  syscall(SYS_rt_sigprocmask, SIG_BLOCK, nullptr, mask, sizeof(mask[0]));
+#endif
+  return (mask[0] & (UINT64_C(1) << (signal_number - 1))) != 0;
+}
+
+static int g_defer_signals_handler_call_count = 0;
+#endif
+
+TEST(signal, android_defer_signals) {
+#if defined(__BIONIC__)
+  ScopedSignalHandler ssh(SIGUSR1, [](int) { ++g_defer_signals_handler_call_count; });
+  ScopedSignalMask mask;
+  g_defer_signals_handler_call_count = 0;
+
+  ASSERT_EQ(0, android_defer_signals_begin());
+  ASSERT_EQ(0, android_defer_signals_begin());
+  ASSERT_EQ(0, kill(getpid(), SIGUSR1));
+  ASSERT_EQ(0, g_defer_signals_handler_call_count);
+  ASSERT_TRUE(KernelBlocks(SIGUSR1));
+  ASSERT_FALSE(KernelBlocks(SIGSEGV));
+
+  // sigprocmask sees and changes the mask the region will restore.
+  sigset_t set;
+  ASSERT_EQ(0, sigprocmask(SIG_BLOCK, nullptr, &set));
+  ASSERT_FALSE(sigismember(&set, SIGUSR1));
+  sigemptyset(&set);
+  sigaddset(&set, SIGUSR2);
+  ASSERT_EQ(0, sigprocmask(SIG_BLOCK, &set, nullptr));
+  ASSERT_EQ(0, sigprocmask(SIG_BLOCK, nullptr, &set));
+  ASSERT_TRUE(sigismember(&set, SIGUSR2));
+  ASSERT_EQ(-1, sigprocmask(-1, &set, nullptr));
+  ASSERT_EQ(EINVAL, errno);
+
+  // Except that synchronous signals are never deferred, so blocking those is real.
+  sigemptyset(&set);
+  sigaddset(&set, SIGSEGV);
+  ASSERT_EQ(0, sigprocmask(SIG_BLOCK, &set, nullptr));
+  ASSERT_TRUE(KernelBlocks(SIGSEGV));
+  ASSERT_EQ(0, sigprocmask(SIG_UNBLOCK, &set, nullptr));
+  ASSERT_FALSE(KernelBlocks(SIGSEGV));
+
+  ASSERT_EQ(0, android_defer_signals_end());
+  ASSERT_EQ(0, g_defer_signals_handler_call_count);
+  ASSERT_EQ(0, android_defer_signals_end());
+  ASSERT_EQ(1, g_defer_signals_handler_call_count);
+  ASSERT_FALSE(KernelBlocks(SIGUSR1));
+  ASSERT_TRUE(KernelBlocks(SIGUSR2));
+
+  ASSERT_EQ(-1, android_defer_signals_end());
+  ASSERT_EQ(EINVAL, errno);
+#else
+  GTEST_LOG_(INFO) << "This test does nothing.\n";
+#endif
+}
+
+TEST(signal, android_defer_signals_pthread_create) {
+#if defined(__BIONIC__)
+  ScopedSignalMask mask;
+  sigset_t set;
+  sigemptyset(&set);
+  sigaddset(&set, SIGUSR2);
+  ASSERT_EQ(0, sigprocmask(SIG_BLOCK, &set, nullptr));
+
+  // A thread created in a region starts with the mask the region is deferring for.
+  ASSERT_EQ(0, android_defer_signals_begin());
+  pthread_t t;
+  ASSERT_EQ(0, pthread_create(&t, nullptr, [](void*) -> void* {
+    bool ok = KernelBlocks(SIGUSR2) && !KernelBlocks(SIGUSR1) &&
+              android_defer_signals_end() == -1;
+    return reinterpret_cast<void*>(ok);
+  }, nullptr));
+  void* result;
+  ASSERT_EQ(0, pthread_join(t, &result));
+  ASSERT_EQ(0, android_defer_signals_end());
+  ASSERT_TRUE(result != nullptr);
+#else
+  GTEST_LOG_(INFO) << "This test does nothing.\n";
+#endif
+}
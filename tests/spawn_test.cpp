@@ -0,0 +1,370 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <spawn.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "TemporaryFile.h"
+#include "utils.h"
+
+#include <android-base/file.h>
+#include <android-base/strings.h>
+
+#if defined(__GLIBC__)
+#define BIN_DIR "/bin/"
+#else
+#define BIN_DIR "/system/bin/"
+#endif
+
+TEST(spawn, posix_spawnattr_init_posix_spawnattr_destroy) {
+  posix_spawnattr_t sa;
+  ASSERT_EQ(0, posix_spawnattr_init(&sa));
+  ASSERT_EQ(0, posix_spawnattr_destroy(&sa));
+}
+
+TEST(spawn, posix_spawnattr_setflags_EINVAL) {
+  posix_spawnattr_t sa;
+  ASSERT_EQ(0, posix_spawnattr_init(&sa));
+  ASSERT_EQ(EINVAL, posix_spawnattr_setflags(&sa, ~0));
+  ASSERT_EQ(0, posix_spawnattr_destroy(&sa));
+}
+
+TEST(spawn, posix_spawnattr_getflags_posix_spawnattr_setflags) {
+  posix_spawnattr_t sa;
+  ASSERT_EQ(0, posix_spawnattr_init(&sa));
+
+  ASSERT_EQ(0, posix_spawnattr_setflags(&sa, POSIX_SPAWN_RESETIDS | POSIX_SPAWN_SETPGROUP));
+  short flags;
+  ASSERT_EQ(0, posix_spawnattr_getflags(&sa, &flags));
+  ASSERT_EQ(POSIX_SPAWN_RESETIDS | POSIX_SPAWN_SETPGROUP, flags);
+
+  ASSERT_EQ(0, posix_spawnattr_setflags(&sa, POSIX_SPAWN_SETSIGDEF | POSIX_SPAWN_SETSIGMASK |
+                                                 POSIX_SPAWN_SETSCHEDPARAM |
+                                                 POSIX_SPAWN_SETSCHEDULER | POSIX_SPAWN_USEVFORK |
+                                                 POSIX_SPAWN_SETSID));
+  ASSERT_EQ(0, posix_spawnattr_getflags(&sa, &flags));
+  ASSERT_EQ(POSIX_SPAWN_SETSIGDEF | POSIX_SPAWN_SETSIGMASK | POSIX_SPAWN_SETSCHEDPARAM |
+            POSIX_SPAWN_SETSCHEDULER | POSIX_SPAWN_USEVFORK | POSIX_SPAWN_SETSID, flags);
+
+  ASSERT_EQ(0, posix_spawnattr_destroy(&sa));
+}
+
+TEST(spawn, posix_spawnattr_getpgroup_posix_spawnattr_setpgroup) {
+  posix_spawnattr_t sa;
+  ASSERT_EQ(0, posix_spawnattr_init(&sa));
+
+  ASSERT_EQ(0, posix_spawnattr_setpgroup(&sa, 123));
+  pid_t g;
+  ASSERT_EQ(0, posix_spawnattr_getpgroup(&sa, &g));
+  ASSERT_EQ(123, g);
+
+  ASSERT_EQ(0, posix_spawnattr_destroy(&sa));
+}
+
+TEST(spawn, posix_spawnattr_getsigmask_posix_spawnattr_setsigmask) {
+  posix_spawnattr_t sa;
+  ASSERT_EQ(0, posix_spawnattr_init(&sa));
+
+  sigset_t sigs;
+  ASSERT_EQ(0, posix_spawnattr_getsigmask(&sa, &sigs));
+  ASSERT_FALSE(sigismember(&sigs, SIGALRM));
+
+  sigset_t just_SIGALRM;
+  sigemptyset(&just_SIGALRM);
+  sigaddset(&just_SIGALRM, SIGALRM);
+  ASSERT_EQ(0, posix_spawnattr_setsigmask(&sa, &just_SIGALRM));
+
+  ASSERT_EQ(0, posix_spawnattr_getsigmask(&sa, &sigs));
+  ASSERT_TRUE(sigismember(&sigs, SIGALRM));
+
+  ASSERT_EQ(0, posix_spawnattr_destroy(&sa));
+}
+
+TEST(spawn, posix_spawnattr_getsigdefault_posix_spawnattr_setsigdefault) {
+  posix_spawnattr_t sa;
+  ASSERT_EQ(0, posix_spawnattr_init(&sa));
+
+  sigset_t sigs;
+  ASSERT_EQ(0, posix_spawnattr_getsigdefault(&sa, &sigs));
+  ASSERT_FALSE(sigismember(&sigs, SIGALRM));
+
+  sigset_t just_SIGALRM;
+  sigemptyset(&just_SIGALRM);
+  sigaddset(&just_SIGALRM, SIGALRM);
+  ASSERT_EQ(0, posix_spawnattr_setsigdefault(&sa, &just_SIGALRM));
+
+  ASSERT_EQ(0, posix_spawnattr_getsigdefault(&sa, &sigs));
+  ASSERT_TRUE(sigismember(&sigs, SIGALRM));
+
+  ASSERT_EQ(0, posix_spawnattr_destroy(&sa));
+}
+
+TEST(spawn, posix_spawnattr_getsschedparam_posix_spawnattr_setschedparam) {
+  posix_spawnattr_t sa;
+  ASSERT_EQ(0, posix_spawnattr_init(&sa));
+
+  sched_param sp;
+  ASSERT_EQ(0, posix_spawnattr_getschedparam(&sa, &sp));
+  ASSERT_EQ(0, sp.sched_priority);
+
+  sched_param sp123 = { .sched_priority = 123 };
+  ASSERT_EQ(0, posix_spawnattr_setschedparam(&sa, &sp123));
+
+  ASSERT_EQ(0, posix_spawnattr_getschedparam(&sa, &sp));
+  ASSERT_EQ(123, sp.sched_priority);
+
+  ASSERT_EQ(0, posix_spawnattr_destroy(&sa));
+}
+
+TEST(spawn, posix_spawnattr_getschedpolicy_posix_spawnattr_setschedpolicy) {
+  posix_spawnattr_t sa;
+  ASSERT_EQ(0, posix_spawnattr_init(&sa));
+
+  int p;
+  ASSERT_EQ(0, posix_spawnattr_getschedpolicy(&sa, &p));
+  ASSERT_EQ(0, p);
+
+  ASSERT_EQ(0, posix_spawnattr_setschedpolicy(&sa, SCHED_FIFO));
+
+  ASSERT_EQ(0, posix_spawnattr_getschedpolicy(&sa, &p));
+  ASSERT_EQ(SCHED_FIFO, p);
+
+  ASSERT_EQ(0, posix_spawnattr_destroy(&sa));
+}
+
+TEST(spawn, posix_spawn_file_actions_init_posix_spawn_file_actions_destroy) {
+  posix_spawn_file_actions_t fa;
+  ASSERT_EQ(0, posix_spawn_file_actions_init(&fa));
+  ASSERT_EQ(0, posix_spawn_file_actions_addclose(&fa, 3));
+  ASSERT_EQ(0, posix_spawn_file_actions_addopen(&fa, 4, "/dev/null", O_RDONLY, 0));
+  ASSERT_EQ(0, posix_spawn_file_actions_adddup2(&fa, 5, 6));
+  ASSERT_EQ(0, posix_spawn_file_actions_destroy(&fa));
+}
+
+TEST(spawn, posix_spawn_file_actions_EBADF) {
+  posix_spawn_file_actions_t fa;
+  ASSERT_EQ(0, posix_spawn_file_actions_init(&fa));
+  ASSERT_EQ(EBADF, posix_spawn_file_actions_addclose(&fa, -1));
+  ASSERT_EQ(EBADF, posix_spawn_file_actions_addopen(&fa, -1, "/dev/null", O_RDONLY, 0));
+  ASSERT_EQ(EBADF, posix_spawn_file_actions_adddup2(&fa, -1, 6));
+  ASSERT_EQ(EBADF, posix_spawn_file_actions_adddup2(&fa, 5, -1));
+  ASSERT_EQ(0, posix_spawn_file_actions_destroy(&fa));
+}
+
+TEST(spawn, posix_spawn_basic) {
+  ExecTestHelper eth;
+  eth.SetArgs({"true", nullptr});
+  pid_t pid;
+  ASSERT_EQ(0, posix_spawn(&pid, BIN_DIR "true", nullptr, nullptr, eth.GetArgs(), nullptr));
+  AssertChildExited(pid, 0);
+}
+
+TEST(spawn, posix_spawn_args_and_env) {
+  ExecTestHelper eth;
+  eth.SetArgs({"sh", "-c", "exit $posix_spawn_args_and_env", nullptr});
+  eth.SetEnv({"posix_spawn_args_and_env=1", nullptr});
+  pid_t pid;
+  ASSERT_EQ(0, posix_spawn(&pid, BIN_DIR "sh", nullptr, nullptr, eth.GetArgs(), eth.GetEnv()));
+  AssertChildExited(pid, 1);
+}
+
+TEST(spawn, posix_spawnp_args_and_env) {
+  ExecTestHelper eth;
+  eth.SetArgs({"sh", "-c", "exit $posix_spawnp_args_and_env", nullptr});
+  eth.SetEnv({"posix_spawnp_args_and_env=1", nullptr});
+  pid_t pid;
+  ASSERT_EQ(0, posix_spawnp(&pid, "sh", nullptr, nullptr, eth.GetArgs(), eth.GetEnv()));
+  AssertChildExited(pid, 1);
+}
+
+TEST(spawn, posix_spawn_ENOENT) {
+  ExecTestHelper eth;
+  eth.SetArgs({"does-not-exist", nullptr});
+  int saved_errno = errno = 1234;
+  pid_t pid = 0;
+  ASSERT_EQ(ENOENT, posix_spawn(&pid, "/does/not/exist", nullptr, nullptr, eth.GetArgs(), nullptr));
+  ASSERT_EQ(saved_errno, errno);
+  ASSERT_EQ(0, pid);
+}
+
+TEST(spawn, posix_spawnp_ENOENT) {
+  ExecTestHelper eth;
+  eth.SetArgs({"does-not-exist", nullptr});
+  pid_t pid = 0;
+  ASSERT_EQ(ENOENT, posix_spawnp(&pid, "does-not-exist", nullptr, nullptr, eth.GetArgs(),
+                                 nullptr));
+}
+
+// Runs the given program with its stdout going to a pipe, and returns what it wrote.
+static void SpawnAndRead(const char* path, char* const argv[], const posix_spawnattr_t* sa,
+                         posix_spawn_file_actions_t* fa, std::string* output) {
+  int fds[2];
+  ASSERT_NE(-1, pipe2(fds, O_CLOEXEC));
+  ASSERT_EQ(0, posix_spawn_file_actions_adddup2(fa, fds[1], STDOUT_FILENO));
+
+  pid_t pid;
+  ASSERT_EQ(0, posix_spawn(&pid, path, fa, sa, argv, nullptr));
+  close(fds[1]);
+
+  output->clear();
+  char buf[BUFSIZ];
+  ssize_t bytes_read;
+  while ((bytes_read = TEMP_FAILURE_RETRY(read(fds[0], buf, sizeof(buf)))) > 0) {
+    output->append(buf, bytes_read);
+  }
+  close(fds[0]);
+  AssertChildExited(pid, 0);
+}
+
+TEST(spawn, posix_spawn_file_actions) {
+  TemporaryFile tf;
+  ASSERT_TRUE(android::base::WriteStringToFile("from the file\n", tf.filename));
+
+  posix_spawn_file_actions_t fa;
+  ASSERT_EQ(0, posix_spawn_file_actions_init(&fa));
+  // cat's stdin is the file, and its stdout is the pipe.
+  ASSERT_EQ(0, posix_spawn_file_actions_addclose(&fa, STDIN_FILENO));
+  ASSERT_EQ(0, posix_spawn_file_actions_addopen(&fa, STDIN_FILENO, tf.filename, O_RDONLY, 0));
+
+  ExecTestHelper eth;
+  eth.SetArgs({"cat", nullptr});
+  std::string output;
+  SpawnAndRead(BIN_DIR "cat", eth.GetArgs(), nullptr, &fa, &output);
+  ASSERT_EQ("from the file\n", output);
+
+  ASSERT_EQ(0, posix_spawn_file_actions_destroy(&fa));
+}
+
+TEST(spawn, posix_spawn_file_actions_failure) {
+  posix_spawn_file_actions_t fa;
+  ASSERT_EQ(0, posix_spawn_file_actions_init(&fa));
+  ASSERT_EQ(0, posix_spawn_file_actions_addopen(&fa, 3, "/does/not/exist", O_RDONLY, 0));
+
+  ExecTestHelper eth;
+  eth.SetArgs({"true", nullptr});
+  pid_t pid;
+  ASSERT_EQ(ENOENT, posix_spawn(&pid, BIN_DIR "true", &fa, nullptr, eth.GetArgs(), nullptr));
+
+  ASSERT_EQ(0, posix_spawn_file_actions_destroy(&fa));
+}
+
+// Returns the hex mask on the given line (such as "SigBlk:") of the child's /proc/self/status.
+static uint64_t ChildStatusMask(const posix_spawnattr_t* sa, const char* name) {
+  posix_spawn_file_actions_t fa;
+  EXPECT_EQ(0, posix_spawn_file_actions_init(&fa));
+  ExecTestHelper eth;
+  eth.SetArgs({"cat", "/proc/self/status", nullptr});
+  std::string output;
+  SpawnAndRead(BIN_DIR "cat", eth.GetArgs(), sa, &fa, &output);
+  EXPECT_EQ(0, posix_spawn_file_actions_destroy(&fa));
+
+  for (const std::string& line : android::base::Split(output, "\n")) {
+    if (android::base::StartsWith(line, name)) {
+      return strtoull(line.c_str() + strlen(name), nullptr, 16);
+    }
+  }
+  ADD_FAILURE() << "no " << name << " in " << output;
+  return 0;
+}
+
+static uint64_t SignalBit(int sig) {
+  return 1ULL << (sig - 1);
+}
+
+TEST(spawn, posix_spawn_POSIX_SPAWN_SETSIGMASK) {
+  // By default the child inherits the caller's signal mask...
+  sigset_t just_SIGALRM;
+  sigemptyset(&just_SIGALRM);
+  sigaddset(&just_SIGALRM, SIGALRM);
+  sigset_t old_mask;
+  ASSERT_EQ(0, sigprocmask(SIG_BLOCK, &just_SIGALRM, &old_mask));
+  EXPECT_EQ(SignalBit(SIGALRM), ChildStatusMask(nullptr, "SigBlk:") & SignalBit(SIGALRM));
+
+  // ...unless a mask is supplied.
+  posix_spawnattr_t sa;
+  ASSERT_EQ(0, posix_spawnattr_init(&sa));
+  ASSERT_EQ(0, posix_spawnattr_setflags(&sa, POSIX_SPAWN_SETSIGMASK));
+  sigset_t just_SIGCONT;
+  sigemptyset(&just_SIGCONT);
+  sigaddset(&just_SIGCONT, SIGCONT);
+  ASSERT_EQ(0, posix_spawnattr_setsigmask(&sa, &just_SIGCONT));
+  EXPECT_EQ(SignalBit(SIGCONT), ChildStatusMask(&sa, "SigBlk:"));
+  ASSERT_EQ(0, posix_spawnattr_destroy(&sa));
+
+  ASSERT_EQ(0, sigprocmask(SIG_SETMASK, &old_mask, nullptr));
+}
+
+TEST(spawn, posix_spawn_POSIX_SPAWN_SETSIGDEF) {
+  // Ignored signals stay ignored in the child...
+  sighandler_t old_handler = signal(SIGCONT, SIG_IGN);
+  EXPECT_EQ(SignalBit(SIGCONT), ChildStatusMask(nullptr, "SigIgn:") & SignalBit(SIGCONT));
+
+  // ...unless they're in the sigdefault set.
+  posix_spawnattr_t sa;
+  ASSERT_EQ(0, posix_spawnattr_init(&sa));
+  ASSERT_EQ(0, posix_spawnattr_setflags(&sa, POSIX_SPAWN_SETSIGDEF));
+  sigset_t just_SIGCONT;
+  sigemptyset(&just_SIGCONT);
+  sigaddset(&just_SIGCONT, SIGCONT);
+  ASSERT_EQ(0, posix_spawnattr_setsigdefault(&sa, &just_SIGCONT));
+  EXPECT_EQ(0U, ChildStatusMask(&sa, "SigIgn:") & SignalBit(SIGCONT));
+  ASSERT_EQ(0, posix_spawnattr_destroy(&sa));
+
+  signal(SIGCONT, old_handler);
+}
+
+TEST(spawn, posix_spawn_POSIX_SPAWN_SETPGROUP) {
+  posix_spawnattr_t sa;
+  ASSERT_EQ(0, posix_spawnattr_init(&sa));
+  ASSERT_EQ(0, posix_spawnattr_setflags(&sa, POSIX_SPAWN_SETPGROUP));
+  ASSERT_EQ(0, posix_spawnattr_setpgroup(&sa, 0));
+
+  ExecTestHelper eth;
+  eth.SetArgs({"true", nullptr});
+  pid_t pid;
+  ASSERT_EQ(0, posix_spawn(&pid, BIN_DIR "true", nullptr, &sa, eth.GetArgs(), nullptr));
+  // The child is the leader of its own new process group.
+  EXPECT_EQ(pid, getpgid(pid));
+  AssertChildExited(pid, 0);
+
+  ASSERT_EQ(0, posix_spawnattr_destroy(&sa));
+}
+
+static bool g_atfork_prepare_called = false;
+
+TEST(spawn, posix_spawn_does_not_run_atfork_handlers) {
+  ASSERT_EQ(0, pthread_atfork([]() { g_atfork_prepare_called = true; }, nullptr, nullptr));
+  g_atfork_prepare_called = false;
+
+  ExecTestHelper eth;
+  eth.SetArgs({"true", nullptr});
+  pid_t pid;
+  ASSERT_EQ(0, posix_spawn(&pid, BIN_DIR "true", nullptr, nullptr, eth.GetArgs(), nullptr));
+  AssertChildExited(pid, 0);
+  ASSERT_FALSE(g_atfork_prepare_called);
+}
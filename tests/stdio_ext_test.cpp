@@ -29,6 +29,8 @@
 #include <wchar.h>
 #include <locale.h>
 
+#include <string>
+
 #include "TemporaryFile.h"
 #include "utils.h"
 
@@ -162,3 +164,50 @@ TEST(stdio_ext, __fsetlocking_BYCALLER) {
   ASSERT_EQ(0, pthread_join(thread, nullptr));
   __fsetlocking(stdout, old_state);
 }
+
+TEST(stdio_ext, __fsetaccesspattern) {
+#if defined(__BIONIC__)
+  TemporaryFile tf;
+  ASSERT_EQ(4096, write(tf.fd, std::string(4096, 'x').data(), 4096));
+  struct stat st;
+  ASSERT_EQ(0, fstat(tf.fd, &st));
+
+  FILE* fp = fopen(tf.filename, "r");
+  ASSERT_TRUE(fp != nullptr);
+  errno = 0;
+  ASSERT_EQ(-1, __fsetaccesspattern(fp, 1234));
+  ASSERT_EQ(EINVAL, errno);
+
+  // A sequential stream gets a bigger buffer than the file's block size.
+  ASSERT_EQ(0, __fsetaccesspattern(fp, POSIX_FADV_SEQUENTIAL));
+  ASSERT_EQ('x', fgetc(fp));
+  ASSERT_GE(__fbufsize(fp), 64U * 1024U);
+  ASSERT_GE(__fbufsize(fp), static_cast<size_t>(st.st_blksize));
+  fclose(fp);
+
+  // A random-access one keeps the block size.
+  fp = fopen(tf.filename, "r");
+  ASSERT_TRUE(fp != nullptr);
+  ASSERT_EQ(0, __fsetaccesspattern(fp, POSIX_FADV_RANDOM));
+  ASSERT_EQ('x', fgetc(fp));
+  ASSERT_EQ(static_cast<size_t>(st.st_blksize), __fbufsize(fp));
+  fclose(fp);
+#else
+  GTEST_LOG_(INFO) << "This test tests bionic implementation details.\n";
+#endif
+}
+
+TEST(stdio_ext, __fsetaccesspattern_pipe) {
+#if defined(__BIONIC__)
+  // posix_fadvise fails with ESPIPE on a pipe, but the hint is only advisory.
+  int fds[2];
+  ASSERT_EQ(0, pipe(fds));
+  FILE* fp = fdopen(fds[0], "r");
+  ASSERT_TRUE(fp != nullptr);
+  ASSERT_EQ(0, __fsetaccesspattern(fp, POSIX_FADV_SEQUENTIAL));
+  fclose(fp);
+  close(fds[1]);
+#else
+  GTEST_LOG_(INFO) << "This test tests bionic implementation details.\n";
+#endif
+}
@@ -27,8 +27,11 @@
 #include <wchar.h>
 #include <locale.h>
 
+#include <string>
 #include <vector>
 
+#include <android-base/file.h>
+
 #include "BionicDeathTest.h"
 #include "TemporaryFile.h"
 
@@ -152,6 +155,34 @@ TEST(STDIO_TEST, getdelim) {
   fclose(fp);
 }
 
+TEST(STDIO_TEST, getline_long_lines) {
+  FILE* fp = tmpfile();
+  ASSERT_TRUE(fp != NULL);
+
+  // Lines much shorter and much longer than the FILE's buffer.
+  std::vector<std::string> lines;
+  for (size_t length : { 1, 100, 5000, 200000, 7, 1000000 }) {
+    std::string line;
+    for (size_t i = 0; i < length - 1; ++i) line += 'a' + i % 26;
+    lines.push_back(line + "\n");
+    ASSERT_NE(EOF, fputs(lines.back().c_str(), fp));
+  }
+  rewind(fp);
+
+  char* line_read = NULL;
+  size_t allocated_length = 0;
+  for (const std::string& line : lines) {
+    ASSERT_EQ(static_cast<ssize_t>(line.size()), getline(&line_read, &allocated_length, fp));
+    ASSERT_GT(allocated_length, line.size());
+    ASSERT_EQ(line, line_read);
+  }
+  ASSERT_EQ(-1, getline(&line_read, &allocated_length, fp));
+  ASSERT_TRUE(feof(fp));
+
+  free(line_read);
+  fclose(fp);
+}
+
 TEST(STDIO_TEST, getdelim_invalid) {
   FILE* fp = tmpfile();
   ASSERT_TRUE(fp != NULL);
@@ -627,6 +658,9 @@ TEST(STDIO_TEST, snprintf_utf8_15439554) {
   // 4-byte character.
   snprintf(buf, sizeof(buf), "%d\xf0\xa4\xad\xa2%d", 1, 2);
   EXPECT_STREQ("1𤭢2", buf);
+  // Positional arguments scan the format twice.
+  snprintf(buf, sizeof(buf), "a\xe2\x82\xac%2$d b\xc2\xa2%1$d c", 1, 2);
+  EXPECT_STREQ("a€2 b¢1 c", buf);
 
   uselocale(old_locale);
   freelocale(cloc);
@@ -666,6 +700,76 @@ TEST(STDIO_TEST, snprintf_asterisk_overflow) {
   ASSERT_EQ(ENOMEM, errno);
 }
 
+TEST(STDIO_TEST, snprintf_integer_flags) {
+  char buf[128];
+  snprintf(buf, sizeof(buf), "[%5d] [%-5d] [%05d] [%+d] [% d] [%+ d]", 42, 42, 42, 42, 42, 42);
+  EXPECT_STREQ("[   42] [42   ] [00042] [+42] [ 42] [+42]", buf);
+  snprintf(buf, sizeof(buf), "[%-05d] [%05.3d] [%.5d] [%.0d] [%8.3x] [%-8.3X]", -42, 42, -42, 0,
+           0xa, 0xb);
+  EXPECT_STREQ("[-42  ] [  042] [-00042] [] [     00a] [00B     ]", buf);
+  snprintf(buf, sizeof(buf), "[%#08x] [%#-8x] [%#x] [%#o] [%o]", 0x1f, 0x1f, 0, 8, 8);
+  EXPECT_STREQ("[0x00001f] [0x1f    ] [0] [010] [10]", buf);
+  snprintf(buf, sizeof(buf), "[%*d] [%*d] [%.*d] [%.*d]", 6, 1, -6, 2, 4, 3, -1, 4);
+  EXPECT_STREQ("[     1] [2     ] [0003] [4]", buf);
+  snprintf(buf, sizeof(buf), "%hd %hu %hhd %hhu", 70000, 70000, 300, 300);
+  EXPECT_STREQ("4464 4464 44 44", buf);
+  snprintf(buf, sizeof(buf), "%jd %zu %zd %td", static_cast<intmax_t>(-5), static_cast<size_t>(7),
+           static_cast<ssize_t>(-9), static_cast<ptrdiff_t>(-3));
+  EXPECT_STREQ("-5 7 -9 -3", buf);
+  snprintf(buf, sizeof(buf), "%llu %llx %llo", ULLONG_MAX, ULLONG_MAX, ULLONG_MAX);
+  EXPECT_STREQ("18446744073709551615 ffffffffffffffff 1777777777777777777777", buf);
+  snprintf(buf, sizeof(buf), "[%10.3s] [%-4c] [%3c]", "abcdef", 'x', 'y');
+  EXPECT_STREQ("[       abc] [x   ] [  y]", buf);
+}
+
+TEST(STDIO_TEST, snprintf_efg_rounding) {
+  char buf[128];
+  // Exact ties round to even.
+  snprintf(buf, sizeof(buf), "%.2f %.0f %.0f %.0f %.1e", 0.125, 0.5, 1.5, 2.5, 1.25);
+  EXPECT_STREQ("0.12 0 2 2 1.2e+00", buf);
+  snprintf(buf, sizeof(buf), "%.6e %.3g %.0e", 12345675.0, 1234500000.0, 25.0);
+  EXPECT_STREQ("1.234568e+07 1.23e+09 2e+01", buf);
+  // Carries into a new leading digit.
+  snprintf(buf, sizeof(buf), "%.2f %.3e %g %.1f", 9.999, 9.9996, 999999.5, -0.96);
+  EXPECT_STREQ("10.00 1.000e+01 1e+06 -1.0", buf);
+  snprintf(buf, sizeof(buf), "%f %e %g %g %g", 0.0, -0.0, 100.0, 1e-5, 123456789.0);
+  EXPECT_STREQ("0.000000 -0.000000e+00 100 1e-05 1.23457e+08", buf);
+  snprintf(buf, sizeof(buf), "%.17g %.17g %g %g", 0.1, 5e-324, 1.7976931348623157e308,
+           2.2250738585072014e-308);
+  EXPECT_STREQ("0.10000000000000001 4.9406564584124654e-324 1.79769e+308 2.22507e-308", buf);
+  snprintf(buf, sizeof(buf), "%.3f %.20f", 1e-10, 0.1);
+  EXPECT_STREQ("0.000 0.10000000000000000555", buf);
+}
+
+TEST(STDIO_TEST, snprintf_17g_round_trip) {
+  char buf[64];
+  uint64_t bits = 0x123456789abcdefULL;
+  for (size_t i = 0; i < 100000; ++i) {
+    bits = bits * 6364136223846793005ULL + 1442695040888963407ULL;
+    double d;
+    memcpy(&d, &bits, sizeof(d));
+    if (isnan(d) || isinf(d)) continue;
+    snprintf(buf, sizeof(buf), "%.17g", d);
+    ASSERT_EQ(d, strtod(buf, nullptr)) << buf;
+  }
+}
+
+TEST(STDIO_TEST, fprintf_larger_than_BUFSIZ) {
+  TemporaryFile tf;
+
+  FILE* tfile = fdopen(tf.fd, "r+");
+  ASSERT_TRUE(tfile != nullptr);
+
+  std::string s(3 * BUFSIZ, 'x');
+  ASSERT_EQ(static_cast<int>(s.size() + 2 * BUFSIZ + 2),
+            fprintf(tfile, "%s|%*d|", s.c_str(), 2 * BUFSIZ, 7));
+  ASSERT_EQ(0, fclose(tfile));
+
+  std::string content;
+  ASSERT_TRUE(android::base::ReadFileToString(tf.filename, &content));
+  ASSERT_EQ(s + "|" + std::string(2 * BUFSIZ - 1, ' ') + "7|", content);
+}
+
 TEST(STDIO_TEST, fprintf) {
   TemporaryFile tf;
 
@@ -1145,6 +1249,48 @@ TEST(STDIO_TEST, fwrite_after_fread_fast_path) {
   test_fwrite_after_fread(64*1024);
 }
 
+static void test_fwrite_buffered_then_large(int buffering, const char* mode) {
+  TemporaryFile tf;
+  ASSERT_EQ(3, write(tf.fd, "old", 3));
+
+  FILE* fp = fopen(tf.filename, mode);
+  ASSERT_TRUE(fp != nullptr);
+  ASSERT_EQ(0, setvbuf(fp, nullptr, buffering, 1024));
+
+  // Large writes when there's something in the buffer, which should go out together.
+  std::string expected;
+  std::string large(5000, 'x');
+  for (size_t i = 0; i < large.size(); i += 100) {
+    large[i] = '\n';
+  }
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_EQ(7, fprintf(fp, "header%d", i));
+    expected += "header" + std::to_string(i);
+    ASSERT_EQ(large.size(), fwrite(large.data(), 1, large.size(), fp));
+    expected += large;
+  }
+  ASSERT_EQ(0, fclose(fp));
+
+  if (strchr(mode, 'a') != nullptr) {
+    expected = "old" + expected;
+  }
+  std::string actual;
+  ASSERT_TRUE(android::base::ReadFileToString(tf.filename, &actual));
+  ASSERT_EQ(expected, actual);
+}
+
+TEST(STDIO_TEST, fwrite_buffered_then_large_IOFBF) {
+  test_fwrite_buffered_then_large(_IOFBF, "w");
+}
+
+TEST(STDIO_TEST, fwrite_buffered_then_large_IOLBF) {
+  test_fwrite_buffered_then_large(_IOLBF, "w");
+}
+
+TEST(STDIO_TEST, fwrite_buffered_then_large_append) {
+  test_fwrite_buffered_then_large(_IOFBF, "a");
+}
+
 // http://b/19172514
 TEST(STDIO_TEST, fread_after_fseek) {
   TemporaryFile tf;
@@ -1183,6 +1329,116 @@ TEST(STDIO_TEST, fread_after_fseek) {
   fclose(fp);
 }
 
+TEST(STDIO_TEST, fread_large_refills_buffer) {
+  TemporaryFile tf;
+  std::vector<char> file_data(64 * 1024);
+  for (size_t i = 0; i < file_data.size(); i++) {
+    file_data[i] = i * 7;
+  }
+  ASSERT_EQ(static_cast<ssize_t>(file_data.size()),
+            write(tf.fd, &file_data[0], file_data.size()));
+
+  FILE* fp = fopen(tf.filename, "r");
+  ASSERT_TRUE(fp != nullptr);
+
+  // A read larger than the buffer bypasses it, and whatever else the same read returns is
+  // left in the buffer for the small reads that follow.
+  std::vector<char> buf(file_data.size());
+  ASSERT_EQ(10000U, fread(&buf[0], 1, 10000, fp));
+  ASSERT_EQ(0, memcmp(&file_data[0], &buf[0], 10000));
+  ASSERT_EQ(10000, ftell(fp));
+  ASSERT_EQ(file_data[10000], static_cast<char>(fgetc(fp)));
+  ASSERT_EQ(100U, fread(&buf[0], 1, 100, fp));
+  ASSERT_EQ(0, memcmp(&file_data[10001], &buf[0], 100));
+  ASSERT_EQ(10101, ftell(fp));
+
+  ASSERT_EQ(0, fseek(fp, -101, SEEK_CUR));
+  ASSERT_EQ(20000U, fread(&buf[0], 1, 20000, fp));
+  ASSERT_EQ(0, memcmp(&file_data[10000], &buf[0], 20000));
+
+  // The rest of the file, asking for more than there is.
+  size_t rest = file_data.size() - 30000;
+  ASSERT_EQ(rest, fread(&buf[0], 1, buf.size(), fp));
+  ASSERT_EQ(0, memcmp(&file_data[30000], &buf[0], rest));
+  ASSERT_TRUE(feof(fp));
+
+  fclose(fp);
+}
+
+TEST(STDIO_TEST, fopen_mmap_mode) {
+  // Big enough to need several windows, and not a multiple of the page size.
+  TemporaryFile tf;
+  std::string file_data;
+  for (size_t i = 0; file_data.size() < 5 * 1024 * 1024; ++i) {
+    file_data += "line " + std::to_string(i) + "\n";
+  }
+  file_data += "no newline";
+  ASSERT_TRUE(android::base::WriteStringToFd(file_data, tf.fd));
+
+  FILE* fp = fopen(tf.filename, "rme");
+  ASSERT_TRUE(fp != nullptr);
+
+  // Line by line across window boundaries.
+  std::string read_back;
+  char* line = nullptr;
+  size_t line_capacity = 0;
+  ssize_t line_length;
+  while ((line_length = getline(&line, &line_capacity, fp)) != -1) {
+    read_back.append(line, line_length);
+  }
+  free(line);
+  ASSERT_TRUE(feof(fp));
+  ASSERT_EQ(file_data, read_back);
+  ASSERT_EQ(static_cast<long>(file_data.size()), ftell(fp));
+
+  // Seeking within and between windows, then reading with fread and getc.
+  std::vector<char> buf(3 * 1024 * 1024);
+  ASSERT_EQ(0, fseek(fp, 12345, SEEK_SET));
+  ASSERT_EQ(buf.size(), fread(&buf[0], 1, buf.size(), fp));
+  ASSERT_EQ(0, memcmp(&file_data[12345], &buf[0], buf.size()));
+  ASSERT_EQ(static_cast<long>(12345 + buf.size()), ftell(fp));
+  ASSERT_EQ(0, fseek(fp, -10, SEEK_CUR));
+  ASSERT_EQ(file_data[12345 + buf.size() - 10], static_cast<char>(getc(fp)));
+  ASSERT_EQ(0, fseek(fp, 7, SEEK_SET));
+  ASSERT_EQ(file_data[7], static_cast<char>(getc(fp)));
+  ASSERT_EQ('x', ungetc('x', fp));
+  ASSERT_EQ(7, ftell(fp));
+  ASSERT_EQ('x', getc(fp));
+  ASSERT_EQ(file_data[8], static_cast<char>(getc(fp)));
+
+  ASSERT_EQ(0, fclose(fp));
+}
+
+TEST(STDIO_TEST, fopen_mmap_mode_falls_back) {
+  // Files that can't be mapped just get a buffer.
+  FILE* fp = fopen("/proc/version", "rm");
+  ASSERT_TRUE(fp != nullptr);
+  char buf[BUFSIZ];
+  ASSERT_TRUE(fgets(buf, sizeof(buf), fp) != nullptr);
+  ASSERT_EQ(0, strncmp(buf, "Linux version ", 14));
+  ASSERT_EQ(0, fclose(fp));
+
+  int fds[2];
+  ASSERT_EQ(0, pipe(fds));
+  ASSERT_EQ(6, write(fds[1], "hello\n", 6));
+  close(fds[1]);
+  fp = fdopen(fds[0], "rm");
+  ASSERT_TRUE(fp != nullptr);
+  ASSERT_TRUE(fgets(buf, sizeof(buf), fp) != nullptr);
+  ASSERT_STREQ("hello\n", buf);
+  ASSERT_EQ(0, fclose(fp));
+
+  // As does a mapped stream given its own buffer.
+  TemporaryFile tf;
+  ASSERT_TRUE(android::base::WriteStringToFd("hello\nworld\n", tf.fd));
+  fp = fopen(tf.filename, "rm");
+  ASSERT_TRUE(fp != nullptr);
+  ASSERT_EQ(0, setvbuf(fp, nullptr, _IOFBF, 128));
+  ASSERT_TRUE(fgets(buf, sizeof(buf), fp) != nullptr);
+  ASSERT_STREQ("hello\n", buf);
+  ASSERT_EQ(0, fclose(fp));
+}
+
 // https://code.google.com/p/android/issues/detail?id=184847
 TEST(STDIO_TEST, fread_EOF_184847) {
   TemporaryFile tf;
@@ -1321,6 +1577,58 @@ TEST(STDIO_TEST, lots_of_concurrent_files) {
   }
 }
 
+TEST(STDIO_TEST, lots_of_concurrent_files_fflush_NULL) {
+  std::vector<TemporaryFile*> tfs;
+  std::vector<FILE*> fps;
+
+  for (size_t i = 0; i < 256; ++i) {
+    TemporaryFile* tf = new TemporaryFile;
+    tfs.push_back(tf);
+    FILE* fp = fopen(tf->filename, "w");
+    ASSERT_TRUE(fp != nullptr);
+    fps.push_back(fp);
+    // Mix in some read-only streams, and some closed ones for fopen to reuse.
+    if (i % 3 == 1) ASSERT_EQ(0, fclose(fopen(tf->filename, "r")));
+    if (i % 5 == 2) fps.push_back(fopen(tf->filename, "r"));
+    fprintf(fp, "hello %zu!\n", i);
+  }
+
+  ASSERT_EQ(0, fflush(nullptr));
+
+  for (size_t i = 0; i < 256; ++i) {
+    char expected[BUFSIZ];
+    snprintf(expected, sizeof(expected), "hello %zu!\n", i);
+    std::string content;
+    ASSERT_TRUE(android::base::ReadFileToString(tfs[i]->filename, &content));
+    ASSERT_EQ(expected, content);
+    delete tfs[i];
+  }
+  for (FILE* fp : fps) ASSERT_EQ(0, fclose(fp));
+}
+
+TEST(STDIO_TEST, freopen_after_fclose_then_fopen) {
+#if defined(__BIONIC__)
+  TemporaryFile tf;
+  FILE* fp = fopen(tf.filename, "w");
+  ASSERT_TRUE(fp != nullptr);
+  ASSERT_EQ(0, fclose(fp));
+
+  // Reopening a closed FILE must take it out of circulation, even though it was freed.
+  ASSERT_EQ(fp, freopen(tf.filename, "w", fp));
+  FILE* other = fopen(tf.filename, "r");
+  ASSERT_TRUE(other != nullptr);
+  ASSERT_NE(fp, other);
+
+  ASSERT_EQ(0, fclose(fp));
+  ASSERT_EQ(0, fclose(other));
+  fp = fopen(tf.filename, "r");
+  ASSERT_TRUE(fp != nullptr);
+  ASSERT_EQ(0, fclose(fp));
+#else
+  GTEST_LOG_(INFO) << "This test does nothing: freopen of a closed FILE is undefined in glibc.\n";
+#endif
+}
+
 static void AssertFileOffsetAt(FILE* fp, off64_t offset) {
   EXPECT_EQ(offset, ftell(fp));
   EXPECT_EQ(offset, ftello(fp));
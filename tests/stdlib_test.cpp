@@ -28,9 +28,19 @@
 #include <math.h>
 #include <pthread.h>
 #include <stdint.h>
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
 #include <sys/types.h>
 #include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <string>
+#include <thread>
+#include <vector>
 
 // The random number generator tests all set the seed, get four values, reset the seed and check
 // that they get the first two values repeated, and then reset the seed and check two more values
@@ -138,6 +148,74 @@ TEST(stdlib, mrand48) {
   EXPECT_EQ(795539493, mrand48());
 }
 
+TEST(stdlib, arc4random_buf_sizes) {
+#if defined(__BIONIC__)
+  // Cover the sizes that are copied out of the keystream buffer, the ones that are written to
+  // directly, and the ones that are a mix of both.
+  for (size_t n = 0; n < 2048; n += 7) {
+    std::vector<uint8_t> buf(n + 1, 0xa5);
+    arc4random_buf(buf.data(), n);
+    ASSERT_EQ(0xa5, buf[n]) << n;
+    if (n >= 32) {
+      ASSERT_FALSE(std::all_of(buf.begin(), buf.end() - 1, [](uint8_t b) { return b == 0xa5; }))
+          << n;
+      ASSERT_EQ(buf.end() - 1, std::search_n(buf.begin(), buf.end() - 1, 16, 0)) << n;
+    }
+  }
+#else
+  GTEST_LOG_(INFO) << "This test does nothing.\n";
+#endif
+}
+
+TEST(stdlib, arc4random_threads) {
+#if defined(__BIONIC__)
+  // Each thread has its own generator; they mustn't have been seeded alike.
+  std::vector<std::array<uint32_t, 8>> values(8);
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < values.size(); i++) {
+    threads.emplace_back([&values, i]() {
+      arc4random_buf(values[i].data(), sizeof(values[i]));
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  std::sort(values.begin(), values.end());
+  ASSERT_EQ(values.end(), std::adjacent_find(values.begin(), values.end()));
+#else
+  GTEST_LOG_(INFO) << "This test does nothing.\n";
+#endif
+}
+
+TEST(stdlib, arc4random_fork) {
+#if defined(__BIONIC__)
+  // Make sure this thread's generator is seeded before the fork.
+  arc4random();
+
+  int fds[2];
+  ASSERT_EQ(0, pipe(fds));
+  pid_t pid = fork();
+  ASSERT_NE(-1, pid) << strerror(errno);
+  if (pid == 0) {
+    uint32_t child_values[8];
+    arc4random_buf(child_values, sizeof(child_values));
+    _exit(write(fds[1], child_values, sizeof(child_values)) == sizeof(child_values) ? 0 : 1);
+  }
+  close(fds[1]);
+
+  uint32_t values[8];
+  arc4random_buf(values, sizeof(values));
+  uint32_t child_values[8];
+  ASSERT_EQ(static_cast<ssize_t>(sizeof(child_values)),
+            TEMP_FAILURE_RETRY(read(fds[0], child_values, sizeof(child_values))));
+  close(fds[0]);
+  AssertChildExited(pid, 0);
+  ASSERT_NE(0, memcmp(values, child_values, sizeof(values)));
+#else
+  GTEST_LOG_(INFO) << "This test does nothing.\n";
+#endif
+}
+
 TEST(stdlib, posix_memalign) {
   void* p;
 
@@ -198,6 +276,35 @@ TEST(stdlib, realpath) {
   free(p);
 }
 
+TEST(stdlib, realpath__symlinks_and_dot_dot) {
+  TemporaryDir td;
+  char base[PATH_MAX];
+  ASSERT_TRUE(realpath(td.dirname, base) != NULL);
+  std::string dir(td.dirname);
+  ASSERT_EQ(0, mkdir((dir + "/a").c_str(), 0700));
+  ASSERT_EQ(0, mkdir((dir + "/a/b").c_str(), 0700));
+  ASSERT_EQ(0, symlink("a/b", (dir + "/link").c_str()));
+  // The name /proc/self/fd gives a file that has been unlinked.
+  ASSERT_EQ(0, close(open((dir + "/a/f (deleted)").c_str(), O_CREAT | O_WRONLY, 0600)));
+
+  char buf[PATH_MAX];
+  ASSERT_STREQ((std::string(base) + "/a/b").c_str(), realpath((dir + "/link").c_str(), buf));
+  // ".." after a symlink is the parent of where it leads.
+  ASSERT_STREQ((std::string(base) + "/a").c_str(), realpath((dir + "/link/..").c_str(), buf));
+  ASSERT_STREQ(base, realpath((dir + "/./a//b/../..").c_str(), buf));
+  ASSERT_STREQ((std::string(base) + "/a/f (deleted)").c_str(),
+               realpath((dir + "/link/../f (deleted)").c_str(), buf));
+
+  errno = 0;
+  ASSERT_TRUE(realpath((dir + "/link/missing").c_str(), buf) == NULL);
+  ASSERT_EQ(ENOENT, errno);
+
+  ASSERT_EQ(0, unlink((dir + "/a/f (deleted)").c_str()));
+  ASSERT_EQ(0, unlink((dir + "/link").c_str()));
+  ASSERT_EQ(0, rmdir((dir + "/a/b").c_str()));
+  ASSERT_EQ(0, rmdir((dir + "/a").c_str()));
+}
+
 TEST(stdlib, qsort) {
   struct s {
     char name[16];
@@ -221,6 +328,85 @@ TEST(stdlib, qsort) {
   ASSERT_STREQ("charlie", entries[2].name);
 }
 
+// Keys padded to Size bytes, with the padding derived from the key so that a sort that only
+// moved part of an element is caught. The sizes cover each of qsort's swap paths.
+template <size_t Size>
+struct padded_key {
+  uint32_t key;
+  uint8_t padding[Size - sizeof(uint32_t)];
+
+  void set(uint32_t k) {
+    key = k;
+    for (size_t i = 0; i < sizeof(padding); ++i) padding[i] = k + i;
+  }
+  bool intact() const {
+    for (size_t i = 0; i < sizeof(padding); ++i) {
+      if (padding[i] != static_cast<uint8_t>(key + i)) return false;
+    }
+    return true;
+  }
+  static int compare(const void* lhs, const void* rhs) {
+    uint32_t a = reinterpret_cast<const padded_key*>(lhs)->key;
+    uint32_t b = reinterpret_cast<const padded_key*>(rhs)->key;
+    return (a > b) - (a < b);
+  }
+};
+
+template <size_t Size>
+static void CheckQsort(size_t count) {
+  SCOPED_TRACE(testing::Message() << "size " << Size << " count " << count);
+  std::vector<padded_key<Size>> v(count);
+  std::vector<uint32_t> expected(count);
+  for (int pattern = 0; pattern < 5; ++pattern) {
+    SCOPED_TRACE(testing::Message() << "pattern " << pattern);
+    for (size_t i = 0; i < count; ++i) {
+      switch (pattern) {
+        case 0: expected[i] = random(); break;
+        case 1: expected[i] = i; break;
+        case 2: expected[i] = count - i; break;
+        case 3: expected[i] = random() % 4; break;
+        case 4: expected[i] = (i < count / 2) ? i : count - i; break;
+      }
+      v[i].set(expected[i]);
+    }
+    qsort(v.data(), count, Size, padded_key<Size>::compare);
+    std::sort(expected.begin(), expected.end());
+    for (size_t i = 0; i < count; ++i) {
+      ASSERT_EQ(expected[i], v[i].key) << i;
+      ASSERT_TRUE(v[i].intact()) << i;
+    }
+  }
+}
+
+TEST(stdlib, qsort_patterns) {
+  srandom(1234);
+  for (size_t count : { 0, 1, 2, 3, 23, 24, 25, 128, 129, 1000, 10000 }) {
+    CheckQsort<4>(count);
+    CheckQsort<8>(count);
+    CheckQsort<12>(count);
+    CheckQsort<16>(count);
+    CheckQsort<40>(count);
+  }
+}
+
+TEST(stdlib, qsort_r) {
+  struct counter {
+    static int compare(const void* lhs, const void* rhs, void* arg) {
+      ++*reinterpret_cast<size_t*>(arg);
+      int a = *reinterpret_cast<const int*>(lhs);
+      int b = *reinterpret_cast<const int*>(rhs);
+      return (a > b) - (a < b);
+    }
+  };
+  std::vector<int> v(1000);
+  for (size_t i = 0; i < v.size(); ++i) v[i] = v.size() - i;
+
+  size_t comparisons = 0;
+  qsort_r(v.data(), v.size(), sizeof(int), counter::compare, &comparisons);
+  ASSERT_TRUE(std::is_sorted(v.begin(), v.end()));
+  ASSERT_GT(comparisons, 0U);
+}
+
 static void* TestBug57421_child(void* arg) {
   pthread_t main_thread = reinterpret_cast<pthread_t>(arg);
   pthread_join(main_thread, NULL);
@@ -368,6 +554,76 @@ TEST(stdlib, strtod_largest_subnormal) {
   ASSERT_EQ(-2.2250738585072014e-308, strtod("-2.2250738585072012e-308", NULL));
 }
 
+TEST(stdlib, strtod_rounding) {
+  // Exactly halfway between two doubles: round to even.
+  ASSERT_EQ(9007199254740992.0, strtod("9007199254740993", NULL));
+  ASSERT_EQ(9007199254740996.0, strtod("9007199254740995", NULL));
+  ASSERT_EQ(4503599627370496.0, strtod("4503599627370496.5", NULL));
+  ASSERT_EQ(4503599627370498.0, strtod("4503599627370497.5", NULL));
+  // Just above halfway, including in digits beyond the first 19.
+  ASSERT_EQ(9007199254740994.0, strtod("9007199254740993.0000000000001", NULL));
+  ASSERT_EQ(9007199254740994.0, strtod("9007199254740993000000000000001e-15", NULL));
+  // The same for float.
+  ASSERT_EQ(16777216.0f, strtof("16777217", NULL));
+  ASSERT_EQ(16777220.0f, strtof("16777219", NULL));
+  ASSERT_EQ(16777218.0f, strtof("16777217.000000000000000000001", NULL));
+  // Rounding to float directly, not via double.
+  ASSERT_EQ(1.0f, strtof("1.00000005960464477539062499", NULL));
+  ASSERT_EQ(1.00000011920928955078125f, strtof("1.00000005960464477539062501", NULL));
+
+  ASSERT_EQ(0.1, strtod("0.1", NULL));
+  ASSERT_EQ(1e23, strtod("1e23", NULL));
+  ASSERT_EQ(1.7976931348623157e308, strtod("1.7976931348623157e308", NULL));
+  ASSERT_EQ(3.4028235e38f, strtof("3.4028235e38", NULL));
+}
+
+TEST(stdlib, strtod_end_ptr) {
+  char* p;
+  ASSERT_EQ(325.0, strtod(" \t+3.25e2x", &p));
+  ASSERT_STREQ("x", p);
+  ASSERT_EQ(1.0, strtod("1e", &p));
+  ASSERT_STREQ("e", p);
+  ASSERT_EQ(1.0, strtod("1e+z", &p));
+  ASSERT_STREQ("e+z", p);
+  ASSERT_EQ(5.0, strtod("5.", &p));
+  ASSERT_STREQ("", p);
+  ASSERT_EQ(0.5f, strtof(".5.5", &p));
+  ASSERT_STREQ(".5", p);
+  ASSERT_EQ(0.0, strtod(".", &p));
+  ASSERT_STREQ(".", p);
+  ASSERT_EQ(0.0, strtod("-", &p));
+  ASSERT_STREQ("-", p);
+
+  ASSERT_TRUE(signbit(strtod("-0.000e10", &p)));
+  ASSERT_STREQ("", p);
+  ASSERT_TRUE(signbit(strtof("-0", &p)));
+  ASSERT_STREQ("", p);
+}
+
+TEST(stdlib, strtod_round_trip) {
+  // Values printed with enough precision must read back unchanged.
+  uint64_t bits = 0x123456789abcdef0ULL;
+  for (size_t i = 0; i < 100000; ++i) {
+    bits = bits * 6364136223846793005ULL + 1442695040888963407ULL;
+    double d;
+    memcpy(&d, &bits, sizeof(d));
+    if (!isfinite(d)) continue;
+
+    char buf[64];
+    snprintf(buf, sizeof(buf), "%.17g", d);
+    double result = strtod(buf, NULL);
+    ASSERT_EQ(0, memcmp(&d, &result, sizeof(d))) << buf;
+
+    float f;
+    uint32_t float_bits = bits >> 32;
+    memcpy(&f, &float_bits, sizeof(f));
+    if (!isfinite(f)) continue;
+    snprintf(buf, sizeof(buf), "%.9g", f);
+    float float_result = strtof(buf, NULL);
+    ASSERT_EQ(0, memcmp(&f, &float_result, sizeof(f))) << buf;
+  }
+}
+
 TEST(stdlib, quick_exit) {
   pid_t pid = fork();
   ASSERT_NE(-1, pid) << strerror(errno);
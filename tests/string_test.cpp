@@ -18,6 +18,7 @@
 
 #include <string.h>
 
+#include <ctype.h>
 #include <errno.h>
 #include <gtest/gtest.h>
 #include <malloc.h>
@@ -25,6 +26,7 @@
 #include <stdint.h>
 
 #include <algorithm>
+#include <string>
 #include <vector>
 
 #include "buffer_tests.h"
@@ -1005,6 +1007,34 @@ TEST(STRING_TEST, memmove_check) {
   }
 }
 
+// Sizes either side of where the x86_64 implementations switch to rep movsb
+// and non-temporal stores, copied in both directions with and without overlap.
+TEST(STRING_TEST, memmove_memset_strategy_boundaries) {
+  const size_t sizes[] = { 2047, 2048, 2049, 786431, 786432, 786433 };
+  const ptrdiff_t offsets[] = { -4096, -33, -1, 1, 33, 4096, 1024 * 1024 };
+  const size_t max_size = 786433;
+  const size_t buffer_size = 3 * 1024 * 1024;
+  std::vector<char> expected(buffer_size);
+  std::vector<char> actual(buffer_size);
+  char* base = actual.data() + 1024 * 1024;
+
+  for (size_t size : sizes) {
+    for (ptrdiff_t offset : offsets) {
+      for (size_t i = 0; i < buffer_size; ++i) expected[i] = actual[i] = (i * 7) % 251;
+      char* src = base;
+      char* dst = base + offset;
+      ASSERT_LE(static_cast<size_t>(dst + max_size - actual.data()), buffer_size);
+      std::vector<char> copy(src, src + size);
+      std::copy(copy.begin(), copy.end(), expected.begin() + (dst - actual.data()));
+      ASSERT_EQ(dst, memmove(dst, src, size));
+      ASSERT_TRUE(expected == actual) << size << " " << offset;
+    }
+    std::fill(expected.begin() + 5, expected.begin() + 5 + size, '#');
+    ASSERT_EQ(actual.data() + 5, memset(actual.data() + 5, '#', size));
+    ASSERT_TRUE(expected == actual) << size;
+  }
+}
+
 TEST(STRING_TEST, bcopy) {
   StringTestState<char> state(LARGE);
   for (size_t i = 0; i < state.n; i++) {
@@ -1340,6 +1370,55 @@ TEST(STRING_TEST, strcmp_overread) {
   RunCmpBufferOverreadTest(DoStrcmpTest, DoStrcmpFailTest);
 }
 
+// Fills buf with letters of alternating case, or the opposite cases if
+// flip is set, plus some punctuation just outside 'A'-'Z' and 'a'-'z'.
+static void FillCaseBuffer(uint8_t* buf, size_t len, bool flip) {
+  static const char kChars[] = "aBcDeFgHiJkLmNoPqRsTuVwXyZ@[`{";
+  for (size_t i = 0; i < len; ++i) {
+    char c = kChars[i % (sizeof(kChars) - 1)];
+    buf[i] = (flip && isalpha(c)) ? (c ^ 0x20) : c;
+  }
+}
+
+static void DoStrcasecmpTest(uint8_t* buf1, uint8_t* buf2, size_t len) {
+  if (len < 1) return;
+  FillCaseBuffer(buf1, len - 1, false);
+  FillCaseBuffer(buf2, len - 1, true);
+  buf1[len - 1] = buf2[len - 1] = '\0';
+  ASSERT_EQ(0, strcasecmp(reinterpret_cast<char*>(buf1), reinterpret_cast<char*>(buf2)));
+  ASSERT_EQ(0, strncasecmp(reinterpret_cast<char*>(buf1), reinterpret_cast<char*>(buf2), len));
+}
+
+static void DoStrcasecmpFailTest(uint8_t* buf1, uint8_t* buf2, size_t len1, size_t len2) {
+  // Different lengths.
+  size_t len = (len1 < len2) ? len1 : len2;
+  FillCaseBuffer(buf1, len1, false);
+  FillCaseBuffer(buf2, len2, true);
+  buf1[len1 - 1] = '\0';
+  buf2[len2 - 1] = '\0';
+  ASSERT_NE(0, strcasecmp(reinterpret_cast<char*>(buf1), reinterpret_cast<char*>(buf2)));
+
+  // A single different character at the end, which only compares
+  // differently once folded.
+  if (len > 1) {
+    buf1[len - 1] = buf2[len - 1] = '\0';
+    buf1[len - 2] = '[';
+    buf2[len - 2] = '{';
+    ASSERT_LT(strcasecmp(reinterpret_cast<char*>(buf1), reinterpret_cast<char*>(buf2)), 0);
+    ASSERT_GT(strncasecmp(reinterpret_cast<char*>(buf2), reinterpret_cast<char*>(buf1), len), 0);
+    ASSERT_EQ(0, strncasecmp(reinterpret_cast<char*>(buf1), reinterpret_cast<char*>(buf2),
+                             len - 2));
+  }
+}
+
+TEST(STRING_TEST, strcasecmp_align) {
+  RunCmpBufferAlignTest(MEDIUM, DoStrcasecmpTest, DoStrcasecmpFailTest, LargeSetIncrement);
+}
+
+TEST(STRING_TEST, strcasecmp_overread) {
+  RunCmpBufferOverreadTest(DoStrcasecmpTest, DoStrcasecmpFailTest);
+}
+
 static void DoMemcmpTest(uint8_t* buf1, uint8_t* buf2, size_t len) {
   memset(buf1, len+1, len);
   memset(buf2, len+1, len);
@@ -1398,6 +1477,104 @@ TEST(STRING_TEST, strchr_overread) {
   RunSingleBufferOverreadTest(DoStrchrTest);
 }
 
+static void DoStrrchrTest(uint8_t* buf, size_t len) {
+  if (len >= 1) {
+    char value = 32 + (len % 96);
+    char search_value = 33 + (len % 96);
+    memset(buf, value, len - 1);
+    buf[len-1] = '\0';
+    ASSERT_EQ(NULL, strrchr(reinterpret_cast<char*>(buf), search_value));
+    ASSERT_EQ(reinterpret_cast<char*>(&buf[len-1]), strrchr(reinterpret_cast<char*>(buf), '\0'));
+    if (len >= 2) {
+      buf[0] = search_value;
+      ASSERT_EQ(reinterpret_cast<char*>(&buf[0]), strrchr(reinterpret_cast<char*>(buf), search_value));
+      buf[len-2] = search_value;
+      ASSERT_EQ(reinterpret_cast<char*>(&buf[len-2]), strrchr(reinterpret_cast<char*>(buf), search_value));
+    }
+  }
+}
+
+TEST(STRING_TEST, strrchr_align) {
+  RunSingleBufferAlignTest(MEDIUM, DoStrrchrTest);
+}
+
+TEST(STRING_TEST, strrchr_overread) {
+  RunSingleBufferOverreadTest(DoStrrchrTest);
+}
+
+static void DoMemchrTest(uint8_t* buf, size_t len) {
+  if (len >= 1) {
+    int value = len % 128;
+    int search_value = (len % 128) + 1;
+    memset(buf, value, len);
+    ASSERT_EQ(NULL, memchr(buf, search_value, len));
+    buf[len-1] = search_value;
+    ASSERT_EQ(&buf[len-1], memchr(buf, search_value, len));
+    ASSERT_EQ(NULL, memchr(buf, search_value, len - 1));
+    buf[0] = search_value;
+    ASSERT_EQ(&buf[0], memchr(buf, search_value, len));
+  }
+}
+
+TEST(STRING_TEST, memchr_align) {
+  RunSingleBufferAlignTest(MEDIUM, DoMemchrTest);
+}
+
+TEST(STRING_TEST, memchr_overread) {
+  RunSingleBufferOverreadTest(DoMemchrTest);
+}
+
+static void DoMemrchrTest(uint8_t* buf, size_t len) {
+  if (len >= 1) {
+    int value = len % 128;
+    int search_value = (len % 128) + 1;
+    memset(buf, value, len);
+    ASSERT_EQ(NULL, memrchr(buf, search_value, len));
+    buf[0] = search_value;
+    ASSERT_EQ(&buf[0], memrchr(buf, search_value, len));
+    ASSERT_EQ(NULL, memrchr(buf + 1, search_value, len - 1));
+    buf[len-1] = search_value;
+    ASSERT_EQ(&buf[len-1], memrchr(buf, search_value, len));
+  }
+}
+
+TEST(STRING_TEST, memrchr_align) {
+  RunSingleBufferAlignTest(MEDIUM, DoMemrchrTest);
+}
+
+TEST(STRING_TEST, memrchr_overread) {
+  RunSingleBufferOverreadTest(DoMemrchrTest);
+}
+
+static void DoStrspnTest(uint8_t* buf, size_t len) {
+  if (len >= 1) {
+    char* str = reinterpret_cast<char*>(buf);
+    for (size_t i = 0; i < len - 1; i++) {
+      str[i] = "abc"[i % 3];
+    }
+    str[len-1] = '\0';
+    ASSERT_EQ(len - 1, strspn(str, "cba"));
+    ASSERT_EQ(len - 1, strcspn(str, "xyz"));
+    ASSERT_EQ(len - 1, strcspn(str, "x"));
+    ASSERT_EQ(NULL, strpbrk(str, "xyz"));
+    if (len >= 2) {
+      str[len-2] = 'x';
+      ASSERT_EQ(len - 2, strspn(str, "cba"));
+      ASSERT_EQ(len - 2, strcspn(str, "zyx"));
+      ASSERT_EQ(len - 2, strcspn(str, "x"));
+      ASSERT_EQ(&str[len-2], strpbrk(str, "zyx"));
+    }
+  }
+}
+
+TEST(STRING_TEST, strspn_align) {
+  RunSingleBufferAlignTest(MEDIUM, DoStrspnTest);
+}
+
+TEST(STRING_TEST, strspn_overread) {
+  RunSingleBufferOverreadTest(DoStrspnTest);
+}
+
 static void TestBasename(const char* in, const char* expected_out) {
   errno = 0;
   const char* out = basename(in);
@@ -1484,3 +1661,75 @@ TEST(STRING_TEST, strstr_smoke) {
   ASSERT_EQ(haystack + 1, strstr(haystack, "i"));
   ASSERT_EQ(haystack + 4, strstr(haystack, "da"));
 }
+
+static const char* naive_memmem(const char* haystack, size_t n, const char* needle, size_t m) {
+  for (size_t i = 0; i + m <= n; ++i) {
+    if (memcmp(haystack + i, needle, m) == 0) return haystack + i;
+  }
+  return nullptr;
+}
+
+TEST(STRING_TEST, memmem_strstr_random) {
+  // Small alphabets give lots of near misses for the first/last byte filter.
+  std::vector<char> haystack(8192 + 1);
+  std::vector<char> needle(300 + 1);
+  srandom(1234);
+  for (size_t iteration = 0; iteration < 2000; ++iteration) {
+    char alphabet = 1 + random() % 4;
+    size_t n = random() % ((iteration % 10 == 0) ? 8192 : 256);
+    size_t m = 1 + random() % ((iteration % 10 == 1) ? 300 : 20);
+    for (size_t i = 0; i < n; ++i) haystack[i] = 'a' + random() % alphabet;
+    for (size_t i = 0; i < m; ++i) needle[i] = 'a' + random() % alphabet;
+    if (n > m && iteration % 3 == 0) memcpy(&haystack[random() % (n - m + 1)], &needle[0], m);
+    haystack[n] = needle[m] = '\0';
+
+    const char* expected = naive_memmem(&haystack[0], n, &needle[0], m);
+    ASSERT_EQ(expected, memmem(&haystack[0], n, &needle[0], m)) << n << " " << m;
+    ASSERT_EQ(expected, strstr(&haystack[0], &needle[0])) << n << " " << m;
+  }
+}
+
+TEST(STRING_TEST, memmem_strstr_pathological) {
+  // Needles that match almost everywhere except at the end, which
+  // a naive search takes quadratic time over.
+  std::string haystack(1024 * 1024, 'a');
+  for (size_t m : {2, 16, 64, 255, 256, 257, 1000}) {
+    std::string needle(m - 1, 'a');
+    needle += 'b';
+    ASSERT_EQ(nullptr, memmem(haystack.data(), haystack.size(), needle.data(), needle.size()));
+    ASSERT_EQ(nullptr, strstr(haystack.c_str(), needle.c_str()));
+
+    std::string found = haystack + needle;
+    ASSERT_EQ(found.c_str() + haystack.size(),
+              memmem(found.data(), found.size(), needle.data(), needle.size()));
+    ASSERT_EQ(found.c_str() + haystack.size(), strstr(found.c_str(), needle.c_str()));
+  }
+}
+
+TEST(STRING_TEST, strcasestr) {
+  const char* haystack = "Content-Type: text/html; Content-Length: 42";
+  ASSERT_EQ(haystack, strcasestr(haystack, ""));
+  ASSERT_EQ(haystack, strcasestr(haystack, "CONTENT-type"));
+  ASSERT_EQ(haystack + 25, strcasestr(haystack, "content-LENGTH"));
+  ASSERT_EQ(haystack + 3, strcasestr(haystack, "T"));
+  ASSERT_EQ(nullptr, strcasestr(haystack, "content-encoding"));
+  // '[' and '{' are one case bit apart but aren't letters.
+  ASSERT_EQ(nullptr, strcasestr("a[b", "a{b"));
+
+  // Every alignment and length around the 16-byte blocks, with the match
+  // straddling the 4KiB windows too.
+  for (size_t offset : {0, 1, 15, 16, 17, 4090, 4095, 4096, 4100}) {
+    for (size_t m = 1; m < 40; ++m) {
+      std::string haystack(offset, 'x');
+      std::string needle;
+      for (size_t i = 0; i < m; ++i) needle += 'a' + (i % 26);
+      std::string upper = needle;
+      for (char& c : upper) c = toupper(c);
+      haystack += upper + "xyz";
+      ASSERT_EQ(haystack.c_str() + offset, strcasestr(haystack.c_str(), needle.c_str()))
+          << offset << " " << m;
+      needle.back() = '!';
+      ASSERT_EQ(nullptr, strcasestr(haystack.c_str(), needle.c_str())) << offset << " " << m;
+    }
+  }
+}
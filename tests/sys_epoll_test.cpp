@@ -20,8 +20,12 @@
 #include <fcntl.h>
 #include <signal.h>
 #include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <time.h>
 #include <unistd.h>
 
+#include <vector>
+
 TEST(sys_epoll, smoke) {
   int epoll_fd = epoll_create(1);
   ASSERT_NE(-1, epoll_fd) << strerror(errno);
@@ -72,3 +76,115 @@ TEST(sys_epoll, epoll_event_data) {
   close(fds[0]);
   close(fds[1]);
 }
+
+TEST(sys_epoll, epoll_pwait2) {
+#if defined(__BIONIC__)
+  int epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+  ASSERT_NE(-1, epoll_fd) << strerror(errno);
+  epoll_event events[1];
+
+  // A zero timeout polls.
+  timespec ts = { 0, 0 };
+  ASSERT_EQ(0, epoll_pwait2(epoll_fd, events, 1, &ts, NULL));
+
+  // A sub-millisecond timeout still waits at least that long.
+  ts.tv_nsec = 500000;
+  timespec start, end;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  sigset_t ss;
+  sigemptyset(&ss);
+  sigaddset(&ss, SIGPIPE);
+  ASSERT_EQ(0, epoll_pwait2(epoll_fd, events, 1, &ts, &ss));
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  int64_t elapsed_ns = (end.tv_sec - start.tv_sec) * 1000000000LL + (end.tv_nsec - start.tv_nsec);
+  ASSERT_GE(elapsed_ns, 500000);
+
+  // With no timeout, it returns as soon as there's an event.
+  int fd = eventfd(1, EFD_CLOEXEC);
+  epoll_event ev;
+  ev.events = EPOLLIN;
+  ev.data.fd = fd;
+  ASSERT_EQ(0, epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev));
+  ASSERT_EQ(1, epoll_pwait2(epoll_fd, events, 1, NULL, NULL));
+  ASSERT_EQ(fd, events[0].data.fd);
+
+  ts.tv_nsec = 1000000000;
+  errno = 0;
+  ASSERT_EQ(-1, epoll_pwait2(epoll_fd, events, 1, &ts, NULL));
+  ASSERT_EQ(EINVAL, errno);
+
+  close(fd);
+  close(epoll_fd);
+#else
+  GTEST_LOG_(INFO) << "This test does nothing.\n";
+#endif
+}
+
+#if defined(__BIONIC__)
+static void RunEpollCtlBatch(size_t count) {
+  int epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+  ASSERT_NE(-1, epoll_fd) << strerror(errno);
+
+  std::vector<int> fds(count);
+  std::vector<android_epoll_ctl> ops(count);
+  for (size_t i = 0; i < count; ++i) {
+    fds[i] = eventfd(1, EFD_CLOEXEC);
+    ASSERT_NE(-1, fds[i]) << strerror(errno);
+    ops[i].op = EPOLL_CTL_ADD;
+    ops[i].fd = fds[i];
+    ops[i].event.events = EPOLLIN | EPOLLONESHOT;
+    ops[i].event.data.u64 = i;
+    ops[i].result = -1;
+  }
+  ASSERT_EQ(0, android_epoll_ctl_batch(epoll_fd, ops.data(), count));
+  for (size_t i = 0; i < count; ++i) ASSERT_EQ(0, ops[i].result);
+
+  // Every fd fires once...
+  std::vector<epoll_event> events(count + 1);
+  std::vector<bool> seen(count);
+  size_t total = 0;
+  while (total < count) {
+    int n = epoll_wait(epoll_fd, events.data(), events.size(), 1000);
+    ASSERT_GT(n, 0);
+    for (int i = 0; i < n; ++i) {
+      ASSERT_FALSE(seen[events[i].data.u64]);
+      seen[events[i].data.u64] = true;
+    }
+    total += n;
+  }
+  ASSERT_EQ(0, epoll_wait(epoll_fd, events.data(), events.size(), 0));
+
+  // ...and again once re-armed.
+  for (size_t i = 0; i < count; ++i) ops[i].op = EPOLL_CTL_MOD;
+  ASSERT_EQ(0, android_epoll_ctl_batch(epoll_fd, ops.data(), count));
+  total = 0;
+  while (total < count) {
+    int n = epoll_wait(epoll_fd, events.data(), events.size(), 1000);
+    ASSERT_GT(n, 0);
+    total += n;
+  }
+
+  // Failures are reported per operation.
+  for (size_t i = 0; i < count; ++i) ops[i].op = (i % 2 == 0) ? EPOLL_CTL_DEL : EPOLL_CTL_ADD;
+  ASSERT_EQ(static_cast<int>(count / 2), android_epoll_ctl_batch(epoll_fd, ops.data(), count));
+  for (size_t i = 0; i < count; ++i) {
+    ASSERT_EQ((i % 2 == 0) ? 0 : EEXIST, ops[i].result) << i;
+  }
+  ASSERT_EQ(static_cast<int>(count), android_epoll_ctl_batch(-1, ops.data(), count));
+  for (size_t i = 0; i < count; ++i) ASSERT_EQ(EBADF, ops[i].result);
+
+  for (int fd : fds) close(fd);
+  close(epoll_fd);
+}
+#endif
+
+TEST(sys_epoll, android_epoll_ctl_batch) {
+#if defined(__BIONIC__)
+  // Small batches use epoll_ctl; larger ones may use io_uring, in more than one submission.
+  RunEpollCtlBatch(1);
+  RunEpollCtlBatch(16);
+  RunEpollCtlBatch(200);
+#else
+  GTEST_LOG_(INFO) << "This test does nothing.\n";
+#endif
+}
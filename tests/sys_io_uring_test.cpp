@@ -0,0 +1,173 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <gtest/gtest.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#if defined(__BIONIC__)
+#include <sys/io_uring.h>
+#endif
+
+
+#include "TemporaryFile.h"
+
+#if defined(__BIONIC__)
+// io_uring is new in Linux 5.1, and may be disabled.
+static bool HaveIoUring() {
+  io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  int fd = io_uring_setup(1, &params);
+  if (fd == -1) {
+    GTEST_LOG_(INFO) << "io_uring unavailable: " << strerror(errno) << "\n";
+    return false;
+  }
+  close(fd);
+  return true;
+}
+#endif
+
+TEST(sys_io_uring, io_uring_setup) {
+#if defined(__BIONIC__)
+  if (!HaveIoUring()) return;
+  io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  int fd = io_uring_setup(6, &params);
+  ASSERT_NE(-1, fd);
+  // The queue sizes are rounded up to a power of two.
+  ASSERT_EQ(8U, params.sq_entries);
+  ASSERT_GE(params.cq_entries, params.sq_entries);
+  close(fd);
+
+  errno = 0;
+  ASSERT_EQ(-1, io_uring_setup(0, &params));
+  ASSERT_EQ(EINVAL, errno);
+#else
+  GTEST_LOG_(INFO) << "This test does nothing.\n";
+#endif
+}
+
+TEST(sys_io_uring, android_io_uring_nop) {
+#if defined(__BIONIC__)
+  if (!HaveIoUring()) return;
+  android_io_uring* ring = android_io_uring_create(8, 0);
+  ASSERT_TRUE(ring != nullptr);
+  ASSERT_TRUE(android_io_uring_peek_cqe(ring) == nullptr);
+
+  // Fill the queue...
+  for (int i = 0; i < 8; ++i) {
+    io_uring_sqe* sqe = android_io_uring_get_sqe(ring);
+    ASSERT_TRUE(sqe != nullptr);
+    sqe->opcode = IORING_OP_NOP;
+    sqe->user_data = 100 + i;
+  }
+  ASSERT_TRUE(android_io_uring_get_sqe(ring) == nullptr);
+
+  // ...submit it, and get the completions back.
+  ASSERT_EQ(8, android_io_uring_submit(ring, 8));
+  for (int i = 0; i < 8; ++i) {
+    io_uring_cqe* cqe = android_io_uring_wait_cqe(ring);
+    ASSERT_TRUE(cqe != nullptr);
+    ASSERT_EQ(100U + i, cqe->user_data);
+    ASSERT_EQ(0, cqe->res);
+    android_io_uring_cqe_seen(ring, cqe);
+  }
+  ASSERT_TRUE(android_io_uring_peek_cqe(ring) == nullptr);
+
+  // The queue has room again.
+  ASSERT_TRUE(android_io_uring_get_sqe(ring) != nullptr);
+  ASSERT_EQ(1, android_io_uring_submit(ring, 0));
+  ASSERT_TRUE(android_io_uring_wait_cqe(ring) != nullptr);
+
+  android_io_uring_destroy(ring);
+#else
+  GTEST_LOG_(INFO) << "This test does nothing.\n";
+#endif
+}
+
+TEST(sys_io_uring, android_io_uring_read_write_fsync) {
+#if defined(__BIONIC__)
+  if (!HaveIoUring()) return;
+  TemporaryFile tf;
+  android_io_uring* ring = android_io_uring_create(4, 0);
+  ASSERT_TRUE(ring != nullptr);
+
+  char hello[] = "hello";
+  char world[] = "world";
+  iovec write_iov[2] = { { hello, 5 }, { world, 5 } };
+  io_uring_sqe* sqe = android_io_uring_get_sqe(ring);
+  sqe->opcode = IORING_OP_WRITEV;
+  sqe->fd = tf.fd;
+  sqe->addr = reinterpret_cast<uintptr_t>(write_iov);
+  sqe->len = 2;
+  sqe->off = 0;
+  sqe->user_data = 1;
+  ASSERT_EQ(1, android_io_uring_submit(ring, 1));
+  io_uring_cqe* cqe = android_io_uring_wait_cqe(ring);
+  ASSERT_TRUE(cqe != nullptr);
+  ASSERT_EQ(1U, cqe->user_data);
+  ASSERT_EQ(10, cqe->res);
+  android_io_uring_cqe_seen(ring, cqe);
+
+  sqe = android_io_uring_get_sqe(ring);
+  sqe->opcode = IORING_OP_FSYNC;
+  sqe->fd = tf.fd;
+  sqe->user_data = 2;
+  char buf[16] = {};
+  iovec read_iov = { buf, sizeof(buf) };
+  sqe = android_io_uring_get_sqe(ring);
+  sqe->opcode = IORING_OP_READV;
+  sqe->fd = tf.fd;
+  sqe->addr = reinterpret_cast<uintptr_t>(&read_iov);
+  sqe->len = 1;
+  sqe->off = 5;
+  sqe->user_data = 3;
+  ASSERT_EQ(2, android_io_uring_submit(ring, 2));
+  for (int i = 0; i < 2; ++i) {
+    cqe = android_io_uring_wait_cqe(ring);
+    ASSERT_TRUE(cqe != nullptr);
+    if (cqe->user_data == 2) {
+      ASSERT_EQ(0, cqe->res);
+    } else {
+      ASSERT_EQ(3U, cqe->user_data);
+      ASSERT_EQ(5, cqe->res);
+    }
+    android_io_uring_cqe_seen(ring, cqe);
+  }
+  ASSERT_STREQ("world", buf);
+
+  android_io_uring_destroy(ring);
+#else
+  GTEST_LOG_(INFO) << "This test does nothing.\n";
+#endif
+}
+
+TEST(sys_io_uring, android_io_uring_create_EINVAL) {
+#if defined(__BIONIC__)
+  if (!HaveIoUring()) return;
+  errno = 0;
+  ASSERT_TRUE(android_io_uring_create(0, 0) == nullptr);
+  ASSERT_EQ(EINVAL, errno);
+#else
+  GTEST_LOG_(INFO) << "This test does nothing.\n";
+#endif
+}
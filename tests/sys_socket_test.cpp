@@ -233,3 +233,112 @@ TEST(sys_socket, sendmmsg_error) {
   ASSERT_EQ(-1, sendmmsg(-1, NULL, 0, 0));
   ASSERT_EQ(EBADF, errno);
 }
+
+#if defined(__BIONIC__)
+// Returns a listening socket bound to the abstract name sock_path, with kClients connections
+// waiting to be accepted on it, and the client ends in clients.
+static constexpr size_t kClients = 3;
+static int ListenWithPending(const char* sock_path, int type, int* clients) {
+  int fd = socket(PF_UNIX, type, 0);
+  if (fd == -1) return -1;
+
+  struct sockaddr_un addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  strcpy(addr.sun_path + 1, sock_path);
+  if (bind(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) == -1 ||
+      listen(fd, kClients) == -1) {
+    close(fd);
+    return -1;
+  }
+  for (size_t i = 0; i < kClients; i++) {
+    clients[i] = socket(PF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (connect(clients[i], reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) == -1) {
+      close(fd);
+      return -1;
+    }
+  }
+  return fd;
+}
+#endif
+
+TEST(sys_socket, android_accept4_batch) {
+#if defined(__BIONIC__)
+  int clients[kClients];
+  int fd = ListenWithPending("test_accept4_batch", SOCK_STREAM | SOCK_NONBLOCK, clients);
+  ASSERT_NE(-1, fd) << strerror(errno);
+
+  int fds[8];
+  struct sockaddr_storage addrs[8];
+  ASSERT_EQ(static_cast<int>(kClients), android_accept4_batch(fd, fds, addrs, 8, SOCK_CLOEXEC));
+  for (size_t i = 0; i < kClients; i++) {
+    ASSERT_EQ(AF_UNIX, addrs[i].ss_family);
+    ASSERT_EQ(FD_CLOEXEC, fcntl(fds[i], F_GETFD) & FD_CLOEXEC);
+    ASSERT_EQ(1, write(clients[i], "x", 1));
+    char c;
+    ASSERT_EQ(1, read(fds[i], &c, 1));
+    close(fds[i]);
+    close(clients[i]);
+  }
+
+  // Nothing left to accept.
+  errno = 0;
+  ASSERT_EQ(-1, android_accept4_batch(fd, fds, nullptr, 8, 0));
+  ASSERT_EQ(EAGAIN, errno);
+  close(fd);
+#else
+  GTEST_LOG_(INFO) << "This test does nothing.\n";
+#endif
+}
+
+TEST(sys_socket, android_accept4_batch_blocking) {
+#if defined(__BIONIC__)
+  // With a blocking listener, the batch stops when the pending connections run out rather
+  // than waiting for more.
+  int clients[kClients];
+  int fd = ListenWithPending("test_accept4_batch_blocking", SOCK_STREAM, clients);
+  ASSERT_NE(-1, fd) << strerror(errno);
+
+  int fds[8];
+  ASSERT_EQ(static_cast<int>(kClients), android_accept4_batch(fd, fds, nullptr, 8, 0));
+  for (size_t i = 0; i < kClients; i++) {
+    close(fds[i]);
+    close(clients[i]);
+  }
+  close(fd);
+#else
+  GTEST_LOG_(INFO) << "This test does nothing.\n";
+#endif
+}
+
+TEST(sys_socket, android_accept4_batch_error) {
+#if defined(__BIONIC__)
+  int fds[1];
+  errno = 0;
+  ASSERT_EQ(-1, android_accept4_batch(-1, fds, nullptr, 1, 0));
+  ASSERT_EQ(EBADF, errno);
+#else
+  GTEST_LOG_(INFO) << "This test does nothing.\n";
+#endif
+}
+
+TEST(sys_socket, android_socket_batch) {
+#if defined(__BIONIC__)
+  int fds[4];
+  ASSERT_EQ(0, android_socket_batch(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0, fds, 4));
+  for (size_t i = 0; i < 4; i++) {
+    ASSERT_EQ(FD_CLOEXEC, fcntl(fds[i], F_GETFD) & FD_CLOEXEC);
+    int type;
+    socklen_t len = sizeof(type);
+    ASSERT_EQ(0, getsockopt(fds[i], SOL_SOCKET, SO_TYPE, &type, &len));
+    ASSERT_EQ(SOCK_DGRAM, type);
+    close(fds[i]);
+  }
+
+  errno = 0;
+  ASSERT_EQ(-1, android_socket_batch(-1, SOCK_DGRAM, 0, fds, 4));
+  ASSERT_EQ(EAFNOSUPPORT, errno);
+#else
+  GTEST_LOG_(INFO) << "This test does nothing.\n";
+#endif
+}
@@ -42,3 +42,45 @@ TEST(sys_sysinfo, sysinfo) {
   memset(&si, 0, sizeof(si));
   ASSERT_EQ(0, sysinfo(&si));
 }
+
+TEST(sys_sysinfo, get_nprocs_repeated) {
+  // The counts are cached; they should be stable across calls (barring hotplug).
+  int nprocs_conf = get_nprocs_conf();
+  for (size_t i = 0; i < 100; ++i) {
+    ASSERT_EQ(nprocs_conf, get_nprocs_conf());
+    ASSERT_GT(get_nprocs(), 0);
+    ASSERT_LE(get_nprocs(), nprocs_conf);
+  }
+}
+
+TEST(sys_sysinfo, android_get_cpu_topology) {
+#if defined(__BIONIC__)
+  const android_cpu_topology* topology = android_get_cpu_topology();
+  ASSERT_TRUE(topology != nullptr);
+  ASSERT_EQ(topology, android_get_cpu_topology());
+  ASSERT_EQ(get_nprocs_conf(), topology->cpu_count);
+  ASSERT_LE(topology->cluster_count, topology->cpu_count);
+
+  for (int i = 0; i < topology->cpu_count; ++i) {
+    const android_cpu_info& cpu = topology->cpus[i];
+    if (i > 0) ASSERT_LT(topology->cpus[i - 1].cpu, cpu.cpu);
+    ASSERT_GE(cpu.cache_count, 0);
+    ASSERT_LE(cpu.cache_count, ANDROID_CPU_MAX_CACHES);
+    for (int j = 0; j < cpu.cache_count; ++j) {
+      ASSERT_GE(cpu.caches[j].level, 1);
+    }
+  }
+
+  // sysconf()'s cache queries report the first CPU's caches.
+  const android_cpu_info& cpu0 = topology->cpus[0];
+  for (int j = 0; j < cpu0.cache_count; ++j) {
+    const android_cpu_cache& cache = cpu0.caches[j];
+    if (cache.level == 1 && cache.type == ANDROID_CPU_CACHE_DATA) {
+      ASSERT_EQ(static_cast<long>(cache.size), sysconf(_SC_LEVEL1_DCACHE_SIZE));
+      ASSERT_EQ(cache.line_size < 0 ? 0 : cache.line_size, sysconf(_SC_LEVEL1_DCACHE_LINESIZE));
+    }
+  }
+#else
+  GTEST_LOG_(INFO) << "This test does nothing.\n";
+#endif
+}
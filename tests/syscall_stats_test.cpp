@@ -0,0 +1,119 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <string>
+
+#include "TemporaryFile.h"
+
+#if defined(__BIONIC__)
+#include <android/syscall_stats.h>
+
+static constexpr uint64_t kCalls = 10;
+
+struct GetppidCalls {
+  pid_t tid;
+  uint64_t calls;
+};
+
+static void CountGetppidCalls(const android_syscall_stats* stats, void* arg) {
+  GetppidCalls* result = reinterpret_cast<GetppidCalls*>(arg);
+  if (stats->tid == result->tid && strcmp(stats->name, "getppid") == 0) {
+    result->calls += stats->calls;
+  }
+}
+
+// Returns how many times the thread tid has called getppid, or -1 if libc isn't instrumented.
+static int64_t GetppidCallsFor(pid_t tid) {
+  GetppidCalls result = { tid, 0 };
+  if (android_syscall_stats_iterate(CountGetppidCalls, &result) == -1) return -1;
+  return result.calls;
+}
+
+static void* CallGetppid(void*) {
+  for (uint64_t i = 0; i < kCalls; ++i) getppid();
+  return nullptr;
+}
+#endif
+
+// The statistics only come from libc_syscall_stats.so, so with the ordinary libc.so this only
+// checks that the functions fail properly.
+TEST(syscall_stats, android_syscall_stats_iterate) {
+#if defined(__BIONIC__)
+  errno = 0;
+  int64_t before = GetppidCallsFor(gettid());
+  if (before == -1) {
+    ASSERT_EQ(ENOSYS, errno);
+    GTEST_LOG_(INFO) << "This libc isn't instrumented.\n";
+    return;
+  }
+  CallGetppid(nullptr);
+  ASSERT_EQ(before + static_cast<int64_t>(kCalls), GetppidCallsFor(gettid()));
+
+  // A thread's counts are added to the exited threads' when it exits.
+  int64_t exited_before = GetppidCallsFor(0);
+  pthread_t thread;
+  ASSERT_EQ(0, pthread_create(&thread, nullptr, CallGetppid, nullptr));
+  ASSERT_EQ(0, pthread_join(thread, nullptr));
+  ASSERT_EQ(exited_before + static_cast<int64_t>(kCalls), GetppidCallsFor(0));
+
+  errno = 0;
+  ASSERT_EQ(-1, android_syscall_stats_iterate(nullptr, nullptr));
+  ASSERT_EQ(EINVAL, errno);
+#else
+  GTEST_LOG_(INFO) << "This test does nothing.\n";
+#endif
+}
+
+TEST(syscall_stats, android_syscall_stats_dump) {
+#if defined(__BIONIC__)
+  TemporaryFile tf;
+  errno = 0;
+  if (android_syscall_stats_dump(tf.fd) == -1) {
+    ASSERT_EQ(ENOSYS, errno);
+    GTEST_LOG_(INFO) << "This libc isn't instrumented.\n";
+    return;
+  }
+  // Our own getppid calls come out as "<tid> getppid <calls> <cycles>".
+  CallGetppid(nullptr);
+  ASSERT_EQ(0, ftruncate(tf.fd, 0));
+  ASSERT_EQ(0, lseek(tf.fd, 0, SEEK_SET));
+  ASSERT_EQ(0, android_syscall_stats_dump(tf.fd));
+
+  FILE* fp = fopen(tf.filename, "r");
+  ASSERT_TRUE(fp != nullptr);
+  std::string prefix = std::to_string(gettid()) + " getppid ";
+  bool found = false;
+  char line[256];
+  while (fgets(line, sizeof(line), fp) != nullptr) {
+    if (strncmp(line, prefix.c_str(), prefix.size()) == 0) found = true;
+  }
+  fclose(fp);
+  ASSERT_TRUE(found);
+
+  ASSERT_EQ(-1, android_syscall_stats_dump(-1));
+  ASSERT_EQ(EBADF, errno);
+#else
+  GTEST_LOG_(INFO) << "This test does nothing.\n";
+#endif
+}
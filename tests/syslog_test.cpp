@@ -0,0 +1,101 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <errno.h>
+#include <pthread.h>
+#include <sys/wait.h>
+#include <syslog.h>
+#include <unistd.h>
+
+TEST(syslog, smoke) {
+  openlog("syslog_test", 0, LOG_USER);
+  errno = ENOENT;
+  syslog(LOG_INFO, "%s: %m", "smoke");
+  ASSERT_EQ(LOG_UPTO(LOG_DEBUG), setlogmask(LOG_UPTO(LOG_ERR)));
+  syslog(LOG_DEBUG, "masked");
+  ASSERT_EQ(LOG_UPTO(LOG_ERR), setlogmask(LOG_UPTO(LOG_DEBUG)));
+  closelog();
+}
+
+#if defined(__BIONIC__)
+static constexpr int kThreads = 4;
+static constexpr int kMessagesPerThread = 500;
+
+static void* LogMessages(void*) {
+  for (int i = 0; i < kMessagesPerThread; ++i) {
+    syslog(LOG_DEBUG, "syslog_test message %d", i);
+  }
+  return nullptr;
+}
+
+static void LogFromThreads() {
+  pthread_t threads[kThreads];
+  for (pthread_t& thread : threads) {
+    ASSERT_EQ(0, pthread_create(&thread, nullptr, LogMessages, nullptr));
+  }
+  for (pthread_t& thread : threads) {
+    ASSERT_EQ(0, pthread_join(thread, nullptr));
+  }
+}
+#endif
+
+TEST(syslog, android_syslog_set_async) {
+#if defined(__BIONIC__)
+  android_syslog_async_stats stats;
+  android_syslog_get_async_stats(&stats);
+  ASSERT_EQ(0U, stats.written + stats.dropped + stats.written_directly);
+
+  errno = 0;
+  ASSERT_EQ(-1, android_syslog_set_async(0, 0));
+  ASSERT_EQ(EINVAL, errno);
+  ASSERT_EQ(-1, android_syslog_set_async(16, 0x100));
+  ASSERT_EQ(EINVAL, errno);
+
+  // A small queue, so some messages should be dropped.
+  ASSERT_EQ(0, android_syslog_set_async(16, ANDROID_SYSLOG_ASYNC_REPORT_DROPS));
+  ASSERT_EQ(-1, android_syslog_set_async(16, 0));
+  ASSERT_EQ(EBUSY, errno);
+
+  LogFromThreads();
+  android_syslog_flush();
+  android_syslog_get_async_stats(&stats);
+  ASSERT_EQ(static_cast<uint64_t>(kThreads * kMessagesPerThread), stats.written + stats.dropped);
+  ASSERT_EQ(0U, stats.written_directly);
+
+  // A forked child doesn't have the parent's thread, so it starts over.
+  pid_t pid = fork();
+  ASSERT_NE(-1, pid);
+  if (pid == 0) {
+    android_syslog_get_async_stats(&stats);
+    if (stats.written != 0) _exit(1);
+    if (android_syslog_set_async(16, ANDROID_SYSLOG_ASYNC_WRITE_WHEN_FULL) != 0) _exit(2);
+    LogFromThreads();
+    android_syslog_flush();
+    android_syslog_get_async_stats(&stats);
+    if (stats.dropped != 0) _exit(3);
+    if (stats.written + stats.written_directly != kThreads * kMessagesPerThread) _exit(4);
+    _exit(0);
+  }
+  int status;
+  ASSERT_EQ(pid, waitpid(pid, &status, 0));
+  ASSERT_TRUE(WIFEXITED(status));
+  ASSERT_EQ(0, WEXITSTATUS(status));
+#else
+  GTEST_LOG_(INFO) << "This test does nothing.\n";
+#endif
+}
@@ -259,6 +259,142 @@ TEST(properties, find_nth) {
 #endif // __BIONIC__
 }
 
+TEST(properties, get_batch) {
+#if defined(__BIONIC__)
+    LocalPropertyTestState pa;
+    ASSERT_TRUE(pa.valid);
+
+    ASSERT_EQ(0, __system_property_add("ro.a.x", 6, "1", 1));
+    ASSERT_EQ(0, __system_property_add("ro.a.y", 6, "22", 2));
+    ASSERT_EQ(0, __system_property_add("ro.b", 4, "333", 3));
+    ASSERT_EQ(0, __system_property_add("sys.a.x", 7, "4444", 4));
+
+    // Out of order, with duplicates and names that don't exist.
+    const char* names[] = { "sys.a.x", "ro.a.y", "ro.a", "ro.b", "ro.a.x", "ro.a.y", "ro.a.z", "x" };
+    const size_t count = sizeof(names) / sizeof(names[0]);
+    char buffers[count][PROP_VALUE_MAX];
+    char* values[count];
+    for (size_t i = 0; i < count; ++i) {
+        memset(buffers[i], 'x', PROP_VALUE_MAX);
+        values[i] = buffers[i];
+    }
+
+    ASSERT_EQ(5, __system_property_get_batch(names, values, count));
+    for (size_t i = 0; i < count; ++i) {
+        char expected[PROP_VALUE_MAX];
+        __system_property_get(names[i], expected);
+        ASSERT_STREQ(expected, values[i]) << names[i];
+    }
+    ASSERT_STREQ("4444", values[0]);
+    ASSERT_STREQ("", values[2]);
+
+    ASSERT_EQ(0, __system_property_get_batch(names, values, 0));
+#else // __BIONIC__
+    GTEST_LOG_(INFO) << "This test does nothing.\n";
+#endif // __BIONIC__
+}
+
+TEST(properties, watch) {
+#if defined(__BIONIC__)
+    LocalPropertyTestState pa;
+    ASSERT_TRUE(pa.valid);
+
+    ASSERT_EQ(0, __system_property_add("other", 5, "x", 1));
+
+    // Watching a property that doesn't exist yet...
+    prop_watch watch;
+    __system_property_watch_init(&watch, "property");
+    ASSERT_FALSE(__system_property_watch_changed(&watch));
+    ASSERT_STREQ("", __system_property_watch_get(&watch));
+
+    // ...notices when it's added.
+    ASSERT_EQ(0, __system_property_add("property", 8, "value1", 6));
+    ASSERT_TRUE(__system_property_watch_changed(&watch));
+    ASSERT_STREQ("value1", __system_property_watch_get(&watch));
+    ASSERT_FALSE(__system_property_watch_changed(&watch));
+
+    // Once it exists, other properties changing don't count.
+    prop_info* other = const_cast<prop_info*>(__system_property_find("other"));
+    ASSERT_EQ(0, __system_property_update(other, "y", 1));
+    ASSERT_FALSE(__system_property_watch_changed(&watch));
+
+    prop_info* pi = const_cast<prop_info*>(__system_property_find("property"));
+    ASSERT_EQ(0, __system_property_update(pi, "value2", 6));
+    ASSERT_TRUE(__system_property_watch_changed(&watch));
+    ASSERT_TRUE(__system_property_watch_update(&watch));
+    ASSERT_FALSE(__system_property_watch_changed(&watch));
+    ASSERT_STREQ("value2", watch.value);
+#else // __BIONIC__
+    GTEST_LOG_(INFO) << "This test does nothing.\n";
+#endif // __BIONIC__
+}
+
+TEST(properties, long_value) {
+#if defined(__BIONIC__)
+    LocalPropertyTestState pa;
+    ASSERT_TRUE(pa.valid);
+
+    std::string long_value(1000, 'x');
+    long_value[0] = 'a';
+    ASSERT_EQ(0, __system_property_add("ro.long", 7, long_value.c_str(), long_value.size()));
+    ASSERT_EQ(0, __system_property_add("ro.short", 8, "value", 5));
+    // Only read-only properties can have long values.
+    ASSERT_EQ(-1, __system_property_add("long", 4, long_value.c_str(), long_value.size()));
+    ASSERT_EQ(-1, __system_property_add("ro.too_long", 11, long_value.c_str(),
+                                        PROP_LONG_VALUE_MAX + 1));
+
+    const prop_info* pi = __system_property_find("ro.long");
+    ASSERT_TRUE(pi != nullptr);
+    size_t len;
+    const char* value = __system_property_value_ptr(pi, &len);
+    ASSERT_TRUE(value != nullptr);
+    ASSERT_EQ(long_value.size(), len);
+    ASSERT_EQ(long_value, std::string(value, len));
+    ASSERT_EQ('\0', value[len]);
+
+    // The copying API gets as much of it as fits.
+    char propvalue[PROP_VALUE_MAX];
+    ASSERT_EQ(PROP_VALUE_MAX - 1, __system_property_get("ro.long", propvalue));
+    ASSERT_EQ(long_value.substr(0, PROP_VALUE_MAX - 1), propvalue);
+
+    ASSERT_EQ(-1, __system_property_update(const_cast<prop_info*>(pi), "x", 1));
+
+    value = __system_property_value_ptr(__system_property_find("ro.short"), &len);
+    ASSERT_TRUE(value != nullptr);
+    ASSERT_EQ(5U, len);
+    ASSERT_STREQ("value", value);
+
+    ASSERT_EQ(0, __system_property_add("short", 5, "value", 5));
+    ASSERT_TRUE(__system_property_value_ptr(__system_property_find("short"), &len) == nullptr);
+#else // __BIONIC__
+    GTEST_LOG_(INFO) << "This test does nothing.\n";
+#endif // __BIONIC__
+}
+
+TEST(properties, find_repeated) {
+#if defined(__BIONIC__)
+    LocalPropertyTestState pa;
+    ASSERT_TRUE(pa.valid);
+
+    // Repeated lookups, hits and misses, must notice properties being added.
+    for (size_t i = 0; i < 3; ++i) {
+        ASSERT_TRUE(__system_property_find("property") == nullptr);
+    }
+    ASSERT_EQ(0, __system_property_add("property", 8, "value1", 6));
+    const prop_info* pi = __system_property_find("property");
+    ASSERT_TRUE(pi != nullptr);
+    for (size_t i = 0; i < 3; ++i) {
+        ASSERT_EQ(pi, __system_property_find("property"));
+    }
+    ASSERT_TRUE(__system_property_find("property2") == nullptr);
+    ASSERT_EQ(0, __system_property_add("property2", 9, "value2", 6));
+    ASSERT_TRUE(__system_property_find("property2") != nullptr);
+    ASSERT_EQ(pi, __system_property_find("property"));
+#else // __BIONIC__
+    GTEST_LOG_(INFO) << "This test does nothing.\n";
+#endif // __BIONIC__
+}
+
 TEST(properties, fill_hierarchical) {
 #if defined(__BIONIC__)
     LocalPropertyTestState pa;
@@ -382,6 +518,59 @@ TEST(properties, wait) {
 #endif // __BIONIC__
 }
 
+TEST(properties, wait_one) {
+#if defined(__BIONIC__)
+    LocalPropertyTestState pa;
+    ASSERT_TRUE(pa.valid);
+
+    ASSERT_EQ(0, __system_property_add("property", 8, "value1", 6));
+    ASSERT_EQ(0, __system_property_add("other", 5, "value1", 6));
+    prop_info* pi = const_cast<prop_info*>(__system_property_find("property"));
+    ASSERT_TRUE(pi != nullptr);
+    prop_info* other = const_cast<prop_info*>(__system_property_find("other"));
+    ASSERT_TRUE(other != nullptr);
+
+    // Nothing changes, so we time out.
+    uint32_t serial = __system_property_serial(pi);
+    uint32_t new_serial = 0;
+    timespec timeout = { 0, 10000000 };
+    ASSERT_FALSE(__system_property_wait(pi, serial, &new_serial, &timeout));
+    ASSERT_EQ(0U, new_serial);
+
+    // An update to another property doesn't wake us either...
+    ASSERT_EQ(0, __system_property_update(other, "value2", 6));
+    ASSERT_FALSE(__system_property_wait(pi, serial, &new_serial, &timeout));
+
+    // ...but it does count for the global serial.
+    ASSERT_TRUE(__system_property_wait(nullptr, 0, &new_serial, &timeout));
+    ASSERT_NE(0U, new_serial);
+
+    // An update that has already happened returns straight away.
+    ASSERT_EQ(0, __system_property_update(pi, "value2", 6));
+    ASSERT_TRUE(__system_property_wait(pi, serial, &new_serial, nullptr));
+    ASSERT_EQ(__system_property_serial(pi), new_serial);
+    serial = new_serial;
+
+    // And one from another thread wakes us.
+    int flag = 0;
+    pthread_t t;
+    ASSERT_EQ(0, pthread_create(&t, NULL, PropertyWaitHelperFn, &flag));
+    ASSERT_TRUE(__system_property_wait(pi, serial, &new_serial, nullptr));
+    ASSERT_EQ(1, flag);
+    ASSERT_NE(serial, new_serial);
+    ASSERT_FALSE(SERIAL_DIRTY(new_serial));
+
+    char value[PROP_VALUE_MAX];
+    ASSERT_EQ(6, __system_property_read(pi, nullptr, value));
+    ASSERT_STREQ("value3", value);
+
+    void* result;
+    ASSERT_EQ(0, pthread_join(t, &result));
+#else // __BIONIC__
+    GTEST_LOG_(INFO) << "This test does nothing.\n";
+#endif // __BIONIC__
+}
+
 class KilledByFault {
     public:
         explicit KilledByFault() {};
@@ -20,6 +20,7 @@
 #include <gtest/gtest.h>
 #include <pthread.h>
 #include <signal.h>
+#include <string.h>
 #include <sys/syscall.h>
 #include <sys/types.h>
 #include <sys/wait.h>
@@ -143,6 +144,49 @@ TEST(time, mktime_EOVERFLOW) {
   ASSERT_EQ(EOVERFLOW, errno);
 }
 
+TEST(time, localtime_r_transitions_and_tzset) {
+  // localtime_r remembers the last UTC offset interval it used; check it doesn't reuse it
+  // across a transition or a change of zone.
+  setenv("TZ", "America/Los_Angeles", 1);
+  tzset();
+
+  // 2017-03-12 10:00:00 UTC, when Los Angeles went from PST to PDT.
+  time_t t = 1489312800;
+  struct tm tm;
+
+  for (int i = 0; i < 2; ++i) {
+    time_t before = t - 1;
+    ASSERT_EQ(&tm, localtime_r(&before, &tm));
+    EXPECT_EQ(1, tm.tm_hour);
+    EXPECT_EQ(59, tm.tm_sec);
+    EXPECT_EQ(0, tm.tm_isdst);
+    EXPECT_EQ(-8 * 60 * 60, tm.tm_gmtoff);
+    EXPECT_STREQ("PST", tm.tm_zone);
+
+    ASSERT_EQ(&tm, localtime_r(&t, &tm));
+    EXPECT_EQ(3, tm.tm_hour);
+    EXPECT_EQ(0, tm.tm_sec);
+    EXPECT_EQ(1, tm.tm_isdst);
+    EXPECT_EQ(-7 * 60 * 60, tm.tm_gmtoff);
+    EXPECT_STREQ("PDT", tm.tm_zone);
+  }
+
+  setenv("TZ", "Europe/London", 1);
+  tzset();
+  ASSERT_EQ(&tm, localtime_r(&t, &tm));
+  EXPECT_EQ(10, tm.tm_hour);
+  EXPECT_EQ(0, tm.tm_isdst);
+  EXPECT_EQ(0, tm.tm_gmtoff);
+  EXPECT_STREQ("GMT", tm.tm_zone);
+
+  setenv("TZ", "Asia/Tokyo", 1);
+  tzset();
+  ASSERT_EQ(&tm, localtime_r(&t, &tm));
+  EXPECT_EQ(19, tm.tm_hour);
+  EXPECT_EQ(9 * 60 * 60, tm.tm_gmtoff);
+  EXPECT_STREQ("JST", tm.tm_zone);
+}
+
 TEST(time, strftime) {
   setenv("TZ", "UTC", 1);
 
@@ -165,6 +209,40 @@ TEST(time, strftime) {
   EXPECT_STREQ("Sun Mar 10 00:00:00 2100", buf);
 }
 
+TEST(time, strftime_iso8601) {
+  struct tm t;
+  memset(&t, 0, sizeof(tm));
+  t.tm_year = 2017 - 1900;
+  t.tm_mon = 7;
+  t.tm_mday = 9;
+  t.tm_hour = 8;
+  t.tm_min = 7;
+  t.tm_sec = 6;
+  t.tm_gmtoff = -(5 * 60 + 30) * 60;
+
+  char buf[64];
+  EXPECT_EQ(24U, strftime(buf, sizeof(buf), "%Y-%m-%dT%H:%M:%S%z", &t));
+  EXPECT_STREQ("2017-08-09T08:07:06-0530", buf);
+  EXPECT_EQ(24U, strftime(buf, sizeof(buf), "%FT%T%z", &t));
+  EXPECT_STREQ("2017-08-09T08:07:06-0530", buf);
+  EXPECT_EQ(15U, strftime(buf, sizeof(buf), "100%% %F", &t));
+  EXPECT_STREQ("100% 2017-08-09", buf);
+
+  // Too small a buffer.
+  EXPECT_EQ(0U, strftime(buf, 24, "%FT%T%z", &t));
+
+  // Fields too wide for their usual number of digits.
+  t.tm_year = 12345 - 1900;
+  t.tm_sec = 123;
+  EXPECT_EQ(15U, strftime(buf, sizeof(buf), "%Y-%m-%d %S", &t));
+  EXPECT_STREQ("12345-08-09 123", buf);
+
+  // No offset if it's unknown.
+  t.tm_isdst = -1;
+  EXPECT_EQ(2U, strftime(buf, sizeof(buf), "<%z>", &t));
+  EXPECT_STREQ("<>", buf);
+}
+
 TEST(time, strftime_null_tm_zone) {
   // Netflix on Nexus Player wouldn't start (http://b/25170306).
   struct tm t;
@@ -553,6 +631,102 @@ TEST(time, timer_delete_from_timer_thread) {
 #endif
 }
 
+#if defined(__BIONIC__)
+struct SharedTimerData {
+  timer_t timer_id;
+  std::atomic<int> calls;
+  std::atomic<int> running;
+  std::atomic<int> overlaps;
+  std::atomic<int> overruns;
+  useconds_t sleep_us;
+};
+
+static void SharedTimerCallback(sigval_t value) {
+  SharedTimerData* data = reinterpret_cast<SharedTimerData*>(value.sival_ptr);
+  if (data->running++ != 0) {
+    ++data->overlaps;
+  }
+  usleep(data->sleep_us);
+  data->overruns += timer_getoverrun(data->timer_id);
+  ++data->calls;
+  --data->running;
+}
+
+static void CreateSharedTimer(SharedTimerData* data) {
+  sigevent_t se;
+  memset(&se, 0, sizeof(se));
+  se.sigev_notify = SIGEV_THREAD;
+  se.sigev_notify_function = SharedTimerCallback;
+  se.sigev_value.sival_ptr = data;
+  ASSERT_EQ(0, android_timer_create_shared(CLOCK_MONOTONIC, &se, &data->timer_id));
+}
+#endif
+
+TEST(time, android_timer_create_shared) {
+#if defined(__BIONIC__)
+  static constexpr size_t kTimerCount = 200;
+  SharedTimerData data[kTimerCount] = {};
+  for (size_t i = 0; i < kTimerCount; ++i) {
+    CreateSharedTimer(&data[i]);
+  }
+  for (size_t i = 0; i < kTimerCount; ++i) {
+    SetTime(data[i].timer_id, 0, 1000000, 0, 0);
+  }
+
+  time_t start = time(NULL);
+  for (size_t i = 0; i < kTimerCount; ++i) {
+    while (data[i].calls == 0 && (time(NULL) - start) < 5) {
+    }
+    ASSERT_EQ(1, data[i].calls);
+  }
+  for (size_t i = 0; i < kTimerCount; ++i) {
+    ASSERT_EQ(0, timer_delete(data[i].timer_id));
+  }
+#else
+  GTEST_LOG_(INFO) << "This test does nothing.\n";
+#endif
+}
+
+TEST(time, android_timer_create_shared_overrun) {
+#if defined(__BIONIC__)
+  // A timer that fires much faster than its callback runs: the callbacks mustn't overlap, and
+  // the expirations they miss are reported by timer_getoverrun instead.
+  SharedTimerData data = {};
+  data.sleep_us = 10000;
+  CreateSharedTimer(&data);
+  SetTime(data.timer_id, 0, 100000, 0, 100000);
+  usleep(200000);
+  SetTime(data.timer_id, 0, 0, 0, 0);
+  usleep(50000);
+  ASSERT_EQ(0, timer_delete(data.timer_id));
+
+  ASSERT_GT(data.calls, 0);
+  ASSERT_GT(data.overruns, 0);
+  ASSERT_EQ(0, data.overlaps);
+#else
+  GTEST_LOG_(INFO) << "This test does nothing.\n";
+#endif
+}
+
+TEST(time, android_timer_create_shared_EINVAL) {
+#if defined(__BIONIC__)
+  // The work pool can't honor thread attributes.
+  pthread_attr_t attr;
+  ASSERT_EQ(0, pthread_attr_init(&attr));
+  sigevent_t se;
+  memset(&se, 0, sizeof(se));
+  se.sigev_notify = SIGEV_THREAD;
+  se.sigev_notify_function = NoOpNotifyFunction;
+  se.sigev_notify_attributes = &attr;
+  timer_t timer_id;
+  errno = 0;
+  ASSERT_EQ(-1, android_timer_create_shared(CLOCK_MONOTONIC, &se, &timer_id));
+  ASSERT_EQ(EINVAL, errno);
+#else
+  GTEST_LOG_(INFO) << "This test does nothing.\n";
+#endif
+}
+
 TEST(time, clock_gettime) {
   // Try to ensure that our vdso clock_gettime is working.
   timespec ts1;
@@ -573,6 +747,36 @@ TEST(time, clock_gettime) {
   ASSERT_LT(ts2.tv_nsec, 1000000);
 }
 
+TEST(time, clock_gettime_thread_cputime_fast_path) {
+#if defined(__BIONIC__)
+  timespec before;
+  ASSERT_EQ(0, clock_gettime(CLOCK_THREAD_CPUTIME_ID, &before));
+  if (android_thread_cputime_enable_fast_path() == -1) {
+    GTEST_LOG_(INFO) << "no perf event fast path: " << strerror(errno) << "\n";
+    return;
+  }
+  ASSERT_EQ(0, android_thread_cputime_enable_fast_path());
+
+  // The fast path should agree with the kernel, and never go backwards.
+  timespec last = before;
+  for (size_t i = 0; i < 100000; ++i) {
+    timespec fast;
+    ASSERT_EQ(0, clock_gettime(CLOCK_THREAD_CPUTIME_ID, &fast));
+    ASSERT_TRUE(fast.tv_sec > last.tv_sec ||
+                (fast.tv_sec == last.tv_sec && fast.tv_nsec >= last.tv_nsec));
+    last = fast;
+  }
+  timespec slow;
+  ASSERT_EQ(0, syscall(__NR_clock_gettime, CLOCK_THREAD_CPUTIME_ID, &slow));
+  int64_t fast_ns = last.tv_sec * NS_PER_S + last.tv_nsec;
+  int64_t slow_ns = slow.tv_sec * NS_PER_S + slow.tv_nsec;
+  ASSERT_GE(slow_ns + 1000000, fast_ns);
+  ASSERT_LT(slow_ns - fast_ns, 10000000);
+#else
+  GTEST_LOG_(INFO) << "This test does nothing.\n";
+#endif
+}
+
 TEST(time, clock) {
   // clock(3) is hard to test, but a 1s sleep should cost less than 1ms.
   clock_t t0 = clock();
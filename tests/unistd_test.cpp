@@ -37,6 +37,10 @@
 #include <android-base/file.h>
 #include <android-base/strings.h>
 
+#include <algorithm>
+#include <string>
+#include <thread>
+
 #include "private/get_cpu_count_from_string.h"
 
 #if defined(NOFORTIFY)
@@ -421,8 +425,10 @@ TEST(UNISTD_TEST, fsync) {
 static void AssertGetPidCorrect() {
   // The loop is just to make manual testing/debugging with strace easier.
   pid_t getpid_syscall_result = syscall(__NR_getpid);
+  pid_t gettid_syscall_result = syscall(__NR_gettid);
   for (size_t i = 0; i < 128; ++i) {
     ASSERT_EQ(getpid_syscall_result, getpid());
+    ASSERT_EQ(gettid_syscall_result, gettid());
   }
 }
 
@@ -439,6 +445,7 @@ static void TestGetPidCachingWithFork(int (*fork_fn)()) {
     _exit(123);
   } else {
     // We're the parent.
+    AssertGetPidCorrect();
     ASSERT_EQ(parent_pid, getpid());
     AssertChildExited(fork_result, 123);
   }
@@ -474,6 +481,31 @@ TEST(UNISTD_TEST, getpid_caching_and_clone) {
   AssertChildExited(clone_result, 123);
 }
 
+// A child sharing our memory can't report a failed assertion, so it exits with 1 instead.
+static int GetPidCachingCloneVmStartRoutine(void*) {
+  return (getpid() == syscall(__NR_getpid) && gettid() == syscall(__NR_gettid)) ? 123 : 1;
+}
+
+static void TestGetPidCachingWithCloneVm(int flags) {
+  pid_t parent_pid = getpid();
+
+  void* child_stack[1024];
+  int clone_result = clone(GetPidCachingCloneVmStartRoutine, &child_stack[1024], flags, NULL);
+  ASSERT_NE(clone_result, -1);
+  AssertChildExited(clone_result, 123);
+
+  AssertGetPidCorrect();
+  ASSERT_EQ(parent_pid, getpid());
+}
+
+TEST(UNISTD_TEST, getpid_caching_and_clone_vm) {
+  TestGetPidCachingWithCloneVm(CLONE_VM | SIGCHLD);
+}
+
+TEST(UNISTD_TEST, getpid_caching_and_clone_vm_vfork) {
+  TestGetPidCachingWithCloneVm(CLONE_VM | CLONE_VFORK | SIGCHLD);
+}
+
 static void* GetPidCachingPthreadStartRoutine(void*) {
   AssertGetPidCorrect();
   return NULL;
@@ -1075,52 +1107,6 @@ TEST(UNISTD_TEST, setdomainname) {
   }
 }
 
-class ExecTestHelper {
- public:
-  char** GetArgs() { return const_cast<char**>(args_.data()); }
-  char** GetEnv() { return const_cast<char**>(env_.data()); }
-
-  void SetArgs(const std::vector<const char*> args) { args_ = args; }
-  void SetEnv(const std::vector<const char*> env) { env_ = env; }
-
-  void Run(const std::function<void ()>& child_fn,
-           int expected_exit_status,
-           const char* expected_output) {
-      int fds[2];
-      ASSERT_NE(pipe2(fds, 0), -1);
-
-      pid_t pid = fork();
-      ASSERT_NE(pid, -1);
-
-      if (pid == 0) {
-          // Child.
-          close(fds[0]);
-          dup2(fds[1], STDOUT_FILENO);
-          dup2(fds[1], STDERR_FILENO);
-          if (fds[1] != STDOUT_FILENO && fds[1] != STDERR_FILENO) close(fds[1]);
-          child_fn();
-          FAIL();
-      }
-
-      // Parent.
-      close(fds[1]);
-      std::string output;
-      char buf[BUFSIZ];
-      ssize_t bytes_read;
-      while ((bytes_read = TEMP_FAILURE_RETRY(read(fds[0], buf, sizeof(buf)))) > 0) {
-          output.append(buf, bytes_read);
-      }
-      close(fds[0]);
-
-      AssertChildExited(pid, expected_exit_status);
-      ASSERT_EQ(expected_output, output);
-  }
-
- private:
-  std::vector<const char*> args_;
-  std::vector<const char*> env_;
-};
-
 #if defined(__GLIBC__)
 #define BIN_DIR "/bin/"
 #else
@@ -1174,6 +1160,29 @@ TEST(UNISTD_TEST, execle) {
   eth.Run([&]() { execle(BIN_DIR "printenv", "printenv", nullptr, eth.GetEnv()); }, 0, "A=B\n");
 }
 
+TEST(UNISTD_TEST, libc_startup_trace) {
+#if defined(__BIONIC__)
+  TemporaryFile tf;
+  std::string env = std::string("LIBC_STARTUP_TRACE=") + tf.filename;
+  ExecTestHelper eth;
+  eth.SetEnv({env.c_str(), nullptr});
+  eth.Run([&]() { execle(BIN_DIR "printenv", "printenv", nullptr, eth.GetEnv()); }, 0,
+          (env + "\n").c_str());
+
+  // A single line of key=value pairs.
+  std::string trace;
+  ASSERT_TRUE(android::base::ReadFileToString(tf.filename, &trace));
+  ASSERT_TRUE(android::base::StartsWith(trace, "libc_startup pid=")) << trace;
+  ASSERT_TRUE(android::base::EndsWith(trace, "\n")) << trace;
+  ASSERT_EQ(1, std::count(trace.begin(), trace.end(), '\n')) << trace;
+  ASSERT_NE(std::string::npos, trace.find(" prog=printenv ")) << trace;
+  ASSERT_NE(std::string::npos, trace.find(" properties_us=")) << trace;
+  ASSERT_NE(std::string::npos, trace.find(" total_us=")) << trace;
+#else
+  GTEST_LOG_(INFO) << "This test does nothing.\n";
+#endif
+}
+
 TEST(UNISTD_TEST, execv_failure) {
   ExecTestHelper eth;
   errno = 0;
@@ -1281,3 +1290,144 @@ TEST(UNISTD_TEST, execvp_libcore_test_55017) {
   ASSERT_EQ(-1, execvp("/system/bin/does-not-exist", eth.GetArgs()));
   ASSERT_EQ(ENOENT, errno);
 }
+
+static std::string CopyTestData(size_t size) {
+  std::string data(size, '\0');
+  for (size_t i = 0; i < size; ++i) data[i] = 'a' + (i * 7) % 26;
+  return data;
+}
+
+TEST(UNISTD_TEST, copy_file_range) {
+#if defined(__BIONIC__)
+  TemporaryFile in;
+  TemporaryFile out;
+  std::string data = CopyTestData(8192);
+  ASSERT_TRUE(android::base::WriteStringToFd(data, in.fd));
+
+  off64_t in_offset = 1000;
+  ssize_t n = copy_file_range(in.fd, &in_offset, out.fd, nullptr, 4096, 0);
+  if (n == -1 && errno == ENOSYS) {
+    GTEST_LOG_(INFO) << "This kernel doesn't have copy_file_range.\n";
+    return;
+  }
+  ASSERT_EQ(4096, n);
+  ASSERT_EQ(5096, in_offset);
+
+  std::string content;
+  ASSERT_TRUE(android::base::ReadFileToString(out.filename, &content));
+  ASSERT_EQ(data.substr(1000, 4096), content);
+#else
+  GTEST_LOG_(INFO) << "This test does nothing.\n";
+#endif
+}
+
+TEST(UNISTD_TEST, android_copy_fd_file_to_file) {
+#if defined(__BIONIC__)
+  TemporaryFile in;
+  TemporaryFile out;
+  std::string data = CopyTestData(3 * 1024 * 1024 + 17);
+  ASSERT_TRUE(android::base::WriteStringToFd(data, in.fd));
+  ASSERT_EQ(0, lseek(in.fd, 0, SEEK_SET));
+
+  // Everything, stopping at the end of the input...
+  ASSERT_EQ(static_cast<ssize_t>(data.size()), android_copy_fd(in.fd, out.fd, SIZE_MAX));
+  std::string content;
+  ASSERT_TRUE(android::base::ReadFileToString(out.filename, &content));
+  ASSERT_EQ(data, content);
+
+  // ...and no more than we asked for, from the current offsets.
+  ASSERT_EQ(100, lseek(in.fd, 100, SEEK_SET));
+  ASSERT_EQ(0, ftruncate(out.fd, 0));
+  ASSERT_EQ(0, lseek(out.fd, 0, SEEK_SET));
+  ASSERT_EQ(1000, android_copy_fd(in.fd, out.fd, 1000));
+  ASSERT_EQ(1100, lseek(in.fd, 0, SEEK_CUR));
+  ASSERT_TRUE(android::base::ReadFileToString(out.filename, &content));
+  ASSERT_EQ(data.substr(100, 1000), content);
+
+  // Nothing left to copy isn't an error.
+  ASSERT_EQ(static_cast<off_t>(data.size()), lseek(in.fd, 0, SEEK_END));
+  ASSERT_EQ(0, android_copy_fd(in.fd, out.fd, 1000));
+#else
+  GTEST_LOG_(INFO) << "This test does nothing.\n";
+#endif
+}
+
+TEST(UNISTD_TEST, android_copy_fd_append) {
+#if defined(__BIONIC__)
+  // copy_file_range won't write to an O_APPEND file, so this needs a fallback.
+  TemporaryFile in;
+  TemporaryFile out;
+  std::string data = CopyTestData(100000);
+  ASSERT_TRUE(android::base::WriteStringToFd(data, in.fd));
+  ASSERT_EQ(0, lseek(in.fd, 0, SEEK_SET));
+  ASSERT_TRUE(android::base::WriteStringToFd("hello", out.fd));
+  int append_fd = open(out.filename, O_WRONLY | O_APPEND | O_CLOEXEC);
+  ASSERT_NE(-1, append_fd);
+
+  ASSERT_EQ(static_cast<ssize_t>(data.size()), android_copy_fd(in.fd, append_fd, SIZE_MAX));
+  close(append_fd);
+  std::string content;
+  ASSERT_TRUE(android::base::ReadFileToString(out.filename, &content));
+  ASSERT_EQ("hello" + data, content);
+#else
+  GTEST_LOG_(INFO) << "This test does nothing.\n";
+#endif
+}
+
+TEST(UNISTD_TEST, android_copy_fd_pipes) {
+#if defined(__BIONIC__)
+  TemporaryFile in;
+  TemporaryFile out;
+  std::string data = CopyTestData(1024 * 1024);
+  ASSERT_TRUE(android::base::WriteStringToFd(data, in.fd));
+  ASSERT_EQ(0, lseek(in.fd, 0, SEEK_SET));
+
+  // File to pipe, and then pipe to file.
+  int fds[2];
+  ASSERT_EQ(0, pipe(fds));
+  std::thread writer([&]() {
+    EXPECT_EQ(static_cast<ssize_t>(data.size()), android_copy_fd(in.fd, fds[1], SIZE_MAX));
+    close(fds[1]);
+  });
+  ASSERT_EQ(static_cast<ssize_t>(data.size()), android_copy_fd(fds[0], out.fd, SIZE_MAX));
+  writer.join();
+  close(fds[0]);
+
+  std::string content;
+  ASSERT_TRUE(android::base::ReadFileToString(out.filename, &content));
+  ASSERT_EQ(data, content);
+#else
+  GTEST_LOG_(INFO) << "This test does nothing.\n";
+#endif
+}
+
+TEST(UNISTD_TEST, android_copy_fd_proc) {
+#if defined(__BIONIC__)
+  // copy_file_range claims that files in /proc are empty.
+  TemporaryFile out;
+  int in = open("/proc/self/status", O_RDONLY | O_CLOEXEC);
+  ASSERT_NE(-1, in);
+  ASSERT_GT(android_copy_fd(in, out.fd, SIZE_MAX), 0);
+  close(in);
+  std::string content;
+  ASSERT_TRUE(android::base::ReadFileToString(out.filename, &content));
+  ASSERT_NE(std::string::npos, content.find("Pid:"));
+#else
+  GTEST_LOG_(INFO) << "This test does nothing.\n";
+#endif
+}
+
+TEST(UNISTD_TEST, android_copy_fd_EBADF) {
+#if defined(__BIONIC__)
+  TemporaryFile in;
+  ASSERT_TRUE(android::base::WriteStringToFd("hello", in.fd));
+  ASSERT_EQ(0, lseek(in.fd, 0, SEEK_SET));
+  int read_only = open(in.filename, O_RDONLY | O_CLOEXEC);
+  errno = 0;
+  ASSERT_EQ(-1, android_copy_fd(in.fd, read_only, SIZE_MAX));
+  ASSERT_EQ(EBADF, errno);
+  close(read_only);
+#else
+  GTEST_LOG_(INFO) << "This test does nothing.\n";
+#endif
+}
@@ -22,6 +22,10 @@
 #include <stdint.h>
 #include <wchar.h>
 
+#include <string>
+#include <vector>
+
+#include "buffer_tests.h"
 #include "math_data_test.h"
 
 #define NUM_WCHARS(num_bytes) ((num_bytes)/sizeof(wchar_t))
@@ -391,6 +395,74 @@ TEST(wchar, mbsrtowcs) {
   ASSERT_EQ('\x20', *invalid);
 }
 
+// Long runs of ASCII are converted in blocks; make sure the block and
+// per-character paths agree at every alignment and length limit.
+TEST(wchar, mbsrtowcs_wcsrtombs_long) {
+  ASSERT_STREQ("C.UTF-8", setlocale(LC_CTYPE, "C.UTF-8"));
+  uselocale(LC_GLOBAL_LOCALE);
+
+  const char* pieces[] = { "abcdefghijklmnopqrstuvwxyz0123456789", "\xc3\xa9", "\xe2\x82\xac",
+                           "\xf0\x9f\x98\x80", "x" };
+  const wchar_t wpieces[] = { 0, 0xe9, 0x20ac, 0x1f600, L'x' };
+  std::string mbs;
+  std::wstring wcs;
+  for (size_t i = 0; i < 64; ++i) {
+    size_t which = (i * 7) % 5;
+    mbs += pieces[which];
+    if (which == 0) {
+      wcs += L"abcdefghijklmnopqrstuvwxyz0123456789";
+    } else {
+      wcs += wpieces[which];
+    }
+  }
+
+  for (size_t offset = 0; offset < 16; ++offset) {
+    const char* src = mbs.c_str() + offset;
+    ASSERT_EQ(wcs.size() - offset, mbsrtowcs(NULL, &src, 0, NULL));
+
+    std::vector<wchar_t> out(wcs.size() + 1);
+    src = mbs.c_str() + offset;
+    ASSERT_EQ(wcs.size() - offset, mbsrtowcs(out.data(), &src, out.size(), NULL));
+    ASSERT_EQ(nullptr, src);
+    ASSERT_EQ(wcs.substr(offset), std::wstring(out.data()));
+
+    const wchar_t* wsrc = wcs.c_str() + offset;
+    ASSERT_EQ(mbs.size() - offset, wcsrtombs(NULL, &wsrc, 0, NULL));
+
+    std::vector<char> bytes(mbs.size() + 1);
+    wsrc = wcs.c_str() + offset;
+    ASSERT_EQ(mbs.size() - offset, wcsrtombs(bytes.data(), &wsrc, bytes.size(), NULL));
+    ASSERT_EQ(nullptr, wsrc);
+    ASSERT_EQ(mbs.substr(offset), std::string(bytes.data()));
+  }
+
+  // Stop part way through a run of ASCII.
+  for (size_t limit = 0; limit < 36; ++limit) {
+    std::vector<wchar_t> out(64, L'-');
+    const char* src = mbs.c_str();
+    ASSERT_EQ(limit, mbsrtowcs(out.data(), &src, limit, NULL));
+    ASSERT_EQ(mbs.c_str() + limit, src);
+    ASSERT_EQ(wcs.substr(0, limit), std::wstring(out.data(), limit));
+    ASSERT_EQ(L'-', out[limit]);
+
+    std::vector<char> bytes(64, '-');
+    const wchar_t* wsrc = wcs.c_str();
+    ASSERT_EQ(limit, wcsrtombs(bytes.data(), &wsrc, limit, NULL));
+    ASSERT_EQ(wcs.c_str() + limit, wsrc);
+    ASSERT_EQ(mbs.substr(0, limit), std::string(bytes.data(), limit));
+    ASSERT_EQ('-', bytes[limit]);
+  }
+
+  // An invalid byte after a long run of ASCII is still reported where it is.
+  std::string bad = mbs.substr(0, 100) + "\xff" + mbs.substr(100);
+  const char* src = bad.c_str();
+  std::vector<wchar_t> out(bad.size() + 1);
+  errno = 0;
+  ASSERT_EQ(static_cast<size_t>(-1), mbsrtowcs(out.data(), &src, out.size(), NULL));
+  ASSERT_EQ(EILSEQ, errno);
+  ASSERT_EQ(bad.c_str() + 100, src);
+}
+
 TEST(wchar, wcstol) {
   ASSERT_EQ(123L, wcstol(L"123", NULL, 0));
 }
@@ -458,6 +530,166 @@ TEST(wchar, wmemmove_smoke) {
   EXPECT_STREQ(L"This This is a test of something or other", wstr);
 }
 
+// Only whole, aligned characters make sense, so the byte buffers that
+// the buffer_tests helpers hand out are skipped when they don't fit.
+static bool IsWideBuffer(uint8_t* buf, size_t len) {
+  return len >= sizeof(wchar_t) && len % sizeof(wchar_t) == 0 &&
+      reinterpret_cast<uintptr_t>(buf) % sizeof(wchar_t) == 0;
+}
+
+static void DoWcslenTest(uint8_t* buf, size_t len) {
+  if (IsWideBuffer(buf, len)) {
+    wchar_t* wstr = reinterpret_cast<wchar_t*>(buf);
+    size_t count = NUM_WCHARS(len);
+    // Characters with zero low bytes catch anything comparing bytes.
+    for (size_t i = 0; i < count - 1; i++) {
+      wstr[i] = (i % 2) ? L'a' : static_cast<wchar_t>(0x10000);
+    }
+    wstr[count-1] = L'\0';
+    ASSERT_EQ(count - 1, wcslen(wstr));
+  }
+}
+
+TEST(wchar, wcslen_align) {
+  RunSingleBufferAlignTest(1024, DoWcslenTest);
+}
+
+TEST(wchar, wcslen_overread) {
+  RunSingleBufferOverreadTest(DoWcslenTest);
+}
+
+static void DoWmemsetTest(uint8_t* buf, size_t len) {
+  if (IsWideBuffer(buf, len)) {
+    wchar_t* wstr = reinterpret_cast<wchar_t*>(buf);
+    size_t count = NUM_WCHARS(len);
+    const wchar_t value = static_cast<wchar_t>(0x12345678);
+    ASSERT_EQ(wstr, wmemset(wstr, value, count));
+    for (size_t i = 0; i < count; i++) {
+      ASSERT_EQ(value, wstr[i]);
+    }
+  }
+}
+
+TEST(wchar, wmemset_align) {
+  RunSingleBufferAlignTest(1024, DoWmemsetTest);
+}
+
+TEST(wchar, wmemset_overread) {
+  RunSingleBufferOverreadTest(DoWmemsetTest);
+}
+
+// Fills a wide buffer with characters whose low bytes are zero, which
+// catches anything comparing bytes rather than wchar_t.
+static void FillWideBuffer(wchar_t* wstr, size_t count) {
+  for (size_t i = 0; i < count; i++) {
+    wstr[i] = (i % 2) ? L'a' : static_cast<wchar_t>(0x10000 + (i % 7) * 0x100);
+  }
+}
+
+static void DoWcschrTest(uint8_t* buf, size_t len) {
+  if (IsWideBuffer(buf, len)) {
+    wchar_t* wstr = reinterpret_cast<wchar_t*>(buf);
+    size_t count = NUM_WCHARS(len);
+    FillWideBuffer(wstr, count - 1);
+    wstr[count-1] = L'\0';
+    const wchar_t target = static_cast<wchar_t>(0x12345678);
+    ASSERT_EQ(nullptr, wcschr(wstr, target));
+    ASSERT_EQ(&wstr[count-1], wcschr(wstr, L'\0'));
+    ASSERT_EQ(nullptr, wmemchr(wstr, target, count));
+    if (count > 1) {
+      wstr[count-2] = target;
+      ASSERT_EQ(&wstr[count-2], wcschr(wstr, target));
+      ASSERT_EQ(&wstr[count-2], wmemchr(wstr, target, count));
+      ASSERT_EQ(nullptr, wmemchr(wstr, target, count - 2));
+    }
+  }
+}
+
+TEST(wchar, wcschr_align) {
+  RunSingleBufferAlignTest(1024, DoWcschrTest);
+}
+
+TEST(wchar, wcschr_overread) {
+  RunSingleBufferOverreadTest(DoWcschrTest);
+}
+
+static void DoWcscmpTest(uint8_t* buf1, uint8_t* buf2, size_t len) {
+  if (IsWideBuffer(buf1, len) && IsWideBuffer(buf2, len)) {
+    wchar_t* wstr1 = reinterpret_cast<wchar_t*>(buf1);
+    wchar_t* wstr2 = reinterpret_cast<wchar_t*>(buf2);
+    size_t count = NUM_WCHARS(len);
+    FillWideBuffer(wstr1, count - 1);
+    FillWideBuffer(wstr2, count - 1);
+    wstr1[count-1] = wstr2[count-1] = L'\0';
+    ASSERT_EQ(0, wcscmp(wstr1, wstr2));
+  }
+}
+
+static void DoWcscmpFailTest(uint8_t* buf1, uint8_t* buf2, size_t len1, size_t len2) {
+  if (IsWideBuffer(buf1, len1) && IsWideBuffer(buf2, len2)) {
+    wchar_t* wstr1 = reinterpret_cast<wchar_t*>(buf1);
+    wchar_t* wstr2 = reinterpret_cast<wchar_t*>(buf2);
+    size_t count1 = NUM_WCHARS(len1);
+    size_t count2 = NUM_WCHARS(len2);
+    FillWideBuffer(wstr1, count1 - 1);
+    FillWideBuffer(wstr2, count2 - 1);
+    wstr1[count1-1] = wstr2[count2-1] = L'\0';
+    if (count1 != count2) {
+      ASSERT_NE(0, wcscmp(wstr1, wstr2));
+    }
+
+    // A single difference in the last character.
+    size_t count = (count1 < count2) ? count1 : count2;
+    if (count > 1) {
+      wstr1[count-1] = wstr2[count-1] = L'\0';
+      wstr1[count-2] = static_cast<wchar_t>(0x10000);
+      wstr2[count-2] = static_cast<wchar_t>(0x10001);
+      ASSERT_LT(wcscmp(wstr1, wstr2), 0);
+      ASSERT_GT(wcscmp(wstr2, wstr1), 0);
+    }
+  }
+}
+
+TEST(wchar, wcscmp_align) {
+  RunCmpBufferAlignTest(1024, DoWcscmpTest, DoWcscmpFailTest);
+}
+
+TEST(wchar, wcscmp_overread) {
+  RunCmpBufferOverreadTest(DoWcscmpTest, DoWcscmpFailTest);
+}
+
+static void DoWcsncpyTest(uint8_t* src, uint8_t* dst, size_t len) {
+  if (IsWideBuffer(src, len) && IsWideBuffer(dst, len)) {
+    wchar_t* wsrc = reinterpret_cast<wchar_t*>(src);
+    wchar_t* wdst = reinterpret_cast<wchar_t*>(dst);
+    size_t count = NUM_WCHARS(len);
+
+    // A string that fills the destination...
+    FillWideBuffer(wsrc, count - 1);
+    wsrc[count-1] = L'\0';
+    ASSERT_EQ(wdst, wcsncpy(wdst, wsrc, count));
+    ASSERT_EQ(0, memcmp(wsrc, wdst, len));
+
+    // ...and a shorter one, which gets padded with NULs.
+    size_t short_count = count / 2;
+    wsrc[short_count] = L'\0';
+    FillWideBuffer(wdst, count);
+    ASSERT_EQ(wdst, wcsncpy(wdst, wsrc, count));
+    ASSERT_EQ(0, memcmp(wsrc, wdst, short_count * sizeof(wchar_t)));
+    for (size_t i = short_count; i < count; i++) {
+      ASSERT_EQ(L'\0', wdst[i]);
+    }
+  }
+}
+
+TEST(wchar, wcsncpy_align) {
+  RunSrcDstBufferAlignTest(1024, DoWcsncpyTest);
+}
+
+TEST(wchar, wcsncpy_overread) {
+  RunSrcDstBufferOverreadTest(DoWcsncpyTest);
+}
+
 TEST(wchar, wmemcpy_smoke) {
   const wchar_t src[] = L"Source string";
   wchar_t dst[NUM_WCHARS(sizeof(src))];
@@ -88,6 +88,43 @@ TEST(wctype, iswxdigit) {
   TestIsWideFn(iswxdigit, iswxdigit_l, L"01aA", L"xg! \b");
 }
 
+TEST(wctype, unicode) {
+#if defined(__BIONIC__)
+  // Letters, digits and spaces from outside ASCII, including a character
+  // outside the BMP (U+10400 DESERET CAPITAL LETTER LONG I).
+  EXPECT_TRUE(iswalpha(0xe9));
+  EXPECT_TRUE(iswalpha(0x4e00));
+  EXPECT_TRUE(iswalpha(0x10400));
+  EXPECT_FALSE(iswalpha(0x2014));
+  EXPECT_TRUE(iswalnum(0x661));
+  EXPECT_FALSE(iswdigit(0x661));
+  EXPECT_TRUE(iswupper(0x3a3));
+  EXPECT_TRUE(iswlower(0x3c3));
+  EXPECT_TRUE(iswupper(0x10400));
+  EXPECT_TRUE(iswspace(0x3000));
+  EXPECT_TRUE(iswblank(0x2003));
+  EXPECT_FALSE(iswspace(0xa0));
+  EXPECT_TRUE(iswpunct(0x2014));
+  EXPECT_TRUE(iswgraph(0x1f600));
+  EXPECT_FALSE(iswprint(0xd800));
+
+  // U+0341 is a combining mark, whatever its low byte looks like.
+  EXPECT_FALSE(iswalpha(0x341));
+  EXPECT_FALSE(iswalpha(WEOF));
+  EXPECT_FALSE(iswprint(0x110000));
+
+  EXPECT_EQ(wint_t(0xe9), towlower(0xc9));
+  EXPECT_EQ(wint_t(0xc9), towupper(0xe9));
+  EXPECT_EQ(wint_t(0x3c3), towlower(0x3a3));
+  EXPECT_EQ(wint_t(0x10428), towlower(0x10400));
+  EXPECT_EQ(wint_t(0x10400), towupper(0x10428));
+  EXPECT_EQ(wint_t(0x4e00), towupper(0x4e00));
+  EXPECT_EQ(WEOF, towlower(WEOF));
+#else
+  GTEST_LOG_(INFO) << "This test does nothing.\n";
+#endif
+}
+
 TEST(wctype, towlower) {
   EXPECT_EQ(wint_t('!'), towlower(L'!'));
   EXPECT_EQ(wint_t('a'), towlower(L'a'));
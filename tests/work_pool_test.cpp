@@ -0,0 +1,138 @@
+/*
+ * Copyright (C) 2017 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <errno.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include <atomic>
+
+#if defined(__BIONIC__)
+#include <android/work_pool.h>
+
+static void Increment(void* arg) {
+  reinterpret_cast<std::atomic<int>*>(arg)->fetch_add(1);
+}
+#endif
+
+TEST(work_pool, android_work_pool_get_worker_count) {
+#if defined(__BIONIC__)
+  ASSERT_GE(android_work_pool_get_worker_count(), 1U);
+  ASSERT_LE(android_work_pool_get_worker_count(),
+            static_cast<size_t>(sysconf(_SC_NPROCESSORS_CONF)));
+#else
+  GTEST_LOG_(INFO) << "This test tests bionic implementation details.\n";
+#endif
+}
+
+TEST(work_pool, android_work_pool_spawn_wait) {
+#if defined(__BIONIC__)
+  std::atomic<int> count(0);
+  android_work_group_t group = ANDROID_WORK_GROUP_INITIALIZER;
+  for (int i = 0; i < 1000; ++i) {
+    ASSERT_EQ(0, android_work_pool_spawn(&group, Increment, &count));
+  }
+  ASSERT_EQ(0, android_work_pool_wait(&group));
+  ASSERT_EQ(1000, count.load());
+
+  // The group can be reused, and waiting for an empty group returns straight away.
+  ASSERT_EQ(0, android_work_pool_wait(&group));
+  ASSERT_EQ(0, android_work_pool_spawn(&group, Increment, &count));
+  ASSERT_EQ(0, android_work_pool_wait(&group));
+  ASSERT_EQ(1001, count.load());
+#else
+  GTEST_LOG_(INFO) << "This test tests bionic implementation details.\n";
+#endif
+}
+
+TEST(work_pool, android_work_pool_EINVAL) {
+#if defined(__BIONIC__)
+  android_work_group_t group = ANDROID_WORK_GROUP_INITIALIZER;
+  ASSERT_EQ(EINVAL, android_work_pool_spawn(nullptr, Increment, nullptr));
+  ASSERT_EQ(EINVAL, android_work_pool_spawn(&group, nullptr, nullptr));
+  ASSERT_EQ(EINVAL, android_work_pool_wait(nullptr));
+#else
+  GTEST_LOG_(INFO) << "This test tests bionic implementation details.\n";
+#endif
+}
+
+#if defined(__BIONIC__)
+struct FibTask {
+  int n;
+  long result;
+};
+
+// Every level spawns and waits for two subtasks, so workers wait for groups from inside tasks
+// and have to run or steal the queued tasks meanwhile.
+static void Fib(void* arg) {
+  FibTask* task = reinterpret_cast<FibTask*>(arg);
+  if (task->n < 2) {
+    task->result = task->n;
+    return;
+  }
+  FibTask a = { task->n - 1, 0 };
+  FibTask b = { task->n - 2, 0 };
+  android_work_group_t group = ANDROID_WORK_GROUP_INITIALIZER;
+  android_work_pool_spawn(&group, Fib, &a);
+  android_work_pool_spawn(&group, Fib, &b);
+  android_work_pool_wait(&group);
+  task->result = a.result + b.result;
+}
+#endif
+
+TEST(work_pool, android_work_pool_nested) {
+#if defined(__BIONIC__)
+  FibTask task = { 20, 0 };
+  android_work_group_t group = ANDROID_WORK_GROUP_INITIALIZER;
+  ASSERT_EQ(0, android_work_pool_spawn(&group, Fib, &task));
+  ASSERT_EQ(0, android_work_pool_wait(&group));
+  ASSERT_EQ(6765, task.result);
+#else
+  GTEST_LOG_(INFO) << "This test tests bionic implementation details.\n";
+#endif
+}
+
+#if defined(__BIONIC__)
+static void* SpawnAndWait(void* arg) {
+  std::atomic<int>* count = reinterpret_cast<std::atomic<int>*>(arg);
+  for (int i = 0; i < 100; ++i) {
+    android_work_group_t group = ANDROID_WORK_GROUP_INITIALIZER;
+    for (int j = 0; j < 10; ++j) {
+      android_work_pool_spawn(&group, Increment, count);
+    }
+    android_work_pool_wait(&group);
+  }
+  return nullptr;
+}
+#endif
+
+TEST(work_pool, android_work_pool_shared_by_threads) {
+#if defined(__BIONIC__)
+  std::atomic<int> count(0);
+  pthread_t threads[4];
+  for (auto& thread : threads) {
+    ASSERT_EQ(0, pthread_create(&thread, nullptr, SpawnAndWait, &count));
+  }
+  for (auto& thread : threads) {
+    ASSERT_EQ(0, pthread_join(thread, nullptr));
+  }
+  ASSERT_EQ(4 * 100 * 10, count.load());
+#else
+  GTEST_LOG_(INFO) << "This test tests bionic implementation details.\n";
+#endif
+}
@@ -672,6 +672,33 @@ static void ReplaceDynamicEntry(typename ELF::Sword tag,
   VLOG(1) << "dynamic[" << slot << "] overwritten with " << dyn.d_tag;
 }
 
+// Sort the symbolic relocations by r_info, which puts those of each symbol
+// next to each other, so that the linker can reuse one lookup for all of
+// them and the packer can group them by info.  Only the symbolic relocations
+// move, and only between the places symbolic relocations were in, so
+// relative and IRELATIVE relocations keep their order relative to them.
+template <typename ELF>
+void ElfFile<ELF>::SortSymbolicRelocations(std::vector<typename ELF::Rela>* relocations) {
+  std::vector<size_t> slots;
+  std::vector<typename ELF::Rela> symbolic;
+  for (size_t i = 0; i < relocations->size(); ++i) {
+    if (ELF::elf_r_sym(relocations->at(i).r_info) != 0) {
+      slots.push_back(i);
+      symbolic.push_back(relocations->at(i));
+    }
+  }
+
+  std::stable_sort(symbolic.begin(), symbolic.end(),
+                   [](const typename ELF::Rela& a, const typename ELF::Rela& b) {
+                     return a.r_info < b.r_info;
+                   });
+
+  for (size_t i = 0; i < slots.size(); ++i) {
+    relocations->at(slots[i]) = symbolic[i];
+  }
+  VLOG(1) << "Sorted " << symbolic.size() << " symbolic relocations";
+}
+
 // Remove relative entries from dynamic relocations and write as packed
 // data into android packed relocations.
 template <typename ELF>
@@ -733,8 +760,12 @@ bool ElfFile<ELF>::PackTypedRelocations(std::vector<typename ELF::Rela>* relocat
   std::vector<uint8_t> packed;
   RelocationPacker<ELF> packer;
 
+  if (format_ == APS3) {
+    SortSymbolicRelocations(relocations);
+  }
+
   // Pack relocations: dry run to estimate memory savings.
-  packer.PackRelocations(*relocations, &packed);
+  packer.PackRelocations(*relocations, &packed, format_);
   const size_t packed_bytes_estimate = packed.size() * sizeof(packed[0]);
   VLOG(1) << "Packed         (no padding): " << packed_bytes_estimate << " bytes";
 
@@ -846,7 +877,7 @@ bool ElfFile<ELF>::UnpackRelocations() {
       packed[0] == 'A' &&
       packed[1] == 'P' &&
       packed[2] == 'S' &&
-      packed[3] == '2') {
+      (packed[3] == '2' || packed[3] == '3')) {
     LOG(INFO) << "Relocations   : " << (relocations_type_ == REL ? "REL" : "RELA");
   } else {
     LOG(ERROR) << "Packed relocations not found (not packed?)";
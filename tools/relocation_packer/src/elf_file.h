@@ -34,7 +34,7 @@ template <typename ELF>
 class ElfFile {
  public:
   explicit ElfFile(int fd)
-      : fd_(fd), is_padding_relocations_(false), elf_(NULL),
+      : fd_(fd), is_padding_relocations_(false), format_(APS2), elf_(NULL),
         relocations_section_(NULL), dynamic_section_(NULL),
         relocations_type_(NONE), has_android_relocations_(false) {}
   ~ElfFile() {}
@@ -45,6 +45,12 @@ class ElfFile {
   // |flag| is true to pad .rel.dyn or .rela.dyn, false to shrink it.
   inline void SetPadding(bool flag) { is_padding_relocations_ = flag; }
 
+  // Set the packed format PackRelocations() writes.  For APS3 it also sorts
+  // the symbolic relocations by symbol, so that the linker looks each symbol
+  // up once.
+  // |format| is the packed format, APS2 by default.
+  inline void SetFormat(PackedFormat format) { format_ = format; }
+
   // Transfer relative relocations from .rel.dyn or .rela.dyn to a packed
   // representation in .android.rel.dyn or .android.rela.dyn.  Returns true
   // on success.
@@ -88,6 +94,8 @@ class ElfFile {
                                           ssize_t hole_size,
                                           relocations_type_t relocations_type);
 
+  static void SortSymbolicRelocations(std::vector<typename ELF::Rela>* relocations);
+
   static void ConvertRelArrayToRelaVector(const typename ELF::Rel* rel_array, size_t rel_array_size,
                                           std::vector<typename ELF::Rela>* rela_vector);
 
@@ -102,6 +110,9 @@ class ElfFile {
   // debugging, allows packing to be checked without affecting load addresses.
   bool is_padding_relocations_;
 
+  // The packed format to write.
+  PackedFormat format_;
+
   // Libelf handle, assigned by Load().
   Elf* elf_;
 
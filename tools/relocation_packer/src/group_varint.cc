@@ -0,0 +1,133 @@
+// Copyright 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "group_varint.h"
+
+#include <limits.h>
+#include <stdint.h>
+#include <vector>
+
+#include "elf_traits.h"
+
+namespace {
+
+const size_t kLengths[4] = { 1, 2, 4, 8 };
+
+uint64_t ZigZagEncode(uint64_t value, size_t bits) {
+  const uint64_t sign = (value >> (bits - 1)) & 1;
+  uint64_t encoded = (value << 1) ^ -sign;
+  if (bits < 64) {
+    encoded &= (static_cast<uint64_t>(1) << bits) - 1;
+  }
+  return encoded;
+}
+
+uint64_t ZigZagDecode(uint64_t value) {
+  return (value >> 1) ^ -(value & 1);
+}
+
+size_t LengthCode(uint64_t value) {
+  size_t code = 0;
+  while (code < 3 && (value >> (kLengths[code] * CHAR_BIT)) != 0) {
+    ++code;
+  }
+  return code;
+}
+
+}
+
+namespace relocation_packer {
+
+// Empty constructor and destructor to silence chromium-style.
+template <typename uint_t>
+GroupVarintEncoder<uint_t>::GroupVarintEncoder() { }
+
+template <typename uint_t>
+GroupVarintEncoder<uint_t>::~GroupVarintEncoder() { }
+
+template <typename uint_t>
+void GroupVarintEncoder<uint_t>::Enqueue(uint_t value) {
+  pending_.push_back(value);
+  if (pending_.size() == 4) {
+    Flush();
+  }
+}
+
+template <typename uint_t>
+void GroupVarintEncoder<uint_t>::EnqueueAll(const std::vector<uint_t>& values) {
+  for (size_t i = 0; i < values.size(); ++i) {
+    Enqueue(values[i]);
+  }
+}
+
+template <typename uint_t>
+void GroupVarintEncoder<uint_t>::GetEncoding(std::vector<uint8_t>* encoding) {
+  if (!pending_.empty()) {
+    pending_.resize(4, 0);
+    Flush();
+  }
+  *encoding = encoding_;
+}
+
+template <typename uint_t>
+void GroupVarintEncoder<uint_t>::Flush() {
+  const size_t tag_index = encoding_.size();
+  encoding_.push_back(0);
+
+  uint8_t tag = 0;
+  for (size_t i = 0; i < 4; ++i) {
+    const uint64_t value = ZigZagEncode(pending_[i], CHAR_BIT * sizeof(uint_t));
+    const size_t code = LengthCode(value);
+    tag |= code << (2 * i);
+    for (size_t j = 0; j < kLengths[code]; ++j) {
+      encoding_.push_back(static_cast<uint8_t>(value >> (j * CHAR_BIT)));
+    }
+  }
+  encoding_[tag_index] = tag;
+  pending_.clear();
+}
+
+// Create a new decoder for the given encoded stream.
+template <typename uint_t>
+GroupVarintDecoder<uint_t>::GroupVarintDecoder(const std::vector<uint8_t>& encoding,
+                                               size_t start_with) {
+  encoding_ = encoding;
+  cursor_ = start_with;
+}
+
+// Empty destructor to silence chromium-style.
+template <typename uint_t>
+GroupVarintDecoder<uint_t>::~GroupVarintDecoder() { }
+
+template <typename uint_t>
+void GroupVarintDecoder<uint_t>::DequeueAll(std::vector<uint_t>* values) {
+  while (cursor_ < encoding_.size()) {
+    const uint8_t tag = encoding_[cursor_];
+    size_t block_size = 1;
+    for (size_t i = 0; i < 4; ++i) {
+      block_size += kLengths[(tag >> (2 * i)) & 3];
+    }
+    // Anything shorter than a block is padding after the packed data.
+    if (encoding_.size() - cursor_ < block_size) {
+      return;
+    }
+    ++cursor_;
+
+    for (size_t i = 0; i < 4; ++i) {
+      const size_t length = kLengths[(tag >> (2 * i)) & 3];
+      uint64_t value = 0;
+      for (size_t j = 0; j < length; ++j) {
+        value |= static_cast<uint64_t>(encoding_[cursor_++]) << (j * CHAR_BIT);
+      }
+      values->push_back(static_cast<uint_t>(ZigZagDecode(value)));
+    }
+  }
+}
+
+template class GroupVarintEncoder<uint32_t>;
+template class GroupVarintEncoder<uint64_t>;
+template class GroupVarintDecoder<uint32_t>;
+template class GroupVarintDecoder<uint64_t>;
+
+}  // namespace relocation_packer
@@ -0,0 +1,78 @@
+// Copyright 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Group varint encoder and decoder, for the APS3 packed relocation format.
+//
+// Values are written in blocks of four: a tag byte whose bit pairs, lowest
+// first, hold the length of each value (1, 2, 4 or 8 bytes), followed by the
+// four values, little-endian.  Values are zigzag-encoded, so that small
+// negative deltas take as few bytes as small positive ones.  The last block
+// is padded with zeros.  The linker's decoder is in linker_group_varint.h.
+
+#ifndef TOOLS_RELOCATION_PACKER_SRC_GROUP_VARINT_H_
+#define TOOLS_RELOCATION_PACKER_SRC_GROUP_VARINT_H_
+
+#include <stdint.h>
+#include <unistd.h>
+#include <vector>
+
+#include "elf_traits.h"
+
+namespace relocation_packer {
+
+template<typename uint_t>
+class GroupVarintEncoder {
+ public:
+  // Explicit (but empty) constructor and destructor, for chromium-style.
+  GroupVarintEncoder();
+  ~GroupVarintEncoder();
+
+  // Add a value to the encoding stream.
+  // |value| is the signed int to add.
+  void Enqueue(uint_t value);
+
+  // Add a vector of values to the encoding stream.
+  // |values| is the vector of signed ints to add.
+  void EnqueueAll(const std::vector<uint_t>& values);
+
+  // Retrieve the encoded representation of the values, padding the last
+  // block.
+  // |encoding| is the returned vector of encoded data.
+  void GetEncoding(std::vector<uint8_t>* encoding);
+
+ private:
+  // Encodes the pending values as one block.
+  void Flush();
+
+  std::vector<uint8_t> encoding_;
+
+  // Values not yet written, fewer than four.
+  std::vector<uint_t> pending_;
+};
+
+template <typename uint_t>
+class GroupVarintDecoder {
+ public:
+  // Create a new decoder for the given encoded stream.
+  // |encoding| is the vector of encoded data.
+  explicit GroupVarintDecoder(const std::vector<uint8_t>& encoding, size_t start_with);
+
+  // Explicit (but empty) destructor, for chromium-style.
+  ~GroupVarintDecoder();
+
+  // Retrieve all the values of the remaining whole blocks, including the
+  // padding of the last one.
+  // |values| is the vector of decoded data.
+  void DequeueAll(std::vector<uint_t>* values);
+
+ private:
+  std::vector<uint8_t> encoding_;
+
+  // Cursor indicating the current stream retrieval point.
+  size_t cursor_;
+};
+
+}  // namespace relocation_packer
+
+#endif  // TOOLS_RELOCATION_PACKER_SRC_GROUP_VARINT_H_
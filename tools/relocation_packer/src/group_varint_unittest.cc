@@ -0,0 +1,108 @@
+// Copyright 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "group_varint.h"
+
+#include <vector>
+#include "elf_traits.h"
+#include "gtest/gtest.h"
+
+namespace relocation_packer {
+
+TEST(GroupVarint, Encoder64) {
+  GroupVarintEncoder<uint64_t> encoder;
+  encoder.Enqueue(0U);
+  encoder.Enqueue(static_cast<uint64_t>(-1));
+  encoder.Enqueue(64U);
+  encoder.Enqueue(0x12345678U);
+  encoder.Enqueue(static_cast<uint64_t>(-9223372036854775807LL - 1));
+
+  std::vector<uint8_t> encoding;
+  encoder.GetEncoding(&encoding);
+
+  // Lengths 1, 1, 1 and 4 bytes.
+  size_t ndx = 0;
+  EXPECT_EQ(0x80, encoding[ndx++]);
+  // 0
+  EXPECT_EQ(0x00, encoding[ndx++]);
+  // -1
+  EXPECT_EQ(0x01, encoding[ndx++]);
+  // 64 = 128 zigzagged
+  EXPECT_EQ(0x80, encoding[ndx++]);
+  // 0x12345678 = 0x2468acf0 zigzagged
+  EXPECT_EQ(0xf0, encoding[ndx++]);
+  EXPECT_EQ(0xac, encoding[ndx++]);
+  EXPECT_EQ(0x68, encoding[ndx++]);
+  EXPECT_EQ(0x24, encoding[ndx++]);
+  // The last block: -2^63 and three zeros of padding.
+  EXPECT_EQ(0x03, encoding[ndx++]);
+  for (size_t i = 0; i < 8; ++i) {
+    EXPECT_EQ(0xff, encoding[ndx++]);
+  }
+  for (size_t i = 0; i < 3; ++i) {
+    EXPECT_EQ(0x00, encoding[ndx++]);
+  }
+  EXPECT_EQ(ndx, encoding.size());
+}
+
+TEST(GroupVarint, Encoder32) {
+  GroupVarintEncoder<uint32_t> encoder;
+  encoder.Enqueue(1U);
+  encoder.Enqueue(static_cast<uint32_t>(-2));
+  encoder.Enqueue(0x7fffffffU);
+  encoder.Enqueue(0x80000000U);
+
+  std::vector<uint8_t> encoding;
+  encoder.GetEncoding(&encoding);
+
+  // Lengths 1, 1, 4 and 4 bytes: 32-bit values never need 8.
+  ASSERT_EQ(11U, encoding.size());
+  EXPECT_EQ(0xa0, encoding[0]);
+  EXPECT_EQ(0x02, encoding[1]);
+  EXPECT_EQ(0x03, encoding[2]);
+  EXPECT_EQ(0xfe, encoding[3]);
+  EXPECT_EQ(0xff, encoding[4]);
+  EXPECT_EQ(0xff, encoding[5]);
+  EXPECT_EQ(0xff, encoding[6]);
+  EXPECT_EQ(0xff, encoding[7]);
+  EXPECT_EQ(0xff, encoding[8]);
+  EXPECT_EQ(0xff, encoding[9]);
+  EXPECT_EQ(0xff, encoding[10]);
+}
+
+template <typename uint_t>
+static void DoRoundTrip() {
+  std::vector<uint_t> values;
+  for (uint_t value = 1; value != 0; value <<= 1) {
+    values.push_back(value);
+    values.push_back(value - 1);
+    values.push_back(-value);
+  }
+
+  GroupVarintEncoder<uint_t> encoder;
+  encoder.EnqueueAll(values);
+  std::vector<uint8_t> encoding;
+  encoder.GetEncoding(&encoding);
+  // Trailing bytes shorter than a block are padding.
+  encoding.push_back(0);
+
+  GroupVarintDecoder<uint_t> decoder(encoding, 0);
+  std::vector<uint_t> decoded;
+  decoder.DequeueAll(&decoded);
+
+  ASSERT_EQ((values.size() + 3) / 4 * 4, decoded.size());
+  for (size_t i = 0; i < values.size(); ++i) {
+    EXPECT_EQ(values[i], decoded[i]);
+  }
+  for (size_t i = values.size(); i < decoded.size(); ++i) {
+    EXPECT_EQ(0U, decoded[i]);
+  }
+}
+
+TEST(GroupVarint, RoundTrip) {
+  DoRoundTrip<uint32_t>();
+  DoRoundTrip<uint64_t>();
+}
+
+}  // namespace relocation_packer
@@ -16,6 +16,7 @@
 #include <getopt.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <sys/types.h>
 #include <unistd.h>
 #include <string>
@@ -36,11 +37,13 @@ static void PrintUsage(const char* argv0) {
   const char* basename = temporary.c_str();
 
   printf(
-      "Usage: %s [-u] [-v] [-p] file\n\n"
+      "Usage: %s [-u] [-v] [-p] [-f aps2|aps3] file\n\n"
       "Pack or unpack relative relocations in a shared library.\n\n"
       "  -u, --unpack   unpack previously packed relative relocations\n"
       "  -v, --verbose  trace object file modifications (for debugging)\n"
-      "  -p, --pad      do not shrink relocations, but pad (for debugging)\n\n",
+      "  -p, --pad      do not shrink relocations, but pad (for debugging)\n"
+      "  -f, --format   the packed format: aps2 (the default), or aps3,\n"
+      "                 which loads faster but needs a newer linker\n\n",
       basename);
 
   printf(
@@ -52,14 +55,15 @@ int main(int argc, char* argv[]) {
   bool is_unpacking = false;
   bool is_verbose = false;
   bool is_padding = false;
+  relocation_packer::PackedFormat format = relocation_packer::APS2;
 
   static const option options[] = {
     {"unpack", 0, 0, 'u'}, {"verbose", 0, 0, 'v'}, {"pad", 0, 0, 'p'},
-    {"help", 0, 0, 'h'}, {NULL, 0, 0, 0}
+    {"format", 1, 0, 'f'}, {"help", 0, 0, 'h'}, {NULL, 0, 0, 0}
   };
   bool has_options = true;
   while (has_options) {
-    int c = getopt_long(argc, argv, "uvph", options, NULL);
+    int c = getopt_long(argc, argv, "uvpf:h", options, NULL);
     switch (c) {
       case 'u':
         is_unpacking = true;
@@ -70,6 +74,16 @@ int main(int argc, char* argv[]) {
       case 'p':
         is_padding = true;
         break;
+      case 'f':
+        if (strcmp(optarg, "aps2") == 0) {
+          format = relocation_packer::APS2;
+        } else if (strcmp(optarg, "aps3") == 0) {
+          format = relocation_packer::APS3;
+        } else {
+          LOG(ERROR) << "unknown format '" << optarg << "'";
+          return 1;
+        }
+        break;
       case 'h':
         PrintUsage(argv[0]);
         return 0;
@@ -121,6 +135,7 @@ int main(int argc, char* argv[]) {
   if (e_ident[EI_CLASS] == ELFCLASS32) {
     relocation_packer::ElfFile<ELF32_traits> elf_file(fd.get());
     elf_file.SetPadding(is_padding);
+    elf_file.SetFormat(format);
 
     if (is_unpacking) {
       status = elf_file.UnpackRelocations();
@@ -130,6 +145,7 @@ int main(int argc, char* argv[]) {
   } else if (e_ident[EI_CLASS] == ELFCLASS64) {
     relocation_packer::ElfFile<ELF64_traits> elf_file(fd.get());
     elf_file.SetPadding(is_padding);
+    elf_file.SetFormat(format);
 
     if (is_unpacking) {
       status = elf_file.UnpackRelocations();
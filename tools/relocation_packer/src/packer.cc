@@ -9,6 +9,7 @@
 #include "debug.h"
 #include "delta_encoder.h"
 #include "elf_traits.h"
+#include "group_varint.h"
 #include "sleb128.h"
 
 namespace relocation_packer {
@@ -16,7 +17,8 @@ namespace relocation_packer {
 // Pack relocations into a group encoded packed representation.
 template <typename ELF>
 void RelocationPacker<ELF>::PackRelocations(const std::vector<typename ELF::Rela>& relocations,
-                                            std::vector<uint8_t>* packed) {
+                                            std::vector<uint8_t>* packed,
+                                            PackedFormat format) {
   // Run-length encode.
   std::vector<typename ELF::Addr> packed_words;
   RelocationDeltaCodec<ELF> codec;
@@ -26,22 +28,25 @@ void RelocationPacker<ELF>::PackRelocations(const std::vector<typename ELF::Rela
   if (packed_words.empty())
     return;
 
-  Sleb128Encoder<typename ELF::Addr> sleb128_encoder;
+  std::vector<uint8_t> encoded;
 
-  std::vector<uint8_t> sleb128_packed;
-
-  sleb128_encoder.EnqueueAll(packed_words);
-  sleb128_encoder.GetEncoding(&sleb128_packed);
+  if (format == APS3) {
+    GroupVarintEncoder<typename ELF::Addr> group_varint_encoder;
+    group_varint_encoder.EnqueueAll(packed_words);
+    group_varint_encoder.GetEncoding(&encoded);
+  } else {
+    Sleb128Encoder<typename ELF::Addr> sleb128_encoder;
+    sleb128_encoder.EnqueueAll(packed_words);
+    sleb128_encoder.GetEncoding(&encoded);
+  }
 
   packed->push_back('A');
   packed->push_back('P');
   packed->push_back('S');
-  packed->push_back('2');
-  packed->insert(packed->end(), sleb128_packed.begin(), sleb128_packed.end());
+  packed->push_back(format == APS3 ? '3' : '2');
+  packed->insert(packed->end(), encoded.begin(), encoded.end());
 }
 
-// Unpack relative relocations from a run-length encoded packed
-// representation.
 template <typename ELF>
 void RelocationPacker<ELF>::UnpackRelocations(
     const std::vector<uint8_t>& packed,
@@ -52,10 +57,15 @@ void RelocationPacker<ELF>::UnpackRelocations(
         packed[0] == 'A' &&
         packed[1] == 'P' &&
         packed[2] == 'S' &&
-        packed[3] == '2');
-
-  Sleb128Decoder<typename ELF::Addr> decoder(packed, 4);
-  decoder.DequeueAll(&packed_words);
+        (packed[3] == '2' || packed[3] == '3'));
+
+  if (packed[3] == '3') {
+    GroupVarintDecoder<typename ELF::Addr> decoder(packed, 4);
+    decoder.DequeueAll(&packed_words);
+  } else {
+    Sleb128Decoder<typename ELF::Addr> decoder(packed, 4);
+    decoder.DequeueAll(&packed_words);
+  }
 
   RelocationDeltaCodec<ELF> codec;
   codec.Decode(packed_words, relocations);
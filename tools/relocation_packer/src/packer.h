@@ -14,6 +14,14 @@
 
 namespace relocation_packer {
 
+// The packed formats.  APS2 writes the packed words as SLEB128; APS3 writes
+// them as group varints, which the linker decodes a block of four at a time,
+// and needs a linker that knows it.
+enum PackedFormat {
+  APS2,
+  APS3,
+};
+
 // A RelocationPacker packs vectors of relocations into more
 // compact forms, and unpacks them to reproduce the pre-packed data.
 template <typename ELF>
@@ -22,10 +30,12 @@ class RelocationPacker {
   // Pack relocations into a more compact form.
   // |relocations| is a vector of relocation structs.
   // |packed| is the vector of packed bytes into which relocations are packed.
+  // |format| is the packed format to write.
   static void PackRelocations(const std::vector<typename ELF::Rela>& relocations,
-                              std::vector<uint8_t>* packed);
+                              std::vector<uint8_t>* packed,
+                              PackedFormat format = APS2);
 
-  // Unpack relocations from their more compact form.
+  // Unpack relocations from their more compact form, in either format.
   // |packed| is the vector of packed relocations.
   // |relocations| is a vector of unpacked relocation structs.
   static void UnpackRelocations(const std::vector<uint8_t>& packed,
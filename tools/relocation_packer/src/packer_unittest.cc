@@ -297,4 +297,43 @@ TEST(Packer, UnpackWithAddend) {
   DoUnpackWithAddend<ELF64_traits>();
 }
 
+template <typename ELF>
+static void DoPackUnpackAps3() {
+  std::vector<typename ELF::Rela> relocations;
+  // Relative relocations with and without addends, then symbolic ones.
+  for (size_t i = 0; i < 100; ++i) {
+    AddRelocation<ELF>(0xd1ce0000 + 8 * i, 0x11, 0, &relocations);
+  }
+  for (size_t i = 0; i < 20; ++i) {
+    AddRelocation<ELF>(0xd1cf0000 + 4 * i, 0x11, 10000 - 24 * i, &relocations);
+  }
+  for (size_t i = 0; i < 20; ++i) {
+    AddRelocation<ELF>(0xd1d00000 + 8 * i, (i % 5 + 1) << 8 | 0x02, 0, &relocations);
+  }
+
+  RelocationPacker<ELF> packer;
+  std::vector<uint8_t> packed;
+  packer.PackRelocations(relocations, &packed, APS3);
+
+  ASSERT_LT(4U, packed.size());
+  EXPECT_EQ('A', packed[0]);
+  EXPECT_EQ('P', packed[1]);
+  EXPECT_EQ('S', packed[2]);
+  EXPECT_EQ('3', packed[3]);
+
+  std::vector<typename ELF::Rela> unpacked;
+  packer.UnpackRelocations(packed, &unpacked);
+
+  ASSERT_EQ(relocations.size(), unpacked.size());
+  for (size_t i = 0; i < relocations.size(); ++i) {
+    EXPECT_TRUE(CheckRelocation<ELF>(relocations[i].r_offset, relocations[i].r_info,
+                                     relocations[i].r_addend, unpacked[i]));
+  }
+}
+
+TEST(Packer, PackUnpackAps3) {
+  DoPackUnpackAps3<ELF32_traits>();
+  DoPackUnpackAps3<ELF64_traits>();
+}
+
 }  // namespace relocation_packer